@@ -11,8 +11,10 @@
  * it under the terms of the PostgreSQL License.
  */
 #include <ctype.h>
+#include <endian.h>
 #include <getopt.h>
 #include <netinet/in.h>
+#include <pthread.h>
 #include <stdarg.h>
 #include <unistd.h>
 #include "arrow_ipc.h"
@@ -32,6 +34,8 @@ typedef struct arrowColumn
 	const char *colname;
 	const char *sqltype;
 	bool	  (*print_datum)(ARROW_PRINT_DATUM_ARGS);
+	bool	  (*send_datum)(ARROW_PRINT_DATUM_ARGS);	/* --binary */
+	uint32_t	type_oid;		/* type OID for binary array/record */
 	bool		nullable;
 	int			buffer_index;
 	int			buffer_count;
@@ -46,10 +50,14 @@ static int			arrow_num_files = -1;
 static arrowColumn *arrow_columns = NULL;
 static int			arrow_num_columns = 0;
 static const char  *output_filename = NULL;
-static FILE		   *output_filp = NULL;
+static FILE		   *output_dest_filp = NULL;
+static __thread FILE *output_filp = NULL;		/* memstream on workers */
 static bool			print_header = false;
 static char			csv_delimiter = ',';
-static char			current_context = 'n';
+static __thread char current_context = 'n';
+static __thread SQLbuffer copy_buf;				/* --binary */
+static bool			binary_copy = false;		/* --binary */
+static int			num_workers = 1;			/* -n|--num-workers */
 static int64_t		num_skip_rows = -1;			/* --offset */
 static int64_t		num_dump_rows = -1;			/* --limit */
 static const char  *create_table_name = NULL;	/* --create-table */
@@ -66,6 +74,9 @@ usage(void)
 		  "  --header       dump column names as csv header\n"
 		  "  --offset NUM   skip first NUM rows\n"
 		  "  --limit NUM    dump only NUM rows\n"
+		  "  --binary       dump in the PostgreSQL binary COPY format\n"
+		  "  -n|--num-workers=N_WORKERS  format record batches in parallel\n"
+		  "                 (default: 1)\n"
 		  "\n"
 		  "  --create-table=TABLE_NAME  dump with CREATE TABLE statement\n"
 		  "  --tablespace=TABLESPACE    specify tablespace of the table, if any\n"
@@ -1010,6 +1021,474 @@ print_arrow_struct(ARROW_PRINT_DATUM_ARGS)
 	return true;
 }
 
+/*
+ * Routines to write out PostgreSQL's binary COPY format (--binary)
+ *
+ * Each send_arrow_XXX() handler appends the length word and the value
+ * in the binary send/recv representation of the SQL type onto the
+ * copy_buf of the current thread. It returns 'false' without writing
+ * anything, if the datum is not valid; then, caller writes NULL instead.
+ */
+static inline void
+__send_int16(int16_t value)
+{
+	uint16_t	temp = htons((uint16_t)value);
+
+	sql_buffer_append(&copy_buf, &temp, sizeof(uint16_t));
+}
+
+static inline void
+__send_int32(int32_t value)
+{
+	uint32_t	temp = htonl((uint32_t)value);
+
+	sql_buffer_append(&copy_buf, &temp, sizeof(uint32_t));
+}
+
+static inline void
+__send_int64(int64_t value)
+{
+	uint64_t	temp = htobe64((uint64_t)value);
+
+	sql_buffer_append(&copy_buf, &temp, sizeof(uint64_t));
+}
+
+/* reserve the length word, then fill it up later */
+static inline size_t
+__send_varlena_begin(void)
+{
+	size_t		off = copy_buf.usage;
+
+	sql_buffer_append_zero(&copy_buf, sizeof(uint32_t));
+	return off;
+}
+
+static inline void
+__send_varlena_end(size_t off)
+{
+	uint32_t	len = copy_buf.usage - (off + sizeof(uint32_t));
+
+	len = htonl(len);
+	memcpy(copy_buf.data + off, &len, sizeof(uint32_t));
+}
+
+static void
+sendArrowDatum(arrowColumn *column,
+			   ArrowBuffer *buffers,
+			   const char *rb_chunk,
+			   int64_t index)
+{
+	/* null checks */
+	if (column->nullable)
+	{
+		const char *nullmap = rb_chunk + buffers[0].offset;
+		int64_t		k = (index >> 3);
+		int32_t		mask = (1 << (index & 7));
+
+		if (k < buffers[0].length && (nullmap[k] & mask) == 0)
+		{
+			__send_int32(-1);
+			return;
+		}
+	}
+	if (column->send_datum(column, rb_chunk, buffers, index, NULL))
+		return;
+	__send_int32(-1);
+}
+
+static bool
+send_arrow_int8(ARROW_PRINT_DATUM_ARGS)
+{
+	ARROW_PRINT_DATUM_SETUP_INLINE(int8_t);
+	__send_int32(sizeof(int8_t));
+	sql_buffer_append(&copy_buf, &datum, sizeof(int8_t));
+	return true;
+}
+
+static bool
+send_arrow_int16(ARROW_PRINT_DATUM_ARGS)
+{
+	ARROW_PRINT_DATUM_SETUP_INLINE(int16_t);
+	__send_int32(sizeof(int16_t));
+	__send_int16(datum);
+	return true;
+}
+
+static bool
+send_arrow_int32(ARROW_PRINT_DATUM_ARGS)
+{
+	ARROW_PRINT_DATUM_SETUP_INLINE(int32_t);
+	__send_int32(sizeof(int32_t));
+	__send_int32(datum);
+	return true;
+}
+
+static bool
+send_arrow_int64(ARROW_PRINT_DATUM_ARGS)
+{
+	ARROW_PRINT_DATUM_SETUP_INLINE(int64_t);
+	__send_int32(sizeof(int64_t));
+	__send_int64(datum);
+	return true;
+}
+
+static bool
+send_arrow_varlena32(ARROW_PRINT_DATUM_ARGS)
+{
+	const char *addr;
+	size_t		sz;
+
+	addr = __arrow_fetch_varlena32(rb_chunk, buffers, index, &sz);
+	if (!addr)
+		return false;
+	__send_int32(sz);
+	sql_buffer_append(&copy_buf, addr, sz);
+	return true;
+}
+
+static bool
+send_arrow_varlena64(ARROW_PRINT_DATUM_ARGS)
+{
+	const char *addr;
+	size_t		sz;
+
+	addr = __arrow_fetch_varlena64(rb_chunk, buffers, index, &sz);
+	if (!addr)
+		return false;
+	__send_int32(sz);
+	sql_buffer_append(&copy_buf, addr, sz);
+	return true;
+}
+
+static bool
+send_arrow_bool(ARROW_PRINT_DATUM_ARGS)
+{
+	int64_t		k = (index >> 3);
+	int32_t		mask = (1 << (index & 7));
+	const char *bitmap = rb_chunk + buffers[1].offset;
+	char		datum;
+
+	if (k >= buffers[1].length)
+		return false;
+	datum = ((bitmap[k] & mask) != 0 ? 1 : 0);
+	__send_int32(sizeof(char));
+	sql_buffer_append(&copy_buf, &datum, sizeof(char));
+	return true;
+}
+
+/*
+ * numeric_send() format; the digits are base-10000 and aligned to the
+ * decimal point.
+ */
+static bool
+send_arrow_decimal128(ARROW_PRINT_DATUM_ARGS)
+{
+	int32_t		scale = column->arrow_type.Decimal.scale;
+	int32_t		dscale = (scale > 0 ? scale : 0);
+	int16_t		digits[16];
+	int			ndigits = 0;
+	int			weight = -1;
+	int			i, sign = 0x0000;
+	int128_t	datum;
+
+	if (sizeof(int128_t) * (index+1) > buffers[1].length)
+		return false;
+	memcpy(&datum, rb_chunk + buffers[1].offset + sizeof(int128_t) * index,
+		   sizeof(int128_t));
+	if (datum < 0)
+	{
+		datum = -datum;
+		sign = 0x4000;
+	}
+	/* shift the value to be aligned to the base-10000 boundary */
+	while (scale < 0)
+	{
+		datum *= 10;
+		scale++;
+	}
+	i = scale % 4;
+	if (i > 0)
+	{
+		for (; i < 4; i++)
+			datum *= 10;
+		scale += (4 - scale % 4);
+	}
+	/* extract base-10000 digits from the least significant one */
+	weight = -(scale / 4) - 1;
+	while (datum != 0)
+	{
+		digits[ndigits++] = (int16_t)(datum % 10000);
+		datum /= 10000;
+		weight++;
+	}
+	/* strip the trailing zeros */
+	for (i=0; i < ndigits && digits[i] == 0; i++);
+	if (i == ndigits)
+	{
+		ndigits = 0;
+		weight = 0;
+		sign = 0x0000;
+	}
+	__send_int32(sizeof(int16_t) * (4 + ndigits - i));
+	__send_int16(ndigits - i);
+	__send_int16(weight);
+	__send_int16(sign);
+	__send_int16(dscale);
+	while (ndigits > i)
+		__send_int16(digits[--ndigits]);
+	return true;
+}
+
+#define POSTGRES_EPOCH_JDATE_OFFSET		10957	/* 2000-01-01 - 1970-01-01 */
+
+static bool
+send_arrow_date_day(ARROW_PRINT_DATUM_ARGS)
+{
+	ARROW_PRINT_DATUM_SETUP_INLINE(int32_t);
+	__send_int32(sizeof(int32_t));
+	__send_int32(datum - POSTGRES_EPOCH_JDATE_OFFSET);
+	return true;
+}
+
+static bool
+send_arrow_date_ms(ARROW_PRINT_DATUM_ARGS)
+{
+	int64_t		days;
+	ARROW_PRINT_DATUM_SETUP_INLINE(int64_t);
+
+	days = datum / 86400000L;
+	if (datum < 0 && datum % 86400000L != 0)
+		days--;
+	__send_int32(sizeof(int32_t));
+	__send_int32(days - POSTGRES_EPOCH_JDATE_OFFSET);
+	return true;
+}
+
+static inline bool
+__send_arrow_time_common(ARROW_PRINT_DATUM_ARGS, int64_t usecs)
+{
+	__send_int32(sizeof(int64_t));
+	__send_int64(usecs);
+	return true;
+}
+
+static bool
+send_arrow_time_sec(ARROW_PRINT_DATUM_ARGS)
+{
+	ARROW_PRINT_DATUM_SETUP_INLINE(int32_t);
+	return __send_arrow_time_common(column, rb_chunk, buffers, index, quote,
+									(int64_t)datum * 1000000L);
+}
+
+static bool
+send_arrow_time_ms(ARROW_PRINT_DATUM_ARGS)
+{
+	ARROW_PRINT_DATUM_SETUP_INLINE(int32_t);
+	return __send_arrow_time_common(column, rb_chunk, buffers, index, quote,
+									(int64_t)datum * 1000L);
+}
+
+static bool
+send_arrow_time_us(ARROW_PRINT_DATUM_ARGS)
+{
+	ARROW_PRINT_DATUM_SETUP_INLINE(int64_t);
+	return __send_arrow_time_common(column, rb_chunk, buffers, index, quote,
+									datum);
+}
+
+static bool
+send_arrow_time_ns(ARROW_PRINT_DATUM_ARGS)
+{
+	ARROW_PRINT_DATUM_SETUP_INLINE(int64_t);
+	return __send_arrow_time_common(column, rb_chunk, buffers, index, quote,
+									datum / 1000L);
+}
+
+/*
+ * timestamp without time zone; it shall be the local time of the
+ * timezone attribute, if any, as the CSV output doing.
+ */
+static inline bool
+__send_arrow_timestamp_common(ARROW_PRINT_DATUM_ARGS, int64_t usecs)
+{
+	if (__assign_timestamp_timezone(&column->arrow_type.Timestamp))
+	{
+		time_t		t = (usecs >= 0 ? usecs : usecs - 999999) / 1000000L;
+		struct tm	tm;
+
+		localtime_r(&t, &tm);
+		usecs += (int64_t)tm.tm_gmtoff * 1000000L;
+	}
+	__send_int32(sizeof(int64_t));
+	__send_int64(usecs - POSTGRES_EPOCH_JDATE_OFFSET * 86400000000L);
+	return true;
+}
+
+static bool
+send_arrow_timestamp_sec(ARROW_PRINT_DATUM_ARGS)
+{
+	ARROW_PRINT_DATUM_SETUP_INLINE(int64_t);
+	return __send_arrow_timestamp_common(column, rb_chunk, buffers, index, quote,
+										 datum * 1000000L);
+}
+
+static bool
+send_arrow_timestamp_ms(ARROW_PRINT_DATUM_ARGS)
+{
+	ARROW_PRINT_DATUM_SETUP_INLINE(int64_t);
+	return __send_arrow_timestamp_common(column, rb_chunk, buffers, index, quote,
+										 datum * 1000L);
+}
+
+static bool
+send_arrow_timestamp_us(ARROW_PRINT_DATUM_ARGS)
+{
+	ARROW_PRINT_DATUM_SETUP_INLINE(int64_t);
+	return __send_arrow_timestamp_common(column, rb_chunk, buffers, index, quote,
+										 datum);
+}
+
+static bool
+send_arrow_timestamp_ns(ARROW_PRINT_DATUM_ARGS)
+{
+	ARROW_PRINT_DATUM_SETUP_INLINE(int64_t);
+	return __send_arrow_timestamp_common(column, rb_chunk, buffers, index, quote,
+										 datum / 1000L);
+}
+
+static bool
+send_arrow_interval_ym(ARROW_PRINT_DATUM_ARGS)
+{
+	ARROW_PRINT_DATUM_SETUP_INLINE(int32_t);
+	__send_int32(sizeof(int64_t) + 2 * sizeof(int32_t));
+	__send_int64(0);		/* time */
+	__send_int32(0);		/* day */
+	__send_int32(datum);	/* month */
+	return true;
+}
+
+static bool
+send_arrow_interval_dt(ARROW_PRINT_DATUM_ARGS)
+{
+	ARROW_PRINT_DATUM_SETUP_INLINE(uint64_t);
+	__send_int32(sizeof(int64_t) + 2 * sizeof(int32_t));
+	__send_int64((int64_t)((int32_t)(datum >> 32)) * 1000L);	/* time */
+	__send_int32((int32_t)(datum & 0xffffffffU));				/* day */
+	__send_int32(0);											/* month */
+	return true;
+}
+
+static bool
+send_arrow_fixedsizebinary(ARROW_PRINT_DATUM_ARGS)
+{
+	static const char *hextbl = "0123456789abcdef";
+	int32_t		i, width = column->arrow_type.FixedSizeBinary.byteWidth;
+	ARROW_PRINT_DATUM_SETUP_FIXEDSIZEBINARY(width);
+
+	/* same text representation to the CSV output */
+	__send_int32(2 + 2 * width);
+	sql_buffer_append(&copy_buf, "\\x", 2);
+	for (i=0; i < width; i++)
+	{
+		int		c = addr[i];
+
+		sql_buffer_append(&copy_buf, &hextbl[(c >> 4) & 0x0f], 1);
+		sql_buffer_append(&copy_buf, &hextbl[(c & 0x0f)], 1);
+	}
+	return true;
+}
+
+static bool
+send_arrow_macaddr(ARROW_PRINT_DATUM_ARGS)
+{
+	int32_t		width = column->arrow_type.FixedSizeBinary.byteWidth;
+	ARROW_PRINT_DATUM_SETUP_FIXEDSIZEBINARY(width);
+	assert(width == 6);
+	__send_int32(width);
+	sql_buffer_append(&copy_buf, addr, width);
+	return true;
+}
+
+static bool
+send_arrow_inet(ARROW_PRINT_DATUM_ARGS)
+{
+	int32_t		width = column->arrow_type.FixedSizeBinary.byteWidth;
+	char		head[4];
+	ARROW_PRINT_DATUM_SETUP_FIXEDSIZEBINARY(width);
+	assert(width == 4 || width == 16);
+
+	head[0] = (width == 4 ? 2 : 3);		/* PGSQL_AF_INET or PGSQL_AF_INET6 */
+	head[1] = 8 * width;				/* bits */
+	head[2] = 0;						/* is_cidr */
+	head[3] = width;					/* nb */
+	__send_int32(sizeof(head) + width);
+	sql_buffer_append(&copy_buf, head, sizeof(head));
+	sql_buffer_append(&copy_buf, addr, width);
+	return true;
+}
+
+/*
+ * array_send() format; 1-dimensional array with lower bound = 1
+ */
+static bool
+send_arrow_list(ARROW_PRINT_DATUM_ARGS)
+{
+	const uint32_t *values;
+	uint32_t		i, head, tail;
+	arrowColumn	   *child;
+	ArrowBuffer	   *__buffers;
+	size_t			off;
+
+	if (sizeof(uint32_t) * (index+2) > buffers[1].length)
+		return false;
+
+	values = (const uint32_t *)(rb_chunk + buffers[1].offset);
+	head = values[index];
+	tail = values[index+1];
+	if (head > tail)
+		return false;
+
+	child = &column->children[0];
+	__buffers = buffers + (child->buffer_index -
+						   column->buffer_index);
+	off = __send_varlena_begin();
+	__send_int32(head < tail ? 1 : 0);			/* ndim */
+	__send_int32(child->nullable ? 1 : 0);		/* has null */
+	__send_int32(child->type_oid);				/* element type */
+	if (head < tail)
+	{
+		__send_int32(tail - head);				/* dimension */
+		__send_int32(1);						/* lower bound */
+		for (i=head; i < tail; i++)
+			sendArrowDatum(child, __buffers, rb_chunk, i);
+	}
+	__send_varlena_end(off);
+	return true;
+}
+
+/*
+ * record_send() format
+ */
+static bool
+send_arrow_struct(ARROW_PRINT_DATUM_ARGS)
+{
+	size_t		off;
+	int			j;
+
+	off = __send_varlena_begin();
+	__send_int32(column->num_children);
+	for (j=0; j < column->num_children; j++)
+	{
+		arrowColumn *child = &column->children[j];
+		ArrowBuffer *__buffers = buffers + (child->buffer_index -
+											column->buffer_index);
+		__send_int32(child->type_oid);
+		sendArrowDatum(child, __buffers, rb_chunk, index);
+	}
+	__send_varlena_end(off);
+	return true;
+}
+
 static int
 setupArrowColumn(arrowColumn *column, ArrowField *field, int buffer_index)
 {
@@ -1310,6 +1789,186 @@ setupArrowColumn(arrowColumn *column, ArrowField *field, int buffer_index)
 	return buffer_count;
 }
 
+/*
+ * setupArrowColumnSend - assign send_datum handler for --binary
+ */
+static void
+setupArrowColumnSend(arrowColumn *column)
+{
+	int		j;
+
+	switch (column->arrow_type.node.tag)
+	{
+		case ArrowNodeTag__Int:
+			switch (column->arrow_type.Int.bitWidth)
+			{
+				case 8:
+					column->send_datum = send_arrow_int8;
+					column->type_oid = 0;		/* int1 has no fixed OID */
+					break;
+				case 16:
+					column->send_datum = send_arrow_int16;
+					column->type_oid = 21;		/* int2 */
+					break;
+				case 32:
+					column->send_datum = send_arrow_int32;
+					column->type_oid = 23;		/* int4 */
+					break;
+				default:
+					column->send_datum = send_arrow_int64;
+					column->type_oid = 20;		/* int8 */
+					break;
+			}
+			break;
+
+		case ArrowNodeTag__FloatingPoint:
+			switch (column->arrow_type.FloatingPoint.precision)
+			{
+				case ArrowPrecision__Half:
+					column->send_datum = send_arrow_int16;
+					column->type_oid = 0;		/* float2 has no fixed OID */
+					break;
+				case ArrowPrecision__Single:
+					column->send_datum = send_arrow_int32;
+					column->type_oid = 700;		/* float4 */
+					break;
+				default:
+					column->send_datum = send_arrow_int64;
+					column->type_oid = 701;		/* float8 */
+					break;
+			}
+			break;
+
+		case ArrowNodeTag__Utf8:
+		case ArrowNodeTag__Binary:
+			column->send_datum = send_arrow_varlena32;
+			column->type_oid = (column->arrow_type.node.tag == ArrowNodeTag__Utf8
+								? 25		/* text */
+								: 17);		/* bytea */
+			break;
+
+		case ArrowNodeTag__LargeUtf8:
+		case ArrowNodeTag__LargeBinary:
+			column->send_datum = send_arrow_varlena64;
+			column->type_oid = (column->arrow_type.node.tag == ArrowNodeTag__LargeUtf8
+								? 25		/* text */
+								: 17);		/* bytea */
+			break;
+
+		case ArrowNodeTag__Bool:
+			column->send_datum = send_arrow_bool;
+			column->type_oid = 16;				/* bool */
+			break;
+
+		case ArrowNodeTag__Decimal:
+			column->send_datum = send_arrow_decimal128;
+			column->type_oid = 1700;			/* numeric */
+			break;
+
+		case ArrowNodeTag__Date:
+			if (column->arrow_type.Date.unit == ArrowDateUnit__Day)
+				column->send_datum = send_arrow_date_day;
+			else
+				column->send_datum = send_arrow_date_ms;
+			column->type_oid = 1082;			/* date */
+			break;
+
+		case ArrowNodeTag__Time:
+			switch (column->arrow_type.Time.unit)
+			{
+				case ArrowTimeUnit__Second:
+					column->send_datum = send_arrow_time_sec;
+					break;
+				case ArrowTimeUnit__MilliSecond:
+					column->send_datum = send_arrow_time_ms;
+					break;
+				case ArrowTimeUnit__MicroSecond:
+					column->send_datum = send_arrow_time_us;
+					break;
+				default:
+					column->send_datum = send_arrow_time_ns;
+					break;
+			}
+			column->type_oid = 1083;			/* time */
+			break;
+
+		case ArrowNodeTag__Timestamp:
+			switch (column->arrow_type.Timestamp.unit)
+			{
+				case ArrowTimeUnit__Second:
+					column->send_datum = send_arrow_timestamp_sec;
+					break;
+				case ArrowTimeUnit__MilliSecond:
+					column->send_datum = send_arrow_timestamp_ms;
+					break;
+				case ArrowTimeUnit__MicroSecond:
+					column->send_datum = send_arrow_timestamp_us;
+					break;
+				default:
+					column->send_datum = send_arrow_timestamp_ns;
+					break;
+			}
+			column->type_oid = 1114;			/* timestamp */
+			break;
+
+		case ArrowNodeTag__Interval:
+			if (column->arrow_type.Interval.unit == ArrowIntervalUnit__Year_Month)
+				column->send_datum = send_arrow_interval_ym;
+			else
+				column->send_datum = send_arrow_interval_dt;
+			column->type_oid = 1186;			/* interval */
+			break;
+
+		case ArrowNodeTag__FixedSizeBinary:
+			if (column->print_datum == print_arrow_macaddr)
+			{
+				column->send_datum = send_arrow_macaddr;
+				column->type_oid = 829;			/* macaddr */
+			}
+			else if (column->print_datum == print_arrow_inet4 ||
+					 column->print_datum == print_arrow_inet6)
+			{
+				column->send_datum = send_arrow_inet;
+				column->type_oid = 869;			/* inet */
+			}
+			else
+			{
+				column->send_datum = send_arrow_fixedsizebinary;
+				column->type_oid = 1042;		/* bpchar */
+			}
+			break;
+
+		case ArrowNodeTag__List:
+			setupArrowColumnSend(column->children);
+			if (column->children->type_oid == 0 ||
+				column->children->arrow_type.node.tag == ArrowNodeTag__List ||
+				column->children->arrow_type.node.tag == ArrowNodeTag__Struct)
+				Elog("--binary does not support array of %s (column '%s')",
+					 column->children->sqltype, column->colname);
+			column->send_datum = send_arrow_list;
+			column->type_oid = 0;		/* array type OID is not used */
+			break;
+
+		case ArrowNodeTag__Struct:
+			for (j=0; j < column->num_children; j++)
+			{
+				arrowColumn *child = &column->children[j];
+
+				setupArrowColumnSend(child);
+				if (child->type_oid == 0)
+					Elog("--binary does not support %s in composite type (column '%s')",
+						 child->sqltype, column->colname);
+			}
+			column->send_datum = send_arrow_struct;
+			column->type_oid = 0;		/* OID of composite type is unknown */
+			break;
+
+		default:
+			Elog("Bug? unexpected Arrow type (%s)",
+				 column->arrow_type.node.tagName);
+	}
+}
+
 /*
  * printCreateTable - dump the schema definition
  */
@@ -1382,24 +2041,68 @@ printCreateTable(void)
 	fprintf(output_filp, ";\n");
 }
 
-static void
-printRecordBatch(ArrowRecordBatch *rbatch, const char *rb_chunk)
+/*
+ * arrowDumpTask - a range of rows in a record batch to be dumped
+ */
+typedef struct
 {
-	int64_t		i, j;
+	ArrowRecordBatch *rbatch;
+	const char *rb_chunk;
+	int64_t		start;
+	int64_t		nrows;
+} arrowDumpTask;
+
+static arrowDumpTask *dump_tasks = NULL;
+static int			dump_num_tasks = 0;
+static int			dump_next_task = 0;
+static int			dump_next_write = 0;
+static pthread_mutex_t dump_write_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  dump_write_cond  = PTHREAD_COND_INITIALIZER;
 
-	/* consider --offset */
-	if (num_skip_rows < 0)
-		i = 0;
-	else
+/*
+ * setupDumpTask - it applies --offset and --limit on the record batch;
+ * it must be called in order of the record batches.
+ */
+static bool
+setupDumpTask(arrowDumpTask *task,
+			  ArrowRecordBatch *rbatch, const char *rb_chunk)
+{
+	int64_t		start = 0;
+	int64_t		nrows;
+
+	if (num_skip_rows > 0)
 	{
-		i = num_skip_rows;
-		if (num_skip_rows > rbatch->length)
+		if (num_skip_rows >= rbatch->length)
+		{
 			num_skip_rows -= rbatch->length;
-		else
-			num_skip_rows = 0;
+			return false;
+		}
+		start = num_skip_rows;
+		num_skip_rows = 0;
+	}
+	nrows = rbatch->length - start;
+	if (num_dump_rows >= 0)
+	{
+		if (nrows > num_dump_rows)
+			nrows = num_dump_rows;
+		num_dump_rows -= nrows;
 	}
+	if (nrows <= 0)
+		return false;
+	task->rbatch = rbatch;
+	task->rb_chunk = rb_chunk;
+	task->start = start;
+	task->nrows = nrows;
+	return true;
+}
+
+static void
+printRecordBatch(arrowDumpTask *task)
+{
+	ArrowRecordBatch *rbatch = task->rbatch;
+	int64_t		i, j;
 
-	while (i < rbatch->length && num_dump_rows != 0)
+	for (i = task->start; i < task->start + task->nrows; i++)
 	{
 		for (j=0; j < arrow_num_columns; j++)
 		{
@@ -1417,16 +2120,105 @@ printRecordBatch(ArrowRecordBatch *rbatch, const char *rb_chunk)
 				assert(column->buffer_index +
 					   column->buffer_count <= rbatch->_num_buffers);
 				buffers = rbatch->buffers + column->buffer_index;
-				printArrowDatum(column, buffers, rb_chunk, i, "\"");
+				printArrowDatum(column, buffers, task->rb_chunk, i, "\"");
 			}
 		}
 		fprintf(output_filp, "\r\n");
-		i++;
-		if (num_dump_rows > 0)
-			num_dump_rows--;
 	}
 }
 
+static void
+__flushCopyBuffer(void)
+{
+	if (copy_buf.usage > 0 &&
+		fwrite(copy_buf.data, copy_buf.usage, 1, output_filp) != 1)
+		Elog("failed on fwrite: %m");
+	sql_buffer_clear(&copy_buf);
+}
+
+static void
+sendRecordBatch(arrowDumpTask *task)
+{
+	ArrowRecordBatch *rbatch = task->rbatch;
+	int64_t		i, j;
+
+	for (i = task->start; i < task->start + task->nrows; i++)
+	{
+		__send_int16(arrow_num_columns);
+		for (j=0; j < arrow_num_columns; j++)
+		{
+			arrowColumn	   *column = &arrow_columns[j];
+			ArrowBuffer	   *buffers;
+
+			if (j >= rbatch->_num_nodes ||
+				i >= rbatch->nodes[j].length)
+				__send_int32(-1);
+			else
+			{
+				assert(column->buffer_index +
+					   column->buffer_count <= rbatch->_num_buffers);
+				buffers = rbatch->buffers + column->buffer_index;
+				sendArrowDatum(column, buffers, task->rb_chunk, i);
+			}
+		}
+		if (copy_buf.usage >= (1UL << 20))
+			__flushCopyBuffer();
+	}
+	__flushCopyBuffer();
+}
+
+static inline void
+dumpRecordBatch(arrowDumpTask *task)
+{
+	if (binary_copy)
+		sendRecordBatch(task);
+	else
+		printRecordBatch(task);
+}
+
+/*
+ * dumpWorkerMain - formats the record batches on the private memstream,
+ * then writes out them in order of the record batches.
+ */
+static void *
+dumpWorkerMain(void *__arg)
+{
+	for (;;)
+	{
+		int		index = __atomic_fetch_add(&dump_next_task, 1,
+										   __ATOMIC_SEQ_CST);
+		char   *buf = NULL;
+		size_t	sz = 0;
+
+		if (index >= dump_num_tasks)
+			break;
+		output_filp = open_memstream(&buf, &sz);
+		if (!output_filp)
+			Elog("failed on open_memstream: %m");
+		dumpRecordBatch(&dump_tasks[index]);
+		if (fclose(output_filp) != 0)
+			Elog("failed on fclose: %m");
+		output_filp = NULL;
+
+		pthread_mutex_lock(&dump_write_mutex);
+		while (dump_next_write != index)
+			pthread_cond_wait(&dump_write_cond, &dump_write_mutex);
+		pthread_mutex_unlock(&dump_write_mutex);
+
+		if (sz > 0 && fwrite(buf, sz, 1, output_dest_filp) != 1)
+			Elog("failed on fwrite: %m");
+		free(buf);
+
+		pthread_mutex_lock(&dump_write_mutex);
+		dump_next_write++;
+		pthread_cond_broadcast(&dump_write_cond);
+		pthread_mutex_unlock(&dump_write_mutex);
+	}
+	if (copy_buf.data)
+		pfree(copy_buf.data);
+	return NULL;
+}
+
 static void
 dumpArrowFile(ArrowFileInfo *af_info, int fdesc)
 {
@@ -1434,7 +2226,7 @@ dumpArrowFile(ArrowFileInfo *af_info, int fdesc)
 	size_t		file_sz = af_info->stat_buf.st_size;
 	size_t		mmap_sz;
 	char	   *mmap_head;
-	int			i;
+	int			i, nworkers;
 
 	if (__PAGE_SIZE < 0)
 		__PAGE_SIZE = sysconf(_SC_PAGESIZE);
@@ -1442,17 +2234,92 @@ dumpArrowFile(ArrowFileInfo *af_info, int fdesc)
 	mmap_head = mmap(NULL, mmap_sz, PROT_READ, MAP_SHARED, fdesc, 0);
 	if (mmap_head == MAP_FAILED)
 		Elog("failed on mmap: %m");
+	dump_tasks = palloc(sizeof(arrowDumpTask) *
+						(af_info->footer._num_recordBatches + 1));
+	dump_num_tasks = 0;
 	for (i=0; i < af_info->footer._num_recordBatches; i++)
 	{
 		ArrowBlock *block = &af_info->footer.recordBatches[i];
 		char	   *rb_chunk = (mmap_head + block->offset + block->metaDataLength);
 		ArrowRecordBatch *rbatch = &af_info->recordBatches[i].body.recordBatch;
 
-		printRecordBatch(rbatch, rb_chunk);
+		if (setupDumpTask(&dump_tasks[dump_num_tasks], rbatch, rb_chunk))
+			dump_num_tasks++;
+	}
+
+	nworkers = (num_workers < dump_num_tasks ? num_workers : dump_num_tasks);
+	if (nworkers <= 1)
+	{
+		for (i=0; i < dump_num_tasks; i++)
+			dumpRecordBatch(&dump_tasks[i]);
 	}
+	else
+	{
+		pthread_t  *workers = alloca(sizeof(pthread_t) * nworkers);
+
+		dump_next_task = 0;
+		dump_next_write = 0;
+		for (i=0; i < nworkers; i++)
+		{
+			if ((errno = pthread_create(&workers[i], NULL,
+										dumpWorkerMain, NULL)) != 0)
+				Elog("failed on pthread_create: %m");
+		}
+		for (i=0; i < nworkers; i++)
+		{
+			if ((errno = pthread_join(workers[i], NULL)) != 0)
+				Elog("failed on pthread_join: %m");
+		}
+	}
+	pfree(dump_tasks);
 	munmap(mmap_head, mmap_sz);
 }
 
+/*
+ * setupTimezoneForWorkers
+ *
+ * Timestamp with timezone attribute is formatted using TZ environment
+ * variable, but it is not safe to switch it during the multi-threaded
+ * dump, so we assign TZ prior to launch the workers.
+ */
+static const char *
+__lookupTimestampTimezone(arrowColumn *column, const char *tz_name)
+{
+	int		j;
+
+	if (column->arrow_type.node.tag == ArrowNodeTag__Timestamp &&
+		column->arrow_type.Timestamp.timezone)
+	{
+		const char *__tz_name = column->arrow_type.Timestamp.timezone;
+
+		if (tz_name && strcmp(tz_name, __tz_name) != 0)
+			Elog("-n|--num-workers does not support multiple timezones (%s, %s)",
+				 tz_name, __tz_name);
+		tz_name = __tz_name;
+	}
+	for (j=0; j < column->num_children; j++)
+		tz_name = __lookupTimestampTimezone(&column->children[j], tz_name);
+	return tz_name;
+}
+
+static void
+setupTimezoneForWorkers(void)
+{
+	const char *tz_name = NULL;
+	int			j;
+
+	for (j=0; j < arrow_num_columns; j++)
+		tz_name = __lookupTimestampTimezone(&arrow_columns[j], tz_name);
+	if (tz_name)
+	{
+		ArrowTypeTimestamp	ts;
+
+		memset(&ts, 0, sizeof(ArrowTypeTimestamp));
+		ts.timezone = tz_name;
+		__assign_timestamp_timezone(&ts);
+	}
+}
+
 int
 main(int argc, char * const argv[])
 {
@@ -1461,6 +2328,8 @@ main(int argc, char * const argv[])
 		{"header",       no_argument,       NULL, 1002},
 		{"offset",       required_argument, NULL, 1004},
 		{"limit",        required_argument, NULL, 1005},
+		{"binary",       no_argument,       NULL, 1006},
+		{"num-workers",  required_argument, NULL, 'n'},
 		/* CREATE TABLE & COPY FROM */
 		{"create-table", required_argument, NULL, 1200},
 		{"tablespace",   required_argument, NULL, 1201},
@@ -1471,7 +2340,7 @@ main(int argc, char * const argv[])
 	};
 	int		i, j, c;
 
-	while ((c = getopt_long(argc, argv, "o:h", long_options, NULL)) >= 0)
+	while ((c = getopt_long(argc, argv, "o:n:h", long_options, NULL)) >= 0)
 	{
 		switch (c)
 		{
@@ -1499,6 +2368,14 @@ main(int argc, char * const argv[])
 				if (num_dump_rows < 0)
 					Elog("--limit=%s is not a numeric value", optarg);
 				break;
+			case 1006:	/* --binary */
+				binary_copy = true;
+				break;
+			case 'n':	/* --num-workers */
+				num_workers = atoi(optarg);
+				if (num_workers < 1)
+					Elog("not a valid -n|--num-workers option: %s", optarg);
+				break;
 			case 1200:	/* --create-table */
 				if (create_table_name)
 					Elog("--create-table was specified twice");
@@ -1525,6 +2402,10 @@ main(int argc, char * const argv[])
 		Elog("--tablespace must be used with --create-table");
 	if (partition_name && !create_table_name)
 		Elog("--partition-of must be used with --create-table");
+	if (binary_copy && print_header)
+		Elog("--header cannot be used with --binary");
+	if (binary_copy && create_table_name)
+		Elog("--create-table cannot be used with --binary; load the output using COPY ... FROM ... (FORMAT binary)");
 	
 	/* arrow files */
 	if (optind >= argc)
@@ -1558,7 +2439,11 @@ main(int argc, char * const argv[])
 				bindex += setupArrowColumn(&arrow_columns[j],
 										   &schema->fields[j],
 										   bindex);
+				if (binary_copy)
+					setupArrowColumnSend(&arrow_columns[j]);
 			}
+			if (num_workers > 1)
+				setupTimezoneForWorkers();
 		}
 		else
 		{
@@ -1591,13 +2476,25 @@ main(int argc, char * const argv[])
 	
 	/* open the output file, if necessary */
 	if (!output_filename)
-		output_filp = stdout;
+		output_dest_filp = stdout;
 	else
 	{
-		output_filp = fopen(output_filename, "w");
-		if (!output_filp)
+		output_dest_filp = fopen(output_filename, "w");
+		if (!output_dest_filp)
 			Elog("unable to open output file '%s': %m", output_filename);
 	}
+	output_filp = output_dest_filp;
+
+	/* header of the binary COPY format */
+	if (binary_copy)
+	{
+		static const char signature[] = "PGCOPY\n\377\r\n";
+
+		sql_buffer_append(&copy_buf, signature, sizeof(signature));
+		__send_int32(0);	/* flags */
+		__send_int32(0);	/* header extension */
+		__flushCopyBuffer();
+	}
 
 	/* CREATE TABLE / CREATE TYPE, if required */
 	if (create_table_name)
@@ -1624,6 +2521,13 @@ main(int argc, char * const argv[])
 		dumpArrowFile(&arrow_files[i], arrow_fdescs[i]);
 	if (create_table_name && num_dump_rows != 0)
 		fprintf(output_filp, "\\.\r\n");
+	if (binary_copy)
+	{
+		__send_int16(-1);	/* file trailer */
+		__flushCopyBuffer();
+	}
+	if (fflush(output_filp) != 0)
+		Elog("failed on fflush: %m");
 	return 0;
 }
 
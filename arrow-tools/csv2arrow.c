@@ -0,0 +1,1071 @@
+/*
+ * csv2arrow.c - bulk loader of CSV files into Apache Arrow
+ *
+ * Copyright 2011-2023 (C) KaiGai Kohei <kaigai@kaigai.gr.jp>
+ * Copyright 2014-2023 (C) PG-Strom Developers Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the PostgreSQL License.
+ */
+#include "arrow_ipc.h"
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * The CSV files are mapped on the memory, then split to the ranges at the
+ * row boundaries (by a quote-aware pre-scan). Each worker thread parses
+ * its own range and type conversion into the private SQLtable, then writes
+ * out the record batch once it reaches the segment size. So, the order of
+ * rows in the Arrow file is not identical to the source.
+ */
+typedef struct
+{
+	const char *filename;
+	const char *base;		/* mmap'ed image */
+	size_t		length;
+} csvFileDesc;
+
+typedef struct
+{
+	const char *head;
+	const char *tail;
+	int			file_id;
+} csvRange;
+
+/* command options */
+static char	   *output_filename = NULL;
+static char	   *csv_schema = NULL;
+static bool		csv_header = false;
+static char		csv_delimiter = ',';
+static char		csv_quote = '"';
+static char	   *csv_null = "";
+static size_t	batch_segment_sz = 0;
+static int		num_worker_threads = 0;
+static int		shows_progress = 0;
+static bool		arrow_compression = false;
+static int		arrow_compression_codec = 0;
+static int		arrow_compression_level = 0;
+static csvFileDesc *csv_files = NULL;
+static int		num_csv_files = 0;
+
+/* shared state */
+static SQLtable		   *main_table = NULL;
+static pthread_mutex_t	main_table_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t	range_mutex = PTHREAD_MUTEX_INITIALIZER;
+static csvRange		   *csv_ranges = NULL;
+static int				num_csv_ranges = 0;
+static int				next_csv_range = 0;
+
+#ifndef Max
+#define Max(a,b)		((a) > (b) ? (a) : (b))
+#endif
+#define UNIX_EPOCH_JDATE		2440588		/* == date2j(1970, 1, 1) */
+
+/*
+ * put values handlers
+ */
+static inline void
+__put_inline_null_value(SQLfield *column, size_t row_index, int sz)
+{
+	column->nullcount++;
+	sql_buffer_clrbit(&column->nullmap, row_index);
+	sql_buffer_append_zero(&column->values, sz);
+}
+
+#define PUT_INTEGER_VALUE_TEMPLATE(NAME,TYPE,MINVAL,MAXVAL)			\
+	static size_t													\
+	put_##NAME##_value(SQLfield *column, const char *addr, int sz)	\
+	{																\
+		size_t	row_index = column->nitems++;						\
+																	\
+		if (!addr)													\
+			__put_inline_null_value(column, row_index, sizeof(TYPE)); \
+		else														\
+		{															\
+			char	   *end;										\
+			int64_t		ival;										\
+			TYPE		value;										\
+																	\
+			errno = 0;												\
+			ival = strtol(addr, &end, 10);							\
+			if (*end != '\0' || end == addr || errno != 0)			\
+				Elog("value '%s' is not valid for column '%s'",		\
+					 addr, column->field_name);						\
+			if (ival < MINVAL || ival > MAXVAL)						\
+				Elog("value '%s' is out of range for column '%s'",	\
+					 addr, column->field_name);						\
+			value = ival;											\
+			sql_buffer_setbit(&column->nullmap, row_index);			\
+			sql_buffer_append(&column->values, &value, sizeof(TYPE)); \
+		}															\
+		return __buffer_usage_inline_type(column);					\
+	}
+PUT_INTEGER_VALUE_TEMPLATE(int8,  int8_t,  SCHAR_MIN, SCHAR_MAX)
+PUT_INTEGER_VALUE_TEMPLATE(int16, int16_t, SHRT_MIN,  SHRT_MAX)
+PUT_INTEGER_VALUE_TEMPLATE(int32, int32_t, INT_MIN,   INT_MAX)
+PUT_INTEGER_VALUE_TEMPLATE(int64, int64_t, LONG_MIN,  LONG_MAX)
+
+static size_t
+put_float32_value(SQLfield *column, const char *addr, int sz)
+{
+	size_t	row_index = column->nitems++;
+
+	if (!addr)
+		__put_inline_null_value(column, row_index, sizeof(float));
+	else
+	{
+		char   *end;
+		float	fval;
+
+		errno = 0;
+		fval = strtof(addr, &end);
+		if (*end != '\0' || end == addr || errno != 0)
+			Elog("value '%s' is not valid for column '%s'",
+				 addr, column->field_name);
+		sql_buffer_setbit(&column->nullmap, row_index);
+		sql_buffer_append(&column->values, &fval, sizeof(float));
+	}
+	return __buffer_usage_inline_type(column);
+}
+
+static size_t
+put_float64_value(SQLfield *column, const char *addr, int sz)
+{
+	size_t	row_index = column->nitems++;
+
+	if (!addr)
+		__put_inline_null_value(column, row_index, sizeof(double));
+	else
+	{
+		char   *end;
+		double	fval;
+
+		errno = 0;
+		fval = strtod(addr, &end);
+		if (*end != '\0' || end == addr || errno != 0)
+			Elog("value '%s' is not valid for column '%s'",
+				 addr, column->field_name);
+		sql_buffer_setbit(&column->nullmap, row_index);
+		sql_buffer_append(&column->values, &fval, sizeof(double));
+	}
+	return __buffer_usage_inline_type(column);
+}
+
+static size_t
+put_decimal_value(SQLfield *column, const char *addr, int sz)
+{
+	size_t	row_index = column->nitems++;
+
+	if (!addr)
+		__put_inline_null_value(column, row_index, sizeof(__int128));
+	else
+	{
+		const char *pos = addr;
+		int			dscale = column->arrow_type.Decimal.scale;
+		bool		negative = false;
+		__int128	value = 0;
+
+		if (*pos == '-')
+		{
+			negative = true;
+			pos++;
+		}
+		else if (*pos == '+')
+			pos++;
+		if (!isdigit(*pos) && *pos != '.')
+			Elog("value '%s' is not valid for column '%s'",
+				 addr, column->field_name);
+		while (isdigit(*pos))
+			value = 10 * value + (*pos++ - '0');
+		if (*pos == '.')
+		{
+			pos++;
+			while (dscale > 0 && isdigit(*pos))
+			{
+				value = 10 * value + (*pos++ - '0');
+				dscale--;
+			}
+			/* truncation of the digits under the scale */
+			while (isdigit(*pos))
+				pos++;
+		}
+		if (*pos != '\0')
+			Elog("value '%s' is not valid for column '%s'",
+				 addr, column->field_name);
+		while (dscale-- > 0)
+			value *= 10;
+		if (negative)
+			value = -value;
+		sql_buffer_setbit(&column->nullmap, row_index);
+		sql_buffer_append(&column->values, &value, sizeof(__int128));
+	}
+	return __buffer_usage_inline_type(column);
+}
+
+static size_t
+put_bool_value(SQLfield *column, const char *addr, int sz)
+{
+	size_t		row_index = column->nitems++;
+
+	if (!addr)
+	{
+		column->nullcount++;
+		sql_buffer_clrbit(&column->nullmap, row_index);
+		sql_buffer_clrbit(&column->values,  row_index);
+	}
+	else
+	{
+		bool	value;
+
+		if (strcasecmp(addr, "t") == 0 ||
+			strcasecmp(addr, "true") == 0 ||
+			strcasecmp(addr, "y") == 0 ||
+			strcasecmp(addr, "yes") == 0 ||
+			strcasecmp(addr, "on") == 0 ||
+			strcmp(addr, "1") == 0)
+			value = true;
+		else if (strcasecmp(addr, "f") == 0 ||
+				 strcasecmp(addr, "false") == 0 ||
+				 strcasecmp(addr, "n") == 0 ||
+				 strcasecmp(addr, "no") == 0 ||
+				 strcasecmp(addr, "off") == 0 ||
+				 strcmp(addr, "0") == 0)
+			value = false;
+		else
+			Elog("value '%s' is not valid for column '%s'",
+				 addr, column->field_name);
+		sql_buffer_setbit(&column->nullmap, row_index);
+		if (value)
+			sql_buffer_setbit(&column->values, row_index);
+		else
+			sql_buffer_clrbit(&column->values, row_index);
+	}
+	return __buffer_usage_inline_type(column);
+}
+
+static long
+date2j(int y, int m, int d)
+{
+	long	julian;
+	long	century;
+
+	if (m > 2)
+	{
+		m += 1;
+		y += 4800;
+	}
+	else
+	{
+		m += 13;
+		y += 4799;
+	}
+	century = y / 100;
+	julian = y * 365 - 32167;
+	julian += y / 4 - century + century / 4;
+	julian += 7834 * m / 256 + d;
+
+	return julian;
+}
+
+/*
+ * __parse_date_token - parses 'YYYY-MM-DD' and returns the position next to
+ */
+static const char *
+__parse_date_token(SQLfield *column, const char *addr, int32_t *p_days)
+{
+	int		y, m, d, n = 0;
+
+	if (sscanf(addr, "%d-%d-%d%n", &y, &m, &d, &n) != 3 ||
+		m < 1 || m > 12 || d < 1 || d > 31)
+		Elog("value '%s' is not valid for column '%s'",
+			 addr, column->field_name);
+	*p_days = date2j(y, m, d) - UNIX_EPOCH_JDATE;
+	return addr + n;
+}
+
+static size_t
+put_date_value(SQLfield *column, const char *addr, int sz)
+{
+	size_t	row_index = column->nitems++;
+
+	if (!addr)
+		__put_inline_null_value(column, row_index, sizeof(int32_t));
+	else
+	{
+		const char *pos;
+		int32_t		value;
+
+		pos = __parse_date_token(column, addr, &value);
+		if (*pos != '\0')
+			Elog("value '%s' is not valid for column '%s'",
+				 addr, column->field_name);
+		sql_buffer_setbit(&column->nullmap, row_index);
+		sql_buffer_append(&column->values, &value, sizeof(int32_t));
+	}
+	return __buffer_usage_inline_type(column);
+}
+
+static size_t
+put_timestamp_value(SQLfield *column, const char *addr, int sz)
+{
+	size_t	row_index = column->nitems++;
+
+	if (!addr)
+		__put_inline_null_value(column, row_index, sizeof(int64_t));
+	else
+	{
+		const char *pos;
+		int32_t		days;
+		int			hh = 0, mm = 0, ss = 0, n = 0;
+		int64_t		value;
+
+		pos = __parse_date_token(column, addr, &days);
+		value = (int64_t)days * 86400000000L;
+		if (*pos == ' ' || *pos == 'T')
+		{
+			if (sscanf(pos+1, "%d:%d:%d%n", &hh, &mm, &ss, &n) != 3 ||
+				hh < 0 || hh > 24 || mm < 0 || mm > 59 || ss < 0 || ss > 60)
+				Elog("value '%s' is not valid for column '%s'",
+					 addr, column->field_name);
+			pos += n + 1;
+			value += ((int64_t)(hh * 3600 + mm * 60 + ss)) * 1000000L;
+			if (*pos == '.')
+			{
+				int		usec = 0;
+				int		ndigits = 0;
+
+				for (pos++; isdigit(*pos); pos++)
+				{
+					if (ndigits++ < 6)
+						usec = 10 * usec + (*pos - '0');
+				}
+				while (ndigits++ < 6)
+					usec *= 10;
+				value += usec;
+			}
+		}
+		if (*pos != '\0')
+			Elog("value '%s' is not valid for column '%s'",
+				 addr, column->field_name);
+		sql_buffer_setbit(&column->nullmap, row_index);
+		sql_buffer_append(&column->values, &value, sizeof(int64_t));
+	}
+	return __buffer_usage_inline_type(column);
+}
+
+static size_t
+put_variable_value(SQLfield *column, const char *addr, int sz)
+{
+	size_t		row_index = column->nitems++;
+
+	if (row_index == 0)
+		sql_buffer_append_zero(&column->values, sizeof(uint32_t));
+	if (!addr)
+	{
+		column->nullcount++;
+		sql_buffer_clrbit(&column->nullmap, row_index);
+		sql_buffer_append(&column->values,
+						  &column->extra.usage, sizeof(uint32_t));
+	}
+	else
+	{
+		sql_buffer_setbit(&column->nullmap, row_index);
+		sql_buffer_append(&column->extra, addr, sz);
+		sql_buffer_append(&column->values,
+						  &column->extra.usage, sizeof(uint32_t));
+	}
+	return __buffer_usage_varlena_type(column);
+}
+
+/*
+ * csv_setup_attribute
+ */
+static int
+csv_setup_attribute(SQLfield *column, char *name, char *type)
+{
+	int		precision = -1;
+	int		scale = 0;
+
+	memset(column, 0, sizeof(SQLfield));
+	column->field_name = pstrdup(name);
+	if (strcasecmp(type, "int1") == 0 ||
+		strcasecmp(type, "tinyint") == 0)
+	{
+		initArrowNode(&column->arrow_type, Int);
+		column->arrow_type.Int.is_signed = true;
+		column->arrow_type.Int.bitWidth = 8;
+		column->put_value = put_int8_value;
+	}
+	else if (strcasecmp(type, "int2") == 0 ||
+			 strcasecmp(type, "smallint") == 0)
+	{
+		initArrowNode(&column->arrow_type, Int);
+		column->arrow_type.Int.is_signed = true;
+		column->arrow_type.Int.bitWidth = 16;
+		column->put_value = put_int16_value;
+	}
+	else if (strcasecmp(type, "int4") == 0 ||
+			 strcasecmp(type, "int") == 0 ||
+			 strcasecmp(type, "integer") == 0)
+	{
+		initArrowNode(&column->arrow_type, Int);
+		column->arrow_type.Int.is_signed = true;
+		column->arrow_type.Int.bitWidth = 32;
+		column->put_value = put_int32_value;
+	}
+	else if (strcasecmp(type, "int8") == 0 ||
+			 strcasecmp(type, "bigint") == 0)
+	{
+		initArrowNode(&column->arrow_type, Int);
+		column->arrow_type.Int.is_signed = true;
+		column->arrow_type.Int.bitWidth = 64;
+		column->put_value = put_int64_value;
+	}
+	else if (strcasecmp(type, "float4") == 0 ||
+			 strcasecmp(type, "real") == 0)
+	{
+		initArrowNode(&column->arrow_type, FloatingPoint);
+		column->arrow_type.FloatingPoint.precision = ArrowPrecision__Single;
+		column->put_value = put_float32_value;
+	}
+	else if (strcasecmp(type, "float8") == 0 ||
+			 strcasecmp(type, "float") == 0 ||
+			 strcasecmp(type, "double") == 0)
+	{
+		initArrowNode(&column->arrow_type, FloatingPoint);
+		column->arrow_type.FloatingPoint.precision = ArrowPrecision__Double;
+		column->put_value = put_float64_value;
+	}
+	else if (strcasecmp(type, "numeric") == 0 ||
+			 sscanf(type, "numeric(%d,%d)", &precision, &scale) == 2 ||
+			 sscanf(type, "numeric(%d)", &precision) == 1)
+	{
+		if (precision < 0)
+		{
+			precision = 30;
+			scale = 8;
+		}
+		if (precision < 1 || precision > 38 || scale < 0 || scale > precision)
+			Elog("column '%s' has invalid numeric precision/scale (%d,%d)",
+				 name, precision, scale);
+		initArrowNode(&column->arrow_type, Decimal);
+		column->arrow_type.Decimal.precision = precision;
+		column->arrow_type.Decimal.scale = scale;
+		column->arrow_type.Decimal.bitWidth = 128;
+		column->put_value = put_decimal_value;
+	}
+	else if (strcasecmp(type, "bool") == 0 ||
+			 strcasecmp(type, "boolean") == 0)
+	{
+		initArrowNode(&column->arrow_type, Bool);
+		column->put_value = put_bool_value;
+	}
+	else if (strcasecmp(type, "date") == 0)
+	{
+		initArrowNode(&column->arrow_type, Date);
+		column->arrow_type.Date.unit = ArrowDateUnit__Day;
+		column->put_value = put_date_value;
+	}
+	else if (strcasecmp(type, "timestamp") == 0)
+	{
+		initArrowNode(&column->arrow_type, Timestamp);
+		column->arrow_type.Timestamp.unit = ArrowTimeUnit__MicroSecond;
+		column->put_value = put_timestamp_value;
+	}
+	else if (strcasecmp(type, "text") == 0 ||
+			 strcasecmp(type, "varchar") == 0)
+	{
+		initArrowNode(&column->arrow_type, Utf8);
+		column->put_value = put_variable_value;
+		return 3;		/* nullmap + index + extra */
+	}
+	else
+	{
+		Elog("column '%s' has unsupported type '%s'", name, type);
+	}
+	return 2;			/* nullmap + values */
+}
+
+/*
+ * __trim
+ */
+static inline char *
+__trim(char *token)
+{
+	char   *tail = token + strlen(token) - 1;
+
+	while (isspace(*token))
+		token++;
+	while (tail >= token && isspace(*tail))
+		*tail-- = '\0';
+	return token;
+}
+
+/*
+ * csv_create_table
+ *
+ * --schema is a comma separated 'NAME TYPE' list
+ */
+static SQLtable *
+csv_create_table(void)
+{
+	SQLtable   *table;
+	char	   *temp = alloca(strlen(csv_schema) + 1);
+	char	   *tok, *pos;
+	int			nfields = 1;
+
+	for (pos = csv_schema; *pos != '\0'; pos++)
+	{
+		/* do not count the comma inside of numeric(p,s) */
+		if (*pos == '(')
+		{
+			while (*pos != '\0' && *pos != ')')
+				pos++;
+			if (*pos == '\0')
+				break;
+		}
+		else if (*pos == ',')
+			nfields++;
+	}
+	table = palloc0(offsetof(SQLtable, columns[nfields]));
+	table->nfields = nfields;
+	table->segment_sz = batch_segment_sz;
+	table->compression = arrow_compression;
+	table->compression_codec = arrow_compression_codec;
+	table->compression_level = arrow_compression_level;
+
+	strcpy(temp, csv_schema);
+	tok = temp;
+	for (int j=0; j < nfields; j++)
+	{
+		char   *name;
+		char   *type;
+
+		/* cut off the next column definition */
+		for (pos = tok; *pos != '\0' && *pos != ','; pos++)
+		{
+			if (*pos == '(')
+			{
+				while (*pos != '\0' && *pos != ')')
+					pos++;
+				if (*pos == '\0')
+					break;
+			}
+		}
+		if (*pos == ',')
+			*pos++ = '\0';
+		name = __trim(tok);
+		tok = pos;
+		for (type = name; *type != '\0' && !isspace(*type); type++);
+		if (*type == '\0')
+			Elog("--schema: column '%s' has no type", name);
+		*type++ = '\0';
+		type = __trim(type);
+		/* allow 'numeric (p,s)' as well */
+		for (pos = type; *pos != '\0'; pos++)
+		{
+			if (isspace(*pos))
+				memmove(pos, pos+1, strlen(pos));
+		}
+		table->numBuffers += csv_setup_attribute(&table->columns[j],
+												 name, type);
+		table->numFieldNodes++;
+	}
+	return table;
+}
+
+/*
+ * csv_parse_one_row
+ *
+ * It parses a row that begins at 'pos', then returns the position of the
+ * next row. Quoted token may contain delimiters, newlines and the doubled
+ * quotation.
+ */
+static const char *
+csv_parse_one_row(SQLtable *table, SQLbuffer *tokbuf,
+				  const char *pos, const char *tail)
+{
+	size_t		usage = 0;
+	int			j = 0;
+
+	for (;;)
+	{
+		SQLfield   *column;
+		bool		quoted = false;
+		bool		has_quote = false;
+
+		sql_buffer_clear(tokbuf);
+		while (pos < tail)
+		{
+			int		c = *pos;
+
+			if (quoted)
+			{
+				if (c != csv_quote)
+					sql_buffer_append(tokbuf, pos, 1);
+				else if (pos + 1 < tail && pos[1] == csv_quote)
+				{
+					sql_buffer_append(tokbuf, pos, 1);
+					pos++;
+				}
+				else
+					quoted = false;
+			}
+			else if (c == csv_quote)
+				quoted = has_quote = true;
+			else if (c == csv_delimiter || c == '\n' || c == '\r')
+				break;
+			else
+				sql_buffer_append(tokbuf, pos, 1);
+			pos++;
+		}
+		if (quoted)
+			Elog("unterminated quoted token was found at row %zu",
+				 table->nitems);
+		if (j >= table->nfields)
+			Elog("too many columns at row %zu", table->nitems);
+		column = &table->columns[j++];
+		if (!has_quote &&
+			tokbuf->usage == strlen(csv_null) &&
+			memcmp(tokbuf->data, csv_null, tokbuf->usage) == 0)
+		{
+			/* quoted empty string is not NULL */
+			usage += sql_field_put_value(column, NULL, 0);
+		}
+		else
+		{
+			int		sz = tokbuf->usage;
+
+			sql_buffer_append_zero(tokbuf, 1);
+			usage += sql_field_put_value(column, tokbuf->data, sz);
+		}
+		if (pos >= tail || *pos != csv_delimiter)
+			break;
+		pos++;
+	}
+	if (j < table->nfields)
+		Elog("too few columns (%d of %d) at row %zu",
+			 j, table->nfields, table->nitems);
+	if (pos < tail && *pos == '\r')
+		pos++;
+	if (pos < tail && *pos == '\n')
+		pos++;
+	table->nitems++;
+	table->usage = usage;
+
+	return pos;
+}
+
+/*
+ * shows_record_batch_progress
+ */
+static void
+shows_record_batch_progress(const ArrowBlock *block,
+							int rb_index, size_t nitems,
+							uint32_t worker_id)
+{
+	printf("worker:%u RecordBatch[%d]: "
+		   "offset=%lu length=%lu (meta=%u, body=%lu) nitems=%zu\n",
+		   worker_id,
+		   rb_index,
+		   block->offset,
+		   block->metaDataLength + block->bodyLength,
+		   block->metaDataLength,
+		   block->bodyLength,
+		   nitems);
+}
+
+static void
+csv_write_record_batch(SQLtable *data_table, uint32_t worker_id)
+{
+	ArrowBlock	__block;
+	int			__rb_index;
+
+	__rb_index = writeArrowRecordBatchMT(main_table,
+										 data_table,
+										 &main_table_mutex,
+										 &__block);
+	if (shows_progress)
+		shows_record_batch_progress(&__block,
+									__rb_index,
+									data_table->nitems,
+									worker_id);
+	sql_table_clear(data_table);
+}
+
+/*
+ * worker_main
+ */
+static void *
+worker_main(void *__worker_id)
+{
+	uint32_t	worker_id = (uintptr_t)__worker_id;
+	SQLtable   *data_table = csv_create_table();
+	SQLbuffer	tokbuf;
+
+	sql_buffer_init(&tokbuf);
+	for (;;)
+	{
+		csvRange   *range;
+		const char *pos;
+
+		pthread_mutex_lock(&range_mutex);
+		if (next_csv_range >= num_csv_ranges)
+		{
+			pthread_mutex_unlock(&range_mutex);
+			break;
+		}
+		range = &csv_ranges[next_csv_range++];
+		pthread_mutex_unlock(&range_mutex);
+
+		pos = range->head;
+		while (pos < range->tail)
+		{
+			pos = csv_parse_one_row(data_table, &tokbuf, pos, range->tail);
+			if (data_table->usage >= batch_segment_sz)
+				csv_write_record_batch(data_table, worker_id);
+		}
+	}
+	/* write out the remaining rows */
+	if (data_table->nitems > 0)
+		csv_write_record_batch(data_table, worker_id);
+	return NULL;
+}
+
+/*
+ * csv_split_file_ranges
+ *
+ * It walks on the file image to split the ranges at the row boundaries.
+ * Only a newline out of the quoted token is the row boundary, so we cannot
+ * simply seek the newline at the middle of the file.
+ */
+static void
+csv_add_file_range(int file_id, const char *head, const char *tail,
+				   int *p_nrooms)
+{
+	if (num_csv_ranges >= *p_nrooms)
+	{
+		*p_nrooms = 2 * *p_nrooms + 20;
+		csv_ranges = repalloc(csv_ranges, sizeof(csvRange) * *p_nrooms);
+	}
+	csv_ranges[num_csv_ranges].head = head;
+	csv_ranges[num_csv_ranges].tail = tail;
+	csv_ranges[num_csv_ranges].file_id = file_id;
+	num_csv_ranges++;
+}
+
+static void
+csv_split_file_ranges(int file_id, csvFileDesc *cfile, int *p_nrooms)
+{
+	const char *pos = cfile->base;
+	const char *tail = cfile->base + cfile->length;
+	const char *head = pos;
+	size_t		unitsz;
+	bool		quoted = false;
+	bool		header = csv_header;
+
+	unitsz = Max(cfile->length / (4 * num_worker_threads), 1UL << 20);
+	while (pos < tail)
+	{
+		int		c = *pos++;
+
+		/* doubled quotation toggles the state twice */
+		if (c == csv_quote)
+			quoted = !quoted;
+		else if (c == '\n' && !quoted)
+		{
+			if (header)
+			{
+				head = pos;
+				header = false;
+			}
+			else if (pos - head >= unitsz)
+			{
+				csv_add_file_range(file_id, head, pos, p_nrooms);
+				head = pos;
+			}
+		}
+	}
+	if (quoted)
+		Elog("unterminated quoted token in '%s'", cfile->filename);
+	if (!header && head < tail)
+		csv_add_file_range(file_id, head, tail, p_nrooms);
+}
+
+static void
+usage(void)
+{
+	fputs("Usage:\n"
+		  "  csv2arrow [OPTION] CSV_FILE [...]\n\n"
+		  "General options:\n"
+		  "  -o, --output=FILENAME  result file in Apache Arrow format\n"
+		  "  -S, --schema=SCHEMA    comma separated list of 'NAME TYPE'.\n"
+		  "                         TYPE is one of: int1, int2, int4, int8,\n"
+		  "                         float4, float8, numeric[(P[,S])], bool,\n"
+		  "                         text, date, timestamp\n"
+		  "  -n, --num-workers=N_WORKERS  number of the parser threads\n"
+		  "                         (default: number of CPUs)\n"
+		  "      --progress         shows progress of the job\n"
+		  "\n"
+		  "CSV format options:\n"
+		  "      --header           skip the first line of the files\n"
+		  "  -d, --delimiter=CHAR   field delimiter (default: ',')\n"
+		  "  -q, --quote=CHAR       quotation character (default: '\"')\n"
+		  "      --null=STRING      string to be NULL (default: empty string)\n"
+		  "\n"
+		  "Arrow format options:\n"
+		  "  -s, --segment-size=SIZE size of record batch for each\n"
+		  "      --compress=CODEC[:LEVEL] compresses the record batches using\n"
+		  "                        CODEC (lz4 or zstd) with LEVEL, if given.\n"
+		  "\n"
+		  "Other options:\n"
+		  "      --help            shows this message\n"
+		  "\n"
+		  "Report bugs to <pgstrom@heterodb.com>.\n",
+		  stderr);
+	exit(1);
+}
+
+static void
+parse_options(int argc, char * const argv[])
+{
+	static struct option long_options[] = {
+		{"output",       required_argument, NULL, 'o'},
+		{"schema",       required_argument, NULL, 'S'},
+		{"num-workers",  required_argument, NULL, 'n'},
+		{"segment-size", required_argument, NULL, 's'},
+		{"delimiter",    required_argument, NULL, 'd'},
+		{"quote",        required_argument, NULL, 'q'},
+		{"header",       no_argument,       NULL, 1000},
+		{"null",         required_argument, NULL, 1001},
+		{"progress",     no_argument,       NULL, 1002},
+		{"compress",     required_argument, NULL, 1003},
+		{"help",         no_argument,       NULL, 9999},
+		{NULL, 0, NULL, 0},
+	};
+	int		c;
+	char   *pos;
+
+	while ((c = getopt_long(argc, argv, "o:S:n:s:d:q:",
+							long_options, NULL)) >= 0)
+	{
+		switch (c)
+		{
+			case 'o':
+				if (output_filename)
+					Elog("-o, --output was supplied twice");
+				output_filename = optarg;
+				break;
+			case 'S':
+				if (csv_schema)
+					Elog("-S, --schema was supplied twice");
+				csv_schema = optarg;
+				break;
+			case 'n':
+				num_worker_threads = strtol(optarg, &pos, 10);
+				if (*pos != '\0' || num_worker_threads < 1)
+					Elog("invalid -n|--num-workers parameter: %s", optarg);
+				break;
+			case 's':
+				{
+					long	sz = strtol(optarg, &pos, 10);
+
+					if (sz <= 0)
+						Elog("invalid segment size: %s", optarg);
+					else if (*pos == '\0')
+						batch_segment_sz = sz;
+					else if (strcasecmp(pos, "k") == 0 ||
+							 strcasecmp(pos, "kb") == 0)
+						batch_segment_sz = (sz << 10);
+					else if (strcasecmp(pos, "m") == 0 ||
+							 strcasecmp(pos, "mb") == 0)
+						batch_segment_sz = (sz << 20);
+					else if (strcasecmp(pos, "g") == 0 ||
+							 strcasecmp(pos, "gb") == 0)
+						batch_segment_sz = (sz << 30);
+					else
+						Elog("invalid segment size: %s", optarg);
+				}
+				break;
+			case 'd':
+				if (strcmp(optarg, "\\t") == 0)
+					csv_delimiter = '\t';
+				else if (strlen(optarg) == 1)
+					csv_delimiter = *optarg;
+				else
+					Elog("-d, --delimiter must be a single character");
+				break;
+			case 'q':
+				if (strlen(optarg) != 1)
+					Elog("-q, --quote must be a single character");
+				csv_quote = *optarg;
+				break;
+			case 1000:		/* --header */
+				csv_header = true;
+				break;
+			case 1001:		/* --null */
+				csv_null = optarg;
+				break;
+			case 1002:		/* --progress */
+				shows_progress = 1;
+				break;
+			case 1003:		/* --compress */
+				arrow_compression = parseArrowCompressionOption(optarg,
+													&arrow_compression_codec,
+													&arrow_compression_level);
+				break;
+			default:
+				usage();
+				break;
+		}
+	}
+	if (!output_filename)
+		Elog("-o, --output=FILENAME must be given");
+	if (!csv_schema)
+		Elog("-S, --schema=SCHEMA must be given");
+	if (csv_delimiter == csv_quote ||
+		csv_delimiter == '\n' || csv_delimiter == '\r')
+		Elog("unavailable combination of the delimiter and quotation");
+	if (optind >= argc)
+		Elog("no CSV files are given");
+	if (num_worker_threads == 0)
+		num_worker_threads = Max(sysconf(_SC_NPROCESSORS_ONLN), 1);
+	if (batch_segment_sz == 0)
+		batch_segment_sz = (1UL << 28);		/* 256MB in default */
+
+	num_csv_files = argc - optind;
+	csv_files = palloc0(sizeof(csvFileDesc) * num_csv_files);
+	for (int i=0; i < num_csv_files; i++)
+		csv_files[i].filename = argv[optind + i];
+}
+
+int
+main(int argc, char * const argv[])
+{
+	pthread_t  *workers;
+	int			nrooms = 0;
+	int			fdesc;
+
+	parse_options(argc, argv);
+
+	/* map the source files and split to the ranges */
+	for (int i=0; i < num_csv_files; i++)
+	{
+		csvFileDesc *cfile = &csv_files[i];
+		struct stat	st_buf;
+		void	   *base;
+		int			fd;
+
+		fd = open(cfile->filename, O_RDONLY);
+		if (fd < 0)
+			Elog("failed on open('%s'): %m", cfile->filename);
+		if (fstat(fd, &st_buf) != 0)
+			Elog("failed on fstat('%s'): %m", cfile->filename);
+		if (st_buf.st_size > 0)
+		{
+			base = mmap(NULL, st_buf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (base == MAP_FAILED)
+				Elog("failed on mmap('%s'): %m", cfile->filename);
+			madvise(base, st_buf.st_size, MADV_SEQUENTIAL);
+			cfile->base = base;
+			cfile->length = st_buf.st_size;
+			csv_split_file_ranges(i, cfile, &nrooms);
+		}
+		close(fd);
+	}
+
+	/* open the result file and write out the schema */
+	main_table = csv_create_table();
+	fdesc = open(output_filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fdesc < 0)
+		Elog("failed on open('%s'): %m", output_filename);
+	main_table->fdesc = fdesc;
+	main_table->filename = output_filename;
+	arrowFileWrite(main_table, "ARROW1\0\0", 8);
+	writeArrowSchema(main_table);
+
+	/* launch the worker threads */
+	workers = palloc0(sizeof(pthread_t) * num_worker_threads);
+	for (uintptr_t i=0; i < num_worker_threads; i++)
+	{
+		if ((errno = pthread_create(&workers[i], NULL,
+									worker_main, (void *)i)) != 0)
+			Elog("failed on pthread_create: %m");
+	}
+	for (int i=0; i < num_worker_threads; i++)
+	{
+		if ((errno = pthread_join(workers[i], NULL)) != 0)
+			Elog("failed on pthread_join[%d]: %m", i);
+	}
+	/* write out footer portion */
+	writeArrowFooter(main_table);
+	close(main_table->fdesc);
+
+	for (int i=0; i < num_csv_files; i++)
+	{
+		if (csv_files[i].base)
+			munmap((void *)csv_files[i].base, csv_files[i].length);
+	}
+	return 0;
+}
+
+/*
+ * memory allocation handlers
+ */
+void *
+palloc(size_t sz)
+{
+	void   *ptr = malloc(sz);
+
+	if (!ptr)
+		Elog("out of memory");
+	return ptr;
+}
+
+void *
+palloc0(size_t sz)
+{
+	void   *ptr = malloc(sz);
+
+	if (!ptr)
+		Elog("out of memory");
+	memset(ptr, 0, sz);
+	return ptr;
+}
+
+char *
+pstrdup(const char *str)
+{
+	char   *ptr = strdup(str);
+
+	if (!ptr)
+		Elog("out of memory");
+	return ptr;
+}
+
+void *
+repalloc(void *old, size_t sz)
+{
+	char   *ptr = realloc(old, sz);
+
+	if (!ptr)
+		Elog("out of memory");
+	return ptr;
+}
+
+void
+pfree(void *ptr)
+{
+	free(ptr);
+}
@@ -1074,7 +1074,8 @@ sqldb_server_connect(const char *sqldb_hostname,
 					 const char *sqldb_password,
 					 const char *sqldb_database,
 					 userConfigOption *sqldb_session_configs,
-					 nestLoopOption *nestloop_option_list)
+					 nestLoopOption *nestloop_option_list,
+					 bool sqldb_binary_copy)
 {
 	MYSTATE	   *mystate = palloc0(sizeof(MYSTATE));
 	MYSQL	   *conn;
@@ -1086,6 +1087,8 @@ sqldb_server_connect(const char *sqldb_hostname,
 
 	if (nestloop_option_list != NULL)
 		Elog("Bug? mysql2arrow does not support --inner-join/--outer-join");
+	if (sqldb_binary_copy)
+		Elog("Bug? mysql2arrow does not support --binary-copy");
 	
 	conn = mysql_init(NULL);
 	if (!conn)
@@ -1102,6 +1105,17 @@ sqldb_server_connect(const char *sqldb_hostname,
 							NULL, 0))
 		Elog("failed on mysql_real_connect: %s", mysql_error(conn));
 
+	/*
+	 * The results are streamed by mysql_use_result(), so the server side
+	 * waits for the client while it writes out record batches. Extend
+	 * the timeout not to abort the connection by a large batch write.
+	 * (User's config options below can override it.)
+	 */
+	query = "SET SESSION net_write_timeout = 3600";
+	if (mysql_query(conn, query) != 0)
+		Elog("failed on mysql_query('%s'): %s",
+			 query, mysql_error(conn));
+
 	/*
 	 * Preset user's config options
 	 */
@@ -1226,7 +1240,13 @@ sqldb_fetch_results(void *sqldb_state, SQLtable *table)
 
 	row = mysql_fetch_row(mystate->res);
 	if (!row)
+	{
+		/* mysql_use_result() may fail in the middle of the stream */
+		if (mysql_errno(mystate->conn) != 0)
+			Elog("failed on mysql_fetch_row: %s",
+				 mysql_error(mystate->conn));
 		return false;
+	}
 
 	row_sz = mysql_fetch_lengths(mystate->res);
 	for (j=0; j < table->nfields; j++)
@@ -1252,15 +1272,128 @@ sqldb_close_connection(void *sqldb_state)
 	mysql_close(mystate->conn);
 }
 
+/*
+ * __sqldb_build_keyrange_command
+ *
+ * MySQL has no physical row identifier like ctid, so the parallel dump by
+ * -t|--table assigns even ranges of an integer key (the first column of
+ * the primary key, or --split-key) between its min/max values.
+ */
+extern int	parseParallelDistKeys(const char *parallel_dist_keys,
+								  const char *delim);
+static char *
+__sqldb_build_keyrange_command(MYSTATE *mystate,
+							   const char *simple_table_name,
+							   const char *split_key,
+							   int num_worker_threads)
+{
+	MYSQL	   *conn = mystate->conn;
+	MYSQL_RES  *res;
+	MYSQL_ROW	row;
+	char	   *sql = alloca(2 * strlen(simple_table_name) + 1000);
+	char	   *key = NULL;
+	char	   *conds;
+	char	   *pos;
+	char	   *end;
+	long long	lower;
+	long long	upper;
+	double		width;
+
+	if (split_key)
+		key = pstrdup(split_key);
+	else
+	{
+		sprintf(sql, "SHOW KEYS FROM %s"
+				" WHERE Key_name = 'PRIMARY' AND Seq_in_index = 1",
+				simple_table_name);
+		if (mysql_query(conn, sql) != 0)
+			Elog("failed on mysql_query('%s'): %s", sql, mysql_error(conn));
+		res = mysql_store_result(conn);
+		if (!res)
+			Elog("failed on mysql_store_result: %s", mysql_error(conn));
+		if (mysql_num_fields(res) >= 5 &&
+			(row = mysql_fetch_row(res)) != NULL && row[4] != NULL)
+		{
+			key = alloca(strlen(row[4]) + 3);
+			sprintf(key, "`%s`", row[4]);
+			key = pstrdup(key);
+		}
+		mysql_free_result(res);
+		if (!key)
+			Elog("table '%s' has no primary key, use --split-key or -c with $(WORKER_ID) instead",
+				 simple_table_name);
+	}
+
+	/* fetch the range of the key */
+	sql = alloca(2 * strlen(key) + strlen(simple_table_name) + 100);
+	sprintf(sql, "SELECT MIN(%s), MAX(%s) FROM %s",
+			key, key, simple_table_name);
+	if (mysql_query(conn, sql) != 0)
+		Elog("failed on mysql_query('%s'): %s", sql, mysql_error(conn));
+	res = mysql_store_result(conn);
+	if (!res)
+		Elog("failed on mysql_store_result: %s", mysql_error(conn));
+	row = mysql_fetch_row(res);
+	if (!row || mysql_num_fields(res) != 2)
+		Elog("unexpected query result for '%s'", sql);
+	if (!row[0] || !row[1])
+		lower = upper = 0;		/* empty table */
+	else
+	{
+		lower = strtoll(row[0], &end, 10);
+		if (*end != '\0')
+			Elog("split key %s is not an integer column, use -c with $(PARALLEL_KEY) instead", key);
+		upper = strtoll(row[1], &end, 10);
+		if (*end != '\0')
+			Elog("split key %s is not an integer column, use -c with $(PARALLEL_KEY) instead", key);
+	}
+	mysql_free_result(res);
+
+	/* build key-range conditions for each worker */
+	width = ((double)upper - (double)lower + 1.0) / (double)num_worker_threads;
+	pos = conds = alloca((3 * strlen(key) + 100) * num_worker_threads);
+	for (int i=0; i < num_worker_threads; i++)
+	{
+		long long	__lower = lower + (long long)(width * (double)i);
+		long long	__upper = lower + (long long)(width * (double)(i+1));
+
+		if (i > 0)
+			*pos++ = '\t';
+		if (i == 0 && i == num_worker_threads - 1)
+			pos += sprintf(pos, "TRUE");
+		else if (i == 0)
+			pos += sprintf(pos, "(%s < %lld OR %s IS NULL)",
+						   key, __upper, key);
+		else if (i == num_worker_threads - 1)
+			pos += sprintf(pos, "%s >= %lld", key, __lower);
+		else
+			pos += sprintf(pos, "%s >= %lld AND %s < %lld",
+						   key, __lower, key, __upper);
+	}
+	*pos = '\0';
+	parseParallelDistKeys(conds, "\t");
+
+	sql = alloca(strlen(simple_table_name) + 100);
+	sprintf(sql, "SELECT * FROM %s WHERE $(PARALLEL_KEY)",
+			simple_table_name);
+	return pstrdup(sql);
+}
+
 char *
 sqldb_build_simple_command(void *sqldb_state,
 						   const char *simple_table_name,
+						   const char *split_key,
 						   int num_worker_threads,
 						   size_t segment_sz)
 {
 	char   *buf = alloca(strlen(simple_table_name) + 100);
 
-	assert(num_worker_threads == 1);
+	assert(num_worker_threads > 0);
+	if (num_worker_threads > 1)
+		return __sqldb_build_keyrange_command((MYSTATE *)sqldb_state,
+											  simple_table_name,
+											  split_key,
+											  num_worker_threads);
 	sprintf(buf, "SELECT * FROM %s", simple_table_name);
 
 	return pstrdup(buf);
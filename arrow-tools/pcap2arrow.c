@@ -10,7 +10,18 @@
 #include <getopt.h>
 #include <limits.h>
 #include <pcap.h>		/* install libpcap-devel */
+#ifdef WITH_PFRING
 #include <pfring.h>		/* install pfring; see https://packages.ntop.org/ */
+#endif
+#ifdef WITH_AF_XDP
+#include <net/if.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <linux/if_xdp.h>
+#include <xdp/xsk.h>	/* install libxdp-devel */
+#endif
 #include <pthread.h>
 #include <semaphore.h>
 #include <signal.h>
@@ -27,6 +38,16 @@
 #define Assert(x)
 #endif
 
+#ifndef WITH_PFRING
+/* packet header compatible to PF-RING, if not installed */
+struct pfring_pkthdr
+{
+	struct timeval	ts;
+	uint32_t		caplen;
+	uint32_t		len;
+};
+#endif
+
 #define __PCAP_PROTO__IPv4			0x0001
 #define __PCAP_PROTO__IPv6			0x0002
 #define __PCAP_PROTO__TCP			0x0010
@@ -67,6 +88,11 @@ static bool				no_payload = false;
 static bool				composite_options = false;
 static int				print_stat_interval = -1;
 static bool				enable_interface_id = false;	/* for PCAP-NG */
+static bool				arrow_compression = false;
+static int				arrow_compression_codec = 0;
+static int				arrow_compression_level = 0;
+static bool				flow_aggregation = false;		/* --flow */
+static int				flow_timeout = 30;				/* --flow-timeout */
 static __thread uint32_t *current_interface_id = NULL;	/* for PCAP-NG */
 
 /*
@@ -96,9 +122,39 @@ static SQLtable		  **arrow_chunks_array;			/* chunk buffer per-thread */
 static sem_t			pcap_worker_sem;
 
 /* static variable for PF-RING capture mode */
+#ifdef WITH_PFRING
 static pfring		  **pfring_desc_array = NULL;
 static uint64_t			pfring_desc_selector = 0;
-static int				pfring_desc_nums = -1;
+#endif
+static int				pfring_desc_nums = -1;	/* --num-queues; also AF_XDP */
+
+/* static variable for AF_XDP capture mode */
+#ifdef WITH_AF_XDP
+#define XDP_NUM_FRAMES			8192
+#define XDP_FRAME_SIZE			XSK_UMEM__DEFAULT_FRAME_SIZE
+#define XDP_RX_BATCH_SZ			64
+
+typedef struct
+{
+	pthread_mutex_t		lock;		/* only one consumer at a time */
+	void			   *umem_area;
+	size_t				umem_sz;
+	struct xsk_umem	   *umem;
+	struct xsk_socket  *xsk;
+	struct xsk_ring_prod fq;		/* fill ring */
+	struct xsk_ring_cons cq;		/* completion ring (unused) */
+	struct xsk_ring_cons rx;		/* rx ring */
+	uint64_t			recv_count;
+} xdpQueueDesc;
+
+static xdpQueueDesc	   *xdp_desc_array = NULL;
+static uint64_t			xdp_desc_selector = 0;
+#ifdef WITH_PFRING
+static bool				use_af_xdp = false;
+#else
+static bool				use_af_xdp = true;
+#endif
+#endif	/* WITH_AF_XDP */
 
 /* definitions for PCAP/PCAPNG file scan mode */
 #define PCAP_MAGIC_LE		0xd4c3b2a1U
@@ -221,11 +277,13 @@ on_sigint_handler(int signal)
 	int		i;
 
 	do_shutdown = true;
+#ifdef WITH_PFRING
 	if (pfring_desc_array)
 	{
 		for (i=0; i < pfring_desc_nums; i++)
 			pfring_breakloop(pfring_desc_array[i]);
 	}
+#endif
 	if (pcap_file_desc_array)
 	{
 		for (i=0; i < pcap_file_desc_nums; i++)
@@ -337,6 +395,22 @@ put_uint32_value_bswap(SQLfield *column, const char *addr, int sz)
 	return __buffer_usage_inline_type(column);
 }
 
+static size_t
+put_uint64_value(SQLfield *column, const char *addr, int sz)
+{
+	size_t		index = column->nitems++;
+
+	Assert(!addr || sz == sizeof(uint64_t));
+	if (!addr)
+		__put_inline_null_value(column, index, sizeof(uint64_t));
+	else
+	{
+		sql_buffer_setbit(&column->nullmap, index);
+		sql_buffer_append(&column->values, addr, sizeof(uint64_t));
+	}
+	return __buffer_usage_inline_type(column);
+}
+
 static size_t
 put_timestamp_us_value(SQLfield *column, const char *addr, int sz)
 {
@@ -593,6 +667,22 @@ arrowFieldInitAsUint32Bswap(SQLtable *table, int cindex, const char *field_name)
 	table->numBuffers += 2;
 }
 
+static void
+arrowFieldInitAsUint64(SQLtable *table, int cindex, const char *field_name)
+{
+	SQLfield   *column = &table->columns[cindex];
+
+	memset(column, 0, sizeof(SQLfield));
+	initArrowNode(&column->arrow_type, Int);
+	column->arrow_type.Int.bitWidth = 64;
+	column->arrow_type.Int.is_signed = false;
+	column->put_value = put_uint64_value;
+	column->field_name = pstrdup(field_name);
+
+	table->numFieldNodes++;
+	table->numBuffers += 2;
+}
+
 static void
 arrowFieldInitAsTimestampUs(SQLtable *table, int cindex, const char *field_name)
 {
@@ -757,6 +847,11 @@ static int arrow_cindex__icmp_code			= -1;
 static int arrow_cindex__icmp_checksum		= -1;
 /* Payload */
 static int arrow_cindex__payload			= -1;
+/* Flow records (--flow) */
+static int arrow_cindex__first_ts			= -1;
+static int arrow_cindex__last_ts			= -1;
+static int arrow_cindex__packets			= -1;
+static int arrow_cindex__bytes				= -1;
 
 static int
 arrowPcapSchemaInit(SQLtable *table)
@@ -772,6 +867,35 @@ arrowPcapSchemaInit(SQLtable *table)
 		arrowFieldInitAs##__TYPE(table, j++, (#__NAME));	\
 	} while(0)
 
+	/* flow records have its own schema */
+	if (flow_aggregation)
+	{
+		__ARROW_FIELD_INIT(first_ts,	TimestampUs);
+		__ARROW_FIELD_INIT(last_ts,		TimestampUs);
+		if ((protocol_mask & __PCAP_PROTO__IPv4) != 0)
+		{
+			__ARROW_FIELD_INIT(src_addr,	IP4Addr);
+			__ARROW_FIELD_INIT(dst_addr,	IP4Addr);
+		}
+		if ((protocol_mask & __PCAP_PROTO__IPv6) != 0)
+		{
+			__ARROW_FIELD_INIT(src_addr6,	IP6Addr);
+			__ARROW_FIELD_INIT(dst_addr6,	IP6Addr);
+		}
+		__ARROW_FIELD_INIT(protocol,	Uint8);
+		if ((protocol_mask & (__PCAP_PROTO__TCP |
+							  __PCAP_PROTO__UDP)) != 0)
+		{
+			__ARROW_FIELD_INIT(src_port,	Uint16);
+			__ARROW_FIELD_INIT(dst_port,	Uint16);
+		}
+		if ((protocol_mask & __PCAP_PROTO__TCP) != 0)
+			__ARROW_FIELD_INIT(tcp_flags,	Uint16);	/* OR of the packets */
+		__ARROW_FIELD_INIT(packets,		Uint64);
+		__ARROW_FIELD_INIT(bytes,		Uint64);
+		goto out;
+	}
+
 	/* timestamp and mac-address */
     __ARROW_FIELD_INIT(timestamp,	TimestampUs);
     __ARROW_FIELD_INIT(dst_mac,		MacAddr);
@@ -857,6 +981,7 @@ arrowPcapSchemaInit(SQLtable *table)
 	/* remained data - payload */
 	if (!no_payload)
 		__ARROW_FIELD_INIT(payload,		  Binary);
+out:
 #undef __ARROW_FIELD_INIT
 	table->nfields = j;
 
@@ -1836,6 +1961,336 @@ arrowMergeChunkWriteOut(SQLtable *dchunk, SQLtable *schunk)
 	}
 }
 
+/*
+ * Flow aggregation mode (--flow)
+ *
+ * Each worker thread has its own flow table, so packets are aggregated
+ * into the 5-tuple flows without any locks. A flow record is emitted to
+ * the chunk-buffer once it has been idle longer than --flow-timeout, or
+ * when the flow table gets full. Note that a long-lived flow, or a flow
+ * captured by multiple worker threads, may be written out as multiple
+ * records; they should be summarized by GROUP BY on the query side.
+ */
+#define FLOW_TABLE_NSLOTS		(1U << 16)
+#define FLOW_TABLE_NITEMS		(FLOW_TABLE_NSLOTS * 3 / 4)
+
+typedef struct
+{
+	u_char		src_addr[IP6ADDR_LEN];	/* IPv4 uses the first 4 bytes */
+	u_char		dst_addr[IP6ADDR_LEN];
+	uint16_t	src_port;				/* 0, if neither TCP nor UDP */
+	uint16_t	dst_port;
+	uint8_t		protocol;
+	uint8_t		is_ipv6;
+	uint16_t	__padding__;
+} flowKey;
+
+typedef struct
+{
+	flowKey		key;
+	uint32_t	hash;
+	int32_t		next;					/* next entry in the slot, or -1 */
+	uint16_t	tcp_flags;
+	struct timeval first_ts;
+	struct timeval last_ts;
+	uint64_t	packets;
+	uint64_t	bytes;
+} flowEntry;
+
+typedef struct
+{
+	uint32_t	nitems;
+	time_t		last_sweep;
+	int32_t		slots[FLOW_TABLE_NSLOTS];
+	flowEntry	entries[FLOW_TABLE_NITEMS];
+} flowTable;
+
+static __thread flowTable *flow_table = NULL;
+
+static inline uint32_t
+__flowKeyHash(const flowKey *key)
+{
+	const u_char *pos = (const u_char *)key;
+	uint32_t	hash = 2166136261U;		/* FNV-1a */
+	int			i;
+
+	for (i=0; i < sizeof(flowKey); i++)
+	{
+		hash ^= pos[i];
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+/*
+ * __flowTableEmitOne
+ */
+static void
+__flowTableEmitOne(SQLtable *chunk, const flowEntry *entry)
+{
+	__FIELD_PUT_VALUE_DECL;
+	const flowKey *key = &entry->key;
+	bool		has_ports = (key->protocol == 0x06 || key->protocol == 0x11);
+
+	__FIELD_PUT_VALUE(first_ts, &entry->first_ts, sizeof(struct timeval));
+	__FIELD_PUT_VALUE(last_ts,  &entry->last_ts,  sizeof(struct timeval));
+	if ((protocol_mask & __PCAP_PROTO__IPv4) != 0)
+	{
+		if (!key->is_ipv6)
+		{
+			__FIELD_PUT_VALUE(src_addr, key->src_addr, IP4ADDR_LEN);
+			__FIELD_PUT_VALUE(dst_addr, key->dst_addr, IP4ADDR_LEN);
+		}
+		else
+		{
+			__FIELD_PUT_VALUE(src_addr, NULL, 0);
+			__FIELD_PUT_VALUE(dst_addr, NULL, 0);
+		}
+	}
+	if ((protocol_mask & __PCAP_PROTO__IPv6) != 0)
+	{
+		if (key->is_ipv6)
+		{
+			__FIELD_PUT_VALUE(src_addr6, key->src_addr, IP6ADDR_LEN);
+			__FIELD_PUT_VALUE(dst_addr6, key->dst_addr, IP6ADDR_LEN);
+		}
+		else
+		{
+			__FIELD_PUT_VALUE(src_addr6, NULL, 0);
+			__FIELD_PUT_VALUE(dst_addr6, NULL, 0);
+		}
+	}
+	__FIELD_PUT_VALUE(protocol, &key->protocol, sizeof(uint8_t));
+	if ((protocol_mask & (__PCAP_PROTO__TCP |
+						  __PCAP_PROTO__UDP)) != 0)
+	{
+		if (has_ports)
+		{
+			__FIELD_PUT_VALUE(src_port, &key->src_port, sizeof(uint16_t));
+			__FIELD_PUT_VALUE(dst_port, &key->dst_port, sizeof(uint16_t));
+		}
+		else
+		{
+			__FIELD_PUT_VALUE(src_port, NULL, 0);
+			__FIELD_PUT_VALUE(dst_port, NULL, 0);
+		}
+	}
+	if ((protocol_mask & __PCAP_PROTO__TCP) != 0)
+	{
+		if (key->protocol == 0x06)
+		{
+			__FIELD_PUT_VALUE(tcp_flags, &entry->tcp_flags, sizeof(uint16_t));
+		}
+		else
+		{
+			__FIELD_PUT_VALUE(tcp_flags, NULL, 0);
+		}
+	}
+	__FIELD_PUT_VALUE(packets, &entry->packets, sizeof(uint64_t));
+	__FIELD_PUT_VALUE(bytes,   &entry->bytes,   sizeof(uint64_t));
+	chunk->usage = usage;
+	chunk->nitems++;
+}
+
+/*
+ * flowTableSweep
+ *
+ * It emits the flows being idle longer than --flow-timeout (or all the
+ * flows if 'force'), then re-constructs the hash slots by the remaining
+ * ones. If 'write_out', chunk-buffer is written out on the threshold.
+ */
+static void
+flowTableSweep(SQLtable *chunk, time_t curr_sec, bool force, bool write_out)
+{
+	flowTable  *ftable = flow_table;
+	uint32_t	i, nitems = 0;
+
+	if (!ftable)
+		return;
+	memset(ftable->slots, -1, sizeof(ftable->slots));
+	for (i=0; i < ftable->nitems; i++)
+	{
+		flowEntry  *entry = &ftable->entries[i];
+
+		if (force || entry->last_ts.tv_sec + flow_timeout <= curr_sec)
+		{
+			__flowTableEmitOne(chunk, entry);
+			if (write_out && chunk->usage >= record_batch_threshold)
+			{
+				arrowChunkWriteOut(chunk);
+				sql_table_clear(chunk);
+			}
+		}
+		else
+		{
+			flowEntry  *dest = &ftable->entries[nitems];
+			uint32_t	k = entry->hash % FLOW_TABLE_NSLOTS;
+
+			if (dest != entry)
+				memcpy(dest, entry, sizeof(flowEntry));
+			dest->next = ftable->slots[k];
+			ftable->slots[k] = nitems++;
+		}
+	}
+	ftable->nitems = nitems;
+	ftable->last_sweep = curr_sec;
+}
+
+/*
+ * __execFlowOnePacket
+ */
+static inline void
+__execFlowOnePacket(SQLtable *chunk,
+					struct pfring_pkthdr *hdr, const u_char *pos)
+{
+	const u_char   *end = pos + hdr->caplen;
+	flowTable	   *ftable = flow_table;
+	flowEntry	   *entry;
+	flowKey			key;
+	uint16_t		ether_type;
+	uint16_t		tcp_flags = 0;
+	uint32_t		hash, k;
+	int32_t			curr;
+	int				proto;
+
+	if (hdr->caplen < 14)
+		return;		/* not a valid ethernet frame */
+	if (print_stat_interval > 0)
+		atomicAdd64(&stat_raw_packet_length, hdr->len);
+	ether_type = __ntoh16(*((uint16_t *)(pos + 12)));
+	pos += 14;
+
+	memset(&key, 0, sizeof(flowKey));
+	if (ether_type == 0x0800)		/* IPv4 */
+	{
+		int		head_sz;
+
+		if (print_stat_interval > 0)
+			atomicAdd64(&stat_ip4_packet_count, 1);
+		if ((protocol_mask & __PCAP_PROTO__IPv4) == 0 ||
+			end - pos < 20 || (pos[0] & 0xf0) != 0x40)
+			return;
+		head_sz = 4 * (pos[0] & 0x0f);
+		if (head_sz > end - pos)
+			return;
+		proto = pos[9];
+		memcpy(key.src_addr, pos + 12, IP4ADDR_LEN);
+		memcpy(key.dst_addr, pos + 16, IP4ADDR_LEN);
+		pos += head_sz;
+	}
+	else if (ether_type == 0x86dd)	/* IPv6 */
+	{
+		if (print_stat_interval > 0)
+			atomicAdd64(&stat_ip6_packet_count, 1);
+		if ((protocol_mask & __PCAP_PROTO__IPv6) == 0 ||
+			end - pos < 40 || (pos[0] & 0xf0) != 0x60)
+			return;
+		proto = pos[6];
+		memcpy(key.src_addr, pos +  8, IP6ADDR_LEN);
+		memcpy(key.dst_addr, pos + 24, IP6ADDR_LEN);
+		key.is_ipv6 = 1;
+		pos += 40;
+		/* skip the IPv6 options headers */
+		while (end - pos >= 8)
+		{
+			int		sz;
+
+			if (proto ==   0 ||		/* Hop-by-Hop */
+				proto ==  43 ||		/* Routing */
+				proto ==  60 ||		/* Destination Options */
+				proto == 135 ||		/* Mobility */
+				proto == 139 ||		/* Host Identity Protocol */
+				proto == 140)		/* Shim6 Protocol */
+				sz = 8 * pos[1] + 8;
+			else if (proto == 44)	/* Fragment */
+				sz = 8;
+			else if (proto == 51)	/* Authentication Header (AH) */
+				sz = 4 * (pos[1] + 2);
+			else
+				break;
+			if (sz > end - pos)
+				return;
+			proto = pos[0];
+			pos += sz;
+		}
+	}
+	else
+	{
+		/* neither IPv4 nor IPv6 */
+		return;
+	}
+	key.protocol = proto;
+
+	if (proto == 0x06 && (protocol_mask & __PCAP_PROTO__TCP) != 0)
+	{
+		if (print_stat_interval > 0)
+			atomicAdd64(&stat_tcp_packet_count, 1);
+		if (end - pos >= 20)
+		{
+			key.src_port = __ntoh16(*((uint16_t *)(pos + 0)));
+			key.dst_port = __ntoh16(*((uint16_t *)(pos + 2)));
+			tcp_flags = __ntoh16(*((uint16_t *)(pos + 12))) & 0x0fff;
+		}
+	}
+	else if (proto == 0x11 && (protocol_mask & __PCAP_PROTO__UDP) != 0)
+	{
+		if (print_stat_interval > 0)
+			atomicAdd64(&stat_udp_packet_count, 1);
+		if (end - pos >= 8)
+		{
+			key.src_port = __ntoh16(*((uint16_t *)(pos + 0)));
+			key.dst_port = __ntoh16(*((uint16_t *)(pos + 2)));
+		}
+	}
+	else if (proto == 0x01 && (protocol_mask & __PCAP_PROTO__ICMP) != 0)
+	{
+		if (print_stat_interval > 0)
+			atomicAdd64(&stat_icmp_packet_count, 1);
+	}
+
+	/* setup the flow table of this thread on the first call */
+	if (!ftable)
+	{
+		ftable = palloc(sizeof(flowTable));
+		memset(ftable->slots, -1, sizeof(ftable->slots));
+		ftable->nitems = 0;
+		ftable->last_sweep = hdr->ts.tv_sec;
+		flow_table = ftable;
+	}
+	/* expire the idle flows once per second */
+	if (hdr->ts.tv_sec > ftable->last_sweep)
+		flowTableSweep(chunk, hdr->ts.tv_sec, false, false);
+
+	/* lookup the flow */
+	hash = __flowKeyHash(&key);
+	k = hash % FLOW_TABLE_NSLOTS;
+	for (curr = ftable->slots[k]; curr >= 0; curr = entry->next)
+	{
+		entry = &ftable->entries[curr];
+		if (entry->hash == hash &&
+			memcmp(&entry->key, &key, sizeof(flowKey)) == 0)
+			goto found;
+	}
+	/* not found, so add a new flow */
+	if (ftable->nitems >= FLOW_TABLE_NITEMS)
+		flowTableSweep(chunk, hdr->ts.tv_sec, true, false);
+	curr = ftable->nitems++;
+	entry = &ftable->entries[curr];
+	memcpy(&entry->key, &key, sizeof(flowKey));
+	entry->hash = hash;
+	entry->next = ftable->slots[k];
+	entry->tcp_flags = 0;
+	entry->first_ts = hdr->ts;
+	entry->packets = 0;
+	entry->bytes = 0;
+	ftable->slots[k] = curr;
+found:
+	entry->tcp_flags |= tcp_flags;
+	entry->last_ts = hdr->ts;
+	entry->packets++;
+	entry->bytes += hdr->len;
+}
+
 /*
  * __execCaptureOnePacket
  */
@@ -1850,6 +2305,11 @@ __execCaptureOnePacket(SQLtable *chunk,
 	int				src_port = -1;
 	int				dst_port = -1;
 
+	if (flow_aggregation)
+	{
+		__execFlowOnePacket(chunk, hdr, pos);
+		return;
+	}
 	pos = handlePacketRawEthernet(chunk, hdr, pos, &ether_type);
 	if (!pos)
 		goto fillup_by_null;
@@ -1964,6 +2424,7 @@ fillup_by_null:
 	chunk->nitems++;
 }
 
+#ifdef WITH_PFRING
 /*
  * execCapturePackets
  */
@@ -1990,6 +2451,7 @@ execCapturePackets(pfring *pd, SQLtable *chunk)
 	/* interrupted, thus chunk-buffer is partially filled up */
 	return 0;
 }
+#endif	/* WITH_PFRING */
 
 /*
  * final_merge_pending_chunks
@@ -2000,6 +2462,9 @@ final_merge_pending_chunks(SQLtable *chunk)
 	int		phase;
 
 	Assert(worker_id >= 0 && worker_id < num_threads);
+	/* emit the flows remaining in the flow table */
+	if (flow_aggregation)
+		flowTableSweep(chunk, 0, true, true);
 	/* merge pending chunks */
 	for (phase = 0; (worker_id & ((1UL << (phase + 1)) - 1)) == 0; phase++)
 	{
@@ -2029,6 +2494,7 @@ final_merge_pending_chunks(SQLtable *chunk)
 	return NULL;
 }
 
+#ifdef WITH_PFRING
 /*
  * pfring_worker_main
  */
@@ -2073,6 +2539,118 @@ pfring_worker_main(void *__arg)
 	}
 	return final_merge_pending_chunks(chunk);
 }
+#endif	/* WITH_PFRING */
+
+#ifdef WITH_AF_XDP
+/*
+ * execCaptureXdpPackets
+ *
+ * It consumes the rx ring of the AF_XDP socket, then returns the frames
+ * to the fill ring as soon as the packets are copied to the chunk-buffer.
+ */
+static int
+execCaptureXdpPackets(xdpQueueDesc *xd, SQLtable *chunk)
+{
+	struct pfring_pkthdr hdr;
+	uint64_t	addrs[XDP_RX_BATCH_SZ];
+	uint32_t	idx_rx, idx_fq;
+	uint32_t	i, nrecv;
+
+	sql_table_clear(chunk);
+
+	while (!do_shutdown)
+	{
+		nrecv = xsk_ring_cons__peek(&xd->rx, XDP_RX_BATCH_SZ, &idx_rx);
+		if (nrecv == 0)
+		{
+			struct pollfd pfd;
+
+			pfd.fd = xsk_socket__fd(xd->xsk);
+			pfd.events = POLLIN;
+			pfd.revents = 0;
+			if (poll(&pfd, 1, 50) < 0 && errno != EINTR)
+				Elog("failed on poll(2): %m");
+			continue;
+		}
+		/* AF_XDP does not deliver timestamp, so use the receive time */
+		gettimeofday(&hdr.ts, NULL);
+		for (i=0; i < nrecv; i++)
+		{
+			const struct xdp_desc *desc
+				= xsk_ring_cons__rx_desc(&xd->rx, idx_rx + i);
+
+			hdr.caplen = desc->len;
+			hdr.len    = desc->len;
+			__execCaptureOnePacket(chunk, &hdr,
+								   xsk_umem__get_data(xd->umem_area,
+													  desc->addr));
+			addrs[i] = xsk_umem__extract_addr(desc->addr);
+		}
+		xsk_ring_cons__release(&xd->rx, nrecv);
+
+		/* fill ring has enough room for all the frames */
+		if (xsk_ring_prod__reserve(&xd->fq, nrecv, &idx_fq) != nrecv)
+			Elog("failed on xsk_ring_prod__reserve");
+		for (i=0; i < nrecv; i++)
+			*xsk_ring_prod__fill_addr(&xd->fq, idx_fq + i) = addrs[i];
+		xsk_ring_prod__submit(&xd->fq, nrecv);
+		atomicAdd64(&xd->recv_count, nrecv);
+
+		if (chunk->usage >= record_batch_threshold)
+			return 1;	/* write out the buffer */
+	}
+	/* interrupted, thus chunk-buffer is partially filled up */
+	return 0;
+}
+
+/*
+ * xdp_worker_main
+ */
+static void *
+xdp_worker_main(void *__arg)
+{
+	SQLtable   *chunk;
+
+	/* assign worker-id of this thread */
+	worker_id = (long)__arg;
+	chunk = arrow_chunks_array[worker_id];
+
+	while (!do_shutdown)
+	{
+		int		status = -1;
+
+		if (sem_wait(&pcap_worker_sem) != 0)
+		{
+			if (errno == EINTR)
+				continue;
+			Elog("worker-%ld: failed on sem_wait: %m", worker_id);
+		}
+		/*
+		 * Ok, Go to packet capture; rings of AF_XDP socket are single
+		 * consumer, so the queue is locked during the capture.
+		 */
+		if (!do_shutdown)
+		{
+			xdpQueueDesc *xd;
+			int			index;
+
+			index = atomicAdd64(&xdp_desc_selector, 1) % pfring_desc_nums;
+			xd = &xdp_desc_array[index];
+
+			pthreadMutexLock(&xd->lock);
+			status = execCaptureXdpPackets(xd, chunk);
+			pthreadMutexUnlock(&xd->lock);
+			Assert(status >= 0);
+		}
+		if (sem_post(&pcap_worker_sem) != 0)
+            Elog("failed on sem_post: %m");
+
+		if (status > 0)
+			arrowChunkWriteOut(chunk);
+	}
+	return final_merge_pending_chunks(chunk);
+}
+#endif	/* WITH_AF_XDP */
 
 /*
  * process_one_pcap_file
@@ -2816,7 +3394,13 @@ usage(int status)
 		  "OPTIONS:\n"
 		  "  -i|--input=DEVICE\n"
 		  "       specifies a network device to capture packet.\n"
-		  "     --num-queues=N_QUEUE : num of PF-RING queues.\n"
+		  "     --num-queues=N_QUEUE : num of PF-RING / AF_XDP queues.\n"
+#ifdef WITH_AF_XDP
+		  "     --af-xdp : captures packets using AF_XDP socket\n"
+#ifndef WITH_PFRING
+		  "       (default; PF-RING is not supported in this build)\n"
+#endif
+#endif
 		  "  -o|--output=<output file; with format>\n"
 		  "       filename format can contains:\n"
 		  "         %i : interface name\n"
@@ -2835,6 +3419,11 @@ usage(int status)
 		  "       opens multiple output files simultaneously (default: 1)\n"
 		  "     --chunk-size=SIZE : size of record batch (default: 128MB)\n"
 		  "     --direct-io : enables O_DIRECT for write-i/o\n"
+		  "     --compress=CODEC[:LEVEL]\n"
+		  "       compresses record batches using CODEC (lz4 or zstd)\n"
+		  "     --flow : writes out 5-tuple flow records, instead of packets\n"
+		  "     --flow-timeout=SECONDS\n"
+		  "       flow is written out after idle of SECONDS (default: 30)\n"
 		  "  -l|--limit=LIMIT : (default: no limit)\n"
 		  "  -p|--protocol=PROTO\n"
 		  "       PROTO is a comma separated string contains\n"
@@ -2880,6 +3469,12 @@ parse_options(int argc, char *argv[])
 		{"parallel-write", required_argument, NULL, 1005},
 		{"composite-options", no_argument,    NULL, 1006},
 		{"interface-id",   no_argument,       NULL, 1007},
+		{"compress",       required_argument, NULL, 1008},
+#ifdef WITH_AF_XDP
+		{"af-xdp",         no_argument,       NULL, 1009},
+#endif
+		{"flow",           no_argument,       NULL, 1010},
+		{"flow-timeout",   required_argument, NULL, 1011},
 		{"help",           no_argument,       NULL, 'h'},
 		{NULL, 0, NULL, 0}
 	};
@@ -3020,6 +3615,27 @@ parse_options(int argc, char *argv[])
 				enable_interface_id = true;
 				break;
 
+			case 1008:	/* --compress */
+				arrow_compression
+					= parseArrowCompressionOption(optarg,
+												  &arrow_compression_codec,
+												  &arrow_compression_level);
+				break;
+#ifdef WITH_AF_XDP
+			case 1009:	/* --af-xdp */
+				use_af_xdp = true;
+				break;
+#endif
+			case 1010:	/* --flow */
+				flow_aggregation = true;
+				break;
+
+			case 1011:	/* --flow-timeout */
+				flow_timeout = strtol(optarg, &pos, 10);
+				if (*pos != '\0' || flow_timeout < 1)
+					Elog("invalid --flow-timeout argument: %s", optarg);
+				break;
+
 			default:
 				usage(code == 'h' ? 0 : 1);
 				break;
@@ -3030,6 +3646,13 @@ parse_options(int argc, char *argv[])
 	{
 		if (argc != optind)
 			Elog("cannot use input device and PCAP files together");
+#if !defined(WITH_PFRING) && !defined(WITH_AF_XDP)
+		Elog("packet capture from the network device is not supported in this build");
+#endif
+#ifdef WITH_AF_XDP
+		if (use_af_xdp && bpf_filter_rule)
+			Elog("-r|--rule is not supported with AF_XDP capture");
+#endif
 	}
 	else if (optind < argc)
 	{
@@ -3066,6 +3689,14 @@ parse_options(int argc, char *argv[])
 		Elog("No network device or input PCAP/PCAPNG files are given");
 	}
 
+	if (flow_aggregation)
+	{
+		if (enable_interface_id)
+			Elog("--interface-id cannot be used with --flow");
+		if (composite_options)
+			Elog("--composite-options cannot be used with --flow");
+	}
+
 	for (pos = output_filename; *pos != '\0'; pos++)
 	{
 		if (*pos == '%')
@@ -3117,6 +3748,46 @@ parse_options(int argc, char *argv[])
 	}
 }
 
+static void
+__fetch_capture_stats(uint64_t *p_recv_count, uint64_t *p_drop_count)
+{
+	uint64_t	recv_count = 0;
+	uint64_t	drop_count = 0;
+	int			i;
+
+#ifdef WITH_AF_XDP
+	if (use_af_xdp)
+	{
+		for (i=0; i < pfring_desc_nums; i++)
+		{
+			xdpQueueDesc *xd = &xdp_desc_array[i];
+			struct xdp_statistics stat;
+			socklen_t	optlen = sizeof(stat);
+
+			recv_count += atomicRead64(&xd->recv_count);
+			if (getsockopt(xsk_socket__fd(xd->xsk), SOL_XDP, XDP_STATISTICS,
+						   &stat, &optlen) == 0)
+				drop_count += stat.rx_dropped + stat.rx_ring_full;
+		}
+		*p_recv_count = recv_count;
+		*p_drop_count = drop_count;
+		return;
+	}
+#endif
+#ifdef WITH_PFRING
+	for (i=0; i < pfring_desc_nums; i++)
+	{
+		pfring_stat	temp;
+
+		pfring_stats(pfring_desc_array[i], &temp);
+		recv_count += temp.recv;
+		drop_count += temp.drop;
+	}
+#endif
+	*p_recv_count = recv_count;
+	*p_drop_count = drop_count;
+}
+
 static void
 pcap_print_stat(bool is_final_call)
 {
@@ -3127,7 +3798,8 @@ pcap_print_stat(bool is_final_call)
 	static uint64_t last_tcp_packet_count = 0;
 	static uint64_t last_udp_packet_count = 0;
 	static uint64_t last_icmp_packet_count = 0;
-	static pfring_stat last_pfring_stat = {0,0,0};
+	static uint64_t last_recv_count = 0;
+	static uint64_t last_drop_count = 0;
 	uint64_t curr_raw_packet_length = atomicRead64(&stat_raw_packet_length);
 	uint64_t curr_ip4_packet_count = atomicRead64(&stat_ip4_packet_count);
 	uint64_t curr_ip6_packet_count = atomicRead64(&stat_ip6_packet_count);
@@ -3135,21 +3807,15 @@ pcap_print_stat(bool is_final_call)
 	uint64_t curr_udp_packet_count = atomicRead64(&stat_udp_packet_count);
 	uint64_t curr_icmp_packet_count = atomicRead64(&stat_icmp_packet_count);
 	uint64_t diff_raw_packet_length;
-	pfring_stat	curr_pfring_stat, temp;
+	uint64_t	curr_recv_count;
+	uint64_t	curr_drop_count;
 	char		linebuf[1024];
 	char	   *pos = linebuf;
 	time_t		t = time(NULL);
 	struct tm	tm;
-	int			i;
 
 	localtime_r(&t, &tm);
-	pfring_stats(pfring_desc_array[0], &curr_pfring_stat);
-	for (i=1; i < pfring_desc_nums; i++)
-	{
-		pfring_stats(pfring_desc_array[i], &temp);
-		curr_pfring_stat.recv += temp.recv;
-		curr_pfring_stat.drop += temp.drop;
-	}
+	__fetch_capture_stats(&curr_recv_count, &curr_drop_count);
 
 	if (is_final_call)
 	{
@@ -3157,8 +3823,8 @@ pcap_print_stat(bool is_final_call)
 			   "Recv packets: %lu\n"
 			   "Drop packets: %lu\n"
 			   "Total bytes: %lu\n",
-			   curr_pfring_stat.recv,
-			   curr_pfring_stat.drop,
+			   curr_recv_count,
+			   curr_drop_count,
 			   curr_raw_packet_length);
 		if ((protocol_mask & __PCAP_PROTO__IPv4) != 0)
 			printf("IPv4 packets: %lu\n", curr_ip4_packet_count);
@@ -3200,8 +3866,8 @@ pcap_print_stat(bool is_final_call)
 				   tm.tm_hour,
 				   tm.tm_min,
 				   tm.tm_sec,
-				   curr_pfring_stat.recv - last_pfring_stat.recv,
-				   curr_pfring_stat.drop - last_pfring_stat.drop);
+				   curr_recv_count - last_recv_count,
+				   curr_drop_count - last_drop_count);
 	diff_raw_packet_length = curr_raw_packet_length - last_raw_packet_length;
 	if (diff_raw_packet_length < 10000UL)
 		pos += sprintf(pos, "  % 8ldB", diff_raw_packet_length);
@@ -3238,9 +3904,11 @@ pcap_print_stat(bool is_final_call)
 	last_tcp_packet_count	= curr_tcp_packet_count;
 	last_udp_packet_count	= curr_udp_packet_count;
 	last_icmp_packet_count	= curr_icmp_packet_count;
-	last_pfring_stat		= curr_pfring_stat;
+	last_recv_count			= curr_recv_count;
+	last_drop_count			= curr_drop_count;
 }
 
+#ifdef WITH_PFRING
 /*
  * init_pfring_device_input - open the network device using PF-RING
  */
@@ -3299,10 +3967,123 @@ init_pfring_input(void)
 		pfring_desc_array[i] = pd;
 	}
 }
+#endif	/* WITH_PFRING */
+
+#ifdef WITH_AF_XDP
+/*
+ * init_xdp_input - open the network device using AF_XDP sockets; one UMEM
+ * and socket per queue. Zero-copy mode is tried first, then it falls back
+ * to the copy mode if the driver does not support.
+ */
+static void
+__init_xdp_set_promisc(void)
+{
+	struct ifreq ifr;
+	int			sockfd;
+
+	sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+	if (sockfd < 0)
+		Elog("failed on socket(2): %m");
+	memset(&ifr, 0, sizeof(ifr));
+	strncpy(ifr.ifr_name, input_devname, IFNAMSIZ-1);
+	if (ioctl(sockfd, SIOCGIFFLAGS, &ifr) != 0)
+		Elog("failed on ioctl(SIOCGIFFLAGS) on '%s': %m", input_devname);
+	ifr.ifr_flags |= IFF_PROMISC;
+	if (ioctl(sockfd, SIOCSIFFLAGS, &ifr) != 0)
+		Elog("failed on ioctl(SIOCSIFFLAGS) on '%s': %m", input_devname);
+	close(sockfd);
+}
+
+static void
+init_xdp_input(void)
+{
+	int			i, rv;
+
+	__init_xdp_set_promisc();
+	xdp_desc_array = palloc0(sizeof(xdpQueueDesc) * pfring_desc_nums);
+	for (i=0; i < pfring_desc_nums; i++)
+	{
+		xdpQueueDesc *xd = &xdp_desc_array[i];
+		struct xsk_umem_config ucfg;
+		struct xsk_socket_config scfg;
+		uint32_t	idx;
+		uint32_t	k;
+
+		pthreadMutexInit(&xd->lock);
+		xd->umem_sz = (size_t)XDP_NUM_FRAMES * XDP_FRAME_SIZE;
+		xd->umem_area = mmap(NULL, xd->umem_sz,
+							 PROT_READ | PROT_WRITE,
+							 MAP_PRIVATE | MAP_ANONYMOUS,
+							 -1, 0);
+		if (xd->umem_area == MAP_FAILED)
+			Elog("failed on mmap(sz=%zu): %m", xd->umem_sz);
+
+		memset(&ucfg, 0, sizeof(ucfg));
+		ucfg.fill_size = XDP_NUM_FRAMES;
+		ucfg.comp_size = XSK_RING_CONS__DEFAULT_NUM_DESCS;
+		ucfg.frame_size = XDP_FRAME_SIZE;
+		ucfg.frame_headroom = XSK_UMEM__DEFAULT_FRAME_HEADROOM;
+		rv = xsk_umem__create(&xd->umem,
+							  xd->umem_area, xd->umem_sz,
+							  &xd->fq, &xd->cq, &ucfg);
+		if (rv)
+			Elog("failed on xsk_umem__create: %s", strerror(-rv));
+
+		memset(&scfg, 0, sizeof(scfg));
+		scfg.rx_size = XSK_RING_CONS__DEFAULT_NUM_DESCS;
+		scfg.tx_size = 0;
+		scfg.bind_flags = XDP_ZEROCOPY;
+		rv = xsk_socket__create(&xd->xsk, input_devname, i,
+								xd->umem, &xd->rx, NULL, &scfg);
+		if (rv)
+		{
+			scfg.bind_flags = XDP_COPY;
+			rv = xsk_socket__create(&xd->xsk, input_devname, i,
+									xd->umem, &xd->rx, NULL, &scfg);
+			if (rv)
+				Elog("failed on xsk_socket__create(%s, queue=%d): %s",
+					 input_devname, i, strerror(-rv));
+			fprintf(stderr, "pcap2arrow: AF_XDP zero-copy mode is not available on %s (queue=%d), use copy mode instead\n",
+					input_devname, i);
+		}
+		/* all the frames are supplied to the kernel */
+		if (xsk_ring_prod__reserve(&xd->fq, XDP_NUM_FRAMES,
+								   &idx) != XDP_NUM_FRAMES)
+			Elog("failed on xsk_ring_prod__reserve");
+		for (k=0; k < XDP_NUM_FRAMES; k++)
+			*xsk_ring_prod__fill_addr(&xd->fq, idx + k) = (uint64_t)k * XDP_FRAME_SIZE;
+		xsk_ring_prod__submit(&xd->fq, XDP_NUM_FRAMES);
+	}
+}
+#endif	/* WITH_AF_XDP */
+
+/*
+ * init_capture_input - open the network device, then returns the entrypoint
+ * of the worker threads for the capture backend.
+ */
+typedef void *(*workerMainFunc)(void *);
+
+static workerMainFunc
+init_capture_input(void)
+{
+#ifdef WITH_AF_XDP
+	if (use_af_xdp)
+	{
+		init_xdp_input();
+		return xdp_worker_main;
+	}
+#endif
+#ifdef WITH_PFRING
+	init_pfring_input();
+	return pfring_worker_main;
+#endif
+	Elog("packet capture from the network device is not supported in this build");
+}
 
 int main(int argc, char *argv[])
 {
 	pthread_t  *workers;
+	workerMainFunc worker_main = pcap_file_worker_main;
 	long		i, rv;
 
 	/* init misc variables */
@@ -3321,11 +4102,14 @@ int main(int argc, char *argv[])
 								 columns[PCAP_SCHEMA_MAX_NFIELDS]));
 		arrowPcapSchemaInit(chunk);
 		chunk->fdesc = -1;
+		chunk->compression = arrow_compression;
+		chunk->compression_codec = arrow_compression_codec;
+		chunk->compression_level = arrow_compression_level;
 		arrow_chunks_array[i] = chunk;
 	}
 
 	if (input_devname)
-		init_pfring_input();
+		worker_main = init_capture_input();
 
 	/* open the output files, and related initialization */
 	arrow_file_desc_locks = palloc0(sizeof(pthread_mutex_t) * arrow_file_desc_nums);
@@ -3354,14 +4138,12 @@ int main(int argc, char *argv[])
 	for (i=0; i < num_threads; i++)
 	{
 		rv = pthread_create(&workers[i], NULL,
-							input_devname ?
-							pfring_worker_main :
-							pcap_file_worker_main, (void *)i);
+							worker_main, (void *)i);
 		if (rv != 0)
 			Elog("failed on pthread_create: %s", strerror(rv));
 	}
 	/* print statistics */
-	if (pfring_desc_array && print_stat_interval > 0)
+	if (input_devname && print_stat_interval > 0)
 	{
 		sleep(print_stat_interval);
 		while (!do_shutdown)
@@ -8,6 +8,8 @@
  * it under the terms of the PostgreSQL License.
  */
 #include "sql2arrow.h"
+#include <ctype.h>
+#include <endian.h>
 #include <limits.h>
 #include <libpq-fe.h>
 
@@ -50,6 +52,15 @@ typedef struct
 	PGresult   *res;
 	uint32_t	nitems;
 	uint32_t	index;
+	/* if --binary-copy is given */
+	bool		copy_binary;
+	bool		copy_done;
+	char	   *copy_msg;	/* CopyData message allocated by libpq */
+	char	   *copy_data;	/* either copy_msg or copy_temp */
+	size_t		copy_len;
+	size_t		copy_pos;
+	char	   *copy_temp;	/* buffer to join the partial tuple */
+	size_t		copy_temp_sz;
 	/* if --nestloop is given */
 	uint32_t	n_depth;
 	PGSTATE_NL	nestloop[1];
@@ -379,6 +390,205 @@ pgsql_move_next(PGSTATE *pgstate, uint32_t *rows_index)
 	}
 }
 
+/*
+ * Binary COPY protocol
+ *
+ * If --binary-copy is given, pg2arrow runs COPY ... TO STDOUT (FORMAT binary)
+ * instead of FETCH FORWARD on the cursor, then parses the binary COPY frames
+ * and puts the values into the column buffers without materialization of
+ * the PGresult objects. Each datum has the same format as the binary cursor
+ * (typsend output), so the put_value callbacks are shared.
+ */
+#define PGCOPY_SIGNATURE		"PGCOPY\n\377\r\n\0"
+#define PGCOPY_SIGNATURE_SZ		11
+
+static bool
+pgsql_copy_fetch_more(PGSTATE *pgstate)
+{
+	PGconn	   *conn = pgstate->conn;
+	PGresult   *res;
+	char	   *buf;
+	int			len;
+	size_t		remain;
+
+	if (pgstate->copy_done)
+		return false;
+	len = PQgetCopyData(conn, &buf, 0);
+	if (len == -1)
+	{
+		/* end of the COPY */
+		while ((res = PQgetResult(conn)) != NULL)
+		{
+			if (PQresultStatus(res) != PGRES_COMMAND_OK)
+				Elog("failed on COPY TO STDOUT: %s",
+					 PQresultErrorMessage(res));
+			PQclear(res);
+		}
+		pgstate->copy_done = true;
+		return false;
+	}
+	else if (len < 0)
+		Elog("failed on PQgetCopyData: %s", PQerrorMessage(conn));
+
+	remain = pgstate->copy_len - pgstate->copy_pos;
+	if (remain == 0)
+	{
+		/* no partial tuple, so the CopyData message is used as is */
+		if (pgstate->copy_msg)
+			PQfreemem(pgstate->copy_msg);
+		pgstate->copy_msg  = buf;
+		pgstate->copy_data = buf;
+		pgstate->copy_len  = len;
+		pgstate->copy_pos  = 0;
+		return true;
+	}
+	/* elsewhere, join the partial tuple and the CopyData message */
+	if (pgstate->copy_data == pgstate->copy_temp)
+		memmove(pgstate->copy_temp,
+				pgstate->copy_temp + pgstate->copy_pos, remain);
+	if (remain + len > pgstate->copy_temp_sz)
+	{
+		pgstate->copy_temp_sz = (remain + len) * 2;
+		pgstate->copy_temp = repalloc(pgstate->copy_temp,
+									  pgstate->copy_temp_sz);
+	}
+	if (pgstate->copy_data == pgstate->copy_msg)
+	{
+		memcpy(pgstate->copy_temp,
+			   pgstate->copy_msg + pgstate->copy_pos, remain);
+		PQfreemem(pgstate->copy_msg);
+		pgstate->copy_msg = NULL;
+	}
+	memcpy(pgstate->copy_temp + remain, buf, len);
+	PQfreemem(buf);
+	pgstate->copy_data = pgstate->copy_temp;
+	pgstate->copy_len  = remain + len;
+	pgstate->copy_pos  = 0;
+	return true;
+}
+
+/*
+ * pgsql_copy_ensure - ensure @sz bytes from the current position are loaded
+ */
+static inline bool
+pgsql_copy_ensure(PGSTATE *pgstate, size_t sz)
+{
+	while (pgstate->copy_len - pgstate->copy_pos < sz)
+	{
+		if (!pgsql_copy_fetch_more(pgstate))
+			return false;
+	}
+	return true;
+}
+
+static void
+pgsql_copy_begin(PGSTATE *pgstate, const char *sqldb_command)
+{
+	PGconn	   *conn = pgstate->conn;
+	PGresult   *res;
+	char	   *query;
+	char	   *pos;
+	uint32_t	flags;
+	uint32_t	extlen;
+
+	query = palloc(strlen(sqldb_command) + 100);
+	pos = query + sprintf(query, "COPY (%s", sqldb_command);
+	/* trailing semicolon is not allowed in the COPY (query) */
+	while (pos > query && (isspace(pos[-1]) || pos[-1] == ';'))
+		pos--;
+	strcpy(pos, ") TO STDOUT (FORMAT binary)");
+	res = PQexec(conn, query);
+	if (PQresultStatus(res) != PGRES_COPY_OUT)
+		Elog("unable to run COPY TO STDOUT: %s", PQresultErrorMessage(res));
+	PQclear(res);
+	pfree(query);
+
+	/* binary COPY header */
+	if (!pgsql_copy_ensure(pgstate, PGCOPY_SIGNATURE_SZ + 8))
+		Elog("COPY TO STDOUT returned no header");
+	pos = pgstate->copy_data + pgstate->copy_pos;
+	if (memcmp(pos, PGCOPY_SIGNATURE, PGCOPY_SIGNATURE_SZ) != 0)
+		Elog("COPY TO STDOUT returned wrong signature");
+	flags  = be32toh(*((uint32_t *)(pos + PGCOPY_SIGNATURE_SZ)));
+	extlen = be32toh(*((uint32_t *)(pos + PGCOPY_SIGNATURE_SZ + 4)));
+	if ((flags & (1U << 16)) != 0)
+		Elog("COPY TO STDOUT with OIDs is not supported");
+	if (!pgsql_copy_ensure(pgstate, PGCOPY_SIGNATURE_SZ + 8 + extlen))
+		Elog("COPY TO STDOUT returned broken header");
+	pgstate->copy_pos += PGCOPY_SIGNATURE_SZ + 8 + extlen;
+}
+
+static bool
+pgsql_copy_fetch_results(PGSTATE *pgstate, SQLtable *table)
+{
+	const char *pos;
+	size_t		off;
+	size_t		usage = 0;
+	int16_t		nfields;
+	int			i;
+
+	if (!pgsql_copy_ensure(pgstate, sizeof(int16_t)))
+	{
+		if (pgstate->copy_len > pgstate->copy_pos)
+			Elog("COPY TO STDOUT was terminated at the middle of tuple");
+		return false;
+	}
+	pos = pgstate->copy_data + pgstate->copy_pos;
+	nfields = (int16_t)be16toh(*((uint16_t *)pos));
+	if (nfields < 0)
+	{
+		/* file trailer, then wait for the end of COPY */
+		pgstate->copy_pos += sizeof(int16_t);
+		while (pgsql_copy_fetch_more(pgstate))
+			pgstate->copy_pos = pgstate->copy_len;
+		return false;
+	}
+	if (nfields != table->nfields)
+		Elog("COPY TO STDOUT returned %d fields, but %d fields are expected",
+			 nfields, table->nfields);
+
+	/* ensure the whole tuple is loaded */
+	off = sizeof(int16_t);
+	for (i=0; i < nfields; i++)
+	{
+		int32_t		len;
+
+		if (!pgsql_copy_ensure(pgstate, off + sizeof(int32_t)))
+			Elog("COPY TO STDOUT was terminated at the middle of tuple");
+		pos = pgstate->copy_data + pgstate->copy_pos + off;
+		len = (int32_t)be32toh(*((uint32_t *)pos));
+		off += sizeof(int32_t);
+		if (len > 0)
+		{
+			if (!pgsql_copy_ensure(pgstate, off + len))
+				Elog("COPY TO STDOUT was terminated at the middle of tuple");
+			off += len;
+		}
+	}
+
+	/* put the values */
+	pos = pgstate->copy_data + pgstate->copy_pos + sizeof(int16_t);
+	for (i=0; i < nfields; i++)
+	{
+		int32_t		len = (int32_t)be32toh(*((uint32_t *)pos));
+
+		pos += sizeof(int32_t);
+		if (len < 0)
+			usage += sql_field_put_value(&table->columns[i], NULL, 0);
+		else
+		{
+			usage += sql_field_put_value(&table->columns[i], pos, len);
+			pos += len;
+		}
+	}
+	pgstate->copy_pos += off;
+
+	table->usage = usage;
+	table->nitems++;
+
+	return true;
+}
+
 /*
  * pgsql_create_dictionary
  */
@@ -922,7 +1132,8 @@ sqldb_server_connect(const char *sqldb_hostname,
                      const char *sqldb_password,
                      const char *sqldb_database,
                      userConfigOption *session_config_list,
-					 nestLoopOption *sqldb_nestloop_list)
+					 nestLoopOption *sqldb_nestloop_list,
+					 bool sqldb_binary_copy)
 {
 	PGSTATE	   *pgstate;
 	PGconn	   *conn;
@@ -980,6 +1191,7 @@ sqldb_server_connect(const char *sqldb_hostname,
 	pgstate = palloc0(offsetof(PGSTATE, nestloop[n_depth]));
 	pgstate->conn = conn;
 	pgstate->res  = NULL;
+	pgstate->copy_binary = sqldb_binary_copy;
 	pgstate->n_depth = n_depth;
 	for (nlopt = sqldb_nestloop_list, i=0; nlopt; nlopt = nlopt->next, i++)
 	{
@@ -1010,6 +1222,7 @@ sqldb_begin_query(void *sqldb_state,
 	PGSTATE	   *pgstate = sqldb_state;
 	PGconn	   *conn = pgstate->conn;
 	PGresult   *res;
+	SQLtable   *table;
 	char	   *query;
 
 	/* begin read-only transaction */
@@ -1070,9 +1283,16 @@ sqldb_begin_query(void *sqldb_state,
 	pgstate->index  = 0;
 	assert(pgstate->nitems == 0);
 
-	return pgsql_create_buffer(pgstate,
-							   af_info,
-							   dictionary_list);
+	table = pgsql_create_buffer(pgstate,
+								af_info,
+								dictionary_list);
+	/* start COPY TO STDOUT, if --binary-copy */
+	if (pgstate->copy_binary)
+	{
+		assert(pgstate->n_depth == 0);
+		pgsql_copy_begin(pgstate, sqldb_command);
+	}
+	return table;
 }
 
 /*
@@ -1089,6 +1309,9 @@ sqldb_fetch_results(void *sqldb_state, SQLtable *table)
 	int			i, j, ncols;
 	size_t		usage = 0;
 
+	if (pgstate->copy_binary)
+		return pgsql_copy_fetch_results(pgstate, table);
+
 	rows_index = alloca(sizeof(uint32_t) * (pgstate->n_depth + 1));
 	if (!pgsql_move_next(pgstate, rows_index))
 		return false;		/* end of the scan */
@@ -1145,6 +1368,10 @@ sqldb_close_connection(void *sqldb_state)
 
 	if (pgstate->res)
 		PQclear(pgstate->res);
+	if (pgstate->copy_msg)
+		PQfreemem(pgstate->copy_msg);
+	if (pgstate->copy_temp)
+		pfree(pgstate->copy_temp);
 	for (i=0; i < pgstate->n_depth; i++)
 	{
 		PGSTATE_NL *nl = &pgstate->nestloop[i];
@@ -1288,9 +1515,114 @@ __sqldb_build_simple_command(PGSTATE *pgstate,
 	return pstrdup(sql);
 }
 
+/*
+ * __sqldb_build_keyrange_command
+ *
+ * It determines the split points of the key-ranges using percentile_disc()
+ * on the sampled rows, to assign balanced number of rows for each worker.
+ */
+#define KEYRANGE_SAMPLE_BLOCKS_PER_WORKER	256
+
+static char *
+__sqldb_build_keyrange_command(PGSTATE *pgstate,
+							   const char *simple_table_name,
+							   const char *split_key,
+							   int num_worker_threads)
+{
+	PGconn	   *conn = pgstate->conn;
+	PGresult   *res;
+	size_t		bufsz = 2 * strlen(simple_table_name) + strlen(split_key) + 1000;
+	char	   *sql = alloca(bufsz + 30 * num_worker_threads);
+	char	   *pos;
+	char	   *conds;
+	uint64_t	num_blocks;
+	double		ratio = 100.0;
+	size_t		len;
+	int			i, nitems;
+
+	/* number of blocks, including inherited children */
+	sprintf(sql,
+			"WITH RECURSIVE r AS (\n"
+			" SELECT '%s'::regclass t\n"
+			"  UNION ALL\n"
+			" SELECT inhrelid FROM pg_catalog.pg_inherits, r\n"
+			"  WHERE inhparent = r.t\n"
+			")\n"
+			"SELECT sum(pg_relation_size(t))"
+			"     / current_setting('block_size')::int FROM r",
+			simple_table_name);
+	res = PQexec(conn, sql);
+	if (PQresultStatus(res) != PGRES_TUPLES_OK)
+		Elog("failed on [%s]: %s", sql, PQresultErrorMessage(res));
+	num_blocks = atol(PQgetvalue(res, 0, 0));
+	PQclear(res);
+	if (num_blocks > KEYRANGE_SAMPLE_BLOCKS_PER_WORKER * num_worker_threads)
+		ratio = (100.0 * KEYRANGE_SAMPLE_BLOCKS_PER_WORKER *
+				 num_worker_threads) / (double)num_blocks;
+
+	/* fetch the split points */
+	pos = sql;
+	pos += sprintf(pos,
+				   "SELECT quote_literal(v)"
+				   "  FROM unnest((SELECT percentile_disc(ARRAY[");
+	for (i=1; i < num_worker_threads; i++)
+		pos += sprintf(pos, "%s%d.0/%d", (i > 1 ? "," : ""),
+					   i, num_worker_threads);
+	pos += sprintf(pos,
+				   "]::float8[]) WITHIN GROUP (ORDER BY %s)"
+				   "  FROM %s TABLESAMPLE SYSTEM (%.6f)))"
+				   "  WITH ORDINALITY AS x(v,i) ORDER BY i",
+				   split_key, simple_table_name, ratio);
+	res = PQexec(conn, sql);
+	if (PQresultStatus(res) != PGRES_TUPLES_OK)
+		Elog("failed on [%s]: %s", sql, PQresultErrorMessage(res));
+	nitems = PQntuples(res);
+	if (nitems != num_worker_threads - 1)
+		Elog("unable to determine the split points of '%s' (%d of %d)",
+			 split_key, nitems, num_worker_threads - 1);
+	len = 0;
+	for (i=0; i < nitems; i++)
+	{
+		if (PQgetisnull(res, i, 0))
+			Elog("unable to determine the split points of '%s' on the sampled rows",
+				 split_key);
+		if (strchr(PQgetvalue(res, i, 0), '\t') != NULL)
+			Elog("split point of '%s' contains tab character, use -k instead",
+				 split_key);
+		len += 2 * (strlen(split_key) + PQgetlength(res, i, 0)) + 40;
+	}
+
+	/* build key-range conditions for each worker */
+	pos = conds = alloca(len + strlen(split_key) + 100);
+	for (i=0; i < num_worker_threads; i++)
+	{
+		const char *lower = (i > 0 ? PQgetvalue(res, i-1, 0) : NULL);
+		const char *upper = (i < nitems ? PQgetvalue(res, i, 0) : NULL);
+
+		if (i > 0)
+			*pos++ = '\t';
+		if (!lower)
+			pos += sprintf(pos, "(%s < %s OR %s IS NULL)",
+						   split_key, upper, split_key);
+		else if (!upper)
+			pos += sprintf(pos, "%s >= %s", split_key, lower);
+		else
+			pos += sprintf(pos, "%s >= %s AND %s < %s",
+						   split_key, lower, split_key, upper);
+	}
+	*pos = '\0';
+	PQclear(res);
+	parseParallelDistKeys(conds, "\t");
+
+	sprintf(sql, "SELECT * FROM %s WHERE $(PARALLEL_KEY)",
+			simple_table_name);
+	return pstrdup(sql);
+}
+
 char *
 sqldb_build_simple_command(void *sqldb_state,
 						   const char *simple_table_name,
+						   const char *split_key,
 						   int num_worker_threads,
 						   size_t batch_segment_sz)
 {
@@ -1302,6 +1634,11 @@ sqldb_build_simple_command(void *sqldb_state,
 		sprintf(buf, "SELECT * FROM %s", simple_table_name);
 		return pstrdup(buf);
 	}
+	if (split_key)
+		return __sqldb_build_keyrange_command((PGSTATE *)sqldb_state,
+											  simple_table_name,
+											  split_key,
+											  num_worker_threads);
 	return __sqldb_build_simple_command((PGSTATE *)sqldb_state,
 										simple_table_name,
 										num_worker_threads,
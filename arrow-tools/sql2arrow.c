@@ -31,11 +31,21 @@ static char	   *sqldb_password = NULL;
 static char	   *sqldb_database = NULL;
 static char	   *dump_arrow_filename = NULL;
 static char	   *stat_embedded_columns = NULL;
+static char	   *dictionary_columns = NULL;
+static char	   *sort_by_keys = NULL;
 static int		num_worker_threads = 0;
 static char	   *parallel_dist_keys = NULL;
+static char	   *parallel_split_key = NULL;
 static int		shows_progress = 0;
 static userConfigOption *sqldb_session_configs = NULL;
 static nestLoopOption *sqldb_nestloop_options = NULL;
+static bool		sqldb_binary_copy = false;
+static char	   *arrow_compression_option = NULL;
+static bool		arrow_compression = false;
+static int		arrow_compression_codec = 0;
+static int		arrow_compression_level = 0;
+static int		async_write_depth = 0;		/* --async-write */
+static bool		enable_direct_io = false;	/* --direct-io */
 
 /*
  * Per-worker state variables
@@ -47,6 +57,7 @@ static pthread_t	   *worker_threads;
 static SQLtable		  **worker_tables;
 static const char	  **worker_dist_keys = NULL;
 static pthread_mutex_t	main_table_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t	dictionary_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 /*
  * __trim
@@ -580,6 +591,206 @@ enable_embedded_stats(SQLtable *table)
 	}
 }
 
+/*
+ * Dictionary encoding of text columns
+ *
+ * Unlike enum types, dictionary of the text column is built on the fly,
+ * and shared by all the worker threads; so it has to be updated under
+ * the dictionary_mutex. DictionaryBatches are written out at the end.
+ */
+#define TEXT_DICTIONARY_ID_BASE		(1L << 32)	/* no conflicts to enum oid */
+#define TEXT_DICTIONARY_NSLOTS		8192
+
+static uint32_t
+__lookupTextDictionary(SQLdictionary *dict, const char *addr, int sz)
+{
+	hashItem   *hitem;
+	uint32_t	hash, hindex;
+
+	hash = hash_any((const unsigned char *)addr, sz);
+	hindex = hash % dict->nslots;
+	pthread_mutex_lock(&dictionary_mutex);
+	for (hitem = dict->hslots[hindex]; hitem != NULL; hitem = hitem->next)
+	{
+		if (hitem->hash == hash &&
+			hitem->label_sz == sz &&
+			memcmp(hitem->label, addr, sz) == 0)
+			break;
+	}
+	if (!hitem)
+	{
+		if (dict->nitems >= INT_MAX)
+			Elog("too many distinct values for dictionary encoding");
+		hitem = palloc0(offsetof(hashItem, label[sz+1]));
+		hitem->hash = hash;
+		hitem->index = dict->nitems++;
+		hitem->label_sz = sz;
+		memcpy(hitem->label, addr, sz);
+
+		hitem->next = dict->hslots[hindex];
+		dict->hslots[hindex] = hitem;
+
+		sql_buffer_append(&dict->extra, addr, sz);
+		sql_buffer_append(&dict->values,
+						  &dict->extra.usage, sizeof(uint32_t));
+	}
+	pthread_mutex_unlock(&dictionary_mutex);
+
+	return hitem->index;
+}
+
+static size_t
+put_text_dictionary_value(SQLfield *column, const char *addr, int sz)
+{
+	size_t		row_index = column->nitems++;
+	uint32_t	index = 0;
+
+	if (!addr)
+	{
+		column->nullcount++;
+		sql_buffer_clrbit(&column->nullmap, row_index);
+	}
+	else
+	{
+		index = __lookupTextDictionary(column->enumdict, addr, sz);
+		sql_buffer_setbit(&column->nullmap, row_index);
+	}
+	sql_buffer_append(&column->values, &index, sizeof(uint32_t));
+	return __buffer_usage_inline_type(column);
+}
+
+static size_t
+move_text_dictionary_value(SQLfield *dest, const SQLfield *src, long sindex)
+{
+	size_t		row_index = dest->nitems++;
+	uint32_t	index = 0;
+
+	assert(dest->enumdict == src->enumdict);
+	if (!sql_buffer_getbit(&src->nullmap, sindex))
+	{
+		dest->nullcount++;
+		sql_buffer_clrbit(&dest->nullmap, row_index);
+	}
+	else
+	{
+		index = ((uint32_t *)src->values.data)[sindex];
+		sql_buffer_setbit(&dest->nullmap, row_index);
+	}
+	sql_buffer_append(&dest->values, &index, sizeof(uint32_t));
+	return __buffer_usage_inline_type(dest);
+}
+
+static void
+__enable_field_dictionary(SQLtable *table, SQLfield *field, int64_t dict_id)
+{
+	SQLdictionary *dict;
+
+	if (field->arrow_type.node.tag != ArrowNodeTag__Utf8 ||
+		field->enumdict != NULL)
+		Elog("field [%s; %s] does not support dictionary encoding",
+			 field->field_name, field->arrow_type.node.tagName);
+
+	for (dict = table->sql_dict_list; dict != NULL; dict = dict->next)
+	{
+		if (dict->dict_id == dict_id)
+			break;
+	}
+	if (!dict)
+	{
+		dict = palloc0(offsetof(SQLdictionary,
+								hslots[TEXT_DICTIONARY_NSLOTS]));
+		dict->dict_id = dict_id;
+		sql_buffer_init(&dict->values);
+		sql_buffer_init(&dict->extra);
+		sql_buffer_append_zero(&dict->values, sizeof(uint32_t));
+		dict->nslots = TEXT_DICTIONARY_NSLOTS;
+
+		dict->next = table->sql_dict_list;
+		table->sql_dict_list = dict;
+	}
+	field->enumdict = dict;
+	field->put_value = put_text_dictionary_value;
+	field->move_value = move_text_dictionary_value;
+	table->numBuffers--;		/* nullmap + index, no extra buffer */
+}
+
+static void
+enable_dictionary_encoding(SQLtable *table, SQLtable *main_table)
+{
+	char	   *buffer;
+	char	   *name, *pos;
+	int			j;
+
+	/* worker table follows the main table */
+	if (main_table)
+	{
+		for (j=0; j < table->nfields; j++)
+		{
+			SQLfield   *field = &main_table->columns[j];
+
+			if (field->put_value == put_text_dictionary_value)
+				__enable_field_dictionary(table, &table->columns[j],
+										  field->enumdict->dict_id);
+		}
+		return;
+	}
+	/* disabled? */
+	if (!dictionary_columns)
+		return;
+
+	/* special case - all the text columns? */
+	if (strcmp(dictionary_columns, "*") == 0)
+	{
+		for (j=0; j < table->nfields; j++)
+		{
+			SQLfield   *field = &table->columns[j];
+
+			if (field->arrow_type.node.tag == ArrowNodeTag__Utf8 &&
+				field->enumdict == NULL)
+				__enable_field_dictionary(table, field,
+										  TEXT_DICTIONARY_ID_BASE + j);
+		}
+		return;
+	}
+
+	/* elsewhere, enables dictionary for each column specified */
+	buffer = alloca(strlen(dictionary_columns) + 1);
+	strcpy(buffer, dictionary_columns);
+	for (name = strtok_r(buffer, ",", &pos);
+		 name != NULL;
+		 name = strtok_r(NULL, ",", &pos))
+	{
+		bool	found = false;
+
+		name = __trim(name);
+		for (j=0; j < table->nfields; j++)
+		{
+			SQLfield   *field = &table->columns[j];
+
+			if (strcmp(field->field_name, name) == 0)
+			{
+				__enable_field_dictionary(table, field,
+										  TEXT_DICTIONARY_ID_BASE + j);
+				found = true;
+			}
+		}
+		if (!found)
+			Elog("field name [%s], specified by --dictionary option, was not found",
+				 name);
+	}
+}
+
+static void
+setup_body_compression(SQLtable *table)
+{
+	table->compression = arrow_compression;
+	if (arrow_compression)
+	{
+		table->compression_codec = arrow_compression_codec;
+		table->compression_level = arrow_compression_level;
+	}
+}
+
 static void
 usage(void)
 {
@@ -607,6 +818,16 @@ usage(void)
 #ifdef __PG2ARROW__
 		  "      --inner-join=SUB_COMMAND\n"
 		  "      --outer-join=SUB_COMMAND\n"
+		  "      --binary-copy     fetches the results using COPY TO STDOUT in\n"
+		  "                        binary format, instead of the binary cursor.\n"
+		  "                        (It is exclusive with --inner/outer-join.)\n"
+		  "      --split-key=KEY   assigns balanced key-ranges of KEY to the workers\n"
+		  "                        on -t and -n, according to the sampled rows.\n"
+#endif
+#ifdef __MYSQL2ARROW__
+		  "      --split-key=KEY   assigns even key-ranges of KEY (integer column)\n"
+		  "                        to the workers on -t and -n. (default: the\n"
+		  "                        first column of the primary key)\n"
 #endif
 		  "  -o, --output=FILENAME result file in Apache Arrow format\n"
 		  "      --append=FILENAME result Apache Arrow file to be appended\n"
@@ -615,9 +836,20 @@ usage(void)
 		  "  -S, --stat[=COLUMNS] embeds min/max statistics for each record batch\n"
 		  "                       COLUMNS is a comma-separated list of the target\n"
 		  "                       columns if partially enabled.\n"
+		  "      --sort-by=KEYS   sorts the results by KEYS (ORDER BY clause)\n"
+		  "                       prior to write out record batches.\n"
 		  "\n"
 		  "Arrow format options:\n"
 		  "  -s, --segment-size=SIZE size of record batch for each\n"
+		  "      --compress=CODEC[:LEVEL] compresses the record batches using\n"
+		  "                        CODEC (lz4 or zstd) with LEVEL, if given.\n"
+		  "      --dictionary=COLUMNS writes out the text columns using\n"
+		  "                        dictionary encoding. COLUMNS is a comma-\n"
+		  "                        separated list, or '*' for all text columns.\n"
+		  "      --async-write[=DEPTH] writes record batches by a dedicated\n"
+		  "                        writer thread with DEPTH queue (default: 4)\n"
+		  "      --direct-io       writes record batches using O_DIRECT\n"
+		  "                        (implies --async-write)\n"
 		  "\n"
 		  "Connection options:\n"
 		  "  -h, --host=HOSTNAME  database server host\n"
@@ -667,6 +899,13 @@ parse_options(int argc, char * const argv[])
 		{"set",          required_argument, NULL, 1003},
 		{"inner-join",   required_argument, NULL, 1004},
 		{"outer-join",   required_argument, NULL, 1005},
+		{"binary-copy",  no_argument,       NULL, 1006},
+		{"split-key",    required_argument, NULL, 1009},
+		{"compress",     required_argument, NULL, 1007},
+		{"dictionary",   required_argument, NULL, 1008},
+		{"sort-by",      required_argument, NULL, 1010},
+		{"async-write",  optional_argument, NULL, 1011},
+		{"direct-io",    no_argument,       NULL, 1012},
 		{"stat",         optional_argument, NULL, 'S'},
 		{"num-workers",  required_argument, NULL, 'n'},
 		{"parallel-keys",required_argument, NULL, 'k'},
@@ -866,7 +1105,15 @@ parse_options(int argc, char * const argv[])
 					last_nest_loop = nlopt;
 				}
 				break;
+			case 1006:		/* --binary-copy */
+				sqldb_binary_copy = true;
+				break;
 #endif	/* __PG2ARROW__ */
+			case 1009:		/* --split-key */
+				if (parallel_split_key)
+					Elog("--split-key option was supplied twice");
+				parallel_split_key = optarg;
+				break;
 			case 'S':		/* --stat */
 				{
 					if (stat_embedded_columns)
@@ -877,6 +1124,42 @@ parse_options(int argc, char * const argv[])
 						stat_embedded_columns = "*";
 				}
 				break;
+			case 1007:		/* --compress */
+				if (arrow_compression_option)
+					Elog("--compress option was supplied twice");
+				arrow_compression_option = optarg;
+				arrow_compression
+					= parseArrowCompressionOption(optarg,
+												  &arrow_compression_codec,
+												  &arrow_compression_level);
+				break;
+			case 1008:		/* --dictionary */
+				if (dictionary_columns)
+					Elog("--dictionary option was supplied twice");
+				dictionary_columns = optarg;
+				break;
+			case 1010:		/* --sort-by */
+				if (sort_by_keys)
+					Elog("--sort-by option was supplied twice");
+				sort_by_keys = optarg;
+				break;
+			case 1011:		/* --async-write */
+				if (async_write_depth > 0)
+					Elog("--async-write option was supplied twice");
+				if (!optarg)
+					async_write_depth = 4;
+				else
+				{
+					char   *end;
+
+					async_write_depth = strtol(optarg, &end, 10);
+					if (*end != '\0' || async_write_depth < 1)
+						Elog("not a valid --async-write option: %s", optarg);
+				}
+				break;
+			case 1012:		/* --direct-io */
+				enable_direct_io = true;
+				break;
 			case 9999:		/* --help */
 			default:
 				usage();
@@ -916,6 +1199,14 @@ parse_options(int argc, char * const argv[])
 	}
 	if (!simple_table_name &&!sqldb_command)
 		Elog("Neither -c nor -t options are supplied");
+	if (sqldb_binary_copy && sqldb_nestloop_options)
+		Elog("--binary-copy is exclusive with --inner-join and --outer-join");
+	if (parallel_split_key && (!simple_table_name || num_worker_threads < 2))
+		Elog("--split-key requires -t|--table and -n|--num-workers larger than 1");
+	if (enable_direct_io && async_write_depth == 0)
+		async_write_depth = 4;
+	if (dictionary_columns && append_filename)
+		Elog("--dictionary is exclusive with --append; dictionary encoding follows the schema of the file to be appended");
 	assert((simple_table_name && !sqldb_command) ||
 		   (!simple_table_name && sqldb_command));
 	if (parallel_dist_keys)
@@ -957,12 +1248,6 @@ parse_options(int argc, char * const argv[])
 			/* -t TABLE without -n option */
 			num_worker_threads = 1;
 		}
-#ifndef __PG2ARROW__
-		else if (num_worker_threads > 1)
-		{
-			Elog("-t|--table with parallel execution is not supported");
-		}
-#endif
 	}
 	/* default segment size */
 	if (batch_segment_sz == 0)
@@ -1185,7 +1470,8 @@ worker_main(void *__worker_id)
 									  sqldb_password,
 									  sqldb_database,
 									  sqldb_session_configs,
-									  sqldb_nestloop_options);
+									  sqldb_nestloop_options,
+									  sqldb_binary_copy);
 	worker_command = sqldb_command_apply_worker_id(sqldb_command, worker_id);
 	if (shows_progress)
 		printf("worker:%lu SQL=[%s]\n", worker_id, worker_command);
@@ -1196,6 +1482,9 @@ worker_main(void *__worker_id)
 	if (!data_table)
 		Elog("Empty results by the query: %s", worker_command);
 	data_table->segment_sz = batch_segment_sz;
+	setup_body_compression(data_table);
+	/* enables dictionary encoding, if any */
+	enable_dictionary_encoding(data_table, main_table);
 	/* enables embedded min/max statistics, if any */
 	enable_embedded_stats(data_table);
 	/* check compatibility */
@@ -1253,7 +1542,8 @@ int main(int argc, char * const argv[])
 									  sqldb_password,
 									  sqldb_database,
 									  sqldb_session_configs,
-									  sqldb_nestloop_options);
+									  sqldb_nestloop_options,
+									  sqldb_binary_copy);
 	/* read the original arrow file, if --append mode */
 	if (append_filename)
 	{
@@ -1269,11 +1559,30 @@ int main(int argc, char * const argv[])
 		assert(!sqldb_command);
 		sqldb_command = sqldb_build_simple_command(sqldb_conn,
 												   simple_table_name,
+												   parallel_split_key,
 												   num_worker_threads,
 												   batch_segment_sz);
 		if (!sqldb_command)
 			Elog("out of memory");
 	}
+	/*
+	 * --sort-by wraps the SQL command by ORDER BY; the database server
+	 * runs external sort (spilled to temporary files if needed), so each
+	 * record batch has tight range of the sort keys for min/max stats.
+	 */
+	if (sort_by_keys)
+	{
+		int		len = strlen(sqldb_command);
+		char   *buf = palloc(len + strlen(sort_by_keys) + 100);
+
+		/* trim the trailing semicolon, if any */
+		while (len > 0 && (isspace(sqldb_command[len-1]) ||
+						   sqldb_command[len-1] == ';'))
+			len--;
+		sprintf(buf, "SELECT * FROM (%.*s) __sort_subq ORDER BY %s",
+				len, sqldb_command, sort_by_keys);
+		sqldb_command = buf;
+	}
 	/* begin SQL command execution */
 	main_command = sqldb_command_apply_worker_id(sqldb_command, 0);
 	if (shows_progress)
@@ -1285,6 +1594,9 @@ int main(int argc, char * const argv[])
 	if (!table)
 		Elog("Empty results by the query: %s", sqldb_command);
 	table->segment_sz = batch_segment_sz;
+	setup_body_compression(table);
+	/* enables dictionary encoding, if any */
+	enable_dictionary_encoding(table, NULL);
 	/* enables embedded min/max statistics, if any */
 	enable_embedded_stats(table);
 
@@ -1307,8 +1619,9 @@ int main(int argc, char * const argv[])
 		table->filename = append_filename;
 		setup_append_file(table, &af_info);
 	}
-	/* write out dictionary batch, if any */
-	writeArrowDictionaryBatches(table);
+	/* launch the dedicated writer thread, if any */
+	if (async_write_depth > 0)
+		arrowAsyncWriterStart(table, async_write_depth, enable_direct_io);
 	/* the primary SQLtable become visible to other workers */
 	pthread_mutex_lock(&worker_setup_mutex);
 	worker_tables[0] = table;
@@ -1322,7 +1635,11 @@ int main(int argc, char * const argv[])
 		ArrowBlock	__block;
 		int			__rb_index;
 
-		__rb_index = writeArrowRecordBatch(table, &__block);
+		/* all the workers are done, but writer thread may be working */
+		__rb_index = writeArrowRecordBatchMT(table,
+											 table,
+											 &main_table_mutex,
+											 &__block);
 		if (shows_progress)
 			shows_record_batch_progress(&__block,
 										__rb_index,
@@ -1330,6 +1647,14 @@ int main(int argc, char * const argv[])
 										0);
 		sql_table_clear(table);
 	}
+	/* wait for completion of the pending writes */
+	arrowAsyncWriterStop(table);
+	/*
+	 * write out dictionary batch, if any. Dictionary of text columns
+	 * are built during the dump, so they are written after all the
+	 * record batches, then referenced from the footer.
+	 */
+	writeArrowDictionaryBatches(table);
 	/* write out footer portion */
 	writeArrowFooter(table);
 
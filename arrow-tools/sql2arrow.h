@@ -28,7 +28,8 @@ sqldb_server_connect(const char *sqldb_hostname,
 					 const char *sqldb_password,
 					 const char *sqldb_database,
 					 userConfigOption *session_config_list,
-					 nestLoopOption *nestloop_option_list);
+					 nestLoopOption *nestloop_option_list,
+					 bool sqldb_binary_copy);
 
 extern SQLtable *
 sqldb_begin_query(void *sqldb_state,
@@ -44,6 +45,7 @@ sqldb_close_connection(void *sqldb_state);
 extern char *
 sqldb_build_simple_command(void *sqldb_state,
 						   const char *simple_table_name,
+						   const char *split_key,
 						   int num_worker_threads,
 						   size_t batch_segment_sz);
 /* misc functions */
@@ -10,7 +10,9 @@
  * it under the terms of the PostgreSQL License.
  */
 #include <ruby.h>
+#include <ruby/thread.h>
 #include <ctype.h>
+#include <errno.h>
 #include <libgen.h>
 #include <sys/file.h>
 #include "float2.h"
@@ -76,17 +78,24 @@ rb_puts(VALUE obj)
 
 /*
  * memory allocation wrapper
+ *
+ * NOTE: arrow_write.c allocates the buffer during the record-batch write
+ * without GVL, so we cannot use ruby_xmalloc() that may invoke GC.
  */
 void *
 palloc(size_t sz)
 {
-	return ruby_xmalloc(sz);
+	void   *ptr = malloc(sz);
+
+	if (!ptr)
+		Elog("out of memory (sz=%zu)", sz);
+	return ptr;
 }
 
 void *
 palloc0(size_t sz)
 {
-	void   *ptr = ruby_xmalloc(sz);
+	void   *ptr = palloc(sz);
 
 	memset(ptr, 0, sz);
 
@@ -118,13 +127,17 @@ pstrdup_ruby(VALUE datum)
 void *
 repalloc(void *old, size_t sz)
 {
-	return ruby_xrealloc(old, sz);
+	void   *ptr = realloc(old, sz);
+
+	if (!ptr)
+		Elog("out of memory (sz=%zu)", sz);
+	return ptr;
 }
 
 void
 pfree(void *ptr)
 {
-	ruby_xfree(ptr);
+	free(ptr);
 }
 
 /* ----------------------------------------------------------------
@@ -1569,6 +1582,7 @@ __arrowFileWriteParseParams(VALUE self,
 	VALUE		ts_column = Qnil;
 	VALUE		tag_column = Qnil;
 	long		f_threshold = 10000;
+	long		rb_threshold = 64;
 	int			i, count;
 
 	if (CLASS_OF(__params) == rb_cHash)
@@ -1592,6 +1606,16 @@ __arrowFileWriteParseParams(VALUE self,
 			if (f_threshold < 16 || f_threshold > 1048576)
 				Elog("filesize_threshold must be [16...1048576]");
 		}
+
+		datum = rb_funcall(__params, rb_intern("fetch"), 2,
+						   rb_str_new_cstr("record_batch_size"), Qnil);
+		if (datum != Qnil)
+		{
+			datum = rb_funcall(datum, rb_intern("to_i"), 0);
+			rb_threshold = NUM2LONG(datum);
+			if (rb_threshold < 1 || rb_threshold > 1024)
+				Elog("record_batch_size must be [1...1024]");
+		}
 	}
 	else if (__params != Qnil)
 		Elog("ArrowFileWrite: parameters must be Hash");
@@ -1624,6 +1648,8 @@ __arrowFileWriteParseParams(VALUE self,
 	}
 	rb_ivar_set(self, rb_intern("filesize_threshold"),
 				LONG2NUM(f_threshold << 20));
+	rb_ivar_set(self, rb_intern("record_batch_size"),
+				LONG2NUM(rb_threshold << 20));
 }
 
 static VALUE
@@ -1721,6 +1747,66 @@ arrowFileCloseFile(SQLtable *table)
 	}
 }
 
+/*
+ * Routines invoked without GVL
+ *
+ * flock(2) may wait for the concurrent writers for a long time, and the
+ * record-batch / footer assembly is pure C code, so we release GVL during
+ * these steps. It allows other flush threads to convert the next buffer
+ * chunks in parallel.
+ * NOTE: Elog() of arrow_write.c never touches Ruby objects.
+ */
+typedef struct
+{
+	int			fdesc;
+	int			retval;
+	int			errcode;
+} LockFileArgs;
+
+static void *
+__arrowFileLockFileNoGVL(void *__args)
+{
+	LockFileArgs *args = (LockFileArgs *)__args;
+
+	args->retval = flock(args->fdesc, LOCK_EX);
+	args->errcode = errno;
+	return NULL;
+}
+
+static void
+arrowFileLockFile(SQLtable *table)
+{
+	LockFileArgs args;
+
+	args.fdesc = table->fdesc;
+	for (;;)
+	{
+		rb_thread_call_without_gvl(__arrowFileLockFileNoGVL, &args,
+								   RUBY_UBF_IO, NULL);
+		if (args.retval == 0)
+			break;
+		if (args.errcode != EINTR)
+		{
+			errno = args.errcode;
+			Elog("failed on flock('%s'): %m", table->filename);
+		}
+		rb_thread_check_ints();
+	}
+}
+
+static void *
+__arrowFileWriteRecordBatchNoGVL(void *__table)
+{
+	SQLtable   *table = (SQLtable *)__table;
+
+	/* write out a new record-batch */
+	writeArrowRecordBatch(table, NULL);
+	/* write out a new footer */
+	writeArrowFooter(table);
+
+	return NULL;
+}
+
 static bool
 arrowFileOpenFile(VALUE self, SQLtable *table)
 {
@@ -1806,8 +1892,7 @@ arrowFileOpenFile(VALUE self, SQLtable *table)
 			Elog("ArrowWrite: failed to open '%s': %m", buf);
 		table->fdesc = fdesc;
 		table->filename = pstrdup(buf);
-		if (flock(fdesc, LOCK_EX) != 0)
-			Elog("failed on flock('%s'): %m", buf);
+		arrowFileLockFile(table);
 		if (fstat(fdesc, &stat_buf) != 0)
 			Elog("failed on fstat('%s'): %m", buf);
 		/* check threshold */
@@ -1826,6 +1911,25 @@ arrowFileSetupNewFile(SQLtable *table)
 	writeArrowSchema(table);
 }
 
+static bool
+__arrowFieldHasStats(ArrowField *af_field)
+{
+	bool		has_min = false;
+	bool		has_max = false;
+	uint32_t	i;
+
+	for (i=0; i < af_field->_num_custom_metadata; i++)
+	{
+		ArrowKeyValue  *kv = &af_field->custom_metadata[i];
+
+		if (strcmp(kv->key, "min_values") == 0)
+			has_min = true;
+		else if (strcmp(kv->key, "max_values") == 0)
+			has_max = true;
+	}
+	return (has_min && has_max);
+}
+
 static SQLstat *
 __arrowFieldParseStats(ArrowField *af_field)
 {
@@ -1954,7 +2058,17 @@ __arrowFileValidateColumn(SQLfield *column,
 	}
 
 	if (column->stat_enabled)
-		column->stat_list = __arrowFieldParseStats(af_field);
+	{
+		/*
+		 * the file might be written by the older version that did not
+		 * save min/max statistics of ts_column, so we skip them.
+		 */
+		if (column->sql_type.fluent.ts_stat_auto &&
+			!__arrowFieldHasStats(af_field))
+			column->stat_enabled = false;
+		else
+			column->stat_list = __arrowFieldParseStats(af_field);
+	}
 }
 
 static void
@@ -2001,6 +2115,7 @@ typedef struct
 {
 	VALUE		self;
 	VALUE		chunk;
+	VALUE		keys;		/* frozen field names to lookup records */
 	SQLtable   *table;
 } WriteChunkArgs;
 
@@ -2055,16 +2170,56 @@ __arrowFileCreateTable(VALUE self)
 											   __stat_enabled == Qtrue,
 											   __ts_column == Qtrue,
 											   __tag_column == Qtrue);
-		if (__stat_enabled == Qtrue)
+		/*
+		 * min/max statistics of ts_column allows Arrow_Fdw to skip record
+		 * batches out of the time range, so we enable it implicitly.
+		 */
+		if (__ts_column == Qtrue &&
+			__stat_enabled != Qtrue &&
+			table->columns[j].write_stat != NULL)
+		{
+			table->columns[j].stat_enabled = true;
+			table->columns[j].sql_type.fluent.ts_stat_auto = true;
+		}
+		if (table->columns[j].stat_enabled)
 			table->has_statistics = true;
 	}
 	table->numFieldNodes = count;
 	table->numBuffers = nbuffers;
 	table->nfields = count;
+	datum = rb_ivar_get(self, rb_intern("record_batch_size"));
+	table->segment_sz = NUM2LONG(datum);
 
 	return table;
 }
 
+/*
+ * __arrowFileResetTable
+ *
+ * reset the buffer to build the next record batch in the same chunk
+ */
+static void
+__arrowFileResetTable(SQLtable *table)
+{
+	int		j;
+
+	sql_table_clear(table);
+	if (table->recordBatches)
+		pfree(table->recordBatches);
+	table->recordBatches = NULL;
+	table->numRecordBatches = 0;
+	table->f_pos = 0;
+	for (j=0; j < table->nfields; j++)
+	{
+		SQLfield   *column = &table->columns[j];
+
+		column->stat_list = NULL;
+		memset(&column->stat_datum, 0, sizeof(SQLstat));
+		if (column->sql_type.fluent.ts_stat_auto)
+			column->stat_enabled = true;
+	}
+}
+
 /*
  * __arrowFileReleaseTable
  *
@@ -2102,6 +2257,30 @@ __arrowFileReleaseTable(SQLtable *table)
 	}
 }
 
+/*
+ * __arrowFileFlushRecordBatch
+ *
+ * write out the buffer as a record batch, with the file lock held
+ */
+static void
+__arrowFileFlushRecordBatch(WriteChunkArgs *args)
+{
+	SQLtable   *table = args->table;
+
+	/* open the destination file */
+	if (arrowFileOpenFile(args->self, table))
+		arrowFileSetupNewFile(table);
+	else
+		arrowFileSetupAppend(table);
+	/* write out a new record-batch and footer, without GVL */
+	rb_thread_call_without_gvl(__arrowFileWriteRecordBatchNoGVL, table,
+							   NULL, NULL);
+	/* close the file, and unlock */
+	arrowFileCloseFile(table);
+	/* reset the buffer for the next record-batch */
+	__arrowFileResetTable(table);
+}
+
 static VALUE
 __arrowFileWriteRow(RB_BLOCK_CALL_FUNC_ARGLIST(__yield, __private))
 {
@@ -2110,11 +2289,21 @@ __arrowFileWriteRow(RB_BLOCK_CALL_FUNC_ARGLIST(__yield, __private))
 	VALUE		tag;
 	VALUE		ts;
 	VALUE		record;
+	size_t		usage = 0;
 	int			j;
 
-	tag = rb_funcall(__yield, rb_intern("fetch"), 1, INT2NUM(0));
-	ts = rb_funcall(__yield, rb_intern("fetch"), 1, INT2NUM(1));
-	record = rb_funcall(__yield, rb_intern("fetch"), 1, INT2NUM(2));
+	if (RB_TYPE_P(__yield, T_ARRAY))
+	{
+		tag    = rb_ary_entry(__yield, 0);
+		ts     = rb_ary_entry(__yield, 1);
+		record = rb_ary_entry(__yield, 2);
+	}
+	else
+	{
+		tag    = rb_funcall(__yield, rb_intern("fetch"), 1, INT2NUM(0));
+		ts     = rb_funcall(__yield, rb_intern("fetch"), 1, INT2NUM(1));
+		record = rb_funcall(__yield, rb_intern("fetch"), 1, INT2NUM(2));
+	}
 	for (j=0; j < table->nfields; j++)
 	{
 		SQLfield   *column = &table->columns[j];
@@ -2124,14 +2313,18 @@ __arrowFileWriteRow(RB_BLOCK_CALL_FUNC_ARGLIST(__yield, __private))
 			datum = ts;
 		else if (column->sql_type.fluent.tag_column)
 			datum = tag;
+		else if (RB_TYPE_P(record, T_HASH))
+			datum = rb_hash_lookup2(record, rb_ary_entry(args->keys, j), Qnil);
 		else
-		{
 			datum = rb_funcall(record, rb_intern("fetch"), 2,
-							   rb_str_new_cstr(column->field_name), Qnil);
-		}
-		column->put_value(column, (const char *)datum, -1);
+							   rb_ary_entry(args->keys, j), Qnil);
+		usage += sql_field_put_value(column, (const char *)datum, -1);
 	}
 	table->nitems++;
+	table->usage = usage;
+	/* flush the buffer if it reached the record_batch_size */
+	if (table->usage >= table->segment_sz)
+		__arrowFileFlushRecordBatch(args);
 
 	return Qtrue;
 }
@@ -2141,9 +2334,18 @@ __arrowFileWriteChunk(VALUE __args)
 {
 	WriteChunkArgs *args = (WriteChunkArgs *)__args;
 	SQLtable   *table;
+	int			j;
 
 	/* setup SQLtable buffer */
 	args->table = table = __arrowFileCreateTable(args->self);
+	/* field names are looked up for each record */
+	args->keys = rb_ary_new_capa(table->nfields);
+	for (j=0; j < table->nfields; j++)
+	{
+		VALUE	key = rb_str_new_cstr(table->columns[j].field_name);
+
+		rb_ary_push(args->keys, rb_obj_freeze(key));
+	}
 	/* iterate chunk to fill up the buffer */
 	rb_block_call(args->chunk,
 				  rb_intern("each"),
@@ -2151,17 +2353,9 @@ __arrowFileWriteChunk(VALUE __args)
 				  NULL,
 				  __arrowFileWriteRow,
 				  __args);
-	/* open the destination file */
-	if (arrowFileOpenFile(args->self, args->table))
-		arrowFileSetupNewFile(args->table);
-	else
-		arrowFileSetupAppend(args->table);
-	/* write out a new record-batch */
-	writeArrowRecordBatch(table);
-	/* write out a new footer */
-	writeArrowFooter(table);
-	/* close the file, and unlock */
-	arrowFileCloseFile(table);
+	/* write out the remaining rows */
+	if (table->nitems > 0)
+		__arrowFileFlushRecordBatch(args);
 
 	return Qtrue;
 }
@@ -2179,6 +2373,7 @@ rb_ArrowFileWrite__writeChunk(VALUE self,
 	args.chunk = chunk;
 
 	retval = rb_protect(__arrowFileWriteChunk, (VALUE)&args, &status);
+	RB_GC_GUARD(args.keys);
 	if (status != 0)
 	{
 		if (args.table)
@@ -14,6 +14,8 @@ module Fluent
       config_param :ts_column, :string, default: NIL
       config_param :tag_column, :string, default: NIL
       config_param :filesize_threshold, :integer, default: 10000
+      # fit PGSTROM_CHUNK_SIZE 64MB
+      config_param :record_batch_size, :integer, default: 64
 
       config_section :buffer do
         config_set_default :@type, 'memory'
@@ -27,14 +29,14 @@ module Fluent
       end
   
       def multi_workers_ready?
-        false
+        true
       end
 
       def configure(conf)
         compat_parameters_convert(conf, :buffer, :inject, default_chunk_key: "time")
         super
 
-        @af=ArrowFileWrite.new(@path,@schema_defs,{"ts_column" => @ts_column,"tag_column" => @tag_column,"filesize_threshold" => @filesize_threshold})
+        @af=ArrowFileWrite.new(@path,@schema_defs,{"ts_column" => @ts_column,"tag_column" => @tag_column,"filesize_threshold" => @filesize_threshold,"record_batch_size" => @record_batch_size})
       end
 
       def format(tag,time,record)
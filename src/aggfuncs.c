@@ -48,6 +48,10 @@ PG_FUNCTION_INFO_V1(pgstrom_fsum_final_fp64_as_numeric);
 PG_FUNCTION_INFO_V1(pgstrom_favg_final_int);
 PG_FUNCTION_INFO_V1(pgstrom_favg_final_fp);
 PG_FUNCTION_INFO_V1(pgstrom_favg_final_num);
+PG_FUNCTION_INFO_V1(pgstrom_partial_sum_numeric);
+PG_FUNCTION_INFO_V1(pgstrom_fsum_trans_numeric);
+PG_FUNCTION_INFO_V1(pgstrom_fsum_final_numeric);
+PG_FUNCTION_INFO_V1(pgstrom_favg_final_numeric);
 
 PG_FUNCTION_INFO_V1(pgstrom_partial_variance);
 PG_FUNCTION_INFO_V1(pgstrom_stddev_trans);
@@ -487,6 +491,204 @@ pgstrom_favg_final_num(PG_FUNCTION_ARGS)
 	PG_RETURN_DATUM(DirectFunctionCall2(numeric_div, sum, n));
 }
 
+/*
+ * Exact SUM(numeric),AVG(numeric) functions
+ */
+PUBLIC_FUNCTION(Datum)
+pgstrom_partial_sum_numeric(PG_FUNCTION_ARGS)
+{
+	kagg_state__psum_numeric_packed *r = palloc(sizeof(kagg_state__psum_numeric_packed));
+	Datum		datum = PG_GETARG_DATUM(0);
+	xpu_numeric_t num;
+
+	__preagg_init_psum_numeric(r, KAGG_NUMERIC_WEIGHT__UNUSED);
+	memset(&num, 0, sizeof(num));
+	if (!__xpu_numeric_from_varlena(&num, (struct varlena *)
+									PG_DETOAST_DATUM_PACKED(datum)))
+		__preagg_update_psum_numeric(r, &num);
+	else
+	{
+		/* too large for the fixed-point accumulator */
+		r->nitems = 1;
+		r->flags  = KAGG_NUMERIC_FLAG__INEXACT;
+		r->fp_sum = DatumGetFloat8(DirectFunctionCall1(numeric_float8, datum));
+	}
+	PG_RETURN_POINTER(r);
+}
+
+PUBLIC_FUNCTION(Datum)
+pgstrom_fsum_trans_numeric(PG_FUNCTION_ARGS)
+{
+	kagg_state__psum_numeric_packed *state;
+	kagg_state__psum_numeric_packed *arg;
+	MemoryContext	aggcxt;
+
+	if (!AggCheckCallContext(fcinfo, &aggcxt))
+		elog(ERROR, "aggregate function called in non-aggregate context");
+	if (PG_ARGISNULL(0))
+	{
+		if (PG_ARGISNULL(1))
+			PG_RETURN_NULL();
+		arg = (kagg_state__psum_numeric_packed *)PG_GETARG_BYTEA_P(1);
+		state = MemoryContextAlloc(aggcxt, sizeof(*state));
+		memcpy(state, arg, sizeof(*state));
+	}
+	else
+	{
+		state = (kagg_state__psum_numeric_packed *)PG_GETARG_BYTEA_P(0);
+		if (!PG_ARGISNULL(1))
+		{
+			arg = (kagg_state__psum_numeric_packed *)PG_GETARG_BYTEA_P(1);
+			if (arg->nitems > 0)
+				__preagg_merge_psum_numeric(state, arg);
+		}
+	}
+	PG_RETURN_POINTER(state);
+}
+
+/*
+ * __numeric_from_psum_slot - 192bit fixed-point integer to numeric
+ */
+static Datum
+__numeric_from_psum_slot(const kagg_numeric_sum *sum, int32 weight)
+{
+	uint64		words[3];
+	bool		is_negative = (sum->hi < 0);
+	char		digits[64];		/* 2^191 has 58 decimal digits */
+	char	   *pos = digits + sizeof(digits);
+	int			ndigits;
+	StringInfoData buf;
+
+	words[0] = sum->lo;
+	words[1] = sum->mid;
+	words[2] = (uint64)sum->hi;
+	if (is_negative)
+	{
+		words[0] = ~words[0];
+		words[1] = ~words[1];
+		words[2] = ~words[2];
+		if (++words[0] == 0 && ++words[1] == 0)
+			++words[2];
+	}
+	*--pos = '\0';
+	do {
+		uint64		rem = 0;
+
+		for (int i=2; i >= 0; i--)
+		{
+			unsigned __int128 curr = (((unsigned __int128)rem << 64) | words[i]);
+
+			words[i] = (uint64)(curr / 10);
+			rem = (uint64)(curr % 10);
+		}
+		*--pos = '0' + rem;
+	} while ((words[0] | words[1] | words[2]) != 0);
+	ndigits = strlen(pos);
+
+	initStringInfo(&buf);
+	if (is_negative)
+		appendStringInfoChar(&buf, '-');
+	if (weight <= 0)
+	{
+		appendStringInfoString(&buf, pos);
+		for (int i=weight; i < 0; i++)
+			appendStringInfoChar(&buf, '0');
+	}
+	else if (ndigits <= weight)
+	{
+		appendStringInfoString(&buf, "0.");
+		for (int i=ndigits; i < weight; i++)
+			appendStringInfoChar(&buf, '0');
+		appendStringInfoString(&buf, pos);
+	}
+	else
+	{
+		appendBinaryStringInfo(&buf, pos, ndigits - weight);
+		appendStringInfoChar(&buf, '.');
+		appendStringInfoString(&buf, pos + ndigits - weight);
+	}
+	return DirectFunctionCall3(numeric_in,
+							   CStringGetDatum(buf.data),
+							   ObjectIdGetDatum(InvalidOid),
+							   Int32GetDatum(-1));
+}
+
+static Datum
+__pgstrom_psum_numeric_datum(const kagg_state__psum_numeric_packed *state)
+{
+	uint32		flags = state->flags;
+	Datum		result = 0;
+	bool		has_result = false;
+
+	if ((flags & KAGG_NUMERIC_FLAG__NAN) != 0 ||
+		(flags & (KAGG_NUMERIC_FLAG__POS_INF |
+				  KAGG_NUMERIC_FLAG__NEG_INF)) == (KAGG_NUMERIC_FLAG__POS_INF |
+												   KAGG_NUMERIC_FLAG__NEG_INF))
+		return DirectFunctionCall3(numeric_in,
+								   CStringGetDatum("NaN"),
+								   ObjectIdGetDatum(InvalidOid),
+								   Int32GetDatum(-1));
+	if ((flags & KAGG_NUMERIC_FLAG__POS_INF) != 0)
+		return DirectFunctionCall3(numeric_in,
+								   CStringGetDatum("Infinity"),
+								   ObjectIdGetDatum(InvalidOid),
+								   Int32GetDatum(-1));
+	if ((flags & KAGG_NUMERIC_FLAG__NEG_INF) != 0)
+		return DirectFunctionCall3(numeric_in,
+								   CStringGetDatum("-Infinity"),
+								   ObjectIdGetDatum(InvalidOid),
+								   Int32GetDatum(-1));
+	/* never return the floating-point side-sum as a numeric result */
+	if ((flags & KAGG_NUMERIC_FLAG__INEXACT) != 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
+				 errmsg("numeric values are not summarized exactly by GPU"),
+				 errhint("try again with pg_strom.enable_numeric_aggfuncs = off")));
+
+	for (int k=0; k < KAGG_NUMERIC_NSLOTS; k++)
+	{
+		Datum	datum;
+
+		if (state->weights[k] == KAGG_NUMERIC_WEIGHT__UNUSED)
+			continue;
+		datum = __numeric_from_psum_slot(&state->sums[k], state->weights[k]);
+		if (!has_result)
+			result = datum;
+		else
+			result = DirectFunctionCall2(numeric_add, result, datum);
+		has_result = true;
+	}
+	if (!has_result)
+		result = DirectFunctionCall1(int8_numeric, Int64GetDatum(0));
+	return result;
+}
+
+PUBLIC_FUNCTION(Datum)
+pgstrom_fsum_final_numeric(PG_FUNCTION_ARGS)
+{
+	kagg_state__psum_numeric_packed *state;
+
+	state = (kagg_state__psum_numeric_packed *)PG_GETARG_BYTEA_P(0);
+	if (state->nitems == 0)
+		PG_RETURN_NULL();
+	PG_RETURN_DATUM(__pgstrom_psum_numeric_datum(state));
+}
+
+PUBLIC_FUNCTION(Datum)
+pgstrom_favg_final_numeric(PG_FUNCTION_ARGS)
+{
+	kagg_state__psum_numeric_packed *state;
+	Datum	n, sum;
+
+	state = (kagg_state__psum_numeric_packed *)PG_GETARG_BYTEA_P(0);
+	if (state->nitems == 0)
+		PG_RETURN_NULL();
+	n = DirectFunctionCall1(int8_numeric, Int64GetDatum(state->nitems));
+	sum = __pgstrom_psum_numeric_datum(state);
+
+	PG_RETURN_DATUM(DirectFunctionCall2(numeric_div, sum, n));
+}
+
 /*
  * STDDEV/VARIANCE
  */
@@ -828,7 +1030,6 @@ pgstrom_regr_syy_final(PG_FUNCTION_ARGS)
 	PG_RETURN_NULL();
 }
 
-#if 0
 /*
  * ----------------------------------------------------------------
  *
@@ -837,146 +1038,42 @@ pgstrom_regr_syy_final(PG_FUNCTION_ARGS)
  * ----------------------------------------------------------------
  */
 
-/*
- * Hash-function based on Sip-Hash
- *
- * See https://en.wikipedia.org/wiki/SipHash
- *     and https://github.com/veorq/SipHash
- */
-/* default: SipHash-2-4 */
-#define cROUNDS 2
-#define dROUNDS 4
-#define ROTL(x, b) (uint64_t)(((x) << (b)) | ((x) >> (64 - (b))))
-
-#define U8TO64_LE(p)											\
-    (((uint64_t)((p)[0]))       | ((uint64_t)((p)[1]) <<  8) |	\
-     ((uint64_t)((p)[2]) << 16) | ((uint64_t)((p)[3]) << 24) |	\
-     ((uint64_t)((p)[4]) << 32) | ((uint64_t)((p)[5]) << 40) |	\
-     ((uint64_t)((p)[6]) << 48) | ((uint64_t)((p)[7]) << 56))
-
-#define SIPROUND					\
-    do {							\
-        v0 += v1;					\
-        v1 = ROTL(v1, 13);			\
-        v1 ^= v0;					\
-        v0 = ROTL(v0, 32);			\
-        v2 += v3;					\
-        v3 = ROTL(v3, 16);			\
-        v3 ^= v2;					\
-        v0 += v3;					\
-        v3 = ROTL(v3, 21);			\
-        v3 ^= v0;					\
-        v2 += v1;					\
-        v1 = ROTL(v1, 17);			\
-        v1 ^= v2;					\
-        v2 = ROTL(v2, 32);			\
-    } while (0)
-
-static uint64_t
-__pgstrom_hll_siphash_value(const void *ptr, const size_t len)
-{
-	const unsigned char *ni = (const unsigned char *)ptr;
-	uint64_t	v0 = 0x736f6d6570736575UL;
-	uint64_t	v1 = 0x646f72616e646f6dUL;
-	uint64_t	v2 = 0x6c7967656e657261UL;
-	uint64_t	v3 = 0x7465646279746573UL;
-	uint64_t	k0 = 0x9c38151cda15a76bUL;	/* random key-0 */
-	uint64_t	k1 = 0xfb4ff68fbd3e6658UL;	/* random key-1 */
-	uint64_t	m;
-	int			i;
-    const unsigned char *end = ni + len - (len % sizeof(uint64_t));
-    const int	left = len & 7;
-    uint64_t	b = ((uint64_t)len) << 56;
-
-    v3 ^= k1;
-    v2 ^= k0;
-    v1 ^= k1;
-    v0 ^= k0;
-
-	for (; ni != end; ni += 8)
-	{
-		m = U8TO64_LE(ni);
-		v3 ^= m;
-
-		for (i = 0; i < cROUNDS; ++i)
-			SIPROUND;
-
-		v0 ^= m;
-	}
-
-#if 1
-	if (left > 0)
-	{
-		uint64_t	temp = 0;
-
-		memcpy(&temp, ni, left);
-		b |= (temp & ((1UL << (BITS_PER_BYTE * left)) - 1));
-	}
-#else
-	/* original code */
-	switch (left)
-	{
-		case 7:
-			b |= ((uint64_t)ni[6]) << 48;		__attribute__ ((fallthrough));
-		case 6:
-			b |= ((uint64_t)ni[5]) << 40;		__attribute__ ((fallthrough));
-		case 5:
-			b |= ((uint64_t)ni[4]) << 32;		__attribute__ ((fallthrough));
-		case 4:
-			b |= ((uint64_t)ni[3]) << 24;		__attribute__ ((fallthrough));
-		case 3:
-			b |= ((uint64_t)ni[2]) << 16;		__attribute__ ((fallthrough));
-		case 2:
-			b |= ((uint64_t)ni[1]) << 8;		__attribute__ ((fallthrough));
-		case 1:
-			b |= ((uint64_t)ni[0]);
-			break;
-		case 0:
-			break;
-    }
-#endif
-
-    v3 ^= b;
-	for (i = 0; i < cROUNDS; ++i)
-		SIPROUND;
-
-	v0 ^= b;
-
-	v2 ^= 0xff;
-
-	for (i = 0; i < dROUNDS; ++i)
-		SIPROUND;
-
-	b = v0 ^ v1 ^ v2 ^ v3;
-
-	return b;
-}
-
 /*
  * pgstrom_hll_hash_xxxx functions
+ *
+ * NOTE: binary images to be hashed must be identical to the device code;
+ * see __preagg_fetch_xdatum_as_hll_hash() in xpu_common.h
  */
 static uint64
 __pgstrom_hll_hash_int1(Datum datum)
 {
-	return __pgstrom_hll_siphash_value(&datum, sizeof(int8));
+	int8		ival = (int8) DatumGetChar(datum);
+
+	return pg_hll_siphash_value(&ival, sizeof(int8));
 }
 
 static uint64
 __pgstrom_hll_hash_int2(Datum datum)
 {
-	return __pgstrom_hll_siphash_value(&datum, sizeof(int16));
+	int16		ival = DatumGetInt16(datum);
+
+	return pg_hll_siphash_value(&ival, sizeof(int16));
 }
 
 static uint64
 __pgstrom_hll_hash_int4(Datum datum)
 {
-	return __pgstrom_hll_siphash_value(&datum, sizeof(int32));
+	int32		ival = DatumGetInt32(datum);
+
+	return pg_hll_siphash_value(&ival, sizeof(int32));
 }
 
 static uint64
 __pgstrom_hll_hash_int8(Datum datum)
 {
-	return __pgstrom_hll_siphash_value(&datum, sizeof(int64));
+	int64		ival = DatumGetInt64(datum);
+
+	return pg_hll_siphash_value(&ival, sizeof(int64));
 }
 
 static uint64
@@ -986,43 +1083,43 @@ __pgstrom_hll_hash_numeric(Datum datum)
 	const char	   *emsg;
 
 	memset(&num, 0, sizeof(num));
-	emsg = __xpu_numeric_from_varlena(&num, (struct varlena *)datum);
+	emsg = __xpu_numeric_from_varlena(&num, (struct varlena *)
+									  PG_DETOAST_DATUM_PACKED(datum));
 	if (emsg)
 		elog(ERROR, "failed on hash calculation of device numeric: %s", emsg);
-	return __pgstrom_hll_siphash_value(&num.weight,
-									   offsetof(xpu_numeric_t, value)
-									   + sizeof(int128_t)
-									   - offsetof(xpu_numeric_t, weight));
+	return pg_hll_hash_numeric(&num);
 }
 
 static uint64
 __pgstrom_hll_hash_date(Datum datum)
 {
-	return __pgstrom_hll_siphash_value(&datum, sizeof(DateADT));
+	DateADT		dval = DatumGetDateADT(datum);
+
+	return pg_hll_siphash_value(&dval, sizeof(DateADT));
 }
 
 static uint64
 __pgstrom_hll_hash_time(Datum datum)
 {
-	return __pgstrom_hll_siphash_value(&datum, sizeof(TimeADT));
-}
+	TimeADT		tval = DatumGetTimeADT(datum);
 
-static uint64
-__pgstrom_hll_hash_timetz(Datum datum)
-{
-	return __pgstrom_hll_siphash_value(DatumGetPointer(datum), sizeof(TimeTzADT));
+	return pg_hll_siphash_value(&tval, sizeof(TimeADT));
 }
 
 static uint64
 __pgstrom_hll_hash_timestamp(Datum datum)
 {
-	return __pgstrom_hll_siphash_value(&datum, sizeof(Timestamp));
+	Timestamp	ts = DatumGetTimestamp(datum);
+
+	return pg_hll_siphash_value(&ts, sizeof(Timestamp));
 }
 
 static uint64
 __pgstrom_hll_hash_timestamptz(Datum datum)
 {
-	return __pgstrom_hll_siphash_value(&datum, sizeof(TimestampTz));
+	TimestampTz	ts = DatumGetTimestampTz(datum);
+
+	return pg_hll_siphash_value(&ts, sizeof(TimestampTz));
 }
 
 static uint64
@@ -1031,64 +1128,97 @@ __pgstrom_hll_hash_bpchar(Datum datum)
 	BpChar	   *val = DatumGetBpCharPP(datum);
 	int			len = bpchartruelen(VARDATA_ANY(val),
 									VARSIZE_ANY_EXHDR(val));
-	return __pgstrom_hll_siphash_value(VARDATA_ANY(val), len);
+	return pg_hll_siphash_value(VARDATA_ANY(val), len);
 }
 
 static uint64
 __pgstrom_hll_hash_varlena(Datum datum)
 {
-	struct varlena *val = PG_DETOAST_DATUM(datum);
+	struct varlena *val = PG_DETOAST_DATUM_PACKED(datum);
 
-	return __pgstrom_hll_siphash_value(VARDATA_ANY(val), VARSIZE_ANY_EXHDR(val));
+	return pg_hll_siphash_value(VARDATA_ANY(val), VARSIZE_ANY_EXHDR(val));
 }
 
 static uint64
 __pgstrom_hll_hash_uuid(Datum datum)
 {
-	return __pgstrom_hll_siphash_value(DatumGetUUIDP(datum), sizeof(pg_uuid_t));
+	return pg_hll_siphash_value(DatumGetUUIDP(datum), sizeof(pg_uuid_t));
+}
+
+/*
+ * __pgstrom_hll_sketch_validate
+ */
+static kagg_state__hll_sketch_packed *
+__pgstrom_hll_sketch_validate(bytea *__state)
+{
+	kagg_state__hll_sketch_packed *state = (kagg_state__hll_sketch_packed *)__state;
+	uint32		nrooms;
+
+	if (VARATT_IS_SHORT(__state) ||
+		VARSIZE(__state) < offsetof(kagg_state__hll_sketch_packed, regs))
+		elog(ERROR, "HLL sketch looks corrupted");
+	nrooms = state->nrooms;
+	if (nrooms < 1 || (nrooms & (nrooms - 1)) != 0 ||
+		VARSIZE(state) != offsetof(kagg_state__hll_sketch_packed, regs) + nrooms)
+		elog(ERROR, "HLL sketch must have 2^N rooms (%u)", nrooms);
+	return state;
+}
+
+/*
+ * __pgstrom_hll_sketch_new
+ */
+static kagg_state__hll_sketch_packed *
+__pgstrom_hll_sketch_new(MemoryContext memcxt)
+{
+	kagg_state__hll_sketch_packed *state;
+	size_t		sz = KAGG_STATE__HLL_SKETCH_SZ(pgstrom_hll_register_bits);
+
+	state = MemoryContextAllocZero(memcxt, sz);
+	state->nrooms = (1U << pgstrom_hll_register_bits);
+	SET_VARSIZE(state, sz);
+
+	return state;
 }
 
-static bytea *
+static inline void
+__pgstrom_hll_sketch_update(kagg_state__hll_sketch_packed *state, uint64 hash)
+{
+	uint32		nbits = __builtin_ctz(state->nrooms);
+	uint32		index;
+	uint32		count;
+
+	pg_hll_register_position(hash, nbits, &index, &count);
+	Assert(index < state->nrooms);
+	if (state->regs[index] < count)
+		state->regs[index] = count;
+}
+
+static kagg_state__hll_sketch_packed *
 __pgstrom_hll_sketch_update_common(PG_FUNCTION_ARGS, uint64 hash)
 {
+	kagg_state__hll_sketch_packed *state;
 	MemoryContext	aggcxt;
-	bytea		   *hll_state;
-	uint8		   *hll_regs;
-	uint64			nrooms;
-	uint32			index;
-	uint32			count;
 
 	if (!AggCheckCallContext(fcinfo, &aggcxt))
 		elog(ERROR, "aggregate function called in non-aggregate context");
-	nrooms = (1UL << pgstrom_hll_register_bits);
 	if (PG_ARGISNULL(0))
-	{
-		size_t	sz = VARHDRSZ + sizeof(uint8) * nrooms;
-		hll_state = MemoryContextAllocZero(aggcxt, sz);
-		SET_VARSIZE(hll_state, sz);
-	}
+		state = __pgstrom_hll_sketch_new(aggcxt);
 	else
-	{
-		hll_state = PG_GETARG_BYTEA_P(0);
-	}
-	Assert(VARSIZE(hll_state) == VARHDRSZ + sizeof(uint8) * nrooms);
-	hll_regs = (uint8 *)VARDATA(hll_state);
+		state = __pgstrom_hll_sketch_validate(PG_GETARG_BYTEA_P(0));
+	__pgstrom_hll_sketch_update(state, hash);
 
-	index = hash & (nrooms - 1);
-	count = __builtin_ctzll(hash >> pgstrom_hll_register_bits) + 1;
-	if (hll_regs[index] < count)
-		hll_regs[index] = count;
-	return hll_state;
+	return state;
 }
 
 #define PGSTROM_HLL_HANDLER_TEMPLATE(NAME)								\
 	PG_FUNCTION_INFO_V1(pgstrom_hll_hash_##NAME);						\
 	PG_FUNCTION_INFO_V1(pgstrom_hll_sketch_update_##NAME);				\
+	PG_FUNCTION_INFO_V1(pgstrom_partial_hll_sketch_##NAME);				\
 	PUBLIC_FUNCTION(Datum)												\
 	pgstrom_hll_hash_##NAME(PG_FUNCTION_ARGS)							\
 	{																	\
 		Datum	arg = PG_GETARG_DATUM(0);								\
-		PG_RETURN_UINT64(__pgstrom_hll_hash_##NAME(arg));				\
+		PG_RETURN_INT64((int64)__pgstrom_hll_hash_##NAME(arg));			\
 	}																	\
 	PUBLIC_FUNCTION(Datum)												\
 	pgstrom_hll_sketch_update_##NAME(PG_FUNCTION_ARGS)					\
@@ -1103,11 +1233,20 @@ __pgstrom_hll_sketch_update_common(PG_FUNCTION_ARGS, uint64 hash)
 		{																\
 			Datum	arg = PG_GETARG_DATUM(1);							\
 			uint64  hash = __pgstrom_hll_hash_##NAME(arg);				\
-			bytea  *state;												\
 																		\
-			state = __pgstrom_hll_sketch_update_common(fcinfo, hash);	\
-			PG_RETURN_BYTEA_P(state);									\
+			PG_RETURN_POINTER(__pgstrom_hll_sketch_update_common(fcinfo, \
+																 hash)); \
 		}																\
+	}																	\
+	PUBLIC_FUNCTION(Datum)												\
+	pgstrom_partial_hll_sketch_##NAME(PG_FUNCTION_ARGS)					\
+	{																	\
+		Datum	arg = PG_GETARG_DATUM(0);								\
+		kagg_state__hll_sketch_packed *state;							\
+																		\
+		state = __pgstrom_hll_sketch_new(CurrentMemoryContext);			\
+		__pgstrom_hll_sketch_update(state, __pgstrom_hll_hash_##NAME(arg)); \
+		PG_RETURN_POINTER(state);										\
 	}
 
 PGSTROM_HLL_HANDLER_TEMPLATE(int1)
@@ -1117,52 +1256,22 @@ PGSTROM_HLL_HANDLER_TEMPLATE(int8)
 PGSTROM_HLL_HANDLER_TEMPLATE(numeric)
 PGSTROM_HLL_HANDLER_TEMPLATE(date)
 PGSTROM_HLL_HANDLER_TEMPLATE(time)
-PGSTROM_HLL_HANDLER_TEMPLATE(timetz)
 PGSTROM_HLL_HANDLER_TEMPLATE(timestamp)
 PGSTROM_HLL_HANDLER_TEMPLATE(timestamptz)
 PGSTROM_HLL_HANDLER_TEMPLATE(bpchar)
 PGSTROM_HLL_HANDLER_TEMPLATE(varlena)
 PGSTROM_HLL_HANDLER_TEMPLATE(uuid)
 
-/*
- * pgstrom_hll_sketch_new
- */
-PUBLIC_FUNCTION(Datum)
-pgstrom_hll_sketch_new(PG_FUNCTION_ARGS)
-{
-	uint64		nrooms = (1UL << pgstrom_hll_register_bits);
-	uint64		hll_hash = DatumGetUInt64(PG_GETARG_DATUM(0));
-	bytea	   *hll_state;
-	uint8	   *hll_regs;
-	uint32		count;
-	uint32		index;
-
-	hll_state = palloc0(VARHDRSZ + sizeof(uint8) * nrooms);
-	SET_VARSIZE(hll_state, VARHDRSZ + sizeof(uint8) * nrooms);
-	hll_regs = (uint8 *)VARDATA(hll_state);
-
-	index = hll_hash & (nrooms - 1);
-	Assert(index < nrooms);
-	count = __builtin_ctzll(hll_hash >> pgstrom_hll_register_bits) + 1;
-	if (hll_regs[index] < count)
-		hll_regs[index] = count;
-
-	PG_RETURN_BYTEA_P(hll_state);
-}
-
 /*
  * pgstrom_hll_sketch_merge
  */
+PG_FUNCTION_INFO_V1(pgstrom_hll_sketch_merge);
 PUBLIC_FUNCTION(Datum)
 pgstrom_hll_sketch_merge(PG_FUNCTION_ARGS)
 {
 	MemoryContext	aggcxt;
-	bytea		   *hll_state = NULL;
-	uint8		   *hll_regs;
-	bytea		   *new_state;
-	uint8		   *new_regs;
-	uint32			nrooms;
-	uint32			index;
+	kagg_state__hll_sketch_packed *state;
+	kagg_state__hll_sketch_packed *arg;
 
 	if (!AggCheckCallContext(fcinfo, &aggcxt))
 		elog(ERROR, "aggregate function called in non-aggregate context");
@@ -1170,73 +1279,57 @@ pgstrom_hll_sketch_merge(PG_FUNCTION_ARGS)
 	{
 		if (PG_ARGISNULL(1))
 			PG_RETURN_NULL();
-		new_state = PG_GETARG_BYTEA_P(1);
-		nrooms = VARSIZE_ANY_EXHDR(new_state);
-		if (nrooms < 1 || (nrooms & (nrooms - 1)) != 0)
-			elog(ERROR, "HLL sketch must have 2^N rooms (%u)", nrooms);
-		hll_state = MemoryContextAllocZero(aggcxt, VARHDRSZ + nrooms);
-		SET_VARSIZE(hll_state, VARHDRSZ + nrooms);
-		memcpy(VARDATA_ANY(hll_state), VARDATA_ANY(new_state), nrooms);
+		arg = __pgstrom_hll_sketch_validate(PG_GETARG_BYTEA_P(1));
+		state = MemoryContextAlloc(aggcxt, VARSIZE(arg));
+		memcpy(state, arg, VARSIZE(arg));
 	}
 	else
 	{
-		hll_state = PG_GETARG_BYTEA_P(0);
-		nrooms = VARSIZE_ANY_EXHDR(hll_state);
-		if (nrooms < 1 || (nrooms & (nrooms - 1)) != 0)
-			elog(ERROR, "HLL sketch must have 2^N rooms (%u)", nrooms);
+		state = __pgstrom_hll_sketch_validate(PG_GETARG_BYTEA_P(0));
 		if (!PG_ARGISNULL(1))
 		{
-			new_state = PG_GETARG_BYTEA_P(1);
-			if (VARSIZE_ANY_EXHDR(hll_state) != VARSIZE_ANY_EXHDR(new_state))
-				elog(ERROR, "incompatible HLL sketch");
-			hll_regs = (uint8 *)VARDATA_ANY(hll_state);
-			new_regs = (uint8 *)VARDATA_ANY(new_state);
-			for (index=0; index < nrooms; index++)
+			arg = __pgstrom_hll_sketch_validate(PG_GETARG_BYTEA_P(1));
+			if (state->nrooms != arg->nrooms)
+				elog(ERROR, "incompatible HLL sketch (%u and %u rooms)",
+					 state->nrooms, arg->nrooms);
+			for (uint32 index=0; index < state->nrooms; index++)
 			{
-				if (hll_regs[index] < new_regs[index])
-                    hll_regs[index] = new_regs[index];
+				if (state->regs[index] < arg->regs[index])
+					state->regs[index] = arg->regs[index];
 			}
 		}
 	}
-	PG_RETURN_POINTER(hll_state);
+	PG_RETURN_POINTER(state);
 }
 
 /*
  * pgstrom_hll_count_final
  */
+PG_FUNCTION_INFO_V1(pgstrom_hll_count_final);
 PUBLIC_FUNCTION(Datum)
 pgstrom_hll_count_final(PG_FUNCTION_ARGS)
 {
-	bytea	   *hll_state;
-	uint8	   *hll_regs;
+	kagg_state__hll_sketch_packed *state;
 	uint32		nrooms;
-	uint32		index;
+	uint32		nzeros = 0;
 	double		divider = 0.0;
 	double		weight;
 	double		estimate;
 
-#if 0
-	/*
-	 * MEMO: Here to no reason to prohibit to use pgstrom.hll_count_final()
-	 * towards preliminary calculated HLL sketch.
-	 */
-	if (!AggCheckCallContext(fcinfo, NULL))
-		elog(ERROR, "aggregate function called in non-aggregate context");
-#endif
 	if (PG_ARGISNULL(0))
 		PG_RETURN_INT64(0);
 	/*
 	 * MEMO: Hyper-Log-Log merge algorithm
-	 * https://ja.wikiqube.net/wiki/HyperLogLog
+	 * https://en.wikipedia.org/wiki/HyperLogLog
 	 */
-	hll_state = PG_GETARG_BYTEA_P(0);
-	nrooms = VARSIZE_ANY_EXHDR(hll_state);
-	if (nrooms < 1 || (nrooms & (nrooms - 1)) != 0)
-		elog(ERROR, "HLL sketch must have 2^N rooms (%u)", nrooms);
-	hll_regs = (uint8 *)VARDATA(hll_state);
-
-	for (index = 0; index < nrooms; index++)
-		divider += 1.0 / (double)(1UL << hll_regs[index]);
+	state = __pgstrom_hll_sketch_validate(PG_GETARG_BYTEA_P(0));
+	nrooms = state->nrooms;
+	for (uint32 index = 0; index < nrooms; index++)
+	{
+		divider += ldexp(1.0, -(int)state->regs[index]);
+		if (state->regs[index] == 0)
+			nzeros++;
+	}
 	if (nrooms <= 16)
 		weight = 0.673;
 	else if (nrooms <= 32)
@@ -1247,51 +1340,374 @@ pgstrom_hll_count_final(PG_FUNCTION_ARGS)
 		weight = 0.7213 / (1.0 + 1.079 / (double)nrooms);
 
 	estimate = (weight * (double)nrooms * (double)nrooms) / divider;
+	/* small range correction (linear counting) */
+	if (estimate <= 2.5 * (double)nrooms && nzeros > 0)
+		estimate = (double)nrooms * log((double)nrooms / (double)nzeros);
 	PG_RETURN_INT64((int64)estimate);
 }
 
-
-
 /*
  * pgstrom_hll_sketch_histogram
  */
+PG_FUNCTION_INFO_V1(pgstrom_hll_sketch_histogram);
 PUBLIC_FUNCTION(Datum)
 pgstrom_hll_sketch_histogram(PG_FUNCTION_ARGS)
 {
-	bytea	   *hll_state = PG_GETARG_BYTEA_P(0);
-	uint8	   *hll_regs;
-	uint32		nrooms;
-	uint32		index;
-	Datum		hll_hist[64];
+	kagg_state__hll_sketch_packed *state;
+	Datum		hll_hist[66];
 	int			max_hist = -1;
-	ArrayType  *result;
-
-	nrooms = VARSIZE_ANY_EXHDR(hll_state);
-	if (nrooms < 1 || (nrooms & (nrooms - 1)) != 0)
-		elog(ERROR, "HLL sketch must have 2^N rooms (%u)", nrooms);
-	hll_regs = (uint8 *)VARDATA(hll_state);
 
+	state = __pgstrom_hll_sketch_validate(PG_GETARG_BYTEA_P(0));
 	memset(hll_hist, 0, sizeof(hll_hist));
-	for (index=0; index < nrooms; index++)
+	for (uint32 index=0; index < state->nrooms; index++)
 	{
-		int		value = (int)hll_regs[index];
+		int		value = (int)state->regs[index];
 
-		if (value < 0 || value >= 64)
+		if (value >= lengthof(hll_hist))
 			elog(ERROR, "HLL sketch looks corrupted");
 		hll_hist[value]++;
 		if (max_hist < value)
 			max_hist = value;
 	}
-
 	if (max_hist < 0)
 		PG_RETURN_NULL();
 
-	result = construct_array(hll_hist,
-							 max_hist + 1,
-							 INT4OID,
-							 sizeof(int32),
-							 true,
-							 'i');
+	PG_RETURN_POINTER(construct_array(hll_hist,
+									  max_hist + 1,
+									  INT4OID,
+									  sizeof(int32),
+									  true,
+									  'i'));
+}
+
+/*
+ * __pgstrom_quantile_sketch_validate
+ */
+static kagg_state__quantile_sketch_packed *
+__pgstrom_quantile_sketch_validate(bytea *__state)
+{
+	kagg_state__quantile_sketch_packed *state =
+		(kagg_state__quantile_sketch_packed *)__state;
+
+	if (VARATT_IS_SHORT(__state) ||
+		VARSIZE(__state) != KAGG_STATE__QUANTILE_SKETCH_SZ ||
+		state->ncounters != KAGG_QSKETCH_NCOUNTERS)
+		elog(ERROR, "quantile sketch looks corrupted");
+	return state;
+}
+
+/*
+ * __pgstrom_quantile_sketch_new
+ */
+static kagg_state__quantile_sketch_packed *
+__pgstrom_quantile_sketch_new(MemoryContext memcxt)
+{
+	kagg_state__quantile_sketch_packed *state;
+
+	state = MemoryContextAllocZero(memcxt, KAGG_STATE__QUANTILE_SKETCH_SZ);
+	state->ncounters = KAGG_QSKETCH_NCOUNTERS;
+	SET_VARSIZE(state, KAGG_STATE__QUANTILE_SKETCH_SZ);
+
+	return state;
+}
+
+/*
+ * pgstrom_partial_quantile_sketch
+ */
+PG_FUNCTION_INFO_V1(pgstrom_partial_quantile_sketch);
+PUBLIC_FUNCTION(Datum)
+pgstrom_partial_quantile_sketch(PG_FUNCTION_ARGS)
+{
+	float8		fval = PG_GETARG_FLOAT8(0);
+	kagg_state__quantile_sketch_packed *state;
+
+	state = __pgstrom_quantile_sketch_new(CurrentMemoryContext);
+	state->counts[pg_quantile_sketch_index(fval)]++;
+	PG_RETURN_POINTER(state);
+}
+
+/*
+ * pgstrom_quantile_sketch_update
+ */
+PG_FUNCTION_INFO_V1(pgstrom_quantile_sketch_update);
+PUBLIC_FUNCTION(Datum)
+pgstrom_quantile_sketch_update(PG_FUNCTION_ARGS)
+{
+	MemoryContext	aggcxt;
+	kagg_state__quantile_sketch_packed *state;
+
+	if (!AggCheckCallContext(fcinfo, &aggcxt))
+		elog(ERROR, "aggregate function called in non-aggregate context");
+	if (PG_ARGISNULL(1))
+	{
+		if (PG_ARGISNULL(0))
+			PG_RETURN_NULL();
+		PG_RETURN_DATUM(PG_GETARG_DATUM(0));
+	}
+	if (PG_ARGISNULL(0))
+		state = __pgstrom_quantile_sketch_new(aggcxt);
+	else
+		state = __pgstrom_quantile_sketch_validate(PG_GETARG_BYTEA_P(0));
+	state->counts[pg_quantile_sketch_index(PG_GETARG_FLOAT8(1))]++;
+	PG_RETURN_POINTER(state);
+}
+
+/*
+ * pgstrom_quantile_sketch_merge
+ */
+PG_FUNCTION_INFO_V1(pgstrom_quantile_sketch_merge);
+PUBLIC_FUNCTION(Datum)
+pgstrom_quantile_sketch_merge(PG_FUNCTION_ARGS)
+{
+	MemoryContext	aggcxt;
+	kagg_state__quantile_sketch_packed *state;
+	kagg_state__quantile_sketch_packed *arg;
+
+	if (!AggCheckCallContext(fcinfo, &aggcxt))
+		elog(ERROR, "aggregate function called in non-aggregate context");
+	if (PG_ARGISNULL(0))
+	{
+		if (PG_ARGISNULL(1))
+			PG_RETURN_NULL();
+		arg = __pgstrom_quantile_sketch_validate(PG_GETARG_BYTEA_P(1));
+		state = MemoryContextAlloc(aggcxt, VARSIZE(arg));
+		memcpy(state, arg, VARSIZE(arg));
+	}
+	else
+	{
+		state = __pgstrom_quantile_sketch_validate(PG_GETARG_BYTEA_P(0));
+		if (!PG_ARGISNULL(1))
+		{
+			arg = __pgstrom_quantile_sketch_validate(PG_GETARG_BYTEA_P(1));
+			for (uint32 index=0; index < state->ncounters; index++)
+				state->counts[index] += arg->counts[index];
+		}
+	}
+	PG_RETURN_POINTER(state);
+}
+
+/*
+ * __pgstrom_quantile_sketch_estimate
+ *
+ * It returns the representative value of the bucket that contains the
+ * 'fraction' position of the values; the midpoint of the bucket in the
+ * sense of the relative error.
+ */
+static float8
+__pgstrom_quantile_sketch_estimate(kagg_state__quantile_sketch_packed *state,
+								   uint64 total, float8 fraction)
+{
+	uint64		rank;
+	uint64		count = 0;
+	uint32		index;
+	int32		k;
+	float8		fval;
+
+	if (isnan(fraction) || fraction < 0.0 || fraction > 1.0)
+		ereport(ERROR,
+				(errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
+				 errmsg("percentile value %g is not between 0 and 1",
+						fraction)));
+	Assert(total > 0);
+	rank = (uint64)floor(fraction * (float8)(total - 1));
+	for (index=0; index < state->ncounters; index++)
+	{
+		count += state->counts[index];
+		if (count > rank)
+			break;
+	}
+	Assert(index < state->ncounters);
+
+	if (index == KAGG_QSKETCH_NCOUNTERS - 1)
+		return get_float8_nan();
+	if (index == KAGG_QSKETCH_NBUCKETS)
+		return 0.0;
+	if (index > KAGG_QSKETCH_NBUCKETS)
+		k = index - KAGG_QSKETCH_NBUCKETS - 1;
+	else
+		k = KAGG_QSKETCH_NBUCKETS - 1 - index;
+	fval = (KAGG_QSKETCH_MIN_VALUE * 2.0 * exp(KAGG_QSKETCH_LOG_GAMMA * (k+1)) /
+			(1.0 + exp(KAGG_QSKETCH_LOG_GAMMA)));
+	return (index > KAGG_QSKETCH_NBUCKETS ? fval : -fval);
+}
+
+static uint64
+__pgstrom_quantile_sketch_total(kagg_state__quantile_sketch_packed *state)
+{
+	uint64		total = 0;
+
+	for (uint32 index=0; index < state->ncounters; index++)
+		total += state->counts[index];
+	return total;
+}
+
+/*
+ * pgstrom_quantile_estimate
+ */
+PG_FUNCTION_INFO_V1(pgstrom_quantile_estimate);
+PUBLIC_FUNCTION(Datum)
+pgstrom_quantile_estimate(PG_FUNCTION_ARGS)
+{
+	kagg_state__quantile_sketch_packed *state;
+	float8		fraction = PG_GETARG_FLOAT8(1);
+	uint64		total;
+
+	state = __pgstrom_quantile_sketch_validate(PG_GETARG_BYTEA_P(0));
+	total = __pgstrom_quantile_sketch_total(state);
+	if (total == 0)
+		PG_RETURN_NULL();
+	PG_RETURN_FLOAT8(__pgstrom_quantile_sketch_estimate(state, total, fraction));
+}
+
+/*
+ * pgstrom_quantile_estimate_multi
+ */
+PG_FUNCTION_INFO_V1(pgstrom_quantile_estimate_multi);
+PUBLIC_FUNCTION(Datum)
+pgstrom_quantile_estimate_multi(PG_FUNCTION_ARGS)
+{
+	kagg_state__quantile_sketch_packed *state;
+	ArrayType  *fractions = PG_GETARG_ARRAYTYPE_P(1);
+	Datum	   *values;
+	bool	   *nulls;
+	int			nitems;
+	int			dims[1];
+	int			lbs[1];
+	uint64		total;
+
+	state = __pgstrom_quantile_sketch_validate(PG_GETARG_BYTEA_P(0));
+	total = __pgstrom_quantile_sketch_total(state);
+	if (total == 0)
+		PG_RETURN_NULL();
+	if (ARR_NDIM(fractions) > 1)
+		ereport(ERROR,
+				(errcode(ERRCODE_ARRAY_SUBSCRIPT_ERROR),
+				 errmsg("multidimensional arrays are not supported")));
+	deconstruct_array(fractions,
+					  FLOAT8OID,
+					  sizeof(float8),
+					  FLOAT8PASSBYVAL,
+					  'd',
+					  &values, &nulls, &nitems);
+	for (int i=0; i < nitems; i++)
+	{
+		if (!nulls[i])
+		{
+			float8	fval = __pgstrom_quantile_sketch_estimate(state, total,
+															  DatumGetFloat8(values[i]));
+			values[i] = Float8GetDatum(fval);
+		}
+	}
+	dims[0] = nitems;
+	lbs[0] = (ARR_NDIM(fractions) > 0 ? ARR_LBOUND(fractions)[0] : 1);
+	PG_RETURN_POINTER(construct_md_array(values, nulls,
+										 1, dims, lbs,
+										 FLOAT8OID,
+										 sizeof(float8),
+										 FLOAT8PASSBYVAL,
+										 'd'));
+}
+
+/*
+ * pgstrom_partial_string_agg
+ */
+PG_FUNCTION_INFO_V1(pgstrom_partial_string_agg);
+PUBLIC_FUNCTION(Datum)
+pgstrom_partial_string_agg(PG_FUNCTION_ARGS)
+{
+	kagg_state__string_agg_packed *state;
+	kagg_string_agg_item *item;
+	bytea	   *value;
+	bytea	   *delim = NULL;
+	uint32_t	vlen, dlen = 0;
+	size_t		sz;
+
+	if (PG_ARGISNULL(0))
+		PG_RETURN_NULL();
+	value = PG_GETARG_BYTEA_PP(0);
+	vlen = VARSIZE_ANY_EXHDR(value);
+	if (!PG_ARGISNULL(1))
+	{
+		delim = PG_GETARG_BYTEA_PP(1);
+		dlen = VARSIZE_ANY_EXHDR(delim);
+	}
+	sz = KAGG_STATE__STRING_AGG_SZ + KAGG_STRING_AGG_ITEM_SZ(dlen, vlen);
+	state = palloc0(sz);
+	SET_VARSIZE(state, sz);
+	state->nitems = 1;
+	item = (kagg_string_agg_item *)state->data;
+	item->dlen = dlen;
+	item->vlen = vlen;
+	if (dlen > 0)
+		memcpy(item->data, VARDATA_ANY(delim), dlen);
+	memcpy(item->data + dlen, VARDATA_ANY(value), vlen);
+
+	PG_RETURN_POINTER(state);
+}
+
+/*
+ * pgstrom_string_agg_accum
+ */
+PG_FUNCTION_INFO_V1(pgstrom_string_agg_accum);
+PUBLIC_FUNCTION(Datum)
+pgstrom_string_agg_accum(PG_FUNCTION_ARGS)
+{
+	MemoryContext	aggcxt;
+	MemoryContext	oldcxt;
+	StringInfo		buf;
+	kagg_state__string_agg_packed *arg;
+	const char	   *pos;
+	const char	   *end;
+
+	if (!AggCheckCallContext(fcinfo, &aggcxt))
+		elog(ERROR, "aggregate function called in non-aggregate context");
+	buf = (PG_ARGISNULL(0) ? NULL : (StringInfo)PG_GETARG_POINTER(0));
+	if (PG_ARGISNULL(1))
+		PG_RETURN_POINTER(buf);
+	arg = (kagg_state__string_agg_packed *)PG_GETARG_BYTEA_P(1);
+	if (VARSIZE(arg) < KAGG_STATE__STRING_AGG_SZ || arg->head != 0)
+		elog(ERROR, "string_agg state looks corrupted");
+	pos = arg->data;
+	end = (const char *)arg + VARSIZE(arg);
+	for (uint32_t i=0; i < arg->nitems; i++)
+	{
+		const kagg_string_agg_item *item = (const kagg_string_agg_item *)pos;
+
+		if (pos + offsetof(kagg_string_agg_item, data) > end ||
+			pos + KAGG_STRING_AGG_ITEM_SZ(item->dlen, item->vlen) > end)
+			elog(ERROR, "string_agg state looks corrupted");
+		oldcxt = MemoryContextSwitchTo(aggcxt);
+		if (!buf)
+		{
+			buf = makeStringInfo();
+			/* the delimiter of the first item shall be removed at final */
+			buf->cursor = item->dlen;
+		}
+		appendBinaryStringInfo(buf, item->data, item->dlen + item->vlen);
+		MemoryContextSwitchTo(oldcxt);
+		pos += KAGG_STRING_AGG_ITEM_SZ(item->dlen, item->vlen);
+	}
+	PG_RETURN_POINTER(buf);
+}
+
+/*
+ * pgstrom_string_agg_final
+ */
+PG_FUNCTION_INFO_V1(pgstrom_string_agg_final);
+PUBLIC_FUNCTION(Datum)
+pgstrom_string_agg_final(PG_FUNCTION_ARGS)
+{
+	StringInfo	buf;
+	bytea	   *result;
+	int			len;
+
+	if (PG_ARGISNULL(0))
+		PG_RETURN_NULL();
+	buf = (StringInfo)PG_GETARG_POINTER(0);
+	len = buf->len - buf->cursor;
+	result = palloc(VARHDRSZ + len);
+	SET_VARSIZE(result, VARHDRSZ + len);
+	memcpy(VARDATA(result), buf->data + buf->cursor, len);
+	/* text and bytea have identical representation */
 	PG_RETURN_POINTER(result);
 }
-#endif
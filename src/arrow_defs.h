@@ -97,6 +97,8 @@ typedef enum
 	ArrowType__LargeBinary		= 19,
 	ArrowType__LargeUtf8		= 20,
 	ArrowType__LargeList		= 21,
+	ArrowType__BinaryView		= 23,
+	ArrowType__Utf8View			= 24,
 } ArrowTypeTag;
 
 /*
@@ -175,6 +177,8 @@ typedef enum
 	ArrowNodeTag__LargeBinary,
 	ArrowNodeTag__LargeUtf8,
 	ArrowNodeTag__LargeList,
+	ArrowNodeTag__BinaryView,
+	ArrowNodeTag__Utf8View,
 	/* others */
 	ArrowNodeTag__KeyValue,
 	ArrowNodeTag__DictionaryEncoding,
@@ -225,6 +229,7 @@ typedef struct ArrowTypeOptions
 		} interval;
 		struct {
 			unsigned int		byteWidth;
+			int					srid;	/* only if geometry point */
 		} fixed_size_binary;
 	};
 } ArrowTypeOptions;
@@ -374,6 +379,12 @@ typedef ArrowNode	ArrowTypeLargeUtf8;
 /* LargeList */
 typedef ArrowNode	ArrowTypeLargeList;
 
+/* BinaryView */
+typedef ArrowNode	ArrowTypeBinaryView;
+
+/* Utf8View */
+typedef ArrowNode	ArrowTypeUtf8View;
+
 /*
  * ArrowType
  */
@@ -401,6 +412,8 @@ typedef union		ArrowType
 	ArrowTypeLargeBinary	LargeBinary;
 	ArrowTypeLargeUtf8		LargeUtf8;
 	ArrowTypeLargeList		LargeList;
+	ArrowTypeBinaryView		BinaryView;
+	ArrowTypeUtf8View		Utf8View;
 } ArrowType;
 
 /*
@@ -525,6 +538,9 @@ typedef struct		ArrowRecordBatch
 	int				_num_buffers;
 	/* optional compression of the message body */
 	ArrowBodyCompression *compression;
+	/* number of variadic data buffers for each BinaryView/Utf8View field */
+	int64_t		   *variadicBufferCounts;
+	int				_num_variadicBufferCounts;
 } ArrowRecordBatch;
 
 /*
@@ -9,9 +9,16 @@
  * This program is free software; you can redistribute it and/or modify
  * it under the terms of the PostgreSQL License.
  */
+#ifdef WITH_LIBLZ4
+#include <lz4frame.h>
+#endif
+#ifdef WITH_LIBZSTD
+#include <zstd.h>
+#endif
 #include "pg_strom.h"
 #include "arrow_defs.h"
 #include "arrow_ipc.h"
+#include "parquet_defs.h"
 #include "xpu_numeric.h"
 
 /*
@@ -47,6 +54,22 @@ typedef struct RecordBatchFieldState
 	size_t		values_length;
 	off_t		extra_offset;
 	size_t		extra_length;
+	/*
+	 * dictionary encoding, if dict_index_unitsz > 0. The values/extra buffers
+	 * are the ones of the DictionaryBatch, so their offsets are relative to the
+	 * record-batch and may be negative.
+	 */
+	int			dict_index_unitsz;
+	off_t		dict_index_offset;
+	size_t		dict_index_length;
+	/*
+	 * BinaryView/Utf8View, if string_view. The values buffer keeps the views,
+	 * and the children keep the variadic data buffers in their extra buffer.
+	 * It is decoded to the Binary/Utf8 layout by the host on the loading time.
+	 */
+	bool		string_view;
+	/* properties of the column chunk, if parquet row-group */
+	ParquetColumnDesc pq_desc;
 	MinMaxStatDatum stat_datum;
 	/* sub-fields if any */
 	int			num_children;
@@ -60,6 +83,9 @@ typedef struct RecordBatchState
 	off_t		rb_offset;	/* offset from the head */
 	size_t		rb_length;	/* length of the entire RecordBatch */
 	int64		rb_nitems;	/* number of items */
+	int			rb_compression;	/* ArrowCompressionType, or -1 */
+	bool		rb_parquet;	/* row-group of the parquet file */
+	bool		rb_string_view;	/* contains BinaryView/Utf8View fields */
 	/* per column information */
 	int			nfields;
 	RecordBatchFieldState fields[FLEXIBLE_ARRAY_MEMBER];
@@ -71,6 +97,9 @@ typedef struct ArrowFileState
 	const char *dpu_path;	/* relative pathname, if DPU */
 	struct stat	stat_buf;
 	List	   *rb_list;	/* list of RecordBatchState */
+	bool		stats_synth;	/* min/max stats are synthesized on scan */
+	bool		is_remote;	/* remote file by URL (http:// or https://) */
+	uint64_t	stat_nr_iochunks;	/* i/o chunks to load, for EXPLAIN ANALYZE */
 } ArrowFileState;
 
 /*
@@ -80,26 +109,57 @@ typedef struct
 {
 	Bitmapset	   *stat_attrs;
 	Bitmapset	   *load_attrs;
+	Bitmapset	   *synth_attrs;	/* min/max can be synthesized */
 	List		   *orig_quals;		/* for EXPLAIN */
 	List		   *eval_quals;
 	ExprState	   *eval_state;
 	ExprContext	   *econtext;
 } arrowStatsHint;
 
+typedef struct
+{
+	Relation		frel;
+	Bitmapset	   *pred_referenced;	/* columns referenced by the quals */
+	List		   *orig_quals;		/* for EXPLAIN */
+	ExprState	   *eval_state;
+	ExprContext	   *econtext;
+	TupleTableSlot *pred_slot;
+	StringInfoData	pred_buffer;	/* buffer to load predicate columns */
+} arrowLateMat;
+
 struct ArrowFdwState
 {
 	Bitmapset		   *referenced;		/* referenced columns */
 	arrowStatsHint	   *stats_hint;		/* min/max statistics, if any */
+	arrowLateMat	   *late_mat;		/* late materialization, if any */
+	AttrNumber			join_key_anum;	/* range of the inner hash-key, */
+	int64_t				join_key_min;	/* if GpuJoin set up */
+	int64_t				join_key_max;
 	pg_atomic_uint32   *rbatch_index;
 	pg_atomic_uint32	__rbatch_index_local;	/* if single process */
 	pg_atomic_uint32   *rbatch_nload;
 	pg_atomic_uint32	__rbatch_nload_local;	/* if single process */
 	pg_atomic_uint32   *rbatch_nskip;
 	pg_atomic_uint32	__rbatch_nskip_local;	/* if single process */
+	pg_atomic_uint32   *rbatch_nprune;
+	pg_atomic_uint32	__rbatch_nprune_local;	/* if single process */
 	StringInfoData		chunk_buffer;	/* buffer to load record-batch */
+	StringInfoData		coalesce_buffer; /* buffer to merge small record-batches */
+	RecordBatchState   *rb_pending;		/* next record-batch not coalesced */
+	ArrowFileState	   *chunk_af_state;	/* file of the last chunk */
+	int64_t				chunk_optimal_gpus;	/* optimal GPUs of chunk_af_state */
 	File				curr_filp;		/* current arrow file to read */
 	kern_data_store	   *curr_kds;		/* current chunk to read */
+	void			   *curr_mmap;		/* mmap address, if curr_kds is mapped */
 	uint32_t			curr_index;		/* current index on the chunk */
+	/* column-at-a-time deform for CPU scan */
+	MemoryContext		batch_memcxt;	/* memory context of the batch */
+	int					batch_natts;	/* number of referenced columns */
+	int				   *batch_attidx;	/* referenced column index */
+	Datum			  **batch_values;	/* [batch_natts][ARROW_DEFORM_BATCH_SZ] */
+	bool			  **batch_isnull;	/* [batch_natts][ARROW_DEFORM_BATCH_SZ] */
+	uint32_t			batch_head;		/* first index of the batch */
+	uint32_t			batch_nitems;	/* number of rows in the batch */
 	List			   *af_states_list;	/* list of ArrowFileState */
 	uint32_t			rb_nitems;		/* number of record-batches */
 	RecordBatchState   *rb_states[FLEXIBLE_ARRAY_MEMBER]; /* flatten RecordBatchState */
@@ -138,6 +198,11 @@ struct arrowMetadataFieldCache
 	size_t		values_length;
 	off_t		extra_offset;
 	size_t		extra_length;
+	int			dict_index_unitsz;
+	off_t		dict_index_offset;
+	size_t		dict_index_length;
+	bool		string_view;
+	ParquetColumnDesc pq_desc;
 	MinMaxStatDatum stat_datum;
 	/* sub-fields if any */
 	int			num_children;
@@ -157,6 +222,9 @@ struct arrowMetadataCache
 	off_t		rb_offset;	/* offset from the head */
 	size_t		rb_length;	/* length of the entire RecordBatch */
 	int64		rb_nitems;	/* number of items */
+	int			rb_compression;	/* ArrowCompressionType, or -1 */
+	bool		rb_parquet;	/* row-group of the parquet file */
+	bool		rb_string_view;	/* contains BinaryView/Utf8View fields */
 	/* per column information */
 	int			nfields;
 	dlist_head	fields;		/* list of arrowMetadataFieldCache */
@@ -187,7 +255,14 @@ static shmem_startup_hook_type shmem_startup_next = NULL;
 static arrowMetadataCacheHead *arrow_metadata_cache = NULL;
 static bool					arrow_fdw_enabled;	/* GUC */
 static bool					arrow_fdw_stats_hint_enabled;	/* GUC */
+static bool					arrow_fdw_stats_synthesis_enabled;	/* GUC */
+static bool					arrow_fdw_late_materialization;	/* GUC */
+static bool					arrow_fdw_mmap_enabled;			/* GUC */
 static int					arrow_metadata_cache_size_kb;	/* GUC */
+static int					arrow_io_coalesce_gap_kb;		/* GUC */
+static bool					arrow_fdw_metadata_index_enabled;	/* GUC */
+static int					arrow_record_batch_size_kb;		/* GUC */
+static int					arrow_coalesce_batch_size_kb;	/* GUC */
 
 /* ----------------------------------------------------------------
  *
@@ -196,6 +271,29 @@ static int					arrow_metadata_cache_size_kb;	/* GUC */
  * ----------------------------------------------------------------
  */
 
+/*
+ * arrowFieldGetGeometrySRID
+ */
+static int
+arrowFieldGetGeometrySRID(const ArrowField *field)
+{
+	for (int i=0; i < field->_num_custom_metadata; i++)
+	{
+		ArrowKeyValue *kv = &field->custom_metadata[i];
+		char	   *end;
+		long		srid;
+
+		if (strcmp(kv->key, "srid") != 0)
+			continue;
+		srid = strtol(kv->value, &end, 10);
+		if (*end != '\0' || srid < 0 || srid > SRID_MAXIMUM)
+			elog(ERROR, "arrow_fdw: field '%s' has invalid srid (%s)",
+				 field->name, kv->value);
+		return srid;
+	}
+	return SRID_UNKNOWN;
+}
+
 /*
  * arrowFieldGetPGTypeHint
  */
@@ -868,6 +966,9 @@ __applyArrowFieldStatsBinary(RecordBatchFieldState *rb_field,
 	{
 		rb_field->stat_datum.isnull = true;
 	}
+	/* children of BinaryView/Utf8View are data buffers, not sub-fields */
+	if (rb_field->string_view)
+		return;
 	Assert(rb_field->num_children == bstats->nfields);
 	for (j=0; j < rb_field->num_children; j++)
 	{
@@ -1051,7 +1152,8 @@ __buildArrowStatsOper(arrowStatsHint *as_hint,
 }
 
 static arrowStatsHint *
-execInitArrowStatsHint(ScanState *ss, List *outer_quals, Bitmapset *stat_attrs)
+execInitArrowStatsHint(ScanState *ss, List *outer_quals,
+					   Bitmapset *stat_attrs, Bitmapset *synth_attrs)
 {
 	Relation		relation = ss->ss_currentRelation;
 	TupleDesc		tupdesc = RelationGetDescr(relation);
@@ -1062,7 +1164,7 @@ execInitArrowStatsHint(ScanState *ss, List *outer_quals, Bitmapset *stat_attrs)
 
 	outer_quals = fixup_scanstate_expressions(ss, outer_quals);
 	as_hint = palloc0(sizeof(arrowStatsHint));
-	as_hint->stat_attrs = stat_attrs;
+	as_hint->stat_attrs = bms_union(stat_attrs, synth_attrs);
 	foreach (lc, outer_quals)
 	{
 		OpExpr *op = lfirst(lc);
@@ -1076,6 +1178,7 @@ execInitArrowStatsHint(ScanState *ss, List *outer_quals, Bitmapset *stat_attrs)
 	}
 	if (as_hint->eval_quals == NIL)
 		return NULL;
+	as_hint->synth_attrs = bms_intersect(synth_attrs, as_hint->load_attrs);
 	if (list_length(as_hint->eval_quals) == 1)
 		eval_expr = linitial(as_hint->eval_quals);
 	else
@@ -1091,6 +1194,238 @@ execInitArrowStatsHint(ScanState *ss, List *outer_quals, Bitmapset *stat_attrs)
 	return as_hint;
 }
 
+/*
+ * __synthArrowFieldStats
+ *
+ * If the file has no custom min/max metadata for the field, it computes the
+ * min/max statistics from the values buffer on the first scan. Only
+ * uncompressed fixed-length fields are supported.
+ */
+static bool
+__arrowFieldStatsSynthesizable(RecordBatchFieldState *rb_field)
+{
+	const ArrowTypeOptions *attopts = &rb_field->attopts;
+
+	if (rb_field->num_children > 0 ||
+		rb_field->dict_index_unitsz > 0)
+		return false;
+	switch (attopts->tag)
+	{
+		case ArrowType__Int:
+			return (attopts->unitsz == sizeof(int16_t) ||
+					attopts->unitsz == sizeof(int32_t) ||
+					attopts->unitsz == sizeof(int64_t));
+		case ArrowType__FloatingPoint:
+			return (attopts->floating_point.precision == ArrowPrecision__Single ||
+					attopts->floating_point.precision == ArrowPrecision__Double);
+		case ArrowType__Date:
+			return (attopts->date.unit == ArrowDateUnit__Day);
+		case ArrowType__Time:
+		case ArrowType__Timestamp:
+			return (attopts->unitsz == sizeof(int32_t) ||
+					attopts->unitsz == sizeof(int64_t));
+		default:
+			break;
+	}
+	return false;
+}
+
+static bool
+__synthArrowFieldStats(RecordBatchState *rb_state,
+					   RecordBatchFieldState *rb_field)
+{
+	ArrowFileState *af_state = rb_state->af_state;
+	const ArrowTypeOptions *attopts = &rb_field->attopts;
+	int64		nitems = rb_field->nitems;
+	size_t		values_sz = attopts->unitsz * nitems;
+	size_t		nullmap_sz = (nitems + 7) / 8;
+	uint8_t	   *nullmap = NULL;
+	char	   *values;
+	int64		ival, imin = 0, imax = 0;
+	float8		fval, fmin = 0.0, fmax = 0.0;
+	bool		has_nan = false;
+	bool		found = false;
+	int			fdesc;
+
+	if (rb_state->rb_compression >= 0 ||
+		rb_state->rb_parquet ||
+		af_state->is_remote ||
+		nitems <= 0 ||
+		rb_field->null_count >= nitems ||
+		rb_field->values_length < values_sz ||
+		(rb_field->null_count > 0 &&
+		 rb_field->nullmap_length < nullmap_sz) ||
+		!__arrowFieldStatsSynthesizable(rb_field))
+		return false;
+
+	fdesc = OpenTransientFile(af_state->filename, O_RDONLY | PG_BINARY);
+	if (fdesc < 0)
+	{
+		elog(DEBUG1, "could not open file \"%s\": %m", af_state->filename);
+		return false;
+	}
+	values = palloc_extended(values_sz, MCXT_ALLOC_HUGE);
+	if (__preadFile(fdesc, values, values_sz,
+					rb_state->rb_offset +
+					rb_field->values_offset) != values_sz)
+		goto bailout;
+	if (rb_field->null_count > 0)
+	{
+		nullmap = palloc_extended(nullmap_sz, MCXT_ALLOC_HUGE);
+		if (__preadFile(fdesc, nullmap, nullmap_sz,
+						rb_state->rb_offset +
+						rb_field->nullmap_offset) != nullmap_sz)
+			goto bailout;
+	}
+
+	for (int64 i=0; i < nitems; i++)
+	{
+		if ((i & 0xffffL) == 0)
+			CHECK_FOR_INTERRUPTS();
+		if (nullmap && (nullmap[i>>3] & (1<<(i & 7))) == 0)
+			continue;
+		if (attopts->tag == ArrowType__FloatingPoint)
+		{
+			if (attopts->unitsz == sizeof(float4))
+				fval = ((float4 *)values)[i];
+			else
+				fval = ((float8 *)values)[i];
+			/* NaN is larger than any other values in PostgreSQL */
+			if (isnan(fval))
+				has_nan = true;
+			else if (!found)
+			{
+				fmin = fmax = fval;
+				found = true;
+			}
+			else
+			{
+				fmin = Min(fmin, fval);
+				fmax = Max(fmax, fval);
+			}
+		}
+		else
+		{
+			switch (attopts->unitsz)
+			{
+				case sizeof(int16_t):
+					ival = ((int16_t *)values)[i];
+					break;
+				case sizeof(int32_t):
+					ival = ((int32_t *)values)[i];
+					break;
+				default:
+					ival = ((int64_t *)values)[i];
+					break;
+			}
+			if (!found)
+			{
+				imin = imax = ival;
+				found = true;
+			}
+			else
+			{
+				imin = Min(imin, ival);
+				imax = Max(imax, ival);
+			}
+		}
+	}
+
+	if (attopts->tag == ArrowType__FloatingPoint)
+	{
+		if (has_nan)
+		{
+			if (!found)
+				fmin = get_float8_nan();
+			fmax = get_float8_nan();
+		}
+		else if (!found)
+			goto bailout;
+		if (attopts->unitsz == sizeof(float4))
+		{
+			rb_field->stat_datum.min.datum = Float4GetDatum((float4)fmin);
+			rb_field->stat_datum.max.datum = Float4GetDatum((float4)fmax);
+		}
+		else
+		{
+			rb_field->stat_datum.min.datum = Float8GetDatum(fmin);
+			rb_field->stat_datum.max.datum = Float8GetDatum(fmax);
+		}
+	}
+	else
+	{
+		int64		__drift;
+
+		if (!found)
+			goto bailout;
+		switch (attopts->tag)
+		{
+			case ArrowType__Date:
+				imin -= (POSTGRES_EPOCH_JDATE - UNIX_EPOCH_JDATE);
+				imax -= (POSTGRES_EPOCH_JDATE - UNIX_EPOCH_JDATE);
+				break;
+			case ArrowType__Time:
+				switch (attopts->time.unit)
+				{
+					case ArrowTimeUnit__Second:
+						imin *= 1000000L;
+						imax *= 1000000L;
+						break;
+					case ArrowTimeUnit__MilliSecond:
+						imin *= 1000L;
+						imax *= 1000L;
+						break;
+					case ArrowTimeUnit__MicroSecond:
+						break;
+					case ArrowTimeUnit__NanoSecond:
+						imin /= 1000L;
+						imax /= 1000L;
+						break;
+					default:
+						goto bailout;
+				}
+				break;
+			case ArrowType__Timestamp:
+				__drift = (POSTGRES_EPOCH_JDATE - UNIX_EPOCH_JDATE) * USECS_PER_DAY;
+				switch (attopts->timestamp.unit)
+				{
+					case ArrowTimeUnit__Second:
+						imin = imin * 1000000L - __drift;
+						imax = imax * 1000000L - __drift;
+						break;
+					case ArrowTimeUnit__MilliSecond:
+						imin = imin * 1000L - __drift;
+						imax = imax * 1000L - __drift;
+						break;
+					case ArrowTimeUnit__MicroSecond:
+						imin = imin - __drift;
+						imax = imax - __drift;
+						break;
+					case ArrowTimeUnit__NanoSecond:
+						imin = imin / 1000L - __drift;
+						imax = imax / 1000L - __drift;
+						break;
+					default:
+						goto bailout;
+				}
+				break;
+			default:
+				break;
+		}
+		rb_field->stat_datum.min.datum = Int64GetDatum(imin);
+		rb_field->stat_datum.max.datum = Int64GetDatum(imax);
+	}
+	rb_field->stat_datum.isnull = false;
+	af_state->stats_synth = true;
+bailout:
+	if (nullmap)
+		pfree(nullmap);
+	pfree(values);
+	CloseTransientFile(fdesc);
+
+	return !rb_field->stat_datum.isnull;
+}
+
 static bool
 execCheckArrowStatsHint(arrowStatsHint *stats_hint,
 						RecordBatchState *rb_state)
@@ -1112,6 +1447,9 @@ execCheckArrowStatsHint(arrowStatsHint *stats_hint,
 		RecordBatchFieldState *rb_field = &rb_state->fields[anum-1];
 
 		Assert(anum > 0 && anum <= rb_state->nfields);
+		if (rb_field->stat_datum.isnull &&
+			bms_is_member(anum, stats_hint->synth_attrs))
+			__synthArrowFieldStats(rb_state, rb_field);
 		if (!rb_field->stat_datum.isnull)
 		{
 			min_values->tts_isnull[anum-1] = false;
@@ -1174,6 +1512,12 @@ __buildRecordBatchFieldStateByCache(RecordBatchFieldState *rb_field,
 	rb_field->values_length  = fcache->values_length;
 	rb_field->extra_offset   = fcache->extra_offset;
 	rb_field->extra_length   = fcache->extra_length;
+	rb_field->dict_index_unitsz = fcache->dict_index_unitsz;
+	rb_field->dict_index_offset = fcache->dict_index_offset;
+	rb_field->dict_index_length = fcache->dict_index_length;
+	rb_field->string_view    = fcache->string_view;
+	memcpy(&rb_field->pq_desc,
+		   &fcache->pq_desc, sizeof(ParquetColumnDesc));
 	memcpy(&rb_field->stat_datum,
 		   &fcache->stat_datum, sizeof(MinMaxStatDatum));
 	if (fcache->num_children > 0)
@@ -1222,6 +1566,9 @@ __buildArrowFileStateByCache(const char *filename,
 		rb_state->rb_offset = mcache->rb_offset;
 		rb_state->rb_length = mcache->rb_length;
 		rb_state->rb_nitems = mcache->rb_nitems;
+		rb_state->rb_compression = mcache->rb_compression;
+		rb_state->rb_parquet = mcache->rb_parquet;
+		rb_state->rb_string_view = mcache->rb_string_view;
 		rb_state->nfields   = mcache->nfields;
 		dlist_foreach(iter, &mcache->fields)
 		{
@@ -1249,6 +1596,14 @@ typedef struct
 	ArrowBuffer	   *buffer_tail;
 	ArrowFieldNode *fnode_curr;
 	ArrowFieldNode *fnode_tail;
+	int64_t		   *variadic_curr;	/* variadicBufferCounts */
+	int64_t		   *variadic_tail;
+	bool			is_compressed;	/* buffer length is compressed size */
+	bool			has_string_view;
+	off_t			rb_offset;		/* offset of the record-batch body */
+	int				num_dictionaries;
+	ArrowBlock	   *dict_blocks;
+	ArrowMessage   *dict_messages;
 } setupRecordBatchContext;
 
 static Oid
@@ -1507,6 +1862,19 @@ __arrowFieldTypeToPGType(const ArrowField *field,
 			{
 				type_oid = INETOID;
 			}
+			else if (OidIsValid(hint_oid) &&
+					 hint_oid == get_geometry_type_oid(true) &&
+					 t->FixedSizeBinary.byteWidth == 2 * sizeof(float8))
+			{
+				/*
+				 * Interleaved XY coordinates of the point, as GeoArrow
+				 * 'geoarrow.point' doing; the device code references
+				 * the values array as geometry points without any
+				 * deserialization.
+				 */
+				type_oid = hint_oid;
+				attopts.fixed_size_binary.srid = arrowFieldGetGeometrySRID(field);
+			}
 			else
 			{
 				type_oid = BPCHAROID;
@@ -1546,6 +1914,26 @@ __arrowFieldTypeToPGType(const ArrowField *field,
 				type_oid = BYTEAOID;
 			break;
 
+		/*
+		 * BinaryView/Utf8View are decoded to the Binary/Utf8 layout on the
+		 * loading time, so the KDS looks like usual variable-length fields.
+		 */
+		case ArrowNodeTag__Utf8View:
+			attopts.tag = ArrowType__Utf8;
+			attopts.unitsz = sizeof(uint32_t);
+			type_oid = TEXTOID;
+			break;
+
+		case ArrowNodeTag__BinaryView:
+			attopts.tag = ArrowType__Binary;
+			attopts.unitsz = sizeof(uint32_t);
+			if (OidIsValid(hint_oid) &&
+				hint_oid == get_cube_type_oid(true))
+				type_oid = hint_oid;
+			else
+				type_oid = BYTEAOID;
+			break;
+
 		case ArrowNodeTag__List:
 		case ArrowNodeTag__LargeList:
 			if (field->_num_children != 1)
@@ -1603,6 +1991,114 @@ __arrowFieldTypeToPGType(const ArrowField *field,
 		memcpy(p_attopts, &attopts, sizeof(ArrowTypeOptions));
 }
 
+/*
+ * __buildRecordBatchFieldDictionary
+ *
+ * A dictionary encoded field has nullmap and index buffers in the record-batch,
+ * and its values/extra buffers come from the DictionaryBatch with the same id.
+ * Right now, only variable length types (Utf8/Binary) are supported.
+ */
+static void
+__buildRecordBatchFieldDictionary(setupRecordBatchContext *con,
+								  RecordBatchFieldState *rb_field,
+								  ArrowField *field, int depth)
+{
+	ArrowDictionaryEncoding *dict = field->dictionary;
+	ArrowDictionaryBatch *dbatch = NULL;
+	ArrowBlock	   *dblock = NULL;
+	ArrowBuffer	   *buffer_curr;
+	off_t			dict_offset;
+	int				unitsz;
+
+	if (depth > 0)
+		elog(ERROR, "arrow_fdw: nested dictionary encoded field is not supported");
+	switch (field->type.node.tag)
+	{
+		case ArrowNodeTag__Utf8:
+		case ArrowNodeTag__LargeUtf8:
+		case ArrowNodeTag__Binary:
+		case ArrowNodeTag__LargeBinary:
+			break;
+		default:
+			elog(ERROR, "arrow_fdw: dictionary encoded field '%s' must be Utf8 or Binary",
+				 field->name);
+	}
+	unitsz = dict->indexType.bitWidth / BITS_PER_BYTE;
+	if (unitsz != sizeof(int8_t)  && unitsz != sizeof(int16_t) &&
+		unitsz != sizeof(int32_t) && unitsz != sizeof(int64_t))
+		elog(ERROR, "arrow_fdw: unexpected dictionary index width (%d)",
+			 dict->indexType.bitWidth);
+	if (con->is_compressed)
+		elog(ERROR, "arrow_fdw: compressed dictionary encoded field is not supported");
+
+	/* lookup the DictionaryBatch */
+	for (int i=0; i < con->num_dictionaries; i++)
+	{
+		ArrowDictionaryBatch *__dbatch = &con->dict_messages[i].body.dictionaryBatch;
+
+		if (__dbatch->node.tag != ArrowNodeTag__DictionaryBatch ||
+			__dbatch->id != dict->id)
+			continue;
+		if (dbatch)
+			elog(ERROR, "arrow_fdw: dictionary replacement (id=%ld) is not supported",
+				 dict->id);
+		dbatch = __dbatch;
+		dblock = &con->dict_blocks[i];
+	}
+	if (!dbatch)
+		elog(ERROR, "arrow_fdw: DictionaryBatch (id=%ld) is missing", dict->id);
+	if (dbatch->isDelta)
+		elog(ERROR, "arrow_fdw: delta DictionaryBatch is not supported");
+	if (dbatch->data.compression)
+		elog(ERROR, "arrow_fdw: compressed DictionaryBatch is not supported");
+	if (dbatch->data._num_nodes != 1 ||
+		dbatch->data._num_buffers != 3)
+		elog(ERROR, "arrow_fdw: DictionaryBatch (id=%ld) has unexpected layout",
+			 dict->id);
+	if (dbatch->data.nodes[0].null_count > 0)
+		elog(ERROR, "arrow_fdw: DictionaryBatch (id=%ld) contains NULL entries",
+			 dict->id);
+
+	/* nullmap and index buffers on the record-batch */
+	buffer_curr = con->buffer_curr++;
+	if (buffer_curr >= con->buffer_tail)
+		elog(ERROR, "RecordBatch has less buffers than expected");
+	if (rb_field->null_count > 0)
+	{
+		rb_field->nullmap_offset = buffer_curr->offset;
+		rb_field->nullmap_length = buffer_curr->length;
+		if (rb_field->nullmap_length < BITMAPLEN(rb_field->nitems))
+			elog(ERROR, "nullmap length is smaller than expected");
+		if (rb_field->nullmap_offset != MAXALIGN(rb_field->nullmap_offset))
+			elog(ERROR, "nullmap is not aligned well");
+	}
+	buffer_curr = con->buffer_curr++;
+	if (buffer_curr >= con->buffer_tail)
+		elog(ERROR, "RecordBatch has less buffers than expected");
+	rb_field->dict_index_unitsz = unitsz;
+	rb_field->dict_index_offset = buffer_curr->offset;
+	rb_field->dict_index_length = buffer_curr->length;
+	if (rb_field->dict_index_length < unitsz * rb_field->nitems)
+		elog(ERROR, "dictionary index array is smaller than expected");
+	if (rb_field->dict_index_offset != MAXALIGN(rb_field->dict_index_offset))
+		elog(ERROR, "dictionary index array is not aligned well");
+
+	/* values and extra buffers on the DictionaryBatch */
+	dict_offset = (dblock->offset + dblock->metaDataLength) - con->rb_offset;
+	rb_field->values_offset = dict_offset + dbatch->data.buffers[1].offset;
+	rb_field->values_length = dbatch->data.buffers[1].length;
+	rb_field->extra_offset  = dict_offset + dbatch->data.buffers[2].offset;
+	rb_field->extra_length  = dbatch->data.buffers[2].length;
+	if (rb_field->values_length < (rb_field->attopts.unitsz *
+								   (dbatch->data.nodes[0].length + 1)))
+		elog(ERROR, "dictionary values array is smaller than expected");
+	if (rb_field->values_offset != MAXALIGN(rb_field->values_offset) ||
+		rb_field->extra_offset  != MAXALIGN(rb_field->extra_offset))
+		elog(ERROR, "dictionary is not aligned well");
+	if (field->_num_children > 0)
+		elog(ERROR, "arrow_fdw: dictionary encoded field has children");
+}
+
 static void
 __buildRecordBatchFieldState(setupRecordBatchContext *con,
 							 RecordBatchFieldState *rb_field,
@@ -1625,6 +2121,12 @@ __buildRecordBatchFieldState(setupRecordBatchContext *con,
 							 &rb_field->atttypid,
 							 &rb_field->atttypmod,
 							 &rb_field->attopts);
+	/* dictionary encoded field */
+	if (field->dictionary)
+	{
+		__buildRecordBatchFieldDictionary(con, rb_field, field, depth);
+		return;
+	}
 	/* assign buffers */
 	switch (field->type.node.tag)
 	{
@@ -1650,6 +2152,13 @@ __buildRecordBatchFieldState(setupRecordBatchContext *con,
 			has_extra_buffer = true;
 			break;
 
+		case ArrowNodeTag__Utf8View:
+		case ArrowNodeTag__BinaryView:
+			/* 16bytes view for each item, then variadic data buffers */
+			least_values_length = 16 * rb_field->nitems;
+			rb_field->string_view = true;
+			break;
+
 		case ArrowNodeTag__List:
         case ArrowNodeTag__LargeList:
 			if (depth > 0)
@@ -1674,7 +2183,8 @@ __buildRecordBatchFieldState(setupRecordBatchContext *con,
 	{
 		rb_field->nullmap_offset = buffer_curr->offset;
 		rb_field->nullmap_length = buffer_curr->length;
-		if (rb_field->nullmap_length < BITMAPLEN(rb_field->nitems))
+		if (!con->is_compressed &&
+			rb_field->nullmap_length < BITMAPLEN(rb_field->nitems))
 			elog(ERROR, "nullmap length is smaller than expected");
 		if (rb_field->nullmap_offset != MAXALIGN(rb_field->nullmap_offset))
 			elog(ERROR, "nullmap is not aligned well");
@@ -1688,12 +2198,43 @@ __buildRecordBatchFieldState(setupRecordBatchContext *con,
 			elog(ERROR, "RecordBatch has less buffers than expected");
 		rb_field->values_offset = buffer_curr->offset;
 		rb_field->values_length = buffer_curr->length;
-		if (rb_field->values_length < least_values_length)
+		if (!con->is_compressed &&
+			rb_field->values_length < least_values_length)
 			elog(ERROR, "values array is smaller than expected");
 		if (rb_field->values_offset != MAXALIGN(rb_field->values_offset))
 			elog(ERROR, "values array is not aligned well");
 	}
 
+	/* setup variadic data buffers of BinaryView/Utf8View */
+	if (rb_field->string_view)
+	{
+		int64_t		nbuffers;
+
+		if (con->variadic_curr >= con->variadic_tail)
+			elog(ERROR, "RecordBatch has less variadicBufferCounts than expected");
+		nbuffers = *con->variadic_curr++;
+		if (nbuffers < 0 || nbuffers > con->buffer_tail - con->buffer_curr)
+			elog(ERROR, "RecordBatch has less buffers than expected");
+		if (nbuffers > 0)
+		{
+			rb_field->children = palloc0(sizeof(RecordBatchFieldState) * nbuffers);
+			for (int j=0; j < nbuffers; j++)
+			{
+				RecordBatchFieldState *__rb_data = &rb_field->children[j];
+
+				buffer_curr = con->buffer_curr++;
+				__rb_data->atttypid = BYTEAOID;
+				__rb_data->atttypmod = -1;
+				__rb_data->stat_datum.isnull = true;
+				__rb_data->extra_offset = buffer_curr->offset;
+				__rb_data->extra_length = buffer_curr->length;
+			}
+		}
+		rb_field->num_children = nbuffers;
+		con->has_string_view = true;
+		return;
+	}
+
 	/* setup extra buffer */
 	if (has_extra_buffer)
 	{
@@ -1724,18 +2265,42 @@ __buildRecordBatchFieldState(setupRecordBatchContext *con,
 }
 
 static RecordBatchState *
-__buildRecordBatchStateOne(ArrowSchema *schema,
+__buildRecordBatchStateOne(ArrowFileInfo *af_info,
 						   ArrowFileState *af_state,
 						   int rb_index,
 						   ArrowBlock *block,
 						   ArrowRecordBatch *rbatch)
 {
+	ArrowSchema *schema = &af_info->footer.schema;
 	setupRecordBatchContext con;
 	RecordBatchState *rb_state;
 	int			nfields = schema->_num_fields;
+	int			rb_compression = -1;
 
 	if (rbatch->compression)
-		elog(ERROR, "arrow_fdw: right now, compressed record-batche is not supported");
+	{
+		ArrowBodyCompression *compress = rbatch->compression;
+
+		if (compress->method != ArrowBodyCompressionMethod__BUFFER)
+			elog(ERROR, "arrow_fdw: unknown body compression method (%d)",
+				 (int)compress->method);
+		switch (compress->codec)
+		{
+#ifdef WITH_LIBLZ4
+			case ArrowCompressionType__LZ4_FRAME:
+				break;
+#endif
+#ifdef WITH_LIBZSTD
+			case ArrowCompressionType__ZSTD:
+				break;
+#endif
+			default:
+				elog(ERROR, "arrow_fdw: record-batch compressed by %s is not supported",
+					 compress->codec == ArrowCompressionType__LZ4_FRAME ? "LZ4_FRAME" :
+					 compress->codec == ArrowCompressionType__ZSTD ? "ZSTD" : "unknown codec");
+		}
+		rb_compression = compress->codec;
+	}
 
 	rb_state = palloc0(offsetof(RecordBatchState, fields[nfields]));
 	rb_state->af_state = af_state;
@@ -1743,6 +2308,7 @@ __buildRecordBatchStateOne(ArrowSchema *schema,
 	rb_state->rb_offset = block->offset + block->metaDataLength;
 	rb_state->rb_length = block->bodyLength;
 	rb_state->rb_nitems = rbatch->length;
+	rb_state->rb_compression = rb_compression;
 	rb_state->nfields   = nfields;
 
 	memset(&con, 0, sizeof(setupRecordBatchContext));
@@ -1750,6 +2316,13 @@ __buildRecordBatchStateOne(ArrowSchema *schema,
 	con.buffer_tail = rbatch->buffers + rbatch->_num_buffers;
 	con.fnode_curr  = rbatch->nodes;
 	con.fnode_tail  = rbatch->nodes + rbatch->_num_nodes;
+	con.variadic_curr = rbatch->variadicBufferCounts;
+	con.variadic_tail = rbatch->variadicBufferCounts + rbatch->_num_variadicBufferCounts;
+	con.is_compressed = (rb_compression >= 0);
+	con.rb_offset   = rb_state->rb_offset;
+	con.num_dictionaries = af_info->footer._num_dictionaries;
+	con.dict_blocks = af_info->footer.dictionaries;
+	con.dict_messages = af_info->dictionaries;
 	for (int j=0; j < nfields; j++)
 	{
 		RecordBatchFieldState *rb_field = &rb_state->fields[j];
@@ -1760,65 +2333,305 @@ __buildRecordBatchStateOne(ArrowSchema *schema,
 	if (con.buffer_curr != con.buffer_tail ||
 		con.fnode_curr  != con.fnode_tail)
 		elog(ERROR, "arrow_fdw: RecordBatch may be corrupted");
+	rb_state->rb_string_view = con.has_string_view;
 	return rb_state;
 }
 
 /*
- * readArrowFile
+ * __buildRecordBatchStateParquet
+ *
+ * It builds a RecordBatchState for a row-group of the parquet file. Each
+ * field points the entire column chunk, and it shall be decoded by the host
+ * on the loading time.
  */
-static bool
-readArrowFile(const char *filename, ArrowFileInfo *af_info, bool missing_ok)
-{
-    File	filp = PathNameOpenFile(filename, O_RDONLY | PG_BINARY);
-
-	if (filp < 0)
-	{
-		if (missing_ok && errno == ENOENT)
-			return false;
-		ereport(ERROR,
-				(errcode_for_file_access(),
-				 errmsg("could not open file \"%s\": %m", filename)));
-	}
-	readArrowFileDesc(FileGetRawDesc(filp), af_info);
-	FileClose(filp);
-	if (af_info->dictionaries != NULL)
-		elog(ERROR, "DictionaryBatch is not supported at '%s'", filename);
-	Assert(af_info->footer._num_dictionaries == 0);
-	return true;
-}
-
-static ArrowFileState *
-__buildArrowFileStateByFile(const char *filename, Bitmapset **p_stat_attrs)
+static void
+__buildParquetFieldStats(RecordBatchFieldState *rb_field,
+						 ArrowField *field,
+						 ParquetColumnChunk *chunk)
 {
-	ArrowFileInfo af_info;
-	ArrowFileState *af_state;
-	arrowStatsBinary *arrow_bstats;
+	int64_t		__min;
+	int64_t		__max;
+	int64_t		__drift;
 
-	if (!readArrowFile(filename, &af_info, true))
+	rb_field->stat_datum.isnull = true;
+	if (!chunk->has_minmax)
+		return;
+	if (chunk->physical_type == ParquetType__INT32 &&
+		chunk->min_len == sizeof(int32_t) &&
+		chunk->max_len == sizeof(int32_t))
 	{
-		elog(DEBUG2, "file '%s' is missing: %m", filename);
-		return NULL;
+		__min = *((int32_t *)chunk->min_value);
+		__max = *((int32_t *)chunk->max_value);
 	}
-	if (af_info.recordBatches == NULL)
+	else if (chunk->physical_type == ParquetType__INT64 &&
+			 chunk->min_len == sizeof(int64_t) &&
+			 chunk->max_len == sizeof(int64_t))
 	{
-		elog(DEBUG2, "arrow file '%s' contains no RecordBatch", filename);
-		return NULL;
+		__min = *((int64_t *)chunk->min_value);
+		__max = *((int64_t *)chunk->max_value);
 	}
-	/* allocate ArrowFileState */
-	af_state = palloc0(sizeof(ArrowFileInfo));
-	af_state->filename = pstrdup(filename);
-	memcpy(&af_state->stat_buf, &af_info.stat_buf, sizeof(struct stat));
+	else
+		return;
 
-	arrow_bstats = buildArrowStatsBinary(&af_info.footer, p_stat_attrs);
-	for (int i=0; i < af_info.footer._num_recordBatches; i++)
+	switch (field->type.node.tag)
 	{
-		ArrowBlock	     *block  = &af_info.footer.recordBatches[i];
-		ArrowRecordBatch *rbatch = &af_info.recordBatches[i].body.recordBatch;
-		RecordBatchState *rb_state;
-
-		rb_state = __buildRecordBatchStateOne(&af_info.footer.schema,
-											  af_state, i, block, rbatch);
-		if (arrow_bstats)
+		case ArrowNodeTag__Int:
+			/* min/max of unsigned integers follow the unsigned order */
+			if (!field->type.Int.is_signed)
+				return;
+			break;
+		case ArrowNodeTag__Date:
+			__min -= (POSTGRES_EPOCH_JDATE - UNIX_EPOCH_JDATE);
+			__max -= (POSTGRES_EPOCH_JDATE - UNIX_EPOCH_JDATE);
+			break;
+		case ArrowNodeTag__Time:
+			switch (field->type.Time.unit)
+			{
+				case ArrowTimeUnit__MilliSecond:
+					__min *= 1000L;
+					__max *= 1000L;
+					break;
+				case ArrowTimeUnit__MicroSecond:
+					break;
+				case ArrowTimeUnit__NanoSecond:
+					__min /= 1000L;
+					__max /= 1000L;
+					break;
+				default:
+					return;
+			}
+			break;
+		case ArrowNodeTag__Timestamp:
+			__drift = (POSTGRES_EPOCH_JDATE - UNIX_EPOCH_JDATE) * USECS_PER_DAY;
+			switch (field->type.Timestamp.unit)
+			{
+				case ArrowTimeUnit__MilliSecond:
+					__min = __min * 1000L - __drift;
+					__max = __max * 1000L - __drift;
+					break;
+				case ArrowTimeUnit__MicroSecond:
+					__min = __min - __drift;
+					__max = __max - __drift;
+					break;
+				case ArrowTimeUnit__NanoSecond:
+					__min = __min / 1000L - __drift;
+					__max = __max / 1000L - __drift;
+					break;
+				default:
+					return;
+			}
+			break;
+		default:
+			return;
+	}
+	rb_field->stat_datum.isnull = false;
+	rb_field->stat_datum.min.datum = (Datum)__min;
+	rb_field->stat_datum.max.datum = (Datum)__max;
+}
+
+static RecordBatchState *
+__buildRecordBatchStateParquet(ArrowFileInfo *af_info,
+							   ParquetFileInfo *pq_info,
+							   ArrowFileState *af_state,
+							   int rg_index,
+							   Bitmapset **p_stat_attrs)
+{
+	ArrowSchema	   *schema = &af_info->footer.schema;
+	ParquetRowGroup *rgroup = &pq_info->row_groups[rg_index];
+	RecordBatchState *rb_state;
+	int			nfields = schema->_num_fields;
+	off_t		rg_head = LONG_MAX;
+	off_t		rg_tail = 0;
+
+	Assert(rgroup->num_columns == nfields);
+	rb_state = palloc0(offsetof(RecordBatchState, fields[nfields]));
+	rb_state->af_state = af_state;
+	rb_state->rb_index = rg_index;
+	rb_state->rb_nitems = rgroup->num_rows;
+	rb_state->rb_compression = -1;
+	rb_state->rb_parquet = true;
+	rb_state->nfields   = nfields;
+	for (int j=0; j < nfields; j++)
+	{
+		ParquetColumnChunk *chunk = &rgroup->columns[j];
+		off_t		head = (chunk->dictionary_page_offset > 0
+							? chunk->dictionary_page_offset
+							: chunk->data_page_offset);
+
+		if (head < PARQUET_SIGNATURE_SZ ||
+			chunk->total_compressed_size <= 0 ||
+			head + chunk->total_compressed_size > af_info->stat_buf.st_size)
+			elog(ERROR, "parquet: column chunk of '%s' is out of the file '%s'",
+				 schema->fields[j].name, pq_info->filename);
+		rg_head = Min(rg_head, head);
+		rg_tail = Max(rg_tail, head + chunk->total_compressed_size);
+	}
+	rb_state->rb_offset = (nfields > 0 ? rg_head : 0);
+	rb_state->rb_length = (nfields > 0 ? rg_tail - rg_head : 0);
+
+	for (int j=0; j < nfields; j++)
+	{
+		RecordBatchFieldState *rb_field = &rb_state->fields[j];
+		ArrowField	   *field = &schema->fields[j];
+		ParquetColumnChunk *chunk = &rgroup->columns[j];
+		ParquetSchemaElement *elem = &pq_info->elements[j+1];
+		off_t		head = (chunk->dictionary_page_offset > 0
+							? chunk->dictionary_page_offset
+							: chunk->data_page_offset);
+
+		__arrowFieldTypeToPGType(field,
+								 &rb_field->atttypid,
+								 &rb_field->atttypmod,
+								 &rb_field->attopts);
+		rb_field->nitems = rgroup->num_rows;
+		rb_field->null_count = Max(chunk->null_count, 0);
+		rb_field->values_offset = head - rb_state->rb_offset;
+		rb_field->values_length = chunk->total_compressed_size;
+		rb_field->pq_desc.physical_type = chunk->physical_type;
+		rb_field->pq_desc.codec = chunk->codec;
+		rb_field->pq_desc.max_def_level =
+			(elem->repetition == ParquetRepetition__OPTIONAL ? 1 : 0);
+		rb_field->pq_desc.type_length = elem->type_length;
+		__buildParquetFieldStats(rb_field, field, chunk);
+		if (p_stat_attrs && !rb_field->stat_datum.isnull)
+			*p_stat_attrs = bms_add_member(*p_stat_attrs, j+1);
+	}
+	return rb_state;
+}
+
+/*
+ * readArrowFile
+ *
+ * If the file is Apache Parquet, it also fills up the pq_info (if any), and
+ * af_info has only the synthetic schema built from the parquet schema.
+ */
+static void
+__readArrowFileDesc(int fdesc, const char *filename,
+					ArrowFileInfo *af_info, ParquetFileInfo *pq_info)
+{
+	if (pq_info)
+		memset(pq_info, 0, sizeof(ParquetFileInfo));
+	if (isParquetFileDesc(fdesc))
+	{
+		ParquetFileInfo	__pq_info;
+
+		if (!pq_info)
+			pq_info = &__pq_info;
+		readParquetFileDesc(fdesc, pq_info);
+		pq_info->filename = pstrdup(filename);
+		memset(af_info, 0, sizeof(ArrowFileInfo));
+		af_info->filename = pq_info->filename;
+		memcpy(&af_info->stat_buf, &pq_info->stat_buf, sizeof(struct stat));
+		parquetSetupArrowSchema(pq_info, &af_info->footer.schema);
+	}
+	else
+	{
+		readArrowFileDesc(fdesc, af_info);
+	}
+}
+
+static bool
+readArrowFile(const char *filename, ArrowFileInfo *af_info,
+			  ParquetFileInfo *pq_info, bool missing_ok)
+{
+	File		filp;
+
+	if (arrowRemoteIsURL(filename))
+	{
+		/*
+		 * remote file; only the metadata portion is fetched on the sparse
+		 * temporary image, then the stat_buf is replaced by the remote one.
+		 */
+		struct stat	stat_buf;
+		int			fdesc;
+
+		fdesc = arrowRemoteOpenMetadata(filename, &stat_buf, missing_ok);
+		if (fdesc < 0)
+			return false;
+		PG_TRY();
+		{
+			__readArrowFileDesc(fdesc, filename, af_info, pq_info);
+		}
+		PG_FINALLY();
+		{
+			close(fdesc);
+		}
+		PG_END_TRY();
+		memcpy(&af_info->stat_buf, &stat_buf, sizeof(struct stat));
+		if (pq_info && pq_info->filename)
+			memcpy(&pq_info->stat_buf, &stat_buf, sizeof(struct stat));
+		return true;
+	}
+
+	filp = PathNameOpenFile(filename, O_RDONLY | PG_BINARY);
+	if (filp < 0)
+	{
+		if (missing_ok && errno == ENOENT)
+			return false;
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not open file \"%s\": %m", filename)));
+	}
+	__readArrowFileDesc(FileGetRawDesc(filp), filename, af_info, pq_info);
+	FileClose(filp);
+	return true;
+}
+
+static ArrowFileState *
+__buildArrowFileStateByFile(const char *filename, Bitmapset **p_stat_attrs)
+{
+	ArrowFileInfo af_info;
+	ParquetFileInfo pq_info;
+	ArrowFileState *af_state;
+	arrowStatsBinary *arrow_bstats;
+
+	if (!readArrowFile(filename, &af_info, &pq_info, true))
+	{
+		elog(DEBUG2, "file '%s' is missing: %m", filename);
+		return NULL;
+	}
+	if (pq_info.filename)
+	{
+		if (pq_info.num_row_groups == 0)
+		{
+			elog(DEBUG2, "parquet file '%s' contains no row-group", filename);
+			return NULL;
+		}
+		af_state = palloc0(sizeof(ArrowFileState));
+		af_state->filename = pstrdup(filename);
+		memcpy(&af_state->stat_buf, &pq_info.stat_buf, sizeof(struct stat));
+		for (int i=0; i < pq_info.num_row_groups; i++)
+		{
+			RecordBatchState *rb_state;
+
+			rb_state = __buildRecordBatchStateParquet(&af_info,
+													  &pq_info,
+													  af_state, i,
+													  p_stat_attrs);
+			af_state->rb_list = lappend(af_state->rb_list, rb_state);
+		}
+		return af_state;
+	}
+	if (af_info.recordBatches == NULL)
+	{
+		elog(DEBUG2, "arrow file '%s' contains no RecordBatch", filename);
+		return NULL;
+	}
+	/* allocate ArrowFileState */
+	af_state = palloc0(sizeof(ArrowFileInfo));
+	af_state->filename = pstrdup(filename);
+	memcpy(&af_state->stat_buf, &af_info.stat_buf, sizeof(struct stat));
+
+	arrow_bstats = buildArrowStatsBinary(&af_info.footer, p_stat_attrs);
+	for (int i=0; i < af_info.footer._num_recordBatches; i++)
+	{
+		ArrowBlock	     *block  = &af_info.footer.recordBatches[i];
+		ArrowRecordBatch *rbatch = &af_info.recordBatches[i].body.recordBatch;
+		RecordBatchState *rb_state;
+
+		rb_state = __buildRecordBatchStateOne(&af_info,
+											  af_state, i, block, rbatch);
+		if (arrow_bstats)
 			applyArrowStatsBinary(rb_state, arrow_bstats);
 		af_state->rb_list = lappend(af_state->rb_list, rb_state);
 	}
@@ -1847,6 +2660,12 @@ __buildArrowMetadataFieldCache(RecordBatchFieldState *rb_field)
 	fcache->values_length = rb_field->values_length;
 	fcache->extra_offset = rb_field->extra_offset;
 	fcache->extra_length = rb_field->extra_length;
+	fcache->dict_index_unitsz = rb_field->dict_index_unitsz;
+	fcache->dict_index_offset = rb_field->dict_index_offset;
+	fcache->dict_index_length = rb_field->dict_index_length;
+	fcache->string_view = rb_field->string_view;
+	memcpy(&fcache->pq_desc,
+		   &rb_field->pq_desc, sizeof(ParquetColumnDesc));
 	memcpy(&fcache->stat_datum,
 		   &rb_field->stat_datum, sizeof(MinMaxStatDatum));
 	fcache->num_children = rb_field->num_children;
@@ -1897,6 +2716,9 @@ __buildArrowMetadataCacheNoLock(ArrowFileState *af_state)
 		mcache->rb_offset = rb_state->rb_offset;
 		mcache->rb_length = rb_state->rb_length;
 		mcache->rb_nitems = rb_state->rb_nitems;
+		mcache->rb_compression = rb_state->rb_compression;
+		mcache->rb_parquet = rb_state->rb_parquet;
+		mcache->rb_string_view = rb_state->rb_string_view;
 		mcache->nfields   = rb_state->nfields;
 		dlist_init(&mcache->fields);
 		if (!mcache_head)
@@ -1928,123 +2750,652 @@ __buildArrowMetadataCacheNoLock(ArrowFileState *af_state)
 	SpinLockRelease(&arrow_metadata_cache->lru_lock);
 }
 
-static ArrowFileState *
-BuildArrowFileState(Relation frel, const char *filename, Bitmapset **p_stat_attrs)
+/*
+ * Persistent metadata index
+ *
+ * $PGDATA/pg_strom_arrow_index/<database oid>_<hash of the directory path>
+ *
+ * +-----------------------+
+ * | ArrowIndexFileHead    |
+ * +-----------------------+
+ * | ArrowIndexFileEntry   | : filename + serialized RecordBatchState(s)
+ * +-----------------------+
+ * |        :              |
+ * +-----------------------+
+ *
+ * It preserves the RecordBatchState of the arrow files for each directory,
+ * so the first query after the restart does not need to parse the footer of
+ * every arrow file. An entry is valid only if device, inode, size and mtime
+ * of the file match, and the data types are still available; type OIDs are
+ * private to the database. The index file is loaded lazily for each directory
+ * on the first reference in the backend, then written back by
+ * flushArrowMetadataIndex() if any entries are added.
+ */
+#define ARROW_INDEX_DIRNAME		"pg_strom_arrow_index"
+#define ARROW_INDEX_FILE_MAGIC	0x58495241U		/* 'ARIX' */
+
+typedef struct
 {
-	arrowMetadataCache *mcache;
-	ArrowFileState *af_state;
-	RecordBatchState *rb_state;
-	struct stat		stat_buf;
-	TupleDesc		tupdesc;
+	uint32_t	magic;
+	uint32_t	rb_state_sz;	/* sizeof(RecordBatchState) */
+	uint32_t	rb_field_sz;	/* sizeof(RecordBatchFieldState) */
+	uint32_t	nitems;
+	uint32_t	dirname_len;
+	char		dirname[FLEXIBLE_ARRAY_MEMBER];
+} ArrowIndexFileHead;
 
-	if (stat(filename, &stat_buf) != 0)
-		elog(ERROR, "failed on stat('%s'): %m", filename);
-	LWLockAcquire(&arrow_metadata_cache->mutex, LW_SHARED);
-	mcache = lookupArrowMetadataCache(&stat_buf, false);
-	if (mcache)
-	{
-		/* found a valid metadata-cache */
-		af_state = __buildArrowFileStateByCache(filename, mcache,
-												p_stat_attrs);
-	}
-	else
-	{
-		LWLockRelease(&arrow_metadata_cache->mutex);
+typedef struct
+{
+	uint32_t	length;			/* MAXALIGN'ed length of the entry */
+	uint32_t	nbatches;
+	uint32_t	name_len;
+	dev_t		st_dev;
+	ino_t		st_ino;
+	off_t		st_size;
+	struct timespec st_mtim;
+	char		data[FLEXIBLE_ARRAY_MEMBER];	/* name + RecordBatchState */
+} ArrowIndexFileEntry;
 
-		/* here is no valid metadata-cache, so build it from the raw file */
-		af_state = __buildArrowFileStateByFile(filename, p_stat_attrs);
-		if (!af_state)
-			return NULL;	/* file not found? */
+typedef struct
+{
+	dev_t		st_dev;
+	ino_t		st_ino;
+} arrowIndexKey;
 
-		LWLockAcquire(&arrow_metadata_cache->mutex, LW_EXCLUSIVE);
-		mcache = lookupArrowMetadataCache(&af_state->stat_buf, true);
-		if (!mcache)
-			__buildArrowMetadataCacheNoLock(af_state);
-	}
-	LWLockRelease(&arrow_metadata_cache->mutex);
+typedef struct
+{
+	arrowIndexKey key;
+	ArrowIndexFileEntry *entry;
+} arrowIndexItem;
 
-	/* compatibility checks */
-	rb_state = linitial(af_state->rb_list);
-	tupdesc = RelationGetDescr(frel);
-	if (tupdesc->natts != rb_state->nfields)
-		elog(ERROR, "arrow_fdw: foreign table '%s' is not compatible to '%s'",
-			 RelationGetRelationName(frel), filename);
-	for (int j=0; j < tupdesc->natts; j++)
-	{
-		Form_pg_attribute	attr = TupleDescAttr(tupdesc, j);
-		RecordBatchFieldState *rb_field = &rb_state->fields[j];
-		bool		compatible = false;
+typedef struct
+{
+	char		dirname[MAXPGPATH];
+	bool		dirty;
+	HTAB	   *items;
+} arrowIndexDirectory;
 
-		if (attr->atttypid == rb_field->atttypid)
-			compatible = true;
-		else
-		{
-			/* check for binary compatible data types */
-			HeapTuple	htup;
+static HTAB	   *arrow_index_directories = NULL;
+static MemoryContext arrow_index_memcxt = NULL;
 
-			htup = SearchSysCache2(CASTSOURCETARGET,
-								   ObjectIdGetDatum(rb_field->atttypid),
-								   ObjectIdGetDatum(attr->atttypid));
-			if (HeapTupleIsValid(htup))
-			{
-				Form_pg_cast cast = (Form_pg_cast) GETSTRUCT(htup);
+static char *
+__arrowIndexFilePath(const char *dirname)
+{
+	return psprintf("%s/%u_%08x", ARROW_INDEX_DIRNAME, MyDatabaseId,
+					hash_bytes((const unsigned char *)dirname,
+							   strlen(dirname)));
+}
 
-				if (cast->castmethod == COERCION_METHOD_BINARY)
-					compatible = true;
-				ReleaseSysCache(htup);
-			}
+static void
+__arrowIndexLoadFile(arrowIndexDirectory *adir)
+{
+	char	   *fname = __arrowIndexFilePath(adir->dirname);
+	ArrowIndexFileHead *head;
+	struct stat	stat_buf;
+	char	   *buffer;
+	char	   *pos;
+	char	   *end;
+	int			fdesc;
+
+	fdesc = OpenTransientFile(fname, O_RDONLY | PG_BINARY);
+	if (fdesc < 0)
+	{
+		if (errno != ENOENT)
+			elog(WARNING, "failed to open arrow metadata index '%s': %m", fname);
+		goto out;
+	}
+	if (fstat(fdesc, &stat_buf) != 0 ||
+		stat_buf.st_size < offsetof(ArrowIndexFileHead, dirname))
+		goto out_close;
+	buffer = MemoryContextAlloc(arrow_index_memcxt, stat_buf.st_size);
+	if (__preadFile(fdesc, buffer, stat_buf.st_size, 0) != stat_buf.st_size)
+		goto out_free;
+	head = (ArrowIndexFileHead *)buffer;
+	if (head->magic != ARROW_INDEX_FILE_MAGIC ||
+		head->rb_state_sz != sizeof(RecordBatchState) ||
+		head->rb_field_sz != sizeof(RecordBatchFieldState) ||
+		MAXALIGN(offsetof(ArrowIndexFileHead,
+						  dirname[head->dirname_len])) > stat_buf.st_size ||
+		head->dirname_len != strlen(adir->dirname) ||
+		memcmp(head->dirname, adir->dirname, head->dirname_len) != 0)
+		goto out_free;		/* not compatible, or hash collision */
+
+	pos = buffer + MAXALIGN(offsetof(ArrowIndexFileHead,
+									 dirname[head->dirname_len]));
+	end = buffer + stat_buf.st_size;
+	for (uint32_t i=0; i < head->nitems; i++)
+	{
+		ArrowIndexFileEntry *entry = (ArrowIndexFileEntry *)pos;
+		arrowIndexItem *item;
+		arrowIndexKey hkey;
+
+		if (end - pos < offsetof(ArrowIndexFileEntry, data) ||
+			entry->length != MAXALIGN(entry->length) ||
+			entry->length > end - pos ||
+			offsetof(ArrowIndexFileEntry,
+					 data[entry->name_len]) > entry->length)
+		{
+			elog(WARNING, "arrow metadata index '%s' is corrupted", fname);
+			hash_destroy(adir->items);
+			adir->items = NULL;
+			goto out_free;
 		}
-		if (!compatible)
-			elog(ERROR, "arrow_fdw: foreign table '%s' column '%s' (%s) is not compatible to the arrow field (%s) in the '%s'",
-				 RelationGetRelationName(frel),
-				 NameStr(attr->attname),
-				 format_type_be(attr->atttypid),
-				 format_type_be(rb_field->atttypid),
-				 filename);
+		memset(&hkey, 0, sizeof(arrowIndexKey));
+		hkey.st_dev = entry->st_dev;
+		hkey.st_ino = entry->st_ino;
+		item = hash_search(adir->items, &hkey, HASH_ENTER, NULL);
+		item->entry = entry;
+		pos += entry->length;
 	}
-	return af_state;
+	/* buffer is kept, because the items reference it */
+	CloseTransientFile(fdesc);
+	pfree(fname);
+	return;
+
+out_free:
+	pfree(buffer);
+out_close:
+	CloseTransientFile(fdesc);
+out:
+	pfree(fname);
 }
 
-/*
- * baseRelIsArrowFdw
- */
-bool
-baseRelIsArrowFdw(RelOptInfo *baserel)
+static arrowIndexDirectory *
+__lookupArrowIndexDirectory(const char *filename)
 {
-	if ((baserel->reloptkind == RELOPT_BASEREL ||
-		 baserel->reloptkind == RELOPT_OTHER_MEMBER_REL) &&
-		baserel->rtekind == RTE_RELATION &&
-		OidIsValid(baserel->serverid) &&
-		baserel->fdwroutine &&
-		memcmp(baserel->fdwroutine,
-			   &pgstrom_arrow_fdw_routine,
-			   sizeof(FdwRoutine)) == 0)
-		return true;
+	arrowIndexDirectory *adir;
+	char		dirname[MAXPGPATH];
+	bool		found;
 
-	return false;
-}
+	if (strlen(filename) >= MAXPGPATH)
+		return NULL;
+	strcpy(dirname, filename);
+	get_parent_directory(dirname);
+	if (dirname[0] == '\0')
+		return NULL;
 
-/*
- * RelationIsArrowFdw
- */
-bool
-RelationIsArrowFdw(Relation frel)
-{
-	if (RelationGetForm(frel)->relkind == RELKIND_FOREIGN_TABLE)
+	if (!arrow_index_directories)
 	{
-		FdwRoutine *routine = GetFdwRoutineForRelation(frel, false);
-
-		if (memcmp(routine, &pgstrom_arrow_fdw_routine, sizeof(FdwRoutine)) == 0)
-			return true;
+		HASHCTL		hctl;
+
+		arrow_index_memcxt = AllocSetContextCreate(CacheMemoryContext,
+												   "arrow metadata index",
+												   ALLOCSET_DEFAULT_SIZES);
+		memset(&hctl, 0, sizeof(HASHCTL));
+		hctl.keysize = MAXPGPATH;
+		hctl.entrysize = sizeof(arrowIndexDirectory);
+		hctl.hcxt = arrow_index_memcxt;
+		arrow_index_directories = hash_create("arrow metadata index directories",
+											  32, &hctl,
+											  HASH_ELEM | HASH_STRINGS | HASH_CONTEXT);
 	}
-	return false;
+	adir = hash_search(arrow_index_directories, dirname, HASH_ENTER, &found);
+	if (!found || !adir->items)
+	{
+		HASHCTL		hctl;
+
+		adir->dirty = false;
+		memset(&hctl, 0, sizeof(HASHCTL));
+		hctl.keysize = sizeof(arrowIndexKey);
+		hctl.entrysize = sizeof(arrowIndexItem);
+		hctl.hcxt = arrow_index_memcxt;
+		adir->items = hash_create("arrow metadata index items",
+								  1024, &hctl,
+								  HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+		__arrowIndexLoadFile(adir);
+		if (!adir->items)
+			adir->items = hash_create("arrow metadata index items",
+									  1024, &hctl,
+									  HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+	}
+	return adir;
 }
 
-/*
- * GetOptimalGpusForArrowFdw
- */
-const Bitmapset *
-GetOptimalGpusForArrowFdw(PlannerInfo *root, RelOptInfo *baserel)
+static const char *
+__deserializeRecordBatchField(const char *pos, const char *end,
+							  RecordBatchFieldState *rb_field)
+{
+	if (end - pos < sizeof(RecordBatchFieldState))
+		return NULL;
+	memcpy(rb_field, pos, sizeof(RecordBatchFieldState));
+	pos += sizeof(RecordBatchFieldState);
+	rb_field->children = NULL;
+	if (rb_field->num_children < 0 ||
+		!SearchSysCacheExists1(TYPEOID, ObjectIdGetDatum(rb_field->atttypid)))
+		return NULL;
+	if (rb_field->num_children > 0)
+	{
+		rb_field->children = palloc0(sizeof(RecordBatchFieldState) *
+									 rb_field->num_children);
+		for (int j=0; j < rb_field->num_children; j++)
+		{
+			pos = __deserializeRecordBatchField(pos, end,
+												&rb_field->children[j]);
+			if (!pos)
+				return NULL;
+		}
+	}
+	return pos;
+}
+
+static void
+__serializeRecordBatchField(StringInfo buf, RecordBatchFieldState *rb_field)
+{
+	appendBinaryStringInfo(buf, (const char *)rb_field,
+						   sizeof(RecordBatchFieldState));
+	for (int j=0; j < rb_field->num_children; j++)
+		__serializeRecordBatchField(buf, &rb_field->children[j]);
+}
+
+/*
+ * lookupArrowMetadataIndex
+ */
+static ArrowFileState *
+lookupArrowMetadataIndex(const char *filename,
+						 struct stat *stat_buf,
+						 Bitmapset **p_stat_attrs)
+{
+	arrowIndexDirectory *adir;
+	arrowIndexItem *item;
+	ArrowIndexFileEntry *entry;
+	ArrowFileState *af_state;
+	arrowIndexKey hkey;
+	const char *pos;
+	const char *end;
+	Bitmapset  *stat_attrs = NULL;
+
+	if (!arrow_fdw_metadata_index_enabled || arrowRemoteIsURL(filename))
+		return NULL;
+	adir = __lookupArrowIndexDirectory(filename);
+	if (!adir)
+		return NULL;
+	memset(&hkey, 0, sizeof(arrowIndexKey));
+	hkey.st_dev = stat_buf->st_dev;
+	hkey.st_ino = stat_buf->st_ino;
+	item = hash_search(adir->items, &hkey, HASH_FIND, NULL);
+	if (!item)
+		return NULL;
+	entry = item->entry;
+	if (entry->st_size != stat_buf->st_size ||
+		entry->st_mtim.tv_sec  != stat_buf->st_mtim.tv_sec ||
+		entry->st_mtim.tv_nsec != stat_buf->st_mtim.tv_nsec ||
+		entry->nbatches == 0)
+		return NULL;	/* file is already updated */
+
+	af_state = palloc0(sizeof(ArrowFileState));
+	af_state->filename = pstrdup(filename);
+	memcpy(&af_state->stat_buf, stat_buf, sizeof(struct stat));
+
+	pos = entry->data + entry->name_len;
+	end = (const char *)entry + entry->length;
+	for (uint32_t i=0; i < entry->nbatches; i++)
+	{
+		RecordBatchState *rb_state;
+		RecordBatchState  temp;
+
+		if (end - pos < offsetof(RecordBatchState, fields))
+			goto corrupted;
+		memcpy(&temp, pos, offsetof(RecordBatchState, fields));
+		pos += offsetof(RecordBatchState, fields);
+		if (temp.nfields < 0)
+			goto corrupted;
+		rb_state = palloc0(offsetof(RecordBatchState, fields[temp.nfields]));
+		memcpy(rb_state, &temp, offsetof(RecordBatchState, fields));
+		rb_state->af_state = af_state;
+		for (int j=0; j < rb_state->nfields; j++)
+		{
+			RecordBatchFieldState *rb_field = &rb_state->fields[j];
+
+			pos = __deserializeRecordBatchField(pos, end, rb_field);
+			if (!pos)
+				goto corrupted;
+			if (!rb_field->stat_datum.isnull)
+				stat_attrs = bms_add_member(stat_attrs, j+1);
+		}
+		af_state->rb_list = lappend(af_state->rb_list, rb_state);
+	}
+	if (p_stat_attrs)
+		*p_stat_attrs = bms_add_members(*p_stat_attrs, stat_attrs);
+	return af_state;
+
+corrupted:
+	elog(DEBUG2, "arrow metadata index entry of '%s' is corrupted", filename);
+	hash_search(adir->items, &hkey, HASH_REMOVE, NULL);
+	return NULL;
+}
+
+/*
+ * saveArrowMetadataIndex
+ */
+static void
+saveArrowMetadataIndex(ArrowFileState *af_state)
+{
+	arrowIndexDirectory *adir;
+	arrowIndexItem *item;
+	ArrowIndexFileEntry *entry;
+	arrowIndexKey hkey;
+	const char *name;
+	StringInfoData buf;
+	ListCell   *lc;
+
+	if (!arrow_fdw_metadata_index_enabled ||
+		arrowRemoteIsURL(af_state->filename))
+		return;
+	adir = __lookupArrowIndexDirectory(af_state->filename);
+	if (!adir)
+		return;
+	name = strrchr(af_state->filename, '/');
+	name = (name ? name + 1 : af_state->filename);
+
+	initStringInfo(&buf);
+	enlargeStringInfo(&buf, offsetof(ArrowIndexFileEntry, data));
+	buf.len = offsetof(ArrowIndexFileEntry, data);
+	appendBinaryStringInfo(&buf, name, strlen(name));
+	foreach (lc, af_state->rb_list)
+	{
+		RecordBatchState *rb_state = lfirst(lc);
+
+		appendBinaryStringInfo(&buf, (const char *)rb_state,
+							   offsetof(RecordBatchState, fields));
+		for (int j=0; j < rb_state->nfields; j++)
+			__serializeRecordBatchField(&buf, &rb_state->fields[j]);
+	}
+	while (buf.len != MAXALIGN(buf.len))
+		appendStringInfoChar(&buf, '\0');
+
+	entry = MemoryContextAlloc(arrow_index_memcxt, buf.len);
+	memcpy(entry, buf.data, buf.len);
+	entry->length   = buf.len;
+	entry->nbatches = list_length(af_state->rb_list);
+	entry->name_len = strlen(name);
+	entry->st_dev   = af_state->stat_buf.st_dev;
+	entry->st_ino   = af_state->stat_buf.st_ino;
+	entry->st_size  = af_state->stat_buf.st_size;
+	entry->st_mtim  = af_state->stat_buf.st_mtim;
+	pfree(buf.data);
+
+	memset(&hkey, 0, sizeof(arrowIndexKey));
+	hkey.st_dev = entry->st_dev;
+	hkey.st_ino = entry->st_ino;
+	item = hash_search(adir->items, &hkey, HASH_ENTER, NULL);
+	item->entry = entry;
+	adir->dirty = true;
+}
+
+/*
+ * flushArrowMetadataIndex
+ *
+ * It writes out the index files of the directories that have new entries.
+ * Entries of the removed or updated files are dropped on the flush.
+ */
+static void
+__flushArrowMetadataIndexDirectory(arrowIndexDirectory *adir)
+{
+	ArrowIndexFileHead *head;
+	HASH_SEQ_STATUS	hseq;
+	arrowIndexItem *item;
+	size_t		head_sz;
+	uint32_t	nitems = 0;
+	char	   *fname;
+	char	   *tname;
+	int			fdesc;
+	StringInfoData buf;
+
+	if (MakePGDirectory(ARROW_INDEX_DIRNAME) != 0 && errno != EEXIST)
+	{
+		elog(WARNING, "could not create directory \"%s\": %m",
+			 ARROW_INDEX_DIRNAME);
+		return;
+	}
+	head_sz = MAXALIGN(offsetof(ArrowIndexFileHead,
+								dirname[strlen(adir->dirname)]));
+	initStringInfo(&buf);
+	enlargeStringInfo(&buf, head_sz);
+	memset(buf.data, 0, head_sz);
+	buf.len = head_sz;
+
+	hash_seq_init(&hseq, adir->items);
+	while ((item = hash_seq_search(&hseq)) != NULL)
+	{
+		ArrowIndexFileEntry *entry = item->entry;
+		char	   *path;
+		struct stat	stat_buf;
+
+		path = psprintf("%s/%.*s", adir->dirname,
+						(int)entry->name_len, entry->data);
+		if (stat(path, &stat_buf) != 0 ||
+			stat_buf.st_dev  != entry->st_dev ||
+			stat_buf.st_ino  != entry->st_ino ||
+			stat_buf.st_size != entry->st_size ||
+			stat_buf.st_mtim.tv_sec  != entry->st_mtim.tv_sec ||
+			stat_buf.st_mtim.tv_nsec != entry->st_mtim.tv_nsec)
+		{
+			/* removed or updated; drop the entry */
+			hash_search(adir->items, &item->key, HASH_REMOVE, NULL);
+		}
+		else
+		{
+			appendBinaryStringInfo(&buf, (const char *)entry, entry->length);
+			nitems++;
+		}
+		pfree(path);
+	}
+	head = (ArrowIndexFileHead *)buf.data;
+	head->magic = ARROW_INDEX_FILE_MAGIC;
+	head->rb_state_sz = sizeof(RecordBatchState);
+	head->rb_field_sz = sizeof(RecordBatchFieldState);
+	head->nitems = nitems;
+	head->dirname_len = strlen(adir->dirname);
+	memcpy(head->dirname, adir->dirname, head->dirname_len);
+
+	/* write out the index file, then replace atomically */
+	fname = __arrowIndexFilePath(adir->dirname);
+	tname = psprintf("%s.%u.tmp", fname, MyProcPid);
+	fdesc = OpenTransientFile(tname, O_RDWR | O_CREAT | O_TRUNC | PG_BINARY);
+	if (fdesc < 0)
+		elog(WARNING, "could not create file \"%s\": %m", tname);
+	else if (__writeFile(fdesc, buf.data, buf.len) != buf.len)
+	{
+		elog(WARNING, "could not write file \"%s\": %m", tname);
+		CloseTransientFile(fdesc);
+		unlink(tname);
+	}
+	else
+	{
+		CloseTransientFile(fdesc);
+		if (durable_rename(tname, fname, WARNING) != 0)
+			unlink(tname);
+	}
+	pfree(tname);
+	pfree(fname);
+	pfree(buf.data);
+	adir->dirty = false;
+}
+
+static void
+flushArrowMetadataIndex(void)
+{
+	HASH_SEQ_STATUS	hseq;
+	arrowIndexDirectory *adir;
+
+	if (!arrow_index_directories)
+		return;
+	hash_seq_init(&hseq, arrow_index_directories);
+	while ((adir = hash_seq_search(&hseq)) != NULL)
+	{
+		if (adir->dirty)
+			__flushArrowMetadataIndexDirectory(adir);
+	}
+}
+
+/*
+ * SetArrowFileLockTag
+ *
+ * Writable arrow files are appended and the footer is rewritten in-place,
+ * so the writer holds ExclusiveLock on the tag by the device and inode
+ * number until end of the transaction, and readers take ShareLock during
+ * the metadata loading. Unlike the lock on the foreign table, the tag also
+ * works on the other foreign tables that read the same file.
+ * The record-batches referenced by the loaded metadata are never touched
+ * by the writer, so readers don't need to keep the lock during the scan.
+ */
+#define ARROW_FILE_LOCKTAG_MAGIC		0x4146		/* 'AF' */
+
+static void
+SetArrowFileLockTag(LOCKTAG *tag, const struct stat *stat_buf)
+{
+	SET_LOCKTAG_ADVISORY(*tag,
+						 (uint32)stat_buf->st_dev,
+						 (uint32)((uint64)stat_buf->st_ino >> 32),
+						 (uint32)((uint64)stat_buf->st_ino & 0xffffffffU),
+						 ARROW_FILE_LOCKTAG_MAGIC);
+}
+
+static ArrowFileState *
+BuildArrowFileState(Relation frel, const char *filename, Bitmapset **p_stat_attrs)
+{
+	arrowMetadataCache *mcache;
+	ArrowFileState *af_state;
+	RecordBatchState *rb_state;
+	struct stat		stat_buf;
+	TupleDesc		tupdesc;
+	LOCKTAG			locktag;
+	bool			locked = false;
+
+	if (arrowRemoteIsURL(filename))
+		arrowRemoteStat(filename, &stat_buf, false);
+	else
+	{
+		if (stat(filename, &stat_buf) != 0)
+			elog(ERROR, "failed on stat('%s'): %m", filename);
+		/* wait for the concurrent writer, if any, then check the file again */
+		SetArrowFileLockTag(&locktag, &stat_buf);
+		(void) LockAcquire(&locktag, ShareLock, false, false);
+		locked = true;
+		if (stat(filename, &stat_buf) != 0)
+			elog(ERROR, "failed on stat('%s'): %m", filename);
+	}
+	LWLockAcquire(&arrow_metadata_cache->mutex, LW_SHARED);
+	mcache = lookupArrowMetadataCache(&stat_buf, false);
+	if (mcache)
+	{
+		/* found a valid metadata-cache */
+		af_state = __buildArrowFileStateByCache(filename, mcache,
+												p_stat_attrs);
+	}
+	else
+	{
+		LWLockRelease(&arrow_metadata_cache->mutex);
+
+		/*
+		 * here is no valid metadata-cache, so build it from the persistent
+		 * metadata index or the raw file
+		 */
+		af_state = lookupArrowMetadataIndex(filename, &stat_buf, p_stat_attrs);
+		if (!af_state)
+		{
+			af_state = __buildArrowFileStateByFile(filename, p_stat_attrs);
+			if (!af_state)
+			{
+				if (locked)
+					LockRelease(&locktag, ShareLock, false);
+				return NULL;	/* file not found? */
+			}
+			saveArrowMetadataIndex(af_state);
+		}
+
+		LWLockAcquire(&arrow_metadata_cache->mutex, LW_EXCLUSIVE);
+		mcache = lookupArrowMetadataCache(&af_state->stat_buf, true);
+		if (!mcache)
+			__buildArrowMetadataCacheNoLock(af_state);
+	}
+	LWLockRelease(&arrow_metadata_cache->mutex);
+	if (locked)
+		LockRelease(&locktag, ShareLock, false);
+	af_state->is_remote = arrowRemoteIsURL(filename);
+
+	/* compatibility checks */
+	rb_state = linitial(af_state->rb_list);
+	tupdesc = RelationGetDescr(frel);
+	if (tupdesc->natts != rb_state->nfields)
+		elog(ERROR, "arrow_fdw: foreign table '%s' is not compatible to '%s'",
+			 RelationGetRelationName(frel), filename);
+	for (int j=0; j < tupdesc->natts; j++)
+	{
+		Form_pg_attribute	attr = TupleDescAttr(tupdesc, j);
+		RecordBatchFieldState *rb_field = &rb_state->fields[j];
+		bool		compatible = false;
+
+		if (attr->atttypid == rb_field->atttypid)
+			compatible = true;
+		else
+		{
+			/* check for binary compatible data types */
+			HeapTuple	htup;
+
+			htup = SearchSysCache2(CASTSOURCETARGET,
+								   ObjectIdGetDatum(rb_field->atttypid),
+								   ObjectIdGetDatum(attr->atttypid));
+			if (HeapTupleIsValid(htup))
+			{
+				Form_pg_cast cast = (Form_pg_cast) GETSTRUCT(htup);
+
+				if (cast->castmethod == COERCION_METHOD_BINARY)
+					compatible = true;
+				ReleaseSysCache(htup);
+			}
+		}
+		if (!compatible)
+			elog(ERROR, "arrow_fdw: foreign table '%s' column '%s' (%s) is not compatible to the arrow field (%s) in the '%s'",
+				 RelationGetRelationName(frel),
+				 NameStr(attr->attname),
+				 format_type_be(attr->atttypid),
+				 format_type_be(rb_field->atttypid),
+				 filename);
+	}
+	return af_state;
+}
+
+/*
+ * baseRelIsArrowFdw
+ */
+bool
+baseRelIsArrowFdw(RelOptInfo *baserel)
+{
+	if ((baserel->reloptkind == RELOPT_BASEREL ||
+		 baserel->reloptkind == RELOPT_OTHER_MEMBER_REL) &&
+		baserel->rtekind == RTE_RELATION &&
+		OidIsValid(baserel->serverid) &&
+		baserel->fdwroutine &&
+		memcmp(baserel->fdwroutine,
+			   &pgstrom_arrow_fdw_routine,
+			   sizeof(FdwRoutine)) == 0)
+		return true;
+
+	return false;
+}
+
+/*
+ * RelationIsArrowFdw
+ */
+bool
+RelationIsArrowFdw(Relation frel)
+{
+	if (RelationGetForm(frel)->relkind == RELKIND_FOREIGN_TABLE)
+	{
+		FdwRoutine *routine = GetFdwRoutineForRelation(frel, false);
+
+		if (memcmp(routine, &pgstrom_arrow_fdw_routine, sizeof(FdwRoutine)) == 0)
+			return true;
+	}
+	return false;
+}
+
+/*
+ * GetOptimalGpusForArrowFdw
+ */
+const Bitmapset *
+GetOptimalGpusForArrowFdw(PlannerInfo *root, RelOptInfo *baserel)
 {
 	List	   *priv_list = (List *)baserel->fdw_private;
 	Bitmapset  *optimal_gpus = NULL;
@@ -2060,7 +3411,10 @@ GetOptimalGpusForArrowFdw(PlannerInfo *root, RelOptInfo *baserel)
 			ArrowFileState *af_state = lfirst(lc);
 			const Bitmapset *__optimal_gpus;
 
-			__optimal_gpus = GetOptimalGpuForFile(af_state->filename);
+			/* remote file has no locality to the GPUs */
+			__optimal_gpus = (af_state->is_remote
+							  ? NULL
+							  : GetOptimalGpuForFile(af_state->filename));
 			if (lc == list_head(af_list))
 				optimal_gpus = bms_copy(__optimal_gpus);
 			else
@@ -2103,6 +3457,58 @@ GetOptimalDpuForArrowFdw(PlannerInfo *root, RelOptInfo *baserel)
 /*
  * arrowFdwExtractFilesList
  */
+static List *
+__arrowFdwExtractDirFiles(List *filesList,
+						  const char *dir_path,
+						  const char *dir_suffix)
+{
+	struct dirent *dentry;
+	struct stat	stat_buf;
+	DIR	   *dir;
+	char   *temp;
+
+	dir = AllocateDir(dir_path);
+	while ((dentry = ReadDir(dir, dir_path)) != NULL)
+	{
+		if (strcmp(dentry->d_name, ".") == 0 ||
+			strcmp(dentry->d_name, "..") == 0)
+			continue;
+		temp = psprintf("%s/%s", dir_path, dentry->d_name);
+		if (stat(temp, &stat_buf) == 0 && S_ISDIR(stat_buf.st_mode))
+		{
+			/* Hive-style partition directory (key=value) */
+			char   *pos = strchr(dentry->d_name, '=');
+
+			if (pos && pos != dentry->d_name)
+				filesList = __arrowFdwExtractDirFiles(filesList, temp,
+													  dir_suffix);
+			else
+				elog(DEBUG1, "arrow_fdw: directory '%s' is not a partition, so skipped", temp);
+			pfree(temp);
+			continue;
+		}
+		if (dir_suffix)
+		{
+			char   *pos = strrchr(dentry->d_name, '.');
+
+			if (!pos || strcmp(pos+1, dir_suffix) != 0)
+			{
+				pfree(temp);
+				continue;
+			}
+		}
+		if (access(temp, R_OK) != 0)
+		{
+			elog(DEBUG1, "arrow_fdw: unable to read '%s', so skipped", temp);
+			continue;
+		}
+		filesList = lappend(filesList, makeString(temp));
+	}
+	FreeDir(dir);
+
+	return filesList;
+}
+
 static List *
 arrowFdwExtractFilesList(List *options_list,
 						 int *p_parallel_nworkers)
@@ -2110,9 +3516,11 @@ arrowFdwExtractFilesList(List *options_list,
 
 	ListCell   *lc;
 	List	   *filesList = NIL;
+	char	   *file_path = NULL;
 	char	   *dir_path = NULL;
 	char	   *dir_suffix = NULL;
 	int			parallel_nworkers = -1;
+	bool		writable = false;
 
 	foreach (lc, options_list)
 	{
@@ -2121,11 +3529,9 @@ arrowFdwExtractFilesList(List *options_list,
 		Assert(IsA(defel->arg, String));
 		if (strcmp(defel->defname, "file") == 0)
 		{
-			char   *temp = strVal(defel->arg);
-
-			if (access(temp, R_OK) != 0)
-				elog(ERROR, "arrow_fdw: unable to access '%s': %m", temp);
-			filesList = lappend(filesList, makeString(pstrdup(temp)));
+			if (file_path)
+				elog(ERROR, "arrow_fdw: 'file' appeared twice");
+			file_path = strVal(defel->arg);
 		}
 		else if (strcmp(defel->defname, "files") == 0)
 		{
@@ -2133,13 +3539,17 @@ arrowFdwExtractFilesList(List *options_list,
 			char   *saveptr;
 			char   *tok;
 
-			while ((tok = strtok_r(temp, ",", &saveptr)) != NULL)
+			for (tok = strtok_r(temp, ",", &saveptr);
+				 tok != NULL;
+				 tok = strtok_r(NULL, ",", &saveptr))
 			{
 				tok = __trim(tok);
 
-				if (*tok != '/')
+				if (arrowRemoteIsURL(tok))
+					;	/* remote file shall be checked on the scan */
+				else if (*tok != '/')
 					elog(ERROR, "arrow_fdw: file '%s' must be absolute path", tok);
-				if (access(tok, R_OK) != 0)
+				else if (access(tok, R_OK) != 0)
 					elog(ERROR, "arrow_fdw: unable to access '%s': %m", tok);
 				filesList = lappend(filesList, makeString(pstrdup(tok)));
 			}
@@ -2161,45 +3571,209 @@ arrowFdwExtractFilesList(List *options_list,
 				elog(ERROR, "'parallel_workers' appeared twice");
 			parallel_nworkers = atoi(strVal(defel->arg));
 		}
+		else if (strcmp(defel->defname, "writable") == 0)
+		{
+			writable = defGetBoolean(defel);
+		}
 		else
 			elog(ERROR, "arrow: unknown option (%s)", defel->defname);
 	}
 	if (dir_suffix && !dir_path)
 		elog(ERROR, "arrow: cannot use 'suffix' option without 'dir'");
+	if (writable && (!file_path || filesList != NIL || dir_path))
+		elog(ERROR, "arrow: 'writable' needs exactly one backend file by the 'file' option");
+	if (writable && arrowRemoteIsURL(file_path))
+		elog(ERROR, "arrow: remote file '%s' cannot be writable", file_path);
 
-	if (dir_path)
+	if (file_path)
 	{
-		struct dirent *dentry;
-		DIR	   *dir;
-		char   *temp;
+		/* writable foreign table may not have the backend file yet */
+		if (arrowRemoteIsURL(file_path) ||
+			access(file_path, R_OK) == 0)
+			filesList = lcons(makeString(pstrdup(file_path)), filesList);
+		else if (!writable || errno != ENOENT)
+			elog(ERROR, "arrow_fdw: unable to access '%s': %m", file_path);
+	}
 
-		dir = AllocateDir(dir_path);
-		while ((dentry = ReadDir(dir, dir_path)) != NULL)
-		{
-			if (strcmp(dentry->d_name, ".") == 0 ||
-				strcmp(dentry->d_name, "..") == 0)
-				continue;
-			if (dir_suffix)
-			{
-				char   *pos = strrchr(dentry->d_name, '.');
+	if (dir_path)
+		filesList = __arrowFdwExtractDirFiles(filesList, dir_path, dir_suffix);
 
-				if (!pos || strcmp(pos+1, dir_suffix) != 0)
-					continue;
-			}
-			temp = psprintf("%s/%s", dir_path, dentry->d_name);
-			if (access(temp, R_OK) != 0)
+	if (p_parallel_nworkers)
+		*p_parallel_nworkers = parallel_nworkers;
+	return filesList;
+}
+
+/*
+ * arrowFdwCheckPartitionQuals
+ *
+ * Files may be put on the Hive-style partition directories, like
+ * "dt=2026-10-01/host=foo/". If the foreign table has a column with the same
+ * name as the key, the value in the path is considered as the value of the
+ * column for all the rows in the file. It returns false, if any of the
+ * qualifiers (Var OP Const) is not satisfied by the partition values, so
+ * we can prune the file without opening it.
+ */
+#define HIVE_DEFAULT_PARTITION		"__HIVE_DEFAULT_PARTITION__"
+
+static bool
+arrowFdwCheckPartitionQuals(const char *fname,
+							TupleDesc tupdesc,
+							Index scanrelid,
+							List *quals)
+{
+	AttrNumber *part_anums = NULL;
+	char	  **part_values = NULL;
+	int			nparts = 0;
+	char	   *path;
+	char	   *tok;
+	char	   *saveptr;
+	ListCell   *lc;
+	bool		retval = true;
+
+	if (quals == NIL || !strchr(fname, '='))
+		return true;
+
+	/* pick up key=value pairs in the path */
+	path = pstrdup(fname);
+	for (tok = strtok_r(path, "/", &saveptr);
+		 tok != NULL;
+		 tok = strtok_r(NULL, "/", &saveptr))
+	{
+		char   *pos = strchr(tok, '=');
+
+		if (!pos || pos == tok)
+			continue;
+		*pos++ = '\0';
+		/* unescape %XX in the value */
+		for (char *src = pos, *dst = pos; ; src++, dst++)
+		{
+			if (src[0] == '%' && isxdigit(src[1]) && isxdigit(src[2]))
 			{
-				elog(DEBUG1, "arrow_fdw: unable to read '%s', so skipped", temp);
+				char	hex[3] = { src[1], src[2], '\0' };
+
+				*dst = (char)strtol(hex, NULL, 16);
+				src += 2;
+			}
+			else if ((*dst = *src) == '\0')
+				break;
+		}
+		for (int j=0; j < tupdesc->natts; j++)
+		{
+			Form_pg_attribute attr = TupleDescAttr(tupdesc, j);
+
+			if (attr->attisdropped ||
+				strcmp(NameStr(attr->attname), tok) != 0)
 				continue;
+			if (!part_anums)
+			{
+				part_anums  = palloc(sizeof(AttrNumber) * tupdesc->natts);
+				part_values = palloc(sizeof(char *) * tupdesc->natts);
 			}
-			filesList = lappend(filesList, makeString(temp));
+			if (nparts < tupdesc->natts)
+			{
+				part_anums[nparts]  = attr->attnum;
+				part_values[nparts] = pos;
+				nparts++;
+			}
+			break;
 		}
-		FreeDir(dir);
 	}
+	if (nparts == 0)
+		goto out;
 
-	if (p_parallel_nworkers)
-		*p_parallel_nworkers = parallel_nworkers;
-	return filesList;
+	foreach (lc, quals)
+	{
+		OpExpr	   *op = lfirst(lc);
+		Node	   *larg;
+		Node	   *rarg;
+		Var		   *var;
+		Const	   *con;
+		bool		reverse = false;
+		Form_pg_attribute attr;
+		Oid			typinput;
+		Oid			typioparam;
+		Datum		datum;
+		Datum		result;
+
+		if (IsA(op, RestrictInfo))
+			op = (OpExpr *)((RestrictInfo *)op)->clause;
+		if (!IsA(op, OpExpr) || list_length(op->args) != 2)
+			continue;
+		larg = linitial(op->args);
+		rarg = lsecond(op->args);
+		if (IsA(larg, RelabelType))
+			larg = (Node *)((RelabelType *)larg)->arg;
+		if (IsA(rarg, RelabelType))
+			rarg = (Node *)((RelabelType *)rarg)->arg;
+		if (IsA(larg, Var) && IsA(rarg, Const))
+		{
+			var = (Var *)larg;
+			con = (Const *)rarg;
+		}
+		else if (IsA(larg, Const) && IsA(rarg, Var))
+		{
+			var = (Var *)rarg;
+			con = (Const *)larg;
+			reverse = true;
+		}
+		else
+			continue;
+		if (var->varno != scanrelid ||
+			var->varlevelsup != 0 ||
+			var->varattno <= 0 ||
+			var->varattno > tupdesc->natts ||
+			con->constisnull)
+			continue;
+		set_opfuncid(op);
+		if (func_volatile(op->opfuncid) != PROVOLATILE_IMMUTABLE)
+			continue;
+
+		for (int k=nparts-1; k >= 0; k--)
+		{
+			/* the last one is the nearest directory to the file */
+			if (part_anums[k] != var->varattno)
+				continue;
+			if (strcmp(part_values[k], HIVE_DEFAULT_PARTITION) == 0)
+			{
+				/* partition value is NULL, so strict operator never match */
+				if (func_strict(op->opfuncid))
+				{
+					retval = false;
+					goto out;
+				}
+				break;
+			}
+			attr = TupleDescAttr(tupdesc, var->varattno - 1);
+			getTypeInputInfo(attr->atttypid, &typinput, &typioparam);
+			datum = OidInputFunctionCall(typinput,
+										 part_values[k],
+										 typioparam,
+										 attr->atttypmod);
+			if (!reverse)
+				result = OidFunctionCall2Coll(op->opfuncid,
+											  op->inputcollid,
+											  datum,
+											  con->constvalue);
+			else
+				result = OidFunctionCall2Coll(op->opfuncid,
+											  op->inputcollid,
+											  con->constvalue,
+											  datum);
+			if (!DatumGetBool(result))
+			{
+				retval = false;
+				goto out;
+			}
+			break;
+		}
+	}
+out:
+	if (part_anums)
+		pfree(part_anums);
+	if (part_values)
+		pfree(part_values);
+	pfree(path);
+	return retval;
 }
 
 /* ----------------------------------------------------------------
@@ -2248,17 +3822,22 @@ __setupIOvectorField(arrowFdwSetupIOContext *con,
 	 */
 
 	if (f_pos >= con->f_offset &&
-		(f_pos & ~PAGE_MASK) == (con->f_offset & ~PAGE_MASK))
+		((f_pos & ~PAGE_MASK) == (con->f_offset & ~PAGE_MASK) ||
+		 f_pos - con->f_offset <= (off_t)arrow_io_coalesce_gap_kb * 1024))
 	{
 		/*
 		 * we can consolidate the two i/o chunks, if file position of the next
 		 * chunk (f_pos) and the current file tail position (con->f_offset) locate
 		 * within the same file page, and gap bytes does not break alignment.
+		 * Also, if the gap is small enough (arrow_fdw.io_coalesce_gap), it is
+		 * cheaper to read and discard the gap bytes than to issue another DMA
+		 * request, because of the per-request overhead of the storage.
 		 */
 		f_gap = f_pos - con->f_offset;
 		m_offset = con->m_offset + f_gap;
 
-		if (m_offset == TYPEALIGN(chunk_align, con->m_offset))
+		if (TYPEALIGN(chunk_align, con->kds_head_sz + m_offset) ==
+			con->kds_head_sz + m_offset)
 		{
 			/* put the gap bytes, if any */
 			if (f_gap > 0)
@@ -2322,6 +3901,15 @@ arrowFdwSetupIOvectorField(arrowFdwSetupIOContext *con,
 							 &cmeta->nullmap_length);
 		//elog(INFO, "D%d att[%d] nullmap=%lu,%lu m_offset=%lu f_offset=%lu", con->depth, index, rb_field->nullmap_offset, rb_field->nullmap_length, con->m_offset, con->f_offset);
 	}
+	if (rb_field->dict_index_length > 0)
+	{
+		__setupIOvectorField(con,
+							 rb_field->dict_index_unitsz,
+							 rb_field->dict_index_offset,
+							 rb_field->dict_index_length,
+							 &cmeta->dict_index_offset,
+							 &cmeta->dict_index_length);
+	}
 	if (rb_field->values_length > 0)
 	{
 		__setupIOvectorField(con,
@@ -2377,7 +3965,7 @@ arrowFdwSetupIOvector(RecordBatchState *rb_state,
 		   kds->ncols <= kds->nr_colmeta &&
 		   kds->ncols == rb_state->nfields);
 	con = alloca(offsetof(arrowFdwSetupIOContext,
-						  ioc[3 * kds->nr_colmeta]));
+						  ioc[4 * kds->nr_colmeta]));
 	con->rb_offset = rb_state->rb_offset;
 	con->f_offset  = ~0UL;	/* invalid offset */
 	con->m_offset  = 0;
@@ -2406,6 +3994,7 @@ arrowFdwSetupIOvector(RecordBatchState *rb_state,
 		nr_chunks = con->io_index;
 	}
 	kds->length = con->kds_head_sz + con->m_offset;
+	rb_state->af_state->stat_nr_iochunks += nr_chunks;
 
 	iovec = palloc0(offsetof(strom_io_vector, ioc[nr_chunks]));
 	iovec->nr_chunks = nr_chunks;
@@ -2448,6 +4037,589 @@ arrowFdwSetupIOvector(RecordBatchState *rb_state,
 	return iovec;
 }
 
+/*
+ * arrowFdwDecompressRecordBatch
+ *
+ * Buffers of the compressed record-batch have different layout on the KDS
+ * from the file, so GPU-Direct SQL cannot load them as is. Instead, it reads
+ * the buffers of the referenced columns, then decompresses them onto the
+ * chunk_buffer just after the KDS header; the KDS is sent as a part of the
+ * command (iovec has no chunks).
+ */
+typedef struct
+{
+	const char *filename;
+	File		filp;		/* -1, if remote file */
+	off_t		rb_offset;
+	int			codec;
+	StringInfo	chunk_buffer;
+	size_t		kds_offset;
+	StringInfoData temp;	/* buffer to read the compressed data */
+} arrowFdwDecompressContext;
+
+static void
+__arrowFdwFileRead(arrowFdwDecompressContext *con,
+				   char *dest, size_t len, off_t f_pos)
+{
+	while (len > 0)
+	{
+		ssize_t		sz;
+
+		CHECK_FOR_INTERRUPTS();
+
+		if (con->filp < 0)
+		{
+			arrowRemoteRange range;
+
+			range.f_pos = f_pos;
+			range.len   = len;
+			range.dest  = dest;
+			arrowRemoteReadRanges(con->filename, &range, 1);
+			break;
+		}
+		sz = FileRead(con->filp, dest, len, f_pos,
+					  WAIT_EVENT_REORDER_BUFFER_READ);
+		if (sz > 0)
+		{
+			Assert(sz <= len);
+			dest  += sz;
+			f_pos += sz;
+			len   -= sz;
+		}
+		else if (sz == 0)
+			elog(ERROR, "arrow_fdw: unexpected EOF at '%s' (pos=%lu)",
+				 con->filename, f_pos);
+		else if (errno != EINTR)
+			elog(ERROR, "failed on FileRead('%s', pos=%lu, len=%lu): %m",
+				 con->filename, f_pos, len);
+	}
+}
+
+static void
+__arrowFdwAssignKdsBuffer(arrowFdwDecompressContext *con,
+						  size_t m_offset,
+						  size_t m_length,
+						  int cmeta_index,
+						  int buffer_kind)
+{
+	kern_colmeta *cmeta;
+
+	cmeta = &((kern_data_store *)(con->chunk_buffer->data +
+								  con->kds_offset))->colmeta[cmeta_index];
+	switch (buffer_kind)
+	{
+		case 'n':
+			cmeta->nullmap_offset = __kds_packed(m_offset);
+			cmeta->nullmap_length = __kds_packed(m_length);
+			break;
+		case 'v':
+			cmeta->values_offset = __kds_packed(m_offset);
+			cmeta->values_length = __kds_packed(m_length);
+			break;
+		case 'e':
+			cmeta->extra_offset = __kds_packed(m_offset);
+			cmeta->extra_length = __kds_packed(m_length);
+			break;
+		default:
+			elog(ERROR, "Bug? unknown buffer kind (%c)", buffer_kind);
+	}
+}
+
+/*
+ * __arrowFdwReadBuffer
+ *
+ * It reads a buffer of the record-batch, and decompresses it if needed,
+ * onto the tail of @dest. It does not move @dest->len, and returns the
+ * length of the raw (uncompressed) data; the caller shall enlarge @dest
+ * by MAXALIGN of the length.
+ */
+static int64_t
+__arrowFdwReadBuffer(arrowFdwDecompressContext *con,
+					 off_t chunk_offset,
+					 size_t chunk_length,
+					 StringInfo dest)
+{
+	char	   *src;
+	char	   *dst;
+	int64_t		raw_length;
+	bool		is_raw;
+
+	if (chunk_length == 0)
+		return 0;
+	/* uncompressed record-batch (has BinaryView/Utf8View fields) */
+	if (con->codec < 0)
+	{
+		enlargeStringInfo(dest, MAXALIGN(chunk_length));
+		__arrowFdwFileRead(con, dest->data + dest->len, chunk_length,
+						   con->rb_offset + chunk_offset);
+		return chunk_length;
+	}
+
+	/*
+	 * Each compressed buffer has 64bit uncompressed length prior to the
+	 * compressed data, or -1 if the buffer is not compressed.
+	 */
+	if (chunk_length < sizeof(int64_t))
+		elog(ERROR, "arrow_fdw: compressed buffer at '%s' is corrupted (length=%zu)",
+			 con->filename, chunk_length);
+	resetStringInfo(&con->temp);
+	enlargeStringInfo(&con->temp, chunk_length);
+	src = con->temp.data;
+	__arrowFdwFileRead(con, src, chunk_length,
+					   con->rb_offset + chunk_offset);
+	memcpy(&raw_length, src, sizeof(int64_t));
+	src += sizeof(int64_t);
+	chunk_length -= sizeof(int64_t);
+	is_raw = (raw_length < 0);
+	if (is_raw)
+		raw_length = chunk_length;
+
+	enlargeStringInfo(dest, MAXALIGN(raw_length));
+	dst = dest->data + dest->len;
+	if (is_raw)
+	{
+		memcpy(dst, src, chunk_length);
+	}
+	else if (con->codec == ArrowCompressionType__LZ4_FRAME)
+	{
+#ifdef WITH_LIBLZ4
+		LZ4F_dctx  *dctx;
+		size_t		d_pos = 0;
+		size_t		s_pos = 0;
+		size_t		rc;
+		const char *errmsg = NULL;
+
+		rc = LZ4F_createDecompressionContext(&dctx, LZ4F_VERSION);
+		if (LZ4F_isError(rc))
+			elog(ERROR, "failed on LZ4F_createDecompressionContext: %s",
+				 LZ4F_getErrorName(rc));
+		while (s_pos < chunk_length)
+		{
+			size_t	d_sz = raw_length - d_pos;
+			size_t	s_sz = chunk_length - s_pos;
+
+			rc = LZ4F_decompress(dctx, dst + d_pos, &d_sz,
+								 src + s_pos, &s_sz, NULL);
+			if (LZ4F_isError(rc))
+			{
+				errmsg = LZ4F_getErrorName(rc);
+				break;
+			}
+			d_pos += d_sz;
+			s_pos += s_sz;
+			if (rc == 0)
+				break;		/* end of the frame */
+			if (d_sz == 0 && s_sz == 0)
+			{
+				errmsg = "no progress";
+				break;
+			}
+		}
+		LZ4F_freeDecompressionContext(dctx);
+		if (errmsg)
+			elog(ERROR, "failed on LZ4F_decompress: %s", errmsg);
+		if (d_pos != raw_length)
+			elog(ERROR, "arrow_fdw: LZ4 decompressed length mismatch (%zu of %ld)",
+				 d_pos, raw_length);
+#else
+		elog(ERROR, "arrow_fdw: LZ4 compression is not supported");
+#endif
+	}
+	else if (con->codec == ArrowCompressionType__ZSTD)
+	{
+#ifdef WITH_LIBZSTD
+		size_t		rc;
+
+		rc = ZSTD_decompress(dst, raw_length, src, chunk_length);
+		if (ZSTD_isError(rc))
+			elog(ERROR, "failed on ZSTD_decompress: %s",
+				 ZSTD_getErrorName(rc));
+		if (rc != raw_length)
+			elog(ERROR, "arrow_fdw: ZSTD decompressed length mismatch (%zu of %ld)",
+				 rc, raw_length);
+#else
+		elog(ERROR, "arrow_fdw: ZSTD compression is not supported");
+#endif
+	}
+	else
+	{
+		elog(ERROR, "arrow_fdw: unknown compression codec (%d)", con->codec);
+	}
+	return raw_length;
+}
+
+static void
+__arrowFdwDecompressBuffer(arrowFdwDecompressContext *con,
+						   uint32_t chunk_align,
+						   off_t    chunk_offset,
+						   size_t   chunk_length,
+						   int      cmeta_index,
+						   int      buffer_kind)
+{
+	StringInfo	chunk_buffer = con->chunk_buffer;
+	char	   *dst;
+	int64_t		raw_length;
+	size_t		m_offset;
+
+	/* put padding bytes for alignment */
+	m_offset = TYPEALIGN(Max(chunk_align, sizeof(int64_t)),
+						 chunk_buffer->len - con->kds_offset);
+	while (chunk_buffer->len - con->kds_offset < m_offset)
+		appendStringInfoChar(chunk_buffer, '\0');
+
+	raw_length = __arrowFdwReadBuffer(con, chunk_offset, chunk_length,
+									  chunk_buffer);
+	dst = chunk_buffer->data + chunk_buffer->len;
+	/* zero clear the padding bytes */
+	memset(dst + raw_length, 0, MAXALIGN(raw_length) - raw_length);
+	chunk_buffer->len += MAXALIGN(raw_length);
+	chunk_buffer->data[chunk_buffer->len] = '\0';
+
+	__arrowFdwAssignKdsBuffer(con, m_offset, MAXALIGN(raw_length),
+							  cmeta_index, buffer_kind);
+}
+
+static void
+__arrowFdwParquetAppendBuffer(arrowFdwDecompressContext *con,
+							  uint32_t chunk_align,
+							  StringInfo buf,
+							  int cmeta_index,
+							  int buffer_kind)
+{
+	StringInfo	chunk_buffer = con->chunk_buffer;
+	size_t		m_offset;
+	size_t		m_length = MAXALIGN(buf->len);
+
+	/* put padding bytes for alignment */
+	m_offset = TYPEALIGN(Max(chunk_align, sizeof(int64_t)),
+						 chunk_buffer->len - con->kds_offset);
+	while (chunk_buffer->len - con->kds_offset < m_offset)
+		appendStringInfoChar(chunk_buffer, '\0');
+	enlargeStringInfo(chunk_buffer, m_length);
+	memcpy(chunk_buffer->data + chunk_buffer->len, buf->data, buf->len);
+	memset(chunk_buffer->data + chunk_buffer->len + buf->len, 0,
+		   m_length - buf->len);
+	chunk_buffer->len += m_length;
+	chunk_buffer->data[chunk_buffer->len] = '\0';
+
+	__arrowFdwAssignKdsBuffer(con, m_offset, m_length,
+							  cmeta_index, buffer_kind);
+}
+
+/*
+ * __arrowFdwDecodeStringView
+ *
+ * BinaryView/Utf8View has 16bytes view for each item; length (int32) and
+ * inline data if length <= 12, or length, prefix (4bytes), index of the
+ * variadic data buffer (int32) and offset (int32) in the buffer. GPU kernel
+ * and CPU fallback don't know the layout, so it is decoded to the usual
+ * Binary/Utf8 layout (uint32 offsets and extra buffer) here.
+ */
+static void
+__arrowFdwDecodeStringView(arrowFdwDecompressContext *con,
+						   RecordBatchFieldState *rb_field,
+						   int cmeta_index)
+{
+	int64_t		nitems = rb_field->nitems;
+	int			nbuffers = rb_field->num_children;
+	StringInfoData nullmap;
+	StringInfoData views;
+	StringInfoData data;
+	StringInfoData values;
+	StringInfoData extra;
+	size_t	   *data_base = alloca(sizeof(size_t) * (nbuffers + 1));
+	size_t	   *data_len = alloca(sizeof(size_t) * (nbuffers + 1));
+	uint32_t   *offsets;
+	uint64_t	extra_len = 0;
+
+	initStringInfo(&nullmap);
+	initStringInfo(&views);
+	initStringInfo(&data);
+	initStringInfo(&values);
+	initStringInfo(&extra);
+	if (rb_field->nullmap_length > 0)
+	{
+		nullmap.len = __arrowFdwReadBuffer(con,
+										   rb_field->nullmap_offset,
+										   rb_field->nullmap_length,
+										   &nullmap);
+		if (nullmap.len < BITMAPLEN(nitems))
+			elog(ERROR, "nullmap length is smaller than expected");
+		__arrowFdwParquetAppendBuffer(con, sizeof(int64_t), &nullmap,
+									  cmeta_index, 'n');
+	}
+	views.len = __arrowFdwReadBuffer(con,
+									 rb_field->values_offset,
+									 rb_field->values_length,
+									 &views);
+	if (views.len < 16 * nitems)
+		elog(ERROR, "values array is smaller than expected");
+	for (int k=0; k < nbuffers; k++)
+	{
+		RecordBatchFieldState *__rb_data = &rb_field->children[k];
+
+		data_base[k] = data.len;
+		data_len[k] = __arrowFdwReadBuffer(con,
+										   __rb_data->extra_offset,
+										   __rb_data->extra_length,
+										   &data);
+		data.len += MAXALIGN(data_len[k]);
+	}
+
+	enlargeStringInfo(&values, sizeof(uint32_t) * (nitems + 1));
+	offsets = (uint32_t *)values.data;
+	offsets[0] = 0;
+	for (int64_t i=0; i < nitems; i++)
+	{
+		const char *view = views.data + 16 * i;
+		int32_t		len;
+
+		memcpy(&len, view, sizeof(int32_t));
+		if ((nullmap.len > 0 && att_isnull(i, (uint8_t *)nullmap.data)) ||
+			len <= 0)
+			len = 0;
+		else if (len <= 12)
+			appendBinaryStringInfo(&extra, view + 4, len);
+		else
+		{
+			int32_t		index;
+			int32_t		offset;
+
+			memcpy(&index,  view +  8, sizeof(int32_t));
+			memcpy(&offset, view + 12, sizeof(int32_t));
+			if (index < 0 || index >= nbuffers ||
+				offset < 0 || offset + (size_t)len > data_len[index])
+				elog(ERROR, "arrow_fdw: BinaryView/Utf8View at '%s' is corrupted",
+					 con->filename);
+			appendBinaryStringInfo(&extra,
+								   data.data + data_base[index] + offset,
+								   len);
+		}
+		extra_len += len;
+		if (extra_len > UINT_MAX)
+			elog(ERROR, "arrow_fdw: BinaryView/Utf8View at '%s' is too large to decode",
+				 con->filename);
+		offsets[i+1] = extra_len;
+	}
+	values.len = sizeof(uint32_t) * (nitems + 1);
+	__arrowFdwParquetAppendBuffer(con, sizeof(uint32_t), &values,
+								  cmeta_index, 'v');
+	__arrowFdwParquetAppendBuffer(con, sizeof(int64_t), &extra,
+								  cmeta_index, 'e');
+	pfree(nullmap.data);
+	pfree(views.data);
+	pfree(data.data);
+	pfree(values.data);
+	pfree(extra.data);
+}
+
+static void
+__arrowFdwDecompressField(arrowFdwDecompressContext *con,
+						  RecordBatchFieldState *rb_field,
+						  int cmeta_index)
+{
+	kern_data_store *kds;
+	kern_colmeta *cmeta;
+
+	if (rb_field->string_view)
+	{
+		__arrowFdwDecodeStringView(con, rb_field, cmeta_index);
+		return;
+	}
+	if (rb_field->nullmap_length > 0)
+	{
+		Assert(rb_field->null_count > 0);
+		__arrowFdwDecompressBuffer(con,
+								   sizeof(int64_t),	/* 64bit alignment */
+								   rb_field->nullmap_offset,
+								   rb_field->nullmap_length,
+								   cmeta_index, 'n');
+	}
+	if (rb_field->values_length > 0)
+	{
+		__arrowFdwDecompressBuffer(con,
+								   rb_field->attopts.align,
+								   rb_field->values_offset,
+								   rb_field->values_length,
+								   cmeta_index, 'v');
+	}
+	if (rb_field->extra_length > 0)
+	{
+		__arrowFdwDecompressBuffer(con,
+								   sizeof(int64_t),	/* 64bit alignment */
+								   rb_field->extra_offset,
+								   rb_field->extra_length,
+								   cmeta_index, 'e');
+	}
+
+	/* nested sub-fields if composite types */
+	kds = (kern_data_store *)(con->chunk_buffer->data + con->kds_offset);
+	cmeta = &kds->colmeta[cmeta_index];
+	if (cmeta->atttypkind == TYPE_KIND__ARRAY ||
+		cmeta->atttypkind == TYPE_KIND__COMPOSITE)
+	{
+		int		idx_subattrs = cmeta->idx_subattrs;
+		int		num_subattrs = cmeta->num_subattrs;
+
+		Assert(rb_field->num_children == num_subattrs);
+		for (int j=0; j < num_subattrs; j++)
+		{
+			__arrowFdwDecompressField(con,
+									  &rb_field->children[j],
+									  idx_subattrs + j);
+		}
+	}
+}
+
+static strom_io_vector *
+arrowFdwDecompressRecordBatch(RecordBatchState *rb_state,
+							  Bitmapset *referenced,
+							  size_t kds_offset,
+							  StringInfo chunk_buffer)
+{
+	ArrowFileState *af_state = rb_state->af_state;
+	arrowFdwDecompressContext con;
+	kern_data_store *kds;
+
+	memset(&con, 0, sizeof(arrowFdwDecompressContext));
+	con.filename = af_state->filename;
+	con.filp = -1;
+	if (!af_state->is_remote &&
+		(con.filp = PathNameOpenFile(af_state->filename,
+									 O_RDONLY | PG_BINARY)) < 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not open file \"%s\": %m", af_state->filename)));
+	con.rb_offset = rb_state->rb_offset;
+	con.codec = rb_state->rb_compression;
+	con.chunk_buffer = chunk_buffer;
+	con.kds_offset = kds_offset;
+	initStringInfo(&con.temp);
+
+	kds = (kern_data_store *)(chunk_buffer->data + kds_offset);
+	Assert(kds->format == KDS_FORMAT_ARROW &&
+		   kds->ncols <= kds->nr_colmeta &&
+		   kds->ncols == rb_state->nfields);
+	chunk_buffer->len = kds_offset + KDS_HEAD_LENGTH(kds);
+	for (int j=0; j < rb_state->nfields; j++)
+	{
+		RecordBatchFieldState *rb_field = &rb_state->fields[j];
+		int			attidx = j + 1 - FirstLowInvalidHeapAttributeNumber;
+
+		if (bms_is_member(attidx, referenced) ||
+			bms_is_member(-FirstLowInvalidHeapAttributeNumber, referenced))
+			__arrowFdwDecompressField(&con, rb_field, j);
+		else
+		{
+			kds = (kern_data_store *)(chunk_buffer->data + kds_offset);
+			kds->colmeta[j].atttypkind = TYPE_KIND__NULL;	/* unreferenced */
+		}
+	}
+	kds = (kern_data_store *)(chunk_buffer->data + kds_offset);
+	kds->length = chunk_buffer->len - kds_offset;
+
+	pfree(con.temp.data);
+	if (con.filp >= 0)
+		FileClose(con.filp);
+
+	return palloc0(offsetof(strom_io_vector, ioc));
+}
+
+/*
+ * arrowFdwLoadParquetRowGroup
+ *
+ * Like the compressed record-batch, it reads the column chunks of the
+ * referenced columns, then decodes the pages into the Arrow compatible
+ * buffers just after the KDS header.
+ */
+static strom_io_vector *
+arrowFdwLoadParquetRowGroup(RecordBatchState *rb_state,
+							Bitmapset *referenced,
+							size_t kds_offset,
+							StringInfo chunk_buffer)
+{
+	ArrowFileState *af_state = rb_state->af_state;
+	arrowFdwDecompressContext con;
+	StringInfoData nullmap;
+	StringInfoData values;
+	StringInfoData extra;
+	kern_data_store *kds;
+
+	memset(&con, 0, sizeof(arrowFdwDecompressContext));
+	con.filename = af_state->filename;
+	con.filp = -1;
+	if (!af_state->is_remote &&
+		(con.filp = PathNameOpenFile(af_state->filename,
+									 O_RDONLY | PG_BINARY)) < 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not open file \"%s\": %m", af_state->filename)));
+	con.rb_offset = rb_state->rb_offset;
+	con.codec = -1;
+	con.chunk_buffer = chunk_buffer;
+	con.kds_offset = kds_offset;
+	initStringInfo(&con.temp);
+	initStringInfo(&nullmap);
+	initStringInfo(&values);
+	initStringInfo(&extra);
+
+	kds = (kern_data_store *)(chunk_buffer->data + kds_offset);
+	Assert(kds->format == KDS_FORMAT_ARROW &&
+		   kds->ncols <= kds->nr_colmeta &&
+		   kds->ncols == rb_state->nfields);
+	chunk_buffer->len = kds_offset + KDS_HEAD_LENGTH(kds);
+	for (int j=0; j < rb_state->nfields; j++)
+	{
+		RecordBatchFieldState *rb_field = &rb_state->fields[j];
+		int			attidx = j + 1 - FirstLowInvalidHeapAttributeNumber;
+		int64_t		null_count;
+
+		if (!bms_is_member(attidx, referenced) &&
+			!bms_is_member(-FirstLowInvalidHeapAttributeNumber, referenced))
+		{
+			kds = (kern_data_store *)(chunk_buffer->data + kds_offset);
+			kds->colmeta[j].atttypkind = TYPE_KIND__NULL;	/* unreferenced */
+			continue;
+		}
+		resetStringInfo(&con.temp);
+		enlargeStringInfo(&con.temp, rb_field->values_length);
+		__arrowFdwFileRead(&con, con.temp.data,
+						   rb_field->values_length,
+						   con.rb_offset + rb_field->values_offset);
+		resetStringInfo(&nullmap);
+		resetStringInfo(&values);
+		resetStringInfo(&extra);
+		null_count = parquetDecodeColumnChunk(con.filename,
+											  &rb_field->pq_desc,
+											  &rb_field->attopts,
+											  con.temp.data,
+											  rb_field->values_length,
+											  rb_state->rb_nitems,
+											  &nullmap,
+											  &values,
+											  &extra);
+		if (null_count > 0)
+			__arrowFdwParquetAppendBuffer(&con, sizeof(int64_t),
+										  &nullmap, j, 'n');
+		__arrowFdwParquetAppendBuffer(&con, rb_field->attopts.align,
+									  &values, j, 'v');
+		if (extra.len > 0)
+			__arrowFdwParquetAppendBuffer(&con, sizeof(int64_t),
+										  &extra, j, 'e');
+	}
+	kds = (kern_data_store *)(chunk_buffer->data + kds_offset);
+	kds->length = chunk_buffer->len - kds_offset;
+
+	pfree(nullmap.data);
+	pfree(values.data);
+	pfree(extra.data);
+	pfree(con.temp.data);
+	if (con.filp >= 0)
+		FileClose(con.filp);
+
+	return palloc0(offsetof(strom_io_vector, ioc));
+}
+
 /*
  * arrowFdwLoadRecordBatch
  */
@@ -2458,6 +4630,7 @@ __arrowKdsAssignAttrOptions(kern_data_store *kds,
 {
 	memcpy(&cmeta->attopts,
 		   &rb_field->attopts, sizeof(ArrowTypeOptions));
+	cmeta->dict_index_unitsz = rb_field->dict_index_unitsz;
 	if (cmeta->atttypkind == TYPE_KIND__ARRAY)
 	{
 		Assert(cmeta->idx_subattrs >= kds->ncols &&
@@ -2482,17 +4655,15 @@ __arrowKdsAssignAttrOptions(kern_data_store *kds,
 	}
 }
 
-static strom_io_vector *
-arrowFdwLoadRecordBatch(Relation relation,
-						Bitmapset *referenced,
-						RecordBatchState *rb_state,
-						StringInfo chunk_buffer)
+static kern_data_store *
+__arrowFdwSetupKdsHead(Relation relation,
+					   RecordBatchState *rb_state,
+					   StringInfo chunk_buffer)
 {
 	TupleDesc	tupdesc = RelationGetDescr(relation);
 	size_t		head_sz = estimate_kern_data_store(tupdesc);
 	kern_data_store *kds;
 
-	/* setup KDS and I/O-vector */
 	enlargeStringInfo(chunk_buffer, head_sz);
 	kds = (kern_data_store *)(chunk_buffer->data +
 							  chunk_buffer->len);
@@ -2506,20 +4677,108 @@ arrowFdwLoadRecordBatch(Relation relation,
 									&rb_state->fields[j]);
 	chunk_buffer->len += head_sz;
 
-	return arrowFdwSetupIOvector(rb_state, referenced, kds);
+	return kds;
 }
 
-static kern_data_store *
-arrowFdwFillupRecordBatch(Relation relation,
-						  Bitmapset *referenced,
-						  RecordBatchState *rb_state,
-						  StringInfo chunk_buffer)
+/*
+ * arrowFdwLoadRemoteIOvector
+ *
+ * Neither GPU-Direct nor the GPU service can read the remote file, so the
+ * chunks of the I/O-vector are fetched onto the chunk_buffer by the ranged
+ * GET requests, then the KDS is sent as a part of the command.
+ */
+static strom_io_vector *
+arrowFdwLoadRemoteIOvector(ArrowFileState *af_state,
+						   strom_io_vector *iovec,
+						   size_t kds_offset,
+						   StringInfo chunk_buffer)
 {
-	ArrowFileState	*af_state = rb_state->af_state;
-	kern_data_store	*kds;
-	strom_io_vector	*iovec;
+	kern_data_store *kds;
+	arrowRemoteRange *ranges;
+	size_t		file_sz = af_state->stat_buf.st_size;
 	char	   *base;
-	File		filp;
+	int			nranges = 0;
+
+	kds = (kern_data_store *)(chunk_buffer->data + kds_offset);
+	enlargeStringInfo(chunk_buffer, kds_offset + kds->length - chunk_buffer->len);
+	kds = (kern_data_store *)(chunk_buffer->data + kds_offset);
+	base = (char *)kds + KDS_HEAD_LENGTH(kds);
+
+	ranges = palloc0(sizeof(arrowRemoteRange) * Max(iovec->nr_chunks, 1));
+	for (int i=0; i < iovec->nr_chunks; i++)
+	{
+		strom_io_chunk *ioc = &iovec->ioc[i];
+		char	   *dest = base + ioc->m_offset;
+		off_t		f_pos = (size_t)ioc->fchunk_id * PAGE_SIZE;
+		size_t		len = (size_t)ioc->nr_pages * PAGE_SIZE;
+
+		/* I/O chunks are page aligned, so it may exceed the file tail */
+		if (f_pos + len > file_sz)
+		{
+			size_t	__len = (f_pos < file_sz ? file_sz - f_pos : 0);
+
+			memset(dest + __len, 0, len - __len);
+			len = __len;
+		}
+		if (len > 0)
+		{
+			ranges[nranges].f_pos = f_pos;
+			ranges[nranges].len   = len;
+			ranges[nranges].dest  = dest;
+			nranges++;
+		}
+	}
+	arrowRemoteReadRanges(af_state->filename, ranges, nranges);
+	chunk_buffer->len = kds_offset + kds->length;
+	pfree(ranges);
+	pfree(iovec);
+
+	return palloc0(offsetof(strom_io_vector, ioc));
+}
+
+static strom_io_vector *
+arrowFdwLoadRecordBatch(Relation relation,
+						Bitmapset *referenced,
+						RecordBatchState *rb_state,
+						StringInfo chunk_buffer)
+{
+	size_t		kds_offset = chunk_buffer->len;
+	kern_data_store *kds;
+
+	/* setup KDS and I/O-vector */
+	kds = __arrowFdwSetupKdsHead(relation, rb_state, chunk_buffer);
+
+	if (rb_state->rb_parquet)
+		return arrowFdwLoadParquetRowGroup(rb_state,
+										   referenced,
+										   kds_offset,
+										   chunk_buffer);
+	if (rb_state->rb_compression >= 0 || rb_state->rb_string_view)
+		return arrowFdwDecompressRecordBatch(rb_state,
+											 referenced,
+											 kds_offset,
+											 chunk_buffer);
+	if (rb_state->af_state->is_remote)
+		return arrowFdwLoadRemoteIOvector(rb_state->af_state,
+										  arrowFdwSetupIOvector(rb_state,
+																referenced,
+																kds),
+										  kds_offset,
+										  chunk_buffer);
+	return arrowFdwSetupIOvector(rb_state, referenced, kds);
+}
+
+static kern_data_store *
+arrowFdwFillupRecordBatch(Relation relation,
+						  Bitmapset *referenced,
+						  RecordBatchState *rb_state,
+						  StringInfo chunk_buffer)
+{
+	ArrowFileState	*af_state = rb_state->af_state;
+	kern_data_store	*kds;
+	strom_io_vector	*iovec;
+	char	   *base;
+	File		filp;
 
 	resetStringInfo(chunk_buffer);
 	iovec = arrowFdwLoadRecordBatch(relation,
@@ -2527,6 +4786,16 @@ arrowFdwFillupRecordBatch(Relation relation,
 									rb_state,
 									chunk_buffer);
 	kds = (kern_data_store *)chunk_buffer->data;
+	if (rb_state->rb_compression >= 0 ||
+		rb_state->rb_parquet ||
+		rb_state->rb_string_view ||
+		af_state->is_remote)
+	{
+		/* already decompressed, decoded or fetched on the chunk_buffer */
+		Assert(iovec->nr_chunks == 0);
+		pfree(iovec);
+		return kds;
+	}
 	enlargeStringInfo(chunk_buffer, kds->length);
 	kds = (kern_data_store *)chunk_buffer->data;
 	filp = PathNameOpenFile(af_state->filename, O_RDONLY | PG_BINARY);
@@ -2579,6 +4848,174 @@ arrowFdwFillupRecordBatch(Relation relation,
 	return kds;
 }
 
+/*
+ * arrowFdwMmapRecordBatch
+ *
+ * It maps the referenced portion of the record-batch on the virtual address
+ * space, and puts the KDS header just in front of the mapped region, so the
+ * CPU scan path can fetch the values without copying them onto the buffer.
+ * Only the pages actually touched are read from the storage.
+ * It returns NULL if record-batch cannot be mapped as is.
+ */
+typedef struct
+{
+	off_t		rb_offset;
+	off_t		f_base;
+	off_t		f_head;
+	off_t		f_tail;
+	size_t		kds_head_sz;
+	bool		setup;			/* false: check the range, true: setup cmeta */
+	bool		misaligned;
+} arrowFdwMmapContext;
+
+static void
+__arrowFdwMmapChunk(arrowFdwMmapContext *con,
+					off_t chunk_offset,
+					size_t chunk_length,
+					uint32_t *p_cmeta_offset,
+					uint32_t *p_cmeta_length)
+{
+	off_t		f_pos = con->rb_offset + chunk_offset;
+
+	if (!con->setup)
+	{
+		if (f_pos != MAXALIGN(f_pos))
+			con->misaligned = true;
+		con->f_head = Min(con->f_head, f_pos);
+		con->f_tail = Max(con->f_tail, f_pos + MAXALIGN(chunk_length));
+	}
+	else
+	{
+		*p_cmeta_offset = __kds_packed(con->kds_head_sz + (f_pos - con->f_base));
+		*p_cmeta_length = __kds_packed(MAXALIGN(chunk_length));
+	}
+}
+
+static void
+__arrowFdwMmapField(arrowFdwMmapContext *con,
+					RecordBatchFieldState *rb_field,
+					kern_data_store *kds,
+					kern_colmeta *cmeta)
+{
+	if (rb_field->nullmap_length > 0)
+		__arrowFdwMmapChunk(con,
+							rb_field->nullmap_offset,
+							rb_field->nullmap_length,
+							&cmeta->nullmap_offset,
+							&cmeta->nullmap_length);
+	if (rb_field->dict_index_length > 0)
+		__arrowFdwMmapChunk(con,
+							rb_field->dict_index_offset,
+							rb_field->dict_index_length,
+							&cmeta->dict_index_offset,
+							&cmeta->dict_index_length);
+	if (rb_field->values_length > 0)
+		__arrowFdwMmapChunk(con,
+							rb_field->values_offset,
+							rb_field->values_length,
+							&cmeta->values_offset,
+							&cmeta->values_length);
+	if (rb_field->extra_length > 0)
+		__arrowFdwMmapChunk(con,
+							rb_field->extra_offset,
+							rb_field->extra_length,
+							&cmeta->extra_offset,
+							&cmeta->extra_length);
+	/* nested sub-fields if composite types */
+	if (cmeta->atttypkind == TYPE_KIND__ARRAY ||
+		cmeta->atttypkind == TYPE_KIND__COMPOSITE)
+	{
+		Assert(rb_field->num_children == cmeta->num_subattrs);
+		for (int j=0; j < cmeta->num_subattrs; j++)
+			__arrowFdwMmapField(con,
+								&rb_field->children[j],
+								kds,
+								&kds->colmeta[cmeta->idx_subattrs + j]);
+	}
+}
+
+static void
+__arrowFdwMmapFields(arrowFdwMmapContext *con,
+					 RecordBatchState *rb_state,
+					 Bitmapset *referenced,
+					 kern_data_store *kds)
+{
+	for (int j=0; j < kds->ncols; j++)
+	{
+		int		attidx = j + 1 - FirstLowInvalidHeapAttributeNumber;
+
+		if (bms_is_member(attidx, referenced) ||
+			bms_is_member(-FirstLowInvalidHeapAttributeNumber, referenced))
+			__arrowFdwMmapField(con, &rb_state->fields[j],
+								kds, &kds->colmeta[j]);
+		else
+			kds->colmeta[j].atttypkind = TYPE_KIND__NULL;	/* unreferenced */
+	}
+}
+
+static kern_data_store *
+arrowFdwMmapRecordBatch(Relation relation,
+						Bitmapset *referenced,
+						RecordBatchState *rb_state,
+						StringInfo chunk_buffer,
+						int mmap_advice,
+						void **p_mmap_addr)
+{
+	ArrowFileState *af_state = rb_state->af_state;
+	arrowFdwMmapContext con;
+	kern_data_store *kds;
+	void	   *mmap_addr;
+	void	   *head;
+	File		filp;
+
+	/* compressed, Parquet or BinaryView/Utf8View must be decoded on the buffer */
+	if (rb_state->rb_compression >= 0 ||
+		rb_state->rb_parquet ||
+		rb_state->rb_string_view ||
+		af_state->is_remote)
+		return NULL;
+
+	resetStringInfo(chunk_buffer);
+	kds = __arrowFdwSetupKdsHead(relation, rb_state, chunk_buffer);
+	memset(&con, 0, sizeof(arrowFdwMmapContext));
+	con.rb_offset = rb_state->rb_offset;
+	con.f_head = PG_INT64_MAX;
+	con.f_tail = 0;
+	con.kds_head_sz = KDS_HEAD_LENGTH(kds);
+	__arrowFdwMmapFields(&con, rb_state, referenced, kds);
+	if (con.misaligned)
+		return NULL;
+	if (con.f_head >= con.f_tail)
+	{
+		/* no columns are referenced, like count(*) */
+		kds->length = con.kds_head_sz;
+		return kds;
+	}
+	con.f_base = PAGE_ALIGN_DOWN(con.f_head);
+	if (con.kds_head_sz + (con.f_tail - con.f_base) >= __KDS_LENGTH_LIMIT)
+		return NULL;
+	con.setup = true;
+	__arrowFdwMmapFields(&con, rb_state, referenced, kds);
+	kds->length = con.kds_head_sz + (con.f_tail - con.f_base);
+
+	filp = PathNameOpenFile(af_state->filename, O_RDONLY | PG_BINARY);
+	if (filp < 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not open file \"%s\": %m", af_state->filename)));
+	mmap_addr = __mmapFileWithHeader(FileGetRawDesc(filp),
+									 con.f_base,
+									 con.f_tail - con.f_base,
+									 con.kds_head_sz,
+									 mmap_advice,
+									 &head);
+	FileClose(filp);
+	memcpy(head, kds, con.kds_head_sz);
+
+	*p_mmap_addr = mmap_addr;
+	return (kern_data_store *)head;
+}
+
 /*
  * ArrowGetForeignRelSize
  */
@@ -2590,7 +5027,8 @@ __recordBatchFieldLength(RecordBatchFieldState *rb_field)
 	if (rb_field->null_count > 0)
 		len += rb_field->nullmap_length;
 	len += (rb_field->values_length +
-			rb_field->extra_length);
+			rb_field->extra_length +
+			rb_field->dict_index_length);
 	for (int j=0; j < rb_field->num_children; j++)
 		len += __recordBatchFieldLength(&rb_field->children[j]);
 	return len;
@@ -2627,6 +5065,10 @@ ArrowGetForeignRelSize(PlannerInfo *root,
 		ArrowFileState *af_state;
 		char	   *fname = strVal(lfirst(lc1));
 
+		if (!arrowFdwCheckPartitionQuals(fname, RelationGetDescr(frel),
+										 baserel->relid,
+										 baserel->baserestrictinfo))
+			continue;	/* pruned by the partition key */
 		af_state = BuildArrowFileState(frel, fname, NULL);
 		if (!af_state)
 			continue;
@@ -2661,6 +5103,7 @@ ArrowGetForeignRelSize(PlannerInfo *root,
 		}
 		results = lappend(results, af_state);
 	}
+	flushArrowMetadataIndex();
 	table_close(frel, NoLock);
 
 	/* setup baserel */
@@ -2676,6 +5119,28 @@ ArrowGetForeignRelSize(PlannerInfo *root,
 							   NULL);
 }
 
+/*
+ * __arrowFdwCountFilesAndBatches
+ */
+static void
+__arrowFdwCountFilesAndBatches(RelOptInfo *baserel,
+							   int *p_nfiles,
+							   int *p_nbatches)
+{
+	List	   *af_list = linitial(baserel->fdw_private);
+	ListCell   *lc;
+	int			nbatches = 0;
+
+	foreach (lc, af_list)
+	{
+		ArrowFileState *af_state = lfirst(lc);
+
+		nbatches += list_length(af_state->rb_list);
+	}
+	*p_nfiles = list_length(af_list);
+	*p_nbatches = nbatches;
+}
+
 /*
  * cost_arrow_fdw_seqscan
  */
@@ -2689,9 +5154,13 @@ cost_arrow_fdw_seqscan(Path *path,
 	Cost		startup_cost = 0.0;
 	Cost		disk_run_cost = 0.0;
 	Cost		cpu_run_cost = 0.0;
+	Cost		file_run_cost = 0.0;
 	QualCost	qcost;
 	double		nrows;
+	double		spc_random_page_cost;
 	double		spc_seq_page_cost;
+	int			nfiles;
+	int			nbatches;
 
 	if (param_info)
 		nrows = param_info->ppi_rows;
@@ -2710,10 +5179,22 @@ cost_arrow_fdw_seqscan(Path *path,
 	 * the pages not to be read.
 	 */
 	get_tablespace_page_costs(baserel->reltablespace,
-							  NULL,
+							  &spc_random_page_cost,
 							  &spc_seq_page_cost);
 	disk_run_cost = spc_seq_page_cost * baserel->pages;
 
+	/*
+	 * Per-file and per-record-batch costs
+	 *
+	 * Each file needs to be opened, and its footer is read unless metadata
+	 * is cached; each record-batch needs at least one i/o request. They are
+	 * not negligible for the many small files, and workers can run them in
+	 * parallel because files are distributed over the workers.
+	 */
+	__arrowFdwCountFilesAndBatches(baserel, &nfiles, &nbatches);
+	file_run_cost = (spc_random_page_cost * (double)nfiles +
+					 spc_seq_page_cost * (double)nbatches);
+
 	/* CPU costs */
 	if (param_info)
 	{
@@ -2742,13 +5223,14 @@ cost_arrow_fdw_seqscan(Path *path,
 
 		/* The CPU cost is divided among all the workers. */
 		cpu_run_cost /= parallel_divisor;
+		file_run_cost /= parallel_divisor;
 
 		/* Estimated row count per background worker process */
 		nrows = clamp_row_est(nrows / parallel_divisor);
 	}
 	path->rows = nrows;
 	path->startup_cost = startup_cost;
-	path->total_cost = startup_cost + cpu_run_cost + disk_run_cost;
+	path->total_cost = startup_cost + cpu_run_cost + disk_run_cost + file_run_cost;
 	path->parallel_workers = num_workers;
 }
 
@@ -2786,10 +5268,21 @@ ArrowGetForeignPaths(PlannerInfo *root,
 
 	if (baserel->consider_parallel)
 	{
-		int		num_workers =
-			compute_parallel_worker(baserel,
-									baserel->pages, -1.0,
-									max_parallel_workers_per_gather);
+		int		nfiles;
+		int		nbatches;
+		int		num_workers;
+
+		/*
+		 * Each file is counted as one page at least, because opening the
+		 * many small files is worth to run in parallel even if total size
+		 * is small. On the other hands, workers more than the number of
+		 * record-batches have nothing to do.
+		 */
+		__arrowFdwCountFilesAndBatches(baserel, &nfiles, &nbatches);
+		num_workers = compute_parallel_worker(baserel,
+											  baserel->pages + nfiles, -1.0,
+											  max_parallel_workers_per_gather);
+		num_workers = Min(num_workers, nbatches);
 //FIXME: Just a workaround to add inner_path of GpuJoin in parallel mode.
 //       We should add non-parallel inner_path
 //		if (num_workers == 0)
@@ -3155,6 +5648,42 @@ pg_inet_arrow_ref(kern_data_store *kds,
 	return PointerGetDatum(ip);
 }
 
+static Datum
+pg_geometry_arrow_ref(kern_data_store *kds,
+					  kern_colmeta *cmeta, size_t index)
+{
+	char	   *base = (char *)kds + __kds_unpack(cmeta->values_offset);
+	size_t		length = __kds_unpack(cmeta->values_length);
+	int			srid = cmeta->attopts.fixed_size_binary.srid;
+	uint32_t	gs_type = GEOM_POINTTYPE;
+	uint32_t	nitems = 1;
+	size_t		len = VARHDRSZ + offsetof(__GSERIALIZED, data);
+	char	   *res;
+	__GSERIALIZED *gs;
+
+	if (cmeta->attopts.fixed_size_binary.byteWidth != 2 * sizeof(float8))
+		elog(ERROR, "Bug? wrong FixedSizeBinary::byteWidth(%d) for geometry",
+			 cmeta->attopts.fixed_size_binary.byteWidth);
+	if (2 * sizeof(float8) * index >= length)
+		elog(ERROR, "corruption? Binary[geometry] points out of range");
+	/* GSERIALIZED v2 point; PostGIS never attaches bbox on points */
+	res = palloc(len + 2 * sizeof(uint32_t) + 2 * sizeof(float8));
+	gs = (__GSERIALIZED *)(res + VARHDRSZ);
+	gs->srid[0] = (srid >> 16) & 0xff;
+	gs->srid[1] = (srid >>  8) & 0xff;
+	gs->srid[2] = (srid & 0xff);
+	gs->gflags  = G2FLAG_VER_0;
+	memcpy(res + len, &gs_type, sizeof(uint32_t));
+	len += sizeof(uint32_t);
+	memcpy(res + len, &nitems, sizeof(uint32_t));
+	len += sizeof(uint32_t);
+	memcpy(res + len, base + 2 * sizeof(float8) * index, 2 * sizeof(float8));
+	len += 2 * sizeof(float8);
+	SET_VARSIZE(res, len);
+
+	return PointerGetDatum(res);
+}
+
 static Datum
 pg_array_arrow_ref(kern_data_store *kds,
 				   kern_colmeta *smeta,
@@ -3317,7 +5846,11 @@ pg_datum_arrow_ref(kern_data_store *kds,
 					datum = pg_bpchar_arrow_ref(kds, cmeta, index);
 					break;
 				default:
-					elog(ERROR, "unknown FixedSizeBinary mapping");
+					if (OidIsValid(cmeta->atttypid) &&
+						cmeta->atttypid == get_geometry_type_oid(true))
+						datum = pg_geometry_arrow_ref(kds, cmeta, index);
+					else
+						elog(ERROR, "unknown FixedSizeBinary mapping");
 					break;
 			}
 			break;
@@ -3399,6 +5932,118 @@ out:
 	*p_isnull = isnull;
 }
 
+/*
+ * pg_datum_arrow_ref_batch
+ *
+ * Column-at-a-time version of pg_datum_arrow_ref; the type dispatch is
+ * resolved once for 'nitems' rows from 'index', then simple fixed-length
+ * types are converted by a tight loop. Other types fall back to the row
+ * by row conversion.
+ */
+static void
+pg_datum_arrow_ref_batch(kern_data_store *kds,
+						 kern_colmeta *cmeta,
+						 size_t index,
+						 int nitems,
+						 Datum *values,
+						 bool *isnull)
+{
+	char	   *base = (char *)kds + __kds_unpack(cmeta->values_offset);
+	size_t		length = __kds_unpack(cmeta->values_length);
+	int32_t		unitsz = cmeta->attopts.unitsz;
+
+	/* nullmap */
+	if (cmeta->nullmap_offset == 0)
+		memset(isnull, 0, sizeof(bool) * nitems);
+	else
+	{
+		for (int i=0; i < nitems; i++)
+			isnull[i] = KDS_ARROW_CHECK_ISNULL(kds, cmeta, index + i);
+	}
+
+	switch (cmeta->attopts.tag)
+	{
+		case ArrowType__Int:
+		case ArrowType__FloatingPoint:
+			if (unitsz * (index + nitems) > length)
+				break;
+			switch (unitsz)
+			{
+				case sizeof(uint8_t):
+					for (int i=0; i < nitems; i++)
+						values[i] = ((uint8_t *)base)[index + i];
+					return;
+				case sizeof(uint16_t):
+					for (int i=0; i < nitems; i++)
+						values[i] = ((uint16_t *)base)[index + i];
+					return;
+				case sizeof(uint32_t):
+					for (int i=0; i < nitems; i++)
+						values[i] = ((uint32_t *)base)[index + i];
+					return;
+				case sizeof(uint64_t):
+					for (int i=0; i < nitems; i++)
+						values[i] = ((uint64_t *)base)[index + i];
+					return;
+				default:
+					break;
+			}
+			break;
+
+		case ArrowType__Bool:
+			if (((index + nitems + 7) >> 3) > length)
+				break;
+			for (int i=0; i < nitems; i++)
+			{
+				size_t	k = index + i;
+
+				values[i] = BoolGetDatum((((uint8_t *)base)[k>>3] & (1<<(k&7))) != 0);
+			}
+			return;
+
+		case ArrowType__Date:
+			if (cmeta->attopts.date.unit != ArrowDateUnit__Day ||
+				sizeof(uint32_t) * (index + nitems) > length)
+				break;
+			for (int i=0; i < nitems; i++)
+			{
+				DateADT	dt = ((uint32_t *)base)[index + i];
+
+				/* convert UNIX epoch to PostgreSQL epoch */
+				dt -= (POSTGRES_EPOCH_JDATE - UNIX_EPOCH_JDATE);
+				values[i] = DateADTGetDatum(dt);
+			}
+			return;
+
+		case ArrowType__Timestamp:
+			if (cmeta->attopts.timestamp.unit != ArrowTimeUnit__MicroSecond ||
+				sizeof(uint64_t) * (index + nitems) > length)
+				break;
+			for (int i=0; i < nitems; i++)
+			{
+				Timestamp	ts = ((uint64_t *)base)[index + i];
+
+				/* convert UNIX epoch to PostgreSQL epoch */
+				ts -= (POSTGRES_EPOCH_JDATE -
+					   UNIX_EPOCH_JDATE) * USECS_PER_DAY;
+				values[i] = TimestampGetDatum(ts);
+			}
+			return;
+
+		default:
+			break;
+	}
+	/* elsewhere, row by row conversion */
+	for (int i=0; i < nitems; i++)
+	{
+		if (isnull[i])
+			values[i] = 0;
+		else
+			pg_datum_arrow_ref(kds, cmeta, index + i,
+							   &values[i], &isnull[i]);
+	}
+}
+
 /*
  * KDS_fetch_tuple_arrow
  */
@@ -3436,6 +6081,119 @@ kds_arrow_fetch_tuple(TupleTableSlot *slot,
  * ----------------------------------------------------------------
  */
 
+/*
+ * execInitArrowLateMat / execCheckArrowLateMat / execEndArrowLateMat
+ *
+ * Late materialization loads the columns referenced by the scan qualifiers
+ * first, and evaluates them on the host. The record-batch is then pruned
+ * without reading the other (usually wider) columns, if no rows match.
+ */
+static arrowLateMat *
+execInitArrowLateMat(ScanState *ss, List *outer_quals,
+					 const Bitmapset *referenced)
+{
+	Relation		frel = ss->ss_currentRelation;
+	Index			scanrelid = ((Scan *)ss->ps.plan)->scanrelid;
+	arrowLateMat   *late_mat;
+	Bitmapset	   *varattnos = NULL;
+	List		   *eval_quals = NIL;
+	ListCell	   *lc;
+	int			k;
+
+	late_mat = palloc0(sizeof(arrowLateMat));
+	foreach (lc, fixup_scanstate_expressions(ss, outer_quals))
+	{
+		Expr   *qual = lfirst(lc);
+
+		if (contain_subplans((Node *)qual) ||
+			contain_volatile_functions((Node *)qual))
+			continue;
+		pull_varattnos((Node *)qual, scanrelid, &varattnos);
+		eval_quals = lappend(eval_quals, qual);
+	}
+	/* whole-row reference or system columns are not supported */
+	if (eval_quals == NIL ||
+		bms_next_member(varattnos, -1) < 1 - FirstLowInvalidHeapAttributeNumber)
+		return NULL;
+	/* no benefit, if the quals reference all the columns */
+	for (k = bms_next_member(referenced, -1);
+		 k >= 0;
+		 k = bms_next_member(referenced, k))
+	{
+		if (!bms_is_member(k, varattnos))
+			break;
+	}
+	if (k < 0)
+		return NULL;
+
+	late_mat->frel = frel;
+	late_mat->pred_referenced = varattnos;
+	late_mat->orig_quals = eval_quals;
+	late_mat->eval_state = ExecInitQual(eval_quals, &ss->ps);
+	late_mat->econtext = CreateExprContext(ss->ps.state);
+	late_mat->pred_slot = MakeSingleTupleTableSlot(RelationGetDescr(frel),
+												   &TTSOpsVirtual);
+	initStringInfo(&late_mat->pred_buffer);
+
+	return late_mat;
+}
+
+static bool
+execCheckArrowLateMat(arrowLateMat *late_mat,
+					  const Bitmapset *referenced,
+					  RecordBatchState *rb_state)
+{
+	ExprContext	   *econtext = late_mat->econtext;
+	TupleTableSlot *slot = late_mat->pred_slot;
+	kern_data_store *kds;
+	size_t		pred_len = 0;
+	size_t		total_len = 0;
+	int			k;
+
+	/* it makes sense only if predicate columns are small enough */
+	for (k = bms_next_member(referenced, -1);
+		 k >= 0;
+		 k = bms_next_member(referenced, k))
+	{
+		int		j = k + FirstLowInvalidHeapAttributeNumber - 1;
+		size_t	len;
+
+		if (j < 0 || j >= rb_state->nfields)
+			continue;
+		len = __recordBatchFieldLength(&rb_state->fields[j]);
+		if (bms_is_member(k, late_mat->pred_referenced))
+			pred_len += len;
+		total_len += len;
+	}
+	if (pred_len * 2 > total_len)
+		return false;
+
+	kds = arrowFdwFillupRecordBatch(late_mat->frel,
+									late_mat->pred_referenced,
+									rb_state,
+									&late_mat->pred_buffer);
+	econtext->ecxt_scantuple = slot;
+	for (size_t index=0; index < kds->nitems; index++)
+	{
+		if ((index & 0x3ffUL) == 0)
+			CHECK_FOR_INTERRUPTS();
+		ResetExprContext(econtext);
+		if (kds_arrow_fetch_tuple(slot, kds, index,
+								  late_mat->pred_referenced) &&
+			ExecQual(late_mat->eval_state, econtext))
+			return false;	/* at least one row matches */
+	}
+	return true;	/* ok, prune this record-batch */
+}
+
+static void
+execEndArrowLateMat(arrowLateMat *late_mat)
+{
+	ExecDropSingleTupleTableSlot(late_mat->pred_slot);
+	FreeExprContext(late_mat->econtext, true);
+	pfree(late_mat->pred_buffer.data);
+}
+
 /*
  * __arrowFdwExecInit
  */
@@ -3451,10 +6209,12 @@ __arrowFdwExecInit(ScanState *ss,
 	ForeignTable   *ft = GetForeignTable(RelationGetRelid(frel));
 	Bitmapset	   *referenced = NULL;
 	Bitmapset	   *stat_attrs = NULL;
+	Bitmapset	   *synth_attrs = NULL;
 	Bitmapset	   *optimal_gpus = NULL;
 	const DpuStorageEntry *ds_entry = NULL;
 	bool			whole_row_ref = false;
 	List		   *filesList;
+	List		   *part_quals;
 	List		   *af_states_list = NIL;
 	uint32_t		rb_nrooms = 0;
 	uint32_t		rb_nitems = 0;
@@ -3478,18 +6238,25 @@ __arrowFdwExecInit(ScanState *ss,
 
 	/* setup ArrowFileState */
 	filesList = arrowFdwExtractFilesList(ft->options, NULL);
+	part_quals = fixup_scanstate_expressions(ss, outer_quals);
 	foreach (lc1, filesList)
 	{
 		char	   *fname = strVal(lfirst(lc1));
 		ArrowFileState *af_state;
 
+		if (!arrowFdwCheckPartitionQuals(fname, tupdesc,
+										 ((Scan *)ss->ps.plan)->scanrelid,
+										 part_quals))
+			continue;	/* pruned by the partition key */
 		af_state = BuildArrowFileState(frel, fname, &stat_attrs);
 		if (af_state)
 		{
 			rb_nrooms += list_length(af_state->rb_list);
 			if (p_optimal_gpus)
 			{
-				const Bitmapset  *__optimal_gpus = GetOptimalGpuForFile(fname);
+				const Bitmapset  *__optimal_gpus = (af_state->is_remote
+													? NULL
+													: GetOptimalGpuForFile(fname));
 
 				if (af_states_list == NIL)
 					optimal_gpus = bms_copy(__optimal_gpus);
@@ -3500,7 +6267,9 @@ __arrowFdwExecInit(ScanState *ss,
 			{
 				const DpuStorageEntry *ds_temp;
 
-				if (af_states_list == NIL)
+				if (af_state->is_remote)
+					ds_entry = NULL;	/* DPU cannot read remote files */
+				else if (af_states_list == NIL)
 					ds_entry = GetOptimalDpuForFile(fname, &af_state->dpu_path);
 				else if (ds_entry)
 				{
@@ -3512,18 +6281,43 @@ __arrowFdwExecInit(ScanState *ss,
 			af_states_list = lappend(af_states_list, af_state);
 		}
 	}
+	flushArrowMetadataIndex();
 
 	/* setup ArrowFdwState */
 	arrow_state = palloc0(offsetof(ArrowFdwState, rb_states[rb_nrooms]));
 	arrow_state->referenced = referenced;
 	if (arrow_fdw_stats_hint_enabled)
-		arrow_state->stats_hint = execInitArrowStatsHint(ss, outer_quals, stat_attrs);
+	{
+		/* columns that file may not have min/max stats, but computable */
+		if (arrow_fdw_stats_synthesis_enabled && af_states_list != NIL)
+		{
+			ArrowFileState *af_state = linitial(af_states_list);
+			RecordBatchState *rb_state = linitial(af_state->rb_list);
+
+			for (int j=0; j < rb_state->nfields; j++)
+			{
+				if (__arrowFieldStatsSynthesizable(&rb_state->fields[j]))
+					synth_attrs = bms_add_member(synth_attrs, j+1);
+			}
+		}
+		arrow_state->stats_hint = execInitArrowStatsHint(ss, outer_quals,
+														 stat_attrs,
+														 synth_attrs);
+	}
+	if (arrow_fdw_late_materialization)
+		arrow_state->late_mat = execInitArrowLateMat(ss, outer_quals, referenced);
 	arrow_state->rbatch_index = &arrow_state->__rbatch_index_local;
 	arrow_state->rbatch_nload = &arrow_state->__rbatch_nload_local;
 	arrow_state->rbatch_nskip = &arrow_state->__rbatch_nskip_local;
+	arrow_state->rbatch_nprune = &arrow_state->__rbatch_nprune_local;
 	initStringInfo(&arrow_state->chunk_buffer);
+	initStringInfo(&arrow_state->coalesce_buffer);
+	arrow_state->rb_pending = NULL;
+	arrow_state->chunk_af_state = NULL;
+	arrow_state->chunk_optimal_gpus = 0UL;
 	arrow_state->curr_filp  = -1;
 	arrow_state->curr_kds   = NULL;
+	arrow_state->curr_mmap  = NULL;
 	arrow_state->curr_index = 0;
 	arrow_state->af_states_list = af_states_list;
 	foreach (lc1, af_states_list)
@@ -3597,13 +6391,68 @@ ArrowBeginForeignScan(ForeignScanState *node, int eflags)
 }
 
 /*
- * ExecArrowScanChunk
+ * pgstromArrowFdwSetJoinKeyRange
+ *
+ * GpuJoin tells the min/max of the inner hash-key after the inner preload;
+ * record-batches out of the range are skipped because they never match.
  */
-static inline RecordBatchState *
-__arrowFdwNextRecordBatch(ArrowFdwState *arrow_state)
+void
+pgstromArrowFdwSetJoinKeyRange(ArrowFdwState *arrow_state,
+							   AttrNumber anum,
+							   int64_t key_min,
+							   int64_t key_max)
 {
-	RecordBatchState *rb_state;
-	uint32_t	rb_index;
+	arrow_state->join_key_anum = anum;
+	arrow_state->join_key_min = key_min;
+	arrow_state->join_key_max = key_max;
+}
+
+static bool
+execCheckArrowJoinKeyRange(ArrowFdwState *arrow_state,
+						   RecordBatchState *rb_state)
+{
+	AttrNumber	anum = arrow_state->join_key_anum;
+	RecordBatchFieldState *rb_field;
+	int64_t		rb_min, rb_max;
+
+	Assert(anum > 0);
+	if (anum > rb_state->nfields)
+		return false;
+	rb_field = &rb_state->fields[anum-1];
+	if (rb_field->stat_datum.isnull)
+		return false;
+	switch (rb_field->atttypid)
+	{
+		case INT2OID:
+			rb_min = DatumGetInt16(rb_field->stat_datum.min.datum);
+			rb_max = DatumGetInt16(rb_field->stat_datum.max.datum);
+			break;
+		case INT4OID:
+		case DATEOID:
+			rb_min = DatumGetInt32(rb_field->stat_datum.min.datum);
+			rb_max = DatumGetInt32(rb_field->stat_datum.max.datum);
+			break;
+		case INT8OID:
+		case TIMESTAMPOID:
+		case TIMESTAMPTZOID:
+			rb_min = DatumGetInt64(rb_field->stat_datum.min.datum);
+			rb_max = DatumGetInt64(rb_field->stat_datum.max.datum);
+			break;
+		default:
+			return false;
+	}
+	return (rb_max < arrow_state->join_key_min ||
+			rb_min > arrow_state->join_key_max);
+}
+
+/*
+ * ExecArrowScanChunk
+ */
+static inline RecordBatchState *
+__arrowFdwNextRecordBatch(ArrowFdwState *arrow_state)
+{
+	RecordBatchState *rb_state;
+	uint32_t	rb_index;
 
 retry:
 	rb_index = pg_atomic_fetch_add_u32(arrow_state->rbatch_index, 1);
@@ -3617,11 +6466,374 @@ retry:
 			pg_atomic_fetch_add_u32(arrow_state->rbatch_nskip, 1);
 			goto retry;
 		}
-		pg_atomic_fetch_add_u32(arrow_state->rbatch_nload, 1);
 	}
+	if (arrow_state->join_key_anum > 0)
+	{
+		if (execCheckArrowJoinKeyRange(arrow_state, rb_state))
+		{
+			pg_atomic_fetch_add_u32(arrow_state->rbatch_nskip, 1);
+			goto retry;
+		}
+	}
+	if (arrow_state->late_mat)
+	{
+		if (execCheckArrowLateMat(arrow_state->late_mat,
+								  arrow_state->referenced,
+								  rb_state))
+		{
+			pg_atomic_fetch_add_u32(arrow_state->rbatch_nprune, 1);
+			goto retry;
+		}
+	}
+	pg_atomic_fetch_add_u32(arrow_state->rbatch_nload, 1);
 	return rb_state;
 }
 
+/*
+ * Coalescing of small record-batches
+ *
+ * Files written by fluentd or similar tools often contain very small
+ * record-batches, so the kernel launch per XpuTaskExec dominates the cost.
+ * Consecutive small record-batches (maybe in different files) are loaded
+ * on the host and merged into one KDS_FORMAT_ARROW chunk up to
+ * arrow_fdw.coalesce_batch_size, then it is sent as a part of the command
+ * like the compressed record-batches.
+ */
+typedef struct
+{
+	int64_t		nitems;		/* number of rows already merged */
+	bool		has_nulls;
+	StringInfoData nullmap;
+	StringInfoData values;
+	StringInfoData extra;
+} arrowCoalesceColumn;
+
+static inline bool
+__arrowFdwIsReferencedField(Bitmapset *referenced, int j)
+{
+	int		attidx = j + 1 - FirstLowInvalidHeapAttributeNumber;
+
+	return (bms_is_member(attidx, referenced) ||
+			bms_is_member(-FirstLowInvalidHeapAttributeNumber, referenced));
+}
+
+/*
+ * __arrowFdwCoalesceBatchSize
+ *
+ * It returns the estimated size of the referenced columns, or -1 if the
+ * record-batch cannot be merged with others (nested or dictionary encoded).
+ */
+static ssize_t
+__arrowFdwCoalesceBatchSize(Bitmapset *referenced, RecordBatchState *rb_state)
+{
+	ssize_t		total_sz = 0;
+
+	for (int j=0; j < rb_state->nfields; j++)
+	{
+		RecordBatchFieldState *rb_field = &rb_state->fields[j];
+
+		if (!__arrowFdwIsReferencedField(referenced, j))
+			continue;
+		if (rb_field->dict_index_unitsz > 0)
+			return -1;
+		switch (rb_field->attopts.tag)
+		{
+			case ArrowType__Int:
+			case ArrowType__FloatingPoint:
+			case ArrowType__Bool:
+			case ArrowType__Decimal:
+			case ArrowType__Date:
+			case ArrowType__Time:
+			case ArrowType__Timestamp:
+			case ArrowType__Interval:
+			case ArrowType__FixedSizeBinary:
+			case ArrowType__Binary:
+			case ArrowType__Utf8:
+			case ArrowType__LargeBinary:
+			case ArrowType__LargeUtf8:
+				break;
+			default:
+				return -1;
+		}
+		total_sz += (rb_field->nullmap_length +
+					 rb_field->values_length +
+					 rb_field->extra_length);
+		/* variadic data buffers of BinaryView/Utf8View */
+		if (rb_field->string_view)
+		{
+			for (int k=0; k < rb_field->num_children; k++)
+				total_sz += rb_field->children[k].extra_length;
+		}
+		else if (rb_field->num_children > 0)
+			return -1;
+	}
+	return total_sz;
+}
+
+static bool
+__arrowFdwCoalesceCompatible(Bitmapset *referenced,
+							 RecordBatchState *rb_head,
+							 RecordBatchState *rb_state)
+{
+	if (rb_head->nfields != rb_state->nfields)
+		return false;
+	for (int j=0; j < rb_head->nfields; j++)
+	{
+		ArrowTypeOptions *a = &rb_head->fields[j].attopts;
+		ArrowTypeOptions *b = &rb_state->fields[j].attopts;
+
+		if (__arrowFdwIsReferencedField(referenced, j) &&
+			(a->tag != b->tag || a->unitsz != b->unitsz))
+			return false;
+	}
+	return true;
+}
+
+static void
+__arrowFdwCoalesceAppendBitmap(StringInfo buf, int64_t head,
+							   const uint8_t *src, int64_t nitems)
+{
+	uint8_t	   *dst;
+	int64_t		len = BITMAPLEN(head + nitems);
+
+	Assert(buf->len == BITMAPLEN(head));
+	enlargeStringInfo(buf, len - buf->len);
+	memset(buf->data + buf->len, 0, len - buf->len);
+	buf->len = len;
+	dst = (uint8_t *)buf->data;
+	if (src && (head & 7) == 0)
+	{
+		memcpy(dst + (head >> 3), src, BITMAPLEN(nitems));
+		if ((nitems & 7) != 0)
+			dst[len - 1] &= (1U << (nitems & 7)) - 1;
+		return;
+	}
+	for (int64_t i=0; i < nitems; i++)
+	{
+		if (!src || (src[i >> 3] & (1U << (i & 7))) != 0)
+		{
+			int64_t		k = head + i;
+
+			dst[k >> 3] |= (1U << (k & 7));
+		}
+	}
+}
+
+static void
+__arrowFdwCoalesceAppendColumn(RecordBatchState *rb_state,
+							   arrowCoalesceColumn *col,
+							   kern_data_store *kds,
+							   kern_colmeta *cmeta)
+{
+	const char *values = NULL;
+	const char *extra = NULL;
+	int64_t		nitems = kds->nitems;
+	int			unitsz = cmeta->attopts.unitsz;
+
+	if (cmeta->nullmap_length > 0)
+		col->has_nulls = true;
+	__arrowFdwCoalesceAppendBitmap(&col->nullmap, col->nitems,
+								   (cmeta->nullmap_length == 0 ? NULL :
+									(uint8_t *)kds + __kds_unpack(cmeta->nullmap_offset)),
+								   nitems);
+	if (cmeta->values_length > 0)
+		values = (char *)kds + __kds_unpack(cmeta->values_offset);
+	if (cmeta->extra_length > 0)
+		extra = (char *)kds + __kds_unpack(cmeta->extra_offset);
+	if (!values)
+		elog(ERROR, "arrow_fdw: values of '%s' are missing at record-batch %d of '%s'",
+			 cmeta->attname, rb_state->rb_index, rb_state->af_state->filename);
+
+	switch (cmeta->attopts.tag)
+	{
+		case ArrowType__Bool:
+			__arrowFdwCoalesceAppendBitmap(&col->values, col->nitems,
+										   (const uint8_t *)values, nitems);
+			break;
+
+		case ArrowType__Binary:
+		case ArrowType__Utf8:
+		case ArrowType__LargeBinary:
+		case ArrowType__LargeUtf8:
+			{
+				uint64_t	base = col->extra.len;
+				uint64_t	head, tail;
+
+				if (col->values.len == 0)
+				{
+					uint64_t	zero = 0;
+
+					appendBinaryStringInfo(&col->values, (char *)&zero, unitsz);
+				}
+				if (unitsz == sizeof(uint32_t))
+				{
+					const uint32_t *offset = (const uint32_t *)values;
+
+					head = offset[0];
+					tail = offset[nitems];
+					if (base + (tail - head) > UINT_MAX)
+						elog(ERROR, "arrow_fdw: too large variable-length buffer to coalesce record-batches; reduce arrow_fdw.coalesce_batch_size");
+					for (int64_t i=1; i <= nitems; i++)
+					{
+						uint32_t	__off = base + (offset[i] - head);
+
+						appendBinaryStringInfo(&col->values, (char *)&__off,
+											   sizeof(uint32_t));
+					}
+				}
+				else
+				{
+					const uint64_t *offset = (const uint64_t *)values;
+
+					Assert(unitsz == sizeof(uint64_t));
+					head = offset[0];
+					tail = offset[nitems];
+					for (int64_t i=1; i <= nitems; i++)
+					{
+						uint64_t	__off = base + (offset[i] - head);
+
+						appendBinaryStringInfo(&col->values, (char *)&__off,
+											   sizeof(uint64_t));
+					}
+				}
+				if (tail > head)
+				{
+					if (!extra)
+						elog(ERROR, "arrow_fdw: extra buffer of '%s' is missing at record-batch %d of '%s'",
+							 cmeta->attname, rb_state->rb_index,
+							 rb_state->af_state->filename);
+					appendBinaryStringInfo(&col->extra, extra + head, tail - head);
+				}
+			}
+			break;
+
+		default:
+			Assert(unitsz > 0);
+			appendBinaryStringInfo(&col->values, values, unitsz * nitems);
+			break;
+	}
+	col->nitems += nitems;
+}
+
+static strom_io_vector *
+arrowFdwLoadCoalescedRecordBatch(Relation relation,
+								 ArrowFdwState *arrow_state,
+								 RecordBatchState *rb_head,
+								 StringInfo chunk_buffer)
+{
+	Bitmapset  *referenced = arrow_state->referenced;
+	List	   *rb_list = list_make1(rb_head);
+	ssize_t		limit = (ssize_t)arrow_coalesce_batch_size_kb * 1024;
+	ssize_t		total_sz;
+	int64_t		total_nitems = rb_head->rb_nitems;
+	arrowCoalesceColumn *columns;
+	arrowFdwDecompressContext con;
+	kern_data_store *kds;
+	size_t		kds_offset = chunk_buffer->len;
+	ListCell   *lc;
+
+	total_sz = __arrowFdwCoalesceBatchSize(referenced, rb_head);
+	if (total_sz >= 0 && total_sz < limit)
+	{
+		RecordBatchState *rb_state;
+		ssize_t		sz;
+
+		while ((rb_state = __arrowFdwNextRecordBatch(arrow_state)) != NULL)
+		{
+			sz = __arrowFdwCoalesceBatchSize(referenced, rb_state);
+			if (sz < 0 ||
+				total_sz + sz > limit ||
+				total_nitems + rb_state->rb_nitems > INT_MAX ||
+				!__arrowFdwCoalesceCompatible(referenced, rb_head, rb_state))
+			{
+				/* it shall be loaded on the next call */
+				arrow_state->rb_pending = rb_state;
+				break;
+			}
+			rb_list = lappend(rb_list, rb_state);
+			total_sz += sz;
+			total_nitems += rb_state->rb_nitems;
+		}
+	}
+	if (list_length(rb_list) == 1)
+	{
+		list_free(rb_list);
+		return arrowFdwLoadRecordBatch(relation,
+									   referenced,
+									   rb_head,
+									   chunk_buffer);
+	}
+
+	/* merge the referenced columns of the record-batches */
+	columns = palloc0(sizeof(arrowCoalesceColumn) * rb_head->nfields);
+	for (int j=0; j < rb_head->nfields; j++)
+	{
+		if (!__arrowFdwIsReferencedField(referenced, j))
+			continue;
+		initStringInfo(&columns[j].nullmap);
+		initStringInfo(&columns[j].values);
+		initStringInfo(&columns[j].extra);
+	}
+	foreach (lc, rb_list)
+	{
+		RecordBatchState *rb_state = lfirst(lc);
+
+		if (rb_state->rb_nitems == 0)
+			continue;
+		kds = arrowFdwFillupRecordBatch(relation,
+										referenced,
+										rb_state,
+										&arrow_state->coalesce_buffer);
+		for (int j=0; j < rb_head->nfields; j++)
+		{
+			if (__arrowFdwIsReferencedField(referenced, j))
+				__arrowFdwCoalesceAppendColumn(rb_state,
+											   &columns[j],
+											   kds,
+											   &kds->colmeta[j]);
+		}
+	}
+
+	/* setup KDS on the chunk_buffer */
+	kds = __arrowFdwSetupKdsHead(relation, rb_head, chunk_buffer);
+	kds->nitems = total_nitems;
+	memset(&con, 0, sizeof(arrowFdwDecompressContext));
+	con.filename = rb_head->af_state->filename;
+	con.filp = -1;
+	con.chunk_buffer = chunk_buffer;
+	con.kds_offset = kds_offset;
+	for (int j=0; j < rb_head->nfields; j++)
+	{
+		RecordBatchFieldState *rb_field = &rb_head->fields[j];
+		arrowCoalesceColumn *col = &columns[j];
+
+		if (!__arrowFdwIsReferencedField(referenced, j))
+		{
+			kds = (kern_data_store *)(chunk_buffer->data + kds_offset);
+			kds->colmeta[j].atttypkind = TYPE_KIND__NULL;	/* unreferenced */
+			continue;
+		}
+		if (col->has_nulls)
+			__arrowFdwParquetAppendBuffer(&con, sizeof(int64_t),
+										  &col->nullmap, j, 'n');
+		__arrowFdwParquetAppendBuffer(&con, rb_field->attopts.align,
+									  &col->values, j, 'v');
+		if (col->extra.len > 0)
+			__arrowFdwParquetAppendBuffer(&con, sizeof(int64_t),
+										  &col->extra, j, 'e');
+		pfree(col->nullmap.data);
+		pfree(col->values.data);
+		pfree(col->extra.data);
+	}
+	kds = (kern_data_store *)(chunk_buffer->data + kds_offset);
+	kds->length = chunk_buffer->len - kds_offset;
+
+	pfree(columns);
+	list_free(rb_list);
+
+	return palloc0(offsetof(strom_io_vector, ioc));
+}
+
 /*
  * pgstromScanChunkArrowFdw
  */
@@ -3639,8 +6851,12 @@ pgstromScanChunkArrowFdw(pgstromTaskState *pts,
 	uint32_t		kds_src_iovec;
 	uint32_t		kds_src_pathname;
 
-	rb_state = __arrowFdwNextRecordBatch(arrow_state);
-	if (!rb_state)
+	if (arrow_state->rb_pending)
+	{
+		rb_state = arrow_state->rb_pending;
+		arrow_state->rb_pending = NULL;
+	}
+	else if (!(rb_state = __arrowFdwNextRecordBatch(arrow_state)))
 	{
 		pts->scan_done = true;
 		return NULL;
@@ -3654,10 +6870,25 @@ pgstromScanChunkArrowFdw(pgstromTaskState *pts,
 						   pts->xcmd_buf.len);
 	/* kds_src + iovec */
 	kds_src_offset = chunk_buffer->len;
-	iovec = arrowFdwLoadRecordBatch(pts->css.ss.ss_currentRelation,
-									arrow_state->referenced,
-									rb_state,
-									chunk_buffer);
+	if (arrow_coalesce_batch_size_kb > 0)
+		iovec = arrowFdwLoadCoalescedRecordBatch(pts->css.ss.ss_currentRelation,
+												 arrow_state,
+												 rb_state,
+												 chunk_buffer);
+	else
+		iovec = arrowFdwLoadRecordBatch(pts->css.ss.ss_currentRelation,
+										arrow_state->referenced,
+										rb_state,
+										chunk_buffer);
+	/* route the chunk to the GPU nearest to the file, if multi-GPU split */
+	if (arrow_state->chunk_af_state != af_state)
+	{
+		arrow_state->chunk_af_state = af_state;
+		arrow_state->chunk_optimal_gpus = (af_state->is_remote || pts->ds_entry
+										   ? 0UL
+										   : GetOptimalGpuForFileChunk(pts, af_state->filename));
+	}
+	pts->chunk_optimal_gpus = arrow_state->chunk_optimal_gpus;
 	kds_src_iovec = __appendBinaryStringInfo(chunk_buffer,
 											 iovec,
 											 offsetof(strom_io_vector,
@@ -3687,12 +6918,70 @@ pgstromScanChunkArrowFdw(pgstromTaskState *pts,
 /*
  * ArrowIterateForeignScan
  */
+#define ARROW_DEFORM_BATCH_SZ		256
+
+static void
+__arrowFdwDeformBatch(ArrowFdwState *arrow_state, EState *estate)
+{
+	kern_data_store *kds = arrow_state->curr_kds;
+	MemoryContext	oldcxt;
+	int				nitems;
+
+	if (!arrow_state->batch_memcxt)
+	{
+		int		natts = 0;
+
+		oldcxt = MemoryContextSwitchTo(estate->es_query_cxt);
+		arrow_state->batch_attidx = palloc0(sizeof(int) * (kds->ncols + 1));
+		for (int k = bms_next_member(arrow_state->referenced, -1);
+			 k >= 0;
+			 k = bms_next_member(arrow_state->referenced, k))
+		{
+			int		j = k + FirstLowInvalidHeapAttributeNumber - 1;
+
+			if (j >= 0 && j < kds->ncols)
+				arrow_state->batch_attidx[natts++] = j;
+		}
+		arrow_state->batch_natts = natts;
+		arrow_state->batch_values = palloc0(sizeof(Datum *) * (natts + 1));
+		arrow_state->batch_isnull = palloc0(sizeof(bool *) * (natts + 1));
+		for (int i=0; i < natts; i++)
+		{
+			arrow_state->batch_values[i] = palloc(sizeof(Datum) * ARROW_DEFORM_BATCH_SZ);
+			arrow_state->batch_isnull[i] = palloc(sizeof(bool)  * ARROW_DEFORM_BATCH_SZ);
+		}
+		arrow_state->batch_memcxt = AllocSetContextCreate(estate->es_query_cxt,
+														  "arrow_fdw deform batch",
+														  ALLOCSET_DEFAULT_SIZES);
+		MemoryContextSwitchTo(oldcxt);
+	}
+	MemoryContextReset(arrow_state->batch_memcxt);
+
+	Assert(arrow_state->curr_index < kds->nitems);
+	nitems = Min(kds->nitems - arrow_state->curr_index, ARROW_DEFORM_BATCH_SZ);
+	oldcxt = MemoryContextSwitchTo(arrow_state->batch_memcxt);
+	for (int i=0; i < arrow_state->batch_natts; i++)
+	{
+		int		j = arrow_state->batch_attidx[i];
+
+		pg_datum_arrow_ref_batch(kds, &kds->colmeta[j],
+								 arrow_state->curr_index,
+								 nitems,
+								 arrow_state->batch_values[i],
+								 arrow_state->batch_isnull[i]);
+	}
+	MemoryContextSwitchTo(oldcxt);
+	arrow_state->batch_head = arrow_state->curr_index;
+	arrow_state->batch_nitems = nitems;
+}
+
 static TupleTableSlot *
 ArrowIterateForeignScan(ForeignScanState *node)
 {
 	ArrowFdwState *arrow_state = node->fdw_state;
 	TupleTableSlot *slot = node->ss.ss_ScanTupleSlot;
 	kern_data_store *kds;
+	uint32_t	index;
 
 	while ((kds = arrow_state->curr_kds) == NULL ||
 		   arrow_state->curr_index >= kds->nitems)
@@ -3701,21 +6990,47 @@ ArrowIterateForeignScan(ForeignScanState *node)
 
 		arrow_state->curr_index = 0;
 		arrow_state->curr_kds = NULL;
+		arrow_state->batch_head = 0;
+		arrow_state->batch_nitems = 0;
+		if (arrow_state->curr_mmap)
+		{
+			__munmapShmem(arrow_state->curr_mmap);
+			arrow_state->curr_mmap = NULL;
+		}
 		rb_state = __arrowFdwNextRecordBatch(arrow_state);
 		if (!rb_state)
 			return NULL;
-		arrow_state->curr_kds
-			= arrowFdwFillupRecordBatch(node->ss.ss_currentRelation,
-										arrow_state->referenced,
-										rb_state,
-										&arrow_state->chunk_buffer);
+		if (arrow_fdw_mmap_enabled)
+			arrow_state->curr_kds
+				= arrowFdwMmapRecordBatch(node->ss.ss_currentRelation,
+										  arrow_state->referenced,
+										  rb_state,
+										  &arrow_state->chunk_buffer,
+										  MADV_SEQUENTIAL,
+										  &arrow_state->curr_mmap);
+		if (!arrow_state->curr_kds)
+			arrow_state->curr_kds
+				= arrowFdwFillupRecordBatch(node->ss.ss_currentRelation,
+											arrow_state->referenced,
+											rb_state,
+											&arrow_state->chunk_buffer);
 	}
 	Assert(kds && arrow_state->curr_index < kds->nitems);
-	if (kds_arrow_fetch_tuple(slot, kds,
-							  arrow_state->curr_index++,
-							  arrow_state->referenced))
-		return slot;
-	return NULL;
+	if (arrow_state->curr_index >= (arrow_state->batch_head +
+									arrow_state->batch_nitems))
+		__arrowFdwDeformBatch(arrow_state, node->ss.ps.state);
+	Assert(arrow_state->curr_index >= arrow_state->batch_head);
+	index = arrow_state->curr_index++ - arrow_state->batch_head;
+
+	ExecStoreAllNullTuple(slot);
+	for (int k=0; k < arrow_state->batch_natts; k++)
+	{
+		int		j = arrow_state->batch_attidx[k];
+
+		slot->tts_values[j] = arrow_state->batch_values[k][index];
+		slot->tts_isnull[j] = arrow_state->batch_isnull[k][index];
+	}
+	return slot;
 }
 
 /*
@@ -3725,9 +7040,14 @@ void
 pgstromArrowFdwExecReset(ArrowFdwState *arrow_state)
 {
 	pg_atomic_write_u32(arrow_state->rbatch_index, 0);
-	if (arrow_state->curr_kds)
-		pfree(arrow_state->curr_kds);
+	arrow_state->rb_pending = NULL;
+	/* curr_kds is either on the chunk_buffer or memory-mapped */
+	if (arrow_state->curr_mmap)
+		__munmapShmem(arrow_state->curr_mmap);
+	arrow_state->curr_mmap = NULL;
 	arrow_state->curr_kds = NULL;
+	arrow_state->batch_head = 0;
+	arrow_state->batch_nitems = 0;
 	arrow_state->curr_index = 0;
 }
 
@@ -3737,6 +7057,60 @@ ArrowReScanForeignScan(ForeignScanState *node)
 	pgstromArrowFdwExecReset(node->fdw_state);
 }
 
+/*
+ * saveSynthArrowStats
+ *
+ * It writes back the min/max statistics synthesized during the scan to the
+ * metadata cache and the persistent metadata index, so later scans can skip
+ * the record-batches without reading the values.
+ */
+static void
+saveSynthArrowStats(ArrowFdwState *arrow_state)
+{
+	bool		updated = false;
+	ListCell   *lc1, *lc2;
+
+	foreach (lc1, arrow_state->af_states_list)
+	{
+		ArrowFileState *af_state = lfirst(lc1);
+		arrowMetadataCache *mcache;
+
+		if (!af_state->stats_synth)
+			continue;
+		LWLockAcquire(&arrow_metadata_cache->mutex, LW_EXCLUSIVE);
+		mcache = lookupArrowMetadataCache(&af_state->stat_buf, true);
+		foreach (lc2, af_state->rb_list)
+		{
+			RecordBatchState *rb_state = lfirst(lc2);
+			dlist_iter	iter;
+			int			j = 0;
+
+			if (!mcache)
+				break;
+			Assert(mcache->rb_index == rb_state->rb_index &&
+				   mcache->nfields == rb_state->nfields);
+			dlist_foreach(iter, &mcache->fields)
+			{
+				arrowMetadataFieldCache *fcache
+					= dlist_container(arrowMetadataFieldCache, chain, iter.cur);
+				RecordBatchFieldState *rb_field = &rb_state->fields[j++];
+
+				if (fcache->stat_datum.isnull && !rb_field->stat_datum.isnull)
+					memcpy(&fcache->stat_datum,
+						   &rb_field->stat_datum, sizeof(MinMaxStatDatum));
+			}
+			mcache = mcache->next;
+		}
+		LWLockRelease(&arrow_metadata_cache->mutex);
+
+		saveArrowMetadataIndex(af_state);
+		af_state->stats_synth = false;
+		updated = true;
+	}
+	if (updated)
+		flushArrowMetadataIndex();
+}
+
 /*
  * ExecEndArrowScan
  */
@@ -3745,8 +7119,15 @@ pgstromArrowFdwExecEnd(ArrowFdwState *arrow_state)
 {
 	if (arrow_state->curr_filp >= 0)
 		FileClose(arrow_state->curr_filp);
+	if (arrow_state->curr_mmap)
+		__munmapShmem(arrow_state->curr_mmap);
 	if (arrow_state->stats_hint)
+	{
+		saveSynthArrowStats(arrow_state);
 		execEndArrowStatsHint(arrow_state->stats_hint);
+	}
+	if (arrow_state->late_mat)
+		execEndArrowLateMat(arrow_state->late_mat);
 }
 
 static void
@@ -3786,6 +7167,7 @@ pgstromArrowFdwInitDSM(ArrowFdwState *arrow_state,
 	arrow_state->rbatch_index = &ps_state->arrow_rbatch_index;
 	arrow_state->rbatch_nload = &ps_state->arrow_rbatch_nload;
 	arrow_state->rbatch_nskip = &ps_state->arrow_rbatch_nskip;
+	arrow_state->rbatch_nprune = &ps_state->arrow_rbatch_nprune;
 }
 
 static void
@@ -3809,6 +7191,7 @@ pgstromArrowFdwAttachDSM(ArrowFdwState *arrow_state,
 	arrow_state->rbatch_index = &ps_state->arrow_rbatch_index;
 	arrow_state->rbatch_nload = &ps_state->arrow_rbatch_nload;
 	arrow_state->rbatch_nskip = &ps_state->arrow_rbatch_nskip;
+	arrow_state->rbatch_nprune = &ps_state->arrow_rbatch_nprune;
 }
 
 static void
@@ -3841,6 +7224,32 @@ pgstromArrowFdwShutdown(ArrowFdwState *arrow_state)
 	pg_atomic_write_u32(&arrow_state->__rbatch_nskip_local, temp);
 	arrow_state->rbatch_nskip = &arrow_state->__rbatch_nskip_local;
 
+	temp = pg_atomic_read_u32(arrow_state->rbatch_nprune);
+	pg_atomic_write_u32(&arrow_state->__rbatch_nprune_local, temp);
+	arrow_state->rbatch_nprune = &arrow_state->__rbatch_nprune_local;
+}
+
+/*
+ * pgstromArrowFdwFileSignature
+ *
+ * It appends the signature of the source files (path, size and mtime, as
+ * the metadata cache identifies the file), to validate the cached results.
+ */
+void
+pgstromArrowFdwFileSignature(ArrowFdwState *arrow_state, StringInfo buf)
+{
+	ListCell   *lc;
+
+	foreach (lc, arrow_state->af_states_list)
+	{
+		ArrowFileState *af_state = lfirst(lc);
+
+		appendStringInfo(buf, "%s:%lu:%ld.%09ld;",
+						 af_state->filename,
+						 (uint64_t)af_state->stat_buf.st_size,
+						 (long)af_state->stat_buf.st_mtim.tv_sec,
+						 (long)af_state->stat_buf.st_mtim.tv_nsec);
+	}
 }
 
 static void
@@ -3910,20 +7319,63 @@ pgstromArrowFdwExplain(ArrowFdwState *arrow_state,
 		ExplainPropertyText("Stats-Hint", buf.data, es);
 	}
 
-	/* shows files on behalf of the foreign table */
-	chunk_sz = alloca(sizeof(size_t) * tupdesc->natts);
-	memset(chunk_sz, 0, sizeof(size_t) * tupdesc->natts);
-	foreach (lc1, arrow_state->af_states_list)
+	/* shows the inner key range of GpuJoin, if any */
+	if (arrow_state->join_key_anum > 0 &&
+		arrow_state->join_key_anum <= tupdesc->natts)
 	{
-		ArrowFileState *af_state = lfirst(lc1);
-		const char *filename = af_state->filename;
-		size_t		total_sz = af_state->stat_buf.st_size;
-		size_t		read_sz = 0;
-		size_t		sz;
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, arrow_state->join_key_anum-1);
 
-		foreach (lc2, af_state->rb_list)
-		{
-			RecordBatchState *rb_state = lfirst(lc2);
+		resetStringInfo(&buf);
+		appendStringInfo(&buf, "%s [%ld..%ld]",
+						 quote_identifier(NameStr(attr->attname)),
+						 arrow_state->join_key_min,
+						 arrow_state->join_key_max);
+		if (es->analyze)
+			appendStringInfo(&buf, "  [skipped: %u]",
+							 pg_atomic_read_u32(arrow_state->rbatch_nskip));
+		ExplainPropertyText("Join-Key Range", buf.data, es);
+	}
+
+	/* shows late materialization if any */
+	if (arrow_state->late_mat)
+	{
+		arrowLateMat *late_mat = arrow_state->late_mat;
+
+		resetStringInfo(&buf);
+		for (k = bms_next_member(late_mat->pred_referenced, -1);
+			 k >= 0;
+			 k = bms_next_member(late_mat->pred_referenced, k))
+		{
+			j = k + FirstLowInvalidHeapAttributeNumber;
+			if (j > 0)
+			{
+				Form_pg_attribute attr = TupleDescAttr(tupdesc, j-1);
+
+				if (buf.len > 0)
+					appendStringInfoString(&buf, ", ");
+				appendStringInfoString(&buf, quote_identifier(NameStr(attr->attname)));
+			}
+		}
+		if (es->analyze)
+			appendStringInfo(&buf, "  [pruned: %u]",
+							 pg_atomic_read_u32(arrow_state->rbatch_nprune));
+		ExplainPropertyText("Late-Materialization", buf.data, es);
+	}
+
+	/* shows files on behalf of the foreign table */
+	chunk_sz = alloca(sizeof(size_t) * tupdesc->natts);
+	memset(chunk_sz, 0, sizeof(size_t) * tupdesc->natts);
+	foreach (lc1, arrow_state->af_states_list)
+	{
+		ArrowFileState *af_state = lfirst(lc1);
+		const char *filename = af_state->filename;
+		size_t		total_sz = af_state->stat_buf.st_size;
+		size_t		read_sz = 0;
+		size_t		sz;
+
+		foreach (lc2, af_state->rb_list)
+		{
+			RecordBatchState *rb_state = lfirst(lc2);
 
 			if (bms_is_member(-FirstLowInvalidHeapAttributeNumber,
 							  arrow_state->referenced))
@@ -3955,205 +7407,1077 @@ pgstromArrowFdwExplain(ArrowFdwState *arrow_state,
 		if (es->format == EXPLAIN_FORMAT_TEXT)
 		{
 			resetStringInfo(&buf);
-			appendStringInfo(&buf, "%s (read: %s, size: %s)",
+			appendStringInfo(&buf, "%s (read: %s, size: %s",
 							 filename,
 							 format_bytesz(read_sz),
 							 format_bytesz(total_sz));
+			if (es->analyze && es->verbose)
+				appendStringInfo(&buf, ", io-chunks: %lu",
+								 af_state->stat_nr_iochunks);
+			appendStringInfoChar(&buf, ')');
 			snprintf(label, sizeof(label), "file%d", fcount);
 			ExplainPropertyText(label, buf.data, es);
 		}
 		else
 		{
-			snprintf(label, sizeof(label), "file%d", fcount);
-			ExplainPropertyText(label, filename, es);
+			snprintf(label, sizeof(label), "file%d", fcount);
+			ExplainPropertyText(label, filename, es);
+
+			snprintf(label, sizeof(label), "file%d-read", fcount);
+			ExplainPropertyText(label, format_bytesz(read_sz), es);
+
+			snprintf(label, sizeof(label), "file%d-size", fcount);
+			ExplainPropertyText(label, format_bytesz(total_sz), es);
+
+			if (es->analyze && es->verbose)
+			{
+				snprintf(label, sizeof(label), "file%d-io-chunks", fcount);
+				ExplainPropertyUInteger(label, NULL, af_state->stat_nr_iochunks, es);
+			}
+		}
+		fcount++;
+	}
+
+	/* read-size per column (only verbose mode) */
+	if (es->verbose && arrow_state->rb_nitems > 0 &&
+		!bms_is_member(-FirstLowInvalidHeapAttributeNumber,
+					   arrow_state->referenced))
+	{
+		resetStringInfo(&buf);
+		for (k = bms_next_member(arrow_state->referenced, -1);
+			 k >= 0;
+			 k = bms_next_member(arrow_state->referenced, k))
+		{
+			Form_pg_attribute attr;
+
+			j = k + FirstLowInvalidHeapAttributeNumber - 1;
+			if (j < 0 || j >= tupdesc->natts)
+				continue;
+			attr = TupleDescAttr(tupdesc, j);
+			snprintf(label, sizeof(label), "  %s", NameStr(attr->attname));
+			ExplainPropertyText(label, format_bytesz(chunk_sz[j]), es);
+		}
+	}
+	pfree(buf.data);
+}
+
+static void
+ArrowExplainForeignScan(ForeignScanState *node, ExplainState *es)
+{
+	Relation		frel = node->ss.ss_currentRelation;
+	List		   *dcontext;
+
+	dcontext = set_deparse_context_plan(es->deparse_cxt,
+										node->ss.ps.plan,
+										NULL);
+	pgstromArrowFdwExplain(node->fdw_state, frel, es, dcontext);
+}
+
+/*
+ * ArrowAnalyzeForeignTable
+ */
+#define ARROW_ANALYZE_SAMPLES_PER_BATCH		100
+
+static int
+__sampleRowIndexComp(const void *__a, const void *__b)
+{
+	uint32_t	a = *((const uint32_t *)__a);
+	uint32_t	b = *((const uint32_t *)__b);
+
+	if (a < b)
+		return -1;
+	if (a > b)
+		return 1;
+	return 0;
+}
+
+static int
+RecordBatchAcquireSampleRows(Relation relation,
+							 RecordBatchState *rb_state,
+							 HeapTuple *rows,
+							 int nsamples)
+{
+	TupleDesc		tupdesc = RelationGetDescr(relation);
+	kern_data_store *kds;
+	Bitmapset	   *referenced = NULL;
+	StringInfoData	buffer;
+	Datum		   *values;
+	bool		   *isnull;
+	uint32_t	   *index;
+	void		   *mmap_addr = NULL;
+	int				count;
+
+	/* ANALYZE needs to fetch all the attributes */
+	referenced = bms_make_singleton(-FirstLowInvalidHeapAttributeNumber);
+	initStringInfo(&buffer);
+	/*
+	 * Memory mapping reads only the pages that contain the sampled rows,
+	 * instead of the entire record-batch.
+	 */
+	if (arrow_fdw_mmap_enabled)
+		kds = arrowFdwMmapRecordBatch(relation,
+									  referenced,
+									  rb_state,
+									  &buffer,
+									  MADV_RANDOM,
+									  &mmap_addr);
+	else
+		kds = NULL;
+	if (!kds)
+		kds = arrowFdwFillupRecordBatch(relation,
+										referenced,
+										rb_state,
+										&buffer);
+	/* fetch rows randomly, but in order of the position */
+	index = palloc(sizeof(uint32_t) * nsamples);
+	for (count = 0; count < nsamples; count++)
+	{
+		index[count] = (double)kds->nitems * drand48();
+		Assert(index[count] < kds->nitems);
+	}
+	qsort(index, nsamples, sizeof(uint32_t), __sampleRowIndexComp);
+
+	values = alloca(sizeof(Datum) * tupdesc->natts);
+	isnull = alloca(sizeof(bool)  * tupdesc->natts);
+	for (count = 0; count < nsamples; count++)
+	{
+		for (int j=0; j < kds->ncols; j++)
+		{
+			kern_colmeta   *cmeta = &kds->colmeta[j];
+
+			pg_datum_arrow_ref(kds,
+							   cmeta,
+							   index[count],
+							   values + j,
+							   isnull + j);
+		}
+		rows[count] = heap_form_tuple(tupdesc, values, isnull);
+	}
+	if (mmap_addr)
+		__munmapShmem(mmap_addr);
+	pfree(buffer.data);
+	pfree(index);
+
+	return count;
+}
+
+static int
+ArrowAcquireSampleRows(Relation relation,
+					   int elevel,
+					   HeapTuple *rows,
+					   int nrooms,
+					   double *p_totalrows,
+					   double *p_totaldeadrows)
+{
+	ForeignTable   *ft = GetForeignTable(RelationGetRelid(relation));
+	List		   *filesList = arrowFdwExtractFilesList(ft->options, NULL);
+	List		   *rb_state_list = NIL;
+	ListCell	   *lc1, *lc2;
+	int64			total_nrows = 0;
+	int64			sample_nrows = 0;
+	int64			count_nrows = 0;
+	int				nsamples_min = Min(nrooms / 100,
+									   ARROW_ANALYZE_SAMPLES_PER_BATCH / 2);
+	int				nbatches = 0;
+	int				nbatches_targ;
+	int				nitems = 0;
+
+	foreach (lc1, filesList)
+	{
+		ArrowFileState *af_state;
+		char	   *fname = strVal(lfirst(lc1));
+
+		af_state = BuildArrowFileState(relation, fname, NULL);
+		if (!af_state)
+			continue;
+		foreach (lc2, af_state->rb_list)
+		{
+			RecordBatchState *rb_state = lfirst(lc2);
+
+			if (rb_state->rb_nitems == 0)
+				continue;	/* not reasonable to sample, skipped */
+			total_nrows += rb_state->rb_nitems;
+			rb_state_list = lappend(rb_state_list, rb_state);
+			nbatches++;
+		}
+	}
+	flushArrowMetadataIndex();
+	nrooms = Min(nrooms, total_nrows);
+
+	/*
+	 * Choose the record-batches to be sampled, like block-sampling of heap
+	 * tables; a huge table need not load all the record-batches, because
+	 * the number of rows is already known from the metadata.
+	 */
+	nbatches_targ = Min(nbatches, Max(nrooms / ARROW_ANALYZE_SAMPLES_PER_BATCH, 1));
+	if (nbatches_targ < nbatches)
+	{
+		List	   *temp = NIL;
+		int			index = 0;
+
+		foreach (lc1, rb_state_list)
+		{
+			/* Knuth's algorithm S */
+			if ((double)(nbatches - index) * drand48() <
+				(double)(nbatches_targ - list_length(temp)))
+				temp = lappend(temp, lfirst(lc1));
+			index++;
+		}
+		rb_state_list = temp;
+	}
+	foreach (lc1, rb_state_list)
+	{
+		RecordBatchState *rb_state = lfirst(lc1);
+
+		sample_nrows += rb_state->rb_nitems;
+	}
+	elog(elevel, "arrow_fdw: \"%s\": sampling %d of %d record-batches (%ld of %ld rows)",
+		 RelationGetRelationName(relation),
+		 list_length(rb_state_list), nbatches,
+		 sample_nrows, total_nrows);
+
+	/* fetch samples for each record-batch */
+	foreach (lc1, rb_state_list)
+	{
+		RecordBatchState *rb_state = lfirst(lc1);
+		int			nsamples;
+
+		count_nrows += rb_state->rb_nitems;
+		nsamples = (double)nrooms * ((double)count_nrows /
+									 (double)sample_nrows) - nitems;
+		if (nitems + nsamples > nrooms)
+			nsamples = nrooms - nitems;
+		if (nsamples > nsamples_min)
+			nitems += RecordBatchAcquireSampleRows(relation,
+												   rb_state,
+												   rows + nitems,
+												   nsamples);
+		CHECK_FOR_INTERRUPTS();
+	}
+	*p_totalrows = total_nrows;
+	*p_totaldeadrows = 0.0;
+
+	return nitems;
+}
+
+/*
+ * ArrowAnalyzeForeignTable
+ */
+static bool
+ArrowAnalyzeForeignTable(Relation frel,
+						 AcquireSampleRowsFunc *p_sample_rows_func,
+						 BlockNumber *p_totalpages)
+{
+	ForeignTable   *ft = GetForeignTable(RelationGetRelid(frel));
+	List		   *filesList = arrowFdwExtractFilesList(ft->options, NULL);
+	ListCell	   *lc;
+	size_t			totalpages = 0;
+
+	foreach (lc, filesList)
+	{
+		const char	   *fname = strVal(lfirst(lc));
+		struct stat		stat_buf;
+
+		if (arrowRemoteIsURL(fname))
+		{
+			if (!arrowRemoteStat(fname, &stat_buf, true))
+			{
+				elog(NOTICE, "remote file '%s' is missing on behalf of '%s', skipped",
+					 fname, get_rel_name(ft->relid));
+				continue;
+			}
+		}
+		else if (stat(fname, &stat_buf) != 0)
+		{
+			elog(NOTICE, "failed on stat('%s') on behalf of '%s', skipped",
+				 fname, get_rel_name(ft->relid));
+			continue;
+		}
+		totalpages += (stat_buf.st_size + BLCKSZ - 1) / BLCKSZ;
+	}
+	if (totalpages > MaxBlockNumber)
+		totalpages = MaxBlockNumber;
+
+	*p_sample_rows_func = ArrowAcquireSampleRows;
+	*p_totalpages = totalpages;
+
+	return true;
+}
+
+/* ----------------------------------------------------------------
+ *
+ * Writable Arrow_Fdw (INSERT / COPY FROM)
+ *
+ * New rows are buffered on the SQLtable, then written out as record-batches
+ * when the buffer usage exceeds arrow_fdw.record_batch_size, and the footer
+ * is rewritten at the end of the statement, like 'pg2arrow --append'.
+ * The original footer is saved on the redo-log, to restore the file image
+ * when the (sub-)transaction is aborted.
+ * Since the footer is overwritten in-place, writer holds ExclusiveLock on
+ * the file (see SetArrowFileLockTag) until end of the transaction, to
+ * prevent concurrent readers from fetching the half-written footer or
+ * uncommitted rows, even if they come from other foreign tables.
+ * The custom-metadata of the existing file is carried over to the new
+ * footer; min/max statistics get 'null' for the appended record-batches.
+ * ----------------------------------------------------------------
+ */
+typedef struct
+{
+	dlist_node	chain;
+	SubTransactionId subid;		/* sub-transaction that wrote the file */
+	char	   *pathname;
+	bool		is_created;		/* true, if file is created by this xact */
+	off_t		footer_offset;
+	size_t		footer_length;
+	char		footer_backup[FLEXIBLE_ARRAY_MEMBER];
+} arrowWriteRedoLog;
+
+typedef struct
+{
+	MemoryContext memcxt;
+	int			fdesc;
+	bool		is_created;		/* true, if file is created by this xact */
+	SQLtable	sql_table;		/* must be the last */
+} arrowWriteState;
+
+static dlist_head	arrow_write_redo_list = DLIST_STATIC_INIT(arrow_write_redo_list);
+
+/*
+ * arrowFdwWritableFile - returns the backend file if 'writable'
+ */
+static const char *
+arrowFdwWritableFile(List *options_list)
+{
+	const char *file_path = NULL;
+	bool		writable = false;
+	ListCell   *lc;
+
+	foreach (lc, options_list)
+	{
+		DefElem	   *defel = lfirst(lc);
+
+		if (strcmp(defel->defname, "file") == 0)
+			file_path = strVal(defel->arg);
+		else if (strcmp(defel->defname, "writable") == 0)
+			writable = defGetBoolean(defel);
+	}
+	return (writable ? file_path : NULL);
+}
+
+/*
+ * invalidateArrowMetadataCache
+ */
+static void
+invalidateArrowMetadataCache(struct stat *stat_buf)
+{
+	uint32_t	hindex = arrowMetadataHashIndex(stat_buf);
+	dlist_mutable_iter iter;
+
+	LWLockAcquire(&arrow_metadata_cache->mutex, LW_EXCLUSIVE);
+	dlist_foreach_modify(iter, &arrow_metadata_cache->hash_slots[hindex])
+	{
+		arrowMetadataCache *mcache
+			= dlist_container(arrowMetadataCache, chain, iter.cur);
+
+		if (stat_buf->st_dev == mcache->stat_buf.st_dev &&
+			stat_buf->st_ino == mcache->stat_buf.st_ino)
+		{
+			SpinLockAcquire(&arrow_metadata_cache->lru_lock);
+			dlist_delete(&mcache->lru_chain);
+			memset(&mcache->lru_chain, 0, sizeof(dlist_node));
+			SpinLockRelease(&arrow_metadata_cache->lru_lock);
+			dlist_delete(&mcache->chain);
+			memset(&mcache->chain, 0, sizeof(dlist_node));
+
+			__releaseMetadataCache(mcache);
+		}
+	}
+	LWLockRelease(&arrow_metadata_cache->mutex);
+}
+
+/*
+ * createArrowWriteRedoLog
+ *
+ * It saves the footer image of the file, then returns the file position
+ * where the new record-batches shall be written.
+ */
+static off_t
+createArrowWriteRedoLog(const char *pathname, int fdesc, bool is_created)
+{
+	arrowWriteRedoLog *redo;
+	struct stat	stat_buf;
+	off_t		footer_offset = 0;
+	size_t		footer_length = 0;
+	size_t		main_sz;
+
+	if (fstat(fdesc, &stat_buf) != 0)
+		elog(ERROR, "failed on fstat('%s'): %m", pathname);
+	if (stat_buf.st_size > 0)
+	{
+		char		temp[sizeof(int32) + 6];	/* = strlen("ARROW1") */
+		ssize_t		nbytes = sizeof(temp);
+
+		if (stat_buf.st_size < 8 + nbytes ||
+			__preadFile(fdesc, temp, nbytes,
+						stat_buf.st_size - nbytes) != nbytes ||
+			memcmp(temp + sizeof(int32), "ARROW1", 6) != 0)
+			elog(ERROR, "arrow_fdw: file '%s' is not Apache Arrow format",
+				 pathname);
+		footer_offset = stat_buf.st_size - nbytes - *((int32 *)temp);
+		if (footer_offset < 8 || footer_offset >= stat_buf.st_size)
+			elog(ERROR, "arrow_fdw: file '%s' has corrupted footer", pathname);
+		footer_length = stat_buf.st_size - footer_offset;
+	}
+	main_sz = MAXALIGN(offsetof(arrowWriteRedoLog,
+								footer_backup[footer_length]));
+	redo = MemoryContextAllocZero(TopMemoryContext,
+								  main_sz + strlen(pathname) + 1);
+	redo->subid = GetCurrentSubTransactionId();
+	redo->pathname = (char *)redo + main_sz;
+	strcpy(redo->pathname, pathname);
+	redo->is_created = is_created;
+	redo->footer_offset = footer_offset;
+	redo->footer_length = footer_length;
+	if (footer_length > 0 &&
+		__preadFile(fdesc, redo->footer_backup,
+					footer_length, footer_offset) != footer_length)
+	{
+		pfree(redo);
+		elog(ERROR, "failed on pread('%s'): %m", pathname);
+	}
+	dlist_push_head(&arrow_write_redo_list, &redo->chain);
+
+	elog(DEBUG2, "arrow_fdw: redo-log on '%s' (offset=%lu, length=%zu)",
+		 redo->pathname, redo->footer_offset, redo->footer_length);
+
+	return footer_offset;
+}
+
+/*
+ * applyArrowWriteRedoLog
+ */
+static void
+applyArrowWriteRedoLog(arrowWriteRedoLog *redo)
+{
+	struct stat	stat_buf;
+	int			fdesc;
+
+	if (redo->is_created)
+	{
+		if (unlink(redo->pathname) != 0 && errno != ENOENT)
+			ereport(WARNING,
+					(errcode_for_file_access(),
+					 errmsg("could not remove file \"%s\": %m", redo->pathname)));
+		return;
+	}
+	fdesc = open(redo->pathname, O_RDWR | PG_BINARY);
+	if (fdesc < 0)
+	{
+		ereport(WARNING,
+				(errcode_for_file_access(),
+				 errmsg("could not open file \"%s\": %m", redo->pathname),
+				 errdetail("could not apply REDO image, therefore, arrow file might be corrupted")));
+		return;
+	}
+	if (fstat(fdesc, &stat_buf) == 0)
+		invalidateArrowMetadataCache(&stat_buf);
+	if (redo->footer_length > 0 &&
+		pwrite(fdesc, redo->footer_backup,
+			   redo->footer_length,
+			   redo->footer_offset) != redo->footer_length)
+		ereport(WARNING,
+				(errcode_for_file_access(),
+				 errmsg("could not write file \"%s\": %m", redo->pathname),
+				 errdetail("could not apply REDO image, therefore, arrow file might be corrupted")));
+	else if (ftruncate(fdesc, redo->footer_offset +
+					   redo->footer_length) != 0)
+		ereport(WARNING,
+				(errcode_for_file_access(),
+				 errmsg("could not truncate file \"%s\": %m", redo->pathname),
+				 errdetail("could not apply REDO image, therefore, arrow file might be corrupted")));
+	else if (pg_fsync(fdesc) != 0)
+		ereport(WARNING,
+				(errcode_for_file_access(),
+				 errmsg("could not fsync file \"%s\": %m", redo->pathname)));
+	close(fdesc);
+
+	elog(DEBUG2, "arrow_fdw: redo-log applied on '%s' (offset=%lu, length=%zu)",
+		 redo->pathname, redo->footer_offset, redo->footer_length);
+}
+
+/*
+ * arrowFdwXactCallback / arrowFdwSubXactCallback
+ */
+static void
+arrowFdwXactCallback(XactEvent event, void *arg)
+{
+	dlist_mutable_iter iter;
+
+	if (dlist_is_empty(&arrow_write_redo_list))
+		return;
+	if (event == XACT_EVENT_PRE_PREPARE)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("cannot PREPARE a transaction that has written arrow_fdw foreign tables")));
+	if (event != XACT_EVENT_COMMIT &&
+		event != XACT_EVENT_ABORT)
+		return;
+	/* redo-logs are chained from the newer one */
+	dlist_foreach_modify(iter, &arrow_write_redo_list)
+	{
+		arrowWriteRedoLog *redo
+			= dlist_container(arrowWriteRedoLog, chain, iter.cur);
+
+		if (event == XACT_EVENT_ABORT)
+			applyArrowWriteRedoLog(redo);
+		dlist_delete(&redo->chain);
+		pfree(redo);
+	}
+}
+
+static void
+arrowFdwSubXactCallback(SubXactEvent event,
+						SubTransactionId mySubid,
+						SubTransactionId parentSubid, void *arg)
+{
+	dlist_mutable_iter iter;
+
+	if (event != SUBXACT_EVENT_COMMIT_SUB &&
+		event != SUBXACT_EVENT_ABORT_SUB)
+		return;
+	dlist_foreach_modify(iter, &arrow_write_redo_list)
+	{
+		arrowWriteRedoLog *redo
+			= dlist_container(arrowWriteRedoLog, chain, iter.cur);
+
+		if (redo->subid != mySubid)
+			continue;
+		if (event == SUBXACT_EVENT_COMMIT_SUB)
+			redo->subid = parentSubid;
+		else
+		{
+			applyArrowWriteRedoLog(redo);
+			dlist_delete(&redo->chain);
+			pfree(redo);
+		}
+	}
+}
+
+/*
+ * setupArrowSQLbufferSchema
+ */
+static void
+__copyArrowCustomMetadata(ArrowKeyValue **p_custom_metadata,
+						  int *p_num_custom_metadata,
+						  const ArrowKeyValue *custom_metadata,
+						  int num_custom_metadata)
+{
+	ArrowKeyValue *dst = *p_custom_metadata;
+	int			nitems = *p_num_custom_metadata;
+
+	for (int i=0; i < num_custom_metadata; i++)
+	{
+		const ArrowKeyValue *kv = &custom_metadata[i];
+		bool		found = false;
+
+		if (!kv->key)
+			continue;
+		/* keys set up by assignArrowTypePgSQL() take precedence */
+		for (int k=0; k < nitems && !found; k++)
+			found = (strcmp(dst[k].key, kv->key) == 0);
+		if (found)
+			continue;
+		if (!dst)
+			dst = palloc(sizeof(ArrowKeyValue));
+		else
+			dst = repalloc(dst, sizeof(ArrowKeyValue) * (nitems + 1));
+		memcpy(&dst[nitems++], kv, sizeof(ArrowKeyValue));
+	}
+	*p_custom_metadata = dst;
+	*p_num_custom_metadata = nitems;
+}
+
+static void
+__setupArrowSQLbufferField(SQLtable *table,
+						   SQLfield *column,
+						   const char *attname,
+						   Oid atttypid,
+						   int32 atttypmod,
+						   ArrowField *afield)
+{
+	HeapTuple		tup;
+	Form_pg_type	__type;
+	const char	   *typname;
+	const char	   *typnamespace;
+	const char	   *extname;
+	Oid				typelem;
+
+	/* walk down to the base type, if domain */
+	for (;;)
+	{
+		tup = SearchSysCache1(TYPEOID, ObjectIdGetDatum(atttypid));
+		if (!HeapTupleIsValid(tup))
+			elog(ERROR, "cache lookup failed for type %u", atttypid);
+		__type = (Form_pg_type) GETSTRUCT(tup);
+		if (__type->typtype != TYPTYPE_DOMAIN)
+			break;
+		atttypid = __type->typbasetype;
+		atttypmod = __type->typtypmod;
+		ReleaseSysCache(tup);
+	}
+	if (__type->typtype == TYPTYPE_ENUM)
+		elog(ERROR, "arrow_fdw: enum type '%s' is not supported on writable foreign tables",
+			 format_type_be(atttypid));
+	if (afield && afield->dictionary)
+		elog(ERROR, "arrow_fdw: dictionary encoded field '%s' is not supported on writable foreign tables",
+			 afield->name);
+	typname = NameStr(__type->typname);
+	typnamespace = get_namespace_name(__type->typnamespace);
+	extname = get_type_extension_name(atttypid);
+	/* only varlena array has element type */
+	typelem = (__type->typlen == -1 ? __type->typelem : InvalidOid);
+
+	table->numFieldNodes++;
+	table->numBuffers +=
+		assignArrowTypePgSQL(column,
+							 attname,
+							 atttypid,
+							 atttypmod,
+							 typname,
+							 typnamespace,
+							 __type->typlen,
+							 __type->typbyval,
+							 __type->typtype,
+							 __type->typalign,
+							 __type->typrelid,
+							 typelem,
+							 pg_get_timezone_name(session_timezone),
+							 extname,
+							 typnamespace,
+							 afield);
+	if (afield)
+		__copyArrowCustomMetadata(&column->customMetadata,
+								  &column->numCustomMetadata,
+								  afield->custom_metadata,
+								  afield->_num_custom_metadata);
+	if (OidIsValid(typelem))
+	{
+		/* array type */
+		char		elem_name[NAMEDATALEN+10];
+		ArrowField *__afield = NULL;
+
+		snprintf(elem_name, sizeof(elem_name), "_%s[]", attname);
+		if (afield)
+		{
+			if (afield->_num_children != 1)
+				elog(ERROR, "arrow_fdw: field '%s' is not compatible", afield->name);
+			__afield = &afield->children[0];
+		}
+		column->element = palloc0(sizeof(SQLfield));
+		__setupArrowSQLbufferField(table,
+								   column->element,
+								   elem_name,
+								   typelem,
+								   -1,
+								   __afield);
+	}
+	else if (OidIsValid(__type->typrelid))
+	{
+		/* composite type */
+		TupleDesc	tupdesc = lookup_rowtype_tupdesc(atttypid, atttypmod);
+
+		if (afield && afield->_num_children != tupdesc->natts)
+			elog(ERROR, "arrow_fdw: field '%s' is not compatible", afield->name);
+		column->nfields = tupdesc->natts;
+		column->subfields = palloc0(sizeof(SQLfield) * tupdesc->natts);
+		for (int j=0; j < tupdesc->natts; j++)
+		{
+			Form_pg_attribute sattr = TupleDescAttr(tupdesc, j);
+
+			__setupArrowSQLbufferField(table,
+									   &column->subfields[j],
+									   NameStr(sattr->attname),
+									   sattr->atttypid,
+									   sattr->atttypmod,
+									   afield ? &afield->children[j] : NULL);
+		}
+		ReleaseTupleDesc(tupdesc);
+	}
+	ReleaseSysCache(tup);
+}
 
-			snprintf(label, sizeof(label), "file%d-read", fcount);
-			ExplainPropertyText(label, format_bytesz(read_sz), es);
+static void
+setupArrowSQLbufferSchema(SQLtable *table, TupleDesc tupdesc,
+						  ArrowFileInfo *af_info)
+{
+	if (af_info && af_info->footer.schema._num_fields != tupdesc->natts)
+		elog(ERROR, "arrow_fdw: file '%s' is not compatible to the foreign table",
+			 table->filename);
+	table->nfields = tupdesc->natts;
+	if (af_info)
+		__copyArrowCustomMetadata(&table->customMetadata,
+								  &table->numCustomMetadata,
+								  af_info->footer.schema.custom_metadata,
+								  af_info->footer.schema._num_custom_metadata);
+	for (int j=0; j < tupdesc->natts; j++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, j);
 
-			snprintf(label, sizeof(label), "file%d-size", fcount);
-			ExplainPropertyText(label, format_bytesz(total_sz), es);
-		}
-		fcount++;
+		if (attr->attisdropped)
+			elog(ERROR, "arrow_fdw: writable foreign table must not have dropped columns");
+		__setupArrowSQLbufferField(table,
+								   &table->columns[j],
+								   NameStr(attr->attname),
+								   attr->atttypid,
+								   attr->atttypmod,
+								   af_info ? &af_info->footer.schema.fields[j] : NULL);
 	}
+	table->segment_sz = (size_t)arrow_record_batch_size_kb << 10;
+}
 
-	/* read-size per column (only verbose mode) */
-	if (es->verbose && arrow_state->rb_nitems > 0 &&
-		!bms_is_member(-FirstLowInvalidHeapAttributeNumber,
-					   arrow_state->referenced))
+static void
+setupArrowSQLbufferBatches(SQLtable *table, ArrowFileInfo *af_info)
+{
+	int		nitems;
+
+	/* restore DictionaryBatches already in the file */
+	nitems = af_info->footer._num_dictionaries;
+	if (nitems > 0)
 	{
-		resetStringInfo(&buf);
-		for (k = bms_next_member(arrow_state->referenced, -1);
-			 k >= 0;
-			 k = bms_next_member(arrow_state->referenced, k))
-		{
-			Form_pg_attribute attr;
+		table->numDictionaries = nitems;
+		table->dictionaries = palloc(sizeof(ArrowBlock) * nitems);
+		memcpy(table->dictionaries,
+			   af_info->footer.dictionaries,
+			   sizeof(ArrowBlock) * nitems);
+	}
+	/* restore RecordBatches already in the file */
+	nitems = af_info->footer._num_recordBatches;
+	if (nitems > 0)
+	{
+		table->numRecordBatches = nitems;
+		table->recordBatches = palloc(sizeof(ArrowBlock) * nitems);
+		memcpy(table->recordBatches,
+			   af_info->footer.recordBatches,
+			   sizeof(ArrowBlock) * nitems);
+	}
+}
 
-			j = k + FirstLowInvalidHeapAttributeNumber - 1;
-			if (j < 0 || j >= tupdesc->natts)
-				continue;
-			attr = TupleDescAttr(tupdesc, j);
-			snprintf(label, sizeof(label), "  %s", NameStr(attr->attname));
-			ExplainPropertyText(label, format_bytesz(chunk_sz[j]), es);
+/*
+ * fixupArrowSQLbufferStats
+ *
+ * min/max statistics carried over from the existing file have no entries
+ * for the appended record-batches, so they are filled by 'null' (unknown).
+ * Readers ignore the statistics that do not cover all the record-batches.
+ */
+static void
+fixupArrowSQLbufferStats(SQLfield *column, int numRecordBatches)
+{
+	for (int k=0; k < column->numCustomMetadata; k++)
+	{
+		ArrowKeyValue *kv = &column->customMetadata[k];
+		StringInfoData buf;
+		int			count = 1;
+
+		if (!kv->value ||
+			(strcmp(kv->key, "min_values") != 0 &&
+			 strcmp(kv->key, "max_values") != 0))
+			continue;
+		for (const char *pos = kv->value; *pos != '\0'; pos++)
+		{
+			if (*pos == ',')
+				count++;
 		}
+		if (count >= numRecordBatches)
+			continue;
+		initStringInfo(&buf);
+		appendStringInfoString(&buf, kv->value);
+		while (count++ < numRecordBatches)
+			appendStringInfoString(&buf, ",null");
+		kv->value = buf.data;
+		kv->_value_len = buf.len;
 	}
-	pfree(buf.data);
+	if (column->element)
+		fixupArrowSQLbufferStats(column->element, numRecordBatches);
+	for (int j=0; j < column->nfields; j++)
+		fixupArrowSQLbufferStats(&column->subfields[j], numRecordBatches);
 }
 
+/*
+ * writeOutArrowRecordBatch
+ */
 static void
-ArrowExplainForeignScan(ForeignScanState *node, ExplainState *es)
+writeOutArrowRecordBatch(arrowWriteState *aw_state, bool with_footer)
 {
-	Relation		frel = node->ss.ss_currentRelation;
-	List		   *dcontext;
+	SQLtable   *table = &aw_state->sql_table;
+	MemoryContext oldcxt = MemoryContextSwitchTo(aw_state->memcxt);
 
-	dcontext = set_deparse_context_plan(es->deparse_cxt,
-										node->ss.ps.plan,
-										NULL);
-	pgstromArrowFdwExplain(node->fdw_state, frel, es, dcontext);
+	/* write out the header and schema, if new file */
+	if (table->f_pos == 0)
+	{
+		arrowFileWrite(table, "ARROW1\0\0", 8);
+		writeArrowSchema(table);
+	}
+	if (table->nitems > 0)
+	{
+		writeArrowRecordBatch(table, NULL);
+		sql_table_clear(table);
+	}
+	if (with_footer)
+	{
+		for (int j=0; j < table->nfields; j++)
+			fixupArrowSQLbufferStats(&table->columns[j],
+									 table->numRecordBatches);
+		writeArrowFooter(table);
+	}
+	MemoryContextSwitchTo(oldcxt);
 }
 
 /*
- * ArrowAnalyzeForeignTable
+ * ArrowIsForeignRelUpdatable
  */
 static int
-RecordBatchAcquireSampleRows(Relation relation,
-							 RecordBatchState *rb_state,
-							 HeapTuple *rows,
-							 int nsamples)
+ArrowIsForeignRelUpdatable(Relation frel)
 {
-	TupleDesc		tupdesc = RelationGetDescr(relation);
-	kern_data_store *kds;
-	Bitmapset	   *referenced = NULL;
-	StringInfoData	buffer;
-	Datum		   *values;
-	bool		   *isnull;
-	int				count;
-	uint32_t		index;
+	ForeignTable   *ft = GetForeignTable(RelationGetRelid(frel));
 
-	/* ANALYZE needs to fetch all the attributes */
-	referenced = bms_make_singleton(-FirstLowInvalidHeapAttributeNumber);
-	initStringInfo(&buffer);
-	kds = arrowFdwFillupRecordBatch(relation,
-									referenced,
-									rb_state,
-									&buffer);
-	values = alloca(sizeof(Datum) * tupdesc->natts);
-	isnull = alloca(sizeof(bool)  * tupdesc->natts);
-	for (count = 0; count < nsamples; count++)
-	{
-		/* fetch a row randomly */
-		index = (double)kds->nitems * drand48();
-		Assert(index < kds->nitems);
+	if (arrowFdwWritableFile(ft->options))
+		return (1 << CMD_INSERT);
+	return 0;
+}
 
-		for (int j=0; j < kds->ncols; j++)
-		{
-			kern_colmeta   *cmeta = &kds->colmeta[j];
+/*
+ * ArrowBeginForeignInsert / ArrowBeginForeignModify
+ */
+static void
+__arrowBeginForeignInsert(ResultRelInfo *rrinfo)
+{
+	Relation		frel = rrinfo->ri_RelationDesc;
+	TupleDesc		tupdesc = RelationGetDescr(frel);
+	ForeignTable   *ft = GetForeignTable(RelationGetRelid(frel));
+	const char	   *fname = arrowFdwWritableFile(ft->options);
+	arrowWriteState *aw_state;
+	SQLtable	   *table;
+	ArrowFileInfo	af_info;
+	struct stat		stat_buf;
+	struct stat		curr_buf;
+	LOCKTAG			locktag;
+	bool			is_created;
+	int				fdesc;
 
-			pg_datum_arrow_ref(kds,
-							   cmeta,
-							   index,
-							   values + j,
-							   isnull + j);
+	if (!fname)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("arrow_fdw: foreign table \"%s\" is not writable",
+						RelationGetRelationName(frel)),
+				 errhint("'writable' option with a single 'file' is required")));
+	for (;;)
+	{
+		is_created = false;
+		fdesc = OpenTransientFile(fname, O_RDWR | PG_BINARY);
+		if (fdesc < 0 && errno == ENOENT)
+		{
+			fdesc = OpenTransientFile(fname, O_RDWR | O_CREAT | O_EXCL | PG_BINARY);
+			if (fdesc < 0 && errno == EEXIST)
+				continue;	/* created concurrently */
+			is_created = true;
 		}
-		rows[count] = heap_form_tuple(tupdesc, values, isnull);
+		if (fdesc < 0)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not open file \"%s\": %m", fname)));
+		if (fstat(fdesc, &stat_buf) != 0)
+			elog(ERROR, "failed on fstat('%s'): %m", fname);
+		/* only one writer, and no readers, until end of the transaction */
+		SetArrowFileLockTag(&locktag, &stat_buf);
+		(void) LockAcquire(&locktag, ExclusiveLock, false, false);
+		/* the file may be removed by the aborted writer during the wait */
+		if (stat(fname, &curr_buf) == 0 &&
+			curr_buf.st_dev == stat_buf.st_dev &&
+			curr_buf.st_ino == stat_buf.st_ino)
+			break;
+		LockRelease(&locktag, ExclusiveLock, false);
+		CloseTransientFile(fdesc);
 	}
-	pfree(buffer.data);
+	if (!is_created && isParquetFileDesc(fdesc))
+		elog(ERROR, "arrow_fdw: Parquet file '%s' is not writable", fname);
+
+	aw_state = palloc0(offsetof(arrowWriteState,
+								sql_table.columns[tupdesc->natts]));
+	aw_state->memcxt = CurrentMemoryContext;
+	aw_state->fdesc = fdesc;
+	aw_state->is_created = is_created;
+	table = &aw_state->sql_table;
+	table->filename = pstrdup(fname);
+	table->fdesc = fdesc;
+	table->f_pos = createArrowWriteRedoLog(fname, fdesc, is_created);
+	if (table->f_pos > 0)
+	{
+		if (fstat(fdesc, &stat_buf) != 0)
+			elog(ERROR, "failed on fstat('%s'): %m", fname);
+		invalidateArrowMetadataCache(&stat_buf);
+		readArrowFileDesc(fdesc, &af_info);
+		setupArrowSQLbufferBatches(table, &af_info);
+		setupArrowSQLbufferSchema(table, tupdesc, &af_info);
+	}
+	else
+	{
+		setupArrowSQLbufferSchema(table, tupdesc, NULL);
+	}
+	rrinfo->ri_FdwState = aw_state;
+}
 
-	return count;
+static void
+ArrowBeginForeignModify(ModifyTableState *mtstate,
+						ResultRelInfo *rrinfo,
+						List *fdw_private,
+						int subplan_index,
+						int eflags)
+{
+	if ((eflags & EXEC_FLAG_EXPLAIN_ONLY) == 0)
+		__arrowBeginForeignInsert(rrinfo);
 }
 
-static int
-ArrowAcquireSampleRows(Relation relation,
-					   int elevel,
-					   HeapTuple *rows,
-					   int nrooms,
-					   double *p_totalrows,
-					   double *p_totaldeadrows)
+static void
+ArrowBeginForeignInsert(ModifyTableState *mtstate,
+						ResultRelInfo *rrinfo)
 {
-	ForeignTable   *ft = GetForeignTable(RelationGetRelid(relation));
-	List		   *filesList = arrowFdwExtractFilesList(ft->options, NULL);
-	List		   *rb_state_list = NIL;
-	ListCell	   *lc1, *lc2;
-	int64			total_nrows = 0;
-	int64			count_nrows = 0;
-	int				nsamples_min = nrooms / 100;
-	int				nitems = 0;
+	__arrowBeginForeignInsert(rrinfo);
+}
 
-	foreach (lc1, filesList)
+/*
+ * ArrowExecForeignInsert / ArrowExecForeignBatchInsert
+ */
+static void
+__arrowExecForeignInsert(arrowWriteState *aw_state,
+						 TupleDesc tupdesc,
+						 TupleTableSlot *slot)
+{
+	SQLtable	   *table = &aw_state->sql_table;
+	MemoryContext	oldcxt;
+	size_t			usage = 0;
+
+	slot_getallattrs(slot);
+	oldcxt = MemoryContextSwitchTo(aw_state->memcxt);
+	for (int j=0; j < tupdesc->natts; j++)
 	{
-		ArrowFileState *af_state;
-		char	   *fname = strVal(lfirst(lc1));
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, j);
+		SQLfield   *column = &table->columns[j];
+		Datum		datum = slot->tts_values[j];
 
-		af_state = BuildArrowFileState(relation, fname, NULL);
-		if (!af_state)
-			continue;
-		foreach (lc2, af_state->rb_list)
+		if (slot->tts_isnull[j])
+			usage += sql_field_put_value(column, NULL, 0);
+		else if (attr->attbyval)
 		{
-			RecordBatchState *rb_state = lfirst(lc2);
+			Assert(column->sql_type.pgsql.typbyval);
+			usage += sql_field_put_value(column, (char *)&datum, attr->attlen);
+		}
+		else if (attr->attlen == -1)
+		{
+			struct varlena *vl = pg_detoast_datum((struct varlena *)DatumGetPointer(datum));
 
-			if (rb_state->rb_nitems == 0)
-				continue;	/* not reasonable to sample, skipped */
-			total_nrows += rb_state->rb_nitems;
-			rb_state_list = lappend(rb_state_list, rb_state);
+			Assert(column->sql_type.pgsql.typlen == -1);
+			usage += sql_field_put_value(column, VARDATA(vl), VARSIZE(vl) - VARHDRSZ);
+			if ((Pointer)vl != DatumGetPointer(datum))
+				pfree(vl);
+		}
+		else
+		{
+			Assert(attr->attlen > 0);
+			usage += sql_field_put_value(column, DatumGetPointer(datum), attr->attlen);
 		}
 	}
-	nrooms = Min(nrooms, total_nrows);
+	table->usage = usage;
+	table->nitems++;
+	MemoryContextSwitchTo(oldcxt);
 
-	/* fetch samples for each record-batch */
-	foreach (lc1, rb_state_list)
-	{
-		RecordBatchState *rb_state = lfirst(lc1);
-		int			nsamples;
+	/* write out a record-batch, if buffer usage exceeds the threshold */
+	if (table->usage > table->segment_sz)
+		writeOutArrowRecordBatch(aw_state, false);
+}
 
-		count_nrows += rb_state->rb_nitems;
-		nsamples = (double)nrooms * ((double)count_nrows /
-									 (double)total_nrows) - nitems;
-		if (nitems + nsamples > nrooms)
-			nsamples = nrooms - nitems;
-		if (nsamples > nsamples_min)
-			nitems += RecordBatchAcquireSampleRows(relation,
-												   rb_state,
-												   rows + nitems,
-												   nsamples);
-	}
-	*p_totalrows = total_nrows;
-	*p_totaldeadrows = 0.0;
+static TupleTableSlot *
+ArrowExecForeignInsert(EState *estate,
+					   ResultRelInfo *rrinfo,
+					   TupleTableSlot *slot,
+					   TupleTableSlot *planSlot)
+{
+	__arrowExecForeignInsert(rrinfo->ri_FdwState,
+							 RelationGetDescr(rrinfo->ri_RelationDesc),
+							 slot);
+	return slot;
+}
 
-	return nitems;
+static TupleTableSlot **
+ArrowExecForeignBatchInsert(EState *estate,
+							ResultRelInfo *rrinfo,
+							TupleTableSlot **slots,
+							TupleTableSlot **planSlots,
+							int *numSlots)
+{
+	TupleDesc	tupdesc = RelationGetDescr(rrinfo->ri_RelationDesc);
+
+	for (int i=0; i < *numSlots; i++)
+		__arrowExecForeignInsert(rrinfo->ri_FdwState, tupdesc, slots[i]);
+	return slots;
+}
+
+static int
+ArrowGetForeignModifyBatchSize(ResultRelInfo *rrinfo)
+{
+	/* RETURNING, WITH CHECK OPTION and row triggers need per-row call */
+	if (rrinfo->ri_projectReturning ||
+		rrinfo->ri_WithCheckOptions != NIL ||
+		(rrinfo->ri_TrigDesc &&
+		 (rrinfo->ri_TrigDesc->trig_insert_before_row ||
+		  rrinfo->ri_TrigDesc->trig_insert_after_row)))
+		return 1;
+	return 1000;
 }
 
 /*
- * ArrowAnalyzeForeignTable
+ * ArrowEndForeignInsert / ArrowEndForeignModify
  */
-static bool
-ArrowAnalyzeForeignTable(Relation frel,
-						 AcquireSampleRowsFunc *p_sample_rows_func,
-						 BlockNumber *p_totalpages)
+static void
+__arrowEndForeignInsert(ResultRelInfo *rrinfo)
 {
-	ForeignTable   *ft = GetForeignTable(RelationGetRelid(frel));
-	List		   *filesList = arrowFdwExtractFilesList(ft->options, NULL);
-	ListCell	   *lc;
-	size_t			totalpages = 0;
+	arrowWriteState *aw_state = rrinfo->ri_FdwState;
 
-	foreach (lc, filesList)
+	if (aw_state)
 	{
-		const char	   *fname = strVal(lfirst(lc));
-		struct stat		stat_buf;
-
-		if (stat(fname, &stat_buf) != 0)
+		const char *fname = aw_state->sql_table.filename;
+
+		writeOutArrowRecordBatch(aw_state, true);
+		/* the new rows must be durable prior to the commit */
+		if (pg_fsync(aw_state->fdesc) != 0)
+			ereport(data_sync_elevel(ERROR),
+					(errcode_for_file_access(),
+					 errmsg("could not fsync file \"%s\": %m", fname)));
+		if (CloseTransientFile(aw_state->fdesc) != 0)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not close file \"%s\": %m", fname)));
+		if (aw_state->is_created)
 		{
-			elog(NOTICE, "failed on stat('%s') on behalf of '%s', skipped",
-				 fname, get_rel_name(ft->relid));
-			continue;
+			char   *dname = pstrdup(fname);
+
+			get_parent_directory(dname);
+			fsync_fname(dname[0] != '\0' ? dname : ".", true);
+			pfree(dname);
 		}
-		totalpages += (stat_buf.st_size + BLCKSZ - 1) / BLCKSZ;
+		rrinfo->ri_FdwState = NULL;
 	}
-	if (totalpages > MaxBlockNumber)
-		totalpages = MaxBlockNumber;
+}
 
-	*p_sample_rows_func = ArrowAcquireSampleRows;
-	*p_totalpages = totalpages;
+static void
+ArrowEndForeignModify(EState *estate, ResultRelInfo *rrinfo)
+{
+	__arrowEndForeignInsert(rrinfo);
+}
 
-	return true;
+static void
+ArrowEndForeignInsert(EState *estate, ResultRelInfo *rrinfo)
+{
+	__arrowEndForeignInsert(rrinfo);
 }
 
 /*
@@ -4196,7 +8520,7 @@ ArrowImportForeignSchema(ImportForeignSchemaStmt *stmt, Oid serverOid)
 		ArrowFileInfo af_info;
 		const char *fname = strVal(lfirst(lc));
 
-		readArrowFile(fname, &af_info, false);
+		readArrowFile(fname, &af_info, NULL, false);
 		if (lc == list_head(filesList))
 		{
 			copyArrowNode(&schema.node, &af_info.footer.schema.node);
@@ -4385,7 +8709,7 @@ pgstrom_arrow_fdw_import_file(PG_FUNCTION_ARGS)
 	else
 		namespace_name = text_to_cstring(PG_GETARG_TEXT_PP(2));
 
-	readArrowFile(file_name, &af_info, false);
+	readArrowFile(file_name, &af_info, NULL, false);
 	copyArrowNode(&schema.node, &af_info.footer.schema.node);
 	if (schema._num_fields > SHRT_MAX)
 		Elog("Arrow file '%s' has too much fields: %d",
@@ -4490,7 +8814,7 @@ pgstrom_arrow_fdw_validator(PG_FUNCTION_ARGS)
 			const char *fname = strVal(lfirst(lc));
 			ArrowFileInfo af_info;
 
-			readArrowFile(fname, &af_info, true);
+			readArrowFile(fname, &af_info, NULL, true);
 		}
 	}
 	else if (options != NIL)
@@ -4582,6 +8906,7 @@ pgstrom_arrow_fdw_precheck_schema(PG_FUNCTION_ARGS)
 
 			(void)BuildArrowFileState(frel, fname, NULL);
 		}
+		flushArrowMetadataIndex();
 	}
 	if (frel)
 		relation_close(frel, NoLock);
@@ -4679,6 +9004,15 @@ pgstrom_init_arrow_fdw(void)
 	r->ShutdownForeignScan			= ArrowShutdownForeignScan;
 	/* IMPORT FOREIGN SCHEMA support */
 	r->ImportForeignSchema			= ArrowImportForeignSchema;
+	/* INSERT / COPY FROM support */
+	r->IsForeignRelUpdatable		= ArrowIsForeignRelUpdatable;
+	r->BeginForeignModify			= ArrowBeginForeignModify;
+	r->ExecForeignInsert			= ArrowExecForeignInsert;
+	r->ExecForeignBatchInsert		= ArrowExecForeignBatchInsert;
+	r->GetForeignModifyBatchSize	= ArrowGetForeignModifyBatchSize;
+	r->EndForeignModify				= ArrowEndForeignModify;
+	r->BeginForeignInsert			= ArrowBeginForeignInsert;
+	r->EndForeignInsert				= ArrowEndForeignInsert;
 
 	/*
 	 * Turn on/off arrow_fdw
@@ -4702,6 +9036,30 @@ pgstrom_init_arrow_fdw(void)
 							 PGC_USERSET,
                              GUC_NOT_IN_SAMPLE,
                              NULL, NULL, NULL);
+	DefineCustomBoolVariable("arrow_fdw.late_materialization",
+							 "Enables to load and evaluate the columns of scan qualifiers first",
+							 NULL,
+							 &arrow_fdw_late_materialization,
+							 false,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	DefineCustomBoolVariable("arrow_fdw.mmap_enabled",
+							 "Enables to map record-batches on memory for CPU scan",
+							 NULL,
+							 &arrow_fdw_mmap_enabled,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	DefineCustomBoolVariable("arrow_fdw.stats_synthesis_enabled",
+							 "Enables to compute min/max statistics on scan, if file has none",
+							 NULL,
+							 &arrow_fdw_stats_synthesis_enabled,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
 	/*
 	 * Configurations for arrow_fdw metadata cache
 	 */
@@ -4715,6 +9073,60 @@ pgstrom_init_arrow_fdw(void)
 							PGC_POSTMASTER,
 							GUC_NOT_IN_SAMPLE | GUC_UNIT_KB,
 							NULL, NULL, NULL);
+	/*
+	 * Turn on/off persistent metadata index
+	 */
+	DefineCustomBoolVariable("arrow_fdw.metadata_index_enabled",
+							 "Enables persistent metadata index of arrow files",
+							 NULL,
+							 &arrow_fdw_metadata_index_enabled,
+							 true,
+							 PGC_SUSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/*
+	 * Threshold of the gap to be read and discarded on i/o consolidation
+	 */
+	DefineCustomIntVariable("arrow_fdw.io_coalesce_gap",
+							"max gap between i/o chunks to be consolidated",
+							NULL,
+							&arrow_io_coalesce_gap_kb,
+							64,				/* 64kB */
+							0,
+							16 * 1024,		/* 16MB */
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_KB,
+							NULL, NULL, NULL);
+	/*
+	 * Threshold of the record-batch size on writing
+	 */
+	DefineCustomIntVariable("arrow_fdw.record_batch_size",
+							"maximum size of record batch on writing",
+							NULL,
+							&arrow_record_batch_size_kb,
+							256 * 1024,		/* 256MB */
+							4 * 1024,		/* 4MB */
+							1024 * 1024,	/* 1GB */
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_KB,
+							NULL, NULL, NULL);
+	/*
+	 * Threshold to merge small record-batches into a chunk on scan
+	 */
+	DefineCustomIntVariable("arrow_fdw.coalesce_batch_size",
+							"size to merge small record batches on scan",
+							NULL,
+							&arrow_coalesce_batch_size_kb,
+							4 * 1024,		/* 4MB */
+							0,
+							256 * 1024,		/* 256MB */
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_KB,
+							NULL, NULL, NULL);
+	/* transaction callbacks to restore the written files on abort */
+	RegisterXactCallback(arrowFdwXactCallback, NULL);
+	RegisterSubXactCallback(arrowFdwSubXactCallback, NULL);
+
 	/* shared memory size */
 	shmem_request_next = shmem_request_hook;
 	shmem_request_hook = pgstrom_request_arrow_fdw;
@@ -103,6 +103,7 @@ struct SQLtype__fluent
 {
 	bool		ts_column;		/* source is 'ts' (timestamp) */
 	bool		tag_column;		/* source is 'tag' (string) */
+	bool		ts_stat_auto;	/* min/max stats implicitly enabled on ts */
 };
 
 union SQLtype
@@ -206,6 +207,10 @@ struct SQLtable
 	size_t		nitems;			/* number of items */
 	int			nfields;		/* number of attributes */
 	bool		has_statistics;	/* one or more columns enable min/max statistics */
+	bool		compression;	/* enables BodyCompression of record-batches */
+	int			compression_codec;	/* ArrowCompressionType */
+	int			compression_level;	/* codec specific level, or 0 (default) */
+	SQLbuffer	compressed;		/* working buffer for compressed images */
 	SQLfield columns[FLEXIBLE_ARRAY_MEMBER];
 };
 
@@ -249,8 +254,14 @@ extern int		writeArrowRecordBatchMT(SQLtable *main_table,
 										pthread_mutex_t *main_table_mutex,
 										ArrowBlock *p_arrow_block);
 extern void		writeArrowFooter(SQLtable *table);
+extern void		arrowAsyncWriterStart(SQLtable *table, int queue_depth,
+									  bool direct_io);
+extern void		arrowAsyncWriterStop(SQLtable *table);
 
 extern size_t	setupArrowRecordBatchIOV(SQLtable *table);
+extern bool		parseArrowCompressionOption(const char *option,
+											int *p_compression_codec,
+											int *p_compression_level);
 
 /* arrow_nodes.c */
 extern void		__initArrowNode(ArrowNode *node, ArrowNodeTag tag);
@@ -259,6 +270,7 @@ extern void		__initArrowNode(ArrowNode *node, ArrowNodeTag tag);
 extern char	   *dumpArrowNode(ArrowNode *node);
 extern void		copyArrowNode(ArrowNode *dest, const ArrowNode *src);
 extern void		readArrowFileDesc(int fdesc, ArrowFileInfo *af_info);
+extern void		readArrowFooterImage(ArrowFooter *footer, const char *pos);
 extern bool		arrowFieldTypeIsEqual(ArrowField *a, ArrowField *b);
 extern const char *arrowNodeName(ArrowNode *node);
 
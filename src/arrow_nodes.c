@@ -44,6 +44,8 @@ __dumpArrowNodeSimple(SQLbuffer *buf, ArrowNode *node)
 #define __dumpArrowTypeLargeBinary	__dumpArrowNodeSimple
 #define __dumpArrowTypeLargeUtf8	__dumpArrowNodeSimple
 #define __dumpArrowTypeLargeList	__dumpArrowNodeSimple
+#define __dumpArrowTypeBinaryView	__dumpArrowNodeSimple
+#define __dumpArrowTypeUtf8View		__dumpArrowNodeSimple
 
 static inline const char *
 ArrowPrecisionAsCstring(ArrowPrecision prec)
@@ -590,6 +592,8 @@ __copyArrowNode(ArrowNode *dest, const ArrowNode *src)
 #define __copyArrowTypeLargeBinary	__copyArrowNode
 #define __copyArrowTypeLargeUtf8	__copyArrowNode
 #define __copyArrowTypeLargeList	__copyArrowNode
+#define __copyArrowTypeBinaryView	__copyArrowNode
+#define __copyArrowTypeUtf8View		__copyArrowNode
 
 static void
 __copyArrowTypeInt(ArrowTypeInt *dest, const ArrowTypeInt *src)
@@ -776,6 +780,15 @@ __copyArrowRecordBatch(ArrowRecordBatch *dest, const ArrowRecordBatch *src)
 	COPY_SCALAR(length);
 	COPY_VECTOR(nodes, ArrowFieldNode);
 	COPY_VECTOR(buffers, ArrowBuffer);
+	if (src->_num_variadicBufferCounts > 0)
+	{
+		dest->variadicBufferCounts = palloc(sizeof(int64_t) *
+											src->_num_variadicBufferCounts);
+		memcpy(dest->variadicBufferCounts,
+			   src->variadicBufferCounts,
+			   sizeof(int64_t) * src->_num_variadicBufferCounts);
+	}
+	COPY_SCALAR(_num_variadicBufferCounts);
 }
 
 static void
@@ -961,6 +974,10 @@ arrowNodeName(ArrowNode *node)
 
 		case ArrowNodeTag__LargeList:
 			return "Arrow::LargeList";
+		case ArrowNodeTag__BinaryView:
+			return "Arrow::BinaryView";
+		case ArrowNodeTag__Utf8View:
+			return "Arrow::Utf8View";
 
 		case ArrowNodeTag__KeyValue:
 			return "Arrow::KeyValue";
@@ -1163,6 +1180,8 @@ __initArrowNode(ArrowNode *node, ArrowNodeTag tag)
 		CASE_ARROW_TYPE_NODE(LargeBinary);
 		CASE_ARROW_TYPE_NODE(LargeUtf8);
 		CASE_ARROW_TYPE_NODE(LargeList);
+		CASE_ARROW_TYPE_NODE(BinaryView);
+		CASE_ARROW_TYPE_NODE(Utf8View);
 
 		CASE_ARROW_NODE(KeyValue);
 		CASE_ARROW_NODE(DictionaryEncoding);
@@ -1601,6 +1620,12 @@ readArrowType(ArrowType *type, int type_tag, const char *type_pos)
 		case ArrowType__LargeList:
 			INIT_ARROW_TYPE_NODE(type, LargeList);
 			break;
+		case ArrowType__BinaryView:
+			INIT_ARROW_TYPE_NODE(type, BinaryView);
+			break;
+		case ArrowType__Utf8View:
+			INIT_ARROW_TYPE_NODE(type, Utf8View);
+			break;
 		default:
 			printf("no suitable ArrowType__* tag for the code = %d", type_tag);
 			break;
@@ -1825,6 +1850,15 @@ readArrowRecordBatch(ArrowRecordBatch *rbatch, const char *pos)
 		rbatch->compression = palloc0(sizeof(ArrowBodyCompression));
 		readArrowBodyCompression(rbatch->compression, next);
 	}
+
+	/* variadicBufferCounts: [long] */
+	next = (const char *)fetchVector(&t, 4, &nitems);
+	if (nitems > 0)
+	{
+		rbatch->variadicBufferCounts = palloc(sizeof(int64_t) * nitems);
+		memcpy(rbatch->variadicBufferCounts, next, sizeof(int64_t) * nitems);
+	}
+	rbatch->_num_variadicBufferCounts = nitems;
 }
 
 static void
@@ -2068,3 +2102,17 @@ readArrowFileDesc(int fdesc, ArrowFileInfo *af_info)
 	}
 	PG_END_TRY();
 }
+
+/*
+ * readArrowFooterImage - read only the Footer chunk on the buffer
+ *
+ * @pos points the head of the Footer chunk; just in front of its length and
+ * the tail signature.
+ */
+void
+readArrowFooterImage(ArrowFooter *footer, const char *pos)
+{
+	int32_t		offset = *((int32_t *)pos);
+
+	readArrowFooter(footer, pos + offset);
+}
@@ -0,0 +1,514 @@
+/*
+ * arrow_remote.c
+ *
+ * Routines to read Apache Arrow / Parquet files on the remote object storage
+ * (S3 compatible storage, or HTTP(S) servers that support ranged GET) for
+ * Arrow_Fdw, without the local copy.
+ * ----
+ * Copyright 2011-2023 (C) KaiGai Kohei <kaigai@kaigai.gr.jp>
+ * Copyright 2014-2023 (C) PG-Strom Developers Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the PostgreSQL License.
+ */
+#ifdef WITH_LIBCURL
+#include <curl/curl.h>
+#endif
+#include <sys/mman.h>
+#include "pg_strom.h"
+#include "arrow_defs.h"
+#include "arrow_ipc.h"
+#include "parquet_defs.h"
+
+/* static variables */
+static int		arrow_remote_concurrency;		/* GUC */
+static char	   *arrow_remote_aws_sigv4;			/* GUC */
+
+/*
+ * Remote object has no device/inode number, so the metadata cache is keyed
+ * by the pseudo device number and hash of the URL.
+ */
+#define ARROW_REMOTE_ST_DEV			((dev_t)0xfffffffeU)
+/* a ranged GET request shall not exceed this size */
+#define ARROW_REMOTE_REQUEST_SZ		(8UL << 20)
+/* length of the first fetch from the tail, to read footer at once */
+#define ARROW_REMOTE_TAIL_SZ		(64UL << 10)
+
+#define ARROW_FILE_HEAD_SIGNATURE		"ARROW1\0\0"
+#define ARROW_FILE_HEAD_SIGNATURE_SZ	(sizeof(ARROW_FILE_HEAD_SIGNATURE) - 1)
+#define ARROW_FILE_TAIL_SIGNATURE_SZ	6		/* strlen("ARROW1") */
+
+/*
+ * arrowRemoteIsURL
+ */
+bool
+arrowRemoteIsURL(const char *filename)
+{
+	return (strncmp(filename, "http://", 7) == 0 ||
+			strncmp(filename, "https://", 8) == 0);
+}
+
+#ifdef WITH_LIBCURL
+typedef struct
+{
+	CURL	   *curl;
+	const char *url;
+	off_t		f_pos;
+	size_t		len;
+	size_t		pos;		/* received length */
+	char	   *dest;
+	char		range[64];
+} arrowRemoteRequest;
+
+static void
+__arrowRemoteGlobalInit(void)
+{
+	static bool	curl_initialized = false;
+
+	if (!curl_initialized)
+	{
+		CURLcode	rc = curl_global_init(CURL_GLOBAL_DEFAULT);
+
+		if (rc != CURLE_OK)
+			elog(ERROR, "failed on curl_global_init: %s",
+				 curl_easy_strerror(rc));
+		curl_initialized = true;
+	}
+}
+
+/*
+ * __arrowRemoteSetupHandle
+ *
+ * If arrow_fdw.remote_aws_sigv4 is configured, the requests are signed by the
+ * AWS Signature Version 4, using the credentials in the environment variables
+ * of the server process.
+ */
+static struct curl_slist *
+__arrowRemoteSetupHandle(CURL *curl, const char *url,
+						 struct curl_slist *headers)
+{
+	curl_easy_setopt(curl, CURLOPT_URL, url);
+	curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+	curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+	if (arrow_remote_aws_sigv4 && *arrow_remote_aws_sigv4 != '\0')
+	{
+#if LIBCURL_VERSION_NUM >= 0x074b00
+		const char *access_key = getenv("AWS_ACCESS_KEY_ID");
+		const char *secret_key = getenv("AWS_SECRET_ACCESS_KEY");
+		const char *session_token = getenv("AWS_SESSION_TOKEN");
+
+		if (!access_key || !secret_key)
+			elog(ERROR, "arrow_fdw: AWS_ACCESS_KEY_ID and AWS_SECRET_ACCESS_KEY are required for arrow_fdw.remote_aws_sigv4");
+		curl_easy_setopt(curl, CURLOPT_AWS_SIGV4, arrow_remote_aws_sigv4);
+		curl_easy_setopt(curl, CURLOPT_USERNAME, access_key);
+		curl_easy_setopt(curl, CURLOPT_PASSWORD, secret_key);
+		if (session_token && !headers)
+		{
+			char   *temp = psprintf("x-amz-security-token: %s", session_token);
+
+			headers = curl_slist_append(NULL, temp);
+			pfree(temp);
+			if (!headers)
+				elog(ERROR, "out of memory");
+		}
+#else
+		elog(ERROR, "arrow_fdw: libcurl is too old to support arrow_fdw.remote_aws_sigv4");
+#endif
+	}
+	if (headers)
+		curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+	return headers;
+}
+
+static size_t
+__arrowRemoteWriteCallback(char *ptr, size_t size, size_t nmemb, void *userdata)
+{
+	arrowRemoteRequest *req = userdata;
+	size_t		sz = size * nmemb;
+
+	/* server may ignore the Range header; abort the transfer */
+	if (sz > req->len - req->pos)
+		return 0;
+	memcpy(req->dest + req->pos, ptr, sz);
+	req->pos += sz;
+	return sz;
+}
+
+static void
+__arrowRemoteCheckResult(arrowRemoteRequest *req, CURLcode rc)
+{
+	long		status = 0;
+
+	if (rc != CURLE_OK)
+		elog(ERROR, "arrow_fdw: failed on GET '%s' (range=%s): %s",
+			 req->url, req->range, curl_easy_strerror(rc));
+	curl_easy_getinfo(req->curl, CURLINFO_RESPONSE_CODE, &status);
+	if (status != 206 && (status != 200 || req->f_pos != 0))
+		elog(ERROR, "arrow_fdw: GET '%s' (range=%s) returned HTTP status %ld",
+			 req->url, req->range, status);
+	if (req->pos != req->len)
+		elog(ERROR, "arrow_fdw: GET '%s' (range=%s) returned %zu bytes, but %zu bytes expected",
+			 req->url, req->range, req->pos, req->len);
+}
+#endif	/* WITH_LIBCURL */
+
+/*
+ * arrowRemoteStat
+ *
+ * It fills up the stat_buf by the HEAD request. st_size and st_mtime are
+ * from Content-Length and Last-Modified.
+ */
+bool
+arrowRemoteStat(const char *url, struct stat *stat_buf, bool missing_ok)
+{
+#ifdef WITH_LIBCURL
+	CURL	   *curl;
+	struct curl_slist *headers = NULL;
+	CURLcode	rc;
+	long		status = 0;
+	curl_off_t	length = -1;
+	curl_off_t	filetime = -1;
+
+	__arrowRemoteGlobalInit();
+	curl = curl_easy_init();
+	if (!curl)
+		elog(ERROR, "failed on curl_easy_init");
+	PG_TRY();
+	{
+		headers = __arrowRemoteSetupHandle(curl, url, NULL);
+		curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+		curl_easy_setopt(curl, CURLOPT_FILETIME, 1L);
+		rc = curl_easy_perform(curl);
+		if (rc != CURLE_OK)
+			elog(ERROR, "arrow_fdw: failed on HEAD '%s': %s",
+				 url, curl_easy_strerror(rc));
+		curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+		curl_easy_getinfo(curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length);
+		curl_easy_getinfo(curl, CURLINFO_FILETIME_T, &filetime);
+	}
+	PG_FINALLY();
+	{
+		if (headers)
+			curl_slist_free_all(headers);
+		curl_easy_cleanup(curl);
+	}
+	PG_END_TRY();
+
+	if (status == 404 && missing_ok)
+		return false;
+	if (status < 200 || status >= 300)
+		elog(ERROR, "arrow_fdw: HEAD '%s' returned HTTP status %ld",
+			 url, status);
+	if (length < 0)
+		elog(ERROR, "arrow_fdw: HEAD '%s' returned no Content-Length", url);
+	memset(stat_buf, 0, sizeof(struct stat));
+	stat_buf->st_dev = ARROW_REMOTE_ST_DEV;
+	stat_buf->st_ino = hash_bytes_extended((const unsigned char *)url,
+										   strlen(url), 0);
+	stat_buf->st_mode = S_IFREG | 0444;
+	stat_buf->st_nlink = 1;
+	stat_buf->st_size = length;
+	stat_buf->st_blksize = BLCKSZ;
+	stat_buf->st_blocks = (length + 511) / 512;
+	if (filetime >= 0)
+	{
+		stat_buf->st_mtim.tv_sec = filetime;
+		stat_buf->st_ctim.tv_sec = filetime;
+	}
+	return true;
+#else
+	elog(ERROR, "arrow_fdw: remote file '%s' is not supported (PG-Strom was not built with WITH_LIBCURL=1)", url);
+#endif
+}
+
+/*
+ * arrowRemoteReadRanges
+ *
+ * It fetches the supplied ranges of the remote file. Large ranges are split
+ * into ARROW_REMOTE_REQUEST_SZ, then arrow_fdw.remote_concurrency requests
+ * at most run concurrently.
+ */
+void
+arrowRemoteReadRanges(const char *url, arrowRemoteRange *ranges, int nranges)
+{
+#ifdef WITH_LIBCURL
+	arrowRemoteRequest *requests;
+	struct curl_slist *headers = NULL;
+	CURLM	   *multi;
+	int			nrequests = 0;
+	int			nrooms = 0;
+	int			next = 0;
+	int			nactives = 0;
+
+	for (int i=0; i < nranges; i++)
+		nrooms += (ranges[i].len + ARROW_REMOTE_REQUEST_SZ - 1) / ARROW_REMOTE_REQUEST_SZ;
+	if (nrooms == 0)
+		return;
+	requests = palloc0(sizeof(arrowRemoteRequest) * nrooms);
+	for (int i=0; i < nranges; i++)
+	{
+		for (size_t pos=0; pos < ranges[i].len; pos += ARROW_REMOTE_REQUEST_SZ)
+		{
+			arrowRemoteRequest *req = &requests[nrequests++];
+
+			req->url   = url;
+			req->f_pos = ranges[i].f_pos + pos;
+			req->len   = Min(ranges[i].len - pos, ARROW_REMOTE_REQUEST_SZ);
+			req->dest  = ranges[i].dest + pos;
+			snprintf(req->range, sizeof(req->range), "%lu-%lu",
+					 (unsigned long)req->f_pos,
+					 (unsigned long)(req->f_pos + req->len - 1));
+		}
+	}
+	Assert(nrequests == nrooms);
+
+	__arrowRemoteGlobalInit();
+	multi = curl_multi_init();
+	if (!multi)
+		elog(ERROR, "failed on curl_multi_init");
+	PG_TRY();
+	{
+		while (next < nrequests || nactives > 0)
+		{
+			CURLMcode	mc;
+			CURLMsg	   *msg;
+			int			nrunning;
+			int			nqueued;
+
+			while (next < nrequests && nactives < arrow_remote_concurrency)
+			{
+				arrowRemoteRequest *req = &requests[next++];
+
+				req->curl = curl_easy_init();
+				if (!req->curl)
+					elog(ERROR, "failed on curl_easy_init");
+				headers = __arrowRemoteSetupHandle(req->curl, url, headers);
+				curl_easy_setopt(req->curl, CURLOPT_RANGE, req->range);
+				curl_easy_setopt(req->curl, CURLOPT_WRITEFUNCTION,
+								 __arrowRemoteWriteCallback);
+				curl_easy_setopt(req->curl, CURLOPT_WRITEDATA, req);
+				curl_easy_setopt(req->curl, CURLOPT_PRIVATE, req);
+				mc = curl_multi_add_handle(multi, req->curl);
+				if (mc != CURLM_OK)
+					elog(ERROR, "failed on curl_multi_add_handle: %s",
+						 curl_multi_strerror(mc));
+				nactives++;
+			}
+			CHECK_FOR_INTERRUPTS();
+
+			mc = curl_multi_perform(multi, &nrunning);
+			if (mc != CURLM_OK)
+				elog(ERROR, "failed on curl_multi_perform: %s",
+					 curl_multi_strerror(mc));
+			while ((msg = curl_multi_info_read(multi, &nqueued)) != NULL)
+			{
+				arrowRemoteRequest *req;
+
+				if (msg->msg != CURLMSG_DONE)
+					continue;
+				curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&req);
+				__arrowRemoteCheckResult(req, msg->data.result);
+				curl_multi_remove_handle(multi, req->curl);
+				curl_easy_cleanup(req->curl);
+				req->curl = NULL;
+				nactives--;
+			}
+			if (nrunning > 0)
+			{
+				mc = curl_multi_poll(multi, NULL, 0, 1000, NULL);
+				if (mc != CURLM_OK)
+					elog(ERROR, "failed on curl_multi_poll: %s",
+						 curl_multi_strerror(mc));
+			}
+		}
+	}
+	PG_FINALLY();
+	{
+		for (int i=0; i < nrequests; i++)
+		{
+			arrowRemoteRequest *req = &requests[i];
+
+			if (req->curl)
+			{
+				curl_multi_remove_handle(multi, req->curl);
+				curl_easy_cleanup(req->curl);
+			}
+		}
+		curl_multi_cleanup(multi);
+		if (headers)
+			curl_slist_free_all(headers);
+	}
+	PG_END_TRY();
+	pfree(requests);
+#else
+	elog(ERROR, "arrow_fdw: remote file '%s' is not supported (PG-Strom was not built with WITH_LIBCURL=1)", url);
+#endif
+}
+
+/*
+ * arrowRemoteOpenMetadata
+ *
+ * It returns a sparse anonymous file (memfd) that has the same size as the
+ * remote file, but only the portion needed to read the metadata (signatures,
+ * footer, and the message headers of the record-batches and dictionaries for
+ * Arrow files) is fetched. So, the usual readArrowFileDesc() and
+ * readParquetFileDesc() can parse it as if local file.
+ * The caller shall close the file descriptor.
+ */
+int
+arrowRemoteOpenMetadata(const char *url, struct stat *stat_buf, bool missing_ok)
+{
+	arrowRemoteRange ranges[3];
+	size_t		file_sz;
+	size_t		tail_sz;
+	char	   *image;
+	int			fdesc;
+
+	if (!arrowRemoteStat(url, stat_buf, missing_ok))
+		return -1;
+	file_sz = stat_buf->st_size;
+	if (file_sz < ARROW_FILE_HEAD_SIGNATURE_SZ + ARROW_FILE_TAIL_SIGNATURE_SZ)
+		elog(ERROR, "arrow_fdw: remote file '%s' is too small", url);
+	fdesc = memfd_create("arrow_remote", MFD_CLOEXEC);
+	if (fdesc < 0)
+		elog(ERROR, "failed on memfd_create: %m");
+	if (ftruncate(fdesc, file_sz) != 0)
+	{
+		close(fdesc);
+		elog(ERROR, "failed on ftruncate: %m");
+	}
+	image = mmap(NULL, file_sz, PROT_READ | PROT_WRITE, MAP_SHARED, fdesc, 0);
+	if (image == MAP_FAILED)
+	{
+		close(fdesc);
+		elog(ERROR, "failed on mmap: %m");
+	}
+
+	PG_TRY();
+	{
+		tail_sz = Min(file_sz - ARROW_FILE_HEAD_SIGNATURE_SZ,
+					  ARROW_REMOTE_TAIL_SZ);
+		ranges[0].f_pos = 0;
+		ranges[0].len   = ARROW_FILE_HEAD_SIGNATURE_SZ;
+		ranges[0].dest  = image;
+		ranges[1].f_pos = file_sz - tail_sz;
+		ranges[1].len   = tail_sz;
+		ranges[1].dest  = image + ranges[1].f_pos;
+		arrowRemoteReadRanges(url, ranges, 2);
+
+		if (memcmp(image, PARQUET_SIGNATURE, PARQUET_SIGNATURE_SZ) == 0)
+		{
+			/* FileMetaData of the parquet file */
+			uint32_t	meta_sz;
+			size_t		meta_pos;
+
+			memcpy(&meta_sz, image + file_sz - sizeof(uint32_t)
+				   - PARQUET_SIGNATURE_SZ, sizeof(uint32_t));
+			meta_pos = file_sz - sizeof(uint32_t) - PARQUET_SIGNATURE_SZ - meta_sz;
+			if (meta_sz > file_sz - sizeof(uint32_t) - 2 * PARQUET_SIGNATURE_SZ)
+				elog(ERROR, "parquet: FileMetaData length (%u) is corrupted", meta_sz);
+			if (meta_pos < file_sz - tail_sz)
+			{
+				ranges[0].f_pos = meta_pos;
+				ranges[0].len   = file_sz - tail_sz - meta_pos;
+				ranges[0].dest  = image + meta_pos;
+				arrowRemoteReadRanges(url, ranges, 1);
+			}
+		}
+		else if (memcmp(image, ARROW_FILE_HEAD_SIGNATURE,
+						ARROW_FILE_HEAD_SIGNATURE_SZ) == 0)
+		{
+			/* Footer, then the message headers of the Arrow file */
+			ArrowFooter	footer;
+			arrowRemoteRange *mranges;
+			int32_t		footer_sz;
+			size_t		footer_pos;
+			int			nitems = 0;
+
+			memcpy(&footer_sz, image + file_sz - sizeof(int32_t)
+				   - ARROW_FILE_TAIL_SIGNATURE_SZ, sizeof(int32_t));
+			if (footer_sz <= 0 ||
+				footer_sz > file_sz - sizeof(int32_t)
+				- ARROW_FILE_HEAD_SIGNATURE_SZ - ARROW_FILE_TAIL_SIGNATURE_SZ)
+				elog(ERROR, "arrow_fdw: Footer length (%d) of '%s' is corrupted",
+					 footer_sz, url);
+			footer_pos = (file_sz - sizeof(int32_t)
+						  - ARROW_FILE_TAIL_SIGNATURE_SZ - footer_sz);
+			if (footer_pos < file_sz - tail_sz)
+			{
+				ranges[0].f_pos = footer_pos;
+				ranges[0].len   = file_sz - tail_sz - footer_pos;
+				ranges[0].dest  = image + footer_pos;
+				arrowRemoteReadRanges(url, ranges, 1);
+			}
+			readArrowFooterImage(&footer, image + footer_pos);
+
+			mranges = palloc0(sizeof(arrowRemoteRange) *
+							  (footer._num_dictionaries +
+							   footer._num_recordBatches));
+			for (int i=0; i < footer._num_dictionaries +
+					 footer._num_recordBatches; i++)
+			{
+				ArrowBlock *b = (i < footer._num_dictionaries
+								 ? &footer.dictionaries[i]
+								 : &footer.recordBatches[i - footer._num_dictionaries]);
+
+				if (b->offset < 0 || b->metaDataLength <= 0 ||
+					b->offset + b->metaDataLength > file_sz)
+					elog(ERROR, "arrow_fdw: Footer of '%s' is corrupted", url);
+				if (b->offset >= file_sz - tail_sz)
+					continue;		/* already fetched */
+				mranges[nitems].f_pos = b->offset;
+				mranges[nitems].len   = Min(b->metaDataLength,
+											file_sz - tail_sz - b->offset);
+				mranges[nitems].dest  = image + b->offset;
+				nitems++;
+			}
+			arrowRemoteReadRanges(url, mranges, nitems);
+			pfree(mranges);
+		}
+		/* elsewhere, the caller will raise an error */
+	}
+	PG_CATCH();
+	{
+		munmap(image, file_sz);
+		close(fdesc);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+	munmap(image, file_sz);
+
+	return fdesc;
+}
+
+/*
+ * pgstrom_init_arrow_remote
+ */
+void
+pgstrom_init_arrow_remote(void)
+{
+	/*
+	 * Max number of concurrent ranged GET requests
+	 */
+	DefineCustomIntVariable("arrow_fdw.remote_concurrency",
+							"max number of concurrent requests to read remote files",
+							NULL,
+							&arrow_remote_concurrency,
+							16,
+							1,
+							256,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE,
+							NULL, NULL, NULL);
+	/*
+	 * AWS Signature Version 4 (e.g, "aws:amz:us-east-1:s3")
+	 */
+	DefineCustomStringVariable("arrow_fdw.remote_aws_sigv4",
+							   "provider:region:service for AWS SigV4 signing of the remote requests",
+							   NULL,
+							   &arrow_remote_aws_sigv4,
+							   "",
+							   PGC_SUSET,
+							   GUC_NOT_IN_SAMPLE,
+							   NULL, NULL, NULL);
+}
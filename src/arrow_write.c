@@ -13,7 +13,14 @@
 #include "postgres.h"
 #endif
 #include <limits.h>
+#include <strings.h>
 #include <pthread.h>
+#ifdef WITH_LIBLZ4
+#include <lz4frame.h>
+#endif
+#ifdef WITH_LIBZSTD
+#include <zstd.h>
+#endif
 #include "arrow_ipc.h"
 
 /* alignment macros, if not */
@@ -1691,6 +1698,165 @@ setupArrowBufferIOV(SQLtable *table, SQLfield *column)
 	return consumed;
 }
 
+/*
+ * __compressArrowBuffer
+ *
+ * It writes out a compressed image of the buffer; the first 8 bytes are
+ * uncompressed length (LE), or -1 if the data is not compressed because
+ * compression does not make it smaller.
+ */
+static size_t
+__compressArrowBuffer(SQLtable *table, const char *src, size_t src_sz)
+{
+	SQLbuffer  *buf = &table->compressed;
+	char	   *dst = buf->data + buf->usage;
+	size_t		sz = 0;
+
+	assert(buf->usage == LONGALIGN(buf->usage) &&
+		   buf->usage + sizeof(int64_t) <= buf->length);
+	switch (table->compression_codec)
+	{
+		case ArrowCompressionType__LZ4_FRAME:
+#ifdef WITH_LIBLZ4
+			{
+				LZ4F_preferences_t prefs;
+
+				memset(&prefs, 0, sizeof(LZ4F_preferences_t));
+				prefs.frameInfo.contentSize = src_sz;
+				prefs.compressionLevel = table->compression_level;
+				sz = LZ4F_compressFrame(dst + sizeof(int64_t),
+										buf->length - buf->usage - sizeof(int64_t),
+										src, src_sz, &prefs);
+				if (LZ4F_isError(sz))
+					Elog("failed on LZ4F_compressFrame: %s",
+						 LZ4F_getErrorName(sz));
+			}
+#else
+			Elog("LZ4 compression is not supported in this build");
+#endif
+			break;
+		case ArrowCompressionType__ZSTD:
+#ifdef WITH_LIBZSTD
+			sz = ZSTD_compress(dst + sizeof(int64_t),
+							   buf->length - buf->usage - sizeof(int64_t),
+							   src, src_sz,
+							   table->compression_level > 0
+							   ? table->compression_level
+							   : ZSTD_CLEVEL_DEFAULT);
+			if (ZSTD_isError(sz))
+				Elog("failed on ZSTD_compress: %s",
+					 ZSTD_getErrorName(sz));
+#else
+			Elog("ZSTD compression is not supported in this build");
+#endif
+			break;
+		default:
+			Elog("unknown compression codec (%d)", table->compression_codec);
+	}
+	if (sz < src_sz)
+		*((int64_t *)dst) = (int64_t)src_sz;
+	else
+	{
+		/* compression does not make sense, so save the raw image */
+		*((int64_t *)dst) = -1L;
+		memcpy(dst + sizeof(int64_t), src, src_sz);
+		sz = src_sz;
+	}
+	sz += sizeof(int64_t);
+	memset(dst + sz, 0, LONGALIGN(sz) - sz);
+	buf->usage += LONGALIGN(sz);
+
+	return LONGALIGN(sz);
+}
+
+static size_t
+__compressBoundArrowBuffer(SQLtable *table, size_t src_sz)
+{
+	size_t		sz = src_sz;
+
+	switch (table->compression_codec)
+	{
+#ifdef WITH_LIBLZ4
+		case ArrowCompressionType__LZ4_FRAME:
+			{
+				LZ4F_preferences_t prefs;
+
+				memset(&prefs, 0, sizeof(LZ4F_preferences_t));
+				prefs.frameInfo.contentSize = src_sz;
+				sz = LZ4F_compressFrameBound(src_sz, &prefs);
+			}
+			break;
+#endif
+#ifdef WITH_LIBZSTD
+		case ArrowCompressionType__ZSTD:
+			sz = ZSTD_compressBound(src_sz);
+			break;
+#endif
+		default:
+			break;
+	}
+	/* raw image is saved if compression is not worth */
+	if (sz < src_sz)
+		sz = src_sz;
+	return LONGALIGN(sizeof(int64_t) + sz);
+}
+
+/*
+ * setupArrowCompressedBufferIOV
+ *
+ * It replaces the body iovec (iov[iov_base...]) by the compressed images,
+ * then updates the buffers[] vector according to the BodyCompression
+ * manner (method = BUFFER). Thus, each of non-empty buffers shall be
+ * compressed individually.
+ */
+static size_t
+setupArrowCompressedBufferIOV(SQLtable *table, int iov_base,
+							  ArrowBuffer *buffers, int nbuffers)
+{
+	SQLbuffer  *buf = &table->compressed;
+	size_t		required = 0;
+	size_t		offset = 0;
+	int			i, k;
+
+	for (k=iov_base; k < table->__iov_cnt; k++)
+	{
+		if (table->__iov[k].iov_len > 0)
+			required += __compressBoundArrowBuffer(table,
+												   table->__iov[k].iov_len);
+	}
+	sql_buffer_clear(buf);
+	sql_buffer_expand(buf, required);
+
+	for (i=0, k=iov_base; i < nbuffers; i++)
+	{
+		ArrowBuffer *bnode = &buffers[i];
+		struct iovec *iov;
+
+		if (bnode->length == 0)
+		{
+			bnode->offset = offset;
+			continue;
+		}
+		/* non-empty buffers are 1:1 mapped to non-empty iovec */
+		while (k < table->__iov_cnt && table->__iov[k].iov_len == 0)
+			k++;
+		assert(k < table->__iov_cnt &&
+			   table->__iov[k].iov_len == bnode->length);
+		iov = &table->__iov[k++];
+		bnode->offset = offset;
+		bnode->length = __compressArrowBuffer(table, iov->iov_base,
+											  iov->iov_len);
+		offset += bnode->length;
+	}
+	assert(buf->usage == offset && buf->usage <= buf->length);
+
+	/* replace the iovec by the compressed images */
+	table->__iov_cnt = iov_base;
+	if (offset > 0)
+		arrowFileAppendIOV(table, buf->data, offset);
+	return offset;
+}
+
 size_t
 setupArrowRecordBatchIOV(SQLtable *table)
 {
@@ -1698,6 +1864,7 @@ setupArrowRecordBatchIOV(SQLtable *table)
 	ArrowRecordBatch *rbatch;
 	ArrowFieldNode *nodes;
 	ArrowBuffer	   *buffers;
+	ArrowBodyCompression compress;
 	int				i, j;
 	size_t			bodyLength = 0;
 	size_t			consumed;
@@ -1723,9 +1890,30 @@ setupArrowRecordBatchIOV(SQLtable *table)
 	}
 	assert(j == table->numBuffers);
 
+	/*
+	 * In case of compressed record-batch, buffers[] shall be adjusted
+	 * according to the compressed images; so body iovec is built first,
+	 * then the metadata message is moved to the head of iovec.
+	 */
+	if (table->compression)
+	{
+		int		iov_base = table->__iov_cnt;
+
+		for (j=0; j < table->nfields; j++)
+			setupArrowBufferIOV(table, &table->columns[j]);
+		bodyLength = setupArrowCompressedBufferIOV(table, iov_base,
+												   buffers,
+												   table->numBuffers);
+		initArrowNode(&compress, BodyCompression);
+		compress.codec = table->compression_codec;
+		compress.method = ArrowBodyCompressionMethod__BUFFER;
+	}
+
 	/* setup Message of Schema */
 	initArrowNode(&message, Message);
-	message.version = ArrowMetadataVersion__V4;
+	message.version = (table->compression
+					   ? ArrowMetadataVersion__V5
+					   : ArrowMetadataVersion__V4);
 	message.bodyLength = bodyLength;
 
 	rbatch = &message.body.recordBatch;
@@ -1735,13 +1923,77 @@ setupArrowRecordBatchIOV(SQLtable *table)
 	rbatch->_num_nodes = table->numFieldNodes;
 	rbatch->buffers = buffers;
 	rbatch->_num_buffers = table->numBuffers;
+	if (table->compression)
+		rbatch->compression = &compress;
 	/* serialization */
-	consumed = setupFlatBufferMessageIOV(table, &message);
-	for (j=0; j < table->nfields; j++)
-		consumed += setupArrowBufferIOV(table, &table->columns[j]);
+	if (!table->compression)
+	{
+		consumed = setupFlatBufferMessageIOV(table, &message);
+		for (j=0; j < table->nfields; j++)
+			consumed += setupArrowBufferIOV(table, &table->columns[j]);
+	}
+	else
+	{
+		int		iov_base = table->__iov_cnt - (bodyLength > 0 ? 1 : 0);
+
+		consumed = setupFlatBufferMessageIOV(table, &message) + bodyLength;
+		/* move the metadata message to the head */
+		if (bodyLength > 0)
+		{
+			struct iovec temp = table->__iov[iov_base];
+
+			table->__iov[iov_base] = table->__iov[iov_base + 1];
+			table->__iov[iov_base + 1] = temp;
+		}
+	}
 	return consumed;
 }
 
+/*
+ * parseArrowCompressionOption - parse 'lz4|zstd[:LEVEL]' option
+ *
+ * It returns false if 'none' is given, or true with codec and level.
+ */
+bool
+parseArrowCompressionOption(const char *option,
+							int *p_compression_codec,
+							int *p_compression_level)
+{
+	const char *pos = strchr(option, ':');
+	size_t		len = (pos ? pos - option : strlen(option));
+	int			level = 0;
+
+	if (len == 4 && strncasecmp(option, "none", 4) == 0 && !pos)
+		return false;
+	else if (len == 3 && strncasecmp(option, "lz4", 3) == 0)
+	{
+#ifndef WITH_LIBLZ4
+		Elog("LZ4 compression is not supported in this build");
+#endif
+		*p_compression_codec = ArrowCompressionType__LZ4_FRAME;
+	}
+	else if (len == 4 && strncasecmp(option, "zstd", 4) == 0)
+	{
+#ifndef WITH_LIBZSTD
+		Elog("ZSTD compression is not supported in this build");
+#endif
+		*p_compression_codec = ArrowCompressionType__ZSTD;
+	}
+	else
+		Elog("unknown compression codec: '%s'", option);
+
+	if (pos)
+	{
+		char   *end;
+
+		level = strtol(pos+1, &end, 10);
+		if (pos[1] == '\0' || *end != '\0' || level < 0 || level > 22)
+			Elog("invalid compression level: '%s'", option);
+	}
+	*p_compression_level = level;
+	return true;
+}
+
 static void
 __saveArrowRecordBatchStats(SQLfield *main_field,
 							SQLfield *data_field, int rb_index)
@@ -1795,6 +2047,227 @@ writeArrowRecordBatch(SQLtable *table, ArrowBlock *p_arrow_block)
 	return rb_index;
 }
 
+/*
+ * Asynchronous record-batch writer
+ *
+ * Once arrowAsyncWriterStart() is called, writeArrowRecordBatchMT() copies
+ * the record batch onto a write request buffer and queues it, instead of
+ * the synchronous pwritev(2). A dedicated writer thread issues the file
+ * i/o, so the conversion threads continue to build the next record batch
+ * without waiting for the disk. The queue depth limits the amount of
+ * memory consumed by the pending requests.
+ * If direct_io, the output file is switched to O_DIRECT, and each record
+ * batch is padded to ARROW_DIRECT_IO_ALIGN.
+ */
+#define ARROW_DIRECT_IO_ALIGN(x)	TYPEALIGN(4096,(x))
+
+typedef struct arrowWriteRequest
+{
+	struct arrowWriteRequest *next;
+	const char *filename;
+	int			fdesc;
+	off_t		f_pos;
+	size_t		length;
+	size_t		bufsz;
+	char	   *buffer;
+} arrowWriteRequest;
+
+static struct {
+	pthread_mutex_t	lock;
+	pthread_cond_t	cond;
+	pthread_t		thread;
+	bool			running;
+	bool			shutdown;
+	bool			direct_io;
+	int				queue_depth;
+	int				num_pending;	/* queued or in-progress requests */
+	arrowWriteRequest *head;		/* queue of the ready requests */
+	arrowWriteRequest *tail;
+	arrowWriteRequest *free_list;
+} arrow_async_writer = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.cond = PTHREAD_COND_INITIALIZER,
+};
+
+static void *
+__arrowAsyncWriterMain(void *__arg)
+{
+	arrowWriteRequest *req;
+
+	pthread_mutex_lock(&arrow_async_writer.lock);
+	for (;;)
+	{
+		size_t		offset = 0;
+		ssize_t		nbytes;
+
+		req = arrow_async_writer.head;
+		if (!req)
+		{
+			if (arrow_async_writer.shutdown)
+				break;
+			pthread_cond_wait(&arrow_async_writer.cond,
+							  &arrow_async_writer.lock);
+			continue;
+		}
+		arrow_async_writer.head = req->next;
+		if (!arrow_async_writer.head)
+			arrow_async_writer.tail = NULL;
+		pthread_mutex_unlock(&arrow_async_writer.lock);
+
+		while (offset < req->length)
+		{
+			nbytes = pwrite(req->fdesc,
+							req->buffer + offset,
+							req->length - offset,
+							req->f_pos + offset);
+			if (nbytes <= 0)
+			{
+				if (errno == EINTR)
+					continue;
+				Elog("failed on pwrite('%s'): %m", req->filename);
+			}
+			offset += nbytes;
+		}
+
+		pthread_mutex_lock(&arrow_async_writer.lock);
+		req->next = arrow_async_writer.free_list;
+		arrow_async_writer.free_list = req;
+		arrow_async_writer.num_pending--;
+		pthread_cond_broadcast(&arrow_async_writer.cond);
+	}
+	pthread_mutex_unlock(&arrow_async_writer.lock);
+
+	return NULL;
+}
+
+static void
+__arrowAsyncWriteIOV(const char *filename,
+					 int fdesc,
+					 off_t f_pos,
+					 size_t length,
+					 SQLtable *table)
+{
+	arrowWriteRequest *req;
+	char	   *pos;
+	int			i;
+
+	/* wait for the free slot of the queue */
+	pthread_mutex_lock(&arrow_async_writer.lock);
+	while (arrow_async_writer.num_pending >= arrow_async_writer.queue_depth)
+		pthread_cond_wait(&arrow_async_writer.cond,
+						  &arrow_async_writer.lock);
+	arrow_async_writer.num_pending++;
+	req = arrow_async_writer.free_list;
+	if (req)
+		arrow_async_writer.free_list = req->next;
+	pthread_mutex_unlock(&arrow_async_writer.lock);
+
+	/* copy the record batch to the request buffer */
+	if (!req)
+		req = palloc0(sizeof(arrowWriteRequest));
+	if (req->bufsz < length)
+	{
+		if (req->buffer)
+			free(req->buffer);
+		req->bufsz = ARROW_DIRECT_IO_ALIGN(length);
+		if ((errno = posix_memalign((void **)&req->buffer, 4096,
+									req->bufsz)) != 0)
+			Elog("failed on posix_memalign(sz=%zu): %m", req->bufsz);
+	}
+	pos = req->buffer;
+	for (i=0; i < table->__iov_cnt; i++)
+	{
+		struct iovec *iov = &table->__iov[i];
+
+		memcpy(pos, iov->iov_base, iov->iov_len);
+		pos += iov->iov_len;
+	}
+	assert(pos <= req->buffer + length);
+	if (pos < req->buffer + length)
+		memset(pos, 0, (req->buffer + length) - pos);
+	table->__iov_cnt = 0;
+
+	req->next = NULL;
+	req->filename = filename;
+	req->fdesc = fdesc;
+	req->f_pos = f_pos;
+	req->length = length;
+
+	/* enqueue the request */
+	pthread_mutex_lock(&arrow_async_writer.lock);
+	if (!arrow_async_writer.tail)
+		arrow_async_writer.head = req;
+	else
+		arrow_async_writer.tail->next = req;
+	arrow_async_writer.tail = req;
+	pthread_cond_broadcast(&arrow_async_writer.cond);
+	pthread_mutex_unlock(&arrow_async_writer.lock);
+}
+
+/*
+ * arrowAsyncWriterStart
+ */
+void
+arrowAsyncWriterStart(SQLtable *table, int queue_depth, bool direct_io)
+{
+	assert(!arrow_async_writer.running);
+	if (direct_io)
+	{
+		int		flags = fcntl(table->fdesc, F_GETFL);
+
+		if (flags < 0 || fcntl(table->fdesc, F_SETFL, flags | O_DIRECT) != 0)
+			Elog("failed on fcntl('%s', F_SETFL, O_DIRECT): %m",
+				 table->filename);
+		table->f_pos = ARROW_DIRECT_IO_ALIGN(table->f_pos);
+	}
+	arrow_async_writer.shutdown = false;
+	arrow_async_writer.direct_io = direct_io;
+	arrow_async_writer.queue_depth = (queue_depth > 0 ? queue_depth : 1);
+	arrow_async_writer.num_pending = 0;
+	if ((errno = pthread_create(&arrow_async_writer.thread, NULL,
+								__arrowAsyncWriterMain, NULL)) != 0)
+		Elog("failed on pthread_create: %m");
+	arrow_async_writer.running = true;
+}
+
+/*
+ * arrowAsyncWriterStop
+ *
+ * It waits for completion of the pending requests, then turns off
+ * O_DIRECT to write out the rest of portion (dictionary, footer, ...).
+ */
+void
+arrowAsyncWriterStop(SQLtable *table)
+{
+	arrowWriteRequest *req;
+
+	if (!arrow_async_writer.running)
+		return;
+	pthread_mutex_lock(&arrow_async_writer.lock);
+	arrow_async_writer.shutdown = true;
+	pthread_cond_broadcast(&arrow_async_writer.cond);
+	pthread_mutex_unlock(&arrow_async_writer.lock);
+
+	if ((errno = pthread_join(arrow_async_writer.thread, NULL)) != 0)
+		Elog("failed on pthread_join: %m");
+	assert(arrow_async_writer.num_pending == 0);
+	while ((req = arrow_async_writer.free_list) != NULL)
+	{
+		arrow_async_writer.free_list = req->next;
+		free(req->buffer);
+		pfree(req);
+	}
+	if (arrow_async_writer.direct_io)
+	{
+		int		flags = fcntl(table->fdesc, F_GETFL);
+
+		if (flags < 0 || fcntl(table->fdesc, F_SETFL, flags & ~O_DIRECT) != 0)
+			Elog("failed on fcntl('%s', F_SETFL, %d): %m",
+				 table->filename, flags & ~O_DIRECT);
+	}
+	arrow_async_writer.running = false;
+}
+
 int
 writeArrowRecordBatchMT(SQLtable *main_table,
 						SQLtable *data_table,
@@ -1814,6 +2287,8 @@ writeArrowRecordBatchMT(SQLtable *main_table,
 	assert(data_table->__iov_cnt > 0 &&
 		   data_table->__iov[0].iov_len <= length);
 	meta_sz = data_table->__iov[0].iov_len;	/* metadata chunk */
+	if (arrow_async_writer.running && arrow_async_writer.direct_io)
+		length = ARROW_DIRECT_IO_ALIGN(length);
 
 	/* critical section */
 	if ((errno = pthread_mutex_lock(main_table_mutex)) != 0)
@@ -1846,7 +2321,10 @@ writeArrowRecordBatchMT(SQLtable *main_table,
 		Elog("failed on pthread_mutex_unlock: %m");
 
 	/* write file i/o */
-	__arrowFileWriteIOV(filename, fdesc, f_pos, data_table);
+	if (arrow_async_writer.running)
+		__arrowAsyncWriteIOV(filename, fdesc, f_pos, length, data_table);
+	else
+		__arrowFileWriteIOV(filename, fdesc, f_pos, data_table);
 
 	/* result back */
 	if (p_arrow_block)
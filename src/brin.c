@@ -20,6 +20,7 @@ typedef struct
 } IndexClauseSet;
 
 static bool		pgstrom_enable_brin;
+static bool		pgstrom_enable_brin_multi_index;
 
 /*
  * simple_match_clause_to_indexcol
@@ -124,6 +125,27 @@ simple_match_clause_to_index(IndexOptInfo *index,
 	}
 }
 
+/*
+ * __brinIndexColumnIsUnordered
+ *
+ * It checks whether the index column uses brin_bloom_ops or minmax_multi_ops.
+ * Unlike the classic minmax, these opclasses prune the ranges well even if
+ * the column is not correlated to the physical order.
+ */
+static bool
+__brinIndexColumnIsUnordered(IndexOptInfo *index, int indexcol)
+{
+	Oid		procoid = get_opfamily_proc(index->opfamily[indexcol],
+										index->opcintype[indexcol],
+										index->opcintype[indexcol],
+										BRIN_PROCNUM_CONSISTENT);
+	return (procoid == F_BRIN_BLOOM_CONSISTENT ||
+			procoid == F_BRIN_MINMAX_MULTI_CONSISTENT);
+}
+
+/* default false_positive_rate of brin_bloom_ops; also used for minmax_multi */
+#define BRIN_UNORDERED_FALSE_POSITIVE_RATE		0.01
+
 /*
  * estimate_brinindex_scan_nblocks
  *
@@ -147,6 +169,7 @@ estimateBrinIndexScanNBlocks(PlannerInfo *root,
 	double			indexRanges;
 	double			minimalRanges;
 	double			estimatedRanges;
+	double			unorderedRatio = 1.0;
 
 	/* Obtain some data from the index itself. */
 	indexRel = index_open(index->indexoid, AccessShareLock);
@@ -168,6 +191,32 @@ estimateBrinIndexScanNBlocks(PlannerInfo *root,
 			indexQuals = lappend(indexQuals, rinfo);
 		}
 
+		/*
+		 * On bloom/minmax_multi, a range is consistent if any of its tuples
+		 * satisfies the qualifiers (or false positive), regardless of the
+		 * correlation.
+		 */
+		if (clauseset->indexclauses[icol-1] != NIL &&
+			__brinIndexColumnIsUnordered(index, icol-1))
+		{
+			Selectivity	colSelectivity;
+			double		ntuples_per_range;
+			double		ratio;
+
+			colSelectivity = clauselist_selectivity(root,
+													clauseset->indexclauses[icol-1],
+													baserel->relid,
+													JOIN_INNER,
+													NULL);
+			ntuples_per_range = (baserel->pages > 0
+								 ? (baserel->tuples * statsData.pagesPerRange /
+									(double) baserel->pages)
+								 : 0.0);
+			ratio = (1.0 - pow(1.0 - colSelectivity, ntuples_per_range) +
+					 BRIN_UNORDERED_FALSE_POSITIVE_RATE);
+			unorderedRatio *= Min(ratio, 1.0);
+		}
+
 		if (IsA(tle->expr, Var))
 		{
 			Var	   *var = (Var *) tle->expr;
@@ -254,6 +303,8 @@ estimateBrinIndexScanNBlocks(PlannerInfo *root,
 		estimatedRanges = indexRanges;
 	else
 		estimatedRanges = Min(minimalRanges / indexCorrelation, indexRanges);
+	estimatedRanges = Min(estimatedRanges,
+						  Max(indexRanges * unorderedRatio, minimalRanges));
 
 	indexSelectivity = estimatedRanges / indexRanges;
 	if (indexSelectivity < 0.0)
@@ -334,17 +385,31 @@ extract_index_conditions(List *index_quals, IndexOptInfo *indexOpt)
 
 /*
  * pgstrom_tryfind_brinindex
+ *
+ * It picks up the BRIN-index with minimal selectivity as the primary one.
+ * Other BRIN-indexes on the different qualifiers are also picked up as
+ * the secondary ones, if the reduction of the blocks to be read exceeds
+ * the cost to check their summaries (only if pg_strom.enable_brin_multi_index).
  */
 IndexOptInfo *
 pgstromTryFindBrinIndex(PlannerInfo *root,
 						RelOptInfo *baserel,
 						List **p_indexConds,
 						List **p_indexQuals,
-						int64_t *p_indexNBlocks)
+						int64_t *p_indexNBlocks,
+						List **p_subIndexOids,
+						List **p_subIndexConds,
+						Cost *p_subIndexCost)
 {
 	int64_t			indexNBlocks = INT64_MAX;
 	IndexOptInfo   *indexOpt = NULL;
 	List		   *indexQuals = NIL;
+	List		   *candIndexes = NIL;
+	List		   *candQuals = NIL;
+	List		   *candNBlocks = NIL;
+	List		   *subIndexOids = NIL;
+	List		   *subIndexConds = NIL;
+	Cost			subIndexCost = 0.0;
 	ListCell	   *cell;
 
 	if (!pgstrom_enable_brin || baserel->indexlist == NIL)
@@ -394,13 +459,59 @@ pgstromTryFindBrinIndex(PlannerInfo *root,
 			indexQuals = temp;
 			indexNBlocks = nblocks;
 		}
+		candIndexes = lappend(candIndexes, index);
+		candQuals = lappend(candQuals, temp);
+		candNBlocks = lappend_int(candNBlocks, nblocks);
 	}
 
 	if (indexOpt)
 	{
+		List	   *usedQuals = list_copy(indexQuals);
+
+		if (pgstrom_enable_brin_multi_index &&
+			list_length(candIndexes) > 1 &&
+			baserel->pages > 0)
+		{
+			ListCell   *lc1, *lc2, *lc3;
+			double		spc_seq_page_cost;
+
+			get_tablespace_page_costs(baserel->reltablespace,
+									  NULL,
+									  &spc_seq_page_cost);
+			forthree (lc1, candIndexes,
+					  lc2, candQuals,
+					  lc3, candNBlocks)
+			{
+				IndexOptInfo *index = lfirst(lc1);
+				List	   *temp = lfirst(lc2);
+				int64_t		nblocks = lfirst_int(lc3);
+				int64_t		__nblocks;
+				Cost		__cost;
+
+				if (index == indexOpt ||
+					list_difference_ptr(temp, usedQuals) == NIL)
+					continue;
+				/* assume the qualifiers are independent */
+				__nblocks = ceil((double)indexNBlocks *
+								 (double)nblocks / (double)baserel->pages);
+				__cost = cost_brin_bitmap_build(root, baserel, index,
+												extract_actual_clauses(temp, false));
+				if (spc_seq_page_cost * (indexNBlocks - __nblocks) <= __cost)
+					continue;
+				subIndexOids = lappend_oid(subIndexOids, index->indexoid);
+				subIndexConds = lappend(subIndexConds,
+										extract_index_conditions(temp, index));
+				subIndexCost += __cost;
+				usedQuals = list_concat_unique_ptr(usedQuals, temp);
+				indexNBlocks = Max(__nblocks, 1);
+			}
+		}
 		*p_indexConds = extract_index_conditions(indexQuals, indexOpt);
-		*p_indexQuals = extract_actual_clauses(indexQuals, false);
+		*p_indexQuals = extract_actual_clauses(usedQuals, false);
 		*p_indexNBlocks = indexNBlocks;
+		*p_subIndexOids = subIndexOids;
+		*p_subIndexConds = subIndexConds;
+		*p_subIndexCost = subIndexCost;
 	}
 	return indexOpt;
 }
@@ -444,22 +555,14 @@ cost_brin_bitmap_build(PlannerInfo *root,
 }
 
 
+/*
+ * BrinIndexScanDesc - state of one BRIN-index to filter the ranges. When
+ * multiple BRIN-indexes are available, a range of the primary index is
+ * fetched only if any overlapping ranges are consistent on the other ones.
+ */
 typedef struct
-{
-	volatile int	build_status;
-	slock_t			lock;	/* once 'build_status' is set, no need to take
-							 * this lock again. */
-	pg_atomic_uint32 index;
-	uint32_t		nitems;
-	BlockNumber		chunks[FLEXIBLE_ARRAY_MEMBER];
-} BrinIndexResults;
-
-struct BrinIndexState
 {
 	Relation		index_rel;
-	List		   *index_quals;
-	BlockNumber		nblocks;
-	BlockNumber		nchunks;
 	BlockNumber		pagesPerRange;
 	BrinRevmap	   *brinRevmap;
 	BrinDesc	   *brinDesc;
@@ -467,14 +570,147 @@ struct BrinIndexState
 	int				NumScanKeys;
 	IndexRuntimeKeyInfo *RuntimeKeys;
 	int				NumRuntimeKeys;
+	/* per-attribute scan keys; see bringetbitmap() */
+	FmgrInfo	   *consistentFn;
+	ScanKey		  **keys;
+	ScanKey		  **nullkeys;
+	int			   *nkeys;
+	int			   *nnullkeys;
+	/* working buffers */
+	BrinMemTuple   *dtup;
+	Buffer			buffer;
+} BrinIndexScanDesc;
+
+/*
+ * BrinIndexResults - shared state of the parallel BRIN-index scan. Each
+ * participant fetches the next range by itself, then checks the summaries
+ * of the range; so the evaluation is distributed to the workers.
+ */
+typedef struct
+{
+	pg_atomic_uint32 index;		/* next range to be checked */
+} BrinIndexResults;
+
+struct BrinIndexState
+{
+	List		   *index_quals;
+	BlockNumber		nblocks;
+	BlockNumber		nchunks;
+	BlockNumber		pagesPerRange;	/* of the primary index */
+	int				nindexes;
+	BrinIndexScanDesc *indexes;		/* [0] is the primary index */
 	bool			RuntimeKeysIsReady;
 	ExprContext	   *RuntimeExprContext;
+	MemoryContext	per_range_cxt;
 	BrinIndexResults *brinResults;
+	uint32_t		batch_head;		/* next range in the current batch */
+	uint32_t		batch_tail;		/* end of the current batch */
+	uint32_t		batch_sz;		/* size of the next batch */
 	uint32_t		curr_chunk_id;
 	uint32_t		curr_block_id;
 	TBMIterateResult tbmres;	/* must be tail */
 };
 
+/*
+ * Ranges are claimed by batch to reduce the contention on the shared counter.
+ * The batch size begins from 1 and gets doubled for each claim, so the first
+ * matched range is returned immediately (likely LIMIT queries).
+ */
+#define BRIN_RANGE_BATCH_MAXSZ		64
+
+/*
+ * __BrinIndexScanBegin
+ */
+static void
+__BrinIndexScanBegin(pgstromTaskState *pts,
+					 BrinIndexScanDesc *iscan,
+					 Oid index_oid,
+					 List *index_conds,
+					 LOCKMODE lockmode)
+{
+	TupleDesc	bd_tupdesc;
+	int			j, keyno;
+
+	iscan->index_rel = index_open(index_oid, lockmode);
+	iscan->brinRevmap = brinRevmapInitialize(iscan->index_rel,
+											 &iscan->pagesPerRange);
+	iscan->brinDesc = brin_build_desc(iscan->index_rel);
+	iscan->buffer = InvalidBuffer;
+
+	/*
+	 * build the index scan keys from the index conditions
+	 */
+	ExecIndexBuildScanKeys(&pts->css.ss.ps,
+						   iscan->index_rel,
+						   index_conds,
+						   false,
+						   &iscan->ScanKeys,
+						   &iscan->NumScanKeys,
+						   &iscan->RuntimeKeys,
+						   &iscan->NumRuntimeKeys,
+						   NULL, NULL);
+	Assert(iscan->NumScanKeys >= iscan->NumRuntimeKeys);
+
+	/*
+	 * Make room for the consistent support procedures and per-attribute
+	 * lists of scan keys. The runtime keys update ScanKeys in place, so
+	 * we can split them at the beginning. We rely on zeroing fn_oid to
+	 * InvalidOid.
+	 */
+	bd_tupdesc = iscan->brinDesc->bd_tupdesc;
+	iscan->consistentFn = palloc0(sizeof(FmgrInfo) * bd_tupdesc->natts);
+	iscan->keys = palloc0(sizeof(ScanKey *) * bd_tupdesc->natts);
+	iscan->nullkeys = palloc0(sizeof(ScanKey *) * bd_tupdesc->natts);
+	iscan->nkeys = palloc0(sizeof(int) * bd_tupdesc->natts);
+	iscan->nnullkeys = palloc0(sizeof(int) * bd_tupdesc->natts);
+	for (j=0; j < bd_tupdesc->natts; j++)
+	{
+		iscan->keys[j] = palloc0(sizeof(ScanKey) * iscan->NumScanKeys);
+		iscan->nullkeys[j] = palloc0(sizeof(ScanKey) * iscan->NumScanKeys);
+	}
+
+	/* Preprocess the scan keys - split them into per-attribute arrays. */
+	for (keyno=0; keyno < iscan->NumScanKeys; keyno++)
+	{
+		ScanKey		key = &iscan->ScanKeys[keyno];
+		AttrNumber	keyattno = key->sk_attno;
+
+		/* the collation must mutually match */
+		Assert((key->sk_flags & SK_ISNULL) ||
+			   (key->sk_collation == TupleDescAttr(bd_tupdesc,
+												   keyattno - 1)->attcollation));
+
+		/* First time we see this index attribute, so init as needed. */
+		if (iscan->consistentFn[keyattno-1].fn_oid == InvalidOid)
+		{
+			FmgrInfo   *tmp;
+
+			Assert(iscan->nkeys[keyattno-1] == 0 &&
+				   iscan->nnullkeys[keyattno-1] == 0);
+			tmp = index_getprocinfo(iscan->index_rel, keyattno,
+									BRIN_PROCNUM_CONSISTENT);
+			fmgr_info_copy(&iscan->consistentFn[keyattno-1], tmp,
+						   CurrentMemoryContext);
+		}
+
+		/* Add key to the proper per-attribute array. */
+		if (key->sk_flags & SK_ISNULL)
+		{
+			int		idx = iscan->nnullkeys[keyattno-1]++;
+
+			iscan->nullkeys[keyattno-1][idx] = key;
+		}
+		else
+		{
+			int		idx = iscan->nkeys[keyattno-1]++;
+
+			iscan->keys[keyattno-1][idx] = key;
+		}
+	}
+	/* allocate an initial in-memory tuple, out of the per-range memcxt */
+	iscan->dtup = brin_new_memtuple(iscan->brinDesc);
+}
+
 /*
  * BrinIndexExecBegin
  */
@@ -482,7 +718,9 @@ void
 pgstromBrinIndexExecBegin(pgstromTaskState *pts,
 						  Oid index_oid,
 						  List *index_conds,
-						  List *index_quals)
+						  List *index_quals,
+						  List *subindex_oids,
+						  List *subindex_conds)
 {
 	/* see ExecInitBitmapIndexScan */
 	EState		   *estate = pts->css.ss.ps.state;
@@ -490,43 +728,50 @@ pgstromBrinIndexExecBegin(pgstromTaskState *pts,
 	Index			scanrelid = ((Scan *)pts->css.ss.ps.plan)->scanrelid;
 	LOCKMODE		lockmode = NoLock;
 	BrinIndexState *br_state;
+	bool			has_runtime_keys = false;
+	ListCell	   *lc1, *lc2;
+	int				i;
 
 	if (!OidIsValid(index_oid))
 	{
 		Assert(index_conds == NIL && index_quals == NIL);
 		return;
 	}
+	Assert(list_length(subindex_oids) == list_length(subindex_conds));
 	br_state = palloc0(offsetof(BrinIndexState, tbmres.offsets) +
 					   sizeof(BlockNumber) * MaxHeapTuplesPerPage);
 	/*
-	 * open the index relation
+	 * open the index relations
 	 */
 	lockmode = exec_rt_fetch(scanrelid, estate)->rellockmode;
-	br_state->index_rel = index_open(index_oid, lockmode);
 	br_state->index_quals = copyObject(index_quals);
-	br_state->brinRevmap = brinRevmapInitialize(br_state->index_rel,
-												&br_state->pagesPerRange);
-	br_state->brinDesc = brin_build_desc(br_state->index_rel); 
+	br_state->nindexes = 1 + list_length(subindex_oids);
+	br_state->indexes = palloc0(sizeof(BrinIndexScanDesc) * br_state->nindexes);
+	__BrinIndexScanBegin(pts, &br_state->indexes[0],
+						 index_oid, index_conds, lockmode);
+	i = 1;
+	forboth (lc1, subindex_oids,
+			 lc2, subindex_conds)
+	{
+		__BrinIndexScanBegin(pts, &br_state->indexes[i++],
+							 lfirst_oid(lc1), lfirst(lc2), lockmode);
+	}
+	for (i=0; i < br_state->nindexes; i++)
+	{
+		if (br_state->indexes[i].NumRuntimeKeys != 0)
+			has_runtime_keys = true;
+	}
+	br_state->pagesPerRange = br_state->indexes[0].pagesPerRange;
 	br_state->nblocks = RelationGetNumberOfBlocks(relation);
 	br_state->nchunks = (br_state->nblocks +
 						 br_state->pagesPerRange - 1) / br_state->pagesPerRange;
+	br_state->batch_head = 0;
+	br_state->batch_tail = 0;
+	br_state->batch_sz = 1;
 	br_state->curr_chunk_id = 0;
 	br_state->curr_block_id = UINT_MAX;
 
-	/*
-	 * build the index scan keys from the index conditions
-	 */
-	ExecIndexBuildScanKeys(&pts->css.ss.ps,
-						   br_state->index_rel,
-						   index_conds,
-						   false,
-						   &br_state->ScanKeys,
-						   &br_state->NumScanKeys,
-						   &br_state->RuntimeKeys,
-						   &br_state->NumRuntimeKeys,
-						   NULL, NULL);
-	Assert(br_state->NumScanKeys >= br_state->NumRuntimeKeys);
-	if (br_state->NumRuntimeKeys != 0)
+	if (has_runtime_keys)
 	{
 		ExprContext	   *econtext_saved = pts->css.ss.ps.ps_ExprContext;
 
@@ -538,6 +783,9 @@ pgstromBrinIndexExecBegin(pgstromTaskState *pts,
 	{
 		br_state->RuntimeExprContext = NULL;
 	}
+	br_state->per_range_cxt = AllocSetContextCreate(estate->es_query_cxt,
+													"BRIN-index per-range working",
+													ALLOCSET_DEFAULT_SIZES);
 	pts->br_state = br_state;
 }
 
@@ -551,23 +799,17 @@ pgstromBrinIndexExecReset(pgstromTaskState *pts)
 	BrinIndexState *br_state = pts->br_state;
 	BrinIndexResults *br_results = br_state->brinResults;
 
-	if (br_state->NumRuntimeKeys != 0)
-	{
-		ExprContext	*econtext = br_state->RuntimeExprContext;
-
-		ResetExprContext(econtext);
-		ExecIndexEvalRuntimeKeys(econtext,
-								 br_state->RuntimeKeys,
-								 br_state->NumRuntimeKeys);
-	}
+	/* runtime keys shall be evaluated on the next fetch */
 	br_state->RuntimeKeysIsReady = false;
 
+	br_state->batch_head = 0;
+	br_state->batch_tail = 0;
+	br_state->batch_sz = 1;
 	br_state->curr_chunk_id = 0;
 	br_state->curr_block_id = UINT_MAX;
 
-	br_results->build_status = 0;
-	br_results->nitems   = 0;
-	pg_atomic_init_u32(&br_results->index, 0);
+	if (br_results)
+		pg_atomic_write_u32(&br_results->index, 0);
 }
 
 /*
@@ -621,261 +863,173 @@ check_null_keys(BrinValues *bval, ScanKey *nullkeys, int nnullkeys)
 }
 
 /*
- * __BrinIndexExecBuildResults
+ * __BrinIndexCheckRange
+ *
+ * It checks whether the summary of the range that contains 'heapBlk' is
+ * consistent with the scan keys; see bringetbitmap().
  */
-static void
-__BrinIndexExecBuildResults(pgstromTaskState *pts)
+static bool
+__BrinIndexCheckRange(BrinIndexScanDesc *iscan, BlockNumber heapBlk)
 {
-	/* see bringetbitmap() */
-	pgstromSharedState *ps_state = pts->ps_state;
-	EState		   *estate = pts->css.ss.ps.state;
-	BrinIndexState *br_state = pts->br_state;
-	BrinIndexResults *br_results = br_state->brinResults;
-	BrinDesc	   *bdesc = br_state->brinDesc;
+	BrinDesc	   *bdesc = iscan->brinDesc;
 	TupleDesc		bd_tupdesc = bdesc->bd_tupdesc;
-	Buffer			buffer = InvalidBuffer;
-	FmgrInfo	   *consistentFn;
-	MemoryContext	oldcxt;
-	MemoryContext	per_range_cxt;
 	BrinMemTuple   *dtup;
-	ScanKey		  **keys;
-	ScanKey		  **nullkeys;
-	int			   *nkeys;
-	int			   *nnullkeys;
+	BrinTuple	   *__btup;
+	BrinTuple	   *btup = NULL;
+	Size			btupsz = 0;
+	OffsetNumber	off;
+	Size			size;
 	int				j, keyno;
-	uint32_t		chunk_id;
 
-	/*
-	 * Make room for the consistent support procedures of indexed columns.  We
-	 * don't look them up here; we do that lazily the first time we see a scan
-	 * key reference each of them.  We rely on zeroing fn_oid to InvalidOid.
-	 */
-	consistentFn = alloca(sizeof(FmgrInfo) * bd_tupdesc->natts);
-	memset(consistentFn, 0, sizeof(FmgrInfo) * bd_tupdesc->natts);
+	__btup = brinGetTupleForHeapBlock(iscan->brinRevmap,
+									  heapBlk,
+									  &iscan->buffer,
+									  &off,
+									  &size,
+									  BUFFER_LOCK_SHARE);
+	if (!__btup)
+		return true;
+	btup = brin_copy_tuple(__btup, size, btup, &btupsz);
+	LockBuffer(iscan->buffer, BUFFER_LOCK_UNLOCK);
 
+	dtup = brin_deform_tuple(bdesc, btup, iscan->dtup);
+	if (dtup->bt_placeholder)
+		return true;
 	/*
-	 * Make room for per-attribute lists of scan keys that we'll pass to the
-	 * consistent support procedure. We don't know which attributes have scan
-	 * keys, so we allocate space for all attributes. That may use more memory
-	 * but it's probably cheaper than determining which attributes are used.
+	 * Compare scan keys with summary values stored for the range.
+	 * If scan keys are matched, the page range must be added to
+	 * the bitmap.  We initially assume the range needs to be
+	 * added; in particular this serves the case where there are
+	 * no keys.
 	 */
-	keys = alloca(sizeof(ScanKey *) * bd_tupdesc->natts);
-	nullkeys = alloca(sizeof(ScanKey *) * bd_tupdesc->natts);
-	nkeys = alloca(sizeof(int) * bd_tupdesc->natts);
-	nnullkeys = alloca(sizeof(int) * bd_tupdesc->natts);
 	for (j=0; j < bd_tupdesc->natts; j++)
 	{
-		keys[j] = alloca(sizeof(ScanKey) * br_state->NumScanKeys);
-		nullkeys[j] = alloca(sizeof(ScanKey) * br_state->NumScanKeys);
-	}
-	memset(nkeys, 0, sizeof(int) * bd_tupdesc->natts);
-	memset(nnullkeys, 0, sizeof(int) * bd_tupdesc->natts);
+		BrinValues *bval;
+		Datum		add;
+		Oid			collation;
+		int			nkeys = iscan->nkeys[j];
+		ScanKey	   *keys = iscan->keys[j];
 
-	/* Preprocess the scan keys - split them into per-attribute arrays. */
-	for (keyno=0; keyno < br_state->NumScanKeys; keyno++)
-	{
-		ScanKey		key = &br_state->ScanKeys[keyno];
-		AttrNumber	keyattno = key->sk_attno;
+		/*
+		 * skip attributes without any scan keys (both regular and
+		 * IS [NOT] NULL)
+		 */
+		if (nkeys == 0 && iscan->nnullkeys[j] == 0)
+			continue;
 
-		/* the collation must mutually match */
-		Assert((key->sk_flags & SK_ISNULL) ||
-			   (key->sk_collation == TupleDescAttr(bd_tupdesc,
-												   keyattno - 1)->attcollation));
+		bval = &dtup->bt_columns[j];
 
-		/* First time we see this index attribute, so init as needed. */
-		if (consistentFn[keyattno-1].fn_oid == InvalidOid)
-		{
-			FmgrInfo   *tmp;
+		/*
+		 * First check if there are any IS [NOT] NULL scan keys,
+		 * and if we're violating them. In that case we can
+		 * terminate early, without invoking the support function.
+		 */
+		if (bdesc->bd_info[j]->oi_regular_nulls &&
+			!check_null_keys(bval, iscan->nullkeys[j], iscan->nnullkeys[j]))
+			return false;
 
-			Assert(nkeys[keyattno-1] == 0 &&
-				   nnullkeys[keyattno-1] == 0);
-			tmp = index_getprocinfo(br_state->index_rel, keyattno,
-									BRIN_PROCNUM_CONSISTENT);
-			fmgr_info_copy(&consistentFn[keyattno-1], tmp,
-						   CurrentMemoryContext);
-		}
+		/*
+		 * So either there are no IS [NOT] NULL keys, or all
+		 * passed. If there are no regular scan keys, we're done -
+		 * the page range matches. If there are regular keys, but
+		 * the page range is marked as 'all nulls' it can't
+		 * possibly pass (we're assuming the operators are
+		 * strict).
+		 */
+		if (nkeys == 0)
+			continue;
+		Assert(nkeys > 0 && nkeys <= iscan->NumScanKeys);
 
-		/* Add key to the proper per-attribute array. */
-		if (key->sk_flags & SK_ISNULL)
+		/* If it is all nulls, it cannot possibly be consistent. */
+		if (bval->bv_allnulls)
+			return false;
+
+		/*
+		 * Collation from the first key (has to be the same for
+		 * all keys for the same attribute).
+		 */
+		collation = keys[0]->sk_collation;
+
+		/*
+		 * Check whether the scan key is consistent with the page
+		 * range values; if so, have the pages in the range added
+		 * to the output bitmap.
+		 */
+		if (iscan->consistentFn[j].fn_nargs >= 4)
 		{
-			int		idx = nnullkeys[keyattno-1]++;
-			
-			nullkeys[keyattno-1][idx] = key;
+			/* Check all keys at once */
+			add = FunctionCall4Coll(&iscan->consistentFn[j],
+									collation,
+									PointerGetDatum(bdesc),
+									PointerGetDatum(bval),
+									PointerGetDatum(keys),
+									Int32GetDatum(nkeys));
+			if (!DatumGetBool(add))
+				return false;
 		}
 		else
 		{
-			int		idx = nkeys[keyattno-1]++;
-
-			keys[keyattno-1][idx] = key;
+			/*
+			 * Check keys one by one
+			 *
+			 * When there are multiple scan keys, failure to meet
+			 * the criteria for a single one of them is enough to
+			 * discard the range as a whole.
+			 */
+			for (keyno = 0; keyno < nkeys; keyno++)
+			{
+				add = FunctionCall3Coll(&iscan->consistentFn[j],
+										keys[keyno]->sk_collation,
+										PointerGetDatum(bdesc),
+										PointerGetDatum(bval),
+										PointerGetDatum(keys[keyno]));
+				if (!DatumGetBool(add))
+					return false;
+			}
 		}
 	}
-	/* allocate an initial in-memory tuple, out of the per-range memcxt */
-	dtup = brin_new_memtuple(bdesc);
+	return true;
+}
 
-	/* setup and switch a per-range memory context */
-	per_range_cxt = AllocSetContextCreate(CurrentMemoryContext,
-										  "__ExecBuildBrinIndexResults working",
-										  ALLOCSET_DEFAULT_SIZES);
-	oldcxt = MemoryContextSwitchTo(per_range_cxt);
+/*
+ * __BrinIndexCheckChunk
+ *
+ * It checks the range of the primary index, then the overlapping ranges of
+ * the secondary indexes. Since the ranges of the secondary indexes may have
+ * different pagesPerRange, the chunk is fetched if any of them are consistent.
+ */
+static bool
+__BrinIndexCheckChunk(BrinIndexState *br_state, uint32_t chunk_id)
+{
+	BlockNumber	head = chunk_id * br_state->pagesPerRange;
+	BlockNumber	tail = Min(head + br_state->pagesPerRange, br_state->nblocks);
 
-	/*
-	 * Now scan the revmap.  We start by querying for heap page 0,
-	 * incrementing by the number of pages per range; this gives us a full
-	 * view of the table.
-	 */
-	br_results->nitems = 0;
-	for (chunk_id = 0; chunk_id < br_state->nchunks; chunk_id++)
+	if (!__BrinIndexCheckRange(&br_state->indexes[0], head))
+		return false;
+	for (int i=1; i < br_state->nindexes; i++)
 	{
-		BrinTuple  *__btup;
-		BrinTuple  *btup = NULL;
-		Size		btupsz = 0;
-		OffsetNumber off;
-		Size		size;
-		bool		addrange = true;
-
-		CHECK_FOR_INTERRUPTS();
+		BrinIndexScanDesc *iscan = &br_state->indexes[i];
+		BlockNumber	blkno = head - head % iscan->pagesPerRange;
+		bool		matched = false;
 
-		MemoryContextReset(per_range_cxt);
-
-		__btup = brinGetTupleForHeapBlock(br_state->brinRevmap,
-										  chunk_id * br_state->pagesPerRange,
-										  &buffer,
-										  &off,
-										  &size,
-										  BUFFER_LOCK_SHARE);
-		if (!__btup)
-			goto skip;
-		btup = brin_copy_tuple(__btup, size, btup, &btupsz);
-		LockBuffer(buffer, BUFFER_LOCK_UNLOCK);
-
-		dtup = brin_deform_tuple(bdesc, btup, dtup);
-		if (dtup->bt_placeholder)
-			goto skip;
-		/*
-		 * Compare scan keys with summary values stored for the range.
-		 * If scan keys are matched, the page range must be added to
-		 * the bitmap.  We initially assume the range needs to be
-		 * added; in particular this serves the case where there are
-		 * no keys.
-		 */
-		for (j=0; j < bd_tupdesc->natts; j++)
+		for (; blkno < tail; blkno += iscan->pagesPerRange)
 		{
-			BrinValues *bval;
-			Datum		add;
-			Oid			collation;
-
-			 /*
-			  * skip attributes without any scan keys (both regular and
-			  * IS [NOT] NULL)
-			  */
-			if (nkeys[j] == 0 && nnullkeys[j] == 0)
-				continue;
-
-			bval = &dtup->bt_columns[j];
-
-			/*
-			  * First check if there are any IS [NOT] NULL scan keys,
-			  * and if we're violating them. In that case we can
-			  * terminate early, without invoking the support function.
-			  */
-			if (bdesc->bd_info[j]->oi_regular_nulls &&
-				!check_null_keys(bval, nullkeys[j], nnullkeys[j]))
+			if (__BrinIndexCheckRange(iscan, blkno))
 			{
-				addrange = false;
+				matched = true;
 				break;
 			}
-
-			/*
-			 * So either there are no IS [NOT] NULL keys, or all
-			 * passed. If there are no regular scan keys, we're done -
-			 * the page range matches. If there are regular keys, but
-			 * the page range is marked as 'all nulls' it can't
-			 * possibly pass (we're assuming the operators are
-			 * strict).
-			 */
-			if (!nkeys[j])
-				continue;
-			Assert(nkeys[j] > 0 && nkeys[j] <= br_state->NumScanKeys);
-
-			/* If it is all nulls, it cannot possibly be consistent. */
-			if (bval->bv_allnulls)
-			{
-				addrange = false;
-				break;
-			}
-
-			
-			/*
-			 * Collation from the first key (has to be the same for
-			 * all keys for the same attribute).
-			 */
-			collation = keys[j][0]->sk_collation;
-
-			/*
-			 * Check whether the scan key is consistent with the page
-			 * range values; if so, have the pages in the range added
-			 * to the output bitmap.
-			 */
-			if (consistentFn[j].fn_nargs >= 4)
-			{
-				/* Check all keys at once */
-				add = FunctionCall4Coll(&consistentFn[j],
-										collation,
-										PointerGetDatum(bdesc),
-										PointerGetDatum(bval),
-										PointerGetDatum(keys[j]),
-										Int32GetDatum(nkeys[j]));
-				addrange = DatumGetBool(add);
-			}
-			else
-			{
-				/*
-				 * Check keys one by one
-				 *
-				 * When there are multiple scan keys, failure to meet
-				 * the criteria for a single one of them is enough to
-				 * discard the range as a whole, so break out of the
-				 * loop as soon as a false return value is obtained.
-				 */
-				for (keyno = 0; keyno < nkeys[j]; keyno++)
-				{
-					add = FunctionCall3Coll(&consistentFn[j],
-											keys[j][keyno]->sk_collation,
-											PointerGetDatum(bdesc),
-											PointerGetDatum(bval),
-											PointerGetDatum(keys[j][keyno]));
-					addrange = DatumGetBool(add);
-					if (!addrange)
-						break;
-				}
-			}
-		}
-	skip:
-		if (addrange)
-		{
-			int		idx = br_results->nitems++;
-
-			br_results->chunks[idx] = chunk_id;
 		}
+		if (!matched)
+			return false;
 	}
-	/* update statistics */
-	pg_atomic_fetch_add_u32(&ps_state->brin_index_fetched, br_results->nitems);
-	pg_atomic_fetch_add_u32(&ps_state->brin_index_skipped,
-							br_state->nchunks - br_results->nitems);
-	MemoryContextSwitchTo(oldcxt);
-	MemoryContextDelete(per_range_cxt);
-
-	if (buffer != InvalidBuffer)
-		ReleaseBuffer(buffer);
-	pg_memory_barrier();
-	br_results->build_status = 1;
+	return true;
 }
 
 static inline BrinIndexResults *
 __BrinIndexGetResults(pgstromTaskState *pts)
 {
 	BrinIndexState *br_state = pts->br_state;
-	BrinIndexResults *br_results;
 
 	/*
 	 * At the first call of pgstromBrinIndexNextXXXX() at the single process
@@ -885,48 +1039,102 @@ __BrinIndexGetResults(pgstromTaskState *pts)
 	if (!br_state->brinResults)
 		pgstromBrinIndexInitDSM(pts, NULL);
 
-	if (br_state->NumRuntimeKeys != 0 &&
-		!br_state->RuntimeKeysIsReady)
-		pgstromBrinIndexExecReset(pts);
+	/*
+	 * Runtime keys are evaluated by each participant, prior to the check
+	 * of the first range.
+	 */
+	if (!br_state->RuntimeKeysIsReady)
+	{
+		ExprContext	*econtext = br_state->RuntimeExprContext;
+
+		if (econtext)
+		{
+			ResetExprContext(econtext);
+			for (int i=0; i < br_state->nindexes; i++)
+			{
+				BrinIndexScanDesc *iscan = &br_state->indexes[i];
 
-	br_results = br_state->brinResults;
-	if (br_results->build_status <= 0)
+				if (iscan->NumRuntimeKeys != 0)
+					ExecIndexEvalRuntimeKeys(econtext,
+											 iscan->RuntimeKeys,
+											 iscan->NumRuntimeKeys);
+			}
+		}
+		br_state->RuntimeKeysIsReady = true;
+	}
+	return br_state->brinResults;
+}
+
+/*
+ * __BrinIndexNextMatchedChunk
+ *
+ * It fetches the next range from the current batch (or claims a new batch),
+ * then checks its summary by itself, until the range consistent with the
+ * scan keys is found. So, the summary evaluation is overlapped with the
+ * scan of the ranges already returned.
+ */
+static bool
+__BrinIndexNextMatchedChunk(pgstromTaskState *pts, uint32_t *p_chunk_id)
+{
+	pgstromSharedState *ps_state = pts->ps_state;
+	BrinIndexState *br_state = pts->br_state;
+	BrinIndexResults *br_results = __BrinIndexGetResults(pts);
+	MemoryContext	oldcxt;
+	uint32_t		chunk_id;
+	bool			found = false;
+
+	oldcxt = MemoryContextSwitchTo(br_state->per_range_cxt);
+	for (;;)
 	{
-		SpinLockAcquire(&br_results->lock);
-		PG_TRY();
+		if (br_state->batch_head >= br_state->batch_tail)
 		{
-			if (br_results->build_status == 0)
-				__BrinIndexExecBuildResults(pts);
-			else if (br_results->build_status < 0)
-				elog(ERROR, "failed on __BrinIndexExecBuildResults by other workers");
+			uint32_t	batch_sz = br_state->batch_sz;
+
+			/* no need to touch the shared counter any more */
+			if (br_state->batch_head >= br_state->nchunks)
+				break;
+			br_state->batch_head = pg_atomic_fetch_add_u32(&br_results->index,
+														   batch_sz);
+			if (br_state->batch_head >= br_state->nchunks)
+			{
+				br_state->batch_tail = br_state->batch_head;
+				break;
+			}
+			br_state->batch_tail = Min(br_state->batch_head + batch_sz,
+									   br_state->nchunks);
+			br_state->batch_sz = Min(2 * batch_sz, BRIN_RANGE_BATCH_MAXSZ);
 		}
-		PG_CATCH();
+		chunk_id = br_state->batch_head++;
+
+		CHECK_FOR_INTERRUPTS();
+
+		MemoryContextReset(br_state->per_range_cxt);
+		if (__BrinIndexCheckChunk(br_state, chunk_id))
 		{
-			br_results->build_status = -1;
-			SpinLockRelease(&br_results->lock);
-			PG_RE_THROW();
+			pg_atomic_fetch_add_u32(&ps_state->brin_index_fetched, 1);
+			*p_chunk_id = chunk_id;
+			found = true;
+			break;
 		}
-		PG_END_TRY();
-		Assert(br_results->build_status > 0);
-		SpinLockRelease(&br_results->lock);
+		pg_atomic_fetch_add_u32(&ps_state->brin_index_skipped, 1);
 	}
-	return br_results;
+	MemoryContextSwitchTo(oldcxt);
+
+	return found;
 }
 
 TBMIterateResult *
 pgstromBrinIndexNextBlock(pgstromTaskState *pts)
 {
 	BrinIndexState *br_state = pts->br_state;
-	BrinIndexResults *br_results = __BrinIndexGetResults(pts);
-	uint32_t		index;
+	uint32_t		chunk_id;
 	BlockNumber		blockno;
 
 	if (br_state->curr_block_id >= br_state->pagesPerRange)
 	{
-		index = pg_atomic_fetch_add_u32(&br_results->index, 1);
-		if (index >= br_results->nitems)
+		if (!__BrinIndexNextMatchedChunk(pts, &chunk_id))
 			return NULL;
-		br_state->curr_chunk_id = br_results->chunks[index];
+		br_state->curr_chunk_id = chunk_id;
 		br_state->curr_block_id = 0;
 	}
 	blockno = (br_state->curr_chunk_id * br_state->pagesPerRange +
@@ -944,15 +1152,13 @@ bool
 pgstromBrinIndexNextChunk(pgstromTaskState *pts)
 {
 	BrinIndexState *br_state = pts->br_state;
-	BrinIndexResults *br_results = __BrinIndexGetResults(pts);
-	uint32_t		index;
+	uint32_t		chunk_id;
 
-	index = pg_atomic_fetch_add_u32(&br_results->index, 1);
-	if (index < br_results->nitems)
+	if (__BrinIndexNextMatchedChunk(pts, &chunk_id))
 	{
 		BlockNumber	pagesPerRange = br_state->pagesPerRange;
 
-		pts->curr_block_num  = br_results->chunks[index] * pagesPerRange;
+		pts->curr_block_num  = chunk_id * pagesPerRange;
 		pts->curr_block_tail = pts->curr_block_num + pagesPerRange;
 		if (pts->curr_block_num >= br_state->nblocks)
 			return false;
@@ -968,20 +1174,25 @@ pgstromBrinIndexExecEnd(pgstromTaskState *pts)
 {
 	BrinIndexState *br_state = pts->br_state;
 
-	if (br_state->brinRevmap)
-		brinRevmapTerminate(br_state->brinRevmap);
-	if (br_state->brinDesc)
-		brin_free_desc(br_state->brinDesc);
-	if (br_state->index_rel)
-		index_close(br_state->index_rel, NoLock);
+	for (int i=0; i < br_state->nindexes; i++)
+	{
+		BrinIndexScanDesc *iscan = &br_state->indexes[i];
+
+		if (iscan->buffer != InvalidBuffer)
+			ReleaseBuffer(iscan->buffer);
+		if (iscan->brinRevmap)
+			brinRevmapTerminate(iscan->brinRevmap);
+		if (iscan->brinDesc)
+			brin_free_desc(iscan->brinDesc);
+		if (iscan->index_rel)
+			index_close(iscan->index_rel, NoLock);
+	}
 }
 
 Size
 pgstromBrinIndexEstimateDSM(pgstromTaskState *pts)
 {
-	BrinIndexState *br_state = pts->br_state;
-
-	return MAXALIGN(offsetof(BrinIndexResults, chunks[br_state->nchunks]));
+	return MAXALIGN(sizeof(BrinIndexResults));
 }
 
 Size
@@ -989,10 +1200,8 @@ pgstromBrinIndexInitDSM(pgstromTaskState *pts, char *dsm_addr)
 {
 	BrinIndexState *br_state = pts->br_state;
 	BrinIndexResults *br_results;
-	Size		dsm_len = 0;
+	Size		dsm_len = MAXALIGN(sizeof(BrinIndexResults));
 
-	dsm_len = MAXALIGN(offsetof(BrinIndexResults,
-								chunks[br_state->nchunks]));
 	if (dsm_addr)
 		br_results = (BrinIndexResults *)dsm_addr;
 	else
@@ -1001,8 +1210,7 @@ pgstromBrinIndexInitDSM(pgstromTaskState *pts, char *dsm_addr)
 
 		br_results = MemoryContextAlloc(estate->es_query_cxt, dsm_len);
 	}
-	memset(br_results, 0, offsetof(BrinIndexResults, chunks));
-	SpinLockInit(&br_results->lock);
+	pg_atomic_init_u32(&br_results->index, 0);
 
 	br_state->brinResults = br_results;
 
@@ -1015,8 +1223,7 @@ pgstromBrinIndexAttachDSM(pgstromTaskState *pts, char *dsm_addr)
 	BrinIndexState *br_state = pts->br_state;
 
 	br_state->brinResults = (BrinIndexResults *)dsm_addr;
-	return MAXALIGN(offsetof(BrinIndexResults,
-							 chunks[br_state->nchunks]));
+	return MAXALIGN(sizeof(BrinIndexResults));
 }
 
 void
@@ -1083,4 +1290,13 @@ pgstrom_init_brin(void)
 							 PGC_USERSET,
 							 GUC_NOT_IN_SAMPLE,
 							 NULL, NULL, NULL);
+	/* pg_strom.enable_brin_multi_index */
+	DefineCustomBoolVariable("pg_strom.enable_brin_multi_index",
+							 "Enables to combine multiple BRIN-indexes",
+							 NULL,
+							 &pgstrom_enable_brin_multi_index,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
 }
@@ -20,6 +20,7 @@ static List	   *devtype_info_slot[DEVTYPE_INFO_NSLOTS];
 static List	   *devfunc_info_slot[DEVFUNC_INFO_NSLOTS];
 static HTAB	   *devtype_rev_htable = NULL;		/* lookup by TypeOpCode */
 static HTAB	   *devfunc_rev_htable = NULL;		/* lookup by FuncOpCode */
+static bool		pgstrom_enable_inline_sql_functions;	/* GUC */
 
 /* -------- static declarations -------- */
 #define TYPE_OPCODE(NAME,EXTENSION,FLAGS)								\
@@ -165,6 +166,40 @@ get_cube_type_oid(bool missing_ok)
 	return __type_oid_cache_cube;
 }
 
+static Oid		__type_oid_cache_geometry = UINT_MAX;
+Oid
+get_geometry_type_oid(bool missing_ok)
+{
+	if (__type_oid_cache_geometry == UINT_MAX)
+	{
+		Oid			type_oid = InvalidOid;
+		CatCList   *typelist;
+
+		typelist = SearchSysCacheList1(TYPENAMENSP,
+									   CStringGetDatum("geometry"));
+		for (int i=0; i < typelist->n_members; i++)
+		{
+			HeapTuple	type_htup = &typelist->members[i]->tuple;
+			Form_pg_type type_form = (Form_pg_type)GETSTRUCT(type_htup);
+			const char *ext_name;
+
+			ext_name = get_extension_name_by_object(TypeRelationId,
+													type_form->oid);
+			if (ext_name && strcmp(ext_name, "postgis") == 0)
+			{
+				type_oid = type_form->oid;
+				break;
+			}
+		}
+		ReleaseCatCacheList(typelist);
+
+		__type_oid_cache_geometry = type_oid;
+	}
+	if (!missing_ok && !OidIsValid(__type_oid_cache_geometry))
+		elog(ERROR, "type 'geometry' is not installed");
+	return __type_oid_cache_geometry;
+}
+
 /*
  * build_basic_devtype_info
  */
@@ -763,6 +798,54 @@ devtype_money_hash(bool isnull, Datum value)
 	return __devtype_simple_hash(isnull, value, sizeof(int64_t));
 }
 
+/*
+ * pgstrom_devtype_hash_batch
+ *
+ * It merges the hash values of nitems datums into hashes[], for the inner
+ * preloading of GpuJoin. The results are identical to type_hashfunc, but
+ * the simple fixed-length types are hashed in a loop without indirect calls.
+ */
+void
+pgstrom_devtype_hash_batch(devtype_info *dtype, int nitems,
+						   const Datum *values, const bool *isnull,
+						   uint32_t *hashes)
+{
+	devtype_hashfunc_f h_func = dtype->type_hashfunc;
+
+	if (h_func == devtype_int4_hash ||
+		h_func == devtype_float4_hash ||
+		h_func == devtype_date_hash)
+	{
+		/* hash_bytes_uint32() is identical to hash_any() on 4 bytes */
+		for (int i=0; i < nitems; i++)
+		{
+			uint32_t	hash = (isnull[i] ? 0 :
+								hash_bytes_uint32(DatumGetUInt32(values[i])));
+			hashes[i] = pg_hash_merge(hashes[i], hash);
+		}
+	}
+	else if (h_func == devtype_int8_hash ||
+			 h_func == devtype_float8_hash ||
+			 h_func == devtype_time_hash ||
+			 h_func == devtype_timestamp_hash ||
+			 h_func == devtype_timestamptz_hash ||
+			 h_func == devtype_money_hash)
+	{
+		for (int i=0; i < nitems; i++)
+		{
+			uint32_t	hash = (isnull[i] ? 0 :
+								hash_any((const unsigned char *)&values[i],
+										 sizeof(int64_t)));
+			hashes[i] = pg_hash_merge(hashes[i], hash);
+		}
+	}
+	else
+	{
+		for (int i=0; i < nitems; i++)
+			hashes[i] = pg_hash_merge(hashes[i], h_func(isnull[i], values[i]));
+	}
+}
+
 static uint32_t
 devtype_uuid_hash(bool isnull, Datum value)
 {
@@ -900,6 +983,36 @@ devtype_box2df_hash(bool isnull, Datum value)
 	elog(ERROR, "box2df type has no device hash function");
 }
 
+static uint32_t
+devtype_int4range_hash(bool isnull, Datum value)
+{
+	elog(ERROR, "int4range type has no device hash function");
+}
+
+static uint32_t
+devtype_int8range_hash(bool isnull, Datum value)
+{
+	elog(ERROR, "int8range type has no device hash function");
+}
+
+static uint32_t
+devtype_daterange_hash(bool isnull, Datum value)
+{
+	elog(ERROR, "daterange type has no device hash function");
+}
+
+static uint32_t
+devtype_tsrange_hash(bool isnull, Datum value)
+{
+	elog(ERROR, "tsrange type has no device hash function");
+}
+
+static uint32_t
+devtype_tstzrange_hash(bool isnull, Datum value)
+{
+	elog(ERROR, "tstzrange type has no device hash function");
+}
+
 static uint32_t
 devtype_cube_hash(bool isnull, Datum value)
 {
@@ -927,6 +1040,158 @@ static struct {
 	{NULL,NULL,0,FuncOpCode__Invalid,0,NULL}
 };
 
+/*
+ * User defined SQL functions
+ *
+ * IMMUTABLE SQL function that consists of a single expression (like
+ * 'SELECT $1 * 0.8 + $2') is also available on the device, if its body is
+ * built from the device supported expressions. The function body is saved
+ * on the devfunc_info, then it is inlined at the code generation time.
+ * It is usually inlined by the planner prior to the query execution, but
+ * not always (e.g, when the function is called from the scan-quals of
+ * the inner side, or STRICT function whose arguments are not referenced).
+ */
+static bool
+__count_inline_sql_params_walker(Node *node, int *usecounts)
+{
+	if (!node)
+		return false;
+	if (IsA(node, Param))
+	{
+		Param	   *param = (Param *)node;
+
+		if (param->paramkind == PARAM_EXTERN && param->paramid > 0)
+			usecounts[param->paramid - 1]++;
+		return false;
+	}
+	return expression_tree_walker(node, __count_inline_sql_params_walker,
+								  usecounts);
+}
+
+static Expr *
+__pgstrom_devfunc_build_inline(Oid func_oid, int func_nargs, Oid *func_argtypes)
+{
+	HeapTuple	tuple;
+	Form_pg_proc proc;
+	Datum		datum;
+	bool		isnull;
+	SQLFunctionParseInfoPtr pinfo;
+	List	   *querytree_list;
+	Query	   *query;
+	TargetEntry *tle;
+	Expr	   *expr = NULL;
+	int		   *usecounts;
+	int			i;
+
+	tuple = SearchSysCache1(PROCOID, ObjectIdGetDatum(func_oid));
+	if (!HeapTupleIsValid(tuple))
+		elog(ERROR, "cache lookup failed for function %u", func_oid);
+	proc = (Form_pg_proc) GETSTRUCT(tuple);
+	if (proc->prolang != SQLlanguageId ||
+		proc->prokind != PROKIND_FUNCTION ||
+		proc->provolatile != PROVOLATILE_IMMUTABLE ||
+		proc->prosecdef ||
+		proc->proretset ||
+		proc->pronargs != func_nargs ||
+		IsPolymorphicType(proc->prorettype) ||
+		!heap_attisnull(tuple, Anum_pg_proc_proconfig, NULL))
+		goto bailout;
+	for (i=0; i < func_nargs; i++)
+	{
+		Oid		type_oid = proc->proargtypes.values[i];
+
+		if (IsPolymorphicType(type_oid) || type_oid != func_argtypes[i])
+			goto bailout;
+	}
+
+	/* parse the function body */
+	pinfo = prepare_sql_fn_parse_info(tuple, NULL, InvalidOid);
+	datum = SysCacheGetAttr(PROCOID, tuple, Anum_pg_proc_prosqlbody, &isnull);
+	if (!isnull)
+	{
+		Node	   *node = stringToNode(TextDatumGetCString(datum));
+
+		if (IsA(node, List))
+			querytree_list = linitial_node(List, castNode(List, node));
+		else
+			querytree_list = list_make1(node);
+		if (list_length(querytree_list) != 1)
+			goto bailout;
+		query = linitial(querytree_list);
+		AcquireRewriteLocks(query, true, false);
+		querytree_list = pg_rewrite_query(query);
+	}
+	else
+	{
+		List	   *raw_parsetree_list;
+		char	   *src;
+
+		datum = SysCacheGetAttr(PROCOID, tuple, Anum_pg_proc_prosrc, &isnull);
+		if (isnull)
+			goto bailout;
+		src = TextDatumGetCString(datum);
+		raw_parsetree_list = pg_parse_query(src);
+		if (list_length(raw_parsetree_list) != 1)
+			goto bailout;
+		querytree_list = pg_analyze_and_rewrite_withcb(linitial(raw_parsetree_list),
+													   src,
+													   (ParserSetupHook) sql_fn_parser_setup,
+													   pinfo, NULL);
+	}
+	if (list_length(querytree_list) != 1)
+		goto bailout;
+	query = linitial(querytree_list);
+
+	/* must be 'SELECT expression' form */
+	if (!IsA(query, Query) ||
+		query->commandType != CMD_SELECT ||
+		query->hasAggs ||
+		query->hasWindowFuncs ||
+		query->hasTargetSRFs ||
+		query->hasSubLinks ||
+		query->cteList != NIL ||
+		query->rtable != NIL ||
+		(query->jointree != NULL &&
+		 (query->jointree->fromlist != NIL ||
+		  query->jointree->quals != NULL)) ||
+		query->groupClause != NIL ||
+		query->groupingSets != NIL ||
+		query->havingQual != NULL ||
+		query->windowClause != NIL ||
+		query->distinctClause != NIL ||
+		query->sortClause != NIL ||
+		query->limitOffset != NULL ||
+		query->limitCount != NULL ||
+		query->setOperations != NULL ||
+		list_length(query->targetList) != 1)
+		goto bailout;
+	tle = linitial(query->targetList);
+	if (exprType((Node *)tle->expr) != proc->prorettype ||
+		contain_mutable_functions((Node *)tle->expr))
+		goto bailout;
+	/*
+	 * STRICT function must return NULL for NULL arguments, so the body
+	 * must be strict and reference all the arguments.
+	 */
+	if (proc->proisstrict)
+	{
+		if (contain_nonstrict_functions((Node *)tle->expr))
+			goto bailout;
+		usecounts = alloca(sizeof(int) * (func_nargs + 1));
+		memset(usecounts, 0, sizeof(int) * (func_nargs + 1));
+		__count_inline_sql_params_walker((Node *)tle->expr, usecounts);
+		for (i=0; i < func_nargs; i++)
+		{
+			if (usecounts[i] == 0)
+				goto bailout;
+		}
+	}
+	expr = tle->expr;
+bailout:
+	ReleaseSysCache(tuple);
+	return expr;
+}
+
 static devfunc_info *
 pgstrom_devfunc_build(Oid func_oid, int func_nargs, Oid *func_argtypes)
 {
@@ -934,6 +1199,7 @@ pgstrom_devfunc_build(Oid func_oid, int func_nargs, Oid *func_argtypes)
 	const char	   *fname;
 	Oid				fnamespace;
 	Oid				frettype;
+	Expr		   *finline;
 	StringInfoData	buf;
 	devfunc_info   *dfunc = NULL;
 	devtype_info   *dtype_rettype;
@@ -960,7 +1226,30 @@ pgstrom_devfunc_build(Oid func_oid, int func_nargs, Oid *func_argtypes)
 	/* we expect built-in functions are in pg_catalog namespace */
 	fextension = get_extension_name_by_object(ProcedureRelationId, func_oid);
 	if (!fextension && fnamespace != PG_CATALOG_NAMESPACE)
+	{
+		/* user defined SQL function that can be inlined? */
+		finline = __pgstrom_devfunc_build_inline(func_oid,
+												 func_nargs,
+												 func_argtypes);
+		if (finline)
+		{
+			oldcxt = MemoryContextSwitchTo(devinfo_memcxt);
+			dfunc = palloc0(offsetof(devfunc_info,
+									 func_argtypes[func_nargs]));
+			dfunc->func_code = FuncOpCode__Invalid;
+			dfunc->func_name = pstrdup(fname);
+			dfunc->func_oid = func_oid;
+			dfunc->func_rettype = dtype_rettype;
+			dfunc->func_flags = DEVKIND__ANY;
+			dfunc->func_cost = 0;
+			dfunc->func_inline_expr = copyObject(finline);
+			dfunc->func_nargs = func_nargs;
+			memcpy(dfunc->func_argtypes, dtype_argtypes,
+				   sizeof(devtype_info *) * func_nargs);
+			MemoryContextSwitchTo(oldcxt);
+		}
 		goto bailout;
+	}
 
 	for (i=0; devfunc_catalog[i].func_name != NULL; i++)
 	{
@@ -1044,6 +1333,60 @@ typedef struct {
 	Oid		func_argtypes[1];
 } devfunc_cache_signature;
 
+/*
+ * __collation_is_bytewise
+ *
+ * The device text comparison is memcmp(). It is consistent with the
+ * C/POSIX collation, and the C.UTF-8 collation of libc on the UTF-8
+ * database, because the byte order of UTF-8 is the code-point order.
+ */
+static bool
+__collation_is_bytewise(Oid collid)
+{
+	const char *collcollate = NULL;
+	char		collprovider;
+	bool		retval = false;
+
+	if (lc_collate_is_c(collid))
+		return true;
+	if (GetDatabaseEncoding() != PG_UTF8)
+		return false;
+	if (collid == DEFAULT_COLLATION_OID)
+	{
+		if (default_locale.provider != COLLPROVIDER_LIBC)
+			return false;
+		collcollate = setlocale(LC_COLLATE, NULL);
+		if (collcollate)
+			retval = (strcmp(collcollate, "C.UTF-8") == 0 ||
+					  strcmp(collcollate, "C.utf8") == 0);
+	}
+	else
+	{
+		HeapTuple	tup;
+		Datum		datum;
+		bool		isnull;
+
+		tup = SearchSysCache1(COLLOID, ObjectIdGetDatum(collid));
+		if (!HeapTupleIsValid(tup))
+			elog(ERROR, "cache lookup failed for collation %u", collid);
+		collprovider = ((Form_pg_collation) GETSTRUCT(tup))->collprovider;
+		if (collprovider == COLLPROVIDER_LIBC)
+		{
+			datum = SysCacheGetAttr(COLLOID, tup,
+									Anum_pg_collation_collcollate,
+									&isnull);
+			if (!isnull)
+			{
+				collcollate = TextDatumGetCString(datum);
+				retval = (strcmp(collcollate, "C.UTF-8") == 0 ||
+						  strcmp(collcollate, "C.utf8") == 0);
+			}
+		}
+		ReleaseSysCache(tup);
+	}
+	return retval;
+}
+
 static devfunc_info *
 __pgstrom_devfunc_lookup(Oid func_oid,
 						 int func_nargs,
@@ -1120,11 +1463,17 @@ __pgstrom_devfunc_lookup(Oid func_oid,
 found:
 	if (dfunc->func_is_negative)
 		return NULL;
-	if (OidIsValid(func_collid) &&
-		(dfunc->func_flags & DEVFUNC__LOCALE_AWARE) != 0)
+	if (OidIsValid(func_collid))
 	{
-		/* see texteq, bpchareq */
-		if (!lc_collate_is_c(func_collid))
+		/*
+		 * non-deterministic collation makes texteq, bpchareq and so on
+		 * not bytewise, so it is not supported at all.
+		 */
+		if (!lc_collate_is_c(func_collid) &&
+			!get_collation_isdeterministic(func_collid))
+			return NULL;
+		if ((dfunc->func_flags & DEVFUNC__LOCALE_AWARE) != 0 &&
+			!__collation_is_bytewise(func_collid))
 			return NULL;	/* not supported */
 	}
 	return dfunc;
@@ -1546,6 +1895,34 @@ found:
 	return kvdef;
 }
 
+/*
+ * __codegen_cse_reference
+ *
+ * It writes out VarExpr to reference the common sub-expression that is
+ * already saved on the kvars-slot at the current stage.
+ */
+static int
+__codegen_cse_reference(codegen_context *context,
+						StringInfo buf,
+						codegen_kvar_defitem *kvdef)
+{
+	if (buf)
+	{
+		kern_expression kexp;
+		int			pos;
+
+		memset(&kexp, 0, sizeof(kexp));
+		kexp.exptype         = kvdef->kv_type_code;
+		kexp.expflags        = context->kexp_flags;
+		kexp.opcode          = FuncOpCode__VarExpr;
+		kexp.u.v.var_slot_id = kvdef->kv_slot_id;
+		kexp.u.v.var_offset  = -1;
+		pos = __appendBinaryStringInfo(buf, &kexp, SizeOfKernExprVar);
+		__appendKernExpMagicAndLength(buf, pos);
+	}
+	return 0;
+}
+
 /*
  * __try_inject_temporary_expression
  */
@@ -1614,6 +1991,12 @@ __try_inject_temporary_expression(codegen_context *context,
 	 * Setup SaveExpr expression
 	 */
 found:
+	if (list_member_ptr(context->cse_kvdefs, kvdef))
+	{
+		/* already saved at the current stage */
+		__codegen_cse_reference(context, buf, kvdef);
+		return kvdef;
+	}
 	memset(&kexp, 0, sizeof(kexp));
 	kexp.exptype  = kvdef->kv_type_code;
 	kexp.expflags = context->kexp_flags;
@@ -1833,6 +2216,205 @@ codegen_var_expression(codegen_context *context,
 	return 0;
 }
 
+/*
+ * __codegen_numeric_precision
+ *
+ * It estimates the precision and scale of the numeric expression, if it is
+ * bounded by the typmod or constant values. Device code tries to run the
+ * numeric operations using scaled 64bit integer, if both arguments and
+ * result are bounded by NUMERIC_INT64_MAX_PRECISION.
+ */
+#define NUMERIC_INT64_MAX_PRECISION		18
+
+static bool
+__codegen_numeric_func_precision(Oid func_oid, List *func_args,
+								 int *p_precision, int *p_scale);
+
+static bool
+__codegen_numeric_precision(Node *node, int *p_precision, int *p_scale)
+{
+	int32_t		typmod;
+
+	if (exprType(node) != NUMERICOID)
+		return false;
+	typmod = exprTypmod(node);
+	if (typmod >= (int32_t)VARHDRSZ)
+	{
+		int32_t		precision = ((typmod - VARHDRSZ) >> 16) & 0xffff;
+		int32_t		scale = (((typmod - VARHDRSZ) & 0x7ff) ^ 1024) - 1024;
+
+		if (scale < 0 || scale > precision)
+			return false;
+		*p_precision = precision;
+		*p_scale = scale;
+		return true;
+	}
+	if (IsA(node, Const))
+	{
+		Const	   *con = (Const *)node;
+		char	   *str, *pos;
+		int			ndigits = 0;
+		int			nscale = 0;
+		bool		meet_dot = false;
+
+		if (con->constisnull)
+			return false;
+		str = DatumGetCString(DirectFunctionCall1(numeric_out,
+												  con->constvalue));
+		for (pos = str; *pos != '\0'; pos++)
+		{
+			if (isdigit(*pos))
+			{
+				ndigits++;
+				if (meet_dot)
+					nscale++;
+			}
+			else if (*pos == '.')
+				meet_dot = true;
+			else if (*pos != '-')
+				return false;	/* NaN or Inf */
+		}
+		*p_precision = Max(ndigits, 1);
+		*p_scale = nscale;
+		return true;
+	}
+	if (IsA(node, FuncExpr))
+	{
+		FuncExpr   *func = (FuncExpr *)node;
+
+		return __codegen_numeric_func_precision(func->funcid,
+												func->args,
+												p_precision,
+												p_scale);
+	}
+	if (IsA(node, OpExpr))
+	{
+		OpExpr	   *op = (OpExpr *)node;
+
+		return __codegen_numeric_func_precision(get_opcode(op->opno),
+												op->args,
+												p_precision,
+												p_scale);
+	}
+	return false;
+}
+
+static bool
+__codegen_numeric_func_precision(Oid func_oid, List *func_args,
+								 int *p_precision, int *p_scale)
+{
+	int			p1, s1, p2, s2;
+
+	switch (func_oid)
+	{
+		case F_NUMERIC_INT2:
+			*p_precision = 5;
+			*p_scale = 0;
+			return true;
+		case F_NUMERIC_INT4:
+			*p_precision = 10;
+			*p_scale = 0;
+			return true;
+		case F_NUMERIC_UPLUS:
+		case F_NUMERIC_UMINUS:
+		case F_NUMERIC_ABS:
+			if (list_length(func_args) != 1)
+				return false;
+			return __codegen_numeric_precision(linitial(func_args),
+											   p_precision,
+											   p_scale);
+		case F_NUMERIC_ADD:
+		case F_NUMERIC_SUB:
+			if (list_length(func_args) != 2 ||
+				!__codegen_numeric_precision(linitial(func_args), &p1, &s1) ||
+				!__codegen_numeric_precision(lsecond(func_args), &p2, &s2))
+				return false;
+			*p_scale = Max(s1, s2);
+			*p_precision = Max(p1 - s1, p2 - s2) + 1 + *p_scale;
+			return true;
+		case F_NUMERIC_MUL:
+			if (list_length(func_args) != 2 ||
+				!__codegen_numeric_precision(linitial(func_args), &p1, &s1) ||
+				!__codegen_numeric_precision(lsecond(func_args), &p2, &s2))
+				return false;
+			*p_precision = p1 + p2;
+			*p_scale = s1 + s2;
+			return true;
+		case F_NUMERIC_EQ:
+		case F_NUMERIC_NE:
+		case F_NUMERIC_LT:
+		case F_NUMERIC_LE:
+		case F_NUMERIC_GT:
+		case F_NUMERIC_GE:
+			/* precision of the arguments */
+			if (list_length(func_args) != 2 ||
+				!__codegen_numeric_precision(linitial(func_args), &p1, &s1) ||
+				!__codegen_numeric_precision(lsecond(func_args), &p2, &s2))
+				return false;
+			*p_scale = Max(s1, s2);
+			*p_precision = Max(p1 - s1, p2 - s2) + *p_scale;
+			return true;
+		default:
+			break;
+	}
+	return false;
+}
+
+/*
+ * codegen_inline_sql_function
+ *
+ * It expands the body of SQL function, by replacement of the parameter
+ * references with the actual arguments.
+ */
+static Node *
+__codegen_inline_sql_function_mutator(Node *node, List *func_args)
+{
+	if (!node)
+		return NULL;
+	if (IsA(node, Param))
+	{
+		Param	   *param = (Param *)node;
+
+		if (param->paramkind == PARAM_EXTERN &&
+			param->paramid > 0 &&
+			param->paramid <= list_length(func_args))
+			return copyObject(list_nth(func_args, param->paramid - 1));
+		elog(ERROR, "unexpected parameter reference in the SQL function");
+	}
+	return expression_tree_mutator(node, __codegen_inline_sql_function_mutator,
+								   func_args);
+}
+
+static int
+codegen_inline_sql_function(codegen_context *context,
+							StringInfo buf, int curr_depth,
+							devfunc_info *dfunc,
+							List *func_args,
+							Oid func_collid)
+{
+	Expr	   *expr;
+	int			rv;
+
+	if (!pgstrom_enable_inline_sql_functions)
+		__Elog("SQL function %s is not supported on device (pg_strom.enable_inline_sql_functions = off)",
+			   format_procedure(dfunc->func_oid));
+	if (OidIsValid(func_collid) && func_collid != DEFAULT_COLLATION_OID)
+		__Elog("SQL function %s with non-default collation is not supported on device",
+			   format_procedure(dfunc->func_oid));
+	if (list_member_oid(context->inline_funcs, dfunc->func_oid))
+		__Elog("SQL function %s is recursively called",
+			   format_procedure(dfunc->func_oid));
+	expr = (Expr *)
+		__codegen_inline_sql_function_mutator((Node *)dfunc->func_inline_expr,
+											  func_args);
+	context->inline_funcs = lappend_oid(context->inline_funcs,
+										dfunc->func_oid);
+	rv = codegen_expression_walker(context, buf, curr_depth, expr);
+	context->inline_funcs = list_delete_last(context->inline_funcs);
+
+	return rv;
+}
+
 static int
 __codegen_func_expression(codegen_context *context,
 						  StringInfo buf,
@@ -1852,6 +2434,9 @@ __codegen_func_expression(codegen_context *context,
 		(dfunc->func_flags & context->xpu_task_flags & DEVKIND__ANY) == 0)
 		__Elog("function %s is not supported on the target device",
 			   format_procedure(func_oid));
+	if (dfunc->func_inline_expr)
+		return codegen_inline_sql_function(context, buf, curr_depth,
+										   dfunc, func_args, func_collid);
 	dtype = dfunc->func_rettype;
 	context->device_cost += dfunc->func_cost;
 
@@ -1861,12 +2446,66 @@ __codegen_func_expression(codegen_context *context,
 	kexp.opcode = dfunc->func_code;
 	kexp.nr_args = list_length(func_args);
 	kexp.args_offset = SizeOfKernExpr(0);
+	switch (dfunc->func_code)
+	{
+		case FuncOpCode__numeric_add:
+		case FuncOpCode__numeric_sub:
+		case FuncOpCode__numeric_mul:
+		case FuncOpCode__numeric_eq:
+		case FuncOpCode__numeric_ne:
+		case FuncOpCode__numeric_lt:
+		case FuncOpCode__numeric_le:
+		case FuncOpCode__numeric_gt:
+		case FuncOpCode__numeric_ge:
+			{
+				int		precision;
+				int		scale;
+
+				if (__codegen_numeric_func_precision(func_oid, func_args,
+													 &precision, &scale) &&
+					precision <= NUMERIC_INT64_MAX_PRECISION)
+					kexp.expflags |= KEXP_FLAG__NUMERIC_INT64;
+			}
+			break;
+		default:
+			break;
+	}
 	if (buf)
 		pos = __appendBinaryStringInfo(buf, &kexp, SizeOfKernExpr(0));
 	foreach (lc, func_args)
 	{
 		Expr   *arg = lfirst(lc);
 
+		if (lc != list_head(func_args) &&
+			(dfunc->func_code == FuncOpCode__textregexeq ||
+			 dfunc->func_code == FuncOpCode__textregexne ||
+			 dfunc->func_code == FuncOpCode__texticregexeq ||
+			 dfunc->func_code == FuncOpCode__texticregexne ||
+			 dfunc->func_code == FuncOpCode__regexp_like))
+		{
+			/* regular expression pattern is compiled to DFA */
+			Const	   *con = (Const *)arg;
+			Const	   *dfa;
+			text	   *pattern;
+			bytea	   *dfa_code;
+			const char *errmsg;
+
+			if (!IsA(con, Const) || con->constisnull)
+				__Elog("regular expression pattern must be a constant");
+			pattern = DatumGetTextPP(con->constvalue);
+			dfa_code = pgstrom_regex_compile(VARDATA_ANY(pattern),
+											 VARSIZE_ANY_EXHDR(pattern),
+											 (dfunc->func_code == FuncOpCode__texticregexeq ||
+											  dfunc->func_code == FuncOpCode__texticregexne),
+											 func_collid,
+											 &errmsg);
+			if (!dfa_code)
+				__Elog("regular expression '%s' is not supported on device: %s",
+					   text_to_cstring(pattern), errmsg);
+			dfa = makeConst(BYTEAOID, -1, InvalidOid, -1,
+							PointerGetDatum(dfa_code), false, false);
+			arg = (Expr *)dfa;
+		}
 		if (codegen_expression_walker(context, buf, curr_depth, arg) < 0)
 			return -1;
 	}
@@ -1875,11 +2514,251 @@ __codegen_func_expression(codegen_context *context,
 	return 0;
 }
 
+/*
+ * codegen_simple_expression
+ *
+ * A tree of integer arithmetic / comparison operators that takes only Var,
+ * Const or common sub-expressions as leaves is flatten to SimpleExpr; that
+ * runs the postfix program in a single dispatch, instead of the recursive
+ * invocation of the operator functions for each node.
+ */
+static int
+__simple_expr_operator(devfunc_info *dfunc)
+{
+	static struct {
+		const char *suffix;
+		int			se_op;
+	} simple_ops[] = {
+		{"pl",  SimpleExprOp__Add},
+		{"mi",  SimpleExprOp__Sub},
+		{"mul", SimpleExprOp__Mul},
+		{"eq",  SimpleExprOp__Eq},
+		{"ne",  SimpleExprOp__Ne},
+		{"lt",  SimpleExprOp__Lt},
+		{"le",  SimpleExprOp__Le},
+		{"gt",  SimpleExprOp__Gt},
+		{"ge",  SimpleExprOp__Ge},
+		{NULL, -1},
+	};
+	const char *fname = dfunc->func_name;
+	int			i;
+
+	if (dfunc->func_nargs != 2 ||
+		dfunc->func_extension != NULL ||
+		dfunc->func_inline_expr != NULL ||
+		strncmp(fname, "int", 3) != 0)
+		return -1;
+	for (i=0; i < 2; i++)
+	{
+		TypeOpCode	type_code = dfunc->func_argtypes[i]->type_code;
+
+		if (type_code != TypeOpCode__int2 &&
+			type_code != TypeOpCode__int4 &&
+			type_code != TypeOpCode__int8)
+			return -1;
+	}
+	for (fname += 3; isdigit(*fname); fname++);
+	for (i=0; simple_ops[i].suffix != NULL; i++)
+	{
+		if (strcmp(fname, simple_ops[i].suffix) == 0)
+		{
+			TypeOpCode	type_code = dfunc->func_rettype->type_code;
+
+			if (simple_ops[i].se_op < SimpleExprOp__Eq
+				? (type_code == TypeOpCode__int2 ||
+				   type_code == TypeOpCode__int4 ||
+				   type_code == TypeOpCode__int8)
+				: type_code == TypeOpCode__bool)
+				return simple_ops[i].se_op;
+			break;
+		}
+	}
+	return -1;
+}
+
+static bool
+__codegen_simple_expression_walker(codegen_context *context,
+								   int curr_depth,
+								   Expr *expr,
+								   kern_simple_expr_step *steps,
+								   int *p_nsteps,
+								   int *p_stack_depth,
+								   int *p_stack_max,
+								   int *p_cost)
+{
+	kern_simple_expr_step *step;
+	devfunc_info *dfunc;
+	List	   *func_args;
+	ListCell   *lc;
+	int			se_op;
+
+	if (*p_nsteps >= KERN_SIMPLE_EXPR_MAX_STEPS)
+		return false;
+	step = &steps[*p_nsteps];
+	memset(step, 0, sizeof(kern_simple_expr_step));
+
+	if (IsA(expr, Const))
+	{
+		Const	   *con = (Const *)expr;
+
+		if (con->constisnull)
+			return false;
+		step->se_op = SimpleExprOp__Const;
+		switch (con->consttype)
+		{
+			case INT2OID:
+				step->se_type_code = TypeOpCode__int2;
+				step->se_value = DatumGetInt16(con->constvalue);
+				break;
+			case INT4OID:
+				step->se_type_code = TypeOpCode__int4;
+				step->se_value = DatumGetInt32(con->constvalue);
+				break;
+			case INT8OID:
+				step->se_type_code = TypeOpCode__int8;
+				step->se_value = DatumGetInt64(con->constvalue);
+				break;
+			default:
+				return false;
+		}
+		goto push_leaf;
+	}
+	foreach (lc, context->cse_kvdefs)
+	{
+		codegen_kvar_defitem *kvdef = lfirst(lc);
+
+		if (equal(expr, kvdef->kv_expr))
+			break;
+	}
+	if (IsA(expr, Var) || lc != NULL)
+	{
+		StringInfoData temp;
+		kern_expression *kexp;
+
+		if (exprType((Node *)expr) != INT2OID &&
+			exprType((Node *)expr) != INT4OID &&
+			exprType((Node *)expr) != INT8OID)
+			return false;
+		/* Var and CSE references are written out as VarExpr */
+		initStringInfo(&temp);
+		if (codegen_expression_walker(context, &temp, curr_depth, expr) < 0)
+			return false;
+		kexp = (kern_expression *)temp.data;
+		if (kexp->opcode != FuncOpCode__VarExpr)
+		{
+			pfree(temp.data);
+			return false;
+		}
+		step->se_op = SimpleExprOp__Var;
+		step->se_type_code = kexp->exptype;
+		step->se_slot_id = kexp->u.v.var_slot_id;
+		step->se_var_offset = kexp->u.v.var_offset;
+		pfree(temp.data);
+		goto push_leaf;
+	}
+	if (IsA(expr, OpExpr))
+	{
+		OpExpr	   *op = (OpExpr *)expr;
+
+		dfunc = pgstrom_devfunc_lookup(get_opcode(op->opno),
+									   op->args,
+									   op->inputcollid);
+		func_args = op->args;
+	}
+	else if (IsA(expr, FuncExpr))
+	{
+		FuncExpr   *func = (FuncExpr *)expr;
+
+		dfunc = pgstrom_devfunc_lookup(func->funcid,
+									   func->args,
+									   func->inputcollid);
+		func_args = func->args;
+	}
+	else
+		return false;
+	if (!dfunc ||
+		(dfunc->func_flags & context->xpu_task_flags & DEVKIND__ANY) == 0 ||
+		(se_op = __simple_expr_operator(dfunc)) < 0)
+		return false;
+	foreach (lc, func_args)
+	{
+		if (!__codegen_simple_expression_walker(context, curr_depth,
+												lfirst(lc),
+												steps,
+												p_nsteps,
+												p_stack_depth,
+												p_stack_max,
+												p_cost))
+			return false;
+	}
+	if (*p_nsteps >= KERN_SIMPLE_EXPR_MAX_STEPS)
+		return false;
+	step = &steps[*p_nsteps];
+	memset(step, 0, sizeof(kern_simple_expr_step));
+	step->se_op = se_op;
+	step->se_type_code = dfunc->func_rettype->type_code;
+	*p_nsteps += 1;
+	*p_stack_depth -= 1;
+	*p_cost += dfunc->func_cost;
+	return true;
+
+push_leaf:
+	*p_nsteps += 1;
+	*p_stack_depth += 1;
+	if (*p_stack_depth > KERN_SIMPLE_EXPR_MAX_DEPTH)
+		return false;
+	if (*p_stack_max < *p_stack_depth)
+		*p_stack_max = *p_stack_depth;
+	return true;
+}
+
+static bool
+codegen_simple_expression(codegen_context *context,
+						  StringInfo buf, int curr_depth,
+						  Expr *expr)
+{
+	kern_simple_expr_step steps[KERN_SIMPLE_EXPR_MAX_STEPS];
+	kern_expression *kexp;
+	int			nsteps = 0;
+	int			stack_depth = 0;
+	int			stack_max = 0;
+	int			cost = 0;
+	int			sz, pos;
+
+	if (!buf ||
+		!__codegen_simple_expression_walker(context, curr_depth, expr,
+											steps,
+											&nsteps,
+											&stack_depth,
+											&stack_max,
+											&cost))
+		return false;
+	Assert(nsteps >= 3 && stack_depth == 1);
+	sz = MAXALIGN(offsetof(kern_expression, u.simple.steps[nsteps]));
+	kexp = alloca(sz);
+	memset(kexp, 0, sz);
+	kexp->exptype  = steps[nsteps-1].se_type_code;
+	kexp->expflags = context->kexp_flags;
+	kexp->opcode   = FuncOpCode__SimpleExpr;
+	kexp->nr_args  = 0;
+	kexp->args_offset = sz;
+	kexp->u.simple.nsteps = nsteps;
+	memcpy(kexp->u.simple.steps, steps,
+		   sizeof(kern_simple_expr_step) * nsteps);
+	pos = __appendBinaryStringInfo(buf, kexp, sz);
+	__appendKernExpMagicAndLength(buf, pos);
+	context->device_cost += cost;
+
+	return true;
+}
+
 static int
 codegen_func_expression(codegen_context *context,
 						StringInfo buf, int curr_depth,
 						FuncExpr *func)
 {
+	if (codegen_simple_expression(context, buf, curr_depth, (Expr *)func))
+		return 0;
 	return __codegen_func_expression(context,
 									 buf,
 									 curr_depth,
@@ -1893,6 +2772,8 @@ codegen_oper_expression(codegen_context *context,
 						StringInfo buf, int curr_depth,
 						OpExpr *oper)
 {
+	if (codegen_simple_expression(context, buf, curr_depth, (Expr *)oper))
+		return 0;
 	return __codegen_func_expression(context,
 									 buf,
 									 curr_depth,
@@ -1925,6 +2806,69 @@ codegen_distinct_expression(codegen_context *context,
 	return 0;
 }
 
+/*
+ * __codegen_bool_reorder_arguments
+ *
+ * AND/OR evaluates the arguments from the head, and it stops as soon as the
+ * result is determined. So, we reorder the arguments by the rank; device
+ * cost per probability to determine the result (false for AND, true for OR),
+ * to run the cheap and fail-fast arguments first.
+ * Each argument is built on the temporary buffer to pick up its device cost,
+ * then appended to the @buf by the rank order.
+ */
+typedef struct
+{
+	StringInfoData	code;
+	double			rank;
+} codegen_bool_argument;
+
+static int
+__codegen_bool_reorder_arguments(codegen_context *context,
+								 StringInfo buf, int curr_depth,
+								 BoolExpr *b)
+{
+	int			nargs = list_length(b->args);
+	codegen_bool_argument *bargs = alloca(sizeof(codegen_bool_argument) * nargs);
+	ListCell   *lc;
+	int			i, j;
+
+	i = 0;
+	foreach (lc, b->args)
+	{
+		Expr	   *arg = lfirst(lc);
+		uint32_t	device_cost = context->device_cost;
+		Selectivity	sel = 0.5;
+		double		prob;
+
+		initStringInfo(&bargs[i].code);
+		if (codegen_expression_walker(context, &bargs[i].code,
+									  curr_depth, arg) < 0)
+			return -1;
+		if (context->root)
+			sel = clause_selectivity(context->root, (Node *)arg,
+									 0, JOIN_INNER, NULL);
+		prob = (b->boolop == AND_EXPR ? 1.0 - sel : sel);
+		bargs[i].rank = ((double)(context->device_cost - device_cost + 1) /
+						 Max(prob, 0.0001));
+		/* stable insertion sort by the rank */
+		for (j=i; j > 0 && bargs[j-1].rank > bargs[j].rank; j--)
+		{
+			codegen_bool_argument temp = bargs[j];
+
+			bargs[j] = bargs[j-1];
+			bargs[j-1] = temp;
+		}
+		i++;
+	}
+	for (i=0; i < nargs; i++)
+	{
+		__appendBinaryStringInfo(buf, bargs[i].code.data,
+								 bargs[i].code.len);
+		pfree(bargs[i].code.data);
+	}
+	return 0;
+}
+
 static int
 codegen_bool_expression(codegen_context *context,
 						StringInfo buf, int curr_depth,
@@ -1963,13 +2907,22 @@ codegen_bool_expression(codegen_context *context,
 	kexp.args_offset = SizeOfKernExpr(0);
 	if (buf)
 		pos = __appendBinaryStringInfo(buf, &kexp, SizeOfKernExpr(0));
-	foreach (lc, b->args)
+	if (buf && b->boolop != NOT_EXPR &&
+		!contain_volatile_functions((Node *)b))
 	{
-		Expr   *arg = lfirst(lc);
-
-		if (codegen_expression_walker(context, buf, curr_depth, arg) < 0)
+		if (__codegen_bool_reorder_arguments(context, buf, curr_depth, b) < 0)
 			return -1;
 	}
+	else
+	{
+		foreach (lc, b->args)
+		{
+			Expr   *arg = lfirst(lc);
+
+			if (codegen_expression_walker(context, buf, curr_depth, arg) < 0)
+				return -1;
+		}
+	}
 	if (buf)
 		__appendKernExpMagicAndLength(buf, pos);
 	return 0;
@@ -2462,6 +3415,66 @@ codegen_casewhen_expression(codegen_context *context,
 	return 0;
 }
 
+/*
+ * __codegen_saop_hashtable
+ *
+ * It builds a hash-table of the constant array elements, to avoid linear
+ * search for each row on the large IN-list. Hash values are computed by
+ * the host version of the device type hash function.
+ */
+#define SAOP_HASHTABLE_MIN_NITEMS		16
+
+static void
+__codegen_saop_hashtable(StringInfo buf, int head_pos,
+						 Const *con, devtype_info *dtype_e)
+{
+	ArrayType  *array = DatumGetArrayTypeP(con->constvalue);
+	bits8	   *nullmap = ARR_NULLBITMAP(array);
+	char	   *base = ARR_DATA_PTR(array);
+	char	   *ptr = base;
+	int			nitems = ArrayGetNItems(ARR_NDIM(array), ARR_DIMS(array));
+	uint32_t	nslots = 1;
+	kern_saop_hashtable *htab;
+	kern_saop_hashitem *items;
+	size_t		sz;
+	int			pos;
+
+	while (nslots < nitems)
+		nslots <<= 1;
+	sz = (offsetof(kern_saop_hashtable, slots) +
+		  sizeof(uint32_t) * nslots +
+		  sizeof(kern_saop_hashitem) * nitems);
+	htab = palloc0(sz);
+	htab->nslots = nslots;
+	items = KERN_SAOP_HASHITEMS(htab);
+	for (int i=0; i < nitems; i++)
+	{
+		kern_saop_hashitem *hitem;
+		Datum		value;
+		uint32_t	hash;
+
+		if (nullmap && att_isnull(i, nullmap))
+		{
+			htab->has_nulls = true;
+			continue;
+		}
+		value = fetch_att(ptr, dtype_e->type_byval, dtype_e->type_length);
+		hash = dtype_e->type_hashfunc(false, value);
+
+		hitem = &items[htab->nitems++];
+		hitem->hash = hash;
+		hitem->offset = (ptr - base);
+		hitem->next = htab->slots[hash & (nslots - 1)];
+		htab->slots[hash & (nslots - 1)] = htab->nitems;
+
+		ptr = att_addlength_pointer(ptr, dtype_e->type_length, ptr);
+		ptr = (char *)att_align_nominal(ptr, dtype_e->type_align);
+	}
+	pos = __appendBinaryStringInfo(buf, htab, sz);
+	((kern_expression *)(buf->data + head_pos))->u.saop.hash_offset = pos - head_pos;
+	pfree(htab);
+}
+
 /*
  * codegen_scalar_array_op_expression
  */
@@ -2528,7 +3541,7 @@ codegen_scalar_array_op_expression(codegen_context *context,
 	dfunc = __pgstrom_devfunc_lookup(func_oid,
 									 2, argtypes,
 									 sa_op->inputcollid);
-	if (!dfunc)
+	if (!dfunc || dfunc->func_inline_expr)
 		__Elog("function %s is not device supported",
 			   format_procedure(func_oid));
 	if (dfunc->func_rettype->type_oid != BOOLOID ||
@@ -2602,6 +3615,24 @@ codegen_scalar_array_op_expression(codegen_context *context,
 	if (buf)
 	{
 		__appendKernExpMagicAndLength(buf, __pos);
+		/* hash-table for large constant IN-list */
+		if (sa_op->useOr &&
+			IsA(expr_a, Const) &&
+			!((Const *)expr_a)->constisnull &&
+			!VARATT_IS_EXTENDED(((Const *)expr_a)->constvalue) &&
+			dtype_s->type_oid == dtype_e->type_oid &&
+			dtype_e->type_hashfunc != NULL &&
+			op_hashjoinable(sa_op->opno, dtype_e->type_oid) &&
+			(!OidIsValid(sa_op->inputcollid) ||
+			 get_collation_isdeterministic(sa_op->inputcollid)))
+		{
+			Const	   *con = (Const *)expr_a;
+			ArrayType  *array = DatumGetArrayTypeP(con->constvalue);
+
+			if (ArrayGetNItems(ARR_NDIM(array),
+							   ARR_DIMS(array)) >= SAOP_HASHTABLE_MIN_NITEMS)
+				__codegen_saop_hashtable(buf, pos, con, dtype_e);
+		}
 		__appendKernExpMagicAndLength(buf, pos);
 	}
 	return 0;
@@ -2615,6 +3646,20 @@ codegen_expression_walker(codegen_context *context,
 	if (!expr)
 		return 0;
 
+	if (context->cse_kvdefs != NIL && buf &&
+		!IsA(expr, Const) && !IsA(expr, Var))
+	{
+		ListCell   *lc;
+
+		foreach (lc, context->cse_kvdefs)
+		{
+			codegen_kvar_defitem *kvdef = lfirst(lc);
+
+			if (equal(expr, kvdef->kv_expr))
+				return __codegen_cse_reference(context, buf, kvdef);
+		}
+	}
+
 	switch (nodeTag(expr))
 	{
 		case T_Const:
@@ -2899,6 +3944,377 @@ codegen_build_packed_kvars_move(codegen_context *context, pgstromPlanInfo *pp_in
 	pp_info->kvecs_ndims = context->kvecs_ndims;
 }
 
+/*
+ * Common sub-expression elimination
+ *
+ * Projection and GpuPreAgg evaluate the target-list, grouping-keys and
+ * arguments of the aggregate functions for each row. If an identical
+ * sub-expression appears multiple times there, it is hoisted to a temporary
+ * kvars-slot by SaveExpr prior to the other expressions, then referenced
+ * by VarExpr, so it is evaluated only once per row.
+ * Sub-expressions under CASE, COALESCE and AND/OR are not hoisted, because
+ * these may not be evaluated (or may raise an error if evaluated). Volatile
+ * expressions are not hoisted also.
+ * Scan-quals are not a target, because GPU runs the scan-quals and the
+ * projection on different threads, and the rows are passed by kvec-buffer.
+ *
+ * In addition, if two or more fields (jsonb->KEY or jsonb->>KEY with constant
+ * keys) of the same jsonb object are referenced, they are hoisted together
+ * and fetched by a JsonbObjectFields at once, to avoid walking on the jsonb
+ * object for each key.
+ */
+typedef struct
+{
+	codegen_context *context;
+	List	   *exprs;
+	List	   *counts;
+	List	   *jfields;
+} codegen_cse_context;
+
+/*
+ * __codegen_jsonb_field_reference
+ *
+ * It checks whether the supplied node is jsonb->KEY or jsonb->>KEY with
+ * a constant key, executable on the target device.
+ */
+static bool
+__codegen_jsonb_field_reference(codegen_context *context, Node *node,
+								Expr **p_jexpr, Const **p_key, bool *p_as_text)
+{
+	devfunc_info *dfunc;
+	Oid			func_oid;
+	Oid			func_collid;
+	List	   *func_args;
+	Const	   *key;
+
+	if (IsA(node, FuncExpr))
+	{
+		FuncExpr   *func = (FuncExpr *)node;
+
+		func_oid  = func->funcid;
+		func_args = func->args;
+		func_collid = func->inputcollid;
+	}
+	else if (IsA(node, OpExpr))
+	{
+		OpExpr	   *op = (OpExpr *)node;
+
+		func_oid  = get_opcode(op->opno);
+		func_args = op->args;
+		func_collid = op->inputcollid;
+	}
+	else
+		return false;
+
+	if ((func_oid != F_JSONB_OBJECT_FIELD &&
+		 func_oid != F_JSONB_OBJECT_FIELD_TEXT) ||
+		list_length(func_args) != 2 ||
+		exprType(linitial(func_args)) != JSONBOID ||
+		!IsA(lsecond(func_args), Const) ||
+		contain_volatile_functions(linitial(func_args)))
+		return false;
+	key = lsecond(func_args);
+	if (key->consttype != TEXTOID || key->constisnull)
+		return false;
+	dfunc = pgstrom_devfunc_lookup(func_oid, func_args, func_collid);
+	if (!dfunc ||
+		(dfunc->func_flags & context->xpu_task_flags & DEVKIND__ANY) == 0)
+		return false;
+	if (p_jexpr)
+		*p_jexpr = linitial(func_args);
+	if (p_key)
+		*p_key = key;
+	if (p_as_text)
+		*p_as_text = (func_oid == F_JSONB_OBJECT_FIELD_TEXT);
+	return true;
+}
+
+static bool
+__codegen_cse_collect_walker(Node *node, codegen_cse_context *cse)
+{
+	ListCell   *lc1, *lc2;
+
+	if (!node)
+		return false;
+	if (IsA(node, CaseExpr) ||
+		IsA(node, CoalesceExpr) ||
+		IsA(node, BoolExpr))
+		return false;
+	if ((IsA(node, FuncExpr) ||
+		 IsA(node, OpExpr) ||
+		 IsA(node, DistinctExpr) ||
+		 IsA(node, ScalarArrayOpExpr) ||
+		 IsA(node, CoerceViaIO)) &&
+		!contain_volatile_functions(node) &&
+		pgstrom_devtype_lookup(exprType(node)) != NULL)
+	{
+		forboth (lc1, cse->exprs,
+				 lc2, cse->counts)
+		{
+			if (equal(node, lfirst(lc1)))
+			{
+				lfirst_int(lc2)++;
+				goto next;
+			}
+		}
+		cse->exprs = lappend(cse->exprs, node);
+		cse->counts = lappend_int(cse->counts, 1);
+	}
+next:
+	if (IsA(node, CoerceViaIO))
+	{
+		Node   *arg = (Node *)((CoerceViaIO *)node)->arg;
+
+		/*
+		 * (jsonb->>KEY)::NUMERIC shall be fetched by the special shortcut,
+		 * see codegen_coerceviaio_expression()
+		 */
+		if (__codegen_jsonb_field_reference(cse->context, arg,
+											NULL, NULL, NULL))
+			return expression_tree_walker(arg, __codegen_cse_collect_walker, cse);
+	}
+	else if (__codegen_jsonb_field_reference(cse->context, node,
+											 NULL, NULL, NULL))
+	{
+		if (!list_member(cse->jfields, node))
+			cse->jfields = lappend(cse->jfields, node);
+	}
+	return expression_tree_walker(node, __codegen_cse_collect_walker, cse);
+}
+
+static bool
+__codegen_cse_contains_walker(Node *node, Node *target)
+{
+	if (!node)
+		return false;
+	if (equal(node, target))
+		return true;
+	return expression_tree_walker(node, __codegen_cse_contains_walker, target);
+}
+
+/*
+ * codegen_hoist_common_subexpressions
+ *
+ * It returns the list of kvars-slot for the sub-expressions to be hoisted.
+ */
+static List *
+codegen_hoist_common_subexpressions(codegen_context *context, List *exprs)
+{
+	codegen_cse_context cse;
+	List	   *cse_exprs = NIL;
+	List	   *cse_counts = NIL;
+	List	   *results = NIL;
+	ListCell   *lc1, *lc2, *lc3, *lc4;
+
+	memset(&cse, 0, sizeof(codegen_cse_context));
+	cse.context = context;
+	foreach (lc1, exprs)
+		__codegen_cse_collect_walker(lfirst(lc1), &cse);
+	forboth (lc1, cse.exprs,
+			 lc2, cse.counts)
+	{
+		if (lfirst_int(lc2) > 1)
+		{
+			cse_exprs = lappend(cse_exprs, lfirst(lc1));
+			cse_counts = lappend_int(cse_counts, lfirst_int(lc2));
+		}
+	}
+	/*
+	 * If a sub-expression appears only inside of another common one, it is
+	 * not worth to hoist.
+	 */
+	forboth (lc1, cse_exprs,
+			 lc2, cse_counts)
+	{
+		Node   *expr = lfirst(lc1);
+		bool	redundant = false;
+
+		forboth (lc3, cse_exprs,
+				 lc4, cse_counts)
+		{
+			if (lc3 != lc1 &&
+				lfirst_int(lc2) <= lfirst_int(lc4) &&
+				__codegen_cse_contains_walker(lfirst(lc3), expr))
+			{
+				redundant = true;
+				break;
+			}
+		}
+		if (!redundant)
+			results = lappend(results, expr);
+	}
+	/*
+	 * Multiple fields of the same jsonb object shall be fetched together.
+	 * These are put on the tail, to be saved first.
+	 */
+	foreach (lc1, cse.jfields)
+	{
+		Expr   *jexpr1;
+		Expr   *jexpr2;
+		int		nfields = 0;
+
+		__codegen_jsonb_field_reference(context, lfirst(lc1),
+										&jexpr1, NULL, NULL);
+		foreach (lc2, cse.jfields)
+		{
+			__codegen_jsonb_field_reference(context, lfirst(lc2),
+											&jexpr2, NULL, NULL);
+			if (equal(jexpr1, jexpr2))
+				nfields++;
+		}
+		if (nfields > 1 && !list_member(results, lfirst(lc1)))
+			results = lappend(results, lfirst(lc1));
+	}
+	/*
+	 * Allocation of kvars-slot; the walker visits the parent node first, so
+	 * the inner ones are saved earlier by the reverse order.
+	 */
+	exprs = results;
+	results = NIL;
+	Assert(context->cse_kvdefs == NIL);
+	for (int i = list_length(exprs) - 1; i >= 0; i--)
+	{
+		codegen_kvar_defitem *kvdef;
+
+		kvdef = __try_inject_temporary_expression(context, NULL,
+												  list_nth(exprs, i),
+												  context->num_rels+1,
+												  false);
+		if (kvdef && !list_member_ptr(results, kvdef))
+			results = lappend(results, kvdef);
+	}
+	return results;
+}
+
+/*
+ * __codegen_save_jsonb_object_fields
+ *
+ * It writes out SaveExpr of JsonbObjectFields; that saves the first field
+ * on the kvars-slot by SaveExpr, and the other ones by itself.
+ */
+static void
+__codegen_save_jsonb_object_fields(codegen_context *context,
+								   StringInfo buf,
+								   Expr *jexpr,
+								   List *jfield_kvdefs)
+{
+	codegen_kvar_defitem *kvdef = linitial(jfield_kvdefs);
+	kern_expression	kexp_save;
+	kern_expression *kexp;
+	int			nfields = list_length(jfield_kvdefs);
+	int			sz = MAXALIGN(offsetof(kern_expression,
+									   u.jfields.desc[nfields]));
+	int			pos_save;
+	int			pos;
+	ListCell   *lc;
+
+	Assert(nfields > 1 && nfields <= KERN_JSONB_OBJECT_FIELDS_MAX);
+	memset(&kexp_save, 0, sizeof(kexp_save));
+	kexp_save.exptype  = kvdef->kv_type_code;
+	kexp_save.expflags = context->kexp_flags;
+	kexp_save.opcode   = FuncOpCode__SaveExpr;
+	kexp_save.nr_args  = 1;
+	kexp_save.args_offset = MAXALIGN(offsetof(kern_expression,
+											  u.save.data));
+	kexp_save.u.save.sv_slot_id = kvdef->kv_slot_id;
+	pos_save = __appendBinaryStringInfo(buf, &kexp_save,
+										kexp_save.args_offset);
+
+	kexp = alloca(sz);
+	memset(kexp, 0, sz);
+	kexp->exptype  = kvdef->kv_type_code;
+	kexp->expflags = context->kexp_flags;
+	kexp->opcode   = FuncOpCode__JsonbObjectFields;
+	kexp->nr_args  = nfields + 1;
+	kexp->args_offset = sz;
+	kexp->u.jfields.nfields = nfields;
+	foreach (lc, jfield_kvdefs)
+	{
+		kern_jsonb_field_desc *desc
+			= &kexp->u.jfields.desc[foreach_current_index(lc)];
+		bool	as_text;
+
+		kvdef = lfirst(lc);
+		__codegen_jsonb_field_reference(context, (Node *)kvdef->kv_expr,
+										NULL, NULL, &as_text);
+		desc->jf_slot_id = kvdef->kv_slot_id;
+		desc->jf_as_text = as_text;
+	}
+	pos = __appendBinaryStringInfo(buf, kexp, sz);
+	codegen_expression_walker(context, buf, context->num_rels+1, jexpr);
+	foreach (lc, jfield_kvdefs)
+	{
+		Const  *key;
+
+		kvdef = lfirst(lc);
+		__codegen_jsonb_field_reference(context, (Node *)kvdef->kv_expr,
+										NULL, &key, NULL);
+		codegen_const_expression(context, buf, context->num_rels+1, key);
+	}
+	__appendKernExpMagicAndLength(buf, pos);
+	__appendKernExpMagicAndLength(buf, pos_save);
+}
+
+/*
+ * codegen_save_common_subexpressions
+ *
+ * It writes out SaveExpr of the hoisted sub-expressions, and returns number
+ * of the expressions.
+ */
+static int
+codegen_save_common_subexpressions(codegen_context *context,
+								   StringInfo buf,
+								   List *cse_kvdefs)
+{
+	ListCell   *lc1, *lc2;
+	int			count = 0;
+
+	context->cse_kvdefs = NIL;
+	foreach (lc1, cse_kvdefs)
+	{
+		codegen_kvar_defitem *kvdef = lfirst(lc1);
+		Expr	   *jexpr1;
+		Expr	   *jexpr2;
+
+		if (list_member_ptr(context->cse_kvdefs, kvdef))
+			continue;	/* already fetched by JsonbObjectFields */
+		if (__codegen_jsonb_field_reference(context, (Node *)kvdef->kv_expr,
+											&jexpr1, NULL, NULL))
+		{
+			List   *jfield_kvdefs = list_make1(kvdef);
+
+			for_each_cell (lc2, cse_kvdefs, lnext(cse_kvdefs, lc1))
+			{
+				codegen_kvar_defitem *temp = lfirst(lc2);
+
+				if (list_length(jfield_kvdefs) < KERN_JSONB_OBJECT_FIELDS_MAX &&
+					!list_member_ptr(jfield_kvdefs, temp) &&
+					__codegen_jsonb_field_reference(context, (Node *)temp->kv_expr,
+													&jexpr2, NULL, NULL) &&
+					equal(jexpr1, jexpr2))
+					jfield_kvdefs = lappend(jfield_kvdefs, temp);
+			}
+			if (list_length(jfield_kvdefs) > 1)
+			{
+				__codegen_save_jsonb_object_fields(context, buf, jexpr1,
+												   jfield_kvdefs);
+				context->cse_kvdefs = list_concat(context->cse_kvdefs,
+												  jfield_kvdefs);
+				count++;
+				continue;
+			}
+		}
+		/* the former ones are already available */
+		__try_inject_temporary_expression(context, buf,
+										  kvdef->kv_expr,
+										  context->num_rels+1,
+										  false);
+		context->cse_kvdefs = lappend(context->cse_kvdefs, kvdef);
+		count++;
+	}
+	return count;
+}
+
 /*
  * codegen_build_scan_quals
  */
@@ -2944,6 +4360,12 @@ try_inject_projection_expression(codegen_context *context,
 	kvdef = __try_inject_temporary_expression(context, buf, expr,
 											  context->num_rels+1,
 											  true);
+	/* revert expression if common sub-expression */
+	if (list_member_ptr(context->cse_kvdefs, kvdef))
+	{
+		buf->len = pos;
+		goto bailout;
+	}
 	for (int i=0; i < kexp_proj->u.proj.nattrs; i++)
 	{
 		uint16_t	proj_slot_id = kexp_proj->u.proj.slot_id[i];
@@ -2972,6 +4394,8 @@ codegen_build_projection(codegen_context *context)
 	bool		meet_resjunk = false;
 	int			nattrs = 0;
 	int			sz;
+	List	   *proj_exprs = NIL;
+	List	   *cse_kvdefs;
 	ListCell   *lc;
 
 	/* count nattrs */
@@ -2987,7 +4411,10 @@ codegen_build_projection(codegen_context *context)
 		else if (meet_resjunk)
 			elog(ERROR, "Bug? a valid TLE after junk TLEs");
 		else
+		{
+			proj_exprs = lappend(proj_exprs, tle->expr);
 			nattrs++;
+		}
 	}
 	sz = MAXALIGN(offsetof(kern_expression, u.proj.slot_id[nattrs]));
 	kexp = alloca(sz);
@@ -2995,6 +4422,9 @@ codegen_build_projection(codegen_context *context)
 
 	initStringInfo(&buf);
 	buf.len = sz;
+	cse_kvdefs = codegen_hoist_common_subexpressions(context, proj_exprs);
+	kexp->nr_args += codegen_save_common_subexpressions(context, &buf,
+														cse_kvdefs);
 	foreach (lc, context->tlist_dev)
 	{
 		TargetEntry	*tle = lfirst(lc);
@@ -3009,6 +4439,7 @@ codegen_build_projection(codegen_context *context)
 		kexp->u.proj.slot_id[kexp->u.proj.nattrs++] = kvdef->kv_slot_id;
 	}
 	Assert(nattrs == kexp->u.proj.nattrs);
+	context->cse_kvdefs = NIL;
 	kexp->exptype = TypeOpCode__int4;
 	kexp->expflags = context->kexp_flags;
 	kexp->opcode  = FuncOpCode__Projection;
@@ -3434,6 +4865,70 @@ codegen_build_packed_gistevals(codegen_context *context,
 	pp_info->kexp_gist_evals_packed = result;
 }
 
+/*
+ * codegen_build_packed_rangekeys
+ *
+ * It packs the outer key of the range-join clause for each depth; the GPU
+ * kernel evaluates it to find the head of the candidate inner tuples on
+ * the sorted row-index.
+ */
+bytea *
+codegen_build_packed_rangekeys(codegen_context *context,
+							   List *stacked_range_keys)
+{
+	kern_expression *kexp;
+	StringInfoData buf;
+	int			depth;
+	int			nrels;
+	size_t		sz;
+	ListCell   *lc;
+	char	   *result = NULL;
+
+	nrels = list_length(stacked_range_keys);
+	sz = MAXALIGN(offsetof(kern_expression, u.pack.offset[nrels+1]));
+	kexp = alloca(sz);
+	memset(kexp, 0, sz);
+	kexp->exptype = TypeOpCode__int4;
+	kexp->expflags = context->kexp_flags;
+	kexp->opcode  = FuncOpCode__Packed;
+	kexp->args_offset = sz;
+	kexp->u.pack.npacked = nrels + 1;
+
+	initStringInfo(&buf);
+	buf.len = sz;
+
+	depth = 1;
+	foreach (lc, stacked_range_keys)
+	{
+		Expr   *range_key = lfirst(lc);
+		StringInfoData temp;
+
+		if (range_key)
+		{
+			initStringInfo(&temp);
+			codegen_expression_walker(context, &temp, depth, range_key);
+			kexp->u.pack.offset[depth]
+				= __appendBinaryStringInfo(&buf, temp.data, temp.len);
+			kexp->nr_args++;
+			pfree(temp.data);
+		}
+		depth++;
+	}
+	Assert(depth == nrels+1);
+
+	if (kexp->nr_args > 0)
+	{
+		memcpy(buf.data, kexp, sz);
+		__appendKernExpMagicAndLength(&buf, 0);
+		result = palloc(VARHDRSZ + buf.len);
+		memcpy(result + VARHDRSZ, buf.data, buf.len);
+		SET_VARSIZE(result, VARHDRSZ + buf.len);
+	}
+	pfree(buf.data);
+
+	return (bytea *)result;
+}
+
 /*
  * codegen_build_groupby_keyhash
  */
@@ -3683,12 +5178,19 @@ try_inject_groupby_expression(codegen_context *context,
 	kvdef = __try_inject_temporary_expression(context, buf, expr,
 											  context->num_rels+1,
 											  false);
+	/* revert expression if common sub-expression */
+	if (list_member_ptr(context->cse_kvdefs, kvdef))
+	{
+		buf->len = pos;
+		goto bailout;
+	}
 	for (int i=0; i < kexp_pagg->u.pagg.nattrs; i++)
 	{
 		const kern_aggregate_desc *desc = &kexp_pagg->u.pagg.desc[i];
 
 		if (desc->arg0_slot_id == kvdef->kv_slot_id ||
-			(desc->action == KAGG_ACTION__COVAR &&
+			((desc->action == KAGG_ACTION__COVAR ||
+			  desc->action == KAGG_ACTION__STRING_AGG) &&
 			 desc->arg1_slot_id == kvdef->kv_slot_id))
 		{
 			buf->len = pos;
@@ -3705,7 +5207,8 @@ bailout:
  */
 static void
 __codegen_build_groupby_actions(codegen_context *context,
-								pgstromPlanInfo *pp_info)
+								pgstromPlanInfo *pp_info,
+								List *cse_kvdefs)
 {
 	StringInfoData	buf;
 	int			nattrs = list_length(pp_info->groupby_actions);
@@ -3724,6 +5227,8 @@ __codegen_build_groupby_actions(codegen_context *context,
 
 	initStringInfo(&buf);
 	buf.len = head_sz;
+	kexp->nr_args += codegen_save_common_subexpressions(context, &buf,
+														cse_kvdefs);
 	forboth (lc1, context->tlist_dev,
 			 lc2, pp_info->groupby_actions)
 	{
@@ -3751,6 +5256,22 @@ __codegen_build_groupby_actions(codegen_context *context,
 
 			Assert(IsA(func, FuncExpr) && list_length(func->args) <= 2);
 			desc->action = action;
+			if (action == KAGG_ACTION__HLL_SKETCH)
+				desc->hll_nbits = pgstrom_hll_register_bits;
+			if (action == KAGG_ACTION__PSUM_NUMERIC ||
+				action == KAGG_ACTION__PAVG_NUMERIC)
+			{
+				int32	typmod = exprTypmod(linitial(func->args));
+
+				/*
+				 * Any values of numeric(p,s) can be accumulated on the slot
+				 * with weight 's', so we assign it preliminarily.
+				 */
+				if (typmod >= (int32)VARHDRSZ)
+					desc->num_weight = ((((typmod - VARHDRSZ) & 0x7ff) ^ 1024) - 1024);
+				else
+					desc->num_weight = KAGG_NUMERIC_WEIGHT__UNUSED;
+			}
 			foreach (cell, func->args)
 			{
 				Expr   *fn_arg = lfirst(cell);
@@ -3771,6 +5292,7 @@ __codegen_build_groupby_actions(codegen_context *context,
 		}
 		kexp->u.pagg.nattrs++;
 	}
+	context->cse_kvdefs = NIL;
 	memcpy(buf.data, kexp, head_sz);
 	__appendKernExpMagicAndLength(&buf, 0);
 
@@ -3791,17 +5313,41 @@ codegen_build_groupby_actions(codegen_context *context,
 {
 	List   *groupby_keys_input;
 	List   *groupby_keys_final;
+	List   *groupby_exprs = NIL;
+	List   *cse_kvdefs;
+	ListCell *lc1, *lc2;
 
 	Assert(pp_info->groupby_actions != NIL &&
 		   list_length(pp_info->groupby_actions) <= list_length(context->tlist_dev));
+	/*
+	 * GpuPreAgg runs SaveExpr of the groupby-actions prior to the keyhash,
+	 * so common sub-expressions are hoisted to the groupby-actions.
+	 */
+	forboth (lc1, context->tlist_dev,
+			 lc2, pp_info->groupby_actions)
+	{
+		TargetEntry *tle = lfirst(lc1);
+		int			action = lfirst_int(lc2);
+
+		if (action == KAGG_ACTION__VREF ||
+			action == KAGG_ACTION__VREF_NOKEY)
+			groupby_exprs = lappend(groupby_exprs, tle->expr);
+		else
+			groupby_exprs = list_concat(groupby_exprs,
+										((FuncExpr *)tle->expr)->args);
+	}
+	cse_kvdefs = codegen_hoist_common_subexpressions(context, groupby_exprs);
+
+	context->cse_kvdefs = cse_kvdefs;
 	groupby_keys_input = codegen_build_groupby_keyhash(context, pp_info);
+	context->cse_kvdefs = NIL;
 	groupby_keys_final = codegen_build_groupby_keyload(context, pp_info);
 	if (groupby_keys_input != NIL &&
 		groupby_keys_final != NIL)
 		codegen_build_groupby_keycomp(context, pp_info,
 									  groupby_keys_input,
 									  groupby_keys_final);
-	__codegen_build_groupby_actions(context, pp_info);
+	__codegen_build_groupby_actions(context, pp_info, cse_kvdefs);
 }
 
 /*
@@ -4202,6 +5748,18 @@ __xpucode_aggfuncs_cstring(StringInfo buf,
 								 __get_expression_cstring(css, dcontext,
 														  desc->arg0_slot_id));
 				break;
+			case KAGG_ACTION__PSUM_NUMERIC:
+				appendStringInfo(buf, "psum::numeric[slot=%d, expr='%s']",
+								 desc->arg0_slot_id,
+								 __get_expression_cstring(css, dcontext,
+														  desc->arg0_slot_id));
+				break;
+			case KAGG_ACTION__PAVG_NUMERIC:
+				appendStringInfo(buf, "pavg::numeric[slot=%d, expr='%s']",
+								 desc->arg0_slot_id,
+								 __get_expression_cstring(css, dcontext,
+														  desc->arg0_slot_id));
+				break;
 			case KAGG_ACTION__STDDEV:
 				appendStringInfo(buf, "stddev[slot=%d, expr='%s']",
 								 desc->arg0_slot_id,
@@ -4217,6 +5775,28 @@ __xpucode_aggfuncs_cstring(StringInfo buf,
 								 __get_expression_cstring(css, dcontext,
 														  desc->arg1_slot_id));
 				break;
+			case KAGG_ACTION__HLL_SKETCH:
+				appendStringInfo(buf, "hll_sketch[slot=%d, nbits=%d, expr='%s']",
+								 desc->arg0_slot_id,
+								 desc->hll_nbits,
+								 __get_expression_cstring(css, dcontext,
+														  desc->arg0_slot_id));
+				break;
+			case KAGG_ACTION__QUANTILE_SKETCH:
+				appendStringInfo(buf, "quantile_sketch[slot=%d, expr='%s']",
+								 desc->arg0_slot_id,
+								 __get_expression_cstring(css, dcontext,
+														  desc->arg0_slot_id));
+				break;
+			case KAGG_ACTION__STRING_AGG:
+				appendStringInfo(buf, "string_agg[slot0=%d, expr0='%s', slot1=%d, expr1='%s']",
+								 desc->arg0_slot_id,
+								 __get_expression_cstring(css, dcontext,
+														  desc->arg0_slot_id),
+								 desc->arg1_slot_id,
+								 __get_expression_cstring(css, dcontext,
+														  desc->arg1_slot_id));
+				break;
 			default:
 				appendStringInfo(buf, "unknown[slot0=%d, expr0='%s', slot1=%d, expr1='%s']",
 								 desc->arg0_slot_id,
@@ -4306,6 +5886,42 @@ __xpucode_to_cstring(StringInfo buf,
 		case FuncOpCode__AggFuncs:
 			__xpucode_aggfuncs_cstring(buf, kexp, css, es, dcontext);
 			break;
+		case FuncOpCode__JsonbObjectFields:
+			appendStringInfo(buf, "{JsonbObjectFields: <");
+			for (i=0; i < kexp->u.jfields.nfields; i++)
+			{
+				const kern_jsonb_field_desc *desc = &kexp->u.jfields.desc[i];
+
+				appendStringInfo(buf, "%sslot=%d%s",
+								 i > 0 ? ", " : "",
+								 desc->jf_slot_id,
+								 desc->jf_as_text ? " (text)" : "");
+			}
+			appendStringInfo(buf, ">");
+			break;
+		case FuncOpCode__SimpleExpr:
+			appendStringInfo(buf, "{SimpleExpr: <");
+			for (i=0; i < kexp->u.simple.nsteps; i++)
+			{
+				const kern_simple_expr_step *step = &kexp->u.simple.steps[i];
+				static const char *se_opnames[] = {
+					NULL, NULL, NULL, "+", "-", "*",
+					"=", "<>", "<", "<=", ">", ">=",
+				};
+
+				if (i > 0)
+					appendStringInfoChar(buf, ' ');
+				if (step->se_op == SimpleExprOp__Var)
+					appendStringInfo(buf, "slot=%d", step->se_slot_id);
+				else if (step->se_op == SimpleExprOp__Const)
+					appendStringInfo(buf, "%ld", step->se_value);
+				else if (step->se_op < lengthof(se_opnames))
+					appendStringInfo(buf, "%s", se_opnames[step->se_op]);
+				else
+					appendStringInfo(buf, "???");
+			}
+			appendStringInfo(buf, ">");
+			break;
 		case FuncOpCode__Packed:
 			appendStringInfo(buf, "{Packed");
 			pos = buf->len;
@@ -4427,6 +6043,14 @@ __xpucode_to_cstring(StringInfo buf,
 				appendStringInfo(buf, ", type='%s'",
 								 devtype_get_name_by_opcode(kvdef->kv_type_code));
 			appendStringInfoChar(buf, '>');
+			if (kexp->u.saop.hash_offset != 0)
+			{
+				const kern_saop_hashtable *htab = (const kern_saop_hashtable *)
+					((const char *)kexp + kexp->u.saop.hash_offset);
+
+				appendStringInfo(buf, ", hash=<nitems=%u, nslots=%u>",
+								 htab->nitems, htab->nslots);
+			}
 			break;
 
 		default:
@@ -4690,6 +6314,7 @@ pgstrom_devcache_invalidator(Datum arg, int cacheid, uint32 hashvalue)
 	__type_oid_cache_int1	= UINT_MAX;
 	__type_oid_cache_float2	= UINT_MAX;
 	__type_oid_cache_cube	= UINT_MAX;
+	__type_oid_cache_geometry = UINT_MAX;
 }
 
 void
@@ -4698,6 +6323,15 @@ pgstrom_init_codegen(void)
 	devinfo_memcxt = AllocSetContextCreate(CacheMemoryContext,
 										   "device type/func info cache",
 										   ALLOCSET_DEFAULT_SIZES);
+	/* pg_strom.enable_inline_sql_functions */
+	DefineCustomBoolVariable("pg_strom.enable_inline_sql_functions",
+							 "Enables to run immutable SQL functions on the device by inlining",
+							 NULL,
+							 &pgstrom_enable_inline_sql_functions,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
 	pgstrom_devcache_invalidator(0, 0, 0);
 	CacheRegisterSyscacheCallback(TYPEOID, pgstrom_devcache_invalidator, 0);
 	CacheRegisterSyscacheCallback(PROCOID, pgstrom_devcache_invalidator, 0);
@@ -0,0 +1,404 @@
+/*
+ * cost_calib.c
+ *
+ * Calibration of the GPU/DPU cost constants according to the recorded
+ * execution statistics.
+ * ----
+ * Copyright 2011-2023 (C) KaiGai Kohei <kaigai@kaigai.gr.jp>
+ * Copyright 2014-2023 (C) PG-Strom Developers Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the PostgreSQL License.
+ */
+#include "pg_strom.h"
+
+/*
+ * Calibration model
+ *
+ * The cost of a plan is an abstract number, but the planner assumes it is
+ * proportional to the execution time. We keep the ratio of the elapsed time
+ * per cost unit for the queries without xPU tasks (the reference), and for
+ * each xPU task node by the device kind and the workload class.
+ * If xPU task nodes take longer (or shorter) time per cost unit than the
+ * reference, the cost constants of the device are underestimated (or
+ * overestimated), so the calibration factor is adjusted to the direction
+ * to eliminate the gap. The factor is damped, because the samples are
+ * measured on the plans already calibrated by the previous factor.
+ *
+ * The factor is multiplied to pg_strom.(gpu|dpu)_operator_cost and
+ * pg_strom.(gpu|dpu)_tuple_cost on the path construction.
+ */
+#define COST_CALIB_DEVKIND_GPU		0
+#define COST_CALIB_DEVKIND_DPU		1
+#define COST_CALIB_NUM_DEVKINDS		2
+#define COST_CALIB_WORKLOAD_SCAN	0
+#define COST_CALIB_WORKLOAD_JOIN	1
+#define COST_CALIB_WORKLOAD_PREAGG	2
+#define COST_CALIB_NUM_WORKLOADS	3
+
+#define COST_CALIB_EWMA_ALPHA		0.1		/* weight of the new sample */
+#define COST_CALIB_DAMPING			0.2		/* exponent of the adjustment */
+#define COST_CALIB_MIN_SAMPLES		10		/* samples before apply */
+#define COST_CALIB_MIN_PLAN_COST	1000.0	/* ignore too small plans */
+#define COST_CALIB_FACTOR_MIN		0.01
+#define COST_CALIB_FACTOR_MAX		100.0
+
+typedef struct
+{
+	int64		nsamples;
+	double		usec_per_cost;	/* EWMA of elapsed time per cost unit */
+	double		factor;			/* calibration factor (xPU only) */
+} costCalibEntry;
+
+typedef struct
+{
+	slock_t		lock;
+	costCalibEntry cpu;			/* reference; queries without xPU tasks */
+	costCalibEntry xpu[COST_CALIB_NUM_DEVKINDS][COST_CALIB_NUM_WORKLOADS];
+} costCalibSharedState;
+
+/* static variables */
+static costCalibSharedState *cost_calib_shared_state = NULL;
+static shmem_request_hook_type shmem_request_next = NULL;
+static shmem_startup_hook_type shmem_startup_next = NULL;
+static ExecutorRun_hook_type executor_run_next = NULL;
+static int		cost_calib_nesting_level = 0;
+bool			pgstrom_cost_calibration;	/* GUC */
+
+/*
+ * __costCalibIndex
+ */
+static bool
+__costCalibIndex(uint32_t xpu_task_flags, int *p_devkind, int *p_workload)
+{
+	if ((xpu_task_flags & DEVKIND__ANY) == DEVKIND__NVIDIA_GPU)
+		*p_devkind = COST_CALIB_DEVKIND_GPU;
+	else if ((xpu_task_flags & DEVKIND__ANY) == DEVKIND__NVIDIA_DPU)
+		*p_devkind = COST_CALIB_DEVKIND_DPU;
+	else
+		return false;
+
+	if ((xpu_task_flags & DEVTASK__PREAGG) != 0)
+		*p_workload = COST_CALIB_WORKLOAD_PREAGG;
+	else if ((xpu_task_flags & DEVTASK__JOIN) != 0)
+		*p_workload = COST_CALIB_WORKLOAD_JOIN;
+	else
+		*p_workload = COST_CALIB_WORKLOAD_SCAN;
+	return true;
+}
+
+/*
+ * __costCalibUpdateEntry
+ */
+static void
+__costCalibUpdateEntry(costCalibEntry *entry, double usec_per_cost)
+{
+	if (entry->nsamples == 0)
+		entry->usec_per_cost = usec_per_cost;
+	else
+		entry->usec_per_cost = (COST_CALIB_EWMA_ALPHA * usec_per_cost +
+								(1.0 - COST_CALIB_EWMA_ALPHA) * entry->usec_per_cost);
+	entry->nsamples++;
+}
+
+/*
+ * pgstromCostCalibrationFactor
+ *
+ * It returns the factor to be multiplied to the cost constants of the device
+ * for the workload class, or 1.0 if no calibration.
+ */
+double
+pgstromCostCalibrationFactor(uint32_t devkind, uint32_t devtask)
+{
+	costCalibEntry *entry;
+	int			__devkind;
+	int			__workload;
+	double		factor = 1.0;
+
+	if (!pgstrom_cost_calibration || !cost_calib_shared_state ||
+		!__costCalibIndex(devkind | devtask, &__devkind, &__workload))
+		return 1.0;
+	entry = &cost_calib_shared_state->xpu[__devkind][__workload];
+	SpinLockAcquire(&cost_calib_shared_state->lock);
+	if (entry->nsamples >= COST_CALIB_MIN_SAMPLES)
+		factor = entry->factor;
+	SpinLockRelease(&cost_calib_shared_state->lock);
+
+	return factor;
+}
+
+/*
+ * pgstromCostCalibrationRecordTask
+ *
+ * It records the elapsed time of the xPU task node (from the first call to
+ * the end of the scan) towards its estimated cost.
+ */
+void
+pgstromCostCalibrationRecordTask(pgstromTaskState *pts, uint64_t elapsed_us)
+{
+	Plan	   *plan = pts->css.ss.ps.plan;
+	costCalibEntry *entry;
+	costCalibEntry *cpu;
+	int			devkind;
+	int			workload;
+	double		usec_per_cost;
+
+	if (!pgstrom_cost_calibration || !cost_calib_shared_state ||
+		plan->total_cost < COST_CALIB_MIN_PLAN_COST ||
+		!__costCalibIndex(pts->xpu_task_flags, &devkind, &workload))
+		return;
+	usec_per_cost = (double)elapsed_us / plan->total_cost;
+
+	SpinLockAcquire(&cost_calib_shared_state->lock);
+	entry = &cost_calib_shared_state->xpu[devkind][workload];
+	cpu = &cost_calib_shared_state->cpu;
+	__costCalibUpdateEntry(entry, usec_per_cost);
+	if (cpu->nsamples >= COST_CALIB_MIN_SAMPLES &&
+		cpu->usec_per_cost > 0.0)
+	{
+		double	gap = usec_per_cost / cpu->usec_per_cost;
+
+		entry->factor *= pow(gap, COST_CALIB_DAMPING);
+		entry->factor = Max(entry->factor, COST_CALIB_FACTOR_MIN);
+		entry->factor = Min(entry->factor, COST_CALIB_FACTOR_MAX);
+	}
+	SpinLockRelease(&cost_calib_shared_state->lock);
+}
+
+/*
+ * __planStateHasXpuTask
+ */
+static bool
+__planStateHasXpuTask(PlanState *ps, void *context)
+{
+	if (IsA(ps, CustomScanState) &&
+		((CustomScanState *)ps)->methods->ExecCustomScan == pgstromExecTaskState)
+		return true;
+	return planstate_tree_walker(ps, __planStateHasXpuTask, context);
+}
+
+/*
+ * pgstrom_cost_calib_executor_run
+ *
+ * It records the elapsed time of the top-level queries without xPU
+ * tasks, as the reference of the calibration.
+ */
+static void
+pgstrom_cost_calib_executor_run(QueryDesc *queryDesc,
+								ScanDirection direction,
+								uint64 count,
+								bool execute_once)
+{
+	uint64_t	ts_begin = monotonic_clock_us();
+
+	cost_calib_nesting_level++;
+	PG_TRY();
+	{
+		if (executor_run_next)
+			executor_run_next(queryDesc, direction, count, execute_once);
+		else
+			standard_ExecutorRun(queryDesc, direction, count, execute_once);
+	}
+	PG_FINALLY();
+	{
+		cost_calib_nesting_level--;
+	}
+	PG_END_TRY();
+
+	if (pgstrom_cost_calibration &&
+		cost_calib_shared_state &&
+		cost_calib_nesting_level == 0 &&
+		!IsParallelWorker() &&
+		queryDesc->operation == CMD_SELECT &&
+		count == 0 &&
+		ScanDirectionIsForward(direction) &&
+		queryDesc->plannedstmt->planTree->total_cost >= COST_CALIB_MIN_PLAN_COST &&
+		!__planStateHasXpuTask(queryDesc->planstate, NULL))
+	{
+		double	usec_per_cost = ((double)(monotonic_clock_us() - ts_begin) /
+								 queryDesc->plannedstmt->planTree->total_cost);
+
+		SpinLockAcquire(&cost_calib_shared_state->lock);
+		__costCalibUpdateEntry(&cost_calib_shared_state->cpu, usec_per_cost);
+		SpinLockRelease(&cost_calib_shared_state->lock);
+	}
+}
+
+/*
+ * pgstrom_cost_calibration_info - SQL function to dump the calibration status
+ */
+PG_FUNCTION_INFO_V1(pgstrom_cost_calibration_info);
+PUBLIC_FUNCTION(Datum)
+pgstrom_cost_calibration_info(PG_FUNCTION_ARGS)
+{
+	static const char *devkind_labels[] = { "GPU", "DPU" };
+	static const char *workload_labels[] = { "scan", "join", "preagg" };
+	FuncCallContext *fncxt;
+	costCalibEntry entry;
+	int			index;
+	Datum		values[5];
+	bool		isnull[5];
+	HeapTuple	tuple;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		TupleDesc		tupdesc;
+		MemoryContext	oldcxt;
+
+		fncxt = SRF_FIRSTCALL_INIT();
+		oldcxt = MemoryContextSwitchTo(fncxt->multi_call_memory_ctx);
+
+		tupdesc = CreateTemplateTupleDesc(5);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 1, "device",
+						   TEXTOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 2, "workload",
+						   TEXTOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 3, "nsamples",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 4, "usec_per_cost",
+						   FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 5, "factor",
+						   FLOAT8OID, -1, 0);
+		fncxt->tuple_desc = BlessTupleDesc(tupdesc);
+
+		fncxt->user_fctx = 0;
+
+		MemoryContextSwitchTo(oldcxt);
+	}
+	fncxt = SRF_PERCALL_SETUP();
+
+	/* the first row is the reference, then xPU for each workload */
+	index = fncxt->call_cntr;
+	if (!cost_calib_shared_state ||
+		index > COST_CALIB_NUM_DEVKINDS * COST_CALIB_NUM_WORKLOADS)
+		SRF_RETURN_DONE(fncxt);
+
+	SpinLockAcquire(&cost_calib_shared_state->lock);
+	if (index == 0)
+		memcpy(&entry, &cost_calib_shared_state->cpu, sizeof(costCalibEntry));
+	else
+		memcpy(&entry, &cost_calib_shared_state->xpu[(index-1) / COST_CALIB_NUM_WORKLOADS]
+													[(index-1) % COST_CALIB_NUM_WORKLOADS],
+			   sizeof(costCalibEntry));
+	SpinLockRelease(&cost_calib_shared_state->lock);
+
+	memset(isnull, 0, sizeof(isnull));
+	if (index == 0)
+	{
+		values[0] = CStringGetTextDatum("CPU");
+		isnull[1] = true;
+	}
+	else
+	{
+		values[0] = CStringGetTextDatum(devkind_labels[(index-1) / COST_CALIB_NUM_WORKLOADS]);
+		values[1] = CStringGetTextDatum(workload_labels[(index-1) % COST_CALIB_NUM_WORKLOADS]);
+	}
+	values[2] = Int64GetDatum(entry.nsamples);
+	if (entry.nsamples > 0)
+		values[3] = Float8GetDatum(entry.usec_per_cost);
+	else
+		isnull[3] = true;
+	if (index > 0)
+		values[4] = Float8GetDatum(entry.factor);
+	else
+		isnull[4] = true;
+
+	tuple = heap_form_tuple(fncxt->tuple_desc, values, isnull);
+
+	SRF_RETURN_NEXT(fncxt, HeapTupleGetDatum(tuple));
+}
+
+/*
+ * __costCalibResetSharedState
+ */
+static void
+__costCalibResetSharedState(void)
+{
+	memset(&cost_calib_shared_state->cpu, 0, sizeof(costCalibEntry));
+	for (int i=0; i < COST_CALIB_NUM_DEVKINDS; i++)
+	{
+		for (int j=0; j < COST_CALIB_NUM_WORKLOADS; j++)
+		{
+			costCalibEntry *entry = &cost_calib_shared_state->xpu[i][j];
+
+			entry->nsamples = 0;
+			entry->usec_per_cost = 0.0;
+			entry->factor = 1.0;
+		}
+	}
+}
+
+/*
+ * pgstrom_cost_calibration_reset - SQL function to discard the calibration
+ */
+PG_FUNCTION_INFO_V1(pgstrom_cost_calibration_reset);
+PUBLIC_FUNCTION(Datum)
+pgstrom_cost_calibration_reset(PG_FUNCTION_ARGS)
+{
+	if (!superuser())
+		ereport(ERROR,
+				(errcode(ERRCODE_INSUFFICIENT_PRIVILEGE),
+				 errmsg("only superuser can reset the cost calibration")));
+	if (cost_calib_shared_state)
+	{
+		SpinLockAcquire(&cost_calib_shared_state->lock);
+		__costCalibResetSharedState();
+		SpinLockRelease(&cost_calib_shared_state->lock);
+	}
+	PG_RETURN_VOID();
+}
+
+/*
+ * pgstrom_request_cost_calib
+ */
+static void
+pgstrom_request_cost_calib(void)
+{
+	if (shmem_request_next)
+		shmem_request_next();
+	RequestAddinShmemSpace(MAXALIGN(sizeof(costCalibSharedState)));
+}
+
+/*
+ * pgstrom_startup_cost_calib
+ */
+static void
+pgstrom_startup_cost_calib(void)
+{
+	bool		found;
+
+	if (shmem_startup_next)
+		shmem_startup_next();
+	cost_calib_shared_state = ShmemInitStruct("PG-Strom Cost Calibration",
+											  MAXALIGN(sizeof(costCalibSharedState)),
+											  &found);
+	if (!found)
+	{
+		SpinLockInit(&cost_calib_shared_state->lock);
+		__costCalibResetSharedState();
+	}
+}
+
+/*
+ * pgstrom_init_cost_calib
+ */
+void
+pgstrom_init_cost_calib(void)
+{
+	DefineCustomBoolVariable("pg_strom.cost_calibration",
+							 "Enables calibration of xPU cost constants by the recorded execution stats",
+							 NULL,
+							 &pgstrom_cost_calibration,
+							 false,
+							 PGC_SUSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* shared memory */
+	shmem_request_next = shmem_request_hook;
+	shmem_request_hook = pgstrom_request_cost_calib;
+	shmem_startup_next = shmem_startup_hook;
+	shmem_startup_hook = pgstrom_startup_cost_calib;
+	/* executor hook */
+	executor_run_next = ExecutorRun_hook;
+	ExecutorRun_hook = pgstrom_cost_calib_executor_run;
+}
@@ -56,6 +56,16 @@ STROM_WRITEBACK_ERROR_STATUS(kern_errorbuf *ebuf, kern_context *kcxt)
 				  KERN_ERRORBUF_MESSAGE_LEN);
 	}
 }
+
+/* nanoseconds of the global timer, common to all the SMs */
+INLINE_FUNCTION(uint64_t)
+__globaltimer(void)
+{
+	uint64_t	ts;
+
+	asm volatile("mov.u64 %0, %%globaltimer;" : "=l"(ts));
+	return ts;
+}
 #endif	/* __CUDACC__ */
 
 /* ----------------------------------------------------------------
@@ -70,6 +80,7 @@ typedef struct
 {
 	uint32_t		smx_row_count;	/* current position of outer relation */
 	int				scan_done;	/* smallest depth that may produce more tuples */
+	int				stats_done;	/* statistics are already counted */
 	/* only KDS_FORMAT_BLOCK */
 	uint32_t		block_id;	/* BLOCK format needs to keep htuples on the */
 	uint32_t		lp_count;	/* lp_items array once, to pull maximum GPU */
@@ -107,6 +118,8 @@ typedef struct
 /*
  * Definitions related to GpuScan/GpuJoin/GpuPreAgg
  */
+#define GPUTASK_KDS_DST_POOL_NSLOTS		8
+
 typedef struct {
 	kern_errorbuf	kerror;
 	uint32_t		grid_sz;
@@ -119,9 +132,18 @@ typedef struct {
 	uint32_t		n_rels;			/* >0, if JOIN is involved */
 	uint32_t		groupby_prepfn_bufsz;
 	uint32_t		groupby_prepfn_nbufs;
+	uint32_t		groupby_local_nslots;	/* local hash-slots, if any */
 	/* suspend/resume support */
 	bool			resume_context;
 	uint32_t		suspend_count;
+	uint32_t		yield_count;	/* # of blocks yielded by the time-slice */
+	uint64_t		time_slice_ns;	/* time-slice of the kernel, or 0 */
+	/* pre-reserved destination buffers; kernel can switch by itself */
+	uint32_t		kds_dst_nrooms;	/* number of valid kds_dst_pool[] */
+	uint32_t		kds_dst_index;	/* index of the kds_dst in use */
+	kern_data_store *kds_dst_pool[GPUTASK_KDS_DST_POOL_NSLOTS];
+	/* REDO logs of GpuCache not applied yet (merge-on-read), if any */
+	struct kern_gpucache_delta *gcache_delta;
 	/* kernel statistics */
 	uint32_t		nitems_raw;		/* nitems in the raw data chunk */
 	uint32_t		nitems_in;		/* nitems after the scan_quals */
@@ -207,6 +229,7 @@ execGpuScanLoadSource(kern_context *kcxt,
 					  kern_warp_context *wp,
 					  const kern_data_store *kds_src,
 					  const kern_data_extra *kds_extra,
+					  const struct kern_gpucache_delta *gcache_delta,
 					  const kern_expression *kexp_load_vars,
 					  const kern_expression *kexp_scan_quals,
 					  const kern_expression *kexp_move_vars,
@@ -234,6 +257,57 @@ EXTERN_FUNCTION(void)
 mergeGpuPreAggGroupByBuffer(kern_context *kcxt,
 							kern_data_store *kds_final);
 
+/*
+ * Definitions related to GPU Top-N selection / GPU Sort
+ *
+ * The leading sort key is normalized to the order-preserving 64bit key;
+ * the smaller key is always the better one.
+ *
+ * The results of GpuScan/GpuJoin under ORDER BY ... LIMIT N are reduced
+ * to the rows whose key is equal to, or better than the N-th key of the
+ * chunk. The N-th key is determined by the radix-select, 8bits per pass
+ * from the MSB.
+ * GPU Sort sorts the row-index of each destination chunk by the key,
+ * using the LSD radix sort (1bit per pass; only the bits that are not
+ * common for all the keys), then the backend merges the sorted chunks.
+ * If GPU Sort has the second key, the chunk is sorted by the second key
+ * first, then by the leading key; the LSD radix sort is stable, so the
+ * rows are ordered by the both keys.
+ */
+#define GPUTOPK_MAX_NITEMS			100000
+#define KERN_SORTKEY__FLOAT_KEY		0x0001	/* float4/float8 key, elsewhere integer */
+#define KERN_SORTKEY__DESC			0x0002	/* descending order */
+#define KERN_SORTKEY__NULLS_FIRST	0x0004	/* NULLs come first */
+
+typedef struct {
+	int16_t			sortkey_resno;	/* attribute number of the sort key */
+	int16_t			sortkey_flags;	/* KERN_SORTKEY__* flags */
+	uint32_t		topk_shift;		/* bit-shift of the current radix digit */
+	uint64_t		topk_prefix;	/* radix digits determined so far */
+	uint32_t		histogram[256];	/* histogram of the current radix digit */
+	uint64_t		keys[1];		/* order-preserving key for each row */
+} kern_gputopk_buffer;
+
+#define GPUSORT_MAX_NBLOCKS			1024
+typedef struct {
+	int16_t			sortkey_resno;	/* attribute number of the sort key */
+	int16_t			sortkey_flags;	/* KERN_SORTKEY__* flags */
+	uint32_t		sort_pass;		/* 0, if rows are not sorted yet */
+	uint32_t		nitems;			/* number of rows to be sorted */
+	uint32_t		nblocks;		/* number of tiles (= grid size) */
+	uint32_t		tile_sz;		/* number of rows per tile */
+	uint64_t		key_and_mask;	/* AND of all the keys */
+	uint64_t		key_or_mask;	/* OR of all the keys */
+	uint32_t		null_order_count; /* # of rows with NULL-ordering bit */
+	uint32_t		block_zeros[GPUSORT_MAX_NBLOCKS]; /* # of 0-bits per tile */
+	uint64_t		data[1];		/* keys[2][nitems] + rowindex[2][nitems] */
+} kern_gpusort_buffer;
+
+#define GPUSORT_KEYS_BUFFER(gsort,k)						\
+	((gsort)->data + (size_t)(k) * (gsort)->nitems)
+#define GPUSORT_ROWINDEX_BUFFER(gsort,k)					\
+	((gsort)->data + (size_t)(2 + (k)) * (gsort)->nitems)
+
 /*
  * Definitions related to GpuCache
  */
@@ -251,6 +325,15 @@ GpuCacheIdentEqual(const GpuCacheIdent *a, const GpuCacheIdent *b)
 			a->signature    == b->signature);
 }
 
+/*
+ * Payload of XpuCommandTag__XpuTaskExecGpuCache
+ */
+typedef struct {
+	GpuCacheIdent	ident;
+	uint64_t		merge_pos;	/* merge the REDO logs prior to this position
+								 * on read, if not applied yet. */
+} GpuCacheScanArgs;
+
 #define GCACHE_TX_LOG__MAGIC		0xEBAD7C00
 #define GCACHE_TX_LOG__INSERT		(GCACHE_TX_LOG__MAGIC | 'I')
 #define GCACHE_TX_LOG__DELETE		(GCACHE_TX_LOG__MAGIC | 'D')
@@ -302,6 +385,27 @@ typedef struct {
 	uint32_t		redo_items[1];
 } kern_gpucache_redolog;
 
+/*
+ * Delta of the REDO logs not applied yet (merge-on-read)
+ *
+ * It overrides the visibility of rows touched by the pending REDO logs,
+ * and also carries the heap-tuples by the pending INSERT logs.
+ */
+typedef struct {
+	uint32_t	rowid;
+	uint32_t	xmin;
+	uint32_t	xmax;
+	uint32_t	htup_offset;	/* packed offset to the heap-tuple, or 0 if
+								 * values are still in the main store */
+} kern_gpucache_delta_item;
+
+typedef struct kern_gpucache_delta {
+	size_t		length;
+	uint32_t	nitems;
+	uint32_t	nrooms;			/* max rowid + 1 in the delta */
+	kern_gpucache_delta_item items[1];	/* sorted by rowid */
+} kern_gpucache_delta;
+
 /*
  * GPU Kernel Entrypoint
  */
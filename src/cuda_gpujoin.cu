@@ -12,6 +12,86 @@
  */
 #include "cuda_common.h"
 
+/*
+ * Grid-Join - it returns the position of the next inner tuple on the cells
+ * around the outer geometry, or 'nitems' if no more. The inner tuples are
+ * sorted by the cell of their center, so the candidates on a row of cells
+ * are continuous; the binary search skips the gap between the rows.
+ */
+STATIC_FUNCTION(uint32_t)
+__execGpuJoinGridNext(kern_context *kcxt,
+					  kern_multirels *kmrels,
+					  int depth,
+					  const int64_t *range_keys,
+					  uint32_t nitems,
+					  uint64_t l_state)
+{
+	const kern_expression *kexp = SESSION_KEXP_RANGE_KEY(kcxt->session, depth);
+	double		cell_sz = kmrels->chunks[depth-1].range_grid_distance;
+	double		margin;
+	uint32_t	nnulls = kmrels->chunks[depth-1].range_nnulls;
+	uint32_t	pos;
+	xpu_geometry_t geom;
+	geom_bbox_2d bbox;
+	int64_t		cx_lo, cx_hi;
+	int64_t		cy_lo, cy_hi;
+
+	if (!kexp || kexp->exptype != TypeOpCode__geometry)
+	{
+		STROM_ELOG(kcxt, "unexpected type of grid-join key");
+		return nitems;
+	}
+	if (!EXEC_KERN_EXPRESSION(kcxt, kexp, &geom))
+		return nitems;
+	switch (xpu_geometry_grid_bbox(kcxt, &geom, &bbox))
+	{
+		case 0:
+			/* NULL or empty geometry never satisfies st_dwithin */
+			return nitems;
+		case 1:
+			/* rounded outside, not to miss the boundary */
+			margin = __dadd_ru(cell_sz, kmrels->chunks[depth-1].range_grid_extent);
+			cx_lo = __geom_grid_cell(__dsub_rd(bbox.xmin, margin), cell_sz);
+			cx_hi = __geom_grid_cell(__dadd_ru(bbox.xmax, margin), cell_sz);
+			cy_lo = __geom_grid_cell(__dsub_rd(bbox.ymin, margin), cell_sz);
+			cy_hi = __geom_grid_cell(__dadd_ru(bbox.ymax, margin), cell_sz);
+			break;
+		default:
+			/* all the non-NULL inner tuples are candidates */
+			if (kcxt->errcode != ERRCODE_STROM_SUCCESS)
+				return nitems;
+			return Max(l_state, nnulls);
+	}
+
+	if (l_state == 0)
+		pos = KERN_RANGE_KEYS_LOWER_BOUND(range_keys, nnulls, nitems,
+										  false, true,
+										  __geom_grid_key(cx_lo, cy_lo));
+	else
+		pos = l_state;
+	while (pos < nitems)
+	{
+		int64_t		key = range_keys[pos];
+		int64_t		cx = GEOM_GRID_KEY_CX(key);
+		int64_t		cy = GEOM_GRID_KEY_CY(key);
+
+		if (cy > cy_hi)
+			break;
+		if (cy < cy_lo)
+			key = __geom_grid_key(cx_lo, cy_lo);
+		else if (cx < cx_lo)
+			key = __geom_grid_key(cx_lo, cy);
+		else if (cx > cx_hi)
+			key = __geom_grid_key(cx_lo, cy + 1);
+		else
+			return pos;
+		/* key is larger than range_keys[pos], so pos always moves forward */
+		pos = KERN_RANGE_KEYS_LOWER_BOUND(range_keys, pos + 1, nitems,
+										  false, true, key);
+	}
+	return nitems;
+}
+
 /*
  * GPU Nested-Loop
  */
@@ -28,10 +108,13 @@ execGpuJoinNestLoop(kern_context *kcxt,
 	const kern_expression *kexp;
 	kern_data_store *kds_heap = KERN_MULTIRELS_INNER_KDS(kmrels, depth-1);
 	bool	   *oj_map = KERN_MULTIRELS_OUTER_JOIN_MAP(kmrels, depth-1);
+	int64_t	   *range_keys = KERN_MULTIRELS_RANGE_KEYS(kmrels, depth-1);
 	uint32_t	rd_pos;
 	uint32_t	wr_pos;
 	uint32_t	count;
 	bool		left_outer = kmrels->chunks[depth-1].left_outer;
+	bool		semi_join = kmrels->chunks[depth-1].semi_join;
+	bool		anti_join = kmrels->chunks[depth-1].anti_join;
 	bool		tuple_is_valid = false;
 
 	if (WARP_WRITE_POS(wp,depth) >= WARP_READ_POS(wp,depth) + get_local_size())
@@ -44,7 +127,8 @@ execGpuJoinNestLoop(kern_context *kcxt,
 	}
 
 	if (__syncthreads_count(l_state < kds_heap->nitems) == 0 &&
-		(!left_outer || __syncthreads_count(l_state != ULONG_MAX) == 0))
+		((!left_outer && !anti_join) ||
+		 __syncthreads_count(l_state != ULONG_MAX) == 0))
 	{
 		/*
 		 * OK, all the threads in this block reached to end of the inner
@@ -85,7 +169,86 @@ execGpuJoinNestLoop(kern_context *kcxt,
 	kcxt->kvecs_curr_buffer = src_kvecs_buffer;
 	if (rd_pos < WARP_WRITE_POS(wp,depth-1))
 	{
-		uint32_t	index = l_state++;
+		uint32_t	index;
+
+		if (range_keys && kmrels->chunks[depth-1].range_grid_distance > 0.0)
+		{
+			/*
+			 * Grid-Join - only the inner tuples on the cells around the
+			 * outer geometry can satisfy the st_dwithin clause.
+			 */
+			if (l_state < kds_heap->nitems)
+				l_state = __execGpuJoinGridNext(kcxt, kmrels, depth,
+												range_keys,
+												kds_heap->nitems,
+												l_state);
+		}
+		else if (range_keys && l_state == 0)
+		{
+			/*
+			 * Range-Join - the inner tuples that can satisfy the range-join
+			 * clause are the suffix of the sorted row-index, so we skip
+			 * the head portion by binary search.
+			 */
+			kexp = SESSION_KEXP_RANGE_KEY(kcxt->session, depth);
+			if (kexp)
+			{
+				union {
+					xpu_int2_t			i2;
+					xpu_int4_t			i4;
+					xpu_int8_t			i8;
+					xpu_date_t			date;
+					xpu_timestamp_t		ts;
+					xpu_timestamptz_t	tstz;
+				} outer_key;
+				int64_t		ival = 0;
+				bool		isnull = true;
+
+				if (EXEC_KERN_EXPRESSION(kcxt, kexp, &outer_key))
+				{
+					switch (kexp->exptype)
+					{
+						case TypeOpCode__int2:
+							isnull = XPU_DATUM_ISNULL(&outer_key.i2);
+							ival = outer_key.i2.value;
+							break;
+						case TypeOpCode__int4:
+							isnull = XPU_DATUM_ISNULL(&outer_key.i4);
+							ival = outer_key.i4.value;
+							break;
+						case TypeOpCode__int8:
+							isnull = XPU_DATUM_ISNULL(&outer_key.i8);
+							ival = outer_key.i8.value;
+							break;
+						case TypeOpCode__date:
+							isnull = XPU_DATUM_ISNULL(&outer_key.date);
+							ival = outer_key.date.value;
+							break;
+						case TypeOpCode__timestamp:
+							isnull = XPU_DATUM_ISNULL(&outer_key.ts);
+							ival = outer_key.ts.value;
+							break;
+						case TypeOpCode__timestamptz:
+							isnull = XPU_DATUM_ISNULL(&outer_key.tstz);
+							ival = outer_key.tstz.value;
+							break;
+						default:
+							STROM_ELOG(kcxt, "unexpected type of range-join key");
+							break;
+					}
+				}
+				/* NULL never satisfies the range-join clause */
+				l_state = kds_heap->nitems;
+				if (!isnull)
+					l_state = KERN_RANGE_KEYS_LOWER_BOUND(range_keys,
+														  kmrels->chunks[depth-1].range_nnulls,
+														  kds_heap->nitems,
+														  kmrels->chunks[depth-1].range_desc,
+														  kmrels->chunks[depth-1].range_inclusive,
+														  ival);
+			}
+		}
+		index = l_state++;
 
 		if (index < kds_heap->nitems)
 		{
@@ -112,6 +275,28 @@ execGpuJoinNestLoop(kern_context *kcxt,
 				assert(tupitem->rowid < kds_heap->nitems);
 				oj_map[tupitem->rowid] = true;
 			}
+			if (anti_join)
+			{
+				/* ANTI JOIN never emits, and stops on the first match */
+				tuple_is_valid = false;
+				if (matched)
+					l_state = ULONG_MAX;
+			}
+			else if (semi_join && tuple_is_valid)
+			{
+				/* SEMI JOIN stops on the first match */
+				l_state = ULONG_MAX;
+			}
+		}
+		else if (anti_join && index >= kds_heap->nitems && !matched)
+		{
+			/*
+			 * ANTI JOIN emits the outer tuple without any matched inner
+			 * tuples. No inner columns are referenced at the later depth,
+			 * so we don't need to load NULLs here.
+			 */
+			tuple_is_valid = true;
+			l_state = ULONG_MAX;
 		}
 		else if (left_outer && index >= kds_heap->nitems && !matched)
 		{
@@ -159,6 +344,114 @@ execGpuJoinNestLoop(kern_context *kcxt,
 	return depth;
 }
 
+/*
+ * __execGpuJoinHashSkew
+ *
+ * It distributes the inner tuples of the heavy-hitters to the threads that
+ * have no result on this call. Each owner thread (that has the outer tuple
+ * of a heavy-hitter) gets up to blockSize pairs, then the idle threads
+ * evaluate the join-quals with the outer tuple of the owner.
+ */
+STATIC_FUNCTION(bool)
+__execGpuJoinHashSkew(kern_context *kcxt,
+					  kern_warp_context *wp,
+					  kern_multirels *kmrels,
+					  int		depth,
+					  uint64_t &l_state,
+					  bool		tuple_is_valid)
+{
+	__shared__ uint32_t	__skew_pairs_tail[MAXTHREADS_PER_BLOCK];
+	__shared__ uint32_t	__skew_index_base[MAXTHREADS_PER_BLOCK];
+	kern_data_store *kds_hash = KERN_MULTIRELS_INNER_KDS(kmrels, depth-1);
+	bool	   *oj_map = KERN_MULTIRELS_OUTER_JOIN_MAP(kmrels, depth-1);
+	kern_hashskew *skews = KERN_MULTIRELS_HASH_SKEWS(kmrels, depth-1);
+	uint32_t	sindex = 0;
+	uint32_t	done = 0;
+	uint32_t	rest = 0;
+	uint32_t	remain = 0;
+	uint32_t	base = 0;
+	uint32_t	free_id;
+	uint32_t	nfree;
+	uint32_t	pair_id;
+	uint32_t	npairs;
+	bool		join_is_valid = false;
+
+	if (KERN_HASHSKEW_LSTATE_IS_VALID(l_state))
+	{
+		const kern_hashskew *skew;
+
+		sindex = KERN_HASHSKEW_LSTATE_SINDEX(l_state);
+		done = KERN_HASHSKEW_LSTATE_DONE(l_state);
+		assert(sindex < kmrels->chunks[depth-1].hash_nskews);
+		skew = &skews[sindex];
+		assert(done < skew->nitems);
+		rest = skew->nitems - done;
+		remain = Min(rest, get_local_size());
+		base = skew->head + done;
+	}
+	free_id = pgstrom_stair_sum_binary(!tuple_is_valid, &nfree);
+	pair_id = pgstrom_stair_sum_uint32(remain, &npairs) - remain;
+	/* pairs [pair_id, pair_id + remain) belong to this thread */
+	__skew_pairs_tail[get_local_id()] = pair_id + remain;
+	__skew_index_base[get_local_id()] = base - pair_id;
+	__syncthreads();
+
+	if (!tuple_is_valid && free_id < Min(npairs, nfree))
+	{
+		const kern_expression *kexp;
+		kern_tupitem   *titem;
+		xpu_int4_t		status;
+		uint32_t		head = 0;
+		uint32_t		tail = get_local_size();
+		uint32_t		rd_pos;
+
+		/* lookup the owner thread of this pair */
+		while (head < tail)
+		{
+			uint32_t	curr = head + (tail - head) / 2;
+
+			if (__skew_pairs_tail[curr] > free_id)
+				tail = curr;
+			else
+				head = curr + 1;
+		}
+		assert(head < get_local_size());
+		rd_pos = WARP_READ_POS(wp,depth-1) + head;
+		kcxt->kvecs_curr_id = (rd_pos % KVEC_UNITSZ);
+		titem = KDS_GET_TUPITEM(kds_hash, __skew_index_base[head] + free_id);
+
+		kexp = SESSION_KEXP_LOAD_VARS(kcxt->session, depth);
+		ExecLoadVarsHeapTuple(kcxt, kexp, depth, kds_hash, &titem->htup);
+		kexp = SESSION_KEXP_JOIN_QUALS(kcxt->session, depth);
+		if (EXEC_KERN_EXPRESSION(kcxt, kexp, &status))
+		{
+			assert(!XPU_DATUM_ISNULL(&status));
+			if (status.value > 0)
+				join_is_valid = true;
+			if (oj_map && status.value != 0)
+			{
+				assert(titem->rowid < kds_hash->nitems);
+				oj_map[titem->rowid] = true;
+			}
+		}
+	}
+	__syncthreads();
+
+	/* advance the position of the heavy-hitter */
+	if (remain > 0)
+	{
+		uint32_t	nassigned = 0;
+
+		if (pair_id < nfree)
+			nassigned = Min(remain, nfree - pair_id);
+		if (nassigned == rest)
+			l_state = ULONG_MAX;
+		else
+			l_state = KERN_HASHSKEW_LSTATE(sindex, done + nassigned);
+	}
+	return join_is_valid;
+}
+
 /*
  * GPU Hash-Join
  */
@@ -174,8 +467,13 @@ execGpuJoinHashJoin(kern_context *kcxt,
 {
 	kern_data_store *kds_hash = KERN_MULTIRELS_INNER_KDS(kmrels, depth-1);
 	bool	   *oj_map = KERN_MULTIRELS_OUTER_JOIN_MAP(kmrels, depth-1);
+	kern_hashbucket *buckets = KERN_MULTIRELS_HASH_BUCKETS(kmrels, depth-1);
+	uint32_t	nbuckets = kmrels->chunks[depth-1].hash_nbuckets;
+	uint32_t   *bloom = KERN_MULTIRELS_BLOOM_FILTER(kmrels, depth-1);
+	kern_hashskew *skews = KERN_MULTIRELS_HASH_SKEWS(kmrels, depth-1);
 	kern_expression *kexp = NULL;
 	kern_hashitem *khitem = NULL;
+	uint64_t	hpos = 0;
 	uint32_t	rd_pos;
 	uint32_t	wr_pos;
 	uint32_t	count;
@@ -242,14 +540,56 @@ execGpuJoinHashJoin(kern_context *kcxt,
 		if (rd_pos < wr_pos)
 		{
 			xpu_int4_t	hash;
+			int			sindex;
 
 			kexp = SESSION_KEXP_HASH_VALUE(kcxt->session, depth);
 			if (EXEC_KERN_EXPRESSION(kcxt, kexp, &hash))
 			{
+				uint32_t	nparts = kmrels->chunks[depth-1].hash_nparts;
+
 				assert(!XPU_DATUM_ISNULL(&hash));
-				for (khitem = KDS_HASH_FIRST_ITEM(kds_hash, hash.value);
-					 khitem != NULL && khitem->hash != hash.value;
-					 khitem = KDS_HASH_NEXT_ITEM(kds_hash, khitem->next));
+				if (nparts > 1 &&
+					KERN_HASH_PARTITION(hash.value, nparts) != kmrels->chunks[depth-1].hash_partid)
+				{
+					/*
+					 * This outer tuple belongs to the other partition of
+					 * the inner hash table, so it shall be joined (or
+					 * filled up by NULLs if LEFT OUTER) on the other pass.
+					 */
+					l_state = ULONG_MAX;
+				}
+				else if (skews &&
+						 (sindex = KERN_HASHSKEW_LOOKUP(skews, kmrels->chunks[depth-1].hash_nskews,
+														hash.value)) >= 0)
+				{
+					/*
+					 * This outer tuple hits a heavy-hitter, so its inner
+					 * tuples are distributed to the idle threads below.
+					 */
+					l_state = KERN_HASHSKEW_LSTATE(sindex, 0);
+				}
+				else if (bloom &&
+						 !KERN_BLOOM_FILTER_CHECK(bloom, kmrels->chunks[depth-1].bloom_nblocks,
+												  hash.value))
+				{
+					/*
+					 * No inner tuples have this hash value, so we don't need
+					 * to probe the hash table. khitem == NULL fills up the
+					 * inner portion by NULLs if LEFT OUTER.
+					 */
+				}
+				else if (buckets)
+				{
+					hpos = (uint64_t)(hash.value % nbuckets) * KERN_HASHBUCKET_NSLOTS;
+					khitem = KERN_HASHBUCKET_LOOKUP(kds_hash, buckets, nbuckets,
+													hash.value, &hpos);
+				}
+				else
+				{
+					for (khitem = KDS_HASH_FIRST_ITEM(kds_hash, hash.value);
+						 khitem != NULL && khitem->hash != hash.value;
+						 khitem = KDS_HASH_NEXT_ITEM(kds_hash, khitem->next));
+				}
 			}
 		}
 		else
@@ -257,6 +597,23 @@ execGpuJoinHashJoin(kern_context *kcxt,
 			l_state = ULONG_MAX;
 		}
 	}
+	else if (KERN_HASHSKEW_LSTATE_IS_VALID(l_state))
+	{
+		/* heavy-hitter is processed by __execGpuJoinHashSkew */
+	}
+	else if (l_state != ULONG_MAX && buckets)
+	{
+		/* pick up the next one from the bucket, if any */
+		const kern_hashbucket *bucket;
+		uint32_t	hash_value;
+
+		hpos = l_state - 1;
+		bucket = &buckets[hpos / KERN_HASHBUCKET_NSLOTS];
+		hash_value = bucket->tags[hpos % KERN_HASHBUCKET_NSLOTS];
+		hpos++;
+		khitem = KERN_HASHBUCKET_LOOKUP(kds_hash, buckets, nbuckets,
+										hash_value, &hpos);
+	}
 	else if (l_state != ULONG_MAX)
 	{
 		/* pick up the next one if any */
@@ -293,12 +650,36 @@ execGpuJoinHashJoin(kern_context *kcxt,
 			assert(khitem->t.rowid < kds_hash->nitems);
 			oj_map[khitem->t.rowid] = true;
 		}
-		l_state = ((char *)khitem - (char *)kds_hash);
+		if (buckets)
+			l_state = hpos + 1;
+		else
+			l_state = ((char *)khitem - (char *)kds_hash);
+		if (kmrels->chunks[depth-1].anti_join)
+		{
+			/* ANTI JOIN never emits, and stops on the first match */
+			tuple_is_valid = false;
+			if (matched)
+				l_state = ULONG_MAX;
+		}
+		else if (kmrels->chunks[depth-1].semi_join && tuple_is_valid)
+		{
+			/* SEMI JOIN stops on the first match */
+			l_state = ULONG_MAX;
+		}
 	}
-	else
+	else if (!KERN_HASHSKEW_LSTATE_IS_VALID(l_state))
 	{
-		if (kmrels->chunks[depth-1].left_outer &&
+		if (kmrels->chunks[depth-1].anti_join &&
 			l_state != ULONG_MAX && !matched)
+		{
+			/*
+			 * ANTI JOIN emits the outer tuple without any matched inner
+			 * tuples; no inner columns are referenced at the later depth.
+			 */
+			tuple_is_valid = true;
+		}
+		else if (kmrels->chunks[depth-1].left_outer &&
+				 l_state != ULONG_MAX && !matched)
 		{
 			/* load NULL values on the inner portion */
 			 kexp = SESSION_KEXP_LOAD_VARS(kcxt->session, depth);
@@ -310,6 +691,16 @@ execGpuJoinHashJoin(kern_context *kcxt,
 	/* error checks */
 	if (__syncthreads_count(kcxt->errcode != ERRCODE_STROM_SUCCESS) > 0)
 		return -1;
+	/* heavy-hitters, if any, are processed by the idle threads */
+	if (skews && __syncthreads_count(KERN_HASHSKEW_LSTATE_IS_VALID(l_state)) > 0)
+	{
+		if (__execGpuJoinHashSkew(kcxt, wp, kmrels, depth,
+								  l_state, tuple_is_valid))
+			tuple_is_valid = true;
+		/* error checks */
+		if (__syncthreads_count(kcxt->errcode != ERRCODE_STROM_SUCCESS) > 0)
+			return -1;
+	}
 	/* save the result on the destination buffer */
 	wr_pos = WARP_WRITE_POS(wp,depth);
 	wr_pos += pgstrom_stair_sum_binary(tuple_is_valid, &count);
@@ -336,6 +727,41 @@ execGpuJoinHashJoin(kern_context *kcxt,
 	return depth;
 }
 
+/*
+ * gpujoin_prep_hashtable
+ *
+ * It links the hash-items shipped as plain rows to the hash-slot (and
+ * the buckets if any), instead of the host-side construction.
+ */
+KERNEL_FUNCTION(void)
+gpujoin_prep_hashtable(kern_multirels *kmrels, int depth)
+{
+	kern_data_store *kds_hash = KERN_MULTIRELS_INNER_KDS(kmrels, depth-1);
+	kern_hashbucket *buckets = KERN_MULTIRELS_HASH_BUCKETS(kmrels, depth-1);
+	uint32_t	nbuckets = kmrels->chunks[depth-1].hash_nbuckets;
+	uint32_t   *bloom = KERN_MULTIRELS_BLOOM_FILTER(kmrels, depth-1);
+	uint32_t	bloom_nblocks = kmrels->chunks[depth-1].bloom_nblocks;
+	uint64_t   *row_index = KDS_GET_ROWINDEX(kds_hash);
+	uint32_t	index;
+
+	assert(kds_hash && kds_hash->format == KDS_FORMAT_HASH);
+	for (index = get_global_id();
+		 index < kds_hash->nitems;
+		 index += get_global_size())
+	{
+		uint64_t	self = row_index[index] + offsetof(kern_hashitem, t);
+		kern_hashitem *hitem = (kern_hashitem *)
+			((char *)kds_hash + kds_hash->length - self);
+
+		KDS_HASH_INSERT_ITEM(kds_hash, hitem, self);
+		/* never fails, because buckets are sized by KERN_HASHBUCKET_FILL */
+		if (buckets)
+			(void)KERN_HASHBUCKET_INSERT(buckets, nbuckets, hitem->hash, self);
+		if (bloom)
+			KERN_BLOOM_FILTER_INSERT(bloom, bloom_nblocks, hitem->hash);
+	}
+}
+
 /*
  * gpujoin_prep_gistindex
  */
@@ -410,6 +836,7 @@ execGpuJoinGiSTJoin(kern_context *kcxt,
 {
 	kern_data_store *kds_hash = KERN_MULTIRELS_INNER_KDS(kmrels, depth-1);
 	kern_data_store *kds_gist = KERN_MULTIRELS_GIST_INDEX(kmrels, depth-1);
+	kern_gist_rtree *rtree = KERN_MULTIRELS_GIST_RTREE(kmrels, depth-1);
 	int				gist_depth = kexp_gist->u.gist.gist_depth;
 	uint32_t		count;
 	uint32_t		rd_pos;
@@ -547,11 +974,18 @@ execGpuJoinGiSTJoin(kern_context *kcxt,
 		{
 			kcxt->kvecs_curr_buffer = src_kvecs_buffer;
 			kcxt->kvecs_curr_id = (rd_pos % KVEC_UNITSZ);
-			l_state = ExecGiSTIndexGetNext(kcxt,
-										   kds_hash,
-										   kds_gist,
-										   kexp_gist,
-										   l_state);
+			if (rtree)
+				l_state = ExecGiSTRTreeGetNext(kcxt,
+											   kds_hash,
+											   rtree,
+											   kexp_gist,
+											   l_state);
+			else
+				l_state = ExecGiSTIndexGetNext(kcxt,
+											   kds_hash,
+											   kds_gist,
+											   kexp_gist,
+											   l_state);
 		}
 	}
 	else
@@ -701,6 +1135,36 @@ execGpuJoinProjection(kern_context *kcxt,
 	return n_rels + 1;		/* elsewhere, try again? */
 }
 
+/*
+ * __gpujoinSwitchDestBuffer
+ *
+ * It switches the kds_dst to the next one in the pre-reserved pool, if any,
+ * instead of the suspend/resume by the host.
+ */
+STATIC_FUNCTION(kern_data_store *)
+__gpujoinSwitchDestBuffer(kern_gputask *kgtask, kern_data_store *kds_dst)
+{
+	__shared__ kern_data_store *kds_next;
+
+	if (get_local_id() == 0)
+	{
+		uint32_t	index = __volatileRead(&kgtask->kds_dst_index);
+
+		if (kgtask->kds_dst_pool[index] == kds_dst &&
+			index + 1 < kgtask->kds_dst_nrooms)
+		{
+			/* only one block can switch, but others see the result */
+			__atomic_cas_uint32(&kgtask->kds_dst_index, index, index+1);
+			index = __volatileRead(&kgtask->kds_dst_index);
+		}
+		kds_next = kgtask->kds_dst_pool[index];
+		if (kds_next == kds_dst)
+			kds_next = NULL;	/* pool is exhausted */
+	}
+	__syncthreads();
+	return kds_next;
+}
+
 /*
  * kern_gpujoin_main
  */
@@ -721,6 +1185,8 @@ kern_gpujoin_main(kern_session_info *session,
 	uint32_t			wp_base_sz;
 	uint32_t			n_rels = (kmrels ? kmrels->num_rels : 0);
 	int					depth;
+	bool				yielded = false;
+	__shared__ uint64_t	ts_yield;	/* end of the time-slice, if any */
 
 	assert(kgtask->kvars_nslots == session->kcxt_kvars_nslots &&
 		   kgtask->kvecs_bufsz  == session->kcxt_kvecs_bufsz &&
@@ -728,6 +1194,7 @@ kern_gpujoin_main(kern_session_info *session,
 		   kgtask->n_rels       == n_rels);
 	/* setup execution context */
 	INIT_KERNEL_CONTEXT(kcxt, session);
+	kcxt->kmrels = kmrels;
 	wp_base_sz = __KERN_WARP_CONTEXT_BASESZ(kgtask->kvecs_ndims);
 	wp = (kern_warp_context *)SHARED_WORKMEM(0);
 	INIT_KERN_GPUTASK_SUBFIELDS(kgtask,
@@ -741,6 +1208,9 @@ kern_gpujoin_main(kern_session_info *session,
 #define __KVEC_BUFFER(__depth)							\
 	(kvec_buffer_base + kvec_buffer_size * (__depth))
 
+	if (get_local_id() == 0)
+		ts_yield = (kgtask->time_slice_ns > 0
+					? __globaltimer() + kgtask->time_slice_ns : 0);
 	if (kgtask->resume_context)
 	{
 		/* resume the warp-context from the previous execution */
@@ -772,10 +1242,39 @@ kern_gpujoin_main(kern_session_info *session,
 		kcxt_reset(kcxt);
 		if (depth == 0)
 		{
+			/*
+			 * Time-slice is expired; the block yields SMs to the kernels of
+			 * other sessions, then resumes from the saved warp-context.
+			 * All the depths are consistent here, between the steps.
+			 */
+			if (ts_yield != 0 &&
+				__syncthreads_count(get_local_id() == 0 &&
+									wp->scan_done == 0 &&
+									__globaltimer() > ts_yield) > 0)
+			{
+				if (get_local_id() == 0)
+					atomicAdd(&kgtask->yield_count, 1);
+				yielded = true;
+				depth = -1;
+				break;
+			}
+			/*
+			 * LIMIT without ORDER BY; no more source rows are needed
+			 * once the destination buffer got enough rows.
+			 */
+			if (session->limit_nitems > 0)
+			{
+				if (get_local_id() == 0 &&
+					wp->scan_done == 0 &&
+					__volatileRead(&kds_dst->nitems) >= session->limit_nitems)
+					wp->scan_done = 1;
+				__syncthreads();
+			}
 			/* LOAD FROM THE SOURCE */
 			depth = execGpuScanLoadSource(kcxt, wp,
 										  kds_src,
 										  kds_extra,
+										  kgtask->gcache_delta,
 										  SESSION_KEXP_LOAD_VARS(session, 0),
 										  SESSION_KEXP_SCAN_QUALS(session),
 										  SESSION_KEXP_MOVE_VARS(session, 0),
@@ -807,9 +1306,22 @@ kern_gpujoin_main(kern_session_info *session,
 			}
 			if (__syncthreads_count(try_suspend) > 0)
 			{
-				if (get_local_id() == 0)
-					atomicAdd(&kgtask->suspend_count, 1);
-				assert(depth < 0);
+				kern_data_store *kds_next = NULL;
+
+				if (kgtask->kds_dst_nrooms > 0)
+					kds_next = __gpujoinSwitchDestBuffer(kgtask, kds_dst);
+				if (kds_next)
+				{
+					/* retry the projection on the next buffer */
+					kds_dst = kds_next;
+					depth = n_rels + 1;
+				}
+				else
+				{
+					if (get_local_id() == 0)
+						atomicAdd(&kgtask->suspend_count, 1);
+					assert(depth < 0);
+				}
 			}
 		}
 		else if (kmrels->chunks[depth-1].is_nestloop)
@@ -871,8 +1383,10 @@ kern_gpujoin_main(kern_session_info *session,
 	/* update the statistics */
 	if (get_local_id() == 0)
 	{
-		if (depth < 0 && WARP_READ_POS(wp,n_rels) >= WARP_WRITE_POS(wp,n_rels))
+		if (depth < 0 && !yielded && !wp->stats_done &&
+			WARP_READ_POS(wp,n_rels) >= WARP_WRITE_POS(wp,n_rels))
 		{
+			wp->stats_done = 1;
 			/* number of raw-tuples fetched from the heap block */
 			if (kds_src->format == KDS_FORMAT_BLOCK)
 				atomicAdd(&kgtask->nitems_raw, wp->lp_wr_pos);
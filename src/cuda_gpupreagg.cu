@@ -12,6 +12,41 @@
 #include "cuda_common.h"
 #include "float2.h"
 
+/*
+ * __atomic_max_hll_registers - update 4 HLL registers in a word at once
+ */
+INLINE_FUNCTION(void)
+__atomic_max_hll_registers(uint32_t *wptr, uint32_t regs)
+{
+	uint32_t	curval = __volatileRead(wptr);
+	uint32_t	oldval;
+	uint32_t	newval;
+
+	for (;;)
+	{
+		newval = __vmaxu4(curval, regs);
+		if (newval == curval)
+			break;		/* no need to update */
+		oldval = curval;
+		curval = __atomic_cas_uint32(wptr, oldval, newval);
+		if (curval == oldval)
+			break;
+	}
+}
+
+INLINE_FUNCTION(void)
+__update_hll_sketch_by_hash(kagg_state__hll_sketch_packed *r,
+							uint32_t hll_nbits, uint64_t hash)
+{
+	uint32_t	index;
+	uint32_t	count;
+
+	pg_hll_register_position(hash, hll_nbits, &index, &count);
+	assert(index < r->nrooms);
+	__atomic_max_hll_registers((uint32_t *)&r->regs[index & ~3U],
+							   count << ((index & 3) * BITS_PER_BYTE));
+}
+
 /*
  * __writeOutOneTuplePreAgg
  */
@@ -161,6 +196,15 @@ __writeOutOneTuplePreAgg(kern_context *kcxt,
 				t_infomask |= HEAP_HASVARWIDTH;
 				break;
 
+			case KAGG_ACTION__PSUM_NUMERIC:
+			case KAGG_ACTION__PAVG_NUMERIC:
+				nbytes = sizeof(kagg_state__psum_numeric_packed);
+				if (buffer)
+					__preagg_init_psum_numeric((kagg_state__psum_numeric_packed *)buffer,
+											   desc->num_weight);
+				t_infomask |= HEAP_HASVARWIDTH;
+				break;
+
 			case KAGG_ACTION__STDDEV:
 				nbytes = sizeof(kagg_state__stddev_packed);
 				if (buffer)
@@ -181,6 +225,42 @@ __writeOutOneTuplePreAgg(kern_context *kcxt,
 				t_infomask |= HEAP_HASVARWIDTH;
 				break;
 
+			case KAGG_ACTION__HLL_SKETCH:
+				nbytes = KAGG_STATE__HLL_SKETCH_SZ(desc->hll_nbits);
+				if (buffer)
+				{
+					kagg_state__hll_sketch_packed *r =
+						(kagg_state__hll_sketch_packed *)buffer;
+					memset(r, 0, nbytes);
+					r->nrooms = (1U << desc->hll_nbits);
+					SET_VARSIZE(r, nbytes);
+				}
+				t_infomask |= HEAP_HASVARWIDTH;
+				break;
+
+			case KAGG_ACTION__QUANTILE_SKETCH:
+				nbytes = KAGG_STATE__QUANTILE_SKETCH_SZ;
+				if (buffer)
+				{
+					kagg_state__quantile_sketch_packed *r =
+						(kagg_state__quantile_sketch_packed *)buffer;
+					memset(r, 0, nbytes);
+					r->ncounters = KAGG_QSKETCH_NCOUNTERS;
+					SET_VARSIZE(r, nbytes);
+				}
+				t_infomask |= HEAP_HASVARWIDTH;
+				break;
+
+			case KAGG_ACTION__STRING_AGG:
+				nbytes = KAGG_STATE__STRING_AGG_SZ;
+				if (buffer)
+				{
+					memset(buffer, 0, KAGG_STATE__STRING_AGG_SZ);
+					SET_VARSIZE(buffer, KAGG_STATE__STRING_AGG_SZ);
+				}
+				t_infomask |= HEAP_HASVARWIDTH;
+				break;
+
 			default:
 				STROM_ELOG(kcxt, "unknown xpuPreAgg action");
 				return -1;
@@ -502,7 +582,7 @@ __update_nogroups__pmax_fp64(kern_context *kcxt,
 			else
 			{
 				__atomic_add_uint32(&r->nitems, count);
-				__atomic_min_fp64(&r->value, fval);
+				__atomic_max_fp64(&r->value, fval);
 			}
 		}
 	}
@@ -594,6 +674,32 @@ __update_nogroups__psum_fp(kern_context *kcxt,
 	}
 }
 
+/*
+ * __update_nogroups__psum_numeric
+ */
+INLINE_FUNCTION(void)
+__update_nogroups__psum_numeric(kern_context *kcxt,
+								char *buffer,
+								kern_colmeta *cmeta,
+								kern_aggregate_desc *desc,
+								bool source_is_valid)
+{
+	xpu_numeric_t	num;
+
+	/*
+	 * No stair-sum for the fixed-point sum with variable weights, so
+	 * each thread updates the state individually using atomic operations.
+	 */
+	if (source_is_valid)
+	{
+		const xpu_datum_t *xdatum = kcxt->kvars_slot[desc->arg0_slot_id];
+
+		if (__preagg_fetch_xdatum_as_numeric(kcxt, &num, xdatum))
+			__preagg_update_psum_numeric((kagg_state__psum_numeric_packed *)buffer,
+										 &num);
+	}
+}
+
 /*
  * __update_nogroups__pstddev
  */
@@ -702,6 +808,62 @@ __update_nogroups__pcovar(kern_context *kcxt,
 	}
 }
 
+/*
+ * __update_nogroups__hll_sketch
+ */
+INLINE_FUNCTION(void)
+__update_nogroups__hll_sketch(kern_context *kcxt,
+							  char *buffer,
+							  kern_colmeta *cmeta,
+							  kern_aggregate_desc *desc,
+							  bool source_is_valid)
+{
+	uint64_t	hash;
+
+	/*
+	 * HLL registers are updated by max(), so each thread can update
+	 * the register individually, regardless of the shared memory.
+	 */
+	if (source_is_valid)
+	{
+		const xpu_datum_t *xdatum = kcxt->kvars_slot[desc->arg0_slot_id];
+
+		if (__preagg_fetch_xdatum_as_hll_hash(kcxt, &hash, xdatum))
+			__update_hll_sketch_by_hash((kagg_state__hll_sketch_packed *)buffer,
+										desc->hll_nbits, hash);
+	}
+}
+
+/*
+ * __update_nogroups__quantile_sketch
+ */
+INLINE_FUNCTION(void)
+__update_nogroups__quantile_sketch(kern_context *kcxt,
+								   char *buffer,
+								   kern_colmeta *cmeta,
+								   kern_aggregate_desc *desc,
+								   bool source_is_valid)
+{
+	float8_t	fval;
+
+	/*
+	 * Quantile sketch is updated by increment of the counter, so each
+	 * thread can update the bucket individually, like HLL registers.
+	 */
+	if (source_is_valid)
+	{
+		const xpu_datum_t *xdatum = kcxt->kvars_slot[desc->arg0_slot_id];
+
+		if (__preagg_fetch_xdatum_as_float64(&fval, xdatum))
+		{
+			kagg_state__quantile_sketch_packed *r =
+				(kagg_state__quantile_sketch_packed *)buffer;
+
+			__atomic_add_uint64(&r->counts[pg_quantile_sketch_index(fval)], 1);
+		}
+	}
+}
+
 /*
  * __updateOneTupleNoGroups
  */
@@ -801,6 +963,12 @@ __updateOneTupleNoGroups(kern_context *kcxt,
 										   cmeta, desc,
 										   source_is_valid);
 				break;
+			case KAGG_ACTION__PAVG_NUMERIC:
+			case KAGG_ACTION__PSUM_NUMERIC:
+				__update_nogroups__psum_numeric(kcxt, buffer,
+												cmeta, desc,
+												source_is_valid);
+				break;
 			case KAGG_ACTION__STDDEV:
 				__update_nogroups__pstddev(kcxt, buffer,
 										   cmeta, desc,
@@ -811,6 +979,16 @@ __updateOneTupleNoGroups(kern_context *kcxt,
 										  cmeta, desc,
 										  source_is_valid);
 				break;
+			case KAGG_ACTION__HLL_SKETCH:
+				__update_nogroups__hll_sketch(kcxt, buffer,
+											  cmeta, desc,
+											  source_is_valid);
+				break;
+			case KAGG_ACTION__QUANTILE_SKETCH:
+				__update_nogroups__quantile_sketch(kcxt, buffer,
+												   cmeta, desc,
+												   source_is_valid);
+				break;
 			default:
 				/*
 				 * No more partial aggregation exists after grouping-keys
@@ -1012,150 +1190,173 @@ __insertOneTupleGroupBy(kern_context *kcxt,
 }
 
 /*
- * __update_groupby__nrows_any
+ * Warp-level pre-reduction for GROUP BY
+ *
+ * When the grouping-keys are skewed, multiple threads in a warp often update
+ * the same group. __execGpuPreAggGroupBy() picks up the peer threads that
+ * update the same destination using __match_any_sync(), then the handlers
+ * below reduce the values within the peers by shuffles, and only the leader
+ * (the lowest lane of the peers) updates the buffer by atomic operations.
+ * If groupby_warp_peers is zero, each thread updates the buffer by itself.
  */
-INLINE_FUNCTION(int)
-__update_groupby__nrows_any(kern_context *kcxt,
-							char *buffer,
-							const kern_colmeta *cmeta,
-							const kern_aggregate_desc *desc)
-{
-	__atomic_add_uint64((uint64_t *)buffer, 1);
-	return sizeof(uint64_t);
-}
-
-INLINE_FUNCTION(int)
-__update_groupby__nrows_cond(kern_context *kcxt,
-							 char *buffer,
-							 const kern_colmeta *cmeta,
-							 const kern_aggregate_desc *desc)
+INLINE_FUNCTION(bool)
+__groupby_warp_is_leader(kern_context *kcxt)
 {
-	xpu_datum_t	   *xdatum = kcxt->kvars_slot[desc->arg0_slot_id];
+	uint32_t	peers = kcxt->groupby_warp_peers;
 
-	if (!XPU_DATUM_ISNULL(xdatum))
-		__atomic_add_uint64((uint64_t *)buffer, 1);
-	return sizeof(uint64_t);
+	return (peers == 0 || __ffs(peers) - 1 == LaneId());
 }
 
-INLINE_FUNCTION(int)
-__update_groupby__pmin_int32(kern_context *kcxt,
-							 char *buffer,
-							 const kern_colmeta *cmeta,
-							 const kern_aggregate_desc *desc)
+INLINE_FUNCTION(uint32_t)
+__groupby_warp_count(kern_context *kcxt, bool is_valid)
 {
-	const xpu_datum_t *xdatum = kcxt->kvars_slot[desc->arg0_slot_id];
-	int32_t		ival;
+	uint32_t	peers = kcxt->groupby_warp_peers;
 
-	if (__preagg_fetch_xdatum_as_int32(&ival, xdatum))
-	{
-		kagg_state__pminmax_int64_packed *r =
-			(kagg_state__pminmax_int64_packed *)buffer;
-
-		__atomic_add_uint32(&r->nitems, 1);
-		__atomic_min_int64(&r->value, ival);
-	}
-	return sizeof(kagg_state__pminmax_int64_packed);
+	if (peers == 0)
+		return (is_valid ? 1 : 0);
+	return __popc(__ballot_sync(kcxt->groupby_warp_mask, is_valid) & peers);
 }
 
-INLINE_FUNCTION(int)
-__update_groupby__pmin_int64(kern_context *kcxt,
-							 char *buffer,
-							 const kern_colmeta *cmeta,
-							 const kern_aggregate_desc *desc)
-{
-	const xpu_datum_t *xdatum = kcxt->kvars_slot[desc->arg0_slot_id];
-	int64_t		ival;
-
-	if (__preagg_fetch_xdatum_as_int64(&ival, xdatum))
-	{
-		kagg_state__pminmax_int64_packed *r =
-			(kagg_state__pminmax_int64_packed *)buffer;
-
-		__atomic_add_uint32(&r->nitems, 1);
-		__atomic_min_int64(&r->value, ival);
+/*
+ * __groupby_warp_reduce_XXXX
+ *
+ * Reduction within the peers of arbitrary lanes; at each step, a thread
+ * merges the value of the next remaining peer, then the peers at the odd
+ * relative position retire. So, it takes log2(number of peers) steps, and
+ * the leader has the result at the end.
+ */
+#define __GROUPBY_WARP_REDUCE_TEMPLATE(NAME,TYPE,OPERATION)				\
+	INLINE_FUNCTION(TYPE)												\
+	__groupby_warp_reduce_##NAME(kern_context *kcxt, TYPE x)			\
+	{																	\
+		uint32_t	mask = kcxt->groupby_warp_mask;						\
+		uint32_t	peers = kcxt->groupby_warp_peers;					\
+		uint32_t	lane = LaneId();									\
+		uint32_t	rel_pos;											\
+																		\
+		if (peers == 0)													\
+			return x;													\
+		rel_pos = __popc(peers & ((1U << lane) - 1));					\
+		peers &= (0xfffffffeU << lane);									\
+		while (__any_sync(mask, peers != 0))							\
+		{																\
+			int		next = __ffs(peers);								\
+			TYPE	y = __shfl_sync(mask, x, next - 1);					\
+																		\
+			if (next)													\
+				x = OPERATION(x, y);									\
+			peers &= ~__ballot_sync(mask, (rel_pos & 1) != 0);			\
+			rel_pos >>= 1;												\
+		}																\
+		return x;														\
 	}
-	return sizeof(kagg_state__pminmax_int64_packed);
-}
+#define __GROUPBY_OP_ADD(x,y)		((x) + (y))
+#define __GROUPBY_OP_MIN(x,y)		((y) < (x) ? (y) : (x))
+#define __GROUPBY_OP_MAX(x,y)		((y) > (x) ? (y) : (x))
+/* NaN is ignored, as __atomic_(min|max)_fp64 doing */
+#define __GROUPBY_OP_MIN_FP(x,y)	(isnan(x) || (y) < (x) ? (y) : (x))
+#define __GROUPBY_OP_MAX_FP(x,y)	(isnan(x) || (y) > (x) ? (y) : (x))
+
+__GROUPBY_WARP_REDUCE_TEMPLATE(add_int64, int64_t,   __GROUPBY_OP_ADD)
+__GROUPBY_WARP_REDUCE_TEMPLATE(min_int64, int64_t,   __GROUPBY_OP_MIN)
+__GROUPBY_WARP_REDUCE_TEMPLATE(max_int64, int64_t,   __GROUPBY_OP_MAX)
+__GROUPBY_WARP_REDUCE_TEMPLATE(add_fp64,  float8_t,  __GROUPBY_OP_ADD)
+__GROUPBY_WARP_REDUCE_TEMPLATE(min_fp64,  float8_t,  __GROUPBY_OP_MIN_FP)
+__GROUPBY_WARP_REDUCE_TEMPLATE(max_fp64,  float8_t,  __GROUPBY_OP_MAX_FP)
 
+/*
+ * __update_groupby__nrows_any
+ */
 INLINE_FUNCTION(int)
-__update_groupby__pmax_int32(kern_context *kcxt,
-							 char *buffer,
-							 const kern_colmeta *cmeta,
-							 const kern_aggregate_desc *desc)
+__update_groupby__nrows_any(kern_context *kcxt,
+							char *buffer,
+							const kern_colmeta *cmeta,
+							const kern_aggregate_desc *desc)
 {
-	const xpu_datum_t *xdatum = kcxt->kvars_slot[desc->arg0_slot_id];
-	int32_t		ival;
+	uint32_t	count = __groupby_warp_count(kcxt, true);
 
-	if (__preagg_fetch_xdatum_as_int32(&ival, xdatum))
-	{
-		kagg_state__pminmax_int64_packed *r =
-			(kagg_state__pminmax_int64_packed *)buffer;
-
-		__atomic_add_uint32(&r->nitems, 1);
-		__atomic_max_int64(&r->value, ival);
-	}
-	return sizeof(kagg_state__pminmax_int64_packed);
+	if (__groupby_warp_is_leader(kcxt))
+		__atomic_add_uint64((uint64_t *)buffer, count);
+	return sizeof(uint64_t);
 }
 
 INLINE_FUNCTION(int)
-__update_groupby__pmax_int64(kern_context *kcxt,
+__update_groupby__nrows_cond(kern_context *kcxt,
 							 char *buffer,
 							 const kern_colmeta *cmeta,
 							 const kern_aggregate_desc *desc)
 {
-	const xpu_datum_t *xdatum = kcxt->kvars_slot[desc->arg0_slot_id];
-	int64_t		ival;
-
-	if (__preagg_fetch_xdatum_as_int64(&ival, xdatum))
-	{
-		kagg_state__pminmax_int64_packed *r =
-			(kagg_state__pminmax_int64_packed *)buffer;
+	xpu_datum_t	   *xdatum = kcxt->kvars_slot[desc->arg0_slot_id];
+	uint32_t		count;
 
-		__atomic_add_uint32(&r->nitems, 1);
-		__atomic_max_int64(&r->value, ival);
-	}
-	return sizeof(kagg_state__pminmax_int64_packed);
+	count = __groupby_warp_count(kcxt, !XPU_DATUM_ISNULL(xdatum));
+	if (count > 0 && __groupby_warp_is_leader(kcxt))
+		__atomic_add_uint64((uint64_t *)buffer, count);
+	return sizeof(uint64_t);
 }
 
-INLINE_FUNCTION(int)
-__update_groupby__pmin_fp64(kern_context *kcxt,
-							char *buffer,
-							const kern_colmeta *cmeta,
-							const kern_aggregate_desc *desc)
-{
-	const xpu_datum_t *xdatum = kcxt->kvars_slot[desc->arg0_slot_id];
-	float8_t	fval;
-
-	if (__preagg_fetch_xdatum_as_float64(&fval, xdatum))
-	{
-		kagg_state__pminmax_fp64_packed *r =
-			(kagg_state__pminmax_fp64_packed *)buffer;
-
-		__atomic_add_uint32(&r->nitems, 1);
-		__atomic_min_fp64(&r->value, fval);
+#define __UPDATE_GROUPBY_PMINMAX_INT_TEMPLATE(NAME,FETCH,TYPE,OPER,IDENTITY) \
+	INLINE_FUNCTION(int)												\
+	__update_groupby__##NAME(kern_context *kcxt,						\
+							 char *buffer,								\
+							 const kern_colmeta *cmeta,					\
+							 const kern_aggregate_desc *desc)			\
+	{																	\
+		const xpu_datum_t *xdatum = kcxt->kvars_slot[desc->arg0_slot_id]; \
+		TYPE		__ival;												\
+		int64_t		ival = IDENTITY;									\
+		bool		is_valid;											\
+		uint32_t	count;												\
+																		\
+		is_valid = __preagg_fetch_xdatum_as_##FETCH(&__ival, xdatum);	\
+		if (is_valid)													\
+			ival = __ival;												\
+		count = __groupby_warp_count(kcxt, is_valid);					\
+		ival = __groupby_warp_reduce_##OPER##_int64(kcxt, ival);		\
+		if (count > 0 && __groupby_warp_is_leader(kcxt))				\
+		{																\
+			kagg_state__pminmax_int64_packed *r =						\
+				(kagg_state__pminmax_int64_packed *)buffer;				\
+																		\
+			__atomic_add_uint32(&r->nitems, count);						\
+			__atomic_##OPER##_int64(&r->value, ival);					\
+		}																\
+		return sizeof(kagg_state__pminmax_int64_packed);				\
 	}
-	return sizeof(kagg_state__pminmax_fp64_packed);
-}
-
-INLINE_FUNCTION(int)
-__update_groupby__pmax_fp64(kern_context *kcxt,
-							char *buffer,
-							const kern_colmeta *cmeta,
-							const kern_aggregate_desc *desc)
-{
-	const xpu_datum_t *xdatum = kcxt->kvars_slot[desc->arg0_slot_id];
-	float8_t	fval;
-
-	if (__preagg_fetch_xdatum_as_float64(&fval, xdatum))
-	{
-		kagg_state__pminmax_fp64_packed *r =
-			(kagg_state__pminmax_fp64_packed *)buffer;
-
-		__atomic_add_uint32(&r->nitems, 1);
-		__atomic_min_fp64(&r->value, fval);
+__UPDATE_GROUPBY_PMINMAX_INT_TEMPLATE(pmin_int32, int32, int32_t, min, LONG_MAX)
+__UPDATE_GROUPBY_PMINMAX_INT_TEMPLATE(pmin_int64, int64, int64_t, min, LONG_MAX)
+__UPDATE_GROUPBY_PMINMAX_INT_TEMPLATE(pmax_int32, int32, int32_t, max, LONG_MIN)
+__UPDATE_GROUPBY_PMINMAX_INT_TEMPLATE(pmax_int64, int64, int64_t, max, LONG_MIN)
+
+#define __UPDATE_GROUPBY_PMINMAX_FP_TEMPLATE(NAME,OPER,IDENTITY)		\
+	INLINE_FUNCTION(int)												\
+	__update_groupby__##NAME(kern_context *kcxt,						\
+							 char *buffer,								\
+							 const kern_colmeta *cmeta,					\
+							 const kern_aggregate_desc *desc)			\
+	{																	\
+		const xpu_datum_t *xdatum = kcxt->kvars_slot[desc->arg0_slot_id]; \
+		float8_t	fval;												\
+		bool		is_valid;											\
+		uint32_t	count;												\
+																		\
+		is_valid = __preagg_fetch_xdatum_as_float64(&fval, xdatum);		\
+		if (!is_valid)													\
+			fval = IDENTITY;											\
+		count = __groupby_warp_count(kcxt, is_valid);					\
+		fval = __groupby_warp_reduce_##OPER##_fp64(kcxt, fval);			\
+		if (count > 0 && __groupby_warp_is_leader(kcxt))				\
+		{																\
+			kagg_state__pminmax_fp64_packed *r =						\
+				(kagg_state__pminmax_fp64_packed *)buffer;				\
+																		\
+			__atomic_add_uint32(&r->nitems, count);						\
+			__atomic_##OPER##_fp64(&r->value, fval);					\
+		}																\
+		return sizeof(kagg_state__pminmax_fp64_packed);					\
 	}
-	return sizeof(kagg_state__pminmax_fp64_packed);
-}
+__UPDATE_GROUPBY_PMINMAX_FP_TEMPLATE(pmin_fp64, min,  DBL_MAX)
+__UPDATE_GROUPBY_PMINMAX_FP_TEMPLATE(pmax_fp64, max, -DBL_MAX)
 
 INLINE_FUNCTION(int)
 __update_groupby__psum_int(kern_context *kcxt,
@@ -1165,13 +1366,20 @@ __update_groupby__psum_int(kern_context *kcxt,
 {
 	const xpu_datum_t *xdatum = kcxt->kvars_slot[desc->arg0_slot_id];
 	int64_t		ival;
-
-	if (__preagg_fetch_xdatum_as_int64(&ival, xdatum))
+	bool		is_valid;
+	uint32_t	count;
+
+	is_valid = __preagg_fetch_xdatum_as_int64(&ival, xdatum);
+	if (!is_valid)
+		ival = 0;
+	count = __groupby_warp_count(kcxt, is_valid);
+	ival = __groupby_warp_reduce_add_int64(kcxt, ival);
+	if (count > 0 && __groupby_warp_is_leader(kcxt))
 	{
 		kagg_state__psum_int_packed *r =
 			(kagg_state__psum_int_packed *)buffer;
 
-		__atomic_add_uint32(&r->nitems, 1);
+		__atomic_add_uint32(&r->nitems, count);
 		__atomic_add_int64(&r->sum, ival);
 	}
 	return sizeof(kagg_state__psum_int_packed);
@@ -1185,18 +1393,40 @@ __update_groupby__psum_fp(kern_context *kcxt,
 {
 	const xpu_datum_t *xdatum = kcxt->kvars_slot[desc->arg0_slot_id];
 	float8_t	fval;
-
-	if (__preagg_fetch_xdatum_as_float64(&fval, xdatum))
+	bool		is_valid;
+	uint32_t	count;
+
+	is_valid = __preagg_fetch_xdatum_as_float64(&fval, xdatum);
+	if (!is_valid)
+		fval = 0.0;
+	count = __groupby_warp_count(kcxt, is_valid);
+	fval = __groupby_warp_reduce_add_fp64(kcxt, fval);
+	if (count > 0 && __groupby_warp_is_leader(kcxt))
 	{
 		kagg_state__psum_fp_packed *r =
 			(kagg_state__psum_fp_packed *)buffer;
 
-		__atomic_add_uint32(&r->nitems, 1);
+		__atomic_add_uint32(&r->nitems, count);
 		__atomic_add_fp64(&r->sum, fval);
 	}
 	return sizeof(kagg_state__psum_fp_packed);
 }
 
+INLINE_FUNCTION(int)
+__update_groupby__psum_numeric(kern_context *kcxt,
+							   char *buffer,
+							   const kern_colmeta *cmeta,
+							   const kern_aggregate_desc *desc)
+{
+	const xpu_datum_t *xdatum = kcxt->kvars_slot[desc->arg0_slot_id];
+	xpu_numeric_t	num;
+
+	if (__preagg_fetch_xdatum_as_numeric(kcxt, &num, xdatum))
+		__preagg_update_psum_numeric((kagg_state__psum_numeric_packed *)buffer,
+									 &num);
+	return sizeof(kagg_state__psum_numeric_packed);
+}
+
 INLINE_FUNCTION(int)
 __update_groupby__pstddev(kern_context *kcxt,
 						  char *buffer,
@@ -1205,15 +1435,24 @@ __update_groupby__pstddev(kern_context *kcxt,
 {
 	const xpu_datum_t *xdatum = kcxt->kvars_slot[desc->arg0_slot_id];
 	float8_t	fval;
-
-	if (__preagg_fetch_xdatum_as_float64(&fval, xdatum))
+	float8_t	fval2;
+	bool		is_valid;
+	uint32_t	count;
+
+	is_valid = __preagg_fetch_xdatum_as_float64(&fval, xdatum);
+	if (!is_valid)
+		fval = 0.0;
+	count = __groupby_warp_count(kcxt, is_valid);
+	fval2 = __groupby_warp_reduce_add_fp64(kcxt, fval * fval);
+	fval  = __groupby_warp_reduce_add_fp64(kcxt, fval);
+	if (count > 0 && __groupby_warp_is_leader(kcxt))
 	{
 		kagg_state__stddev_packed *r =
 			(kagg_state__stddev_packed *)buffer;
 
-		__atomic_add_uint32(&r->nitems, 1);
+		__atomic_add_uint32(&r->nitems, count);
 		__atomic_add_fp64(&r->sum_x,  fval);
-		__atomic_add_fp64(&r->sum_x2, fval * fval);
+		__atomic_add_fp64(&r->sum_x2, fval2);
 	}
 	return sizeof(kagg_state__stddev_packed);
 }
@@ -1227,23 +1466,111 @@ __update_groupby__pcovar(kern_context *kcxt,
 	const xpu_datum_t *xdatum = kcxt->kvars_slot[desc->arg0_slot_id];
 	const xpu_datum_t *ydatum = kcxt->kvars_slot[desc->arg1_slot_id];
 	float8_t		xval, yval;
-
-	if (__preagg_fetch_xdatum_as_float64(&xval, xdatum) &&
-		__preagg_fetch_xdatum_as_float64(&yval, ydatum))
+	float8_t		sum_x, sum_xx, sum_y, sum_yy, sum_xy;
+	bool			is_valid;
+	uint32_t		count;
+
+	is_valid = (__preagg_fetch_xdatum_as_float64(&xval, xdatum) &&
+				__preagg_fetch_xdatum_as_float64(&yval, ydatum));
+	if (!is_valid)
+		xval = yval = 0.0;
+	count  = __groupby_warp_count(kcxt, is_valid);
+	sum_x  = __groupby_warp_reduce_add_fp64(kcxt, xval);
+	sum_xx = __groupby_warp_reduce_add_fp64(kcxt, xval * xval);
+	sum_y  = __groupby_warp_reduce_add_fp64(kcxt, yval);
+	sum_yy = __groupby_warp_reduce_add_fp64(kcxt, yval * yval);
+	sum_xy = __groupby_warp_reduce_add_fp64(kcxt, xval * yval);
+	if (count > 0 && __groupby_warp_is_leader(kcxt))
 	{
 		kagg_state__covar_packed *r =
 			(kagg_state__covar_packed *)buffer;
 
-		__atomic_add_uint32(&r->nitems, 1);
-		__atomic_add_fp64(&r->sum_x,  xval);
-		__atomic_add_fp64(&r->sum_xx, xval * xval);
-		__atomic_add_fp64(&r->sum_y,  yval);
-		__atomic_add_fp64(&r->sum_yy, yval * yval);
-		__atomic_add_fp64(&r->sum_xy, xval * yval);
+		__atomic_add_uint32(&r->nitems, count);
+		__atomic_add_fp64(&r->sum_x,  sum_x);
+		__atomic_add_fp64(&r->sum_xx, sum_xx);
+		__atomic_add_fp64(&r->sum_y,  sum_y);
+		__atomic_add_fp64(&r->sum_yy, sum_yy);
+		__atomic_add_fp64(&r->sum_xy, sum_xy);
 	}
 	return sizeof(kagg_state__covar_packed);
 }
 
+INLINE_FUNCTION(int)
+__update_groupby__hll_sketch(kern_context *kcxt,
+							 char *buffer,
+							 const kern_colmeta *cmeta,
+							 const kern_aggregate_desc *desc)
+{
+	const xpu_datum_t *xdatum = kcxt->kvars_slot[desc->arg0_slot_id];
+	uint64_t	hash;
+
+	if (__preagg_fetch_xdatum_as_hll_hash(kcxt, &hash, xdatum))
+		__update_hll_sketch_by_hash((kagg_state__hll_sketch_packed *)buffer,
+									desc->hll_nbits, hash);
+	return KAGG_STATE__HLL_SKETCH_SZ(desc->hll_nbits);
+}
+
+INLINE_FUNCTION(int)
+__update_groupby__quantile_sketch(kern_context *kcxt,
+								  char *buffer,
+								  const kern_colmeta *cmeta,
+								  const kern_aggregate_desc *desc)
+{
+	const xpu_datum_t *xdatum = kcxt->kvars_slot[desc->arg0_slot_id];
+	float8_t	fval;
+
+	if (__preagg_fetch_xdatum_as_float64(&fval, xdatum))
+	{
+		kagg_state__quantile_sketch_packed *r =
+			(kagg_state__quantile_sketch_packed *)buffer;
+
+		__atomic_add_uint64(&r->counts[pg_quantile_sketch_index(fval)], 1);
+	}
+	return KAGG_STATE__QUANTILE_SKETCH_SZ;
+}
+
+INLINE_FUNCTION(int)
+__update_groupby__string_agg(kern_context *kcxt,
+							 char *buffer,
+							 const kern_colmeta *cmeta,
+							 const kern_aggregate_desc *desc)
+{
+	/* xpu_bytea_t has identical layout */
+	const xpu_text_t *xval = (const xpu_text_t *)
+		kcxt->kvars_slot[desc->arg0_slot_id];
+	const xpu_text_t *xdel = (const xpu_text_t *)
+		kcxt->kvars_slot[desc->arg1_slot_id];
+
+	if (!XPU_DATUM_ISNULL(xval))
+	{
+		kagg_state__string_agg_packed *r =
+			(kagg_state__string_agg_packed *)buffer;
+		kagg_string_agg_item *item = (kagg_string_agg_item *)
+			kcxt->groupby_accum_buffer;
+		uint64_t	item_offset = kcxt->groupby_accum_offset;
+		uint32_t	dlen = (XPU_DATUM_ISNULL(xdel) ? 0 : xdel->length);
+		uint32_t	sz = KAGG_STRING_AGG_ITEM_SZ(dlen, xval->length);
+		uint64_t	oldval;
+
+		/* already reserved by __reserveGpuPreAggAccumBuffer */
+		assert(item != NULL && xval->length >= 0);
+		item->dlen = dlen;
+		item->vlen = xval->length;
+		if (dlen > 0)
+			memcpy(item->data, xdel->value, dlen);
+		memcpy(item->data + dlen, xval->value, xval->length);
+		kcxt->groupby_accum_buffer += sz;
+		kcxt->groupby_accum_offset -= sz;
+		/* push the item to the chain */
+		oldval = __atomic_exchange_uint64(&r->head, item_offset);
+		item->next = oldval;
+		if (oldval == 0)
+			r->tail = item_offset;
+		__atomic_add_uint32(&r->nitems, 1);
+	}
+	return KAGG_STATE__STRING_AGG_SZ;
+}
+
 /*
  * __updateOneTupleGroupBy
  */
@@ -1315,12 +1642,25 @@ __updateOneTupleGroupBy(kern_context *kcxt,
 			case KAGG_ACTION__PSUM_FP:
 				curr += __update_groupby__psum_fp(kcxt, curr, cmeta, desc);
 				break;
+			case KAGG_ACTION__PAVG_NUMERIC:
+			case KAGG_ACTION__PSUM_NUMERIC:
+				curr += __update_groupby__psum_numeric(kcxt, curr, cmeta, desc);
+				break;
 			case KAGG_ACTION__STDDEV:
 				curr += __update_groupby__pstddev(kcxt, curr, cmeta, desc);
 				break;
 			case KAGG_ACTION__COVAR:
 				curr += __update_groupby__pcovar(kcxt, curr, cmeta, desc);
 				break;
+			case KAGG_ACTION__HLL_SKETCH:
+				curr += __update_groupby__hll_sketch(kcxt, curr, cmeta, desc);
+				break;
+			case KAGG_ACTION__QUANTILE_SKETCH:
+				curr += __update_groupby__quantile_sketch(kcxt, curr, cmeta, desc);
+				break;
+			case KAGG_ACTION__STRING_AGG:
+				curr += __update_groupby__string_agg(kcxt, curr, cmeta, desc);
+				break;
 			default:
 				/*
 				 * No more partial aggregation exists after grouping-keys
@@ -1332,6 +1672,162 @@ bailout:
 	assert(curr == groupby_prepfn_buffer + kcxt->groupby_prepfn_bufsz);
 }
 
+/*
+ * __compareGpuPreAggGroupKeys
+ */
+INLINE_FUNCTION(bool)
+__compareGpuPreAggGroupKeys(kern_context *kcxt,
+							kern_data_store *kds_final,
+							kern_hashitem *hitem,
+							kern_expression *kexp_groupby_keyload,
+							kern_expression *kexp_groupby_keycomp)
+{
+	bool		saved_compare_nulls = kcxt->kmode_compare_nulls;
+	bool		retval = false;
+	xpu_bool_t	status;
+
+	kcxt->kmode_compare_nulls = true;
+	ExecLoadVarsHeapTuple(kcxt, kexp_groupby_keyload,
+						  -2,
+						  kds_final,
+						  &hitem->t.htup);
+	if (EXEC_KERN_EXPRESSION(kcxt, kexp_groupby_keycomp, &status))
+		retval = (!XPU_DATUM_ISNULL(&status) && status.value);
+	kcxt->kmode_compare_nulls = saved_compare_nulls;
+
+	return retval;
+}
+
+/*
+ * __lookupGpuPreAggLocalHash
+ *
+ * It looks up the per-block local hash-slots, that map the grouping keys to
+ * the result tuples whose partial states are kept on the prepfn buffer.
+ * Hot groups are found without the global hash chain nor its slot lock.
+ */
+STATIC_FUNCTION(kern_hashitem *)
+__lookupGpuPreAggLocalHash(kern_context *kcxt,
+						   kern_data_store *kds_final,
+						   uint32_t hash,
+						   kern_expression *kexp_groupby_keyload,
+						   kern_expression *kexp_groupby_keycomp)
+{
+	uint32_t	nslots = kcxt->groupby_local_nslots;
+	uint32_t	index = hash % nslots;
+
+	for (uint32_t count=0; count < nslots; count++)
+	{
+		uint64_t	hslot = __volatileRead(&kcxt->groupby_local_hslots[index]);
+		kern_tupitem *tupitem;
+
+		if (hslot == ULONG_MAX)
+			break;		/* not found */
+		if ((uint32_t)(hslot >> 32) == hash &&
+			(tupitem = KDS_GET_TUPITEM(kds_final, (uint32_t)hslot)) != NULL)
+		{
+			kern_hashitem *hitem = (kern_hashitem *)
+				((char *)tupitem - offsetof(kern_hashitem, t));
+
+			if (__compareGpuPreAggGroupKeys(kcxt, kds_final, hitem,
+											kexp_groupby_keyload,
+											kexp_groupby_keycomp))
+				return hitem;
+		}
+		index = (index + 1) % nslots;
+	}
+	return NULL;
+}
+
+/*
+ * __insertGpuPreAggLocalHash
+ */
+STATIC_FUNCTION(void)
+__insertGpuPreAggLocalHash(kern_context *kcxt,
+						   uint32_t hash, uint32_t rowid)
+{
+	uint32_t	nslots = kcxt->groupby_local_nslots;
+	uint32_t	index = hash % nslots;
+	uint64_t	newval = (((uint64_t)hash << 32) | (uint64_t)rowid);
+
+	assert(rowid < kcxt->groupby_prepfn_nbufs);
+	for (uint32_t count=0; count < nslots; count++)
+	{
+		uint64_t   *hslot = &kcxt->groupby_local_hslots[index];
+		uint64_t	oldval = __volatileRead(hslot);
+
+		if (oldval == ULONG_MAX)
+		{
+			oldval = __atomic_cas_uint64(hslot, ULONG_MAX, newval);
+			if (oldval == ULONG_MAX)
+				break;		/* inserted */
+		}
+		if (oldval == newval)
+			break;			/* concurrent insertion by other threads */
+		index = (index + 1) % nslots;
+	}
+	/* elsewhere, local hash-slots are full; the global hash is used */
+}
+
+/*
+ * __reserveGpuPreAggAccumBuffer
+ *
+ * It reserves the extent on the kds_final for the items of STRING_AGG prior
+ * to the update of the group, because the update cannot be retried once the
+ * other aggregates are updated.
+ */
+STATIC_FUNCTION(bool)
+__reserveGpuPreAggAccumBuffer(kern_context *kcxt,
+							  kern_data_store *kds_final,
+							  const kern_expression *kexp_groupby_actions,
+							  bool *p_try_suspend)
+{
+	uint64_t	required = 0;
+	uint64_t	usage;
+
+	kcxt->groupby_accum_buffer = NULL;
+	kcxt->groupby_accum_offset = 0;
+	for (int j=0; j < kexp_groupby_actions->u.pagg.nattrs; j++)
+	{
+		const kern_aggregate_desc *desc = &kexp_groupby_actions->u.pagg.desc[j];
+		xpu_text_t *xval;
+		xpu_text_t *xdel;
+		uint32_t	dlen = 0;
+
+		if (desc->action != KAGG_ACTION__STRING_AGG)
+			continue;
+		/* decompress the values in-place, if needed */
+		xval = (xpu_text_t *)kcxt->kvars_slot[desc->arg0_slot_id];
+		if (XPU_DATUM_ISNULL(xval))
+			continue;
+		if (!xpu_text_is_valid(kcxt, xval))
+			return false;
+		xdel = (xpu_text_t *)kcxt->kvars_slot[desc->arg1_slot_id];
+		if (!XPU_DATUM_ISNULL(xdel))
+		{
+			if (!xpu_text_is_valid(kcxt, xdel))
+				return false;
+			dlen = xdel->length;
+		}
+		required += KAGG_STRING_AGG_ITEM_SZ(dlen, xval->length);
+	}
+	if (required == 0)
+		return true;
+
+	usage = __atomic_add_uint64(&kds_final->__usage64, required);
+	if (!__KDS_CHECK_OVERFLOW(kds_final,
+							  __volatileRead(&kds_final->nitems),
+							  usage + required))
+	{
+		*p_try_suspend = true;	/* out of memory */
+		return true;
+	}
+	kcxt->groupby_accum_offset = usage + required;
+	kcxt->groupby_accum_buffer = ((char *)kds_final
+								  + kds_final->length
+								  - kcxt->groupby_accum_offset);
+	return true;
+}
+
 STATIC_FUNCTION(int)
 __execGpuPreAggGroupBy(kern_context *kcxt,
 					   kern_data_store *kds_final,
@@ -1344,6 +1840,7 @@ __execGpuPreAggGroupBy(kern_context *kcxt,
 {
 	kern_hashitem *hitem = NULL;
 	xpu_int4_t	hash;
+	bool		local_found = false;
 
 	assert(kds_final->format == KDS_FORMAT_HASH);
 	/*
@@ -1358,6 +1855,31 @@ __execGpuPreAggGroupBy(kern_context *kcxt,
 	if (__syncthreads_count(kcxt->errcode != ERRCODE_STROM_SUCCESS) > 0)
 		return false;
 
+	/*
+	 * reserve the extent for STRING_AGG, if any
+	 */
+	if (source_is_valid)
+		__reserveGpuPreAggAccumBuffer(kcxt, kds_final,
+									  kexp_groupby_actions,
+									  p_try_suspend);
+	if (__syncthreads_count(*p_try_suspend) > 0)
+		return false;
+	if (__syncthreads_count(kcxt->errcode != ERRCODE_STROM_SUCCESS) > 0)
+		return false;
+
+	/*
+	 * lookup the local hash-slots first, if any
+	 */
+	if (kcxt->groupby_local_hslots && !XPU_DATUM_ISNULL(&hash))
+	{
+		hitem = __lookupGpuPreAggLocalHash(kcxt, kds_final, hash.value,
+										   kexp_groupby_keyload,
+										   kexp_groupby_keycomp);
+		local_found = (hitem != NULL);
+	}
+	if (__syncthreads_count(kcxt->errcode != ERRCODE_STROM_SUCCESS) > 0)
+		return false;
+
 	/*
 	 * lookup the destination grouping tuple. if not found, create a new one.
 	 */
@@ -1368,7 +1890,6 @@ __execGpuPreAggGroupBy(kern_context *kcxt,
 			uint64_t	hoffset;
 			uint64_t	saved;
 			bool		has_lock = false;
-			xpu_bool_t	status;
 
 			hoffset = __volatileRead(hslot);
 		try_again:
@@ -1376,22 +1897,11 @@ __execGpuPreAggGroupBy(kern_context *kcxt,
 				 hitem != NULL;
 				 hitem = KDS_HASH_NEXT_ITEM(kds_final, hitem->next))
 			{
-				bool	saved_compare_nulls = kcxt->kmode_compare_nulls;
-
-				if (hitem->hash != hash.value)
-					continue;
-				kcxt->kmode_compare_nulls = true;
-				ExecLoadVarsHeapTuple(kcxt, kexp_groupby_keyload,
-									  -2,
-									  kds_final,
-									  &hitem->t.htup);
-				if (EXEC_KERN_EXPRESSION(kcxt, kexp_groupby_keycomp, &status))
-				{
-					kcxt->kmode_compare_nulls = saved_compare_nulls;
-					if (!XPU_DATUM_ISNULL(&status) && status.value)
-						break;
-				}
-				kcxt->kmode_compare_nulls = saved_compare_nulls;
+				if (hitem->hash == hash.value &&
+					__compareGpuPreAggGroupKeys(kcxt, kds_final, hitem,
+												kexp_groupby_keyload,
+												kexp_groupby_keycomp))
+					break;
 			}
 
 			if (!hitem)
@@ -1455,17 +1965,27 @@ __execGpuPreAggGroupBy(kern_context *kcxt,
 	if (hitem)
 	{
 		char   *prepfn_buffer = NULL;
+		char   *dest;
 
 		if (kcxt->groupby_prepfn_buffer &&
 			hitem->t.rowid < kcxt->groupby_prepfn_nbufs)
 		{
 			prepfn_buffer = kcxt->groupby_prepfn_buffer
 				+ hitem->t.rowid * kcxt->groupby_prepfn_bufsz;
+			if (kcxt->groupby_local_hslots && !local_found)
+				__insertGpuPreAggLocalHash(kcxt, hash.value, hitem->t.rowid);
 		}
+		/* pick up the peer threads that update the same group */
+		dest = (prepfn_buffer ? prepfn_buffer : (char *)&hitem->t.htup);
+		kcxt->groupby_warp_mask  = __activemask();
+		kcxt->groupby_warp_peers = __match_any_sync(kcxt->groupby_warp_mask,
+													(unsigned long long)dest);
 		__updateOneTupleGroupBy(kcxt, kds_final,
 								&hitem->t.htup,
 								prepfn_buffer,
 								kexp_groupby_actions);
+		kcxt->groupby_warp_mask  = 0;
+		kcxt->groupby_warp_peers = 0;
 	}
 	return true;
 }
@@ -1552,6 +2072,13 @@ __setupGpuPreAggGroupByBufferOne(kern_context *kcxt,
 				pos += sizeof(kagg_state__psum_fp_packed);
 				break;
 
+			case KAGG_ACTION__PSUM_NUMERIC:
+			case KAGG_ACTION__PAVG_NUMERIC:
+				__preagg_init_psum_numeric((kagg_state__psum_numeric_packed *)pos,
+										   desc->num_weight);
+				pos += sizeof(kagg_state__psum_numeric_packed);
+				break;
+
 			case KAGG_ACTION__STDDEV:
 				memset(pos, 0, sizeof(kagg_state__stddev_packed));
 				SET_VARSIZE(pos, sizeof(kagg_state__stddev_packed));
@@ -1564,6 +2091,37 @@ __setupGpuPreAggGroupByBufferOne(kern_context *kcxt,
 				pos += sizeof(kagg_state__covar_packed);
 				break;
 
+			case KAGG_ACTION__HLL_SKETCH:
+				{
+					kagg_state__hll_sketch_packed *r =
+						(kagg_state__hll_sketch_packed *)pos;
+					uint32_t	sz = KAGG_STATE__HLL_SKETCH_SZ(desc->hll_nbits);
+
+					memset(r, 0, sz);
+					r->nrooms = (1U << desc->hll_nbits);
+					SET_VARSIZE(r, sz);
+					pos += sz;
+				}
+				break;
+
+			case KAGG_ACTION__QUANTILE_SKETCH:
+				{
+					kagg_state__quantile_sketch_packed *r =
+						(kagg_state__quantile_sketch_packed *)pos;
+
+					memset(r, 0, KAGG_STATE__QUANTILE_SKETCH_SZ);
+					r->ncounters = KAGG_QSKETCH_NCOUNTERS;
+					SET_VARSIZE(r, KAGG_STATE__QUANTILE_SKETCH_SZ);
+					pos += KAGG_STATE__QUANTILE_SKETCH_SZ;
+				}
+				break;
+
+			case KAGG_ACTION__STRING_AGG:
+				memset(pos, 0, KAGG_STATE__STRING_AGG_SZ);
+				SET_VARSIZE(pos, KAGG_STATE__STRING_AGG_SZ);
+				pos += KAGG_STATE__STRING_AGG_SZ;
+				break;
+
 			default:
 				/* no more prep-function should exist after the keyref */
 				goto bailout;
@@ -1604,6 +2162,20 @@ setupGpuPreAggGroupByBuffer(kern_context *kcxt,
 							   kcxt->groupby_prepfn_bufsz * index);
 				__setupGpuPreAggGroupByBufferOne(kcxt, kexp_actions, pos);
 			}
+			/* local hash-slots, next to the prepfn buffer */
+			if (kgtask->groupby_local_nslots > 0)
+			{
+				kcxt->groupby_local_nslots = kgtask->groupby_local_nslots;
+				kcxt->groupby_local_hslots = (uint64_t *)
+					(kcxt->groupby_prepfn_buffer +
+					 kcxt->groupby_prepfn_bufsz * kcxt->groupby_prepfn_nbufs);
+				for (index = get_local_id();
+					 index < kcxt->groupby_local_nslots;
+					 index += get_local_size())
+				{
+					kcxt->groupby_local_hslots[index] = ULONG_MAX;
+				}
+			}
 		}
 		else
 		{
@@ -1747,6 +2319,19 @@ __mergeGpuPreAggGroupByBufferOne(kern_context *kcxt,
 				}
 				break;
 
+			case KAGG_ACTION__PSUM_NUMERIC:
+			case KAGG_ACTION__PAVG_NUMERIC:
+				{
+					const kagg_state__psum_numeric_packed *s =
+						(const kagg_state__psum_numeric_packed *)pos;
+					kagg_state__psum_numeric_packed *r =
+						(kagg_state__psum_numeric_packed *)((char *)htup + t_hoff);
+					if (s->nitems > 0)
+						__preagg_merge_psum_numeric(r, s);
+					nbytes = sizeof(kagg_state__psum_numeric_packed);
+				}
+				break;
+
 			case KAGG_ACTION__STDDEV:
 				{
 					const kagg_state__stddev_packed *s =
@@ -1782,6 +2367,66 @@ __mergeGpuPreAggGroupByBufferOne(kern_context *kcxt,
 				}
 				break;
 
+			case KAGG_ACTION__HLL_SKETCH:
+				{
+					const kagg_state__hll_sketch_packed *s =
+						(const kagg_state__hll_sketch_packed *)pos;
+					kagg_state__hll_sketch_packed *r =
+						(kagg_state__hll_sketch_packed *)((char *)htup + t_hoff);
+					const uint32_t *s_regs = (const uint32_t *)s->regs;
+					uint32_t   *r_regs = (uint32_t *)r->regs;
+
+					assert(s->nrooms == r->nrooms);
+					for (int k=0; k < s->nrooms / sizeof(uint32_t); k++)
+					{
+						if (s_regs[k] != 0)
+							__atomic_max_hll_registers(&r_regs[k], s_regs[k]);
+					}
+					nbytes = KAGG_STATE__HLL_SKETCH_SZ(desc->hll_nbits);
+				}
+				break;
+
+			case KAGG_ACTION__QUANTILE_SKETCH:
+				{
+					const kagg_state__quantile_sketch_packed *s =
+						(const kagg_state__quantile_sketch_packed *)pos;
+					kagg_state__quantile_sketch_packed *r =
+						(kagg_state__quantile_sketch_packed *)((char *)htup + t_hoff);
+
+					assert(s->ncounters == r->ncounters);
+					for (int k=0; k < s->ncounters; k++)
+					{
+						if (s->counts[k] != 0)
+							__atomic_add_uint64(&r->counts[k], s->counts[k]);
+					}
+					nbytes = KAGG_STATE__QUANTILE_SKETCH_SZ;
+				}
+				break;
+
+			case KAGG_ACTION__STRING_AGG:
+				{
+					const kagg_state__string_agg_packed *s =
+						(const kagg_state__string_agg_packed *)pos;
+					kagg_state__string_agg_packed *r =
+						(kagg_state__string_agg_packed *)((char *)htup + t_hoff);
+
+					if (s->nitems > 0)
+					{
+						kagg_string_agg_item *s_tail = (kagg_string_agg_item *)
+							((char *)kds_final + kds_final->length - s->tail);
+						uint64_t	oldval;
+
+						/* link the local chain to the head of the global one */
+						oldval = __atomic_exchange_uint64(&r->head, s->head);
+						s_tail->next = oldval;
+						if (oldval == 0)
+							r->tail = s->tail;
+						__atomic_add_uint32(&r->nitems, s->nitems);
+					}
+					nbytes = KAGG_STATE__STRING_AGG_SZ;
+				}
+				break;
+
 			default:
 				goto bailout;
 		}
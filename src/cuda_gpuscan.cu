@@ -484,61 +484,102 @@ kds_column_get_sysattr(const kern_data_store *kds, uint32_t rowid)
 }
 
 STATIC_FUNCTION(bool)
-kds_column_check_visibility(kern_context *kcxt,
-							const kern_data_store *kds,
-							uint32_t rowid)
+__gpucache_check_visibility(kern_context *kcxt,
+							uint32_t xmin,
+							uint32_t xmax)
 {
 	SerializedTransactionState *xstate = SESSION_XACT_STATE(kcxt->session);
-	GpuCacheSysattr *sysattr = kds_column_get_sysattr(kds, rowid);
 
-	assert(xstate != NULL && sysattr != NULL);
+	assert(xstate != NULL);
 
-	if (sysattr->xmin == InvalidTransactionId)
+	if (xmin == InvalidTransactionId)
 		return false;
-	if (sysattr->xmin != FrozenTransactionId)
+	if (xmin != FrozenTransactionId)
 	{
 		for (int i=0; i < xstate->nParallelCurrentXids; i++)
 		{
-			if (sysattr->xmin == xstate->parallelCurrentXids[i])
+			if (xmin == xstate->parallelCurrentXids[i])
 				goto xmin_is_visible;
 		}
 		return false;
 	}
 xmin_is_visible:
-	if (sysattr->xmax == InvalidTransactionId)
+	if (xmax == InvalidTransactionId)
 		return true;
-	if (sysattr->xmax == FrozenTransactionId)
+	if (xmax == FrozenTransactionId)
 		return false;
 	for (int i=0; i < xstate->nParallelCurrentXids; i++)
 	{
-		if (sysattr->xmax == xstate->parallelCurrentXids[i])
+		if (xmax == xstate->parallelCurrentXids[i])
 			return false;
 	}
 	return true;
 }
 
+STATIC_FUNCTION(bool)
+kds_column_check_visibility(kern_context *kcxt,
+							const kern_data_store *kds,
+							uint32_t rowid)
+{
+	GpuCacheSysattr *sysattr = kds_column_get_sysattr(kds, rowid);
+
+	assert(sysattr != NULL);
+	return __gpucache_check_visibility(kcxt, sysattr->xmin, sysattr->xmax);
+}
+
+/*
+ * kds_column_lookup_delta - returns the delta item of the rowid, if any
+ */
+INLINE_FUNCTION(const kern_gpucache_delta_item *)
+kds_column_lookup_delta(const kern_gpucache_delta *gcache_delta,
+						uint32_t rowid)
+{
+	uint32_t	head = 0;
+	uint32_t	tail = gcache_delta->nitems;
+
+	while (head < tail)
+	{
+		uint32_t	curr = (head + tail) / 2;
+		const kern_gpucache_delta_item *ditem = &gcache_delta->items[curr];
+
+		if (ditem->rowid == rowid)
+			return ditem;
+		if (ditem->rowid < rowid)
+			head = curr + 1;
+		else
+			tail = curr;
+	}
+	return NULL;
+}
+
 STATIC_FUNCTION(int)
 __gpuscan_load_source_column(kern_context *kcxt,
 							 kern_warp_context *wp,
 							 const kern_data_store *kds_src,
 							 const kern_data_extra *kds_extra,
+							 const kern_gpucache_delta *gcache_delta,
 							 const kern_expression *kexp_load_vars,
 							 const kern_expression *kexp_scan_quals,
 							 const kern_expression *kexp_move_vars,
 							 char *dst_kvecs_buffer)
 {
+	const kern_gpucache_delta_item *ditem = NULL;
+	uint32_t	nitems = kds_src->nitems;
 	uint32_t	count;
 	uint32_t	index;
 	uint32_t	wr_pos;
 	bool		is_valid = false;
 
+	/* rows inserted by the pending REDO logs also should be scanned */
+	if (gcache_delta && nitems < gcache_delta->nrooms)
+		nitems = gcache_delta->nrooms;
 	/* fetch next blockSize tuples */
 	count = wp->smx_row_count;
 	__syncthreads();
 	if (get_local_id() == 0)
 		wp->smx_row_count++;
 	index = get_global_size() * count + get_global_base();
-	if (index >= kds_src->nitems)
+	if (index >= nitems)
 	{
 		if (get_local_id() == 0)
 			wp->scan_done = 1;
@@ -549,8 +590,36 @@ __gpuscan_load_source_column(kern_context *kcxt,
 	/*
 	 * fetch the outer tuple to scan
 	 */
-	if (index < kds_src->nitems &&
-		kds_column_check_visibility(kcxt, kds_src, index))
+	if (gcache_delta && index < nitems)
+		ditem = kds_column_lookup_delta(gcache_delta, index);
+	if (ditem)
+	{
+		/* merge-on-read of the pending REDO logs */
+		if (__gpucache_check_visibility(kcxt, ditem->xmin, ditem->xmax))
+		{
+			if (ditem->htup_offset != 0)
+			{
+				const HeapTupleHeaderData *htup = (const HeapTupleHeaderData *)
+					((const char *)gcache_delta + __kds_unpack(ditem->htup_offset));
+
+				if (ExecLoadVarsOuterRow(kcxt,
+										 kexp_load_vars,
+										 kexp_scan_quals,
+										 kds_src,
+										 htup))
+					is_valid = true;
+			}
+			else if (ExecLoadVarsOuterColumn(kcxt,
+											 kexp_load_vars,
+											 kexp_scan_quals,
+											 kds_src,
+											 kds_extra,
+											 index))
+				is_valid = true;
+		}
+	}
+	else if (index < kds_src->nitems &&
+			 kds_column_check_visibility(kcxt, kds_src, index))
 	{
 		if (ExecLoadVarsOuterColumn(kcxt,
 									kexp_load_vars,
@@ -592,6 +661,7 @@ execGpuScanLoadSource(kern_context *kcxt,
 					  kern_warp_context *wp,
 					  const kern_data_store *kds_src,
 					  const kern_data_extra *kds_extra,
+					  const kern_gpucache_delta *gcache_delta,
 					  const kern_expression *kexp_load_vars,
 					  const kern_expression *kexp_scan_quals,
 					  const kern_expression *kexp_move_vars,
@@ -636,6 +706,7 @@ execGpuScanLoadSource(kern_context *kcxt,
 			return __gpuscan_load_source_column(kcxt, wp,
 												kds_src,
 												kds_extra,
+												gcache_delta,
 												kexp_load_vars,
 												kexp_scan_quals,
 												kexp_move_vars,
@@ -728,6 +799,57 @@ gpucache_assign_update_owner(kern_context *kcxt,
 	}
 }
 
+/*
+ * __gpucache_for_encode_value - frame-of-reference encoding
+ */
+STATIC_FUNCTION(bool)
+__gpucache_for_encode_value(kern_context *kcxt,
+							const kern_colmeta *cmeta,
+							char *base,
+							uint32_t rowid,
+							const char *addr)
+{
+	int64_t		ival;
+	int64_t		delta;
+	int64_t		limit = (1L << (8 * cmeta->for_unitsz - 1));
+
+	switch (cmeta->attlen)
+	{
+		case sizeof(int16_t):
+			ival = *((const int16_t *)addr);
+			break;
+		case sizeof(int32_t):
+			ival = *((const int32_t *)addr);
+			break;
+		case sizeof(int64_t):
+			ival = *((const int64_t *)addr);
+			break;
+		default:
+			STROM_ELOG(kcxt, "gpucache: unexpected encoded column length");
+			return false;
+	}
+	/* backend already checked the range, so it should never happen */
+	if (__builtin_sub_overflow(ival, cmeta->for_base, &delta) ||
+		delta < -limit || delta >= limit)
+	{
+		STROM_ELOG(kcxt, "gpucache: value out of range for frame-of-reference encoding");
+		return false;
+	}
+	switch (cmeta->for_unitsz)
+	{
+		case sizeof(int8_t):
+			((int8_t *)base)[rowid] = (int8_t)delta;
+			break;
+		case sizeof(int16_t):
+			((int16_t *)base)[rowid] = (int16_t)delta;
+			break;
+		default:
+			((int32_t *)base)[rowid] = (int32_t)delta;
+			break;
+	}
+	return true;
+}
+
 STATIC_FUNCTION(bool)
 __gpucache_apply_insert_log(kern_context *kcxt,
 							kern_data_store *kds,
@@ -746,6 +868,26 @@ __gpucache_apply_insert_log(kern_context *kcxt,
 		const kern_colmeta *cmeta = &kds->colmeta[j];
 		char	   *base;
 
+		if (cmeta->values_offset == 0)
+		{
+			/* not a cached column, so just skip it */
+			if (heap_hasnull && att_isnull(j, htup->t_bits))
+				continue;
+			if (cmeta->attlen > 0)
+			{
+				offset = TYPEALIGN(cmeta->attalign, offset);
+				offset += cmeta->attlen;
+			}
+			else
+			{
+				assert(cmeta->attlen == -1);
+				if (!VARATT_NOT_PAD_BYTE((char *)htup + offset))
+					offset = TYPEALIGN(cmeta->attalign, offset);
+				offset += VARSIZE_ANY((char *)htup + offset);
+			}
+			continue;
+		}
+
 		if (cmeta->nullmap_offset != 0)
 		{
 			uint32_t   *nullmap = (uint32_t *)
@@ -775,9 +917,18 @@ __gpucache_apply_insert_log(kern_context *kcxt,
 		if (cmeta->attlen > 0)
 		{
 			offset = TYPEALIGN(cmeta->attalign, offset);
-			memcpy(base + cmeta->attlen * rowid,
-				   (char *)htup + offset,
-				   cmeta->attlen);
+			if (cmeta->for_unitsz > 0)
+			{
+				if (!__gpucache_for_encode_value(kcxt, cmeta, base, rowid,
+												 (char *)htup + offset))
+					return false;
+			}
+			else
+			{
+				memcpy(base + cmeta->attlen * rowid,
+					   (char *)htup + offset,
+					   cmeta->attlen);
+			}
 			offset += cmeta->attlen;
 		}
 		else
@@ -912,7 +1063,7 @@ __gpucache_count_deadspace(kern_data_store *kds,
 		{
 			const kern_colmeta *cmeta = &kds->colmeta[j];
 
-			if (cmeta->attlen > 0)
+			if (cmeta->attlen > 0 || cmeta->values_offset == 0)
 				continue;
 			assert(cmeta->attlen == -1);
 			if (!KDS_COLUMN_ITEM_ISNULL(kds, cmeta, rowid))
@@ -1078,7 +1229,7 @@ kern_gpucache_compaction(kern_data_store *kds,
 			uint32_t		vl_len;
 			uint64_t		offset;
 
-			if (cmeta->attlen >= 0)
+			if (cmeta->attlen >= 0 || cmeta->values_offset == 0)
 				continue;
 			if (cmeta->nullmap_offset != 0)
 			{
@@ -1102,3 +1253,529 @@ kern_gpucache_compaction(kern_data_store *kds,
 		}
 	}
 }
+
+/*
+ * kern_gpucache_compaction_segment
+ *
+ * It compacts the varlena values located at [seg_head, seg_tail) of the
+ * extra buffer in-place. The phase-1 estimates the required size of the
+ * staging buffer; the phase-2 moves the values to the staging buffer, and
+ * re-assign the offset of the final location (dst_base + offset in the
+ * staging buffer). The host code copies the staging buffer to dst_base,
+ * which never overlaps with the values not compacted yet.
+ */
+KERNEL_FUNCTION(void)
+kern_gpucache_compaction_segment(kern_data_store *kds,
+								 kern_data_extra *extra,
+								 kern_data_extra *extra_tmp,
+								 uint64_t seg_head,
+								 uint64_t seg_tail,
+								 uint64_t dst_base,
+								 int phase)
+{
+	uint32_t	index;
+
+	for (index = get_global_id();
+		 index < kds->nitems;
+		 index += get_global_size())
+	{
+		for (int j=0; j < kds->ncols; j++)
+		{
+			kern_colmeta   *cmeta = &kds->colmeta[j];
+			uint32_t	   *values;
+			uint64_t		vl_off;
+			char		   *vl_src;
+			uint32_t		vl_len;
+			uint64_t		offset;
+
+			if (cmeta->attlen >= 0 || cmeta->values_offset == 0)
+				continue;
+			if (cmeta->nullmap_offset != 0)
+			{
+				uint8_t	   *nullmap = (uint8_t *)
+					((char *)kds + __kds_unpack(cmeta->nullmap_offset));
+
+				if (att_isnull(index, nullmap))
+					continue;
+			}
+			values = (uint32_t *)
+				((char *)kds + __kds_unpack(cmeta->values_offset));
+			vl_off = __kds_unpack(values[index]);
+			if (vl_off < seg_head || vl_off >= seg_tail)
+				continue;
+			vl_src = ((char *)extra + vl_off);
+			vl_len = VARSIZE_ANY(vl_src);
+
+			offset = __atomic_add_uint64(&extra_tmp->usage, MAXALIGN(vl_len));
+			if (phase == 2)
+			{
+				assert(offset + vl_len <= extra_tmp->length);
+				memcpy((char *)extra_tmp + offset, vl_src, vl_len);
+				values[index] = __kds_packed(dst_base + offset -
+											 offsetof(kern_data_extra, data));
+			}
+		}
+	}
+}
+
+/*
+ * GPU Top-N selection / GPU Sort
+ *
+ * __gpuscan_fetch_sortkey() returns the order-preserving 64bit key of the
+ * leading sort key; the smaller key is always the better one, regardless
+ * of ASC/DESC. NULLs are reported separately, because any 64bit keys may
+ * be valid for int8 or timestamp values.
+ */
+STATIC_FUNCTION(uint64_t)
+__gpuscan_fetch_sortkey(const kern_data_store *kds,
+						const kern_tupitem *tupitem,
+						int sortkey_resno,
+						int sortkey_flags,
+						bool *p_isnull)
+{
+	const HeapTupleHeaderData *htup = &tupitem->htup;
+	uint32_t	offset = htup->t_hoff;
+	int			ncols = Min(htup->t_infomask2 & HEAP_NATTS_MASK, kds->ncols);
+	bool		heap_hasnull = ((htup->t_infomask & HEAP_HASNULL) != 0);
+	const kern_colmeta *cmeta = NULL;
+	const char *addr = NULL;
+	uint64_t	key;
+
+	for (int j=0; j < sortkey_resno && j < ncols; j++)
+	{
+		cmeta = &kds->colmeta[j];
+		if (heap_hasnull && att_isnull(j, htup->t_bits))
+		{
+			addr = NULL;
+			continue;
+		}
+		if (cmeta->attlen > 0)
+			offset = TYPEALIGN(cmeta->attalign, offset);
+		else if (!VARATT_NOT_PAD_BYTE((const char *)htup + offset))
+			offset = TYPEALIGN(cmeta->attalign, offset);
+		addr = ((const char *)htup + offset);
+		if (cmeta->attlen > 0)
+			offset += cmeta->attlen;
+		else
+			offset += VARSIZE_ANY(addr);
+	}
+	if (sortkey_resno > ncols || !addr)
+	{
+		*p_isnull = true;
+		return 0UL;
+	}
+	*p_isnull = false;
+
+	if ((sortkey_flags & KERN_SORTKEY__FLOAT_KEY) != 0)
+	{
+		float8_t	fval;
+
+		if (cmeta->attlen == sizeof(float4_t))
+			fval = *((const float4_t *)addr);
+		else
+			fval = *((const float8_t *)addr);
+		if (isnan(fval))
+			key = ULONG_MAX - 1;	/* NaN is larger than any other values */
+		else
+		{
+			if (fval == 0.0)
+				fval = 0.0;			/* -0.0 equals to +0.0 */
+			key = __double_as_longlong__(fval);
+			if ((key & (1UL<<63)) != 0)
+				key = ~key;
+			else
+				key |= (1UL<<63);
+		}
+	}
+	else
+	{
+		int64_t		ival;
+
+		switch (cmeta->attlen)
+		{
+			case sizeof(int16_t):
+				ival = *((const int16_t *)addr);
+				break;
+			case sizeof(int32_t):
+				ival = *((const int32_t *)addr);
+				break;
+			default:
+				ival = *((const int64_t *)addr);
+				break;
+		}
+		key = ((uint64_t)ival ^ (1UL<<63));
+	}
+	if ((sortkey_flags & KERN_SORTKEY__DESC) != 0)
+		key = ~key;
+	return key;
+}
+
+/*
+ * __gpuscan_topk_fetch_key
+ *
+ * NULLs are mapped to the smallest or largest key for Top-N selection.
+ * Duplicated keys never eliminate the rows to be returned, because the
+ * compaction keeps all the rows equivalent to the threshold.
+ */
+INLINE_FUNCTION(uint64_t)
+__gpuscan_topk_fetch_key(const kern_data_store *kds,
+						 const kern_tupitem *tupitem,
+						 const kern_gputopk_buffer *topk)
+{
+	uint64_t	key;
+	bool		isnull;
+
+	key = __gpuscan_fetch_sortkey(kds, tupitem,
+								  topk->sortkey_resno,
+								  topk->sortkey_flags, &isnull);
+	if (isnull)
+		return ((topk->sortkey_flags & KERN_SORTKEY__NULLS_FIRST) != 0 ? 0UL : ULONG_MAX);
+	return key;
+}
+
+/*
+ * kern_gpuscan_topk_histogram
+ *
+ * It makes histogram of the radix digit at topk_shift, for the keys that
+ * match with topk_prefix on the upper digits. The first call (topk_shift=56)
+ * also extracts the keys of the rows.
+ */
+KERNEL_FUNCTION(void)
+kern_gpuscan_topk_histogram(kern_data_store *kds,
+							kern_gputopk_buffer *topk)
+{
+	__shared__ uint32_t	smx_histogram[256];
+	uint32_t	shift = topk->topk_shift;
+	uint32_t	index;
+
+	for (int i=get_local_id(); i < 256; i += get_local_size())
+		smx_histogram[i] = 0;
+	__syncthreads();
+	for (index = get_global_id();
+		 index < kds->nitems;
+		 index += get_global_size())
+	{
+		uint64_t	key;
+
+		if (shift == 56)
+		{
+			kern_tupitem *tupitem = KDS_GET_TUPITEM(kds, index);
+
+			key = (tupitem ? __gpuscan_topk_fetch_key(kds, tupitem, topk) : ULONG_MAX);
+			topk->keys[index] = key;
+		}
+		else
+		{
+			key = topk->keys[index];
+			if (((key ^ topk->topk_prefix) >> (shift + 8)) != 0)
+				continue;
+		}
+		__atomic_add_uint32(&smx_histogram[(key >> shift) & 0xff], 1);
+	}
+	__syncthreads();
+	for (int i=get_local_id(); i < 256; i += get_local_size())
+	{
+		if (smx_histogram[i] > 0)
+			__atomic_add_uint32(&topk->histogram[i], smx_histogram[i]);
+	}
+}
+
+/*
+ * kern_gpuscan_topk_compact
+ *
+ * It copies the rows whose key is equal to or better than the threshold
+ * (topk_prefix) to the new KDS. Order of the rows is not preserved.
+ */
+KERNEL_FUNCTION(void)
+kern_gpuscan_topk_compact(kern_data_store *kds_src,
+						  kern_data_store *kds_dst,
+						  kern_gputopk_buffer *topk)
+{
+	uint32_t	index;
+
+	for (index = get_global_id();
+		 index < kds_src->nitems;
+		 index += get_global_size())
+	{
+		kern_tupitem *titem_src;
+		kern_tupitem *titem_dst;
+		uint32_t	tupsz;
+		uint32_t	row_id;
+		uint64_t	offset;
+
+		if (topk->keys[index] > topk->topk_prefix)
+			continue;
+		titem_src = KDS_GET_TUPITEM(kds_src, index);
+		if (!titem_src)
+			continue;
+		tupsz = MAXALIGN(offsetof(kern_tupitem, htup) + titem_src->t_len);
+		offset = __atomic_add_uint64(&kds_dst->__usage64, tupsz) + tupsz;
+		row_id = __atomic_add_uint32(&kds_dst->nitems, 1);
+		titem_dst = (kern_tupitem *)((char *)kds_dst + kds_dst->length - offset);
+		memcpy(titem_dst, titem_src, offsetof(kern_tupitem, htup) + titem_src->t_len);
+		titem_dst->rowid = row_id;
+		KDS_GET_ROWINDEX(kds_dst)[row_id] = offset;
+	}
+}
+
+/*
+ * kern_gpuscan_sort_setup
+ *
+ * It extracts the keys and the row-index to be sorted. The top bit of the
+ * row-index (never used by the offset) is the NULL-ordering bit; it is 1
+ * if the row must be located after the other group.
+ * The second pass (sort_pass > 0) extracts the keys in the order already
+ * sorted by the previous key.
+ */
+KERNEL_FUNCTION(void)
+kern_gpuscan_sort_setup(kern_data_store *kds,
+						kern_gpusort_buffer *gsort, int curr)
+{
+	__shared__ uint64_t	smx_and_mask;
+	__shared__ uint64_t	smx_or_mask;
+	__shared__ uint32_t	smx_null_order;
+	uint64_t   *keys = GPUSORT_KEYS_BUFFER(gsort, curr);
+	uint64_t   *rowindex = GPUSORT_ROWINDEX_BUFFER(gsort, curr);
+	bool		nulls_first = ((gsort->sortkey_flags & KERN_SORTKEY__NULLS_FIRST) != 0);
+	uint64_t	and_mask = ULONG_MAX;
+	uint64_t	or_mask = 0UL;
+	uint32_t	null_order = 0;
+	uint32_t	index;
+
+	if (get_local_id() == 0)
+	{
+		smx_and_mask = ULONG_MAX;
+		smx_or_mask = 0UL;
+		smx_null_order = 0;
+	}
+	__syncthreads();
+	for (index = get_global_id();
+		 index < gsort->nitems;
+		 index += get_global_size())
+	{
+		uint64_t	offset;
+		uint64_t	key = 0UL;
+		bool		isnull = true;
+
+		if (gsort->sort_pass == 0)
+			offset = KDS_GET_ROWINDEX(kds)[index];
+		else
+			offset = (rowindex[index] & ~(1UL<<63));
+
+		if (offset != 0)
+			key = __gpuscan_fetch_sortkey(kds,
+										  (kern_tupitem *)((char *)kds +
+														   kds->length - offset),
+										  gsort->sortkey_resno,
+										  gsort->sortkey_flags,
+										  &isnull);
+		if (isnull != nulls_first)
+		{
+			offset |= (1UL<<63);
+			null_order++;
+		}
+		keys[index] = key;
+		rowindex[index] = offset;
+		and_mask &= key;
+		or_mask  |= key;
+	}
+	__atomic_and_uint64(&smx_and_mask, and_mask);
+	__atomic_or_uint64(&smx_or_mask, or_mask);
+	if (null_order > 0)
+		__atomic_add_uint32(&smx_null_order, null_order);
+	__syncthreads();
+	if (get_local_id() == 0)
+	{
+		__atomic_and_uint64(&gsort->key_and_mask, smx_and_mask);
+		__atomic_or_uint64(&gsort->key_or_mask, smx_or_mask);
+		if (smx_null_order > 0)
+			__atomic_add_uint32(&gsort->null_order_count, smx_null_order);
+	}
+}
+
+/*
+ * __gpusort_fetch_bit
+ *
+ * bit=0..63 means the bit of the keys, bit=64 means the NULL-ordering bit.
+ */
+INLINE_FUNCTION(uint32_t)
+__gpusort_fetch_bit(const uint64_t *keys, const uint64_t *rowindex,
+					uint32_t index, int bit)
+{
+	if (bit < 64)
+		return ((keys[index] >> bit) & 1);
+	return (rowindex[index] >> 63);
+}
+
+/*
+ * kern_gpuscan_sort_count
+ *
+ * It counts the number of 0-bit for each tile.
+ */
+KERNEL_FUNCTION(void)
+kern_gpuscan_sort_count(kern_gpusort_buffer *gsort, int bit, int curr)
+{
+	const uint64_t *keys = GPUSORT_KEYS_BUFFER(gsort, curr);
+	const uint64_t *rowindex = GPUSORT_ROWINDEX_BUFFER(gsort, curr);
+
+	for (uint32_t block_id = get_group_id();
+		 block_id < gsort->nblocks;
+		 block_id += get_num_groups())
+	{
+		uint32_t	head = block_id * gsort->tile_sz;
+		uint32_t	tail = Min(head + gsort->tile_sz, gsort->nitems);
+		uint32_t	nzeros = 0;
+
+		for (uint32_t base = head; base < tail; base += get_local_size())
+		{
+			uint32_t	index = base + get_local_id();
+
+			nzeros += __syncthreads_count(index < tail &&
+										  __gpusort_fetch_bit(keys, rowindex,
+															  index, bit) == 0);
+		}
+		if (get_local_id() == 0)
+			gsort->block_zeros[block_id] = nzeros;
+		__syncthreads();
+	}
+}
+
+/*
+ * kern_gpuscan_sort_scatter
+ *
+ * It moves the keys and row-index to the other buffer according to the bit,
+ * with keeping the order of the rows that have same bit (stable split).
+ */
+KERNEL_FUNCTION(void)
+kern_gpuscan_sort_scatter(kern_gpusort_buffer *gsort, int bit, int curr)
+{
+	const uint64_t *keys_src = GPUSORT_KEYS_BUFFER(gsort, curr);
+	const uint64_t *rowindex_src = GPUSORT_ROWINDEX_BUFFER(gsort, curr);
+	uint64_t   *keys_dst = GPUSORT_KEYS_BUFFER(gsort, 1 - curr);
+	uint64_t   *rowindex_dst = GPUSORT_ROWINDEX_BUFFER(gsort, 1 - curr);
+	__shared__ uint32_t smx_base0;
+	__shared__ uint32_t smx_base1;
+
+	for (uint32_t block_id = get_group_id();
+		 block_id < gsort->nblocks;
+		 block_id += get_num_groups())
+	{
+		uint32_t	head = block_id * gsort->tile_sz;
+		uint32_t	tail = Min(head + gsort->tile_sz, gsort->nitems);
+
+		if (get_local_id() == 0)
+		{
+			uint32_t	nzeros_prev = 0;
+			uint32_t	nzeros_total = 0;
+
+			for (uint32_t k=0; k < gsort->nblocks; k++)
+			{
+				if (k < block_id)
+					nzeros_prev += gsort->block_zeros[k];
+				nzeros_total += gsort->block_zeros[k];
+			}
+			smx_base0 = nzeros_prev;
+			smx_base1 = nzeros_total + (head - nzeros_prev);
+		}
+		__syncthreads();
+
+		for (uint32_t base = head; base < tail; base += get_local_size())
+		{
+			uint32_t	index = base + get_local_id();
+			uint32_t	__bit = 0;
+			uint32_t	rank0, count0;
+			uint32_t	rank1, count1;
+			uint32_t	dest;
+
+			if (index < tail)
+				__bit = __gpusort_fetch_bit(keys_src, rowindex_src, index, bit);
+			rank0 = pgstrom_stair_sum_binary(index < tail && __bit == 0, &count0);
+			rank1 = pgstrom_stair_sum_binary(index < tail && __bit != 0, &count1);
+			if (index < tail)
+			{
+				dest = (__bit == 0 ? smx_base0 + rank0 : smx_base1 + rank1);
+				keys_dst[dest] = keys_src[index];
+				rowindex_dst[dest] = rowindex_src[index];
+			}
+			__syncthreads();
+			if (get_local_id() == 0)
+			{
+				smx_base0 += count0;
+				smx_base1 += count1;
+			}
+			__syncthreads();
+		}
+	}
+}
+
+/*
+ * kern_gpuscan_sort_finish
+ *
+ * It writes back the sorted row-index to the destination KDS.
+ */
+KERNEL_FUNCTION(void)
+kern_gpuscan_sort_finish(kern_data_store *kds,
+						 kern_gpusort_buffer *gsort, int curr)
+{
+	const uint64_t *rowindex = GPUSORT_ROWINDEX_BUFFER(gsort, curr);
+	uint32_t	index;
+
+	for (index = get_global_id();
+		 index < gsort->nitems;
+		 index += get_global_size())
+	{
+		KDS_GET_ROWINDEX(kds)[index] = (rowindex[index] & ~(1UL<<63));
+	}
+}
+
+/*
+ * kern_gpuscan_columnar_pack
+ *
+ * It packs the heap-tuples of the destination KDS (KDS_FORMAT_ROW) into
+ * the KDS_FORMAT_COLUMN layout; the null-bitmap (1 = valid) and the values
+ * array of each column, located at @nullmap_offset and @values_offset.
+ * All the columns are fixed-length and by-value. The null-bitmap must be
+ * cleared by the caller.
+ */
+KERNEL_FUNCTION(void)
+kern_gpuscan_columnar_pack(kern_data_store *kds_src,
+						   kern_data_store *kds_dst)
+{
+	uint32_t	index;
+
+	for (index = get_global_id();
+		 index < kds_src->nitems;
+		 index += get_global_size())
+	{
+		kern_tupitem *tupitem = KDS_GET_TUPITEM(kds_src, index);
+		const HeapTupleHeaderData *htup;
+		uint32_t	offset;
+		int			ncols;
+		bool		heap_hasnull;
+
+		if (!tupitem)
+			continue;
+		htup = &tupitem->htup;
+		offset = htup->t_hoff;
+		ncols = Min(htup->t_infomask2 & HEAP_NATTS_MASK, kds_src->ncols);
+		heap_hasnull = ((htup->t_infomask & HEAP_HASNULL) != 0);
+		for (int j=0; j < ncols; j++)
+		{
+			const kern_colmeta *cmeta = &kds_dst->colmeta[j];
+			uint32_t   *nullmap;
+			char	   *values;
+
+			if (heap_hasnull && att_isnull(j, htup->t_bits))
+				continue;
+			offset = TYPEALIGN(cmeta->attalign, offset);
+			nullmap = (uint32_t *)
+				((char *)kds_dst + __kds_unpack(cmeta->nullmap_offset));
+			values = ((char *)kds_dst + __kds_unpack(cmeta->values_offset));
+			memcpy(values + cmeta->attlen * index,
+				   (const char *)htup + offset,
+				   cmeta->attlen);
+			__atomic_or_uint32(&nullmap[index>>5], (1U << (index & 0x1f)));
+			offset += cmeta->attlen;
+		}
+	}
+}
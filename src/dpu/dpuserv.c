@@ -26,6 +26,7 @@ typedef struct
 	pthread_mutex_t		mutex;	/* mutex to write the socket */
 	int					sockfd;	/* connection to PG-backend */
 	pthread_t			worker;	/* receiver thread */
+	int					queue_id; /* command queue of this client */
 	char				peer_addr[PEER_ADDR_LEN];
 } dpuClient;
 
@@ -37,11 +38,32 @@ static char			   *dpuserv_identifier = NULL;
 static const char	   *dpuserv_logfile = NULL;
 static bool				verbose = false;
 static bool				use_direct_io = false;
+static bool				use_cpu_affinity = true;
+static long				dpuserv_sockbuf_size = 0;	/* KB, 0 = auto */
+static size_t			dpuserv_groupby_buffer_limit = 0;	/* 0 = unlimited */
+static const char	   *dpuserv_spill_directory = NULL;
 static pthread_mutex_t	dpu_client_mutex;
 static dlist_head		dpu_client_list;
-static pthread_mutex_t	dpu_command_mutex;
-static pthread_cond_t	dpu_command_cond;
-static dlist_head		dpu_command_list;
+static kern_server_stats dpuserv_stats;		/* updated by atomic operations */
+
+/*
+ * dpuCommandQueue - per-core command queue
+ *
+ * A client is bound to one of the queues on connection, so its commands
+ * are handled by the workers pinned on the same core, unless workers of
+ * the other queues are idle and steal them.
+ */
+typedef struct
+{
+	pthread_mutex_t		mutex;
+	pthread_cond_t		cond;
+	dlist_head			list;
+	volatile int		nidles;	/* number of workers waiting for commands */
+	int					cpu_id;	/* core where workers are pinned, or -1 */
+} __attribute__((aligned(64))) dpuCommandQueue;
+
+static dpuCommandQueue *dpu_command_queues = NULL;
+static int				dpu_num_command_queues = 0;
 static volatile bool	got_sigterm = false;
 static xpu_type_hash_table *dpuserv_type_htable = NULL;
 static xpu_func_hash_table *dpuserv_func_htable = NULL;
@@ -119,6 +141,63 @@ __dpuClientWriteBack(dpuClient *dclient, struct iovec *iov, int iovcnt)
 	pthreadMutexUnlock(&dclient->mutex);
 }
 
+#ifdef WITH_LIBLZ4
+/*
+ * __dpuClientWriteBackCompressed
+ *
+ * It sends back the kds_dst array using LZ4 compression, if backend
+ * accepts it. It returns false when the results are not compressible,
+ * then caller sends back them as is.
+ */
+#define DPUSERV_COMPRESS_MIN_SIZE		(64UL << 10)
+
+static bool
+__dpuClientWriteBackCompressed(dpuClient *dclient, XpuCommand *resp,
+							   struct iovec *iov_array, int iovcnt)
+{
+	size_t		head_sz = resp->u.results.chunks_offset;
+	size_t		raw_sz = resp->length - head_sz;
+	char	   *raw_buf;
+	char	   *comp_buf;
+	char	   *pos;
+	int			comp_sz;
+	struct iovec iov[2];
+
+	if (!dclient->session->compress_results ||
+		raw_sz < DPUSERV_COMPRESS_MIN_SIZE ||
+		raw_sz > LZ4_MAX_INPUT_SIZE)
+		return false;
+	raw_buf = malloc(raw_sz + LZ4_compressBound(raw_sz));
+	if (!raw_buf)
+		return false;
+	pos = raw_buf;
+	for (int i=0; i < iovcnt; i++)
+	{
+		memcpy(pos, iov_array[i].iov_base, iov_array[i].iov_len);
+		pos += iov_array[i].iov_len;
+	}
+	assert(pos - raw_buf == raw_sz);
+	comp_buf = raw_buf + raw_sz;
+	comp_sz = LZ4_compress_default(raw_buf, comp_buf, raw_sz,
+								   LZ4_compressBound(raw_sz));
+	if (comp_sz <= 0 || comp_sz >= raw_sz)
+	{
+		free(raw_buf);
+		return false;
+	}
+	resp->u.results.chunks_rawsize = raw_sz;
+	resp->length = head_sz + comp_sz;
+	iov[0].iov_base = resp;
+	iov[0].iov_len  = head_sz;
+	iov[1].iov_base = comp_buf;
+	iov[1].iov_len  = comp_sz;
+	__dpuClientWriteBack(dclient, iov, 2);
+	free(raw_buf);
+
+	return true;
+}
+#endif
+
 static void
 dpuClientWriteBack(dpuClient *dclient,
 				   dpuTaskExecState *dtes)
@@ -141,6 +220,8 @@ dpuClientWriteBack(dpuClient *dclient,
 	resp->u.results.nitems_in  = dtes->nitems_in;
 	resp->u.results.nitems_out = dtes->nitems_out;
 	resp->u.results.num_rels   = dtes->num_rels;
+	__atomic_add_uint64(&dpuserv_stats.nitems_raw, dtes->nitems_raw);
+	__atomic_add_uint64(&dpuserv_stats.nitems_in,  dtes->nitems_in);
 	for (int i=0; i < dtes->num_rels; i++)
 	{
 		resp->u.results.stats[i].nitems_gist = dtes->stats[i].nitems_gist;
@@ -184,6 +265,11 @@ dpuClientWriteBack(dpuClient *dclient,
 		resp_sz += kds->length;
 	}
 	resp->length = resp_sz;
+#ifdef WITH_LIBLZ4
+	if (__dpuClientWriteBackCompressed(dclient, resp,
+									   iov_array + 1, iovcnt - 1))
+		return;
+#endif
 	__dpuClientWriteBack(dclient, iov_array, iovcnt);
 }
 
@@ -245,6 +331,9 @@ struct groupby_final_buffer
 	uint32_t	pgsql_client_hash;
 	pthread_rwlock_t kds_final_rwlock;
 	kern_data_store *kds_final;
+	int			spill_fd;		/* spill file, or -1 */
+	int			spill_nchunks;	/* number of chunks in the spill file */
+	size_t		spill_usage;	/* length of the spill file */
 };
 typedef struct groupby_final_buffer		groupby_final_buffer;
 
@@ -307,6 +396,7 @@ dpuServGetGroupByFinalBuffer(dpuClient *dclient, kern_session_info *session)
 	gf_buf->pgsql_port_number  = session->pgsql_port_number;
 	gf_buf->pgsql_plan_node_id = session->pgsql_plan_node_id;
 	gf_buf->pgsql_client_hash  = hash;
+	gf_buf->spill_fd = -1;
 	pthreadRWLockInit(&gf_buf->kds_final_rwlock);
 	memcpy(gf_buf->kds_final, kds_final, KDS_HEAD_LENGTH(kds_final));
 
@@ -325,6 +415,8 @@ dpuServPutGroupByFinalBuffer(groupby_final_buffer *gf_buf)
 	if (--gf_buf->refcnt == 0)
 	{
 		dlist_delete(&gf_buf->chain);
+		if (gf_buf->spill_fd >= 0)
+			close(gf_buf->spill_fd);
 		free(gf_buf->kds_final);
 		free(gf_buf);
 	}
@@ -734,6 +826,7 @@ __dpuservLoadKdsCommon(dpuClient *dclient,
 				if (nbytes > 0)
 				{
 					assert(nbytes <= length);
+					__atomic_add_uint64(&dpuserv_stats.bytes_read, nbytes);
 					dest   += nbytes;
 					offset += nbytes;
 					length -= nbytes;
@@ -1039,6 +1132,15 @@ __writeOutOneTuplePreAgg(kern_context *kcxt,
 				t_infomask |= HEAP_HASVARWIDTH;
 				break;
 
+			case KAGG_ACTION__PSUM_NUMERIC:
+			case KAGG_ACTION__PAVG_NUMERIC:
+				nbytes = sizeof(kagg_state__psum_numeric_packed);
+				if (buffer)
+					__preagg_init_psum_numeric((kagg_state__psum_numeric_packed *)buffer,
+											   desc->num_weight);
+				t_infomask |= HEAP_HASVARWIDTH;
+				break;
+
 			case KAGG_ACTION__STDDEV:
 				nbytes = sizeof(kagg_state__stddev_packed);
 				if (buffer)
@@ -1378,6 +1480,23 @@ __update_preagg__psum_fp(kern_context *kcxt,
 	}
 }
 
+/*
+ * __update_preagg__psum_numeric
+ */
+static inline void
+__update_preagg__psum_numeric(kern_context *kcxt,
+							  char *buffer,
+							  kern_colmeta *cmeta,
+							  kern_aggregate_desc *desc)
+{
+	const xpu_datum_t  *xdatum = kcxt->kvars_slot[desc->arg0_slot_id];
+	xpu_numeric_t		num;
+
+	if (__preagg_fetch_xdatum_as_numeric(kcxt, &num, xdatum))
+		__preagg_update_psum_numeric((kagg_state__psum_numeric_packed *)buffer,
+									 &num);
+}
+
 /*
  * __update_preagg__pstddev
  */
@@ -1504,6 +1623,10 @@ __updateOneTupleDpuPreAgg(kern_context *kcxt,
 			case KAGG_ACTION__PAVG_FP:
 				__update_preagg__psum_fp(kcxt, buffer, cmeta, desc);
 				break;
+			case KAGG_ACTION__PSUM_NUMERIC:
+			case KAGG_ACTION__PAVG_NUMERIC:
+				__update_preagg__psum_numeric(kcxt, buffer, cmeta, desc);
+				break;
 			case KAGG_ACTION__STDDEV:
 				__update_preagg__pstddev(kcxt, buffer, cmeta, desc);
 				break;
@@ -1519,6 +1642,91 @@ __updateOneTupleDpuPreAgg(kern_context *kcxt,
 	}
 }
 
+/*
+ * spillGroupByFinalBuffer
+ *
+ * It writes out the contents of the group-by final buffer to the spill file
+ * as a KDS_FORMAT_ROW chunk, then resets the buffer. A group may appear in
+ * multiple chunks, but it is harmless because all the chunks are sent back
+ * as partial aggregation results, then merged by the final aggregation on
+ * the host side.
+ *
+ * NOTE: this function must be called under kds_final_rwlock WRITE-LOCK
+ */
+static bool
+spillGroupByFinalBuffer(groupby_final_buffer *gf_buf)
+{
+	kern_data_store *kds_final = gf_buf->kds_final;
+	kern_data_store *khead;
+	struct iovec	iov[3];
+	size_t		offset = gf_buf->spill_usage;
+	size_t		sz1, sz2, sz3;
+
+	if (gf_buf->spill_fd < 0)
+	{
+		char	path[PATH_MAX];
+
+		snprintf(path, sizeof(path), "%s/dpuserv_spill.XXXXXX",
+				 dpuserv_spill_directory);
+		gf_buf->spill_fd = mkstemp(path);
+		if (gf_buf->spill_fd < 0)
+		{
+			fprintf(stderr, "failed on mkstemp('%s'): %m\n", path);
+			return false;
+		}
+		/* the spill file is released on close */
+		unlink(path);
+	}
+	/* the spilled chunk is always KDS_FORMAT_ROW */
+	sz1 = KDS_HEAD_LENGTH(kds_final);
+	sz2 = MAXALIGN(sizeof(uint32_t) * kds_final->nitems);
+	sz3 = __kds_unpack(kds_final->usage);
+	khead = alloca(sz1);
+	memcpy(khead, kds_final, sz1);
+	khead->format = KDS_FORMAT_ROW;
+	khead->hash_nslots = 0;
+	khead->length = (sz1 + sz2 + sz3);
+
+	iov[0].iov_base = khead;
+	iov[0].iov_len  = sz1;
+	iov[1].iov_base = KDS_GET_ROWINDEX(kds_final);
+	iov[1].iov_len  = sz2;
+	iov[2].iov_base = (char *)kds_final + kds_final->length - sz3;
+	iov[2].iov_len  = sz3;
+	for (int i=0; i < 3; i++)
+	{
+		char	   *pos = iov[i].iov_base;
+		size_t		remained = iov[i].iov_len;
+
+		while (remained > 0)
+		{
+			ssize_t	nbytes = pwrite(gf_buf->spill_fd, pos, remained, offset);
+
+			if (nbytes < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				fprintf(stderr, "failed on pwrite(spill file): %m\n");
+				return false;
+			}
+			pos += nbytes;
+			remained -= nbytes;
+			offset += nbytes;
+		}
+	}
+	gf_buf->spill_usage = offset;
+	gf_buf->spill_nchunks++;
+
+	/* reset the group-by final buffer */
+	if (kds_final->format == KDS_FORMAT_HASH)
+		memset(KDS_BODY_ADDR(kds_final), 0,
+			   MAXALIGN(sizeof(uint32_t) * kds_final->hash_nslots));
+	kds_final->nitems = 0;
+	kds_final->usage = 0;
+
+	return true;
+}
+
 /*
  * expandGroupByFinalBuffer
  *
@@ -1532,6 +1740,20 @@ expandGroupByFinalBuffer(groupby_final_buffer *gf_buf)
 	size_t		sz, length;
 
 	length = kds_old->length + Min(kds_old->length, 1UL<<30);
+	if (dpuserv_groupby_buffer_limit > 0 &&
+		length > dpuserv_groupby_buffer_limit)
+	{
+		/* spill out the buffer, if it already reached the limit */
+		if (kds_old->length >= dpuserv_groupby_buffer_limit)
+		{
+			if (dpuserv_spill_directory)
+				return spillGroupByFinalBuffer(gf_buf);
+			fprintf(stderr, "group-by final buffer reached the limit (%zu bytes)\n",
+					dpuserv_groupby_buffer_limit);
+			return false;
+		}
+		length = dpuserv_groupby_buffer_limit;
+	}
 	kds_new = malloc(length);
 	if (!kds_new)
 		return false;
@@ -1665,14 +1887,19 @@ __handleDpuTaskExecGroupByPreAgg(dpuClient *dclient,
 		return false;
 
 	pthreadRWLockReadLock(&gf_buf->kds_final_rwlock);
-	kds_final = gf_buf->kds_final;
-	assert(kds_final->format == KDS_FORMAT_HASH);
 	do {
-		uint32_t   *hslot = KDS_GET_HASHSLOT(kds_final, hash.value);
-		uint32_t	hoffset = __volatileRead(hslot);
-		uint32_t	saved = hoffset;
+		uint32_t   *hslot;
+		uint32_t	hoffset;
+		uint32_t	saved;
 		xpu_bool_t	status;
 
+		/* kds_final may be expanded or spilled out */
+		kds_final = gf_buf->kds_final;
+		assert(kds_final->format == KDS_FORMAT_HASH);
+		hslot = KDS_GET_HASHSLOT(kds_final, hash.value);
+		hoffset = __volatileRead(hslot);
+		saved = hoffset;
+
 		if (hoffset == UINT_MAX)
 		{
 			/* someone already hold the hslot-lock */
@@ -1996,6 +2223,338 @@ __handleDpuScanExecBlock(dpuClient *dclient,
 	return true;
 }
 
+/*
+ * Arrow pre-filter
+ *
+ * Comparisons between a fixed-length Arrow column and a constant at the
+ * top level of the scan quals are evaluated column-by-column, prior to the
+ * row-by-row expression. These simple loops are vectorized by compiler
+ * (NEON/SVE or SSE/AVX according to the -march flags), then the rows
+ * already rejected skip the expression. The scan quals are evaluated as
+ * usual for the rest of rows, so this never changes the results.
+ */
+typedef enum
+{
+	DPU_PREFILTER_COMP__eq,
+	DPU_PREFILTER_COMP__ne,
+	DPU_PREFILTER_COMP__lt,
+	DPU_PREFILTER_COMP__le,
+	DPU_PREFILTER_COMP__gt,
+	DPU_PREFILTER_COMP__ge,
+} DpuPrefilterComp;
+
+static bool
+__dpuArrowPrefilterOpcode(FuncOpCode opcode,
+						  TypeOpCode *p_type_code,
+						  DpuPrefilterComp *p_comp)
+{
+	switch (opcode)
+	{
+#define __DPU_PREFILTER_OPCODE(TYPE,COMP)				\
+		case FuncOpCode__##TYPE##COMP:					\
+			*p_type_code = TypeOpCode__##TYPE;			\
+			*p_comp = DPU_PREFILTER_COMP__##COMP;		\
+			return true
+#define __DPU_PREFILTER_OPCODES(TYPE)					\
+		__DPU_PREFILTER_OPCODE(TYPE,eq);				\
+		__DPU_PREFILTER_OPCODE(TYPE,ne);				\
+		__DPU_PREFILTER_OPCODE(TYPE,lt);				\
+		__DPU_PREFILTER_OPCODE(TYPE,le);				\
+		__DPU_PREFILTER_OPCODE(TYPE,gt);				\
+		__DPU_PREFILTER_OPCODE(TYPE,ge)
+		__DPU_PREFILTER_OPCODES(int2);
+		__DPU_PREFILTER_OPCODES(int4);
+		__DPU_PREFILTER_OPCODES(int8);
+		__DPU_PREFILTER_OPCODES(float4);
+		__DPU_PREFILTER_OPCODES(float8);
+#undef __DPU_PREFILTER_OPCODES
+#undef __DPU_PREFILTER_OPCODE
+		default:
+			break;
+	}
+	return false;
+}
+
+#define __DPU_PREFILTER_LOOP(EXPR)							\
+	do {													\
+		for (uint32_t i=0; i < nrows; i++)					\
+		{													\
+			__typeof__(__cval) X = __values[i];				\
+			matched[i] &= (EXPR);							\
+		}													\
+	} while(0)
+
+#define DPU_PREFILTER_INT_LOOP(BASETYPE)						\
+	do {														\
+		const BASETYPE *__values = (const BASETYPE *)values;	\
+		BASETYPE	__cval;										\
+																\
+		memcpy(&__cval, cval, sizeof(BASETYPE));				\
+		switch (comp)											\
+		{														\
+			case DPU_PREFILTER_COMP__eq:						\
+				__DPU_PREFILTER_LOOP(X == __cval);				\
+				break;											\
+			case DPU_PREFILTER_COMP__ne:						\
+				__DPU_PREFILTER_LOOP(X != __cval);				\
+				break;											\
+			case DPU_PREFILTER_COMP__lt:						\
+				__DPU_PREFILTER_LOOP(X < __cval);				\
+				break;											\
+			case DPU_PREFILTER_COMP__le:						\
+				__DPU_PREFILTER_LOOP(X <= __cval);				\
+				break;											\
+			case DPU_PREFILTER_COMP__gt:						\
+				__DPU_PREFILTER_LOOP(X > __cval);				\
+				break;											\
+			case DPU_PREFILTER_COMP__ge:						\
+				__DPU_PREFILTER_LOOP(X >= __cval);				\
+				break;											\
+		}														\
+	} while(0)
+
+/*
+ * NaN is larger than any other values, and equal to NaN in PostgreSQL.
+ * (X != X) is true only if X is NaN.
+ */
+#define DPU_PREFILTER_FLOAT_LOOP(BASETYPE)						\
+	do {														\
+		const BASETYPE *__values = (const BASETYPE *)values;	\
+		BASETYPE	__cval;										\
+																\
+		memcpy(&__cval, cval, sizeof(BASETYPE));				\
+		if (isnan(__cval))										\
+		{														\
+			switch (comp)										\
+			{													\
+				case DPU_PREFILTER_COMP__eq:					\
+				case DPU_PREFILTER_COMP__ge:					\
+					__DPU_PREFILTER_LOOP(X != X);				\
+					break;										\
+				case DPU_PREFILTER_COMP__ne:					\
+				case DPU_PREFILTER_COMP__lt:					\
+					__DPU_PREFILTER_LOOP(X == X);				\
+					break;										\
+				case DPU_PREFILTER_COMP__le:					\
+					break;										\
+				case DPU_PREFILTER_COMP__gt:					\
+					memset(matched, 0, nrows);					\
+					break;										\
+			}													\
+		}														\
+		else													\
+		{														\
+			switch (comp)										\
+			{													\
+				case DPU_PREFILTER_COMP__eq:					\
+					__DPU_PREFILTER_LOOP(X == __cval);			\
+					break;										\
+				case DPU_PREFILTER_COMP__ne:					\
+					__DPU_PREFILTER_LOOP(X != __cval);			\
+					break;										\
+				case DPU_PREFILTER_COMP__lt:					\
+					__DPU_PREFILTER_LOOP(X < __cval);			\
+					break;										\
+				case DPU_PREFILTER_COMP__le:					\
+					__DPU_PREFILTER_LOOP(X <= __cval);			\
+					break;										\
+				case DPU_PREFILTER_COMP__gt:					\
+					__DPU_PREFILTER_LOOP((X > __cval) | (X != X)); \
+					break;										\
+				case DPU_PREFILTER_COMP__ge:					\
+					__DPU_PREFILTER_LOOP((X >= __cval) | (X != X)); \
+					break;										\
+			}													\
+		}														\
+	} while(0)
+
+/*
+ * __dpuArrowPrefilterComparison - it applies the comparison on the matched[]
+ * array, or returns false if the expression is not supported.
+ */
+static bool
+__dpuArrowPrefilterComparison(const kern_data_store *kds,
+							  const kern_expression *kexp_load_vars,
+							  const kern_expression *kexp,
+							  uint8_t *matched)
+{
+	const kern_expression *kvar;
+	const kern_expression *kcon;
+	const kern_colmeta *cmeta = NULL;
+	TypeOpCode	type_code;
+	DpuPrefilterComp comp;
+	uint32_t	unitsz;
+	uint32_t	nrows;
+	const char *values;
+	const char *cval;
+
+	if (!__dpuArrowPrefilterOpcode(kexp->opcode, &type_code, &comp) ||
+		kexp->nr_args != 2)
+		return false;
+	kvar = KEXP_FIRST_ARG(kexp);
+	kcon = KEXP_NEXT_ARG(kvar);
+	if (kvar->opcode == FuncOpCode__ConstExpr &&
+		kcon->opcode == FuncOpCode__VarExpr)
+	{
+		const kern_expression *temp = kvar;
+
+		kvar = kcon;
+		kcon = temp;
+		switch (comp)
+		{
+			case DPU_PREFILTER_COMP__lt: comp = DPU_PREFILTER_COMP__gt; break;
+			case DPU_PREFILTER_COMP__le: comp = DPU_PREFILTER_COMP__ge; break;
+			case DPU_PREFILTER_COMP__gt: comp = DPU_PREFILTER_COMP__lt; break;
+			case DPU_PREFILTER_COMP__ge: comp = DPU_PREFILTER_COMP__le; break;
+			default: break;
+		}
+	}
+	if (kvar->opcode != FuncOpCode__VarExpr ||
+		kvar->exptype != type_code ||
+		kcon->opcode != FuncOpCode__ConstExpr ||
+		kcon->exptype != type_code)
+		return false;
+	/* NULL never satisfies the comparison */
+	if (kcon->u.c.const_isnull)
+	{
+		memset(matched, 0, kds->nitems);
+		return true;
+	}
+	cval = kcon->u.c.const_value;
+
+	/* lookup the Arrow column to be loaded on the slot */
+	for (int i=0; i < kexp_load_vars->u.load.nitems; i++)
+	{
+		const kern_varload_desc *vl_desc = &kexp_load_vars->u.load.desc[i];
+
+		if (vl_desc->vl_slot_id == kvar->u.v.var_slot_id)
+		{
+			if (vl_desc->vl_resno > 0 && vl_desc->vl_resno <= kds->ncols)
+				cmeta = &kds->colmeta[vl_desc->vl_resno - 1];
+			break;
+		}
+	}
+	if (!cmeta || cmeta->values_offset == 0)
+		return false;
+	switch (type_code)
+	{
+		case TypeOpCode__int2:
+		case TypeOpCode__int4:
+		case TypeOpCode__int8:
+			/* unsigned values are checked by the expression */
+			if (cmeta->attopts.tag != ArrowType__Int ||
+				!cmeta->attopts.integer.is_signed)
+				return false;
+			unitsz = cmeta->attopts.integer.bitWidth / 8;
+			break;
+		case TypeOpCode__float4:
+			if (cmeta->attopts.tag != ArrowType__FloatingPoint ||
+				cmeta->attopts.floating_point.precision != ArrowPrecision__Single)
+				return false;
+			unitsz = sizeof(float);
+			break;
+		case TypeOpCode__float8:
+			if (cmeta->attopts.tag != ArrowType__FloatingPoint ||
+				cmeta->attopts.floating_point.precision != ArrowPrecision__Double)
+				return false;
+			unitsz = sizeof(double);
+			break;
+		default:
+			return false;
+	}
+	values = (const char *)kds + __kds_unpack(cmeta->values_offset);
+	nrows = Min(kds->nitems, __kds_unpack(cmeta->values_length) / unitsz);
+	/* rows out of the values buffer are NULL */
+	if (nrows < kds->nitems)
+		memset(matched + nrows, 0, kds->nitems - nrows);
+
+	switch (type_code)
+	{
+		case TypeOpCode__int2:
+			if (unitsz != sizeof(int16_t))
+				return false;
+			DPU_PREFILTER_INT_LOOP(int16_t);
+			break;
+		case TypeOpCode__int4:
+			if (unitsz != sizeof(int32_t))
+				return false;
+			DPU_PREFILTER_INT_LOOP(int32_t);
+			break;
+		case TypeOpCode__int8:
+			if (unitsz != sizeof(int64_t))
+				return false;
+			DPU_PREFILTER_INT_LOOP(int64_t);
+			break;
+		case TypeOpCode__float4:
+			DPU_PREFILTER_FLOAT_LOOP(float);
+			break;
+		case TypeOpCode__float8:
+			DPU_PREFILTER_FLOAT_LOOP(double);
+			break;
+		default:
+			return false;
+	}
+	/* NULL never satisfies the comparison */
+	if (cmeta->nullmap_offset)
+	{
+		const uint8_t *nullmap = ((const uint8_t *)kds +
+								  __kds_unpack(cmeta->nullmap_offset));
+		uint32_t	nullmap_len = __kds_unpack(cmeta->nullmap_length);
+
+		nrows = Min(nrows, 8 * nullmap_len);
+		for (uint32_t i=0; i < nrows; i++)
+			matched[i] &= ((nullmap[i >> 3] >> (i & 7)) & 1);
+		if (nrows < kds->nitems)
+			memset(matched + nrows, 0, kds->nitems - nrows);
+	}
+	return true;
+}
+
+/*
+ * __dpuArrowPrefilter - it returns the matched[] array of the rows that
+ * may satisfy the scan quals, or NULL if no comparisons are supported.
+ */
+static uint8_t *
+__dpuArrowPrefilter(const kern_data_store *kds,
+					const kern_expression *kexp_load_vars,
+					const kern_expression *kexp_scan_quals)
+{
+	const kern_expression *karg;
+	uint8_t	   *matched;
+	bool		applied = false;
+	int			nargs;
+
+	if (!kexp_load_vars || !kexp_scan_quals || kds->nitems == 0)
+		return NULL;
+	matched = malloc(kds->nitems);
+	if (!matched)
+		return NULL;	/* fallback to the row-by-row evaluation */
+	memset(matched, 1, kds->nitems);
+
+	if (kexp_scan_quals->opcode == FuncOpCode__BoolExpr_And)
+	{
+		karg = KEXP_FIRST_ARG(kexp_scan_quals);
+		nargs = kexp_scan_quals->nr_args;
+	}
+	else
+	{
+		karg = kexp_scan_quals;
+		nargs = 1;
+	}
+	for (int i=0; i < nargs; i++, karg = KEXP_NEXT_ARG(karg))
+	{
+		if (__dpuArrowPrefilterComparison(kds, kexp_load_vars,
+										  karg, matched))
+			applied = true;
+	}
+	if (!applied)
+	{
+		free(matched);
+		return NULL;
+	}
+	return matched;
+}
+
 static bool
 __handleDpuScanExecArrow(dpuClient *dclient,
 						 dpuTaskExecState *dtes,
@@ -2007,11 +2566,16 @@ __handleDpuScanExecArrow(dpuClient *dclient,
 	kern_expression	   *kexp_scan_quals = SESSION_KEXP_SCAN_QUALS(session);
 	kern_context	   *kcxt;
 	uint32_t			kds_index;
+	uint8_t			   *matched;
+	bool				retval = false;
 
 	assert(kds_src->format == KDS_FORMAT_ARROW);
 	INIT_KERNEL_CONTEXT(kcxt, session);
+	matched = __dpuArrowPrefilter(kds_src, kexp_load_vars, kexp_scan_quals);
 	for (kds_index = 0; kds_index < kds_src->nitems; kds_index++)
 	{
+		if (matched && !matched[kds_index])
+			continue;
 		kcxt_reset(kcxt);
 		if (ExecLoadVarsOuterArrow(kcxt,
 								   kexp_load_vars,
@@ -2023,19 +2587,19 @@ __handleDpuScanExecArrow(dpuClient *dclient,
 			if (!kmrels)
 			{
 				if (!dtes->handleDpuTaskFinalDepth(dclient, dtes, kcxt))
-					return false;
+					goto bailout;
 			}
 			else if (kmrels->chunks[0].is_nestloop)
 			{
 				/* NEST-LOOP */
 				if (!__handleDpuTaskExecNestLoop(dclient, dtes, kcxt, 1))
-					return false;
+					goto bailout;
 			}
 			else
 			{
 				/* HASH-JOIN */
 				if (!__handleDpuTaskExecHashJoin(dclient, dtes, kcxt, 1))
-					return false;
+					goto bailout;
 			}
 		}
 		else if (kcxt->errcode != ERRCODE_STROM_SUCCESS)
@@ -2046,11 +2610,15 @@ __handleDpuScanExecArrow(dpuClient *dclient,
 							kcxt->error_lineno,
 							kcxt->error_funcname,
 							kcxt->error_message);
-			return false;
+			goto bailout;
 		}
 	}
 	dtes->nitems_raw += kds_src->nitems;
-	return true;
+	retval = true;
+bailout:
+	if (matched)
+		free(matched);
+	return retval;
 }
 
 /*
@@ -2164,6 +2732,8 @@ dpuservHandleDpuTaskFinal(dpuClient *dclient, XpuCommand *xcmd)
 	struct iovec   *iov;
 	int				iovcnt = 0;
 	bool			gf_buf_locked = false;
+	void		   *spill_addr = NULL;
+	size_t			spill_sz = 0;
 	size_t			resp_sz;
 
 	/* iovec allocation */
@@ -2277,14 +2847,100 @@ dpuservHandleDpuTaskFinal(dpuClient *dclient, XpuCommand *xcmd)
 		resp.u.results.chunks_nitems = 1;
 		resp.u.results.chunks_offset = resp_sz;
 		resp_sz += kds_final->length;
+
+		/* also sends back the chunks in the spill file, if any */
+		if (gf_buf->spill_nchunks > 0)
+		{
+			spill_sz = gf_buf->spill_usage;
+			spill_addr = mmap(NULL, spill_sz,
+							  PROT_READ,
+							  MAP_SHARED,
+							  gf_buf->spill_fd, 0);
+			if (spill_addr == MAP_FAILED)
+			{
+				pthreadRWLockUnlock(&gf_buf->kds_final_rwlock);
+				dpuClientElog(dclient, "failed on mmap(spill file, sz=%zu): %m",
+							  spill_sz);
+				return;
+			}
+			iov = &iovec_array[iovcnt++];
+			iov->iov_base = spill_addr;
+			iov->iov_len  = spill_sz;
+			resp.u.results.chunks_nitems += gf_buf->spill_nchunks;
+			resp_sz += spill_sz;
+		}
 	}
 	resp.length = resp_sz;
 	__dpuClientWriteBack(dclient, iovec_array, iovcnt);
 
+	if (spill_addr)
+		munmap(spill_addr, spill_sz);
 	if (gf_buf_locked)
 		pthreadRWLockUnlock(&gf_buf->kds_final_rwlock);
 }
 
+/*
+ * dpuservHandleServerStats
+ */
+static void
+dpuservHandleServerStats(dpuClient *dclient)
+{
+	XpuCommand	   *resp;
+	struct iovec	iov;
+	dlist_iter		iter;
+	size_t			resp_sz;
+	uint32_t		nr_sessions = 0;
+
+	resp_sz = MAXALIGN(offsetof(XpuCommand, u.stats) + sizeof(kern_server_stats));
+	resp = alloca(resp_sz);
+	memset(resp, 0, resp_sz);
+	resp->magic  = XpuCommandMagicNumber;
+	resp->tag    = XpuCommandTag__Success;
+	resp->length = resp_sz;
+
+	pthreadMutexLock(&dpu_client_mutex);
+	dlist_foreach (iter, &dpu_client_list)
+	{
+		dpuClient  *curr = dlist_container(dpuClient, chain, iter.cur);
+
+		if (curr->session && (curr->refcnt & 1) == 1)
+			nr_sessions++;
+	}
+	pthreadMutexUnlock(&dpu_client_mutex);
+	resp->u.stats.nr_sessions = nr_sessions;
+	resp->u.stats.nr_queued  = __volatileRead(&dpuserv_stats.nr_queued);
+	resp->u.stats.bytes_read = __volatileRead(&dpuserv_stats.bytes_read);
+	resp->u.stats.nitems_raw = __volatileRead(&dpuserv_stats.nitems_raw);
+	resp->u.stats.nitems_in  = __volatileRead(&dpuserv_stats.nitems_in);
+	for (int i=0; i < XPU_STATS_NUM_COMMANDS; i++)
+	{
+		for (int j=0; j < XPU_STATS_LATENCY_NBUCKETS; j++)
+			resp->u.stats.latency_hist[i][j]
+				= __volatileRead(&dpuserv_stats.latency_hist[i][j]);
+	}
+	iov.iov_base = resp;
+	iov.iov_len  = resp_sz;
+	__dpuClientWriteBack(dclient, &iov, 1);
+}
+
+/*
+ * __dpuservUpdateLatencyStats
+ */
+static void
+__dpuservUpdateLatencyStats(int cmd_index, struct timespec *tv_start)
+{
+	struct timespec	tv_end;
+	uint64_t	usec;
+	int			k = 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &tv_end);
+	usec = ((tv_end.tv_sec - tv_start->tv_sec) * 1000000L +
+			(tv_end.tv_nsec - tv_start->tv_nsec) / 1000L);
+	while (k < XPU_STATS_LATENCY_NBUCKETS - 1 && usec >= (1UL << k))
+		k++;
+	__atomic_add_uint64(&dpuserv_stats.latency_hist[cmd_index][k], 1);
+}
+
 /*
  * getDpuClient
  */
@@ -2329,6 +2985,116 @@ putDpuClient(dpuClient *dclient, int count)
 	}
 }
 
+/*
+ * __dpuservPinCurrentThread
+ */
+static void
+__dpuservPinCurrentThread(int cpu_id)
+{
+	cpu_set_t	cpuset;
+
+	if (cpu_id < 0)
+		return;
+	CPU_ZERO(&cpuset);
+	CPU_SET(cpu_id, &cpuset);
+	if ((errno = pthread_setaffinity_np(pthread_self(),
+										sizeof(cpu_set_t),
+										&cpuset)) != 0)
+		fprintf(stderr, "failed on pthread_setaffinity_np(cpu=%d): %m\n",
+				cpu_id);
+}
+
+/*
+ * __dpuservStealCommand
+ *
+ * It pulls a command from the other queues, if not contended.
+ */
+static XpuCommand *
+__dpuservStealCommand(int queue_id)
+{
+	for (int k=1; k < dpu_num_command_queues; k++)
+	{
+		dpuCommandQueue *dqueue;
+		XpuCommand *xcmd = NULL;
+
+		dqueue = &dpu_command_queues[(queue_id + k) % dpu_num_command_queues];
+		if (pthread_mutex_trylock(&dqueue->mutex) != 0)
+			continue;
+		if (!dlist_is_empty(&dqueue->list))
+			xcmd = dlist_container(XpuCommand, chain,
+								   dlist_pop_head_node(&dqueue->list));
+		pthreadMutexUnlock(&dqueue->mutex);
+		if (xcmd)
+			return xcmd;
+	}
+	return NULL;
+}
+
+/*
+ * __dpuservHandleCommand
+ */
+static void
+__dpuservHandleCommand(long worker_id, XpuCommand *xcmd)
+{
+	dpuClient  *dclient = xcmd->priv;
+	struct timespec	tv_start;
+
+	__atomic_fetch_sub(&dpuserv_stats.nr_queued, 1, __ATOMIC_SEQ_CST);
+	clock_gettime(CLOCK_MONOTONIC, &tv_start);
+	/*
+	 * MEMO: If the least bit of gclient->refcnt is not set,
+	 * it means the gpu-client connection is no longer available.
+	 * (monitor thread has already gone)
+	 */
+	if ((dclient->refcnt & 1) == 1)
+	{
+		switch (xcmd->tag)
+		{
+			case XpuCommandTag__OpenSession:
+				if (dpuservHandleOpenSession(dclient, xcmd))
+					xcmd = NULL;	/* session information shall be kept until
+									 * end of the session. */
+				__dpuservUpdateLatencyStats(XPU_STATS_CMD__OPEN_SESSION,
+											&tv_start);
+				if (verbose)
+					fprintf(stderr, "[DPU-%ld@%s] OpenSession ... %s\n",
+							worker_id, dclient->peer_addr,
+							(xcmd != NULL ? "failed" : "ok"));
+				break;
+			case XpuCommandTag__XpuTaskExec:
+				dpuservHandleDpuTaskExec(dclient, xcmd);
+				__dpuservUpdateLatencyStats(XPU_STATS_CMD__TASK_EXEC,
+											&tv_start);
+				if (verbose)
+					fprintf(stderr, "[DPU-%ld@%s] CMD=XpuTaskExec\n",
+							worker_id, dclient->peer_addr);
+				break;
+			case XpuCommandTag__XpuTaskFinal:
+				dpuservHandleDpuTaskFinal(dclient, xcmd);
+				__dpuservUpdateLatencyStats(XPU_STATS_CMD__TASK_FINAL,
+											&tv_start);
+				if (verbose)
+					fprintf(stderr, "[DPU-%ld@%s] CMD=XpuTaskFinal\n",
+							worker_id, dclient->peer_addr);
+				break;
+			case XpuCommandTag__ServerStats:
+				dpuservHandleServerStats(dclient);
+				if (verbose)
+					fprintf(stderr, "[DPU-%ld@%s] CMD=ServerStats\n",
+							worker_id, dclient->peer_addr);
+				break;
+			default:
+				fprintf(stderr, "[DPU-%ld@%s] unknown xPU command (tag=%u, len=%ld)\n",
+						worker_id, dclient->peer_addr,
+						xcmd->tag, xcmd->length);
+				break;
+		}
+	}
+	if (xcmd)
+		free(xcmd);
+	putDpuClient(dclient, 2);
+}
+
 /*
  * dpuservDpuWorkerMain
  */
@@ -2336,69 +3102,37 @@ static void *
 dpuservDpuWorkerMain(void *__priv)
 {
 	long	worker_id = (long)__priv;
+	int		queue_id = worker_id % dpu_num_command_queues;
+	dpuCommandQueue *dqueue = &dpu_command_queues[queue_id];
 
+	__dpuservPinCurrentThread(dqueue->cpu_id);
 	if (verbose)
-		fprintf(stderr, "[worker-%lu] DPU service worker start.\n", worker_id);
-	pthreadMutexLock(&dpu_command_mutex);
+		fprintf(stderr, "[worker-%lu] DPU service worker start (queue=%d, cpu=%d).\n",
+				worker_id, queue_id, dqueue->cpu_id);
+	pthreadMutexLock(&dqueue->mutex);
 	while (!got_sigterm)
 	{
-		if (!dlist_is_empty(&dpu_command_list))
-		{
-			dlist_node	   *dnode = dlist_pop_head_node(&dpu_command_list);
-			XpuCommand	   *xcmd = dlist_container(XpuCommand, chain, dnode);
-			dpuClient	   *dclient;
-			pthreadMutexUnlock(&dpu_command_mutex);
-
-			dclient = xcmd->priv;
-			/*
-			 * MEMO: If the least bit of gclient->refcnt is not set,
-			 * it means the gpu-client connection is no longer available.
-			 * (monitor thread has already gone)
-			 */
-			if ((dclient->refcnt & 1) == 1)
-			{
-				switch (xcmd->tag)
-				{
-					case XpuCommandTag__OpenSession:
-						if (dpuservHandleOpenSession(dclient, xcmd))
-							xcmd = NULL;	/* session information shall be kept until
-											 * end of the session. */
-						if (verbose)
-							fprintf(stderr, "[DPU-%ld@%s] OpenSession ... %s\n",
-									worker_id, dclient->peer_addr,
-									(xcmd != NULL ? "failed" : "ok"));
-						break;
-					case XpuCommandTag__XpuTaskExec:
-						dpuservHandleDpuTaskExec(dclient, xcmd);
-						if (verbose)
-							fprintf(stderr, "[DPU-%ld@%s] CMD=XpuTaskExec\n",
-									worker_id, dclient->peer_addr);
-						break;
-					case XpuCommandTag__XpuTaskFinal:
-						dpuservHandleDpuTaskFinal(dclient, xcmd);
-						if (verbose)
-							fprintf(stderr, "[DPU-%ld@%s] CMD=XpuTaskFinal\n",
-									worker_id, dclient->peer_addr);
-						break;
-					default:
-						fprintf(stderr, "[DPU-%ld@%s] unknown xPU command (tag=%u, len=%ld)\n",
-								worker_id, dclient->peer_addr,
-								xcmd->tag, xcmd->length);
-						break;
-				}
-			}
-			if (xcmd)
-				free(xcmd);
-			putDpuClient(dclient, 2);
-			pthreadMutexLock(&dpu_command_mutex);
-		}
-		else
+		XpuCommand *xcmd = NULL;
+
+		if (!dlist_is_empty(&dqueue->list))
+			xcmd = dlist_container(XpuCommand, chain,
+								   dlist_pop_head_node(&dqueue->list));
+		pthreadMutexUnlock(&dqueue->mutex);
+
+		if (!xcmd)
+			xcmd = __dpuservStealCommand(queue_id);
+		if (xcmd)
+			__dpuservHandleCommand(worker_id, xcmd);
+
+		pthreadMutexLock(&dqueue->mutex);
+		if (!xcmd && dlist_is_empty(&dqueue->list) && !got_sigterm)
 		{
-			pthreadCondWait(&dpu_command_cond,
-							&dpu_command_mutex);
+			dqueue->nidles++;
+			pthreadCondWait(&dqueue->cond, &dqueue->mutex);
+			dqueue->nidles--;
 		}
 	}
-	pthreadMutexUnlock(&dpu_command_mutex);
+	pthreadMutexUnlock(&dqueue->mutex);
 	if (verbose)
 		fprintf(stderr, "[worker-%lu] DPU service worker terminated.\n", worker_id);
 	return NULL;
@@ -2417,19 +3151,45 @@ static void
 __dpuServAttachCommand(void *__priv, XpuCommand *xcmd)
 {
 	dpuClient  *dclient = (dpuClient *)__priv;
+	dpuCommandQueue *dqueue = &dpu_command_queues[dclient->queue_id];
+	bool		has_idle_worker;
 
 	getDpuClient(dclient, 2);
 	xcmd->priv = dclient;
+	__atomic_fetch_add(&dpuserv_stats.nr_queued, 1, __ATOMIC_SEQ_CST);
 
 	if (verbose)
 		fprintf(stderr, "[%s] received xcmd (tag=%u len=%lu)\n",
 				dclient->peer_addr,
 				xcmd->tag, xcmd->length);
 
-	pthreadMutexLock(&dpu_command_mutex);
-	dlist_push_tail(&dpu_command_list, &xcmd->chain);
-	pthreadCondSignal(&dpu_command_cond);
-	pthreadMutexUnlock(&dpu_command_mutex);
+	pthreadMutexLock(&dqueue->mutex);
+	dlist_push_tail(&dqueue->list, &xcmd->chain);
+	has_idle_worker = (dqueue->nidles > 0);
+	if (has_idle_worker)
+		pthreadCondSignal(&dqueue->cond);
+	pthreadMutexUnlock(&dqueue->mutex);
+	if (has_idle_worker)
+		return;
+
+	/*
+	 * All the workers of the queue are busy, so wake up an idle worker
+	 * of the neighbor queues to steal the command.
+	 */
+	for (int k=1; k < dpu_num_command_queues; k++)
+	{
+		dqueue = &dpu_command_queues[(dclient->queue_id + k) %
+									 dpu_num_command_queues];
+		if (dqueue->nidles == 0)
+			continue;
+		pthreadMutexLock(&dqueue->mutex);
+		has_idle_worker = (dqueue->nidles > 0);
+		if (has_idle_worker)
+			pthreadCondSignal(&dqueue->cond);
+		pthreadMutexUnlock(&dqueue->mutex);
+		if (has_idle_worker)
+			break;
+	}
 }
 
 TEMPLATE_XPU_CONNECT_RECEIVE_COMMANDS(__dpuServ)
@@ -2439,6 +3199,7 @@ dpuservMonitorClient(void *__priv)
 {
 	dpuClient  *dclient = (dpuClient *)__priv;
 
+	__dpuservPinCurrentThread(dpu_command_queues[dclient->queue_id].cpu_id);
 	if (verbose)
 		fprintf(stderr, "[%s] connection start\n", dclient->peer_addr);
 	while (!got_sigterm && !dclient->in_termination)
@@ -2493,10 +3254,82 @@ dpuserv_signal_handler(int signum)
 	errno = errno_saved;
 }
 
+/*
+ * dpuservSetupCommandQueues
+ *
+ * It creates a command queue for each core available, up to the number
+ * of workers.
+ */
+static void
+dpuservSetupCommandQueues(void)
+{
+	cpu_set_t	cpuset;
+	int			cpu_id = 0;
+
+	CPU_ZERO(&cpuset);
+	if (sched_getaffinity(0, sizeof(cpu_set_t), &cpuset) != 0)
+		__Elog("failed on sched_getaffinity: %m");
+	dpu_num_command_queues = Min(CPU_COUNT(&cpuset), dpuserv_num_workers);
+	if (dpu_num_command_queues < 1)
+		dpu_num_command_queues = 1;
+	if ((errno = posix_memalign((void **)&dpu_command_queues, 64,
+								sizeof(dpuCommandQueue) *
+								dpu_num_command_queues)) != 0)
+		__Elog("out of memory: %m");
+	for (int i=0; i < dpu_num_command_queues; i++)
+	{
+		dpuCommandQueue *dqueue = &dpu_command_queues[i];
+
+		memset(dqueue, 0, sizeof(dpuCommandQueue));
+		pthreadMutexInit(&dqueue->mutex);
+		pthreadCondInit(&dqueue->cond);
+		dlist_init(&dqueue->list);
+		dqueue->nidles = 0;
+		dqueue->cpu_id = -1;
+		if (use_cpu_affinity)
+		{
+			while (cpu_id < CPU_SETSIZE && !CPU_ISSET(cpu_id, &cpuset))
+				cpu_id++;
+			if (cpu_id < CPU_SETSIZE)
+				dqueue->cpu_id = cpu_id++;
+		}
+	}
+}
+
+/*
+ * __dpuservSetupClientSocket
+ *
+ * XpuCommands are exchanged as request/response messages, so we disable
+ * Nagle's algorithm not to delay the small replies.
+ */
+static void
+__dpuservSetupClientSocket(int client_fd, int sa_family)
+{
+	if (sa_family == AF_INET || sa_family == AF_INET6)
+	{
+		int		nodelay = 1;
+
+		if (setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY,
+					   &nodelay, sizeof(nodelay)) != 0)
+			fprintf(stderr, "failed on setsockopt(TCP_NODELAY): %m\n");
+	}
+	if (dpuserv_sockbuf_size > 0)
+	{
+		int		bufsz = dpuserv_sockbuf_size * 1024;
+
+		if (setsockopt(client_fd, SOL_SOCKET, SO_SNDBUF,
+					   &bufsz, sizeof(bufsz)) != 0 ||
+			setsockopt(client_fd, SOL_SOCKET, SO_RCVBUF,
+					   &bufsz, sizeof(bufsz)) != 0)
+			fprintf(stderr, "failed on setsockopt(SO_SNDBUF/SO_RCVBUF): %m\n");
+	}
+}
+
 static int
 dpuserv_main(struct sockaddr *addr, socklen_t addr_len)
 {
 	pthread_t  *dpuserv_workers;
+	int			next_queue_id = 0;
 	int			serv_fd;
 	int			epoll_fd;
 	struct epoll_event epoll_ev;
@@ -2507,6 +3340,7 @@ dpuserv_main(struct sockaddr *addr, socklen_t addr_len)
 	signal(SIGPIPE, SIG_IGN);
 
 	/* start worker threads */
+	dpuservSetupCommandQueues();
 	dpuserv_workers = alloca(sizeof(pthread_t) * dpuserv_num_workers);
 	for (long i=0; i < dpuserv_num_workers; i++)
 	{
@@ -2569,12 +3403,15 @@ dpuserv_main(struct sockaddr *addr, socklen_t addr_len)
 				{
 					dpuClient  *dclient;
 
+					__dpuservSetupClientSocket(client_fd, peer.addr.sa_family);
 					dclient = calloc(1, sizeof(dpuClient));
 					if (!dclient)
 						__Elog("out of memory: %m");
 					dclient->refcnt = 1;
 					pthreadMutexInit(&dclient->mutex);
 					dclient->sockfd = client_fd;
+					dclient->queue_id = next_queue_id;
+					next_queue_id = (next_queue_id + 1) % dpu_num_command_queues;
 					if (peer.addr.sa_family == AF_INET)
 					{
 						inet_ntop(peer.in.sin_family,
@@ -2634,7 +3471,12 @@ dpuserv_main(struct sockaddr *addr, socklen_t addr_len)
 	close(serv_fd);
 
 	/* wait for completion of worker threads */
-	pthread_cond_broadcast(&dpu_command_cond);
+	for (int i=0; i < dpu_num_command_queues; i++)
+	{
+		pthreadMutexLock(&dpu_command_queues[i].mutex);
+		pthreadCondBroadcast(&dpu_command_queues[i].cond);
+		pthreadMutexUnlock(&dpu_command_queues[i].mutex);
+	}
 	for (int i=0; i < dpuserv_num_workers; i++)
 		pthread_join(dpuserv_workers[i], NULL);
 	pthreadMutexLock(&dpu_client_mutex);
@@ -2666,6 +3508,10 @@ main(int argc, char *argv[])
 		{"identifier", required_argument, 0,  'i'},
 		{"log",        required_argument, 0,  'l'},
 		{"direct-io",  no_argument,       0, 1001},
+		{"no-cpu-affinity", no_argument,  0, 1002},
+		{"sockbuf-size", required_argument, 0, 1003},
+		{"groupby-buffer-limit", required_argument, 0, 1004},
+		{"spill-dir",  required_argument, 0, 1005},
 		{"verbose",    no_argument,       0,  'v'},
 		{"help",       no_argument,       0,  'h'},
 		{NULL, 0, 0, 0},
@@ -2676,9 +3522,6 @@ main(int argc, char *argv[])
 	/* init misc variables */
 	pthreadMutexInit(&dpu_client_mutex);
 	dlist_init(&dpu_client_list);
-	pthreadMutexInit(&dpu_command_mutex);
-	pthreadCondInit(&dpu_command_cond);
-	dlist_init(&dpu_command_list);
 
 	/* parse command line options */
 	for (;;)
@@ -2742,6 +3585,40 @@ main(int argc, char *argv[])
 				use_direct_io = true;
 				break;
 
+			case 1002:
+				use_cpu_affinity = false;
+				break;
+
+			case 1003:
+				dpuserv_sockbuf_size = strtol(optarg, &end, 10);
+				if (*optarg == '\0' || *end != '\0')
+					__Elog("socket buffer size [%s] is not valid", optarg);
+				if (dpuserv_sockbuf_size < 0 ||
+					dpuserv_sockbuf_size > INT_MAX / 1024)
+					__Elog("socket buffer size %ldkB is out of range",
+						   dpuserv_sockbuf_size);
+				break;
+
+			case 1004:
+				{
+					long	limit = strtol(optarg, &end, 10);
+
+					if (*optarg == '\0' || *end != '\0')
+						__Elog("group-by buffer limit [%s] is not valid", optarg);
+					if (limit < 0 || limit > (LONG_MAX >> 20))
+						__Elog("group-by buffer limit %ldMB is out of range", limit);
+					dpuserv_groupby_buffer_limit = ((size_t)limit << 20);
+				}
+				break;
+
+			case 1005:
+				if (dpuserv_spill_directory)
+					__Elog("--spill-dir option was given twice");
+				if (*optarg != '/')
+					__Elog("--spill-dir must be an absolute path [%s]", optarg);
+				dpuserv_spill_directory = optarg;
+				break;
+
 			case 'v':
 				verbose = true;
 				break;
@@ -2754,6 +3631,11 @@ main(int argc, char *argv[])
 					  "\t-i|--identifier=IDENT    security identifier\n"
 					  "\t-l|--log=LOGFILE         log file (default: stderr)\n"
 					  "\t   --direct-io           enables O_DIRECT (default: no)\n"
+					  "\t   --no-cpu-affinity     does not pin workers on cores\n"
+					  "\t   --sockbuf-size=KB     socket buffer size (default: auto)\n"
+					  "\t   --groupby-buffer-limit=MB\n"
+					  "\t                         group-by buffer limit (default: unlimited)\n"
+					  "\t   --spill-dir=DIR       spill group-by buffer to DIR on the limit\n"
 					  "\t-v|--verbose             verbose output\n"
 					  "\t-h|--help                shows this message\n",
 					  stderr);
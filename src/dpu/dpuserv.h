@@ -17,11 +17,13 @@
 #include <getopt.h>
 #include <poll.h>
 #include <pthread.h>
+#include <sched.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <unistd.h>
+#include <time.h>
 #include <signal.h>
 #include <sys/epoll.h>
 #include <sys/mman.h>
@@ -31,10 +33,14 @@
 #include <sys/types.h>
 #include <sys/uio.h>
 #include <netdb.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include "xpu_common.h"
 #include "float2.h"
 #include "heterodb_extra.h"
+#ifdef WITH_LIBLZ4
+#include <lz4.h>
+#endif
 
 #define __Elog(fmt,...)								\
 	do {											\
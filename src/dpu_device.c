@@ -11,6 +11,7 @@
  */
 #include "pg_strom.h"
 #include <netdb.h>
+#include <netinet/tcp.h>
 
 static char	   *pgstrom_dpu_endpoint_list;	/* GUC */
 static int		pgstrom_dpu_endpoint_default_port;	/* GUC */
@@ -25,6 +26,8 @@ double		pgstrom_dpu_operator_cost = DEFAULT_DPU_OPERATOR_COST;	/* GUC */
 double		pgstrom_dpu_seq_page_cost = DEFAULT_DPU_SEQ_PAGE_COST;	/* GUC */
 double		pgstrom_dpu_tuple_cost    = DEFAULT_DPU_TUPLE_COST;		/* GUC */
 bool		pgstrom_dpu_handle_cached_pages = false;	/* GUC */
+bool		pgstrom_dpu_compress_results = false;		/* GUC */
+static int	pgstrom_dpu_socket_buffer_size = 0;		/* GUC */
 
 struct DpuStorageEntry
 {
@@ -36,7 +39,9 @@ struct DpuStorageEntry
 	const struct sockaddr *endpoint_addr;
 	socklen_t	endpoint_addr_len;
 	struct stat	endpoint_stat_buf;
+	int32_t		replica_next;	/* next endpoint_id of the same directory */
 	pg_atomic_uint32 *validated;	/* shared memory */
+	pg_atomic_uint32 *nsessions;	/* shared memory; # of running sessions */
 };
 
 typedef struct
@@ -302,32 +307,102 @@ DpuStorageEntryCount(void)
 }
 
 /*
- * DpuClientOpenSession 
+ * __dpuClientConnectEndpoint
+ *
+ * It returns a socket connected to the endpoint, or -1 if the endpoint is
+ * not reachable yet the storage has other replicas.
  */
-void
-DpuClientOpenSession(pgstromTaskState *pts,
-					 const XpuCommand *session)
+static pgsocket
+__dpuClientConnectEndpoint(const DpuStorageEntry *ds_entry)
 {
-	const DpuStorageEntry *ds_entry = pts->ds_entry;
-    pgsocket    sockfd;
-    char        namebuf[32];
-
-	if (!ds_entry)
-		elog(ERROR, "Bug? no DPU device is configured");
+	pgsocket	sockfd;
 
 	sockfd = socket(ds_entry->endpoint_domain, SOCK_STREAM, 0);
 	if (sockfd < 0)
 		elog(ERROR, "failed on socket(2) dom=%d: %m", ds_entry->endpoint_domain);
+	/*
+	 * XpuCommands are request/response messages, so Nagle's algorithm
+	 * only adds latency. Socket buffer size follows the kernel's auto
+	 * tuning unless pg_strom.dpu_socket_buffer_size is configured.
+	 */
+	if (ds_entry->endpoint_domain == AF_INET ||
+		ds_entry->endpoint_domain == AF_INET6)
+	{
+		int		nodelay = 1;
+
+		if (setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY,
+					   &nodelay, sizeof(nodelay)) != 0)
+			elog(WARNING, "failed on setsockopt(TCP_NODELAY): %m");
+	}
+	if (pgstrom_dpu_socket_buffer_size > 0)
+	{
+		int		bufsz = pgstrom_dpu_socket_buffer_size * 1024;
+
+		if (setsockopt(sockfd, SOL_SOCKET, SO_SNDBUF,
+					   &bufsz, sizeof(bufsz)) != 0 ||
+			setsockopt(sockfd, SOL_SOCKET, SO_RCVBUF,
+					   &bufsz, sizeof(bufsz)) != 0)
+			elog(WARNING, "failed on setsockopt(SO_SNDBUF/SO_RCVBUF): %m");
+	}
 	if (connect(sockfd,
 				ds_entry->endpoint_addr,
 				ds_entry->endpoint_addr_len) != 0)
 	{
+		int		errno_saved = errno;
+
 		close(sockfd);
-		elog(ERROR, "failed on connect('%s'): %m", ds_entry->config_host);
+		errno = errno_saved;
+		if (ds_entry->replica_next == ds_entry->endpoint_id)
+			elog(ERROR, "failed on connect('%s'): %m", ds_entry->config_host);
+		elog(LOG, "failed on connect('%s'): %m, try other replicas",
+			 ds_entry->config_host);
+		return -1;
+	}
+	return sockfd;
+}
+
+/*
+ * DpuClientOpenSession
+ *
+ * If the storage is reachable from multiple DPUs (same directory is
+ * configured for several endpoints), the least loaded one is chosen
+ * first, then other replicas are tried on connection failures.
+ */
+void
+DpuClientOpenSession(pgstromTaskState *pts,
+					 const XpuCommand *session)
+{
+	const DpuStorageEntry *ds_entry = pts->ds_entry;
+	DpuStorageEntry *ds_curr;
+	DpuStorageEntry *ds_temp;
+	pgsocket	sockfd;
+	char		namebuf[32];
+
+	if (!ds_entry)
+		elog(ERROR, "Bug? no DPU device is configured");
+
+	ds_curr = &dpu_storage_master_array->entries[ds_entry->endpoint_id];
+	for (ds_temp = &dpu_storage_master_array->entries[ds_curr->replica_next];
+		 ds_temp->endpoint_id != ds_entry->endpoint_id;
+		 ds_temp = &dpu_storage_master_array->entries[ds_temp->replica_next])
+	{
+		if (pg_atomic_read_u32(ds_temp->nsessions) <
+			pg_atomic_read_u32(ds_curr->nsessions))
+			ds_curr = ds_temp;
 	}
-	snprintf(namebuf, sizeof(namebuf), "DPU-%u", ds_entry->endpoint_id);
+	ds_temp = ds_curr;
+	while ((sockfd = __dpuClientConnectEndpoint(ds_curr)) < 0)
+	{
+		ds_curr = &dpu_storage_master_array->entries[ds_curr->replica_next];
+		if (ds_curr == ds_temp)
+			elog(ERROR, "no DPU endpoints are reachable for '%s'",
+				 ds_entry->endpoint_dir);
+	}
+	snprintf(namebuf, sizeof(namebuf), "DPU-%u", ds_curr->endpoint_id);
 
-	__xpuClientOpenSession(pts, session, sockfd, namebuf, ds_entry->endpoint_id);
+	__xpuClientOpenSession(pts, session, sockfd, namebuf, ds_curr->endpoint_id);
+	pg_atomic_fetch_add_u32(ds_curr->nsessions, 1);
+	xpuClientAttachLoadCounter(pts->conn, ds_curr->nsessions);
 }
 
 /*
@@ -363,6 +438,193 @@ explainDpuStorageEntry(const DpuStorageEntry *ds_entry, ExplainState *es)
 	}
 }
 
+/*
+ * __dpuFetchServerStats
+ *
+ * It sends a ServerStats command to the endpoint, then fetch the response.
+ * It returns false if the endpoint is not reachable.
+ */
+#define DPU_SERVER_STATS_TIMEOUT	5	/* sec */
+
+static bool
+__dpuFetchServerStats(const DpuStorageEntry *ds_entry,
+					  kern_server_stats *stats)
+{
+	XpuCommand *xcmd;
+	size_t		resp_sz;
+	char	   *pos;
+	size_t		remained;
+	ssize_t		nbytes;
+	struct timeval tv;
+	pgsocket	sockfd;
+	bool		retval = false;
+
+	sockfd = socket(ds_entry->endpoint_domain, SOCK_STREAM, 0);
+	if (sockfd < 0)
+		elog(ERROR, "failed on socket(2) dom=%d: %m", ds_entry->endpoint_domain);
+	tv.tv_sec = DPU_SERVER_STATS_TIMEOUT;
+	tv.tv_usec = 0;
+	if (setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) != 0 ||
+		setsockopt(sockfd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv)) != 0)
+		elog(WARNING, "failed on setsockopt(SO_RCVTIMEO/SO_SNDTIMEO): %m");
+	if (connect(sockfd,
+				ds_entry->endpoint_addr,
+				ds_entry->endpoint_addr_len) != 0)
+	{
+		elog(LOG, "failed on connect('%s'): %m", ds_entry->config_host);
+		goto out;
+	}
+	/* send ServerStats command */
+	resp_sz = MAXALIGN(offsetof(XpuCommand, u.stats) + sizeof(kern_server_stats));
+	xcmd = palloc0(resp_sz);
+	xcmd->magic = XpuCommandMagicNumber;
+	xcmd->tag = XpuCommandTag__ServerStats;
+	xcmd->length = offsetof(XpuCommand, u);
+	for (pos = (char *)xcmd, remained = xcmd->length; remained > 0; )
+	{
+		nbytes = write(sockfd, pos, remained);
+		if (nbytes < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			elog(LOG, "failed on write('%s'): %m", ds_entry->config_host);
+			goto out;
+		}
+		pos += nbytes;
+		remained -= nbytes;
+	}
+	/* receive the response */
+	memset(xcmd, 0, resp_sz);
+	for (pos = (char *)xcmd, remained = resp_sz; remained > 0; )
+	{
+		nbytes = read(sockfd, pos, remained);
+		if (nbytes <= 0)
+		{
+			if (nbytes < 0 && errno == EINTR)
+				continue;
+			elog(LOG, "failed on read('%s'): %m", ds_entry->config_host);
+			goto out;
+		}
+		pos += nbytes;
+		remained -= nbytes;
+	}
+	if (xcmd->magic != XpuCommandMagicNumber ||
+		xcmd->tag != XpuCommandTag__Success ||
+		xcmd->length != resp_sz)
+	{
+		elog(LOG, "unexpected ServerStats response from '%s' (tag=%u, len=%lu)",
+			 ds_entry->config_host, xcmd->tag, xcmd->length);
+		goto out;
+	}
+	memcpy(stats, &xcmd->u.stats, sizeof(kern_server_stats));
+	retval = true;
+out:
+	close(sockfd);
+	return retval;
+}
+
+static Datum
+__pgstrom_dpu_latency_hist_datum(const uint64_t *latency_hist)
+{
+	Datum		hist[XPU_STATS_LATENCY_NBUCKETS];
+
+	for (int k=0; k < XPU_STATS_LATENCY_NBUCKETS; k++)
+		hist[k] = Int64GetDatum(latency_hist[k]);
+	return PointerGetDatum(construct_array(hist,
+										   XPU_STATS_LATENCY_NBUCKETS,
+										   INT8OID,
+										   sizeof(int64),
+										   FLOAT8PASSBYVAL,
+										   'd'));
+}
+
+/*
+ * pgstrom_dpu_server_stats - SQL function to dump DPU service statistics
+ */
+PG_FUNCTION_INFO_V1(pgstrom_dpu_server_stats);
+PUBLIC_FUNCTION(Datum)
+pgstrom_dpu_server_stats(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *fncxt;
+	DpuStorageEntry *ds_entry;
+	kern_server_stats stats;
+	Datum		values[12];
+	bool		isnull[12];
+	HeapTuple	tuple;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		TupleDesc		tupdesc;
+		MemoryContext	oldcxt;
+
+		fncxt = SRF_FIRSTCALL_INIT();
+		oldcxt = MemoryContextSwitchTo(fncxt->multi_call_memory_ctx);
+
+		tupdesc = CreateTemplateTupleDesc(12);
+		TupleDescInitEntry(tupdesc,  1, "dpu_id",
+						   INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc,  2, "host",
+						   TEXTOID, -1, 0);
+		TupleDescInitEntry(tupdesc,  3, "port",
+						   TEXTOID, -1, 0);
+		TupleDescInitEntry(tupdesc,  4, "dir",
+						   TEXTOID, -1, 0);
+		TupleDescInitEntry(tupdesc,  5, "active_sessions",
+						   INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc,  6, "queued_commands",
+						   INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc,  7, "bytes_read",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc,  8, "rows_scanned",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc,  9, "rows_filtered",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, 10, "open_latency_us",
+						   INT8ARRAYOID, -1, 0);
+		TupleDescInitEntry(tupdesc, 11, "exec_latency_us",
+						   INT8ARRAYOID, -1, 0);
+		TupleDescInitEntry(tupdesc, 12, "final_latency_us",
+						   INT8ARRAYOID, -1, 0);
+		fncxt->tuple_desc = BlessTupleDesc(tupdesc);
+
+		MemoryContextSwitchTo(oldcxt);
+	}
+	fncxt = SRF_PERCALL_SETUP();
+
+	if (fncxt->call_cntr >= DpuStorageEntryCount())
+		SRF_RETURN_DONE(fncxt);
+	ds_entry = &dpu_storage_master_array->entries[fncxt->call_cntr];
+
+	memset(isnull, 0, sizeof(isnull));
+	values[0] = Int32GetDatum(ds_entry->endpoint_id);
+	values[1] = CStringGetTextDatum(ds_entry->config_host);
+	values[2] = CStringGetTextDatum(ds_entry->config_port);
+	values[3] = CStringGetTextDatum(ds_entry->endpoint_dir);
+	if (__dpuFetchServerStats(ds_entry, &stats))
+	{
+		values[4] = Int32GetDatum(stats.nr_sessions);
+		values[5] = Int32GetDatum(stats.nr_queued);
+		values[6] = Int64GetDatum(stats.bytes_read);
+		values[7] = Int64GetDatum(stats.nitems_raw);
+		values[8] = Int64GetDatum(stats.nitems_raw - stats.nitems_in);
+		values[9] = __pgstrom_dpu_latency_hist_datum(
+			stats.latency_hist[XPU_STATS_CMD__OPEN_SESSION]);
+		values[10] = __pgstrom_dpu_latency_hist_datum(
+			stats.latency_hist[XPU_STATS_CMD__TASK_EXEC]);
+		values[11] = __pgstrom_dpu_latency_hist_datum(
+			stats.latency_hist[XPU_STATS_CMD__TASK_FINAL]);
+	}
+	else
+	{
+		/* endpoint is unreachable */
+		for (int j=4; j < 12; j++)
+			isnull[j] = true;
+	}
+	tuple = heap_form_tuple(fncxt->tuple_desc, values, isnull);
+
+	SRF_RETURN_NEXT(fncxt, HeapTupleGetDatum(tuple));
+}
+
 /*
  * parse_dpu_endpoint_list
  */
@@ -444,6 +706,23 @@ parse_dpu_endpoint_list(void)
 	}
 	dpu_storage_master_array->nitems   = nitems;
 
+	/* link the endpoints that serve the same directory (replicas) */
+	for (int i=0; i < nitems; i++)
+	{
+		DpuStorageEntry *curr = &dpu_storage_master_array->entries[i];
+
+		curr->replica_next = curr->endpoint_id;
+		for (int k=1; k < nitems; k++)
+		{
+			DpuStorageEntry *temp = &dpu_storage_master_array->entries[(i+k) % nitems];
+
+			if (strcmp(curr->endpoint_dir, temp->endpoint_dir) == 0)
+			{
+				curr->replica_next = temp->endpoint_id;
+				break;
+			}
+		}
+	}
 	return (nitems > 0);
 }
 
@@ -455,7 +734,7 @@ pgstrom_request_dpu_device(void)
 {
 	if (shmem_request_next)
 		shmem_request_next();
-	RequestAddinShmemSpace(MAXALIGN(sizeof(pg_atomic_uint32) *
+	RequestAddinShmemSpace(MAXALIGN(2 * sizeof(pg_atomic_uint32) *
 									dpu_storage_master_array->nitems));
 }
 
@@ -473,11 +752,14 @@ pgstrom_startup_dpu_device(void)
 		shmem_startup_next();
 	Assert(nitems > 0);
 	validated = ShmemInitStruct("DPU-Tablespace Info",
-								sizeof(pg_atomic_uint32) * nitems,
+								2 * sizeof(pg_atomic_uint32) * nitems,
 								&found);
 	for (int i=0; i < dpu_storage_master_array->nitems; i++)
 	{
 		dpu_storage_master_array->entries[i].validated = &validated[i];
+		dpu_storage_master_array->entries[i].nsessions = &validated[nitems + i];
+		if (!found)
+			pg_atomic_init_u32(&validated[nitems + i], 0);
 	}
 }
 
@@ -553,6 +835,26 @@ pgstrom_init_dpu_options(void)
 							 PGC_USERSET,
 							 GUC_NOT_IN_SAMPLE,
 							 NULL, NULL, NULL);
+	/* control whether DPU sends back LZ4 compressed results */
+	DefineCustomBoolVariable("pg_strom.dpu_compress_results",
+							 "Enables LZ4 compression of the results sent back from DPU",
+							 NULL,
+							 &pgstrom_dpu_compress_results,
+							 false,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* socket buffer size of the DPU connection */
+	DefineCustomIntVariable("pg_strom.dpu_socket_buffer_size",
+							"Socket buffer size of the connection to DPU, or 0 for auto-tuning",
+							NULL,
+							&pgstrom_dpu_socket_buffer_size,
+							0,
+							0,
+							INT_MAX / 1024,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_KB,
+							NULL, NULL, NULL);
 }
 
 /*
@@ -11,16 +11,45 @@
  */
 #include "pg_strom.h"
 #include "cuda_common.h"
+#ifdef WITH_LIBLZ4
+#include <lz4.h>
+#endif
+
+/*
+ * XpuConnectionSocket
+ *
+ * A connection usually has one socket to the xPU service. In case of the
+ * multi-GPU split execution, it has multiple sockets; one for each GPU device,
+ * and the chunks are distributed to the least loaded device.
+ */
+typedef struct
+{
+	XpuConnection  *conn;			/* owner of this socket */
+	int				dev_index;		/* cuda_dindex or dpu_endpoint_id */
+	volatile pgsocket sockfd;
+	int				num_running_cmds;	/* per device; protected by conn->mutex */
+	bool			final_this_device;	/* see pgstromTaskStateEndScan */
+} XpuConnectionSocket;
 
 /*
  * XpuConnection
  */
+typedef struct
+{
+	uint64_t		key;
+	uint32_t		offset;
+	uint32_t		length;
+	char		   *image;			/* copy of the static portion */
+} XpuSessionCacheEntry;
+
+/* upper limit of pg_strom.xpu_max_inflight_tasks (per device) */
+#define XPU_INFLIGHT_MAX_TASKS		1024
+#define XPU_INFLIGHT_TRACK_NSLOTS	2048
+
 struct XpuConnection
 {
 	dlist_node		chain;	/* link to gpuserv_connection_slots */
 	char			devname[32];
-	int				dev_index;		/* cuda_dindex or dpu_endpoint_id */
-	volatile pgsocket sockfd;
 	volatile int	terminated;		/* positive: normal exit
 									 * negative: exit by errors */
 	ResourceOwner	resowner;
@@ -31,6 +60,26 @@ struct XpuConnection
 	dlist_head		ready_cmds_list;	/* ready, but not fetched yet  */
 	dlist_head		active_cmds_list;	/* currently in-use */
 	kern_errorbuf	errorbuf;
+	bool			final_plan_pending;	/* XpuTaskFinal with final_plan_node
+										 * is not sent yet (multi-GPU only) */
+	kern_result_ring *h_ring;		/* result ring buffer, if any */
+	size_t			ring_mmap_sz;
+	char			ring_name[64];
+	bool			poolable;		/* can be kept for the next session */
+	pg_atomic_uint32 *load_counter;	/* per-endpoint load counter, if any */
+	/* static portion of the sessions kept by GPU-service */
+	XpuSessionCacheEntry session_cache[KERN_SESSION_CACHE_NSLOTS];
+	int				session_cache_next;
+	/* adaptive in-flight window; see __xpuClientUpdateInflightWindow */
+	int				inflight_window;	/* credits of the running commands */
+	double			latency_us;		/* EWMA of the response latency */
+	double			consume_us;		/* EWMA of the host consumption interval */
+	uint64_t		last_pickup_us;	/* timestamp of the last pickup */
+	uint32_t		sent_head;		/* sent_ts[] ring; protected by mutex */
+	uint32_t		sent_tail;
+	uint64_t		sent_ts[XPU_INFLIGHT_TRACK_NSLOTS];
+	int				num_socks;
+	XpuConnectionSocket socks[FLEXIBLE_ARRAY_MEMBER];
 };
 
 /* see xact.c */
@@ -39,6 +88,126 @@ extern TransactionId   *ParallelCurrentXids;
 
 /* static variables */
 static dlist_head		xpu_connections_list;
+static dlist_head		xpu_pooled_connections_list;
+static int				xpu_pooled_connections_count = 0;
+static int				pgstrom_xpu_connection_pool_size;	/* GUC */
+static int				pgstrom_xpu_task_priority;	/* GUC */
+static int				pgstrom_gpu_result_ring_size;	/* GUC; MB */
+static int				pgstrom_gpu_session_memory_limit;	/* GUC; MB */
+static bool				pgstrom_gpu_session_cache;	/* GUC */
+static int				pgstrom_xpu_max_inflight_tasks;	/* GUC */
+static bool				pgstrom_parallel_cpu_fallback;	/* GUC */
+static int				pgstrom_async_append_depth;	/* GUC */
+static bool				pgstrom_enable_columnar_results;	/* GUC */
+static int				pgstrom_chunk_size_min;	/* GUC; MB */
+static ExecutorStart_hook_type executor_start_next = NULL;
+
+/*
+ * In-flight window of the xPU commands
+ *
+ * Backend keeps at least pg_strom.max_async_tasks commands running per
+ * device, and extends the window up to pg_strom.xpu_max_inflight_tasks
+ * according to the Little's law; the number of the commands to be running
+ * to avoid the host waiting is (latency / host consumption interval).
+ * A command consumes one credit of the window on send, and returns it
+ * on the response. The latency is estimated by matching the responses
+ * with the oldest send timestamp; it is not exact for each command because
+ * commands are completed out of order, but the average is correct.
+ */
+static inline uint64_t
+__xpuClientTimestampUs(void)
+{
+	instr_time	tv;
+
+	INSTR_TIME_SET_CURRENT(tv);
+	return INSTR_TIME_GET_MICROSEC(tv);
+}
+
+/*
+ * MEMO: caller must hold 'conn->mutex'
+ */
+static inline void
+__xpuClientTrackSendCommand(XpuConnection *conn)
+{
+	if (conn->sent_head - conn->sent_tail >= XPU_INFLIGHT_TRACK_NSLOTS)
+		conn->sent_tail++;		/* overwrite the oldest one */
+	conn->sent_ts[conn->sent_head++ % XPU_INFLIGHT_TRACK_NSLOTS]
+		= __xpuClientTimestampUs();
+}
+
+/*
+ * MEMO: caller must hold 'conn->mutex'
+ */
+static inline void
+__xpuClientTrackRecvCommand(XpuConnection *conn)
+{
+	uint64_t	ts;
+	double		sample;
+
+	if (conn->sent_tail == conn->sent_head)
+		return;
+	ts = conn->sent_ts[conn->sent_tail++ % XPU_INFLIGHT_TRACK_NSLOTS];
+	sample = (double)(__xpuClientTimestampUs() - ts);
+	if (conn->latency_us <= 0.0)
+		conn->latency_us = sample;
+	else
+		conn->latency_us = 0.875 * conn->latency_us + 0.125 * sample;
+}
+
+/*
+ * __xpuClientUpdateInflightWindow
+ *
+ * MEMO: caller must hold 'conn->mutex'
+ */
+static void
+__xpuClientUpdateInflightWindow(XpuConnection *conn)
+{
+	uint64_t	now = __xpuClientTimestampUs();
+	int			window_min = pgstrom_max_async_tasks() * conn->num_socks;
+	int			window_max = pgstrom_xpu_max_inflight_tasks * conn->num_socks;
+	double		desired;
+
+	if (conn->last_pickup_us != 0)
+	{
+		double	sample = (double)(now - conn->last_pickup_us);
+
+		if (conn->consume_us <= 0.0)
+			conn->consume_us = sample;
+		else
+			conn->consume_us = 0.875 * conn->consume_us + 0.125 * sample;
+	}
+	conn->last_pickup_us = now;
+
+	if (window_max <= window_min ||
+		conn->latency_us <= 0.0 ||
+		conn->consume_us <= 0.0)
+	{
+		conn->inflight_window = window_min;
+		return;
+	}
+	desired = ceil(conn->latency_us / Max(conn->consume_us, 1.0)) + 1.0;
+	if (desired <= (double)window_min)
+		conn->inflight_window = window_min;
+	else if (desired >= (double)window_max)
+		conn->inflight_window = window_max;
+	else
+		conn->inflight_window = (int)desired;
+}
+
+/*
+ * __xpuClientResetInflightWindow
+ */
+static void
+__xpuClientResetInflightWindow(XpuConnection *conn)
+{
+	pthreadMutexLock(&conn->mutex);
+	conn->inflight_window = pgstrom_max_async_tasks() * conn->num_socks;
+	conn->latency_us = 0.0;
+	conn->consume_us = 0.0;
+	conn->last_pickup_us = 0;
+	conn->sent_tail = conn->sent_head;
+	pthreadMutexUnlock(&conn->mutex);
+}
 
 /*
  * Worker thread to receive response messages
@@ -49,15 +218,89 @@ __xpuConnectAllocCommand(void *__priv, size_t sz)
 	return malloc(sz);
 }
 
+/*
+ * __xpuConnectDecompressResults
+ *
+ * It expands the LZ4 compressed kds_dst array (sent by DPU), then returns
+ * a newly allocated XpuCommand. NULL shall be returned on errors.
+ */
+static XpuCommand *
+__xpuConnectDecompressResults(XpuCommand *xcmd, const char *devname)
+{
+	uint32_t	head_sz = xcmd->u.results.chunks_offset;
+	uint32_t	raw_sz = xcmd->u.results.chunks_rawsize;
+	XpuCommand *resp;
+	int			nbytes;
+
+	resp = malloc(head_sz + raw_sz);
+	if (!resp)
+	{
+		fprintf(stderr, "[%s] out of memory (sz=%u): %m\n",
+				devname, head_sz + raw_sz);
+		return NULL;
+	}
+	memcpy(resp, xcmd, head_sz);
+#ifdef WITH_LIBLZ4
+	nbytes = LZ4_decompress_safe((char *)xcmd + head_sz,
+								 (char *)resp + head_sz,
+								 xcmd->length - head_sz,
+								 raw_sz);
+#else
+	nbytes = -1;	/* never requested */
+#endif
+	if (nbytes != (int)raw_sz)
+	{
+		fprintf(stderr, "[%s] failed on LZ4_decompress_safe (%d of %u bytes)\n",
+				devname, nbytes, raw_sz);
+		free(resp);
+		return NULL;
+	}
+	resp->length = head_sz + raw_sz;
+	resp->u.results.chunks_rawsize = 0;
+	free(xcmd);
+
+	return resp;
+}
+
 static void
 __xpuConnectAttachCommand(void *__priv, XpuCommand *xcmd)
 {
-	XpuConnection *conn = __priv;
+	XpuConnectionSocket *sock = __priv;
+	XpuConnection *conn = sock->conn;
 
+	if ((xcmd->tag == XpuCommandTag__Success ||
+		 xcmd->tag == XpuCommandTag__SuccessPartial) &&
+		xcmd->u.results.chunks_rawsize > 0)
+	{
+		XpuCommand *temp = __xpuConnectDecompressResults(xcmd, conn->devname);
+
+		if (!temp)
+		{
+			free(xcmd);
+			pthreadMutexLock(&conn->mutex);
+			conn->terminated = -1;
+			SetLatch(MyLatch);
+			pthreadMutexUnlock(&conn->mutex);
+			return;
+		}
+		xcmd = temp;
+	}
 	xcmd->priv = conn;
 	pthreadMutexLock(&conn->mutex);
-	Assert(conn->num_running_cmds > 0);
+	if (xcmd->tag == XpuCommandTag__SuccessPartial)
+	{
+		/* partial results; the command is still running */
+		dlist_push_tail(&conn->ready_cmds_list, &xcmd->chain);
+		conn->num_ready_cmds++;
+		SetLatch(MyLatch);
+		pthreadMutexUnlock(&conn->mutex);
+		return;
+	}
+	Assert(conn->num_running_cmds > 0 &&
+		   sock->num_running_cmds > 0);
 	conn->num_running_cmds--;
+	sock->num_running_cmds--;
+	__xpuClientTrackRecvCommand(conn);
 	if (xcmd->tag == XpuCommandTag__Error)
 	{
 		if (conn->errorbuf.errcode == ERRCODE_STROM_SUCCESS)
@@ -83,20 +326,21 @@ static void *
 __xpuConnectSessionWorker(void *__priv)
 {
 	XpuConnection *conn = __priv;
+	struct pollfd *pfds = alloca(sizeof(struct pollfd) * conn->num_socks);
 
 	for (;;)
 	{
-		struct pollfd pfd;
-		int		sockfd;
 		int		nevents;
 
-		sockfd = conn->sockfd;
-		if (sockfd < 0)
-			break;
-		pfd.fd = sockfd;
-		pfd.events = POLLIN;
-		pfd.revents = 0;
-		nevents = poll(&pfd, 1, -1);
+		for (int i=0; i < conn->num_socks; i++)
+		{
+			pfds[i].fd = conn->socks[i].sockfd;
+			pfds[i].events = POLLIN;
+			pfds[i].revents = 0;
+			if (pfds[i].fd < 0)
+				goto bailout;
+		}
+		nevents = poll(pfds, conn->num_socks, -1);
 		if (nevents < 0)
 		{
 			if (errno == EINTR)
@@ -105,10 +349,9 @@ __xpuConnectSessionWorker(void *__priv)
 					conn->devname, __FILE_NAME__, __LINE__);
 			break;
 		}
-		else if (nevents > 0)
+		for (int i=0; i < conn->num_socks && nevents > 0; i++)
 		{
-			Assert(nevents == 1);
-			if (pfd.revents & ~POLLIN)
+			if (pfds[i].revents & ~POLLIN)
 			{
 				pthreadMutexLock(&conn->mutex);
 				conn->terminated = 1;
@@ -116,15 +359,17 @@ __xpuConnectSessionWorker(void *__priv)
 				pthreadMutexUnlock(&conn->mutex);
 				return NULL;
 			}
-			else if (pfd.revents & POLLIN)
+			else if (pfds[i].revents & POLLIN)
 			{
-				if (__xpuConnectReceiveCommands(conn->sockfd,
-												conn,
+				if (__xpuConnectReceiveCommands(pfds[i].fd,
+												&conn->socks[i],
 												conn->devname) < 0)
-					break;
+					goto bailout;
+				nevents--;
 			}
 		}
 	}
+bailout:
 	pthreadMutexLock(&conn->mutex);
 	conn->terminated = -1;
 	SetLatch(MyLatch);
@@ -133,19 +378,77 @@ __xpuConnectSessionWorker(void *__priv)
 	return NULL;
 }
 
+/*
+ * __xpuClientChooseSocket
+ *
+ * It chooses the socket with the least running commands.
+ *
+ * MEMO: caller must hold 'conn->mutex'
+ */
+static XpuConnectionSocket *
+__xpuClientChooseSocket(XpuConnection *conn)
+{
+	XpuConnectionSocket *sock = &conn->socks[0];
+
+	for (int i=1; i < conn->num_socks; i++)
+	{
+		if (conn->socks[i].num_running_cmds < sock->num_running_cmds)
+			sock = &conn->socks[i];
+	}
+	return sock;
+}
+
+/*
+ * __xpuClientChooseSocketByLocality
+ *
+ * It chooses the socket of the optimal GPUs for the chunk, with the least
+ * running commands. However, if the optimal GPUs are overloaded than the
+ * others, by pg_strom.max_async_tasks commands or more, the storage
+ * bandwidth is no longer the bottleneck, so the least loaded socket is
+ * chosen regardless of the locality.
+ *
+ * MEMO: caller must hold 'conn->mutex'
+ */
+static XpuConnectionSocket *
+__xpuClientChooseSocketByLocality(XpuConnection *conn, int64_t optimal_gpus)
+{
+	XpuConnectionSocket *sock = __xpuClientChooseSocket(conn);
+	XpuConnectionSocket *lsock = NULL;
+
+	for (int i=0; i < conn->num_socks; i++)
+	{
+		XpuConnectionSocket *curr = &conn->socks[i];
+
+		if ((optimal_gpus & (1UL << curr->dev_index)) != 0 &&
+			(!lsock || curr->num_running_cmds < lsock->num_running_cmds))
+			lsock = curr;
+	}
+	if (lsock && (lsock->num_running_cmds <
+				  sock->num_running_cmds + pgstrom_max_async_tasks()))
+		return lsock;
+	return sock;
+}
+
 /*
  * xpuClientSendCommand
  */
 void
 xpuClientSendCommand(XpuConnection *conn, const XpuCommand *xcmd)
 {
-	int			sockfd = conn->sockfd;
+	int			sockfd;
 	const char *buf = (const char *)xcmd;
 	size_t		len = xcmd->length;
 	ssize_t		nbytes;
 
 	pthreadMutexLock(&conn->mutex);
-	conn->num_running_cmds++;
+	{
+		XpuConnectionSocket *sock = __xpuClientChooseSocket(conn);
+
+		sockfd = sock->sockfd;
+		sock->num_running_cmds++;
+		conn->num_running_cmds++;
+		__xpuClientTrackSendCommand(conn);
+	}
 	pthreadMutexUnlock(&conn->mutex);
 
 	while (len > 0)
@@ -167,16 +470,26 @@ xpuClientSendCommand(XpuConnection *conn, const XpuCommand *xcmd)
 
 /*
  * xpuClientSendCommandIOV
+ *
+ * It sends the command to the supplied socket, or the least loaded one
+ * if 'sock' is NULL.
  */
 static void
-xpuClientSendCommandIOV(XpuConnection *conn, struct iovec *iov, int iovcnt)
+xpuClientSendCommandIOV(XpuConnection *conn,
+						XpuConnectionSocket *sock,
+						struct iovec *iov, int iovcnt)
 {
-	int			sockfd = conn->sockfd;
+	int			sockfd;
 	ssize_t		nbytes;
 
 	Assert(iovcnt > 0);
 	pthreadMutexLock(&conn->mutex);
+	if (!sock)
+		sock = __xpuClientChooseSocket(conn);
+	sockfd = sock->sockfd;
+	sock->num_running_cmds++;
 	conn->num_running_cmds++;
+	__xpuClientTrackSendCommand(conn);
 	pthreadMutexUnlock(&conn->mutex);
 
 	while (iovcnt > 0)
@@ -215,13 +528,41 @@ void
 xpuClientPutResponse(XpuCommand *xcmd)
 {
 	XpuConnection  *conn = xcmd->priv;
-	
+
+	if ((xcmd->tag == XpuCommandTag__Success ||
+		 xcmd->tag == XpuCommandTag__SuccessPartial) &&
+		xcmd->u.results.chunks_ring_offset != 0)
+	{
+		kern_result_ring_block *block = (kern_result_ring_block *)
+			((char *)conn->h_ring + xcmd->u.results.chunks_ring_offset -
+			 offsetof(kern_result_ring_block, data));
+		/* GPU-service can reuse the block */
+		pg_memory_barrier();
+		block->released = 1;
+	}
 	pthreadMutexLock(&conn->mutex);
 	dlist_delete(&xcmd->chain);
 	pthreadMutexUnlock(&conn->mutex);
 	free(xcmd);
 }
 
+/*
+ * xpuClientFirstResultChunk
+ */
+static inline kern_data_store *
+xpuClientFirstResultChunk(XpuCommand *resp)
+{
+	if (resp->u.results.chunks_ring_offset != 0)
+	{
+		XpuConnection  *conn = resp->priv;
+
+		Assert(conn->h_ring != NULL);
+		return (kern_data_store *)
+			((char *)conn->h_ring + resp->u.results.chunks_ring_offset);
+	}
+	return (kern_data_store *)((char *)resp + resp->u.results.chunks_offset);
+}
+
 /*
  * xpuClientCloseSession
  */
@@ -232,8 +573,11 @@ xpuClientCloseSession(XpuConnection *conn)
 	dlist_node *dnode;
 
 	/* ensure termination of worker thread */
-	close(conn->sockfd);
-	conn->sockfd = -1;
+	for (int i=0; i < conn->num_socks; i++)
+	{
+		close(conn->socks[i].sockfd);
+		conn->socks[i].sockfd = -1;
+	}
 	pg_memory_barrier();
 	pthread_kill(conn->worker, SIGPOLL);
 	pthread_join(conn->worker, NULL);
@@ -250,10 +594,181 @@ xpuClientCloseSession(XpuConnection *conn)
 		xcmd = dlist_container(XpuCommand, chain, dnode);
 		free(xcmd);
 	}
+	if (conn->load_counter)
+		pg_atomic_fetch_sub_u32(conn->load_counter, 1);
+	if (conn->h_ring)
+	{
+		if (munmap(conn->h_ring, conn->ring_mmap_sz) != 0)
+			elog(WARNING, "failed on munmap('%s'): %m", conn->ring_name);
+		/* usually, already unlinked at the session open */
+		shm_unlink(conn->ring_name);
+	}
+	for (int i=0; i < KERN_SESSION_CACHE_NSLOTS; i++)
+	{
+		if (conn->session_cache[i].image)
+			free(conn->session_cache[i].image);
+	}
 	dlist_delete(&conn->chain);
 	free(conn);
 }
 
+/*
+ * xpuClientAttachLoadCounter
+ *
+ * It attaches the load counter of the endpoint (already incremented by the
+ * caller), to be decremented when the connection is closed.
+ */
+void
+xpuClientAttachLoadCounter(XpuConnection *conn, pg_atomic_uint32 *load_counter)
+{
+	Assert(!conn->poolable && !conn->load_counter);
+	conn->load_counter = load_counter;
+}
+
+/*
+ * __xpuClientPoolConnection
+ *
+ * It tries to keep the connection for the next session, instead of closing.
+ * The xPU service releases the resources of the previous session on
+ * XpuCommandTag__ResetSession, but the socket, the worker thread (and its
+ * counterpart in the xPU service) and the result ring are kept, so the
+ * next session can skip the setup. Only the connections
+ * terminated normally are kept.
+ */
+static bool
+__xpuClientPoolConnection(XpuConnection *conn)
+{
+	XpuCommand	xcmd;
+	XpuCommand *resp;
+	dlist_node *dnode;
+	bool		ok;
+
+	if (pgstrom_xpu_connection_pool_size <= 0 ||
+		!conn->poolable ||
+		conn->num_socks != 1)
+		return false;
+	pthreadMutexLock(&conn->mutex);
+	ok = (conn->terminated == 0 &&
+		  conn->num_running_cmds == 0 &&
+		  conn->errorbuf.errcode == ERRCODE_STROM_SUCCESS);
+	pthreadMutexUnlock(&conn->mutex);
+	if (!ok)
+		return false;
+
+	/* release the oldest one, if too many connections are kept */
+	if (xpu_pooled_connections_count >= pgstrom_xpu_connection_pool_size)
+	{
+		XpuConnection *oldest;
+
+		dnode = dlist_pop_head_node(&xpu_pooled_connections_list);
+		oldest = dlist_container(XpuConnection, chain, dnode);
+		xpu_pooled_connections_count--;
+		dlist_push_tail(&xpu_connections_list, &oldest->chain);
+		xpuClientCloseSession(oldest);
+	}
+
+	/* send ResetSession; no ereport() here */
+	memset(&xcmd, 0, sizeof(XpuCommand));
+	xcmd.magic = XpuCommandMagicNumber;
+	xcmd.tag = XpuCommandTag__ResetSession;
+	xcmd.length = offsetof(XpuCommand, u);
+	pthreadMutexLock(&conn->mutex);
+	conn->socks[0].num_running_cmds++;
+	conn->num_running_cmds++;
+	__xpuClientTrackSendCommand(conn);
+	pthreadMutexUnlock(&conn->mutex);
+	if (write(conn->socks[0].sockfd, &xcmd, xcmd.length) != xcmd.length)
+		return false;
+
+	/* results of the previous session are no longer referenced */
+	pthreadMutexLock(&conn->mutex);
+	while (!dlist_is_empty(&conn->ready_cmds_list))
+	{
+		dnode = dlist_pop_head_node(&conn->ready_cmds_list);
+		resp = dlist_container(XpuCommand, chain, dnode);
+		free(resp);
+	}
+	conn->num_ready_cmds = 0;
+	while (!dlist_is_empty(&conn->active_cmds_list))
+	{
+		dnode = dlist_pop_head_node(&conn->active_cmds_list);
+		resp = dlist_container(XpuCommand, chain, dnode);
+		free(resp);
+	}
+	pthreadMutexUnlock(&conn->mutex);
+
+	dlist_delete(&conn->chain);
+	conn->resowner = NULL;
+	dlist_push_tail(&xpu_pooled_connections_list, &conn->chain);
+	xpu_pooled_connections_count++;
+	return true;
+}
+
+/*
+ * xpuClientReleaseSession
+ *
+ * It closes the session at the end of execution; the connection may be
+ * kept for the next session.
+ */
+static void
+xpuClientReleaseSession(XpuConnection *conn)
+{
+	if (!__xpuClientPoolConnection(conn))
+		xpuClientCloseSession(conn);
+}
+
+/*
+ * __xpuClientWaitResetSession
+ *
+ * It waits for the response of XpuCommandTag__ResetSession.
+ */
+static bool
+__xpuClientWaitResetSession(XpuConnection *conn)
+{
+	XpuCommand *resp;
+	dlist_node *dnode;
+	bool		ok;
+
+	pthreadMutexLock(&conn->mutex);
+	for (;;)
+	{
+		int		ev;
+
+		ResetLatch(MyLatch);
+		if (conn->num_running_cmds == 0 ||
+			conn->terminated != 0 ||
+			conn->errorbuf.errcode != ERRCODE_STROM_SUCCESS)
+			break;
+		pthreadMutexUnlock(&conn->mutex);
+
+		CHECK_FOR_INTERRUPTS();
+		ev = WaitLatch(MyLatch,
+					   WL_LATCH_SET |
+					   WL_TIMEOUT |
+					   WL_POSTMASTER_DEATH,
+					   1000L,
+					   PG_WAIT_EXTENSION);
+		if (ev & WL_POSTMASTER_DEATH)
+			ereport(FATAL,
+					(errcode(ERRCODE_ADMIN_SHUTDOWN),
+					 errmsg("Unexpected Postmaster dead")));
+		pthreadMutexLock(&conn->mutex);
+	}
+	ok = (conn->num_running_cmds == 0 &&
+		  conn->terminated == 0 &&
+		  conn->errorbuf.errcode == ERRCODE_STROM_SUCCESS);
+	while (!dlist_is_empty(&conn->ready_cmds_list))
+	{
+		dnode = dlist_pop_head_node(&conn->ready_cmds_list);
+		resp = dlist_container(XpuCommand, chain, dnode);
+		free(resp);
+	}
+	conn->num_ready_cmds = 0;
+	pthreadMutexUnlock(&conn->mutex);
+
+	return ok;
+}
+
 /*
  * xpuclientCleanupConnections
  */
@@ -275,8 +790,8 @@ xpuclientCleanupConnections(ResourceReleasePhase phase,
 		if (conn->resowner == CurrentResourceOwner)
 		{
 			if (isCommit)
-				elog(LOG, "Bug? GPU connection %d is not closed on ExecEnd",
-					 conn->sockfd);
+				elog(LOG, "Bug? %s connection is not closed on ExecEnd",
+					 conn->devname);
 			xpuClientCloseSession(conn);
 		}
 	}
@@ -495,8 +1010,55 @@ __build_session_timezone(StringInfo buf)
 
 	if (session_timezone)
 	{
+		const struct pg_tz_state *state = &session_timezone->state;
+		kern_tz_compact *tzc;
+		int32_t	   *offsets;
+		int			ntrans = state->timecnt;
+		size_t		sz;
+
 		offset = __appendBinaryStringInfo(buf, session_timezone,
 										  sizeof(struct pg_tz));
+		/*
+		 * Compact transition table shall be put on the next; it is not
+		 * available if timezone has leap seconds or something corrupted.
+		 */
+		if (state->leapcnt != 0 ||
+			ntrans < 0 || ntrans > TZ_MAX_TIMES ||
+			state->defaulttype < 0 || state->defaulttype >= state->typecnt)
+			ntrans = -1;
+		else
+		{
+			for (int i=0; i < ntrans; i++)
+			{
+				if (state->types[i] >= state->typecnt)
+				{
+					ntrans = -1;
+					break;
+				}
+			}
+		}
+		sz = KERN_TZ_COMPACT_LENGTH(Max(ntrans, 0));
+		tzc = alloca(sz);
+		memset(tzc, 0, sz);
+		tzc->ntrans = ntrans;
+		if (ntrans >= 0)
+		{
+			const struct pg_tz_ttinfo *ttis = &state->ttis[state->defaulttype];
+
+			tzc->default_offset = ttis->tt_utoff * 2 + (ttis->tt_isdst ? 1 : 0);
+			tzc->lower_bound = ((ntrans > 0 && state->goback)
+								? state->ats[0] : PG_INT64_MIN);
+			tzc->upper_bound = ((ntrans > 0 && state->goahead)
+								? state->ats[ntrans-1] : PG_INT64_MAX);
+			offsets = KERN_TZ_COMPACT_OFFSETS(tzc);
+			for (int i=0; i < ntrans; i++)
+			{
+				ttis = &state->ttis[state->types[i]];
+				tzc->ats[i] = state->ats[i];
+				offsets[i] = ttis->tt_utoff * 2 + (ttis->tt_isdst ? 1 : 0);
+			}
+		}
+		__appendBinaryStringInfo(buf, tzc, sz);
 	}
 	return offset;
 }
@@ -525,13 +1087,42 @@ __build_session_lconvert(kern_session_info *session)
 	session->session_currency_frac_digits = lconvert->frac_digits;
 }
 
-const XpuCommand *
-pgstromBuildSessionInfo(pgstromTaskState *pts,
-						uint32_t join_inner_handle,
-						TupleDesc groupby_tdesc_final)
+/*
+ * __columnar_results_available
+ *
+ * GPU-Service packs the results into KDS_FORMAT_COLUMN, if all the columns
+ * of the GPU projection are fixed-length and by-value. GPU Sort and
+ * STRING_AGG need heap-tuples as is, so they are not the target.
+ */
+static bool
+__columnar_results_available(pgstromTaskState *pts)
 {
-	pgstromSharedState *ps_state = pts->ps_state;
-	pgstromPlanInfo *pp_info = pts->pp_info;
+	TupleDesc	tupdesc = pts->css.ss.ps.scandesc;
+
+	if (!pgstrom_enable_columnar_results ||
+		(pts->xpu_task_flags & DEVKIND__NVIDIA_GPU) == 0 ||
+		(pts->xpu_task_flags & DEVTASK__PREAGG) != 0 ||
+		OidIsValid(pts->pp_info->gpusort_sortop) ||
+		pts->groupby_accum_attrs != NULL ||
+		tupdesc->natts == 0)
+		return false;
+	for (int j=0; j < tupdesc->natts; j++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, j);
+
+		if (attr->attlen <= 0 || !attr->attbyval)
+			return false;
+	}
+	return true;
+}
+
+const XpuCommand *
+pgstromBuildSessionInfo(pgstromTaskState *pts,
+						uint32_t join_inner_handle,
+						TupleDesc groupby_tdesc_final)
+{
+	pgstromSharedState *ps_state = pts->ps_state;
+	pgstromPlanInfo *pp_info = pts->pp_info;
 	ExprContext	   *econtext = pts->css.ss.ps.ps_ExprContext;
 	ParamListInfo	param_info = econtext->ecxt_param_list_info;
 	uint32_t		nparams = (param_info ? param_info->numParams : 0);
@@ -540,14 +1131,21 @@ pgstromBuildSessionInfo(pgstromTaskState *pts,
 	XpuCommand	   *xcmd;
 	StringInfoData	buf;
 	bytea		   *xpucode;
+	uint32_t		static_offset;
 
 	initStringInfo(&buf);
 	session_sz = offsetof(kern_session_info, poffset[nparams]);
 	session = alloca(session_sz);
 	memset(session, 0, session_sz);
 	__appendZeroStringInfo(&buf, session_sz);
-	if (param_info)
-		__build_session_param_info(pts, session, &buf);
+
+	/*
+	 * The static portion (xpucode, kvars definitions, kds_final, timezone
+	 * and encoding) is put on the head, because it is identical across
+	 * executions of the same plan, thus GPU-service can cache it. The
+	 * dynamic portion (parameters and transaction state) follows.
+	 */
+	static_offset = buf.len;
 	if (pp_info->kvars_deflist != NIL)
 		__build_session_kvars_defs(pts, session, &buf);
 	if (pp_info->kexp_load_vars_packed)
@@ -598,6 +1196,14 @@ pgstromBuildSessionInfo(pgstromTaskState *pts,
 									 VARDATA(xpucode),
 									 VARSIZE(xpucode) - VARHDRSZ);
 	}
+	if (pp_info->kexp_range_keys_packed)
+	{
+		xpucode = pp_info->kexp_range_keys_packed;
+		session->xpucode_range_keys_packed =
+			__appendBinaryStringInfo(&buf,
+									 VARDATA(xpucode),
+									 VARSIZE(xpucode) - VARHDRSZ);
+	}
 	if (pp_info->kexp_projection)
 	{
 		xpucode = pp_info->kexp_projection;
@@ -666,19 +1272,56 @@ pgstromBuildSessionInfo(pgstromTaskState *pts,
 		session->groupby_kds_final = __appendBinaryStringInfo(&buf, kds_temp, sz);
 		session->groupby_prepfn_bufsz = pp_info->groupby_prepfn_bufsz;
 		session->groupby_ngroups_estimation = pts->css.ss.ps.plan->plan_rows;
+		session->groupby_final_mode = pp_info->groupby_final_mode;
 	}
 	/* other database session information */
 	session->query_plan_id = ps_state->query_plan_id;
+	/*
+	 * grace hash-join loads different inner buffer for each pass, so
+	 * GPU service must not pick up the query buffer of the previous pass.
+	 */
+	if (pts->inner_part_depth > 0)
+	{
+		/* each pass has its own kds_final, so groups are not unique */
+		if (pp_info->groupby_final_mode)
+			elog(ERROR, "GpuPreAgg with final aggregation cannot run on the partitioned inner buffer");
+		session->query_plan_id |= ((uint64_t)pts->inner_part_id << 16);
+	}
 	session->kcxt_kvecs_bufsz = pp_info->kvecs_bufsz;
 	session->kcxt_kvecs_ndims = pp_info->kvecs_ndims;
 	session->kcxt_extra_bufsz = pp_info->extra_bufsz;
 	session->cuda_stack_size  = pp_info->cuda_stack_size;
 	session->xpu_task_flags = pts->xpu_task_flags;
+	session->topk_nitems = pp_info->topk_nitems;
+	session->limit_nitems = pp_info->limit_nitems;
+	session->sortkey_resno  = pp_info->sortkey_resno;
+	session->sortkey_flags  = pp_info->sortkey_flags;
+	session->sortkey2_resno = pp_info->sortkey2_resno;
+	session->sortkey2_flags = pp_info->sortkey2_flags;
+	session->gpusort_chunks = OidIsValid(pp_info->gpusort_sortop);
+	session->columnar_results = __columnar_results_available(pts);
+	session->xpu_task_priority = pgstrom_xpu_task_priority;
+	session->gpumem_limit_mb = pgstrom_gpu_session_memory_limit;
+#ifdef WITH_LIBLZ4
+	session->compress_results = (pts->ds_entry != NULL &&
+								 pgstrom_dpu_compress_results);
+#endif
 	session->hostEpochTimestamp = SetEpochTimestamp();
 	session->xactStartTimestamp = GetCurrentTransactionStartTimestamp();
-	session->session_xact_state = __build_session_xact_state(&buf);
 	session->session_timezone = __build_session_timezone(&buf);
 	session->session_encode = __build_session_encode(&buf);
+	if (pgstrom_gpu_session_cache && buf.len > static_offset)
+	{
+		uint64_t	key = hash_bytes_extended((const unsigned char *)
+											  buf.data + static_offset,
+											  buf.len - static_offset, 0);
+		session->session_cache_key = (key != 0 ? key : 1);
+		session->session_cache_offset = static_offset;
+		session->session_cache_length = buf.len - static_offset;
+	}
+	if (param_info)
+		__build_session_param_info(pts, session, &buf);
+	session->session_xact_state = __build_session_xact_state(&buf);
 	__build_session_lconvert(session);
 	session->pgsql_port_number = PostPortNumber;
 	session->pgsql_plan_node_id = pts->css.ss.ps.plan->plan_node_id;
@@ -715,12 +1358,17 @@ pgstromTaskStateBeginScan(pgstromTaskState *pts)
 		newval = curval + 2;
 	} while (!pg_atomic_compare_exchange_u32(&ps_state->parallel_task_control,
 											 &curval, newval));
-	pg_atomic_fetch_add_u32(&pts->rjoin_devs_count[conn->dev_index], 1);
+	for (int i=0; i < conn->num_socks; i++)
+		pg_atomic_fetch_add_u32(&pts->rjoin_devs_count[conn->socks[i].dev_index], 1);
 	return true;
 }
 
 /*
  * pgstromTaskStateEndScan
+ *
+ * In case of multi-GPU split execution, 'final_this_device' of kfin is set
+ * if any of the devices get finished; see socks[*].final_this_device for
+ * the individual devices.
  */
 static bool
 pgstromTaskStateEndScan(pgstromTaskState *pts, kern_final_task *kfin)
@@ -740,8 +1388,15 @@ pgstromTaskStateEndScan(pgstromTaskState *pts, kern_final_task *kfin)
 	if (newval == 1)
 		kfin->final_plan_node = true;
 
-	if (pg_atomic_sub_fetch_u32(&pts->rjoin_devs_count[conn->dev_index], 1) == 0)
-		kfin->final_this_device = true;
+	for (int i=0; i < conn->num_socks; i++)
+	{
+		XpuConnectionSocket *sock = &conn->socks[i];
+
+		sock->final_this_device =
+			(pg_atomic_sub_fetch_u32(&pts->rjoin_devs_count[sock->dev_index], 1) == 0);
+		if (sock->final_this_device)
+			kfin->final_this_device = true;
+	}
 
 	return (kfin->final_plan_node | kfin->final_this_device);
 }
@@ -755,6 +1410,10 @@ pgstromTaskStateResetScan(pgstromTaskState *pts)
 	pgstromSharedState *ps_state = pts->ps_state;
 	int		num_devs = 0;
 
+	pts->scan_done = false;
+	pts->final_done = false;
+	pts->limit_nitems_received = 0;
+	pts->chunk_size = 0;
 	/*
 	 * pgstromExecTaskState() is never called on the single process
 	 * execution, thus we have no state to reset.
@@ -793,6 +1452,90 @@ pgstromTaskStateResetScan(pgstromTaskState *pts)
 	}
 }
 
+/*
+ * __updateStatsXpuTaskPhases
+ */
+static void
+__updateStatsXpuTaskPhases(pgstromSharedState *ps_state,
+						   const kern_exec_results *results)
+{
+	uint64_t	ts[XPU_TASK_NUM_PHASES + 1];
+
+	ts[0] = results->ts_enqueue;
+	ts[1] = results->ts_dequeue;
+	ts[2] = results->ts_io_done;
+	ts[3] = results->ts_kernel_done;
+	ts[4] = results->ts_write_back;
+	ts[5] = monotonic_clock_us();
+	pg_atomic_fetch_add_u64(&ps_state->phase_ntasks, 1);
+	for (int i=0; i < XPU_TASK_NUM_PHASES; i++)
+	{
+		uint64_t	usec = (ts[i+1] > ts[i] ? ts[i+1] - ts[i] : 0);
+		int			k = 0;
+
+		while (k < XPU_TASK_PHASE_NBUCKETS - 1 && usec >= (1UL << k))
+			k++;
+		pg_atomic_fetch_add_u64(&ps_state->phase_time_us[i], usec);
+		pg_atomic_fetch_add_u32(&ps_state->phase_hist[i][k], 1);
+	}
+}
+
+/*
+ * pgstromTaskStateChunkSize
+ *
+ * It returns the size of the next source chunk. The scan starts with
+ * pg_strom.chunk_size_min to return the first rows quickly, then the
+ * chunk size is adjusted according to the measured results.
+ */
+size_t
+pgstromTaskStateChunkSize(pgstromTaskState *pts)
+{
+	if (pts->chunk_size == 0)
+	{
+		/* DPU does not report the kernel time */
+		if ((pts->xpu_task_flags & DEVKIND__NVIDIA_GPU) != 0)
+			pts->chunk_size = Min((size_t)pgstrom_chunk_size_min << 20,
+								  PGSTROM_CHUNK_SIZE);
+		else
+			pts->chunk_size = PGSTROM_CHUNK_SIZE;
+	}
+	return pts->chunk_size;
+}
+
+/*
+ * __updateChunkSizeXpuCommand
+ *
+ * Short kernel time means the per-task overhead is dominant, so the chunk
+ * size is doubled, unless the results are already large (high selectivity
+ * or expanding joins). Results larger than the source chunk make multiple
+ * destination buffers and suspend/resume of the kernel, so the chunk size
+ * is halved.
+ */
+#define CHUNK_SIZE_KERNEL_TIME_SHORT	10000	/* 10ms */
+
+static void
+__updateChunkSizeXpuCommand(pgstromTaskState *pts, const XpuCommand *xcmd)
+{
+	size_t		chunk_min = Min((size_t)pgstrom_chunk_size_min << 20,
+								PGSTROM_CHUNK_SIZE);
+	size_t		chunk_sz = pgstromTaskStateChunkSize(pts);
+	size_t		result_sz = xcmd->length - xcmd->u.results.chunks_offset;
+	uint64_t	kernel_us;
+
+	if (xcmd->u.results.ts_io_done == 0 ||
+		xcmd->u.results.ts_kernel_done < xcmd->u.results.ts_io_done ||
+		xcmd->u.results.nitems_raw == 0)
+		return;
+	kernel_us = (xcmd->u.results.ts_kernel_done -
+				 xcmd->u.results.ts_io_done);
+	if (result_sz > chunk_sz)
+		chunk_sz = Max(chunk_sz / 2, chunk_min);
+	else if (kernel_us < CHUNK_SIZE_KERNEL_TIME_SHORT &&
+			 result_sz < chunk_sz / 2)
+		chunk_sz = Min(chunk_sz * 2, PGSTROM_CHUNK_SIZE);
+	pts->chunk_size = chunk_sz;
+}
+
 /*
  * __updateStatsXpuCommand
  */
@@ -820,6 +1563,14 @@ __updateStatsXpuCommand(pgstromTaskState *pts, const XpuCommand *xcmd)
 									xcmd->u.results.stats[i].nitems_out);
 		}
 		pg_atomic_fetch_add_u64(&ps_state->result_ntuples, xcmd->u.results.nitems_out);
+		pg_atomic_fetch_or_u32(&ps_state->exec_paths, xcmd->u.results.exec_paths);
+		if (xcmd->u.results.chunks_ring_offset != 0)
+			pg_atomic_fetch_or_u32(&ps_state->exec_paths,
+								   XPU_EXEC_PATH__RESULT_RING);
+		pts->limit_nitems_received += xcmd->u.results.nitems_out;
+		if (xcmd->u.results.ts_enqueue != 0)
+			__updateStatsXpuTaskPhases(ps_state, &xcmd->u.results);
+		__updateChunkSizeXpuCommand(pts, xcmd);
 	}
 	else if (xcmd->tag == XpuCommandTag__CPUFallback)
 	{
@@ -848,10 +1599,55 @@ __pickupNextXpuCommand(XpuConnection *conn)
 	xcmd = dlist_container(XpuCommand, chain, dnode);
 	dlist_push_tail(&conn->active_cmds_list, &xcmd->chain);
 	conn->num_ready_cmds--;
+	__xpuClientUpdateInflightWindow(conn);
 
 	return xcmd;
 }
 
+/*
+ * __xpuClientSendFinalChunkMulti
+ *
+ * In case of multi-GPU split execution, XpuTaskFinal is sent to each device
+ * that finished its own portion. final_plan_node is deferred until all of them
+ * responded, because RIGHT OUTER JOIN on the CPU side needs the outer-join-map
+ * merged by all the devices.
+ */
+static void
+__xpuClientSendFinalChunkMulti(pgstromTaskState *pts, kern_final_task *kfin)
+{
+	XpuConnection  *conn = pts->conn;
+	XpuCommand	   *xcmd;
+	struct iovec	xcmd_iov[10];
+	int				xcmd_iovcnt;
+
+	for (int i=0; i < conn->num_socks; i++)
+	{
+		XpuConnectionSocket *sock = &conn->socks[i];
+		kern_final_task	__kfin;
+
+		if (!sock->final_this_device)
+			continue;
+		memset(&__kfin, 0, sizeof(kern_final_task));
+		__kfin.final_this_device = true;
+		xcmd = pts->cb_final_chunk(pts, &__kfin, xcmd_iov, &xcmd_iovcnt);
+		if (xcmd)
+			xpuClientSendCommandIOV(conn, sock, xcmd_iov, xcmd_iovcnt);
+	}
+	if (kfin->final_plan_node)
+		conn->final_plan_pending = true;
+}
+
+/*
+ * __xpuTaskWaitEvent - wait event to be reported during the wait for xPU
+ */
+static inline uint32
+__xpuTaskWaitEvent(pgstromTaskState *pts)
+{
+	if ((pts->xpu_task_flags & DEVKIND__NVIDIA_DPU) != 0)
+		return pgstrom_wait_event(PGSTROM_WAIT_EVENT__DPU_TASK);
+	return pgstrom_wait_event(PGSTROM_WAIT_EVENT__GPU_TASK);
+}
+
 static XpuCommand *
 __waitAndFetchNextXpuCommand(pgstromTaskState *pts, bool try_final_callback)
 {
@@ -903,14 +1699,39 @@ __waitAndFetchNextXpuCommand(pgstromTaskState *pts, bool try_final_callback)
 					pgstromTaskStateEndScan(pts, &kfin) &&
 					pts->cb_final_chunk != NULL)
 				{
+					if (conn->num_socks > 1)
+					{
+						__xpuClientSendFinalChunkMulti(pts, &kfin);
+						pthreadMutexLock(&conn->mutex);
+						continue;
+					}
 					xcmd = pts->cb_final_chunk(pts, &kfin, xcmd_iov, &xcmd_iovcnt);
 					if (xcmd)
 					{
-						xpuClientSendCommandIOV(conn, xcmd_iov, xcmd_iovcnt);
+						xpuClientSendCommandIOV(conn, NULL, xcmd_iov, xcmd_iovcnt);
+						pthreadMutexLock(&conn->mutex);
 						continue;
 					}
 				}
 			}
+			else if (conn->final_plan_pending)
+			{
+				kern_final_task	kfin;
+
+				/*
+				 * All the devices already responded to XpuTaskFinal, so
+				 * the outer-join-maps are merged. Then, kick final_plan_node.
+				 */
+				conn->final_plan_pending = false;
+				memset(&kfin, 0, sizeof(kern_final_task));
+				kfin.final_plan_node = true;
+				xcmd = pts->cb_final_chunk(pts, &kfin, xcmd_iov, &xcmd_iovcnt);
+				if (xcmd)
+					xpuClientSendCommandIOV(conn, &conn->socks[0],
+											xcmd_iov, xcmd_iovcnt);
+				pthreadMutexLock(&conn->mutex);
+				continue;
+			}
 			return NULL;
 		}
 		CHECK_FOR_INTERRUPTS();
@@ -920,7 +1741,7 @@ __waitAndFetchNextXpuCommand(pgstromTaskState *pts, bool try_final_callback)
 					   WL_TIMEOUT |
 					   WL_POSTMASTER_DEATH,
 					   1000L,
-					   PG_WAIT_EXTENSION);
+					   __xpuTaskWaitEvent(pts));
 		if (ev & WL_POSTMASTER_DEATH)
 			ereport(FATAL,
 					(errcode(ERRCODE_ADMIN_SHUTDOWN),
@@ -933,20 +1754,61 @@ __waitAndFetchNextXpuCommand(pgstromTaskState *pts, bool try_final_callback)
 	return xcmd;
 }
 
-static XpuCommand *
-__fetchNextXpuCommand(pgstromTaskState *pts)
+/*
+ * __sendNextXpuCommand
+ *
+ * It loads the next chunk and sends the command to the xPU service.
+ * It returns false if no more chunks.
+ */
+static bool
+__sendNextXpuCommand(pgstromTaskState *pts)
 {
 	XpuConnection  *conn = pts->conn;
 	XpuCommand	   *xcmd;
 	struct iovec	xcmd_iov[10];
 	int				xcmd_iovcnt;
+
+	xcmd = pts->cb_next_chunk(pts, xcmd_iov, &xcmd_iovcnt);
+	if (!xcmd)
+	{
+		Assert(pts->scan_done);
+		return false;
+	}
+	if (conn->num_socks > 1 && pts->chunk_optimal_gpus != 0)
+	{
+		XpuConnectionSocket *sock;
+
+		pthreadMutexLock(&conn->mutex);
+		sock = __xpuClientChooseSocketByLocality(conn, pts->chunk_optimal_gpus);
+		pthreadMutexUnlock(&conn->mutex);
+		xpuClientSendCommandIOV(conn, sock, xcmd_iov, xcmd_iovcnt);
+	}
+	else
+		xpuClientSendCommandIOV(conn, NULL, xcmd_iov, xcmd_iovcnt);
+	return true;
+}
+
+static XpuCommand *
+__fetchNextXpuCommand(pgstromTaskState *pts)
+{
+	XpuConnection  *conn = pts->conn;
+	XpuCommand	   *xcmd;
 	int				ev;
-	int				max_async_tasks = pgstrom_max_async_tasks();
+	int				window;
 
 	while (!pts->scan_done)
 	{
 		CHECK_FOR_INTERRUPTS();
 
+		/*
+		 * LIMIT without ORDER BY; we already received enough rows, so
+		 * no more chunks are sent. GPU-Service also skips the queued
+		 * chunks of this session.
+		 */
+		if (pts->pp_info->limit_nitems > 0 &&
+			pts->limit_nitems_received >= pts->pp_info->limit_nitems)
+			break;
+
 		pthreadMutexLock(&conn->mutex);
 		/* device error checks */
 		if (conn->errorbuf.errcode != ERRCODE_STROM_SUCCESS)
@@ -963,24 +1825,23 @@ __fetchNextXpuCommand(pgstromTaskState *pts)
 							 conn->errorbuf.funcname)));
 		}
 
-		if ((conn->num_running_cmds + conn->num_ready_cmds) < max_async_tasks &&
+		window = conn->inflight_window;
+		if ((conn->num_running_cmds + conn->num_ready_cmds) < window &&
 			(dlist_is_empty(&conn->ready_cmds_list) ||
-			 conn->num_running_cmds < max_async_tasks / 2))
+			 conn->num_running_cmds < window / 2))
 		{
 			/*
 			 * xPU service still has margin to enqueue new commands.
 			 * If we have no ready commands or number of running commands
-			 * are less than pg_strom.max_async_tasks/2, we try to load
+			 * are less than half of the in-flight window, we try to load
 			 * the next chunk and enqueue this command.
 			 */
+			if (conn->num_running_cmds >= pgstrom_max_async_tasks() * conn->num_socks)
+				pg_atomic_fetch_or_u32(&pts->ps_state->exec_paths,
+									   XPU_EXEC_PATH__INFLIGHT_WINDOW);
 			pthreadMutexUnlock(&conn->mutex);
-			xcmd = pts->cb_next_chunk(pts, xcmd_iov, &xcmd_iovcnt);
-			if (!xcmd)
-			{
-				Assert(pts->scan_done);
+			if (!__sendNextXpuCommand(pts))
 				break;
-			}
-			xpuClientSendCommandIOV(conn, xcmd_iov, xcmd_iovcnt);
 		}
 		else if (!dlist_is_empty(&conn->ready_cmds_list))
 		{
@@ -1004,7 +1865,7 @@ __fetchNextXpuCommand(pgstromTaskState *pts)
 						   WL_TIMEOUT |
 						   WL_POSTMASTER_DEATH,
 						   1000L,
-						   PG_WAIT_EXTENSION);
+						   __xpuTaskWaitEvent(pts));
 			if (ev & WL_POSTMASTER_DEATH)
 				ereport(FATAL,
 						(errcode(ERRCODE_ADMIN_SHUTDOWN),
@@ -1016,12 +1877,141 @@ __fetchNextXpuCommand(pgstromTaskState *pts)
 			 * Unfortunately, we touched the threshold. Take a short wait
 			 */
 			pthreadMutexUnlock(&conn->mutex);
+			pgstat_report_wait_start(__xpuTaskWaitEvent(pts));
 			pg_usleep(20000L);		/* 20ms */
+			pgstat_report_wait_end();
 		}
 	}
 	return __waitAndFetchNextXpuCommand(pts, true);
 }
 
+/*
+ * __flattenStringAggState
+ *
+ * STRING_AGG state on the kds_final chains the items allocated from the tail
+ * of the buffer. It copies the items next to the state header, so the final
+ * aggregate function can handle it without the kds_final.
+ */
+static Datum
+__flattenStringAggState(kern_data_store *kds, Datum datum)
+{
+	kagg_state__string_agg_packed *state;
+	kagg_state__string_agg_packed *flat;
+	const kagg_string_agg_item *item;
+	uint64_t	offset;
+	uint32_t	count = 0;
+	size_t		sz = KAGG_STATE__STRING_AGG_SZ;
+	char	   *pos;
+
+	state = (kagg_state__string_agg_packed *)DatumGetPointer(datum);
+	if (state->head == 0)
+		return datum;		/* already flat */
+	for (offset = state->head; offset != 0; offset = item->next)
+	{
+		if (offset > kds->length - KDS_HEAD_LENGTH(kds))
+			elog(ERROR, "string_agg state is corrupted");
+		item = (const kagg_string_agg_item *)((char *)kds + kds->length - offset);
+		sz += KAGG_STRING_AGG_ITEM_SZ(item->dlen, item->vlen);
+		count++;
+	}
+	if (count != state->nitems)
+		elog(ERROR, "string_agg state is corrupted (nitems=%u, chain=%u)",
+			 state->nitems, count);
+	if (sz >= MaxAllocSize)
+		elog(ERROR, "string_agg state is too large (%zu bytes)", sz);
+	flat = palloc(sz);
+	SET_VARSIZE(flat, sz);
+	flat->nitems = count;
+	flat->head = 0;
+	flat->tail = 0;
+	pos = flat->data;
+	for (offset = state->head; offset != 0; offset = item->next)
+	{
+		uint32_t	isz;
+
+		item = (const kagg_string_agg_item *)((char *)kds + kds->length - offset);
+		isz = KAGG_STRING_AGG_ITEM_SZ(item->dlen, item->vlen);
+		memcpy(pos, item, isz);
+		((kagg_string_agg_item *)pos)->next = 0;
+		pos += isz;
+	}
+	Assert(pos == (char *)flat + sz);
+	return PointerGetDatum(flat);
+}
+
+/*
+ * __pgstromFlattenGroupByTuple
+ */
+static TupleTableSlot *
+__pgstromFlattenGroupByTuple(pgstromTaskState *pts,
+							 kern_data_store *kds,
+							 TupleTableSlot *slot)
+{
+	TupleDesc	tupdesc = slot->tts_tupleDescriptor;
+	MemoryContext oldcxt;
+	HeapTuple	tuple;
+	Datum	   *values;
+	bool	   *isnull;
+	int			anum = -1;
+
+	MemoryContextReset(pts->groupby_accum_memcxt);
+	oldcxt = MemoryContextSwitchTo(pts->groupby_accum_memcxt);
+	values = palloc(sizeof(Datum) * tupdesc->natts);
+	isnull = palloc(sizeof(bool)  * tupdesc->natts);
+	heap_deform_tuple(&pts->curr_htup, tupdesc, values, isnull);
+	while ((anum = bms_next_member(pts->groupby_accum_attrs, anum)) >= 0)
+	{
+		Assert(anum > 0 && anum <= tupdesc->natts);
+		if (!isnull[anum-1])
+			values[anum-1] = __flattenStringAggState(kds, values[anum-1]);
+	}
+	tuple = heap_form_tuple(tupdesc, values, isnull);
+	tuple->t_self = pts->curr_htup.t_self;
+	MemoryContextSwitchTo(oldcxt);
+
+	return ExecStoreHeapTuple(tuple, slot, false);
+}
+
+/*
+ * __pgstromScanNextColumnarTuple
+ *
+ * It fetches the values from the results packed by GPU-Service; all the
+ * columns are fixed-length and by-value, so no heap-tuple is deformed.
+ */
+static TupleTableSlot *
+__pgstromScanNextColumnarTuple(kern_data_store *kds, int64_t index,
+							   TupleTableSlot *slot)
+{
+	int		natts = Min(kds->ncols, slot->tts_tupleDescriptor->natts);
+
+	ExecClearTuple(slot);
+	for (int j=0; j < natts; j++)
+	{
+		const kern_colmeta *cmeta = &kds->colmeta[j];
+		const uint32_t *nullmap = (const uint32_t *)
+			((char *)kds + __kds_unpack(cmeta->nullmap_offset));
+		const char *values = ((char *)kds + __kds_unpack(cmeta->values_offset));
+
+		if ((nullmap[index>>5] & (1U << (index & 0x1f))) == 0)
+		{
+			slot->tts_values[j] = 0;
+			slot->tts_isnull[j] = true;
+		}
+		else
+		{
+			slot->tts_values[j] = fetch_att(values + cmeta->attlen * index,
+											true, cmeta->attlen);
+			slot->tts_isnull[j] = false;
+		}
+	}
+	for (int j=natts; j < slot->tts_tupleDescriptor->natts; j++)
+	{
+		slot->tts_values[j] = 0;
+		slot->tts_isnull[j] = true;
+	}
+	return ExecStoreVirtualTuple(slot);
+}
+
 /*
  * pgstromScanNextTuple
  */
@@ -1035,6 +2025,13 @@ pgstromScanNextTuple(pgstromTaskState *pts)
 		kern_data_store *kds = pts->curr_kds;
 		int64_t		index = pts->curr_index++;
 
+		if (index < kds->nitems && kds->format == KDS_FORMAT_COLUMN)
+		{
+			if (index == 0)
+				pg_atomic_fetch_or_u32(&pts->ps_state->exec_paths,
+									   XPU_EXEC_PATH__COLUMNAR_RESULTS);
+			return __pgstromScanNextColumnarTuple(kds, index, slot);
+		}
 		if (index < kds->nitems)
 		{
 			kern_tupitem   *tupitem = KDS_GET_TUPITEM(kds, index);
@@ -1044,6 +2041,8 @@ pgstromScanNextTuple(pgstromTaskState *pts)
 				   &tupitem->htup.t_ctid,
 				   sizeof(ItemPointerData));
 			pts->curr_htup.t_data = &tupitem->htup;
+			if (pts->groupby_accum_attrs)
+				return __pgstromFlattenGroupByTuple(pts, kds, slot);
 			return ExecStoreHeapTuple(&pts->curr_htup, slot, false);
 		}
 		if (++pts->curr_chunk < pts->curr_resp->u.results.chunks_nitems)
@@ -1117,101 +2116,378 @@ pgstromExecFinalChunkDummy(pgstromTaskState *pts,
 		SetLatch(MyLatch);
 		pthreadMutexUnlock(&conn->mutex);
 	}
-	return NULL;
+	return NULL;
+}
+
+/*
+ * CPU Fallback Routines
+ */
+static void
+ExecFallbackRowDataStore(pgstromTaskState *pts,
+						 kern_data_store *kds)
+{
+	for (uint32_t i=0; i < kds->nitems; i++)
+	{
+		kern_tupitem   *tupitem = KDS_GET_TUPITEM(kds, i);
+		HeapTupleData	tuple;
+
+		tuple.t_len = tupitem->t_len;
+		ItemPointerCopy(&tupitem->htup.t_ctid, &tuple.t_self);
+		tuple.t_tableOid = kds->table_oid;
+		tuple.t_data = &tupitem->htup;
+		pts->cb_cpu_fallback(pts, &tuple);
+	}
+}
+
+static void
+ExecFallbackBlockDataStore(pgstromTaskState *pts,
+						   kern_data_store *kds)
+{
+	for (uint32_t i=0; i < kds->nitems; i++)
+	{
+		PageHeaderData *pg_page = KDS_BLOCK_PGPAGE(kds, i);
+		BlockNumber		block_nr = KDS_BLOCK_BLCKNR(kds, i);
+		uint32_t		ntuples = PageGetMaxOffsetNumber((Page)pg_page);
+
+		for (uint32_t k=0; k < ntuples; k++)
+		{
+			ItemIdData	   *lpp = &pg_page->pd_linp[k];
+			HeapTupleData	tuple;
+
+			if (ItemIdIsNormal(lpp))
+			{
+				tuple.t_len = ItemIdGetLength(lpp);
+				tuple.t_self.ip_blkid.bi_hi = (uint16_t)(block_nr >> 16);
+				tuple.t_self.ip_blkid.bi_lo = (uint16_t)(block_nr & 0xffffU);
+				tuple.t_self.ip_posid = k+1;
+				tuple.t_tableOid = kds->table_oid;
+				tuple.t_data = (HeapTupleHeader)PageGetItem((Page)pg_page, lpp);
+
+				pts->cb_cpu_fallback(pts, &tuple);
+			}
+		}
+	}
+}
+
+static void
+ExecFallbackColumnDataStore(pgstromTaskState *pts,
+							kern_data_store *kds)
+{
+	Relation		rel = pts->css.ss.ss_currentRelation;
+	EState		   *estate = pts->css.ss.ps.state;
+	TableScanDesc	scan;
+
+	scan = table_beginscan(rel, estate->es_snapshot, 0, NULL);
+	while (table_scan_getnextslot(scan, ForwardScanDirection, pts->base_slot))
+	{
+		HeapTuple	tuple;
+		bool		should_free;
+
+		if (pts->cb_cpu_fallback_slot)
+		{
+			pts->cb_cpu_fallback_slot(pts);
+			continue;
+		}
+		tuple = ExecFetchSlotHeapTuple(pts->base_slot, false, &should_free);
+		pts->cb_cpu_fallback(pts, tuple);
+		if (should_free)
+			pfree(tuple);
+	}
+	table_endscan(scan);
+}
+
+static void
+ExecFallbackArrowDataStore(pgstromTaskState *pts,
+						   kern_data_store *kds)
+{
+	pgstromPlanInfo *pp_info = pts->pp_info;
+
+	for (uint32_t index=0; index < kds->nitems; index++)
+	{
+		HeapTuple	tuple;
+		bool		should_free;
+
+		if (!kds_arrow_fetch_tuple(pts->base_slot,
+								   kds, index,
+								   pp_info->outer_refs))
+			break;
+		/* no need to form a heap tuple, then deform it again */
+		if (pts->cb_cpu_fallback_slot)
+		{
+			pts->cb_cpu_fallback_slot(pts);
+			continue;
+		}
+		tuple = ExecFetchSlotHeapTuple(pts->base_slot, false, &should_free);
+		pts->cb_cpu_fallback(pts, tuple);
+		if (should_free)
+			pfree(tuple);
+	}
+}
+
+/*
+ * ExecFallbackDataStore
+ */
+static void
+ExecFallbackDataStore(pgstromTaskState *pts, kern_data_store *kds)
+{
+	switch (kds->format)
+	{
+		case KDS_FORMAT_ROW:
+			ExecFallbackRowDataStore(pts, kds);
+			break;
+		case KDS_FORMAT_BLOCK:
+			ExecFallbackBlockDataStore(pts, kds);
+			break;
+		case KDS_FORMAT_COLUMN:
+			ExecFallbackColumnDataStore(pts, kds);
+			break;
+		case KDS_FORMAT_ARROW:
+			ExecFallbackArrowDataStore(pts, kds);
+			break;
+		default:
+			elog(ERROR, "CPU fallback received unknown KDS format (%c)",
+				 kds->format);
+			break;
+	}
+}
+
+/*
+ * Parallel CPU fallback
+ *
+ * A process that received CPU fallback chunk copies the KDS onto a DSM
+ * segment and queues it on the fallback_slots[] of the shared state, then
+ * the other processes run the CPU fallback at the next chunk boundary.
+ * The owner keeps the segment attached until someone attached it, so the
+ * segment is never destroyed prior to the consumption; each process takes
+ * its own entries back at the end of scan, and waits for the entries
+ * taken by the others.
+ * RIGHT OUTER JOIN is not a target, because the outer-join-map must be
+ * completed before the last process runs final_plan_node.
+ */
+static bool
+__pgstromOffloadFallbackChunk(pgstromTaskState *pts, XpuCommand *resp)
+{
+	pgstromSharedState *ps_state = pts->ps_state;
+	kern_data_store *kds = &resp->u.fallback.kds_src;
+	size_t		sz = resp->length - offsetof(XpuCommand, u.fallback.kds_src);
+	dsm_segment *seg;
+	int			index = -1;
+
+	if (!pgstrom_parallel_cpu_fallback ||
+		ps_state->ss_handle == DSM_HANDLE_INVALID ||
+		pts->cb_final_chunk == pgstromExecFinalChunk ||
+		(kds->format != KDS_FORMAT_ROW &&
+		 kds->format != KDS_FORMAT_BLOCK &&
+		 kds->format != KDS_FORMAT_ARROW))
+		return false;
+
+	SpinLockAcquire(&ps_state->fallback_mutex);
+	for (int i=0; i < PGSTROM_FALLBACK_NSLOTS; i++)
+	{
+		pgstromFallbackSlot *slot = &ps_state->fallback_slots[i];
+
+		if (slot->status == FALLBACK_SLOT__FREE)
+		{
+			slot->status = FALLBACK_SLOT__RESERVED;
+			slot->owner = MyProcPid;
+			index = i;
+			break;
+		}
+	}
+	SpinLockRelease(&ps_state->fallback_mutex);
+	if (index < 0)
+		return false;
+
+	seg = dsm_create(sz, DSM_CREATE_NULL_IF_MAXSEGMENTS);
+	if (seg)
+		memcpy(dsm_segment_address(seg), kds, sz);
+
+	SpinLockAcquire(&ps_state->fallback_mutex);
+	if (seg)
+	{
+		ps_state->fallback_slots[index].handle = dsm_segment_handle(seg);
+		ps_state->fallback_slots[index].status = FALLBACK_SLOT__QUEUED;
+		pg_atomic_fetch_add_u32(&ps_state->fallback_nqueued, 1);
+		pg_atomic_fetch_or_u32(&ps_state->exec_paths,
+							   XPU_EXEC_PATH__PARALLEL_FALLBACK);
+	}
+	else
+	{
+		ps_state->fallback_slots[index].status = FALLBACK_SLOT__FREE;
+		ps_state->fallback_slots[index].owner = 0;
+	}
+	SpinLockRelease(&ps_state->fallback_mutex);
+	pts->fallback_dsm_segs[index] = seg;
+
+	return (seg != NULL);
+}
+
+/*
+ * __pgstromTakeFallbackChunk
+ *
+ * It runs a CPU fallback chunk queued by the other process (or by itself,
+ * if 'take_own_chunks').
+ */
+static bool
+__pgstromTakeFallbackChunk(pgstromTaskState *pts, bool take_own_chunks)
+{
+	pgstromSharedState *ps_state = pts->ps_state;
+	pgstromFallbackSlot *slot = NULL;
+	dsm_handle	handle = DSM_HANDLE_INVALID;
+	dsm_segment *seg;
+	bool		is_own = false;
+	int			index;
+
+	if (ps_state->ss_handle == DSM_HANDLE_INVALID ||
+		pg_atomic_read_u32(&ps_state->fallback_nqueued) == 0)
+		return false;
+
+	SpinLockAcquire(&ps_state->fallback_mutex);
+	for (index=0; index < PGSTROM_FALLBACK_NSLOTS; index++)
+	{
+		pgstromFallbackSlot *curr = &ps_state->fallback_slots[index];
+
+		if (curr->status == FALLBACK_SLOT__QUEUED &&
+			(take_own_chunks || curr->owner != MyProcPid))
+		{
+			curr->status = FALLBACK_SLOT__TAKEN;
+			pg_atomic_fetch_sub_u32(&ps_state->fallback_nqueued, 1);
+			handle = curr->handle;
+			is_own = (curr->owner == MyProcPid);
+			slot = curr;
+			break;
+		}
+	}
+	SpinLockRelease(&ps_state->fallback_mutex);
+	if (!slot)
+		return false;
+
+	if (is_own)
+	{
+		/* own chunk; no need to attach the segment again */
+		seg = pts->fallback_dsm_segs[index];
+		ExecFallbackDataStore(pts, dsm_segment_address(seg));
+		SpinLockAcquire(&ps_state->fallback_mutex);
+		slot->status = FALLBACK_SLOT__FREE;
+		slot->owner = 0;
+		SpinLockRelease(&ps_state->fallback_mutex);
+		pts->fallback_dsm_segs[index] = NULL;
+		dsm_detach(seg);
+		return true;
+	}
+	/* NULL, only if the owner already gave up the scan */
+	seg = dsm_attach(handle);
+
+	SpinLockAcquire(&ps_state->fallback_mutex);
+	Assert(slot->status == FALLBACK_SLOT__TAKEN && slot->handle == handle);
+	if (slot->owner != 0)
+		slot->status = FALLBACK_SLOT__ATTACHED;
+	else
+		slot->status = FALLBACK_SLOT__FREE;
+	SpinLockRelease(&ps_state->fallback_mutex);
+	ConditionVariableBroadcast(&ps_state->fallback_cond);
+
+	if (seg)
+	{
+		ExecFallbackDataStore(pts, dsm_segment_address(seg));
+		dsm_detach(seg);
+	}
+	return true;
 }
 
 /*
- * CPU Fallback Routines
+ * __pgstromReleaseFallbackSlots
+ *
+ * It detaches the segments already attached by the others.
  */
 static void
-ExecFallbackRowDataStore(pgstromTaskState *pts,
-						 kern_data_store *kds)
+__pgstromReleaseFallbackSlots(pgstromTaskState *pts, bool wait_for_others)
 {
-	for (uint32_t i=0; i < kds->nitems; i++)
-	{
-		kern_tupitem   *tupitem = KDS_GET_TUPITEM(kds, i);
-		HeapTupleData	tuple;
-
-		tuple.t_len = tupitem->t_len;
-		ItemPointerCopy(&tupitem->htup.t_ctid, &tuple.t_self);
-		tuple.t_tableOid = kds->table_oid;
-		tuple.t_data = &tupitem->htup;
-		pts->cb_cpu_fallback(pts, &tuple);
-	}
-}
+	pgstromSharedState *ps_state = pts->ps_state;
 
-static void
-ExecFallbackBlockDataStore(pgstromTaskState *pts,
-						   kern_data_store *kds)
-{
-	for (uint32_t i=0; i < kds->nitems; i++)
+	for (int i=0; i < PGSTROM_FALLBACK_NSLOTS; i++)
 	{
-		PageHeaderData *pg_page = KDS_BLOCK_PGPAGE(kds, i);
-		BlockNumber		block_nr = KDS_BLOCK_BLCKNR(kds, i);
-		uint32_t		ntuples = PageGetMaxOffsetNumber((Page)pg_page);
+		pgstromFallbackSlot *slot = &ps_state->fallback_slots[i];
+		dsm_segment *seg = pts->fallback_dsm_segs[i];
+		bool		done = false;
 
-		for (uint32_t k=0; k < ntuples; k++)
+		if (!seg)
+			continue;
+		for (;;)
 		{
-			ItemIdData	   *lpp = &pg_page->pd_linp[k];
-			HeapTupleData	tuple;
-
-			if (ItemIdIsNormal(lpp))
+			SpinLockAcquire(&ps_state->fallback_mutex);
+			Assert(slot->owner == MyProcPid);
+			if (slot->status == FALLBACK_SLOT__ATTACHED)
 			{
-				tuple.t_len = ItemIdGetLength(lpp);
-				tuple.t_self.ip_blkid.bi_hi = (uint16_t)(block_nr >> 16);
-				tuple.t_self.ip_blkid.bi_lo = (uint16_t)(block_nr & 0xffffU);
-				tuple.t_self.ip_posid = k+1;
-				tuple.t_tableOid = kds->table_oid;
-				tuple.t_data = (HeapTupleHeader)PageGetItem((Page)pg_page, lpp);
-
-				pts->cb_cpu_fallback(pts, &tuple);
+				slot->status = FALLBACK_SLOT__FREE;
+				slot->owner = 0;
+				done = true;
 			}
+			SpinLockRelease(&ps_state->fallback_mutex);
+			if (done || !wait_for_others)
+				break;
+			ConditionVariableSleep(&ps_state->fallback_cond,
+								   PG_WAIT_EXTENSION);
+		}
+		if (done)
+		{
+			pts->fallback_dsm_segs[i] = NULL;
+			dsm_detach(seg);
 		}
 	}
+	if (wait_for_others)
+		ConditionVariableCancelSleep();
 }
 
+/*
+ * __pgstromFinishFallbackSlots
+ *
+ * It runs all the remaining CPU fallback chunks at the end of scan.
+ */
 static void
-ExecFallbackColumnDataStore(pgstromTaskState *pts,
-							kern_data_store *kds)
+__pgstromFinishFallbackSlots(pgstromTaskState *pts)
 {
-	Relation		rel = pts->css.ss.ss_currentRelation;
-	EState		   *estate = pts->css.ss.ps.state;
-	TableScanDesc	scan;
-
-	scan = table_beginscan(rel, estate->es_snapshot, 0, NULL);
-	while (table_scan_getnextslot(scan, ForwardScanDirection, pts->base_slot))
-	{
-		HeapTuple	tuple;
-		bool		should_free;
-
-		tuple = ExecFetchSlotHeapTuple(pts->base_slot, false, &should_free);
-		pts->cb_cpu_fallback(pts, tuple);
-		if (should_free)
-			pfree(tuple);
-	}
-	table_endscan(scan);
+	if (pts->ps_state->ss_handle == DSM_HANDLE_INVALID)
+		return;
+	while (__pgstromTakeFallbackChunk(pts, true))
+		CHECK_FOR_INTERRUPTS();
+	__pgstromReleaseFallbackSlots(pts, true);
 }
 
+/*
+ * __pgstromCancelFallbackSlots
+ *
+ * It gives up the entries not consumed yet; only when the scan is
+ * terminated prior to the end.
+ */
 static void
-ExecFallbackArrowDataStore(pgstromTaskState *pts,
-						   kern_data_store *kds)
+__pgstromCancelFallbackSlots(pgstromTaskState *pts)
 {
-	pgstromPlanInfo *pp_info = pts->pp_info;
+	pgstromSharedState *ps_state = pts->ps_state;
 
-	for (uint32_t index=0; index < kds->nitems; index++)
+	for (int i=0; i < PGSTROM_FALLBACK_NSLOTS; i++)
 	{
-		HeapTuple	tuple;
-		bool		should_free;
-
-		if (!kds_arrow_fetch_tuple(pts->base_slot,
-								   kds, index,
-								   pp_info->outer_refs))
-			break;
+		pgstromFallbackSlot *slot = &ps_state->fallback_slots[i];
+		dsm_segment *seg = pts->fallback_dsm_segs[i];
 
-		tuple = ExecFetchSlotHeapTuple(pts->base_slot, false, &should_free);
-		pts->cb_cpu_fallback(pts, tuple);
-		if (should_free)
-			pfree(tuple);
+		if (!seg)
+			continue;
+		SpinLockAcquire(&ps_state->fallback_mutex);
+		if (slot->status == FALLBACK_SLOT__TAKEN)
+		{
+			/* consumer shall release the slot */
+			slot->owner = 0;
+		}
+		else
+		{
+			if (slot->status == FALLBACK_SLOT__QUEUED)
+				pg_atomic_fetch_sub_u32(&ps_state->fallback_nqueued, 1);
+			slot->status = FALLBACK_SLOT__FREE;
+			slot->owner = 0;
+		}
+		SpinLockRelease(&ps_state->fallback_mutex);
+		pts->fallback_dsm_segs[i] = NULL;
+		dsm_detach(seg);
 	}
 }
 
@@ -1232,7 +2508,7 @@ __setupTaskStateRequestBuffer(pgstromTaskState *pts,
 	initStringInfo(&pts->xcmd_buf);
 	bufsz = MAXALIGN(offsetof(XpuCommand, u.task.data));
 	if (pts->gcache_desc)
-		bufsz += MAXALIGN(sizeof(GpuCacheIdent));
+		bufsz += MAXALIGN(sizeof(GpuCacheScanArgs));
 	if (tdesc_src)
 		bufsz += estimate_kern_data_store(tdesc_src);
 	if (tdesc_dst)
@@ -1245,9 +2521,11 @@ __setupTaskStateRequestBuffer(pgstromTaskState *pts,
 	if (pts->gcache_desc)
 	{
 		const GpuCacheIdent *ident = getGpuCacheDescIdent(pts->gcache_desc);
+		GpuCacheScanArgs *gc_args = (GpuCacheScanArgs *)((char *)xcmd + off);
 
-		memcpy((char *)xcmd + off, ident, sizeof(GpuCacheIdent));
-		off += MAXALIGN(sizeof(GpuCacheIdent));
+		memcpy(&gc_args->ident, ident, sizeof(GpuCacheIdent));
+		gc_args->merge_pos = 0;
+		off += MAXALIGN(sizeof(GpuCacheScanArgs));
 	}
 	if (tdesc_dst)
 	{
@@ -1417,6 +2695,9 @@ __execInitTaskStateCpuFallback(pgstromTaskState *pts)
 		last_depth = vl_map[i].src_depth;
 		src_list = lappend_int(src_list, vl_map[i].src_resno);
 		dst_list = lappend_int(dst_list, vl_map[i].dst_resno);
+		if (last_depth == 0)
+			pts->fallback_load_natts = Max(pts->fallback_load_natts,
+										   vl_map[i].src_resno);
 	}
 	Assert(src_list == NIL && dst_list == NIL);
 }
@@ -1467,6 +2748,8 @@ pgstromExecInitTaskState(CustomScanState *node, EState *estate, int eflags)
 	Assert(rel != NULL &&
 		   outerPlanState(node) == NULL &&
 		   innerPlanState(node) == NULL &&
+		   (outerPlan(cscan) == NULL ||
+			(pts->xpu_task_flags & DEVKIND__NVIDIA_GPU) != 0) &&
 		   pp_info->num_rels == list_length(cscan->custom_plans) &&
 		   pts->num_rels == list_length(cscan->custom_plans));
 	/*
@@ -1491,9 +2774,20 @@ pgstromExecInitTaskState(CustomScanState *node, EState *estate, int eflags)
 		pgstromBrinIndexExecBegin(pts,
 								  pp_info->brin_index_oid,
 								  pp_info->brin_index_conds,
-								  pp_info->brin_index_quals);
+								  pp_info->brin_index_quals,
+								  pp_info->brin_subindex_oids,
+								  pp_info->brin_subindex_conds);
+		/* setup zone-map, if no BRIN-index */
+		if (!pts->br_state && pp_info->gpu_cache_dindex < 0)
+			pgstromZoneMapExecBegin(pts, pp_info->scan_quals);
 		if ((pts->xpu_task_flags & DEVKIND__NVIDIA_GPU) != 0)
-			pts->optimal_gpus = GetOptimalGpuForRelation(rel);
+		{
+			/* GpuCache scan is distributed to the GPUs with replica */
+			if (pts->gcache_desc)
+				pts->optimal_gpus = pgstromGpuCacheOptimalGpus(pts->gcache_desc);
+			else
+				pts->optimal_gpus = GetOptimalGpuForRelation(rel);
+		}
 		if ((pts->xpu_task_flags & DEVKIND__NVIDIA_DPU) != 0)
 			pts->ds_entry = GetOptimalDpuForRelation(rel, &kds_pathname);
 		pts->kds_pathname = kds_pathname;
@@ -1543,6 +2837,22 @@ pgstromExecInitTaskState(CustomScanState *node, EState *estate, int eflags)
 
 		istate->ps = ExecInitNode(plan, estate, eflags);
 		istate->econtext = CreateExprContext(estate);
+		if (istate->ps->ps_ResultTupleDesc)
+		{
+			TupleDesc	tupdesc = istate->ps->ps_ResultTupleDesc;
+
+			for (int j=0; j < tupdesc->natts; j++)
+			{
+				Form_pg_attribute attr = TupleDescAttr(tupdesc, j);
+				devtype_info *dtype;
+
+				if (attr->attisdropped)
+					continue;
+				dtype = pgstrom_devtype_lookup(attr->atttypid);
+				if (dtype && dtype->type_code == TypeOpCode__geometry)
+					istate->geom_anums = lappend_int(istate->geom_anums, j+1);
+			}
+		}
 		istate->depth = depth_index + 1;
 		istate->join_type = pp_inner->join_type;
 		istate->join_quals = ExecInitQual(pp_inner->join_quals,
@@ -1585,6 +2895,15 @@ pgstromExecInitTaskState(CustomScanState *node, EState *estate, int eflags)
 											   dtype->type_hashfunc);
 		}
 
+		/* inner range-key also references the result of inner-slot */
+		if (pp_inner->range_inner_key)
+		{
+			istate->range_inner_key = ExecInitExpr(pp_inner->range_inner_key,
+												   &pts->css.ss.ps);
+			istate->range_strategy = pp_inner->range_strategy;
+			istate->range_grid_distance = pp_inner->range_grid_distance;
+		}
+
 		if (OidIsValid(pp_inner->gist_index_oid))
 		{
 			istate->gist_irel = index_open(pp_inner->gist_index_oid,
@@ -1597,7 +2916,31 @@ pgstromExecInitTaskState(CustomScanState *node, EState *estate, int eflags)
 		depth_index++;
 	}
 	Assert(depth_index == pts->num_rels);
-	
+
+	/*
+	 * Partition-wise JOIN with the identical inner relations; the first
+	 * sibling preloads the inner buffer, then the others share it.
+	 * Outer-join map is per partition leaf, so RIGHT/FULL JOIN is not.
+	 */
+	if (pp_info->sibling_param_id >= 0 &&
+		pts->num_rels > 0 && !has_right_outer)
+	{
+		ParamExecData  *prm = &estate->es_param_exec_vals[pp_info->sibling_param_id];
+		pgstromTaskState *leader = (pgstromTaskState *)DatumGetPointer(prm->value);
+
+		if (!leader)
+			prm->value = PointerGetDatum(pts);
+		else if (leader->num_rels == pts->num_rels &&
+				 leader->ds_entry == pts->ds_entry &&
+				 (leader->xpu_task_flags & DEVKIND__ANY) ==
+				 (pts->xpu_task_flags & DEVKIND__ANY))
+			pts->sibling_leader = leader;
+	}
+
+	/* DPU pre-filtering of the outer relation, if any */
+	if (outerPlan(cscan))
+		outerPlanState(node) = ExecInitNode(outerPlan(cscan), estate, eflags);
+
 	/*
 	 * Setup request buffer
 	 */
@@ -1619,8 +2962,18 @@ pgstromExecInitTaskState(CustomScanState *node, EState *estate, int eflags)
 									  tupdesc_dst,
 									  KDS_FORMAT_COLUMN);
 	}
+	else if (outerPlanState(node))	/* DPU pre-filtering */
+	{
+		pts->cb_next_chunk = pgstromRelScanChunkPrefilter;
+		pts->cb_next_tuple = pgstromScanNextTuple;
+		__setupTaskStateRequestBuffer(pts,
+									  tupdesc_src,
+									  tupdesc_dst,
+									  KDS_FORMAT_ROW);
+	}
 	else if (!bms_is_empty(pts->optimal_gpus) ||	/* GPU-Direct SQL */
-			 pts->ds_entry)							/* DPU Storage */
+			 pts->ds_entry ||						/* DPU Storage */
+			 pgstrom_relscan_block_format)			/* pages via shared-buffer */
 	{
 		pts->cb_next_chunk = pgstromRelScanChunkDirect;
 		pts->cb_next_tuple = pgstromScanNextTuple;
@@ -1645,6 +2998,7 @@ pgstromExecInitTaskState(CustomScanState *node, EState *estate, int eflags)
 	if ((pts->xpu_task_flags & DEVTASK__SCAN) != 0)
 	{
 		pts->cb_cpu_fallback = ExecFallbackCpuScan;
+		pts->cb_cpu_fallback_slot = ExecFallbackCpuScanSlot;
 	}
 	else if ((pts->xpu_task_flags & DEVTASK__JOIN) != 0)
 	{
@@ -1653,6 +3007,7 @@ pgstromExecInitTaskState(CustomScanState *node, EState *estate, int eflags)
 		else
 			pts->cb_final_chunk = pgstromExecFinalChunkDummy;
 		pts->cb_cpu_fallback = ExecFallbackCpuJoin;
+		pts->cb_cpu_fallback_slot = ExecFallbackCpuJoinSlot;
 	}
 	else if ((pts->xpu_task_flags & DEVTASK__PREAGG) != 0)
 	{
@@ -1663,6 +3018,7 @@ pgstromExecInitTaskState(CustomScanState *node, EState *estate, int eflags)
 		elog(ERROR, "Bug? unknown DEVTASK");
 	/* other fields init */
 	pts->curr_vm_buffer = InvalidBuffer;
+	pts->segment_optimal_id = InvalidBlockNumber;
 }
 
 /*
@@ -1682,10 +3038,20 @@ pgstromExecScanAccess(pgstromTaskState *pts)
 	{
 	next_chunks:
 		if (pts->curr_resp)
+		{
 			xpuClientPutResponse(pts->curr_resp);
+			pts->curr_resp = NULL;
+		}
+		/* CPU fallback offloaded by the other processes, if any */
+		if (__pgstromTakeFallbackChunk(pts, false) &&
+			(slot = pgstromFetchFallbackTuple(pts)) != NULL)
+			return slot;
 		pts->curr_resp = __fetchNextXpuCommand(pts);
 		if (!pts->curr_resp)
+		{
+			__pgstromFinishFallbackSlots(pts);
 			return pgstromFetchFallbackTuple(pts);
+		}
 		resp = pts->curr_resp;
 		switch (resp->tag)
 		{
@@ -1696,12 +3062,283 @@ pgstromExecScanAccess(pgstromTaskState *pts)
 					ExecFallbackCpuJoinRightOuter(pts);
 				if (resp->u.results.chunks_nitems == 0)
 					goto next_chunks;
-				pts->curr_kds = (kern_data_store *)
-					((char *)resp + resp->u.results.chunks_offset);
+				pts->curr_kds = xpuClientFirstResultChunk(resp);
+				pts->curr_chunk = 0;
+				pts->curr_index = 0;
+				break;
+
+			case XpuCommandTag__SuccessPartial:
+				/* results streamed prior to the completion of the task */
+				if (resp->u.results.chunks_nitems == 0)
+					goto next_chunks;
+				pts->curr_kds = xpuClientFirstResultChunk(resp);
 				pts->curr_chunk = 0;
 				pts->curr_index = 0;
 				break;
 
+			case XpuCommandTag__CPUFallback:
+				/* CPU fallback would emit the same groups twice */
+				if (pts->pp_info->groupby_final_mode)
+					elog(ERROR, "(%s:%d) GpuPreAgg with final aggregation cannot run CPU fallback due to %s [%s]",
+						 resp->u.fallback.error.filename,
+						 resp->u.fallback.error.lineno,
+						 resp->u.fallback.error.message,
+						 resp->u.fallback.error.funcname);
+				elog(pgstrom_cpu_fallback_elevel,
+					 "(%s:%d) CPU fallback due to %s [%s]",
+					 resp->u.fallback.error.filename,
+					 resp->u.fallback.error.lineno,
+					 resp->u.fallback.error.message,
+					 resp->u.fallback.error.funcname);
+				if (!__pgstromOffloadFallbackChunk(pts, resp))
+					ExecFallbackDataStore(pts, &resp->u.fallback.kds_src);
+				goto next_chunks;
+
+			default:
+				elog(ERROR, "unknown response tag: %u", resp->tag);
+				break;
+		}
+	}
+	slot_getallattrs(slot);
+	return slot;
+}
+
+/*
+ * GPU Sort - merge of the sorted chunks
+ *
+ * GPU-Service sorts each destination chunk by the leading sort key (and
+ * the second key, if any), then the backend keeps the chunks as sorted runs
+ * on the logical tapes, and merges them using the binary-heap. The tuples
+ * by CPU fallback are sorted by tuplesort, then merged as an additional run.
+ */
+typedef struct
+{
+	LogicalTape	   *tape;		/* NULL, if CPU fallback run */
+	int64_t			nitems;		/* remaining tuples on the tape */
+	HeapTupleData	htup;
+	char		   *buffer;
+	size_t			bufsz;
+	TupleTableSlot *slot;
+	Datum			value;
+	bool			isnull;
+	Datum			value2;
+	bool			isnull2;
+} pgstromGpuSortRun;
+
+struct pgstromGpuSortState
+{
+	MemoryContext	memcxt;
+	LogicalTapeSet *lts;
+	Tuplesortstate *fallback_sort;
+	AttrNumber		attnum;
+	SortSupportData	ssup;
+	AttrNumber		attnum2;	/* 0, if no second key */
+	SortSupportData	ssup2;
+	int				nruns;
+	int				nrooms;
+	pgstromGpuSortRun *runs;
+	binaryheap	   *heap;
+};
+typedef struct pgstromGpuSortState	pgstromGpuSortState;
+
+static pgstromGpuSortRun *
+__gpusortAllocRun(pgstromGpuSortState *gs)
+{
+	pgstromGpuSortRun *run;
+
+	if (gs->nruns >= gs->nrooms)
+	{
+		gs->nrooms = 2 * gs->nrooms + 20;
+		if (!gs->runs)
+			gs->runs = MemoryContextAlloc(gs->memcxt,
+										  sizeof(pgstromGpuSortRun) * gs->nrooms);
+		else
+			gs->runs = repalloc(gs->runs,
+								sizeof(pgstromGpuSortRun) * gs->nrooms);
+	}
+	run = &gs->runs[gs->nruns++];
+	memset(run, 0, sizeof(pgstromGpuSortRun));
+	return run;
+}
+
+static void
+__gpusortWriteChunkRun(pgstromGpuSortState *gs, kern_data_store *kds)
+{
+	pgstromGpuSortRun *run;
+	MemoryContext	oldcxt;
+
+	if (kds->nitems == 0)
+		return;
+	oldcxt = MemoryContextSwitchTo(gs->memcxt);
+	run = __gpusortAllocRun(gs);
+	run->tape = LogicalTapeCreate(gs->lts);
+	for (uint32_t i=0; i < kds->nitems; i++)
+	{
+		kern_tupitem   *tupitem = KDS_GET_TUPITEM(kds, i);
+
+		LogicalTapeWrite(run->tape, &tupitem->t_len, sizeof(uint32_t));
+		LogicalTapeWrite(run->tape, &tupitem->htup, tupitem->t_len);
+	}
+	run->nitems = kds->nitems;
+	MemoryContextSwitchTo(oldcxt);
+}
+
+static bool
+__gpusortFetchRun(pgstromGpuSortState *gs, pgstromGpuSortRun *run)
+{
+	if (!run->tape)
+	{
+		if (!tuplesort_gettupleslot(gs->fallback_sort, true, false,
+									run->slot, NULL))
+			return false;
+	}
+	else
+	{
+		uint32_t	t_len;
+
+		if (run->nitems == 0)
+			return false;
+		if (LogicalTapeRead(run->tape, &t_len,
+							sizeof(uint32_t)) != sizeof(uint32_t))
+			elog(ERROR, "unexpected end of GPU Sort run");
+		if (t_len > run->bufsz)
+		{
+			run->bufsz = MAXALIGN(t_len) + 512;
+			if (!run->buffer)
+				run->buffer = MemoryContextAlloc(gs->memcxt, run->bufsz);
+			else
+				run->buffer = repalloc(run->buffer, run->bufsz);
+		}
+		if (LogicalTapeRead(run->tape, run->buffer, t_len) != t_len)
+			elog(ERROR, "unexpected end of GPU Sort run");
+		run->htup.t_len = t_len;
+		run->htup.t_data = (HeapTupleHeader)run->buffer;
+		ItemPointerCopy(&run->htup.t_data->t_ctid, &run->htup.t_self);
+		run->htup.t_tableOid = InvalidOid;
+		ExecStoreHeapTuple(&run->htup, run->slot, false);
+		run->nitems--;
+	}
+	run->value = slot_getattr(run->slot, gs->attnum, &run->isnull);
+	if (gs->attnum2 > 0)
+		run->value2 = slot_getattr(run->slot, gs->attnum2, &run->isnull2);
+	return true;
+}
+
+static int
+__gpusortHeapCompare(Datum a, Datum b, void *arg)
+{
+	pgstromGpuSortState *gs = arg;
+	pgstromGpuSortRun *ra = &gs->runs[DatumGetInt32(a)];
+	pgstromGpuSortRun *rb = &gs->runs[DatumGetInt32(b)];
+	int			comp;
+
+	/* binaryheap keeps the largest one on the top */
+	comp = ApplySortComparator(ra->value, ra->isnull,
+							   rb->value, rb->isnull,
+							   &gs->ssup);
+	if (comp == 0 && gs->attnum2 > 0)
+		comp = ApplySortComparator(ra->value2, ra->isnull2,
+								   rb->value2, rb->isnull2,
+								   &gs->ssup2);
+	return -comp;
+}
+
+static void
+__gpusortPutFallbackTuples(pgstromTaskState *pts)
+{
+	pgstromGpuSortState *gs = pts->gpusort_state;
+	TupleTableSlot *slot;
+
+	while ((slot = pgstromFetchFallbackTuple(pts)) != NULL)
+		tuplesort_puttupleslot(gs->fallback_sort, slot);
+}
+
+static void
+__pgstromGpuSortLoadRuns(pgstromTaskState *pts)
+{
+	pgstromPlanInfo *pp_info = pts->pp_info;
+	EState	   *estate = pts->css.ss.ps.state;
+	TupleDesc	tupdesc = pts->css.ss.ss_ScanTupleSlot->tts_tupleDescriptor;
+	pgstromGpuSortState *gs;
+	MemoryContext memcxt;
+	MemoryContext oldcxt;
+	XpuCommand *resp;
+	AttrNumber	attnums[2];
+	Oid			sortops[2];
+	Oid			collids[2];
+	bool		nulls_first[2];
+	int			nkeys = 1;
+
+	attnums[0] = pp_info->sortkey_resno;
+	sortops[0] = pp_info->gpusort_sortop;
+	collids[0] = pp_info->gpusort_collid;
+	nulls_first[0] = ((pp_info->sortkey_flags & KERN_SORTKEY__NULLS_FIRST) != 0);
+	if (pp_info->sortkey2_resno > 0)
+	{
+		attnums[1] = pp_info->sortkey2_resno;
+		sortops[1] = pp_info->gpusort_sortop2;
+		collids[1] = pp_info->gpusort_collid2;
+		nulls_first[1] = ((pp_info->sortkey2_flags & KERN_SORTKEY__NULLS_FIRST) != 0);
+		nkeys = 2;
+	}
+
+	memcxt = AllocSetContextCreate(estate->es_query_cxt,
+								   "GPU Sort",
+								   ALLOCSET_DEFAULT_SIZES);
+	oldcxt = MemoryContextSwitchTo(memcxt);
+	gs = palloc0(sizeof(pgstromGpuSortState));
+	gs->memcxt = memcxt;
+	gs->lts = LogicalTapeSetCreate(false, NULL, -1);
+	gs->attnum = attnums[0];
+	gs->ssup.ssup_cxt = memcxt;
+	gs->ssup.ssup_collation = collids[0];
+	gs->ssup.ssup_nulls_first = nulls_first[0];
+	gs->ssup.ssup_attno = gs->attnum;
+	PrepareSortSupportFromOrderingOp(sortops[0], &gs->ssup);
+	if (nkeys > 1)
+	{
+		gs->attnum2 = attnums[1];
+		gs->ssup2.ssup_cxt = memcxt;
+		gs->ssup2.ssup_collation = collids[1];
+		gs->ssup2.ssup_nulls_first = nulls_first[1];
+		gs->ssup2.ssup_attno = gs->attnum2;
+		PrepareSortSupportFromOrderingOp(sortops[1], &gs->ssup2);
+	}
+	gs->fallback_sort = tuplesort_begin_heap(tupdesc, nkeys,
+											 attnums,
+											 sortops,
+											 collids,
+											 nulls_first,
+											 work_mem,
+											 NULL,
+											 TUPLESORT_NONE);
+	MemoryContextSwitchTo(oldcxt);
+	pts->gpusort_state = gs;
+
+	for (;;)
+	{
+		/* CPU fallback offloaded by the other processes, if any */
+		if (__pgstromTakeFallbackChunk(pts, false))
+			__gpusortPutFallbackTuples(pts);
+		resp = __fetchNextXpuCommand(pts);
+		if (!resp)
+			break;
+		switch (resp->tag)
+		{
+			case XpuCommandTag__Success:
+			case XpuCommandTag__SuccessPartial:
+				if (resp->u.results.chunks_nitems > 0)
+				{
+					kern_data_store *kds = xpuClientFirstResultChunk(resp);
+
+					for (int i=0; i < resp->u.results.chunks_nitems; i++)
+					{
+						__gpusortWriteChunkRun(gs, kds);
+						kds = (kern_data_store *)((char *)kds + kds->length);
+					}
+				}
+				break;
+
 			case XpuCommandTag__CPUFallback:
 				elog(pgstrom_cpu_fallback_elevel,
 					 "(%s:%d) CPU fallback due to %s [%s]",
@@ -1709,34 +3346,99 @@ pgstromExecScanAccess(pgstromTaskState *pts)
 					 resp->u.fallback.error.lineno,
 					 resp->u.fallback.error.message,
 					 resp->u.fallback.error.funcname);
-				switch (resp->u.fallback.kds_src.format)
+				if (!__pgstromOffloadFallbackChunk(pts, resp))
 				{
-					case KDS_FORMAT_ROW:
-						ExecFallbackRowDataStore(pts, &resp->u.fallback.kds_src);
-						break;
-					case KDS_FORMAT_BLOCK:
-						ExecFallbackBlockDataStore(pts, &resp->u.fallback.kds_src);
-						break;
-					case KDS_FORMAT_COLUMN:
-						ExecFallbackColumnDataStore(pts, &resp->u.fallback.kds_src);
-						break;
-					case KDS_FORMAT_ARROW:
-						ExecFallbackArrowDataStore(pts, &resp->u.fallback.kds_src);
-						break;
-					default:
-						elog(ERROR, "CPU fallback received unknown KDS format (%c)",
-							 resp->u.fallback.kds_src.format);
-						break;
+					ExecFallbackDataStore(pts, &resp->u.fallback.kds_src);
+					__gpusortPutFallbackTuples(pts);
 				}
-				goto next_chunks;
+				break;
 
 			default:
 				elog(ERROR, "unknown response tag: %u", resp->tag);
 				break;
 		}
+		xpuClientPutResponse(resp);
+	}
+	__pgstromFinishFallbackSlots(pts);
+	__gpusortPutFallbackTuples(pts);
+	tuplesort_performsort(gs->fallback_sort);
+
+	/* setup the binary-heap to merge the runs */
+	oldcxt = MemoryContextSwitchTo(memcxt);
+	__gpusortAllocRun(gs);		/* CPU fallback run */
+	gs->heap = binaryheap_allocate(gs->nruns,
+								   __gpusortHeapCompare,
+								   gs);
+	for (int k=0; k < gs->nruns; k++)
+	{
+		pgstromGpuSortRun *run = &gs->runs[k];
+
+		if (run->tape)
+		{
+			run->slot = MakeSingleTupleTableSlot(tupdesc, &TTSOpsHeapTuple);
+			LogicalTapeRewindForRead(run->tape, BLCKSZ);
+		}
+		else
+			run->slot = MakeSingleTupleTableSlot(tupdesc, &TTSOpsMinimalTuple);
+		if (__gpusortFetchRun(gs, run))
+			binaryheap_add_unordered(gs->heap, Int32GetDatum(k));
+	}
+	binaryheap_build(gs->heap);
+	MemoryContextSwitchTo(oldcxt);
+}
+
+/*
+ * pgstromExecGpuSortAccess
+ */
+static TupleTableSlot *
+pgstromExecGpuSortAccess(pgstromTaskState *pts)
+{
+	TupleTableSlot *slot = pts->css.ss.ss_ScanTupleSlot;
+	pgstromGpuSortState *gs;
+	pgstromGpuSortRun *run;
+	MemoryContext oldcxt;
+	int			k;
+
+	if (!pts->gpusort_state)
+		__pgstromGpuSortLoadRuns(pts);
+	gs = pts->gpusort_state;
+	if (binaryheap_empty(gs->heap))
+		return NULL;
+	k = DatumGetInt32(binaryheap_first(gs->heap));
+	run = &gs->runs[k];
+	ExecCopySlot(slot, run->slot);
+
+	oldcxt = MemoryContextSwitchTo(gs->memcxt);
+	if (__gpusortFetchRun(gs, run))
+		binaryheap_replace_first(gs->heap, Int32GetDatum(k));
+	else
+		binaryheap_remove_first(gs->heap);
+	MemoryContextSwitchTo(oldcxt);
+
+	slot_getallattrs(slot);
+	return slot;
+}
+
+/*
+ * pgstromGpuSortEnd
+ */
+static void
+pgstromGpuSortEnd(pgstromTaskState *pts)
+{
+	pgstromGpuSortState *gs = pts->gpusort_state;
+
+	if (!gs)
+		return;
+	for (int k=0; k < gs->nruns; k++)
+	{
+		if (gs->runs[k].slot)
+			ExecDropSingleTupleTableSlot(gs->runs[k].slot);
 	}
-	slot_getallattrs(slot);
-	return slot;
+	if (gs->fallback_sort)
+		tuplesort_end(gs->fallback_sort);
+	LogicalTapeSetClose(gs->lts);
+	MemoryContextDelete(gs->memcxt);
+	pts->gpusort_state = NULL;
 }
 
 /*
@@ -1866,6 +3568,19 @@ __pgstromExecTaskOpenConnection(pgstromTaskState *pts)
 		}
 		Assert(nvalids <= tupdesc_kds_final->natts);
 		tupdesc_kds_final->natts = nvalids;
+
+		/* STRING_AGG states must be flattened on fetch from kds_final */
+		foreach (lc, pts->pp_info->groupby_actions)
+		{
+			if (lfirst_int(lc) == KAGG_ACTION__STRING_AGG)
+				pts->groupby_accum_attrs = bms_add_member(pts->groupby_accum_attrs,
+														  foreach_current_index(lc) + 1);
+		}
+		if (pts->groupby_accum_attrs)
+			pts->groupby_accum_memcxt =
+				AllocSetContextCreate(pts->css.ss.ps.state->es_query_cxt,
+									  "GpuPreAgg string_agg",
+									  ALLOCSET_DEFAULT_SIZES);
 	}
 	/* build the session information */
 	session = pgstromBuildSessionInfo(pts, inner_handle, tupdesc_kds_final);
@@ -1890,6 +3605,83 @@ __pgstromExecTaskOpenConnection(pgstromTaskState *pts)
 	return true;
 }
 
+/*
+ * __pgstromExecTaskNextInnerPartition
+ *
+ * Grace hash-join runs the scan of the outer relation for each partition
+ * of the inner hash table. Once a pass finished, it loads the next
+ * partition and restarts the scan with a new session.
+ */
+static bool
+__pgstromExecTaskNextInnerPartition(pgstromTaskState *pts)
+{
+	uint32_t	part_id = pts->inner_part_id + 1;
+
+	if (pts->inner_part_depth == 0 ||
+		part_id >= pts->inner_part_nparts)
+		return false;
+	if (pts->conn)
+	{
+		xpuClientReleaseSession(pts->conn);
+		pts->conn = NULL;
+	}
+	pgstromTaskStateResetScan(pts);
+	if (pts->br_state)
+		pgstromBrinIndexExecReset(pts);
+	if (pts->zm_state)
+		pgstromZoneMapExecReset(pts);
+	if (!GpuJoinInnerPreloadSwitchPartition(pts, part_id))
+		elog(ERROR, "GpuJoin: unable to load inner partition %u of %u",
+			 part_id, pts->inner_part_nparts);
+	return __pgstromExecTaskOpenConnection(pts);
+}
+
+/*
+ * __pgstromExecTaskPrestartSiblings
+ *
+ * PostgreSQL's asynchronous execution is available only for ForeignScan,
+ * so Append runs the partition leafs one after another. Instead, the leaf
+ * under execution opens the session of the next leafs and enqueues their
+ * first commands, so the xPU service already runs the tasks of the next
+ * leaf when Append switches to it.
+ */
+static void
+__pgstromExecTaskPrestartSiblings(pgstromTaskState *pts)
+{
+	pgstromTaskState *sibling = pts->async_next;
+
+	pts->async_kicked = true;
+	for (int depth=0; sibling && depth < pgstrom_async_append_depth; depth++)
+	{
+		if (!sibling->conn && !sibling->async_empty)
+		{
+			XpuConnection *conn;
+			int		count;
+
+			sibling->async_prestarted = true;
+			if (!__pgstromExecTaskOpenConnection(sibling))
+				sibling->async_empty = true;
+			else
+			{
+				/* enqueue up to the half of in-flight window, as usual */
+				conn = sibling->conn;
+				pthreadMutexLock(&conn->mutex);
+				count = Max(conn->inflight_window / 2, 1);
+				pthreadMutexUnlock(&conn->mutex);
+				while (count-- > 0 && !sibling->scan_done)
+				{
+					if (!__sendNextXpuCommand(sibling))
+						break;
+				}
+				elog(DEBUG2, "%s: prestart the next partition leaf (plan_node_id=%d)",
+					 pts->css.methods->CustomName,
+					 sibling->css.ss.ps.plan->plan_node_id);
+			}
+		}
+		sibling = sibling->async_next;
+	}
+}
+
 /*
  * pgstromExecTaskState
  */
@@ -1903,12 +3695,19 @@ pgstromExecTaskState(CustomScanState *node)
 	ProjectionInfo *proj_info = node->ss.ps.ps_ProjInfo;
 	TupleTableSlot *slot;
 
-	if (!pts->conn)
+	if (!pts->conn && !pts->async_empty)
 	{
 		if (!__pgstromExecTaskOpenConnection(pts))
-			return NULL;
-		Assert(pts->conn);
+			pts->async_empty = true;
 	}
+	/* an empty leaf also kicks the next leafs */
+	if (pts->async_next && !pts->async_kicked)
+		__pgstromExecTaskPrestartSiblings(pts);
+	if (pts->async_empty)
+		return NULL;
+	Assert(pts->conn);
+	if (pts->calib_ts_begin == 0 && pgstrom_cost_calibration)
+		pts->calib_ts_begin = monotonic_clock_us();
 
 	/*
 	 * see, ExecScan() - it assumes CustomScan with scanrelid > 0 returns
@@ -1929,9 +3728,24 @@ pgstromExecTaskState(CustomScanState *node)
 
 	for (;;)
 	{
-		slot = pgstromExecScanAccess(pts);
+		if (OidIsValid(pts->pp_info->gpusort_sortop))
+			slot = pgstromExecGpuSortAccess(pts);
+		else
+			slot = pgstromExecScanAccess(pts);
 		if (TupIsNull(slot))
+		{
+			/* grace hash-join; run the next pass, if any */
+			if (__pgstromExecTaskNextInnerPartition(pts))
+				continue;
+			/* record the elapsed time for the cost calibration */
+			if (pts->calib_ts_begin != 0 && !pts->calib_recorded)
+			{
+				pgstromCostCalibrationRecordTask(pts, (monotonic_clock_us() -
+													   pts->calib_ts_begin));
+				pts->calib_recorded = true;
+			}
 			break;
+		}
 		/* check whether the current tuple satisfies the qual-clause */
 		ResetExprContext(econtext);
 		econtext->ecxt_scantuple = slot;
@@ -1960,9 +3774,12 @@ pgstromExecEndTaskState(CustomScanState *node)
 	if (pts->curr_vm_buffer != InvalidBuffer)
 		ReleaseBuffer(pts->curr_vm_buffer);
 	if (pts->conn)
-		xpuClientCloseSession(pts->conn);
+		xpuClientReleaseSession(pts->conn);
+	pgstromGpuSortEnd(pts);
 	if (pts->br_state)
 		pgstromBrinIndexExecEnd(pts);
+	if (pts->zm_state)
+		pgstromZoneMapExecEnd(pts);
 	if (pts->gcache_desc)
 		pgstromGpuCacheExecEnd(pts);
 	if (pts->arrow_state)
@@ -1987,6 +3804,8 @@ pgstromExecEndTaskState(CustomScanState *node)
 	}
 	foreach (lc, pts->css.custom_ps)
 		ExecEndNode((PlanState *) lfirst(lc));
+	if (outerPlanState(node))
+		ExecEndNode(outerPlanState(node));
 }
 
 /*
@@ -1999,14 +3818,26 @@ pgstromExecResetTaskState(CustomScanState *node)
 
 	if (pts->conn)
 	{
-		xpuClientCloseSession(pts->conn);
+		xpuClientReleaseSession(pts->conn);
 		pts->conn = NULL;
 	}
+	pgstromGpuSortEnd(pts);
 	pgstromTaskStateResetScan(pts);
+	pts->async_kicked = false;
+	pts->async_empty = false;
 	if (pts->br_state)
 		pgstromBrinIndexExecReset(pts);
+	if (pts->zm_state)
+		pgstromZoneMapExecReset(pts);
 	if (pts->arrow_state)
 		pgstromArrowFdwExecReset(pts->arrow_state);
+	/* grace hash-join restarts from the first partition */
+	if (pts->inner_part_depth > 0)
+		GpuJoinInnerPreloadSwitchPartition(pts, 0);
+	/* DPU pre-filtering, unless chgParam triggers rescan */
+	if (outerPlanState(node) &&
+		outerPlanState(node)->chgParam == NULL)
+		ExecReScan(outerPlanState(node));
 }
 
 /*
@@ -2121,7 +3952,9 @@ pgstromSharedStateInitDSM(CustomScanState *node,
 	ps_state->num_rels = num_rels;
 	ConditionVariableInit(&ps_state->preload_cond);
 	SpinLockInit(&ps_state->preload_mutex);
-	if (num_rels > 0)
+	ConditionVariableInit(&ps_state->fallback_cond);
+	SpinLockInit(&ps_state->fallback_mutex);
+	if (num_rels > 0 && !pts->sibling_leader)
 		ps_state->preload_shmem_handle = __shmemCreate(pts->ds_entry);
 	pts->ps_state = ps_state;
 	pts->css.ss.ss_currentScanDesc = scan;
@@ -2190,8 +4023,12 @@ pgstromSharedStateShutdownDSM(CustomScanState *node)
 	{
 		size_t	sz = offsetof(pgstromSharedState,
 							  inners[src_state->num_rels]);
+
+		__pgstromCancelFallbackSlots(pts);
 		dst_state = MemoryContextAllocZero(estate->es_query_cxt, sz);
 		memcpy(dst_state, src_state, sz);
+		/* nobody can take the fallback chunks any more */
+		pg_atomic_init_u32(&dst_state->fallback_nqueued, 0);
 		pts->ps_state = dst_state;
 	}
 }
@@ -2275,6 +4112,105 @@ pgstromGpuDirectExplain(pgstromTaskState *pts,
 	pfree(buf.data);
 }
 
+/*
+ * __explainXpuTaskPhaseTime
+ */
+static void
+__explainXpuTaskPhaseTime(pgstromSharedState *ps_state, ExplainState *es)
+{
+	static const char *phase_labels[XPU_TASK_NUM_PHASES] = {
+		"Queue", "I/O", "Kernel", "Post", "Transfer",
+	};
+	static const int	percentiles[] = { 50, 90, 99 };
+	uint64_t	ntasks = pg_atomic_read_u64(&ps_state->phase_ntasks);
+	StringInfoData buf;
+	char		label[80];
+
+	if (ntasks == 0)
+		return;
+	ExplainPropertyInteger("Task Samples", NULL, ntasks, es);
+	initStringInfo(&buf);
+	for (int i=0; i < XPU_TASK_NUM_PHASES; i++)
+	{
+		uint64_t	total_us = pg_atomic_read_u64(&ps_state->phase_time_us[i]);
+
+		resetStringInfo(&buf);
+		appendStringInfo(&buf, "total: %.3fms", (double)total_us / 1000.0);
+		for (int j=0; j < lengthof(percentiles); j++)
+		{
+			uint64_t	threshold = (ntasks * percentiles[j] + 99) / 100;
+			uint64_t	count = 0;
+			int			k;
+
+			for (k=0; k < XPU_TASK_PHASE_NBUCKETS - 1; k++)
+			{
+				count += pg_atomic_read_u32(&ps_state->phase_hist[i][k]);
+				if (count >= threshold)
+					break;
+			}
+			if (k < XPU_TASK_PHASE_NBUCKETS - 1)
+				appendStringInfo(&buf, ", p%d: <%.3fms", percentiles[j],
+								 (double)(1UL << k) / 1000.0);
+			else
+				appendStringInfo(&buf, ", p%d: >=%.3fms", percentiles[j],
+								 (double)(1UL << (k-1)) / 1000.0);
+		}
+		snprintf(label, sizeof(label), "Task Time [%s]", phase_labels[i]);
+		ExplainPropertyText(label, buf.data, es);
+	}
+	pfree(buf.data);
+}
+
+/*
+ * __explainXpuExecPaths
+ */
+static void
+__explainXpuExecPaths(pgstromSharedState *ps_state, ExplainState *es)
+{
+	static const char *exec_path_labels[] = {
+		"multi-gpu",			/* XPU_EXEC_PATH__MULTI_GPU */
+		"grid-tuning",			/* XPU_EXEC_PATH__GRID_TUNING */
+		"result-ring",			/* XPU_EXEC_PATH__RESULT_RING */
+		"specialized-module",	/* XPU_EXEC_PATH__JIT_MODULE */
+		"device-memory",		/* XPU_EXEC_PATH__DEVICE_MEMORY */
+		"shared-inner-buffer",	/* XPU_EXEC_PATH__SHARED_INNER */
+		"pooled-connection",	/* XPU_EXEC_PATH__POOLED_CONN */
+		"inflight-window",		/* XPU_EXEC_PATH__INFLIGHT_WINDOW */
+		"parallel-fallback",	/* XPU_EXEC_PATH__PARALLEL_FALLBACK */
+		"read-ahead",			/* XPU_EXEC_PATH__READ_AHEAD */
+		"multi-chunk-claim",	/* XPU_EXEC_PATH__MULTI_CHUNK_CLAIM */
+		"vfs-fallback",			/* XPU_EXEC_PATH__VFS_FALLBACK */
+		"dma-pool",				/* XPU_EXEC_PATH__DMA_POOL */
+		"hash-bucketized",		/* XPU_EXEC_PATH__HASH_BUCKETIZED */
+		"gpu-hash-build",		/* XPU_EXEC_PATH__GPU_HASH_BUILD */
+		"bloom-filter",			/* XPU_EXEC_PATH__BLOOM_FILTER */
+		"hash-skew",			/* XPU_EXEC_PATH__HASH_SKEW */
+		"cached-inner-buffer",	/* XPU_EXEC_PATH__CACHED_INNER */
+		"columnar-results",		/* XPU_EXEC_PATH__COLUMNAR_RESULTS */
+		"host-mapped-inner-buffer",	/* XPU_EXEC_PATH__HOST_MAPPED_INNER */
+		"time-slice-yield",		/* XPU_EXEC_PATH__KERNEL_YIELD */
+		"block-format",			/* XPU_EXEC_PATH__BLOCK_FORMAT */
+		"shared-scan-buffer",	/* XPU_EXEC_PATH__SHARED_SCAN */
+		"peer-inner-buffer",	/* XPU_EXEC_PATH__PEER_INNER */
+	};
+	uint32_t	exec_paths = pg_atomic_read_u32(&ps_state->exec_paths);
+	StringInfoData buf;
+
+	if (exec_paths == 0)
+		return;
+	initStringInfo(&buf);
+	for (int i=0; i < lengthof(exec_path_labels); i++)
+	{
+		if ((exec_paths & (1U<<i)) == 0)
+			continue;
+		if (buf.len > 0)
+			appendStringInfoString(&buf, ", ");
+		appendStringInfoString(&buf, exec_path_labels[i]);
+	}
+	ExplainPropertyText("Exec Paths", buf.data, es);
+	pfree(buf.data);
+}
+
 /*
  * pgstromExplainTaskState
  */
@@ -2459,6 +4395,12 @@ pgstromExplainTaskState(CustomScanState *node,
 					 "%s Inner Hash [%d]", xpu_label, i+1);
 			ExplainPropertyText(label, buf.data, es);
 		}
+		if (pts->inner_part_depth == i+1)
+		{
+			snprintf(label, sizeof(label),
+					 "%s Hash Partitions [%d]", xpu_label, i+1);
+			ExplainPropertyInteger(label, NULL, pts->inner_part_nparts, es);
+		}
 		if (pp_inner->gist_clause)
 		{
 			char   *idxname = get_rel_name(pp_inner->gist_index_oid);
@@ -2480,10 +4422,57 @@ pgstromExplainTaskState(CustomScanState *node,
 					 "%s GiST Join [%d]", xpu_label, i+1);
 			ExplainPropertyText(label, buf.data, es);
 		}
+		if (pp_inner->range_inner_key && pp_inner->range_grid_distance > 0.0)
+		{
+			resetStringInfo(&buf);
+			str = deparse_expression((Node *)pp_inner->range_inner_key,
+									 dcontext, verbose, true);
+			appendStringInfo(&buf, "%s, ", str);
+			str = deparse_expression((Node *)pp_inner->range_outer_key,
+									 dcontext, verbose, true);
+			appendStringInfo(&buf, "%s (cell: %g)", str,
+							 pp_inner->range_grid_distance);
+			snprintf(label, sizeof(label),
+					 "%s Grid Join [%d]", xpu_label, i+1);
+			ExplainPropertyText(label, buf.data, es);
+		}
+		else if (pp_inner->range_inner_key)
+		{
+			const char *opname;
+
+			switch (pp_inner->range_strategy)
+			{
+				case BTLessStrategyNumber:         opname = "<";  break;
+				case BTLessEqualStrategyNumber:    opname = "<="; break;
+				case BTGreaterEqualStrategyNumber: opname = ">="; break;
+				case BTGreaterStrategyNumber:      opname = ">";  break;
+				default:                           opname = "??"; break;
+			}
+			resetStringInfo(&buf);
+			str = deparse_expression((Node *)pp_inner->range_inner_key,
+									 dcontext, verbose, true);
+			appendStringInfo(&buf, "%s %s ", str, opname);
+			str = deparse_expression((Node *)pp_inner->range_outer_key,
+									 dcontext, verbose, true);
+			appendStringInfoString(&buf, str);
+			snprintf(label, sizeof(label),
+					 "%s Range Join [%d]", xpu_label, i+1);
+			ExplainPropertyText(label, buf.data, es);
+		}
 	}
 	if (pp_info->sibling_param_id >= 0)
 		ExplainPropertyInteger("Inner Siblings-Id", NULL,
 							   pp_info->sibling_param_id, es);
+	if (pp_info->groupby_final_mode)
+		ExplainPropertyBool("Final Aggregation", true, es);
+	if (pp_info->topk_nitems > 0)
+		ExplainPropertyInteger("GPU Top-N", NULL, pp_info->topk_nitems, es);
+	if (pp_info->limit_nitems > 0)
+		ExplainPropertyInteger("GPU Limit", NULL, pp_info->limit_nitems, es);
+	if (OidIsValid(pp_info->gpusort_sortop))
+		ExplainPropertyBool("GPU Sort", true, es);
+	if (es->analyze && pts->async_prestarted)
+		ExplainPropertyBool("Prestarted", true, es);
 
 	/*
 	 * Storage related info
@@ -2517,6 +4506,15 @@ pgstromExplainTaskState(CustomScanState *node,
 	/* State of BRIN-index */
 	if (pts->br_state)
 		pgstromBrinIndexExplain(pts, dcontext, es);
+	/* State of zone-map */
+	if (pts->zm_state)
+		pgstromZoneMapExplain(pts, dcontext, es);
+	/* Optional execution paths taken by the xPU tasks */
+	if (es->analyze && ps_state)
+		__explainXpuExecPaths(ps_state, es);
+	/* Per-phase time of the xPU tasks */
+	if (es->analyze && ps_state && !pgstrom_regression_test_mode)
+		__explainXpuTaskPhaseTime(ps_state, es);
 
 	/*
 	 * Dump the XPU code (only if verbose)
@@ -2543,6 +4541,9 @@ pgstromExplainTaskState(CustomScanState *node,
 		pgstrom_explain_xpucode(&pts->css, es, dcontext,
 								"GiST-Index Join OpCode",
 								pp_info->kexp_gist_evals_packed);
+		pgstrom_explain_xpucode(&pts->css, es, dcontext,
+								"Range Join OpCode",
+								pp_info->kexp_range_keys_packed);
 		pgstrom_explain_xpucode(&pts->css, es, dcontext,
 								"Projection OpCode",
 								pp_info->kexp_projection);
@@ -2569,29 +4570,293 @@ pgstromExplainTaskState(CustomScanState *node,
 }
 
 /*
- * __xpuClientOpenSession
+ * __xpuClientSetupResultRing
+ *
+ * It creates a shared memory ring buffer for the results; GPU-service
+ * copies the results into the ring buffer, instead of the socket payload.
+ * It is an optimization, so we don't raise an error even if failed.
+ */
+static const XpuCommand *
+__xpuClientSetupResultRing(XpuConnection *conn, const XpuCommand *session)
+{
+	static uint32_t	ring_handle_seed = 0;
+	XpuCommand *__session;
+	kern_result_ring *h_ring;
+	size_t		ring_sz = (size_t)pgstrom_gpu_result_ring_size << 20;
+	uint32_t	handle;
+	int			fdesc;
+	char		namebuf[64];
+
+	do {
+		handle = (((uint32_t)MyProcPid << 12) ^ (++ring_handle_seed));
+		if (handle == 0)
+			continue;
+		snprintf(namebuf, sizeof(namebuf),
+				 ".pgstrom_ring_%u_%u",
+				 PostPortNumber, handle);
+		fdesc = shm_open(namebuf, O_RDWR | O_CREAT | O_EXCL, 0600);
+		if (fdesc < 0 && errno != EEXIST)
+		{
+			elog(DEBUG1, "failed on shm_open('%s'): %m", namebuf);
+			return session;
+		}
+	} while (fdesc < 0);
+
+	while (fallocate(fdesc, 0, 0, ring_sz) != 0)
+	{
+		if (errno != EINTR)
+		{
+			elog(DEBUG1, "failed on fallocate('%s', %zu): %m",
+				 namebuf, ring_sz);
+			close(fdesc);
+			shm_unlink(namebuf);
+			return session;
+		}
+	}
+	h_ring = mmap(NULL, ring_sz,
+				  PROT_READ | PROT_WRITE,
+				  MAP_SHARED,
+				  fdesc, 0);
+	close(fdesc);
+	if (h_ring == MAP_FAILED)
+	{
+		elog(DEBUG1, "failed on mmap('%s', %zu): %m", namebuf, ring_sz);
+		shm_unlink(namebuf);
+		return session;
+	}
+	h_ring->length = ring_sz;
+	conn->h_ring = h_ring;
+	conn->ring_mmap_sz = ring_sz;
+	strcpy(conn->ring_name, namebuf);
+
+	__session = palloc(session->length);
+	memcpy(__session, session, session->length);
+	__session->u.session.result_ring_handle = handle;
+
+	return __session;
+}
+
+/*
+ * __xpuClientLookupSessionCache
+ *
+ * It checks whether GPU-service already keeps the static portion of the
+ * session on this connection. Entire image is compared, not only the hash.
+ */
+static bool
+__xpuClientLookupSessionCache(XpuConnection *conn,
+							  const kern_session_info *session)
+{
+	if (session->session_cache_key == 0)
+		return false;
+	for (int i=0; i < KERN_SESSION_CACHE_NSLOTS; i++)
+	{
+		XpuSessionCacheEntry *entry = &conn->session_cache[i];
+
+		if (entry->key == session->session_cache_key &&
+			entry->offset == session->session_cache_offset &&
+			entry->length == session->session_cache_length &&
+			entry->image != NULL &&
+			memcmp(entry->image, (const char *)session + entry->offset,
+				   entry->length) == 0)
+			return true;
+	}
+	return false;
+}
+
+/*
+ * __xpuClientSaveSessionCache
+ *
+ * It tracks the static portion kept by GPU-service. The entry with the same
+ * key, or the oldest one, is replaced, as GPU-service doing.
+ */
+static void
+__xpuClientSaveSessionCache(XpuConnection *conn,
+							const kern_session_info *session)
+{
+	XpuSessionCacheEntry *entry = NULL;
+
+	if (session->session_cache_key == 0)
+		return;
+	for (int i=0; i < KERN_SESSION_CACHE_NSLOTS; i++)
+	{
+		if (conn->session_cache[i].key == session->session_cache_key)
+		{
+			entry = &conn->session_cache[i];
+			break;
+		}
+	}
+	if (!entry)
+	{
+		entry = &conn->session_cache[conn->session_cache_next];
+		conn->session_cache_next = ((conn->session_cache_next + 1) %
+									KERN_SESSION_CACHE_NSLOTS);
+	}
+	if (entry->image)
+		free(entry->image);
+	entry->key = session->session_cache_key;
+	entry->offset = session->session_cache_offset;
+	entry->length = session->session_cache_length;
+	/* no match on out of memory, but the slot shall be consumed anyway */
+	entry->image = malloc(entry->length);
+	if (entry->image)
+		memcpy(entry->image, (const char *)session + entry->offset,
+			   entry->length);
+}
+
+/*
+ * __xpuClientInitSession
+ *
+ * It sends OpenSession to all the sockets, and waits for the responses.
+ */
+static void
+__xpuClientInitSession(pgstromTaskState *pts,
+					   XpuConnection *conn,
+					   const XpuCommand *session)
+{
+	XpuCommand *resp;
+	bool		ring_created = false;
+	bool		cache_hit = false;
+
+	/*
+	 * Setup the result ring buffer; only when a single GPU device.
+	 * A reused connection keeps the ring buffer already attached.
+	 */
+	if (!conn->h_ring &&
+		conn->num_socks == 1 &&
+		pgstrom_gpu_result_ring_size > 0 &&
+		(pts->xpu_task_flags & DEVKIND__NVIDIA_GPU) != 0)
+	{
+		session = __xpuClientSetupResultRing(conn, session);
+		ring_created = (conn->h_ring != NULL);
+	}
+
+	/*
+	 * Initialize the new session
+	 */
+	Assert(session->tag == XpuCommandTag__OpenSession);
+	if (conn->poolable &&
+		__xpuClientLookupSessionCache(conn, &session->u.session))
+	{
+		const kern_session_info *__session = &session->u.session;
+		uint32_t	head_sz = (offsetof(XpuCommand, u.session) +
+							   __session->session_cache_offset);
+		XpuCommand *__xcmd = alloca(head_sz);
+		struct iovec iov[2];
+
+		/* send the session without the static portion */
+		memcpy(__xcmd, session, head_sz);
+		__xcmd->length -= __session->session_cache_length;
+		__xcmd->u.session.session_cache_omitted = true;
+		iov[0].iov_base = __xcmd;
+		iov[0].iov_len  = head_sz;
+		iov[1].iov_base = ((char *)session + head_sz +
+						   __session->session_cache_length);
+		iov[1].iov_len  = __xcmd->length - head_sz;
+		xpuClientSendCommandIOV(conn, &conn->socks[0], iov, 2);
+		cache_hit = true;
+	}
+	else
+	{
+		for (int i=0; i < conn->num_socks; i++)
+		{
+			struct iovec	iov;
+
+			iov.iov_base = (void *)session;
+			iov.iov_len  = session->length;
+			xpuClientSendCommandIOV(conn, &conn->socks[i], &iov, 1);
+		}
+	}
+	for (int i=0; i < conn->num_socks; i++)
+	{
+		resp = __waitAndFetchNextXpuCommand(pts, false);
+		if (!resp)
+			elog(ERROR, "Bug? %s:OpenSession response is missing", conn->devname);
+		if (resp->tag != XpuCommandTag__Success)
+			elog(ERROR, "%s:OpenSession failed - %s (%s:%d %s)",
+				 conn->devname,
+				 resp->u.error.message,
+				 resp->u.error.filename,
+				 resp->u.error.lineno,
+				 resp->u.error.funcname);
+		xpuClientPutResponse(resp);
+	}
+	/* GPU-service keeps the static portion of this session also */
+	if (conn->poolable && !cache_hit)
+		__xpuClientSaveSessionCache(conn, &session->u.session);
+	/* GPU-service already mapped the ring buffer */
+	if (ring_created)
+		shm_unlink(conn->ring_name);
+}
+
+/*
+ * xpuClientReuseConnection
+ *
+ * It opens the session on the connection kept by the previous session
+ * on the same device, if any.
+ */
+bool
+xpuClientReuseConnection(pgstromTaskState *pts,
+						 const XpuCommand *session,
+						 int dev_index)
+{
+	dlist_mutable_iter iter;
+
+	Assert(!pts->conn);
+	dlist_foreach_modify(iter, &xpu_pooled_connections_list)
+	{
+		XpuConnection  *conn = dlist_container(XpuConnection,
+											   chain, iter.cur);
+		if (conn->socks[0].dev_index != dev_index)
+			continue;
+		dlist_delete(&conn->chain);
+		xpu_pooled_connections_count--;
+		dlist_push_tail(&xpu_connections_list, &conn->chain);
+		conn->resowner = CurrentResourceOwner;
+		if (!__xpuClientWaitResetSession(conn))
+		{
+			xpuClientCloseSession(conn);
+			continue;
+		}
+		conn->final_plan_pending = false;
+		conn->socks[0].final_this_device = false;
+		__xpuClientResetInflightWindow(conn);
+		pts->conn = conn;
+		pg_atomic_fetch_or_u32(&pts->ps_state->exec_paths,
+							   XPU_EXEC_PATH__POOLED_CONN);
+		__xpuClientInitSession(pts, conn, session);
+		return true;
+	}
+	return false;
+}
+
+/*
+ * __xpuClientOpenSessionMulti
+ *
+ * It opens a session with one or more sockets connected to the xPU service.
+ * Multiple sockets are used for the multi-GPU split execution; each of them
+ * is connected to the individual GPU device, and the same session is opened
+ * on all the devices.
  */
 void
-__xpuClientOpenSession(pgstromTaskState *pts,
-					   const XpuCommand *session,
-					   pgsocket sockfd,
-					   const char *devname,
-					   int dev_index)
+__xpuClientOpenSessionMulti(pgstromTaskState *pts,
+							const XpuCommand *session,
+							int num_socks,
+							const pgsocket *sockfds,
+							const int *dev_indexes,
+							const char *devname)
 {
 	XpuConnection  *conn;
-	XpuCommand	   *resp;
 	int				rv;
 
-	Assert(!pts->conn);
-	conn = calloc(1, sizeof(XpuConnection));
+	Assert(!pts->conn && num_socks > 0);
+	conn = calloc(1, offsetof(XpuConnection, socks[num_socks]));
 	if (!conn)
 	{
-		close(sockfd);
+		for (int i=0; i < num_socks; i++)
+			close(sockfds[i]);
 		elog(ERROR, "out of memory");
 	}
 	strncpy(conn->devname, devname, 32);
-	conn->dev_index = dev_index;
-	conn->sockfd = sockfd;
 	conn->resowner = CurrentResourceOwner;
 	conn->worker = pthread_self();	/* to be over-written by worker's-id */
 	pthreadMutexInit(&conn->mutex);
@@ -2599,6 +4864,18 @@ __xpuClientOpenSession(pgstromTaskState *pts,
 	conn->num_ready_cmds = 0;
 	dlist_init(&conn->ready_cmds_list);
 	dlist_init(&conn->active_cmds_list);
+	conn->poolable = (num_socks == 1 &&
+					  (pts->xpu_task_flags & DEVKIND__NVIDIA_GPU) != 0);
+	conn->num_socks = num_socks;
+	conn->inflight_window = pgstrom_max_async_tasks() * num_socks;
+	for (int i=0; i < num_socks; i++)
+	{
+		XpuConnectionSocket *sock = &conn->socks[i];
+
+		sock->conn = conn;
+		sock->dev_index = dev_indexes[i];
+		sock->sockfd = sockfds[i];
+	}
 	dlist_push_tail(&xpu_connections_list, &conn->chain);
 	pts->conn = conn;
 
@@ -2610,22 +4887,76 @@ __xpuClientOpenSession(pgstromTaskState *pts,
 							 __xpuConnectSessionWorker, conn)) != 0)
 		elog(ERROR, "failed on pthread_create: %s", strerror(rv));
 
-	/*
-	 * Initialize the new session
-	 */
-	Assert(session->tag == XpuCommandTag__OpenSession);
-	xpuClientSendCommand(conn, session);
-	resp = __waitAndFetchNextXpuCommand(pts, false);
-	if (!resp)
-		elog(ERROR, "Bug? %s:OpenSession response is missing", conn->devname);
-	if (resp->tag != XpuCommandTag__Success)
-		elog(ERROR, "%s:OpenSession failed - %s (%s:%d %s)",
-			 conn->devname,
-			 resp->u.error.message,
-			 resp->u.error.filename,
-			 resp->u.error.lineno,
-			 resp->u.error.funcname);
-	xpuClientPutResponse(resp);
+	__xpuClientInitSession(pts, conn, session);
+}
+
+/*
+ * __xpuClientOpenSession
+ */
+void
+__xpuClientOpenSession(pgstromTaskState *pts,
+					   const XpuCommand *session,
+					   pgsocket sockfd,
+					   const char *devname,
+					   int dev_index)
+{
+	__xpuClientOpenSessionMulti(pts, session, 1,
+								&sockfd, &dev_index, devname);
+}
+
+/*
+ * __pgstromLinkAsyncSiblings
+ *
+ * It links the PG-Strom task states under a (non-parallel) Append in the
+ * order of execution, to prestart the next partition leafs.
+ * Append with the run-time partition pruning may skip some leafs, so it
+ * is not a candidate.
+ */
+static bool
+__pgstromLinkAsyncSiblings(PlanState *ps, void *context)
+{
+	if (!ps)
+		return false;
+	if (IsA(ps, AppendState) &&
+		!ps->plan->parallel_aware &&
+		(!((AppendState *)ps)->as_prune_state ||
+		 !((AppendState *)ps)->as_prune_state->do_exec_prune))
+	{
+		AppendState *astate = (AppendState *)ps;
+		pgstromTaskState *prev = NULL;
+
+		for (int i=0; i < astate->as_nplans; i++)
+		{
+			PlanState  *child = astate->appendplans[i];
+
+			if (IsA(child, CustomScanState) &&
+				((CustomScanState *)child)->methods->BeginCustomScan == pgstromExecInitTaskState)
+			{
+				pgstromTaskState *curr = (pgstromTaskState *)child;
+
+				if (prev)
+					prev->async_next = curr;
+				prev = curr;
+			}
+		}
+	}
+	return planstate_tree_walker(ps, __pgstromLinkAsyncSiblings, context);
+}
+
+/*
+ * pgstrom_executor_start
+ */
+static void
+pgstrom_executor_start(QueryDesc *queryDesc, int eflags)
+{
+	if (executor_start_next)
+		executor_start_next(queryDesc, eflags);
+	else
+		standard_ExecutorStart(queryDesc, eflags);
+
+	if (pgstrom_async_append_depth > 0 &&
+		(eflags & EXEC_FLAG_EXPLAIN_ONLY) == 0)
+		__pgstromLinkAsyncSiblings(queryDesc->planstate, NULL);
 }
 
 /*
@@ -2634,6 +4965,104 @@ __xpuClientOpenSession(pgstromTaskState *pts,
 void
 pgstrom_init_executor(void)
 {
+	DefineCustomIntVariable("pg_strom.xpu_task_priority",
+							"Weight of the xPU tasks of this session for fair-share scheduling",
+							NULL,
+							&pgstrom_xpu_task_priority,
+							100,
+							1,
+							10000,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE,
+							NULL, NULL, NULL);
+	DefineCustomIntVariable("pg_strom.gpu_result_ring_size",
+							"Size of the shared memory ring buffer to receive the results from GPU service (0 = disabled)",
+							NULL,
+							&pgstrom_gpu_result_ring_size,
+							64,
+							0,
+							1024,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_MB,
+							NULL, NULL, NULL);
+	DefineCustomIntVariable("pg_strom.gpu_session_memory_limit",
+							"Device memory budget of a session; use ALTER ROLE to set per-role budget (0 = unlimited)",
+							NULL,
+							&pgstrom_gpu_session_memory_limit,
+							0,
+							0,
+							INT_MAX,
+							PGC_SUSET,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_MB,
+							NULL, NULL, NULL);
+	DefineCustomIntVariable("pg_strom.xpu_connection_pool_size",
+							"Number of connections to GPU service kept for the next sessions (0 = disabled)",
+							NULL,
+							&pgstrom_xpu_connection_pool_size,
+							2,
+							0,
+							64,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE,
+							NULL, NULL, NULL);
+	DefineCustomIntVariable("pg_strom.xpu_max_inflight_tasks",
+							"Upper limit of the adaptive in-flight window of xPU tasks per device",
+							NULL,
+							&pgstrom_xpu_max_inflight_tasks,
+							32,
+							0,
+							XPU_INFLIGHT_MAX_TASKS,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE,
+							NULL, NULL, NULL);
+	DefineCustomBoolVariable("pg_strom.parallel_cpu_fallback",
+							 "Enables to run CPU fallback chunks by the other parallel processes",
+							 NULL,
+							 &pgstrom_parallel_cpu_fallback,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	DefineCustomBoolVariable("pg_strom.gpu_session_cache",
+							 "Enables to send only the dynamic portion of the session information on the kept connection",
+							 NULL,
+							 &pgstrom_gpu_session_cache,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	DefineCustomBoolVariable("pg_strom.enable_columnar_results",
+							 "Enables to send back the GPU results in the columnar format",
+							 NULL,
+							 &pgstrom_enable_columnar_results,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	DefineCustomIntVariable("pg_strom.chunk_size_min",
+							"Initial size of the source chunks; adjusted up to 64MB at runtime",
+							NULL,
+							&pgstrom_chunk_size_min,
+							8,
+							1,
+							64,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_MB,
+							NULL, NULL, NULL);
+	DefineCustomIntVariable("pg_strom.async_append_depth",
+							"Number of the next partition leafs under Append to be started in advance (0 = disabled)",
+							NULL,
+							&pgstrom_async_append_depth,
+							1,
+							0,
+							16,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE,
+							NULL, NULL, NULL);
 	dlist_init(&xpu_connections_list);
+	dlist_init(&xpu_pooled_connections_list);
 	RegisterResourceReleaseCallback(xpuclientCleanupConnections, NULL);
+	/* executor hook to link the partition leafs */
+	executor_start_next = ExecutorStart_hook;
+	ExecutorStart_hook = pgstrom_executor_start;
 }
@@ -10,6 +10,10 @@
  * it under the terms of the PostgreSQL License.
  */
 #include <dlfcn.h>
+#include <sys/syscall.h>
+#ifdef WITH_LIBURING
+#include <liburing.h>
+#endif
 #include "pg_strom.h"
 
 
@@ -19,6 +23,7 @@
 static int		gpudirect_driver_kind;
 static __thread void   *gpudirect_vfs_dma_buffer = NULL;
 static __thread size_t	gpudirect_vfs_dma_buffer_sz = 0UL;
+static __thread int		gpudirect_vfs_dma_buffer_dindex = -1;	/* if pooled */
 
 /*
  * heterodbExtraModuleInfo
@@ -391,6 +396,173 @@ gpuDirectDeregisterStream(CUstream cuda_stream)
 	return true;
 }
 
+/*
+ * DMA buffer pool
+ *
+ * GPU service preallocates the pinned host buffers for the VFS fallback
+ * per GPU device, on the huge-pages of the NUMA node of the device, then
+ * worker threads attach one of them at the start-up. It avoids the TLB
+ * misses and the latency spike of cuMemAllocHost() on the first read by
+ * the new worker threads.
+ */
+#define GPUDIRECT_DMA_BUFFER_UNITSZ		(PGSTROM_CHUNK_SIZE + (8UL<<20))
+#define GPUDIRECT_HUGEPAGE_SZ			(2UL<<20)
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED					1
+#endif
+
+typedef struct
+{
+	pthread_mutex_t	lock;
+	char		   *base;			/* mmap'ed region */
+	size_t			length;
+	int				nitems;
+	int				nfree;
+	void		  **free_list;
+} gpuDirectDMABufferPool;
+
+static gpuDirectDMABufferPool *gpudirect_dma_pools = NULL;
+
+void
+gpuDirectSetupDMABufferPool(int cuda_dindex, int numa_node_id, size_t pool_sz)
+{
+	gpuDirectDMABufferPool *pool;
+	size_t		unitsz = GPUDIRECT_DMA_BUFFER_UNITSZ;
+	size_t		length;
+	int			nitems = pool_sz / unitsz;
+	char	   *base;
+	CUresult	rc;
+
+	if (nitems <= 0)
+		return;
+	if (!gpudirect_dma_pools)
+	{
+		gpudirect_dma_pools = calloc(numGpuDevAttrs,
+									 sizeof(gpuDirectDMABufferPool));
+		if (!gpudirect_dma_pools)
+			elog(ERROR, "out of memory");
+	}
+	pool = &gpudirect_dma_pools[cuda_dindex];
+	Assert(!pool->base);
+	length = TYPEALIGN(GPUDIRECT_HUGEPAGE_SZ, unitsz * nitems);
+	base = mmap(NULL, length,
+				PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+				-1, 0);
+	if (base == MAP_FAILED)
+	{
+		/* no reserved huge-pages, so try transparent huge-pages */
+		base = mmap(NULL, length,
+					PROT_READ | PROT_WRITE,
+					MAP_PRIVATE | MAP_ANONYMOUS,
+					-1, 0);
+		if (base == MAP_FAILED)
+		{
+			elog(LOG, "GPU%d: failed on mmap(2) for DMA buffer pool: %m",
+				 cuda_dindex);
+			return;
+		}
+		if (madvise(base, length, MADV_HUGEPAGE) != 0)
+			elog(LOG, "GPU%d: failed on madvise(MADV_HUGEPAGE): %m",
+				 cuda_dindex);
+	}
+	/* prefer the NUMA node of the GPU device, prior to the first touch */
+	if (numa_node_id >= 0 && numa_node_id < 64)
+	{
+		unsigned long	nodemask = (1UL << numa_node_id);
+
+		if (syscall(SYS_mbind, base, length, MPOL_PREFERRED,
+					&nodemask, sizeof(nodemask) * BITS_PER_BYTE, 0) != 0)
+			elog(LOG, "GPU%d: failed on mbind(2) for NUMA node %d: %m",
+				 cuda_dindex, numa_node_id);
+	}
+	memset(base, 0, length);
+	rc = cuMemHostRegister(base, length, CU_MEMHOSTREGISTER_PORTABLE);
+	if (rc != CUDA_SUCCESS)
+	{
+		elog(LOG, "GPU%d: failed on cuMemHostRegister: %s",
+			 cuda_dindex, cuStrError(rc));
+		munmap(base, length);
+		return;
+	}
+	pool->free_list = calloc(nitems, sizeof(void *));
+	if (!pool->free_list)
+	{
+		cuMemHostUnregister(base);
+		munmap(base, length);
+		elog(ERROR, "out of memory");
+	}
+	pthreadMutexInit(&pool->lock);
+	pool->base = base;
+	pool->length = length;
+	pool->nitems = nitems;
+	pool->nfree = nitems;
+	for (int i=0; i < nitems; i++)
+		pool->free_list[i] = base + unitsz * i;
+	elog(LOG, "GPU%d: DMA buffer pool %zuMB (%d buffers) is ready",
+		 cuda_dindex, length >> 20, nitems);
+}
+
+void
+gpuDirectReleaseDMABufferPool(int cuda_dindex)
+{
+	gpuDirectDMABufferPool *pool;
+	CUresult	rc;
+
+	if (!gpudirect_dma_pools)
+		return;
+	pool = &gpudirect_dma_pools[cuda_dindex];
+	if (!pool->base)
+		return;
+	if (pool->nfree != pool->nitems)
+		elog(LOG, "GPU%d: %d DMA buffers are still in use",
+			 cuda_dindex, pool->nitems - pool->nfree);
+	rc = cuMemHostUnregister(pool->base);
+	if (rc != CUDA_SUCCESS)
+		elog(LOG, "failed on cuMemHostUnregister: %s", cuStrError(rc));
+	if (munmap(pool->base, pool->length) != 0)
+		elog(LOG, "failed on munmap: %m");
+	free(pool->free_list);
+	memset(pool, 0, sizeof(gpuDirectDMABufferPool));
+}
+
+/*
+ * gpuDirectAttachDMABuffer
+ *
+ * It attaches a DMA buffer of the pool to the current thread, if any.
+ * Elsewhere, it shall be allocated on demand.
+ */
+void
+gpuDirectAttachDMABuffer(int cuda_dindex)
+{
+	gpuDirectDMABufferPool *pool;
+
+	if (gpudirect_vfs_dma_buffer || !gpudirect_dma_pools)
+		return;
+	pool = &gpudirect_dma_pools[cuda_dindex];
+	if (!pool->base)
+		return;
+	pthreadMutexLock(&pool->lock);
+	if (pool->nfree > 0)
+	{
+		gpudirect_vfs_dma_buffer = pool->free_list[--pool->nfree];
+		gpudirect_vfs_dma_buffer_sz = GPUDIRECT_DMA_BUFFER_UNITSZ;
+		gpudirect_vfs_dma_buffer_dindex = cuda_dindex;
+	}
+	pthreadMutexUnlock(&pool->lock);
+}
+
+/*
+ * gpuDirectDMABufferIsPooled
+ *
+ * It tells whether the DMA buffer of the current thread comes from the pool.
+ */
+bool
+gpuDirectDMABufferIsPooled(void)
+{
+	return (gpudirect_vfs_dma_buffer_dindex >= 0);
+}
+
 /*
  * __gpuDirectAllocDMABufferOnDemand
  */
@@ -401,7 +573,7 @@ __gpuDirectAllocDMABufferOnDemand(void)
 
 	if (!gpudirect_vfs_dma_buffer)
 	{
-		size_t	bufsz = PGSTROM_CHUNK_SIZE + (8UL<<20);
+		size_t	bufsz = GPUDIRECT_DMA_BUFFER_UNITSZ;
 
 		rc = cuMemAllocHost(&gpudirect_vfs_dma_buffer, bufsz);
 		if (rc != CUDA_SUCCESS)
@@ -493,6 +665,259 @@ error_0:
 	return false;
 }
 
+#ifdef WITH_LIBURING
+/*
+ * io_uring based VFS fallback
+ *
+ * The pinned DMA buffer is split into the fixed-size units, and registered
+ * to the per-thread io_uring as fixed buffers. All the I/O requests of the
+ * strom_io_vector are submitted as long as any free units exist, so the
+ * NVMe device sees a deep queue across the chunks, instead of synchronous
+ * pread(2) one by one.
+ */
+#define GPUDIRECT_URING_UNIT_SZ		(1UL << 20)		/* 1MB */
+#define GPUDIRECT_URING_MAX_UNITS	128
+
+typedef struct
+{
+	off_t		file_pos;		/* current position to read */
+	off_t		dest_pos;		/* current position to copy */
+	size_t		remained;		/* remained bytes of the request */
+} gpudirectUringUnit;
+
+static __thread struct io_uring *gpudirect_uring = NULL;
+static __thread bool	gpudirect_uring_disabled = false;
+static __thread int		gpudirect_uring_nunits = 0;
+
+static bool
+__gpuDirectSetupUring(void)
+{
+	struct io_uring *ring;
+	struct iovec	iov[GPUDIRECT_URING_MAX_UNITS];
+	int				nunits;
+	int				rv;
+
+	if (gpudirect_uring)
+		return true;
+	if (gpudirect_uring_disabled)
+		return false;
+	nunits = Min(gpudirect_vfs_dma_buffer_sz / GPUDIRECT_URING_UNIT_SZ,
+				 GPUDIRECT_URING_MAX_UNITS);
+	ring = calloc(1, sizeof(struct io_uring));
+	if (!ring || nunits < 2)
+		goto error_0;
+	rv = io_uring_queue_init(nunits, ring, 0);
+	if (rv < 0)
+	{
+		fprintf(stderr, "failed on io_uring_queue_init: %s\n",
+				strerror(-rv));
+		goto error_0;
+	}
+	for (int i=0; i < nunits; i++)
+	{
+		iov[i].iov_base = (char *)gpudirect_vfs_dma_buffer +
+			i * GPUDIRECT_URING_UNIT_SZ;
+		iov[i].iov_len  = GPUDIRECT_URING_UNIT_SZ;
+	}
+	rv = io_uring_register_buffers(ring, iov, nunits);
+	if (rv < 0)
+	{
+		fprintf(stderr, "failed on io_uring_register_buffers: %s\n",
+				strerror(-rv));
+		goto error_1;
+	}
+	gpudirect_uring = ring;
+	gpudirect_uring_nunits = nunits;
+	return true;
+
+error_1:
+	io_uring_queue_exit(ring);
+error_0:
+	if (ring)
+		free(ring);
+	/* never retry on this thread */
+	gpudirect_uring_disabled = true;
+	return false;
+}
+
+/*
+ * __uringSubmitUnit
+ */
+static bool
+__uringSubmitUnit(int fdesc, int index, gpudirectUringUnit *unit)
+{
+	struct io_uring_sqe *sqe = io_uring_get_sqe(gpudirect_uring);
+
+	if (!sqe)
+		return false;
+	io_uring_prep_read_fixed(sqe, fdesc,
+							 (char *)gpudirect_vfs_dma_buffer +
+							 index * GPUDIRECT_URING_UNIT_SZ,
+							 Min(unit->remained, GPUDIRECT_URING_UNIT_SZ),
+							 unit->file_pos,
+							 index);
+	io_uring_sqe_set_data64(sqe, index);
+	return true;
+}
+
+/*
+ * __uringFileReadIOV
+ */
+static bool
+__uringFileReadIOV(const char *pathname,
+				   CUdeviceptr m_segment,
+				   off_t m_offset,
+				   const strom_io_vector *iovec,
+				   uint32_t *p_npages_direct_read,
+				   uint32_t *p_npages_vfs_read)
+{
+	gpudirectUringUnit units[GPUDIRECT_URING_MAX_UNITS];
+	int			free_units[GPUDIRECT_URING_MAX_UNITS];
+	int			nfree = 0;
+	int			ninflight = 0;
+	int			fdesc;
+	int			chunk_index = 0;
+	off_t		file_pos = 0;
+	off_t		dest_pos = 0;
+	size_t		remained = 0;
+	uint32_t	nr_pages = 0;
+	bool		retval = false;
+	struct stat	stat_buf;
+
+	fdesc = open(pathname, O_RDONLY);
+	if (fdesc < 0)
+	{
+		fprintf(stderr, "failed on open('%s'): %m\n", pathname);
+		return false;
+	}
+	if (fstat(fdesc, &stat_buf) != 0)
+	{
+		fprintf(stderr, "failed on fstat('%s'): %m\n", pathname);
+		goto bailout;
+	}
+	for (int i=gpudirect_uring_nunits-1; i >= 0; i--)
+		free_units[nfree++] = i;
+
+	for (;;)
+	{
+		struct io_uring_cqe *cqe;
+		int			rv;
+
+		/* submit the requests as long as free units exist */
+		while (nfree > 0)
+		{
+			gpudirectUringUnit *unit;
+			int			index;
+
+			while (remained == 0 && chunk_index < iovec->nr_chunks)
+			{
+				const strom_io_chunk *ioc = &iovec->ioc[chunk_index++];
+
+				file_pos = ioc->fchunk_id * PAGE_SIZE;
+				dest_pos = m_offset + ioc->m_offset;
+				remained = ioc->nr_pages * PAGE_SIZE;
+				/* cut off the file tail */
+				if (file_pos >= stat_buf.st_size)
+					remained = 0;
+				else
+				{
+					if (file_pos + remained > stat_buf.st_size)
+						remained = stat_buf.st_size - file_pos;
+					nr_pages += ioc->nr_pages;
+				}
+			}
+			if (remained == 0)
+				break;
+			index = free_units[--nfree];
+			unit = &units[index];
+			unit->file_pos = file_pos;
+			unit->dest_pos = dest_pos;
+			unit->remained = Min(remained, GPUDIRECT_URING_UNIT_SZ);
+			if (!__uringSubmitUnit(fdesc, index, unit))
+			{
+				free_units[nfree++] = index;
+				break;
+			}
+			file_pos += unit->remained;
+			dest_pos += unit->remained;
+			remained -= unit->remained;
+			ninflight++;
+		}
+		if (ninflight == 0)
+			break;		/* all done */
+
+		rv = io_uring_submit_and_wait(gpudirect_uring, 1);
+		if (rv < 0 && rv != -EINTR)
+		{
+			fprintf(stderr, "failed on io_uring_submit_and_wait: %s\n",
+					strerror(-rv));
+			goto bailout;
+		}
+		while (io_uring_peek_cqe(gpudirect_uring, &cqe) == 0)
+		{
+			int			index = (int)io_uring_cqe_get_data64(cqe);
+			int			res = cqe->res;
+			gpudirectUringUnit *unit = &units[index];
+			CUresult	rc;
+
+			io_uring_cqe_seen(gpudirect_uring, cqe);
+			ninflight--;
+			if (res == -EINTR || res == -EAGAIN)
+				res = 0;		/* retry */
+			else if (res <= 0)
+			{
+				fprintf(stderr, "failed on io_uring read: %s\n",
+						res < 0 ? strerror(-res) : "unexpected EOF");
+				goto bailout;
+			}
+			if (res > 0)
+			{
+				rc = cuMemcpyHtoD(m_segment + unit->dest_pos,
+								  (char *)gpudirect_vfs_dma_buffer +
+								  index * GPUDIRECT_URING_UNIT_SZ,
+								  res);
+				if (rc != CUDA_SUCCESS)
+				{
+					fprintf(stderr, "failed on cuMemcpyHtoD\n");
+					goto bailout;
+				}
+				unit->file_pos += res;
+				unit->dest_pos += res;
+				unit->remained -= res;
+			}
+			if (unit->remained == 0)
+				free_units[nfree++] = index;
+			else if (__uringSubmitUnit(fdesc, index, unit))
+				ninflight++;	/* short read, or retry */
+			else
+			{
+				fprintf(stderr, "io_uring submission queue is full\n");
+				goto bailout;
+			}
+		}
+	}
+	/* update statistics */
+	if (p_npages_direct_read)
+		*p_npages_direct_read = 0;
+	if (p_npages_vfs_read)
+		*p_npages_vfs_read = nr_pages;
+	retval = true;
+bailout:
+	/* wait for the requests in-flight, prior to reuse of the buffer */
+	while (ninflight > 0)
+	{
+		struct io_uring_cqe *cqe;
+
+		if (io_uring_wait_cqe(gpudirect_uring, &cqe) != 0)
+			break;
+		io_uring_cqe_seen(gpudirect_uring, cqe);
+		ninflight--;
+	}
+	close(fdesc);
+	return retval;
+}
+#endif	/* WITH_LIBURING */
+
 /*
  * gpuDirectFileReadIOV
  */
@@ -572,6 +997,15 @@ gpuDirectFileReadIOV(const char *pathname,
 	/* fallback using regular filesystem */
 	if (!__gpuDirectAllocDMABufferOnDemand())
 		return false;
+#ifdef WITH_LIBURING
+	if (__gpuDirectSetupUring())
+		return __uringFileReadIOV(pathname,
+								  m_segment,
+								  m_offset,
+								  iovec,
+								  p_npages_direct_read,
+								  p_npages_vfs_read);
+#endif
 	return __fallbackFileReadIOV(pathname,
 								 m_segment,
 								 m_offset,
@@ -609,7 +1043,7 @@ gpuDirectFileReadAsyncIOV(const char *pathname,
 	switch (gpudirect_driver_kind)
 	{
 		case GPUDIRECT_DRIVER__CUFILE:
-			if (p_cufile__read_file_iov_v3)
+			if (p_cufile__read_file_async_iov_v3)
 				return (p_cufile__read_file_async_iov_v3(pathname,
 														 m_segment,
 														 m_offset,
@@ -618,6 +1052,13 @@ gpuDirectFileReadAsyncIOV(const char *pathname,
 														 p_error_code_async,
 														 p_npages_direct_read,
 														 p_npages_vfs_read) == 0);
+			if (p_cufile__read_file_iov_v3)
+				return (p_cufile__read_file_iov_v3(pathname,
+												   m_segment,
+												   m_offset,
+												   iovec,
+												   p_npages_direct_read,
+												   p_npages_vfs_read) == 0);
 			break;
 		case GPUDIRECT_DRIVER__NVME_STROM:
 			if (p_nvme_strom__read_file_iov)
@@ -650,6 +1091,15 @@ gpuDirectFileReadAsyncIOV(const char *pathname,
 	/* fallback using regular filesystem */
 	if (!__gpuDirectAllocDMABufferOnDemand())
 		return false;
+#ifdef WITH_LIBURING
+	if (__gpuDirectSetupUring())
+		return __uringFileReadIOV(pathname,
+								  m_segment,
+								  m_offset,
+								  iovec,
+								  p_npages_direct_read,
+								  p_npages_vfs_read);
+#endif
 	return __fallbackFileReadIOV(pathname,
 								 m_segment,
 								 m_offset,
@@ -699,8 +1149,30 @@ gpuDirectCleanUpOnThreadTerminate(void)
 {
 	CUresult	rc;
 
+#ifdef WITH_LIBURING
+	/* io_uring has the DMA buffer as fixed buffers */
+	if (gpudirect_uring)
+	{
+		io_uring_queue_exit(gpudirect_uring);
+		free(gpudirect_uring);
+		gpudirect_uring = NULL;
+	}
+#endif
 	/* release gpudirect_vfs_dma_buffer, if any */
-	if (gpudirect_vfs_dma_buffer)
+	if (gpudirect_vfs_dma_buffer_dindex >= 0)
+	{
+		gpuDirectDMABufferPool *pool
+			= &gpudirect_dma_pools[gpudirect_vfs_dma_buffer_dindex];
+
+		pthreadMutexLock(&pool->lock);
+		Assert(pool->nfree < pool->nitems);
+		pool->free_list[pool->nfree++] = gpudirect_vfs_dma_buffer;
+		pthreadMutexUnlock(&pool->lock);
+		gpudirect_vfs_dma_buffer = NULL;
+		gpudirect_vfs_dma_buffer_sz = 0UL;
+		gpudirect_vfs_dma_buffer_dindex = -1;
+	}
+	else if (gpudirect_vfs_dma_buffer)
 	{
 		rc = cuMemFreeHost(gpudirect_vfs_dma_buffer);
 		if (rc != CUDA_SUCCESS)
@@ -193,6 +193,21 @@ match_funcclause_to_indexcol(PlannerInfo *root,
 #define __POSTGIS		"@postgis"
 #define __GEOM			"geometry" __POSTGIS
 #define __BOX2D			"box2df" __POSTGIS
+#define __CUBE			"cube@cube"
+#define __EARTH			"earth@earthdistance"
+
+#define __CUBE_GIST_ENTRIES(GIST_KEY)									\
+	{ "cube_overlap@cube",   __CUBE, __CUBE, "cube_overlap@cube",  GIST_KEY, __CUBE }, \
+	{ "cube_contains@cube",  __CUBE, __CUBE, "cube_contains@cube", GIST_KEY, __CUBE }, \
+	{ "cube_contained@cube", __CUBE, __CUBE, "cube_overlap@cube",  GIST_KEY, __CUBE },
+/*
+ * NOTE: range '<@' is not here, because an empty leaf range is contained
+ * by any range, but its parent key may not overlap with the argument.
+ */
+#define __RANGE_GIST_ENTRIES(RANGE,ELEM)								\
+	{ "range_overlaps",      RANGE, RANGE, "range_overlaps",      RANGE, RANGE }, \
+	{ "range_contains",      RANGE, RANGE, "range_contains",      RANGE, RANGE }, \
+	{ "range_contains_elem", RANGE, ELEM,  "range_contains_elem", RANGE, ELEM },
 
 static struct {
 	/* geometry overlap operator */
@@ -254,6 +269,15 @@ static struct {
 		"is_contained_2d"   __POSTGIS, __BOX2D,  __GEOM,
 		"is_contained_2d"   __POSTGIS, __BOX2D, __BOX2D,
 	},
+	/* cube/earthdistance; internal keys are bounding boxes of the leaves */
+	__CUBE_GIST_ENTRIES(__CUBE)
+	__CUBE_GIST_ENTRIES(__EARTH)	/* index on ll_to_earth() */
+	/* range types; internal keys are union of the leaf ranges */
+	__RANGE_GIST_ENTRIES("int4range", "int4")
+	__RANGE_GIST_ENTRIES("int8range", "int8")
+	__RANGE_GIST_ENTRIES("daterange", "date")
+	__RANGE_GIST_ENTRIES("tsrange",   "timestamp")
+	__RANGE_GIST_ENTRIES("tstzrange", "timestamptz")
 	{ NULL, NULL, NULL, NULL, NULL, NULL },
 };
 
@@ -279,6 +303,49 @@ __get_func_signature(Oid func_oid)
 	return func_name;
 }
 
+/*
+ * __lookup_polymorphic_catalog_function
+ *
+ * built-in range operators are declared with anyrange/anyelement, so
+ * the exact signature lookup does not work for them.
+ */
+static Oid
+__lookup_polymorphic_catalog_function(const char *func_name,
+									  oidvector *func_argtypes)
+{
+	CatCList   *catlist;
+	Oid			func_oid = InvalidOid;
+
+	catlist = SearchSysCacheList1(PROCNAMEARGSNSP,
+								  CStringGetDatum(func_name));
+	for (int k=0; k < catlist->n_members; k++)
+	{
+		HeapTuple	htup = &catlist->members[k]->tuple;
+		Form_pg_proc proc = (Form_pg_proc) GETSTRUCT(htup);
+		int			j;
+
+		if (proc->pronamespace != PG_CATALOG_NAMESPACE ||
+			proc->pronargs != func_argtypes->dim1)
+			continue;
+		for (j=0; j < proc->pronargs; j++)
+		{
+			Oid		type_oid = proc->proargtypes.values[j];
+
+			if (type_oid != func_argtypes->values[j] &&
+				!IsPolymorphicType(type_oid))
+				break;
+		}
+		if (j == proc->pronargs)
+		{
+			func_oid = proc->oid;
+			break;
+		}
+	}
+	ReleaseSysCacheList(catlist);
+
+	return func_oid;
+}
+
 /*
  * fixup_gist_clause_for_device
  */
@@ -323,6 +390,9 @@ __lookup_gist_device_function(Oid opno, Oid left_oid, Oid right_oid, Oid gist_oi
 										   CStringGetDatum(func_name),
 										   PointerGetDatum(gist_argtypes),
 										   ObjectIdGetDatum(PG_CATALOG_NAMESPACE));
+				if (!OidIsValid(func_oid))
+					func_oid = __lookup_polymorphic_catalog_function(func_name,
+																	 gist_argtypes);
 			}
 			else
 			{
@@ -19,15 +19,25 @@
 #define GCACHE_CONTROL_CMD__APPLY_REDO		'A'
 #define GCACHE_CONTROL_CMD__COMPACTION		'C'
 #define GCACHE_CONTROL_CMD__DROP_UNLOAD		'D'
+#define GCACHE_CONTROL_CMD__CHECKPOINT		'K'
+#define GCACHE_CONTROL_CMD__RESTORE			'R'
 #define GCACHE_CONTROL_CMD__ERRORBUF_SIZE	120
 
+/*
+ * In-place compaction of the extra buffer is processed per segment; scans
+ * can run between segments, and staging buffer is at most one segment.
+ */
+#define GCACHE_COMPACTION_NSEGMENTS			16
+#define GCACHE_COMPACTION_SEGMENT_MINSZ		(64UL << 20)	/* 64MB */
+#define GCACHE_COMPACTION_SEGMENT_MAXSZ		(1UL << 30)		/* 1GB */
+
 typedef struct
 {
 	dlist_node	chain;
 	GpuCacheIdent ident;
 	Latch	   *backend;
 	int			command;	/* one of GCACHE_CONTROL_CMD__* */
-	uint64_t	end_pos;	/* for APPLY_REDO */
+	uint64_t	end_pos;	/* for APPLY_REDO, LSN for CHECKPOINT */
 	int			errcode;
 	char		errbuf[GCACHE_CONTROL_CMD__ERRORBUF_SIZE];
 } GpuCacheControlCommand;
@@ -55,15 +65,30 @@ typedef struct
 /*
  * GpuCacheOptions
  */
+#define GCACHE_FOR_ENCODING_MAX_ATTRS	16
+#define GCACHE_SKIPPED_ATTRS_NWORDS		((MaxHeapAttributeNumber + 63) / 64)
+
+typedef struct
+{
+	int16		attnum;
+	int16		unitsz;		/* 1, 2 or 4 */
+	int64		base;
+} GpuCacheForEncoding;
+
 typedef struct
 {
 	Oid			tg_sync_row;
-	int			cuda_dindex;
+	int			cuda_dindex;		/* primary GPU that applies REDO logs */
+	uint64_t	cuda_dmask;			/* mask of GPUs that keep replicas */
 	int32		gpu_sync_interval;
 	size_t		gpu_sync_threshold;
 	int64		max_num_rows;
 	int64		rowid_hash_nslots;
 	size_t		redo_buffer_size;
+	int32		for_nattrs;			/* frame-of-reference encoded columns */
+	GpuCacheForEncoding for_attrs[GCACHE_FOR_ENCODING_MAX_ATTRS];
+	/* bitmap of the columns not cached; zero-cleared if all the columns */
+	uint64_t	skipped_attrs[GCACHE_SKIPPED_ATTRS_NWORDS];
 } GpuCacheOptions;
 
 INLINE_FUNCTION(bool)
@@ -71,11 +96,37 @@ GpuCacheOptionsEqual(const GpuCacheOptions *a, const GpuCacheOptions *b)
 {
 	return (a->tg_sync_row        == b->tg_sync_row &&
 			a->cuda_dindex        == b->cuda_dindex &&
+			a->cuda_dmask         == b->cuda_dmask &&
 			a->gpu_sync_interval  == b->gpu_sync_interval &&
 			a->gpu_sync_threshold == b->gpu_sync_threshold &&
 			a->max_num_rows       == b->max_num_rows &&
 			a->rowid_hash_nslots  == b->rowid_hash_nslots &&
-			a->redo_buffer_size   == b->redo_buffer_size);
+			a->redo_buffer_size   == b->redo_buffer_size &&
+			a->for_nattrs         == b->for_nattrs &&
+			memcmp(a->for_attrs, b->for_attrs,
+				   sizeof(GpuCacheForEncoding) * a->for_nattrs) == 0 &&
+			memcmp(a->skipped_attrs, b->skipped_attrs,
+				   sizeof(a->skipped_attrs)) == 0);
+}
+
+static inline bool
+gpuCacheAttrIsCached(const GpuCacheOptions *gc_options, int attnum)
+{
+	int		k = attnum - 1;
+
+	Assert(attnum > 0 && attnum <= MaxHeapAttributeNumber);
+	return (gc_options->skipped_attrs[k / 64] & (1UL << (k % 64))) == 0;
+}
+
+static inline const GpuCacheForEncoding *
+lookupGpuCacheForEncoding(const GpuCacheOptions *gc_options, int attnum)
+{
+	for (int k=0; k < gc_options->for_nattrs; k++)
+	{
+		if (gc_options->for_attrs[k].attnum == attnum)
+			return &gc_options->for_attrs[k];
+	}
+	return NULL;
 }
 
 /*
@@ -127,6 +178,11 @@ typedef struct
 #define GCACHE_PHASE__IS_CORRUPTED		4	/* corrupted */
 	pg_atomic_uint32 phase;
 
+	/* status of the snapshot file */
+#define GCACHE_SNAPSHOT__NONE			0	/* no valid snapshot */
+#define GCACHE_SNAPSHOT__VALID			1	/* snapshot matches the cache */
+	pg_atomic_uint32 snapshot_state;
+
 	/* device memory allocation (just for information) */
 	pg_atomic_uint64 gcache_main_size;
 	pg_atomic_uint64 gcache_main_nitems;
@@ -139,14 +195,34 @@ typedef struct
 	uint32_t		rowid_next_free;
 	uint32_t		rowid_num_free;
 
-	/* redo buffer properties */
-	pthread_mutex_t	redo_mutex;
-	uint64_t		redo_write_timestamp;
-	uint64_t		redo_write_nitems;
-	uint64_t		redo_write_pos;
-	uint64_t		redo_read_nitems;
-	uint64_t		redo_read_pos;
-	uint64_t		redo_sync_pos;
+	/*
+	 * redo buffer properties
+	 *
+	 * Backends reserve a range of the REDO buffer by atomic increment of
+	 * the redo_write_pos, then copy the logs and commit them one by one
+	 * by setting the 'type' word at last. The GPU service consumes the
+	 * committed logs from the redo_read_pos, then clears the 'type' word.
+	 */
+	pg_atomic_uint64 redo_write_timestamp;
+	pg_atomic_uint64 redo_write_nitems;
+	pg_atomic_uint64 redo_write_pos;	/* reserved by writers */
+	uint64_t		redo_read_nitems;	/* only GPU service updates */
+	pg_atomic_uint64 redo_read_pos;
+	pg_atomic_uint64 redo_sync_pos;
+	pg_atomic_uint64 redo_pending_since;	/* write timestamp of the oldest
+											 * log not applied yet, or 0 */
+
+	/*
+	 * statistics (log2 histograms)
+	 *
+	 * The bucket-0 counts zero, and the bucket-k counts the values in the
+	 * range of [2^(k-1), 2^k). The last bucket also counts larger values.
+	 */
+#define GCACHE_STAT_NBUCKETS			32
+	pg_atomic_uint64 stat_apply_redo_us[GCACHE_STAT_NBUCKETS];
+	pg_atomic_uint64 stat_compaction_us[GCACHE_STAT_NBUCKETS];
+	pg_atomic_uint64 stat_redo_queue_sz[GCACHE_STAT_NBUCKETS];
+	pg_atomic_uint64 stat_visibility_us[GCACHE_STAT_NBUCKETS];
 
 	/* schema definitions (KDS_FORMAT_COLUMN) */
 	size_t			kds_extra_sz;
@@ -158,6 +234,47 @@ typedef struct
 			 ".gpucache_p%u_d%u_r%u.%09lx.buf",							\
 			 PostPortNumber, (datOid), (relOid), (signature))
 
+/*
+ * GpuCacheSnapshotHead
+ *
+ * Snapshot of the GpuCache image, written by pgstrom.gpucache_checkpoint().
+ * It allows to restore the GpuCache without the initial loading on restart.
+ * The file is removed once any REDO log is appended, so it is valid only
+ * if the table is not modified after the checkpoint.
+ *
+ * $PGDATA/pg_strom_gpucache/<database oid>_<table oid>.<signature>.snap
+ *
+ * +-----------------------+
+ * | GpuCacheSnapshotHead  |
+ * +-----------------------+
+ * | rowid hash slots      |  sizeof(uint32_t) * rowid_hash_nslots
+ * +-----------------------+
+ * | rowid items           |  sizeof(GpuCacheRowIdItem) * max_num_rows
+ * +-----------------------+
+ * | main kds image        |  main_length
+ * +-----------------------+
+ * | extra buffer image    |  extra_usage
+ * +-----------------------+
+ */
+#define GCACHE_SNAPSHOT_DIRNAME		"pg_strom_gpucache"
+#define GpuCacheSnapshotFileName(nameBuf,nameLen,datOid,relOid,signature) \
+	snprintf((nameBuf), (nameLen),										\
+			 "%s/%u_%u.%09lx.snap",										\
+			 GCACHE_SNAPSHOT_DIRNAME, (datOid), (relOid), (signature))
+
+typedef struct
+{
+	char			magic[8];	/* = "GCSnap01" */
+	GpuCacheIdent	ident;
+	GpuCacheOptions	gc_options;
+	uint64_t		checkpoint_lsn;	/* just for information */
+	uint32_t		rowid_next_free;
+	uint32_t		rowid_num_free;
+	uint64_t		main_length;
+	uint64_t		extra_usage;
+	uint64_t		extra_deadspace;
+} GpuCacheSnapshotHead;
+
 /*
  * GpuCacheRowIdItem
  */
@@ -174,6 +291,23 @@ gpuCacheRedoLogBuffer(GpuCacheSharedState *gc_sstate)
 	return (char *)gc_sstate + gc_sstate->redo_buffer_offset;
 }
 
+/*
+ * gpuCacheStatUpdate - increments a bucket of the log2 histogram
+ */
+static inline void
+gpuCacheStatUpdate(pg_atomic_uint64 *stat_hist, int64_t value)
+{
+	int		k = 0;
+
+	if (value > 0)
+	{
+		k = 64 - __builtin_clzl((uint64_t)value);
+		if (k >= GCACHE_STAT_NBUCKETS)
+			k = GCACHE_STAT_NBUCKETS - 1;
+	}
+	pg_atomic_fetch_add_u64(&stat_hist[k], 1);
+}
+
 INLINE_FUNCTION(uint32_t *)
 gpuCacheRowIdHashSlot(GpuCacheSharedState *gc_sstate)
 {
@@ -203,6 +337,12 @@ typedef struct
 	CUdeviceptr		gcache_extra_devptr;
 	ssize_t			gcache_main_size;
 	ssize_t			gcache_extra_size;
+	/* memory tiering; see __gpucacheRebalanceTiers */
+	pg_atomic_uint64 access_count;
+	uint64_t		access_score;
+	bool			tier_on_host;
+	CUdeviceptr		tier_main_devptr;
+	CUdeviceptr		tier_extra_devptr;
 } GpuCacheLocalMapping;
 
 /*
@@ -218,6 +358,7 @@ struct GpuCacheDesc
 	bool			drop_on_commit;
 	uint32_t		nitems;
 	StringInfoData	buf;	/* array of PendingCtidItem */
+	StringInfoData	redo_batch;	/* REDO logs not appended yet */
 };
 
 typedef struct
@@ -230,6 +371,10 @@ typedef struct
 /* --- static variables --- */
 static char	   *pgstrom_gpucache_auto_preload;		/* GUC */
 static bool		pgstrom_enable_gpucache;			/* GUC */
+static int		pgstrom_gpucache_log_batch_size;	/* GUC (kB) */
+static int		pgstrom_gpucache_initial_load_workers;	/* GUC */
+static bool		pgstrom_gpucache_merge_on_read;		/* GUC */
+static int		pgstrom_gpucache_device_memory_limit;	/* GUC (MB) */
 static GpuCacheSharedHead *gcache_shared_head = NULL;
 static HTAB	   *gcache_descriptors_htab = NULL;
 static HTAB	   *gcache_signatures_htab = NULL;
@@ -240,9 +385,20 @@ static object_access_hook_type object_access_next = NULL;
 /* --- function declarations --- */
 static void		__gpuCacheAppendLog(GpuCacheDesc *gc_desc,
 									GCacheTxLogCommon *tx_log);
+static void		__gpuCacheAppendLogBatch(GpuCacheDesc *gc_desc,
+										 const char *tx_logs,
+										 size_t tx_length);
+static void		__gpuCacheFlushLogBatch(GpuCacheDesc *gc_desc);
+static void		__gpuCacheInvokeBackgroundCommand(const GpuCacheIdent *ident,
+												  int cuda_dindex,
+												  bool is_async,
+												  int command,
+												  uint64 end_pos);
 static void		gpuCacheInvokeDropUnload(const GpuCacheDesc *gc_desc,
 										 bool is_async);
 void	gpuCacheStartupPreloader(Datum arg);
+PUBLIC_FUNCTION(void) gpuCacheInitialLoadWorkerMain(dsm_segment *seg,
+													shm_toc *toc);
 
 /*
  * gpucache_sync_trigger_function_oid
@@ -313,11 +469,15 @@ __parseSyncTriggerOptions(int elevel,
 						  GpuCacheOptions *gc_options)
 {
 	int			cuda_dindex = 0;				/* default: GPU0 */
+	uint64_t	cuda_dmask = 0;
 	int			gpu_sync_interval = 5000000L;	/* default: 5sec = 5000000us */
 	ssize_t		gpu_sync_threshold = -1;		/* default: auto */
 	int64		max_num_rows = (10UL << 20);	/* default: 10M rows */
 	int64		rowid_hash_nslots = -1;			/* default: auto */
 	ssize_t		redo_buffer_size = (160UL << 20);	/* default: 160MB */
+	int			for_nattrs = 0;
+	GpuCacheForEncoding for_attrs[GCACHE_FOR_ENCODING_MAX_ATTRS];
+	uint64_t	skipped_attrs[GCACHE_SKIPPED_ATTRS_NWORDS];
 	char	   *config;
 	char	   *key, *value;
 	char	   *saved;
@@ -325,6 +485,8 @@ __parseSyncTriggerOptions(int elevel,
 	size_t		extra_sz = 0;
 	int			unitsz;
 
+	memset(for_attrs, 0, sizeof(for_attrs));
+	memset(skipped_attrs, 0, sizeof(skipped_attrs));
 	if (!trigger_config)
 		goto out;
 	config = alloca(strlen(trigger_config) + 1);
@@ -347,28 +509,54 @@ __parseSyncTriggerOptions(int elevel,
 
 		if (strcmp(key, "gpu_device_id") == 0)
 		{
-			int		gpu_device_id;
-
-			gpu_device_id = __strtol(value);
-			if (errno != 0)
-			{
-				elog(elevel, "gpucache: invalid option [%s]=[%s] : %m", key, value);
-				return false;
-			}
+			/*
+			 * gpu_device_id=<primary> [<replica> ...]
+			 *
+			 * The first device is the primary one that applies REDO logs,
+			 * and the GpuCache is also replicated on the following devices.
+			 */
+			char   *tok, *pos;
 
 			cuda_dindex = -1;
-			for (int i=0; i < numGpuDevAttrs; i++)
+			cuda_dmask = 0;
+			for (tok = strtok_r(value, " ", &pos);
+				 tok != NULL;
+				 tok = strtok_r(NULL, " ", &pos))
 			{
-				if (gpuDevAttrs[i].DEV_ID == gpu_device_id)
+				int		gpu_device_id;
+				int		dindex = -1;
+
+				gpu_device_id = __strtol(tok);
+				if (errno != 0)
 				{
-					cuda_dindex = i;
-					break;
+					elog(elevel, "gpucache: invalid option [%s]=[%s] : %m", key, tok);
+					return false;
+				}
+				for (int i=0; i < numGpuDevAttrs; i++)
+				{
+					if (gpuDevAttrs[i].DEV_ID == gpu_device_id)
+					{
+						dindex = i;
+						break;
+					}
+				}
+				if (dindex < 0)
+				{
+					elog(elevel, "gpucache: gpu_device_id (%d) not found", gpu_device_id);
+					return false;
+				}
+				if (dindex >= 64)
+				{
+					elog(elevel, "gpucache: gpu_device_id (%d) cannot keep replica", gpu_device_id);
+					return false;
 				}
+				if (cuda_dindex < 0)
+					cuda_dindex = dindex;
+				cuda_dmask |= (1UL << dindex);
 			}
-
 			if (cuda_dindex < 0)
 			{
-				elog(elevel, "gpucache: gpu_device_id (%d) not found", gpu_device_id);
+				elog(elevel, "gpucache: gpu_device_id is empty");
 				return false;
 			}
 		}
@@ -409,6 +597,131 @@ __parseSyncTriggerOptions(int elevel,
 				return false;
 			}
 		}
+		else if (strcmp(key, "cached_columns") == 0)
+		{
+			/*
+			 * cached_columns=<attname> [...]
+			 *
+			 * Only the listed columns are kept on the GpuCache; queries
+			 * that reference other columns never use the GpuCache.
+			 */
+			char   *tok, *pos;
+
+			for (int j=0; j < pg_class->relnatts; j++)
+				skipped_attrs[j / 64] |= (1UL << (j % 64));
+			for (tok = strtok_r(value, " ", &pos);
+				 tok != NULL;
+				 tok = strtok_r(NULL, " ", &pos))
+			{
+				int		j;
+
+				for (j=0; j < pg_class->relnatts; j++)
+				{
+					if (!pg_attrs[j].attisdropped &&
+						strcmp(NameStr(pg_attrs[j].attname), tok) == 0)
+						break;
+				}
+				if (j >= pg_class->relnatts)
+				{
+					elog(elevel, "gpucache: column \"%s\" for cached_columns not found", tok);
+					return false;
+				}
+				skipped_attrs[j / 64] &= ~(1UL << (j % 64));
+			}
+		}
+		else if (strcmp(key, "for_encoding") == 0)
+		{
+			/*
+			 * for_encoding=<attname>:<width>[:<base>] [...]
+			 *
+			 * The integer column is stored as (value - base) using the
+			 * narrower signed integer of <width> bytes (1, 2 or 4).
+			 * Rows that have out-of-range values are rejected.
+			 */
+			char   *tok, *pos;
+
+			for (tok = strtok_r(value, " ", &pos);
+				 tok != NULL;
+				 tok = strtok_r(NULL, " ", &pos))
+			{
+				Form_pg_attribute attr = NULL;
+				GpuCacheForEncoding *fenc;
+				char   *attname = tok;
+				char   *width;
+				char   *base;
+
+				width = strchr(tok, ':');
+				if (!width)
+				{
+					elog(elevel, "gpucache: invalid option [%s]=[%s]", key, tok);
+					return false;
+				}
+				*width++ = '\0';
+				base = strchr(width, ':');
+				if (base)
+					*base++ = '\0';
+
+				for (int j=0; j < pg_class->relnatts; j++)
+				{
+					if (!pg_attrs[j].attisdropped &&
+						strcmp(NameStr(pg_attrs[j].attname), attname) == 0)
+					{
+						attr = &pg_attrs[j];
+						break;
+					}
+				}
+				if (!attr)
+				{
+					elog(elevel, "gpucache: column \"%s\" for for_encoding not found", attname);
+					return false;
+				}
+				if (attr->atttypid != INT2OID &&
+					attr->atttypid != INT4OID &&
+					attr->atttypid != INT8OID)
+				{
+					elog(elevel, "gpucache: for_encoding is not supported on column \"%s\" of type %s",
+						 attname, format_type_be(attr->atttypid));
+					return false;
+				}
+				for (int k=0; k < for_nattrs; k++)
+				{
+					if (for_attrs[k].attnum == attr->attnum)
+					{
+						elog(elevel, "gpucache: column \"%s\" appeared twice in for_encoding", attname);
+						return false;
+					}
+				}
+				if (for_nattrs >= GCACHE_FOR_ENCODING_MAX_ATTRS)
+				{
+					elog(elevel, "gpucache: too many columns in for_encoding (up to %d)",
+						 GCACHE_FOR_ENCODING_MAX_ATTRS);
+					return false;
+				}
+				fenc = &for_attrs[for_nattrs++];
+				fenc->attnum = attr->attnum;
+				fenc->unitsz = __strtol(width);
+				if (errno != 0 ||
+					(fenc->unitsz != 1 &&
+					 fenc->unitsz != 2 &&
+					 fenc->unitsz != 4) ||
+					fenc->unitsz >= attr->attlen)
+				{
+					elog(elevel, "gpucache: invalid for_encoding width [%s] on column \"%s\"",
+						 width, attname);
+					return false;
+				}
+				if (base)
+				{
+					fenc->base = __strtol(base);
+					if (errno != 0)
+					{
+						elog(elevel, "gpucache: invalid for_encoding base [%s] on column \"%s\"",
+							 base, attname);
+						return false;
+					}
+				}
+			}
+		}
 		else
 		{
 			elog(elevel, "gpucache: unknown option [%s]=[%s]", key, value);
@@ -416,6 +729,10 @@ __parseSyncTriggerOptions(int elevel,
 	}
 out:
 	/* default configuration (auto adjustment) */
+	if (cuda_dmask == 0 && cuda_dindex < 64)
+		cuda_dmask = (1UL << cuda_dindex);
+	/* REDO log entry header must not cross the end of buffer */
+	redo_buffer_size = TYPEALIGN_DOWN(MAXIMUM_ALIGNOF, redo_buffer_size);
 	if (gpu_sync_threshold < 0)
 		gpu_sync_threshold = redo_buffer_size / 4;
 	if (rowid_hash_nslots < 0)
@@ -446,17 +763,36 @@ out:
 		return false;
 	}
 
+	for (int k=0; k < for_nattrs; k++)
+	{
+		int		j = for_attrs[k].attnum - 1;
+
+		if ((skipped_attrs[j / 64] & (1UL << (j % 64))) != 0)
+		{
+			elog(elevel, "gpucache: column \"%s\" of for_encoding is not cached",
+				 NameStr(pg_attrs[j].attname));
+			return false;
+		}
+	}
+
 	/* check initial kds_column/kds_extra size */
 	for (int j=0; j < pg_class->relnatts; j++)
 	{
 		Form_pg_attribute attr = &pg_attrs[j];
 
+		if ((skipped_attrs[j / 64] & (1UL << (j % 64))) != 0)
+			continue;
 		if (!attr->attnotnull)
 			main_sz += MAXALIGN(BITMAPLEN(max_num_rows));
 		if (attr->attlen > 0)
 		{
 			unitsz = att_align_nominal(attr->attlen,
 									   attr->attalign);
+			for (int k=0; k < for_nattrs; k++)
+			{
+				if (for_attrs[k].attnum == attr->attnum)
+					unitsz = for_attrs[k].unitsz;
+			}
 			main_sz += MAXALIGN(unitsz * max_num_rows);
 		}
 		else if (attr->attlen == -1)
@@ -499,11 +835,15 @@ out:
 	{
 		gc_options->tg_sync_row = trigger_oid;
 		gc_options->cuda_dindex = cuda_dindex;
+		gc_options->cuda_dmask = cuda_dmask;
 		gc_options->gpu_sync_interval = gpu_sync_interval;
 		gc_options->gpu_sync_threshold = gpu_sync_threshold;
 		gc_options->max_num_rows = max_num_rows;
 		gc_options->rowid_hash_nslots = rowid_hash_nslots;
 		gc_options->redo_buffer_size  = redo_buffer_size;
+		gc_options->for_nattrs = for_nattrs;
+		memcpy(gc_options->for_attrs, for_attrs, sizeof(for_attrs));
+		memcpy(gc_options->skipped_attrs, skipped_attrs, sizeof(skipped_attrs));
 	}
 	return true;
 }
@@ -830,9 +1170,10 @@ static void
 __setup_kern_data_store_column(kern_data_store *kds_head,
 							   size_t *p_extra_sz,
 							   Relation rel,
-							   uint32_t nrooms)
+							   const GpuCacheOptions *gc_options)
 {
 	TupleDesc	tupdesc = RelationGetDescr(rel);
+	uint32_t	nrooms = gc_options->max_num_rows;
 	kern_colmeta *cmeta;
 	size_t		sz, off;
 	size_t		unitsz;
@@ -849,6 +1190,8 @@ __setup_kern_data_store_column(kern_data_store *kds_head,
 		Form_pg_attribute attr = TupleDescAttr(tupdesc, j);
 
 		cmeta = &kds_head->colmeta[j];
+		if (!gpuCacheAttrIsCached(gc_options, attr->attnum))
+			continue;	/* values_offset == 0 means not cached */
 		if (!attr->attnotnull)
 		{
 			sz = MAXALIGN(BITMAPLEN(nrooms));
@@ -859,8 +1202,18 @@ __setup_kern_data_store_column(kern_data_store *kds_head,
 
 		if (attr->attlen > 0)
 		{
+			const GpuCacheForEncoding *fenc
+				= lookupGpuCacheForEncoding(gc_options, attr->attnum);
+
 			unitsz = att_align_nominal(attr->attlen,
 									   attr->attalign);
+			if (fenc)
+			{
+				Assert(attr->attbyval && fenc->unitsz < attr->attlen);
+				unitsz = fenc->unitsz;
+				cmeta->for_unitsz = fenc->unitsz;
+				cmeta->for_base = fenc->base;
+			}
 			sz = MAXALIGN(unitsz * nrooms);
 			cmeta->values_offset = __kds_packed(off);
 			cmeta->values_length = __kds_packed(sz);
@@ -1038,6 +1391,7 @@ __openGpuCacheSharedState(Oid database_oid,
 	gc_lmap->gc_sstate = gc_sstate;
 	gc_lmap->mmap_sz = stat_buf.st_size;
 	pthreadRWLockInit(&gc_lmap->gcache_rwlock);
+	pg_atomic_init_u64(&gc_lmap->access_count, 0);
 	hslot = __gpuCacheSharedMappingHashSlot(database_oid,
 											table_oid,
 											signature);
@@ -1077,15 +1431,17 @@ __resetGpuCacheSharedState(GpuCacheSharedState *gc_sstate)
 	gc_sstate->rowid_num_free = rowid_nrooms;
 	pthreadMutexUnlock(&gc_sstate->rowid_mutex);
 
-	/* reset redo-log-buffer */
-	pthreadMutexLock(&gc_sstate->redo_mutex);
-	gc_sstate->redo_write_timestamp = GetCurrentTimestamp();
-	gc_sstate->redo_write_nitems = 0;
-    gc_sstate->redo_write_pos = 0;
-    gc_sstate->redo_read_nitems = 0;
-    gc_sstate->redo_read_pos = 0;
-    gc_sstate->redo_sync_pos = 0;
-	pthreadMutexUnlock(&gc_sstate->redo_mutex);
+	/* reset redo-log-buffer (no committed logs) */
+	memset(gpuCacheRedoLogBuffer(gc_sstate), 0,
+		   gc_sstate->gc_options.redo_buffer_size);
+	pg_atomic_write_u64(&gc_sstate->redo_write_timestamp, GetCurrentTimestamp());
+	pg_atomic_write_u64(&gc_sstate->redo_write_nitems, 0);
+	pg_atomic_write_u64(&gc_sstate->redo_write_pos, 0);
+	gc_sstate->redo_read_nitems = 0;
+	pg_atomic_write_u64(&gc_sstate->redo_read_pos, 0);
+	pg_atomic_write_u64(&gc_sstate->redo_sync_pos, 0);
+	pg_atomic_write_u64(&gc_sstate->redo_pending_since, 0);
+	pg_write_barrier();
 
 	/* initial buffer size should be legal */
 	Assert(gc_sstate->kds_head.length <= __KDS_LENGTH_LIMIT &&
@@ -1161,12 +1517,18 @@ __createGpuCacheSharedState(Relation rel,
 		gc_sstate->rowid_map_offset = rowid_map_offset;
 		gc_sstate->redo_buffer_offset = redo_buffer_offset;
 		memcpy(&gc_sstate->gc_options, gc_options, sizeof(GpuCacheOptions));
+		pg_atomic_init_u32(&gc_sstate->snapshot_state, GCACHE_SNAPSHOT__NONE);
 		pthreadMutexInitShared(&gc_sstate->rowid_mutex);
-		pthreadMutexInitShared(&gc_sstate->redo_mutex);
+		pg_atomic_init_u64(&gc_sstate->redo_write_timestamp, 0);
+		pg_atomic_init_u64(&gc_sstate->redo_write_nitems, 0);
+		pg_atomic_init_u64(&gc_sstate->redo_write_pos, 0);
+		pg_atomic_init_u64(&gc_sstate->redo_read_pos, 0);
+		pg_atomic_init_u64(&gc_sstate->redo_sync_pos, 0);
+		pg_atomic_init_u64(&gc_sstate->redo_pending_since, 0);
 		__setup_kern_data_store_column(&gc_sstate->kds_head,
 									   &gc_sstate->kds_extra_sz,
 									   rel,
-									   gc_options->max_num_rows);
+									   gc_options);
 		__resetGpuCacheSharedState(gc_sstate);
 
 		/* build GpuCacheLocalMapping */
@@ -1179,6 +1541,7 @@ __createGpuCacheSharedState(Relation rel,
 		gc_lmap->gc_sstate    = gc_sstate;
 		gc_lmap->mmap_sz      = mmap_sz;
 		pthreadRWLockInit(&gc_lmap->gcache_rwlock);
+		pg_atomic_init_u64(&gc_lmap->access_count, 0);
 
 		hslot = __gpuCacheSharedMappingHashSlot(MyDatabaseId,
 												RelationGetRelid(rel),
@@ -1551,6 +1914,7 @@ lookupGpuCacheDescNoLoad(Oid table_oid,
 			gc_desc->drop_on_commit = false;
 			gc_desc->nitems = 0;
 			memset(&gc_desc->buf, 0, sizeof(StringInfoData));
+			memset(&gc_desc->redo_batch, 0, sizeof(StringInfoData));
 		}
 		PG_CATCH();
 		{
@@ -1610,6 +1974,7 @@ lookupGpuCacheDesc(Relation rel)
 			gc_desc->drop_on_commit = false;
 			gc_desc->nitems = 0;
 			memset(&gc_desc->buf, 0, sizeof(StringInfoData));
+			memset(&gc_desc->redo_batch, 0, sizeof(StringInfoData));
 		}
 		PG_CATCH();
 		{
@@ -1631,6 +1996,9 @@ releaseGpuCacheDesc(GpuCacheDesc *gc_desc, bool normal_commit)
 	{
 		char	namebuf[MAXPGPATH];
 
+		/* pending REDO logs make no sense any more */
+		if (gc_desc->redo_batch.data)
+			resetStringInfo(&gc_desc->redo_batch);
 		/* unload from the server */
 		gpuCacheInvokeDropUnload(gc_desc, true);
 		/* unlink the shared memory segment */
@@ -1647,6 +2015,13 @@ releaseGpuCacheDesc(GpuCacheDesc *gc_desc, bool normal_commit)
 	{
 		const char *pos = gc_desc->buf.data;
 
+		/*
+		 * Pending REDO logs must be appended prior to the COMMIT/ABORT logs,
+		 * then these logs are also appended at once.
+		 */
+		__gpuCacheFlushLogBatch(gc_desc);
+		if (gc_desc->nitems > 0 && !gc_desc->redo_batch.data)
+			initStringInfoCxt(CacheMemoryContext, &gc_desc->redo_batch);
 		for (uint32_t i=0; i < gc_desc->nitems; i++)
 		{
 			PendingCtidItem	   *pitem = (PendingCtidItem *)pos;
@@ -1686,15 +2061,18 @@ releaseGpuCacheDesc(GpuCacheDesc *gc_desc, bool normal_commit)
 					 pitem->tag);
 				continue;
 			}
-			__gpuCacheAppendLog(gc_desc, (GCacheTxLogCommon *)&tx_log);
-
+			appendBinaryStringInfo(&gc_desc->redo_batch,
+								   (char *)&tx_log, tx_log.length);
 			pos += sizeof(PendingCtidItem);
 		}
+		__gpuCacheFlushLogBatch(gc_desc);
 		putGpuCacheLocalMapping(gc_desc->gc_lmap);
 	}
 	/* cleanup itself */
 	if (gc_desc->buf.data)
 		pfree(gc_desc->buf.data);
+	if (gc_desc->redo_batch.data)
+		pfree(gc_desc->redo_batch.data);
 	hash_search(gcache_descriptors_htab,
 				gc_desc, HASH_REMOVE, NULL);
 }
@@ -1955,6 +2333,58 @@ __makeFlattenHeapTuple(Relation rel, HeapTuple tuple)
 	return tuple;
 }
 
+/*
+ * __gpuCacheCheckForEncoding
+ *
+ * It ensures the values of frame-of-reference encoded columns fit the
+ * configured width, because GPU kernel cannot store them in the cache.
+ */
+static void
+__gpuCacheCheckForEncoding(Relation rel,
+						   const GpuCacheOptions *gc_options,
+						   HeapTuple tuple)
+{
+	TupleDesc	tupdesc = RelationGetDescr(rel);
+
+	for (int k=0; k < gc_options->for_nattrs; k++)
+	{
+		const GpuCacheForEncoding *fenc = &gc_options->for_attrs[k];
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, fenc->attnum-1);
+		int64		limit = (1L << (8 * fenc->unitsz - 1));
+		int64		ival;
+		int64		delta;
+		Datum		datum;
+		bool		isnull;
+
+		datum = heap_getattr(tuple, fenc->attnum, tupdesc, &isnull);
+		if (isnull)
+			continue;
+		switch (attr->atttypid)
+		{
+			case INT2OID:
+				ival = DatumGetInt16(datum);
+				break;
+			case INT4OID:
+				ival = DatumGetInt32(datum);
+				break;
+			case INT8OID:
+				ival = DatumGetInt64(datum);
+				break;
+			default:
+				elog(ERROR, "gpucache: for_encoding is not supported on type %s",
+					 format_type_be(attr->atttypid));
+		}
+		if (pg_sub_s64_overflow(ival, fenc->base, &delta) ||
+			delta < -limit || delta >= limit)
+			ereport(ERROR,
+					(errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
+					 errmsg("value %ld of column \"%s\" is out of range for GpuCache",
+							ival, NameStr(attr->attname)),
+					 errdetail("for_encoding accepts values between %ld and %ld.",
+							   fenc->base - limit, fenc->base + limit - 1)));
+	}
+}
+
 /*
  * __gpuCacheInitLoadTrackCtid
  */
@@ -1985,6 +2415,179 @@ __gpuCacheInitLoadTrackCtid(GpuCacheDesc *gc_desc,
 	gc_desc->nitems++;
 }
 
+/*
+ * Parallel initial loading
+ *
+ * If the loading backend has no transaction-id (so no tuples need to be
+ * tracked by __gpuCacheInitLoadTrackCtid), the heap is scanned by parallel
+ * workers, using parallel block table scan over the shared GpuCache segment.
+ * Each participant appends INSERT logs by large batches.
+ */
+#define GCACHE_INITLOAD_KEY_SHARED		1
+#define GCACHE_INITLOAD_KEY_PSCAN		2
+
+typedef struct
+{
+	Oid				table_oid;
+	uint64_t		signature;
+	GpuCacheOptions	gc_options;
+	pg_atomic_uint32 rowid_exhausted;
+	pg_atomic_uint64 nitems_loaded;
+} GpuCacheInitLoadShared;
+
+static void
+__initialLoadGpuCacheParticipant(Relation rel,
+								 GpuCacheInitLoadShared *shared,
+								 ParallelTableScanDesc pscan)
+{
+	GpuCacheDesc	gc_desc;
+	TableScanDesc	hscan;
+	HeapTuple		scantup;
+	HeapTuple		tuple;
+	StringInfoData	batch;
+	size_t			batch_sz = ((size_t)Max(pgstrom_gpucache_log_batch_size,
+											64) << 10);
+	uint64_t		nitems = 0;
+
+	memset(&gc_desc, 0, sizeof(GpuCacheDesc));
+	gc_desc.ident.database_oid = MyDatabaseId;
+	gc_desc.ident.table_oid = shared->table_oid;
+	gc_desc.ident.signature = shared->signature;
+	memcpy(&gc_desc.gc_options, &shared->gc_options, sizeof(GpuCacheOptions));
+	gc_desc.gc_lmap = getGpuCacheLocalMapping(rel, shared->signature,
+											  &gc_desc.gc_options);
+	initStringInfo(&batch);
+
+	hscan = table_beginscan_parallel(rel, pscan);
+	while ((scantup = heap_getnext(hscan, ForwardScanDirection)) != NULL)
+	{
+		GCacheTxLogInsert *item;
+		TransactionId	gcache_xmin;
+		TransactionId	gcache_xmax;
+		uint32_t		rowid;
+		size_t			sz;
+
+		CHECK_FOR_INTERRUPTS();
+
+		if (pg_atomic_read_u32(&shared->rowid_exhausted) != 0)
+			break;
+		if (!__initialLoadGpuCacheVisibilityCheck(scantup,
+												  &gcache_xmin,
+												  &gcache_xmax))
+			continue;
+		if (TransactionIdIsNormal(gcache_xmin) ||
+			TransactionIdIsNormal(gcache_xmax))
+			elog(ERROR, "Bug? parallel initial loading met a tuple to be tracked");
+
+		tuple = __makeFlattenHeapTuple(rel, scantup);
+		__gpuCacheCheckForEncoding(rel, &gc_desc.gc_options, tuple);
+		rowid = __allocGpuCacheRowId(gc_desc.gc_lmap, &tuple->t_self);
+		if (rowid == UINT_MAX)
+		{
+			pg_atomic_write_u32(&shared->rowid_exhausted, 1);
+			break;
+		}
+		sz = MAXALIGN(offsetof(GCacheTxLogInsert, htup) + tuple->t_len);
+		enlargeStringInfo(&batch, sz);
+		item = (GCacheTxLogInsert *)(batch.data + batch.len);
+		memset(item, 0, offsetof(GCacheTxLogInsert, htup));
+		item->type = GCACHE_TX_LOG__INSERT;
+		item->length = sz;
+		item->rowid = rowid;
+		memcpy(&item->htup, tuple->t_data, tuple->t_len);
+		memcpy(&item->htup.t_ctid, &tuple->t_self, sizeof(ItemPointerData));
+		HeapTupleHeaderSetXmin(&item->htup, gcache_xmin);
+		HeapTupleHeaderSetXmax(&item->htup, gcache_xmax);
+		HeapTupleHeaderSetCmin(&item->htup, InvalidCommandId);
+		batch.len += sz;
+		nitems++;
+
+		if (batch.len >= batch_sz)
+		{
+			__gpuCacheAppendLogBatch(&gc_desc, batch.data, batch.len);
+			resetStringInfo(&batch);
+		}
+		if (tuple != scantup)
+			pfree(tuple);
+	}
+	if (batch.len > 0)
+		__gpuCacheAppendLogBatch(&gc_desc, batch.data, batch.len);
+	table_endscan(hscan);
+	pfree(batch.data);
+	putGpuCacheLocalMapping(gc_desc.gc_lmap);
+
+	pg_atomic_fetch_add_u64(&shared->nitems_loaded, nitems);
+}
+
+/*
+ * gpuCacheInitialLoadWorkerMain - entrypoint of the parallel worker
+ */
+PUBLIC_FUNCTION(void)
+gpuCacheInitialLoadWorkerMain(dsm_segment *seg, shm_toc *toc)
+{
+	GpuCacheInitLoadShared *shared;
+	ParallelTableScanDesc pscan;
+	Relation	rel;
+
+	shared = shm_toc_lookup(toc, GCACHE_INITLOAD_KEY_SHARED, false);
+	pscan = shm_toc_lookup(toc, GCACHE_INITLOAD_KEY_PSCAN, false);
+	rel = table_open(shared->table_oid, AccessShareLock);
+	__initialLoadGpuCacheParticipant(rel, shared, pscan);
+	table_close(rel, AccessShareLock);
+}
+
+static bool
+__initialLoadGpuCacheParallel(GpuCacheDesc *gc_desc, Relation rel)
+{
+	ParallelContext *pcxt;
+	GpuCacheInitLoadShared *shared;
+	ParallelTableScanDesc pscan;
+	Size		pscan_sz;
+
+	if (pgstrom_gpucache_initial_load_workers <= 0 ||
+		IsParallelWorker() ||
+		TransactionIdIsValid(GetTopTransactionIdIfAny()) ||
+		RelationGetNumberOfBlocks(rel) < min_parallel_table_scan_size)
+		return false;
+
+	EnterParallelMode();
+	pcxt = CreateParallelContext("pg_strom",
+								 "gpuCacheInitialLoadWorkerMain",
+								 pgstrom_gpucache_initial_load_workers);
+	pscan_sz = table_parallelscan_estimate(rel, SnapshotAny);
+	shm_toc_estimate_chunk(&pcxt->estimator, sizeof(GpuCacheInitLoadShared));
+	shm_toc_estimate_chunk(&pcxt->estimator, pscan_sz);
+	shm_toc_estimate_keys(&pcxt->estimator, 2);
+	InitializeParallelDSM(pcxt);
+
+	shared = shm_toc_allocate(pcxt->toc, sizeof(GpuCacheInitLoadShared));
+	memset(shared, 0, sizeof(GpuCacheInitLoadShared));
+	shared->table_oid = RelationGetRelid(rel);
+	shared->signature = gc_desc->ident.signature;
+	memcpy(&shared->gc_options, &gc_desc->gc_options, sizeof(GpuCacheOptions));
+	pg_atomic_init_u32(&shared->rowid_exhausted, 0);
+	pg_atomic_init_u64(&shared->nitems_loaded, 0);
+	shm_toc_insert(pcxt->toc, GCACHE_INITLOAD_KEY_SHARED, shared);
+
+	pscan = shm_toc_allocate(pcxt->toc, pscan_sz);
+	table_parallelscan_initialize(rel, pscan, SnapshotAny);
+	shm_toc_insert(pcxt->toc, GCACHE_INITLOAD_KEY_PSCAN, pscan);
+
+	LaunchParallelWorkers(pcxt);
+	/* the leader also participates in the initial loading */
+	__initialLoadGpuCacheParticipant(rel, shared, pscan);
+	WaitForParallelWorkersToFinish(pcxt);
+
+	elog(DEBUG1, "gpucache: initial loading of '%s' by %d workers (nitems=%lu)",
+		 RelationGetRelationName(rel),
+		 pcxt->nworkers_launched,
+		 pg_atomic_read_u64(&shared->nitems_loaded));
+
+	DestroyParallelContext(pcxt);
+	ExitParallelMode();
+	return true;
+}
+
 /*
  * __initialLoadGpuCache - entrypoint of the initial loading
  */
@@ -1999,6 +2602,9 @@ __initialLoadGpuCache(GpuCacheDesc *gc_desc, Relation rel)
 
 	Assert(gc_desc->gc_lmap != NULL);
 
+	if (__initialLoadGpuCacheParallel(gc_desc, rel))
+		return;
+
 	hscan = table_beginscan(rel, SnapshotAny, 0, NULL);
 	while ((scantup = heap_getnext(hscan, ForwardScanDirection)) != NULL)
 	{
@@ -2015,6 +2621,7 @@ __initialLoadGpuCache(GpuCacheDesc *gc_desc, Relation rel)
 			continue;
 
 		tuple = __makeFlattenHeapTuple(rel, scantup);
+		__gpuCacheCheckForEncoding(rel, &gc_desc->gc_options, tuple);
 		sz = MAXALIGN(offsetof(GCacheTxLogInsert, htup) + tuple->t_len);
 		if (sz > item_sz)
 		{
@@ -2054,6 +2661,100 @@ __initialLoadGpuCache(GpuCacheDesc *gc_desc, Relation rel)
 	table_endscan(hscan);
 }
 
+/*
+ * __gpuCacheRestoreSnapshot
+ *
+ * It tries to restore GpuCache from the snapshot file, instead of the initial
+ * loading. The device buffer is loaded by the GPU service first, then the
+ * rowid-map is restored on the shared memory segment.
+ */
+static bool
+__gpuCacheRestoreSnapshot(GpuCacheDesc *gc_desc, Relation rel)
+{
+	GpuCacheSharedState *gc_sstate = gc_desc->gc_lmap->gc_sstate;
+	GpuCacheOptions *gc_options = &gc_sstate->gc_options;
+	GpuCacheSnapshotHead snap_head;
+	char		path[MAXPGPATH];
+	ssize_t		hslot_sz;
+	ssize_t		items_sz;
+	int			fdesc;
+
+	GpuCacheSnapshotFileName(path, MAXPGPATH,
+							 gc_desc->ident.database_oid,
+							 gc_desc->ident.table_oid,
+							 gc_desc->ident.signature);
+	fdesc = OpenTransientFile(path, O_RDONLY | PG_BINARY);
+	if (fdesc < 0)
+	{
+		if (errno != ENOENT)
+			elog(LOG, "gpucache: could not open snapshot \"%s\": %m", path);
+		return false;
+	}
+	if (__readFile(fdesc, &snap_head,
+				   sizeof(GpuCacheSnapshotHead)) != sizeof(GpuCacheSnapshotHead) ||
+		memcmp(snap_head.magic, "GCSnap01", 8) != 0 ||
+		!GpuCacheIdentEqual(&snap_head.ident, &gc_desc->ident) ||
+		!GpuCacheOptionsEqual(&snap_head.gc_options, gc_options) ||
+		snap_head.main_length != gc_sstate->kds_head.length)
+	{
+		CloseTransientFile(fdesc);
+		elog(LOG, "gpucache: snapshot \"%s\" does not match, so ignored", path);
+		return false;
+	}
+	/* load the device buffer by the GPU service */
+	__gpuCacheInvokeBackgroundCommand(&gc_desc->ident,
+									  gc_desc->gc_options.cuda_dindex,
+									  false,
+									  GCACHE_CONTROL_CMD__RESTORE,
+									  0);
+	if (pg_atomic_read_u32(&gc_sstate->snapshot_state) != GCACHE_SNAPSHOT__VALID)
+	{
+		CloseTransientFile(fdesc);
+		elog(LOG, "gpucache: unable to restore snapshot \"%s\", so ignored", path);
+		return false;
+	}
+	/* restore the rowid-map */
+	hslot_sz = sizeof(uint32_t) * gc_options->rowid_hash_nslots;
+	items_sz = sizeof(GpuCacheRowIdItem) * gc_options->max_num_rows;
+	pthreadMutexLock(&gc_sstate->rowid_mutex);
+	if (__readFile(fdesc, gpuCacheRowIdHashSlot(gc_sstate), hslot_sz) != hslot_sz ||
+		__readFile(fdesc, gpuCacheRowIdItemArray(gc_sstate), items_sz) != items_sz)
+	{
+		pthreadMutexUnlock(&gc_sstate->rowid_mutex);
+		elog(ERROR, "gpucache: failed to read snapshot \"%s\": %m", path);
+	}
+	gc_sstate->rowid_next_free = snap_head.rowid_next_free;
+	gc_sstate->rowid_num_free  = snap_head.rowid_num_free;
+	pthreadMutexUnlock(&gc_sstate->rowid_mutex);
+	CloseTransientFile(fdesc);
+
+	elog(LOG, "gpucache: table '%s' was restored from the snapshot at %X/%X",
+		 RelationGetRelationName(rel),
+		 LSN_FORMAT_ARGS(snap_head.checkpoint_lsn));
+	return true;
+}
+
+/*
+ * __gpuCacheInvalidateSnapshot
+ *
+ * The snapshot file must be removed durably prior to any modification of
+ * the table; elsewhere, a stale snapshot may be restored after crash.
+ */
+static void
+__gpuCacheInvalidateSnapshot(GpuCacheSharedState *gc_sstate)
+{
+	char		path[MAXPGPATH];
+
+	GpuCacheSnapshotFileName(path, MAXPGPATH,
+							 gc_sstate->ident.database_oid,
+							 gc_sstate->ident.table_oid,
+							 gc_sstate->ident.signature);
+	if (unlink(path) != 0 && errno != ENOENT)
+		elog(ERROR, "gpucache: could not remove snapshot \"%s\": %m", path);
+	fsync_fname(GCACHE_SNAPSHOT_DIRNAME, true);
+	pg_atomic_write_u32(&gc_sstate->snapshot_state, GCACHE_SNAPSHOT__NONE);
+}
+
 static bool
 initialLoadGpuCache(GpuCacheDesc *gc_desc, Relation rel)
 {
@@ -2079,7 +2780,8 @@ initialLoadGpuCache(GpuCacheDesc *gc_desc, Relation rel)
 		{
 			PG_TRY();
 			{
-				__initialLoadGpuCache(gc_desc, rel);
+				if (!__gpuCacheRestoreSnapshot(gc_desc, rel))
+					__initialLoadGpuCache(gc_desc, rel);
 			}
 			PG_CATCH();
 			{
@@ -2123,6 +2825,45 @@ initialLoadGpuCache(GpuCacheDesc *gc_desc, Relation rel)
  *
  * ------------------------------------------------------------
  */
+static bool
+__baseRelCoveredByGpuCache(RelOptInfo *baserel,
+						   const GpuCacheOptions *gc_options)
+{
+	Bitmapset  *referenced = NULL;
+	ListCell   *lc;
+	int			k;
+
+	pull_varattnos((Node *)baserel->reltarget->exprs,
+				   baserel->relid, &referenced);
+	foreach (lc, baserel->baserestrictinfo)
+	{
+		RestrictInfo   *rinfo = lfirst(lc);
+
+		pull_varattnos((Node *)rinfo->clause, baserel->relid, &referenced);
+	}
+	for (k = bms_next_member(referenced, -1);
+		 k >= 0;
+		 k = bms_next_member(referenced, k))
+	{
+		int		attnum = k + FirstLowInvalidHeapAttributeNumber;
+
+		if (attnum < 0)
+			continue;	/* system columns */
+		if (attnum == 0)
+		{
+			/* whole-row reference needs all the columns */
+			for (int i=0; i < GCACHE_SKIPPED_ATTRS_NWORDS; i++)
+			{
+				if (gc_options->skipped_attrs[i] != 0)
+					return false;
+			}
+		}
+		else if (!gpuCacheAttrIsCached(gc_options, attnum))
+			return false;
+	}
+	return true;
+}
+
 int
 baseRelHasGpuCache(PlannerInfo *root, RelOptInfo *baserel)
 {
@@ -2139,7 +2880,8 @@ baseRelHasGpuCache(PlannerInfo *root, RelOptInfo *baserel)
 
 		rel = table_open(rte->relid, NoLock);
 		signature = gpuCacheTableSignature(rel, &gc_options);
-		if (signature != 0UL)
+		if (signature != 0UL &&
+			__baseRelCoveredByGpuCache(baserel, &gc_options))
 		{
 			GpuCacheLocalMapping *gc_lmap;
 			uint32_t	phase;
@@ -2195,7 +2937,9 @@ __gpuCacheInvokeBackgroundCommand(const GpuCacheIdent *ident,
 	{
 		pthreadMutexUnlock(&gcache_shared_head->gcache_cmd_mutex);
 		CHECK_FOR_INTERRUPTS();
+		pgstat_report_wait_start(pgstrom_wait_event(PGSTROM_WAIT_EVENT__GPUCACHE_REDO));
 		pg_usleep(2000L);	/* 2ms */
+		pgstat_report_wait_end();
 		pthreadMutexLock(&gcache_shared_head->gcache_cmd_mutex);
 	}
 	dnode = dlist_pop_head_node(&gcache_shared_head->gcache_free_cmds);
@@ -2234,7 +2978,7 @@ __gpuCacheInvokeBackgroundCommand(const GpuCacheIdent *ident,
 							   WL_TIMEOUT |
 							   WL_POSTMASTER_DEATH,
 							   1000L,
-							   PG_WAIT_EXTENSION);
+							   pgstrom_wait_event(PGSTROM_WAIT_EVENT__GPUCACHE_REDO));
 				ResetLatch(MyLatch);
 				if (ev & WL_POSTMASTER_DEATH)
 					elog(FATAL, "unexpected postmaster dead");
@@ -2317,22 +3061,96 @@ gpuCacheInvokeDropUnload(const GpuCacheDesc *gc_desc, bool is_async)
 }
 
 /*
- * __gpuCacheAppendLog
+ * __gpuCacheAdvanceSyncPos
+ *
+ * It moves the redo_sync_pos forward, and returns true if the caller is
+ * responsible to kick the apply-redo.
  */
-static void
-__gpuCacheAppendLog(GpuCacheDesc *gc_desc, GCacheTxLogCommon *tx_log)
+static bool
+__gpuCacheAdvanceSyncPos(GpuCacheSharedState *gc_sstate, uint64_t sync_pos)
 {
-	GpuCacheSharedState *gc_sstate = gc_desc->gc_lmap->gc_sstate;
+	uint64_t	curr_pos = pg_atomic_read_u64(&gc_sstate->redo_sync_pos);
+
+	while (curr_pos < sync_pos)
+	{
+		if (pg_atomic_compare_exchange_u64(&gc_sstate->redo_sync_pos,
+										   &curr_pos, sync_pos))
+			return true;
+	}
+	return false;
+}
+
+/*
+ * __gpuCacheRedoBufferWrite
+ */
+static inline void
+__gpuCacheRedoBufferWrite(char *redo_buffer, size_t buffer_sz,
+						  uint64_t pos, const char *data, size_t length)
+{
+	while (length > 0)
+	{
+		size_t	offset = pos % buffer_sz;
+		size_t	nbytes = Min(length, buffer_sz - offset);
+
+		memcpy(redo_buffer + offset, data, nbytes);
+		pos += nbytes;
+		data += nbytes;
+		length -= nbytes;
+	}
+}
+
+/*
+ * __gpuCacheRedoBufferZero
+ *
+ * It clears the consumed range of the REDO log buffer. Not only the 'type'
+ * word of each log; any stale bytes of the previous lap could look like a
+ * committed log header, once a new log is reserved on them.
+ */
+static inline void
+__gpuCacheRedoBufferZero(char *redo_buffer, size_t buffer_sz,
+						 uint64_t pos, size_t length)
+{
+	while (length > 0)
+	{
+		size_t	offset = pos % buffer_sz;
+		size_t	nbytes = Min(length, buffer_sz - offset);
+
+		memset(redo_buffer + offset, 0, nbytes);
+		pos += nbytes;
+		length -= nbytes;
+	}
+}
+
+/*
+ * __gpuCacheAppendLogBatch
+ *
+ * It appends a series of REDO logs without any locks. The range of REDO
+ * buffer is reserved by compare-and-exchange on the redo_write_pos (so
+ * concurrent writers never overwrite the logs not consumed yet), then
+ * each log is committed by the 'type' word written after its body.
+ */
+static void
+__gpuCacheAppendLogBatch(GpuCacheDesc *gc_desc,
+						 const char *tx_logs, size_t tx_length)
+{
+	GpuCacheSharedState *gc_sstate = gc_desc->gc_lmap->gc_sstate;
 	char	   *redo_buffer = gpuCacheRedoLogBuffer(gc_sstate);
 	size_t		buffer_sz = gc_sstate->gc_options.redo_buffer_size;
-	bool		append_done = false;
+	size_t		sync_threshold = gc_sstate->gc_options.gpu_sync_threshold;
 
-	Assert(tx_log->length == MAXALIGN(tx_log->length));
-	while (!append_done)
+	/* the snapshot becomes stale once any REDO log is appended */
+	if (pg_atomic_read_u32(&gc_sstate->snapshot_state) != GCACHE_SNAPSHOT__NONE)
+		__gpuCacheInvalidateSnapshot(gc_sstate);
+
+	while (tx_length > 0)
 	{
+		uint64_t	read_pos;
+		uint64_t	write_pos;
+		uint64_t	sync_pos;
 		size_t		usage;
+		size_t		length = 0;
+		uint32_t	nitems = 0;
 		uint32_t	phase;
-		uint64_t	sync_pos;
 
 		/*
 		 * Once GPU buffer is marked to 'corrupted', any following REDO-logs
@@ -2344,55 +3162,138 @@ __gpuCacheAppendLog(GpuCacheDesc *gc_desc, GCacheTxLogCommon *tx_log)
 		Assert(phase == GCACHE_PHASE__IS_LOADING ||
 			   phase == GCACHE_PHASE__IS_READY);
 
-		pthreadMutexLock(&gc_sstate->redo_mutex);
-		Assert(gc_sstate->redo_write_pos >= gc_sstate->redo_read_pos &&
-			   gc_sstate->redo_write_pos <= gc_sstate->redo_read_pos + buffer_sz &&
-			   gc_sstate->redo_sync_pos <= gc_sstate->redo_write_pos);
-		usage = gc_sstate->redo_write_pos - gc_sstate->redo_read_pos;
+		/* read_pos should be fetched first, not to over-estimate the space */
+		read_pos = pg_atomic_read_u64(&gc_sstate->redo_read_pos);
+		write_pos = pg_atomic_read_u64(&gc_sstate->redo_write_pos);
+		Assert(write_pos >= read_pos && write_pos <= read_pos + buffer_sz);
+		usage = write_pos - read_pos;
 
-		/* buffer has enough space? */
-		if (usage + tx_log->length <= buffer_sz)
+		/* how many logs can be appended at once? */
+		while (length < tx_length)
 		{
-			const char *pos = (const char *)tx_log;
-			size_t		remain = tx_log->length;
-			size_t		offset;
-			size_t		nbytes;
+			const GCacheTxLogCommon *tx_log
+				= (const GCacheTxLogCommon *)(tx_logs + length);
+
+			Assert(tx_log->length == MAXALIGN(tx_log->length));
+			if (usage + length + tx_log->length > buffer_sz)
+				break;
+			length += tx_log->length;
+			nitems++;
+		}
 
-			while (remain > 0)
+		if (nitems == 0)
+		{
+			/*
+			 * REDO log buffer has no space, so apply the logs synchronously.
+			 * If someone already kicked it, just wait for a moment.
+			 */
+			if (__gpuCacheAdvanceSyncPos(gc_sstate, write_pos))
+				gpuCacheInvokeApplyRedo(gc_desc, write_pos, false);
+			else
 			{
-				offset = gc_sstate->redo_write_pos % buffer_sz;
-				if (offset + remain > buffer_sz)
-					nbytes = buffer_sz - offset;
-				else
-					nbytes = remain;
-				memcpy(redo_buffer + offset, pos, nbytes);
-				gc_sstate->redo_write_pos += nbytes;
-				pos += nbytes;
-				remain -= nbytes;
+				pgstat_report_wait_start(pgstrom_wait_event(PGSTROM_WAIT_EVENT__GPUCACHE_REDO));
+				pg_usleep(2000L);	/* 2ms */
+				pgstat_report_wait_end();
 			}
-			gc_sstate->redo_write_nitems++;
-			gc_sstate->redo_write_timestamp = GetCurrentTimestamp();
-			append_done = true;
+			continue;
 		}
-		/*
-		 * check whether the REDO log buffer usage exceeds the threshold of
-		 * the synchronization.
-		 */
-		if (gc_sstate->redo_write_pos >= (gc_sstate->redo_sync_pos +
-										  gc_sstate->gc_options.gpu_sync_threshold))
+		/* reserve the range; retry if concurrent writer got it */
+		if (!pg_atomic_compare_exchange_u64(&gc_sstate->redo_write_pos,
+											&write_pos, write_pos + length))
+			continue;
+		pg_atomic_fetch_add_u64(&gc_sstate->redo_write_nitems, nitems);
+
+		/* copy the REDO logs, then commit them one by one */
+		for (size_t off = 0; off < length; )
 		{
-			sync_pos = gc_sstate->redo_sync_pos = gc_sstate->redo_write_pos;
-			pthreadMutexUnlock(&gc_sstate->redo_mutex);
-			gpuCacheInvokeApplyRedo(gc_desc, sync_pos, append_done);
+			const GCacheTxLogCommon *tx_log
+				= (const GCacheTxLogCommon *)(tx_logs + off);
+			uint64_t	pos = write_pos + off;
+
+			__gpuCacheRedoBufferWrite(redo_buffer, buffer_sz,
+									  pos + sizeof(uint32_t),
+									  (const char *)tx_log + sizeof(uint32_t),
+									  tx_log->length - sizeof(uint32_t));
+			pg_write_barrier();
+			*((volatile uint32_t *)(redo_buffer + pos % buffer_sz)) = tx_log->type;
+			off += tx_log->length;
 		}
-		else
 		{
-			pthreadMutexUnlock(&gc_sstate->redo_mutex);
+			TimestampTz	now = GetCurrentTimestamp();
+			uint64_t	expected = 0;
+
+			pg_atomic_write_u64(&gc_sstate->redo_write_timestamp, now);
+			pg_atomic_compare_exchange_u64(&gc_sstate->redo_pending_since,
+										   &expected, now);
 		}
+		tx_logs += length;
+		tx_length -= length;
+		write_pos += length;
+
+		/*
+		 * check whether the REDO log buffer usage exceeds the threshold of
+		 * the synchronization.
+		 */
+		sync_pos = pg_atomic_read_u64(&gc_sstate->redo_sync_pos);
+		if (write_pos >= sync_pos + sync_threshold &&
+			__gpuCacheAdvanceSyncPos(gc_sstate, write_pos))
+			gpuCacheInvokeApplyRedo(gc_desc, write_pos, true);
+	}
+}
+
+/*
+ * __gpuCacheAppendLog
+ */
+static void
+__gpuCacheAppendLog(GpuCacheDesc *gc_desc, GCacheTxLogCommon *tx_log)
+{
+	__gpuCacheAppendLogBatch(gc_desc, (const char *)tx_log, tx_log->length);
+}
+
+/*
+ * __gpuCacheFlushLogBatch
+ */
+static void
+__gpuCacheFlushLogBatch(GpuCacheDesc *gc_desc)
+{
+	if (gc_desc->redo_batch.len > 0)
+	{
+		__gpuCacheAppendLogBatch(gc_desc,
+								 gc_desc->redo_batch.data,
+								 gc_desc->redo_batch.len);
+		resetStringInfo(&gc_desc->redo_batch);
+	}
+}
+
+/*
+ * __gpuCacheQueueLog
+ *
+ * The REDO logs written by the sync trigger are once accumulated on the
+ * per-backend batch buffer, then appended to the shared REDO buffer in bulk,
+ * to reduce the contention on the REDO buffer on bulk-loading.
+ * The batch is flushed when it exceeds pg_strom.gpucache_log_batch_size, at
+ * the beginning of GpuCache scan, and at the end of transaction.
+ */
+static void
+__gpuCacheQueueLog(GpuCacheDesc *gc_desc, GCacheTxLogCommon *tx_log)
+{
+	GpuCacheSharedState *gc_sstate = gc_desc->gc_lmap->gc_sstate;
 
-		if (!append_done)
-			pg_usleep(2000L);	/* 2ms */
+	/* must be invalidated prior to the commit, even if batched */
+	if (pg_atomic_read_u32(&gc_sstate->snapshot_state) != GCACHE_SNAPSHOT__NONE)
+		__gpuCacheInvalidateSnapshot(gc_sstate);
+	if (pgstrom_gpucache_log_batch_size <= 0)
+	{
+		__gpuCacheFlushLogBatch(gc_desc);
+		__gpuCacheAppendLog(gc_desc, tx_log);
+		return;
 	}
+	if (!gc_desc->redo_batch.data)
+		initStringInfoCxt(CacheMemoryContext, &gc_desc->redo_batch);
+	appendBinaryStringInfo(&gc_desc->redo_batch,
+						   (const char *)tx_log, tx_log->length);
+	if (gc_desc->redo_batch.len >= (size_t)pgstrom_gpucache_log_batch_size << 10)
+		__gpuCacheFlushLogBatch(gc_desc);
 }
 
 /*
@@ -2433,7 +3334,7 @@ __gpuCacheInsertLog(HeapTuple tuple, GpuCacheDesc *gc_desc)
 		HeapTupleHeaderSetXmax(&item->htup, InvalidTransactionId);
 		HeapTupleHeaderSetCmin(&item->htup, InvalidCommandId);
 
-		__gpuCacheAppendLog(gc_desc, (GCacheTxLogCommon *)item);
+		__gpuCacheQueueLog(gc_desc, (GCacheTxLogCommon *)item);
 	}
 	PG_CATCH();
 	{
@@ -2474,7 +3375,7 @@ __gpuCacheDeleteLog(HeapTuple tuple, GpuCacheDesc *gc_desc)
 	item.rowid = rowid;
 	memcpy(&item.ctid, &tuple->t_self, sizeof(ItemPointerData));
 
-	__gpuCacheAppendLog(gc_desc, (GCacheTxLogCommon *)&item);
+	__gpuCacheQueueLog(gc_desc, (GCacheTxLogCommon *)&item);
 }
 
 /*
@@ -2539,6 +3440,8 @@ pgstrom_gpucache_sync_trigger(PG_FUNCTION_ARGS)
 		{
 			tuple = __makeFlattenHeapTuple(trigdata->tg_relation,
 										   trigdata->tg_trigtuple);
+			__gpuCacheCheckForEncoding(trigdata->tg_relation,
+									   &gc_desc->gc_options, tuple);
 			__gpuCacheInsertLog(tuple, gc_desc);
 			if (tuple != trigdata->tg_trigtuple)
 				pfree(tuple);
@@ -2547,6 +3450,8 @@ pgstrom_gpucache_sync_trigger(PG_FUNCTION_ARGS)
 		{
 			tuple = __makeFlattenHeapTuple(trigdata->tg_relation,
 										   trigdata->tg_newtuple);
+			__gpuCacheCheckForEncoding(trigdata->tg_relation,
+									   &gc_desc->gc_options, tuple);
 
 			__gpuCacheDeleteLog(trigdata->tg_trigtuple, gc_desc);
 			__gpuCacheInsertLog(tuple, gc_desc);
@@ -2590,9 +3495,9 @@ pgstrom_gpucache_apply_redo(PG_FUNCTION_ARGS)
 		GpuCacheSharedState *gc_sstate = gc_desc->gc_lmap->gc_sstate;
 		uint64_t	sync_pos;
 
-		pthreadMutexLock(&gc_sstate->redo_mutex);
-		sync_pos = gc_sstate->redo_sync_pos = gc_sstate->redo_write_pos;
-		pthreadMutexUnlock(&gc_sstate->redo_mutex);
+		__gpuCacheFlushLogBatch(gc_desc);
+		sync_pos = pg_atomic_read_u64(&gc_sstate->redo_write_pos);
+		__gpuCacheAdvanceSyncPos(gc_sstate, sync_pos);
 
 		gpuCacheInvokeApplyRedo(gc_desc, sync_pos, false);
 	}
@@ -2623,6 +3528,47 @@ pgstrom_gpucache_compaction(PG_FUNCTION_ARGS)
 	PG_RETURN_VOID();
 }
 
+/*
+ * pgstrom_gpucache_checkpoint
+ */
+PG_FUNCTION_INFO_V1(pgstrom_gpucache_checkpoint);
+PUBLIC_FUNCTION(Datum)
+pgstrom_gpucache_checkpoint(PG_FUNCTION_ARGS)
+{
+	Oid			table_oid = PG_GETARG_OID(0);
+	Relation	rel;
+	GpuCacheDesc *gc_desc;
+
+	/* ShareLock waits for the concurrent writers, and blocks new ones */
+	rel = table_open(table_oid, ShareLock);
+	gc_desc = lookupGpuCacheDesc(rel);
+	if (gc_desc && initialLoadGpuCache(gc_desc, rel))
+	{
+		GpuCacheSharedState *gc_sstate = gc_desc->gc_lmap->gc_sstate;
+		uint64_t	sync_pos;
+
+		if (gc_desc->nitems > 0 || gc_desc->redo_batch.len > 0)
+			elog(ERROR, "gpucache: unable to checkpoint table '%s' modified by the current transaction",
+				 RelationGetRelationName(rel));
+		/* apply all the REDO logs */
+		sync_pos = pg_atomic_read_u64(&gc_sstate->redo_write_pos);
+		__gpuCacheAdvanceSyncPos(gc_sstate, sync_pos);
+		gpuCacheInvokeApplyRedo(gc_desc, sync_pos, false);
+
+		if (MakePGDirectory(GCACHE_SNAPSHOT_DIRNAME) != 0 && errno != EEXIST)
+			elog(ERROR, "could not create directory \"%s\": %m",
+				 GCACHE_SNAPSHOT_DIRNAME);
+		__gpuCacheInvokeBackgroundCommand(&gc_desc->ident,
+										  gc_desc->gc_options.cuda_dindex,
+										  false,
+										  GCACHE_CONTROL_CMD__CHECKPOINT,
+										  GetXLogInsertRecPtr());
+	}
+	table_close(rel, ShareLock);
+
+	PG_RETURN_VOID();
+}
+
 /*
  * pgstrom_gpucache_recovery
  */
@@ -2679,6 +3625,7 @@ GpuCacheDesc *
 pgstromGpuCacheExecInit(pgstromTaskState *pts)
 {
 	Relation	rel = pts->css.ss.ss_currentRelation;
+	GpuCacheDesc *gc_desc;
 	uint64_t	signature;
 	GpuCacheOptions gc_options;
 
@@ -2707,7 +3654,81 @@ pgstromGpuCacheExecInit(pgstromTaskState *pts)
 			 RelationGetRelationName(rel));
 		return NULL;
 	}
-	return lookupGpuCacheDesc(rel);
+	gc_desc = lookupGpuCacheDesc(rel);
+	/* REDO logs by the current transaction must be visible to the scan */
+	if (gc_desc && gc_desc->gc_lmap)
+		__gpuCacheFlushLogBatch(gc_desc);
+	return gc_desc;
+}
+
+/*
+ * pgstromGpuCacheOptimalGpus
+ *
+ * It returns the set of GPUs that keep the GpuCache (primary + replicas),
+ * so the scan can be distributed to any of them.
+ */
+const Bitmapset *
+pgstromGpuCacheOptimalGpus(GpuCacheDesc *gc_desc)
+{
+	GpuCacheOptions *gc_options = &gc_desc->gc_options;
+	Bitmapset  *gpuset = NULL;
+
+	for (int dindex=0; dindex < numGpuDevAttrs && dindex < 64; dindex++)
+	{
+		if ((gc_options->cuda_dmask & (1UL << dindex)) != 0)
+			gpuset = bms_add_member(gpuset, dindex);
+	}
+	if (bms_is_empty(gpuset))
+		gpuset = bms_make_singleton(gc_options->cuda_dindex);
+	return gpuset;
+}
+
+/*
+ * pgstromGpuCacheRedoSignature
+ *
+ * It appends the current position of the REDO log buffer, if all the logs
+ * until the position have been committed or aborted before the snapshot of
+ * the scan; so the same position tells us the scan will see the same rows.
+ * The timestamp of the last write is also appended because the recovery
+ * process resets the position to zero.
+ */
+bool
+pgstromGpuCacheRedoSignature(GpuCacheDesc *gc_desc,
+							 Snapshot snapshot,
+							 StringInfo buf)
+{
+	GpuCacheSharedState *gc_sstate;
+	uint64_t	write_pos;
+	uint64_t	write_timestamp;
+
+	if (!gc_desc || !gc_desc->gc_lmap)
+		return false;
+	gc_sstate = gc_desc->gc_lmap->gc_sstate;
+	if (pg_atomic_read_u32(&gc_sstate->phase) != GCACHE_PHASE__IS_READY)
+		return false;
+	/* the current transaction may rollback its own updates */
+	if (TransactionIdIsValid(GetTopTransactionIdIfAny()))
+		return false;
+	/* no concurrent transactions that may write REDO logs */
+	if (!snapshot ||
+		snapshot->xcnt > 0 ||
+		snapshot->subxcnt > 0 ||
+		snapshot->suboverflowed ||
+		!TransactionIdEquals(snapshot->xmin, snapshot->xmax))
+		return false;
+	write_timestamp = pg_atomic_read_u64(&gc_sstate->redo_write_timestamp);
+	pg_read_barrier();
+	write_pos = pg_atomic_read_u64(&gc_sstate->redo_write_pos);
+	pg_read_barrier();
+	/* writers must have a new xid after the snapshot */
+	if (!TransactionIdEquals(XidFromFullTransactionId(ReadNextFullTransactionId()),
+							 snapshot->xmax))
+		return false;
+	appendStringInfo(buf, "gpucache:%lu:%lu:%lu;",
+					 gc_desc->ident.signature,
+					 write_timestamp,
+					 write_pos);
+	return true;
 }
 
 XpuCommand *
@@ -2723,17 +3744,16 @@ pgstromScanChunkGpuCache(pgstromTaskState *pts,
 		elog(ERROR, "Bug? no GpuCacheDesc is assigned");
 	if (!initialLoadGpuCache(gc_desc, rel))
 		elog(ERROR, "GpuCache is now corrupted, try the query again");
+	__gpuCacheFlushLogBatch(gc_desc);
 	if (pg_atomic_fetch_add_u32(pts->gcache_fetch_count, 1) == 0)
 	{
 		GpuCacheSharedState *gc_sstate = gc_desc->gc_lmap->gc_sstate;
+		GpuCacheScanArgs *gc_args;
 		uint64_t	write_pos;
-		uint64_t	sync_pos = ULONG_MAX;
+		uint64_t	read_pos;
 
-		pthreadMutexLock(&gc_sstate->redo_mutex);
-		write_pos = gc_sstate->redo_write_pos;
-		if (gc_sstate->redo_sync_pos < gc_sstate->redo_write_pos)
-			sync_pos = gc_sstate->redo_sync_pos = gc_sstate->redo_write_pos;
-		pthreadMutexUnlock(&gc_sstate->redo_mutex);
+		write_pos = pg_atomic_read_u64(&gc_sstate->redo_write_pos);
+		read_pos  = pg_atomic_read_u64(&gc_sstate->redo_read_pos);
 
 		/* is the target table empty? */
 		if (write_pos == 0)
@@ -2741,9 +3761,25 @@ pgstromScanChunkGpuCache(pgstromTaskState *pts,
 			pts->scan_done = true;
 			return NULL;
 		}
-		/* force to apply pending REDO logs, if any */
-		if (sync_pos != ULONG_MAX)
+		xcmd = (XpuCommand *)pts->xcmd_buf.data;
+		gc_args = (GpuCacheScanArgs *)xcmd->u.task.data;
+		gc_args->merge_pos = 0;
+
+		if (pgstrom_gpucache_merge_on_read &&
+			write_pos - read_pos < gc_desc->gc_options.gpu_sync_threshold)
+		{
+			/*
+			 * Merge-on-read; GPU kernel merges the pending REDO logs with
+			 * the main store, so we don't wait for the apply-redo. Larger
+			 * pending logs shall be applied as usual, because the delta
+			 * is built for each scan.
+			 */
+			if (write_pos > read_pos)
+				gc_args->merge_pos = write_pos;
+		}
+		else if (__gpuCacheAdvanceSyncPos(gc_sstate, write_pos))
 		{
+			/* force to apply pending REDO logs */
 			/*
 			 * If REDO logs could not be applied correctly, GpuCache shall be
 			 * moved to 'corrupted' state during execution. This execution will
@@ -2751,9 +3787,8 @@ pgstromScanChunkGpuCache(pgstromTaskState *pts,
 			 * However, next execution (by retry) will use heap storage like
 			 * as a fallback.
 			 */
-			gpuCacheInvokeApplyRedo(gc_desc, sync_pos, true);
+			gpuCacheInvokeApplyRedo(gc_desc, write_pos, true);
 		}
-		xcmd = (XpuCommand *)pts->xcmd_buf.data;
 		Assert(xcmd->length == pts->xcmd_buf.len);
 		xcmd_iov->iov_base = pts->xcmd_buf.data;
 		xcmd_iov->iov_len  = pts->xcmd_buf.len;
@@ -2878,19 +3913,32 @@ pgstromGpuCacheExplain(pgstromTaskState *pts,
 
 	if (es->verbose)
 	{
-		int		gpu_device_id = -1;
+		char	gpu_device_ids[256];
+		int		off = 0;
 
+		gpu_device_ids[0] = '\0';
 		if (gc_options->cuda_dindex >= 0 &&
 			gc_options->cuda_dindex < numGpuDevAttrs)
-			gpu_device_id = gpuDevAttrs[gc_options->cuda_dindex].DEV_ID;
-
+			off += snprintf(gpu_device_ids, sizeof(gpu_device_ids), "%d",
+							gpuDevAttrs[gc_options->cuda_dindex].DEV_ID);
+		else
+			off += snprintf(gpu_device_ids, sizeof(gpu_device_ids), "-1");
+		for (int dindex=0; dindex < numGpuDevAttrs && dindex < 64; dindex++)
+		{
+			if (dindex == gc_options->cuda_dindex ||
+				(gc_options->cuda_dmask & (1UL << dindex)) == 0 ||
+				off >= sizeof(gpu_device_ids))
+				continue;
+			off += snprintf(gpu_device_ids + off, sizeof(gpu_device_ids) - off,
+							" %d", gpuDevAttrs[dindex].DEV_ID);
+		}
 		snprintf(temp, sizeof(temp),
-				 "gpu_device_id=%d,"
+				 "gpu_device_id=%s,"
 				 "max_num_rows=%ld,"
 				 "redo_buffer_size=%zu,"
 				 "gpu_sync_interval=%d,"
 				 "gpu_sync_threshold=%zu",
-				 gpu_device_id,
+				 gpu_device_ids,
 				 gc_options->max_num_rows,
 				 gc_options->redo_buffer_size,
 				 gc_options->gpu_sync_interval,
@@ -3321,6 +4369,244 @@ __gpucacheAllocDeviceMemory(GpuCacheLocalMapping *gc_lmap,
 	return 0;
 }
 
+/*
+ * __gpucacheRefreshReplicas
+ *
+ * When GpuCache is replicated on multiple GPUs, device buffers are marked
+ * as read-mostly, then the unified memory driver keeps read-only copies
+ * on the replica devices. REDO logs are applied by the primary device,
+ * so its writes invalidate the copies; we prefetch them again here, to
+ * avoid page-fault based migration on the next scan.
+ *
+ * NOTE: must be called under the exclusive lock of gcache_rwlock
+ */
+static void
+__gpucacheRefreshReplicas(GpuCacheLocalMapping *gc_lmap)
+{
+	GpuCacheOptions *gc_options = &gc_lmap->gc_sstate->gc_options;
+	CUdeviceptr	devptrs[2];
+	size_t		lengths[2];
+	CUresult	rc;
+
+	if ((gc_options->cuda_dmask & ~(1UL << gc_options->cuda_dindex)) == 0)
+		return;		/* no replicas */
+	devptrs[0] = gc_lmap->gcache_main_devptr;
+	lengths[0] = gc_lmap->gcache_main_size;
+	devptrs[1] = gc_lmap->gcache_extra_devptr;
+	lengths[1] = gc_lmap->gcache_extra_size;
+	for (int k=0; k < 2; k++)
+	{
+		if (devptrs[k] == 0UL || lengths[k] == 0)
+			continue;
+		rc = cuMemAdvise(devptrs[k], lengths[k],
+						 CU_MEM_ADVISE_SET_READ_MOSTLY, 0);
+		if (rc != CUDA_SUCCESS)
+		{
+			fprintf(stderr, "gpucache: failed on cuMemAdvise(READ_MOSTLY): %s\n",
+					cuStrError(rc));
+			return;
+		}
+		for (int dindex=0; dindex < numGpuDevAttrs && dindex < 64; dindex++)
+		{
+			CUdevice	cuda_device;
+
+			if ((gc_options->cuda_dmask & (1UL << dindex)) == 0)
+				continue;
+			rc = cuDeviceGet(&cuda_device, gpuDevAttrs[dindex].DEV_ID);
+			if (rc != CUDA_SUCCESS)
+				continue;
+			rc = cuMemAdvise(devptrs[k], lengths[k],
+							 CU_MEM_ADVISE_SET_ACCESSED_BY, cuda_device);
+			if (rc != CUDA_SUCCESS)
+				fprintf(stderr, "gpucache: failed on cuMemAdvise(ACCESSED_BY, GPU%d): %s\n",
+						dindex, cuStrError(rc));
+			if (dindex == gc_options->cuda_dindex)
+				continue;
+			rc = cuMemPrefetchAsync(devptrs[k], lengths[k],
+									cuda_device, CU_STREAM_LEGACY);
+			if (rc != CUDA_SUCCESS)
+				fprintf(stderr, "gpucache: failed on cuMemPrefetchAsync(GPU%d): %s\n",
+						dindex, cuStrError(rc));
+		}
+	}
+}
+
+/*
+ * __gpucacheRebalanceTiers
+ *
+ * GpuCache buffers are allocated on the unified memory, so it can be
+ * placed on the host memory, and GPU kernels can still scan them over
+ * the PCIe bus without page migration (ACCESSED_BY).
+ * If pg_strom.gpucache_device_memory_limit is configured, GpuCaches on
+ * this device are sorted by the access frequency (counted at
+ * gpuCacheGetDeviceBuffer, and decayed by half for each round), then the
+ * hot ones are kept on the device memory within the limit, and the cold
+ * ones are moved to the host memory. Replicated GpuCaches are always kept
+ * on the devices.
+ *
+ * NOTE: it is called by the GpuCache manager thread periodically.
+ */
+typedef struct
+{
+	GpuCacheLocalMapping *gc_lmap;
+	uint64_t	score;
+	size_t		length;
+} gpucacheTierItem;
+
+static int
+__gpucacheTierItemComp(const void *__a, const void *__b)
+{
+	const gpucacheTierItem *a = __a;
+	const gpucacheTierItem *b = __b;
+
+	if (a->score > b->score)
+		return -1;
+	if (a->score < b->score)
+		return 1;
+	return 0;
+}
+
+static void
+__gpucacheSetMemoryTier(GpuCacheLocalMapping *gc_lmap,
+						CUdevice cuda_device, bool on_host)
+{
+	CUdeviceptr	devptrs[2];
+	size_t		lengths[2];
+	CUdevice	location = (on_host ? CU_DEVICE_CPU : cuda_device);
+	CUresult	rc;
+
+	devptrs[0] = gc_lmap->gcache_main_devptr;
+	lengths[0] = gc_lmap->gcache_main_size;
+	devptrs[1] = gc_lmap->gcache_extra_devptr;
+	lengths[1] = gc_lmap->gcache_extra_size;
+	for (int k=0; k < 2; k++)
+	{
+		if (devptrs[k] == 0UL || lengths[k] == 0)
+			continue;
+		rc = cuMemAdvise(devptrs[k], lengths[k],
+						 CU_MEM_ADVISE_SET_PREFERRED_LOCATION, location);
+		if (rc != CUDA_SUCCESS)
+		{
+			fprintf(stderr, "gpucache: failed on cuMemAdvise(PREFERRED_LOCATION): %s\n",
+					cuStrError(rc));
+			return;
+		}
+		if (on_host)
+		{
+			rc = cuMemAdvise(devptrs[k], lengths[k],
+							 CU_MEM_ADVISE_SET_ACCESSED_BY, cuda_device);
+			if (rc != CUDA_SUCCESS)
+				fprintf(stderr, "gpucache: failed on cuMemAdvise(ACCESSED_BY): %s\n",
+						cuStrError(rc));
+		}
+		rc = cuMemPrefetchAsync(devptrs[k], lengths[k],
+								location, CU_STREAM_LEGACY);
+		if (rc != CUDA_SUCCESS)
+			fprintf(stderr, "gpucache: failed on cuMemPrefetchAsync: %s\n",
+					cuStrError(rc));
+	}
+	rc = cuStreamSynchronize(CU_STREAM_LEGACY);
+	if (rc != CUDA_SUCCESS)
+		fprintf(stderr, "gpucache: failed on cuStreamSynchronize: %s\n",
+				cuStrError(rc));
+	gc_lmap->tier_on_host = on_host;
+	gc_lmap->tier_main_devptr = gc_lmap->gcache_main_devptr;
+	gc_lmap->tier_extra_devptr = gc_lmap->gcache_extra_devptr;
+
+	fprintf(stderr, "gpucache on '%s' moved to the %s memory (main: %lu, extra: %lu)\n",
+			gc_lmap->gc_sstate->table_name,
+			on_host ? "host" : "device",
+			gc_lmap->gcache_main_size,
+			gc_lmap->gcache_extra_size);
+}
+
+static void
+__gpucacheRebalanceTiers(int cuda_dindex)
+{
+	gpucacheTierItem *items = NULL;
+	int			nitems = 0;
+	int			nrooms = 0;
+	size_t		limit;
+	size_t		total = 0;
+	CUdevice	cuda_device;
+
+	if (cuCtxGetDevice(&cuda_device) != CUDA_SUCCESS)
+		return;
+	if (pgstrom_gpucache_device_memory_limit > 0)
+		limit = (size_t)pgstrom_gpucache_device_memory_limit << 20;
+	else
+		limit = SIZE_MAX;
+
+	pthreadMutexLock(&gcache_shared_mapping_lock);
+	for (int i=0; i < GCACHE_SHARED_MAPPING_NSLOTS; i++)
+	{
+		dlist_iter	iter;
+
+		dlist_foreach (iter, &gcache_shared_mapping_slot[i])
+		{
+			GpuCacheLocalMapping *gc_lmap = dlist_container(GpuCacheLocalMapping,
+															 chain, iter.cur);
+			GpuCacheOptions *gc_options = &gc_lmap->gc_sstate->gc_options;
+
+			if (gc_lmap->gcache_main_devptr == 0UL ||
+				gc_options->cuda_dindex != cuda_dindex)
+				continue;
+			if (nitems >= nrooms)
+			{
+				gpucacheTierItem *__items;
+
+				nrooms = 2 * nrooms + 20;
+				__items = realloc(items, sizeof(gpucacheTierItem) * nrooms);
+				if (!__items)
+					break;
+				items = __items;
+			}
+			gc_lmap->access_score = (gc_lmap->access_score / 2 +
+									 pg_atomic_exchange_u64(&gc_lmap->access_count, 0));
+			gc_lmap->refcnt += 2;
+			items[nitems].gc_lmap = gc_lmap;
+			items[nitems].score   = gc_lmap->access_score;
+			items[nitems].length  = (gc_lmap->gcache_main_size +
+									 gc_lmap->gcache_extra_size);
+			/* replicated GpuCache is always on the device */
+			if ((gc_options->cuda_dmask & ~(1UL << cuda_dindex)) != 0)
+				items[nitems].score = UINT64_MAX;
+			nitems++;
+		}
+	}
+	pthreadMutexUnlock(&gcache_shared_mapping_lock);
+
+	if (nitems > 1)
+		qsort(items, nitems, sizeof(gpucacheTierItem),
+			  __gpucacheTierItemComp);
+	for (int i=0; i < nitems; i++)
+	{
+		GpuCacheLocalMapping *gc_lmap = items[i].gc_lmap;
+		bool		on_host;
+
+		if (items[i].score == UINT64_MAX || total + items[i].length <= limit)
+		{
+			on_host = false;
+			total += items[i].length;
+		}
+		else
+			on_host = true;
+		/* skip it if GpuCache is in-use, then retry on the next round */
+		if (pthread_rwlock_trywrlock(&gc_lmap->gcache_rwlock) == 0)
+		{
+			if (gc_lmap->gcache_main_devptr != 0UL &&
+				(gc_lmap->tier_on_host != on_host ||
+				 (on_host && (gc_lmap->tier_main_devptr != gc_lmap->gcache_main_devptr ||
+							  gc_lmap->tier_extra_devptr != gc_lmap->gcache_extra_devptr))))
+				__gpucacheSetMemoryTier(gc_lmap, cuda_device, on_host);
+			pthreadRWLockUnlock(&gc_lmap->gcache_rwlock);
+		}
+		putGpuCacheLocalMapping(gc_lmap);
+	}
+	if (items)
+		free(items);
+}
+
 /*
  * __gpucacheMarkAsCorrupted
  */
@@ -3375,6 +4661,7 @@ __gpucacheExecCompactionKernel(GpuCacheControlCommand *cmd,
 	GpuCacheSharedState *gc_sstate = gc_lmap->gc_sstate;
 	kern_data_extra *kds_extra;
 	CUdeviceptr	m_kds_extra = 0UL;
+	TimestampTz	t_start = GetCurrentTimestamp();
 	int			grid_sz, block_sz;
 	void	   *kern_args[4];
 	CUresult	rc;
@@ -3457,6 +4744,8 @@ retry:
 	gc_lmap->gcache_extra_devptr = m_kds_extra;
 	gc_lmap->gcache_extra_size   = gcache_extra_size;
 	pg_atomic_write_u64(&gc_sstate->gcache_extra_size, gcache_extra_size);
+	gpuCacheStatUpdate(gc_sstate->stat_compaction_us,
+					   GetCurrentTimestamp() - t_start);
 	return 0;
 
 bailout:
@@ -3465,17 +4754,175 @@ bailout:
 	return EIO;
 }
 
+/*
+ * __gpucacheExecCompactionInPlace
+ *
+ * It compacts the extra buffer segment by segment, using a staging buffer
+ * of one segment size, instead of a whole new extra buffer. If allow_yield,
+ * the exclusive lock is released between segments, so concurrent scans are
+ * not blocked during the entire compaction.
+ *
+ * NOTE: must be called under the exclusive lock of gcache_rwlock
+ */
 static int
-__gpucacheExecCompaction(GpuCacheControlCommand *cmd,
-						 CUfunction f_gcache_compaction)
+__gpucacheExecCompactionInPlace(GpuCacheControlCommand *cmd,
+								GpuCacheLocalMapping *gc_lmap,
+								CUfunction f_gcache_compaction_segment,
+								bool allow_yield)
 {
-	GpuCacheLocalMapping *gc_lmap;
-	int		status = 0;
+	GpuCacheSharedState *gc_sstate = gc_lmap->gc_sstate;
+	CUdeviceptr	m_kds_extra = gc_lmap->gcache_extra_devptr;
+	kern_data_extra *kds_extra = (kern_data_extra *)m_kds_extra;
+	kern_data_extra *extra_tmp = NULL;
+	CUdeviceptr	m_extra_tmp = 0UL;
+	size_t		extra_tmp_sz = 0;
+	uint64_t	seg_sz;
+	uint64_t	seg_head;
+	uint64_t	dst_base;
+	uint64_t	old_usage;
+	TimestampTz	t_start = GetCurrentTimestamp();
+	int			grid_sz, block_sz;
+	void	   *kern_args[7];
+	CUresult	rc;
+	int			status = EIO;
 
-	gc_lmap = getGpuCacheLocalMappingIfExist(cmd->ident.database_oid,
-											 cmd->ident.table_oid,
-											 cmd->ident.signature,
-											 false);
+	if (m_kds_extra == 0UL)
+		return 0;	/* nothing to do */
+	rc = gpuOptimalBlockSize(&grid_sz,
+							 &block_sz,
+							 f_gcache_compaction_segment, 0);
+	if (rc != CUDA_SUCCESS)
+	{
+		snprintf(cmd->errbuf, sizeof(cmd->errbuf),
+				 "failed on gpuOptimalBlockSize: %s", cuStrError(rc));
+		return EIO;
+	}
+	old_usage = kds_extra->usage;
+	seg_sz = old_usage / GCACHE_COMPACTION_NSEGMENTS;
+	seg_sz = Max(seg_sz, GCACHE_COMPACTION_SEGMENT_MINSZ);
+	seg_sz = Min(seg_sz, GCACHE_COMPACTION_SEGMENT_MAXSZ);
+
+	seg_head = dst_base = offsetof(kern_data_extra, data);
+	while (seg_head < kds_extra->usage)
+	{
+		/*
+		 * Values in [offsetof(data), dst_base) are already compacted, so
+		 * only values at dst_base or later shall be moved.
+		 */
+		uint64_t	__head = Max(seg_head, dst_base);
+		uint64_t	seg_tail = seg_head + seg_sz;
+		size_t		required;
+
+		for (int phase = 1; phase <= 2; phase++)
+		{
+			if (!extra_tmp || extra_tmp->usage > extra_tmp_sz)
+			{
+				size_t	sz = PAGE_ALIGN(extra_tmp ? extra_tmp->usage
+										: offsetof(kern_data_extra, data) + seg_sz);
+				if (m_extra_tmp != 0UL)
+					cuMemFree(m_extra_tmp);
+				rc = cuMemAllocManaged(&m_extra_tmp, sz,
+									   CU_MEM_ATTACH_GLOBAL);
+				if (rc != CUDA_SUCCESS)
+				{
+					snprintf(cmd->errbuf, sizeof(cmd->errbuf),
+							 "failed on cuMemAllocManaged: %s", cuStrError(rc));
+					m_extra_tmp = 0UL;
+					status = ENOMEM;
+					goto bailout;
+				}
+				extra_tmp = (kern_data_extra *)m_extra_tmp;
+				extra_tmp_sz = sz;
+			}
+			extra_tmp->length = extra_tmp_sz;
+			extra_tmp->usage = offsetof(kern_data_extra, data);
+			extra_tmp->deadspace = 0;
+
+			kern_args[0] = &gc_lmap->gcache_main_devptr;
+			kern_args[1] = &m_kds_extra;
+			kern_args[2] = &m_extra_tmp;
+			kern_args[3] = &__head;
+			kern_args[4] = &seg_tail;
+			kern_args[5] = &dst_base;
+			kern_args[6] = &phase;
+			rc = cuLaunchKernel(f_gcache_compaction_segment,
+								grid_sz, 1, 1,
+								block_sz, 1, 1,
+								0,
+								CU_STREAM_LEGACY,
+								kern_args,
+								NULL);
+			if (rc != CUDA_SUCCESS)
+			{
+				snprintf(cmd->errbuf, sizeof(cmd->errbuf),
+						 "failed on cuLaunchKernel: %s", cuStrError(rc));
+				goto bailout;
+			}
+			rc = cuStreamSynchronize(CU_STREAM_LEGACY);
+			if (rc != CUDA_SUCCESS)
+			{
+				snprintf(cmd->errbuf, sizeof(cmd->errbuf),
+						 "failed on cuStreamSynchronize: %s", cuStrError(rc));
+				goto bailout;
+			}
+			/* phase-1 may require larger staging buffer, for phase-2 */
+		}
+		/* write back the staging buffer to the final location */
+		required = extra_tmp->usage - offsetof(kern_data_extra, data);
+		if (required > 0)
+		{
+			rc = cuMemcpyDtoD(m_kds_extra + dst_base,
+							  m_extra_tmp + offsetof(kern_data_extra, data),
+							  required);
+			if (rc != CUDA_SUCCESS)
+			{
+				snprintf(cmd->errbuf, sizeof(cmd->errbuf),
+						 "failed on cuMemcpyDtoD: %s", cuStrError(rc));
+				goto bailout;
+			}
+			dst_base += required;
+		}
+		seg_head = seg_tail;
+
+		/* let the concurrent scans run */
+		if (allow_yield)
+		{
+			pthreadRWLockUnlock(&gc_lmap->gcache_rwlock);
+			pthreadRWLockWriteLock(&gc_lmap->gcache_rwlock);
+		}
+	}
+	kds_extra->usage = dst_base;
+	kds_extra->deadspace = 0;
+	pg_atomic_write_u64(&gc_sstate->gcache_extra_usage, kds_extra->usage);
+	pg_atomic_write_u64(&gc_sstate->gcache_extra_dead, kds_extra->deadspace);
+#if 1
+	fprintf(stderr, "%s: extra %p usage %lu --> %lu (staging %lu)\n",
+			__FUNCTION__,
+			(void *)m_kds_extra,
+			old_usage,
+			kds_extra->usage,
+			extra_tmp_sz);
+#endif
+	gpuCacheStatUpdate(gc_sstate->stat_compaction_us,
+					   GetCurrentTimestamp() - t_start);
+	status = 0;
+bailout:
+	if (m_extra_tmp != 0UL)
+		cuMemFree(m_extra_tmp);
+	return status;
+}
+
+static int
+__gpucacheExecCompaction(GpuCacheControlCommand *cmd,
+						 CUfunction f_gcache_compaction_segment)
+{
+	GpuCacheLocalMapping *gc_lmap;
+	int		status = 0;
+
+	gc_lmap = getGpuCacheLocalMappingIfExist(cmd->ident.database_oid,
+											 cmd->ident.table_oid,
+											 cmd->ident.signature,
+											 false);
 	if (!gc_lmap)
 	{
 		snprintf(cmd->errbuf, sizeof(cmd->errbuf),
@@ -3488,10 +4935,12 @@ __gpucacheExecCompaction(GpuCacheControlCommand *cmd,
 	pthreadRWLockWriteLock(&gc_lmap->gcache_rwlock);
 	if (gc_lmap->gcache_main_devptr != 0UL)
 	{
-		status = __gpucacheExecCompactionKernel(cmd,
-												gc_lmap,
-												f_gcache_compaction,
-												gc_lmap->gcache_extra_size);
+		status = __gpucacheExecCompactionInPlace(cmd,
+												 gc_lmap,
+												 f_gcache_compaction_segment,
+												 true);
+		if (status == 0)
+			__gpucacheRefreshReplicas(gc_lmap);
 	}
 	pthreadRWLockUnlock(&gc_lmap->gcache_rwlock);
 	return status;
@@ -3504,7 +4953,8 @@ static int
 __gpucacheExecApplyRedoKernel(GpuCacheControlCommand *cmd,
 							  GpuCacheLocalMapping *gc_lmap,
 							  CUfunction f_gcache_apply_redo,
-							  CUfunction f_gcache_compaction)
+							  CUfunction f_gcache_compaction,
+							  CUfunction f_gcache_compaction_segment)
 {
 	GpuCacheSharedState *gc_sstate = gc_lmap->gc_sstate;
 	char	   *redo_buf = gpuCacheRedoLogBuffer(gc_sstate);
@@ -3514,6 +4964,8 @@ __gpucacheExecApplyRedoKernel(GpuCacheControlCommand *cmd,
 	size_t		length;
 	size_t		offset;
 	char	   *pos, *end;
+	TimestampTz	t_start = GetCurrentTimestamp();
+	TimestampTz	t_pending;
 	int			grid_sz, block_sz;
 	void	   *kern_args[4];
 	kern_gpucache_redolog *gcache_redo;
@@ -3521,13 +4973,37 @@ __gpucacheExecApplyRedoKernel(GpuCacheControlCommand *cmd,
 	CUresult	rc;
 	int			status = EIO;
 
-	pthreadMutexLock(&gc_sstate->redo_mutex);
-	Assert(gc_sstate->redo_write_pos    >= gc_sstate->redo_read_pos &&
-		   gc_sstate->redo_write_nitems >= gc_sstate->redo_read_nitems);
-	head_pos = gc_sstate->redo_read_pos;
-	tail_pos = gc_sstate->redo_write_pos;
-	nitems  = (gc_sstate->redo_write_nitems - gc_sstate->redo_read_nitems);
-	pthreadMutexUnlock(&gc_sstate->redo_mutex);
+	/*
+	 * Pick up the committed REDO logs. The logs reserved prior to the
+	 * cmd->end_pos shall be committed soon, because writers never block
+	 * between reservation and commit, so we wait for them.
+	 */
+	head_pos = tail_pos = pg_atomic_read_u64(&gc_sstate->redo_read_pos);
+	nitems = 0;
+	while (tail_pos < pg_atomic_read_u64(&gc_sstate->redo_write_pos))
+	{
+		volatile GCacheTxLogCommon *tx_log = (volatile GCacheTxLogCommon *)
+			(redo_buf + tail_pos % redo_bufsz);
+
+		if ((tx_log->type & 0xffffff00U) != GCACHE_TX_LOG__MAGIC)
+		{
+			if (tail_pos >= cmd->end_pos)
+				break;
+			pg_usleep(10L);
+			continue;
+		}
+		pg_read_barrier();
+		if (tx_log->length < offsetof(GCacheTxLogCommon, data) ||
+			tx_log->length != MAXALIGN(tx_log->length))
+		{
+			snprintf(cmd->errbuf, sizeof(cmd->errbuf),
+					 "REDO log is corrupted at %lu (length=%u)",
+					 tail_pos, tx_log->length);
+			return EIO;
+		}
+		tail_pos += tx_log->length;
+		nitems++;
+	}
 
 	/* alloc kern_gpucache_redolog */
 	length = (MAXALIGN(offsetof(kern_gpucache_redolog,
@@ -3566,13 +5042,25 @@ __gpucacheExecApplyRedoKernel(GpuCacheControlCommand *cmd,
 	}
 	end = pos + length;
 
-	/* make advance the read position */
-	pthreadMutexLock(&gc_sstate->redo_mutex);
-	gc_sstate->redo_read_pos    += length;
+	/* clear the consumed logs, then make advance the read position */
+	__gpuCacheRedoBufferZero(redo_buf, redo_bufsz, head_pos, tail_pos - head_pos);
+	pg_write_barrier();
+	pg_atomic_write_u64(&gc_sstate->redo_read_pos, tail_pos);
 	gc_sstate->redo_read_nitems += nitems;
-	Assert(gc_sstate->redo_write_pos    >= gc_sstate->redo_read_pos &&
-		   gc_sstate->redo_write_nitems >= gc_sstate->redo_read_nitems);
-	pthreadMutexUnlock(&gc_sstate->redo_mutex);
+	gpuCacheStatUpdate(gc_sstate->stat_redo_queue_sz,
+					   pg_atomic_read_u64(&gc_sstate->redo_write_pos) - head_pos);
+	/*
+	 * The logs written after the tail_pos are still pending; a concurrent
+	 * writer may fail to set redo_pending_since, so we set it instead.
+	 */
+	t_pending = pg_atomic_exchange_u64(&gc_sstate->redo_pending_since, 0);
+	if (tail_pos < pg_atomic_read_u64(&gc_sstate->redo_write_pos))
+	{
+		uint64_t	expected = 0;
+
+		pg_atomic_compare_exchange_u64(&gc_sstate->redo_pending_since,
+									   &expected, t_start);
+	}
 
 	/* setup kern_gpucache_redolog index */
 	while (pos < end)
@@ -3631,6 +5119,16 @@ retry:
 		size_t		gcache_extra_size;
 		int			__status;
 
+		if (extra->deadspace > extra->length / 5)
+		{
+			/* enough dead space to be reclaimed without new allocation */
+			__status = __gpucacheExecCompactionInPlace(cmd,
+													   gc_lmap,
+													   f_gcache_compaction_segment,
+													   false);
+			if (__status == 0)
+				goto retry;
+		}
 		/* expand the extra buffer with 25% larger virtual space */
 		gcache_extra_size = PAGE_ALIGN((extra->length * 5) / 4);
 		__status = __gpucacheExecCompactionKernel(cmd,
@@ -3672,6 +5170,15 @@ retry:
 				pg_atomic_read_u64(&gc_sstate->gcache_extra_usage),
 				pg_atomic_read_u64(&gc_sstate->gcache_extra_dead));
 #endif
+		{
+			TimestampTz	t_end = GetCurrentTimestamp();
+
+			gpuCacheStatUpdate(gc_sstate->stat_apply_redo_us,
+							   t_end - t_start);
+			if (t_pending != 0)
+				gpuCacheStatUpdate(gc_sstate->stat_visibility_us,
+								   t_end - t_pending);
+		}
 		status = 0;		/* success */
 	}
 bailout:
@@ -3685,7 +5192,8 @@ bailout:
 static int
 __gpucacheExecApplyRedo(GpuCacheControlCommand *cmd,
 						CUfunction f_gcache_apply_redo,
-						CUfunction f_gcache_compaction)
+						CUfunction f_gcache_compaction,
+						CUfunction f_gcache_compaction_segment)
 {
 	GpuCacheLocalMapping *gc_lmap;
 	int		status = 0;
@@ -3715,7 +5223,10 @@ __gpucacheExecApplyRedo(GpuCacheControlCommand *cmd,
 	}
 	status = __gpucacheExecApplyRedoKernel(cmd, gc_lmap,
 										   f_gcache_apply_redo,
-										   f_gcache_compaction);
+										   f_gcache_compaction,
+										   f_gcache_compaction_segment);
+	if (status == 0)
+		__gpucacheRefreshReplicas(gc_lmap);
 bailout:
 	if (status)
 		__gpucacheMarkAsCorrupted(gc_lmap);
@@ -3724,6 +5235,286 @@ bailout:
 	return status;
 }
 
+/*
+ * GCACHE_CONTROL_CMD__CHECKPOINT
+ */
+static int
+__gpucacheWriteSnapshot(GpuCacheLocalMapping *gc_lmap,
+						uint64_t checkpoint_lsn,
+						char *errbuf, size_t errbuf_sz)
+{
+	GpuCacheSharedState *gc_sstate = gc_lmap->gc_sstate;
+	GpuCacheOptions *gc_options = &gc_sstate->gc_options;
+	kern_data_extra *kds_extra = (kern_data_extra *)gc_lmap->gcache_extra_devptr;
+	GpuCacheSnapshotHead snap_head;
+	char		path[MAXPGPATH];
+	char		temp[MAXPGPATH];
+	ssize_t		hslot_sz = sizeof(uint32_t) * gc_options->rowid_hash_nslots;
+	ssize_t		items_sz = sizeof(GpuCacheRowIdItem) * gc_options->max_num_rows;
+	int			fdesc;
+	int			dfd;
+
+	GpuCacheSnapshotFileName(path, MAXPGPATH,
+							 gc_sstate->ident.database_oid,
+							 gc_sstate->ident.table_oid,
+							 gc_sstate->ident.signature);
+	snprintf(temp, MAXPGPATH, "%s.tmp", path);
+	fdesc = open(temp, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	if (fdesc < 0)
+	{
+		snprintf(errbuf, errbuf_sz, "failed on open('%s'): %m", temp);
+		return EIO;
+	}
+	memset(&snap_head, 0, sizeof(GpuCacheSnapshotHead));
+	memcpy(snap_head.magic, "GCSnap01", 8);
+	memcpy(&snap_head.ident, &gc_sstate->ident, sizeof(GpuCacheIdent));
+	memcpy(&snap_head.gc_options, gc_options, sizeof(GpuCacheOptions));
+	snap_head.checkpoint_lsn = checkpoint_lsn;
+	snap_head.main_length = gc_lmap->gcache_main_size;
+	if (kds_extra)
+	{
+		snap_head.extra_usage = kds_extra->usage;
+		snap_head.extra_deadspace = kds_extra->deadspace;
+	}
+	pthreadMutexLock(&gc_sstate->rowid_mutex);
+	snap_head.rowid_next_free = gc_sstate->rowid_next_free;
+	snap_head.rowid_num_free  = gc_sstate->rowid_num_free;
+	if (__writeFile(fdesc, &snap_head,
+					sizeof(GpuCacheSnapshotHead)) != sizeof(GpuCacheSnapshotHead) ||
+		__writeFile(fdesc, gpuCacheRowIdHashSlot(gc_sstate), hslot_sz) != hslot_sz ||
+		__writeFile(fdesc, gpuCacheRowIdItemArray(gc_sstate), items_sz) != items_sz)
+	{
+		pthreadMutexUnlock(&gc_sstate->rowid_mutex);
+		snprintf(errbuf, errbuf_sz, "failed on write('%s'): %m", temp);
+		goto bailout;
+	}
+	pthreadMutexUnlock(&gc_sstate->rowid_mutex);
+	/* device buffers are managed memory, so host can read them directly */
+	if (__writeFile(fdesc, (void *)gc_lmap->gcache_main_devptr,
+					snap_head.main_length) != snap_head.main_length ||
+		(kds_extra && __writeFile(fdesc, kds_extra,
+								  snap_head.extra_usage) != snap_head.extra_usage))
+	{
+		snprintf(errbuf, errbuf_sz, "failed on write('%s'): %m", temp);
+		goto bailout;
+	}
+	if (fsync(fdesc) != 0)
+	{
+		snprintf(errbuf, errbuf_sz, "failed on fsync('%s'): %m", temp);
+		goto bailout;
+	}
+	close(fdesc);
+	if (rename(temp, path) != 0)
+	{
+		snprintf(errbuf, errbuf_sz, "failed on rename('%s','%s'): %m", temp, path);
+		unlink(temp);
+		return EIO;
+	}
+	dfd = open(GCACHE_SNAPSHOT_DIRNAME, O_RDONLY);
+	if (dfd >= 0)
+	{
+		fsync(dfd);
+		close(dfd);
+	}
+	pg_atomic_write_u32(&gc_sstate->snapshot_state, GCACHE_SNAPSHOT__VALID);
+	fprintf(stderr, "gpucache: snapshot of '%s' was written (main=%lu, extra=%lu)\n",
+			gc_sstate->table_name,
+			snap_head.main_length,
+			snap_head.extra_usage);
+	return 0;
+
+bailout:
+	close(fdesc);
+	unlink(temp);
+	return EIO;
+}
+
+static int
+__gpucacheExecCheckpoint(GpuCacheControlCommand *cmd)
+{
+	GpuCacheLocalMapping *gc_lmap;
+	int		status;
+
+	gc_lmap = getGpuCacheLocalMappingIfExist(cmd->ident.database_oid,
+											 cmd->ident.table_oid,
+											 cmd->ident.signature,
+											 false);
+	if (!gc_lmap)
+	{
+		snprintf(cmd->errbuf, sizeof(cmd->errbuf),
+				 "shared memory segment (dat=%u,rel=%u,sig=%09lx) not found",
+				 cmd->ident.database_oid,
+				 cmd->ident.table_oid,
+				 cmd->ident.signature);
+		return EEXIST;
+	}
+	pthreadRWLockReadLock(&gc_lmap->gcache_rwlock);
+	if (gc_lmap->gcache_main_devptr == 0UL)
+	{
+		snprintf(cmd->errbuf, sizeof(cmd->errbuf),
+				 "GpuCache of '%s' is not loaded on the device",
+				 gc_lmap->gc_sstate->table_name);
+		status = ENOENT;
+	}
+	else
+	{
+		status = __gpucacheWriteSnapshot(gc_lmap, cmd->end_pos,
+										 cmd->errbuf, sizeof(cmd->errbuf));
+	}
+	pthreadRWLockUnlock(&gc_lmap->gcache_rwlock);
+	putGpuCacheLocalMapping(gc_lmap);
+	return status;
+}
+
+/*
+ * GCACHE_CONTROL_CMD__RESTORE
+ *
+ * It loads the device buffer from the snapshot file. Even if it fails, it
+ * is not an error; the backend falls back to the initial loading.
+ *
+ * NOTE: must be called under the exclusive lock of gcache_rwlock
+ */
+static void
+__gpucacheLoadSnapshot(GpuCacheLocalMapping *gc_lmap)
+{
+	GpuCacheSharedState *gc_sstate = gc_lmap->gc_sstate;
+	GpuCacheOptions *gc_options = &gc_sstate->gc_options;
+	GpuCacheSnapshotHead snap_head;
+	kern_data_extra *kds_extra;
+	char		path[MAXPGPATH];
+	char		errbuf[200];
+	off_t		f_pos;
+	int			fdesc;
+	CUresult	rc;
+
+	GpuCacheSnapshotFileName(path, MAXPGPATH,
+							 gc_sstate->ident.database_oid,
+							 gc_sstate->ident.table_oid,
+							 gc_sstate->ident.signature);
+	fdesc = open(path, O_RDONLY);
+	if (fdesc < 0)
+	{
+		snprintf(errbuf, sizeof(errbuf), "failed on open: %m");
+		goto bailout;
+	}
+	if (__readFile(fdesc, &snap_head,
+				   sizeof(GpuCacheSnapshotHead)) != sizeof(GpuCacheSnapshotHead) ||
+		memcmp(snap_head.magic, "GCSnap01", 8) != 0 ||
+		!GpuCacheIdentEqual(&snap_head.ident, &gc_sstate->ident))
+	{
+		snprintf(errbuf, sizeof(errbuf), "snapshot header mismatch");
+		goto bailout;
+	}
+	/* release the current device buffers, if any */
+	if (gc_lmap->gcache_main_devptr != 0UL)
+		cuMemFree(gc_lmap->gcache_main_devptr);
+	if (gc_lmap->gcache_extra_devptr != 0UL)
+		cuMemFree(gc_lmap->gcache_extra_devptr);
+	gc_lmap->gcache_main_devptr = 0UL;
+	gc_lmap->gcache_extra_devptr = 0UL;
+	if (__gpucacheAllocDeviceMemory(gc_lmap, errbuf, sizeof(errbuf)) != 0)
+		goto bailout;
+	if (snap_head.main_length != gc_lmap->gcache_main_size)
+	{
+		snprintf(errbuf, sizeof(errbuf), "main buffer size mismatch");
+		goto bailout;
+	}
+	/* expand the extra buffer, if snapshot is larger */
+	if (snap_head.extra_usage > gc_lmap->gcache_extra_size)
+	{
+		size_t	gcache_extra_size = PAGE_ALIGN(snap_head.extra_usage * 5 / 4);
+
+		if (gc_lmap->gcache_extra_devptr != 0UL)
+			cuMemFree(gc_lmap->gcache_extra_devptr);
+		gc_lmap->gcache_extra_devptr = 0UL;
+		rc = cuMemAllocManaged(&gc_lmap->gcache_extra_devptr,
+							   gcache_extra_size,
+							   CU_MEM_ATTACH_GLOBAL);
+		if (rc != CUDA_SUCCESS)
+		{
+			gc_lmap->gcache_extra_devptr = 0UL;
+			snprintf(errbuf, sizeof(errbuf),
+					 "failed on cuMemAllocManaged: %s", cuStrError(rc));
+			goto bailout;
+		}
+		gc_lmap->gcache_extra_size = gcache_extra_size;
+		pg_atomic_write_u64(&gc_sstate->gcache_extra_size, gcache_extra_size);
+	}
+	/* read the device images, next to the rowid-map */
+	f_pos = (sizeof(GpuCacheSnapshotHead) +
+			 sizeof(uint32_t) * gc_options->rowid_hash_nslots +
+			 sizeof(GpuCacheRowIdItem) * gc_options->max_num_rows);
+	if (__preadFile(fdesc, (void *)gc_lmap->gcache_main_devptr,
+					snap_head.main_length, f_pos) != snap_head.main_length)
+	{
+		snprintf(errbuf, sizeof(errbuf), "failed on read: %m");
+		goto bailout;
+	}
+	f_pos += snap_head.main_length;
+	kds_extra = (kern_data_extra *)gc_lmap->gcache_extra_devptr;
+	if (snap_head.extra_usage > 0)
+	{
+		if (!kds_extra ||
+			__preadFile(fdesc, kds_extra,
+						snap_head.extra_usage, f_pos) != snap_head.extra_usage)
+		{
+			snprintf(errbuf, sizeof(errbuf), "failed on read: %m");
+			goto bailout;
+		}
+		kds_extra->length    = gc_lmap->gcache_extra_size;
+		kds_extra->usage     = snap_head.extra_usage;
+		kds_extra->deadspace = snap_head.extra_deadspace;
+		pg_atomic_write_u64(&gc_sstate->gcache_extra_usage, kds_extra->usage);
+		pg_atomic_write_u64(&gc_sstate->gcache_extra_dead, kds_extra->deadspace);
+	}
+	close(fdesc);
+	pg_atomic_write_u64(&gc_sstate->gcache_main_nitems,
+						((kern_data_store *)gc_lmap->gcache_main_devptr)->nitems);
+	__gpucacheRefreshReplicas(gc_lmap);
+	pg_atomic_write_u32(&gc_sstate->snapshot_state, GCACHE_SNAPSHOT__VALID);
+	return;
+
+bailout:
+	fprintf(stderr, "gpucache: unable to restore snapshot '%s': %s\n",
+			path, errbuf);
+	if (fdesc >= 0)
+		close(fdesc);
+	if (gc_lmap->gcache_main_devptr != 0UL)
+		cuMemFree(gc_lmap->gcache_main_devptr);
+	if (gc_lmap->gcache_extra_devptr != 0UL)
+		cuMemFree(gc_lmap->gcache_extra_devptr);
+	gc_lmap->gcache_main_devptr = 0UL;
+	gc_lmap->gcache_main_size = 0;
+	gc_lmap->gcache_extra_devptr = 0UL;
+	gc_lmap->gcache_extra_size = 0;
+	pg_atomic_write_u32(&gc_sstate->snapshot_state, GCACHE_SNAPSHOT__NONE);
+}
+
+static int
+__gpucacheExecRestore(GpuCacheControlCommand *cmd)
+{
+	GpuCacheLocalMapping *gc_lmap;
+
+	gc_lmap = getGpuCacheLocalMappingIfExist(cmd->ident.database_oid,
+											 cmd->ident.table_oid,
+											 cmd->ident.signature,
+											 false);
+	if (!gc_lmap)
+	{
+		snprintf(cmd->errbuf, sizeof(cmd->errbuf),
+				 "shared memory segment (dat=%u,rel=%u,sig=%09lx) not found",
+				 cmd->ident.database_oid,
+				 cmd->ident.table_oid,
+				 cmd->ident.signature);
+		return EEXIST;
+	}
+	pthreadRWLockWriteLock(&gc_lmap->gcache_rwlock);
+	__gpucacheLoadSnapshot(gc_lmap);
+	pthreadRWLockUnlock(&gc_lmap->gcache_rwlock);
+	putGpuCacheLocalMapping(gc_lmap);
+	return 0;
+}
+
 /*
  * GCACHE_CONTROL_CMD__DROP_UNLOAD
  */
@@ -3745,6 +5536,18 @@ __gpucacheExecDropUnload(GpuCacheControlCommand *cmd)
 				 cmd->ident.signature);
 		return EEXIST;
 	}
+	/* snapshot also makes no sense any more */
+	{
+		char	path[MAXPGPATH];
+
+		GpuCacheSnapshotFileName(path, MAXPGPATH,
+								 cmd->ident.database_oid,
+								 cmd->ident.table_oid,
+								 cmd->ident.signature);
+		unlink(path);
+		pg_atomic_write_u32(&gc_lmap->gc_sstate->snapshot_state,
+							GCACHE_SNAPSHOT__NONE);
+	}
 	pthreadMutexLock(&gcache_shared_mapping_lock);
 	gc_lmap->refcnt &= 0xfffffffeU;
 	__putGpuCacheLocalMappingNoLock(gc_lmap);
@@ -3765,6 +5568,8 @@ gpucacheManagerEventLoop(int cuda_dindex,
 	dlist_head	   *cmd_queue = &gcache_shared_head->gpus[cuda_dindex].queue;
 	CUfunction		f_gcache_apply_redo;
 	CUfunction		f_gcache_compaction;
+	CUfunction		f_gcache_compaction_segment;
+	uint64_t		nvtx_range = 0;
 	CUresult		rc;
 	GpuCacheControlCommand *cmd;
 
@@ -3784,6 +5589,14 @@ gpucacheManagerEventLoop(int cuda_dindex,
 		fprintf(stderr, "gpucache: unable to lookup gpucache_compaction\n");
 		return;
 	}
+	rc = cuModuleGetFunction(&f_gcache_compaction_segment,
+							 cuda_module,
+							 "kern_gpucache_compaction_segment");
+	if (rc != CUDA_SUCCESS)
+	{
+		fprintf(stderr, "gpucache: unable to lookup gpucache_compaction_segment\n");
+		return;
+	}
 	
 	pthreadMutexLock(cmd_mutex);
 	while (!gpuServiceGoingTerminate())
@@ -3794,7 +5607,10 @@ gpucacheManagerEventLoop(int cuda_dindex,
 		{
 			if (!pthreadCondWaitTimeout(cmd_cond, cmd_mutex, 5000L))
 			{
-				/* timeout -> add some maintenance work here*/
+				/* timeout -> memory tiering of GpuCaches */
+				pthreadMutexUnlock(cmd_mutex);
+				__gpucacheRebalanceTiers(cuda_dindex);
+				pthreadMutexLock(cmd_mutex);
 			}
 			continue;
 		}
@@ -3805,19 +5621,34 @@ gpucacheManagerEventLoop(int cuda_dindex,
 		memset(&cmd->chain, 0, sizeof(dlist_node));
 		pthreadMutexUnlock(cmd_mutex);
 
+		pgstromNvtxRangeStart(&nvtx_range, "GpuCache %s (dat=%u,rel=%u)",
+							  cmd->command == GCACHE_CONTROL_CMD__APPLY_REDO ? "Apply Redo" :
+							  cmd->command == GCACHE_CONTROL_CMD__COMPACTION ? "Compaction" :
+							  cmd->command == GCACHE_CONTROL_CMD__DROP_UNLOAD ? "Drop/Unload" :
+							  cmd->command == GCACHE_CONTROL_CMD__CHECKPOINT ? "Checkpoint" :
+							  cmd->command == GCACHE_CONTROL_CMD__RESTORE ? "Restore" : "???",
+							  cmd->ident.database_oid,
+							  cmd->ident.table_oid);
 		switch (cmd->command)
 		{
 			case GCACHE_CONTROL_CMD__APPLY_REDO:
 				status = __gpucacheExecApplyRedo(cmd,
 												 f_gcache_apply_redo,
-												 f_gcache_compaction);
+												 f_gcache_compaction,
+												 f_gcache_compaction_segment);
 				break;
 			case GCACHE_CONTROL_CMD__COMPACTION:
-				status = __gpucacheExecCompaction(cmd, f_gcache_compaction);
+				status = __gpucacheExecCompaction(cmd, f_gcache_compaction_segment);
 				break;
 			case GCACHE_CONTROL_CMD__DROP_UNLOAD:
 				status = __gpucacheExecDropUnload(cmd);
 				break;
+			case GCACHE_CONTROL_CMD__CHECKPOINT:
+				status = __gpucacheExecCheckpoint(cmd);
+				break;
+			case GCACHE_CONTROL_CMD__RESTORE:
+				status = __gpucacheExecRestore(cmd);
+				break;
 			default:
 				status = EINVAL;
 				snprintf(cmd->errbuf, sizeof(cmd->errbuf),
@@ -3825,6 +5656,7 @@ gpucacheManagerEventLoop(int cuda_dindex,
 						 cmd->command);
 				break;
 		}
+		pgstromNvtxRangeEnd(&nvtx_range);
 		pthreadMutexLock(cmd_mutex);
 		cmd->errcode = status;
 		if (cmd->backend)
@@ -3906,11 +5738,269 @@ retry:
 		}
 	}
 	/* ok, valid result */
+	pg_atomic_fetch_add_u64(&gc_lmap->access_count, 1);
 	*p_gcache_main_devptr  = gc_lmap->gcache_main_devptr;
 	*p_gcache_extra_devptr = gc_lmap->gcache_extra_devptr;
 	return gc_lmap;
 }
 
+/*
+ * gpuCacheBuildDeltaBuffer
+ *
+ * It builds the delta of the REDO logs not applied yet (merge-on-read).
+ * The caller must hold the gcache_rwlock by gpuCacheGetDeviceBuffer(), so
+ * apply-redo never moves the redo_read_pos during the scan.
+ */
+typedef struct
+{
+	kern_gpucache_delta_item ditem;
+	const GCacheTxLogInsert *i_log;
+} GpuCacheDeltaEntry;
+
+static int
+__gpuCacheDeltaEntryComp(const void *__a, const void *__b)
+{
+	const GpuCacheDeltaEntry *a = __a;
+	const GpuCacheDeltaEntry *b = __b;
+
+	if (a->ditem.rowid < b->ditem.rowid)
+		return -1;
+	if (a->ditem.rowid > b->ditem.rowid)
+		return 1;
+	return 0;
+}
+
+int
+gpuCacheBuildDeltaBuffer(void *__gc_lmap,
+						 uint64_t merge_pos,
+						 CUdeviceptr *p_gcache_delta,
+						 char *errbuf, size_t errbuf_sz)
+{
+	GpuCacheLocalMapping *gc_lmap = (GpuCacheLocalMapping *)__gc_lmap;
+	GpuCacheSharedState *gc_sstate = gc_lmap->gc_sstate;
+	kern_data_store *kds = (kern_data_store *)gc_lmap->gcache_main_devptr;
+	kern_colmeta   *cmeta = &kds->colmeta[kds->nr_colmeta - 1];
+	GpuCacheSysattr *sysattr = (GpuCacheSysattr *)
+		((char *)kds + __kds_unpack(cmeta->values_offset));
+	char	   *redo_buf = gpuCacheRedoLogBuffer(gc_sstate);
+	size_t		redo_bufsz = gc_sstate->gc_options.redo_buffer_size;
+	uint64_t	read_pos;
+	uint64_t	curr;
+	size_t		length;
+	size_t		offset;
+	char	   *logs = NULL;
+	char	   *pos, *end;
+	uint32_t	nlogs = 0;
+	uint32_t	nslots;
+	uint32_t   *hslots = NULL;
+	GpuCacheDeltaEntry *entries = NULL;
+	uint32_t	nitems = 0;
+	uint32_t	nrooms = 0;
+	kern_gpucache_delta *gcache_delta;
+	CUdeviceptr	m_gcache_delta;
+	CUresult	rc;
+	int			status = EIO;
+
+	*p_gcache_delta = 0UL;
+retry:
+	read_pos = pg_atomic_read_u64(&gc_sstate->redo_read_pos);
+	if (merge_pos <= read_pos)
+		return 0;	/* already applied */
+
+	/*
+	 * The logs reserved prior to the merge_pos shall be committed soon,
+	 * like as __gpucacheExecApplyRedoKernel() doing.
+	 */
+	nlogs = 0;
+	for (curr = read_pos; curr < merge_pos; )
+	{
+		volatile GCacheTxLogCommon *tx_log = (volatile GCacheTxLogCommon *)
+			(redo_buf + curr % redo_bufsz);
+
+		if ((tx_log->type & 0xffffff00U) != GCACHE_TX_LOG__MAGIC)
+		{
+			/* the logs may be consumed (and cleared) by the concurrent apply */
+			if (pg_atomic_read_u64(&gc_sstate->redo_read_pos) != read_pos)
+				goto retry;
+			pg_usleep(10L);
+			continue;
+		}
+		pg_read_barrier();
+		if (tx_log->length < offsetof(GCacheTxLogCommon, data) ||
+			tx_log->length != MAXALIGN(tx_log->length))
+		{
+			snprintf(errbuf, errbuf_sz,
+					 "REDO log is corrupted at %lu (length=%u)",
+					 curr, tx_log->length);
+			return EIO;
+		}
+		curr += tx_log->length;
+		nlogs++;
+	}
+	merge_pos = curr;
+
+	/* copy the pending logs to the linear buffer */
+	length = merge_pos - read_pos;
+	offset = read_pos % redo_bufsz;
+	nslots = 2 * nlogs + 1;
+	logs = malloc(length);
+	hslots = calloc(nslots, sizeof(uint32_t));
+	entries = malloc(sizeof(GpuCacheDeltaEntry) * nlogs);
+	if (!logs || !hslots || !entries)
+	{
+		snprintf(errbuf, errbuf_sz, "out of memory");
+		goto bailout;
+	}
+	if (offset + length <= redo_bufsz)
+		memcpy(logs, redo_buf + offset, length);
+	else
+	{
+		size_t	sz = redo_bufsz - offset;
+
+		memcpy(logs, redo_buf + offset, sz);
+		memcpy(logs + sz, redo_buf, length - sz);
+	}
+	pg_read_barrier();
+	if (pg_atomic_read_u64(&gc_sstate->redo_read_pos) != read_pos)
+	{
+		/* the copied logs might be cleared during the copy */
+		free(logs);
+		free(hslots);
+		free(entries);
+		logs = NULL;
+		hslots = NULL;
+		entries = NULL;
+		goto retry;
+	}
+
+	/* replay the logs on the visibility of the touched rows */
+	length = 0;
+	end = logs + (merge_pos - read_pos);
+	for (pos = logs; pos < end; pos += ((GCacheTxLogCommon *)pos)->length)
+	{
+		GCacheTxLogCommon *tx_log = (GCacheTxLogCommon *)pos;
+		GpuCacheDeltaEntry *entry;
+		uint32_t	rowid;
+		uint32_t	hindex;
+
+		switch (tx_log->type)
+		{
+			case GCACHE_TX_LOG__INSERT:
+				rowid = ((GCacheTxLogInsert *)tx_log)->rowid;
+				break;
+			case GCACHE_TX_LOG__DELETE:
+				rowid = ((GCacheTxLogDelete *)tx_log)->rowid;
+				break;
+			case GCACHE_TX_LOG__COMMIT_INS:
+			case GCACHE_TX_LOG__COMMIT_DEL:
+			case GCACHE_TX_LOG__ABORT_INS:
+			case GCACHE_TX_LOG__ABORT_DEL:
+				rowid = ((GCacheTxLogXact *)tx_log)->rowid;
+				break;
+			default:
+				continue;
+		}
+		if (rowid >= kds->column_nrooms)
+		{
+			snprintf(errbuf, errbuf_sz,
+					 "REDO log has out of range rowid (%u)", rowid);
+			goto bailout;
+		}
+		hindex = rowid % nslots;
+		while (hslots[hindex] != 0 &&
+			   entries[hslots[hindex]-1].ditem.rowid != rowid)
+			hindex = (hindex + 1) % nslots;
+		if (hslots[hindex] == 0)
+		{
+			entry = &entries[nitems++];
+			entry->ditem.rowid = rowid;
+			entry->ditem.xmin  = sysattr[rowid].xmin;
+			entry->ditem.xmax  = sysattr[rowid].xmax;
+			entry->ditem.htup_offset = 0;
+			entry->i_log = NULL;
+			hslots[hindex] = nitems;
+			nrooms = Max(nrooms, rowid + 1);
+		}
+		else
+		{
+			entry = &entries[hslots[hindex]-1];
+		}
+
+		switch (tx_log->type)
+		{
+			case GCACHE_TX_LOG__INSERT:
+				entry->i_log = (GCacheTxLogInsert *)tx_log;
+				entry->ditem.xmin = entry->i_log->htup.t_choice.t_heap.t_xmin;
+				entry->ditem.xmax = entry->i_log->htup.t_choice.t_heap.t_xmax;
+				break;
+			case GCACHE_TX_LOG__DELETE:
+				entry->ditem.xmax = ((GCacheTxLogDelete *)tx_log)->xid;
+				break;
+			case GCACHE_TX_LOG__COMMIT_INS:
+				entry->ditem.xmin = FrozenTransactionId;
+				break;
+			case GCACHE_TX_LOG__COMMIT_DEL:
+				entry->ditem.xmax = FrozenTransactionId;
+				break;
+			case GCACHE_TX_LOG__ABORT_INS:
+				entry->ditem.xmin = InvalidTransactionId;
+				break;
+			case GCACHE_TX_LOG__ABORT_DEL:
+				entry->ditem.xmax = InvalidTransactionId;
+				break;
+		}
+	}
+	for (uint32_t i=0; i < nitems; i++)
+	{
+		const GCacheTxLogInsert *i_log = entries[i].i_log;
+
+		if (i_log)
+			length += MAXALIGN(i_log->length - offsetof(GCacheTxLogInsert, htup));
+	}
+	qsort(entries, nitems, sizeof(GpuCacheDeltaEntry), __gpuCacheDeltaEntryComp);
+
+	/* setup kern_gpucache_delta */
+	offset = MAXALIGN(offsetof(kern_gpucache_delta, items[nitems]));
+	length += offset;
+	rc = cuMemAllocManaged(&m_gcache_delta, length, CU_MEM_ATTACH_GLOBAL);
+	if (rc != CUDA_SUCCESS)
+	{
+		snprintf(errbuf, errbuf_sz,
+				 "failed on cuMemAllocManaged: %s", cuStrError(rc));
+		goto bailout;
+	}
+	gcache_delta = (kern_gpucache_delta *)m_gcache_delta;
+	gcache_delta->length = length;
+	gcache_delta->nitems = nitems;
+	gcache_delta->nrooms = nrooms;
+	for (uint32_t i=0; i < nitems; i++)
+	{
+		kern_gpucache_delta_item *ditem = &gcache_delta->items[i];
+		const GCacheTxLogInsert *i_log = entries[i].i_log;
+
+		memcpy(ditem, &entries[i].ditem, sizeof(kern_gpucache_delta_item));
+		if (i_log)
+		{
+			size_t	sz = i_log->length - offsetof(GCacheTxLogInsert, htup);
+
+			memcpy((char *)gcache_delta + offset, &i_log->htup, sz);
+			ditem->htup_offset = __kds_packed(offset);
+			offset += MAXALIGN(sz);
+		}
+	}
+	Assert(offset == length);
+	*p_gcache_delta = m_gcache_delta;
+	status = 0;
+bailout:
+	if (entries)
+		free(entries);
+	if (hslots)
+		free(hslots);
+	if (logs)
+		free(logs);
+	return status;
+}
+
 /*
  * gpuCachePutDeviceBuffer
  */
@@ -4300,14 +6390,29 @@ __pgstrom_gpucache_info(void)
 	return results;
 }
 
+static Datum
+__pgstrom_gpucache_stat_datum(pg_atomic_uint64 *stat_hist)
+{
+	Datum		hist[GCACHE_STAT_NBUCKETS];
+
+	for (int k=0; k < GCACHE_STAT_NBUCKETS; k++)
+		hist[k] = Int64GetDatum(pg_atomic_read_u64(&stat_hist[k]));
+	return PointerGetDatum(construct_array(hist,
+										   GCACHE_STAT_NBUCKETS,
+										   INT8OID,
+										   sizeof(int64),
+										   FLOAT8PASSBYVAL,
+										   'd'));
+}
+
 PUBLIC_FUNCTION(Datum)
 pgstrom_gpucache_info(PG_FUNCTION_ARGS)
 {
 	GpuCacheSharedState *gc_sstate;
 	FuncCallContext *fncxt;
 	List	   *info_list;
-	Datum		values[20];
-	bool		isnull[20];
+	Datum		values[24];
+	bool		isnull[24];
 	HeapTuple	tuple;
 	uint32_t	phase;
 	char	   *str;
@@ -4319,7 +6424,7 @@ pgstrom_gpucache_info(PG_FUNCTION_ARGS)
 
 		fncxt = SRF_FIRSTCALL_INIT();
 		oldcxt = MemoryContextSwitchTo(fncxt->multi_call_memory_ctx);
-		tupdesc = CreateTemplateTupleDesc(20);
+		tupdesc = CreateTemplateTupleDesc(24);
 		TupleDescInitEntry(tupdesc,  1, "database_oid",
 						   OIDOID, -1, 0);
 		TupleDescInitEntry(tupdesc,  2, "database_name",
@@ -4360,6 +6465,14 @@ pgstrom_gpucache_info(PG_FUNCTION_ARGS)
 						   INT8OID, -1, 0);
 		TupleDescInitEntry(tupdesc, 20, "config_options",
 						   TEXTOID, -1, 0);
+		TupleDescInitEntry(tupdesc, 21, "stat_apply_redo_us",
+						   INT8ARRAYOID, -1, 0);
+		TupleDescInitEntry(tupdesc, 22, "stat_compaction_us",
+						   INT8ARRAYOID, -1, 0);
+		TupleDescInitEntry(tupdesc, 23, "stat_redo_queue_sz",
+						   INT8ARRAYOID, -1, 0);
+		TupleDescInitEntry(tupdesc, 24, "stat_visibility_us",
+						   INT8ARRAYOID, -1, 0);
 		fncxt->tuple_desc = BlessTupleDesc(tupdesc);
 		fncxt->user_fctx = __pgstrom_gpucache_info();
 
@@ -4404,12 +6517,12 @@ pgstrom_gpucache_info(PG_FUNCTION_ARGS)
 	values[10] = Int64GetDatum(pg_atomic_read_u64(&gc_sstate->gcache_extra_size));
 	values[11] = Int64GetDatum(pg_atomic_read_u64(&gc_sstate->gcache_extra_usage));
 	values[12] = Int64GetDatum(pg_atomic_read_u64(&gc_sstate->gcache_extra_dead));
-	values[13] = TimestampGetDatum(gc_sstate->redo_write_timestamp);
-	values[14] = Int64GetDatum(gc_sstate->redo_write_nitems);
-	values[15] = Int64GetDatum(gc_sstate->redo_write_pos);
+	values[13] = TimestampGetDatum(pg_atomic_read_u64(&gc_sstate->redo_write_timestamp));
+	values[14] = Int64GetDatum(pg_atomic_read_u64(&gc_sstate->redo_write_nitems));
+	values[15] = Int64GetDatum(pg_atomic_read_u64(&gc_sstate->redo_write_pos));
 	values[16] = Int64GetDatum(gc_sstate->redo_read_nitems);
-	values[17] = Int64GetDatum(gc_sstate->redo_read_pos);
-	values[18] = Int64GetDatum(gc_sstate->redo_sync_pos);
+	values[17] = Int64GetDatum(pg_atomic_read_u64(&gc_sstate->redo_read_pos));
+	values[18] = Int64GetDatum(pg_atomic_read_u64(&gc_sstate->redo_sync_pos));
 	if (gc_sstate->gc_options.cuda_dindex >= 0 &&
 		gc_sstate->gc_options.cuda_dindex < numGpuDevAttrs)
 	{
@@ -4429,6 +6542,10 @@ pgstrom_gpucache_info(PG_FUNCTION_ARGS)
 	{
 		isnull[19] = true;
 	}
+	values[20] = __pgstrom_gpucache_stat_datum(gc_sstate->stat_apply_redo_us);
+	values[21] = __pgstrom_gpucache_stat_datum(gc_sstate->stat_compaction_us);
+	values[22] = __pgstrom_gpucache_stat_datum(gc_sstate->stat_redo_queue_sz);
+	values[23] = __pgstrom_gpucache_stat_datum(gc_sstate->stat_visibility_us);
 	tuple = heap_form_tuple(fncxt->tuple_desc, values, isnull);
 	SRF_RETURN_NEXT(fncxt, HeapTupleGetDatum(tuple));
 }
@@ -4543,6 +6660,48 @@ pgstrom_init_gpu_cache(void)
 							 PGC_USERSET,
 							 GUC_NOT_IN_SAMPLE,
 							 NULL, NULL, NULL);
+	/* GUC: pg_strom.gpucache_merge_on_read */
+	DefineCustomBoolVariable("pg_strom.gpucache_merge_on_read",
+							 "Enables GpuCache scan to merge REDO logs not applied yet",
+							 NULL,
+							 &pgstrom_gpucache_merge_on_read,
+							 false,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* GUC: pg_strom.gpucache_device_memory_limit */
+	DefineCustomIntVariable("pg_strom.gpucache_device_memory_limit",
+							"Limit of the device memory for GpuCache per GPU; the cold ones are moved to the host memory",
+							"0 means no limit",
+							&pgstrom_gpucache_device_memory_limit,
+							0,
+							0,
+							INT_MAX,
+							PGC_SIGHUP,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_MB,
+							NULL, NULL, NULL);
+	/* GUC: pg_strom.gpucache_initial_load_workers */
+	DefineCustomIntVariable("pg_strom.gpucache_initial_load_workers",
+							"Number of parallel workers for GpuCache initial loading",
+							NULL,
+							&pgstrom_gpucache_initial_load_workers,
+							4,
+							0,
+							MAX_PARALLEL_WORKER_LIMIT,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE,
+							NULL, NULL, NULL);
+	/* GUC: pg_strom.gpucache_log_batch_size */
+	DefineCustomIntVariable("pg_strom.gpucache_log_batch_size",
+							"Size of per-backend batch of GpuCache REDO logs",
+							"0 means REDO logs are appended row-by-row",
+							&pgstrom_gpucache_log_batch_size,
+							256,
+							0,
+							65536,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_KB,
+							NULL, NULL, NULL);
 	/* setup local hash tables */
 	memset(&hctl, 0, sizeof(HASHCTL));
 	hctl.keysize = offsetof(GpuCacheDesc, xid) + sizeof(TransactionId);
@@ -21,6 +21,8 @@ double			pgstrom_gpu_operator_cost;		/* GUC */
 double			pgstrom_gpu_direct_seq_page_cost; /* GUC */
 static bool		pgstrom_gpudirect_enabled;			/* GUC */
 static int		__pgstrom_gpudirect_threshold_kb;	/* GUC */
+static bool		pgstrom_multi_gpu_split;			/* GUC */
+static double	pgstrom_gpu_memory_plan_ratio;		/* GUC */
 #define pgstrom_gpudirect_threshold		((size_t)__pgstrom_gpudirect_threshold_kb << 10)
 
 
@@ -109,7 +111,12 @@ __collectGpuDevAttrs(GpuDevAttributes *dattrs, CUdevice cuda_device)
 	rc = cuDeviceGetName(dattrs->DEV_NAME, sizeof(dattrs->DEV_NAME), cuda_device);
 	if (rc != CUDA_SUCCESS)
 		__FATAL("failed on cuDeviceGetName: %s", cuStrError(rc));
+#if CUDA_VERSION >= 11040
+	/* _v2 returns UUID of the MIG instance, instead of the physical GPU */
+	rc = cuDeviceGetUuid_v2(&uuid, cuda_device);
+#else
 	rc = cuDeviceGetUuid(&uuid, cuda_device);
+#endif
 	if (rc != CUDA_SUCCESS)
 		__FATAL("failed on cuDeviceGetUuid: %s", cuStrError(rc));
 	sprintf(dattrs->DEV_UUID,
@@ -186,10 +193,108 @@ __collectGpuDevAttrs(GpuDevAttributes *dattrs, CUdevice cuda_device)
 	}
 }
 
+/*
+ * __collectGpuDevMigInstances
+ *
+ * If MIG UUIDs are given by CUDA_VISIBLE_DEVICES, each MIG instance is
+ * enumerated as a CUDA device on the same PCI-E slot. SMs and device memory
+ * are already partitioned for the instance, however, PCI-E Bar1 is shared
+ * by the sibling instances on the physical GPU.
+ */
+static void
+__collectGpuDevMigInstances(GpuDevAttributes *devAttrs, int nr_gpus)
+{
+	const char *env = getenv("CUDA_VISIBLE_DEVICES");
+	bool		mig_visible = (env && strstr(env, "MIG-") != NULL);
+
+	for (int i=0; i < nr_gpus; i++)
+	{
+		GpuDevAttributes *dattrs = &devAttrs[i];
+		int			nsiblings = 0;
+
+		for (int j=0; j < nr_gpus; j++)
+		{
+			if (devAttrs[j].PCI_DOMAIN_ID == dattrs->PCI_DOMAIN_ID &&
+				devAttrs[j].PCI_BUS_ID    == dattrs->PCI_BUS_ID &&
+				devAttrs[j].PCI_DEVICE_ID == dattrs->PCI_DEVICE_ID)
+				nsiblings++;
+		}
+		if (nsiblings < 2 && !mig_visible)
+			continue;
+		dattrs->DEV_MIG_SIBLINGS = nsiblings;
+		memcpy(dattrs->DEV_UUID, "MIG", 3);
+		if (dattrs->DEV_BAR1_MEMSZ > 0)
+		{
+			dattrs->DEV_BAR1_MEMSZ /= nsiblings;
+			if (dattrs->DEV_BAR1_MEMSZ <= (256UL << 20))
+				dattrs->DEV_SUPPORT_GPUDIRECTSQL = false;
+		}
+	}
+}
+
+/*
+ * __collectGpuDevMpsConfig
+ *
+ * If CUDA MPS server is running, this process shares the GPU with the other
+ * MPS clients; CUDA_MPS_ACTIVE_THREAD_PERCENTAGE and
+ * CUDA_MPS_PINNED_DEVICE_MEM_LIMIT (like '0=16G,1=8192M') limit the SMs and
+ * device memory available to the process.
+ */
+static void
+__collectGpuDevMpsConfig(GpuDevAttributes *devAttrs, int nr_gpus)
+{
+	const char *pipe_dir = getenv("CUDA_MPS_PIPE_DIRECTORY");
+	const char *env;
+	char		path[MAXPGPATH];
+	struct stat	stat_buf;
+	int			percentage = 100;
+
+	snprintf(path, sizeof(path), "%s/control",
+			 pipe_dir ? pipe_dir : "/tmp/nvidia-mps");
+	if (stat(path, &stat_buf) != 0)
+		return;		/* MPS is not running */
+	env = getenv("CUDA_MPS_ACTIVE_THREAD_PERCENTAGE");
+	if (env)
+		percentage = Max(1, Min(atoi(env), 100));
+	for (int i=0; i < nr_gpus; i++)
+		devAttrs[i].DEV_MPS_THREAD_PERCENTAGE = percentage;
+
+	env = getenv("CUDA_MPS_PINNED_DEVICE_MEM_LIMIT");
+	if (env)
+	{
+		char   *temp = strdup(env);
+		char   *tok, *saveptr;
+
+		if (!temp)
+			__FATAL("out of memory");
+		for (tok = strtok_r(temp, ",", &saveptr);
+			 tok != NULL;
+			 tok = strtok_r(NULL, ",", &saveptr))
+		{
+			int		dindex;
+			size_t	limit;
+			char	unit;
+
+			if (sscanf(__trim(tok), "%d=%zu%c", &dindex, &limit, &unit) != 3 ||
+				dindex < 0 || dindex >= nr_gpus)
+				continue;
+			if (unit == 'G' || unit == 'g')
+				limit <<= 30;
+			else if (unit == 'M' || unit == 'm')
+				limit <<= 20;
+			else
+				continue;
+			devAttrs[dindex].DEV_TOTAL_MEMSZ
+				= Min(devAttrs[dindex].DEV_TOTAL_MEMSZ, limit);
+		}
+		free(temp);
+	}
+}
+
 static int
 collectGpuDevAttrs(int fdesc)
 {
-	GpuDevAttributes dattrs;
+	GpuDevAttributes *devAttrs;
 	CUdevice	cuda_device;
 	CUresult	rc;
 	int			i, nr_gpus;
@@ -201,20 +306,27 @@ collectGpuDevAttrs(int fdesc)
 	if (rc != CUDA_SUCCESS)
 		__FATAL("failed on cuDeviceGetCount: %s", cuStrError(rc));
 
+	devAttrs = calloc(Max(nr_gpus, 1), sizeof(GpuDevAttributes));
+	if (!devAttrs)
+		__FATAL("out of memory");
 	for (i=0; i < nr_gpus; i++)
 	{
-		ssize_t		offset, nbytes;
-
 		rc = cuDeviceGet(&cuda_device, i);
 		if (rc != CUDA_SUCCESS)
 			__FATAL("failed on cuDeviceGet: %s", cuStrError(rc));
-		memset(&dattrs, 0, sizeof(GpuDevAttributes));
-		dattrs.DEV_ID = i;
-		__collectGpuDevAttrs(&dattrs, cuda_device);
+		devAttrs[i].DEV_ID = i;
+		__collectGpuDevAttrs(&devAttrs[i], cuda_device);
+	}
+	__collectGpuDevMigInstances(devAttrs, nr_gpus);
+	__collectGpuDevMpsConfig(devAttrs, nr_gpus);
+
+	for (i=0; i < nr_gpus; i++)
+	{
+		ssize_t		offset, nbytes;
 
 		for (offset=0; offset < sizeof(GpuDevAttributes); offset += nbytes)
 		{
-			nbytes = write(fdesc, ((char *)&dattrs) + offset,
+			nbytes = write(fdesc, ((char *)&devAttrs[i]) + offset,
 						   sizeof(GpuDevAttributes) - offset);
 			if (nbytes == 0)
 				break;
@@ -425,6 +537,12 @@ pgstrom_collect_gpu_devices(void)
 		appendStringInfo(&buf, ", CC %d.%d",
 						 dattrs->COMPUTE_CAPABILITY_MAJOR,
 						 dattrs->COMPUTE_CAPABILITY_MINOR);
+		if (dattrs->DEV_MIG_SIBLINGS > 0)
+			appendStringInfo(&buf, ", MIG instance (%d on the GPU)",
+							 dattrs->DEV_MIG_SIBLINGS);
+		if (dattrs->DEV_MPS_THREAD_PERCENTAGE > 0)
+			appendStringInfo(&buf, ", MPS active threads %d%%",
+							 dattrs->DEV_MPS_THREAD_PERCENTAGE);
         elog(LOG, "PG-Strom: %s", buf.data);
 	}
 	pfree(buf.data);
@@ -443,6 +561,30 @@ pgstrom_gpu_operator_ratio(void)
 	return (pgstrom_gpu_operator_cost == 0.0 ? 1.0 : disable_cost);
 }
 
+/*
+ * pgstrom_gpu_memory_plan_limit
+ *
+ * The device memory size that a plan can occupy; the smallest GPU device
+ * memory by pg_strom.gpu_memory_plan_ratio. 0 means no limitation.
+ */
+size_t
+pgstrom_gpu_memory_plan_limit(void)
+{
+	size_t		limit = 0;
+
+	if (pgstrom_gpu_memory_plan_ratio <= 0.0)
+		return 0;
+	for (int i=0; i < numGpuDevAttrs; i++)
+	{
+		size_t	sz = pgstrom_gpu_memory_plan_ratio *
+			(double)gpuDevAttrs[i].DEV_TOTAL_MEMSZ;
+
+		if (limit == 0 || sz < limit)
+			limit = sz;
+	}
+	return limit;
+}
+
 /*
  * optimal-gpus cache
  */
@@ -627,6 +769,83 @@ GetOptimalGpuForRelation(Relation relation)
 	return GetOptimalGpuForTablespace(tablespace_oid);
 }
 
+/*
+ * GetOptimalGpuForSegment
+ *
+ * It returns the mask of the optimal GPUs for the segment file (1GB) of
+ * the relation being scanned. A tablespace on the RAID-0 volume striped
+ * over NVMe drives behind different PCIe switches may have multiple GPUs
+ * as optimal, but each segment file may be closer to a subset of them.
+ * It is used to route the chunks on the multi-GPU split execution, and
+ * returns 0 (no preference) if not applicable.
+ */
+int64_t
+GetOptimalGpuForSegment(pgstromTaskState *pts, BlockNumber segment_id)
+{
+	if (!pgstrom_multi_gpu_split ||
+		bms_num_members(pts->optimal_gpus) < 2 ||
+		segment_id == InvalidBlockNumber)
+		return 0UL;
+	if (pts->segment_optimal_id != segment_id)
+	{
+		char	   *path;
+		int64_t		optimal_gpus = 0UL;
+
+		if (segment_id == 0)
+			path = pstrdup(pts->kds_pathname);
+		else
+			path = psprintf("%s.%u", pts->kds_pathname, segment_id);
+		for (int k = bms_next_member(pts->optimal_gpus, -1);
+			 k >= 0;
+			 k = bms_next_member(pts->optimal_gpus, k))
+			optimal_gpus |= (1UL << k);
+		/* only GPUs connected by the session are valid */
+		optimal_gpus &= __GetOptimalGpuForFile(path);
+		pfree(path);
+
+		pts->segment_optimal_id = segment_id;
+		pts->segment_optimal_gpus = optimal_gpus;
+	}
+	return pts->segment_optimal_gpus;
+}
+
+/*
+ * GetOptimalGpuForFileChunk
+ *
+ * Like GetOptimalGpuForSegment, it returns the mask of the optimal GPUs
+ * for the chunk loaded from the supplied file (e.g, Apache Arrow files).
+ * Files in a foreign table may be distributed over the NVMe drives behind
+ * different PCIe switches, so the session may connect to all the GPUs,
+ * then each chunk is routed to the GPU nearest to the drive.
+ */
+int64_t
+GetOptimalGpuForFileChunk(pgstromTaskState *pts, const char *pathname)
+{
+	int64_t		session_gpus = 0UL;
+
+	if (!pgstrom_multi_gpu_split || !pathname)
+		return 0UL;
+	if (bms_is_empty(pts->optimal_gpus))
+	{
+		/* see gpuClientOpenSession; it connects to all the GPUs */
+		if (numGpuDevAttrs < 2)
+			return 0UL;
+		for (int k=0; k < numGpuDevAttrs && k < 64; k++)
+			session_gpus |= (1UL << k);
+	}
+	else
+	{
+		if (bms_num_members(pts->optimal_gpus) < 2)
+			return 0UL;
+		for (int k = bms_next_member(pts->optimal_gpus, -1);
+			 k >= 0;
+			 k = bms_next_member(pts->optimal_gpus, k))
+			session_gpus |= (1UL << k);
+	}
+	/* only GPUs connected by the session are valid */
+	return (session_gpus & __GetOptimalGpuForFile(pathname));
+}
+
 /*
  * GetOptimalGpuForBaseRel - checks wthere the relation can use GPU-Direct SQL.
  * If possible, it returns bitmap of the optimal GPUs.
@@ -900,6 +1119,26 @@ pgstrom_init_gpu_options(void)
 							 (has_gpudirectsql ? PGC_SUSET : PGC_POSTMASTER),
 							 GUC_NOT_IN_SAMPLE,
 							 NULL, NULL, NULL);
+	/* split execution of a scan over multiple GPUs */
+	DefineCustomBoolVariable("pg_strom.multi_gpu_split",
+							 "enables to distribute chunks of a scan to multiple GPUs",
+							 NULL,
+							 &pgstrom_multi_gpu_split,
+							 false,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* device memory footprint of the plan */
+	DefineCustomRealVariable("pg_strom.gpu_memory_plan_ratio",
+							 "Ratio of the device memory that a GPU plan can occupy (0 = no limitation)",
+							 NULL,
+							 &pgstrom_gpu_memory_plan_ratio,
+							 0.90,
+							 0.0,
+							 1.0,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
 	/* table size threshold for GPU-Direct SQL */
 	DefineCustomIntVariable("pg_strom.gpudirect_threshold",
 							"table-size threshold to use GPU-Direct SQL",
@@ -1009,15 +1248,100 @@ __gpuClientChooseDevice(const Bitmapset *gpuset)
 	return (rr_counter++ % numGpuDevAttrs);
 }
 
+/*
+ * __gpuClientOpenSessionMulti
+ *
+ * It connects to all the candidate GPUs, then opens a session on them.
+ */
+static void
+__gpuClientOpenSessionMulti(pgstromTaskState *pts,
+							const XpuCommand *session,
+							const Bitmapset *gpuset)
+{
+	int			num_socks = 0;
+	pgsocket   *sockfds = alloca(sizeof(pgsocket) * numGpuDevAttrs);
+	int		   *dindexes = alloca(sizeof(int) * numGpuDevAttrs);
+	char		namebuf[32];
+	size_t		off;
+
+	off = snprintf(namebuf, sizeof(namebuf), "GPU-");
+	for (int k=0; k < numGpuDevAttrs; k++)
+	{
+		struct sockaddr_un addr;
+		pgsocket	sockfd;
+
+		if (!bms_is_empty(gpuset) && !bms_is_member(k, gpuset))
+			continue;
+		sockfd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (sockfd >= 0)
+		{
+			memset(&addr, 0, sizeof(addr));
+			addr.sun_family = AF_UNIX;
+			snprintf(addr.sun_path, sizeof(addr.sun_path),
+					 ".pg_strom.%u.gpu%u.sock",
+					 PostmasterPid, k);
+			if (connect(sockfd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+			{
+				int		errno_saved = errno;
+
+				close(sockfd);
+				sockfd = -1;
+				errno = errno_saved;
+			}
+		}
+		if (sockfd < 0)
+		{
+			int		errno_saved = errno;
+
+			while (num_socks > 0)
+				close(sockfds[--num_socks]);
+			errno = errno_saved;
+			elog(ERROR, "failed on connect to GPU%d service: %m", k);
+		}
+		sockfds[num_socks] = sockfd;
+		dindexes[num_socks] = k;
+		num_socks++;
+		if (off < sizeof(namebuf))
+			off += snprintf(namebuf + off, sizeof(namebuf) - off,
+							"%s%d", (num_socks > 1 ? "," : ""), k);
+	}
+	__xpuClientOpenSessionMulti(pts, session, num_socks,
+								sockfds, dindexes, namebuf);
+}
+
 void
 gpuClientOpenSession(pgstromTaskState *pts,
 					 const XpuCommand *session)
 {
 	struct sockaddr_un addr;
 	pgsocket	sockfd;
-	int			cuda_dindex = __gpuClientChooseDevice(pts->optimal_gpus);
+	int			cuda_dindex;
 	char		namebuf[32];
 
+	/*
+	 * Multi-GPU split execution
+	 *
+	 * GpuCache is not supported because it is kept on a particular device.
+	 */
+	if (pgstrom_multi_gpu_split && !pts->gcache_desc)
+	{
+		const Bitmapset *gpuset = pts->optimal_gpus;
+		int		num = (bms_is_empty(gpuset)
+					   ? numGpuDevAttrs
+					   : bms_num_members(gpuset));
+		if (num > 1)
+		{
+			pg_atomic_fetch_or_u32(&pts->ps_state->exec_paths,
+								   XPU_EXEC_PATH__MULTI_GPU);
+			__gpuClientOpenSessionMulti(pts, session, gpuset);
+			return;
+		}
+	}
+	cuda_dindex = __gpuClientChooseDevice(pts->optimal_gpus);
+	/* reuse the connection kept by the previous session, if any */
+	if (xpuClientReuseConnection(pts, session, cuda_dindex))
+		return;
+
 	sockfd = socket(AF_UNIX, SOCK_STREAM, 0);
 	if (sockfd < 0)
 		elog(ERROR, "failed on socket(2): %m");
@@ -1099,8 +1423,8 @@ pgstrom_gpu_device_info(PG_FUNCTION_ARGS)
 	}
 	fncxt = SRF_PERCALL_SETUP();
 
-	dindex = fncxt->call_cntr / (lengthof(GpuDevAttrCatalog) + 5);
-	aindex = fncxt->call_cntr % (lengthof(GpuDevAttrCatalog) + 5);
+	dindex = fncxt->call_cntr / (lengthof(GpuDevAttrCatalog) + 8);
+	aindex = fncxt->call_cntr % (lengthof(GpuDevAttrCatalog) + 8);
 	if (dindex >= numGpuDevAttrs)
 		SRF_RETURN_DONE(fncxt);
 	dattrs = &gpuDevAttrs[dindex];
@@ -1136,8 +1460,18 @@ pgstrom_gpu_device_info(PG_FUNCTION_ARGS)
 			att_desc = "GPU NUMA Node Id";
 			att_value = psprintf("%d", dattrs->NUMA_NODE_ID);
 			break;
+		case 6:
+			att_name = "DEV_MIG_SIBLINGS";
+			att_desc = "Number of MIG instances on the GPU";
+			att_value = psprintf("%d", dattrs->DEV_MIG_SIBLINGS);
+			break;
+		case 7:
+			att_name = "DEV_MPS_THREAD_PERCENTAGE";
+			att_desc = "Active thread percentage of MPS";
+			att_value = psprintf("%d", dattrs->DEV_MPS_THREAD_PERCENTAGE);
+			break;
 		default:
-			i = aindex - 6;
+			i = aindex - 8;
 			val = *((int *)((char *)dattrs +
 							GpuDevAttrCatalog[i].attr_offset));
 			att_name = GpuDevAttrCatalog[i].attr_label;
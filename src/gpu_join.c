@@ -22,7 +22,17 @@ static CustomExecMethods	gpujoin_exec_methods;
 static bool					pgstrom_enable_gpujoin = false;		/* GUC */
 static bool					pgstrom_enable_gpuhashjoin = false;	/* GUC */
 static bool					pgstrom_enable_gpugistindex = false;/* GUC */
+static bool					pgstrom_enable_gpurangejoin = false;/* GUC */
+static bool					pgstrom_enable_gpugridjoin = false;/* GUC */
 static bool					pgstrom_enable_partitionwise_gpujoin = false;
+static int					pgstrom_gpujoin_inner_buffer_limit = 0;	/* GUC */
+static bool					pgstrom_gpujoin_adaptive_partition = false;	/* GUC */
+static bool					pgstrom_gpuhashjoin_bucketized = false;	/* GUC */
+static bool					pgstrom_gpuhashjoin_build_on_gpu = false;	/* GUC */
+static bool					pgstrom_gpujoin_bloom_filter = false;	/* GUC */
+static int					pgstrom_gpuhashjoin_skew_threshold = 0;	/* GUC */
+static bool					pgstrom_gpujoin_gist_rtree = false;	/* GUC */
+static bool					pgstrom_gpujoin_geometry_index = false;	/* GUC */
 
 static CustomPathMethods	dpujoin_path_methods;
 static CustomScanMethods	dpujoin_plan_methods;
@@ -190,6 +200,7 @@ fixup_join_varnullingrels(RelOptInfo *joinrel, pgstromPlanInfo *pp_info)
 	__FIXUP_FIELD(pp_info->scan_quals);
 	__FIXUP_FIELD(pp_info->brin_index_conds);
 	__FIXUP_FIELD(pp_info->brin_index_quals);
+	__FIXUP_FIELD(pp_info->brin_subindex_conds);
 	for (int i=0; i < pp_info->num_rels; i++)
 	{
 		pgstromPlanInnerInfo *pp_inner = &pp_info->inners[i];
@@ -199,12 +210,280 @@ fixup_join_varnullingrels(RelOptInfo *joinrel, pgstromPlanInfo *pp_info)
 		__FIXUP_FIELD(pp_inner->join_quals);
 		__FIXUP_FIELD(pp_inner->other_quals);
 		__FIXUP_FIELD(pp_inner->gist_clause);
+		__FIXUP_FIELD(pp_inner->range_outer_key);
+		__FIXUP_FIELD(pp_inner->range_inner_key);
 	}
 #undef __FIXUP_FIELD
 	return pp_info;
 }
 #endif
 
+/*
+ * gpujoin_inner_buffer_limit
+ *
+ * The max length of the inner buffer on a pass of GpuJoin. The inner hash
+ * table larger than this limit shall be partitioned (grace hash-join).
+ */
+static size_t
+gpujoin_inner_buffer_limit(void)
+{
+	size_t		limit = 0;
+
+	if (pgstrom_gpujoin_inner_buffer_limit > 0)
+		return ((size_t)pgstrom_gpujoin_inner_buffer_limit << 20);
+	if (pgstrom_gpujoin_inner_buffer_limit < 0)
+		return 0;		/* never partitioned */
+	/* 75% of the smallest device memory in default */
+	for (int i=0; i < numGpuDevAttrs; i++)
+	{
+		size_t	sz = (gpuDevAttrs[i].DEV_TOTAL_MEMSZ / 4) * 3;
+
+		if (limit == 0 || sz < limit)
+			limit = sz;
+	}
+	return limit;
+}
+
+static bool
+__innerKeyRangeTypeCompatible(Oid outer_type, Oid inner_type);
+
+/*
+ * tryFindRangeJoinClause
+ *
+ * It looks for a join-clause in the form of (outer_key OP inner_key), where
+ * OP is a btree inequality operator (<, <=, > or >=) on the integer or
+ * date/time types. GpuNestLoop sorts the inner relation by the inner_key,
+ * then the GPU kernel evaluates the join-quals only on the portion of the
+ * inner tuples that can satisfy the clause.
+ */
+static bool
+tryFindRangeJoinClause(PlannerInfo *root,
+					   List *join_quals,
+					   RelOptInfo *outer_rel,
+					   RelOptInfo *inner_rel,
+					   pgstromPlanInnerInfo *pp_inner,
+					   Selectivity *p_range_selectivity)
+{
+	ListCell   *lc;
+
+	foreach (lc, join_quals)
+	{
+		OpExpr	   *op = lfirst(lc);
+		Expr	   *outer_key;
+		Expr	   *inner_key;
+		Relids		relids1;
+		Relids		relids2;
+		Oid			opcode;
+		int			strategy = 0;
+		CatCList   *catlist;
+
+		if (!IsA(op, OpExpr) || list_length(op->args) != 2 ||
+			contain_volatile_functions((Node *)op))
+			continue;
+		relids1 = pull_varnos(root, linitial(op->args));
+		relids2 = pull_varnos(root, lsecond(op->args));
+		if (!bms_is_empty(relids1) && bms_is_subset(relids1, outer_rel->relids) &&
+			!bms_is_empty(relids2) && bms_is_subset(relids2, inner_rel->relids))
+		{
+			/* (outer OP inner) --> (inner COMMUTATOR outer) */
+			outer_key = linitial(op->args);
+			inner_key = lsecond(op->args);
+			opcode = get_commutator(op->opno);
+		}
+		else if (!bms_is_empty(relids1) && bms_is_subset(relids1, inner_rel->relids) &&
+				 !bms_is_empty(relids2) && bms_is_subset(relids2, outer_rel->relids))
+		{
+			inner_key = linitial(op->args);
+			outer_key = lsecond(op->args);
+			opcode = op->opno;
+		}
+		else
+			continue;
+		if (!OidIsValid(opcode) ||
+			!__innerKeyRangeTypeCompatible(exprType((Node *)outer_key),
+										   exprType((Node *)inner_key)))
+			continue;
+
+		catlist = SearchSysCacheList1(AMOPOPID, ObjectIdGetDatum(opcode));
+		for (int i=0; i < catlist->n_members; i++)
+		{
+			HeapTuple	tuple = &catlist->members[i]->tuple;
+			Form_pg_amop amop = (Form_pg_amop) GETSTRUCT(tuple);
+
+			if (amop->amopmethod == BTREE_AM_OID)
+			{
+				strategy = amop->amopstrategy;
+				break;
+			}
+		}
+		ReleaseSysCacheList(catlist);
+
+		if (strategy == BTLessStrategyNumber ||
+			strategy == BTLessEqualStrategyNumber ||
+			strategy == BTGreaterEqualStrategyNumber ||
+			strategy == BTGreaterStrategyNumber)
+		{
+			pp_inner->range_outer_key = outer_key;
+			pp_inner->range_inner_key = inner_key;
+			pp_inner->range_strategy  = strategy;
+			*p_range_selectivity = clause_selectivity(root, (Node *)op, 0,
+													  JOIN_INNER, NULL);
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+ * __extractGridJoinClause
+ *
+ * It picks up the pair of geometries and the distance from either of
+ * st_dwithin(geom1, geom2, distance), or comparison of the distance
+ * like (geom1 <-> geom2) < distance or st_distance(geom1, geom2) <= distance.
+ */
+static bool
+__extractGridJoinClause(Expr *clause,
+						Expr **p_arg1, Expr **p_arg2, Expr **p_arg3)
+{
+	devfunc_info *dfunc;
+
+	if (IsA(clause, FuncExpr))
+	{
+		FuncExpr   *func = (FuncExpr *)clause;
+
+		if (list_length(func->args) != 3)
+			return false;
+		dfunc = pgstrom_devfunc_lookup(func->funcid,
+									   func->args,
+									   func->inputcollid);
+		if (!dfunc || dfunc->func_code != FuncOpCode__st_dwithin)
+			return false;
+		*p_arg1 = linitial(func->args);
+		*p_arg2 = lsecond(func->args);
+		*p_arg3 = lthird(func->args);
+		return true;
+	}
+	else if (IsA(clause, OpExpr))
+	{
+		OpExpr	   *op = (OpExpr *)clause;
+		Expr	   *dist;
+		Expr	   *con;
+		List	   *dist_args;
+		Oid			dist_funcid;
+		Oid			dist_collid;
+
+		if (list_length(op->args) != 2)
+			return false;
+		if (op->opfuncid == F_FLOAT8LT || op->opfuncid == F_FLOAT8LE)
+		{
+			dist = linitial(op->args);
+			con  = lsecond(op->args);
+		}
+		else if (op->opfuncid == F_FLOAT8GT || op->opfuncid == F_FLOAT8GE)
+		{
+			dist = lsecond(op->args);
+			con  = linitial(op->args);
+		}
+		else
+			return false;
+
+		if (IsA(dist, FuncExpr))
+		{
+			dist_funcid = ((FuncExpr *)dist)->funcid;
+			dist_args   = ((FuncExpr *)dist)->args;
+			dist_collid = ((FuncExpr *)dist)->inputcollid;
+		}
+		else if (IsA(dist, OpExpr))
+		{
+			dist_funcid = get_opcode(((OpExpr *)dist)->opno);
+			dist_args   = ((OpExpr *)dist)->args;
+			dist_collid = ((OpExpr *)dist)->inputcollid;
+		}
+		else
+			return false;
+		if (list_length(dist_args) != 2)
+			return false;
+		dfunc = pgstrom_devfunc_lookup(dist_funcid,
+									   dist_args,
+									   dist_collid);
+		if (!dfunc || dfunc->func_code != FuncOpCode__st_distance)
+			return false;
+		*p_arg1 = linitial(dist_args);
+		*p_arg2 = lsecond(dist_args);
+		*p_arg3 = con;
+		return true;
+	}
+	return false;
+}
+
+/*
+ * tryFindGridJoinClause
+ *
+ * It looks for a join-clause that limits the distance between the outer
+ * and inner geometries by a positive constant (see __extractGridJoinClause).
+ * GpuNestLoop sorts the inner relation by the cell of the uniform grid
+ * (cell size = distance), then the GPU kernel evaluates the join-quals
+ * only on the inner tuples in the cells around the outer geometry.
+ */
+static bool
+tryFindGridJoinClause(PlannerInfo *root,
+					  List *join_quals,
+					  RelOptInfo *outer_rel,
+					  RelOptInfo *inner_rel,
+					  pgstromPlanInnerInfo *pp_inner,
+					  Selectivity *p_range_selectivity)
+{
+	ListCell   *lc;
+
+	foreach (lc, join_quals)
+	{
+		Expr	   *clause = lfirst(lc);
+		devtype_info *dtype;
+		Expr	   *arg1;
+		Expr	   *arg2;
+		Const	   *con;
+		Relids		relids1;
+		Relids		relids2;
+		double		distance;
+
+		if (!__extractGridJoinClause(clause, &arg1, &arg2, (Expr **)&con))
+			continue;
+		dtype = pgstrom_devtype_lookup(exprType((Node *)arg1));
+		if (!dtype || dtype->type_code != TypeOpCode__geometry ||
+			exprType((Node *)arg2) != exprType((Node *)arg1))
+			continue;
+		if (!IsA(con, Const) || con->constisnull ||
+			con->consttype != FLOAT8OID)
+			continue;
+		distance = DatumGetFloat8(con->constvalue);
+		if (isnan(distance) || isinf(distance) || distance <= 0.0)
+			continue;
+
+		relids1 = pull_varnos(root, (Node *)arg1);
+		relids2 = pull_varnos(root, (Node *)arg2);
+		if (!bms_is_empty(relids1) && bms_is_subset(relids1, outer_rel->relids) &&
+			!bms_is_empty(relids2) && bms_is_subset(relids2, inner_rel->relids))
+		{
+			pp_inner->range_outer_key = arg1;
+			pp_inner->range_inner_key = arg2;
+		}
+		else if (!bms_is_empty(relids1) && bms_is_subset(relids1, inner_rel->relids) &&
+				 !bms_is_empty(relids2) && bms_is_subset(relids2, outer_rel->relids))
+		{
+			pp_inner->range_outer_key = arg2;
+			pp_inner->range_inner_key = arg1;
+		}
+		else
+			continue;
+		pp_inner->range_strategy = 0;
+		pp_inner->range_grid_distance = distance;
+		*p_range_selectivity = clause_selectivity(root, (Node *)clause, 0,
+												  JOIN_INNER, NULL);
+		return true;
+	}
+	return false;
+}
+
 /*
  * __buildXpuJoinPlanInfo
  */
@@ -233,16 +512,22 @@ __buildXpuJoinPlanInfo(PlannerInfo *root,
 	Cost			comp_cost = 0.0;
 	bool			enable_xpuhashjoin;
 	bool			enable_xpugistindex;
+	bool			enable_xpurangejoin;
 	double			xpu_tuple_cost;
 	Cost			xpu_ratio;
 	QualCost		join_quals_cost;
+	Cost			join_quals_xpu_cost;
 	List		   *join_quals = NIL;
+	List		   *join_quals_dcosts = NIL;
 	List		   *other_quals = NIL;
 	List		   *hash_outer_keys = NIL;
 	List		   *hash_inner_keys = NIL;
 	List		   *inner_target_list = NIL;
 	ListCell	   *lc;
 	bool			clauses_are_immutable = true;
+	Selectivity		range_selectivity = 1.0;
+	double			inner_sz;
+	bool			inner_partitionable = false;
 
 	/* cross join is not welcome */
 	if (!restrict_clauses)
@@ -255,6 +540,7 @@ __buildXpuJoinPlanInfo(PlannerInfo *root,
 	{
 		enable_xpuhashjoin  = pgstrom_enable_gpuhashjoin;
 		enable_xpugistindex = pgstrom_enable_gpugistindex;
+		enable_xpurangejoin = pgstrom_enable_gpurangejoin;
 		xpu_tuple_cost      = pgstrom_gpu_tuple_cost;
 		xpu_ratio           = pgstrom_gpu_operator_ratio();
 	}
@@ -262,6 +548,7 @@ __buildXpuJoinPlanInfo(PlannerInfo *root,
 	{
 		enable_xpuhashjoin  = pgstrom_enable_dpuhashjoin;
 		enable_xpugistindex = pgstrom_enable_dpugistindex;
+		enable_xpurangejoin = false;	/* not supported by DPU */
 		xpu_tuple_cost      = pgstrom_dpu_tuple_cost;
 		xpu_ratio           = pgstrom_dpu_operator_ratio();
 	}
@@ -270,6 +557,14 @@ __buildXpuJoinPlanInfo(PlannerInfo *root,
 		elog(ERROR, "Bug? unexpected xpu_task_flags: %08x",
 			 pp_prev->xpu_task_flags);
 	}
+	/* calibration by the recorded execution stats, if any */
+	if (pgstrom_cost_calibration)
+	{
+		double	factor = pgstromCostCalibrationFactor(pp_prev->xpu_task_flags & DEVKIND__ANY,
+													  DEVTASK__JOIN);
+		xpu_tuple_cost *= factor;
+		xpu_ratio      *= factor;
+	}
 
 	/* setup inner_target_list */
 	foreach (lc, inner_paths_list)
@@ -289,6 +584,7 @@ __buildXpuJoinPlanInfo(PlannerInfo *root,
 	foreach (lc, restrict_clauses)
 	{
 		RestrictInfo   *rinfo = lfirst(lc);
+		int				devcost;
 
 		/*
 		 * In case when neither outer-vars nor inner-vars are not referenced,
@@ -306,7 +602,7 @@ __buildXpuJoinPlanInfo(PlannerInfo *root,
 									pp_prev->xpu_task_flags,
 									pp_prev->scan_relid,
 									inner_target_list,
-									NULL))
+									&devcost))
 		{
 			return NULL;
 		}
@@ -328,6 +624,7 @@ __buildXpuJoinPlanInfo(PlannerInfo *root,
 		{
 			Assert(!rinfo->pseudoconstant);
 			join_quals = lappend(join_quals, rinfo->clause);
+			join_quals_dcosts = lappend_int(join_quals_dcosts, devcost);
 		}
 		/* Is the hash-join enabled? */
 		if (!enable_xpuhashjoin)
@@ -399,8 +696,10 @@ __buildXpuJoinPlanInfo(PlannerInfo *root,
 	pp_inner->hash_inner_keys = hash_inner_keys;
 	pp_inner->join_quals = join_quals;
 	pp_inner->other_quals = other_quals;
-	/* GiST-Index availability checks */
+	/* GiST-Index availability checks (not for SEMI/ANTI JOIN) */
 	if (enable_xpugistindex &&
+		join_type != JOIN_SEMI &&
+		join_type != JOIN_ANTI &&
 		hash_outer_keys == NIL &&
 		hash_inner_keys == NIL)
 	{
@@ -416,6 +715,28 @@ __buildXpuJoinPlanInfo(PlannerInfo *root,
 		if (gist_inner_path)
 			llast(inner_paths_list) = gist_inner_path;
 	}
+	/* Range-Join availability checks */
+	if (enable_xpurangejoin &&
+		hash_outer_keys == NIL &&
+		hash_inner_keys == NIL &&
+		!OidIsValid(pp_inner->gist_index_oid))
+	{
+		if (!tryFindRangeJoinClause(root,
+									join_quals,
+									outer_rel,
+									inner_rel,
+									pp_inner,
+									&range_selectivity) &&
+			pgstrom_enable_gpugridjoin)
+		{
+			tryFindGridJoinClause(root,
+								  join_quals,
+								  outer_rel,
+								  inner_rel,
+								  pp_inner,
+								  &range_selectivity);
+		}
+	}
 
 	/*
 	 * Cost estimation
@@ -445,12 +766,22 @@ __buildXpuJoinPlanInfo(PlannerInfo *root,
 	}
 	inner_cost += (inner_path->total_cost +
 				   inner_nrows * cpu_tuple_cost) * inner_discount_ratio;
+	/* length of the inner buffer; tuples + hash-slots or row-index */
+	inner_sz = inner_nrows * (MAXALIGN(offsetof(kern_hashitem, t.htup) +
+									   SizeofHeapTupleHeader +
+									   inner_rel->reltarget->width) +
+							  2 * sizeof(uint64_t));
 
 	/*
 	 * Cost for join_quals
 	 */
 	cost_qual_eval(&join_quals_cost, join_quals, root);
 	startup_cost += join_quals_cost.startup;
+	/* per-tuple cost by the device functions/operators */
+	join_quals_xpu_cost = cost_device_qualifiers(root,
+												 join_quals,
+												 join_quals_dcosts,
+												 0) * xpu_ratio;
 	if (hash_outer_keys != NIL && hash_inner_keys != NIL)
 	{
 		/*
@@ -467,7 +798,25 @@ __buildXpuJoinPlanInfo(PlannerInfo *root,
 					  num_hashkeys *
 					  outer_nrows);
 		/* cost to evaluate join qualifiers */
-		comp_cost += join_quals_cost.per_tuple * xpu_ratio * outer_nrows;
+		comp_cost += join_quals_xpu_cost * outer_nrows;
+
+		/*
+		 * Grace hash-join - if the inner hash table is larger than the
+		 * inner buffer limit, the outer relation is scanned for each
+		 * partition of the inner hash table (only non-parallel plan).
+		 */
+		if ((pp_info->xpu_task_flags & DEVKIND__NVIDIA_GPU) != 0 &&
+			pp_info->parallel_nworkers == 0 &&
+			(join_type == JOIN_INNER || join_type == JOIN_LEFT))
+		{
+			size_t	limit = gpujoin_inner_buffer_limit();
+
+			if (limit > 0 && inner_sz > (double)limit)
+				run_cost += (ceil(inner_sz / (double)limit) - 1.0) * pp_prev->run_cost;
+			/* other depths must leave the space for a partition */
+			if (limit > 0 && pp_prev->gpu_memsz <= (double)(limit / 4) * 3.0)
+				inner_partitionable = true;
+		}
 	}
 	else if (OidIsValid(pp_inner->gist_index_oid))
 	{
@@ -486,11 +835,31 @@ __buildXpuJoinPlanInfo(PlannerInfo *root,
 		cost_qual_eval_node(&gist_clause_cost, (Node *)gist_clause, root);
 		comp_cost += gist_clause_cost.per_tuple * xpu_ratio * outer_nrows;
 		/* cost to evaluate join qualifiers by GPU */
-		comp_cost += (join_quals_cost.per_tuple * xpu_ratio *
+		comp_cost += (join_quals_xpu_cost *
 					  outer_nrows *
 					  gist_selectivity *
 					  inner_path->rows);
 	}
+	else if (pp_inner->range_inner_key != NULL)
+	{
+		/*
+		 * GpuNestLoop+Range-Join - It sorts the inner tuples by the CPU,
+		 * then GPU evaluates join-qual only for the portion of the inner
+		 * tuples that can satisfy the range-join clause.
+		 */
+		double		log2_nrows = log2(Max(inner_path->rows, 2.0));
+
+		/* cost to preload and sort inner heap tuples by CPU */
+		startup_cost += cpu_tuple_cost * inner_path->rows;
+		startup_cost += 2.0 * cpu_operator_cost * inner_path->rows * log2_nrows;
+		/* cost to binary search on the sorted keys by GPU */
+		comp_cost += cpu_operator_cost * xpu_ratio * log2_nrows * outer_nrows;
+		/* cost to evaluate join qualifiers by GPU */
+		comp_cost += (join_quals_xpu_cost *
+					  inner_path->rows *
+					  outer_nrows *
+					  range_selectivity);
+	}
 	else
 	{
 		/*
@@ -503,7 +872,7 @@ __buildXpuJoinPlanInfo(PlannerInfo *root,
 		startup_cost += cpu_tuple_cost * inner_path->rows;
 
 		/* cost to evaluate join qualifiers by GPU */
-		comp_cost += (join_quals_cost.per_tuple * xpu_ratio *
+		comp_cost += (join_quals_xpu_cost *
 					  inner_path->rows *
 					  outer_nrows);
 	}
@@ -515,6 +884,25 @@ __buildXpuJoinPlanInfo(PlannerInfo *root,
 	final_cost += (joinrel->reltarget->cost.per_tuple *
 				   joinrel->rows / pp_info->parallel_divisor);
 
+	/*
+	 * Device memory footprint; inner buffers of all the depths are loaded
+	 * at once. If it exceeds the device memory and cannot be partitioned,
+	 * GPU shall thrash on the managed memory, so we give up this path to
+	 * prefer the partitioned variant (or CPU plan).
+	 */
+	pp_info->gpu_memsz = pp_prev->gpu_memsz + inner_sz;
+	if ((pp_info->xpu_task_flags & DEVKIND__NVIDIA_GPU) != 0 &&
+		!inner_partitionable)
+	{
+		size_t	limit = pgstrom_gpu_memory_plan_limit();
+
+		if (limit > 0 && pp_info->gpu_memsz > (double)limit)
+		{
+			elog(DEBUG2, "GpuJoin: inner buffer (%.0f bytes) exceeds the device memory limit (%zu bytes)",
+				 pp_info->gpu_memsz, limit);
+			return NULL;
+		}
+	}
 	pp_info->startup_cost = startup_cost;
 	pp_info->inner_cost = inner_cost;
 	pp_info->run_cost = run_cost;
@@ -1064,9 +1452,14 @@ __xpuJoinAddCustomPathCommon(PlannerInfo *root,
 	if (join_type != JOIN_INNER &&
 		join_type != JOIN_FULL &&
 		join_type != JOIN_RIGHT &&
-		join_type != JOIN_LEFT)
+		join_type != JOIN_LEFT &&
+		join_type != JOIN_SEMI &&
+		join_type != JOIN_ANTI)
+		return;
+	/* SEMI/ANTI JOIN is supported by GPU only */
+	if ((join_type == JOIN_SEMI || join_type == JOIN_ANTI) &&
+		(xpu_task_flags & DEVKIND__NVIDIA_GPU) == 0)
 		return;
-	//TODO: JOIN_SEMI and JOIN_ANTI
 
 	inner_pathlist = innerrel->pathlist;
 	for (int try_parallel=0; try_parallel < 2; try_parallel++)
@@ -1457,6 +1850,10 @@ build_explain_tlist_junks(codegen_context *context,
 										   context);
 		__build_explain_tlist_junks_walker((Node *)pp_inner->gist_clause,
 										   context);
+		__build_explain_tlist_junks_walker((Node *)pp_inner->range_outer_key,
+										   context);
+		__build_explain_tlist_junks_walker((Node *)pp_inner->range_inner_key,
+										   context);
 	}
 	__build_explain_tlist_junks_walker((Node *)vars_in_exprs, context);
 	
@@ -1508,6 +1905,7 @@ PlanXpuJoinPathCommon(PlannerInfo *root,
 	List	   *other_quals_stacked = NIL;
 	List	   *hash_keys_stacked = NIL;
 	List	   *gist_quals_stacked = NIL;
+	List	   *range_keys_stacked = NIL;
 
 	Assert(pp_info->num_rels == list_length(custom_plans));
 	context = create_codegen_context(root, cpath, pp_info);
@@ -1563,6 +1961,13 @@ PlanXpuJoinPathCommon(PlannerInfo *root,
 		pull_varattnos((Node *)pp_inner->gist_clause,
 					   pp_info->scan_relid,
 					   &outer_refs);
+
+		/* xpu code to evaluate the outer key of range-join */
+		range_keys_stacked = lappend(range_keys_stacked,
+									 pp_inner->range_outer_key);
+		pull_varattnos((Node *)pp_inner->range_outer_key,
+					   pp_info->scan_relid,
+					   &outer_refs);
 	}
 
 	/*
@@ -1581,6 +1986,7 @@ PlanXpuJoinPathCommon(PlannerInfo *root,
 		/* build device projection */
 		pgstrom_build_join_tlist_dev(context, root, joinrel, tlist);
 		pp_info->kexp_projection = codegen_build_projection(context);
+		pgstrom_build_topk_planinfo(root, joinrel, pp_info, context->tlist_dev);
 	}
 	pull_varattnos((Node *)context->tlist_dev,
 				   pp_info->scan_relid,
@@ -1596,6 +2002,9 @@ PlanXpuJoinPathCommon(PlannerInfo *root,
 		= codegen_build_packed_hashkeys(context,
 										hash_keys_stacked);
 	codegen_build_packed_gistevals(context, pp_info);
+	pp_info->kexp_range_keys_packed
+		= codegen_build_packed_rangekeys(context,
+										 range_keys_stacked);
 	/* LoadVars for each depth */
 	codegen_build_packed_kvars_load(context, pp_info);
 	/* MoveVars for each depth (only GPUs) */
@@ -1620,6 +2029,9 @@ PlanXpuJoinPathCommon(PlannerInfo *root,
 	cscan->custom_plans = custom_plans;
 	cscan->custom_scan_tlist = assign_custom_cscan_tlist(context->tlist_dev,
 														 pp_info);
+	/* DPU pre-filtering of the outer relation, if available */
+	cscan->scan.plan.lefttree = pgstrom_build_dpu_prefilter_plan(root, cpath,
+																 pp_info);
 	return cscan;
 }
 
@@ -1711,20 +2123,235 @@ typedef struct
 	uint32_t		nitems;
 	uint32_t		nrooms;
 	size_t			usage;
+	bool			key_valid;	/* min/max of the inner hash-key, if any */
+	int64_t			key_min;
+	int64_t			key_max;
+	double			grid_extent; /* max half-extent of the geometries, if
+								  * grid-join */
 	struct {
 		HeapTuple	htup;
 		uint32_t	hash;		/* if hash-join or gist-join */
+		bool		range_isnull;	/* if range-join */
+		int64_t		range_key;
 	} rows[1];
 } inner_preload_buffer;
 
-static uint32_t
-get_tuple_hashvalue(pgstromTaskState *pts,
-					pgstromTaskInnerState *istate,
-					TupleTableSlot *inner_slot)
+/*
+ * innerKeyRangeOuterAttnum
+ *
+ * It returns the attribute number of the outer Arrow_Fdw relation, if the
+ * min/max of the inner hash-key at depth=1 can skip the record-batches
+ * that never match the inner relation.
+ */
+static bool
+__innerKeyRangeTypeCompatible(Oid outer_type, Oid inner_type)
+{
+	switch (outer_type)
+	{
+		case INT2OID:
+		case INT4OID:
+		case INT8OID:
+			return (inner_type == INT2OID ||
+					inner_type == INT4OID ||
+					inner_type == INT8OID);
+		case DATEOID:
+		case TIMESTAMPOID:
+		case TIMESTAMPTZOID:
+			return (outer_type == inner_type);
+		default:
+			break;
+	}
+	return false;
+}
+
+static int64_t
+__innerKeyRangeDatum(Oid type_oid, Datum datum)
+{
+	switch (type_oid)
+	{
+		case INT2OID:
+			return DatumGetInt16(datum);
+		case INT4OID:
+		case DATEOID:
+			return DatumGetInt32(datum);
+		default:
+			return DatumGetInt64(datum);
+	}
+}
+
+/*
+ * __geometry_host_rawdata
+ *
+ * It parses the header of the serialized geometry on the host side (see
+ * __geometry_datum_ref_v1 and __geometry_datum_ref_v2), then returns the
+ * position of the geometry type, or NULL if compressed or external.
+ */
+static const char *
+__geometry_host_rawdata(const char *vl_datum,
+						uint16_t *p_geom_flags,
+						const char **p_bbox,
+						const char **p_end)
+{
+	const __GSERIALIZED *gs;
+	const char *pos;
+	uint16_t	geom_flags = 0;
+
+	if (VARATT_IS_EXTERNAL(vl_datum) || VARATT_IS_COMPRESSED(vl_datum))
+		return NULL;
+	gs = (const __GSERIALIZED *)VARDATA_ANY(vl_datum);
+	pos = gs->data;
+	if ((gs->gflags & G2FLAG_VER_0) != 0)
+	{
+		if ((gs->gflags & G2FLAG_Z) != 0)
+			geom_flags |= GEOM_FLAG__Z;
+		if ((gs->gflags & G2FLAG_M) != 0)
+			geom_flags |= GEOM_FLAG__M;
+		if ((gs->gflags & G2FLAG_BBOX) != 0)
+			geom_flags |= GEOM_FLAG__BBOX;
+		if ((gs->gflags & G2FLAG_GEODETIC) != 0)
+			geom_flags |= GEOM_FLAG__GEODETIC;
+		if ((gs->gflags & G2FLAG_EXTENDED) != 0)
+			pos += sizeof(uint64_t);
+	}
+	else
+	{
+		if ((gs->gflags & G1FLAG_Z) != 0)
+			geom_flags |= GEOM_FLAG__Z;
+		if ((gs->gflags & G1FLAG_M) != 0)
+			geom_flags |= GEOM_FLAG__M;
+		if ((gs->gflags & G1FLAG_BBOX) != 0)
+			geom_flags |= GEOM_FLAG__BBOX;
+		if ((gs->gflags & G1FLAG_GEODETIC) != 0)
+			geom_flags |= GEOM_FLAG__GEODETIC;
+	}
+	if (p_bbox)
+		*p_bbox = ((geom_flags & GEOM_FLAG__BBOX) != 0 ? pos : NULL);
+	if ((geom_flags & GEOM_FLAG__BBOX) != 0)
+		pos += geometry_bbox_size(geom_flags);
+	*p_geom_flags = geom_flags;
+	*p_end = VARDATA_ANY(vl_datum) + VARSIZE_ANY_EXHDR(vl_datum);
+
+	return pos;
+}
+
+/*
+ * __innerGridKeyGeometry
+ *
+ * It computes the grid-join key by the center of the bounding-box of the
+ * inner geometry, and its half-extent. It returns false if the geometry is
+ * empty, that never satisfies st_dwithin. The half-extent is infinity if
+ * the bounding-box is not available, so all the cells are checked.
+ */
+static bool
+__innerGridKeyGeometry(const char *vl_datum, double cell_sz,
+					   int64_t *p_key, double *p_extent)
+{
+	const char *pos;
+	const char *bbox_pos;
+	const char *end;
+	uint16_t	geom_flags;
+	uint32_t	gs_type;
+	uint32_t	nitems;
+	double		xmin, xmax;
+	double		ymin, ymax;
+	double		cx, cy;
+	double		extent;
+
+	*p_key = 0;
+	*p_extent = get_float8_infinity();
+	pos = __geometry_host_rawdata(vl_datum, &geom_flags, &bbox_pos, &end);
+	if (!pos ||
+		(geom_flags & GEOM_FLAG__GEODETIC) != 0 ||
+		pos + 2 * sizeof(uint32_t) > end)
+		return true;
+	memcpy(&gs_type, pos, sizeof(uint32_t));
+	memcpy(&nitems, pos + sizeof(uint32_t), sizeof(uint32_t));
+	pos += 2 * sizeof(uint32_t);
+	if (nitems == 0)
+		return false;
+
+	if (bbox_pos)
+	{
+		geom_bbox_2d	bbox;
+
+		memcpy(&bbox, bbox_pos, sizeof(geom_bbox_2d));
+		xmin = bbox.xmin;
+		xmax = bbox.xmax;
+		ymin = bbox.ymin;
+		ymax = bbox.ymax;
+	}
+	else if (gs_type == GEOM_POINTTYPE || gs_type == GEOM_LINETYPE)
+	{
+		uint32_t	unitsz = sizeof(double) * GEOM_FLAGS_NDIMS(geom_flags);
+		POINT2D		pt;
+
+		if ((uint64_t)nitems * unitsz > end - pos)
+			return true;
+		memcpy(&pt, pos, sizeof(POINT2D));
+		xmin = xmax = pt.x;
+		ymin = ymax = pt.y;
+		for (uint32_t i=1; i < nitems; i++)
+		{
+			memcpy(&pt, pos + unitsz * i, sizeof(POINT2D));
+			xmin = Min(xmin, pt.x);
+			xmax = Max(xmax, pt.x);
+			ymin = Min(ymin, pt.y);
+			ymax = Max(ymax, pt.y);
+		}
+	}
+	else
+		return true;
+	if (!isfinite(xmin) || !isfinite(xmax) || xmin > xmax ||
+		!isfinite(ymin) || !isfinite(ymax) || ymin > ymax)
+		return true;
+
+	cx = (xmin + xmax) / 2.0;
+	cy = (ymin + ymax) / 2.0;
+	extent = Max(Max(cx - xmin, xmax - cx),
+				 Max(cy - ymin, ymax - cy));
+	/* a bit larger, not to miss the boundary by rounding errors */
+	*p_extent = extent * (1.0 + 1.0e-9);
+	*p_key = __geom_grid_key(__geom_grid_cell(cx, cell_sz),
+							 __geom_grid_cell(cy, cell_sz));
+	return true;
+}
+
+static AttrNumber
+innerKeyRangeOuterAttnum(pgstromTaskState *pts,
+						 pgstromTaskInnerState *istate)
+{
+	CustomScan *cscan = (CustomScan *)pts->css.ss.ps.plan;
+	ExprState  *o_key;
+	ExprState  *i_key;
+	Var		   *var;
+
+	if (!pts->arrow_state ||
+		istate->depth != 1 ||
+		(istate->join_type != JOIN_INNER &&
+		 istate->join_type != JOIN_RIGHT) ||
+		list_length(istate->hash_outer_keys) != 1 ||
+		list_length(istate->hash_inner_keys) != 1)
+		return InvalidAttrNumber;
+	o_key = linitial(istate->hash_outer_keys);
+	i_key = linitial(istate->hash_inner_keys);
+	var = linitial(fixup_scanstate_expressions(&pts->css.ss,
+											   list_make1(o_key->expr)));
+	if (!IsA(var, Var) ||
+		var->varno != cscan->scan.scanrelid ||
+		var->varattno <= 0 ||
+		!__innerKeyRangeTypeCompatible(var->vartype,
+									   exprType((Node *)i_key->expr)))
+		return InvalidAttrNumber;
+	return var->varattno;
+}
+
+static void
+__innerSlotMoveToScanSlot(pgstromTaskState *pts,
+						  pgstromTaskInnerState *istate,
+						  TupleTableSlot *inner_slot)
 {
 	ExprContext	   *econtext = pts->css.ss.ps.ps_ExprContext;
 	TupleTableSlot *scan_slot = pts->css.ss.ss_ScanTupleSlot;
-	uint32_t		hash = 0xffffffffU;
 	ListCell	   *lc1, *lc2;
 
 	/* move to scan_slot from inner_slot */
@@ -1737,8 +2364,21 @@ get_tuple_hashvalue(pgstromTaskState *pts,
 		scan_slot->tts_isnull[dst] = inner_slot->tts_isnull[src];
 		scan_slot->tts_values[dst] = inner_slot->tts_values[src];
 	}
-	/* calculation of a hash value of this entry */
 	econtext->ecxt_scantuple = scan_slot;
+}
+
+static uint32_t
+get_tuple_hashvalue(pgstromTaskState *pts,
+					pgstromTaskInnerState *istate,
+					TupleTableSlot *inner_slot,
+					inner_preload_buffer *key_range)
+{
+	ExprContext	   *econtext = pts->css.ss.ps.ps_ExprContext;
+	uint32_t		hash = 0xffffffffU;
+	ListCell	   *lc1, *lc2;
+
+	__innerSlotMoveToScanSlot(pts, istate, inner_slot);
+	/* calculation of a hash value of this entry */
 	forboth (lc1, istate->hash_inner_keys,
 			 lc2, istate->hash_inner_funcs)
 	{
@@ -1749,12 +2389,186 @@ get_tuple_hashvalue(pgstromTaskState *pts,
 
 		datum = ExecEvalExpr(es, econtext, &isnull);
 		hash = pg_hash_merge(hash, h_func(isnull, datum));
+		/* min/max of the (single) hash-key, if required */
+		if (key_range && !isnull)
+		{
+			int64_t		ival = __innerKeyRangeDatum(exprType((Node *)es->expr),
+													datum);
+			if (!key_range->key_valid)
+			{
+				key_range->key_min = key_range->key_max = ival;
+				key_range->key_valid = true;
+			}
+			else if (ival < key_range->key_min)
+				key_range->key_min = ival;
+			else if (ival > key_range->key_max)
+				key_range->key_max = ival;
+		}
 	}
 	hash ^= 0xffffffffU;
 
 	return hash;
 }
 
+static int64_t
+get_tuple_range_key(pgstromTaskState *pts,
+					pgstromTaskInnerState *istate,
+					TupleTableSlot *inner_slot,
+					inner_preload_buffer *preload_buf,
+					bool *p_isnull)
+{
+	ExprContext	   *econtext = pts->css.ss.ps.ps_ExprContext;
+	ExprState	   *es = istate->range_inner_key;
+	Datum			datum;
+
+	__innerSlotMoveToScanSlot(pts, istate, inner_slot);
+	datum = ExecEvalExpr(es, econtext, p_isnull);
+	if (*p_isnull)
+		return 0;
+	if (istate->range_grid_distance > 0.0)
+	{
+		int64_t		key;
+		double		extent;
+
+		/* empty geometry is sorted as if NULL */
+		if (!__innerGridKeyGeometry(DatumGetPointer(datum),
+									istate->range_grid_distance,
+									&key, &extent))
+		{
+			*p_isnull = true;
+			return 0;
+		}
+		preload_buf->grid_extent = Max(preload_buf->grid_extent, extent);
+		return key;
+	}
+	return __innerKeyRangeDatum(exprType((Node *)es->expr), datum);
+}
+
+/*
+ * inner_hash_batch
+ *
+ * If all the inner hash-keys are simple references to the by-value columns
+ * of the inner tuples, hash values are computed for every
+ * INNER_HASH_BATCH_SZ tuples at once, without expression evaluation per
+ * tuple and key.
+ */
+#define INNER_HASH_BATCH_SZ		1024
+
+typedef struct
+{
+	int				nkeys;
+	int			   *src_anums;	/* index of tts_values on the inner slot */
+	devtype_info  **dtypes;
+	Oid				key_type;	/* type of the first key, for the key range */
+	uint32_t		head;		/* row index of the first item in the batch */
+	uint32_t		nitems;
+	Datum		   *values;		/* [nkeys * INNER_HASH_BATCH_SZ] */
+	bool		   *isnull;		/* [nkeys * INNER_HASH_BATCH_SZ] */
+} inner_hash_batch;
+
+static inner_hash_batch *
+__innerHashBatchCreate(pgstromTaskInnerState *istate)
+{
+	inner_hash_batch *hbatch;
+	int			nkeys = list_length(istate->hash_inner_keys);
+	int			k = 0;
+	ListCell   *lc1, *lc2, *cell;
+
+	if (nkeys == 0)
+		return NULL;
+	hbatch = palloc0(sizeof(inner_hash_batch));
+	hbatch->nkeys = nkeys;
+	hbatch->src_anums = palloc(sizeof(int) * nkeys);
+	hbatch->dtypes = palloc(sizeof(devtype_info *) * nkeys);
+	foreach (cell, istate->hash_inner_keys)
+	{
+		ExprState  *es = lfirst(cell);
+		Var		   *var = (Var *)es->expr;
+		devtype_info *dtype;
+
+		if (!IsA(var, Var) ||
+			var->varno == INNER_VAR ||
+			var->varno == OUTER_VAR ||
+			var->varattno <= 0)
+			goto bailout;
+		dtype = pgstrom_devtype_lookup(var->vartype);
+		if (!dtype || !dtype->type_byval)
+			goto bailout;
+		/* the scan-slot column must be moved from the inner slot */
+		hbatch->src_anums[k] = -1;
+		forboth (lc1, istate->inner_load_src,
+				 lc2, istate->inner_load_dst)
+		{
+			if (lfirst_int(lc2) == var->varattno)
+			{
+				hbatch->src_anums[k] = lfirst_int(lc1) - 1;
+				break;
+			}
+		}
+		if (hbatch->src_anums[k] < 0)
+			goto bailout;
+		if (k == 0)
+			hbatch->key_type = var->vartype;
+		hbatch->dtypes[k++] = dtype;
+	}
+	hbatch->values = palloc(sizeof(Datum) * nkeys * INNER_HASH_BATCH_SZ);
+	hbatch->isnull = palloc(sizeof(bool)  * nkeys * INNER_HASH_BATCH_SZ);
+	return hbatch;
+
+bailout:
+	pfree(hbatch->src_anums);
+	pfree(hbatch->dtypes);
+	pfree(hbatch);
+	return NULL;
+}
+
+static void
+__innerHashBatchFlush(inner_hash_batch *hbatch,
+					  inner_preload_buffer *preload_buf,
+					  bool track_key_range)
+{
+	uint32_t	hashes[INNER_HASH_BATCH_SZ];
+	uint32_t	nitems = hbatch->nitems;
+
+	for (uint32_t i=0; i < nitems; i++)
+		hashes[i] = 0xffffffffU;
+	for (int k=0; k < hbatch->nkeys; k++)
+	{
+		pgstrom_devtype_hash_batch(hbatch->dtypes[k], nitems,
+								   hbatch->values + k * INNER_HASH_BATCH_SZ,
+								   hbatch->isnull + k * INNER_HASH_BATCH_SZ,
+								   hashes);
+	}
+	for (uint32_t i=0; i < nitems; i++)
+		preload_buf->rows[hbatch->head + i].hash = (hashes[i] ^ 0xffffffffU);
+
+	/* min/max of the (single) hash-key, if required */
+	if (track_key_range)
+	{
+		Oid			type_oid = hbatch->key_type;
+
+		for (uint32_t i=0; i < nitems; i++)
+		{
+			int64_t		ival;
+
+			if (hbatch->isnull[i])
+				continue;
+			ival = __innerKeyRangeDatum(type_oid, hbatch->values[i]);
+			if (!preload_buf->key_valid)
+			{
+				preload_buf->key_min = preload_buf->key_max = ival;
+				preload_buf->key_valid = true;
+			}
+			else if (ival < preload_buf->key_min)
+				preload_buf->key_min = ival;
+			else if (ival > preload_buf->key_max)
+				preload_buf->key_max = ival;
+		}
+	}
+	hbatch->head += nitems;
+	hbatch->nitems = 0;
+}
+
 /*
  * execInnerPreloadOneDepth
  */
@@ -1768,12 +2582,16 @@ execInnerPreloadOneDepth(MemoryContext memcxt,
 	PlanState	   *ps = istate->ps;
 	MemoryContext	oldcxt;
 	inner_preload_buffer *preload_buf;
+	inner_hash_batch *hbatch;
+	bool			track_key_range;
 
 	/* initial alloc of inner_preload_buffer */
 	preload_buf = MemoryContextAlloc(memcxt, offsetof(inner_preload_buffer,
 													  rows[12000]));
 	memset(preload_buf, 0, offsetof(inner_preload_buffer, rows));
 	preload_buf->nrooms = 12000;
+	track_key_range = (innerKeyRangeOuterAttnum(pts, istate) > 0);
+	hbatch = __innerHashBatchCreate(istate);
 
 	ExecStoreAllNullTuple(pts->css.ss.ss_ScanTupleSlot);
 	for (;;)
@@ -1818,9 +2636,28 @@ execInnerPreloadOneDepth(MemoryContext memcxt,
 		}
 		index = preload_buf->nitems++;
 
-		if (istate->hash_inner_keys != NIL)
+		if (hbatch)
+		{
+			uint32_t	j = hbatch->nitems++;
+
+			for (int k=0; k < hbatch->nkeys; k++)
+			{
+				int		anum = hbatch->src_anums[k];
+
+				hbatch->values[k * INNER_HASH_BATCH_SZ + j] = slot->tts_values[anum];
+				hbatch->isnull[k * INNER_HASH_BATCH_SZ + j] = slot->tts_isnull[anum];
+			}
+			preload_buf->rows[index].htup = htup;
+			preload_buf->usage += MAXALIGN(offsetof(kern_hashitem,
+													t.htup) + htup->t_len);
+			if (hbatch->nitems == INNER_HASH_BATCH_SZ)
+				__innerHashBatchFlush(hbatch, preload_buf, track_key_range);
+		}
+		else if (istate->hash_inner_keys != NIL)
 		{
-			uint32_t	hash = get_tuple_hashvalue(pts, istate, slot);
+			uint32_t	hash = get_tuple_hashvalue(pts, istate, slot,
+												   track_key_range
+												   ? preload_buf : NULL);
 
 			preload_buf->rows[index].htup = htup;
 			preload_buf->rows[index].hash = hash;
@@ -1849,22 +2686,163 @@ execInnerPreloadOneDepth(MemoryContext memcxt,
 		{
 			preload_buf->rows[index].htup = htup;
 			preload_buf->rows[index].hash = 0;
+			if (istate->range_inner_key)
+				preload_buf->rows[index].range_key
+					= get_tuple_range_key(pts, istate, slot, preload_buf,
+										  &preload_buf->rows[index].range_isnull);
 			preload_buf->usage += MAXALIGN(offsetof(kern_tupitem,
 													htup) + htup->t_len);
 		}
 		MemoryContextSwitchTo(oldcxt);
 	}
+	if (hbatch && hbatch->nitems > 0)
+		__innerHashBatchFlush(hbatch, preload_buf, track_key_range);
 	istate->preload_buffer = preload_buf;
 	pg_atomic_fetch_add_u64(p_shared_inner_nitems, preload_buf->nitems);
 	pg_atomic_fetch_add_u64(p_shared_inner_usage,  preload_buf->usage);
 }
 
 /*
- * innerPreloadSetupGiSTIndex
+ * innerPreloadSetupPartitions
+ *
+ * When the inner buffer is larger than gpujoin_inner_buffer_limit(), it
+ * partitions the largest inner hash table by the hash value (grace
+ * hash-join). Only one partition is loaded to the inner buffer at
+ * once, and the outer relation is scanned for each partition.
+ * It is available only on the non-parallel plan, because all the inner
+ * tuples are kept in the local memory of this process.
  */
-static void
-__innerPreloadSetupGiSTIndexWalker(char *base,
-								   BlockNumber blkno,
+#define GPUJOIN_INNER_MAX_PARTITIONS	4096
+
+/*
+ * innerPreloadMisestimatedLimit
+ *
+ * The build side of the join was chosen by the planner estimation, but it
+ * is often wrong after multi-way joins. If the preloaded inner relation has
+ * far more rows than the estimation, and even more than the estimated outer
+ * rows, we cannot swap the sides of the running plan any more. Instead, it
+ * returns the length of the inner buffer per pass that holds as many rows
+ * as the planner expected, to switch to the partitioned hash-join; the
+ * outer relation is expected to be small, so it is cheaper to scan it for
+ * each partition than to build the huge hash table at once.
+ * It returns 0, if the estimation looks reasonable.
+ */
+#define GPUJOIN_MISESTIMATE_RATIO		4.0
+#define GPUJOIN_MISESTIMATE_MAX_PARTITIONS	16
+
+static size_t
+innerPreloadMisestimatedLimit(pgstromTaskState *pts, int depth,
+							  size_t inner_sz, size_t limit)
+{
+	pgstromPlanInfo *pp_info = pts->pp_info;
+	pgstromTaskInnerState *istate = &pts->inners[depth-1];
+	double		nitems = istate->preload_buffer->nitems;
+	double		outer_nrows;
+	double		inner_nrows;
+	double		nrows;
+
+	if (!pgstrom_gpujoin_adaptive_partition || nitems == 0.0)
+		return 0;
+	outer_nrows = (depth == 1
+				   ? pp_info->scan_nrows
+				   : pp_info->inners[depth-2].join_nrows);
+	inner_nrows = istate->ps->plan->plan_rows;
+	if (nitems <= outer_nrows ||
+		nitems <= GPUJOIN_MISESTIMATE_RATIO * inner_nrows)
+		return 0;
+	nrows = Max(Max(outer_nrows, inner_nrows), 1.0);
+	elog(DEBUG1, "GpuJoin: inner relation [%d] has %.0f rows, but %.0f rows (outer %.0f rows) are estimated",
+		 depth, nitems, inner_nrows, outer_nrows);
+	/* too many passes also hurts, if the outer estimation is wrong too */
+	return Max((size_t)((double)inner_sz * (nrows / nitems)),
+			   limit / GPUJOIN_MISESTIMATE_MAX_PARTITIONS);
+}
+
+static void
+innerPreloadSetupPartitions(pgstromTaskState *pts, MemoryContext memcxt)
+{
+	size_t		limit = gpujoin_inner_buffer_limit();
+	size_t		total_sz = 0;
+	size_t		largest_sz = 0;
+	size_t		avail_sz;
+	int			largest_depth = 0;
+	uint32_t	nparts;
+	inner_preload_buffer *preload_buf;
+
+	if (limit == 0 ||
+		pts->css.ss.ps.plan->parallel_aware ||
+		(pts->xpu_task_flags & DEVKIND__NVIDIA_GPU) == 0)
+		return;
+
+	for (int i=0; i < pts->num_rels; i++)
+	{
+		pgstromTaskInnerState *istate = &pts->inners[i];
+		size_t		sz;
+
+		preload_buf = istate->preload_buffer;
+		if (istate->join_type == JOIN_RIGHT ||
+			istate->join_type == JOIN_FULL)
+			return;		/* outer-join map is not partitioned */
+		if (!preload_buf)
+			continue;
+		sz = preload_buf->usage + 2 * sizeof(uint64_t) * preload_buf->nitems;
+		total_sz += sz;
+		if (istate->hash_inner_keys != NIL &&
+			istate->hash_outer_keys != NIL &&
+			istate->gist_irel == NULL &&
+			(istate->join_type == JOIN_INNER ||
+			 istate->join_type == JOIN_LEFT) &&
+			sz > largest_sz)
+		{
+			largest_sz = sz;
+			largest_depth = i+1;
+		}
+	}
+	if (largest_depth == 0)
+		return;
+	if (total_sz <= limit)
+	{
+		/* partitioned anyway, if the inner relation is misestimated */
+		size_t	__limit = innerPreloadMisestimatedLimit(pts, largest_depth,
+														largest_sz, limit);
+		if (__limit == 0 || total_sz <= __limit)
+			return;
+		limit = __limit;
+	}
+	/* other depths occupies most of the inner buffer, so it makes no sense */
+	avail_sz = limit - Min(limit, total_sz - largest_sz);
+	if (avail_sz < limit / 4)
+		return;
+	nparts = Min((largest_sz + avail_sz - 1) / avail_sz,
+				 GPUJOIN_INNER_MAX_PARTITIONS);
+	if (nparts < 2)
+		return;
+
+	pts->inner_part_depth  = largest_depth;
+	pts->inner_part_nparts = nparts;
+	pts->inner_part_id     = 0;
+	pts->inner_part_nitems = MemoryContextAllocZero(memcxt, sizeof(uint32_t) * nparts);
+	pts->inner_part_usage  = MemoryContextAllocZero(memcxt, sizeof(uint64_t) * nparts);
+	preload_buf = pts->inners[largest_depth-1].preload_buffer;
+	for (uint32_t index=0; index < preload_buf->nitems; index++)
+	{
+		HeapTuple	htup = preload_buf->rows[index].htup;
+		uint32_t	part = KERN_HASH_PARTITION(preload_buf->rows[index].hash,
+											   nparts);
+		pts->inner_part_nitems[part]++;
+		pts->inner_part_usage[part] += MAXALIGN(offsetof(kern_hashitem,
+														 t.htup) + htup->t_len);
+	}
+	elog(DEBUG1, "GpuJoin: inner hash table [%d] (%zu bytes) is split into %u partitions",
+		 largest_depth, largest_sz, nparts);
+}
+
+/*
+ * innerPreloadSetupGiSTIndex
+ */
+static void
+__innerPreloadSetupGiSTIndexWalker(char *base,
+								   BlockNumber blkno,
 								   BlockNumber nblocks,
 								   BlockNumber parent_blkno,
 								   OffsetNumber parent_offno)
@@ -1896,15 +2874,311 @@ __innerPreloadSetupGiSTIndexWalker(char *base,
 	}
 }
 
+/*
+ * innerPreloadBuildGiSTRTree
+ *
+ * It rebuilds the leaf keys of the GiST-index (box2df of PostGIS) to
+ * the packed R-tree by sort-tile-recursive (STR), then replaces the
+ * GiST-index pages by the R-tree. GPU kernel walks on the compact nodes
+ * with small fanout, instead of the 8KB pages, and the leaf entries
+ * already point the inner tuples on the kds_hash.
+ */
+typedef struct
+{
+	ItemPointerData	ctid;
+	uint32_t		t_off;
+} gist_rtree_ctid_entry;
+
+typedef struct
+{
+	geom_bbox_2d	key;
+	uint32_t		value;
+} gist_rtree_entry;
+
+static int
+__gist_rtree_entry_comp_x(const void *__a, const void *__b)
+{
+	const gist_rtree_entry *a = __a;
+	const gist_rtree_entry *b = __b;
+	float	a_x = a->key.xmin + a->key.xmax;
+	float	b_x = b->key.xmin + b->key.xmax;
+
+	if (a_x < b_x)
+		return -1;
+	if (a_x > b_x)
+		return 1;
+	return 0;
+}
+
+static int
+__gist_rtree_entry_comp_y(const void *__a, const void *__b)
+{
+	const gist_rtree_entry *a = __a;
+	const gist_rtree_entry *b = __b;
+	float	a_y = a->key.ymin + a->key.ymax;
+	float	b_y = b->key.ymin + b->key.ymax;
+
+	if (a_y < b_y)
+		return -1;
+	if (a_y > b_y)
+		return 1;
+	return 0;
+}
+
+/*
+ * __innerPreloadBuildGiSTRTreeLevel
+ *
+ * It packs the entries to the nodes of the next level, and returns
+ * the number of the new nodes. entries[] are overwritten by the entries
+ * that point the new nodes.
+ */
+static uint32_t
+__innerPreloadBuildGiSTRTreeLevel(kern_gist_rtree_node **p_nodes,
+								  uint32_t *p_nnodes,
+								  uint32_t *p_nrooms,
+								  gist_rtree_entry *entries,
+								  uint32_t nitems,
+								  bool is_leaf)
+{
+	uint32_t	npages = (nitems + KERN_GIST_RTREE_FANOUT - 1) / KERN_GIST_RTREE_FANOUT;
+	uint32_t	nslices = (uint32_t)ceil(sqrt((double)npages));
+	uint32_t	slice_sz = nslices * KERN_GIST_RTREE_FANOUT;
+	uint32_t	count = 0;
+
+	qsort(entries, nitems, sizeof(gist_rtree_entry),
+		  __gist_rtree_entry_comp_x);
+	for (uint32_t base=0; base < nitems; base += slice_sz)
+	{
+		uint32_t	nslice = Min(slice_sz, nitems - base);
+
+		qsort(entries + base, nslice, sizeof(gist_rtree_entry),
+			  __gist_rtree_entry_comp_y);
+		for (uint32_t pos=0; pos < nslice; pos += KERN_GIST_RTREE_FANOUT)
+		{
+			kern_gist_rtree_node *node;
+			gist_rtree_entry *curr = entries + base + pos;
+			uint32_t	node_id;
+			geom_bbox_2d bbox;
+
+			if (*p_nnodes >= *p_nrooms)
+			{
+				*p_nrooms = 2 * *p_nrooms + 64;
+				*p_nodes = repalloc_huge(*p_nodes, sizeof(kern_gist_rtree_node) *
+										 (size_t)*p_nrooms);
+			}
+			node_id = (*p_nnodes)++;
+			node = &(*p_nodes)[node_id];
+			memset(node, 0, sizeof(kern_gist_rtree_node));
+			node->nitems = Min(KERN_GIST_RTREE_FANOUT, nslice - pos);
+			node->parent = UINT_MAX;
+			bbox = curr[0].key;
+			for (uint32_t i=0; i < node->nitems; i++)
+			{
+				node->keys[i] = curr[i].key;
+				node->values[i] = curr[i].value;
+				bbox.xmin = Min(bbox.xmin, curr[i].key.xmin);
+				bbox.xmax = Max(bbox.xmax, curr[i].key.xmax);
+				bbox.ymin = Min(bbox.ymin, curr[i].key.ymin);
+				bbox.ymax = Max(bbox.ymax, curr[i].key.ymax);
+				if (!is_leaf)
+				{
+					Assert(curr[i].value < node_id);
+					(*p_nodes)[curr[i].value].parent
+						= node_id * KERN_GIST_RTREE_FANOUT + i;
+				}
+			}
+			/* the upper level entries; never overrun the unprocessed ones */
+			entries[count].key = bbox;
+			entries[count].value = node_id;
+			count++;
+		}
+	}
+	return count;
+}
+
+static bool
+innerPreloadBuildGiSTRTree(kern_multirels *h_kmrels, int dindex,
+						   Relation i_rel)
+{
+	kern_data_store *kds_hash = KERN_MULTIRELS_INNER_KDS(h_kmrels, dindex);
+	kern_data_store *kds_gist = KERN_MULTIRELS_GIST_INDEX(h_kmrels, dindex);
+	uint64_t   *row_index = KDS_GET_ROWINDEX(kds_hash);
+	devtype_info *dtype;
+	HASHCTL		hctl;
+	HTAB	   *ctid_htab;
+	gist_rtree_entry *entries;
+	uint32_t	nitems = 0;
+	uint32_t	nrooms = 0;
+	kern_gist_rtree_node *nodes;
+	uint32_t	nnodes = 0;
+	uint32_t	nleaf_nodes;
+	uint32_t	node_nrooms = 64;
+	kern_gist_rtree *rtree;
+	size_t		sz;
+
+	/* only box2df index of PostGIS is supported right now */
+	if (RelationGetDescr(i_rel)->natts != 1 ||
+		kds_gist->ncols != 1 ||
+		kds_gist->colmeta[0].attlen != sizeof(geom_bbox_2d))
+		return false;
+	dtype = pgstrom_devtype_lookup(TupleDescAttr(RelationGetDescr(i_rel),
+												 0)->atttypid);
+	if (!dtype || dtype->type_code != TypeOpCode__box2df)
+		return false;
+
+	/* inner tuples indexed by ctid */
+	memset(&hctl, 0, sizeof(HASHCTL));
+	hctl.keysize = sizeof(ItemPointerData);
+	hctl.entrysize = sizeof(gist_rtree_ctid_entry);
+	hctl.hcxt = CurrentMemoryContext;
+	ctid_htab = hash_create("GiST R-Tree ctid", Max(kds_hash->nitems, 1024),
+							&hctl,
+							HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+	for (uint32_t i=0; i < kds_hash->nitems; i++)
+	{
+		kern_tupitem *tupitem = (kern_tupitem *)
+			((char *)kds_hash + kds_hash->length - row_index[i]);
+		gist_rtree_ctid_entry *hentry;
+
+		hentry = hash_search(ctid_htab, &tupitem->htup.t_ctid,
+							 HASH_ENTER, NULL);
+		hentry->t_off = __kds_packed((char *)&tupitem->htup -
+									 (char *)kds_hash);
+	}
+
+	/* pick up the leaf keys */
+	nrooms = Max(kds_hash->nitems, 1);
+	entries = MemoryContextAllocHuge(CurrentMemoryContext,
+									 sizeof(gist_rtree_entry) * (size_t)nrooms);
+	for (BlockNumber k=0; k < kds_gist->nitems; k++)
+	{
+		Page		page = (Page)KDS_BLOCK_PGPAGE(kds_gist, k);
+		OffsetNumber i, maxoff;
+
+		if (GistPageIsDeleted(page) || !GistPageIsLeaf(page))
+			continue;
+		maxoff = PageGetMaxOffsetNumber(page);
+		for (i=FirstOffsetNumber; i <= maxoff; i++)
+		{
+			ItemId		iid = PageGetItemId(page, i);
+			IndexTuple	itup;
+			gist_rtree_ctid_entry *hentry;
+
+			if (!ItemIdIsNormal(iid))
+				continue;
+			itup = (IndexTuple) PageGetItem(page, iid);
+			if (IndexTupleHasNulls(itup))
+				continue;
+			hentry = hash_search(ctid_htab, &itup->t_tid, HASH_FIND, NULL);
+			if (!hentry)
+				continue;	/* not loaded */
+			if (nitems >= nrooms)
+			{
+				nrooms = 2 * nrooms + 1024;
+				entries = repalloc_huge(entries, sizeof(gist_rtree_entry) *
+										(size_t)nrooms);
+			}
+			memcpy(&entries[nitems].key,
+				   (char *)itup + MAXALIGN(sizeof(IndexTupleData)),
+				   sizeof(geom_bbox_2d));
+			entries[nitems].value = hentry->t_off;
+			nitems++;
+		}
+	}
+	hash_destroy(ctid_htab);
+
+	/* build the packed R-tree bottom up */
+	nodes = MemoryContextAllocHuge(CurrentMemoryContext,
+								   sizeof(kern_gist_rtree_node) * node_nrooms);
+	if (nitems > 0)
+	{
+		nitems = __innerPreloadBuildGiSTRTreeLevel(&nodes, &nnodes, &node_nrooms,
+												   entries, nitems, true);
+		nleaf_nodes = nnodes;
+		while (nitems > 1)
+			nitems = __innerPreloadBuildGiSTRTreeLevel(&nodes, &nnodes, &node_nrooms,
+													   entries, nitems, false);
+	}
+	else
+		nleaf_nodes = 0;
+	pfree(entries);
+
+	/* replace the GiST-index pages, if it fits */
+	sz = offsetof(kern_gist_rtree, nodes) + sizeof(kern_gist_rtree_node) * (size_t)nnodes;
+	if (kds_gist->block_offset + sz > kds_gist->length)
+	{
+		pfree(nodes);
+		return false;
+	}
+	rtree = (kern_gist_rtree *)((char *)kds_gist + kds_gist->block_offset);
+	memset(rtree, 0, offsetof(kern_gist_rtree, nodes));
+	rtree->nnodes = nnodes;
+	rtree->nleaf_nodes = nleaf_nodes;
+	if (nnodes > 0)
+		memcpy(rtree->nodes, nodes, sizeof(kern_gist_rtree_node) * (size_t)nnodes);
+	pfree(nodes);
+
+	elog(DEBUG1, "GpuJoin: GiST-index [%d] is packed to R-tree (%u nodes, %zu bytes)",
+		 dindex+1, nnodes, sz);
+	return true;
+}
+
 static void
-innerPreloadSetupGiSTIndex(kern_data_store *kds_gist)
+innerPreloadSetupGiSTIndex(pgstromTaskState *pts, int dindex)
 {
+	kern_multirels *h_kmrels = pts->h_kmrels;
+	kern_data_store *kds_gist = KERN_MULTIRELS_GIST_INDEX(h_kmrels, dindex);
+
+	h_kmrels->chunks[dindex].gist_rtree = false;
+	if (pgstrom_gpujoin_gist_rtree &&
+		(pts->xpu_task_flags & DEVKIND__NVIDIA_GPU) != 0 &&
+		innerPreloadBuildGiSTRTree(h_kmrels, dindex,
+								   pts->inners[dindex].gist_irel))
+	{
+		h_kmrels->chunks[dindex].gist_rtree = true;
+		return;
+	}
 	__innerPreloadSetupGiSTIndexWalker((char *)KDS_BLOCK_PGPAGE(kds_gist, 0),
 									   0, kds_gist->nitems,
 									   InvalidBlockNumber,
 									   InvalidOffsetNumber);
 }
 
+/*
+ * innerPreloadCopyGiSTIndex
+ *
+ * It copies the GiST-index blocks onto the host inner buffer. All the
+ * processes in the setup phase pick up the blocks by the shared counter,
+ * then the last one links the parent blocks by innerPreloadSetupGiSTIndex.
+ */
+static void
+innerPreloadCopyGiSTIndex(kern_data_store *kds_gist,
+						  Relation i_rel,
+						  pgstromSharedInnerState *ps_inner)
+{
+	uint32_t	k;
+
+	Assert(kds_gist->format == KDS_FORMAT_BLOCK);
+	while ((k = pg_atomic_fetch_add_u32(&ps_inner->gist_block_index, 1)) < kds_gist->nitems)
+	{
+		Buffer		buffer;
+		Page		page;
+		PageHeader	hpage;
+
+		buffer = ReadBuffer(i_rel, k);
+		LockBuffer(buffer, BUFFER_LOCK_SHARE);
+		page = BufferGetPage(buffer);
+		hpage = KDS_BLOCK_PGPAGE(kds_gist, k);
+
+		memcpy(hpage, page, BLCKSZ);
+		hpage->pd_lsn.xlogid = InvalidBlockNumber;
+		hpage->pd_lsn.xrecoff = InvalidOffsetNumber;
+		KDS_BLOCK_BLCKNR(kds_gist, k) = k;
+
+		UnlockReleaseBuffer(buffer);
+	}
+}
+
 /*
  * innerPreloadAllocHostBuffer
  *
@@ -1917,6 +3191,7 @@ innerPreloadAllocHostBuffer(pgstromTaskState *pts)
 	kern_multirels	   *h_kmrels = NULL;
 	kern_data_store	   *kds = NULL;
 	size_t				offset;
+	uint64_t			geom_usage;
 
 	/* other backend already setup the buffer metadata */
 	if (ps_state->preload_shmem_length > 0)
@@ -1928,6 +3203,7 @@ innerPreloadAllocHostBuffer(pgstromTaskState *pts)
 	 */
 again:
 	offset = MAXALIGN(offsetof(kern_multirels, chunks[pts->num_rels]));
+	geom_usage = 0;
 	for (int i=0; i < pts->num_rels; i++)
 	{
 		pgstromTaskInnerState *istate = &pts->inners[i];
@@ -1936,11 +3212,28 @@ again:
 		uint64_t	usage;
 		size_t		nbytes;
 
-		nrooms = pg_atomic_read_u64(&ps_state->inners[i].inner_nitems);
-		usage  = pg_atomic_read_u64(&ps_state->inners[i].inner_usage);
+		if (pts->inner_part_depth == i+1)
+		{
+			/* grace hash-join; sized by the largest partition */
+			nrooms = usage = 0;
+			for (uint32_t k=0; k < pts->inner_part_nparts; k++)
+			{
+				nrooms = Max(nrooms, pts->inner_part_nitems[k]);
+				usage  = Max(usage,  pts->inner_part_usage[k]);
+			}
+		}
+		else
+		{
+			nrooms = pg_atomic_read_u64(&ps_state->inners[i].inner_nitems);
+			usage  = pg_atomic_read_u64(&ps_state->inners[i].inner_usage);
+		}
 		if (nrooms >= UINT_MAX)
 			elog(ERROR, "GpuJoin: Inner Relation[%d] has %lu tuples, too large",
 				 i+1, nrooms);
+		if (pgstrom_gpujoin_geometry_index &&
+			(pts->xpu_task_flags & DEVKIND__NVIDIA_GPU) != 0 &&
+			istate->geom_anums != NIL)
+			geom_usage += usage;
 		if (h_kmrels)
 		{
 			kds = (kern_data_store *)((char *)h_kmrels + offset);
@@ -1963,8 +3256,82 @@ again:
 									  KDS_FORMAT_HASH);
 				kds->hash_nslots = nslots;
 				memset(KDS_GET_HASHSLOT_BASE(kds), 0, sizeof(uint64_t) * nslots);
+				if (pts->inner_part_depth == i+1)
+				{
+					h_kmrels->chunks[i].hash_nparts = pts->inner_part_nparts;
+					h_kmrels->chunks[i].hash_partid = pts->inner_part_id;
+				}
+				/* hash-items are linked by GPU kernel */
+				if (pgstrom_gpuhashjoin_build_on_gpu &&
+					(pts->xpu_task_flags & DEVKIND__NVIDIA_GPU) != 0)
+					h_kmrels->chunks[i].hash_gpu_build = true;
 			}
 			offset += nbytes;
+
+			/*
+			 * Bucketized index of the hash table for GPU; item offsets
+			 * are kept in uint32 by MAXALIGN unit, so KDS must be less
+			 * than 32GB.
+			 */
+			if (pgstrom_gpuhashjoin_bucketized &&
+				(pts->xpu_task_flags & DEVKIND__NVIDIA_GPU) != 0 &&
+				nbytes / MAXIMUM_ALIGNOF < UINT_MAX)
+			{
+				uint32_t	nbuckets = Max(1, (nrooms + KERN_HASHBUCKET_FILL - 1) /
+										   KERN_HASHBUCKET_FILL);
+
+				offset = TYPEALIGN(sizeof(kern_hashbucket), offset);
+				nbytes = sizeof(kern_hashbucket) * (size_t)nbuckets;
+				if (h_kmrels)
+				{
+					h_kmrels->chunks[i].hash_nbuckets = nbuckets;
+					h_kmrels->chunks[i].hash_bucket_offset = offset;
+					memset((char *)h_kmrels + offset, 0, nbytes);
+				}
+				offset += nbytes;
+			}
+
+			/*
+			 * Bloom-filter of the inner hash-keys; GPU kernel checks it
+			 * prior to the hash table probe.
+			 */
+			if (pgstrom_gpujoin_bloom_filter &&
+				(pts->xpu_task_flags & DEVKIND__NVIDIA_GPU) != 0)
+			{
+				uint64_t	nblocks = ((nrooms * KERN_BLOOM_BITS_PER_KEY +
+										KERN_BLOOM_BLOCK_NWORDS * 32 - 1) /
+									   (KERN_BLOOM_BLOCK_NWORDS * 32));
+
+				nblocks = Min(Max(nblocks, 1), UINT_MAX);
+				nbytes = sizeof(uint32_t) * KERN_BLOOM_BLOCK_NWORDS * nblocks;
+				if (h_kmrels)
+				{
+					h_kmrels->chunks[i].bloom_nblocks = nblocks;
+					h_kmrels->chunks[i].bloom_offset = offset;
+					memset((char *)h_kmrels + offset, 0, nbytes);
+				}
+				offset += nbytes;
+			}
+
+			/*
+			 * Heavy-hitters of the inner hash-keys; it is filled up after
+			 * all the inner tuples are loaded. LEFT/FULL OUTER JOIN is not
+			 * supported, because the GPU kernel cannot tell whether an outer
+			 * tuple matched when its inner tuples are distributed.
+			 */
+			if (pgstrom_gpuhashjoin_skew_threshold > 0 &&
+				(pts->xpu_task_flags & DEVKIND__NVIDIA_GPU) != 0 &&
+				(istate->join_type == JOIN_INNER ||
+				 istate->join_type == JOIN_RIGHT))
+			{
+				nbytes = MAXALIGN(sizeof(kern_hashskew) * KERN_HASHSKEW_MAX_KEYS);
+				if (h_kmrels)
+				{
+					h_kmrels->chunks[i].hash_nskews = 0;
+					h_kmrels->chunks[i].hash_skew_offset = offset;
+				}
+				offset += nbytes;
+			}
 		}
 		else if (istate->gist_irel != NULL)
 		{
@@ -2000,28 +3367,10 @@ again:
 				setup_kern_data_store(kds, i_tupdesc, nbytes,
 									  KDS_FORMAT_BLOCK);
 				kds->block_offset = block_offset;
-				for (int k=0; k < nblocks; k++)
-				{
-					Buffer		buffer;
-					Page		page;
-					PageHeader	hpage;
-
-					buffer = ReadBuffer(i_rel, k);
-					LockBuffer(buffer, BUFFER_LOCK_SHARE);
-					page = BufferGetPage(buffer);
-					hpage = KDS_BLOCK_PGPAGE(kds, k);
-
-					memcpy(hpage, page, BLCKSZ);
-					hpage->pd_lsn.xlogid = InvalidBlockNumber;
-					hpage->pd_lsn.xrecoff = InvalidOffsetNumber;
-					KDS_BLOCK_BLCKNR(kds, k) = k;
-
-					UnlockReleaseBuffer(buffer);
-				}
 				kds->length = block_offset + BLCKSZ * nblocks;
 				kds->nitems = nblocks;
 				kds->block_nloaded = nblocks;
-				innerPreloadSetupGiSTIndex(kds);
+				/* index blocks are copied by innerPreloadCopyGiSTIndex */
 			}
 			offset += (block_offset + BLCKSZ * nblocks);
 		}
@@ -2037,6 +3386,35 @@ again:
 				h_kmrels->chunks[i].is_nestloop = true;
 			}
 			offset += nbytes;
+
+			/*
+			 * Range-Join - keys of the inner tuples are sorted along with
+			 * the row-index, once all the inner tuples are loaded.
+			 */
+			if (istate->range_inner_key)
+			{
+				int		strategy = istate->range_strategy;
+
+				nbytes = (MAXALIGN(sizeof(int64_t) * nrooms) +
+						  MAXALIGN(sizeof(bool) * nrooms));
+				if (h_kmrels)
+				{
+					h_kmrels->chunks[i].range_keys_offset = offset;
+					h_kmrels->chunks[i].range_nulls_offset
+						= offset + MAXALIGN(sizeof(int64_t) * nrooms);
+					h_kmrels->chunks[i].range_desc
+						= (strategy == BTLessStrategyNumber ||
+						   strategy == BTLessEqualStrategyNumber);
+					h_kmrels->chunks[i].range_inclusive
+						= (strategy == BTLessEqualStrategyNumber ||
+						   strategy == BTGreaterEqualStrategyNumber);
+					h_kmrels->chunks[i].range_grid_distance
+						= istate->range_grid_distance;
+					h_kmrels->chunks[i].range_grid_extent
+						= ps_state->inners[i].inner_grid_extent;
+				}
+				offset += nbytes;
+			}
 		}
 
 		if (istate->join_type == JOIN_RIGHT ||
@@ -2057,6 +3435,32 @@ again:
 			if (h_kmrels)
 				h_kmrels->chunks[i].left_outer = true;
 		}
+		if (h_kmrels)
+		{
+			h_kmrels->chunks[i].semi_join = (istate->join_type == JOIN_SEMI);
+			h_kmrels->chunks[i].anti_join = (istate->join_type == JOIN_ANTI);
+		}
+	}
+
+	/*
+	 * Edge index of the inner polygons; it is built after all the inner
+	 * tuples are loaded, within the half of the inner buffer usage that
+	 * may contain geometry values.
+	 */
+	if (geom_usage > 0)
+	{
+		size_t		nbytes = MAXALIGN(offsetof(kern_geom_index, entries) +
+									  geom_usage / 2);
+
+		offset = MAXALIGN(offset);
+		if (h_kmrels)
+		{
+			h_kmrels->geom_index_offset = offset;
+			h_kmrels->geom_index_length = nbytes;
+			memset((char *)h_kmrels + offset, 0,
+				   offsetof(kern_geom_index, entries));
+		}
+		offset += nbytes;
 	}
 
 	/*
@@ -2083,17 +3487,23 @@ again:
  * __innerPreloadSetupHeapBuffer
  */
 static void
-__innerPreloadSetupHeapBuffer(kern_data_store *kds,
+__innerPreloadSetupHeapBuffer(kern_multirels *h_kmrels, int dindex,
 							  pgstromTaskInnerState *istate,
 							  uint32_t base_nitems,
 							  uint64_t base_usage)
 {
+	kern_data_store *kds = KERN_MULTIRELS_INNER_KDS(h_kmrels, dindex);
+	int64_t	   *range_keys = KERN_MULTIRELS_RANGE_KEYS(h_kmrels, dindex);
+	bool	   *range_nulls = NULL;
 	uint64_t   *row_index = KDS_GET_ROWINDEX(kds);
 	uint32_t	rowid = base_nitems;
 	char	   *tail_pos = (char *)kds + kds->length;
 	char	   *curr_pos = (tail_pos - base_usage);
 	inner_preload_buffer *preload_buf = istate->preload_buffer;
-	
+
+	if (range_keys)
+		range_nulls = (bool *)((char *)h_kmrels +
+							   h_kmrels->chunks[dindex].range_nulls_offset);
 	for (uint32_t index=0; index < preload_buf->nitems; index++)
 	{
 		HeapTuple	htup = preload_buf->rows[index].htup;
@@ -2107,22 +3517,118 @@ __innerPreloadSetupHeapBuffer(kern_data_store *kds,
 		titem->rowid = rowid;
 		memcpy(&titem->htup, htup->t_data, htup->t_len);
 		memcpy(&titem->htup.t_ctid, &htup->t_self, sizeof(ItemPointerData));
-
+		if (range_keys)
+		{
+			range_keys[rowid]  = preload_buf->rows[index].range_key;
+			range_nulls[rowid] = preload_buf->rows[index].range_isnull;
+		}
 		row_index[rowid++] = (tail_pos - curr_pos);
 	}
 }
 
+/*
+ * innerPreloadSortRangeKeys
+ *
+ * It sorts the row-index of the inner KDS by the keys of range-join, after
+ * all the inner tuples are loaded. NULL keys come first, then ascending or
+ * descending order according to the strategy of the range-join clause.
+ * tupitem->rowid is also renumbered by the new position, because both of
+ * GPU kernel and CPU-fallback assume outer-join map is indexed by them.
+ */
+typedef struct
+{
+	int64_t		key;
+	uint64_t	offset;
+	bool		isnull;
+} range_sort_item;
+
+static int
+__range_sort_item_compare(const void *__a, const void *__b)
+{
+	const range_sort_item *a = __a;
+	const range_sort_item *b = __b;
+
+	if (a->isnull || b->isnull)
+		return (int)b->isnull - (int)a->isnull;
+	if (a->key < b->key)
+		return -1;
+	if (a->key > b->key)
+		return 1;
+	return 0;
+}
+
+static void
+innerPreloadSortRangeKeys(kern_multirels *h_kmrels)
+{
+	for (int i=0; i < h_kmrels->num_rels; i++)
+	{
+		kern_data_store *kds = KERN_MULTIRELS_INNER_KDS(h_kmrels, i);
+		int64_t	   *range_keys = KERN_MULTIRELS_RANGE_KEYS(h_kmrels, i);
+		bool	   *range_nulls;
+		uint64_t   *row_index;
+		range_sort_item *items;
+		uint32_t	nitems;
+		uint32_t	nnulls = 0;
+
+		if (!range_keys)
+			continue;
+		Assert(kds->format == KDS_FORMAT_ROW);
+		range_nulls = (bool *)((char *)h_kmrels +
+							   h_kmrels->chunks[i].range_nulls_offset);
+		row_index = KDS_GET_ROWINDEX(kds);
+		nitems = kds->nitems;
+		items = palloc_extended(sizeof(range_sort_item) * Max(nitems, 1),
+								MCXT_ALLOC_HUGE);
+		for (uint32_t k=0; k < nitems; k++)
+		{
+			items[k].key    = range_keys[k];
+			items[k].offset = row_index[k];
+			items[k].isnull = range_nulls[k];
+			if (range_nulls[k])
+				nnulls++;
+		}
+		qsort(items, nitems, sizeof(range_sort_item),
+			  __range_sort_item_compare);
+		for (uint32_t k=0; k < nitems; k++)
+		{
+			kern_tupitem *titem;
+			uint32_t	j = k;
+
+			/* descending order, except for the NULL keys at the head */
+			if (h_kmrels->chunks[i].range_desc && k >= nnulls)
+				j = nitems - 1 - (k - nnulls);
+			range_keys[j] = items[k].key;
+			row_index[j]  = items[k].offset;
+			range_nulls[j] = items[k].isnull;
+			titem = (kern_tupitem *)((char *)kds + kds->length - items[k].offset);
+			titem->rowid = j;
+		}
+		h_kmrels->chunks[i].range_nnulls = nnulls;
+		pfree(items);
+	}
+}
+
 /*
  * __innerPreloadSetupHashBuffer
+ *
+ * It copies the inner tuples onto the hash-items. Unless hash table is
+ * built by GPU kernel, it also links them to the hash-slot and buckets.
  */
 static void
-__innerPreloadSetupHashBuffer(kern_data_store *kds,
+__innerPreloadSetupHashBuffer(kern_multirels *h_kmrels, int dindex,
 							  pgstromTaskInnerState *istate,
 							  uint32_t base_nitems,
 							  uint64_t base_usage)
 {
+	kern_data_store *kds = KERN_MULTIRELS_INNER_KDS(h_kmrels, dindex);
+	kern_hashbucket *buckets = KERN_MULTIRELS_HASH_BUCKETS(h_kmrels, dindex);
+	uint32_t	nbuckets = h_kmrels->chunks[dindex].hash_nbuckets;
+	uint32_t	nparts = h_kmrels->chunks[dindex].hash_nparts;
+	uint32_t	part_id = h_kmrels->chunks[dindex].hash_partid;
+	bool		gpu_build = h_kmrels->chunks[dindex].hash_gpu_build;
+	uint32_t   *bloom = KERN_MULTIRELS_BLOOM_FILTER(h_kmrels, dindex);
+	uint32_t	bloom_nblocks = h_kmrels->chunks[dindex].bloom_nblocks;
 	uint64_t   *row_index = KDS_GET_ROWINDEX(kds);
-	uint64_t   *hash_slot = KDS_GET_HASHSLOT_BASE(kds);
 	uint32_t	rowid = base_nitems;
 	char	   *tail_pos = (char *)kds + kds->length;
 	char	   *curr_pos = (tail_pos - base_usage);
@@ -2132,34 +3638,506 @@ __innerPreloadSetupHashBuffer(kern_data_store *kds,
 	{
 		HeapTuple	htup = preload_buf->rows[index].htup;
 		uint32_t	hash = preload_buf->rows[index].hash;
-		uint32_t	hindex = hash % kds->hash_nslots;
-		uint64_t	next, self;
+		uint64_t	self;
 		size_t		sz;
 		kern_hashitem *hitem;
 
+		/* grace hash-join loads only the current partition */
+		if (nparts > 1 && KERN_HASH_PARTITION(hash, nparts) != part_id)
+			continue;
 		sz = MAXALIGN(offsetof(kern_hashitem, t.htup) + htup->t_len);
 		curr_pos -= sz;
 		self = (tail_pos - curr_pos);
 
-		next = __atomic_exchange_uint64(&hash_slot[hindex], self);
 		hitem = (kern_hashitem *)curr_pos;
-		hitem->next = next;
+		hitem->next = 0;
 		hitem->hash = hash;
 		hitem->__padding__ = 0;
 		hitem->t.t_len = htup->t_len;
 		hitem->t.rowid = rowid;
 		memcpy(&hitem->t.htup, htup->t_data, htup->t_len);
 		memcpy(&hitem->t.htup.t_ctid, &htup->t_self, sizeof(ItemPointerData));
-
+		if (!gpu_build)
+		{
+			KDS_HASH_INSERT_ITEM(kds, hitem, self);
+			if (buckets && !KERN_HASHBUCKET_INSERT(buckets, nbuckets,
+												   hash, self))
+				elog(ERROR, "GpuHashJoin: no empty slot in the hash buckets");
+			if (bloom)
+				KERN_BLOOM_FILTER_INSERT(bloom, bloom_nblocks, hash);
+		}
 		row_index[rowid++] = (tail_pos - (char *)&hitem->t);
 		Assert(curr_pos >= (char *)kds + KDS_HEAD_LENGTH(kds) + sizeof(uint64_t) * (kds->hash_nslots + rowid));
 	}
 }
 
+/*
+ * innerPreloadSetupHashSkews
+ *
+ * It detects the heavy-hitters of the inner hash table by counting the hash
+ * values, then gathers their tuples at the head of the row-index. Like the
+ * range-join, tupitem->rowid is renumbered by the new position. Hash-chains,
+ * buckets and bloom-filter are kept as is, because they are linked by offset.
+ */
+typedef struct
+{
+	uint32_t	hash;
+	uint32_t	index;
+} hash_skew_item;
+
+static int
+__hash_skew_item_compare(const void *__a, const void *__b)
+{
+	const hash_skew_item *a = __a;
+	const hash_skew_item *b = __b;
+
+	if (a->hash != b->hash)
+		return (a->hash < b->hash ? -1 : 1);
+	if (a->index != b->index)
+		return (a->index < b->index ? -1 : 1);
+	return 0;
+}
+
+static int
+__hash_skew_compare_by_nitems(const void *__a, const void *__b)
+{
+	const kern_hashskew *a = __a;
+	const kern_hashskew *b = __b;
+
+	if (a->nitems != b->nitems)
+		return (a->nitems > b->nitems ? -1 : 1);
+	return 0;
+}
+
+static int
+__hash_skew_compare_by_hash(const void *__a, const void *__b)
+{
+	const kern_hashskew *a = __a;
+	const kern_hashskew *b = __b;
+
+	if (a->hash != b->hash)
+		return (a->hash < b->hash ? -1 : 1);
+	return 0;
+}
+
+static void
+innerPreloadSetupHashSkews(kern_multirels *h_kmrels, int dindex)
+{
+	kern_data_store *kds = KERN_MULTIRELS_INNER_KDS(h_kmrels, dindex);
+	uint32_t	threshold = pgstrom_gpuhashjoin_skew_threshold;
+	uint64_t   *row_index;
+	uint64_t   *new_index;
+	bool	   *moved;
+	kern_hashskew *skews;
+	kern_hashskew *candidates;
+	hash_skew_item *items;
+	uint32_t	nitems = kds->nitems;
+	uint32_t	ncandidates = 0;
+	uint32_t	nskews;
+	uint32_t	head, pos;
+
+	h_kmrels->chunks[dindex].hash_nskews = 0;
+	if (h_kmrels->chunks[dindex].hash_skew_offset == 0 ||
+		threshold == 0 || nitems < threshold)
+		return;
+	Assert(kds->format == KDS_FORMAT_HASH);
+	skews = (kern_hashskew *)((char *)h_kmrels +
+							  h_kmrels->chunks[dindex].hash_skew_offset);
+	row_index = KDS_GET_ROWINDEX(kds);
+	items = palloc_extended(sizeof(hash_skew_item) * nitems, MCXT_ALLOC_HUGE);
+	for (uint32_t k=0; k < nitems; k++)
+	{
+		kern_tupitem   *titem = KDS_GET_TUPITEM(kds, k);
+		kern_hashitem  *hitem;
+
+		hitem = (kern_hashitem *)((char *)titem - offsetof(kern_hashitem, t));
+		items[k].hash  = hitem->hash;
+		items[k].index = k;
+	}
+	qsort(items, nitems, sizeof(hash_skew_item),
+		  __hash_skew_item_compare);
+	/* pick up the groups; 'head' is the position in items[] */
+	candidates = palloc_extended(sizeof(kern_hashskew) * (nitems / threshold),
+								 MCXT_ALLOC_HUGE);
+	for (head=0; head < nitems; head = pos)
+	{
+		for (pos=head+1; pos < nitems && items[pos].hash == items[head].hash; pos++);
+		if (pos - head < threshold)
+			continue;
+		Assert(ncandidates < nitems / threshold);
+		candidates[ncandidates].hash   = items[head].hash;
+		candidates[ncandidates].head   = head;
+		candidates[ncandidates].nitems = pos - head;
+		ncandidates++;
+	}
+	/* keep the largest ones only */
+	if (ncandidates > KERN_HASHSKEW_MAX_KEYS)
+		qsort(candidates, ncandidates, sizeof(kern_hashskew),
+			  __hash_skew_compare_by_nitems);
+	nskews = Min(ncandidates, KERN_HASHSKEW_MAX_KEYS);
+	memcpy(skews, candidates, sizeof(kern_hashskew) * nskews);
+	pfree(candidates);
+
+	if (nskews > 0)
+	{
+		/* gather the heavy-hitters at the head of the row-index */
+		new_index = palloc_extended(sizeof(uint64_t) * nitems, MCXT_ALLOC_HUGE);
+		moved = palloc0_extended(sizeof(bool) * nitems, MCXT_ALLOC_HUGE);
+		qsort(skews, nskews, sizeof(kern_hashskew),
+			  __hash_skew_compare_by_hash);
+		pos = 0;
+		for (uint32_t i=0; i < nskews; i++)
+		{
+			kern_hashskew *skew = &skews[i];
+
+			for (uint32_t k=0; k < skew->nitems; k++)
+			{
+				uint32_t	index = items[skew->head + k].index;
+
+				new_index[pos + k] = row_index[index];
+				moved[index] = true;
+			}
+			skew->head = pos;
+			pos += skew->nitems;
+		}
+		/* then, the others by the original order */
+		for (uint32_t k=0; k < nitems; k++)
+		{
+			if (!moved[k])
+				new_index[pos++] = row_index[k];
+		}
+		Assert(pos == nitems);
+		for (uint32_t k=0; k < nitems; k++)
+		{
+			row_index[k] = new_index[k];
+			KDS_GET_TUPITEM(kds, k)->rowid = k;
+		}
+		pfree(moved);
+		pfree(new_index);
+		elog(DEBUG1, "GpuJoin: inner hash table [%d] has %u heavy-hitters",
+			 dindex+1, nskews);
+	}
+	h_kmrels->chunks[dindex].hash_nskews = nskews;
+	pfree(items);
+}
+
+/*
+ * innerPreloadSetupGeometryIndex
+ *
+ * It builds the edge index (kern_geom_index) of the rings of POLYGON and
+ * MULTIPOLYGON on the inner buffer. The directory grows from the head of
+ * the region, and the ring indexes grow from the tail. Rings that do not
+ * fit the region are not indexed; the device walks on all the edges.
+ */
+typedef struct
+{
+	kern_multirels *h_kmrels;
+	kern_geom_index *gindex;
+	char	   *tail;			/* lower bound of the ring indexes */
+	bool		is_full;		/* true, if no more space in the region */
+} geom_index_build_state;
+
+static void
+__innerPreloadBuildGeomRingIndex(geom_index_build_state *gstate,
+								 const char *points,
+								 uint32_t npoints,
+								 uint32_t unitsz)
+{
+	kern_geom_ring_index temp;
+	kern_geom_ring_index *rindex;
+	kern_geom_index_entry *entry;
+	uint32_t   *cursor;
+	uint32_t   *edges;
+	uint64_t	nedges = 0;
+	double		ymin = DBL_MAX;
+	double		ymax = -DBL_MAX;
+	POINT2D		seg1;
+	POINT2D		seg2;
+	char	   *head;
+	size_t		sz;
+
+	if (npoints < GEOM_RING_INDEX_MIN_POINTS)
+		return;
+	for (uint32_t i=0; i < npoints; i++)
+	{
+		memcpy(&seg1, points + unitsz * i, sizeof(POINT2D));
+		if (isnan(seg1.y) || isinf(seg1.y))
+			return;
+		ymin = Min(ymin, seg1.y);
+		ymax = Max(ymax, seg1.y);
+	}
+	memset(&temp, 0, sizeof(kern_geom_ring_index));
+	temp.npoints = npoints;
+	temp.nbuckets = ((npoints - 1 + GEOM_RING_INDEX_EDGES_PER_BUCKET - 1) /
+					 GEOM_RING_INDEX_EDGES_PER_BUCKET);
+	temp.ymin = ymin;
+	temp.ystep = (ymax - ymin) / (double)temp.nbuckets;
+	if (!(temp.ystep > 0.0))
+		return;
+
+	/* 1st pass - count the edges for each band */
+	cursor = palloc0(sizeof(uint32_t) * (temp.nbuckets + 1));
+	memcpy(&seg1, points, sizeof(POINT2D));
+	for (uint32_t i=1; i < npoints; i++, seg1 = seg2)
+	{
+		uint32_t	b_lo, b_hi;
+
+		memcpy(&seg2, points + unitsz * i, sizeof(POINT2D));
+		/* zero length segments are ignored on the device also */
+		if (seg1.x == seg2.x && seg1.y == seg2.y)
+			continue;
+		b_lo = __geom_ring_index_bucket(&temp, Min(seg1.y, seg2.y));
+		b_hi = __geom_ring_index_bucket(&temp, Max(seg1.y, seg2.y));
+		for (uint32_t b=b_lo; b <= b_hi; b++)
+			cursor[b+1]++;
+		nedges += (b_hi - b_lo + 1);
+	}
+	/* index is not worth, if most of edges are long in y-direction */
+	if (nedges > (uint64_t)npoints * GEOM_RING_INDEX_EDGES_PER_BUCKET)
+	{
+		pfree(cursor);
+		return;
+	}
+
+	/* reserve the space */
+	sz = MAXALIGN(offsetof(kern_geom_ring_index,
+						   buckets[temp.nbuckets + 1]) +
+				  sizeof(uint32_t) * nedges);
+	head = (char *)&gstate->gindex->entries[gstate->gindex->nrings + 1];
+	if (head > gstate->tail || gstate->tail - head < sz)
+	{
+		gstate->is_full = true;
+		pfree(cursor);
+		return;
+	}
+	gstate->tail -= sz;
+	rindex = (kern_geom_ring_index *)gstate->tail;
+	memcpy(rindex, &temp, offsetof(kern_geom_ring_index, buckets));
+	for (uint32_t b=0; b < temp.nbuckets; b++)
+		cursor[b+1] += cursor[b];
+	memcpy(rindex->buckets, cursor, sizeof(uint32_t) * (temp.nbuckets + 1));
+	Assert(cursor[temp.nbuckets] == nedges);
+
+	/* 2nd pass - fill up the edges */
+	edges = rindex->buckets + temp.nbuckets + 1;
+	memcpy(&seg1, points, sizeof(POINT2D));
+	for (uint32_t i=1; i < npoints; i++, seg1 = seg2)
+	{
+		uint32_t	b_lo, b_hi;
+
+		memcpy(&seg2, points + unitsz * i, sizeof(POINT2D));
+		if (seg1.x == seg2.x && seg1.y == seg2.y)
+			continue;
+		b_lo = __geom_ring_index_bucket(&temp, Min(seg1.y, seg2.y));
+		b_hi = __geom_ring_index_bucket(&temp, Max(seg1.y, seg2.y));
+		for (uint32_t b=b_lo; b <= b_hi; b++)
+			edges[cursor[b]++] = i;
+	}
+	pfree(cursor);
+
+	entry = &gstate->gindex->entries[gstate->gindex->nrings++];
+	entry->points_offset = (points - (char *)gstate->h_kmrels);
+	entry->index_offset = ((char *)rindex - (char *)gstate->h_kmrels);
+}
+
+static const char *
+__innerPreloadBuildGeomPolygonIndex(geom_index_build_state *gstate,
+									const char *pos, const char *end,
+									uint32_t nrings, uint32_t unitsz)
+{
+	const char *points = pos + LONGALIGN(sizeof(uint32_t) * nrings);
+
+	if (points > end)
+		return NULL;
+	for (uint32_t i=0; i < nrings; i++)
+	{
+		uint32_t	npoints;
+
+		memcpy(&npoints, pos + sizeof(uint32_t) * i, sizeof(uint32_t));
+		if ((uint64_t)npoints * unitsz > end - points)
+			return NULL;	/* corrupted? */
+		if (!gstate->is_full)
+			__innerPreloadBuildGeomRingIndex(gstate, points, npoints, unitsz);
+		points += (uint64_t)npoints * unitsz;
+	}
+	return points;
+}
+
+static void
+__innerPreloadBuildGeomIndexDatum(geom_index_build_state *gstate,
+								  const char *vl_datum)
+{
+	const char *pos;
+	const char *end;
+	uint16_t	geom_flags = 0;
+	uint32_t	unitsz;
+	uint32_t	gs_type;
+	uint32_t	nitems;
+
+	pos = __geometry_host_rawdata(vl_datum, &geom_flags, NULL, &end);
+	if (!pos)
+		return;
+	unitsz = sizeof(double) * GEOM_FLAGS_NDIMS(geom_flags);
+
+	if (pos + 2 * sizeof(uint32_t) > end)
+		return;
+	memcpy(&gs_type, pos, sizeof(uint32_t));
+	memcpy(&nitems, pos + sizeof(uint32_t), sizeof(uint32_t));
+	pos += 2 * sizeof(uint32_t);
+	if (gs_type == GEOM_POLYGONTYPE)
+	{
+		__innerPreloadBuildGeomPolygonIndex(gstate, pos, end, nitems, unitsz);
+	}
+	else if (gs_type == GEOM_MULTIPOLYGONTYPE)
+	{
+		for (uint32_t j=0; j < nitems && pos && !gstate->is_full; j++)
+		{
+			uint32_t	sub_type;
+			uint32_t	sub_nitems;
+
+			if (pos + 2 * sizeof(uint32_t) > end)
+				break;
+			memcpy(&sub_type, pos, sizeof(uint32_t));
+			memcpy(&sub_nitems, pos + sizeof(uint32_t), sizeof(uint32_t));
+			pos += 2 * sizeof(uint32_t);
+			if (sub_type != GEOM_POLYGONTYPE)
+				break;
+			pos = __innerPreloadBuildGeomPolygonIndex(gstate, pos, end,
+													  sub_nitems, unitsz);
+		}
+	}
+}
+
+static int
+__geom_index_entry_compare(const void *__a, const void *__b)
+{
+	const kern_geom_index_entry *a = __a;
+	const kern_geom_index_entry *b = __b;
+
+	if (a->points_offset != b->points_offset)
+		return (a->points_offset < b->points_offset ? -1 : 1);
+	return 0;
+}
+
+static void
+innerPreloadSetupGeometryIndex(pgstromTaskState *pts)
+{
+	kern_multirels *h_kmrels = pts->h_kmrels;
+	geom_index_build_state gstate;
+
+	if (h_kmrels->geom_index_offset == 0)
+		return;
+	memset(&gstate, 0, sizeof(geom_index_build_state));
+	gstate.h_kmrels = h_kmrels;
+	gstate.gindex = (kern_geom_index *)
+		((char *)h_kmrels + h_kmrels->geom_index_offset);
+	gstate.gindex->nrings = 0;
+	gstate.tail = ((char *)gstate.gindex + h_kmrels->geom_index_length);
+
+	for (int i=0; i < h_kmrels->num_rels && !gstate.is_full; i++)
+	{
+		pgstromTaskInnerState *istate = &pts->inners[i];
+		TupleDesc	tupdesc = istate->ps->ps_ResultTupleDesc;
+		kern_data_store *kds = KERN_MULTIRELS_INNER_KDS(h_kmrels, i);
+		ListCell   *lc;
+
+		if (istate->geom_anums == NIL)
+			continue;
+
+		for (uint32_t k=0; k < kds->nitems && !gstate.is_full; k++)
+		{
+			kern_tupitem *tupitem = KDS_GET_TUPITEM(kds, k);
+			HeapTupleData tuple;
+
+			if (!tupitem)
+				continue;
+			tuple.t_len = tupitem->t_len;
+			ItemPointerSetInvalid(&tuple.t_self);
+			tuple.t_tableOid = InvalidOid;
+			tuple.t_data = &tupitem->htup;
+			foreach (lc, istate->geom_anums)
+			{
+				Datum	datum;
+				bool	isnull;
+
+				datum = heap_getattr(&tuple, lfirst_int(lc), tupdesc, &isnull);
+				if (!isnull)
+					__innerPreloadBuildGeomIndexDatum(&gstate,
+													  DatumGetPointer(datum));
+			}
+		}
+	}
+	if (gstate.gindex->nrings > 1)
+		qsort(gstate.gindex->entries,
+			  gstate.gindex->nrings,
+			  sizeof(kern_geom_index_entry),
+			  __geom_index_entry_compare);
+	elog(DEBUG1, "GpuJoin: %u rings of the inner polygons are indexed%s",
+		 gstate.gindex->nrings,
+		 gstate.is_full ? " (no more space)" : "");
+}
+
 #define INNER_PHASE__SCAN_RELATIONS		0
 #define INNER_PHASE__SETUP_BUFFERS		1
 #define INNER_PHASE__GPUJOIN_EXEC		2
 
+/*
+ * innerPreloadSetupJoinKeyRange
+ *
+ * Outer record-batches out of the inner key range never match
+ */
+static void
+innerPreloadSetupJoinKeyRange(pgstromTaskState *pts,
+							  pgstromSharedState *ps_state)
+{
+	if (pts->arrow_state && ps_state->inners[0].inner_key_valid)
+	{
+		AttrNumber	anum = innerKeyRangeOuterAttnum(pts, &pts->inners[0]);
+
+		if (anum > 0)
+			pgstromArrowFdwSetJoinKeyRange(pts->arrow_state, anum,
+										   ps_state->inners[0].inner_key_min,
+										   ps_state->inners[0].inner_key_max);
+	}
+}
+
+/*
+ * innerPreloadShareSibling
+ *
+ * Partition-wise JOIN with the identical inner relations maps the inner
+ * buffer preloaded by the leader sibling, instead of preloading the same
+ * inner relations for each partition leaf.
+ * The grace hash-join switches the partition of the leader's buffer on
+ * the execution, so the sibling preloads its own buffer in this case.
+ */
+static bool
+innerPreloadShareSibling(pgstromTaskState *pts)
+{
+	pgstromTaskState   *leader = pts->sibling_leader;
+	pgstromSharedState *ps_state;
+
+	if (!leader->ps_state)
+		pgstromSharedStateInitDSM(&leader->css, NULL, NULL);
+	GpuJoinInnerPreload(leader);
+	if (leader->inner_part_depth > 0)
+	{
+		pts->sibling_leader = NULL;
+		if (pts->ps_state->preload_shmem_handle == 0)
+			pts->ps_state->preload_shmem_handle = __shmemCreate(pts->ds_entry);
+		return false;
+	}
+	ps_state = leader->ps_state;
+	if (!pts->h_kmrels)
+		pts->h_kmrels = __mmapShmem(ps_state->preload_shmem_handle,
+									ps_state->preload_shmem_length,
+									pts->ds_entry);
+	innerPreloadSetupJoinKeyRange(pts, ps_state);
+	elog(DEBUG2, "%s: inner buffer is shared with the sibling (plan_node_id=%d)",
+		 pts->css.methods->CustomName,
+		 leader->css.ss.ps.plan->plan_node_id);
+	return true;
+}
+
 uint32_t
 GpuJoinInnerPreload(pgstromTaskState *pts)
 {
@@ -2167,9 +4145,9 @@ GpuJoinInnerPreload(pgstromTaskState *pts)
 	pgstromSharedState *ps_state;
 	MemoryContext		memcxt;
 
-	//pick up leader's ps_state if partitionwise plan
-	//if (sibling is exist)
-	// leader = pts->sibling->leader;
+	/* pick up the leader's inner buffer, if partition-wise plan */
+	if (pts->sibling_leader && innerPreloadShareSibling(pts))
+		return pts->sibling_leader->ps_state->preload_shmem_handle;
 	ps_state = leader->ps_state;
 
 	/* memory context for temporary store  */
@@ -2195,7 +4173,45 @@ GpuJoinInnerPreload(pgstromTaskState *pts)
 				execInnerPreloadOneDepth(memcxt, pts, istate,
 										 &ps_state->inners[i].inner_nitems,
 										 &ps_state->inners[i].inner_usage);
+				/* merge the max half-extent of the grid-join, if any */
+				if (istate->range_grid_distance > 0.0)
+				{
+					pgstromSharedInnerState *ps_inner = &ps_state->inners[i];
+
+					SpinLockAcquire(&ps_state->preload_mutex);
+					ps_inner->inner_grid_extent
+						= Max(ps_inner->inner_grid_extent,
+							  istate->preload_buffer->grid_extent);
+					SpinLockRelease(&ps_state->preload_mutex);
+				}
 			}
+			/* merge the min/max of the inner hash-key, if any */
+			if (leader->inners[0].preload_buffer)
+			{
+				inner_preload_buffer *preload_buf = leader->inners[0].preload_buffer;
+				pgstromSharedInnerState *ps_inner = &ps_state->inners[0];
+
+				if (preload_buf->key_valid)
+				{
+					SpinLockAcquire(&ps_state->preload_mutex);
+					if (!ps_inner->inner_key_valid)
+					{
+						ps_inner->inner_key_min = preload_buf->key_min;
+						ps_inner->inner_key_max = preload_buf->key_max;
+						ps_inner->inner_key_valid = true;
+					}
+					else
+					{
+						ps_inner->inner_key_min = Min(ps_inner->inner_key_min,
+													  preload_buf->key_min);
+						ps_inner->inner_key_max = Max(ps_inner->inner_key_max,
+													  preload_buf->key_max);
+					}
+					SpinLockRelease(&ps_state->preload_mutex);
+				}
+			}
+			/* partitioning of the inner hash table, if too large */
+			innerPreloadSetupPartitions(leader, memcxt);
 
 			/*
 			 * Once (parallel) scan completed, no other concurrent
@@ -2232,7 +4248,7 @@ GpuJoinInnerPreload(pgstromTaskState *pts)
 				{
 					SpinLockRelease(&ps_state->preload_mutex);
 					ConditionVariableSleep(&ps_state->preload_cond,
-										   PG_WAIT_EXTENSION);
+										   pgstrom_wait_event(PGSTROM_WAIT_EVENT__INNER_PRELOAD));
 					SpinLockAcquire(&ps_state->preload_mutex);
 				}
 				ConditionVariableCancelSleep();
@@ -2270,6 +4286,8 @@ GpuJoinInnerPreload(pgstromTaskState *pts)
 				kern_data_store *kds = KERN_MULTIRELS_INNER_KDS(pts->h_kmrels, i);
 				uint64_t	base_nitems;
 				uint64_t	base_usage;
+				uint64_t	nitems;
+				uint64_t	usage;
 
 				/*
 				 * If this backend/worker process called GpuJoinInnerPreload()
@@ -2278,42 +4296,89 @@ GpuJoinInnerPreload(pgstromTaskState *pts)
 				 */
 				if (!preload_buf)
 					continue;
+				if (leader->inner_part_depth == i+1)
+				{
+					nitems = leader->inner_part_nitems[leader->inner_part_id];
+					usage  = leader->inner_part_usage[leader->inner_part_id];
+				}
+				else
+				{
+					nitems = preload_buf->nitems;
+					usage  = preload_buf->usage;
+				}
 
-				SpinLockAcquire(&ps_state->preload_mutex);
-				base_nitems  = kds->nitems;
-				kds->nitems += preload_buf->nitems;
-				base_usage   = kds->__usage64;
-				kds->__usage64 += preload_buf->usage;
-				SpinLockRelease(&ps_state->preload_mutex);
+				/* reserve the slab of this process without locks */
+				base_nitems = __atomic_add_uint32(&kds->nitems, nitems);
+				base_usage  = __atomic_add_uint64(&kds->__usage64, usage);
 
 				/* sanity checks */
-				if (base_nitems + preload_buf->nitems >= UINT_MAX)
+				if (base_nitems + nitems >= UINT_MAX)
 					elog(ERROR, "GpuJoin: inner relation has %lu tuples, too large",
-						 base_nitems + preload_buf->nitems);
+						 base_nitems + nitems);
 				Assert(KDS_HEAD_LENGTH(kds) +
 					   MAXALIGN(sizeof(uint64_t) * (kds->hash_nslots +
 													base_nitems +
-													preload_buf->nitems)) +
+													nitems)) +
 					   base_usage +
-					   preload_buf->usage <= kds->length);
+					   usage <= kds->length);
 
 				if (kds->format == KDS_FORMAT_ROW)
-					__innerPreloadSetupHeapBuffer(kds, istate,
+					__innerPreloadSetupHeapBuffer(pts->h_kmrels, i, istate,
 												  base_nitems,
 												  base_usage);
 				else if (kds->format == KDS_FORMAT_HASH)
-					__innerPreloadSetupHashBuffer(kds, istate,
+					__innerPreloadSetupHashBuffer(pts->h_kmrels, i, istate,
 												  base_nitems,
 												  base_usage);
 				else
 					elog(ERROR, "unexpected inner-KDS format");
 			}
 
+			/*
+			 * Copy the GiST-index blocks, even if this process has no
+			 * inner tuples to be added.
+			 */
+			for (int i=0; i < leader->num_rels; i++)
+			{
+				kern_data_store *kds_gist
+					= KERN_MULTIRELS_GIST_INDEX(pts->h_kmrels, i);
+
+				if (kds_gist)
+					innerPreloadCopyGiSTIndex(kds_gist,
+											  leader->inners[i].gist_irel,
+											  &ps_state->inners[i]);
+			}
+
 			/*
 			 * Wait for completion of the host buffer setup
 			 * by other concurrent workers
 			 */
 			SpinLockAcquire(&ps_state->preload_mutex);
+			if (ps_state->preload_nr_scanning == 0 &&
+				ps_state->preload_nr_setup == 1)
+			{
+				/*
+				 * The last one sorts the inner buffer of range-join, links
+				 * the parent blocks of GiST-index, gathers the heavy-
+				 * hitters of the hash table, and builds the edge index of
+				 * the inner polygons, if any.
+				 * preload_nr_setup is not decremented yet, so the others
+				 * still wait for the completion.
+				 */
+				SpinLockRelease(&ps_state->preload_mutex);
+				innerPreloadSortRangeKeys(pts->h_kmrels);
+				for (int i=0; i < pts->h_kmrels->num_rels; i++)
+				{
+					kern_data_store *kds_gist
+						= KERN_MULTIRELS_GIST_INDEX(pts->h_kmrels, i);
+
+					if (kds_gist)
+						innerPreloadSetupGiSTIndex(pts, i);
+					innerPreloadSetupHashSkews(pts->h_kmrels, i);
+				}
+				innerPreloadSetupGeometryIndex(pts);
+				SpinLockAcquire(&ps_state->preload_mutex);
+			}
 			ps_state->preload_nr_setup--;
 			if (ps_state->preload_nr_scanning == 0 &&
 				ps_state->preload_nr_setup == 0)
@@ -2330,7 +4395,7 @@ GpuJoinInnerPreload(pgstromTaskState *pts)
 				{
                     SpinLockRelease(&ps_state->preload_mutex);
                     ConditionVariableSleep(&ps_state->preload_cond,
-                                           PG_WAIT_EXTENSION);
+                                           pgstrom_wait_event(PGSTROM_WAIT_EVENT__INNER_PRELOAD));
                     SpinLockAcquire(&ps_state->preload_mutex);
                 }
                 ConditionVariableCancelSleep();
@@ -2360,13 +4425,73 @@ GpuJoinInnerPreload(pgstromTaskState *pts)
 			break;
 	}
 	SpinLockRelease(&ps_state->preload_mutex);
-	/* release working memory */
-	MemoryContextDelete(memcxt);
+	innerPreloadSetupJoinKeyRange(pts, ps_state);
+	/*
+	 * release working memory, unless grace hash-join kept the inner
+	 * tuples for the next partitions.
+	 */
+	if (leader->inner_part_depth > 0 && !leader->inner_part_memcxt)
+		leader->inner_part_memcxt = memcxt;
+	else
+		MemoryContextDelete(memcxt);
 	Assert(pts->h_kmrels != NULL);
 
 	return ps_state->preload_shmem_handle;
 }
 
+/*
+ * GpuJoinInnerPreloadSwitchPartition
+ *
+ * It reloads the partitioned inner hash table by the partition 'part_id'
+ * on the host inner buffer; the executor runs the next pass with it.
+ */
+bool
+GpuJoinInnerPreloadSwitchPartition(pgstromTaskState *pts, uint32_t part_id)
+{
+	int			depth = pts->inner_part_depth;
+	pgstromTaskInnerState *istate;
+	kern_data_store *kds;
+	kern_hashbucket *buckets;
+	uint32_t	nbuckets;
+	uint64_t	nitems;
+
+	if (depth == 0 || part_id >= pts->inner_part_nparts ||
+		!pts->h_kmrels)
+		return false;
+	if (pts->inner_part_id == part_id)
+		return true;
+
+	istate = &pts->inners[depth-1];
+	kds = KERN_MULTIRELS_INNER_KDS(pts->h_kmrels, depth-1);
+	Assert(kds->format == KDS_FORMAT_HASH);
+	/* reset the hash table */
+	memset(KDS_GET_HASHSLOT_BASE(kds), 0, sizeof(uint64_t) * kds->hash_nslots);
+	buckets = KERN_MULTIRELS_HASH_BUCKETS(pts->h_kmrels, depth-1);
+	nbuckets = pts->h_kmrels->chunks[depth-1].hash_nbuckets;
+	if (buckets)
+		memset(buckets, 0, sizeof(kern_hashbucket) * (size_t)nbuckets);
+	if (pts->h_kmrels->chunks[depth-1].bloom_offset != 0)
+		memset(KERN_MULTIRELS_BLOOM_FILTER(pts->h_kmrels, depth-1), 0,
+			   sizeof(uint32_t) * KERN_BLOOM_BLOCK_NWORDS *
+			   (size_t)pts->h_kmrels->chunks[depth-1].bloom_nblocks);
+	nitems = pts->inner_part_nitems[part_id];
+	kds->nitems = nitems;
+	kds->__usage64 = pts->inner_part_usage[part_id];
+	pts->h_kmrels->chunks[depth-1].hash_partid = part_id;
+	pts->inner_part_id = part_id;
+	/* private hash index for CPU-fallback is no longer valid */
+	if (istate->fallback_hslots)
+		pfree(istate->fallback_hslots);
+	if (istate->fallback_hnext)
+		pfree(istate->fallback_hnext);
+	istate->fallback_hslots = NULL;
+	istate->fallback_hnext = NULL;
+	__innerPreloadSetupHashBuffer(pts->h_kmrels, depth-1, istate, 0, 0);
+	innerPreloadSetupHashSkews(pts->h_kmrels, depth-1);
+	innerPreloadSetupGeometryIndex(pts);
+	return true;
+}
+
 /*
  * CPU Fallback for JOIN
  */
@@ -2504,6 +4629,7 @@ __execFallbackCpuNestLoop(pgstromTaskState *pts,
 	pgstromTaskInnerState *istate = &pts->inners[depth-1];
 	ExprContext    *econtext = pts->css.ss.ps.ps_ExprContext;
 	TupleTableSlot *scan_slot = pts->css.ss.ss_ScanTupleSlot;
+	bool			matched = false;
 
 	Assert(kds_in->format == KDS_FORMAT_ROW);
 	for (uint32_t index=0; index < kds_in->nitems; index++)
@@ -2528,20 +4654,74 @@ __execFallbackCpuNestLoop(pgstromTaskState *pts,
 									   &tupitem->htup);
 		}
 		/* check JOIN-clause */
-		if (istate->join_quals != NULL ||
+		if (istate->join_quals == NULL ||
 			ExecQual(istate->join_quals, econtext))
 		{
-			if (istate->other_quals != NULL ||
+			matched = true;
+			/* ANTI JOIN never emits the matched tuple */
+			if (istate->join_type == JOIN_ANTI)
+				break;
+			if (istate->other_quals == NULL ||
 				ExecQual(istate->other_quals, econtext))
 			{
 				/* Ok, go to the next depth */
 				__execFallbackCpuJoinOneDepth(pts, depth+1);
+				/* SEMI JOIN emits the outer tuple only once */
+				if (istate->join_type == JOIN_SEMI)
+					break;
 			}
 			/* mark outer-join map, if any */
 			if (oj_map)
 				oj_map[index] = true;
 		}
 	}
+	/* ANTI JOIN emits the outer tuple that has no matched inner tuples */
+	if (istate->join_type == JOIN_ANTI && !matched)
+		__execFallbackCpuJoinOneDepth(pts, depth+1);
+}
+
+/*
+ * __execFallbackCpuHashIndex
+ *
+ * When the inner hash table is built by GPU kernel, the host inner buffer
+ * has no hash-chain. So, CPU-fallback builds a private index on demand.
+ */
+static void
+__execFallbackCpuHashIndex(pgstromTaskState *pts,
+						   pgstromTaskInnerState *istate,
+						   kern_data_store *kds_in)
+{
+	MemoryContext	memcxt = pts->css.ss.ps.state->es_query_cxt;
+	uint32_t	   *hslots;
+	uint32_t	   *hnext;
+
+	hslots = MemoryContextAllocHuge(memcxt, sizeof(uint32_t) * kds_in->hash_nslots);
+	hnext  = MemoryContextAllocHuge(memcxt, sizeof(uint32_t) * (kds_in->nitems + 1));
+	memset(hslots, 0, sizeof(uint32_t) * kds_in->hash_nslots);
+	for (uint32_t rowid=0; rowid < kds_in->nitems; rowid++)
+	{
+		kern_tupitem   *titem = KDS_GET_TUPITEM(kds_in, rowid);
+		kern_hashitem  *hitem;
+		uint32_t		hindex;
+
+		hitem = (kern_hashitem *)((char *)titem - offsetof(kern_hashitem, t));
+		hindex = hitem->hash % kds_in->hash_nslots;
+		hnext[rowid] = hslots[hindex];
+		hslots[hindex] = rowid + 1;
+	}
+	istate->fallback_hslots = hslots;
+	istate->fallback_hnext  = hnext;
+}
+
+static inline kern_hashitem *
+__execFallbackCpuHashItem(kern_data_store *kds_in, uint32_t hrowid)
+{
+	kern_tupitem   *titem;
+
+	if (hrowid == 0)
+		return NULL;
+	titem = KDS_GET_TUPITEM(kds_in, hrowid - 1);
+	return (kern_hashitem *)((char *)titem - offsetof(kern_hashitem, t));
 }
 
 static void
@@ -2554,6 +4734,8 @@ __execFallbackCpuHashJoin(pgstromTaskState *pts,
 	TupleTableSlot *scan_slot = pts->css.ss.ss_ScanTupleSlot;
 	kern_hashitem  *hitem;
 	uint32_t		hash;
+	bool			gpu_build = pts->h_kmrels->chunks[depth-1].hash_gpu_build;
+	bool			matched = false;
 	ListCell	   *lc1, *lc2;
 
 	Assert(kds_in->format == KDS_FORMAT_HASH);
@@ -2575,12 +4757,24 @@ __execFallbackCpuHashJoin(pgstromTaskState *pts,
 	}
 	hash ^= 0xffffffffU;
 
+	/* grace hash-join; this tuple shall be processed on the other pass */
+	if (pts->h_kmrels->chunks[depth-1].hash_nparts > 1 &&
+		KERN_HASH_PARTITION(hash, pts->h_kmrels->chunks[depth-1].hash_nparts)
+		!= pts->h_kmrels->chunks[depth-1].hash_partid)
+		return;
+
 	/*
 	 * walks on the hash-join-table
 	 */
-	for (hitem = KDS_HASH_FIRST_ITEM(kds_in, hash);
+	if (gpu_build && !istate->fallback_hslots)
+		__execFallbackCpuHashIndex(pts, istate, kds_in);
+	for (hitem = (gpu_build
+				  ? __execFallbackCpuHashItem(kds_in, istate->fallback_hslots[hash % kds_in->hash_nslots])
+				  : KDS_HASH_FIRST_ITEM(kds_in, hash));
 		 hitem != NULL;
-		 hitem = KDS_HASH_NEXT_ITEM(kds_in, hitem->next))
+		 hitem = (gpu_build
+				  ? __execFallbackCpuHashItem(kds_in, istate->fallback_hnext[hitem->t.rowid])
+				  : KDS_HASH_NEXT_ITEM(kds_in, hitem->next)))
 	{
 		if (hitem->hash != hash)
 			continue;
@@ -2601,17 +4795,27 @@ __execFallbackCpuHashJoin(pgstromTaskState *pts,
 		if (istate->join_quals == NULL ||
 			ExecQual(istate->join_quals, econtext))
 		{
+			matched = true;
+			/* ANTI JOIN never emits the matched tuple */
+			if (istate->join_type == JOIN_ANTI)
+				break;
 			if (istate->other_quals == NULL ||
 				ExecQual(istate->other_quals, econtext))
 			{
 				/* Ok, go to the next depth */
 				__execFallbackCpuJoinOneDepth(pts, depth+1);
+				/* SEMI JOIN emits the outer tuple only once */
+				if (istate->join_type == JOIN_SEMI)
+					break;
 			}
 			/* mark outer-join map, if any */
 			if (oj_map)
 				oj_map[hitem->t.rowid] = true;
 		}
 	}
+	/* ANTI JOIN emits the outer tuple that has no matched inner tuples */
+	if (istate->join_type == JOIN_ANTI && !matched)
+		__execFallbackCpuJoinOneDepth(pts, depth+1);
 }
 
 static void
@@ -2685,6 +4889,19 @@ __execFallbackCpuJoinOneDepth(pgstromTaskState *pts, int depth)
 
 bool
 ExecFallbackCpuJoin(pgstromTaskState *pts, HeapTuple tuple)
+{
+	ExecForceStoreHeapTuple(tuple, pts->base_slot, false);
+	return ExecFallbackCpuJoinSlot(pts);
+}
+
+/*
+ * ExecFallbackCpuJoinSlot
+ *
+ * Same as ExecFallbackCpuJoin, but the base tuple is already loaded on
+ * pts->base_slot.
+ */
+bool
+ExecFallbackCpuJoinSlot(pgstromTaskState *pts)
 {
 	ExprContext    *econtext = pts->css.ss.ps.ps_ExprContext;
 	TupleTableSlot *base_slot = pts->base_slot;
@@ -2693,8 +4910,7 @@ ExecFallbackCpuJoin(pgstromTaskState *pts, HeapTuple tuple)
 	ListCell	   *lc1, *lc2;
 
 	/* Load the base tuple (depth-0) to the fallback slot */
-	ExecForceStoreHeapTuple(tuple, base_slot, false);
-	slot_getallattrs(base_slot);
+	slot_getsomeattrs(base_slot, pts->fallback_load_natts);
 	ExecStoreAllNullTuple(scan_slot);
 	forboth (lc1, pts->fallback_load_src,
 			 lc2, pts->fallback_load_dst)
@@ -2862,6 +5078,24 @@ pgstrom_init_gpu_join(void)
 							 PGC_USERSET,
 							 GUC_NOT_IN_SAMPLE,
 							 NULL, NULL, NULL);
+	/* turn on/off gpurangejoin */
+	DefineCustomBoolVariable("pg_strom.enable_gpurangejoin",
+							 "Enables the use of GpuNestLoop on the inner relation sorted by the range-join key",
+							 NULL,
+							 &pgstrom_enable_gpurangejoin,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* turn on/off gpugridjoin */
+	DefineCustomBoolVariable("pg_strom.enable_gpugridjoin",
+							 "Enables the use of GpuNestLoop on the inner relation sorted by the grid cell of st_dwithin",
+							 NULL,
+							 &pgstrom_enable_gpugridjoin,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
 	/* turn on/off partition-wise gpujoin */
 	DefineCustomBoolVariable("pg_strom.enable_partitionwise_gpujoin",
 							 "Enables the use of partition-wise GpuJoin",
@@ -2871,6 +5105,81 @@ pgstrom_init_gpu_join(void)
 							 PGC_USERSET,
 							 GUC_NOT_IN_SAMPLE,
 							 NULL, NULL, NULL);
+	/* max length of the inner buffer on a pass */
+	DefineCustomIntVariable("pg_strom.gpujoin_inner_buffer_limit",
+							"Max length of GpuJoin inner buffer per pass; larger inner hash table is partitioned (0 = auto, -1 = never)",
+							NULL,
+							&pgstrom_gpujoin_inner_buffer_limit,
+							0,
+							-1,
+							INT_MAX,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_MB,
+							NULL, NULL, NULL);
+	/* partitioned hash-join on misestimation of the inner relation */
+	DefineCustomBoolVariable("pg_strom.gpujoin_adaptive_partition",
+							 "Enables to partition the inner hash table that is far larger than the planner estimation",
+							 NULL,
+							 &pgstrom_gpujoin_adaptive_partition,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* bucketized inner hash table */
+	DefineCustomBoolVariable("pg_strom.gpuhashjoin_bucketized",
+							 "Enables the bucketized open-addressing hash table for GpuHashJoin",
+							 NULL,
+							 &pgstrom_gpuhashjoin_bucketized,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* build the inner hash table by GPU */
+	DefineCustomBoolVariable("pg_strom.gpuhashjoin_build_on_gpu",
+							 "Enables to build the inner hash table of GpuHashJoin by GPU kernel",
+							 NULL,
+							 &pgstrom_gpuhashjoin_build_on_gpu,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* runtime bloom-filter of the inner hash-keys */
+	DefineCustomBoolVariable("pg_strom.gpujoin_bloom_filter",
+							 "Enables the runtime bloom-filter of inner hash-keys for GpuHashJoin",
+							 NULL,
+							 &pgstrom_gpujoin_bloom_filter,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* heavy-hitters of the inner hash table */
+	DefineCustomIntVariable("pg_strom.gpuhashjoin_skew_threshold",
+							"Number of inner tuples with the same hash value to be handled as heavy-hitter by GpuHashJoin (0 = disabled)",
+							NULL,
+							&pgstrom_gpuhashjoin_skew_threshold,
+							256,
+							0,
+							INT_MAX,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE,
+							NULL, NULL, NULL);
+	/* turn on/off packed R-tree for GiST-Join */
+	DefineCustomBoolVariable("pg_strom.gpujoin_gist_rtree",
+							 "Enables to replace the GiST-index pages by the packed R-tree for GpuJoin",
+							 NULL,
+							 &pgstrom_gpujoin_gist_rtree,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	DefineCustomBoolVariable("pg_strom.gpujoin_geometry_index",
+							 "Enables the edge index of the inner polygons for GpuJoin",
+							 NULL,
+							 &pgstrom_gpujoin_geometry_index,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
 	/* setup path methods */
 	memset(&gpujoin_path_methods, 0, sizeof(CustomPathMethods));
 	gpujoin_path_methods.CustomName				= "GpuJoin";
@@ -23,9 +23,45 @@ static bool					pgstrom_enable_dpupreagg = false;
 static bool					pgstrom_enable_partitionwise_dpupreagg = false;
 static bool					pgstrom_enable_gpupreagg = false;
 static bool					pgstrom_enable_partitionwise_gpupreagg = false;
+static bool					pgstrom_enable_gpupreagg_finalize = false;
 static bool					pgstrom_enable_numeric_aggfuncs;
+static int					pgstrom_gpupreagg_result_cache_size;	/* GUC; MB */
 int							pgstrom_hll_register_bits;
 
+/*
+ * GpuPreAgg result cache
+ *
+ * GpuPreAgg over the Arrow_Fdw files returns the same partial aggregation
+ * as long as the plan and the source files (path, size and mtime) are
+ * the same. So, we keep the results on the backend-local memory, then
+ * the next run replays them without GPU invocation.
+ */
+typedef struct
+{
+	dlist_node		chain;		/* LRU list */
+	uint32_t		hash;
+	char		   *key;
+	MemoryContext	memcxt;		/* keeps the entry and tuples */
+	int				refcnt;		/* number of the nodes in replay */
+	bool			evicted;	/* already detached from the LRU list */
+	size_t			usage;
+	uint64_t		nitems;
+	uint64_t		nrooms;
+	MinimalTuple   *tuples;
+} preaggResultCacheEntry;
+
+typedef struct preaggResultCacheState
+{
+	preaggResultCacheEntry *entry;	/* hit entry, or entry under build */
+	bool			cache_hit;
+	bool			cache_abort;	/* too large, or rescan under build */
+	uint64_t		index;			/* next tuple to replay */
+} preaggResultCacheState;
+
+static dlist_head	preagg_result_cache_list = DLIST_STATIC_INIT(preagg_result_cache_list);
+static dlist_head	preagg_result_cache_zombies = DLIST_STATIC_INIT(preagg_result_cache_zombies);
+static size_t		preagg_result_cache_usage = 0;
+
 /*
  * List of supported aggregate functions
  */
@@ -233,9 +269,9 @@ static aggfunc_catalog_t	aggfunc_catalog_array[] = {
 	 KAGG_ACTION__PSUM_FP, false
 	},
 	{"sum(numeric)",
-	 "s:sum_fp_num(bytea)",
-	 "s:psum(float8)",
-	 KAGG_ACTION__PSUM_FP, true
+	 "s:sum_numeric(bytea)",
+	 "s:psum(numeric)",
+	 KAGG_ACTION__PSUM_NUMERIC, true
 	},
 	{"sum(money)",
 	 "s:sum_cash(bytea)",
@@ -281,9 +317,9 @@ static aggfunc_catalog_t	aggfunc_catalog_array[] = {
 	 KAGG_ACTION__PAVG_FP, false
 	},
 	{"avg(numeric)",
-	 "s:avg_num(bytea)",
-	 "s:pavg(float8)",
-	 KAGG_ACTION__PAVG_FP, true
+	 "s:avg_numeric(bytea)",
+	 "s:pavg(numeric)",
+	 KAGG_ACTION__PAVG_NUMERIC, true
 	},
 	/*
 	 * STDDEV(X) = EX_STDDEV_SAMP(NROWS(),PSUM(X),PSUM(X*X))
@@ -614,6 +650,161 @@ static aggfunc_catalog_t	aggfunc_catalog_array[] = {
 	 "s:pcovar(float8,float8)",
 	 KAGG_ACTION__COVAR, false
 	},
+	/*
+	 * HLL_COUNT(X)  = HLL_MERGE(PHLL_SKETCH(X))
+	 * HLL_SKETCH(X) = HLL_COMBINE(PHLL_SKETCH(X))
+	 */
+	{"hll_count(int1)",
+	 "c:hll_merge(bytea)",
+	 "s:phll_sketch(int1)",
+	 KAGG_ACTION__HLL_SKETCH, false
+	},
+	{"hll_count(int2)",
+	 "c:hll_merge(bytea)",
+	 "s:phll_sketch(int2)",
+	 KAGG_ACTION__HLL_SKETCH, false
+	},
+	{"hll_count(int4)",
+	 "c:hll_merge(bytea)",
+	 "s:phll_sketch(int4)",
+	 KAGG_ACTION__HLL_SKETCH, false
+	},
+	{"hll_count(int8)",
+	 "c:hll_merge(bytea)",
+	 "s:phll_sketch(int8)",
+	 KAGG_ACTION__HLL_SKETCH, false
+	},
+	{"hll_count(numeric)",
+	 "c:hll_merge(bytea)",
+	 "s:phll_sketch(numeric)",
+	 KAGG_ACTION__HLL_SKETCH, true
+	},
+	{"hll_count(date)",
+	 "c:hll_merge(bytea)",
+	 "s:phll_sketch(date)",
+	 KAGG_ACTION__HLL_SKETCH, false
+	},
+	{"hll_count(time)",
+	 "c:hll_merge(bytea)",
+	 "s:phll_sketch(time)",
+	 KAGG_ACTION__HLL_SKETCH, false
+	},
+	{"hll_count(timestamp)",
+	 "c:hll_merge(bytea)",
+	 "s:phll_sketch(timestamp)",
+	 KAGG_ACTION__HLL_SKETCH, false
+	},
+	{"hll_count(timestamptz)",
+	 "c:hll_merge(bytea)",
+	 "s:phll_sketch(timestamptz)",
+	 KAGG_ACTION__HLL_SKETCH, false
+	},
+	{"hll_count(bpchar)",
+	 "c:hll_merge(bytea)",
+	 "s:phll_sketch(bpchar)",
+	 KAGG_ACTION__HLL_SKETCH, false
+	},
+	{"hll_count(text)",
+	 "c:hll_merge(bytea)",
+	 "s:phll_sketch(text)",
+	 KAGG_ACTION__HLL_SKETCH, false
+	},
+	{"hll_count(bytea)",
+	 "c:hll_merge(bytea)",
+	 "s:phll_sketch(bytea)",
+	 KAGG_ACTION__HLL_SKETCH, false
+	},
+	{"hll_count(uuid)",
+	 "c:hll_merge(bytea)",
+	 "s:phll_sketch(uuid)",
+	 KAGG_ACTION__HLL_SKETCH, false
+	},
+	{"hll_sketch(int1)",
+	 "c:hll_combine(bytea)",
+	 "s:phll_sketch(int1)",
+	 KAGG_ACTION__HLL_SKETCH, false
+	},
+	{"hll_sketch(int2)",
+	 "c:hll_combine(bytea)",
+	 "s:phll_sketch(int2)",
+	 KAGG_ACTION__HLL_SKETCH, false
+	},
+	{"hll_sketch(int4)",
+	 "c:hll_combine(bytea)",
+	 "s:phll_sketch(int4)",
+	 KAGG_ACTION__HLL_SKETCH, false
+	},
+	{"hll_sketch(int8)",
+	 "c:hll_combine(bytea)",
+	 "s:phll_sketch(int8)",
+	 KAGG_ACTION__HLL_SKETCH, false
+	},
+	{"hll_sketch(numeric)",
+	 "c:hll_combine(bytea)",
+	 "s:phll_sketch(numeric)",
+	 KAGG_ACTION__HLL_SKETCH, true
+	},
+	{"hll_sketch(date)",
+	 "c:hll_combine(bytea)",
+	 "s:phll_sketch(date)",
+	 KAGG_ACTION__HLL_SKETCH, false
+	},
+	{"hll_sketch(time)",
+	 "c:hll_combine(bytea)",
+	 "s:phll_sketch(time)",
+	 KAGG_ACTION__HLL_SKETCH, false
+	},
+	{"hll_sketch(timestamp)",
+	 "c:hll_combine(bytea)",
+	 "s:phll_sketch(timestamp)",
+	 KAGG_ACTION__HLL_SKETCH, false
+	},
+	{"hll_sketch(timestamptz)",
+	 "c:hll_combine(bytea)",
+	 "s:phll_sketch(timestamptz)",
+	 KAGG_ACTION__HLL_SKETCH, false
+	},
+	{"hll_sketch(bpchar)",
+	 "c:hll_combine(bytea)",
+	 "s:phll_sketch(bpchar)",
+	 KAGG_ACTION__HLL_SKETCH, false
+	},
+	{"hll_sketch(text)",
+	 "c:hll_combine(bytea)",
+	 "s:phll_sketch(text)",
+	 KAGG_ACTION__HLL_SKETCH, false
+	},
+	{"hll_sketch(bytea)",
+	 "c:hll_combine(bytea)",
+	 "s:phll_sketch(bytea)",
+	 KAGG_ACTION__HLL_SKETCH, false
+	},
+	{"hll_sketch(uuid)",
+	 "c:hll_combine(bytea)",
+	 "s:phll_sketch(uuid)",
+	 KAGG_ACTION__HLL_SKETCH, false
+	},
+	/*
+	 * QUANTILE_SKETCH(X) = QUANTILE_COMBINE(PQUANTILE_SKETCH(X))
+	 */
+	{"quantile_sketch(float8)",
+	 "c:quantile_combine(bytea)",
+	 "s:pquantile_sketch(float8)",
+	 KAGG_ACTION__QUANTILE_SKETCH, false
+	},
+	/*
+	 * STRING_AGG(X,D) = STRING_AGG(PSTRING_AGG(X,D))
+	 */
+	{"string_agg(text,text)",
+	 "s:string_agg(bytea)",
+	 "s:pstring_agg(text,text)",
+	 KAGG_ACTION__STRING_AGG, false
+	},
+	{"string_agg(bytea,bytea)",
+	 "s:string_agg_bytea(bytea)",
+	 "s:pstring_agg(bytea,bytea)",
+	 KAGG_ACTION__STRING_AGG, false
+	},
 	{ NULL, NULL, NULL, -1, false },
 };
 
@@ -756,6 +947,13 @@ __aggfunc_resolve_partial_func(aggfunc_catalog_entry *entry,
 			type_oid = BYTEAOID;
 			partfn_bufsz = sizeof(kagg_state__psum_fp_packed);
 			break;
+
+		case KAGG_ACTION__PAVG_NUMERIC:
+		case KAGG_ACTION__PSUM_NUMERIC:
+			func_nargs = 1;
+			type_oid = BYTEAOID;
+			partfn_bufsz = sizeof(kagg_state__psum_numeric_packed);
+			break;
 			
 		case KAGG_ACTION__STDDEV:
 			func_nargs = 1;
@@ -767,6 +965,23 @@ __aggfunc_resolve_partial_func(aggfunc_catalog_entry *entry,
 			type_oid = BYTEAOID;
 			partfn_bufsz = sizeof(kagg_state__covar_packed);
 			break;
+		case KAGG_ACTION__HLL_SKETCH:
+			/* actual length depends on the GUC; see make_alternative_aggref */
+			func_nargs = 1;
+			type_oid = BYTEAOID;
+			partfn_bufsz = KAGG_STATE__HLL_SKETCH_SZ(pgstrom_hll_register_bits);
+			break;
+		case KAGG_ACTION__QUANTILE_SKETCH:
+			func_nargs = 1;
+			type_oid = BYTEAOID;
+			partfn_bufsz = KAGG_STATE__QUANTILE_SKETCH_SZ;
+			break;
+		case KAGG_ACTION__STRING_AGG:
+			/* values are chained on the kds_final, not in the state */
+			func_nargs = 2;
+			type_oid = BYTEAOID;
+			partfn_bufsz = KAGG_STATE__STRING_AGG_SZ;
+			break;
 		default:
 			elog(ERROR, "Catalog corruption? unknown action: %d", partfn_action);
 			break;
@@ -910,6 +1125,7 @@ typedef struct
 	RelOptInfo	   *input_rel;
 	ParamPathInfo  *param_info;
 	double			num_groups;
+	double			num_partial_groups;	/* num_groups on the device side */
 	bool			try_parallel;
 	PathTarget	   *target_upper;
 	PathTarget	   *target_partial;
@@ -921,6 +1137,8 @@ typedef struct
 	List		   *inner_target_list;
 	List		   *groupby_keys;
 	List		   *groupby_keys_refno;
+	List		   *distinct_keys;	/* arguments of DISTINCT aggregates */
+	bool			has_distinct_aggs;
 	Node		   *havingQual;
 } xpugroupby_build_path_context;
 
@@ -985,6 +1203,122 @@ make_expr_typecast(Expr *expr, Oid target_type)
  * It makes an alternative final aggregate function towards the supplied
  * Aggref, and append its arguments on the target_partial/target_device.
  */
+/*
+ * xpugroupby_check_device_key
+ *
+ * It checks whether the expression can be a grouping-key on the device.
+ */
+static bool
+xpugroupby_check_device_key(xpugroupby_build_path_context *con, Expr *expr)
+{
+	pgstromPlanInfo *pp_info = con->pp_info;
+	devtype_info *dtype;
+	Oid		type_oid = exprType((Node *)expr);
+	Oid		coll_oid;
+
+	dtype = pgstrom_devtype_lookup(type_oid);
+	if (!dtype || !dtype->type_hashfunc)
+	{
+		elog(DEBUG2, "GROUP BY contains unsupported type (%s): %s",
+			 format_type_be(type_oid),
+			 nodeToString(expr));
+		return false;
+	}
+	coll_oid = exprCollation((Node *)expr);
+	if (devtype_lookup_equal_func(dtype, coll_oid) == NULL)
+	{
+		elog(DEBUG2, "GROUP BY contains unsupported device type (%s): %s",
+			 format_type_be(type_oid),
+			 nodeToString(expr));
+		return false;
+	}
+	/* grouping-key must be device executable. */
+	if (!pgstrom_xpu_expression(expr,
+								pp_info->xpu_task_flags,
+								pp_info->scan_relid,
+								con->inner_target_list,
+								NULL))
+	{
+		elog(DEBUG2, "Grouping-key must be device executable: %s",
+			 nodeToString(expr));
+		return false;
+	}
+	return true;
+}
+
+/*
+ * make_distinct_aggref
+ *
+ * Aggregate function with DISTINCT, like COUNT(DISTINCT X), is evaluated
+ * by the final Agg node as is. Instead, its arguments are added to the
+ * grouping-keys on the device, so kds_final works as a hash-set that
+ * deduplicates the pairs of the grouping-keys and the distinct values,
+ * then the final Agg node receives only the unique combinations.
+ * The result is exact even if a combination appears multiple times
+ * (by parallel workers, multiple devices or CPU fallback), because the
+ * final Agg node still applies DISTINCT on them.
+ */
+static Node *
+make_distinct_aggref(xpugroupby_build_path_context *con, Aggref *aggref)
+{
+	Query	   *parse = con->root->parse;
+	Aggref	   *aggref_alt;
+	HeapTuple	htup;
+	Form_pg_aggregate agg;
+	ListCell   *lc;
+
+	if (aggref->aggfilter != NULL)
+	{
+		elog(DEBUG2, "Aggregate with DISTINCT and FILTER is not supported: %s",
+			 nodeToString(aggref));
+		return NULL;
+	}
+	/* nodeAgg.c runs DISTINCT aggregates only on the sorted input */
+	if (parse->groupingSets != NIL ||
+		!grouping_is_sortable(parse->groupClause))
+	{
+		elog(DEBUG2, "Aggregate with DISTINCT needs sortable GROUP BY: %s",
+			 nodeToString(aggref));
+		return NULL;
+	}
+	foreach (lc, aggref->args)
+	{
+		TargetEntry *tle = lfirst(lc);
+
+		if (tle->resjunk)
+			continue;
+		if (!xpugroupby_check_device_key(con, tle->expr))
+			return NULL;
+		if (!list_member(con->distinct_keys, tle->expr))
+			con->distinct_keys = lappend(con->distinct_keys, tle->expr);
+	}
+	aggref_alt = copyObject(aggref);
+	aggref_alt->aggtransno = aggref->aggno;	/* see make_alternative_aggref */
+
+	/*
+	 * Update the cost factor
+	 */
+	htup = SearchSysCache1(AGGFNOID, ObjectIdGetDatum(aggref->aggfnoid));
+	if (!HeapTupleIsValid(htup))
+		elog(ERROR, "cache lookup failed for pg_aggregate %u",
+			 aggref->aggfnoid);
+	agg = (Form_pg_aggregate) GETSTRUCT(htup);
+	if (OidIsValid(agg->aggtransfn))
+		add_function_cost(con->root,
+						  agg->aggtransfn,
+						  NULL,
+						  &con->final_clause_costs.transCost);
+	if (OidIsValid(agg->aggfinalfn))
+		add_function_cost(con->root,
+						  agg->aggfinalfn,
+						  NULL,
+						  &con->final_clause_costs.finalCost);
+	ReleaseSysCache(htup);
+	con->has_distinct_aggs = true;
+
+	return (Node *)aggref_alt;
+}
+
 static Node *
 make_alternative_aggref(xpugroupby_build_path_context *con, Aggref *aggref)
 {
@@ -1001,9 +1335,9 @@ make_alternative_aggref(xpugroupby_build_path_context *con, Aggref *aggref)
 	ListCell   *lc;
 	int			j;
 
-	if (aggref->aggorder != NIL || aggref->aggdistinct != NIL)
+	if (aggref->aggorder != NIL)
 	{
-		elog(DEBUG2, "Aggregate with ORDER BY/DISTINCT is not supported: %s",
+		elog(DEBUG2, "Aggregate with ORDER BY is not supported: %s",
 			 nodeToString(aggref));
 		return NULL;
 	}
@@ -1013,6 +1347,8 @@ make_alternative_aggref(xpugroupby_build_path_context *con, Aggref *aggref)
 			 nodeToString(aggref));
 		return NULL;
 	}
+	if (aggref->aggdistinct != NIL)
+		return make_distinct_aggref(con, aggref);
 
 	/*
 	 * Lookup properties of aggregate function
@@ -1070,10 +1406,15 @@ make_alternative_aggref(xpugroupby_build_path_context *con, Aggref *aggref)
 	/* see add_new_column_to_pathtarget */
 	if (!list_member(target_partial->exprs, partfn))
 	{
+		int		prepfn_bufsz = aggfn_cat->partial_func_bufsz;
+
+		/* HLL sketch shall be built with the current register bits */
+		if (aggfn_cat->partial_func_action == KAGG_ACTION__HLL_SKETCH)
+			prepfn_bufsz = MAXALIGN(KAGG_STATE__HLL_SKETCH_SZ(pgstrom_hll_register_bits));
 		add_column_to_pathtarget(target_partial, partfn, 0);
 		pp_info->groupby_actions = lappend_int(pp_info->groupby_actions,
 											   aggfn_cat->partial_func_action);
-		pp_info->groupby_prepfn_bufsz += aggfn_cat->partial_func_bufsz;
+		pp_info->groupby_prepfn_bufsz += prepfn_bufsz;
 	}
 
 	/*
@@ -1200,7 +1541,7 @@ xpugroupby_build_path_target(xpugroupby_build_path_context *con)
 	pgstromPlanInfo *pp_info = con->pp_info;
 	PathTarget	   *target_upper = con->target_upper;
 	Node		   *havingQual = NULL;
-	ListCell	   *lc1, *lc2;
+	ListCell	   *lc1, *lc2, *lc3;
 	int				i = 0;
 
 	/*
@@ -1217,37 +1558,8 @@ xpugroupby_build_path_target(xpugroupby_build_path_context *con)
 										  parse->groupClause) != NULL)
 		{
 			/* Grouping Key */
-			devtype_info *dtype;
-			Oid		type_oid = exprType((Node *)expr);
-			Oid		coll_oid;
-
-			dtype = pgstrom_devtype_lookup(type_oid);
-			if (!dtype || !dtype->type_hashfunc)
-			{
-				elog(DEBUG2, "GROUP BY contains unsupported type (%s): %s",
-					 format_type_be(type_oid),
-					 nodeToString(expr));
-				return false;
-			}
-			coll_oid = exprCollation((Node *)expr);
-			if (devtype_lookup_equal_func(dtype, coll_oid) == NULL)
-			{
-				elog(DEBUG2, "GROUP BY contains unsupported device type (%s): %s",
-					 format_type_be(type_oid),
-					 nodeToString(expr));
+			if (!xpugroupby_check_device_key(con, expr))
 				return false;
-			}
-			/* grouping-key must be device executable. */
-			if (!pgstrom_xpu_expression(expr,
-										pp_info->xpu_task_flags,
-										pp_info->scan_relid,
-										con->inner_target_list,
-										NULL))
-			{
-				elog(DEBUG2, "Grouping-key must be device executable: %s",
-					 nodeToString(expr));
-				return false;
-			}
 			add_column_to_pathtarget(con->target_final, expr, sortgroupref);
 			/* to be attached to target-partial later */
 			con->groupby_keys = lappend(con->groupby_keys, expr);
@@ -1273,6 +1585,14 @@ xpugroupby_build_path_target(xpugroupby_build_path_context *con)
 			}
 			add_column_to_pathtarget(con->target_final, altfn, 0);
 		}
+		else if (IsA(expr, GroupingFunc) && parse->groupingSets != NIL)
+		{
+			/*
+			 * GROUPING() is evaluated by the final Agg node on the grouping
+			 * keys; they are always on the target-partial.
+			 */
+			add_column_to_pathtarget(con->target_final, expr, 0);
+		}
 		else
 		{
 			elog(DEBUG2, "unexpected expression on the upper-tlist: %s",
@@ -1312,12 +1632,158 @@ xpugroupby_build_path_target(xpugroupby_build_path_context *con)
 											   ? KAGG_ACTION__VREF_NOKEY
 											   : KAGG_ACTION__VREF);
 	}
+
+	/*
+	 * Arguments of DISTINCT aggregates are grouping-keys on the device,
+	 * but not for the final Agg node.
+	 */
+	con->num_partial_groups = con->num_groups;
+	if (con->distinct_keys != NIL)
+	{
+		List   *groupExprs = list_copy(con->groupby_keys);
+
+		foreach (lc1, con->distinct_keys)
+		{
+			Expr   *key = lfirst(lc1);
+			bool	found = false;
+
+			forboth (lc2, con->groupby_keys,
+					 lc3, con->groupby_keys_refno)
+			{
+				if (lfirst_int(lc3) != 0 && equal(key, lfirst(lc2)))
+				{
+					found = true;
+					break;
+				}
+			}
+			if (found)
+				continue;
+			add_column_to_pathtarget(con->target_partial, key, 0);
+			pp_info->groupby_actions = lappend_int(pp_info->groupby_actions,
+												   KAGG_ACTION__VREF);
+			groupExprs = lappend(groupExprs, key);
+		}
+		con->num_partial_groups = estimate_num_groups(root, groupExprs,
+													  PP_INFO_NUM_ROWS(pp_info),
+													  NULL, NULL);
+	}
+
+	/*
+	 * STRING_AGG chains the values from the group on the kds_final of GPU,
+	 * so it is not available without grouping-keys, or on DPU.
+	 */
+	if (list_member_int(pp_info->groupby_actions, KAGG_ACTION__STRING_AGG) &&
+		(!list_member_int(pp_info->groupby_actions, KAGG_ACTION__VREF) ||
+		 (pp_info->xpu_task_flags & DEVKIND__ANY) != DEVKIND__NVIDIA_GPU))
+	{
+		elog(DEBUG2, "string_agg is supported only by GpuPreAgg with GROUP BY");
+		return false;
+	}
 	set_pathtarget_cost_width(root, con->target_final);
 	set_pathtarget_cost_width(root, con->target_partial);
 
 	return true;
 }
 
+/*
+ * try_add_final_groupingsets_path
+ *
+ * XpuPreAgg groups the source rows by all the columns in GROUPING SETS,
+ * ROLLUP or CUBE, so a single scan produces the partial groups of the
+ * finest grain. Then, the final Agg node computes each grouping set on
+ * the partial groups by the hash-table per grouping set, as like
+ * consider_groupingsets_paths() doing for the hashed strategy.
+ * It is less rows than the source by far, and all the alternative
+ * aggregate functions can combine the partial states multiple times.
+ */
+static void
+try_add_final_groupingsets_path(xpugroupby_build_path_context *con,
+								Path *part_path)
+{
+	PlannerInfo *root = con->root;
+	Query	   *parse = root->parse;
+	List	   *gsets;
+	List	   *rollups = NIL;
+	List	   *empty_sets = NIL;
+	List	   *empty_sets_data = NIL;
+	AggStrategy	strategy = AGG_HASHED;
+	ListCell   *lc1, *lc2;
+	Path	   *agg_path;
+	Path	   *dummy_path;
+
+	gsets = expand_grouping_sets(parse->groupingSets,
+								 parse->groupDistinct, -1);
+	foreach (lc1, gsets)
+	{
+		List		   *gset = lfirst(lc1);
+		GroupingSetData *gs = makeNode(GroupingSetData);
+		RollupData	   *rollup;
+		List		   *groupClause = NIL;
+		List		   *groupIndex = NIL;
+
+		gs->set = gset;
+		if (gset == NIL)
+		{
+			/* Empty grouping sets can't be hashed. */
+			gs->numGroups = 1.0;
+			empty_sets_data = lappend(empty_sets_data, gs);
+			empty_sets = lappend(empty_sets, NIL);
+			continue;
+		}
+		foreach (lc2, gset)
+		{
+			Index	sortgroupref = lfirst_int(lc2);
+
+			groupIndex = lappend_int(groupIndex, list_length(groupClause));
+			groupClause = lappend(groupClause,
+								  get_sortgroupref_clause(sortgroupref,
+														  parse->groupClause));
+		}
+		gs->numGroups = estimate_num_groups(root,
+											get_sortgrouplist_exprs(groupClause,
+																	parse->targetList),
+											con->num_groups,
+											NULL, NULL);
+		rollup = makeNode(RollupData);
+		rollup->groupClause = groupClause;
+		rollup->gsets = list_make1(groupIndex);
+		rollup->gsets_data = list_make1(gs);
+		rollup->numGroups = gs->numGroups;
+		rollup->hashable = true;
+		rollup->is_hashed = true;
+		rollups = lappend(rollups, rollup);
+	}
+	if (rollups == NIL)
+	{
+		elog(DEBUG2, "GROUPING SETS has no non-empty grouping set");
+		return;
+	}
+	if (empty_sets != NIL)
+	{
+		RollupData *rollup = makeNode(RollupData);
+
+		rollup->groupClause = NIL;
+		rollup->gsets = empty_sets;
+		rollup->gsets_data = empty_sets_data;
+		rollup->numGroups = list_length(empty_sets);
+		rollup->hashable = false;
+		rollup->is_hashed = false;
+		rollups = lappend(rollups, rollup);
+		strategy = AGG_MIXED;
+	}
+	agg_path = (Path *)create_groupingsets_path(root,
+												con->group_rel,
+												part_path,
+												(List *)con->havingQual,
+												strategy,
+												rollups,
+												&con->final_clause_costs);
+	/* create_groupingsets_path() takes the target of the grouped_rel */
+	agg_path->pathtarget = con->target_final;
+	dummy_path = pgstrom_create_dummy_path(root, agg_path);
+	add_path(con->group_rel, dummy_path);
+}
+
 /*
  * try_add_final_groupby_paths
  */
@@ -1329,7 +1795,37 @@ try_add_final_groupby_paths(xpugroupby_build_path_context *con,
 	Path	   *agg_path;
 	Path	   *dummy_path;
 
-	if (!parse->groupClause)
+	if (parse->groupingSets != NIL)
+	{
+		try_add_final_groupingsets_path(con, part_path);
+	}
+	else if (con->has_distinct_aggs)
+	{
+		/*
+		 * nodeAgg.c does not support DISTINCT aggregates in hashed mode,
+		 * so the partial results are sorted by the group pathkeys. It
+		 * also satisfies the aggregates marked as presorted.
+		 */
+		if (con->root->group_pathkeys != NIL)
+			part_path = (Path *)create_sort_path(con->root,
+												 con->group_rel,
+												 part_path,
+												 con->root->group_pathkeys,
+												 -1.0);
+		agg_path = (Path *)create_agg_path(con->root,
+										   con->group_rel,
+										   part_path,
+										   con->target_final,
+										   parse->groupClause ? AGG_SORTED : AGG_PLAIN,
+										   AGGSPLIT_SIMPLE,
+										   parse->groupClause,
+										   (List *)con->havingQual,
+										   &con->final_clause_costs,
+										   con->num_groups);
+		dummy_path = pgstrom_create_dummy_path(con->root, agg_path);
+		add_path(con->group_rel, dummy_path);
+	}
+	else if (!parse->groupClause)
 	{
 		agg_path = (Path *)create_agg_path(con->root,
 										   con->group_rel,
@@ -1365,6 +1861,133 @@ try_add_final_groupby_paths(xpugroupby_build_path_context *con,
 /*
  * __buildXpuPreAggCustomPath
  */
+/*
+ * replace_altfunc_by_final_expression
+ *
+ * It replaces the alternative aggregate function, that combines the partial
+ * states, by its final function that takes the partial state of a group as
+ * is. The transition function of the alternative aggregate functions copies
+ * the partial state at the first call, so the result is equivalent when
+ * every group appears only once.
+ */
+static Node *
+replace_altfunc_by_final_expression(Node *node, bool *p_supported)
+{
+	if (!node)
+		return NULL;
+	if (IsA(node, Aggref))
+	{
+		Aggref	   *aggref = (Aggref *)node;
+		TargetEntry *tle;
+		Expr	   *partfn;
+		HeapTuple	htup;
+		Form_pg_aggregate agg;
+		bool		isnull;
+		Node	   *result = NULL;
+
+		if (list_length(aggref->args) != 1)
+		{
+			*p_supported = false;
+			return node;
+		}
+		tle = linitial(aggref->args);
+		partfn = tle->expr;
+
+		htup = SearchSysCache1(AGGFNOID, ObjectIdGetDatum(aggref->aggfnoid));
+		if (!HeapTupleIsValid(htup))
+			elog(ERROR, "cache lookup failed for pg_aggregate %u",
+				 aggref->aggfnoid);
+		agg = (Form_pg_aggregate) GETSTRUCT(htup);
+		(void)SysCacheGetAttr(AGGFNOID, htup,
+							  Anum_pg_aggregate_agginitval,
+							  &isnull);
+		if (OidIsValid(agg->aggfinalfn))
+		{
+			if (isnull &&
+				!agg->aggfinalextra &&
+				agg->aggtranstype == exprType((Node *)partfn))
+				result = (Node *)makeFuncExpr(agg->aggfinalfn,
+											  aggref->aggtype,
+											  list_make1(partfn),
+											  aggref->aggcollid,
+											  aggref->inputcollid,
+											  COERCE_EXPLICIT_CALL);
+		}
+		else if (agg->aggtranstype == exprType((Node *)partfn) &&
+				 agg->aggtranstype == aggref->aggtype)
+		{
+			/* e.g, fcount(int8) just sums up the partial counts */
+			result = (Node *)partfn;
+		}
+		ReleaseSysCache(htup);
+
+		if (!result)
+		{
+			elog(DEBUG2, "Aggregate function cannot be finalized per group: %s",
+				 nodeToString(aggref));
+			*p_supported = false;
+			return node;
+		}
+		return result;
+	}
+	return expression_tree_mutator(node, replace_altfunc_by_final_expression,
+								   p_supported);
+}
+
+/*
+ * try_add_finalized_groupby_path
+ *
+ * If a single GPU device owns the global kds_final of the non-parallel
+ * GpuPreAgg, every group appears only once in the results. In this case,
+ * the final aggregation (re-hashing of the partial groups by CPU) is a pure
+ * overhead, thus we add an alternative path that finalizes each group by
+ * the projection on top of GpuPreAgg.
+ * CPU fallback, spill of kds_final and partitioned inner buffers break the
+ * assumption above, so they raise an error in this mode.
+ */
+static void
+try_add_finalized_groupby_path(xpugroupby_build_path_context *con,
+							   CustomPath *cpath)
+{
+	Query	   *parse = con->root->parse;
+	PathTarget *target_direct;
+	pgstromPlanInfo *pp_info;
+	CustomPath *cpath_final;
+	Path	   *proj_path;
+	Path	   *dummy_path;
+	bool		supported = true;
+
+	if (!pgstrom_enable_gpupreagg_finalize ||
+		!parse->groupClause ||
+		parse->groupingSets != NIL ||
+		con->has_distinct_aggs ||
+		con->havingQual != NULL ||
+		con->try_parallel ||
+		con->sibling_param_id >= 0 ||
+		numGpuDevAttrs != 1 ||
+		cpath->methods != &gpupreagg_path_methods)
+		return;
+	target_direct = copy_pathtarget(con->target_final);
+	target_direct->exprs = (List *)
+		replace_altfunc_by_final_expression((Node *)target_direct->exprs,
+											&supported);
+	if (!supported)
+		return;
+	pp_info = copy_pgstrom_plan_info(linitial(cpath->custom_private));
+	pp_info->groupby_final_mode = true;
+
+	cpath_final = makeNode(CustomPath);
+	memcpy(cpath_final, cpath, sizeof(CustomPath));
+	cpath_final->custom_private = list_make1(pp_info);
+
+	proj_path = (Path *)create_projection_path(con->root,
+											   con->group_rel,
+											   &cpath_final->path,
+											   target_direct);
+	dummy_path = pgstrom_create_dummy_path(con->root, proj_path);
+	add_path(con->group_rel, dummy_path);
+}
+
 static CustomPath *
 __buildXpuPreAggCustomPath(xpugroupby_build_path_context *con)
 {
@@ -1402,6 +2025,15 @@ __buildXpuPreAggCustomPath(xpugroupby_build_path_context *con)
 	{
 		elog(ERROR, "Bug? unexpected task_kind: %08x", pp_info->xpu_task_flags);
 	}
+	/* calibration by the recorded execution stats, if any */
+	if (pgstrom_cost_calibration)
+	{
+		double	factor = pgstromCostCalibrationFactor(pp_info->xpu_task_flags & DEVKIND__ANY,
+													  DEVTASK__PREAGG);
+		xpu_operator_cost *= factor;
+		xpu_tuple_cost    *= factor;
+		xpu_ratio         *= factor;
+	}
 	pp_info->xpu_task_flags &= ~DEVTASK__MASK;
 	pp_info->xpu_task_flags |= DEVTASK__PREAGG;
 	pp_info->sibling_param_id = con->sibling_param_id;
@@ -1419,7 +2051,30 @@ __buildXpuPreAggCustomPath(xpugroupby_build_path_context *con)
 	startup_cost += (target_partial->cost.per_tuple * input_nrows +
 					 target_partial->cost.startup) * xpu_ratio;
 	/* Cost estimation to fetch results */
-	run_cost = xpu_tuple_cost * con->num_groups;
+	run_cost = xpu_tuple_cost * con->num_partial_groups;
+
+	/*
+	 * Device memory footprint; kds_final keeps all the partial groups
+	 * in addition to the inner buffer. If it exceeds the device memory,
+	 * __expandGpuQueryGroupByBuffer() shall thrash, so we give up this
+	 * path to prefer the partition-wise variant (or CPU plan).
+	 */
+	if ((pp_info->xpu_task_flags & DEVKIND__NVIDIA_GPU) != 0 &&
+		parse->groupClause != NIL)
+	{
+		size_t	limit = pgstrom_gpu_memory_plan_limit();
+
+		pp_info->gpu_memsz += con->num_partial_groups *
+			(MAXALIGN(offsetof(kern_hashitem, t.htup) +
+					  SizeofHeapTupleHeader +
+					  target_partial->width) + sizeof(uint64_t));
+		if (limit > 0 && pp_info->gpu_memsz > (double)limit)
+		{
+			elog(DEBUG2, "GpuPreAgg: final buffer (%.0f bytes) exceeds the device memory limit (%zu bytes)",
+				 pp_info->gpu_memsz, limit);
+			return NULL;
+		}
+	}
 
 	cpath->path.pathtype         = T_CustomScan;
 	cpath->path.parent           = con->input_rel;
@@ -1428,7 +2083,7 @@ __buildXpuPreAggCustomPath(xpugroupby_build_path_context *con)
 	cpath->path.parallel_aware   = con->try_parallel;
 	cpath->path.parallel_safe    = con->input_rel->consider_parallel;
 	cpath->path.parallel_workers = pp_info->parallel_nworkers;
-	cpath->path.rows             = con->num_groups;
+	cpath->path.rows             = con->num_partial_groups;
 	cpath->path.startup_cost     = startup_cost;
 	cpath->path.total_cost       = startup_cost + run_cost;
 	cpath->path.pathkeys         = NIL;
@@ -1491,6 +2146,10 @@ __try_add_xpupreagg_normal_path(PlannerInfo *root,
 	if (!xpugroupby_build_path_target(&con))
 		return;
 	part_path = (Path *)__buildXpuPreAggCustomPath(&con);
+	if (!part_path)
+		return;
+	/* try add finalized groupby path, if possible */
+	try_add_finalized_groupby_path(&con, (CustomPath *)part_path);
 
 	/* inject Gather path if parallel-aware */
 	if (be_parallel)
@@ -1501,7 +2160,7 @@ __try_add_xpupreagg_normal_path(PlannerInfo *root,
 							   part_path,
 							   part_path->pathtarget,
 							   NULL,
-							   &num_groups);
+							   &con.num_partial_groups);
 	}
 	/* try add final groupby path */
 	try_add_final_groupby_paths(&con, part_path);
@@ -1578,7 +2237,8 @@ __try_add_xpupreagg_partition_path(PlannerInfo *root,
 											   op_leaf->leaf_rel->relids,
 											   con.target_partial->exprs);
 		cpath = __buildXpuPreAggCustomPath(&con);
-
+		if (!cpath)
+			return;
 		parallel_nworkers += cpath->path.parallel_workers;
 		total_nrows       += cpath->path.rows;
 
@@ -1634,8 +2294,7 @@ __xpuPreAggAddCustomPathCommon(PlannerInfo *root,
 	Query	   *parse = root->parse;
 
 	/* quick bailout if not supported */
-	if (parse->groupingSets != NIL ||
-		!grouping_is_hashable(parse->groupClause))
+	if (!grouping_is_hashable(parse->groupClause))
 	{
 		elog(DEBUG2, "GROUP BY clause is not supported form");
 		return;
@@ -1803,6 +2462,386 @@ CreateDpuPreAggScanState(CustomScan *cscan)
 	return pgstromCreateTaskState(cscan, &dpupreagg_exec_methods);
 }
 
+/*
+ * __preaggResultCacheDrop
+ */
+static void
+__preaggResultCacheDrop(preaggResultCacheEntry *entry)
+{
+	MemoryContextDelete(entry->memcxt);
+}
+
+/*
+ * __preaggResultCacheUnpin
+ */
+static void
+__preaggResultCacheUnpin(preaggResultCacheEntry *entry)
+{
+	Assert(entry->refcnt > 0);
+	if (--entry->refcnt == 0 && entry->evicted)
+	{
+		dlist_delete(&entry->chain);
+		__preaggResultCacheDrop(entry);
+	}
+}
+
+/*
+ * preaggResultCacheXactCallback
+ *
+ * The nodes in replay pin the entries, but error may skip the unpin.
+ * No executor nodes survive across the transaction end, so we can
+ * release the evicted entries here.
+ */
+static void
+preaggResultCacheXactCallback(XactEvent event, void *arg)
+{
+	dlist_mutable_iter iter;
+	dlist_iter	__iter;
+
+	if (event != XACT_EVENT_COMMIT &&
+		event != XACT_EVENT_ABORT)
+		return;
+	dlist_foreach_modify (iter, &preagg_result_cache_zombies)
+	{
+		preaggResultCacheEntry *entry
+			= dlist_container(preaggResultCacheEntry, chain, iter.cur);
+		dlist_delete(&entry->chain);
+		__preaggResultCacheDrop(entry);
+	}
+	dlist_foreach (__iter, &preagg_result_cache_list)
+	{
+		preaggResultCacheEntry *entry
+			= dlist_container(preaggResultCacheEntry, chain, __iter.cur);
+		entry->refcnt = 0;
+	}
+}
+
+/*
+ * __preaggResultCacheMutableWalker
+ *
+ * It checks whether the expression depends on anything other than the
+ * scanned data, like now(), current_date or current_user.
+ */
+static bool
+__preaggResultCacheMutableChecker(Oid func_oid, void *context)
+{
+	return (func_volatile(func_oid) != PROVOLATILE_IMMUTABLE);
+}
+
+static bool
+__preaggResultCacheMutableWalker(Node *node, void *context)
+{
+	if (!node)
+		return false;
+	if (IsA(node, SQLValueFunction) ||
+		IsA(node, NextValueExpr))
+		return true;
+	if (check_functions_in_node(node, __preaggResultCacheMutableChecker,
+								context))
+		return true;
+	return expression_tree_walker(node,
+								  __preaggResultCacheMutableWalker,
+								  context);
+}
+
+/*
+ * __preaggResultCacheIsMutable
+ *
+ * The partial aggregate functions (pgstrom.nrows, pgstrom.psum, ...) at
+ * the top of custom_scan_tlist are not declared immutable, however, they
+ * are evaluated on the device, so only their arguments are checked.
+ */
+static bool
+__preaggResultCacheIsMutable(pgstromTaskState *pts)
+{
+	CustomScan *cscan = (CustomScan *)pts->css.ss.ps.plan;
+	pgstromPlanInfo *pp_info = pts->pp_info;
+	Oid			namespace_oid = get_namespace_oid("pgstrom", false);
+	ListCell   *lc;
+
+	foreach (lc, cscan->custom_scan_tlist)
+	{
+		TargetEntry *tle = lfirst(lc);
+		Node	   *expr = (Node *)tle->expr;
+
+		if (IsA(expr, FuncExpr) &&
+			get_func_namespace(((FuncExpr *)expr)->funcid) == namespace_oid)
+			expr = (Node *)((FuncExpr *)expr)->args;
+		if (__preaggResultCacheMutableWalker(expr, NULL))
+			return true;
+	}
+	return (__preaggResultCacheMutableWalker((Node *)cscan->custom_exprs, NULL) ||
+			__preaggResultCacheMutableWalker((Node *)cscan->scan.plan.targetlist, NULL) ||
+			__preaggResultCacheMutableWalker((Node *)cscan->scan.plan.qual, NULL) ||
+			__preaggResultCacheMutableWalker((Node *)pp_info->scan_quals, NULL) ||
+			__preaggResultCacheMutableWalker((Node *)pp_info->host_quals, NULL));
+}
+
+/*
+ * __preaggResultCacheBegin
+ */
+static preaggResultCacheState *
+__preaggResultCacheBegin(pgstromTaskState *pts)
+{
+	CustomScan *cscan = (CustomScan *)pts->css.ss.ps.plan;
+	EState	   *estate = pts->css.ss.ps.state;
+	preaggResultCacheState *rc_state;
+	preaggResultCacheEntry *entry;
+	MemoryContext memcxt;
+	MemoryContext oldcxt;
+	StringInfoData buf;
+	dlist_iter	iter;
+	uint32_t	hash;
+
+	/*
+	 * The results are stable only if it scans the Arrow_Fdw files, or
+	 * GpuCache without any REDO logs since the last run, without parallel
+	 * workers, JOIN and parameters.
+	 */
+	if (pgstrom_gpupreagg_result_cache_size <= 0 ||
+		(!pts->arrow_state && !pts->gcache_desc) ||
+		pts->num_rels > 0 ||
+		pts->css.ss.ps.plan->parallel_aware ||
+		IsParallelWorker() ||
+		!bms_is_empty(pts->css.ss.ps.plan->allParam) ||
+		(estate->es_param_list_info &&
+		 estate->es_param_list_info->numParams > 0) ||
+		__preaggResultCacheIsMutable(pts))
+		return NULL;
+
+	/*
+	 * The session configurations that affect the results of immutable
+	 * expressions (e.g, timestamptz to date or text) are also a part of
+	 * the key.
+	 */
+	initStringInfo(&buf);
+	appendStringInfo(&buf, "%u:%u:%s:%s:%d:%d:%d:", MyDatabaseId,
+					 RelationGetRelid(pts->css.ss.ss_currentRelation),
+					 session_timezone ? pg_get_timezone_name(session_timezone) : "",
+					 GetDatabaseEncodingName(),
+					 DateStyle, DateOrder, IntervalStyle);
+	if (pts->arrow_state)
+		pgstromArrowFdwFileSignature(pts->arrow_state, &buf);
+	else if (!pgstromGpuCacheRedoSignature(pts->gcache_desc,
+										   estate->es_snapshot, &buf))
+	{
+		pfree(buf.data);
+		return NULL;
+	}
+	appendStringInfoString(&buf, nodeToString(cscan->custom_private));
+	appendStringInfoString(&buf, nodeToString(cscan->custom_exprs));
+	appendStringInfoString(&buf, nodeToString(cscan->custom_scan_tlist));
+	appendStringInfoString(&buf, nodeToString(cscan->scan.plan.targetlist));
+	appendStringInfoString(&buf, nodeToString(cscan->scan.plan.qual));
+	hash = hash_any((unsigned char *)buf.data, buf.len);
+
+	rc_state = palloc0(sizeof(preaggResultCacheState));
+	dlist_foreach (iter, &preagg_result_cache_list)
+	{
+		entry = dlist_container(preaggResultCacheEntry, chain, iter.cur);
+		if (entry->hash == hash && strcmp(entry->key, buf.data) == 0)
+		{
+			/* move to the head of LRU */
+			dlist_delete(&entry->chain);
+			dlist_push_head(&preagg_result_cache_list, &entry->chain);
+			entry->refcnt++;
+			rc_state->entry = entry;
+			rc_state->cache_hit = true;
+			pfree(buf.data);
+			return rc_state;
+		}
+	}
+	/*
+	 * build a new entry; it belongs to the query until commit, so it is
+	 * released on error.
+	 */
+	memcxt = AllocSetContextCreate(estate->es_query_cxt,
+								   "GpuPreAgg Result Cache",
+								   ALLOCSET_DEFAULT_SIZES);
+	oldcxt = MemoryContextSwitchTo(memcxt);
+	entry = palloc0(sizeof(preaggResultCacheEntry));
+	entry->hash = hash;
+	entry->key = pstrdup(buf.data);
+	entry->memcxt = memcxt;
+	entry->nrooms = 1000;
+	entry->tuples = palloc(sizeof(MinimalTuple) * entry->nrooms);
+	MemoryContextSwitchTo(oldcxt);
+	pfree(buf.data);
+
+	rc_state->entry = entry;
+	return rc_state;
+}
+
+/*
+ * __preaggResultCacheSave
+ */
+static void
+__preaggResultCacheSave(preaggResultCacheState *rc_state, TupleTableSlot *slot)
+{
+	preaggResultCacheEntry *entry = rc_state->entry;
+	MemoryContext oldcxt;
+
+	oldcxt = MemoryContextSwitchTo(entry->memcxt);
+	if (entry->nitems >= entry->nrooms)
+	{
+		entry->nrooms = 2 * entry->nrooms;
+		entry->tuples = repalloc_huge(entry->tuples,
+									  sizeof(MinimalTuple) * entry->nrooms);
+	}
+	entry->tuples[entry->nitems] = ExecCopySlotMinimalTuple(slot);
+	entry->usage += entry->tuples[entry->nitems]->t_len + sizeof(MinimalTuple);
+	entry->nitems++;
+	MemoryContextSwitchTo(oldcxt);
+
+	if (entry->usage > ((size_t)pgstrom_gpupreagg_result_cache_size << 20))
+	{
+		__preaggResultCacheDrop(entry);
+		rc_state->entry = NULL;
+		rc_state->cache_abort = true;
+	}
+}
+
+/*
+ * __preaggResultCacheCommit
+ */
+static void
+__preaggResultCacheCommit(preaggResultCacheState *rc_state)
+{
+	preaggResultCacheEntry *entry = rc_state->entry;
+	size_t		limit = ((size_t)pgstrom_gpupreagg_result_cache_size << 20);
+
+	/* evict the least recently used entries */
+	while (!dlist_is_empty(&preagg_result_cache_list) &&
+		   preagg_result_cache_usage + entry->usage > limit)
+	{
+		preaggResultCacheEntry *victim
+			= dlist_container(preaggResultCacheEntry, chain,
+							  dlist_tail_node(&preagg_result_cache_list));
+		dlist_delete(&victim->chain);
+		preagg_result_cache_usage -= victim->usage;
+		if (victim->refcnt == 0)
+			__preaggResultCacheDrop(victim);
+		else
+		{
+			victim->evicted = true;
+			dlist_push_tail(&preagg_result_cache_zombies, &victim->chain);
+		}
+	}
+	MemoryContextSetParent(entry->memcxt, TopMemoryContext);
+	dlist_push_head(&preagg_result_cache_list, &entry->chain);
+	preagg_result_cache_usage += entry->usage;
+	entry->refcnt++;
+	/* the entry is now owned by the cache, then replay on rescan */
+	rc_state->cache_hit = true;
+	rc_state->index = entry->nitems;
+}
+
+/*
+ * ExecGpuPreAggTaskState
+ */
+static TupleTableSlot *
+ExecGpuPreAggTaskState(CustomScanState *node)
+{
+	pgstromTaskState *pts = (pgstromTaskState *)node;
+	preaggResultCacheState *rc_state = pts->rcache_state;
+	TupleTableSlot *slot;
+
+	if (!rc_state)
+	{
+		rc_state = __preaggResultCacheBegin(pts);
+		if (!rc_state)
+		{
+			/* not cacheable, so never try again */
+			pts->rcache_state = palloc0(sizeof(preaggResultCacheState));
+			pts->rcache_state->cache_abort = true;
+			return pgstromExecTaskState(node);
+		}
+		pts->rcache_state = rc_state;
+	}
+
+	if (rc_state->cache_hit)
+	{
+		preaggResultCacheEntry *entry = rc_state->entry;
+
+		if (rc_state->index >= entry->nitems)
+			return NULL;
+		slot = node->ss.ps.ps_ResultTupleSlot;
+		ExecForceStoreMinimalTuple(entry->tuples[rc_state->index++],
+								   slot, false);
+		return slot;
+	}
+	slot = pgstromExecTaskState(node);
+	if (!rc_state->cache_abort)
+	{
+		if (!TupIsNull(slot))
+			__preaggResultCacheSave(rc_state, slot);
+		else
+			__preaggResultCacheCommit(rc_state);
+	}
+	return slot;
+}
+
+/*
+ * ExecEndGpuPreAggTaskState
+ */
+static void
+ExecEndGpuPreAggTaskState(CustomScanState *node)
+{
+	pgstromTaskState *pts = (pgstromTaskState *)node;
+	preaggResultCacheState *rc_state = pts->rcache_state;
+
+	if (rc_state && rc_state->entry)
+	{
+		if (rc_state->cache_hit)
+			__preaggResultCacheUnpin(rc_state->entry);
+		else
+			__preaggResultCacheDrop(rc_state->entry);	/* under build */
+	}
+	pts->rcache_state = NULL;
+	pgstromExecEndTaskState(node);
+}
+
+/*
+ * ExecReScanGpuPreAggTaskState
+ */
+static void
+ExecReScanGpuPreAggTaskState(CustomScanState *node)
+{
+	pgstromTaskState *pts = (pgstromTaskState *)node;
+	preaggResultCacheState *rc_state = pts->rcache_state;
+
+	if (rc_state)
+	{
+		if (rc_state->cache_hit)
+			rc_state->index = 0;
+		else if (!rc_state->cache_abort)
+		{
+			/* partially built entry is not reusable */
+			__preaggResultCacheDrop(rc_state->entry);
+			rc_state->entry = NULL;
+			rc_state->cache_abort = true;
+		}
+	}
+	pgstromExecResetTaskState(node);
+}
+
+/*
+ * ExplainGpuPreAggTaskState
+ */
+static void
+ExplainGpuPreAggTaskState(CustomScanState *node,
+						  List *ancestors,
+						  ExplainState *es)
+{
+	pgstromTaskState *pts = (pgstromTaskState *)node;
+	preaggResultCacheState *rc_state = pts->rcache_state;
+
+	pgstromExplainTaskState(node, ancestors, es);
+	if (es->analyze && rc_state && rc_state->entry)
+		ExplainPropertyText("Result Cache",
+							rc_state->cache_hit ? "hit" : "miss", es);
+}
+
 /*
  * ExecFallbackCpuPreAgg
  */
@@ -1830,6 +2869,7 @@ __pgstrom_init_xpupreagg_common(void)
 		create_upper_paths_next = create_upper_paths_hook;
 		create_upper_paths_hook = XpuPreAggAddCustomPath;
 		CacheRegisterSyscacheCallback(PROCOID, aggfunc_catalog_htable_invalidator, 0);
+		RegisterXactCallback(preaggResultCacheXactCallback, NULL);
 
 		xpupreagg_common_initialized = true;
 	}
@@ -1868,6 +2908,26 @@ pgstrom_init_gpu_preagg(void)
 							 PGC_USERSET,
 							 GUC_NOT_IN_SAMPLE,
 							 NULL, NULL, NULL);
+	/* pg_strom.enable_gpupreagg_finalize */
+	DefineCustomBoolVariable("pg_strom.enable_gpupreagg_finalize",
+							 "Enables GPU-PreAgg to finalize the groups without CPU aggregation",
+							 NULL,
+							 &pgstrom_enable_gpupreagg_finalize,
+							 false,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* pg_strom.gpupreagg_result_cache_size */
+	DefineCustomIntVariable("pg_strom.gpupreagg_result_cache_size",
+							"Size of the GpuPreAgg result cache over Arrow_Fdw, per backend",
+							NULL,
+							&pgstrom_gpupreagg_result_cache_size,
+							0,
+							0,
+							INT_MAX,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_MB,
+							NULL, NULL, NULL);
 	/* pg_strom.hll_registers_bits */
 	DefineCustomIntVariable("pg_strom.hll_registers_bits",
 							"Accuracy of HyperLogLog COUNT(distinct ...) estimation",
@@ -1895,14 +2955,14 @@ pgstrom_init_gpu_preagg(void)
 	memset(&gpupreagg_exec_methods, 0, sizeof(CustomExecMethods));
 	gpupreagg_exec_methods.CustomName          = "GpuPreAgg";
 	gpupreagg_exec_methods.BeginCustomScan     = pgstromExecInitTaskState;
-	gpupreagg_exec_methods.ExecCustomScan      = pgstromExecTaskState;
-	gpupreagg_exec_methods.EndCustomScan       = pgstromExecEndTaskState;
-	gpupreagg_exec_methods.ReScanCustomScan    = pgstromExecResetTaskState;
+	gpupreagg_exec_methods.ExecCustomScan      = ExecGpuPreAggTaskState;
+	gpupreagg_exec_methods.EndCustomScan       = ExecEndGpuPreAggTaskState;
+	gpupreagg_exec_methods.ReScanCustomScan    = ExecReScanGpuPreAggTaskState;
 	gpupreagg_exec_methods.EstimateDSMCustomScan = pgstromSharedStateEstimateDSM;
 	gpupreagg_exec_methods.InitializeDSMCustomScan = pgstromSharedStateInitDSM;
 	gpupreagg_exec_methods.InitializeWorkerCustomScan = pgstromSharedStateAttachDSM;
 	gpupreagg_exec_methods.ShutdownCustomScan  = pgstromSharedStateShutdownDSM;
-	gpupreagg_exec_methods.ExplainCustomScan   = pgstromExplainTaskState;
+	gpupreagg_exec_methods.ExplainCustomScan   = ExplainGpuPreAggTaskState;
 	/* common portion */
 	__pgstrom_init_xpupreagg_common();
 }
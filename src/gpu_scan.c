@@ -21,6 +21,10 @@ static CustomPathMethods	dpuscan_path_methods;
 static CustomScanMethods	dpuscan_plan_methods;
 static CustomExecMethods	dpuscan_exec_methods;
 static bool					enable_dpuscan = false;		/* GUC */
+static bool					pgstrom_enable_dpu_prefilter = false;	/* GUC */
+static bool					pgstrom_enable_gputopk = true;	/* GUC */
+static bool					pgstrom_enable_gpusort = true;	/* GUC */
+static bool					pgstrom_enable_generated_column_rewrite = true;	/* GUC */
 
 /*
  * sort_device_qualifiers
@@ -68,6 +72,44 @@ sort_device_qualifiers(List *dev_quals_list, List *dev_costs_list)
 			dev_quals[i]->ptr_value = dqual;
 		}
 	}
+	/* dev_costs_list also follows the sorted order */
+	i = 0;
+	foreach (lc2, dev_costs_list)
+		lfirst_int(lc2) = dev_costs[i++];
+}
+
+/*
+ * cost_device_qualifiers
+ *
+ * It estimates the per-tuple cost of the device qualifiers according to the
+ * cost of the device functions and operators (FUNC_COST in xpu_opcodes.h),
+ * instead of the procost of the host functions. The qualifiers are evaluated
+ * in the order of dev_quals_list, so the later ones are discounted by the
+ * selectivity of the former ones.
+ * The result is in the unit of cpu_operator_cost, so the caller shall
+ * multiply the xPU operator ratio.
+ */
+Cost
+cost_device_qualifiers(PlannerInfo *root,
+					   List *dev_quals_list,
+					   List *dev_costs_list,
+					   Index varRelid)
+{
+	Selectivity	selectivity = 1.0;
+	Cost		qual_cost = 0.0;
+	ListCell   *lc1, *lc2;
+
+	forboth (lc1, dev_quals_list,
+			 lc2, dev_costs_list)
+	{
+		Node   *dqual = lfirst(lc1);
+		int		dcost = lfirst_int(lc2);
+
+		qual_cost += cpu_operator_cost * (double)Max(dcost, 1) * selectivity;
+		selectivity *= clause_selectivity(root, dqual, varRelid,
+										  JOIN_INNER, NULL);
+	}
+	return qual_cost;
 }
 
 /*
@@ -79,6 +121,7 @@ __buildSimpleScanPlanInfo(PlannerInfo *root,
 						  uint32_t xpu_task_flags,
 						  bool parallel_path,
 						  List *dev_quals,
+						  List *dev_costs,
 						  List *host_quals,
 						  Cardinality scan_nrows)
 {
@@ -92,6 +135,9 @@ __buildSimpleScanPlanInfo(PlannerInfo *root,
 	List		   *indexConds = NIL;
 	List		   *indexQuals = NIL;
 	int64_t			indexNBlocks = 0;
+	List		   *subIndexOids = NIL;
+	List		   *subIndexConds = NIL;
+	Cost			subIndexCost = 0.0;
 	int				parallel_nworkers = 0;
 	double			parallel_divisor = 1.0;
 	double			spc_seq_page_cost;
@@ -173,6 +219,14 @@ __buildSimpleScanPlanInfo(PlannerInfo *root,
 	{
 		elog(ERROR, "Bug? unsupported xpu_task_flags: %08x", xpu_task_flags);
 	}
+	/* calibration by the recorded execution stats, if any */
+	if (pgstrom_cost_calibration)
+	{
+		double	factor = pgstromCostCalibrationFactor(xpu_task_flags & DEVKIND__ANY,
+													  DEVTASK__SCAN);
+		xpu_ratio      *= factor;
+		xpu_tuple_cost *= factor;
+	}
 
 	/*
 	 * NOTE: ArrowGetForeignRelSize() already discount baserel->pages according
@@ -189,13 +243,17 @@ __buildSimpleScanPlanInfo(PlannerInfo *root,
 	indexOpt = pgstromTryFindBrinIndex(root, baserel,
 									   &indexConds,
 									   &indexQuals,
-									   &indexNBlocks);
+									   &indexNBlocks,
+									   &subIndexOids,
+									   &subIndexConds,
+									   &subIndexCost);
 	if (indexOpt)
 	{
 		Cost	index_disk_cost = (cost_brin_bitmap_build(root,
 														  baserel,
 														  indexOpt,
 														  indexQuals) +
+								   subIndexCost +
 								   avg_seq_page_cost * indexNBlocks);
 		if (disk_cost > index_disk_cost)
 		{
@@ -215,7 +273,9 @@ __buildSimpleScanPlanInfo(PlannerInfo *root,
 	{
 		cost_qual_eval_node(&qcost, (Node *)dev_quals, root);
 		startup_cost += qcost.startup;
-		run_cost += qcost.per_tuple * xpu_ratio * ntuples / parallel_divisor;
+		run_cost += (cost_device_qualifiers(root, dev_quals, dev_costs,
+											baserel->relid) *
+					 xpu_ratio * ntuples / parallel_divisor);
 
 		selectivity = clauselist_selectivity(root,
 											 dev_quals,
@@ -273,6 +333,8 @@ __buildSimpleScanPlanInfo(PlannerInfo *root,
 		pp_info->brin_index_oid = indexOpt->indexoid;
 		pp_info->brin_index_conds = indexConds;
 		pp_info->brin_index_quals = indexQuals;
+		pp_info->brin_subindex_oids = subIndexOids;
+		pp_info->brin_subindex_conds = subIndexConds;
 	}
 	outer_refs = pickup_outer_referenced(root, baserel, outer_refs);
 	pull_varattnos((Node *)pp_info->host_quals,
@@ -285,6 +347,113 @@ __buildSimpleScanPlanInfo(PlannerInfo *root,
 }
 
 
+/*
+ * Replacement of the expressions by the stored generated columns
+ *
+ * If a qualifier contains an expression identical to the generation
+ * expression of a stored generated column, like:
+ *
+ *   ALTER TABLE events ADD COLUMN uid int
+ *     GENERATED ALWAYS AS ((payload->>'uid')::int) STORED;
+ *
+ * we can reference the column instead of the expression, because the
+ * generation expression is immutable and the value is already computed
+ * at INSERT/UPDATE. It prevents the device code from parsing the jsonb
+ * (or other large values) for each row, and the GpuCache also keeps the
+ * generated column as a regular typed column.
+ */
+typedef struct
+{
+	Index		relid;
+	List	   *gencol_exprs;
+	List	   *gencol_vars;
+} replace_generated_columns_context;
+
+static Node *
+__replace_generated_columns_mutator(Node *node,
+									replace_generated_columns_context *con)
+{
+	ListCell   *lc1, *lc2;
+
+	if (!node)
+		return NULL;
+	forboth (lc1, con->gencol_exprs,
+			 lc2, con->gencol_vars)
+	{
+		if (equal(node, lfirst(lc1)))
+			return copyObject(lfirst(lc2));
+	}
+	return expression_tree_mutator(node, __replace_generated_columns_mutator, con);
+}
+
+static bool
+__setup_generated_columns_context(PlannerInfo *root,
+								  RelOptInfo *baserel,
+								  replace_generated_columns_context *con)
+{
+	RangeTblEntry *rte = root->simple_rte_array[baserel->relid];
+	Relation	rel;
+	TupleDesc	tupdesc;
+
+	memset(con, 0, sizeof(replace_generated_columns_context));
+	con->relid = baserel->relid;
+	if (!pgstrom_enable_generated_column_rewrite ||
+		rte->rtekind != RTE_RELATION)
+		return false;
+	rel = table_open(rte->relid, NoLock);
+	tupdesc = RelationGetDescr(rel);
+	if (tupdesc->constr && tupdesc->constr->has_generated_stored)
+	{
+		for (int j=0; j < tupdesc->natts; j++)
+		{
+			Form_pg_attribute attr = TupleDescAttr(tupdesc, j);
+			Node	   *expr;
+
+			if (attr->attisdropped ||
+				attr->attgenerated != ATTRIBUTE_GENERATED_STORED)
+				continue;
+			expr = build_column_default(rel, attr->attnum);
+			if (!expr)
+				continue;
+			if (con->relid != 1)
+				ChangeVarNodes(expr, 1, con->relid, 0);
+			expr = eval_const_expressions(root, expr);
+			/* not worth to replace trivial expressions */
+			if (IsA(expr, Var) || IsA(expr, Const))
+				continue;
+			con->gencol_exprs = lappend(con->gencol_exprs, expr);
+			con->gencol_vars = lappend(con->gencol_vars,
+									   makeVar(con->relid,
+											   attr->attnum,
+											   attr->atttypid,
+											   attr->atttypmod,
+											   attr->attcollation,
+											   0));
+		}
+	}
+	table_close(rel, NoLock);
+
+	return (con->gencol_exprs != NIL);
+}
+
+static RestrictInfo *
+__replace_generated_columns(RestrictInfo *rinfo,
+							replace_generated_columns_context *con)
+{
+	Expr	   *clause;
+
+	if (con->gencol_exprs == NIL)
+		return rinfo;
+	clause = (Expr *)__replace_generated_columns_mutator((Node *)rinfo->clause, con);
+	if (equal(clause, rinfo->clause))
+		return rinfo;
+	/* baserestrictinfo is shared with the other paths */
+	rinfo = copyObject(rinfo);
+	rinfo->clause = clause;
+	rinfo->orclause = NULL;
+	return rinfo;
+}
+
 static pgstromOuterPathLeafInfo *
 buildSimpleScanPlanInfo(PlannerInfo *root,
 						RelOptInfo *baserel,
@@ -299,13 +468,16 @@ buildSimpleScanPlanInfo(PlannerInfo *root,
 	List	   *host_quals = NIL;
 	ListCell   *lc;
 	Cardinality	scan_nrows = baserel->rows;
+	replace_generated_columns_context gencol_con;
 
 	Assert((xpu_task_flags & DEVKIND__ANY) == DEVKIND__NVIDIA_GPU ||
 		   (xpu_task_flags & DEVKIND__ANY) == DEVKIND__NVIDIA_DPU);
+	__setup_generated_columns_context(root, baserel, &gencol_con);
 	/* fetch device/host qualifiers */
 	foreach (lc, baserel->baserestrictinfo)
 	{
-		RestrictInfo *rinfo = lfirst(lc);
+		RestrictInfo *rinfo = __replace_generated_columns(lfirst(lc),
+														  &gencol_con);
 		int		devcost;
 
 		if (pgstrom_xpu_expression(rinfo->clause,
@@ -329,7 +501,8 @@ buildSimpleScanPlanInfo(PlannerInfo *root,
 	{
 		foreach (lc, param_info->ppi_clauses)
 		{
-			RestrictInfo *rinfo = lfirst(lc);
+			RestrictInfo *rinfo = __replace_generated_columns(lfirst(lc),
+															  &gencol_con);
 			int		devcost;
 
 			if (pgstrom_xpu_expression(rinfo->clause,
@@ -355,6 +528,7 @@ buildSimpleScanPlanInfo(PlannerInfo *root,
 										xpu_task_flags,
 										parallel_path,
 										dev_quals,
+										dev_costs,
 										host_quals,
 										scan_nrows);
 	if (!pp_info)
@@ -373,6 +547,271 @@ buildSimpleScanPlanInfo(PlannerInfo *root,
 	return op_leaf;
 }
 
+/*
+ * __pathkey_to_sortkey_flags
+ *
+ * It checks whether the pathkey is supported by the device sort-key;
+ * only the default ordering of the fixed-length numeric types.
+ */
+static bool
+__pathkey_to_sortkey_flags(PathKey *pathkey, Oid type_oid, int *p_flags)
+{
+	TypeCacheEntry *tcache;
+	int			flags = 0;
+
+	switch (type_oid)
+	{
+		case FLOAT4OID:
+		case FLOAT8OID:
+			flags |= KERN_SORTKEY__FLOAT_KEY;
+			break;
+		case INT2OID:
+		case INT4OID:
+		case INT8OID:
+		case DATEOID:
+		case TIMEOID:
+		case TIMESTAMPOID:
+		case TIMESTAMPTZOID:
+		case CASHOID:
+			break;
+		default:
+			return false;
+	}
+	/* must be the default sort order of the type */
+	tcache = lookup_type_cache(type_oid, TYPECACHE_BTREE_OPFAMILY);
+	if (pathkey->pk_opfamily != tcache->btree_opf)
+		return false;
+	if (pathkey->pk_strategy == BTGreaterStrategyNumber)
+		flags |= KERN_SORTKEY__DESC;
+	if (pathkey->pk_nulls_first)
+		flags |= KERN_SORTKEY__NULLS_FIRST;
+	*p_flags = flags;
+	return true;
+}
+
+/*
+ * pgstrom_build_topk_planinfo
+ *
+ * If the query is ORDER BY ... LIMIT N on the result of this scan/join
+ * without any further relational operations, GPU-Service can drop the rows
+ * that are never in the top-N of the chunk, prior to write back. Sort and
+ * Limit on the host side run as usual, so the leading sort key is enough
+ * to reduce the rows.
+ * If LIMIT N has no ORDER BY, any N rows are the results. So, GPU-Service
+ * stops the source scan once N rows were produced, and the backend stops
+ * to send the next chunks once N rows were returned (limit_nitems).
+ */
+void
+pgstrom_build_topk_planinfo(PlannerInfo *root,
+							RelOptInfo *rel,
+							pgstromPlanInfo *pp_info,
+							List *tlist_dev)
+{
+	Query	   *parse = root->parse;
+	PathKey	   *pathkey;
+	EquivalenceClass *ec;
+	ListCell   *lc1, *lc2;
+
+	pp_info->topk_nitems = 0;
+	pp_info->limit_nitems = 0;
+	if ((pp_info->xpu_task_flags & DEVKIND__ANY) != DEVKIND__NVIDIA_GPU ||
+		root->limit_tuples <= 0.0 ||
+		root->limit_tuples > (double)INT_MAX ||
+		parse->groupClause != NIL ||
+		parse->groupingSets != NIL ||
+		parse->hasAggs ||
+		parse->havingQual != NULL ||
+		parse->distinctClause != NIL ||
+		parse->hasWindowFuncs ||
+		parse->hasTargetSRFs ||
+		parse->setOperations != NULL ||
+		parse->rowMarks != NIL ||
+		pp_info->host_quals != NIL ||
+		!bms_is_subset(root->all_baserels, rel->relids))
+		return;
+	if (root->sort_pathkeys == NIL)
+	{
+		/*
+		 * RIGHT/FULL OUTER JOIN emits the inner rows not matched at the end,
+		 * so all the outer rows must be scanned.
+		 */
+		for (int i=0; i < pp_info->num_rels; i++)
+		{
+			JoinType	join_type = pp_info->inners[i].join_type;
+
+			if (join_type == JOIN_RIGHT || join_type == JOIN_FULL)
+				return;
+		}
+		pp_info->limit_nitems = (int)root->limit_tuples;
+		return;
+	}
+	if (!pgstrom_enable_gputopk ||
+		root->limit_tuples > (double)GPUTOPK_MAX_NITEMS)
+		return;
+	/* GPU Sort already determined the sort key */
+	if (OidIsValid(pp_info->gpusort_sortop))
+	{
+		pp_info->topk_nitems = (int)root->limit_tuples;
+		return;
+	}
+
+	pathkey = linitial(root->sort_pathkeys);
+	ec = pathkey->pk_eclass;
+	if (ec->ec_has_volatile)
+		return;
+	foreach (lc1, ec->ec_members)
+	{
+		EquivalenceMember *em = lfirst(lc1);
+		int			flags;
+
+		if (em->em_is_const || em->em_is_child)
+			continue;
+		if (!__pathkey_to_sortkey_flags(pathkey,
+										exprType((Node *)em->em_expr),
+										&flags))
+			continue;
+		foreach (lc2, tlist_dev)
+		{
+			TargetEntry *tle = lfirst(lc2);
+
+			if (tle->resjunk)
+				break;
+			if (equal(tle->expr, em->em_expr))
+			{
+				pp_info->topk_nitems = (int)root->limit_tuples;
+				pp_info->sortkey_resno = tle->resno;
+				pp_info->sortkey_flags = flags;
+				return;
+			}
+		}
+	}
+}
+
+/*
+ * __fetch_gpusort_key_expr
+ *
+ * It returns the sort key expression of the GPU Sort path on the baserel.
+ */
+static Expr *
+__fetch_gpusort_key_expr(RelOptInfo *baserel, PathKey *pathkey)
+{
+	ListCell   *lc;
+
+	foreach (lc, pathkey->pk_eclass->ec_members)
+	{
+		EquivalenceMember *em = lfirst(lc);
+
+		if (!em->em_is_const &&
+			!em->em_is_child &&
+			IsA(em->em_expr, Var) &&
+			bms_equal(em->em_relids, baserel->relids) &&
+			list_member(baserel->reltarget->exprs, em->em_expr))
+			return em->em_expr;
+	}
+	return NULL;
+}
+
+/*
+ * __lookup_gpusort_key
+ *
+ * It checks whether the pathkey is available for the GPU Sort key, and
+ * returns its flags and the sort operator.
+ */
+static bool
+__lookup_gpusort_key(RelOptInfo *baserel, PathKey *pathkey,
+					 int *p_flags, Oid *p_sortop)
+{
+	Expr	   *key_expr;
+	Oid			type_oid;
+
+	if (pathkey->pk_eclass->ec_has_volatile)
+		return false;
+	key_expr = __fetch_gpusort_key_expr(baserel, pathkey);
+	if (!key_expr)
+		return false;
+	type_oid = exprType((Node *)key_expr);
+	if (!__pathkey_to_sortkey_flags(pathkey, type_oid, p_flags))
+		return false;
+	*p_sortop = get_opfamily_member(pathkey->pk_opfamily,
+									type_oid,
+									type_oid,
+									pathkey->pk_strategy);
+	return OidIsValid(*p_sortop);
+}
+
+/*
+ * try_add_gpusort_scan_path
+ *
+ * GPU Sort path returns the results ordered by the leading two keys of the
+ * query_pathkeys; GPU-Service sorts each chunk, then the backend merges
+ * the sorted chunks. The remaining keys, if any, shall be handled by
+ * the Incremental Sort.
+ * It fits the input of WindowAgg by PARTITION BY x ORDER BY y; rows are
+ * delivered in the order of the window, so no sort is needed on the CPU.
+ */
+static void
+try_add_gpusort_scan_path(PlannerInfo *root,
+						  RelOptInfo *baserel,
+						  CustomPath *cpath)
+{
+	pgstromPlanInfo *pp_info = linitial(cpath->custom_private);
+	pgstromPlanInfo *pp_temp;
+	CustomPath *sorted;
+	PathKey	   *pathkey;
+	Oid			sortop;
+	int			flags;
+	double		nrows = cpath->path.rows;
+	double		width = baserel->reltarget->width;
+	double		nruns;
+	double		npages;
+
+	if (!pgstrom_enable_gpusort ||
+		root->query_pathkeys == NIL ||
+		(pp_info->xpu_task_flags & DEVKIND__ANY) != DEVKIND__NVIDIA_GPU)
+		return;
+	pathkey = linitial(root->query_pathkeys);
+	if (!__lookup_gpusort_key(baserel, pathkey, &flags, &sortop))
+		return;
+
+	pp_temp = copy_pgstrom_plan_info(pp_info);
+	pp_temp->sortkey_flags = flags;
+	pp_temp->gpusort_sortop = sortop;
+	pp_temp->gpusort_collid = pathkey->pk_eclass->ec_collation;
+
+	sorted = makeNode(CustomPath);
+	memcpy(sorted, cpath, sizeof(CustomPath));
+	sorted->path.pathkeys = list_make1(pathkey);
+	sorted->custom_private = list_make1(pp_temp);
+
+	/* the second key, if any */
+	if (list_length(root->query_pathkeys) > 1)
+	{
+		pathkey = lsecond(root->query_pathkeys);
+		if (__lookup_gpusort_key(baserel, pathkey, &flags, &sortop))
+		{
+			pp_temp->sortkey2_flags = flags;
+			pp_temp->gpusort_sortop2 = sortop;
+			pp_temp->gpusort_collid2 = pathkey->pk_eclass->ec_collation;
+			sorted->path.pathkeys = lappend(sorted->path.pathkeys, pathkey);
+		}
+	}
+	/*
+	 * cost for GPU Sort; radix sort on the device, and write/read/merge
+	 * the sorted runs on the host side. No results are returned until
+	 * all the chunks are sorted.
+	 */
+	width += MAXALIGN(SizeofHeapTupleHeader) + sizeof(uint32_t);
+	nruns = Max(ceil(nrows * width / (double)PGSTROM_CHUNK_SIZE), 1.0);
+	npages = ceil(nrows * width / (double)BLCKSZ);
+	sorted->path.startup_cost = (cpath->path.total_cost +
+								 nrows * pgstrom_gpu_operator_cost * 64.0 +
+								 npages * seq_page_cost);
+	sorted->path.total_cost = (sorted->path.startup_cost +
+							   npages * seq_page_cost +
+							   nrows * 2.0 * cpu_operator_cost * log2(nruns + 1.0));
+	add_path(baserel, &sorted->path);
+}
+
 /*
  * try_add_simple_scan_path
  */
@@ -415,7 +854,8 @@ try_add_simple_scan_path(PlannerInfo *root,
 	{
 		pgstromPlanInfo *pp_info = op_leaf->pp_info;
 
-		if (pp_info->scan_quals != NIL)
+		if (pp_info->scan_quals != NIL ||
+			(allow_no_device_quals && pp_info->host_quals == NIL))
 		{
 			CustomPath *cpath = makeNode(CustomPath);
 
@@ -438,8 +878,21 @@ try_add_simple_scan_path(PlannerInfo *root,
 			cpath->custom_private   = list_make1(pp_info);
 			cpath->methods = xpuscan_path_methods;
 
-			if (be_parallel == 0)
+			/*
+			 * GpuScan without device quals makes sense only if GPU Sort
+			 * saves the CPU sort, like the sorted (key, ctid) extraction
+			 * of the whole table.
+			 */
+			if (pp_info->scan_quals == NIL)
+			{
+				if (be_parallel == 0)
+					try_add_gpusort_scan_path(root, baserel, cpath);
+			}
+			else if (be_parallel == 0)
+			{
 				add_path(baserel, &cpath->path);
+				try_add_gpusort_scan_path(root, baserel, cpath);
+			}
 			else
 				add_partial_path(baserel, &cpath->path);
 		}
@@ -553,7 +1006,9 @@ __xpuScanAddScanPathCommon(PlannerInfo *root,
 									 xpu_task_flags,
 									 (try_parallel > 0),
 									 true,	/* allow host quals */
-									 false,	/* disallow no device quals*/
+									 (pgstrom_enable_gpusort &&
+									  root->query_pathkeys != NIL &&
+									  (xpu_task_flags & DEVKIND__ANY) == DEVKIND__NVIDIA_GPU),
 									 xpuscan_path_methods);
 		}
 		if (!baserel->consider_parallel)
@@ -709,6 +1164,75 @@ gpuscan_build_projection(RelOptInfo *baserel,
 	return tlist_dev;
 }
 
+/*
+ * gpuscan_build_gpusort_key
+ *
+ * It determines the attribute number of the GPU Sort keys on the kds_dst.
+ * The key must be a valid (non-junk) entry of the tlist_dev, so we insert
+ * the key prior to the junk entries if not exist.
+ */
+static AttrNumber
+__gpuscan_build_gpusort_key(RelOptInfo *baserel,
+							PathKey *pathkey,
+							codegen_context *context)
+{
+	Expr	   *key_expr = __fetch_gpusort_key_expr(baserel, pathkey);
+	List	   *tlist_new = NIL;
+	AttrNumber	resno = 1;
+	AttrNumber	key_resno = 0;
+	ListCell   *lc;
+
+	if (!key_expr)
+		elog(ERROR, "Bug? GPU Sort key is not found");
+	foreach (lc, context->tlist_dev)
+	{
+		TargetEntry *tle = lfirst(lc);
+
+		if (tle->resjunk)
+			break;
+		if (equal(tle->expr, key_expr))
+			return tle->resno;
+	}
+	/* not found, so insert the key prior to the junk entries */
+	foreach (lc, context->tlist_dev)
+	{
+		TargetEntry *tle = lfirst(lc);
+
+		if (tle->resjunk && key_resno == 0)
+		{
+			key_resno = resno;
+			tlist_new = lappend(tlist_new,
+								makeTargetEntry(key_expr, resno++, NULL, false));
+		}
+		tle->resno = resno++;
+		tlist_new = lappend(tlist_new, tle);
+	}
+	if (key_resno == 0)
+	{
+		key_resno = resno;
+		tlist_new = lappend(tlist_new,
+							makeTargetEntry(key_expr, resno++, NULL, false));
+	}
+	context->tlist_dev = tlist_new;
+
+	return key_resno;
+}
+
+static void
+gpuscan_build_gpusort_key(RelOptInfo *baserel,
+						  CustomPath *best_path,
+						  pgstromPlanInfo *pp_info,
+						  codegen_context *context)
+{
+	List	   *pathkeys = best_path->path.pathkeys;
+
+	pp_info->sortkey_resno =
+		__gpuscan_build_gpusort_key(baserel, linitial(pathkeys), context);
+	if (OidIsValid(pp_info->gpusort_sortop2))
+		pp_info->sortkey2_resno =
+			__gpuscan_build_gpusort_key(baserel, lsecond(pathkeys), context);
+}
+
 /*
  * __build_explain_tlist_junks
  */
@@ -831,7 +1355,10 @@ PlanXpuScanPathCommon(PlannerInfo *root,
 	pp_info->kexp_scan_quals = codegen_build_scan_quals(context, pp_info->scan_quals);
 	/* code generation for the Projection */
 	context->tlist_dev = gpuscan_build_projection(baserel, pp_info, tlist);
+	if (OidIsValid(pp_info->gpusort_sortop))
+		gpuscan_build_gpusort_key(baserel, best_path, pp_info, context);
 	pp_info->kexp_projection = codegen_build_projection(context);
+	pgstrom_build_topk_planinfo(root, baserel, pp_info, context->tlist_dev);
 	/* VarLoads for each depth */
 	codegen_build_packed_kvars_load(context, pp_info);
 	/* VarMoves for each depth (only GPUs) */
@@ -920,6 +1447,161 @@ PlanDpuScanPath(PlannerInfo *root,
 	return &cscan->scan.plan;
 }
 
+/*
+ * pgstrom_build_dpu_prefilter_plan
+ *
+ * It builds a DpuScan sub-plan that runs the scan qualifiers of the GPU
+ * workload on the DPU close to the storage, when the outer relation is
+ * located on the DPU attached storage but GPU-Direct SQL is not available.
+ * The DpuScan returns tuples in the table layout, and the columns never
+ * referenced by the GPU workload are sent back as NULL to reduce the network
+ * traffic. The GPU workload loads them as KDS_FORMAT_ROW chunks, instead of
+ * the normal heap scan.
+ */
+Plan *
+pgstrom_build_dpu_prefilter_plan(PlannerInfo *root,
+								 CustomPath *cpath,
+								 pgstromPlanInfo *pp_gpu)
+{
+	RelOptInfo	   *baserel;
+	RangeTblEntry  *rte;
+	pgstromOuterPathLeafInfo *op_leaf;
+	pgstromPlanInfo *pp_info;
+	CustomPath	   *dpath;
+	codegen_context *context;
+	CustomScan	   *cscan;
+	Relation		relation;
+	TupleDesc		tupdesc;
+	List		   *tlist_dev = NIL;
+	List		   *tlist_vars = NIL;
+	int				natts;
+	int				anum;
+
+	if (!pgstrom_enable_dpu_prefilter ||
+		(pp_gpu->xpu_task_flags & DEVKIND__ANY) != DEVKIND__NVIDIA_GPU ||
+		pp_gpu->scan_relid == 0 ||
+		pp_gpu->scan_quals == NIL ||
+		pp_gpu->gpu_cache_dindex >= 0 ||
+		pp_gpu->gpu_direct_devs != NULL ||
+		OidIsValid(pp_gpu->brin_index_oid))
+		return NULL;
+	baserel = root->simple_rel_array[pp_gpu->scan_relid];
+	rte = root->simple_rte_array[pp_gpu->scan_relid];
+	if (rte->rtekind != RTE_RELATION ||
+		(rte->relkind != RELKIND_RELATION &&
+		 rte->relkind != RELKIND_MATVIEW) ||
+		!bms_is_empty(baserel->lateral_relids))
+		return NULL;
+	/* system columns and whole-row references are not supported */
+	anum = bms_next_member(pp_gpu->outer_refs, -1);
+	if (anum >= 0 && anum + FirstLowInvalidHeapAttributeNumber <= 0)
+		return NULL;
+	op_leaf = buildSimpleScanPlanInfo(root, baserel,
+									  TASK_KIND__DPUSCAN,
+									  cpath->path.parallel_aware);
+	if (!op_leaf || op_leaf->pp_info->scan_quals == NIL)
+		return NULL;
+	pp_info = op_leaf->pp_info;
+	/* GPU workload evaluates the host qualifiers, if any */
+	pp_info->host_quals = NIL;
+
+	/*
+	 * Build the target-list in the table layout; unreferenced columns
+	 * are replaced by NULL.
+	 */
+	relation = table_open(rte->relid, AccessShareLock);
+	tupdesc = RelationGetDescr(relation);
+	natts = tupdesc->natts;
+	for (int j=0; j < natts; j++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, j);
+		Var		   *var;
+		Expr	   *expr;
+
+		if (attr->attisdropped)
+			break;
+		var = makeVar(baserel->relid,
+					  attr->attnum,
+					  attr->atttypid,
+					  attr->atttypmod,
+					  attr->attcollation,
+					  0);
+		if (bms_is_member(attr->attnum - FirstLowInvalidHeapAttributeNumber,
+						  pp_gpu->outer_refs))
+			expr = (Expr *)var;
+		else
+			expr = (Expr *)makeNullConst(attr->atttypid,
+										 attr->atttypmod,
+										 attr->attcollation);
+		if (!pgstrom_xpu_expression(expr,
+									pp_info->xpu_task_flags,
+									baserel->relid,
+									NIL,
+									NULL))
+			break;
+		tlist_vars = lappend(tlist_vars,
+							 makeTargetEntry((Expr *)var,
+											 list_length(tlist_vars) + 1,
+											 pstrdup(NameStr(attr->attname)),
+											 false));
+		tlist_dev = lappend(tlist_dev,
+							makeTargetEntry(expr,
+											list_length(tlist_dev) + 1,
+											NULL,
+											false));
+	}
+	table_close(relation, NoLock);
+	if (list_length(tlist_dev) != natts)
+		return NULL;
+
+	/* code generation for the DpuScan */
+	dpath = makeNode(CustomPath);
+	dpath->path.pathtype = T_CustomScan;
+	dpath->path.parent = baserel;
+	dpath->path.pathtarget = baserel->reltarget;
+	dpath->path.parallel_aware = cpath->path.parallel_aware;
+	dpath->path.parallel_safe = cpath->path.parallel_safe;
+	dpath->custom_paths = NIL;
+	dpath->custom_private = list_make1(pp_info);
+	dpath->methods = &dpuscan_path_methods;
+
+	context = create_codegen_context(root, dpath, pp_info);
+	pp_info->kexp_scan_quals = codegen_build_scan_quals(context, pp_info->scan_quals);
+	context->tlist_dev = tlist_dev;
+	pp_info->kexp_projection = codegen_build_projection(context);
+	codegen_build_packed_kvars_load(context, pp_info);
+	codegen_build_packed_kvars_move(context, pp_info);
+	pp_info->kvars_deflist = context->kvars_deflist;
+	pp_info->xpu_task_flags = context->xpu_task_flags;
+	pp_info->extra_bufsz = context->extra_bufsz;
+	pp_info->used_params = context->used_params;
+	pp_info->cuda_stack_size = estimate_cuda_stack_size(context);
+
+	/*
+	 * Build CustomScan(DpuScan) node; it has no host projection
+	 */
+	cscan = makeNode(CustomScan);
+	cscan->scan.plan.startup_cost = pp_info->startup_cost;
+	cscan->scan.plan.total_cost = (pp_info->startup_cost +
+								   pp_info->run_cost +
+								   pp_info->final_cost);
+	cscan->scan.plan.plan_rows = pp_info->scan_nrows;
+	cscan->scan.plan.plan_width = baserel->reltarget->width;
+	cscan->scan.plan.parallel_aware = cpath->path.parallel_aware;
+	cscan->scan.plan.parallel_safe = cpath->path.parallel_safe;
+	cscan->scan.plan.targetlist = tlist_vars;
+	cscan->scan.plan.qual = NIL;
+	cscan->scan.scanrelid = baserel->relid;
+	cscan->flags = 0;
+	cscan->methods = &dpuscan_plan_methods;
+	cscan->custom_plans = NIL;
+	cscan->custom_scan_tlist = assign_custom_cscan_tlist(copyObject(tlist_vars),
+														 pp_info);
+	form_pgstrom_plan_info(cscan, pp_info);
+
+	return &cscan->scan.plan;
+}
+
 /*
  * CreateGpuScanState
  */
@@ -945,17 +1627,31 @@ CreateDpuScanState(CustomScan *cscan)
  */
 bool
 ExecFallbackCpuScan(pgstromTaskState *pts, HeapTuple tuple)
+{
+	ExecForceStoreHeapTuple(tuple, pts->base_slot, false);
+	return ExecFallbackCpuScanSlot(pts);
+}
+
+/*
+ * ExecFallbackCpuScanSlot
+ *
+ * Same as ExecFallbackCpuScan, but the base tuple is already loaded on
+ * pts->base_slot; it allows to skip forming a heap tuple for the columnar
+ * data sources.
+ */
+bool
+ExecFallbackCpuScanSlot(pgstromTaskState *pts)
 {
 	ExprContext	   *econtext = pts->css.ss.ps.ps_ExprContext;
 	TupleTableSlot *base_slot = pts->base_slot;
 	TupleTableSlot *fallback_slot = pts->css.ss.ss_ScanTupleSlot;
+	HeapTuple		tuple;
 	ListCell	   *lc1, *lc2;
 	int				attidx = 0;
 	bool			should_free;
 
 	/* Load the base tuple (depth-0) to the fallback slot */
-	ExecForceStoreHeapTuple(tuple, base_slot, false);
-	slot_getallattrs(base_slot);
+	slot_getsomeattrs(base_slot, pts->fallback_load_natts);
 	ExecStoreAllNullTuple(fallback_slot);
 	forboth (lc1, pts->fallback_load_src,
 			 lc2, pts->fallback_load_dst)
@@ -1041,6 +1737,33 @@ pgstrom_init_gpu_scan(void)
 							 PGC_USERSET,
 							 GUC_NOT_IN_SAMPLE,
 							 NULL, NULL, NULL);
+	/* pg_strom.enable_gputopk */
+	DefineCustomBoolVariable("pg_strom.enable_gputopk",
+							 "Enables the GPU Top-N selection for ORDER BY ... LIMIT",
+							 NULL,
+							 &pgstrom_enable_gputopk,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* pg_strom.enable_gpusort */
+	DefineCustomBoolVariable("pg_strom.enable_gpusort",
+							 "Enables the GPU Sort for the sorted results of GpuScan",
+							 NULL,
+							 &pgstrom_enable_gpusort,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* pg_strom.enable_generated_column_rewrite */
+	DefineCustomBoolVariable("pg_strom.enable_generated_column_rewrite",
+							 "Enables to reference stored generated columns instead of the identical expressions",
+							 NULL,
+							 &pgstrom_enable_generated_column_rewrite,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
 	/* setup path methods */
 	memset(&gpuscan_path_methods, 0, sizeof(gpuscan_path_methods));
 	gpuscan_path_methods.CustomName			= "GpuScan";
@@ -1083,6 +1806,15 @@ pgstrom_init_dpu_scan(void)
 							 PGC_USERSET,
 							 GUC_NOT_IN_SAMPLE,
 							 NULL, NULL, NULL);
+	/* pg_strom.enable_dpu_prefilter */
+	DefineCustomBoolVariable("pg_strom.enable_dpu_prefilter",
+							 "Enables DPU pre-filtering of the outer relation of GPU workloads",
+							 NULL,
+							 &pgstrom_enable_dpu_prefilter,
+							 false,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
 	/* setup path methods */
 	memset(&dpuscan_path_methods, 0, sizeof(dpuscan_path_methods));
 	dpuscan_path_methods.CustomName			= "DpuScan";
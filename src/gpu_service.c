@@ -12,9 +12,27 @@
 #include "pg_strom.h"
 #include "cuda_common.h"
 #include <cudaProfiler.h>
+#ifdef WITH_NVTX
+#include <nvtx3/nvToolsExt.h>
+#include <sys/syscall.h>
+#endif
 /*
- * gpuContext / gpuMemory
+ * gpuContext / gpuWorkerQueue / gpuMemory
  */
+typedef struct
+{
+	pthread_mutex_t	lock;
+	pthread_cond_t	cond;
+	dlist_head		command_list;
+	volatile int	nitems;		/* # of commands in the command_list */
+	volatile bool	owned;		/* true, if a worker is assigned */
+	volatile bool	active;		/* true, if the owner accepts new commands */
+	volatile bool	idle;		/* true, if the owner waits for commands */
+} gpuWorkerQueue;
+
+/* upper limit of pg_strom.max_async_tasks */
+#define GPUSERV_MAX_WORKER_QUEUES	256
+
 typedef struct
 {
 	pthread_mutex_t	lock;
@@ -23,6 +41,14 @@ typedef struct
 	size_t			hard_limit;
 	size_t			keep_limit;
 	dlist_head		segment_list;
+	/* statistics; see gpuservPublishMemoryPoolStats */
+	uint64_t		nr_alloc;	/* # of allocations from the segments */
+	uint64_t		nr_free;	/* # of releases to the segments */
+	uint64_t		maint_count; /* # of maintenance tasks */
+	uint64_t		maint_time_us; /* time consumed by maintenance tasks */
+	uint64_t		last_nr_alloc;	/* nr_alloc at the last publish */
+	uint64_t		last_nr_free;	/* nr_free at the last publish */
+	struct timeval	last_tval;		/* timestamp of the last publish */
 } gpuMemoryPool;
 
 struct gpuContext
@@ -48,19 +74,80 @@ struct gpuContext
 	/* GPU workers */
 	pthread_mutex_t	worker_lock;
 	dlist_head		worker_list;
-	/* XPU commands */
-	pthread_cond_t	cond;
-	pthread_mutex_t	lock;
-	dlist_head		command_list;
+	/* admission control of query buffers (by gpu_query_buffer_mutex) */
+	size_t			qbuf_reserved;
+	/* mask of the peer GPUs connected by NVLink (see __setupGpuPeerDevices) */
+	uint64_t		peer_nvlink_dmask;
+	/* shared scan of Arrow_Fdw chunks (see gpuservLookupSharedScanChunk) */
+	pthread_mutex_t	sscan_lock;
+	dlist_head		sscan_lru_list;
+	size_t			sscan_usage;
+	/* XPU commands (per-worker queues) */
+	pg_atomic_uint64 sched_vclock;	/* virtual clock of fair-share scheduling */
+	pg_atomic_uint32 queue_dispatch_count;	/* round-robin hint of dispatch */
+	volatile int	num_queues;		/* high-water mark of queues[] in use */
+	gpuWorkerQueue	queues[GPUSERV_MAX_WORKER_QUEUES];
 };
 
+/*
+ * gpuGridSizeTuner - see gpuservChooseGridSize()
+ */
+#define GPUSERV_GRID_TUNER_NCANDS		4
+
+typedef struct
+{
+	pthread_mutex_t	lock;
+	uint32_t		nsamples[GPUSERV_GRID_TUNER_NCANDS];
+	double			cost[GPUSERV_GRID_TUNER_NCANDS];	/* msec per 1M rows */
+} gpuGridSizeTuner;
+
+/*
+ * gpuModuleLinkage - linkage to the device functions and types of a module
+ */
+typedef struct
+{
+	CUmodule		cuda_module;
+	HTAB		   *cuda_type_htab;
+	HTAB		   *cuda_func_htab;
+	xpu_encode_info *cuda_encode_catalog;
+} gpuModuleLinkage;
+
+/*
+ * gpuSessionCacheEntry - static portion of the session kept per connection
+ */
+typedef struct
+{
+	uint64_t		key;		/* session_cache_key */
+	uint32_t		offset;		/* session_cache_offset */
+	uint32_t		length;		/* session_cache_length */
+	CUmodule		cuda_module; /* device pointers are resolved for */
+	char		   *image;		/* copy of the static portion */
+} gpuSessionCacheEntry;
+
 struct gpuClient
 {
 	struct gpuContext *gcontext;/* per-device status */
 	dlist_node		chain;		/* gcontext->client_list */
 	kern_session_info *session;	/* per session info (on cuda managed memory) */
 	struct gpuQueryBuffer *gq_buf; /* per query join/preagg device buffer */
+	CUmodule		cuda_module; /* generic or session specialized module */
 	pg_atomic_uint32 refcnt;	/* odd number, if error status */
+	uint64_t		sched_vtag;	/* virtual finish tag of the last command */
+	gpuGridSizeTuner grid_tuner; /* online tuner of the grid size */
+	volatile int	kds_dst_pool_hint; /* # of kds_dst to be pre-reserved */
+	pg_atomic_uint64 gpumem_usage; /* device memory charged to the session */
+	pg_atomic_uint64 limit_nitems_out; /* rows sent back, see limit_nitems */
+	/* static portion of the sessions; see gpuservHandleOpenSession */
+	gpuSessionCacheEntry session_cache[KERN_SESSION_CACHE_NSLOTS];
+	int				session_cache_next;
+	/* result ring buffer shared with the backend, if any */
+	kern_result_ring *h_ring;
+	size_t			ring_mmap_sz;
+	bool			ring_registered; /* pinned by cuMemHostRegister */
+	pthread_mutex_t	ring_lock;
+	uint64_t		ring_head;	/* offset of the next block */
+	uint64_t		ring_tail;	/* offset of the oldest active block */
+	uint64_t		ring_usage;	/* consumption of the ring */
 	pthread_mutex_t	mutex;		/* mutex to write the socket */
 	int				sockfd;		/* connection to PG backend */
 	pthread_t		worker;		/* receiver thread */
@@ -75,6 +162,7 @@ typedef struct
 	gpuContext	   *gcontext;
 	pthread_t		worker;
 	char			kind;	/* one of GPUSERV_WORKER_KIND__* */
+	int				qindex;	/* index of gcontext->queues[], if GPUTASK */
 	volatile bool	termination;
 } gpuWorker;
 
@@ -84,6 +172,48 @@ typedef struct
 //#define __SIGWAKEUP		(__SIGRTMIN + 3)
 #define __SIGWAKEUP		SIGUSR2
 
+
+/*
+ * gpuMemoryPoolStat - snapshot of the memory pool for pgstrom.gpu_mempool_info
+ *
+ * GPU service updates it periodically, and backends read it. The reader
+ * retries if changecount is odd or changed during the copy.
+ */
+typedef struct
+{
+	volatile uint32_t changecount;
+	int32_t		num_segments;
+	int32_t		num_free_chunks;
+	int64_t		total_sz;
+	int64_t		active_sz;
+	int64_t		largest_free;
+	int64_t		hard_limit;
+	int64_t		keep_limit;
+	int64_t		nr_alloc;
+	int64_t		nr_free;
+	double		alloc_rate;		/* per second, at the last interval */
+	double		free_rate;		/* per second, at the last interval */
+	int64_t		maint_count;
+	int64_t		maint_time_us;
+} gpuMemoryPoolStat;
+
+/*
+ * gpuServDeviceStat - cumulative statistics of GPU tasks per device
+ */
+typedef struct
+{
+	pg_atomic_uint64	nr_tasks_scan;
+	pg_atomic_uint64	nr_tasks_join;
+	pg_atomic_uint64	nr_tasks_preagg;
+	pg_atomic_uint64	nr_suspend_resume;
+	pg_atomic_uint64	nr_cpu_fallback;
+	pg_atomic_uint64	nr_errors;
+	pg_atomic_uint64	npages_direct_read;
+	pg_atomic_uint64	npages_vfs_read;
+	pg_atomic_uint64	queue_wait_us;
+	pg_atomic_uint64	kernel_time_us;
+} gpuServDeviceStat;
+
 typedef struct
 {
 	volatile pid_t		gpuserv_pid;
@@ -91,8 +221,20 @@ typedef struct
 	pg_atomic_uint32	max_async_tasks_updated;
 	pg_atomic_uint32	max_async_tasks;
 	pg_atomic_uint32	gpuserv_debug_output;
+	/* device/managed pool for each GPU */
+	gpuMemoryPoolStat	mempool_stats[FLEXIBLE_ARRAY_MEMBER];
 } gpuServSharedState;
 
+#define GPUSERV_DEVICE_STATS_OFFSET							\
+	MAXALIGN(offsetof(gpuServSharedState, mempool_stats[2 * numGpuDevAttrs]))
+#define GPUSERV_SHARED_STATE_LENGTH							\
+	(GPUSERV_DEVICE_STATS_OFFSET +							\
+	 MAXALIGN(sizeof(gpuServDeviceStat) * numGpuDevAttrs))
+/* gpuServDeviceStat of the GPU device (dindex) */
+#define GPUSERV_DEVICE_STAT(dindex)							\
+	((gpuServDeviceStat *)((char *)gpuserv_shared_state +	\
+						   GPUSERV_DEVICE_STATS_OFFSET) + (dindex))
+
 /*
  * variables
  */
@@ -101,6 +243,11 @@ static __thread CUdevice	MY_DEVICE_PER_THREAD = -1;
 static __thread CUcontext	MY_CONTEXT_PER_THREAD = NULL;
 static __thread CUstream	MY_STREAM_PER_THREAD = NULL;
 static __thread CUevent		MY_EVENT_PER_THREAD = NULL;
+static __thread CUevent		MY_TIMER_EVENT_PER_THREAD = NULL;
+static __thread CUstream	MY_COPY_STREAM_PER_THREAD = NULL;
+static __thread CUevent		MY_COPY_EVENT_PER_THREAD = NULL;
+static __thread gpuWorker  *MY_WORKER_PER_THREAD = NULL;
+static __thread gpuClient  *MY_CLIENT_PER_THREAD = NULL;
 static __thread gpuContext *GpuWorkerCurrentContext = NULL;
 static volatile int	gpuserv_bgworker_got_signal = 0;
 static dlist_head	gpuserv_gpucontext_list;
@@ -116,6 +263,7 @@ static int			__pgstrom_cuda_stack_limit_kb;
 static bool			__gpuserv_debug_output_dummy;
 static char		   *pgstrom_cuda_toolkit_basedir = CUDA_TOOLKIT_BASEDIR; /* GUC */
 static const char  *pgstrom_fatbin_image_filename = "/dev/null";
+static const char  *pgstrom_fatbin_image_basename = NULL;
 
 
 static void
@@ -539,6 +687,75 @@ __setup_gpu_fatbin_filename(void)
 					cuda_version, hexsum);
 }
 
+/*
+ * __read_gpu_fatbin_archs_cache / __write_gpu_fatbin_archs_cache
+ *
+ * The list of SM architectures in the fatbin (by cuobjdump) is cached at
+ * PGSTROM_FATBIN_DIR with the size and mtime of the fatbin file, because
+ * cuobjdump on the large fatbin takes a few seconds for each startup.
+ * The fatbin filename already contains the hash of the source files.
+ */
+static bool
+__read_gpu_fatbin_archs_cache(const char *fatbin_file,
+							  const struct stat *fatbin_st,
+							  StringInfo buf)
+{
+	char		path[MAXPGPATH];
+	char		linebuf[1024];
+	FILE	   *filp;
+	size_t		st_size;
+	long		st_mtime;
+	bool		retval = false;
+
+	snprintf(path, sizeof(path), "%s/%s.archs",
+			 PGSTROM_FATBIN_DIR, fatbin_file);
+	filp = fopen(path, "r");
+	if (!filp)
+		return false;
+	if (fgets(linebuf, sizeof(linebuf), filp) &&
+		sscanf(linebuf, "%zu %ld", &st_size, &st_mtime) == 2 &&
+		st_size == fatbin_st->st_size &&
+		st_mtime == fatbin_st->st_mtime)
+	{
+		while (fgets(linebuf, sizeof(linebuf), filp))
+			appendStringInfoString(buf, linebuf);
+		retval = true;
+	}
+	fclose(filp);
+	return retval;
+}
+
+static void
+__write_gpu_fatbin_archs_cache(const char *fatbin_file,
+							   const struct stat *fatbin_st,
+							   StringInfo buf)
+{
+	char		path[MAXPGPATH];
+	char		temp[MAXPGPATH];
+	FILE	   *filp;
+
+	if (mkdir(PGSTROM_FATBIN_DIR, 0755) != 0 && errno != EEXIST)
+		return;
+	snprintf(path, sizeof(path), "%s/%s.archs",
+			 PGSTROM_FATBIN_DIR, fatbin_file);
+	snprintf(temp, sizeof(temp), "%s.%u", path, (uint32)getpid());
+	filp = fopen(temp, "w");
+	if (!filp)
+	{
+		elog(LOG, "unable to open '%s': %m", temp);
+		return;
+	}
+	fprintf(filp, "%zu %ld\n%s",
+			(size_t)fatbin_st->st_size,
+			(long)fatbin_st->st_mtime,
+			buf->data);
+	if (fclose(filp) != 0 || rename(temp, path) != 0)
+	{
+		elog(LOG, "unable to write '%s': %m", path);
+		unlink(temp);
+	}
+}
+
 /*
  * __validate_gpu_fatbin_file
  */
@@ -549,14 +766,19 @@ __validate_gpu_fatbin_file(const char *fatbin_dir, const char *fatbin_file)
 	StringInfoData buf;
 	FILE	   *filp;
 	char	   *temp;
+	char	   *fatbin_path;
+	struct stat	fatbin_st;
 	bool		retval = false;
 
 	initStringInfo(&cmd);
 	initStringInfo(&buf);
 
-	appendStringInfo(&buf, "%s/%s", fatbin_dir, fatbin_file);
-	if (access(buf.data, R_OK) != 0)
+	fatbin_path = psprintf("%s/%s", fatbin_dir, fatbin_file);
+	if (access(fatbin_path, R_OK) != 0 ||
+		stat(fatbin_path, &fatbin_st) != 0)
 		return false;
+	if (__read_gpu_fatbin_archs_cache(fatbin_file, &fatbin_st, &buf))
+		goto check;
 	/* Pick up supported SM from the fatbin file */
 	appendStringInfo(&cmd,
 					 "%s/bin/cuobjdump '%s/%s'"
@@ -600,7 +822,9 @@ __validate_gpu_fatbin_file(const char *fatbin_dir, const char *fatbin_file)
 		}
 	}
 	ClosePipeStream(filp);
-
+	buf.data[buf.len] = '\0';
+	__write_gpu_fatbin_archs_cache(fatbin_file, &fatbin_st, &buf);
+check:
 	temp = alloca(buf.len + 1);
 	for (int i=0; i < numGpuDevAttrs; i++)
 	{
@@ -631,6 +855,7 @@ __validate_gpu_fatbin_file(const char *fatbin_dir, const char *fatbin_file)
 	/* ok, this fatbin is validated */
 	retval = true;
 out:
+	pfree(fatbin_path);
 	pfree(cmd.data);
 	pfree(buf.data);
 	return retval;
@@ -759,6 +984,11 @@ gpuservSetupFatbin(void)
 	pgstrom_fatbin_image_filename = strdup(path);
 	if (!pgstrom_fatbin_image_filename)
 		elog(ERROR, "out of memory");
+	/* also used for the session specialized modules */
+	pgstrom_fatbin_image_basename = strndup(fatbin_file,
+											strlen(fatbin_file) - strlen(".fatbin"));
+	if (!pgstrom_fatbin_image_basename)
+		elog(ERROR, "out of memory");
 	elog(LOG, "PG-Strom fatbin image is ready: %s", fatbin_file);
 }
 
@@ -794,8 +1024,34 @@ typedef struct
 	size_t		__offset;	/* offset from the base */
 	size_t		__length;	/* length of the chunk */
 	CUdeviceptr	m_devptr;	/* __base + __offset */
+	int			slab_class;	/* size-class + 1, if slab chunk */
+	struct gpuClient *owner; /* session charged for, if any */
 } gpuMemChunk;
 
+/*
+ * gpuMemSlabCache - per-thread cache of the small chunks
+ *
+ * Small chunks (like kern_gputask) are allocated and released very
+ * frequently. The worker thread keeps the released chunks by size-class,
+ * then reuses them without pool->lock. The cached chunks are still active
+ * from the standpoint of the segment, so the cache size is limited and
+ * flushed on idle.
+ */
+#define GPUMEM_SLAB_MIN_SHIFT		12		/* 4kB */
+#define GPUMEM_SLAB_MAX_SHIFT		18		/* 256kB */
+#define GPUMEM_SLAB_NCLASSES		(GPUMEM_SLAB_MAX_SHIFT - GPUMEM_SLAB_MIN_SHIFT + 1)
+#define GPUMEM_SLAB_CACHE_LIMIT		(4UL << 20)	/* per class, pool and thread */
+
+typedef struct
+{
+	gpuMemoryPool  *pool;
+	uint32_t		nitems[GPUMEM_SLAB_NCLASSES];
+	dlist_head		free_list[GPUMEM_SLAB_NCLASSES];
+} gpuMemSlabCache;
+
+static __thread bool			MY_SLAB_CACHE_ENABLED = false;
+static __thread gpuMemSlabCache	MY_SLAB_CACHE_PER_THREAD[2];	/* raw/managed */
+
 static gpuMemChunk *
 __gpuMemAllocFromSegment(gpuMemoryPool *pool,
 						 gpuMemorySegment *mseg,
@@ -930,7 +1186,10 @@ __gpuMemAllocCommon(gpuMemoryPool *pool, size_t bytesize)
 		{
 			chunk = __gpuMemAllocFromSegment(pool, mseg, bytesize);
 			if (chunk)
+			{
+				pool->nr_alloc++;
 				goto out_unlock;
+			}
 		}
 	}
 	segment_sz = ((size_t)pgstrom_gpu_mempool_segment_sz_kb << 10);
@@ -947,6 +1206,8 @@ __gpuMemAllocCommon(gpuMemoryPool *pool, size_t bytesize)
 
 		if (mseg)
 			chunk = __gpuMemAllocFromSegment(pool, mseg, bytesize);
+		if (chunk)
+			pool->nr_alloc++;
 	}
 out_unlock:	
 	pthreadMutexUnlock(&pool->lock);
@@ -954,20 +1215,91 @@ out_unlock:
 	return (chunk ? chunk : NULL);
 }
 
+static inline int
+__gpuMemSlabClass(size_t bytesize)
+{
+	int		shift = GPUMEM_SLAB_MIN_SHIFT;
+
+	if (bytesize > (1UL << GPUMEM_SLAB_MAX_SHIFT))
+		return -1;
+	while ((1UL << shift) < bytesize)
+		shift++;
+	return shift - GPUMEM_SLAB_MIN_SHIFT;
+}
+
+static gpuMemChunk *
+__gpuMemAllocSlab(gpuMemoryPool *pool, size_t bytesize)
+{
+	gpuMemSlabCache *slab = &MY_SLAB_CACHE_PER_THREAD[pool->is_managed ? 1 : 0];
+	gpuMemChunk *chunk;
+	int			sclass;
+
+	if (!MY_SLAB_CACHE_ENABLED || (sclass = __gpuMemSlabClass(bytesize)) < 0)
+		return __gpuMemAllocCommon(pool, bytesize);
+	if (slab->pool == pool && slab->nitems[sclass] > 0)
+	{
+		dlist_node *dnode = dlist_pop_head_node(&slab->free_list[sclass]);
+
+		chunk = dlist_container(gpuMemChunk, free_chain, dnode);
+		memset(&chunk->free_chain, 0, sizeof(dlist_node));
+		slab->nitems[sclass]--;
+		return chunk;
+	}
+	chunk = __gpuMemAllocCommon(pool, 1UL << (sclass + GPUMEM_SLAB_MIN_SHIFT));
+	if (chunk)
+		chunk->slab_class = sclass + 1;
+	return chunk;
+}
+
+static size_t	__gpuClientQueryBufferUsage(gpuClient *gclient);
+
+/*
+ * __gpuMemAllocCharged
+ *
+ * It charges the chunk to the session currently processed by the worker
+ * thread, if it has device memory budget (session->gpumem_limit_mb).
+ * Allocation beyond the budget fails, as if device memory ran out.
+ */
+static gpuMemChunk *
+__gpuMemAllocCharged(gpuMemoryPool *pool, size_t bytesize)
+{
+	gpuClient  *gclient = MY_CLIENT_PER_THREAD;
+	gpuMemChunk *chunk;
+	uint64_t	limit;
+	uint64_t	usage;
+
+	chunk = __gpuMemAllocSlab(pool, bytesize);
+	if (!chunk || !gclient || !gclient->session ||
+		gclient->session->gpumem_limit_mb == 0)
+		return chunk;
+	limit = ((uint64_t)gclient->session->gpumem_limit_mb << 20);
+	usage = pg_atomic_add_fetch_u64(&gclient->gpumem_usage, chunk->__length);
+	if (usage + __gpuClientQueryBufferUsage(gclient) > limit)
+	{
+		pg_atomic_sub_fetch_u64(&gclient->gpumem_usage, chunk->__length);
+		__gsDebug("GPU memory budget of the session (%uMB) exceeded",
+				  gclient->session->gpumem_limit_mb);
+		gpuMemFree(chunk);
+		return NULL;
+	}
+	chunk->owner = gclient;
+	return chunk;
+}
+
 static gpuMemChunk *
 gpuMemAlloc(size_t bytesize)
 {
-	return __gpuMemAllocCommon(&GpuWorkerCurrentContext->pool_raw, bytesize);
+	return __gpuMemAllocCharged(&GpuWorkerCurrentContext->pool_raw, bytesize);
 }
 
 static gpuMemChunk *
 gpuMemAllocManaged(size_t bytesize)
 {
-	return __gpuMemAllocCommon(&GpuWorkerCurrentContext->pool_managed, bytesize);
+	return __gpuMemAllocCharged(&GpuWorkerCurrentContext->pool_managed, bytesize);
 }
 
 static void
-gpuMemFree(gpuMemChunk *chunk)
+__gpuMemFreeCommon(gpuMemChunk *chunk)
 {
 	gpuMemoryPool  *pool;
 	gpuMemorySegment *mseg;
@@ -979,6 +1311,8 @@ gpuMemFree(gpuMemChunk *chunk)
 	pool = mseg->pool;
 
 	pthreadMutexLock(&pool->lock);
+	pool->nr_free++;
+	chunk->slab_class = 0;
 	/* revert this chunk state to 'free' */
 	mseg->active_sz -= chunk->__length;
 	dlist_push_head(&mseg->free_chunks,
@@ -1027,6 +1361,110 @@ gpuMemFree(gpuMemChunk *chunk)
 	pthreadMutexUnlock(&pool->lock);
 }
 
+static void
+gpuMemFree(gpuMemChunk *chunk)
+{
+	gpuMemoryPool  *pool = chunk->mseg->pool;
+	gpuMemSlabCache *slab = &MY_SLAB_CACHE_PER_THREAD[pool->is_managed ? 1 : 0];
+	int			sclass = chunk->slab_class - 1;
+
+	Assert(!chunk->free_chain.prev && !chunk->free_chain.next);
+	if (chunk->owner)
+	{
+		pg_atomic_sub_fetch_u64(&chunk->owner->gpumem_usage, chunk->__length);
+		chunk->owner = NULL;
+	}
+	/*
+	 * The caller may adjust m_devptr for alignment of the direct read
+	 * (see __gpuservLoadKdsCommon); it has to be reverted before the
+	 * chunk is reused from the slab cache, or merged with the buddies.
+	 */
+	chunk->m_devptr = chunk->__base + chunk->__offset;
+	if (MY_SLAB_CACHE_ENABLED && sclass >= 0 &&
+		(slab->pool == pool || slab->pool == NULL) &&
+		((size_t)(slab->nitems[sclass] + 1) << (sclass + GPUMEM_SLAB_MIN_SHIFT)) <= GPUMEM_SLAB_CACHE_LIMIT)
+	{
+		slab->pool = pool;
+		dlist_push_head(&slab->free_list[sclass], &chunk->free_chain);
+		slab->nitems[sclass]++;
+		return;
+	}
+	__gpuMemFreeCommon(chunk);
+}
+
+/*
+ * gpuMemSlabFlush - release the chunks kept in the per-thread cache
+ */
+static void
+gpuMemSlabFlush(void)
+{
+	for (int k=0; k < lengthof(MY_SLAB_CACHE_PER_THREAD); k++)
+	{
+		gpuMemSlabCache *slab = &MY_SLAB_CACHE_PER_THREAD[k];
+
+		for (int i=0; i < GPUMEM_SLAB_NCLASSES; i++)
+		{
+			while (slab->nitems[i] > 0)
+			{
+				dlist_node *dnode = dlist_pop_head_node(&slab->free_list[i]);
+				gpuMemChunk *chunk = dlist_container(gpuMemChunk, free_chain, dnode);
+
+				memset(&chunk->free_chain, 0, sizeof(dlist_node));
+				slab->nitems[i]--;
+				__gpuMemFreeCommon(chunk);
+			}
+		}
+		slab->pool = NULL;
+	}
+}
+
+#ifdef WITH_NVTX
+/*
+ * NVTX instrumentation
+ *
+ * When PG-Strom is built with WITH_NVTX=1, the GPU service marks the phases
+ * of GPU tasks, GpuCache maintenance and memory pool maintenance using
+ * NVTX ranges, so Nsight Systems timelines can be correlated with the
+ * PostgreSQL queries. NVTX calls are almost no-op unless the profiler
+ * is attached.
+ */
+void
+pgstromNvtxRangeStart(uint64_t *p_range, const char *fmt, ...)
+{
+	char		label[200];
+	va_list		ap;
+
+	if (*p_range != 0)
+		nvtxRangeEnd(*p_range);
+	va_start(ap, fmt);
+	vsnprintf(label, sizeof(label), fmt, ap);
+	va_end(ap);
+	*p_range = nvtxRangeStartA(label);
+}
+
+void
+pgstromNvtxRangeEnd(uint64_t *p_range)
+{
+	if (*p_range != 0)
+	{
+		nvtxRangeEnd(*p_range);
+		*p_range = 0;
+	}
+}
+
+void
+pgstromNvtxNameThread(const char *fmt, ...)
+{
+	char		label[200];
+	va_list		ap;
+
+	va_start(ap, fmt);
+	vsnprintf(label, sizeof(label), fmt, ap);
+	va_end(ap);
+	nvtxNameOsThreadA((uint32_t)syscall(SYS_gettid), label);
+}
+#endif	/* WITH_NVTX */
+
 /*
  * gpuMemoryPoolMaintenance
  */
@@ -1035,11 +1473,17 @@ __gpuMemoryPoolMaintenanceTask(gpuContext *gcontext, gpuMemoryPool *pool)
 {
 	dlist_iter		iter;
 	struct timeval	tval;
+	struct timeval	tv_start;
 	int64			tdiff;
+	uint64_t		nvtx_range = 0;
 	CUresult		rc;
 
 	if (!pthreadMutexTryLock(&pool->lock))
 		return;
+	pgstromNvtxRangeStart(&nvtx_range, "GPU-%d %s pool maintenance",
+						  gcontext->cuda_dindex,
+						  pool->is_managed ? "managed" : "device");
+	gettimeofday(&tv_start, NULL);
 	if (pool->total_sz > pool->keep_limit)
 	{
 		gettimeofday(&tval, NULL);
@@ -1083,6 +1527,11 @@ __gpuMemoryPoolMaintenanceTask(gpuContext *gcontext, gpuMemoryPool *pool)
 			break;
 		}
 	}
+	gettimeofday(&tval, NULL);
+	pool->maint_count++;
+	pool->maint_time_us += ((tval.tv_sec  - tv_start.tv_sec) * 1000000L +
+							(tval.tv_usec - tv_start.tv_usec));
+	pgstromNvtxRangeEnd(&nvtx_range);
 	pthreadMutexUnlock(&pool->lock);
 }
 
@@ -1105,6 +1554,311 @@ gpuMemoryPoolInit(gpuMemoryPool *pool,
 	pool->hard_limit = pgstrom_gpu_mempool_max_ratio * (double)dev_total_memsz;
 	pool->keep_limit = pgstrom_gpu_mempool_min_ratio * (double)dev_total_memsz;
 	dlist_init(&pool->segment_list);
+	gettimeofday(&pool->last_tval, NULL);
+}
+
+/*
+ * gpuservPublishMemoryPoolStats
+ *
+ * It writes out the snapshot of memory pools to the shared memory.
+ * Only the GPU service main thread calls this function.
+ */
+static void
+__gpuMemoryPoolPublishStats(gpuMemoryPool *pool, gpuMemoryPoolStat *stat)
+{
+	dlist_iter	iter;
+	dlist_iter	__iter;
+	struct timeval tval;
+	gpuMemoryPoolStat temp;
+	double		elapsed;
+
+	memset(&temp, 0, sizeof(gpuMemoryPoolStat));
+	pthreadMutexLock(&pool->lock);
+	dlist_foreach(iter, &pool->segment_list)
+	{
+		gpuMemorySegment *mseg = dlist_container(gpuMemorySegment,
+												 chain, iter.cur);
+		temp.num_segments++;
+		temp.active_sz += mseg->active_sz;
+		dlist_foreach(__iter, &mseg->free_chunks)
+		{
+			gpuMemChunk *chunk = dlist_container(gpuMemChunk,
+												 free_chain, __iter.cur);
+			temp.num_free_chunks++;
+			temp.largest_free = Max(temp.largest_free, chunk->__length);
+		}
+	}
+	temp.total_sz      = pool->total_sz;
+	temp.hard_limit    = pool->hard_limit;
+	temp.keep_limit    = pool->keep_limit;
+	temp.nr_alloc      = pool->nr_alloc;
+	temp.nr_free       = pool->nr_free;
+	temp.maint_count   = pool->maint_count;
+	temp.maint_time_us = pool->maint_time_us;
+	pthreadMutexUnlock(&pool->lock);
+
+	gettimeofday(&tval, NULL);
+	elapsed = ((double)(tval.tv_sec  - pool->last_tval.tv_sec) +
+			   (double)(tval.tv_usec - pool->last_tval.tv_usec) / 1000000.0);
+	if (elapsed > 0.0)
+	{
+		temp.alloc_rate = (double)(temp.nr_alloc - pool->last_nr_alloc) / elapsed;
+		temp.free_rate  = (double)(temp.nr_free  - pool->last_nr_free) / elapsed;
+	}
+	pool->last_nr_alloc = temp.nr_alloc;
+	pool->last_nr_free  = temp.nr_free;
+	pool->last_tval     = tval;
+
+	temp.changecount = stat->changecount + 1;
+	stat->changecount = temp.changecount;	/* odd, during update */
+	pg_write_barrier();
+	memcpy((char *)stat + sizeof(uint32_t),
+		   (char *)&temp + sizeof(uint32_t),
+		   sizeof(gpuMemoryPoolStat) - sizeof(uint32_t));
+	pg_write_barrier();
+	stat->changecount = temp.changecount + 1;
+}
+
+static void
+gpuservPublishMemoryPoolStats(void)
+{
+	static struct timeval tv_last = {0,0};
+	struct timeval	tval;
+	dlist_iter		iter;
+
+	/* not more than once per second */
+	gettimeofday(&tval, NULL);
+	if (tval.tv_sec == tv_last.tv_sec)
+		return;
+	tv_last = tval;
+
+	dlist_foreach(iter, &gpuserv_gpucontext_list)
+	{
+		gpuContext *gcontext = dlist_container(gpuContext, chain, iter.cur);
+		gpuMemoryPoolStat *stats = &gpuserv_shared_state->mempool_stats[2 * gcontext->cuda_dindex];
+
+		__gpuMemoryPoolPublishStats(&gcontext->pool_raw,     &stats[0]);
+		__gpuMemoryPoolPublishStats(&gcontext->pool_managed, &stats[1]);
+	}
+}
+
+/*
+ * pgstrom_gpu_mempool_info - SQL function to dump memory pool statistics
+ */
+PG_FUNCTION_INFO_V1(pgstrom_gpu_mempool_info);
+PUBLIC_FUNCTION(Datum)
+pgstrom_gpu_mempool_info(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *fncxt;
+	gpuMemoryPoolStat *stat;
+	gpuMemoryPoolStat temp;
+	int			dindex;
+	int			pindex;
+	Datum		values[15];
+	bool		isnull[15];
+	HeapTuple	tuple;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		TupleDesc		tupdesc;
+		MemoryContext	oldcxt;
+
+		fncxt = SRF_FIRSTCALL_INIT();
+		oldcxt = MemoryContextSwitchTo(fncxt->multi_call_memory_ctx);
+
+		tupdesc = CreateTemplateTupleDesc(15);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  1, "gpu_id",
+						   INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  2, "pool",
+						   TEXTOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  3, "num_segments",
+						   INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  4, "total_sz",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  5, "active_sz",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  6, "free_sz",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  7, "largest_free",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  8, "num_free_chunks",
+						   INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  9, "hard_limit",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 10, "keep_limit",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 11, "nr_alloc",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 12, "nr_free",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 13, "alloc_rate",
+						   FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 14, "free_rate",
+						   FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 15, "maint_time",
+						   FLOAT8OID, -1, 0);
+		fncxt->tuple_desc = BlessTupleDesc(tupdesc);
+
+		fncxt->user_fctx = 0;
+
+		MemoryContextSwitchTo(oldcxt);
+	}
+	fncxt = SRF_PERCALL_SETUP();
+
+	dindex = fncxt->call_cntr / 2;
+	pindex = fncxt->call_cntr % 2;
+	if (!gpuserv_shared_state || dindex >= numGpuDevAttrs)
+		SRF_RETURN_DONE(fncxt);
+	stat = &gpuserv_shared_state->mempool_stats[2 * dindex + pindex];
+	for (;;)
+	{
+		uint32_t	before = stat->changecount;
+
+		pg_read_barrier();
+		memcpy(&temp, stat, sizeof(gpuMemoryPoolStat));
+		pg_read_barrier();
+		if ((before & 1) == 0 && before == stat->changecount)
+			break;
+		CHECK_FOR_INTERRUPTS();
+		pg_usleep(1000L);
+	}
+	memset(isnull, 0, sizeof(isnull));
+	values[0]  = Int32GetDatum(dindex);
+	values[1]  = CStringGetTextDatum(pindex == 0 ? "device" : "managed");
+	values[2]  = Int32GetDatum(temp.num_segments);
+	values[3]  = Int64GetDatum(temp.total_sz);
+	values[4]  = Int64GetDatum(temp.active_sz);
+	values[5]  = Int64GetDatum(temp.total_sz - temp.active_sz);
+	values[6]  = Int64GetDatum(temp.largest_free);
+	values[7]  = Int32GetDatum(temp.num_free_chunks);
+	values[8]  = Int64GetDatum(temp.hard_limit);
+	values[9]  = Int64GetDatum(temp.keep_limit);
+	values[10] = Int64GetDatum(temp.nr_alloc);
+	values[11] = Int64GetDatum(temp.nr_free);
+	values[12] = Float8GetDatum(temp.alloc_rate);
+	values[13] = Float8GetDatum(temp.free_rate);
+	/* average time per maintenance task in msec */
+	if (temp.maint_count > 0)
+		values[14] = Float8GetDatum((double)temp.maint_time_us /
+									(1000.0 * (double)temp.maint_count));
+	else
+		isnull[14] = true;
+
+	tuple = heap_form_tuple(fncxt->tuple_desc, values, isnull);
+
+	SRF_RETURN_NEXT(fncxt, HeapTupleGetDatum(tuple));
+}
+
+/*
+ * gpuservUpdateDeviceStat - accumulates the statistics of a GPU task
+ */
+static void
+gpuservUpdateDeviceStat(gpuClient *gclient,
+						uint64_t ts_enqueue,
+						uint64_t ts_dequeue,
+						uint64_t ts_io_done,
+						uint64_t ts_kernel_done,
+						uint32_t npages_direct_read,
+						uint32_t npages_vfs_read,
+						uint32_t nr_suspend_resume)
+{
+	gpuServDeviceStat *dstat = GPUSERV_DEVICE_STAT(gclient->gcontext->cuda_dindex);
+	uint32_t	task_kind = gclient->session->xpu_task_flags;
+
+	if ((task_kind & DEVTASK__PREAGG) != 0)
+		pg_atomic_fetch_add_u64(&dstat->nr_tasks_preagg, 1);
+	else if ((task_kind & DEVTASK__JOIN) != 0)
+		pg_atomic_fetch_add_u64(&dstat->nr_tasks_join, 1);
+	else
+		pg_atomic_fetch_add_u64(&dstat->nr_tasks_scan, 1);
+	if (nr_suspend_resume > 0)
+		pg_atomic_fetch_add_u64(&dstat->nr_suspend_resume, nr_suspend_resume);
+	if (npages_direct_read > 0)
+		pg_atomic_fetch_add_u64(&dstat->npages_direct_read, npages_direct_read);
+	if (npages_vfs_read > 0)
+		pg_atomic_fetch_add_u64(&dstat->npages_vfs_read, npages_vfs_read);
+	if (ts_enqueue > 0 && ts_dequeue > ts_enqueue)
+		pg_atomic_fetch_add_u64(&dstat->queue_wait_us, ts_dequeue - ts_enqueue);
+	if (ts_io_done > 0 && ts_kernel_done > ts_io_done)
+		pg_atomic_fetch_add_u64(&dstat->kernel_time_us, ts_kernel_done - ts_io_done);
+}
+
+/*
+ * pgstrom_gpu_service_stats - SQL function to dump cumulative statistics
+ * of GPU tasks for each device
+ */
+PG_FUNCTION_INFO_V1(pgstrom_gpu_service_stats);
+PUBLIC_FUNCTION(Datum)
+pgstrom_gpu_service_stats(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *fncxt;
+	gpuServDeviceStat *dstat;
+	int			dindex;
+	Datum		values[11];
+	bool		isnull[11];
+	HeapTuple	tuple;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		TupleDesc		tupdesc;
+		MemoryContext	oldcxt;
+
+		fncxt = SRF_FIRSTCALL_INIT();
+		oldcxt = MemoryContextSwitchTo(fncxt->multi_call_memory_ctx);
+
+		tupdesc = CreateTemplateTupleDesc(11);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  1, "gpu_id",
+						   INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  2, "nr_tasks_scan",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  3, "nr_tasks_join",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  4, "nr_tasks_preagg",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  5, "nr_suspend_resume",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  6, "nr_cpu_fallback",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  7, "nr_errors",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  8, "direct_read_sz",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber)  9, "vfs_read_sz",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 10, "queue_wait_time",
+						   FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 11, "kernel_time",
+						   FLOAT8OID, -1, 0);
+		fncxt->tuple_desc = BlessTupleDesc(tupdesc);
+
+		fncxt->user_fctx = 0;
+
+		MemoryContextSwitchTo(oldcxt);
+	}
+	fncxt = SRF_PERCALL_SETUP();
+
+	dindex = fncxt->call_cntr;
+	if (!gpuserv_shared_state || dindex >= numGpuDevAttrs)
+		SRF_RETURN_DONE(fncxt);
+	dstat = GPUSERV_DEVICE_STAT(dindex);
+
+	memset(isnull, 0, sizeof(isnull));
+	values[0]  = Int32GetDatum(dindex);
+	values[1]  = Int64GetDatum(pg_atomic_read_u64(&dstat->nr_tasks_scan));
+	values[2]  = Int64GetDatum(pg_atomic_read_u64(&dstat->nr_tasks_join));
+	values[3]  = Int64GetDatum(pg_atomic_read_u64(&dstat->nr_tasks_preagg));
+	values[4]  = Int64GetDatum(pg_atomic_read_u64(&dstat->nr_suspend_resume));
+	values[5]  = Int64GetDatum(pg_atomic_read_u64(&dstat->nr_cpu_fallback));
+	values[6]  = Int64GetDatum(pg_atomic_read_u64(&dstat->nr_errors));
+	values[7]  = Int64GetDatum(pg_atomic_read_u64(&dstat->npages_direct_read) * PAGE_SIZE);
+	values[8]  = Int64GetDatum(pg_atomic_read_u64(&dstat->npages_vfs_read) * PAGE_SIZE);
+	/* cumulative time in msec */
+	values[9]  = Float8GetDatum((double)pg_atomic_read_u64(&dstat->queue_wait_us) / 1000.0);
+	values[10] = Float8GetDatum((double)pg_atomic_read_u64(&dstat->kernel_time_us) / 1000.0);
+
+	tuple = heap_form_tuple(fncxt->tuple_desc, values, isnull);
+
+	SRF_RETURN_NEXT(fncxt, HeapTupleGetDatum(tuple));
 }
 
 /* ----------------------------------------------------------------
@@ -1125,11 +1879,21 @@ struct gpuQueryBuffer
 									 * -1: error, during buffer setup */
 	uint64_t		buffer_id;		/* unique buffer id */
 	int				cuda_dindex;	/* GPU device identifier */
+	struct gpuContext *gcontext;	/* GPU device context */
+	size_t			reserved_sz;	/* admitted size of the buffers */
 	CUdeviceptr		m_kmrels;		/* GpuJoin inner buffer (device) */
 	void		   *h_kmrels;		/* GpuJoin inner buffer (host) */
 	size_t			kmrels_sz;		/* GpuJoin inner buffer size */
+	struct gpuSharedInnerBuffer *shared_inner; /* owner of m_kmrels/h_kmrels,
+												* if shared with other queries */
+	bool			kmrels_shared;	/* m_kmrels is loaded by other query */
+	bool			kmrels_cached;	/* m_kmrels is revived from the idle one */
+	bool			kmrels_peer;	/* m_kmrels is owned by the peer GPU */
+	bool			kmrels_host_mapped; /* m_kmrels is device pointer of the
+										 * h_kmrels registered to CUDA */
 	CUdeviceptr		m_kds_final;	/* GpuPreAgg final buffer (device) */
 	size_t			m_kds_final_length;	/* length of GpuPreAgg final buffer */
+	uint32_t		m_kds_final_nspills;	/* number of spills of the final buffer */
 	pthread_rwlock_t m_kds_final_rwlock;  /* RWLock for the final buffer */
 };
 typedef struct gpuQueryBuffer		gpuQueryBuffer;
@@ -1138,33 +1902,167 @@ typedef struct gpuQueryBuffer		gpuQueryBuffer;
 static dlist_head		gpu_query_buffer_hslot[GPU_QUERY_BUFFER_NSLOTS];
 static pthread_mutex_t	gpu_query_buffer_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t	gpu_query_buffer_cond = PTHREAD_COND_INITIALIZER;
+static double			pgstrom_gpu_admission_ratio;	/* GUC */
+static int				pgstrom_gpu_admission_timeout;	/* GUC */
+
+/*
+ * gpuSharedInnerBuffer
+ *
+ * GpuJoin inner buffer (kern_multirels) can be shared by multiple queries
+ * on the same device, if its contents are identical; e.g, concurrent
+ * star-joins towards the same dimension tables. Identical contents are
+ * the only reliable condition regardless of the snapshot of the queries,
+ * so a candidate found by content_key is verified by memcmp().
+ * Inner buffers with outer-join-map are never shared, because GPU kernel
+ * updates them.
+ */
+struct gpuSharedInnerBuffer
+{
+	dlist_node		chain;		/* gpu_shared_inner_list */
+	int				refcnt;
+	struct gpuContext *gcontext;
+	uint64_t		content_key;
+	CUdeviceptr		m_kmrels;
+	void		   *h_kmrels;
+	size_t			kmrels_sz;
+	size_t			reserved_sz; /* admitted size of the buffer */
+};
+typedef struct gpuSharedInnerBuffer	gpuSharedInnerBuffer;
+
+static dlist_head		gpu_shared_inner_list = DLIST_STATIC_INIT(gpu_shared_inner_list);
+static size_t			gpu_shared_inner_idle_sz = 0;
+static bool				pgstrom_gpu_shared_inner_buffer;	/* GUC */
+static int				pgstrom_gpu_inner_buffer_cache_size;	/* GUC */
+static int				pgstrom_gpu_host_mapped_inner_size;		/* GUC (kB) */
+static int				pgstrom_gpu_kernel_time_slice;	/* GUC (ms) */
+static bool				pgstrom_gpu_peer_inner_buffer;	/* GUC */
 
 static void
-__putGpuQueryBufferNoLock(gpuQueryBuffer *gq_buf)
+__releaseGpuSharedInnerBufferNoLock(gpuSharedInnerBuffer *si)
 {
-	Assert(gq_buf->refcnt > 0);
-	if (--gq_buf->refcnt == 0)
+	CUresult	rc;
+
+	Assert(si->refcnt == 0);
+	rc = cuMemFree(si->m_kmrels);
+	if (rc != CUDA_SUCCESS)
+		__gsDebug("failed on cuMemFree: %s", cuStrError(rc));
+	if (munmap(si->h_kmrels, si->kmrels_sz) != 0)
+		__gsDebug("failed on munmap: %m");
+	if (si->reserved_sz > 0)
 	{
-		CUresult	rc;
+		Assert(si->gcontext->qbuf_reserved >= si->reserved_sz);
+		si->gcontext->qbuf_reserved -= si->reserved_sz;
+		pthreadCondBroadcast(&gpu_query_buffer_cond);
+	}
+	dlist_delete(&si->chain);
+	free(si);
+}
 
-		if (gq_buf->m_kmrels)
-		{
-			rc = cuMemFree(gq_buf->m_kmrels);
-			if (rc != CUDA_SUCCESS)
-				__gsDebug("failed on cuMemFree: %s", cuStrError(rc));
+/*
+ * Once the last session detached, the shared inner buffer is kept as an
+ * idle one (refcnt == 0), up to pg_strom.gpu_inner_buffer_cache_size in
+ * total. So, rescans of the GpuJoin and repeated queries on the unchanged
+ * inner relations reuse the device buffer without upload and build of the
+ * hash table. Its contents are verified by memcmp() on the lookup, thus
+ * updates of the inner relations never hit the stale buffer.
+ * Idle buffers are not charged to the admission control, and the least
+ * recently used ones are released first.
+ */
+static void
+__putGpuSharedInnerBufferNoLock(gpuSharedInnerBuffer *si)
+{
+	size_t		cache_limit = ((size_t)pgstrom_gpu_inner_buffer_cache_size << 20);
+	dlist_iter	iter;
+
+	Assert(si->refcnt > 0);
+	if (--si->refcnt > 0)
+		return;
+	if (si->kmrels_sz > cache_limit)
+	{
+		__releaseGpuSharedInnerBufferNoLock(si);
+		return;
+	}
+	/* keep the buffer as idle one */
+	if (si->reserved_sz > 0)
+	{
+		Assert(si->gcontext->qbuf_reserved >= si->reserved_sz);
+		si->gcontext->qbuf_reserved -= si->reserved_sz;
+		si->reserved_sz = 0;
+		pthreadCondBroadcast(&gpu_query_buffer_cond);
+	}
+	dlist_delete(&si->chain);
+	dlist_push_head(&gpu_shared_inner_list, &si->chain);
+	gpu_shared_inner_idle_sz += si->kmrels_sz;
+	/* release the least recently used ones, if too much */
+	while (gpu_shared_inner_idle_sz > cache_limit)
+	{
+		gpuSharedInnerBuffer *victim = NULL;
+
+		dlist_reverse_foreach(iter, &gpu_shared_inner_list)
+		{
+			gpuSharedInnerBuffer *curr = dlist_container(gpuSharedInnerBuffer,
+														 chain, iter.cur);
+			if (curr->refcnt == 0)
+			{
+				victim = curr;
+				break;
+			}
 		}
-		if (gq_buf->h_kmrels)
+		if (!victim)
+			break;
+		Assert(gpu_shared_inner_idle_sz >= victim->kmrels_sz);
+		gpu_shared_inner_idle_sz -= victim->kmrels_sz;
+		__releaseGpuSharedInnerBufferNoLock(victim);
+	}
+}
+
+static void
+__putGpuQueryBufferNoLock(gpuQueryBuffer *gq_buf)
+{
+	Assert(gq_buf->refcnt > 0);
+	if (--gq_buf->refcnt == 0)
+	{
+		CUresult	rc;
+
+		if (gq_buf->shared_inner)
+			__putGpuSharedInnerBufferNoLock(gq_buf->shared_inner);
+		else if (gq_buf->kmrels_host_mapped)
 		{
+			rc = cuMemHostUnregister(gq_buf->h_kmrels);
+			if (rc != CUDA_SUCCESS)
+				__gsDebug("failed on cuMemHostUnregister: %s", cuStrError(rc));
 			if (munmap(gq_buf->h_kmrels,
 					   gq_buf->kmrels_sz) != 0)
 				__gsDebug("failed on munmap: %m");
 		}
+		else
+		{
+			if (gq_buf->m_kmrels)
+			{
+				rc = cuMemFree(gq_buf->m_kmrels);
+				if (rc != CUDA_SUCCESS)
+					__gsDebug("failed on cuMemFree: %s", cuStrError(rc));
+			}
+			if (gq_buf->h_kmrels)
+			{
+				if (munmap(gq_buf->h_kmrels,
+						   gq_buf->kmrels_sz) != 0)
+					__gsDebug("failed on munmap: %m");
+			}
+		}
 		if (gq_buf->m_kds_final)
 		{
 			rc = cuMemFree(gq_buf->m_kds_final);
 			if (rc != CUDA_SUCCESS)
 				__gsDebug("failed on cuMemFree: %s", cuStrError(rc));
 		}
+		if (gq_buf->reserved_sz > 0)
+		{
+			Assert(gq_buf->gcontext->qbuf_reserved >= gq_buf->reserved_sz);
+			gq_buf->gcontext->qbuf_reserved -= gq_buf->reserved_sz;
+			/* wake up the sessions waiting for admission */
+			pthreadCondBroadcast(&gpu_query_buffer_cond);
+		}
 		dlist_delete(&gq_buf->chain);
 		free(gq_buf);
 	}
@@ -1178,6 +2076,158 @@ putGpuQueryBuffer(gpuQueryBuffer *gq_buf)
 	pthreadMutexUnlock(&gpu_query_buffer_mutex);
 }
 
+static size_t
+__gpuClientQueryBufferUsage(gpuClient *gclient)
+{
+	gpuQueryBuffer *gq_buf = gclient->gq_buf;
+
+	if (!gq_buf)
+		return 0;
+	/* shared inner buffer is also charged to each session */
+	return (gq_buf->reserved_sz +
+			(gq_buf->shared_inner ? gq_buf->kmrels_sz : 0));
+}
+
+/*
+ * __admitGpuQueryBuffer
+ *
+ * It checks the device memory budget of the session, then reserves the
+ * query buffer size on the device. If heavy query buffers already occupy
+ * the device (pg_strom.gpu_admission_ratio), the new session is delayed
+ * until others are released, rather than thrashing the managed memory of
+ * all the running queries. After pg_strom.gpu_admission_timeout, it goes
+ * ahead anyway.
+ */
+static bool
+__admitGpuQueryBuffer(gpuContext *gcontext,
+					  gpuQueryBuffer *gq_buf,
+					  size_t required,
+					  uint32_t gpumem_limit_mb,
+					  char *errmsg, size_t errmsg_sz)
+{
+	size_t		admission_limit;
+	struct timeval tv1, tv2;
+
+	if (gpumem_limit_mb > 0 &&
+		gq_buf->reserved_sz + required > ((size_t)gpumem_limit_mb << 20))
+	{
+		snprintf(errmsg, errmsg_sz,
+				 "GPU memory budget of the session (%uMB) is too small for the query buffer (%zu bytes)",
+				 gpumem_limit_mb, gq_buf->reserved_sz + required);
+		return false;
+	}
+	admission_limit = (pgstrom_gpu_admission_ratio *
+					   (double)gpuDevAttrs[gcontext->cuda_dindex].DEV_TOTAL_MEMSZ);
+	gettimeofday(&tv1, NULL);
+	pthreadMutexLock(&gpu_query_buffer_mutex);
+	while (gcontext->qbuf_reserved > 0 &&
+		   gcontext->qbuf_reserved + required > admission_limit &&
+		   !gpuServiceGoingTerminate())
+	{
+		long	elapsed;
+
+		gettimeofday(&tv2, NULL);
+		elapsed = ((tv2.tv_sec  - tv1.tv_sec)  * 1000L +
+				   (tv2.tv_usec - tv1.tv_usec) / 1000L);
+		if (elapsed >= pgstrom_gpu_admission_timeout)
+		{
+			__gsDebug("GPU-%d: query buffer (%zu bytes) admitted after %ldms wait",
+					  gcontext->cuda_dindex, required, elapsed);
+			break;
+		}
+		pthreadCondWaitTimeout(&gpu_query_buffer_cond,
+							   &gpu_query_buffer_mutex,
+							   Min(pgstrom_gpu_admission_timeout - elapsed, 1000L));
+	}
+	gcontext->qbuf_reserved += required;
+	gq_buf->reserved_sz += required;
+	pthreadMutexUnlock(&gpu_query_buffer_mutex);
+
+	return true;
+}
+
+/*
+ * __setupGpuQueryJoinHashTableBuffer
+ *
+ * It builds the inner hash table by GPU kernel, if the backend shipped
+ * the inner tuples as plain rows.
+ */
+static bool
+__setupGpuQueryJoinHashTableBuffer(gpuContext *gcontext,
+								   gpuQueryBuffer *gq_buf,
+								   char *errmsg, size_t errmsg_sz)
+{
+	kern_multirels *h_kmrels = gq_buf->h_kmrels;
+	CUfunction	f_prep_hash = NULL;
+	CUresult	rc;
+	int			grid_sz;
+	int			block_sz;
+	void	   *kern_args[10];
+	bool		has_hash = false;
+
+	for (int depth=1; depth <= h_kmrels->num_rels; depth++)
+	{
+		if (!h_kmrels->chunks[depth-1].hash_gpu_build)
+			continue;
+		if (!f_prep_hash)
+		{
+			rc = cuModuleGetFunction(&f_prep_hash,
+									 gcontext->cuda_module,
+									 "gpujoin_prep_hashtable");
+			if (rc != CUDA_SUCCESS)
+			{
+				snprintf(errmsg, errmsg_sz,
+						 "failed on cuModuleGetFunction: %s", cuStrError(rc));
+				return false;
+			}
+			rc = gpuOptimalBlockSize(&grid_sz,
+									 &block_sz,
+									 f_prep_hash, 0);
+			if (rc != CUDA_SUCCESS)
+			{
+				snprintf(errmsg, errmsg_sz,
+						 "failed on gpuOptimalBlockSize: %s", cuStrError(rc));
+				return false;
+			}
+		}
+		kern_args[0] = &gq_buf->m_kmrels;
+		kern_args[1] = &depth;
+		rc = cuLaunchKernel(f_prep_hash,
+							grid_sz, 1, 1,
+							block_sz, 1, 1,
+							0,
+							MY_STREAM_PER_THREAD,
+							kern_args,
+							NULL);
+		if (rc != CUDA_SUCCESS)
+		{
+			snprintf(errmsg, errmsg_sz,
+					 "failed on cuLaunchKernel: %s", cuStrError(rc));
+			return false;
+		}
+		has_hash = true;
+	}
+
+	if (has_hash)
+	{
+		rc = cuEventRecord(MY_EVENT_PER_THREAD, MY_STREAM_PER_THREAD);
+		if (rc != CUDA_SUCCESS)
+		{
+			snprintf(errmsg, errmsg_sz,
+					 "failed on cuEventRecord: %s", cuStrError(rc));
+			return false;
+		}
+		rc = cuEventSynchronize(MY_EVENT_PER_THREAD);
+		if (rc != CUDA_SUCCESS)
+		{
+			snprintf(errmsg, errmsg_sz,
+					 "failed on cuEventSynchronize: %s", cuStrError(rc));
+			return false;
+		}
+	}
+	return true;
+}
+
 static bool
 __setupGpuQueryJoinGiSTIndexBuffer(gpuContext *gcontext,
 								   gpuQueryBuffer *gq_buf,
@@ -1193,8 +2243,9 @@ __setupGpuQueryJoinGiSTIndexBuffer(gpuContext *gcontext,
 
 	for (int depth=1; depth <= h_kmrels->num_rels; depth++)
 	{
-		if (h_kmrels->chunks[depth-1].gist_offset == 0)
-			continue;
+		if (h_kmrels->chunks[depth-1].gist_offset == 0 ||
+			h_kmrels->chunks[depth-1].gist_rtree)
+			continue;	/* no GiST-index, or packed R-tree already */
 		if (!f_prep_gist)
 		{
 			rc = cuModuleGetFunction(&f_prep_gist,
@@ -1254,10 +2305,238 @@ __setupGpuQueryJoinGiSTIndexBuffer(gpuContext *gcontext,
 	return true;
 }
 
+/*
+ * __gpuSharedInnerContentKey
+ *
+ * Key to find a candidate of shared inner buffer. It hashes the header
+ * portion and samples of the buffer, to avoid reading the entire buffer
+ * for each query. The final decision is made by memcmp().
+ */
+static uint64_t
+__gpuSharedInnerContentKey(const char *h_kmrels, size_t kmrels_sz)
+{
+	uint64_t	key;
+	size_t		off;
+
+	key = hash_bytes_extended((const unsigned char *)h_kmrels,
+							  Min(kmrels_sz, 8192), kmrels_sz);
+	for (off = 8192; off < kmrels_sz; off += (1UL<<20))
+	{
+		key ^= hash_bytes_extended((const unsigned char *)h_kmrels + off,
+								   Min(kmrels_sz - off, 64), key);
+	}
+	return key;
+}
+
+static bool
+__isShareableInnerBuffer(kern_multirels *h_kmrels)
+{
+	if (!pgstrom_gpu_shared_inner_buffer)
+		return false;
+	for (int i=0; i < h_kmrels->num_rels; i++)
+	{
+		if (h_kmrels->chunks[i].ojmap_offset != 0)
+			return false;
+	}
+	return true;
+}
+
+/*
+ * __isHostMappableInnerBuffer
+ *
+ * A small inner buffer is not uploaded to the device memory; GPU kernel
+ * directly reads the host shared memory mapped to the device address space,
+ * over PCI-E or NVLink-C2C. It saves the allocation and copy for short
+ * queries, but only if GPU kernel never writes the buffer (hash-table and
+ * GiST-index built on GPU, or outer-join-map) because the backend process
+ * also refers to the same shared memory segment.
+ */
+static bool
+__isHostMappableInnerBuffer(kern_multirels *h_kmrels, size_t kmrels_sz)
+{
+	if (kmrels_sz > ((size_t)pgstrom_gpu_host_mapped_inner_size << 10))
+		return false;
+	for (int i=0; i < h_kmrels->num_rels; i++)
+	{
+		if (h_kmrels->chunks[i].ojmap_offset != 0 ||
+			h_kmrels->chunks[i].hash_gpu_build ||
+			(h_kmrels->chunks[i].gist_offset != 0 &&
+			 !h_kmrels->chunks[i].gist_rtree))
+			return false;
+	}
+	return true;
+}
+
+/*
+ * __setupGpuPeerDevices
+ *
+ * It picks up the peer GPUs that can access the managed memory of this
+ * device concurrently over NVLink. CUDA driver API does not tell us the
+ * interconnect, so we assume NVLink if P2P native atomic operations are
+ * supported, because PCI-E P2P does not support them.
+ */
+static void
+__setupGpuPeerDevices(gpuContext *gcontext)
+{
+	int		value;
+
+	gcontext->peer_nvlink_dmask = 0;
+	if (cuDeviceGetAttribute(&value, CU_DEVICE_ATTRIBUTE_CONCURRENT_MANAGED_ACCESS,
+							 gcontext->cuda_device) != CUDA_SUCCESS || !value)
+		return;
+	for (int dindex=0; dindex < numGpuDevAttrs && dindex < 64; dindex++)
+	{
+		CUdevice	peer_device;
+
+		if (dindex == gcontext->cuda_dindex ||
+			cuDeviceGet(&peer_device, gpuDevAttrs[dindex].DEV_ID) != CUDA_SUCCESS ||
+			peer_device == gcontext->cuda_device)
+			continue;
+		if (cuDeviceGetP2PAttribute(&value,
+									CU_DEVICE_P2P_ATTRIBUTE_ACCESS_SUPPORTED,
+									gcontext->cuda_device,
+									peer_device) != CUDA_SUCCESS || !value)
+			continue;
+		if (cuDeviceGetP2PAttribute(&value,
+									CU_DEVICE_P2P_ATTRIBUTE_NATIVE_ATOMIC_SUPPORTED,
+									gcontext->cuda_device,
+									peer_device) != CUDA_SUCCESS || !value)
+			continue;
+		gcontext->peer_nvlink_dmask |= (1UL << dindex);
+	}
+	if (gcontext->peer_nvlink_dmask != 0)
+		elog(LOG, "GPU-%d: peer GPUs over NVLink (mask=%08lx)",
+			 gcontext->cuda_dindex, gcontext->peer_nvlink_dmask);
+}
+
+static bool
+__lookupGpuSharedInnerBuffer(gpuContext *gcontext,
+							 gpuQueryBuffer *gq_buf,
+							 kern_multirels *h_kmrels,
+							 size_t kmrels_sz,
+							 uint64_t content_key)
+{
+	gpuSharedInnerBuffer *si = NULL;
+	bool		in_use = false;
+	dlist_iter	iter;
+
+	pthreadMutexLock(&gpu_query_buffer_mutex);
+	dlist_foreach(iter, &gpu_shared_inner_list)
+	{
+		gpuSharedInnerBuffer *curr = dlist_container(gpuSharedInnerBuffer,
+													 chain, iter.cur);
+		if (curr->kmrels_sz != kmrels_sz ||
+			curr->content_key != content_key)
+			continue;
+		if (curr->gcontext == gcontext)
+		{
+			si = curr;
+			break;
+		}
+		/*
+		 * The inner buffer on the peer GPU connected by NVLink is also
+		 * available, but the one on the local device is preferable.
+		 */
+		if (!si && pgstrom_gpu_peer_inner_buffer &&
+			curr->gcontext->cuda_dindex < 64 &&
+			(gcontext->peer_nvlink_dmask & (1UL << curr->gcontext->cuda_dindex)) != 0)
+			si = curr;
+	}
+	if (si)
+	{
+		if (si->refcnt == 0)
+		{
+			/* revive the idle buffer; charged to the admission again */
+			Assert(gpu_shared_inner_idle_sz >= si->kmrels_sz);
+			gpu_shared_inner_idle_sz -= si->kmrels_sz;
+			si->reserved_sz = si->kmrels_sz;
+			si->gcontext->qbuf_reserved += si->kmrels_sz;
+		}
+		else
+			in_use = true;
+		si->refcnt++;
+	}
+	pthreadMutexUnlock(&gpu_query_buffer_mutex);
+
+	if (!si)
+		return false;
+	if (memcmp(si->h_kmrels, h_kmrels, kmrels_sz) != 0)
+	{
+		pthreadMutexLock(&gpu_query_buffer_mutex);
+		__putGpuSharedInnerBufferNoLock(si);
+		pthreadMutexUnlock(&gpu_query_buffer_mutex);
+		return false;
+	}
+	if (si->gcontext != gcontext)
+	{
+		CUresult	rc;
+
+		/*
+		 * Pages of the inner buffer stay on the owner device, and this
+		 * device reads them through the P2P mapping over NVLink, without
+		 * page-fault based migration.
+		 */
+		rc = cuMemAdvise(si->m_kmrels, si->kmrels_sz,
+						 CU_MEM_ADVISE_SET_PREFERRED_LOCATION,
+						 si->gcontext->cuda_device);
+		if (rc == CUDA_SUCCESS)
+			rc = cuMemAdvise(si->m_kmrels, si->kmrels_sz,
+							 CU_MEM_ADVISE_SET_ACCESSED_BY,
+							 gcontext->cuda_device);
+		if (rc != CUDA_SUCCESS)
+		{
+			__gsDebug("failed on cuMemAdvise for the peer inner buffer: %s",
+					  cuStrError(rc));
+			pthreadMutexLock(&gpu_query_buffer_mutex);
+			__putGpuSharedInnerBufferNoLock(si);
+			pthreadMutexUnlock(&gpu_query_buffer_mutex);
+			return false;
+		}
+		__gsDebug("GPU-%d: inner buffer (%zu bytes) on GPU-%d is shared over NVLink",
+				  gcontext->cuda_dindex, kmrels_sz, si->gcontext->cuda_dindex);
+	}
+	gq_buf->m_kmrels = si->m_kmrels;
+	gq_buf->h_kmrels = si->h_kmrels;
+	gq_buf->kmrels_sz = si->kmrels_sz;
+	gq_buf->shared_inner = si;
+	gq_buf->kmrels_shared = in_use;
+	gq_buf->kmrels_cached = !in_use;
+	gq_buf->kmrels_peer = (si->gcontext != gcontext);
+	__gsDebug("GPU-%d: inner buffer (%zu bytes) is shared",
+			  gcontext->cuda_dindex, kmrels_sz);
+	return true;
+}
+
+static void
+__registerGpuSharedInnerBuffer(gpuContext *gcontext,
+							   gpuQueryBuffer *gq_buf,
+							   uint64_t content_key)
+{
+	gpuSharedInnerBuffer *si = calloc(1, sizeof(gpuSharedInnerBuffer));
+
+	if (!si)
+		return;		/* not shared, but no problem */
+	si->refcnt = 1;
+	si->gcontext = gcontext;
+	si->content_key = content_key;
+	si->m_kmrels = gq_buf->m_kmrels;
+	si->h_kmrels = gq_buf->h_kmrels;
+	si->kmrels_sz = gq_buf->kmrels_sz;
+
+	pthreadMutexLock(&gpu_query_buffer_mutex);
+	/* admitted size is moved to the shared buffer */
+	si->reserved_sz = Min(gq_buf->reserved_sz, gq_buf->kmrels_sz);
+	gq_buf->reserved_sz -= si->reserved_sz;
+	gq_buf->shared_inner = si;
+	dlist_push_head(&gpu_shared_inner_list, &si->chain);
+	pthreadMutexUnlock(&gpu_query_buffer_mutex);
+}
+
 static bool
 __setupGpuQueryJoinInnerBuffer(gpuContext *gcontext,
 							   gpuQueryBuffer *gq_buf,
 							   uint32_t kmrels_handle,
+							   uint32_t gpumem_limit_mb,
 							   char *errmsg, size_t errmsg_sz)
 {
 	kern_multirels *h_kmrels;
@@ -1267,6 +2546,8 @@ __setupGpuQueryJoinInnerBuffer(gpuContext *gcontext,
 	struct stat	stat_buf;
 	char		namebuf[100];
 	size_t		mmap_sz;
+	uint64_t	content_key = 0;
+	bool		shareable;
 
 	if (kmrels_handle == 0)
 		return true;
@@ -1302,6 +2583,53 @@ __setupGpuQueryJoinInnerBuffer(gpuContext *gcontext,
 		return false;
 	}
 
+	/* use the inner buffer already loaded by other query, if any */
+	shareable = __isShareableInnerBuffer(h_kmrels);
+	if (shareable)
+	{
+		content_key = __gpuSharedInnerContentKey((const char *)h_kmrels, mmap_sz);
+		if (gpumem_limit_mb == 0 ||
+			gq_buf->reserved_sz + mmap_sz <= ((size_t)gpumem_limit_mb << 20))
+		{
+			if (__lookupGpuSharedInnerBuffer(gcontext, gq_buf,
+											 h_kmrels, mmap_sz,
+											 content_key))
+			{
+				munmap(h_kmrels, mmap_sz);
+				return true;
+			}
+		}
+	}
+	/* small and read-only inner buffer is referenced on the host memory */
+	if (__isHostMappableInnerBuffer(h_kmrels, mmap_sz))
+	{
+		rc = cuMemHostRegister(h_kmrels, mmap_sz,
+							   CU_MEMHOSTREGISTER_DEVICEMAP);
+		if (rc == CUDA_SUCCESS)
+		{
+			rc = cuMemHostGetDevicePointer(&m_kmrels, h_kmrels, 0);
+			if (rc == CUDA_SUCCESS)
+			{
+				gq_buf->m_kmrels = m_kmrels;
+				gq_buf->h_kmrels = h_kmrels;
+				gq_buf->kmrels_sz = mmap_sz;
+				gq_buf->kmrels_host_mapped = true;
+				return true;
+			}
+			cuMemHostUnregister(h_kmrels);
+		}
+		__gsDebug("unable to map the inner buffer (%zu bytes) on the host: %s",
+				  mmap_sz, cuStrError(rc));
+	}
+
+	if (!__admitGpuQueryBuffer(gcontext, gq_buf, mmap_sz,
+							   gpumem_limit_mb,
+							   errmsg, errmsg_sz))
+	{
+		munmap(h_kmrels, mmap_sz);
+		return false;
+	}
+
 	rc = cuMemAllocManaged(&m_kmrels, mmap_sz,
 						   CU_MEM_ATTACH_GLOBAL);
 	if (rc != CUDA_SUCCESS)
@@ -1319,14 +2647,21 @@ __setupGpuQueryJoinInnerBuffer(gpuContext *gcontext,
 	gq_buf->h_kmrels = h_kmrels;
 	gq_buf->kmrels_sz = mmap_sz;
 
-	/* preparation of GiST-index buffer, if any */
-	if (!__setupGpuQueryJoinGiSTIndexBuffer(gcontext, gq_buf,
+	/* build of the inner hash table and GiST-index buffer, if any */
+	if (!__setupGpuQueryJoinHashTableBuffer(gcontext, gq_buf,
+											errmsg, errmsg_sz) ||
+		!__setupGpuQueryJoinGiSTIndexBuffer(gcontext, gq_buf,
 											errmsg, errmsg_sz))
 	{
 		cuMemFree(m_kmrels);
 		munmap(h_kmrels, mmap_sz);
+		gq_buf->m_kmrels = 0UL;
+		gq_buf->h_kmrels = NULL;
 		return false;
 	}
+	/* other queries can share this inner buffer */
+	if (shareable)
+		__registerGpuSharedInnerBuffer(gcontext, gq_buf, content_key);
 	return true;
 }
 
@@ -1334,6 +2669,7 @@ static bool
 __setupGpuQueryGroupByBuffer(gpuContext *gcontext,
 							 gpuQueryBuffer *gq_buf,
 							 kern_data_store *kds_final_head,
+							 uint32_t gpumem_limit_mb,
 							 char *errmsg, size_t errmsg_sz)
 {
 	CUdeviceptr	m_kds_final;
@@ -1343,6 +2679,11 @@ __setupGpuQueryGroupByBuffer(gpuContext *gcontext,
 		return true;	/* nothing to do */
 
 	Assert(KDS_HEAD_LENGTH(kds_final_head) <= kds_final_head->length);
+	if (!__admitGpuQueryBuffer(gcontext, gq_buf,
+							   kds_final_head->length,
+							   gpumem_limit_mb,
+							   errmsg, errmsg_sz))
+		return false;
 	rc =  cuMemAllocManaged(&m_kds_final,
 							kds_final_head->length,
 							CU_MEM_ATTACH_GLOBAL);
@@ -1372,7 +2713,8 @@ __setupGpuQueryGroupByBuffer(gpuContext *gcontext,
  */
 static bool
 __expandGpuQueryGroupByBuffer(gpuQueryBuffer *gq_buf,
-							  size_t kds_length_last)
+							  size_t kds_length_last,
+							  uint32_t gpumem_limit_mb)
 {
 	assert(kds_length_last != 0);	/* must be 2nd or later trial */
 	pthreadRWLockWriteLock(&gq_buf->m_kds_final_rwlock);
@@ -1380,13 +2722,23 @@ __expandGpuQueryGroupByBuffer(gpuQueryBuffer *gq_buf,
 	{
 		kern_data_store *kds_old = (kern_data_store *)gq_buf->m_kds_final;
 		kern_data_store *kds_new;
+		size_t			kds_old_length = kds_old->length;
 		CUdeviceptr		m_devptr;
 		CUresult		rc;
 		size_t			sz, length;
 
 		assert(kds_old->length == gq_buf->m_kds_final_length);
 		length = kds_old->length + Min(kds_old->length, 1UL<<30);
-		rc = cuMemAllocManaged(&m_devptr, length,
+		/* expansion is also under the budget of the session */
+		if (gpumem_limit_mb > 0 &&
+			gq_buf->reserved_sz + (length - kds_old->length) > ((size_t)gpumem_limit_mb << 20))
+		{
+			__gsDebug("GPU memory budget of the session (%uMB) exceeded by kds_final expand",
+					  gpumem_limit_mb);
+			pthreadRWLockUnlock(&gq_buf->m_kds_final_rwlock);
+			return false;
+		}
+		rc = cuMemAllocManaged(&m_devptr, length,
 							   CU_MEM_ATTACH_GLOBAL);
 		if (rc != CUDA_SUCCESS)
 		{
@@ -1413,6 +2765,77 @@ __expandGpuQueryGroupByBuffer(gpuQueryBuffer *gq_buf,
 		cuMemFree(gq_buf->m_kds_final);
 		gq_buf->m_kds_final = m_devptr;
 		gq_buf->m_kds_final_length = length;
+
+		pthreadMutexLock(&gpu_query_buffer_mutex);
+		gq_buf->gcontext->qbuf_reserved += (length - kds_old_length);
+		gq_buf->reserved_sz += (length - kds_old_length);
+		pthreadMutexUnlock(&gpu_query_buffer_mutex);
+	}
+	pthreadRWLockUnlock(&gq_buf->m_kds_final_rwlock);
+
+	return true;
+}
+
+static void	gpuClientWriteBack(gpuClient *gclient,
+								   XpuCommand *resp,
+								   size_t resp_sz,
+								   int kds_nitems,
+								   kern_data_store **kds_array);
+/*
+ * __spillGpuQueryGroupByBuffer
+ *
+ * If kds_final cannot be expanded any more, we write back the partial groups
+ * accumulated so far to the backend, then reuse the buffer for the remaining
+ * rows. It is safe because GpuPreAgg always runs under the final Agg node
+ * of the CPU, and the same grouping keys just appear multiple times in the
+ * partial results. The hash-based final aggregation of PostgreSQL spills by
+ * hash partitions by itself, if the number of groups exceeds the hash_mem.
+ */
+static bool
+__spillGpuQueryGroupByBuffer(gpuClient *gclient,
+							 gpuQueryBuffer *gq_buf,
+							 size_t kds_length_last,
+							 uint32_t kds_nspills_last)
+{
+	pthreadRWLockWriteLock(&gq_buf->m_kds_final_rwlock);
+	if (gq_buf->m_kds_final_length == kds_length_last &&
+		gq_buf->m_kds_final_nspills == kds_nspills_last)
+	{
+		kern_data_store *kds_final = (kern_data_store *)gq_buf->m_kds_final;
+		uint64_t	saved_length = kds_final->length;
+		uint32_t	saved_hash_nslots = kds_final->hash_nslots;
+		XpuCommand *resp;
+		size_t		resp_sz;
+
+		Assert(kds_final->format == KDS_FORMAT_HASH);
+		if (kds_final->nitems == 0)
+		{
+			pthreadRWLockUnlock(&gq_buf->m_kds_final_rwlock);
+			return false;	/* no partial groups to be spilled */
+		}
+		__gsDebug("kds_final spill: nitems=%u usage=%lu length=%lu",
+				  kds_final->nitems,
+				  kds_final->__usage64,
+				  kds_final->length);
+		resp_sz = MAXALIGN(offsetof(XpuCommand, u.results.stats));
+		resp = alloca(resp_sz);
+		memset(resp, 0, resp_sz);
+		resp->magic = XpuCommandMagicNumber;
+		resp->tag   = XpuCommandTag__SuccessPartial;
+		resp->u.results.chunks_nitems = 1;
+		resp->u.results.chunks_offset = resp_sz;
+		gpuClientWriteBack(gclient,
+						   resp, resp_sz,
+						   1, &kds_final);
+		/* restore the header fixed up by gpuClientWriteBack, and reset */
+		kds_final->format = KDS_FORMAT_HASH;
+		kds_final->hash_nslots = saved_hash_nslots;
+		kds_final->length = saved_length;
+		kds_final->nitems = 0;
+		kds_final->__usage64 = 0;
+		memset(KDS_GET_HASHSLOT_BASE(kds_final), 0,
+			   sizeof(uint64_t) * kds_final->hash_nslots);
+		gq_buf->m_kds_final_nspills++;
 	}
 	pthreadRWLockUnlock(&gq_buf->m_kds_final_rwlock);
 
@@ -1424,6 +2847,7 @@ getGpuQueryBuffer(gpuContext *gcontext,
 				  uint64_t buffer_id,
 				  uint32_t kmrels_handle,
 				  kern_data_store *kds_final_head,
+				  uint32_t gpumem_limit_mb,
 				  char *errmsg, size_t errmsg_sz)
 {
 	gpuQueryBuffer *gq_buf;
@@ -1477,16 +2901,19 @@ getGpuQueryBuffer(gpuContext *gcontext,
 	gq_buf->phase  = 0;	/* not initialized yet */
 	gq_buf->buffer_id = buffer_id;
 	gq_buf->cuda_dindex = MY_DINDEX_PER_THREAD;
+	gq_buf->gcontext = gcontext;
 	dlist_push_tail(&gpu_query_buffer_hslot[hindex], &gq_buf->chain);
 	pthreadMutexUnlock(&gpu_query_buffer_mutex);
 
 	if ((kmrels_handle == 0 ||
 		 __setupGpuQueryJoinInnerBuffer(gcontext,
 										gq_buf, kmrels_handle,
+										gpumem_limit_mb,
 										errmsg, errmsg_sz)) &&
 		(kds_final_head == NULL ||
 		 __setupGpuQueryGroupByBuffer(gcontext,
 									  gq_buf, kds_final_head,
+									  gpumem_limit_mb,
 									  errmsg, errmsg_sz)))
 	{
 		/* ok, buffer is now ready */
@@ -1516,16 +2943,321 @@ gpuServiceGoingTerminate(void)
 
 /* ----------------------------------------------------------------
  *
- * gpuservMonitorClient
+ * Per-worker command queues
+ *
+ * Each GPU worker thread owns its command queue, and the monitor threads
+ * dispatch the received commands to the queues; preferably, to idle ones.
+ * A worker that has no commands in its own queue tries to steal commands
+ * from the sibling queues, so the dispatch cost does not depend on the
+ * number of workers (pg_strom.max_async_tasks).
  *
  * ----------------------------------------------------------------
  */
 typedef struct
 {
 	gpuMemChunk	   *chunk;
+	uint64_t		sched_vtag;	/* virtual start tag for fair-share scheduling */
+	uint64_t		ts_enqueue;	/* timestamp when the command is received */
 	XpuCommand		xcmd;
 } gpuServXpuCommandPacked;
 
+#define GPUSERV_PACKED_COMMAND(__xcmd)							\
+	((gpuServXpuCommandPacked *)((char *)(__xcmd) -				\
+								 offsetof(gpuServXpuCommandPacked, xcmd)))
+
+/*
+ * A command held by the worker for the pipelined load of kds_src.
+ * See gpuservPrefetchNextCommand().
+ */
+typedef struct
+{
+	XpuCommand	   *xcmd;			/* command held by the worker, or NULL */
+	bool			fetched;		/* xcmd is already fetched by the worker */
+	gpuMemChunk	   *s_chunk;		/* buffer of kds_src in loading, or NULL */
+	uint32_t		error_code_async;
+	uint32_t		npages_direct_read;
+	uint32_t		npages_vfs_read;
+} gpuServPrefetchState;
+
+static __thread gpuServPrefetchState MY_PREFETCH_PER_THREAD;
+
+/*
+ * Fair-share scheduling
+ *
+ * Each command is tagged with the virtual start time based on the start-time
+ * fair queuing; S = max(V, F_prev) and F = S + GPUSERV_SCHED_COST_UNIT / weight,
+ * where V is the virtual clock of the device (the start tag of the command
+ * in service), F_prev is the finish tag of the previous command of the same
+ * session, and weight is pg_strom.xpu_task_priority of the session.
+ * The queues are ordered by the start tag, thus, a session that enqueued
+ * hundreds of chunks does not starve short queries behind itself.
+ * OpenSession and XpuTaskFinal are not charged, and run next to the commands
+ * already in service.
+ */
+#define GPUSERV_SCHED_COST_UNIT		(1UL<<20)
+
+static void
+__gpuClientSetupSchedTag(gpuClient *gclient, XpuCommand *xcmd)
+{
+	gpuContext *gcontext = gclient->gcontext;
+	gpuServXpuCommandPacked *packed = GPUSERV_PACKED_COMMAND(xcmd);
+	uint64_t	vclock = pg_atomic_read_u64(&gcontext->sched_vclock);
+
+	if (xcmd->tag == XpuCommandTag__XpuTaskExec ||
+		xcmd->tag == XpuCommandTag__XpuTaskExecGpuCache)
+	{
+		uint32_t	weight = 100;
+
+		if (gclient->session && gclient->session->xpu_task_priority > 0)
+			weight = gclient->session->xpu_task_priority;
+		packed->sched_vtag = Max(vclock, gclient->sched_vtag);
+		gclient->sched_vtag = packed->sched_vtag + GPUSERV_SCHED_COST_UNIT / weight;
+	}
+	else
+	{
+		packed->sched_vtag = vclock;
+	}
+}
+
+static void
+__gpuContextAdvanceSchedClock(gpuContext *gcontext, XpuCommand *xcmd)
+{
+	gpuServXpuCommandPacked *packed = GPUSERV_PACKED_COMMAND(xcmd);
+	uint64_t	vclock = pg_atomic_read_u64(&gcontext->sched_vclock);
+
+	while (vclock < packed->sched_vtag)
+	{
+		if (pg_atomic_compare_exchange_u64(&gcontext->sched_vclock,
+										   &vclock,
+										   packed->sched_vtag))
+			break;
+	}
+}
+
+/*
+ * __gpuWorkerQueueInsertCommand
+ *
+ * MEMO: caller must hold 'wqueue->lock'
+ */
+static void
+__gpuWorkerQueueInsertCommand(gpuWorkerQueue *wqueue, XpuCommand *xcmd)
+{
+	uint64_t	vtag = GPUSERV_PACKED_COMMAND(xcmd)->sched_vtag;
+	dlist_iter	iter;
+
+	/* usually, the new command has the largest tag */
+	dlist_reverse_foreach(iter, &wqueue->command_list)
+	{
+		XpuCommand *curr = dlist_container(XpuCommand, chain, iter.cur);
+
+		if (GPUSERV_PACKED_COMMAND(curr)->sched_vtag <= vtag)
+		{
+			dlist_insert_after(iter.cur, &xcmd->chain);
+			goto out;
+		}
+	}
+	dlist_push_head(&wqueue->command_list, &xcmd->chain);
+out:
+	wqueue->nitems++;
+}
+
+static void
+__gpuContextDispatchCommand(gpuContext *gcontext, XpuCommand *xcmd)
+{
+	gpuWorkerQueue *wqueue;
+
+	for (;;)
+	{
+		int			nqueues = gcontext->num_queues;
+		uint32_t	start;
+		gpuWorkerQueue *wq1;
+		gpuWorkerQueue *wq2;
+
+		if (nqueues == 0)
+			goto no_active_queues;
+		start = pg_atomic_fetch_add_u32(&gcontext->queue_dispatch_count, 1);
+
+		/* idle worker first */
+		wqueue = NULL;
+		for (int i=0; i < nqueues; i++)
+		{
+			gpuWorkerQueue *temp = &gcontext->queues[(start + i) % nqueues];
+
+			if (temp->active && temp->idle && temp->nitems == 0)
+			{
+				wqueue = temp;
+				break;
+			}
+		}
+		/* elsewhere, shorter one of the two candidates */
+		if (!wqueue)
+		{
+			wq1 = &gcontext->queues[start % nqueues];
+			wq2 = &gcontext->queues[(start + nqueues / 2) % nqueues];
+			if (wq1->active && (!wq2->active || wq1->nitems <= wq2->nitems))
+				wqueue = wq1;
+			else if (wq2->active)
+				wqueue = wq2;
+			else
+			{
+				for (int i=0; i < nqueues; i++)
+				{
+					gpuWorkerQueue *temp = &gcontext->queues[i];
+
+					if (temp->active)
+					{
+						wqueue = temp;
+						break;
+					}
+				}
+				if (!wqueue)
+					goto no_active_queues;
+			}
+		}
+		pthreadMutexLock(&wqueue->lock);
+		if (wqueue->active)
+			break;
+		/* the owner is going to terminate, so retry */
+		pthreadMutexUnlock(&wqueue->lock);
+	}
+	goto found;
+
+no_active_queues:
+	/*
+	 * No workers are launched yet, or all of them are terminating.
+	 * queues[0] shall be processed by the next worker.
+	 */
+	wqueue = &gcontext->queues[0];
+	pthreadMutexLock(&wqueue->lock);
+found:
+	__gpuWorkerQueueInsertCommand(wqueue, xcmd);
+	pthreadMutexUnlock(&wqueue->lock);
+	pthreadCondSignal(&wqueue->cond);
+}
+
+/*
+ * __gpuWorkerFetchCommand
+ *
+ * It fetches a command from the own queue, or steals from the siblings.
+ */
+static XpuCommand *
+__gpuWorkerFetchCommand(gpuWorker *gworker)
+{
+	gpuContext *gcontext = gworker->gcontext;
+	gpuWorkerQueue *wqueue = &gcontext->queues[gworker->qindex];
+	int			nqueues = gcontext->num_queues;
+	dlist_node *dnode;
+	XpuCommand *xcmd;
+
+	/* the command already picked up for the pipelined load */
+	if (MY_PREFETCH_PER_THREAD.xcmd && !MY_PREFETCH_PER_THREAD.fetched)
+	{
+		xcmd = MY_PREFETCH_PER_THREAD.xcmd;
+		MY_PREFETCH_PER_THREAD.fetched = true;
+		__gpuContextAdvanceSchedClock(gcontext, xcmd);
+		return xcmd;
+	}
+
+	pthreadMutexLock(&wqueue->lock);
+	if (!dlist_is_empty(&wqueue->command_list))
+	{
+		dnode = dlist_pop_head_node(&wqueue->command_list);
+		wqueue->nitems--;
+		pthreadMutexUnlock(&wqueue->lock);
+		xcmd = dlist_container(XpuCommand, chain, dnode);
+		__gpuContextAdvanceSchedClock(gcontext, xcmd);
+		return xcmd;
+	}
+	pthreadMutexUnlock(&wqueue->lock);
+
+	/* try to steal a command from the sibling queues */
+	for (int i=1; i <= nqueues; i++)
+	{
+		gpuWorkerQueue *victim;
+
+		victim = &gcontext->queues[(gworker->qindex + i) % nqueues];
+		if (victim == wqueue || victim->nitems == 0)
+			continue;
+		if (!pthreadMutexTryLock(&victim->lock))
+			continue;
+		if (!dlist_is_empty(&victim->command_list))
+		{
+			dnode = dlist_pop_head_node(&victim->command_list);
+			victim->nitems--;
+			pthreadMutexUnlock(&victim->lock);
+			xcmd = dlist_container(XpuCommand, chain, dnode);
+			__gpuContextAdvanceSchedClock(gcontext, xcmd);
+			return xcmd;
+		}
+		pthreadMutexUnlock(&victim->lock);
+	}
+	return NULL;
+}
+
+/*
+ * __gpuWorkerDetachQueue
+ *
+ * It stops to accept new commands on the worker's queue, then re-dispatch
+ * the pending commands to the sibling workers.
+ */
+static void
+__gpuWorkerDetachQueue(gpuWorker *gworker)
+{
+	gpuContext *gcontext = gworker->gcontext;
+	gpuWorkerQueue *wqueue = &gcontext->queues[gworker->qindex];
+	dlist_head	pending_list;
+
+	dlist_init(&pending_list);
+	/* the command held for the pipelined load, if any */
+	if (MY_PREFETCH_PER_THREAD.xcmd && !MY_PREFETCH_PER_THREAD.fetched)
+	{
+		XpuCommand *xcmd = MY_PREFETCH_PER_THREAD.xcmd;
+
+		if (MY_PREFETCH_PER_THREAD.s_chunk)
+		{
+			cuEventSynchronize(MY_COPY_EVENT_PER_THREAD);
+			gpuMemFree(MY_PREFETCH_PER_THREAD.s_chunk);
+		}
+		memset(&MY_PREFETCH_PER_THREAD, 0, sizeof(gpuServPrefetchState));
+		dlist_push_tail(&pending_list, &xcmd->chain);
+	}
+	pthreadMutexLock(&wqueue->lock);
+	wqueue->active = false;
+	wqueue->idle = false;
+	while (!dlist_is_empty(&wqueue->command_list))
+	{
+		dlist_node *dnode = dlist_pop_head_node(&wqueue->command_list);
+
+		dlist_push_tail(&pending_list, dnode);
+	}
+	wqueue->nitems = 0;
+	pthreadMutexUnlock(&wqueue->lock);
+
+	while (!dlist_is_empty(&pending_list))
+	{
+		dlist_node *dnode = dlist_pop_head_node(&pending_list);
+
+		__gpuContextDispatchCommand(gcontext,
+									dlist_container(XpuCommand, chain, dnode));
+	}
+}
+
+/*
+ * __gpuContextWakeupWorkers
+ */
+static void
+__gpuContextWakeupWorkers(gpuContext *gcontext)
+{
+	for (int i=0; i < GPUSERV_MAX_WORKER_QUEUES; i++)
+		pthreadCondBroadcast(&gcontext->queues[i].cond);
+}
+
+/* ----------------------------------------------------------------
+ *
+ * gpuservMonitorClient
+ *
+ * ----------------------------------------------------------------
+ */
 static void *
 __gpuServiceAllocCommand(void *__priv, size_t sz)
 {
@@ -1548,18 +3280,17 @@ __gpuServiceAttachCommand(void *__priv, XpuCommand *xcmd)
 
 	pg_atomic_fetch_add_u32(&gclient->refcnt, 2);
 	xcmd->priv = gclient;
+	GPUSERV_PACKED_COMMAND(xcmd)->ts_enqueue = monotonic_clock_us();
 
-	pthreadMutexLock(&gcontext->lock);
-	dlist_push_tail(&gcontext->command_list, &xcmd->chain);
-	pthreadMutexUnlock(&gcontext->lock);
-	pthreadCondSignal(&gcontext->cond);
+	__gpuClientSetupSchedTag(gclient, xcmd);
+	__gpuContextDispatchCommand(gcontext, xcmd);
 }
 
 static void
 __gpuServiceFreeCommand(XpuCommand *xcmd)
 {
-	gpuServXpuCommandPacked *packed = (gpuServXpuCommandPacked *)
-		((char *)xcmd - offsetof(gpuServXpuCommandPacked, xcmd));
+	gpuServXpuCommandPacked *packed = GPUSERV_PACKED_COMMAND(xcmd);
+
 	gpuMemFree(packed->chunk);
 }
 TEMPLATE_XPU_CONNECT_RECEIVE_COMMANDS(__gpuService)
@@ -1585,16 +3316,215 @@ gpuClientPut(gpuClient *gclient, bool exit_monitor_thread)
 			close(gclient->sockfd);
 		if (gclient->gq_buf)
 			putGpuQueryBuffer(gclient->gq_buf);
+		if (gclient->h_ring)
+		{
+			if (gclient->ring_registered)
+				cuMemHostUnregister(gclient->h_ring);
+			munmap(gclient->h_ring, gclient->ring_mmap_sz);
+		}
 		if (gclient->session)
 		{
 			XpuCommand	   *xcmd = (XpuCommand *)((char *)gclient->session -
 												  offsetof(XpuCommand, u.session));
 			__gpuServiceFreeCommand(xcmd);
 		}
+		for (int i=0; i < KERN_SESSION_CACHE_NSLOTS; i++)
+		{
+			if (gclient->session_cache[i].image)
+				free(gclient->session_cache[i].image);
+		}
 		free(gclient);
 	}
 }
 
+/*
+ * gpuClientSetupResultRing
+ */
+static void
+gpuClientSetupResultRing(gpuClient *gclient, kern_session_info *session)
+{
+	kern_result_ring *h_ring;
+	int			fdesc;
+	struct stat	stat_buf;
+	char		namebuf[100];
+	size_t		mmap_sz;
+	CUresult	rc;
+
+	if (session->result_ring_handle == 0)
+		return;
+	snprintf(namebuf, sizeof(namebuf),
+			 ".pgstrom_ring_%u_%u",
+			 PostPortNumber, session->result_ring_handle);
+	fdesc = shm_open(namebuf, O_RDWR, 0600);
+	if (fdesc < 0)
+	{
+		__gsDebug("failed on shm_open('%s'): %m", namebuf);
+		return;
+	}
+	if (fstat(fdesc, &stat_buf) != 0)
+	{
+		__gsDebug("failed on fstat('%s'): %m", namebuf);
+		close(fdesc);
+		return;
+	}
+	mmap_sz = PAGE_ALIGN(stat_buf.st_size);
+	h_ring = mmap(NULL, mmap_sz,
+				  PROT_READ | PROT_WRITE,
+				  MAP_SHARED,
+				  fdesc, 0);
+	close(fdesc);
+	if (h_ring == MAP_FAILED)
+	{
+		__gsDebug("failed on mmap('%s', %zu): %m", namebuf, mmap_sz);
+		return;
+	}
+	if (h_ring->length > mmap_sz ||
+		h_ring->length < offsetof(kern_result_ring, data) + PAGE_SIZE)
+	{
+		__gsDebug("result ring '%s' has wrong length (%lu)",
+				  namebuf, h_ring->length);
+		munmap(h_ring, mmap_sz);
+		return;
+	}
+	/* results can be written by DMA, if pinned */
+	rc = cuMemHostRegister(h_ring, mmap_sz, CU_MEMHOSTREGISTER_PORTABLE);
+	if (rc != CUDA_SUCCESS)
+		__gsDebug("failed on cuMemHostRegister('%s'): %s",
+				  namebuf, cuStrError(rc));
+	else
+		gclient->ring_registered = true;
+	gclient->h_ring = h_ring;
+	gclient->ring_mmap_sz = mmap_sz;
+	gclient->ring_head = 0;
+	gclient->ring_tail = 0;
+	gclient->ring_usage = 0;
+}
+
+/*
+ * gpuClientAllocResultRing
+ *
+ * It returns the offset of the new block from the head of the ring,
+ * or 0 if no space left. The backend releases the blocks in arbitrary
+ * order, so we reclaim the consecutive released blocks from the tail.
+ */
+static uint64_t
+gpuClientAllocResultRing(gpuClient *gclient, size_t sz)
+{
+	kern_result_ring *h_ring = gclient->h_ring;
+	kern_result_ring_block *block;
+	uint64_t	ring_sz = (h_ring->length - offsetof(kern_result_ring, data));
+	uint64_t	required;
+	uint64_t	skip = 0;
+	uint64_t	offset = 0;
+
+	ring_sz &= ~((uint64_t)KERN_RESULT_RING_ALIGN - 1);
+	required = TYPEALIGN(KERN_RESULT_RING_ALIGN,
+						 offsetof(kern_result_ring_block, data) + sz);
+	if (required > ring_sz)
+		return 0;
+
+	pthreadMutexLock(&gclient->ring_lock);
+	/* reclaim the blocks already released */
+	while (gclient->ring_usage > 0)
+	{
+		block = (kern_result_ring_block *)
+			(h_ring->data + gclient->ring_tail);
+		if (!block->released)
+			break;
+		pg_read_barrier();
+		Assert(block->length <= gclient->ring_usage);
+		gclient->ring_usage -= block->length;
+		gclient->ring_tail += block->length;
+		if (gclient->ring_tail >= ring_sz)
+			gclient->ring_tail = 0;
+	}
+	if (gclient->ring_usage == 0)
+		gclient->ring_head = gclient->ring_tail = 0;
+	/* wrap around, if no contiguous space at the end */
+	if (gclient->ring_head + required > ring_sz)
+		skip = ring_sz - gclient->ring_head;
+	if (gclient->ring_usage + skip + required <= ring_sz)
+	{
+		if (skip > 0)
+		{
+			block = (kern_result_ring_block *)
+				(h_ring->data + gclient->ring_head);
+			block->released = 1;
+			block->length = skip;
+			gclient->ring_usage += skip;
+			gclient->ring_head = 0;
+		}
+		block = (kern_result_ring_block *)
+			(h_ring->data + gclient->ring_head);
+		block->released = 0;
+		block->length = required;
+		offset = (block->data - (char *)h_ring);
+		gclient->ring_usage += required;
+		gclient->ring_head += required;
+		if (gclient->ring_head >= ring_sz)
+			gclient->ring_head = 0;
+	}
+	pthreadMutexUnlock(&gclient->ring_lock);
+
+	return offset;
+}
+
+/*
+ * __gpuClientWriteBackRing
+ *
+ * It copies the data chunks (iov_array[1...]) into the result ring, then
+ * sends back only the response header. If no space left on the ring, it
+ * returns false, and caller sends back the results over the socket.
+ */
+static bool
+__gpuClientWriteBackRing(gpuClient *gclient,
+						 XpuCommand *resp, size_t resp_sz,
+						 struct iovec *iov_array, int iovcnt)
+{
+	uint64_t	offset;
+	char	   *pos;
+	size_t		payload_sz = resp->length - resp_sz;
+	CUresult	rc = CUDA_SUCCESS;
+	struct iovec iov;
+
+	if (iovcnt <= 1 || payload_sz == 0)
+		return false;
+	if ((offset = gpuClientAllocResultRing(gclient, payload_sz)) == 0)
+		return false;
+	pos = (char *)gclient->h_ring + offset;
+	for (int i=1; i < iovcnt; i++)
+	{
+		if (gclient->ring_registered && rc == CUDA_SUCCESS)
+			rc = cuMemcpyAsync((CUdeviceptr)pos,
+							   (CUdeviceptr)iov_array[i].iov_base,
+							   iov_array[i].iov_len,
+							   MY_STREAM_PER_THREAD);
+		if (!gclient->ring_registered || rc != CUDA_SUCCESS)
+			memcpy(pos, iov_array[i].iov_base, iov_array[i].iov_len);
+		pos += iov_array[i].iov_len;
+	}
+	if (gclient->ring_registered &&
+		(rc != CUDA_SUCCESS ||
+		 cuStreamSynchronize(MY_STREAM_PER_THREAD) != CUDA_SUCCESS))
+	{
+		/* DMA is not reliable, so copy them again by CPU */
+		pos = (char *)gclient->h_ring + offset;
+		for (int i=1; i < iovcnt; i++)
+		{
+			memcpy(pos, iov_array[i].iov_base, iov_array[i].iov_len);
+			pos += iov_array[i].iov_len;
+		}
+	}
+	Assert(pos - ((char *)gclient->h_ring + offset) == payload_sz);
+	resp->u.results.chunks_ring_offset = offset;
+	resp->length = resp_sz;
+	iov.iov_base = resp;
+	iov.iov_len  = resp_sz;
+	__gpuClientWriteBack(gclient, &iov, 1);
+
+	return true;
+}
+
 /*
  * gpuClientWriteBack
  */
@@ -1744,6 +3674,12 @@ gpuClientWriteBack(gpuClient  *gclient,
 		resp_sz += kds->length;
 	}
 	resp->length = resp_sz;
+	if (gclient->h_ring &&
+		(resp->tag == XpuCommandTag__Success ||
+		 resp->tag == XpuCommandTag__SuccessPartial) &&
+		__gpuClientWriteBackRing(gclient, resp, iov_array[0].iov_len,
+								 iov_array, iovcnt))
+		return;
 	__gpuClientWriteBack(gclient, iov_array, iovcnt);
 }
 
@@ -1898,14 +3834,14 @@ expandCudaStackLimit(gpuClient *gclient, kern_session_info *session)
  * gpuservHandleOpenSession
  */
 static bool
-__lookupDeviceTypeOper(gpuContext *gcontext,
+__lookupDeviceTypeOper(const gpuModuleLinkage *linkage,
 					   const xpu_datum_operators **p_expr_ops,
 					   TypeOpCode type_code,
 					   char *emsg, size_t emsg_sz)
 {
 	xpu_type_catalog_entry *xpu_type;
 
-	xpu_type = hash_search(gcontext->cuda_type_htab,
+	xpu_type = hash_search(linkage->cuda_type_htab,
 						   &type_code,
 						   HASH_FIND, NULL);
 	if (!xpu_type)
@@ -1920,14 +3856,14 @@ __lookupDeviceTypeOper(gpuContext *gcontext,
 }
 
 static bool
-__lookupDeviceFuncDptr(gpuContext *gcontext,
+__lookupDeviceFuncDptr(const gpuModuleLinkage *linkage,
 					   xpu_function_t *p_func_dptr,
 					   FuncOpCode func_code,
 					   char *emsg, size_t emsg_sz)
 {
 	xpu_function_catalog_entry *xpu_func;
 
-	xpu_func = hash_search(gcontext->cuda_func_htab,
+	xpu_func = hash_search(linkage->cuda_func_htab,
 						   &func_code,
 						   HASH_FIND, NULL);
 	if (!xpu_func)
@@ -1942,20 +3878,20 @@ __lookupDeviceFuncDptr(gpuContext *gcontext,
 }
 
 static bool
-__resolveDevicePointersWalker(gpuContext *gcontext,
+__resolveDevicePointersWalker(const gpuModuleLinkage *linkage,
 							  kern_expression *kexp,
 							  char *emsg, size_t emsg_sz)
 {
 	kern_expression *karg;
 	int		i;
 
-	if (!__lookupDeviceFuncDptr(gcontext,
+	if (!__lookupDeviceFuncDptr(linkage,
 								&kexp->fn_dptr,
 								kexp->opcode,
 								emsg, emsg_sz))
 		return false;
 
-	if (!__lookupDeviceTypeOper(gcontext,
+	if (!__lookupDeviceTypeOper(linkage,
 								&kexp->expr_ops,
 								kexp->exptype,
 								emsg, emsg_sz))
@@ -1971,7 +3907,7 @@ __resolveDevicePointersWalker(gpuContext *gcontext,
 					((char *)kexp + kexp->u.casewhen.case_comp);
 				if (!__KEXP_IS_VALID(kexp,karg))
 					goto corruption;
-				if (!__resolveDevicePointersWalker(gcontext, karg,
+				if (!__resolveDevicePointersWalker(linkage, karg,
 												   emsg, emsg_sz))
 					return false;
 			}
@@ -1981,7 +3917,7 @@ __resolveDevicePointersWalker(gpuContext *gcontext,
 					((char *)kexp + kexp->u.casewhen.case_else);
 				if (!__KEXP_IS_VALID(kexp,karg))
 					goto corruption;
-				if (!__resolveDevicePointersWalker(gcontext, karg,
+				if (!__resolveDevicePointersWalker(linkage, karg,
 												   emsg, emsg_sz))
 					return false;
 			}
@@ -1997,7 +3933,7 @@ __resolveDevicePointersWalker(gpuContext *gcontext,
 	{
 		if (!__KEXP_IS_VALID(kexp,karg))
 			goto corruption;
-		if (!__resolveDevicePointersWalker(gcontext, karg, emsg, emsg_sz))
+		if (!__resolveDevicePointersWalker(linkage, karg, emsg, emsg_sz))
 			return false;
 	}
 	return true;
@@ -2008,7 +3944,7 @@ corruption:
 }
 
 static bool
-__resolveDevicePointers(gpuContext *gcontext,
+__resolveDevicePointers(const gpuModuleLinkage *linkage,
 						kern_session_info *session,
 						char *emsg, size_t emsg_sz)
 {
@@ -2023,6 +3959,7 @@ __resolveDevicePointers(gpuContext *gcontext,
 	__kexp[nitems++] = SESSION_KEXP_JOIN_QUALS(session, -1);
 	__kexp[nitems++] = SESSION_KEXP_HASH_VALUE(session, -1);
 	__kexp[nitems++] = SESSION_KEXP_GIST_EVALS(session, -1);
+	__kexp[nitems++] = SESSION_KEXP_RANGE_KEY(session, -1);
 	__kexp[nitems++] = SESSION_KEXP_PROJECTION(session);
 	__kexp[nitems++] = SESSION_KEXP_GROUPBY_KEYHASH(session);
 	__kexp[nitems++] = SESSION_KEXP_GROUPBY_KEYLOAD(session);
@@ -2031,7 +3968,7 @@ __resolveDevicePointers(gpuContext *gcontext,
 
 	for (int i=0; i < nitems; i++)
 	{
-		if (__kexp[i] && !__resolveDevicePointersWalker(gcontext,
+		if (__kexp[i] && !__resolveDevicePointersWalker(linkage,
 														__kexp[i],
 														emsg, emsg_sz))
 			return false;
@@ -2040,7 +3977,7 @@ __resolveDevicePointers(gpuContext *gcontext,
 	/* fixup kern_varslot_desc also */
 	for (int i=0; i < session->kcxt_kvars_nslots; i++)
 	{
-		if (!__lookupDeviceTypeOper(gcontext,
+		if (!__lookupDeviceTypeOper(linkage,
 									&kvslot_desc[i].vs_ops,
 									kvslot_desc[i].vs_type_code,
 									emsg, emsg_sz))
@@ -2050,7 +3987,7 @@ __resolveDevicePointers(gpuContext *gcontext,
 	/**/
 	if (encode)
 	{
-		xpu_encode_info *catalog = gcontext->cuda_encode_catalog;
+		xpu_encode_info *catalog = linkage->cuda_encode_catalog;
 
 		for (int i=0; ; i++)
 		{
@@ -2071,29 +4008,154 @@ __resolveDevicePointers(gpuContext *gcontext,
 	return true;
 }
 
-static bool
-gpuservHandleOpenSession(gpuClient *gclient, XpuCommand *xcmd)
-{
-	gpuContext	   *gcontext = gclient->gcontext;
-	kern_session_info *session = &xcmd->u.session;
-	XpuCommand		resp;
-	char			emsg[512];
-	struct iovec	iov;
+static void		gpuservLookupJitModule(gpuClient *gclient,
+									   kern_session_info *session,
+									   gpuModuleLinkage *linkage);
 
-	if (gclient->session)
+/*
+ * __lookupGpuSessionCache
+ */
+static gpuSessionCacheEntry *
+__lookupGpuSessionCache(gpuClient *gclient, const kern_session_info *session)
+{
+	if (session->session_cache_key == 0)
+		return NULL;
+	for (int i=0; i < KERN_SESSION_CACHE_NSLOTS; i++)
 	{
-		gpuClientELog(gclient, "OpenSession is called twice");
+		gpuSessionCacheEntry *entry = &gclient->session_cache[i];
+
+		if (entry->key == session->session_cache_key &&
+			entry->offset == session->session_cache_offset &&
+			entry->length == session->session_cache_length &&
+			entry->image != NULL)
+			return entry;
+	}
+	return NULL;
+}
+
+/*
+ * __restoreGpuSessionCache
+ *
+ * It builds the entire session image from the dynamic portion sent by the
+ * backend and the static portion kept on the connection.
+ */
+static XpuCommand *
+__restoreGpuSessionCache(gpuSessionCacheEntry *entry, XpuCommand *xcmd)
+{
+	XpuCommand *__xcmd;
+	size_t		head_sz = offsetof(XpuCommand, u.session) + entry->offset;
+
+	if (xcmd->length < head_sz)
+		return NULL;
+	__xcmd = __gpuServiceAllocCommand(NULL, xcmd->length + entry->length);
+	if (!__xcmd)
+		return NULL;
+	memcpy(__xcmd, xcmd, head_sz);
+	memcpy((char *)__xcmd + head_sz, entry->image, entry->length);
+	memcpy((char *)__xcmd + head_sz + entry->length,
+		   (char *)xcmd + head_sz,
+		   xcmd->length - head_sz);
+	__xcmd->length = xcmd->length + entry->length;
+	__xcmd->u.session.session_cache_omitted = false;
+
+	return __xcmd;
+}
+
+/*
+ * __saveGpuSessionCache
+ *
+ * It keeps the static portion of the session, already resolved. The entry
+ * with the same key, or the oldest one, is replaced, as the backend doing.
+ */
+static bool
+__saveGpuSessionCache(gpuClient *gclient, const kern_session_info *session)
+{
+	gpuSessionCacheEntry *entry = NULL;
+
+	for (int i=0; i < KERN_SESSION_CACHE_NSLOTS; i++)
+	{
+		if (gclient->session_cache[i].key == session->session_cache_key)
+		{
+			entry = &gclient->session_cache[i];
+			break;
+		}
+	}
+	if (!entry)
+	{
+		entry = &gclient->session_cache[gclient->session_cache_next];
+		gclient->session_cache_next = ((gclient->session_cache_next + 1) %
+									   KERN_SESSION_CACHE_NSLOTS);
+	}
+	if (entry->image)
+		free(entry->image);
+	entry->key = session->session_cache_key;
+	entry->offset = session->session_cache_offset;
+	entry->length = session->session_cache_length;
+	entry->cuda_module = gclient->cuda_module;
+	entry->image = malloc(entry->length);
+	if (!entry->image)
+		return false;
+	memcpy(entry->image, (const char *)session + entry->offset,
+		   entry->length);
+	return true;
+}
+
+static bool
+gpuservHandleOpenSession(gpuClient *gclient, XpuCommand *xcmd)
+{
+	gpuContext	   *gcontext = gclient->gcontext;
+	kern_session_info *session = &xcmd->u.session;
+	gpuSessionCacheEntry *centry = NULL;
+	XpuCommand	   *xcmd_orig = NULL;
+	gpuModuleLinkage linkage;
+	XpuCommand		resp;
+	char			emsg[512];
+	struct iovec	iov;
+
+	if (gclient->session)
+	{
+		gpuClientELog(gclient, "OpenSession is called twice");
 		return false;
 	}
+	/* restore the static portion kept on the connection, if omitted */
+	if (session->session_cache_omitted)
+	{
+		centry = __lookupGpuSessionCache(gclient, session);
+		if (!centry)
+		{
+			gpuClientELog(gclient, "session cache %016lx is not found",
+						  session->session_cache_key);
+			return false;
+		}
+		xcmd_orig = xcmd;
+		xcmd = __restoreGpuSessionCache(centry, xcmd_orig);
+		if (!xcmd)
+		{
+			gpuClientELog(gclient, "out of managed memory");
+			return false;
+		}
+		session = &xcmd->u.session;
+	}
 	/* expand CUDA thread stack limit on demand */
 	if (!expandCudaStackLimit(gclient, session))
-		return false;
+		goto bailout;
+
+	/* choose the session specialized module, if any */
+	gpuservLookupJitModule(gclient, session, &linkage);
 
-	/* resolve device pointers */
-	if (!__resolveDevicePointers(gcontext, session, emsg, sizeof(emsg)))
+	/* resolve device pointers, unless already resolved for the module */
+	if ((!centry || centry->cuda_module != linkage.cuda_module) &&
+		!__resolveDevicePointers(&linkage, session, emsg, sizeof(emsg)))
 	{
 		gpuClientELog(gclient, "%s", emsg);
-		return false;
+		goto bailout;
+	}
+	gclient->cuda_module = linkage.cuda_module;
+	if (!centry && session->session_cache_key != 0 &&
+		!__saveGpuSessionCache(gclient, session))
+	{
+		gpuClientELog(gclient, "out of memory");
+		goto bailout;
 	}
 	if (session->join_inner_handle != 0 ||
 		session->groupby_kds_final != 0)
@@ -2109,14 +4171,20 @@ gpuservHandleOpenSession(gpuClient *gclient, XpuCommand *xcmd)
 											session->query_plan_id,
 											session->join_inner_handle,
 											kds_final_head,
+											session->gpumem_limit_mb,
 											emsg, sizeof(emsg));
 		if (!gclient->gq_buf)
 		{
 			gpuClientELog(gclient, "%s", emsg);
-			return false;
+			goto bailout;
 		}
 	}
 	gclient->session = session;
+	/* the restored image is kept instead */
+	if (xcmd_orig)
+		__gpuServiceFreeCommand(xcmd_orig);
+	/* attach the result ring buffer, if any */
+	gpuClientSetupResultRing(gclient, session);
 
 	/* success status */
 	memset(&resp, 0, sizeof(resp));
@@ -2129,6 +4197,73 @@ gpuservHandleOpenSession(gpuClient *gclient, XpuCommand *xcmd)
 	__gpuClientWriteBack(gclient, &iov, 1);
 
 	return true;
+
+bailout:
+	/* release the restored image; the original one is released by caller */
+	if (xcmd_orig)
+		__gpuServiceFreeCommand(xcmd);
+	return false;
+}
+
+/*
+ * gpuservHandleResetSession
+ *
+ * It releases the resources of the current session, but keeps the
+ * connection (and the result ring buffer), for the next session of the
+ * same backend; see xpuClientReuseConnection().
+ */
+static void
+gpuservHandleResetSession(gpuClient *gclient, XpuCommand *xcmd)
+{
+	gpuContext	   *gcontext = gclient->gcontext;
+	XpuCommand		resp;
+	struct iovec	iov;
+
+	/*
+	 * The backend sends ResetSession after all the responses of the
+	 * session. However, worker threads may still be in the tail of the
+	 * GPU tasks that reference the session, so wait for them.
+	 * (refcnt: 1 by the receiver thread, 2 by this command)
+	 */
+	while ((pg_atomic_read_u32(&gclient->refcnt) & ~1U) > 2 &&
+		   !gpuServiceGoingTerminate())
+		pg_usleep(1000L);
+
+	if (gclient->gq_buf)
+	{
+		putGpuQueryBuffer(gclient->gq_buf);
+		gclient->gq_buf = NULL;
+	}
+	if (gclient->session)
+	{
+		XpuCommand	   *__xcmd = (XpuCommand *)((char *)gclient->session -
+												offsetof(XpuCommand, u.session));
+		gclient->session = NULL;
+		__gpuServiceFreeCommand(__xcmd);
+	}
+	gclient->cuda_module = gcontext->cuda_module;
+	gclient->kds_dst_pool_hint = 0;
+	pg_atomic_write_u64(&gclient->limit_nitems_out, 0);
+	pthreadMutexLock(&gclient->grid_tuner.lock);
+	memset(gclient->grid_tuner.nsamples, 0, sizeof(gclient->grid_tuner.nsamples));
+	memset(gclient->grid_tuner.cost, 0, sizeof(gclient->grid_tuner.cost));
+	pthreadMutexUnlock(&gclient->grid_tuner.lock);
+	/* all the blocks on the ring buffer are no longer referenced */
+	pthreadMutexLock(&gclient->ring_lock);
+	gclient->ring_head = 0;
+	gclient->ring_tail = 0;
+	gclient->ring_usage = 0;
+	pthreadMutexUnlock(&gclient->ring_lock);
+
+	/* success status */
+	memset(&resp, 0, sizeof(resp));
+	resp.magic = XpuCommandMagicNumber;
+	resp.tag = XpuCommandTag__Success;
+	resp.length = offsetof(XpuCommand, u.results.stats);
+
+	iov.iov_base = &resp;
+	iov.iov_len  = resp.length;
+	__gpuClientWriteBack(gclient, &iov, 1);
 }
 
 /* ----------------------------------------------------------------
@@ -2237,969 +4372,3187 @@ gpuservLoadKdsArrow(gpuClient *gclient,
 
 /* ----------------------------------------------------------------
  *
- * gpuservHandleGpuTaskExec
+ * Shared scan of Arrow_Fdw chunks
+ *
+ * When multiple sessions scan the same Apache Arrow files concurrently
+ * (e.g, dashboards that run the same queries), each session reads the
+ * identical record-batches from the storage individually. So, GPU service
+ * keeps the recently loaded KDS_FORMAT_ARROW chunks on the device memory
+ * up to pg_strom.gpu_shared_scan_buffer_size per GPU, then the sessions
+ * that load the identical chunk (same KDS header and I/O vector on the
+ * same file) run their kernels on the shared buffer without I/O.
+ * GPU kernels never modify kds_src. Arrow files are not updated in-place,
+ * so the file identity (inode, size and mtime) is a part of the key.
+ * The shared buffers are not charged to any sessions.
  *
  * ----------------------------------------------------------------
  */
-static unsigned int
-__expand_gpupreagg_prepfunc_buffer(kern_session_info *session,
-								   int grid_sz, int block_sz,
-								   unsigned int __shmem_dynamic_sz,
-								   unsigned int shmem_dynamic_limit,
-								   unsigned int *p_groupby_prepfn_bufsz,
-								   unsigned int *p_groupby_prepfn_nbufs)
+static int		pgstrom_gpu_shared_scan_buffer_size;	/* GUC; MB per GPU */
+
+typedef struct
 {
-	unsigned int	shmem_dynamic_sz = TYPEALIGN(1024, __shmem_dynamic_sz);
+	dlist_node		chain;		/* LRU list */
+	int				refcnt;		/* by gcontext->sscan_lock */
+	gpuMemChunk	   *chunk;
+	uint32_t		hash;
+	size_t			key_len;
+	char			key[FLEXIBLE_ARRAY_MEMBER];
+} gpuSharedScanChunk;
 
-	if (session->groupby_prepfn_bufsz == 0 || shmem_dynamic_sz >= shmem_dynamic_limit)
-		goto no_prepfunc_buffer;
+typedef struct
+{
+	dev_t			st_dev;
+	ino_t			st_ino;
+	off_t			st_size;
+	struct timespec	st_mtim;
+} gpuSharedScanFileIdent;
 
-	if (session->xpucode_groupby_keyhash &&
-		session->xpucode_groupby_keyload &&
-		session->xpucode_groupby_keycomp)
-	{
-		/* GROUP-BY */
-		int		num_buffers = 2 * session->groupby_ngroups_estimation + 100;
-		int		prepfn_usage = session->groupby_prepfn_bufsz * num_buffers;
+/*
+ * __gpuservSharedScanBuildKey
+ */
+static char *
+__gpuservSharedScanBuildKey(const kern_data_store *kds,
+							const char *pathname,
+							const strom_io_vector *kds_iovec,
+							size_t *p_key_len)
+{
+	gpuSharedScanFileIdent fident;
+	struct stat	stat_buf;
+	size_t		path_len = strlen(pathname) + 1;
+	size_t		head_sz = KDS_HEAD_LENGTH(kds);
+	size_t		iovec_sz = offsetof(strom_io_vector, ioc[kds_iovec->nr_chunks]);
+	size_t		key_len;
+	char	   *key, *pos;
 
-		if (shmem_dynamic_sz + prepfn_usage > shmem_dynamic_limit)
-		{
-			/* adjust num_buffers, if too large */
-			num_buffers = (shmem_dynamic_limit -
-						   shmem_dynamic_sz) / session->groupby_prepfn_bufsz;
-			prepfn_usage = session->groupby_prepfn_bufsz * num_buffers;
-		}
-		Assert(shmem_dynamic_sz + prepfn_usage <= shmem_dynamic_limit);
-		if (num_buffers >= 32)
-		{
-			*p_groupby_prepfn_bufsz = session->groupby_prepfn_bufsz;
-			*p_groupby_prepfn_nbufs = num_buffers;
-			return shmem_dynamic_sz + prepfn_usage;
-		}
-	}
-	else if (session->xpucode_groupby_actions)
-	{
-		/* NO-GROUPS */
-		if (shmem_dynamic_sz + session->groupby_prepfn_bufsz <= shmem_dynamic_limit)
-		{
-			*p_groupby_prepfn_bufsz = session->groupby_prepfn_bufsz;
-			*p_groupby_prepfn_nbufs = 1;
-			return shmem_dynamic_sz + session->groupby_prepfn_bufsz;
-		}
-	}
-no_prepfunc_buffer:
-	*p_groupby_prepfn_bufsz = 0;
-	*p_groupby_prepfn_nbufs = 0;
-	return __shmem_dynamic_sz;		/* unaligned original size */
+	if (stat(pathname, &stat_buf) != 0)
+		return NULL;
+	memset(&fident, 0, sizeof(gpuSharedScanFileIdent));
+	fident.st_dev  = stat_buf.st_dev;
+	fident.st_ino  = stat_buf.st_ino;
+	fident.st_size = stat_buf.st_size;
+	fident.st_mtim = stat_buf.st_mtim;
+
+	key_len = sizeof(gpuSharedScanFileIdent) + path_len + head_sz + iovec_sz;
+	key = malloc(key_len);
+	if (!key)
+		return NULL;
+	pos = key;
+	memcpy(pos, &fident, sizeof(gpuSharedScanFileIdent));
+	pos += sizeof(gpuSharedScanFileIdent);
+	memcpy(pos, pathname, path_len);
+	pos += path_len;
+	memcpy(pos, kds, head_sz);
+	pos += head_sz;
+	memcpy(pos, kds_iovec, iovec_sz);
+	*p_key_len = key_len;
+	return key;
 }
 
+/*
+ * __gpuservSharedScanEvict - caller must hold sscan_lock
+ */
 static void
-gpuservHandleGpuTaskExec(gpuClient *gclient, XpuCommand *xcmd)
+__gpuservSharedScanEvict(gpuContext *gcontext, size_t limit)
 {
-	gpuContext		*gcontext = gclient->gcontext;
-	kern_session_info *session = gclient->session;
-	gpuQueryBuffer  *gq_buf = gclient->gq_buf;
-	kern_gputask	*kgtask = NULL;
-	const char		*kds_src_pathname = NULL;
-	strom_io_vector *kds_src_iovec = NULL;
-	kern_data_store *kds_src = NULL;
-	kern_data_store *kds_dst = NULL;
-	kern_data_store *kds_dst_head = NULL;
-	kern_data_store **kds_dst_array = NULL;
-	int				kds_dst_nrooms = 0;
-	int				kds_dst_nitems = 0;
-	int				num_inner_rels = 0;
-	uint32_t		npages_direct_read = 0;
-	uint32_t		npages_vfs_read = 0;
-	CUfunction		f_kern_gpuscan;
-	void		   *gc_lmap = NULL;
-	gpuMemChunk	   *s_chunk = NULL;		/* for kds_src */
-	gpuMemChunk	   *t_chunk = NULL;		/* for kern_gputask */
-	gpuMemChunk	  **d_chunk_array = NULL; /* for kds_dst_array */
-	CUdeviceptr		m_kds_src = 0UL;
-	CUdeviceptr		m_kds_extra = 0UL;
-	CUdeviceptr		m_kmrels = 0UL;
-	CUresult		rc;
-	int				grid_sz;
-	int				block_sz;
-	unsigned int	shmem_dynamic_sz;
-	unsigned int	groupby_prepfn_bufsz = 0;
-	unsigned int	groupby_prepfn_nbufs = 0;
-	size_t			kds_final_length = 0;
-	bool			kds_final_locked = false;
-	size_t			sz;
-	void		   *kern_args[10];
-
-	if (xcmd->u.task.kds_src_pathname)
-		kds_src_pathname = (char *)xcmd + xcmd->u.task.kds_src_pathname;
-	if (xcmd->u.task.kds_src_iovec)
-		kds_src_iovec = (strom_io_vector *)((char *)xcmd + xcmd->u.task.kds_src_iovec);
-	if (xcmd->u.task.kds_src_offset)
-		kds_src = (kern_data_store *)((char *)xcmd + xcmd->u.task.kds_src_offset);
-	if (xcmd->u.task.kds_dst_offset)
-		kds_dst_head = (kern_data_store *)((char *)xcmd + xcmd->u.task.kds_dst_offset);
-	if (!kds_src)
-	{
-		const GpuCacheIdent *ident = (GpuCacheIdent *)xcmd->u.task.data;
-		char		errbuf[120];
+	dlist_mutable_iter iter;
 
-		Assert(xcmd->tag == XpuCommandTag__XpuTaskExecGpuCache);
-		gc_lmap = gpuCacheGetDeviceBuffer(ident,
-										  &m_kds_src,
-										  &m_kds_extra,
-										  errbuf, sizeof(errbuf));
-		if (!gc_lmap)
-		{
-			gpuClientELog(gclient, "no GpuCache (dat=%u,rel=%u,sig=%09lx) found - %s",
-						  ident->database_oid,
-						  ident->table_oid,
-						  ident->signature,
-						  errbuf);
-			return;
-		}
-	}
-	else if (kds_src->format == KDS_FORMAT_ROW)
+	dlist_reverse_foreach_modify(iter, &gcontext->sscan_lru_list)
 	{
-		m_kds_src = (CUdeviceptr)kds_src;
+		gpuSharedScanChunk *sschunk = dlist_container(gpuSharedScanChunk,
+													  chain, iter.cur);
+		if (gcontext->sscan_usage <= limit)
+			break;
+		if (sschunk->refcnt > 0)
+			continue;
+		dlist_delete(&sschunk->chain);
+		gcontext->sscan_usage -= sschunk->chunk->__length;
+		gpuMemFree(sschunk->chunk);
+		free(sschunk);
 	}
-	else if (kds_src->format == KDS_FORMAT_BLOCK)
+}
+
+/*
+ * gpuservLookupSharedScanChunk
+ *
+ * It returns the shared buffer of the identical chunk, if any.
+ */
+static gpuSharedScanChunk *
+gpuservLookupSharedScanChunk(const char *key, size_t key_len)
+{
+	gpuContext *gcontext = GpuWorkerCurrentContext;
+	uint32_t	hash = hash_bytes((const unsigned char *)key, key_len);
+	dlist_iter	iter;
+
+	pthreadMutexLock(&gcontext->sscan_lock);
+	dlist_foreach (iter, &gcontext->sscan_lru_list)
 	{
-		if (kds_src_pathname && kds_src_iovec)
+		gpuSharedScanChunk *sschunk = dlist_container(gpuSharedScanChunk,
+													  chain, iter.cur);
+		if (sschunk->hash == hash &&
+			sschunk->key_len == key_len &&
+			memcmp(sschunk->key, key, key_len) == 0)
 		{
-			s_chunk = gpuservLoadKdsBlock(gclient,
-										  kds_src,
-										  kds_src_pathname,
-										  kds_src_iovec,
-										  &npages_direct_read,
-										  &npages_vfs_read);
-			if (!s_chunk)
-				return;
-			m_kds_src = s_chunk->m_devptr;
-		}
-		else
-		{
-			Assert(kds_src->block_nloaded == kds_src->nitems);
-			m_kds_src = (CUdeviceptr)kds_src;
+			sschunk->refcnt++;
+			dlist_move_head(&gcontext->sscan_lru_list, &sschunk->chain);
+			pthreadMutexUnlock(&gcontext->sscan_lock);
+			return sschunk;
 		}
 	}
-	else if (kds_src->format == KDS_FORMAT_ARROW)
+	pthreadMutexUnlock(&gcontext->sscan_lock);
+	return NULL;
+}
+
+/*
+ * gpuservInsertSharedScanChunk
+ *
+ * It registers the chunk (not charged to the session) to the shared scan
+ * buffers. If any other session already registered the identical chunk,
+ * or it is larger than the limit, the chunk is kept private.
+ */
+static gpuSharedScanChunk *
+gpuservInsertSharedScanChunk(const char *key, size_t key_len,
+							 gpuMemChunk *chunk)
+{
+	gpuContext *gcontext = GpuWorkerCurrentContext;
+	size_t		limit = ((size_t)pgstrom_gpu_shared_scan_buffer_size << 20);
+	gpuSharedScanChunk *sschunk;
+	uint32_t	hash;
+	dlist_iter	iter;
+
+	if (chunk->owner || chunk->__length > limit)
+		return NULL;
+	hash = hash_bytes((const unsigned char *)key, key_len);
+	sschunk = malloc(offsetof(gpuSharedScanChunk, key[key_len]));
+	if (!sschunk)
+		return NULL;
+	memset(sschunk, 0, offsetof(gpuSharedScanChunk, key));
+	sschunk->refcnt = 1;
+	sschunk->chunk = chunk;
+	sschunk->hash = hash;
+	sschunk->key_len = key_len;
+	memcpy(sschunk->key, key, key_len);
+
+	pthreadMutexLock(&gcontext->sscan_lock);
+	dlist_foreach (iter, &gcontext->sscan_lru_list)
 	{
-		if (kds_src_iovec->nr_chunks == 0)
-			m_kds_src = (CUdeviceptr)kds_src;
-		else
+		gpuSharedScanChunk *curr = dlist_container(gpuSharedScanChunk,
+												   chain, iter.cur);
+		if (curr->hash == hash &&
+			curr->key_len == key_len &&
+			memcmp(curr->key, key, key_len) == 0)
 		{
-			if (!kds_src_pathname)
-			{
-				gpuClientELog(gclient, "GpuScan: arrow file is missing");
-				return;
-			}
-			s_chunk = gpuservLoadKdsArrow(gclient,
-										  kds_src,
-										  kds_src_pathname,
-										  kds_src_iovec,
-										  &npages_direct_read,
-										  &npages_vfs_read);
-			if (!s_chunk)
-				return;
-			m_kds_src = s_chunk->m_devptr;
+			pthreadMutexUnlock(&gcontext->sscan_lock);
+			free(sschunk);
+			return NULL;
 		}
 	}
-	else
+	dlist_push_head(&gcontext->sscan_lru_list, &sschunk->chain);
+	gcontext->sscan_usage += chunk->__length;
+	__gpuservSharedScanEvict(gcontext, limit);
+	pthreadMutexUnlock(&gcontext->sscan_lock);
+
+	return sschunk;
+}
+
+/*
+ * gpuservReleaseSharedScanChunk
+ */
+static void
+gpuservReleaseSharedScanChunk(gpuSharedScanChunk *sschunk)
+{
+	gpuContext *gcontext = GpuWorkerCurrentContext;
+	size_t		limit = ((size_t)pgstrom_gpu_shared_scan_buffer_size << 20);
+
+	pthreadMutexLock(&gcontext->sscan_lock);
+	Assert(sschunk->refcnt > 0);
+	sschunk->refcnt--;
+	__gpuservSharedScanEvict(gcontext, limit);
+	pthreadMutexUnlock(&gcontext->sscan_lock);
+}
+
+/*
+ * gpuservReleaseAllSharedScanChunks
+ */
+static void
+gpuservReleaseAllSharedScanChunks(gpuContext *gcontext)
+{
+	pthreadMutexLock(&gcontext->sscan_lock);
+	while (!dlist_is_empty(&gcontext->sscan_lru_list))
 	{
-		gpuClientELog(gclient, "unknown GpuScan Source format (%c)",
-					  kds_src->format);
-		return;
+		dlist_node *dnode = dlist_pop_head_node(&gcontext->sscan_lru_list);
+		gpuSharedScanChunk *sschunk = dlist_container(gpuSharedScanChunk,
+													  chain, dnode);
+		gpuMemFree(sschunk->chunk);
+		free(sschunk);
 	}
-	/* inner buffer of GpuJoin */
-	if (gq_buf && gq_buf->m_kmrels)
-	{
-		kern_multirels *h_kmrels = (kern_multirels *)gq_buf->h_kmrels;
+	gcontext->sscan_usage = 0;
+	pthreadMutexUnlock(&gcontext->sscan_lock);
+}
 
-		m_kmrels = gq_buf->m_kmrels;
-		num_inner_rels = h_kmrels->num_rels;
-	}
+/* ----------------------------------------------------------------
+ *
+ * Pipelined load of the next data chunk
+ *
+ * When the GPU worker launches the kernel for the current command, it picks
+ * up the next command in its own queue, and kicks GPU-Direct SQL (or VFS)
+ * read of the source chunk on the copy stream. So, I/O of the next chunk
+ * is overlapped with the kernel execution of the current chunk.
+ * The picked-up command is held by the worker, then it shall be processed
+ * next to the current command; it is not visible to the sibling workers
+ * for work stealing. Only one command can be prefetched at once, because
+ * gpudirect_vfs_dma_buffer of the extra module is per-thread.
+ *
+ * ----------------------------------------------------------------
+ */
+static bool		pgstrom_gpu_pipelined_load;			/* GUC */
+static int		pgstrom_gpudirect_dma_pool_size;	/* GUC; MB per GPU */
 
-	rc = cuModuleGetFunction(&f_kern_gpuscan,
-							 gcontext->cuda_module,
-							 "kern_gpujoin_main");
+/*
+ * __gpuservPrefetchKdsSource
+ *
+ * It kicks asynchronous load of kds_src of the supplied command. On errors,
+ * it silently gives up prefetching; the command shall load its kds_src in
+ * the synchronous manner, and then reports the error.
+ */
+static gpuMemChunk *
+__gpuservPrefetchKdsSource(XpuCommand *xcmd)
+{
+	gpuServPrefetchState *pf = &MY_PREFETCH_PER_THREAD;
+	const char	   *pathname;
+	strom_io_vector *kds_iovec;
+	kern_data_store *kds;
+	gpuMemChunk	   *chunk;
+	size_t			base_offset;
+	size_t			gap;
+	off_t			off;
+	CUresult		rc;
+
+	pathname  = (char *)xcmd + xcmd->u.task.kds_src_pathname;
+	kds_iovec = (strom_io_vector *)((char *)xcmd + xcmd->u.task.kds_src_iovec);
+	kds = (kern_data_store *)((char *)xcmd + xcmd->u.task.kds_src_offset);
+	if (kds->format == KDS_FORMAT_BLOCK)
+		base_offset = kds->block_offset + kds->block_nloaded * BLCKSZ;
+	else
+		base_offset = KDS_HEAD_LENGTH(kds);
+	off = PAGE_ALIGN(base_offset);
+	gap = off - base_offset;
+
+	chunk = gpuMemAlloc(gap + kds->length);
+	if (!chunk)
+		return NULL;
+	chunk->m_devptr = chunk->__base + chunk->__offset + gap;
+
+	rc = cuMemcpyHtoDAsync(chunk->m_devptr, kds, base_offset,
+						   MY_COPY_STREAM_PER_THREAD);
 	if (rc != CUDA_SUCCESS)
-	{
-		gpuClientFatal(gclient, "failed on cuModuleGetFunction: %s",
-					   cuStrError(rc));
-		goto bailout;
-	}
-	shmem_dynamic_sz = __KERN_WARP_CONTEXT_BASESZ(session->kcxt_kvecs_ndims);
-	rc = gpuOptimalBlockSize(&grid_sz,
-							 &block_sz,
-							 f_kern_gpuscan,
-							 shmem_dynamic_sz);
+		goto error;
+	pf->error_code_async = 0;
+	if (!gpuDirectFileReadAsyncIOV(pathname,
+								   chunk->__base,
+								   chunk->__offset + off,
+								   chunk->mseg->iomap_handle,
+								   kds_iovec,
+								   MY_COPY_STREAM_PER_THREAD,
+								   &pf->error_code_async,
+								   &pf->npages_direct_read,
+								   &pf->npages_vfs_read))
+		goto error;
+	rc = cuEventRecord(MY_COPY_EVENT_PER_THREAD, MY_COPY_STREAM_PER_THREAD);
 	if (rc != CUDA_SUCCESS)
-	{
-		gpuClientFatal(gclient, "failed on gpuOptimalBlockSize: %s",
-					   cuStrError(rc));
-		goto bailout;
-	}
-//	block_sz = 128;
-//	grid_sz = 1;
+		goto error;
+	return chunk;
 
-	/* allocation of extra shared memory for GpuPreAgg (if any) */
-	shmem_dynamic_sz =
-		__expand_gpupreagg_prepfunc_buffer(session,
-										   grid_sz, block_sz,
-										   shmem_dynamic_sz,
-										   gcontext->gpumain_shmem_sz_dynamic,
-										   &groupby_prepfn_bufsz,
-										   &groupby_prepfn_nbufs);
-	/*
-	 * Allocation of the control structure
-	 */
-	sz = KERN_GPUTASK_LENGTH(session->kcxt_kvecs_ndims,
-							 session->kcxt_kvecs_bufsz,
-							 grid_sz, block_sz);
-	t_chunk = gpuMemAllocManaged(sz);
-	if (!t_chunk)
-	{
-		gpuClientFatal(gclient, "failed on gpuMemAllocManaged: %lu", sz);
-		goto bailout;
-	}
-	kgtask = (kern_gputask *)t_chunk->m_devptr;
-	memset(kgtask, 0, offsetof(kern_gputask, stats[num_inner_rels]));
-	kgtask->grid_sz  = grid_sz;
-	kgtask->block_sz = block_sz;
-	kgtask->kvars_nslots = session->kcxt_kvars_nslots;
-	kgtask->kvecs_bufsz  = session->kcxt_kvecs_bufsz;
-	kgtask->kvecs_ndims  = session->kcxt_kvecs_ndims;
-	kgtask->n_rels       = num_inner_rels;
-	kgtask->groupby_prepfn_bufsz = groupby_prepfn_bufsz;
-	kgtask->groupby_prepfn_nbufs = groupby_prepfn_nbufs;
+error:
+	cuStreamSynchronize(MY_COPY_STREAM_PER_THREAD);
+	gpuMemFree(chunk);
+	return NULL;
+}
 
-	/* prefetch source KDS, if managed memory */
-	if (!s_chunk && !gc_lmap)
+/*
+ * gpuservPrefetchNextCommand
+ *
+ * It picks up the next command from the own queue, then kicks the load of
+ * its kds_src, if it is KDS_FORMAT_BLOCK or KDS_FORMAT_ARROW that needs
+ * GPU-Direct SQL.
+ */
+static void
+gpuservPrefetchNextCommand(void)
+{
+	gpuWorker	   *gworker = MY_WORKER_PER_THREAD;
+	gpuServPrefetchState *pf = &MY_PREFETCH_PER_THREAD;
+	gpuWorkerQueue *wqueue;
+	gpuClient	   *gclient;
+	XpuCommand	   *xcmd;
+	kern_data_store *kds;
+
+	if (!pgstrom_gpu_pipelined_load || !gworker || pf->xcmd)
+		return;
+	wqueue = &gworker->gcontext->queues[gworker->qindex];
+	if (wqueue->nitems == 0)
+		return;
+	pthreadMutexLock(&wqueue->lock);
+	if (dlist_is_empty(&wqueue->command_list))
+		goto skip;
+	xcmd = dlist_head_element(XpuCommand, chain, &wqueue->command_list);
+	if (xcmd->tag != XpuCommandTag__XpuTaskExec ||
+		xcmd->u.task.kds_src_offset == 0 ||
+		xcmd->u.task.kds_src_pathname == 0 ||
+		xcmd->u.task.kds_src_iovec == 0)
+		goto skip;
+	kds = (kern_data_store *)((char *)xcmd + xcmd->u.task.kds_src_offset);
+	if (kds->format == KDS_FORMAT_ARROW)
 	{
-		rc = cuMemPrefetchAsync((CUdeviceptr)kds_src,
-								kds_src->length,
-								MY_DEVICE_PER_THREAD,
-								MY_STREAM_PER_THREAD);
-		if (rc != CUDA_SUCCESS)
+		strom_io_vector *kds_iovec = (strom_io_vector *)
+			((char *)xcmd + xcmd->u.task.kds_src_iovec);
+		if (kds_iovec->nr_chunks == 0)
+			goto skip;
+		/* no need to prefetch, if it is already on the shared buffer */
+		if (pgstrom_gpu_shared_scan_buffer_size > 0)
 		{
-			gpuClientFatal(gclient, "failed on cuMemPrefetchAsync: %s",
-						   cuStrError(rc));
-			goto bailout;
-		}
-	}
+			const char *pathname = (char *)xcmd + xcmd->u.task.kds_src_pathname;
+			gpuSharedScanChunk *sschunk = NULL;
+			char	   *key;
+			size_t		key_len;
 
-	/*
-	 * Allocation of the destination buffer
-	 */
-resume_kernel:
-	if (gq_buf && gq_buf->m_kds_final)
-	{
-		/*
-		 * Suspend of GpuPreAgg kernel means the kds_final buffer is
-		 * almost full, thus GPU kernel wants to expand the buffer.
-		 * It must be done under the exclusive lock.
-		 */
-		if (kgtask->resume_context)
-		{
-			if (!__expandGpuQueryGroupByBuffer(gq_buf, kds_final_length))
+			key = __gpuservSharedScanBuildKey(kds, pathname, kds_iovec, &key_len);
+			if (key)
 			{
-				gpuClientFatal(gclient, "unable to expand GpuPreAgg final buffer");
-				goto bailout;
+				sschunk = gpuservLookupSharedScanChunk(key, key_len);
+				free(key);
+			}
+			if (sschunk)
+			{
+				gpuservReleaseSharedScanChunk(sschunk);
+				goto skip;
 			}
 		}
-		pthreadRWLockReadLock(&gq_buf->m_kds_final_rwlock);
-		kds_dst = (kern_data_store *)gq_buf->m_kds_final;
-		kds_final_length = gq_buf->m_kds_final_length;
-		kds_final_locked = true;
 	}
-	else
-	{
-		gpuMemChunk	   *d_chunk;
+	else if (kds->format != KDS_FORMAT_BLOCK)
+		goto skip;
+	dlist_delete(&xcmd->chain);
+	wqueue->nitems--;
+	pthreadMutexUnlock(&wqueue->lock);
+
+	pf->xcmd = xcmd;
+	pf->fetched = false;
+	/* prefetched chunk is not charged to the current session */
+	gclient = MY_CLIENT_PER_THREAD;
+	MY_CLIENT_PER_THREAD = NULL;
+	pf->s_chunk = __gpuservPrefetchKdsSource(xcmd);
+	MY_CLIENT_PER_THREAD = gclient;
+	return;
+skip:
+	pthreadMutexUnlock(&wqueue->lock);
+}
+
+/*
+ * gpuservClaimPrefetchedKds
+ *
+ * It returns the buffer of kds_src already loaded by the prefetch, if any.
+ */
+static gpuMemChunk *
+gpuservClaimPrefetchedKds(XpuCommand *xcmd,
+						  uint32_t *p_npages_direct_read,
+						  uint32_t *p_npages_vfs_read)
+{
+	gpuServPrefetchState *pf = &MY_PREFETCH_PER_THREAD;
+	gpuMemChunk	   *chunk = NULL;
+	CUresult		rc;
 
-		sz = KDS_HEAD_LENGTH(kds_dst_head) + PGSTROM_CHUNK_SIZE;
-		d_chunk = gpuMemAllocManaged(sz);
-		if (!d_chunk)
+	if (pf->xcmd != xcmd)
+		return NULL;
+	if (pf->s_chunk)
+	{
+		rc = cuEventSynchronize(MY_COPY_EVENT_PER_THREAD);
+		if (rc != CUDA_SUCCESS || pf->error_code_async != 0)
 		{
-			gpuClientFatal(gclient, "failed on gpuMemAllocManaged(%lu)", sz);
-			goto bailout;
+			__gsDebug("prefetch of kds_src failed (%s, error_code=%u), retry\n",
+					  cuStrError(rc), pf->error_code_async);
+			gpuMemFree(pf->s_chunk);
 		}
-		kds_dst = (kern_data_store *)d_chunk->m_devptr;
-		memcpy(kds_dst, kds_dst_head, KDS_HEAD_LENGTH(kds_dst_head));
-		kds_dst->length = sz;
-		if (kds_dst_nitems >= kds_dst_nrooms)
+		else
 		{
-			kern_data_store	**kds_dst_temp;
-			gpuMemChunk		**d_chunk_temp;
-
-			kds_dst_nrooms = 2 * kds_dst_nrooms + 10;
-			kds_dst_temp = alloca(sizeof(kern_data_store *) * kds_dst_nrooms);
-			d_chunk_temp = alloca(sizeof(gpuMemChunk *) * kds_dst_nrooms);
-			if (kds_dst_nitems > 0)
-			{
-				memcpy(kds_dst_temp, kds_dst_array,
-					   sizeof(kern_data_store *) * kds_dst_nitems);
-				memcpy(d_chunk_temp, d_chunk_array,
-					   sizeof(gpuMemChunk *) * kds_dst_nitems);
-			}
-			kds_dst_array = kds_dst_temp;
-			d_chunk_array = d_chunk_temp;
+			chunk = pf->s_chunk;
+			*p_npages_direct_read = pf->npages_direct_read;
+			*p_npages_vfs_read = pf->npages_vfs_read;
 		}
-		kds_dst_array[kds_dst_nitems] = kds_dst;
-		d_chunk_array[kds_dst_nitems] = d_chunk;
-		kds_dst_nitems++;
 	}
+	memset(pf, 0, sizeof(gpuServPrefetchState));
+	return chunk;
+}
 
-	/*
-	 * Launch kernel
-	 */
-	kern_args[0] = &gclient->session;
-	kern_args[1] = &kgtask;
-	kern_args[2] = &m_kmrels;
-	kern_args[3] = &m_kds_src;
-	kern_args[4] = &m_kds_extra;
-	kern_args[5] = &kds_dst;
+/*
+ * gpuservReleasePrefetchedKds
+ *
+ * It releases the buffer of kds_src, if the command has been completed
+ * without claim (e.g, the client already closed the connection).
+ */
+static void
+gpuservReleasePrefetchedKds(XpuCommand *xcmd)
+{
+	gpuServPrefetchState *pf = &MY_PREFETCH_PER_THREAD;
 
-	rc = cuLaunchKernel(f_kern_gpuscan,
-						grid_sz, 1, 1,
-						block_sz, 1, 1,
-						shmem_dynamic_sz,
-						MY_STREAM_PER_THREAD,
-						kern_args,
-						NULL);
-	if (rc != CUDA_SUCCESS)
+	if (pf->xcmd != xcmd)
+		return;
+	if (pf->s_chunk)
 	{
-		gpuClientFatal(gclient, "failed on cuLaunchKernel: %s", cuStrError(rc));
-		goto bailout;
+		cuEventSynchronize(MY_COPY_EVENT_PER_THREAD);
+		gpuMemFree(pf->s_chunk);
 	}
+	memset(pf, 0, sizeof(gpuServPrefetchState));
+}
 
-	rc = cuEventRecord(MY_EVENT_PER_THREAD, MY_STREAM_PER_THREAD);
+/* ----------------------------------------------------------------
+ *
+ * gpuservHandleGpuTaskExec
+ *
+ * ----------------------------------------------------------------
+ */
+
+/*
+ * Kernel graph cache
+ *
+ * Every chunk launches kern_gpujoin_main with the same configuration;
+ * only the kernel arguments are different. So, we capture the launch as
+ * a CUDA graph, then update the parameters of its kernel node for each
+ * chunk, to reduce the launch overhead for many small chunks (GpuCache,
+ * small record batches of Arrow files, ...).
+ * An executable graph cannot be launched concurrently by multiple threads,
+ * so the cache is per-thread and keyed by the launch configuration; not
+ * per-session, because commands of a session are processed by multiple
+ * workers concurrently.
+ */
+#define GPUSERV_KERNEL_GRAPH_NSLOTS		8
+
+typedef struct
+{
+	CUfunction		f_kernel;
+	unsigned int	grid_sz;
+	unsigned int	block_sz;
+	unsigned int	shmem_sz;
+	uint64_t		last_used;
+	CUgraph			graph;
+	CUgraphNode		node;
+	CUgraphExec		graph_exec;
+} gpuKernelGraphCache;
+
+static __thread gpuKernelGraphCache	MY_KERNEL_GRAPHS_PER_THREAD[GPUSERV_KERNEL_GRAPH_NSLOTS];
+static __thread uint64_t	MY_KERNEL_GRAPHS_CLOCK = 0;
+
+static void
+__gpuservReleaseKernelGraph(gpuKernelGraphCache *kgraph)
+{
+	if (kgraph->graph_exec)
+		cuGraphExecDestroy(kgraph->graph_exec);
+	if (kgraph->graph)
+		cuGraphDestroy(kgraph->graph);
+	memset(kgraph, 0, sizeof(gpuKernelGraphCache));
+}
+
+static void
+gpuservReleaseKernelGraphs(void)
+{
+	for (int i=0; i < GPUSERV_KERNEL_GRAPH_NSLOTS; i++)
+		__gpuservReleaseKernelGraph(&MY_KERNEL_GRAPHS_PER_THREAD[i]);
+}
+
+/*
+ * gpuservLaunchKernelGraph
+ *
+ * It launches the kernel using the cached graph, or constructs a new one.
+ * If CUDA graph is not available for some reasons, it falls back to the
+ * regular cuLaunchKernel.
+ */
+static CUresult
+gpuservLaunchKernelGraph(CUfunction f_kernel,
+						 unsigned int grid_sz,
+						 unsigned int block_sz,
+						 unsigned int shmem_sz,
+						 void **kern_args)
+{
+	gpuKernelGraphCache *kgraph = NULL;
+	CUDA_KERNEL_NODE_PARAMS params;
+	CUresult	rc;
+
+	memset(&params, 0, sizeof(CUDA_KERNEL_NODE_PARAMS));
+	params.func = f_kernel;
+	params.gridDimX = grid_sz;
+	params.gridDimY = 1;
+	params.gridDimZ = 1;
+	params.blockDimX = block_sz;
+	params.blockDimY = 1;
+	params.blockDimZ = 1;
+	params.sharedMemBytes = shmem_sz;
+	params.kernelParams = kern_args;
+
+	for (int i=0; i < GPUSERV_KERNEL_GRAPH_NSLOTS; i++)
+	{
+		gpuKernelGraphCache *curr = &MY_KERNEL_GRAPHS_PER_THREAD[i];
+
+		if (curr->graph_exec &&
+			curr->f_kernel == f_kernel &&
+			curr->grid_sz  == grid_sz &&
+			curr->block_sz == block_sz &&
+			curr->shmem_sz == shmem_sz)
+		{
+			rc = cuGraphExecKernelNodeSetParams(curr->graph_exec,
+												curr->node,
+												&params);
+			if (rc != CUDA_SUCCESS)
+			{
+				__gsDebug("failed on cuGraphExecKernelNodeSetParams: %s",
+						  cuStrError(rc));
+				__gpuservReleaseKernelGraph(curr);
+				goto fallback;
+			}
+			kgraph = curr;
+			goto launch;
+		}
+		/* choose the least recently used slot for replacement */
+		if (!kgraph || curr->last_used < kgraph->last_used)
+			kgraph = curr;
+	}
+	/* construct a new kernel graph */
+	__gpuservReleaseKernelGraph(kgraph);
+	rc = cuGraphCreate(&kgraph->graph, 0);
 	if (rc != CUDA_SUCCESS)
 	{
-		gpuClientFatal(gclient, "failed on cuEventRecord: %s", cuStrError(rc));
-		goto bailout;
+		__gsDebug("failed on cuGraphCreate: %s", cuStrError(rc));
+		goto fallback;
 	}
-
-	/* point of synchronization */
-	rc = cuEventSynchronize(MY_EVENT_PER_THREAD);
+	rc = cuGraphAddKernelNode(&kgraph->node, kgraph->graph, NULL, 0, &params);
 	if (rc != CUDA_SUCCESS)
 	{
-		gpuClientFatal(gclient, "failed on cuEventSynchronize: %s", cuStrError(rc));
-		goto bailout;
+		__gsDebug("failed on cuGraphAddKernelNode: %s", cuStrError(rc));
+		__gpuservReleaseKernelGraph(kgraph);
+		goto fallback;
 	}
-	/* unlock kds_final buffer */
-	if (kds_final_locked)
+	rc = cuGraphInstantiateWithFlags(&kgraph->graph_exec, kgraph->graph, 0);
+	if (rc != CUDA_SUCCESS)
 	{
-		pthreadRWLockUnlock(&gq_buf->m_kds_final_rwlock);
-		kds_final_locked = false;
+		__gsDebug("failed on cuGraphInstantiateWithFlags: %s", cuStrError(rc));
+		kgraph->graph_exec = NULL;
+		__gpuservReleaseKernelGraph(kgraph);
+		goto fallback;
 	}
+	kgraph->f_kernel = f_kernel;
+	kgraph->grid_sz  = grid_sz;
+	kgraph->block_sz = block_sz;
+	kgraph->shmem_sz = shmem_sz;
+launch:
+	kgraph->last_used = ++MY_KERNEL_GRAPHS_CLOCK;
+	rc = cuGraphLaunch(kgraph->graph_exec, MY_STREAM_PER_THREAD);
+	if (rc == CUDA_SUCCESS)
+		return CUDA_SUCCESS;
+	__gsDebug("failed on cuGraphLaunch: %s", cuStrError(rc));
+	__gpuservReleaseKernelGraph(kgraph);
+fallback:
+	return cuLaunchKernel(f_kernel,
+						  grid_sz, 1, 1,
+						  block_sz, 1, 1,
+						  shmem_sz,
+						  MY_STREAM_PER_THREAD,
+						  kern_args,
+						  NULL);
+}
+/*
+ * Online tuner of the grid size
+ *
+ * gpuOptimalBlockSize() determines the grid size by the occupancy only,
+ * however, kernels that are bound by registers or stack (e.g, GiST-join,
+ * JSONB-heavy expressions) often run faster with smaller grid.
+ * The tuner tries 1/1, 1/2, 1/4 and 1/8 of the occupancy-based grid size
+ * for GPUSERV_GRID_TUNER_NSAMPLES chunks each, then picks up the one with
+ * the least elapsed time per rows. The cost of the chosen one is updated
+ * by the moving average, so the tuner switches to another candidate if the
+ * workload changes. A larger grid is never tried, because blocks beyond the
+ * occupancy do not run concurrently.
+ * It is per session, because the kernel variant (scan, join depth, preagg)
+ * is decided by the session, and chunks of a session are processed by
+ * the multiple workers concurrently.
+ */
+static bool		pgstrom_gpu_grid_size_tuning;		/* GUC */
 
-	/* status check */
-	if (kgtask->kerror.errcode == ERRCODE_STROM_SUCCESS)
-	{
-		XpuCommand *resp;
-		size_t		resp_sz;
+#define GPUSERV_GRID_TUNER_NSAMPLES		3
+#define GPUSERV_GRID_TUNER_MIN_GRID_SZ	16
+
+static int
+gpuservChooseGridSize(gpuClient *gclient, int grid_sz, int *p_grid_cand)
+{
+	gpuGridSizeTuner *tuner = &gclient->grid_tuner;
+	int			cand = 0;
 
-		if (kgtask->suspend_count > 0)
+	if (!pgstrom_gpu_grid_size_tuning ||
+		grid_sz < GPUSERV_GRID_TUNER_MIN_GRID_SZ)
+	{
+		*p_grid_cand = -1;
+		return grid_sz;
+	}
+	pthreadMutexLock(&tuner->lock);
+	for (int i=1; i < GPUSERV_GRID_TUNER_NCANDS; i++)
+	{
+		if (tuner->nsamples[cand] < GPUSERV_GRID_TUNER_NSAMPLES)
 		{
-			if (gpuServiceGoingTerminate())
-			{
-				gpuClientFatal(gclient, "GpuService is going to terminate during GpuScan kernel suspend/resume");
-				goto bailout;
-			}
-			/* restore warp context from the previous state */
-			kgtask->resume_context = true;
-			kgtask->suspend_count = 0;
-			__gsDebug("suspend / resume happen\n");
-			if (kds_final_locked)
-				pthreadRWLockUnlock(&gq_buf->m_kds_final_rwlock);
-			goto resume_kernel;
+			/* exploration phase; less sampled one first */
+			if (tuner->nsamples[i] < tuner->nsamples[cand])
+				cand = i;
 		}
-		/* send back status and kds_dst */
-		resp_sz = MAXALIGN(offsetof(XpuCommand,
-									u.results.stats[num_inner_rels]));
-		resp = alloca(resp_sz);
-		memset(resp, 0, resp_sz);
-		resp->magic = XpuCommandMagicNumber;
-		resp->tag   = XpuCommandTag__Success;
-		resp->u.results.chunks_nitems = kds_dst_nitems;
-		resp->u.results.chunks_offset = resp_sz;
-		resp->u.results.npages_direct_read = npages_direct_read;
-		resp->u.results.npages_vfs_read = npages_vfs_read;
-		resp->u.results.nitems_raw = kgtask->nitems_raw;
-		resp->u.results.nitems_in  = kgtask->nitems_in;
-		resp->u.results.nitems_out = kgtask->nitems_out;
-		resp->u.results.num_rels = num_inner_rels;
-		for (int i=0; i < num_inner_rels; i++)
+		else if (tuner->nsamples[i] < GPUSERV_GRID_TUNER_NSAMPLES ||
+				 tuner->cost[i] < tuner->cost[cand])
 		{
-			resp->u.results.stats[i].nitems_gist = kgtask->stats[i].nitems_gist;
-			resp->u.results.stats[i].nitems_out  = kgtask->stats[i].nitems_out;
+			cand = i;
 		}
-		gpuClientWriteBack(gclient,
-						   resp, resp_sz,
-						   kds_dst_nitems, kds_dst_array);
 	}
-	else if (kgtask->kerror.errcode == ERRCODE_CPU_FALLBACK)
+	pthreadMutexUnlock(&tuner->lock);
+
+	*p_grid_cand = cand;
+	return Max(grid_sz >> cand, 1);
+}
+
+static void
+gpuservUpdateGridSizeTuner(gpuClient *gclient, int grid_cand,
+						   float elapsed_ms, uint64_t nitems)
+{
+	gpuGridSizeTuner *tuner = &gclient->grid_tuner;
+	double		cost = (double)elapsed_ms * 1000000.0 / (double)Max(nitems, 1);
+	uint32_t	nsamples;
+
+	Assert(grid_cand >= 0 && grid_cand < GPUSERV_GRID_TUNER_NCANDS);
+	pthreadMutexLock(&tuner->lock);
+	nsamples = tuner->nsamples[grid_cand];
+	if (nsamples < GPUSERV_GRID_TUNER_NSAMPLES)
 	{
-		kern_data_store *__kds_src = kds_src;
-		XpuCommand	resp;
+		tuner->cost[grid_cand] = (tuner->cost[grid_cand] * nsamples + cost) / (nsamples + 1);
+		tuner->nsamples[grid_cand] = nsamples + 1;
+	}
+	else
+	{
+		tuner->cost[grid_cand] = 0.75 * tuner->cost[grid_cand] + 0.25 * cost;
+	}
+	pthreadMutexUnlock(&tuner->lock);
+}
+
+static unsigned int
+__expand_gpupreagg_prepfunc_buffer(kern_session_info *session,
+								   int grid_sz, int block_sz,
+								   unsigned int __shmem_dynamic_sz,
+								   unsigned int shmem_dynamic_limit,
+								   unsigned int *p_groupby_prepfn_bufsz,
+								   unsigned int *p_groupby_prepfn_nbufs,
+								   unsigned int *p_groupby_local_nslots)
+{
+	unsigned int	shmem_dynamic_sz = TYPEALIGN(1024, __shmem_dynamic_sz);
+
+	if (session->groupby_prepfn_bufsz == 0 || shmem_dynamic_sz >= shmem_dynamic_limit)
+		goto no_prepfunc_buffer;
+
+	if (session->xpucode_groupby_keyhash &&
+		session->xpucode_groupby_keyload &&
+		session->xpucode_groupby_keycomp)
+	{
+		/* GROUP-BY */
+		int		num_buffers = 2 * session->groupby_ngroups_estimation + 100;
+		int		unitsz = session->groupby_prepfn_bufsz + 2 * sizeof(uint64_t);
+		int		num_slots = 0;
+		int		prepfn_usage;
 
 		/*
-		 * Send back the source buffer with XpuCommandTag__CPUFallback
-		 *
-		 * KDS_FORMAT_BLOCK and KDS_FORMAT_ARROW must be send back the
-		 * backend process from the GPU device buffer, because the original
-		 * kds_src does not have data contents itself.
-		 * For KDS_FORMAT_COLUMN, it is equivalent to the kernel buffer,
-		 * and its size tends to be large. So, CPU fallback uses regular
-		 * heap-scan instead.
+		 * If all the estimated groups fit the prepfn buffer, we also put
+		 * the local hash-slots (2 slots per buffer) next to the buffer, to
+		 * look up the hot groups without the global hash-slot lock.
 		 */
-		if (s_chunk)
+		if (shmem_dynamic_sz + unitsz * num_buffers > shmem_dynamic_limit)
+			num_buffers = (shmem_dynamic_limit - shmem_dynamic_sz) / unitsz;
+		if (num_buffers >= session->groupby_ngroups_estimation)
 		{
-			__kds_src = malloc(s_chunk->__length);
-			if (!__kds_src)
-			{
-				gpuClientELog(gclient, "out of memory for CPU fallback (sz=%lu)",
-							  s_chunk->__length);
-				goto bailout;
-			}
-			rc = cuMemcpyDtoH(__kds_src, s_chunk->m_devptr, s_chunk->__length);
-			if (rc != CUDA_SUCCESS)
+			num_slots = 2 * num_buffers;
+			prepfn_usage = unitsz * num_buffers;
+		}
+		else
+		{
+			num_buffers = 2 * session->groupby_ngroups_estimation + 100;
+			prepfn_usage = session->groupby_prepfn_bufsz * num_buffers;
+			if (shmem_dynamic_sz + prepfn_usage > shmem_dynamic_limit)
 			{
-				free(__kds_src);
-				gpuClientELog(gclient, "failed on cuMemcpyDtoH: %s", cuStrError(rc));
-				goto bailout;
+				/* adjust num_buffers, if too large */
+				num_buffers = (shmem_dynamic_limit -
+							   shmem_dynamic_sz) / session->groupby_prepfn_bufsz;
+				prepfn_usage = session->groupby_prepfn_bufsz * num_buffers;
 			}
 		}
-		memset(&resp, 0, sizeof(resp));
-		resp.magic = XpuCommandMagicNumber;
-		resp.tag   = XpuCommandTag__CPUFallback;
-		memcpy(&resp.u.fallback.error,
-			   &kgtask->kerror,
-			   sizeof(kern_errorbuf));
-		resp.u.fallback.npages_direct_read = npages_direct_read;
-		resp.u.fallback.npages_vfs_read = npages_vfs_read;
-		gpuClientWriteBack(gclient,
-						   &resp,
-						   offsetof(XpuCommand, u.fallback.kds_src),
-						   1, &__kds_src);
-		if (kds_src != __kds_src)
-			free(__kds_src);
+		Assert(shmem_dynamic_sz + prepfn_usage <= shmem_dynamic_limit);
+		if (num_buffers >= 32)
+		{
+			*p_groupby_prepfn_bufsz = session->groupby_prepfn_bufsz;
+			*p_groupby_prepfn_nbufs = num_buffers;
+			*p_groupby_local_nslots = num_slots;
+			return shmem_dynamic_sz + prepfn_usage;
+		}
 	}
-	else
+	else if (session->xpucode_groupby_actions)
 	{
-		/* send back error status */
-		__gpuClientELogRaw(gclient, &kgtask->kerror);
+		/* NO-GROUPS */
+		if (shmem_dynamic_sz + session->groupby_prepfn_bufsz <= shmem_dynamic_limit)
+		{
+			*p_groupby_prepfn_bufsz = session->groupby_prepfn_bufsz;
+			*p_groupby_prepfn_nbufs = 1;
+			*p_groupby_local_nslots = 0;
+			return shmem_dynamic_sz + session->groupby_prepfn_bufsz;
+		}
 	}
-bailout:
-	if (kds_final_locked)
-		pthreadRWLockUnlock(&gq_buf->m_kds_final_rwlock);
-	if (s_chunk)
-		gpuMemFree(s_chunk);
-	if (t_chunk)
-		gpuMemFree(t_chunk);
-	while (kds_dst_nitems > 0)
-		gpuMemFree(d_chunk_array[--kds_dst_nitems]);
-	if (gc_lmap)
-		gpuCachePutDeviceBuffer(gc_lmap);
+no_prepfunc_buffer:
+	*p_groupby_prepfn_bufsz = 0;
+	*p_groupby_prepfn_nbufs = 0;
+	*p_groupby_local_nslots = 0;
+	return __shmem_dynamic_sz;		/* unaligned original size */
 }
 
-/* ------------------------------------------------------------
- *
- * gpuservGpuCacheManager - GpuCache worker
+/*
+ * Device memory mode
  *
- * ------------------------------------------------------------
+ * The kds_src delivered by the backend process is kept in the managed
+ * memory, thus GPU kernel often stalls on page-faults at the first touch,
+ * and its bandwidth depends on the memory pressure. In the device memory
+ * mode, kds_src is copied to the raw device memory by explicit DMA, and
+ * kds_dst buffers (host code has to read its header) are prefetched to
+ * the device or host on demand, instead of the fault-driven migration.
  */
-static void *
-gpuservGpuCacheManager(void *__arg)
+static bool		pgstrom_gpu_mempool_device_mode;	/* GUC */
+
+static gpuMemChunk *
+gpuservCopyKdsSourceToDevice(kern_data_store *kds_src)
 {
-	gpuWorker  *gworker = (gpuWorker *)__arg;
-	gpuContext *gcontext = gworker->gcontext;
+	gpuMemChunk *chunk;
 	CUresult	rc;
 
-	rc = cuCtxSetCurrent(gcontext->cuda_context);
+	chunk = gpuMemAlloc(kds_src->length);
+	if (!chunk)
+	{
+		__gsDebug("no device memory for kds_src (sz=%lu), use managed memory",
+				  kds_src->length);
+		return NULL;
+	}
+	rc = cuMemcpyAsync(chunk->m_devptr,
+					   (CUdeviceptr)kds_src,
+					   kds_src->length,
+					   MY_STREAM_PER_THREAD);
 	if (rc != CUDA_SUCCESS)
-		__FATAL("failed on cuCtxSetCurrent: %s", cuStrError(rc));
-
-	GpuWorkerCurrentContext	= gcontext;
-	MY_DINDEX_PER_THREAD	= gcontext->cuda_dindex;
-	MY_DEVICE_PER_THREAD	= gcontext->cuda_device;
-	MY_CONTEXT_PER_THREAD	= gcontext->cuda_context;
-	MY_STREAM_PER_THREAD	= CU_STREAM_LEGACY;
-	MY_EVENT_PER_THREAD		= NULL;
-	pg_memory_barrier();
-
-	__gsDebug("GPU-%d GpuCache manager thread launched.",
-			  MY_DINDEX_PER_THREAD);
-	
-	gpucacheManagerEventLoop(gcontext->cuda_dindex,
-							 gcontext->cuda_context,
-							 gcontext->cuda_module);
-
-	/* delete gpuWorker from the gpuContext */
-	pthreadMutexLock(&gcontext->worker_lock);
-	dlist_delete(&gworker->chain);
-	pthreadMutexUnlock(&gcontext->worker_lock);
-	free(gworker);
+	{
+		__gsDebug("failed on cuMemcpyAsync: %s", cuStrError(rc));
+		gpuMemFree(chunk);
+		return NULL;
+	}
+	return chunk;
+}
 
-	__gsDebug("GPU-%d GpuCache manager terminated.",
-			  MY_DINDEX_PER_THREAD);
-	return NULL;
+static void
+gpuservPrefetchKdsDestToDevice(kern_data_store *kds_dst)
+{
+	(void)cuMemPrefetchAsync((CUdeviceptr)kds_dst,
+							 kds_dst->length,
+							 MY_DEVICE_PER_THREAD,
+							 MY_STREAM_PER_THREAD);
 }
 
-/* ----------------------------------------------------------------
- *
- * gpuservHandleGpuTaskFinal
+/*
+ * gpuservPrefetchKdsDestToHost
  *
- * ----------------------------------------------------------------
+ * It migrates the portion of kds_dst to be sent back over the socket.
+ * DMA to the result ring does not need page migration.
  */
 static void
-gpuservHandleGpuTaskFinal(gpuClient *gclient, XpuCommand *xcmd)
+gpuservPrefetchKdsDestToHost(gpuClient *gclient,
+							 int kds_nitems,
+							 kern_data_store **kds_array)
 {
-	kern_final_task *kfin = &xcmd->u.fin;
-	gpuQueryBuffer *gq_buf = gclient->gq_buf;
-	XpuCommand		resp;
-	kern_data_store	*kds_final = NULL;
-
-	memset(&resp, 0, sizeof(XpuCommand));
-	resp.magic = XpuCommandMagicNumber;
-	resp.tag   = XpuCommandTag__Success;
-	resp.u.results.chunks_offset = MAXALIGN(offsetof(XpuCommand, u.results.stats));
-	resp.u.results.chunks_nitems = 0;
-
-	if (kfin->final_this_device && gq_buf)
+	if (gclient->h_ring)
+		return;
+	for (int i=0; i < kds_nitems; i++)
 	{
-		/*
-		 * Is the outer-join-map written back to the host buffer?
-		 */
-		if (gq_buf->m_kmrels != 0UL &&
-			gq_buf->h_kmrels != NULL)
-		{
-			kern_multirels *d_kmrels = (kern_multirels *)gq_buf->m_kmrels;
-			kern_multirels *h_kmrels = (kern_multirels *)gq_buf->h_kmrels;
-
-			for (int i=0; i < d_kmrels->num_rels; i++)
-			{
-				kern_data_store *kds = KERN_MULTIRELS_INNER_KDS(h_kmrels, i);
-				bool   *d_ojmap = KERN_MULTIRELS_OUTER_JOIN_MAP(d_kmrels, i);
-				bool   *h_ojmap = KERN_MULTIRELS_OUTER_JOIN_MAP(h_kmrels, i);
-
-				if (d_ojmap && h_ojmap)
-				{
-					for (uint32_t j=0; j < kds->nitems; j++)
-						h_ojmap[j] |= d_ojmap[j];
-					resp.u.results.final_this_device = true;
-				}
-			}
-		}
+		kern_data_store *kds = kds_array[i];
+		size_t		head_sz = (KDS_HEAD_LENGTH(kds) +
+							   sizeof(uint64_t) * (kds->hash_nslots +
+												   kds->nitems));
+		size_t		tail_sz = Min(kds->__usage64, kds->length - head_sz);
 
-		/*
-		 * Is the GpuPreAgg final buffer written back?
-		 */
-		if (gq_buf->m_kds_final != 0UL)
+		/* packed by __gpuservColumnarDestChunks; no holes */
+		if (kds->format == KDS_FORMAT_COLUMN)
 		{
-			kds_final = (kern_data_store *)gq_buf->m_kds_final;
-			resp.u.results.chunks_nitems = 1;
-			resp.u.results.final_this_device = true;
+			(void)cuMemPrefetchAsync((CUdeviceptr)kds,
+									 kds->length,
+									 CU_DEVICE_CPU,
+									 MY_STREAM_PER_THREAD);
+			continue;
 		}
+		(void)cuMemPrefetchAsync((CUdeviceptr)kds,
+								 Min(head_sz, kds->length),
+								 CU_DEVICE_CPU,
+								 MY_STREAM_PER_THREAD);
+		if (tail_sz > 0)
+			(void)cuMemPrefetchAsync((CUdeviceptr)kds + kds->length - tail_sz,
+									 tail_sz,
+									 CU_DEVICE_CPU,
+									 MY_STREAM_PER_THREAD);
 	}
-	resp.u.results.final_plan_node = kfin->final_plan_node;
-
-	gpuClientWriteBack(gclient, &resp,
-					   resp.u.results.chunks_offset,
-					   resp.u.results.chunks_nitems,
-					   &kds_final);
+	(void)cuStreamSynchronize(MY_STREAM_PER_THREAD);
 }
 
 /*
- * gpuservGpuWorkerMain -- actual worker
+ * __gpuservTopKSelection
+ *
+ * It reduces the destination buffers of GpuScan/GpuJoin to the rows whose
+ * leading sort key is in the top-N of the chunk, using the radix-select.
+ * Sort + Limit on the backend side merges the survivors of the chunks, so
+ * the rows equivalent to the N-th key are kept as is.
  */
-static void *
-gpuservGpuWorkerMain(void *__arg)
+static bool
+__gpuservTopKSelection(gpuClient *gclient,
+					   int kds_dst_nitems,
+					   kern_data_store **kds_dst_array,
+					   gpuMemChunk **d_chunk_array)
 {
-	gpuWorker  *gworker = (gpuWorker *)__arg;
-	gpuContext *gcontext = gworker->gcontext;
-	gpuClient  *gclient;
-	CUstream	cuda_stream;
-	CUevent		cuda_event;
+	gpuContext *gcontext = gclient->gcontext;
+	kern_session_info *session = gclient->session;
+	CUfunction	f_histogram;
+	CUfunction	f_compact;
 	CUresult	rc;
+	int			grid_sz;
+	int			block_sz;
+	void	   *kern_args[4];
 
-	rc = cuCtxSetCurrent(gcontext->cuda_context);
-	if (rc != CUDA_SUCCESS)
-		__FATAL("failed on cuCtxSetCurrent: %s", cuStrError(rc));
-	rc = cuStreamCreate(&cuda_stream, CU_STREAM_NON_BLOCKING);
+	rc = cuModuleGetFunction(&f_histogram,
+							 gcontext->cuda_module,
+							 "kern_gpuscan_topk_histogram");
+	if (rc == CUDA_SUCCESS)
+		rc = cuModuleGetFunction(&f_compact,
+								 gcontext->cuda_module,
+								 "kern_gpuscan_topk_compact");
 	if (rc != CUDA_SUCCESS)
-		 __FATAL("failed on cuStreamCreate: %s", cuStrError(rc));
-	rc = cuEventCreate(&cuda_event, CU_EVENT_BLOCKING_SYNC);
+	{
+		gpuClientELog(gclient, "failed on cuModuleGetFunction: %s",
+					  cuStrError(rc));
+		return false;
+	}
+	rc = gpuOptimalBlockSize(&grid_sz,
+							 &block_sz,
+							 f_histogram, 0);
 	if (rc != CUDA_SUCCESS)
-		__FATAL("failed on cuEventCreate: %s", cuStrError(rc));
-
-	GpuWorkerCurrentContext = gcontext;
-	MY_DINDEX_PER_THREAD	= gcontext->cuda_dindex;
-	MY_DEVICE_PER_THREAD	= gcontext->cuda_device;
-	MY_CONTEXT_PER_THREAD	= gcontext->cuda_context;
-	MY_STREAM_PER_THREAD	= cuda_stream;
-	MY_EVENT_PER_THREAD		= cuda_event;
-	pg_memory_barrier();
+	{
+		gpuClientELog(gclient, "failed on gpuOptimalBlockSize: %s",
+					  cuStrError(rc));
+		return false;
+	}
 
-	__gsDebug("GPU-%d worker thread launched\n", MY_DINDEX_PER_THREAD);
-	
-	pthreadMutexLock(&gcontext->lock);
-	while (!gpuServiceGoingTerminate() && !gworker->termination)
+	for (int i=0; i < kds_dst_nitems; i++)
 	{
-		XpuCommand *xcmd;
-		dlist_node *dnode;
+		kern_data_store *kds_src = kds_dst_array[i];
+		kern_data_store *kds_new;
+		kern_gputopk_buffer *topk;
+		gpuMemChunk *k_chunk;
+		gpuMemChunk *n_chunk;
+		uint32_t	remain = session->topk_nitems;
+		size_t		sz;
 
-		if (!dlist_is_empty(&gcontext->command_list))
+		if (kds_src->nitems <= session->topk_nitems)
+			continue;
+		sz = offsetof(kern_gputopk_buffer, keys[kds_src->nitems]);
+		k_chunk = gpuMemAllocManaged(sz);
+		if (!k_chunk)
 		{
-			dnode = dlist_pop_head_node(&gcontext->command_list);
-			xcmd = dlist_container(XpuCommand, chain, dnode);
-			pthreadMutexUnlock(&gcontext->lock);
+			gpuClientELog(gclient, "failed on gpuMemAllocManaged(%lu)", sz);
+			return false;
+		}
+		topk = (kern_gputopk_buffer *)k_chunk->m_devptr;
+		memset(topk, 0, offsetof(kern_gputopk_buffer, keys));
+		topk->sortkey_resno = session->sortkey_resno;
+		topk->sortkey_flags = session->sortkey_flags;
+
+		/* determine the N-th key, 8bits per pass from the MSB */
+		for (int shift=56; shift >= 0; shift -= 8)
+		{
+			uint32_t	count = 0;
+			int			digit;
+
+			topk->topk_shift = shift;
+			memset(topk->histogram, 0, sizeof(topk->histogram));
+			kern_args[0] = &kds_src;
+			kern_args[1] = &topk;
+			rc = cuLaunchKernel(f_histogram,
+								grid_sz, 1, 1,
+								block_sz, 1, 1,
+								0,
+								MY_STREAM_PER_THREAD,
+								kern_args,
+								NULL);
+			if (rc == CUDA_SUCCESS)
+				rc = cuStreamSynchronize(MY_STREAM_PER_THREAD);
+			if (rc != CUDA_SUCCESS)
+			{
+				gpuClientELog(gclient, "failed on GPU Top-N histogram: %s",
+							  cuStrError(rc));
+				gpuMemFree(k_chunk);
+				return false;
+			}
+			for (digit=0; digit < 255; digit++)
+			{
+				if (count + topk->histogram[digit] >= remain)
+					break;
+				count += topk->histogram[digit];
+			}
+			remain -= count;
+			topk->topk_prefix |= ((uint64_t)digit << shift);
+		}
+
+		/* move the survivor rows to the new destination buffer */
+		sz = kds_src->length;
+		n_chunk = gpuMemAllocManaged(sz);
+		if (!n_chunk)
+		{
+			gpuClientELog(gclient, "failed on gpuMemAllocManaged(%lu)", sz);
+			gpuMemFree(k_chunk);
+			return false;
+		}
+		kds_new = (kern_data_store *)n_chunk->m_devptr;
+		memcpy(kds_new, kds_src, KDS_HEAD_LENGTH(kds_src));
+		kds_new->nitems = 0;
+		kds_new->__usage64 = 0;
+
+		kern_args[0] = &kds_src;
+		kern_args[1] = &kds_new;
+		kern_args[2] = &topk;
+		rc = cuLaunchKernel(f_compact,
+							grid_sz, 1, 1,
+							block_sz, 1, 1,
+							0,
+							MY_STREAM_PER_THREAD,
+							kern_args,
+							NULL);
+		if (rc == CUDA_SUCCESS)
+			rc = cuStreamSynchronize(MY_STREAM_PER_THREAD);
+		gpuMemFree(k_chunk);
+		if (rc != CUDA_SUCCESS)
+		{
+			gpuClientELog(gclient, "failed on GPU Top-N compaction: %s",
+						  cuStrError(rc));
+			gpuMemFree(n_chunk);
+			return false;
+		}
+		gpuMemFree(d_chunk_array[i]);
+		kds_dst_array[i] = kds_new;
+		d_chunk_array[i] = n_chunk;
+	}
+	return true;
+}
+
+/*
+ * __gpuservSortDestChunks
+ *
+ * It sorts the row-index of the destination buffers by the leading sort
+ * key, for the backend to merge the sorted chunks (GPU Sort).
+ */
+static bool
+__gpuservSortDestChunks(gpuClient *gclient,
+						int kds_dst_nitems,
+						kern_data_store **kds_dst_array)
+{
+	gpuContext *gcontext = gclient->gcontext;
+	kern_session_info *session = gclient->session;
+	CUfunction	f_setup;
+	CUfunction	f_count;
+	CUfunction	f_scatter;
+	CUfunction	f_finish;
+	CUresult	rc;
+	int			grid_sz;
+	int			block_sz;
+	void	   *kern_args[4];
+
+	rc = cuModuleGetFunction(&f_setup,
+							 gcontext->cuda_module,
+							 "kern_gpuscan_sort_setup");
+	if (rc == CUDA_SUCCESS)
+		rc = cuModuleGetFunction(&f_count,
+								 gcontext->cuda_module,
+								 "kern_gpuscan_sort_count");
+	if (rc == CUDA_SUCCESS)
+		rc = cuModuleGetFunction(&f_scatter,
+								 gcontext->cuda_module,
+								 "kern_gpuscan_sort_scatter");
+	if (rc == CUDA_SUCCESS)
+		rc = cuModuleGetFunction(&f_finish,
+								 gcontext->cuda_module,
+								 "kern_gpuscan_sort_finish");
+	if (rc != CUDA_SUCCESS)
+	{
+		gpuClientELog(gclient, "failed on cuModuleGetFunction: %s",
+					  cuStrError(rc));
+		return false;
+	}
+	rc = gpuOptimalBlockSize(&grid_sz,
+							 &block_sz,
+							 f_scatter, 0);
+	if (rc != CUDA_SUCCESS)
+	{
+		gpuClientELog(gclient, "failed on gpuOptimalBlockSize: %s",
+					  cuStrError(rc));
+		return false;
+	}
+	grid_sz = Min(grid_sz, GPUSORT_MAX_NBLOCKS);
+
+	for (int i=0; i < kds_dst_nitems; i++)
+	{
+		kern_data_store *kds = kds_dst_array[i];
+		kern_gpusort_buffer *gsort;
+		gpuMemChunk *g_chunk;
+		uint64_t	mask;
+		int			curr = 0;
+		int			nkeys = (session->sortkey2_resno > 0 ? 2 : 1);
+		size_t		sz;
+
+		if (kds->nitems <= 1)
+			continue;
+		sz = offsetof(kern_gpusort_buffer, data[4 * (size_t)kds->nitems]);
+		g_chunk = gpuMemAllocManaged(sz);
+		if (!g_chunk)
+		{
+			gpuClientELog(gclient, "failed on gpuMemAllocManaged(%lu)", sz);
+			return false;
+		}
+		gsort = (kern_gpusort_buffer *)g_chunk->m_devptr;
+		memset(gsort, 0, offsetof(kern_gpusort_buffer, data));
+		gsort->nitems = kds->nitems;
+		gsort->nblocks = Min(grid_sz, (kds->nitems + block_sz - 1) / block_sz);
+		gsort->tile_sz = (kds->nitems + gsort->nblocks - 1) / gsort->nblocks;
+
+		/* the second key first, then the leading key */
+		for (int k=nkeys-1; k >= 0; k--)
+		{
+			gsort->sortkey_resno = (k == 0
+									? session->sortkey_resno
+									: session->sortkey2_resno);
+			gsort->sortkey_flags = (k == 0
+									? session->sortkey_flags
+									: session->sortkey2_flags);
+			gsort->sort_pass = (nkeys - 1 - k);
+			gsort->key_and_mask = ULONG_MAX;
+			gsort->key_or_mask = 0UL;
+			gsort->null_order_count = 0;
+
+			kern_args[0] = &kds;
+			kern_args[1] = &gsort;
+			kern_args[2] = &curr;
+			rc = cuLaunchKernel(f_setup,
+								grid_sz, 1, 1,
+								block_sz, 1, 1,
+								0,
+								MY_STREAM_PER_THREAD,
+								kern_args,
+								NULL);
+			if (rc == CUDA_SUCCESS)
+				rc = cuStreamSynchronize(MY_STREAM_PER_THREAD);
+			if (rc != CUDA_SUCCESS)
+				goto error;
 
-			gclient = xcmd->priv;
 			/*
-			 * MEMO: If the least bit of gclient->refcnt is not set,
-			 * it means the gpu-client connection is no longer available.
-			 * (already closed, or error detected.)
+			 * LSD radix sort, but skips the bits common for all the keys.
+			 * The NULL-ordering bit is the most significant one.
 			 */
-			if ((pg_atomic_read_u32(&gclient->refcnt) & 1) == 1)
+			mask = (gsort->key_or_mask & ~gsort->key_and_mask);
+			for (int bit=0; bit <= 64; bit++)
 			{
-				switch (xcmd->tag)
-				{
-					case XpuCommandTag__OpenSession:
-						if (gpuservHandleOpenSession(gclient, xcmd))
-							xcmd = NULL;	/* session information shall be kept until
-											 * end of the session. */
-						break;
-					case XpuCommandTag__XpuTaskExec:
-					case XpuCommandTag__XpuTaskExecGpuCache:
-						gpuservHandleGpuTaskExec(gclient, xcmd);
-						break;
-					case XpuCommandTag__XpuTaskFinal:
-						gpuservHandleGpuTaskFinal(gclient, xcmd);
-						break;
-					default:
-						gpuClientELog(gclient, "unknown XPU command (%d)",
-									  (int)xcmd->tag);
-						break;
-				}
+				if (bit < 64
+					? (mask & (1UL << bit)) == 0
+					: (gsort->null_order_count == 0 ||
+					   gsort->null_order_count == gsort->nitems))
+					continue;
+				kern_args[0] = &gsort;
+				kern_args[1] = &bit;
+				kern_args[2] = &curr;
+				rc = cuLaunchKernel(f_count,
+									gsort->nblocks, 1, 1,
+									block_sz, 1, 1,
+									0,
+									MY_STREAM_PER_THREAD,
+									kern_args,
+									NULL);
+				if (rc == CUDA_SUCCESS)
+					rc = cuLaunchKernel(f_scatter,
+										gsort->nblocks, 1, 1,
+										block_sz, 1, 1,
+										0,
+										MY_STREAM_PER_THREAD,
+										kern_args,
+										NULL);
+				if (rc != CUDA_SUCCESS)
+					goto error;
+				curr = 1 - curr;
 			}
+		}
+		kern_args[0] = &kds;
+		kern_args[1] = &gsort;
+		kern_args[2] = &curr;
+		rc = cuLaunchKernel(f_finish,
+							grid_sz, 1, 1,
+							block_sz, 1, 1,
+							0,
+							MY_STREAM_PER_THREAD,
+							kern_args,
+							NULL);
+		if (rc == CUDA_SUCCESS)
+			rc = cuStreamSynchronize(MY_STREAM_PER_THREAD);
+		if (rc != CUDA_SUCCESS)
+			goto error;
+		gpuMemFree(g_chunk);
+		continue;
+	error:
+		gpuClientELog(gclient, "failed on GPU Sort: %s", cuStrError(rc));
+		gpuMemFree(g_chunk);
+		return false;
+	}
+	return true;
+}
 
-			if (xcmd)
-				__gpuServiceFreeCommand(xcmd);
-			gpuClientPut(gclient, false);
-			pthreadMutexLock(&gcontext->lock);
+/*
+ * __gpuservColumnarDestChunks
+ *
+ * It packs the destination buffers into KDS_FORMAT_COLUMN, if all the
+ * result columns are fixed-length and by-value. It eliminates the tuple
+ * header and the row-index of each row, so narrow projections send back
+ * much less bytes, and the backend fetches the values without deforming
+ * the heap-tuples.
+ */
+static bool
+__gpuservColumnarDestChunks(gpuClient *gclient,
+							int kds_dst_nitems,
+							kern_data_store **kds_dst_array,
+							gpuMemChunk **d_chunk_array)
+{
+	gpuContext *gcontext = gclient->gcontext;
+	CUfunction	f_pack;
+	CUresult	rc;
+	int			grid_sz;
+	int			block_sz;
+	void	   *kern_args[2];
+
+	rc = cuModuleGetFunction(&f_pack,
+							 gcontext->cuda_module,
+							 "kern_gpuscan_columnar_pack");
+	if (rc != CUDA_SUCCESS)
+	{
+		gpuClientELog(gclient, "failed on cuModuleGetFunction: %s",
+					  cuStrError(rc));
+		return false;
+	}
+	rc = gpuOptimalBlockSize(&grid_sz,
+							 &block_sz,
+							 f_pack, 0);
+	if (rc != CUDA_SUCCESS)
+	{
+		gpuClientELog(gclient, "failed on gpuOptimalBlockSize: %s",
+					  cuStrError(rc));
+		return false;
+	}
+
+	for (int i=0; i < kds_dst_nitems; i++)
+	{
+		kern_data_store *kds_src = kds_dst_array[i];
+		kern_data_store *kds_new;
+		gpuMemChunk *n_chunk;
+		size_t		head_sz = KDS_HEAD_LENGTH(kds_src);
+		size_t		sz = head_sz;
+
+		if (kds_src->format != KDS_FORMAT_ROW || kds_src->nitems == 0)
+			continue;
+		for (int j=0; j < kds_src->ncols; j++)
+		{
+			const kern_colmeta *cmeta = &kds_src->colmeta[j];
+
+			if (cmeta->attlen <= 0 || !cmeta->attbyval)
+			{
+				gpuClientELog(gclient, "unable to pack variable-length column '%s'",
+							  cmeta->attname);
+				return false;
+			}
+			sz += (MAXALIGN(sizeof(uint32_t) * ((kds_src->nitems + 31) / 32)) +
+				   MAXALIGN(cmeta->attlen * kds_src->nitems));
 		}
-		else if (!pthreadCondWaitTimeout(&gcontext->cond,
-										 &gcontext->lock,
-										 5000))
+		n_chunk = gpuMemAllocManaged(sz);
+		if (!n_chunk)
 		{
-			pthreadMutexUnlock(&gcontext->lock);
-			/* maintenance works */
-			gpuMemoryPoolMaintenance(gcontext);
-			pthreadMutexLock(&gcontext->lock);
+			gpuClientELog(gclient, "failed on gpuMemAllocManaged(%lu)", sz);
+			return false;
+		}
+		kds_new = (kern_data_store *)n_chunk->m_devptr;
+		memcpy(kds_new, kds_src, head_sz);
+		kds_new->length = sz;
+		kds_new->format = KDS_FORMAT_COLUMN;
+		kds_new->__usage64 = 0;
+		kds_new->column_nrooms = kds_src->nitems;
+		sz = head_sz;
+		for (int j=0; j < kds_new->ncols; j++)
+		{
+			kern_colmeta *cmeta = &kds_new->colmeta[j];
+			size_t		len;
+
+			len = MAXALIGN(sizeof(uint32_t) * ((kds_src->nitems + 31) / 32));
+			cmeta->nullmap_offset = __kds_packed(sz);
+			cmeta->nullmap_length = __kds_packed(len);
+			sz += len;
+			len = MAXALIGN(cmeta->attlen * kds_src->nitems);
+			cmeta->values_offset = __kds_packed(sz);
+			cmeta->values_length = __kds_packed(len);
+			sz += len;
+		}
+		Assert(sz == kds_new->length);
+
+		kern_args[0] = &kds_src;
+		kern_args[1] = &kds_new;
+		rc = cuMemsetD8Async((CUdeviceptr)kds_new + head_sz, 0,
+							 sz - head_sz,
+							 MY_STREAM_PER_THREAD);
+		if (rc == CUDA_SUCCESS)
+			rc = cuLaunchKernel(f_pack,
+								grid_sz, 1, 1,
+								block_sz, 1, 1,
+								0,
+								MY_STREAM_PER_THREAD,
+								kern_args,
+								NULL);
+		if (rc == CUDA_SUCCESS)
+			rc = cuStreamSynchronize(MY_STREAM_PER_THREAD);
+		if (rc != CUDA_SUCCESS)
+		{
+			gpuClientELog(gclient, "failed on columnar packing: %s",
+						  cuStrError(rc));
+			gpuMemFree(n_chunk);
+			return false;
 		}
+		gpuMemFree(d_chunk_array[i]);
+		kds_dst_array[i] = kds_new;
+		d_chunk_array[i] = n_chunk;
 	}
-	pthreadMutexUnlock(&gcontext->lock);
+	return true;
+}
 
-	/* detach from the gpuContext */
-	pthreadMutexLock(&gcontext->worker_lock);
-	dlist_delete(&gworker->chain);
-	pthreadMutexUnlock(&gcontext->worker_lock);
-	/* release */
-	cuEventDestroy(cuda_event);
-	cuStreamDestroy(cuda_stream);
-	free(gworker);
+static void
+gpuservHandleGpuTaskExec(gpuClient *gclient, XpuCommand *xcmd)
+{
+	gpuContext		*gcontext = gclient->gcontext;
+	kern_session_info *session = gclient->session;
+	gpuQueryBuffer  *gq_buf = gclient->gq_buf;
+	kern_gputask	*kgtask = NULL;
+	const char		*kds_src_pathname = NULL;
+	strom_io_vector *kds_src_iovec = NULL;
+	kern_data_store *kds_src = NULL;
+	kern_data_store *kds_dst = NULL;
+	kern_data_store *kds_dst_head = NULL;
+	kern_data_store **kds_dst_array = NULL;
+	int				kds_dst_nrooms = 0;
+	int				kds_dst_nitems = 0;
+	int				num_inner_rels = 0;
+	uint32_t		npages_direct_read = 0;
+	uint32_t		npages_vfs_read = 0;
+	CUfunction		f_kern_gpuscan;
+	void		   *gc_lmap = NULL;
+	gpuMemChunk	   *s_chunk = NULL;		/* for kds_src */
+	gpuSharedScanChunk *ss_chunk = NULL;	/* shared scan of kds_src */
+	gpuMemChunk	   *c_chunk = NULL;		/* device copy of host kds_src */
+	gpuMemChunk	   *t_chunk = NULL;		/* for kern_gputask */
+	gpuMemChunk	  **d_chunk_array = NULL; /* for kds_dst_array */
+	CUdeviceptr		m_kds_src = 0UL;
+	CUdeviceptr		m_kds_extra = 0UL;
+	CUdeviceptr		m_gcache_delta = 0UL;
+	CUdeviceptr		m_kmrels = 0UL;
+	CUresult		rc;
+	int				grid_sz;
+	int				block_sz;
+	int				grid_cand = -1;
+	int				pool_nrooms = 0;
+	bool			partial_results_sent = false;
+	int				pool_base = 0;
+	unsigned int	shmem_dynamic_sz;
+	unsigned int	groupby_prepfn_bufsz = 0;
+	unsigned int	groupby_prepfn_nbufs = 0;
+	unsigned int	groupby_local_nslots = 0;
+	size_t			kds_final_length = 0;
+	uint32_t		kds_final_nspills = 0;
+	bool			kds_final_locked = false;
+	uint64_t		ts_dequeue = monotonic_clock_us();
+	uint64_t		ts_io_done = 0;
+	uint64_t		ts_kernel_done = 0;
+	uint32_t		nr_suspend_resume = 0;
+	uint32_t		exec_paths = 0;
+	bool			resume_on_yield = false;
+	uint64_t		nvtx_range = 0;
+	size_t			sz;
+	void		   *kern_args[10];
 
-	__gsDebug("GPU-%d worker thread launched\n", MY_DINDEX_PER_THREAD);
+	/*
+	 * LIMIT without ORDER BY is already satisfied by the former tasks,
+	 * so the queued chunks are skipped.
+	 */
+	if (session->limit_nitems > 0 &&
+		pg_atomic_read_u64(&gclient->limit_nitems_out) >= session->limit_nitems)
+	{
+		XpuCommand	resp;
+
+		memset(&resp, 0, sizeof(XpuCommand));
+		resp.magic = XpuCommandMagicNumber;
+		resp.tag   = XpuCommandTag__Success;
+		resp.u.results.chunks_offset = MAXALIGN(offsetof(XpuCommand,
+														 u.results.stats));
+		gpuClientWriteBack(gclient, &resp,
+						   resp.u.results.chunks_offset, 0, NULL);
+		return;
+	}
+	if (xcmd->u.task.kds_src_pathname)
+		kds_src_pathname = (char *)xcmd + xcmd->u.task.kds_src_pathname;
+	if (xcmd->u.task.kds_src_iovec)
+		kds_src_iovec = (strom_io_vector *)((char *)xcmd + xcmd->u.task.kds_src_iovec);
+	if (xcmd->u.task.kds_src_offset)
+		kds_src = (kern_data_store *)((char *)xcmd + xcmd->u.task.kds_src_offset);
+	if (xcmd->u.task.kds_dst_offset)
+		kds_dst_head = (kern_data_store *)((char *)xcmd + xcmd->u.task.kds_dst_offset);
+	if (!kds_src)
+	{
+		const GpuCacheScanArgs *gc_args = (GpuCacheScanArgs *)xcmd->u.task.data;
+		const GpuCacheIdent *ident = &gc_args->ident;
+		char		errbuf[120];
+
+		Assert(xcmd->tag == XpuCommandTag__XpuTaskExecGpuCache);
+		gc_lmap = gpuCacheGetDeviceBuffer(ident,
+										  &m_kds_src,
+										  &m_kds_extra,
+										  errbuf, sizeof(errbuf));
+		if (!gc_lmap)
+		{
+			gpuClientELog(gclient, "no GpuCache (dat=%u,rel=%u,sig=%09lx) found - %s",
+						  ident->database_oid,
+						  ident->table_oid,
+						  ident->signature,
+						  errbuf);
+			return;
+		}
+		/* REDO logs not applied yet are merged on read, if required */
+		if (gc_args->merge_pos > 0 &&
+			gpuCacheBuildDeltaBuffer(gc_lmap,
+									 gc_args->merge_pos,
+									 &m_gcache_delta,
+									 errbuf, sizeof(errbuf)) != 0)
+		{
+			gpuClientELog(gclient, "unable to merge GpuCache REDO logs - %s",
+						  errbuf);
+			gpuCachePutDeviceBuffer(gc_lmap);
+			return;
+		}
+	}
+	else if (kds_src->format == KDS_FORMAT_ROW)
+	{
+		m_kds_src = (CUdeviceptr)kds_src;
+	}
+	else if (kds_src->format == KDS_FORMAT_BLOCK)
+	{
+		if (kds_src_pathname && kds_src_iovec)
+		{
+			pgstromNvtxRangeStart(&nvtx_range, "GpuTask I/O (query=%lx, node=%u)",
+								  session->query_plan_id,
+								  session->pgsql_plan_node_id);
+			s_chunk = gpuservClaimPrefetchedKds(xcmd,
+												&npages_direct_read,
+												&npages_vfs_read);
+			if (!s_chunk)
+				s_chunk = gpuservLoadKdsBlock(gclient,
+											  kds_src,
+											  kds_src_pathname,
+											  kds_src_iovec,
+											  &npages_direct_read,
+											  &npages_vfs_read);
+			pgstromNvtxRangeEnd(&nvtx_range);
+			if (!s_chunk)
+				return;
+			m_kds_src = s_chunk->m_devptr;
+		}
+		else
+		{
+			Assert(kds_src->block_nloaded == kds_src->nitems);
+			m_kds_src = (CUdeviceptr)kds_src;
+		}
+	}
+	else if (kds_src->format == KDS_FORMAT_ARROW)
+	{
+		if (kds_src_iovec->nr_chunks == 0)
+			m_kds_src = (CUdeviceptr)kds_src;
+		else
+		{
+			if (!kds_src_pathname)
+			{
+				gpuClientELog(gclient, "GpuScan: arrow file is missing");
+				return;
+			}
+			pgstromNvtxRangeStart(&nvtx_range, "GpuTask I/O (query=%lx, node=%u)",
+								  session->query_plan_id,
+								  session->pgsql_plan_node_id);
+			s_chunk = gpuservClaimPrefetchedKds(xcmd,
+												&npages_direct_read,
+												&npages_vfs_read);
+			if (pgstrom_gpu_shared_scan_buffer_size > 0)
+			{
+				char	   *key;
+				size_t		key_len;
+
+				key = __gpuservSharedScanBuildKey(kds_src,
+												  kds_src_pathname,
+												  kds_src_iovec,
+												  &key_len);
+				if (key)
+				{
+					if (!s_chunk)
+					{
+						ss_chunk = gpuservLookupSharedScanChunk(key, key_len);
+						if (ss_chunk)
+						{
+							s_chunk = ss_chunk->chunk;
+							exec_paths |= XPU_EXEC_PATH__SHARED_SCAN;
+						}
+					}
+					if (!s_chunk)
+					{
+						/* shared buffer is not charged to the session */
+						MY_CLIENT_PER_THREAD = NULL;
+						s_chunk = gpuservLoadKdsArrow(gclient,
+													  kds_src,
+													  kds_src_pathname,
+													  kds_src_iovec,
+													  &npages_direct_read,
+													  &npages_vfs_read);
+						MY_CLIENT_PER_THREAD = gclient;
+					}
+					if (s_chunk && !ss_chunk)
+						ss_chunk = gpuservInsertSharedScanChunk(key, key_len,
+																s_chunk);
+					free(key);
+				}
+			}
+			if (!s_chunk)
+				s_chunk = gpuservLoadKdsArrow(gclient,
+											  kds_src,
+											  kds_src_pathname,
+											  kds_src_iovec,
+											  &npages_direct_read,
+											  &npages_vfs_read);
+			pgstromNvtxRangeEnd(&nvtx_range);
+			if (!s_chunk)
+				return;
+			m_kds_src = s_chunk->m_devptr;
+		}
+	}
+	else
+	{
+		gpuClientELog(gclient, "unknown GpuScan Source format (%c)",
+					  kds_src->format);
+		return;
+	}
+	if (npages_vfs_read > 0)
+	{
+		exec_paths |= XPU_EXEC_PATH__VFS_FALLBACK;
+		if (gpuDirectDMABufferIsPooled())
+			exec_paths |= XPU_EXEC_PATH__DMA_POOL;
+	}
+	/* copy the host kds_src to the device memory by DMA, if device mode */
+	if (pgstrom_gpu_mempool_device_mode && !s_chunk && !gc_lmap)
+	{
+		c_chunk = gpuservCopyKdsSourceToDevice(kds_src);
+		if (c_chunk)
+		{
+			m_kds_src = c_chunk->m_devptr;
+			exec_paths |= XPU_EXEC_PATH__DEVICE_MEMORY;
+		}
+	}
+	ts_io_done = monotonic_clock_us();
+	pgstromNvtxRangeStart(&nvtx_range, "GpuTask Setup (query=%lx, node=%u)",
+						  session->query_plan_id,
+						  session->pgsql_plan_node_id);
+	/* inner buffer of GpuJoin */
+	if (gq_buf && gq_buf->m_kmrels)
+	{
+		kern_multirels *h_kmrels = (kern_multirels *)gq_buf->h_kmrels;
+
+		m_kmrels = gq_buf->m_kmrels;
+		num_inner_rels = h_kmrels->num_rels;
+		if (gq_buf->kmrels_shared)
+			exec_paths |= XPU_EXEC_PATH__SHARED_INNER;
+		if (gq_buf->kmrels_cached)
+			exec_paths |= XPU_EXEC_PATH__CACHED_INNER;
+		if (gq_buf->kmrels_host_mapped)
+			exec_paths |= XPU_EXEC_PATH__HOST_MAPPED_INNER;
+		if (gq_buf->kmrels_peer)
+			exec_paths |= XPU_EXEC_PATH__PEER_INNER;
+		for (int i=0; i < num_inner_rels; i++)
+		{
+			if (h_kmrels->chunks[i].hash_nbuckets > 0)
+				exec_paths |= XPU_EXEC_PATH__HASH_BUCKETIZED;
+			if (h_kmrels->chunks[i].hash_gpu_build)
+				exec_paths |= XPU_EXEC_PATH__GPU_HASH_BUILD;
+			if (h_kmrels->chunks[i].bloom_nblocks > 0)
+				exec_paths |= XPU_EXEC_PATH__BLOOM_FILTER;
+			if (h_kmrels->chunks[i].hash_nskews > 0)
+				exec_paths |= XPU_EXEC_PATH__HASH_SKEW;
+		}
+	}
+
+	rc = cuModuleGetFunction(&f_kern_gpuscan,
+							 gclient->cuda_module,
+							 "kern_gpujoin_main");
+	if (rc != CUDA_SUCCESS)
+	{
+		gpuClientFatal(gclient, "failed on cuModuleGetFunction: %s",
+					   cuStrError(rc));
+		goto bailout;
+	}
+	if (gclient->cuda_module != GpuWorkerCurrentContext->cuda_module)
+		exec_paths |= XPU_EXEC_PATH__JIT_MODULE;
+	shmem_dynamic_sz = __KERN_WARP_CONTEXT_BASESZ(session->kcxt_kvecs_ndims);
+	rc = gpuOptimalBlockSize(&grid_sz,
+							 &block_sz,
+							 f_kern_gpuscan,
+							 shmem_dynamic_sz);
+	if (rc != CUDA_SUCCESS)
+	{
+		gpuClientFatal(gclient, "failed on gpuOptimalBlockSize: %s",
+					   cuStrError(rc));
+		goto bailout;
+	}
+//	block_sz = 128;
+//	grid_sz = 1;
+	grid_sz = gpuservChooseGridSize(gclient, grid_sz, &grid_cand);
+	if (grid_cand > 0)
+		exec_paths |= XPU_EXEC_PATH__GRID_TUNING;
+
+	/* allocation of extra shared memory for GpuPreAgg (if any) */
+	shmem_dynamic_sz =
+		__expand_gpupreagg_prepfunc_buffer(session,
+										   grid_sz, block_sz,
+										   shmem_dynamic_sz,
+										   gcontext->gpumain_shmem_sz_dynamic,
+										   &groupby_prepfn_bufsz,
+										   &groupby_prepfn_nbufs,
+										   &groupby_local_nslots);
+	/*
+	 * Allocation of the control structure
+	 */
+	sz = KERN_GPUTASK_LENGTH(session->kcxt_kvecs_ndims,
+							 session->kcxt_kvecs_bufsz,
+							 grid_sz, block_sz);
+	t_chunk = gpuMemAllocManaged(sz);
+	if (!t_chunk)
+	{
+		gpuClientFatal(gclient, "failed on gpuMemAllocManaged: %lu", sz);
+		goto bailout;
+	}
+	kgtask = (kern_gputask *)t_chunk->m_devptr;
+	memset(kgtask, 0, offsetof(kern_gputask, stats[num_inner_rels]));
+	kgtask->grid_sz  = grid_sz;
+	kgtask->block_sz = block_sz;
+	kgtask->kvars_nslots = session->kcxt_kvars_nslots;
+	kgtask->kvecs_bufsz  = session->kcxt_kvecs_bufsz;
+	kgtask->kvecs_ndims  = session->kcxt_kvecs_ndims;
+	kgtask->n_rels       = num_inner_rels;
+	kgtask->gcache_delta = (kern_gpucache_delta *)m_gcache_delta;
+	kgtask->groupby_prepfn_bufsz = groupby_prepfn_bufsz;
+	kgtask->groupby_prepfn_nbufs = groupby_prepfn_nbufs;
+	kgtask->groupby_local_nslots = groupby_local_nslots;
+	kgtask->time_slice_ns = (uint64_t)pgstrom_gpu_kernel_time_slice * 1000000UL;
+
+	/* prefetch source KDS, if managed memory */
+	if (!s_chunk && !c_chunk && !gc_lmap)
+	{
+		rc = cuMemPrefetchAsync((CUdeviceptr)kds_src,
+								kds_src->length,
+								MY_DEVICE_PER_THREAD,
+								MY_STREAM_PER_THREAD);
+		if (rc != CUDA_SUCCESS)
+		{
+			gpuClientFatal(gclient, "failed on cuMemPrefetchAsync: %s",
+						   cuStrError(rc));
+			goto bailout;
+		}
+	}
+
+	/*
+	 * Allocation of the destination buffer
+	 */
+resume_kernel:
+	pgstromNvtxRangeStart(&nvtx_range, "GpuTask Kernel (query=%lx, node=%u)",
+						  session->query_plan_id,
+						  session->pgsql_plan_node_id);
+	if (gq_buf && gq_buf->m_kds_final)
+	{
+		/*
+		 * Suspend of GpuPreAgg kernel means the kds_final buffer is
+		 * almost full, thus GPU kernel wants to expand the buffer.
+		 * It must be done under the exclusive lock.
+		 */
+		if (kgtask->resume_context && !resume_on_yield)
+		{
+			if (!__expandGpuQueryGroupByBuffer(gq_buf, kds_final_length,
+											   session->gpumem_limit_mb) &&
+				(session->groupby_final_mode ||
+				 !__spillGpuQueryGroupByBuffer(gclient, gq_buf,
+											   kds_final_length,
+											   kds_final_nspills)))
+			{
+				gpuClientFatal(gclient, "unable to expand GpuPreAgg final buffer");
+				goto bailout;
+			}
+		}
+		pthreadRWLockReadLock(&gq_buf->m_kds_final_rwlock);
+		kds_dst = (kern_data_store *)gq_buf->m_kds_final;
+		kds_final_length = gq_buf->m_kds_final_length;
+		kds_final_nspills = gq_buf->m_kds_final_nspills;
+		kds_final_locked = true;
+	}
+	else
+	{
+		/*
+		 * GPU projection can switch the destination buffer by itself,
+		 * if we pre-reserve multiple buffers; see __gpujoinSwitchDestBuffer.
+		 * Once a session needs suspend/resume, we reserve more buffers for
+		 * the following chunks.
+		 */
+		pool_nrooms = 1;
+		if (session->xpucode_projection)
+			pool_nrooms = Max(gclient->kds_dst_pool_hint, 1);
+		pool_base = kds_dst_nitems;
+		kgtask->kds_dst_nrooms = (pool_nrooms > 1 ? pool_nrooms : 0);
+		kgtask->kds_dst_index = 0;
+		for (int k=0; k < pool_nrooms; k++)
+		{
+			gpuMemChunk	   *d_chunk;
+
+			sz = KDS_HEAD_LENGTH(kds_dst_head) + PGSTROM_CHUNK_SIZE;
+			d_chunk = gpuMemAllocManaged(sz);
+			if (!d_chunk)
+			{
+				gpuClientFatal(gclient, "failed on gpuMemAllocManaged(%lu)", sz);
+				goto bailout;
+			}
+			kds_dst = (kern_data_store *)d_chunk->m_devptr;
+			memcpy(kds_dst, kds_dst_head, KDS_HEAD_LENGTH(kds_dst_head));
+			kds_dst->length = sz;
+			if (pgstrom_gpu_mempool_device_mode)
+				gpuservPrefetchKdsDestToDevice(kds_dst);
+			if (kds_dst_nitems >= kds_dst_nrooms)
+			{
+				kern_data_store	**kds_dst_temp;
+				gpuMemChunk		**d_chunk_temp;
+
+				kds_dst_nrooms = 2 * kds_dst_nrooms + 10;
+				kds_dst_temp = alloca(sizeof(kern_data_store *) * kds_dst_nrooms);
+				d_chunk_temp = alloca(sizeof(gpuMemChunk *) * kds_dst_nrooms);
+				if (kds_dst_nitems > 0)
+				{
+					memcpy(kds_dst_temp, kds_dst_array,
+						   sizeof(kern_data_store *) * kds_dst_nitems);
+					memcpy(d_chunk_temp, d_chunk_array,
+						   sizeof(gpuMemChunk *) * kds_dst_nitems);
+				}
+				kds_dst_array = kds_dst_temp;
+				d_chunk_array = d_chunk_temp;
+			}
+			kds_dst_array[kds_dst_nitems] = kds_dst;
+			d_chunk_array[kds_dst_nitems] = d_chunk;
+			kds_dst_nitems++;
+			if (k < GPUTASK_KDS_DST_POOL_NSLOTS)
+				kgtask->kds_dst_pool[k] = kds_dst;
+		}
+		kds_dst = kds_dst_array[pool_base];
+	}
+
+	/*
+	 * Launch kernel
+	 */
+	kern_args[0] = &gclient->session;
+	kern_args[1] = &kgtask;
+	kern_args[2] = &m_kmrels;
+	kern_args[3] = &m_kds_src;
+	kern_args[4] = &m_kds_extra;
+	kern_args[5] = &kds_dst;
+
+	if (grid_cand >= 0 && !kgtask->resume_context)
+	{
+		rc = cuEventRecord(MY_TIMER_EVENT_PER_THREAD, MY_STREAM_PER_THREAD);
+		if (rc != CUDA_SUCCESS)
+			grid_cand = -1;		/* no tuning for this chunk */
+	}
+	rc = gpuservLaunchKernelGraph(f_kern_gpuscan,
+								  grid_sz,
+								  block_sz,
+								  shmem_dynamic_sz,
+								  kern_args);
+	if (rc != CUDA_SUCCESS)
+	{
+		gpuClientFatal(gclient, "failed on cuLaunchKernel: %s", cuStrError(rc));
+		goto bailout;
+	}
+	/* load the next chunk during the kernel execution */
+	gpuservPrefetchNextCommand();
+
+	rc = cuEventRecord(MY_EVENT_PER_THREAD, MY_STREAM_PER_THREAD);
+	if (rc != CUDA_SUCCESS)
+	{
+		gpuClientFatal(gclient, "failed on cuEventRecord: %s", cuStrError(rc));
+		goto bailout;
+	}
+
+	/* point of synchronization */
+	rc = cuEventSynchronize(MY_EVENT_PER_THREAD);
+	if (rc != CUDA_SUCCESS)
+	{
+		gpuClientFatal(gclient, "failed on cuEventSynchronize: %s", cuStrError(rc));
+		goto bailout;
+	}
+	ts_kernel_done = monotonic_clock_us();
+	pgstromNvtxRangeStart(&nvtx_range, "GpuTask Write-back (query=%lx, node=%u)",
+						  session->query_plan_id,
+						  session->pgsql_plan_node_id);
+	/* unlock kds_final buffer */
+	if (kds_final_locked)
+	{
+		pthreadRWLockUnlock(&gq_buf->m_kds_final_rwlock);
+		kds_final_locked = false;
+	}
+	/* release the pre-reserved destination buffers not in use */
+	if (kgtask->kds_dst_nrooms > 0)
+	{
+		int		nused = kgtask->kds_dst_index + 1;
+
+		Assert(nused <= pool_nrooms);
+		while (kds_dst_nitems > pool_base + nused)
+			gpuMemFree(d_chunk_array[--kds_dst_nitems]);
+		kgtask->kds_dst_nrooms = 0;
+	}
+	if (kgtask->suspend_count > 0 && session->xpucode_projection)
+	{
+		/* reserve more destination buffers for the next chunks */
+		if (gclient->kds_dst_pool_hint < GPUTASK_KDS_DST_POOL_NSLOTS)
+			gclient->kds_dst_pool_hint = Min(2 * Max(gclient->kds_dst_pool_hint, 1),
+											 GPUTASK_KDS_DST_POOL_NSLOTS);
+	}
+
+	/* status check */
+	if (kgtask->kerror.errcode == ERRCODE_STROM_SUCCESS)
+	{
+		XpuCommand *resp;
+		size_t		resp_sz;
+
+		if (grid_cand >= 0 && !kgtask->resume_context &&
+			kgtask->suspend_count == 0 && kgtask->yield_count == 0)
+		{
+			float	elapsed_ms;
+
+			/* suspended/resumed chunks are not sampled */
+			if (cuEventElapsedTime(&elapsed_ms,
+								   MY_TIMER_EVENT_PER_THREAD,
+								   MY_EVENT_PER_THREAD) == CUDA_SUCCESS)
+				gpuservUpdateGridSizeTuner(gclient, grid_cand, elapsed_ms,
+										   kgtask->nitems_raw);
+		}
+		if (kgtask->suspend_count > 0 || kgtask->yield_count > 0)
+		{
+			if (gpuServiceGoingTerminate())
+			{
+				gpuClientFatal(gclient, "GpuService is going to terminate during GpuScan kernel suspend/resume");
+				goto bailout;
+			}
+			/*
+			 * The destination chunks filled up so far are never touched
+			 * by the resumed kernel, so we stream them to the backend
+			 * prior to the remaining results.
+			 */
+			if (kds_dst_nitems > 0)
+			{
+				if (session->topk_nitems > 0 &&
+					!__gpuservTopKSelection(gclient, kds_dst_nitems,
+											kds_dst_array, d_chunk_array))
+					goto bailout;
+				if (session->gpusort_chunks &&
+					!__gpuservSortDestChunks(gclient, kds_dst_nitems,
+											 kds_dst_array))
+					goto bailout;
+				if (session->columnar_results &&
+					!__gpuservColumnarDestChunks(gclient, kds_dst_nitems,
+												 kds_dst_array, d_chunk_array))
+					goto bailout;
+				if (pgstrom_gpu_mempool_device_mode)
+					gpuservPrefetchKdsDestToHost(gclient, kds_dst_nitems,
+												 kds_dst_array);
+				resp_sz = MAXALIGN(offsetof(XpuCommand, u.results.stats));
+				resp = alloca(resp_sz);
+				memset(resp, 0, resp_sz);
+				resp->magic = XpuCommandMagicNumber;
+				resp->tag   = XpuCommandTag__SuccessPartial;
+				resp->u.results.chunks_nitems = kds_dst_nitems;
+				resp->u.results.chunks_offset = resp_sz;
+				gpuClientWriteBack(gclient,
+								   resp, resp_sz,
+								   kds_dst_nitems, kds_dst_array);
+				while (kds_dst_nitems > 0)
+					gpuMemFree(d_chunk_array[--kds_dst_nitems]);
+				partial_results_sent = true;
+			}
+			/*
+			 * restore warp context from the previous state; if kernel just
+			 * yielded SMs by the time-slice, no buffer needs to expand.
+			 */
+			resume_on_yield = (kgtask->suspend_count == 0);
+			if (resume_on_yield)
+				exec_paths |= XPU_EXEC_PATH__KERNEL_YIELD;
+			kgtask->resume_context = true;
+			kgtask->suspend_count = 0;
+			kgtask->yield_count = 0;
+			nr_suspend_resume++;
+			__gsDebug("%s / resume happen\n",
+					  resume_on_yield ? "yield" : "suspend");
+			if (kds_final_locked)
+				pthreadRWLockUnlock(&gq_buf->m_kds_final_rwlock);
+			goto resume_kernel;
+		}
+		/* send back status and kds_dst */
+		resp_sz = MAXALIGN(offsetof(XpuCommand,
+									u.results.stats[num_inner_rels]));
+		resp = alloca(resp_sz);
+		memset(resp, 0, resp_sz);
+		resp->magic = XpuCommandMagicNumber;
+		resp->tag   = XpuCommandTag__Success;
+		resp->u.results.chunks_nitems = kds_dst_nitems;
+		resp->u.results.chunks_offset = resp_sz;
+		resp->u.results.npages_direct_read = npages_direct_read;
+		resp->u.results.npages_vfs_read = npages_vfs_read;
+		resp->u.results.nitems_raw = kgtask->nitems_raw;
+		resp->u.results.nitems_in  = kgtask->nitems_in;
+		resp->u.results.nitems_out = kgtask->nitems_out;
+		resp->u.results.exec_paths = exec_paths;
+		resp->u.results.num_rels = num_inner_rels;
+		for (int i=0; i < num_inner_rels; i++)
+		{
+			resp->u.results.stats[i].nitems_gist = kgtask->stats[i].nitems_gist;
+			resp->u.results.stats[i].nitems_out  = kgtask->stats[i].nitems_out;
+		}
+		if (session->topk_nitems > 0 &&
+			!__gpuservTopKSelection(gclient, kds_dst_nitems,
+									kds_dst_array, d_chunk_array))
+			goto bailout;
+		if (session->gpusort_chunks &&
+			!__gpuservSortDestChunks(gclient, kds_dst_nitems,
+									 kds_dst_array))
+			goto bailout;
+		if (session->columnar_results &&
+			!__gpuservColumnarDestChunks(gclient, kds_dst_nitems,
+										 kds_dst_array, d_chunk_array))
+			goto bailout;
+		if (pgstrom_gpu_mempool_device_mode)
+			gpuservPrefetchKdsDestToHost(gclient, kds_dst_nitems,
+										 kds_dst_array);
+		resp->u.results.ts_enqueue = GPUSERV_PACKED_COMMAND(xcmd)->ts_enqueue;
+		resp->u.results.ts_dequeue = ts_dequeue;
+		resp->u.results.ts_io_done = ts_io_done;
+		resp->u.results.ts_kernel_done = ts_kernel_done;
+		resp->u.results.ts_write_back = monotonic_clock_us();
+		if (session->limit_nitems > 0)
+			pg_atomic_fetch_add_u64(&gclient->limit_nitems_out,
+									kgtask->nitems_out);
+		gpuClientWriteBack(gclient,
+						   resp, resp_sz,
+						   kds_dst_nitems, kds_dst_array);
+		gpuservUpdateDeviceStat(gclient,
+								GPUSERV_PACKED_COMMAND(xcmd)->ts_enqueue,
+								ts_dequeue,
+								ts_io_done,
+								ts_kernel_done,
+								npages_direct_read,
+								npages_vfs_read,
+								nr_suspend_resume);
+	}
+	else if (kgtask->kerror.errcode == ERRCODE_CPU_FALLBACK &&
+			 partial_results_sent)
+	{
+		/*
+		 * CPU fallback re-runs the entire source chunk, so it would
+		 * duplicate the results already streamed to the backend.
+		 */
+		gpuClientELog(gclient, "CPU fallback is not available after partial results were sent (%s:%d %s)",
+					  kgtask->kerror.filename,
+					  kgtask->kerror.lineno,
+					  kgtask->kerror.message);
+	}
+	else if (kgtask->kerror.errcode == ERRCODE_CPU_FALLBACK)
+	{
+		kern_data_store *__kds_src = kds_src;
+		XpuCommand	resp;
+
+		/*
+		 * Send back the source buffer with XpuCommandTag__CPUFallback
+		 *
+		 * KDS_FORMAT_BLOCK and KDS_FORMAT_ARROW must be send back the
+		 * backend process from the GPU device buffer, because the original
+		 * kds_src does not have data contents itself.
+		 * For KDS_FORMAT_COLUMN, it is equivalent to the kernel buffer,
+		 * and its size tends to be large. So, CPU fallback uses regular
+		 * heap-scan instead.
+		 */
+		if (s_chunk)
+		{
+			__kds_src = malloc(s_chunk->__length);
+			if (!__kds_src)
+			{
+				gpuClientELog(gclient, "out of memory for CPU fallback (sz=%lu)",
+							  s_chunk->__length);
+				goto bailout;
+			}
+			rc = cuMemcpyDtoH(__kds_src, s_chunk->m_devptr, s_chunk->__length);
+			if (rc != CUDA_SUCCESS)
+			{
+				free(__kds_src);
+				gpuClientELog(gclient, "failed on cuMemcpyDtoH: %s", cuStrError(rc));
+				goto bailout;
+			}
+		}
+		memset(&resp, 0, sizeof(resp));
+		resp.magic = XpuCommandMagicNumber;
+		resp.tag   = XpuCommandTag__CPUFallback;
+		memcpy(&resp.u.fallback.error,
+			   &kgtask->kerror,
+			   sizeof(kern_errorbuf));
+		resp.u.fallback.npages_direct_read = npages_direct_read;
+		resp.u.fallback.npages_vfs_read = npages_vfs_read;
+		gpuClientWriteBack(gclient,
+						   &resp,
+						   offsetof(XpuCommand, u.fallback.kds_src),
+						   1, &__kds_src);
+		if (kds_src != __kds_src)
+			free(__kds_src);
+		gpuservUpdateDeviceStat(gclient,
+								GPUSERV_PACKED_COMMAND(xcmd)->ts_enqueue,
+								ts_dequeue,
+								ts_io_done,
+								ts_kernel_done,
+								npages_direct_read,
+								npages_vfs_read,
+								nr_suspend_resume);
+		pg_atomic_fetch_add_u64(&GPUSERV_DEVICE_STAT(gcontext->cuda_dindex)->nr_cpu_fallback, 1);
+	}
+	else
+	{
+		/* send back error status */
+		__gpuClientELogRaw(gclient, &kgtask->kerror);
+		pg_atomic_fetch_add_u64(&GPUSERV_DEVICE_STAT(gcontext->cuda_dindex)->nr_errors, 1);
+	}
+bailout:
+	pgstromNvtxRangeEnd(&nvtx_range);
+	if (kds_final_locked)
+		pthreadRWLockUnlock(&gq_buf->m_kds_final_rwlock);
+	if (ss_chunk)
+		gpuservReleaseSharedScanChunk(ss_chunk);
+	else if (s_chunk)
+		gpuMemFree(s_chunk);
+	if (c_chunk)
+		gpuMemFree(c_chunk);
+	if (t_chunk)
+		gpuMemFree(t_chunk);
+	while (kds_dst_nitems > 0)
+		gpuMemFree(d_chunk_array[--kds_dst_nitems]);
+	if (m_gcache_delta)
+		cuMemFree(m_gcache_delta);
+	if (gc_lmap)
+		gpuCachePutDeviceBuffer(gc_lmap);
+}
+
+/* ------------------------------------------------------------
+ *
+ * gpuservGpuCacheManager - GpuCache worker
+ *
+ * ------------------------------------------------------------
+ */
+static void *
+gpuservGpuCacheManager(void *__arg)
+{
+	gpuWorker  *gworker = (gpuWorker *)__arg;
+	gpuContext *gcontext = gworker->gcontext;
+	CUresult	rc;
+
+	rc = cuCtxSetCurrent(gcontext->cuda_context);
+	if (rc != CUDA_SUCCESS)
+		__FATAL("failed on cuCtxSetCurrent: %s", cuStrError(rc));
+
+	GpuWorkerCurrentContext	= gcontext;
+	MY_DINDEX_PER_THREAD	= gcontext->cuda_dindex;
+	MY_DEVICE_PER_THREAD	= gcontext->cuda_device;
+	MY_CONTEXT_PER_THREAD	= gcontext->cuda_context;
+	MY_STREAM_PER_THREAD	= CU_STREAM_LEGACY;
+	MY_EVENT_PER_THREAD		= NULL;
+	pg_memory_barrier();
+
+	__gsDebug("GPU-%d GpuCache manager thread launched.",
+			  MY_DINDEX_PER_THREAD);
+	pgstromNvtxNameThread("GPU-%d GpuCache manager", MY_DINDEX_PER_THREAD);
+	
+	gpucacheManagerEventLoop(gcontext->cuda_dindex,
+							 gcontext->cuda_context,
+							 gcontext->cuda_module);
+
+	/* delete gpuWorker from the gpuContext */
+	pthreadMutexLock(&gcontext->worker_lock);
+	dlist_delete(&gworker->chain);
+	pthreadMutexUnlock(&gcontext->worker_lock);
+	free(gworker);
+
+	__gsDebug("GPU-%d GpuCache manager terminated.",
+			  MY_DINDEX_PER_THREAD);
+	return NULL;
+}
+
+/* ----------------------------------------------------------------
+ *
+ * gpuservHandleGpuTaskFinal
+ *
+ * ----------------------------------------------------------------
+ */
+static void
+gpuservHandleGpuTaskFinal(gpuClient *gclient, XpuCommand *xcmd)
+{
+	kern_final_task *kfin = &xcmd->u.fin;
+	gpuQueryBuffer *gq_buf = gclient->gq_buf;
+	XpuCommand		resp;
+	kern_data_store	*kds_final = NULL;
+
+	memset(&resp, 0, sizeof(XpuCommand));
+	resp.magic = XpuCommandMagicNumber;
+	resp.tag   = XpuCommandTag__Success;
+	resp.u.results.chunks_offset = MAXALIGN(offsetof(XpuCommand, u.results.stats));
+	resp.u.results.chunks_nitems = 0;
+
+	if (kfin->final_this_device && gq_buf)
+	{
+		/*
+		 * Is the outer-join-map written back to the host buffer?
+		 */
+		if (gq_buf->m_kmrels != 0UL &&
+			gq_buf->h_kmrels != NULL &&
+			!gq_buf->kmrels_host_mapped)
+		{
+			kern_multirels *d_kmrels = (kern_multirels *)gq_buf->m_kmrels;
+			kern_multirels *h_kmrels = (kern_multirels *)gq_buf->h_kmrels;
+
+			for (int i=0; i < d_kmrels->num_rels; i++)
+			{
+				kern_data_store *kds = KERN_MULTIRELS_INNER_KDS(h_kmrels, i);
+				bool   *d_ojmap = KERN_MULTIRELS_OUTER_JOIN_MAP(d_kmrels, i);
+				bool   *h_ojmap = KERN_MULTIRELS_OUTER_JOIN_MAP(h_kmrels, i);
+
+				if (d_ojmap && h_ojmap)
+				{
+					for (uint32_t j=0; j < kds->nitems; j++)
+						h_ojmap[j] |= d_ojmap[j];
+					resp.u.results.final_this_device = true;
+				}
+			}
+		}
+
+		/*
+		 * Is the GpuPreAgg final buffer written back?
+		 */
+		if (gq_buf->m_kds_final != 0UL)
+		{
+			kds_final = (kern_data_store *)gq_buf->m_kds_final;
+			resp.u.results.chunks_nitems = 1;
+			resp.u.results.final_this_device = true;
+		}
+	}
+	resp.u.results.final_plan_node = kfin->final_plan_node;
+
+	gpuClientWriteBack(gclient, &resp,
+					   resp.u.results.chunks_offset,
+					   resp.u.results.chunks_nitems,
+					   &kds_final);
+}
+
+/*
+ * gpuservGpuWorkerMain -- actual worker
+ */
+static void *
+gpuservGpuWorkerMain(void *__arg)
+{
+	gpuWorker  *gworker = (gpuWorker *)__arg;
+	gpuContext *gcontext = gworker->gcontext;
+	gpuWorkerQueue *wqueue = &gcontext->queues[gworker->qindex];
+	gpuClient  *gclient;
+	CUstream	cuda_stream;
+	CUevent		cuda_event;
+	CUevent		timer_event;
+	CUstream	copy_stream;
+	CUevent		copy_event;
+	CUresult	rc;
+
+	rc = cuCtxSetCurrent(gcontext->cuda_context);
+	if (rc != CUDA_SUCCESS)
+		__FATAL("failed on cuCtxSetCurrent: %s", cuStrError(rc));
+	rc = cuStreamCreate(&cuda_stream, CU_STREAM_NON_BLOCKING);
+	if (rc != CUDA_SUCCESS)
+		 __FATAL("failed on cuStreamCreate: %s", cuStrError(rc));
+	rc = cuEventCreate(&cuda_event, CU_EVENT_BLOCKING_SYNC);
+	if (rc != CUDA_SUCCESS)
+		__FATAL("failed on cuEventCreate: %s", cuStrError(rc));
+	rc = cuEventCreate(&timer_event, CU_EVENT_DEFAULT);
+	if (rc != CUDA_SUCCESS)
+		__FATAL("failed on cuEventCreate: %s", cuStrError(rc));
+	/* stream/event for the pipelined load */
+	rc = cuStreamCreate(&copy_stream, CU_STREAM_NON_BLOCKING);
+	if (rc != CUDA_SUCCESS)
+		 __FATAL("failed on cuStreamCreate: %s", cuStrError(rc));
+	rc = cuEventCreate(&copy_event, CU_EVENT_BLOCKING_SYNC);
+	if (rc != CUDA_SUCCESS)
+		__FATAL("failed on cuEventCreate: %s", cuStrError(rc));
+	if (!gpuDirectRegisterStream(copy_stream))
+		__gsDebug("GPU-%d: unable to register copy stream to GPU-Direct SQL\n",
+				  gcontext->cuda_dindex);
+
+	/* DMA buffer for VFS fallback, if preallocated */
+	gpuDirectAttachDMABuffer(gcontext->cuda_dindex);
+
+	GpuWorkerCurrentContext = gcontext;
+	MY_DINDEX_PER_THREAD	= gcontext->cuda_dindex;
+	MY_DEVICE_PER_THREAD	= gcontext->cuda_device;
+	MY_CONTEXT_PER_THREAD	= gcontext->cuda_context;
+	MY_STREAM_PER_THREAD	= cuda_stream;
+	MY_EVENT_PER_THREAD		= cuda_event;
+	MY_TIMER_EVENT_PER_THREAD = timer_event;
+	MY_COPY_STREAM_PER_THREAD = copy_stream;
+	MY_COPY_EVENT_PER_THREAD = copy_event;
+	MY_WORKER_PER_THREAD	= gworker;
+	MY_SLAB_CACHE_ENABLED	= true;
+	pg_memory_barrier();
+
+	__gsDebug("GPU-%d worker thread launched\n", MY_DINDEX_PER_THREAD);
+	pgstromNvtxNameThread("GPU-%d worker (queue=%d)",
+						  MY_DINDEX_PER_THREAD, gworker->qindex);
+
+	while (!gpuServiceGoingTerminate() && !gworker->termination)
+	{
+		XpuCommand *xcmd = __gpuWorkerFetchCommand(gworker);
+
+		if (xcmd)
+		{
+			gclient = xcmd->priv;
+			/*
+			 * MEMO: If the least bit of gclient->refcnt is not set,
+			 * it means the gpu-client connection is no longer available.
+			 * (already closed, or error detected.)
+			 */
+			MY_CLIENT_PER_THREAD = gclient;
+			if ((pg_atomic_read_u32(&gclient->refcnt) & 1) == 1)
+			{
+				switch (xcmd->tag)
+				{
+					case XpuCommandTag__OpenSession:
+						if (gpuservHandleOpenSession(gclient, xcmd))
+							xcmd = NULL;	/* session information shall be kept until
+											 * end of the session. */
+						break;
+					case XpuCommandTag__ResetSession:
+						gpuservHandleResetSession(gclient, xcmd);
+						break;
+					case XpuCommandTag__XpuTaskExec:
+					case XpuCommandTag__XpuTaskExecGpuCache:
+						gpuservHandleGpuTaskExec(gclient, xcmd);
+						break;
+					case XpuCommandTag__XpuTaskFinal:
+						gpuservHandleGpuTaskFinal(gclient, xcmd);
+						break;
+					default:
+						gpuClientELog(gclient, "unknown XPU command (%d)",
+									  (int)xcmd->tag);
+						break;
+				}
+			}
+
+			MY_CLIENT_PER_THREAD = NULL;
+			if (xcmd)
+			{
+				gpuservReleasePrefetchedKds(xcmd);
+				__gpuServiceFreeCommand(xcmd);
+			}
+			gpuClientPut(gclient, false);
+		}
+		else
+		{
+			bool	has_command = true;
+
+			pthreadMutexLock(&wqueue->lock);
+			if (dlist_is_empty(&wqueue->command_list) &&
+				!gpuServiceGoingTerminate() &&
+				!gworker->termination)
+			{
+				wqueue->idle = true;
+				has_command = pthreadCondWaitTimeout(&wqueue->cond,
+													 &wqueue->lock,
+													 5000);
+				wqueue->idle = false;
+			}
+			pthreadMutexUnlock(&wqueue->lock);
+			/* maintenance works */
+			if (!has_command)
+			{
+				gpuMemSlabFlush();
+				gpuMemoryPoolMaintenance(gcontext);
+			}
+		}
+	}
+	__gpuWorkerDetachQueue(gworker);
+
+	/* detach from the gpuContext */
+	pthreadMutexLock(&gcontext->worker_lock);
+	dlist_delete(&gworker->chain);
+	wqueue->owned = false;
+	pthreadMutexUnlock(&gcontext->worker_lock);
+	/* release */
+	gpuservReleaseKernelGraphs();
+	MY_SLAB_CACHE_ENABLED = false;
+	gpuMemSlabFlush();
+	MY_WORKER_PER_THREAD = NULL;
+	gpuDirectDeregisterStream(copy_stream);
+	gpuDirectCleanUpOnThreadTerminate();
+	cuEventDestroy(copy_event);
+	cuStreamDestroy(copy_stream);
+	cuEventDestroy(timer_event);
+	cuEventDestroy(cuda_event);
+	cuStreamDestroy(cuda_stream);
+	free(gworker);
+
+	__gsDebug("GPU-%d worker thread launched\n", MY_DINDEX_PER_THREAD);
+
+	return NULL;
+}
+
+static void *
+gpuservMonitorClient(void *__priv)
+{
+	gpuClient  *gclient = __priv;
+	gpuContext *gcontext = gclient->gcontext;
+	pgsocket	sockfd = gclient->sockfd;
+	char		elabel[32];
+	CUresult	rc;
+
+	snprintf(elabel, sizeof(elabel), "GPU-%d", gcontext->cuda_dindex);
+
+	rc = cuCtxSetCurrent(gcontext->cuda_context);
+	if (rc != CUDA_SUCCESS)
+	{
+		__gsDebug("[%s] failed on cuCtxSetCurrent: %s\n",
+				  elabel, cuStrError(rc));
+		goto out;
+	}
+	GpuWorkerCurrentContext = gcontext;
+	pg_memory_barrier();
+
+	for (;;)
+	{
+		struct pollfd  pfd;
+		int		nevents;
+
+		pfd.fd = sockfd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		nevents = poll(&pfd, 1, -1);
+		if (nevents < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			__gsDebug("[%s] failed on poll(2): %m", elabel);
+			break;
+		}
+		if (nevents == 0)
+			continue;
+		Assert(nevents == 1);
+		if (pfd.revents == POLLIN)
+		{
+			if (__gpuServiceReceiveCommands(sockfd, gclient, elabel) < 0)
+				break;
+		}
+		else if (pfd.revents & ~POLLIN)
+		{
+			__gsDebug("[%s] peer socket closed.", elabel);
+			break;
+		}
+	}
+out:
+	gpuClientPut(gclient, true);
+	return NULL;
+}
+
+/*
+ * gpuservAcceptClient
+ */
+static void
+gpuservAcceptClient(gpuContext *gcontext)
+{
+	gpuClient  *gclient;
+	pgsocket	sockfd;
+	int			errcode;
+
+	sockfd = accept(gcontext->serv_fd, NULL, NULL);
+	if (sockfd < 0)
+	{
+		elog(LOG, "GPU%d: could not accept new connection: %m",
+			 gcontext->cuda_dindex);
+		pg_usleep(10000L);		/* wait 10ms */
+		return;
+	}
+
+	gclient = calloc(1, sizeof(gpuClient));
+	if (!gclient)
+	{
+		elog(LOG, "GPU%d: out of memory: %m",
+			 gcontext->cuda_dindex);
+		close(sockfd);
+		return;
+	}
+	gclient->gcontext = gcontext;
+	gclient->cuda_module = gcontext->cuda_module;
+	pg_atomic_init_u32(&gclient->refcnt, 1);
+	pg_atomic_init_u64(&gclient->gpumem_usage, 0);
+	pg_atomic_init_u64(&gclient->limit_nitems_out, 0);
+	pthreadMutexInit(&gclient->mutex);
+	pthreadMutexInit(&gclient->grid_tuner.lock);
+	pthreadMutexInit(&gclient->ring_lock);
+	gclient->sockfd = sockfd;
+
+	if ((errcode = pthread_create(&gclient->worker, NULL,
+								  gpuservMonitorClient,
+								  gclient)) != 0)
+	{
+		elog(LOG, "failed on pthread_create: %s", strerror(errcode));
+		close(sockfd);
+		free(gclient);
+		return;
+	}
+	pthreadMutexLock(&gcontext->client_lock);
+	dlist_push_tail(&gcontext->client_list, &gclient->chain);
+	pthreadMutexUnlock(&gcontext->client_lock);
+}
+
+/*
+ * __setupDevTypeLinkageTable
+ */
+static HTAB *
+__setupDevTypeLinkageTable(CUmodule cuda_module)
+{
+	xpu_type_catalog_entry *xpu_types_catalog;
+	const char *symbol = "builtin_xpu_types_catalog";
+	HASHCTL		hctl;
+	HTAB	   *htab = NULL;
+	CUdeviceptr	dptr;
+	CUresult	rc;
+	size_t		nbytes;
+	int			i;
+	
+	/* build device type table */
+	memset(&hctl, 0, sizeof(HASHCTL));
+	hctl.keysize = sizeof(TypeOpCode);
+	hctl.entrysize = sizeof(xpu_type_catalog_entry);
+	hctl.hcxt = TopMemoryContext;
+	htab = hash_create("CUDA device type hash table",
+					   512,
+					   &hctl,
+					   HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+
+	rc = cuModuleGetGlobal(&dptr, &nbytes, cuda_module, symbol);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuModuleGetGlobal('%s'): %s",
+			 symbol, cuStrError(rc));
+
+	xpu_types_catalog = alloca(nbytes);
+	rc = cuMemcpyDtoH(xpu_types_catalog, dptr, nbytes);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuMemcpyDtoH: %s", cuStrError(rc));
+	for (i=0; xpu_types_catalog[i].type_opcode != TypeOpCode__Invalid; i++)
+	{
+		TypeOpCode	type_opcode = xpu_types_catalog[i].type_opcode;
+		xpu_type_catalog_entry *entry;
+		bool		found;
+
+		entry = hash_search(htab, &type_opcode, HASH_ENTER, &found);
+		if (found)
+			elog(ERROR, "Bug? duplicated TypeOpCode: %u", (uint32_t)type_opcode);
+		Assert(entry->type_opcode == type_opcode);
+		entry->type_ops = xpu_types_catalog[i].type_ops;
+	}
+	return htab;
+}
+
+/*
+ * __setupDevFuncLinkageTable
+ */
+static HTAB *
+__setupDevFuncLinkageTable(CUmodule cuda_module)
+{
+	xpu_function_catalog_entry *xpu_funcs_catalog;
+	const char *symbol = "builtin_xpu_functions_catalog";
+	HASHCTL		hctl;
+	HTAB	   *htab;
+	CUdeviceptr	dptr;
+	CUresult	rc;
+	size_t		nbytes;
+	int			i;
+
+	memset(&hctl, 0, sizeof(HASHCTL));
+	hctl.keysize = sizeof(FuncOpCode);
+	hctl.entrysize = sizeof(xpu_function_catalog_entry);
+	hctl.hcxt = TopMemoryContext;
+	htab = hash_create("CUDA device function hash table",
+					   1024,
+					   &hctl,
+					   HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+
+	rc = cuModuleGetGlobal(&dptr, &nbytes, cuda_module, symbol);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuModuleGetGlobal('%s'): %s",
+			 symbol, cuStrError(rc));
+	xpu_funcs_catalog = alloca(nbytes);
+	rc = cuMemcpyDtoH(xpu_funcs_catalog, dptr, nbytes);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuMemcpyDtoH: %s", cuStrError(rc));
+	for (i=0; xpu_funcs_catalog[i].func_opcode != FuncOpCode__Invalid; i++)
+	{
+		FuncOpCode	func_opcode = xpu_funcs_catalog[i].func_opcode;
+		xpu_function_catalog_entry *entry;
+		bool		found;
+
+		entry = hash_search(htab, &func_opcode, HASH_ENTER, &found);
+		if (found)
+			elog(ERROR, "Bug? duplicated FuncOpCode: %u", (uint32_t)func_opcode);
+		Assert(entry->func_opcode == func_opcode);
+		entry->func_dptr = xpu_funcs_catalog[i].func_dptr;
+	}
+	return htab;
+}
+
+/*
+ * __setupDevEncodeLinkageCatalog
+ */
+static xpu_encode_info *
+__setupDevEncodeLinkageCatalog(CUmodule cuda_module)
+{
+	xpu_encode_info *xpu_encode_catalog;
+	const char *symbol = "xpu_encode_catalog";
+	CUdeviceptr	dptr;
+	CUresult	rc;
+	size_t		nbytes;
+
+	rc = cuModuleGetGlobal(&dptr, &nbytes, cuda_module, symbol);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuModuleGetGlobal('%s'): %s",
+			 symbol, cuStrError(rc));
+	xpu_encode_catalog = MemoryContextAlloc(TopMemoryContext, nbytes);
+	rc = cuMemcpyDtoH(xpu_encode_catalog, dptr, nbytes);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuMemcpyDtoH: %s", cuStrError(rc));
+
+	return xpu_encode_catalog;
+}
+
+/*
+ * __setupGpuKernelsSharedMemoryConfig
+ */
+static void
+__setupGpuKernelsSharedMemoryConfig(gpuContext *gcontext)
+{
+	GpuDevAttributes *dattrs = &gpuDevAttrs[gcontext->cuda_dindex];
+	CUmodule	cuda_module = gcontext->cuda_module;
+	CUfunction	cuda_function;
+	CUresult	rc;
+	int			shmem_sz_static;
+	int			shmem_sz_dynamic;
+	const char *fname = "kern_gpujoin_main";
+
+	Assert(gcontext->cuda_dindex < numGpuDevAttrs);
+	rc = cuModuleGetFunction(&cuda_function, cuda_module, fname);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuModuleGetFunction('%s'): %s",
+			 fname, cuStrError(rc));
+
+	rc = cuFuncGetAttribute(&shmem_sz_static,
+							CU_FUNC_ATTRIBUTE_SHARED_SIZE_BYTES,
+							cuda_function);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuFuncGetAttribute(SHARED_SIZE_BYTES): %s",
+			 cuStrError(rc));
+
+	shmem_sz_dynamic = (dattrs->MAX_SHARED_MEMORY_PER_BLOCK_OPTIN
+						- TYPEALIGN(1024, shmem_sz_static)
+						- 8192);	/* margin for L1-cache */
+
+	rc = cuFuncSetAttribute(cuda_function,
+							CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES,
+							shmem_sz_dynamic);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuFuncSetAttribute(MAX_DYNAMIC_SHARED_SIZE_BYTES, %d): %s",
+			 shmem_sz_dynamic, cuStrError(rc));
+
+	gcontext->gpumain_shmem_sz_dynamic = shmem_sz_dynamic;
+}
+
+/*
+ * gpuservPreloadGpuModules
+ *
+ * cuModuleLoad() of the fatbin takes a few seconds for each device, thus
+ * the primary contexts and modules are set up by threads in parallel, then
+ * gpuservSetupGpuContext() picks them up.
+ */
+typedef struct
+{
+	pthread_t	thread;
+	int			cuda_dindex;
+	CUcontext	cuda_context;
+	CUmodule	cuda_module;
+	CUresult	rc;
+	const char *fname;		/* CUDA API failed on */
+} gpuservPreloadModule;
+
+static gpuservPreloadModule *gpuserv_preload_modules = NULL;
+
+static void *
+__gpuservPreloadGpuModuleThread(void *__arg)
+{
+	gpuservPreloadModule *preload = __arg;
+	GpuDevAttributes *dattrs = &gpuDevAttrs[preload->cuda_dindex];
+	CUdevice	cuda_device;
+	CUresult	rc;
+
+	rc = cuDeviceGet(&cuda_device, dattrs->DEV_ID);
+	if (rc != CUDA_SUCCESS)
+	{
+		preload->fname = "cuDeviceGet";
+		goto bailout;
+	}
+	rc = cuDevicePrimaryCtxRetain(&preload->cuda_context, cuda_device);
+	if (rc != CUDA_SUCCESS)
+	{
+		preload->fname = "cuDevicePrimaryCtxRetain";
+		goto bailout;
+	}
+	preload->fname = "cuDevicePrimaryCtxSetFlags";
+	rc = cuDevicePrimaryCtxSetFlags(cuda_device, CU_CTX_SCHED_BLOCKING_SYNC);
+	if (rc == CUDA_SUCCESS)
+	{
+		preload->fname = "cuCtxSetCurrent";
+		rc = cuCtxSetCurrent(preload->cuda_context);
+	}
+	if (rc == CUDA_SUCCESS)
+	{
+		preload->fname = "cuModuleLoad";
+		rc = cuModuleLoad(&preload->cuda_module,
+						  pgstrom_fatbin_image_filename);
+	}
+	if (rc != CUDA_SUCCESS)
+	{
+		cuDevicePrimaryCtxRelease(cuda_device);
+		preload->cuda_context = NULL;
+		preload->cuda_module = NULL;
+	}
+bailout:
+	preload->rc = rc;
+	return NULL;
+}
+
+static void
+gpuservPreloadGpuModules(void)
+{
+	if (numGpuDevAttrs < 2)
+		return;		/* no parallelism */
+	gpuserv_preload_modules = calloc(numGpuDevAttrs,
+									 sizeof(gpuservPreloadModule));
+	if (!gpuserv_preload_modules)
+		return;
+	for (int i=0; i < numGpuDevAttrs; i++)
+	{
+		gpuservPreloadModule *preload = &gpuserv_preload_modules[i];
+
+		preload->cuda_dindex = i;
+		if ((errno = pthread_create(&preload->thread, NULL,
+									__gpuservPreloadGpuModuleThread,
+									preload)) != 0)
+		{
+			elog(LOG, "failed on pthread_create: %m");
+			preload->fname = "pthread_create";
+		}
+	}
+	for (int i=0; i < numGpuDevAttrs; i++)
+	{
+		gpuservPreloadModule *preload = &gpuserv_preload_modules[i];
 
-	return NULL;
+		if (preload->fname && strcmp(preload->fname, "pthread_create") == 0)
+			continue;
+		pthread_join(preload->thread, NULL);
+		if (preload->rc != CUDA_SUCCESS)
+			elog(LOG, "GPU%d: failed on %s: %s (retry on setup)",
+				 i, preload->fname, cuStrError(preload->rc));
+	}
 }
 
-static void *
-gpuservMonitorClient(void *__priv)
+/*
+ * gpuservSetupGpuModule
+ */
+static void
+gpuservSetupGpuModule(gpuContext *gcontext, CUmodule cuda_module)
 {
-	gpuClient  *gclient = __priv;
-	gpuContext *gcontext = gclient->gcontext;
-	pgsocket	sockfd = gclient->sockfd;
-	char		elabel[32];
 	CUresult	rc;
 
-	snprintf(elabel, sizeof(elabel), "GPU-%d", gcontext->cuda_dindex);
-
-	rc = cuCtxSetCurrent(gcontext->cuda_context);
-	if (rc != CUDA_SUCCESS)
+	if (!cuda_module)
 	{
-		__gsDebug("[%s] failed on cuCtxSetCurrent: %s\n",
-				  elabel, cuStrError(rc));
-		goto out;
+		rc = cuModuleLoad(&cuda_module, pgstrom_fatbin_image_filename);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on cuModuleLoad('%s'): %s",
+				 pgstrom_fatbin_image_filename,
+				 cuStrError(rc));
 	}
-	GpuWorkerCurrentContext = gcontext;
-	pg_memory_barrier();
+	/* setup XPU linkage hash tables */
+	gcontext->cuda_type_htab = __setupDevTypeLinkageTable(cuda_module);
+	gcontext->cuda_func_htab = __setupDevFuncLinkageTable(cuda_module);
+	gcontext->cuda_encode_catalog = __setupDevEncodeLinkageCatalog(cuda_module);
+	gcontext->cuda_module = cuda_module;
 
-	for (;;)
-	{
-		struct pollfd  pfd;
-		int		nevents;
+	/* adjust shared memory configuration */
+	__setupGpuKernelsSharedMemoryConfig(gcontext);
+}
 
-		pfd.fd = sockfd;
-		pfd.events = POLLIN;
-		pfd.revents = 0;
-		nevents = poll(&pfd, 1, -1);
-		if (nevents < 0)
-		{
-			if (errno == EINTR)
-				continue;
-			__gsDebug("[%s] failed on poll(2): %m", elabel);
+/* ----------------------------------------------------------------
+ *
+ * Session specialized GPU modules (JIT)
+ *
+ * The generic fatbin calls the device functions through the function
+ * pointers (kexp->fn_dptr) being set up at OpenSession, thus no inlining
+ * is possible across expression nodes. If the same set of opcodes appears
+ * in repeated sessions (like dashboard queries), we build a specialized
+ * fatbin for the set of opcodes in background, then the later sessions
+ * use the module that calls the device functions directly.
+ * The fatbin is cached on PGSTROM_FATBIN_DIR, keyed by the hash of the
+ * opcodes set, so it is reused after restart of the GPU-Service.
+ *
+ * ----------------------------------------------------------------
+ */
+static bool		pgstrom_gpu_jit_specialization;		/* GUC */
+static int		pgstrom_gpu_jit_threshold;			/* GUC */
+
+#define GPUJIT_STATUS__NONE			0
+#define GPUJIT_STATUS__REQUESTED	1	/* waiting for the main thread */
+#define GPUJIT_STATUS__BUILDING		2	/* builder thread is working */
+#define GPUJIT_STATUS__BUILT		3	/* fatbin is ready, but not loaded */
+#define GPUJIT_STATUS__READY		4
+#define GPUJIT_STATUS__FAILED		5
+
+#define GPUJIT_MAX_OPCODES			400
+
+typedef struct
+{
+	dlist_node		chain;		/* link to gpuserv_jit_module_list */
+	uint64_t		jit_hash;	/* hash of opcodes[] */
+	volatile int	status;		/* one of GPUJIT_STATUS__* */
+	uint32_t		nhits;		/* # of sessions with this opcodes set */
+	char		   *fatbin_path;
+	char		   *build_cmd;
+	char		   *build_dir;	/* work directory of the builder */
+	int				nopcodes;
+	uint32_t	   *opcodes;
+	gpuModuleLinkage linkage[FLEXIBLE_ARRAY_MEMBER];	/* per device */
+} gpuJitModule;
+
+static pthread_mutex_t	gpuserv_jit_lock;
+static dlist_head		gpuserv_jit_module_list;
+static bool				gpuserv_jit_builder_running = false;
+
+static int
+__compareGpuJitOpcodes(const void *__a, const void *__b)
+{
+	uint32_t	a = *((const uint32_t *)__a);
+	uint32_t	b = *((const uint32_t *)__b);
+
+	if (a < b)
+		return -1;
+	if (a > b)
+		return 1;
+	return 0;
+}
+
+static bool
+__collectGpuJitOpcodesWalker(const kern_expression *kexp,
+							 uint32_t *opcodes, int *p_nopcodes)
+{
+	const kern_expression *karg;
+	int		i, n = *p_nopcodes;
+
+	for (i=0; i < n; i++)
+	{
+		if (opcodes[i] == (uint32_t)kexp->opcode)
 			break;
-		}
-		if (nevents == 0)
-			continue;
-		Assert(nevents == 1);
-		if (pfd.revents == POLLIN)
+	}
+	if (i == n)
+	{
+		if (n >= GPUJIT_MAX_OPCODES)
+			return false;
+		opcodes[n++] = (uint32_t)kexp->opcode;
+		*p_nopcodes = n;
+	}
+	if (kexp->opcode == FuncOpCode__CaseWhenExpr)
+	{
+		if (kexp->u.casewhen.case_comp)
 		{
-			if (__gpuServiceReceiveCommands(sockfd, gclient, elabel) < 0)
-				break;
+			karg = (const kern_expression *)
+				((const char *)kexp + kexp->u.casewhen.case_comp);
+			if (!__collectGpuJitOpcodesWalker(karg, opcodes, p_nopcodes))
+				return false;
 		}
-		else if (pfd.revents & ~POLLIN)
+		if (kexp->u.casewhen.case_else)
 		{
-			__gsDebug("[%s] peer socket closed.", elabel);
-			break;
+			karg = (const kern_expression *)
+				((const char *)kexp + kexp->u.casewhen.case_else);
+			if (!__collectGpuJitOpcodesWalker(karg, opcodes, p_nopcodes))
+				return false;
 		}
 	}
-out:
-	gpuClientPut(gclient, true);
-	return NULL;
+	for (i=0, karg = KEXP_FIRST_ARG(kexp);
+		 i < kexp->nr_args;
+		 i++, karg = KEXP_NEXT_ARG(karg))
+	{
+		if (!__collectGpuJitOpcodesWalker(karg, opcodes, p_nopcodes))
+			return false;
+	}
+	return true;
+}
+
+static int
+__collectGpuJitOpcodes(kern_session_info *session, uint32_t *opcodes)
+{
+	kern_expression *__kexp[20];
+	int		nitems = 0;
+	int		nopcodes = 0;
+
+	__kexp[nitems++] = SESSION_KEXP_LOAD_VARS(session, -1);
+	__kexp[nitems++] = SESSION_KEXP_MOVE_VARS(session, -1);
+	__kexp[nitems++] = SESSION_KEXP_SCAN_QUALS(session);
+	__kexp[nitems++] = SESSION_KEXP_JOIN_QUALS(session, -1);
+	__kexp[nitems++] = SESSION_KEXP_HASH_VALUE(session, -1);
+	__kexp[nitems++] = SESSION_KEXP_GIST_EVALS(session, -1);
+	__kexp[nitems++] = SESSION_KEXP_RANGE_KEY(session, -1);
+	__kexp[nitems++] = SESSION_KEXP_PROJECTION(session);
+	__kexp[nitems++] = SESSION_KEXP_GROUPBY_KEYHASH(session);
+	__kexp[nitems++] = SESSION_KEXP_GROUPBY_KEYLOAD(session);
+	__kexp[nitems++] = SESSION_KEXP_GROUPBY_KEYCOMP(session);
+	__kexp[nitems++] = SESSION_KEXP_GROUPBY_ACTIONS(session);
+
+	for (int i=0; i < nitems; i++)
+	{
+		if (__kexp[i] && !__collectGpuJitOpcodesWalker(__kexp[i],
+													   opcodes,
+													   &nopcodes))
+			return -1;
+	}
+	if (nopcodes > 0)
+		qsort(opcodes, nopcodes, sizeof(uint32_t), __compareGpuJitOpcodes);
+	return nopcodes;
 }
 
 /*
- * gpuservAcceptClient
+ * gpuservLookupJitModule
+ *
+ * It is called by the worker thread on OpenSession, to choose the module
+ * to be used in the session. It also counts up the number of sessions with
+ * the same opcodes set, and requests the main thread to build a specialized
+ * module once it reached the pg_strom.gpu_jit_threshold.
  */
 static void
-gpuservAcceptClient(gpuContext *gcontext)
+gpuservLookupJitModule(gpuClient *gclient,
+					   kern_session_info *session,
+					   gpuModuleLinkage *linkage)
 {
-	gpuClient  *gclient;
-	pgsocket	sockfd;
-	int			errcode;
+	gpuContext	   *gcontext = gclient->gcontext;
+	gpuJitModule   *jmod = NULL;
+	uint32_t		opcodes[GPUJIT_MAX_OPCODES];
+	int				nopcodes;
+	uint64_t		jit_hash;
+	dlist_iter		iter;
 
-	sockfd = accept(gcontext->serv_fd, NULL, NULL);
-	if (sockfd < 0)
-	{
-		elog(LOG, "GPU%d: could not accept new connection: %m",
-			 gcontext->cuda_dindex);
-		pg_usleep(10000L);		/* wait 10ms */
+	/* default: generic module */
+	linkage->cuda_module = gcontext->cuda_module;
+	linkage->cuda_type_htab = gcontext->cuda_type_htab;
+	linkage->cuda_func_htab = gcontext->cuda_func_htab;
+	linkage->cuda_encode_catalog = gcontext->cuda_encode_catalog;
+
+	if (!pgstrom_gpu_jit_specialization || !pgstrom_fatbin_image_basename)
 		return;
-	}
+	nopcodes = __collectGpuJitOpcodes(session, opcodes);
+	if (nopcodes <= 0)
+		return;
+	jit_hash = hash_bytes_extended((const unsigned char *)opcodes,
+								   sizeof(uint32_t) * nopcodes, 0);
 
-	gclient = calloc(1, sizeof(gpuClient));
-	if (!gclient)
+	pthreadMutexLock(&gpuserv_jit_lock);
+	dlist_foreach(iter, &gpuserv_jit_module_list)
 	{
-		elog(LOG, "GPU%d: out of memory: %m",
-			 gcontext->cuda_dindex);
-		close(sockfd);
-		return;
-	}
-	gclient->gcontext = gcontext;
-	pg_atomic_init_u32(&gclient->refcnt, 1);
-	pthreadMutexInit(&gclient->mutex);
-	gclient->sockfd = sockfd;
+		gpuJitModule   *curr = dlist_container(gpuJitModule, chain, iter.cur);
 
-	if ((errcode = pthread_create(&gclient->worker, NULL,
-								  gpuservMonitorClient,
-								  gclient)) != 0)
+		if (curr->jit_hash == jit_hash &&
+			curr->nopcodes == nopcodes &&
+			memcmp(curr->opcodes, opcodes, sizeof(uint32_t) * nopcodes) == 0)
+		{
+			jmod = curr;
+			break;
+		}
+	}
+	if (!jmod)
 	{
-		elog(LOG, "failed on pthread_create: %s", strerror(errcode));
-		close(sockfd);
-		free(gclient);
-		return;
+		jmod = calloc(1, offsetof(gpuJitModule, linkage[numGpuDevAttrs]) +
+					  sizeof(uint32_t) * nopcodes);
+		if (!jmod)
+			goto out;	/* not a fatal error */
+		jmod->jit_hash = jit_hash;
+		jmod->status = GPUJIT_STATUS__NONE;
+		jmod->nopcodes = nopcodes;
+		jmod->opcodes = (uint32_t *)&jmod->linkage[numGpuDevAttrs];
+		memcpy(jmod->opcodes, opcodes, sizeof(uint32_t) * nopcodes);
+		dlist_push_tail(&gpuserv_jit_module_list, &jmod->chain);
 	}
-	pthreadMutexLock(&gcontext->client_lock);
-	dlist_push_tail(&gcontext->client_list, &gclient->chain);
-	pthreadMutexUnlock(&gcontext->client_lock);
+	jmod->nhits++;
+	if (jmod->status == GPUJIT_STATUS__NONE &&
+		jmod->nhits >= pgstrom_gpu_jit_threshold)
+	{
+		jmod->status = GPUJIT_STATUS__REQUESTED;
+		__gsDebug("JIT module %016lx (nopcodes=%d) is requested",
+				  jit_hash, nopcodes);
+	}
+	else if (jmod->status == GPUJIT_STATUS__READY &&
+			 jmod->linkage[gcontext->cuda_dindex].cuda_module != NULL)
+	{
+		memcpy(linkage, &jmod->linkage[gcontext->cuda_dindex],
+			   sizeof(gpuModuleLinkage));
+	}
+out:
+	pthreadMutexUnlock(&gpuserv_jit_lock);
 }
 
 /*
- * __setupDevTypeLinkageTable
+ * __gpuJitRemoveWorkDir - remove the work directory of the JIT build
  */
-static HTAB *
-__setupDevTypeLinkageTable(CUmodule cuda_module)
+static void
+__gpuJitRemoveWorkDir(const char *workdir)
 {
-	xpu_type_catalog_entry *xpu_types_catalog;
-	const char *symbol = "builtin_xpu_types_catalog";
-	HASHCTL		hctl;
-	HTAB	   *htab = NULL;
-	CUdeviceptr	dptr;
-	CUresult	rc;
-	size_t		nbytes;
-	int			i;
-	
-	/* build device type table */
-	memset(&hctl, 0, sizeof(HASHCTL));
-	hctl.keysize = sizeof(TypeOpCode);
-	hctl.entrysize = sizeof(xpu_type_catalog_entry);
-	hctl.hcxt = TopMemoryContext;
-	htab = hash_create("CUDA device type hash table",
-					   512,
-					   &hctl,
-					   HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
-
-	rc = cuModuleGetGlobal(&dptr, &nbytes, cuda_module, symbol);
-	if (rc != CUDA_SUCCESS)
-		elog(ERROR, "failed on cuModuleGetGlobal('%s'): %s",
-			 symbol, cuStrError(rc));
+	DIR		   *dir;
+	struct dirent *dentry;
+	char		path[MAXPGPATH];
 
-	xpu_types_catalog = alloca(nbytes);
-	rc = cuMemcpyDtoH(xpu_types_catalog, dptr, nbytes);
-	if (rc != CUDA_SUCCESS)
-		elog(ERROR, "failed on cuMemcpyDtoH: %s", cuStrError(rc));
-	for (i=0; xpu_types_catalog[i].type_opcode != TypeOpCode__Invalid; i++)
+	dir = opendir(workdir);
+	if (dir)
 	{
-		TypeOpCode	type_opcode = xpu_types_catalog[i].type_opcode;
-		xpu_type_catalog_entry *entry;
-		bool		found;
+		while ((dentry = readdir(dir)) != NULL)
+		{
+			if (strcmp(dentry->d_name, ".") == 0 ||
+				strcmp(dentry->d_name, "..") == 0)
+				continue;
+			snprintf(path, sizeof(path), "%s/%s", workdir, dentry->d_name);
+			if (unlink(path) != 0)
+				__gsLog("failed on unlink('%s'): %m", path);
+		}
+		closedir(dir);
+	}
+	if (rmdir(workdir) != 0)
+		__gsLog("failed on rmdir('%s'): %m", workdir);
+}
 
-		entry = hash_search(htab, &type_opcode, HASH_ENTER, &found);
-		if (found)
-			elog(ERROR, "Bug? duplicated TypeOpCode: %u", (uint32_t)type_opcode);
-		Assert(entry->type_opcode == type_opcode);
-		entry->type_ops = xpu_types_catalog[i].type_ops;
+/*
+ * __gpuJitBuilderMain - builder thread of the specialized fatbin
+ */
+static void *
+__gpuJitBuilderMain(void *__priv)
+{
+	gpuJitModule   *jmod = __priv;
+	int				status;
+
+	status = system(jmod->build_cmd);
+	/* fatbin is installed on PGSTROM_FATBIN_DIR, so work directory is no longer needed */
+	__gpuJitRemoveWorkDir(jmod->build_dir);
+
+	pthreadMutexLock(&gpuserv_jit_lock);
+	free(jmod->build_dir);
+	jmod->build_dir = NULL;
+	if (status == 0 && access(jmod->fatbin_path, R_OK) == 0)
+		jmod->status = GPUJIT_STATUS__BUILT;
+	else
+	{
+		__gsLog("failed on the build of JIT module [%s]", jmod->build_cmd);
+		jmod->status = GPUJIT_STATUS__FAILED;
 	}
-	return htab;
+	gpuserv_jit_builder_running = false;
+	pthreadMutexUnlock(&gpuserv_jit_lock);
+
+	return NULL;
 }
 
 /*
- * __setupDevFuncLinkageTable
+ * __gpuJitLaunchBuilder
+ *
+ * MEMO: caller must hold gpuserv_jit_lock
  */
-static HTAB *
-__setupDevFuncLinkageTable(CUmodule cuda_module)
+static bool
+__gpuJitLaunchBuilder(gpuJitModule *jmod)
 {
-	xpu_function_catalog_entry *xpu_funcs_catalog;
-	const char *symbol = "builtin_xpu_functions_catalog";
-	HASHCTL		hctl;
-	HTAB	   *htab;
-	CUdeviceptr	dptr;
-	CUresult	rc;
-	size_t		nbytes;
-	int			i;
+	StringInfoData cmd;
+	char	workdir[200];
+	char	path[MAXPGPATH];
+	char   *namebuf;
+	char   *tok, *pos;
+	FILE   *filp;
+	pthread_t thread;
+	int		count;
 
-	memset(&hctl, 0, sizeof(HASHCTL));
-	hctl.keysize = sizeof(FuncOpCode);
-	hctl.entrysize = sizeof(xpu_function_catalog_entry);
-	hctl.hcxt = TopMemoryContext;
-	htab = hash_create("CUDA device function hash table",
-					   1024,
-					   &hctl,
-					   HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+	strcpy(workdir, "/tmp/.pgstrom_jit_build_XXXXXX");
+	if (!mkdtemp(workdir))
+	{
+		elog(LOG, "unable to create work directory for JIT module build: %m");
+		return false;
+	}
+	/* header file to tell the set of opcodes */
+	snprintf(path, sizeof(path), "%s/pgstrom_jit_opcodes.h", workdir);
+	filp = fopen(path, "wb");
+	if (!filp)
+	{
+		elog(LOG, "failed on fopen('%s'): %m", path);
+		goto bailout;
+	}
+	fprintf(filp,
+			"/* auto-generated by PG-Strom; opcodes used in the session */\n"
+			"#define PGSTROM_JIT_OPCODE_USED(x)\t\\\n"
+			"\t(");
+	for (int i=0; i < jmod->nopcodes; i++)
+	{
+		if (i > 0)
+			fprintf(filp, " ||%s", (i % 8) == 0 ? "\t\\\n\t " : " ");
+		fprintf(filp, "(x)==%u", jmod->opcodes[i]);
+	}
+	fprintf(filp, ")\n");
+	if (fclose(filp) != 0)
+	{
+		elog(LOG, "failed on fclose('%s'): %m", path);
+		goto bailout;
+	}
+
+	namebuf = alloca(sizeof(CUDA_CORE_FILES) + 1);
+	strcpy(namebuf, CUDA_CORE_FILES);
 
-	rc = cuModuleGetGlobal(&dptr, &nbytes, cuda_module, symbol);
-	if (rc != CUDA_SUCCESS)
-		elog(ERROR, "failed on cuModuleGetGlobal('%s'): %s",
-			 symbol, cuStrError(rc));
-	xpu_funcs_catalog = alloca(nbytes);
-	rc = cuMemcpyDtoH(xpu_funcs_catalog, dptr, nbytes);
-	if (rc != CUDA_SUCCESS)
-		elog(ERROR, "failed on cuMemcpyDtoH: %s", cuStrError(rc));
-	for (i=0; xpu_funcs_catalog[i].func_opcode != FuncOpCode__Invalid; i++)
+	initStringInfo(&cmd);
+	appendStringInfo(&cmd, "(cd '%s' && (", workdir);
+	for (tok = strtok_r(namebuf, " ", &pos), count=0;
+		 tok != NULL;
+		 tok = strtok_r(NULL,    " ", &pos), count++)
 	{
-		FuncOpCode	func_opcode = xpu_funcs_catalog[i].func_opcode;
-		xpu_function_catalog_entry *entry;
-		bool		found;
+		appendStringInfo(&cmd,
+						 " /bin/sh -c '%s/bin/nvcc"
+						 " --maxrregcount=%d"
+						 " -I. -I%s "
+						 " -DHAVE_FLOAT2 "
+						 " -DPGSTROM_JIT_SPECIALIZED=1"
+						 " -include pgstrom_jit_opcodes.h"
+						 " -arch=native -dlto --threads 4"
+						 " --device-c"
+						 " -o %s.o"
+						 " %s/pg_strom/%s.cu' > %s.log 2>&1 &",
+						 pgstrom_cuda_toolkit_basedir,
+						 CUDA_MAXREGCOUNT,
+						 PGINCLUDEDIR,
+						 tok,
+						 PGSHAREDIR, tok, tok);
+	}
+	appendStringInfo(&cmd,
+					 " wait ) &&"
+					 " /bin/sh -c '%s/bin/nvcc"
+					 " -Xnvlink --suppress-stack-size-warning"
+					 " -arch=native -dlto --threads 4"
+					 " --device-link --fatbin"
+					 " -o jit.fatbin",
+					 pgstrom_cuda_toolkit_basedir);
+	strcpy(namebuf, CUDA_CORE_FILES);
+	for (tok = strtok_r(namebuf, " ", &pos);
+		 tok != NULL;
+		 tok = strtok_r(NULL,    " ", &pos))
+	{
+		appendStringInfo(&cmd, " %s.o", tok);
+	}
+	appendStringInfo(&cmd,
+					 "' > jit.log 2>&1 ) &&"
+					 " mkdir -p '%s' &&"
+					 " install -m 0644 '%s/jit.fatbin' '%s'",
+					 PGSTROM_FATBIN_DIR,
+					 workdir, jmod->fatbin_path);
+	jmod->build_cmd = strdup(cmd.data);
+	jmod->build_dir = strdup(workdir);
+	pfree(cmd.data);
+	if (!jmod->build_cmd || !jmod->build_dir)
+		goto bailout;
 
-		entry = hash_search(htab, &func_opcode, HASH_ENTER, &found);
-		if (found)
-			elog(ERROR, "Bug? duplicated FuncOpCode: %u", (uint32_t)func_opcode);
-		Assert(entry->func_opcode == func_opcode);
-		entry->func_dptr = xpu_funcs_catalog[i].func_dptr;
+	if (pthread_create(&thread, NULL, __gpuJitBuilderMain, jmod) != 0)
+	{
+		elog(LOG, "failed on pthread_create: %m");
+		goto bailout;
 	}
-	return htab;
+	pthread_detach(thread);
+	elog(LOG, "PG-Strom JIT module build in progress: %s", jmod->fatbin_path);
+	return true;
+
+bailout:
+	if (jmod->build_cmd)
+		free(jmod->build_cmd);
+	if (jmod->build_dir)
+		free(jmod->build_dir);
+	jmod->build_cmd = NULL;
+	jmod->build_dir = NULL;
+	__gpuJitRemoveWorkDir(workdir);
+	return false;
 }
 
 /*
- * __setupDevEncodeLinkageCatalog
+ * __gpuJitLoadModules
  */
-static xpu_encode_info *
-__setupDevEncodeLinkageCatalog(CUmodule cuda_module)
+static bool
+__gpuJitLoadModules(gpuJitModule *jmod)
 {
-	xpu_encode_info *xpu_encode_catalog;
-	const char *symbol = "xpu_encode_catalog";
-	CUdeviceptr	dptr;
-	CUresult	rc;
-	size_t		nbytes;
+	volatile bool	retval = true;
+	dlist_iter		iter;
 
-	rc = cuModuleGetGlobal(&dptr, &nbytes, cuda_module, symbol);
-	if (rc != CUDA_SUCCESS)
-		elog(ERROR, "failed on cuModuleGetGlobal('%s'): %s",
-			 symbol, cuStrError(rc));
-	xpu_encode_catalog = MemoryContextAlloc(TopMemoryContext, nbytes);
-	rc = cuMemcpyDtoH(xpu_encode_catalog, dptr, nbytes);
-	if (rc != CUDA_SUCCESS)
-		elog(ERROR, "failed on cuMemcpyDtoH: %s", cuStrError(rc));
+	dlist_foreach(iter, &gpuserv_gpucontext_list)
+	{
+		gpuContext *gcontext = dlist_container(gpuContext, chain, iter.cur);
+		gpuModuleLinkage *linkage = &jmod->linkage[gcontext->cuda_dindex];
+		CUmodule	cuda_module;
+		CUfunction	cuda_function;
+		CUresult	rc;
 
-	return xpu_encode_catalog;
+		rc = cuCtxSetCurrent(gcontext->cuda_context);
+		if (rc != CUDA_SUCCESS)
+		{
+			elog(LOG, "failed on cuCtxSetCurrent: %s", cuStrError(rc));
+			return false;
+		}
+		rc = cuModuleLoad(&cuda_module, jmod->fatbin_path);
+		if (rc != CUDA_SUCCESS)
+		{
+			elog(LOG, "failed on cuModuleLoad('%s'): %s",
+				 jmod->fatbin_path, cuStrError(rc));
+			return false;
+		}
+		/* same shared memory configuration with the generic module */
+		rc = cuModuleGetFunction(&cuda_function, cuda_module,
+								 "kern_gpujoin_main");
+		if (rc == CUDA_SUCCESS)
+			rc = cuFuncSetAttribute(cuda_function,
+									CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES,
+									gcontext->gpumain_shmem_sz_dynamic);
+		if (rc != CUDA_SUCCESS)
+		{
+			elog(LOG, "unable to setup JIT module '%s': %s",
+				 jmod->fatbin_path, cuStrError(rc));
+			cuModuleUnload(cuda_module);
+			return false;
+		}
+		PG_TRY();
+		{
+			linkage->cuda_type_htab = __setupDevTypeLinkageTable(cuda_module);
+			linkage->cuda_func_htab = __setupDevFuncLinkageTable(cuda_module);
+			linkage->cuda_encode_catalog = __setupDevEncodeLinkageCatalog(cuda_module);
+			linkage->cuda_module = cuda_module;
+		}
+		PG_CATCH();
+		{
+			EmitErrorReport();
+			FlushErrorState();
+			cuModuleUnload(cuda_module);
+			retval = false;
+		}
+		PG_END_TRY();
+		if (!retval)
+			break;
+	}
+	return retval;
 }
 
 /*
- * __setupGpuKernelsSharedMemoryConfig
+ * gpuservProcessJitModules
+ *
+ * It is called by the main thread to launch the builder, and to load
+ * the built modules.
  */
 static void
-__setupGpuKernelsSharedMemoryConfig(gpuContext *gcontext)
+gpuservProcessJitModules(void)
 {
-	GpuDevAttributes *dattrs = &gpuDevAttrs[gcontext->cuda_dindex];
-	CUmodule	cuda_module = gcontext->cuda_module;
-	CUfunction	cuda_function;
-	CUresult	rc;
-	int			shmem_sz_static;
-	int			shmem_sz_dynamic;
-	const char *fname = "kern_gpujoin_main";
-
-	Assert(gcontext->cuda_dindex < numGpuDevAttrs);
-	rc = cuModuleGetFunction(&cuda_function, cuda_module, fname);
-	if (rc != CUDA_SUCCESS)
-		elog(ERROR, "failed on cuModuleGetFunction('%s'): %s",
-			 fname, cuStrError(rc));
-
-	rc = cuFuncGetAttribute(&shmem_sz_static,
-							CU_FUNC_ATTRIBUTE_SHARED_SIZE_BYTES,
-							cuda_function);
-	if (rc != CUDA_SUCCESS)
-		elog(ERROR, "failed on cuFuncGetAttribute(SHARED_SIZE_BYTES): %s",
-			 cuStrError(rc));
-
-	shmem_sz_dynamic = (dattrs->MAX_SHARED_MEMORY_PER_BLOCK_OPTIN
-						- TYPEALIGN(1024, shmem_sz_static)
-						- 8192);	/* margin for L1-cache */
-
-	rc = cuFuncSetAttribute(cuda_function,
-							CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES,
-							shmem_sz_dynamic);
-	if (rc != CUDA_SUCCESS)
-		elog(ERROR, "failed on cuFuncSetAttribute(MAX_DYNAMIC_SHARED_SIZE_BYTES, %d): %s",
-			 shmem_sz_dynamic, cuStrError(rc));
+	gpuJitModule   *jmod_load = NULL;
+	dlist_iter		iter;
 
-	gcontext->gpumain_shmem_sz_dynamic = shmem_sz_dynamic;
-}
+	if (!pgstrom_gpu_jit_specialization)
+		return;
+	pthreadMutexLock(&gpuserv_jit_lock);
+	dlist_foreach(iter, &gpuserv_jit_module_list)
+	{
+		gpuJitModule   *jmod = dlist_container(gpuJitModule, chain, iter.cur);
 
-/*
- * gpuservSetupGpuModule
- */
-static void
-gpuservSetupGpuModule(gpuContext *gcontext)
-{
-	CUmodule	cuda_module;
-	CUresult	rc;
+		if (jmod->status == GPUJIT_STATUS__REQUESTED)
+		{
+			char	path[MAXPGPATH];
 
-	rc = cuModuleLoad(&cuda_module, pgstrom_fatbin_image_filename);
-	if (rc != CUDA_SUCCESS)
-		elog(ERROR, "failed on cuModuleLoad('%s'): %s",
-			 pgstrom_fatbin_image_filename,
-			 cuStrError(rc));
-	/* setup XPU linkage hash tables */
-	gcontext->cuda_type_htab = __setupDevTypeLinkageTable(cuda_module);
-	gcontext->cuda_func_htab = __setupDevFuncLinkageTable(cuda_module);
-	gcontext->cuda_encode_catalog = __setupDevEncodeLinkageCatalog(cuda_module);
-	gcontext->cuda_module = cuda_module;
+			if (!jmod->fatbin_path)
+			{
+				snprintf(path, sizeof(path), "%s/%s-jit%016lx.fatbin",
+						 PGSTROM_FATBIN_DIR,
+						 pgstrom_fatbin_image_basename,
+						 jmod->jit_hash);
+				jmod->fatbin_path = strdup(path);
+				if (!jmod->fatbin_path)
+				{
+					jmod->status = GPUJIT_STATUS__FAILED;
+					continue;
+				}
+			}
+			/* already cached on the disk? */
+			if (access(jmod->fatbin_path, R_OK) == 0)
+				jmod->status = GPUJIT_STATUS__BUILT;
+			else if (!gpuserv_jit_builder_running)
+			{
+				if (__gpuJitLaunchBuilder(jmod))
+				{
+					jmod->status = GPUJIT_STATUS__BUILDING;
+					gpuserv_jit_builder_running = true;
+				}
+				else
+					jmod->status = GPUJIT_STATUS__FAILED;
+			}
+		}
+		if (jmod->status == GPUJIT_STATUS__BUILT && !jmod_load)
+			jmod_load = jmod;
+	}
+	pthreadMutexUnlock(&gpuserv_jit_lock);
 
-	/* adjust shared memory configuration */
-	__setupGpuKernelsSharedMemoryConfig(gcontext);
+	/*
+	 * BUILT status is never changed by others than the main thread,
+	 * so we can load the module without gpuserv_jit_lock.
+	 */
+	if (jmod_load)
+	{
+		bool	status = __gpuJitLoadModules(jmod_load);
+
+		pthreadMutexLock(&gpuserv_jit_lock);
+		jmod_load->status = (status
+							 ? GPUJIT_STATUS__READY
+							 : GPUJIT_STATUS__FAILED);
+		pthreadMutexUnlock(&gpuserv_jit_lock);
+		if (status)
+			elog(LOG, "PG-Strom JIT module is ready: %s",
+				 jmod_load->fatbin_path);
+	}
 }
 
 /*
@@ -3242,7 +7595,7 @@ __gpuContextAdjustWorkersOne(gpuContext *gcontext, uint32_t nworkers)
 	}
 	pthreadMutexUnlock(&gcontext->worker_lock);
 	if (needs_wakeup)
-		pthreadCondBroadcast(&gcontext->cond);
+		__gpuContextWakeupWorkers(gcontext);
 	if (count >= nworkers && has_gpucache)
 		goto out;
 
@@ -3255,6 +7608,7 @@ __gpuContextAdjustWorkersOne(gpuContext *gcontext, uint32_t nworkers)
 	while (count < nworkers)
 	{
 		gpuWorker  *gworker = calloc(1, sizeof(gpuWorker));
+		gpuWorkerQueue *wqueue = NULL;
 
 		if (!gworker)
 		{
@@ -3263,12 +7617,44 @@ __gpuContextAdjustWorkersOne(gpuContext *gcontext, uint32_t nworkers)
 		}
 		gworker->gcontext = gcontext;
 		gworker->kind = GPUSERV_WORKER_KIND__GPUTASK;
+		/* assign a command queue for the new worker */
+		pthreadMutexLock(&gcontext->worker_lock);
+		for (int i=0; i < GPUSERV_MAX_WORKER_QUEUES; i++)
+		{
+			if (!gcontext->queues[i].owned)
+			{
+				wqueue = &gcontext->queues[i];
+				pthreadMutexLock(&wqueue->lock);
+				wqueue->owned = true;
+				wqueue->active = true;
+				wqueue->idle = false;
+				pthreadMutexUnlock(&wqueue->lock);
+				gworker->qindex = i;
+				if (gcontext->num_queues <= i)
+					gcontext->num_queues = i + 1;
+				break;
+			}
+		}
+		pthreadMutexUnlock(&gcontext->worker_lock);
+		if (!wqueue)
+		{
+			elog(LOG, "GPU%d: no command queue is available for new worker",
+				 gcontext->cuda_dindex);
+			free(gworker);
+			break;
+		}
 		if ((errno = pthread_create(&gworker->worker,
 									&th_attr,
 									gpuservGpuWorkerMain,
 									gworker)) != 0)
 		{
 			elog(LOG, "failed on pthread_create: %m");
+			pthreadMutexLock(&gcontext->worker_lock);
+			pthreadMutexLock(&wqueue->lock);
+			wqueue->active = false;
+			wqueue->owned = false;
+			pthreadMutexUnlock(&wqueue->lock);
+			pthreadMutexUnlock(&gcontext->worker_lock);
 			free(gworker);
 			break;
 		}
@@ -3329,8 +7715,17 @@ __gpuContextAdjustWorkers(void)
 		dlist_foreach(iter, &gpuserv_gpucontext_list)
 		{
 			gpuContext *gcontext = dlist_container(gpuContext, chain, iter.cur);
-
-			__gpuContextAdjustWorkersOne(gcontext, nworkers);
+			GpuDevAttributes *dattrs = &gpuDevAttrs[gcontext->cuda_dindex];
+			uint32_t	__nworkers = nworkers;
+
+			/* MIG instances and MPS clients share the physical GPU */
+			if (dattrs->DEV_MIG_SIBLINGS > 1)
+				__nworkers = ((__nworkers + dattrs->DEV_MIG_SIBLINGS - 1) /
+							  dattrs->DEV_MIG_SIBLINGS);
+			if (dattrs->DEV_MPS_THREAD_PERCENTAGE > 0)
+				__nworkers = ((__nworkers * dattrs->DEV_MPS_THREAD_PERCENTAGE
+							   + 99) / 100);
+			__gpuContextAdjustWorkersOne(gcontext, Max(__nworkers, 1));
 		}
 	}
 }
@@ -3350,7 +7745,7 @@ __gpuContextTerminateWorkers(gpuContext *gcontext)
 
 	for (;;)
 	{
-		pthreadCondBroadcast(&gcontext->cond);
+		__gpuContextWakeupWorkers(gcontext);
 		gpucacheManagerWakeUp(gcontext->cuda_dindex);
 
 		pthreadMutexLock(&gcontext->worker_lock);
@@ -3372,11 +7767,15 @@ static gpuContext *
 gpuservSetupGpuContext(int cuda_dindex)
 {
 	GpuDevAttributes *dattrs = &gpuDevAttrs[cuda_dindex];
+	gpuservPreloadModule *preload = NULL;
 	gpuContext *gcontext = NULL;
 	CUresult	rc;
 	struct sockaddr_un addr;
 	struct epoll_event ev;
 
+	if (gpuserv_preload_modules &&
+		gpuserv_preload_modules[cuda_dindex].cuda_module)
+		preload = &gpuserv_preload_modules[cuda_dindex];
 	/* gpuContext allocation */
 	gcontext = calloc(1, sizeof(gpuContext));
 	if (!gcontext)
@@ -3390,10 +7789,20 @@ gpuservSetupGpuContext(int cuda_dindex)
 	dlist_init(&gcontext->client_list);
 	pthreadMutexInit(&gcontext->worker_lock);
 	dlist_init(&gcontext->worker_list);
+	pthreadMutexInit(&gcontext->sscan_lock);
+	dlist_init(&gcontext->sscan_lru_list);
+
+	pg_atomic_init_u64(&gcontext->sched_vclock, 0);
+	pg_atomic_init_u32(&gcontext->queue_dispatch_count, 0);
+	gcontext->num_queues = 0;
+	for (int i=0; i < GPUSERV_MAX_WORKER_QUEUES; i++)
+	{
+		gpuWorkerQueue *wqueue = &gcontext->queues[i];
 
-	pthreadCondInit(&gcontext->cond);
-	pthreadMutexInit(&gcontext->lock);
-	dlist_init(&gcontext->command_list);
+		pthreadMutexInit(&wqueue->lock);
+		pthreadCondInit(&wqueue->cond);
+		dlist_init(&wqueue->command_list);
+	}
 
 	PG_TRY();
 	{
@@ -3421,21 +7830,36 @@ gpuservSetupGpuContext(int cuda_dindex)
 		if (rc != CUDA_SUCCESS)
 			elog(ERROR, "failed on cuDeviceGet: %s", cuStrError(rc));
 
-		rc = cuDevicePrimaryCtxRetain(&gcontext->cuda_context,
-									  gcontext->cuda_device);
-		if (rc != CUDA_SUCCESS)
-			elog(ERROR, "failed on cuDevicePrimaryCtxRetain: %s", cuStrError(rc));
+		if (preload)
+		{
+			/* already retained by gpuservPreloadGpuModules */
+			gcontext->cuda_context = preload->cuda_context;
+		}
+		else
+		{
+			rc = cuDevicePrimaryCtxRetain(&gcontext->cuda_context,
+										  gcontext->cuda_device);
+			if (rc != CUDA_SUCCESS)
+				elog(ERROR, "failed on cuDevicePrimaryCtxRetain: %s", cuStrError(rc));
 
-		rc = cuDevicePrimaryCtxSetFlags(gcontext->cuda_device,
-										CU_CTX_SCHED_BLOCKING_SYNC);
-		if (rc != CUDA_SUCCESS)
-			elog(ERROR, "failed on cuDevicePrimaryCtxSetFlags: %s", cuStrError(rc));
+			rc = cuDevicePrimaryCtxSetFlags(gcontext->cuda_device,
+											CU_CTX_SCHED_BLOCKING_SYNC);
+			if (rc != CUDA_SUCCESS)
+				elog(ERROR, "failed on cuDevicePrimaryCtxSetFlags: %s", cuStrError(rc));
+		}
 
 		rc = cuCtxSetCurrent(gcontext->cuda_context);
 		if (rc != CUDA_SUCCESS)
 			elog(ERROR, "failed on cuCtxSetCurrent: %s", cuStrError(rc));
 
-		gpuservSetupGpuModule(gcontext);
+		gpuservSetupGpuModule(gcontext, preload ? preload->cuda_module : NULL);
+		if (preload)
+			preload->cuda_module = NULL;	/* now owned by gcontext */
+		__setupGpuPeerDevices(gcontext);
+		/* DMA buffer pool for the VFS fallback */
+		gpuDirectSetupDMABufferPool(cuda_dindex,
+									dattrs->NUMA_NODE_ID,
+									(size_t)pgstrom_gpudirect_dma_pool_size << 20);
 		/* enable kernel profiling if captured */
 		if (getenv("NSYS_PROFILING_SESSION_ID") != NULL)
 		{
@@ -3479,6 +7903,8 @@ gpuservCleanupGpuContext(gpuContext *gcontext)
 	}
 	if (close(gcontext->serv_fd) != 0)
 		elog(LOG, "failed on close(serv_fd): %m");
+	gpuDirectReleaseDMABufferPool(gcontext->cuda_dindex);
+	gpuservReleaseAllSharedScanChunks(gcontext);
 	if (gcontext->cuda_profiler_started)
 	{
 		rc = cuProfilerStop();
@@ -3552,6 +7978,8 @@ gpuservBgWorkerMain(Datum arg)
 
 	/* Registration of resource cleanup handler */
 	dlist_init(&gpuserv_gpucontext_list);
+	pthreadMutexInit(&gpuserv_jit_lock);
+	dlist_init(&gpuserv_jit_module_list);
 	before_shmem_exit(gpuservCleanupOnProcExit, 0);
 
 	/* Open epoll descriptor */
@@ -3561,7 +7989,10 @@ gpuservBgWorkerMain(Datum arg)
 	/* Open logger pipe for worker threads */
 	gpuservLoggerOpen();
 
-	/* Build the fatbin binary image on demand */
+	/*
+	 * Build the fatbin binary image on demand; the backends run the queries
+	 * without GPU until gpuserv_ready_accept, so it does not block sessions.
+	 */
 	gpuservSetupFatbin();
 
 	/* Init GPU Context for each devices */
@@ -3569,6 +8000,7 @@ gpuservBgWorkerMain(Datum arg)
 	if (rc != CUDA_SUCCESS)
 		elog(ERROR, "failed on cuInit: %s", cuStrError(rc));
 
+	gpuservPreloadGpuModules();
 	PG_TRY();
 	{
 		for (dindex=0; dindex < numGpuDevAttrs; dindex++)
@@ -3590,6 +8022,10 @@ gpuservBgWorkerMain(Datum arg)
 			CHECK_FOR_INTERRUPTS();
 			/* launch/eliminate worker threads */
 			__gpuContextAdjustWorkers();
+			/* build/load the session specialized modules */
+			gpuservProcessJitModules();
+			/* update pgstrom.gpu_mempool_info */
+			gpuservPublishMemoryPoolStats();
 
 			status = epoll_wait(gpuserv_epoll_fdesc, &ep_ev, 1, 4000);
 			if (status < 0)
@@ -3658,7 +8094,7 @@ pgstrom_request_executor(void)
 {
 	if (shmem_request_next)
 		(*shmem_request_next)();
-	RequestAddinShmemSpace(MAXALIGN(sizeof(gpuServSharedState)));
+	RequestAddinShmemSpace(GPUSERV_SHARED_STATE_LENGTH);
 }
 
 /*
@@ -3672,14 +8108,29 @@ pgstrom_startup_executor(void)
 	if (shmem_startup_next)
 		(*shmem_startup_next)();
 	gpuserv_shared_state = ShmemInitStruct("gpuServSharedState",
-										   MAXALIGN(sizeof(gpuServSharedState)),
+										   GPUSERV_SHARED_STATE_LENGTH,
 										   &found);
-	memset(gpuserv_shared_state, 0, sizeof(gpuServSharedState));
+	memset(gpuserv_shared_state, 0, GPUSERV_SHARED_STATE_LENGTH);
 	pg_atomic_init_u32(&gpuserv_shared_state->max_async_tasks_updated, 1);
 	pg_atomic_init_u32(&gpuserv_shared_state->max_async_tasks,
 					   __pgstrom_max_async_tasks_dummy);
 	pg_atomic_init_u32(&gpuserv_shared_state->gpuserv_debug_output,
 					   __gpuserv_debug_output_dummy);
+	for (int dindex=0; dindex < numGpuDevAttrs; dindex++)
+	{
+		gpuServDeviceStat *dstat = GPUSERV_DEVICE_STAT(dindex);
+
+		pg_atomic_init_u64(&dstat->nr_tasks_scan, 0);
+		pg_atomic_init_u64(&dstat->nr_tasks_join, 0);
+		pg_atomic_init_u64(&dstat->nr_tasks_preagg, 0);
+		pg_atomic_init_u64(&dstat->nr_suspend_resume, 0);
+		pg_atomic_init_u64(&dstat->nr_cpu_fallback, 0);
+		pg_atomic_init_u64(&dstat->nr_errors, 0);
+		pg_atomic_init_u64(&dstat->npages_direct_read, 0);
+		pg_atomic_init_u64(&dstat->npages_vfs_read, 0);
+		pg_atomic_init_u64(&dstat->queue_wait_us, 0);
+		pg_atomic_init_u64(&dstat->kernel_time_us, 0);
+	}
 }
 
 /*
@@ -3731,6 +8182,134 @@ pgstrom_init_gpu_service(void)
 							PGC_SIGHUP,
 							GUC_NOT_IN_SAMPLE | GUC_UNIT_MS | GUC_NO_SHOW_ALL,
 							NULL, NULL, NULL);
+	DefineCustomBoolVariable("pg_strom.gpu_shared_inner_buffer",
+							 "Enables to share identical GpuJoin inner buffers across queries",
+							 NULL,
+							 &pgstrom_gpu_shared_inner_buffer,
+							 true,
+							 PGC_SIGHUP,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	DefineCustomBoolVariable("pg_strom.gpu_peer_inner_buffer",
+							 "Enables to share GpuJoin inner buffers with the peer GPUs connected by NVLink",
+							 NULL,
+							 &pgstrom_gpu_peer_inner_buffer,
+							 true,
+							 PGC_SIGHUP,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	DefineCustomIntVariable("pg_strom.gpu_inner_buffer_cache_size",
+							"Total size of the idle GpuJoin inner buffers kept for rescans and repeated queries",
+							NULL,
+							&pgstrom_gpu_inner_buffer_cache_size,
+							1024,		/* 1GB */
+							0,
+							INT_MAX,
+							PGC_SIGHUP,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_MB,
+							NULL, NULL, NULL);
+	DefineCustomIntVariable("pg_strom.gpu_host_mapped_inner_size",
+							"Max size of the GpuJoin inner buffer that GPU kernel reads from the host memory without upload",
+							NULL,
+							&pgstrom_gpu_host_mapped_inner_size,
+							4096,		/* 4MB */
+							0,
+							1048576,	/* 1GB */
+							PGC_SIGHUP,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_KB,
+							NULL, NULL, NULL);
+	DefineCustomIntVariable("pg_strom.gpu_kernel_time_slice",
+							"Time-slice of GPU kernel; it yields SMs to other sessions, then resumes",
+							NULL,
+							&pgstrom_gpu_kernel_time_slice,
+							0,			/* disabled */
+							0,
+							INT_MAX,
+							PGC_SIGHUP,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_MS,
+							NULL, NULL, NULL);
+	DefineCustomRealVariable("pg_strom.gpu_admission_ratio",
+							 "Ratio of device memory for query buffers, beyond which new heavy sessions are delayed",
+							 NULL,
+							 &pgstrom_gpu_admission_ratio,
+							 0.75,		/* 75% */
+							 0.10,		/* 10% */
+							 1.00,		/* 100% */
+							 PGC_SIGHUP,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	DefineCustomIntVariable("pg_strom.gpu_admission_timeout",
+							"Maximum time to delay a new session for admission of its query buffer",
+							NULL,
+							&pgstrom_gpu_admission_timeout,
+							10000,		/* 10sec */
+							0,
+							INT_MAX,
+							PGC_SIGHUP,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_MS,
+							NULL, NULL, NULL);
+	DefineCustomBoolVariable("pg_strom.gpu_jit_specialization",
+							 "Enables GPU kernels specialized for the set of device functions in repeated sessions",
+							 NULL,
+							 &pgstrom_gpu_jit_specialization,
+							 false,
+							 PGC_SIGHUP,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	DefineCustomIntVariable("pg_strom.gpu_jit_threshold",
+							"Number of the sessions with same device functions to build the specialized GPU kernel",
+							NULL,
+							&pgstrom_gpu_jit_threshold,
+							3,
+							1,
+							INT_MAX,
+							PGC_SIGHUP,
+							GUC_NOT_IN_SAMPLE,
+							NULL, NULL, NULL);
+	DefineCustomBoolVariable("pg_strom.gpu_grid_size_tuning",
+							 "Enables online tuning of the grid size of GPU kernels",
+							 NULL,
+							 &pgstrom_gpu_grid_size_tuning,
+							 true,
+							 PGC_SIGHUP,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	DefineCustomBoolVariable("pg_strom.gpu_pipelined_load",
+							 "Enables to load the next data chunk during execution of the current one",
+							 NULL,
+							 &pgstrom_gpu_pipelined_load,
+							 true,
+							 PGC_SIGHUP,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	DefineCustomBoolVariable("pg_strom.gpu_mempool_device_mode",
+							 "Uses device memory with explicit DMA/prefetch for data chunks, instead of the fault-driven migration",
+							 NULL,
+							 &pgstrom_gpu_mempool_device_mode,
+							 false,
+							 PGC_SIGHUP,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	DefineCustomIntVariable("pg_strom.gpu_shared_scan_buffer_size",
+							"Size of the Arrow_Fdw chunks shared by the concurrent scans per GPU (0 = disabled)",
+							NULL,
+							&pgstrom_gpu_shared_scan_buffer_size,
+							0,
+							0,
+							INT_MAX,
+							PGC_SIGHUP,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_MB,
+							NULL, NULL, NULL);
+	DefineCustomIntVariable("pg_strom.gpudirect_dma_pool_size",
+							"Size of the preallocated DMA buffers for VFS fallback per GPU (0 = on demand)",
+							NULL,
+							&pgstrom_gpudirect_dma_pool_size,
+							0,
+							0,
+							INT_MAX,
+							PGC_POSTMASTER,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_MB,
+							NULL, NULL, NULL);
 	DefineCustomIntVariable("pg_strom.max_async_tasks",
 							"Limit of concurrent xPU task execution",
 							NULL,
@@ -56,6 +56,37 @@ pgstrom_enabled(void)
 	return false;
 }
 
+/*
+ * pgstrom_wait_event
+ *
+ * It returns the wait_event_info for the waits of PG-Strom; the backends
+ * waiting for the GPU/DPU tasks, the inner preload and the GpuCache redo
+ * apply show up in pg_stat_activity with the names below.
+ * PostgreSQL v17 allows extensions to register custom wait events, so they
+ * are registered on the first use in each process. Elsewhere, all of them
+ * are reported as the generic 'Extension' wait event.
+ */
+uint32
+pgstrom_wait_event(PgStromWaitEvent kind)
+{
+#if PG_VERSION_NUM >= 170000
+	static uint32	wait_events[PGSTROM_WAIT_EVENT__NITEMS];
+	static const char *wait_event_names[PGSTROM_WAIT_EVENT__NITEMS] = {
+		"GpuTaskWait",
+		"DpuNetworkWait",
+		"InnerPreloadWait",
+		"GpuCacheRedoApply",
+	};
+
+	Assert(kind >= 0 && kind < PGSTROM_WAIT_EVENT__NITEMS);
+	if (wait_events[kind] == 0)
+		wait_events[kind] = WaitEventExtensionNew(wait_event_names[kind]);
+	return wait_events[kind];
+#else
+	return PG_WAIT_EXTENSION;
+#endif
+}
+
 /*
  * pg_kern_ereport - raise an ereport at host side
  */
@@ -663,8 +694,11 @@ _PG_init(void)
 	pgstrom_init_codegen();
 	pgstrom_init_relscan();
 	pgstrom_init_brin();
+	pgstrom_init_zonemap();
 	pgstrom_init_arrow_fdw();
+	pgstrom_init_arrow_remote();
 	pgstrom_init_executor();
+	pgstrom_init_cost_calib();
 	/* dump version number */
 	elog(LOG, "PG-Strom version %s built for PostgreSQL %s (githash: %s)",
 		 PGSTROM_VERSION,
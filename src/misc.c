@@ -129,10 +129,13 @@ form_pgstrom_plan_info(CustomScan *cscan, pgstromPlanInfo *pp_info)
 	privs = lappend(privs, __makeFloat(pp_info->inner_cost));
 	privs = lappend(privs, __makeFloat(pp_info->run_cost));
 	privs = lappend(privs, __makeFloat(pp_info->final_cost));
+	privs = lappend(privs, __makeFloat(pp_info->gpu_memsz));
 	/* bin-index support */
 	privs = lappend(privs, makeInteger(pp_info->brin_index_oid));
 	privs = lappend(privs, pp_info->brin_index_conds);
 	privs = lappend(privs, pp_info->brin_index_quals);
+	privs = lappend(privs, pp_info->brin_subindex_oids);
+	privs = lappend(privs, pp_info->brin_subindex_conds);
 	/* XPU code */
 	privs = lappend(privs, __makeByteaConst(pp_info->kexp_load_vars_packed));
 	privs = lappend(privs, __makeByteaConst(pp_info->kexp_move_vars_packed));
@@ -140,6 +143,7 @@ form_pgstrom_plan_info(CustomScan *cscan, pgstromPlanInfo *pp_info)
 	privs = lappend(privs, __makeByteaConst(pp_info->kexp_join_quals_packed));
 	privs = lappend(privs, __makeByteaConst(pp_info->kexp_hash_keys_packed));
 	privs = lappend(privs, __makeByteaConst(pp_info->kexp_gist_evals_packed));
+	privs = lappend(privs, __makeByteaConst(pp_info->kexp_range_keys_packed));
 	privs = lappend(privs, __makeByteaConst(pp_info->kexp_projection));
 	privs = lappend(privs, __makeByteaConst(pp_info->kexp_groupby_keyhash));
 	privs = lappend(privs, __makeByteaConst(pp_info->kexp_groupby_keyload));
@@ -165,6 +169,17 @@ form_pgstrom_plan_info(CustomScan *cscan, pgstromPlanInfo *pp_info)
 	privs = lappend(privs, makeInteger(pp_info->cuda_stack_size));
 	privs = lappend(privs, pp_info->groupby_actions);
 	privs = lappend(privs, makeInteger(pp_info->groupby_prepfn_bufsz));
+	privs = lappend(privs, makeBoolean(pp_info->groupby_final_mode));
+	privs = lappend(privs, makeInteger(pp_info->topk_nitems));
+	privs = lappend(privs, makeInteger(pp_info->limit_nitems));
+	privs = lappend(privs, makeInteger(pp_info->sortkey_resno));
+	privs = lappend(privs, makeInteger(pp_info->sortkey_flags));
+	privs = lappend(privs, makeInteger(pp_info->gpusort_sortop));
+	privs = lappend(privs, makeInteger(pp_info->gpusort_collid));
+	privs = lappend(privs, makeInteger(pp_info->sortkey2_resno));
+	privs = lappend(privs, makeInteger(pp_info->sortkey2_flags));
+	privs = lappend(privs, makeInteger(pp_info->gpusort_sortop2));
+	privs = lappend(privs, makeInteger(pp_info->gpusort_collid2));
 	/* inner relations */
 	privs = lappend(privs, makeInteger(pp_info->sibling_param_id));
 	privs = lappend(privs, makeInteger(pp_info->num_rels));
@@ -189,6 +204,10 @@ form_pgstrom_plan_info(CustomScan *cscan, pgstromPlanInfo *pp_info)
 		__privs = lappend(__privs, __makeFloat(pp_inner->gist_selectivity));
 		__privs = lappend(__privs, __makeFloat(pp_inner->gist_npages));
 		__privs = lappend(__privs, makeInteger(pp_inner->gist_height));
+		__exprs = lappend(__exprs, pp_inner->range_outer_key);
+		__exprs = lappend(__exprs, pp_inner->range_inner_key);
+		__privs = lappend(__privs, makeInteger(pp_inner->range_strategy));
+		__privs = lappend(__privs, __makeFloat(pp_inner->range_grid_distance));
 
 		exprs = lappend(exprs, __exprs);
 		privs = lappend(privs, __privs);
@@ -235,10 +254,13 @@ deform_pgstrom_plan_info(CustomScan *cscan)
 	pp_data.inner_cost   = floatVal(list_nth(privs, pindex++));
 	pp_data.run_cost     = floatVal(list_nth(privs, pindex++));
 	pp_data.final_cost   = floatVal(list_nth(privs, pindex++));
+	pp_data.gpu_memsz    = floatVal(list_nth(privs, pindex++));
 	/* brin-index support */
 	pp_data.brin_index_oid = intVal(list_nth(privs, pindex++));
 	pp_data.brin_index_conds = list_nth(privs, pindex++);
 	pp_data.brin_index_quals = list_nth(privs, pindex++);
+	pp_data.brin_subindex_oids = list_nth(privs, pindex++);
+	pp_data.brin_subindex_conds = list_nth(privs, pindex++);
 	/* XPU code */
 	pp_data.kexp_load_vars_packed  = __getByteaConst(list_nth(privs, pindex++));
 	pp_data.kexp_move_vars_packed  = __getByteaConst(list_nth(privs, pindex++));
@@ -246,6 +268,7 @@ deform_pgstrom_plan_info(CustomScan *cscan)
 	pp_data.kexp_join_quals_packed = __getByteaConst(list_nth(privs, pindex++));
 	pp_data.kexp_hash_keys_packed  = __getByteaConst(list_nth(privs, pindex++));
 	pp_data.kexp_gist_evals_packed = __getByteaConst(list_nth(privs, pindex++));
+	pp_data.kexp_range_keys_packed = __getByteaConst(list_nth(privs, pindex++));
 	pp_data.kexp_projection        = __getByteaConst(list_nth(privs, pindex++));
 	pp_data.kexp_groupby_keyhash   = __getByteaConst(list_nth(privs, pindex++));
 	pp_data.kexp_groupby_keyload   = __getByteaConst(list_nth(privs, pindex++));
@@ -270,6 +293,17 @@ deform_pgstrom_plan_info(CustomScan *cscan)
 	pp_data.cuda_stack_size = intVal(list_nth(privs, pindex++));
 	pp_data.groupby_actions = list_nth(privs, pindex++);
 	pp_data.groupby_prepfn_bufsz  = intVal(list_nth(privs, pindex++));
+	pp_data.groupby_final_mode = boolVal(list_nth(privs, pindex++));
+	pp_data.topk_nitems = intVal(list_nth(privs, pindex++));
+	pp_data.limit_nitems = intVal(list_nth(privs, pindex++));
+	pp_data.sortkey_resno  = intVal(list_nth(privs, pindex++));
+	pp_data.sortkey_flags  = intVal(list_nth(privs, pindex++));
+	pp_data.gpusort_sortop = intVal(list_nth(privs, pindex++));
+	pp_data.gpusort_collid = intVal(list_nth(privs, pindex++));
+	pp_data.sortkey2_resno = intVal(list_nth(privs, pindex++));
+	pp_data.sortkey2_flags = intVal(list_nth(privs, pindex++));
+	pp_data.gpusort_sortop2 = intVal(list_nth(privs, pindex++));
+	pp_data.gpusort_collid2 = intVal(list_nth(privs, pindex++));
 	/* inner relations */
 	pp_data.sibling_param_id = intVal(list_nth(privs, pindex++));
 	pp_data.num_rels = intVal(list_nth(privs, pindex++));
@@ -298,6 +332,10 @@ deform_pgstrom_plan_info(CustomScan *cscan)
 		pp_inner->gist_selectivity = floatVal(list_nth(__privs, __pindex++));
 		pp_inner->gist_npages     = floatVal(list_nth(__privs, __pindex++));
 		pp_inner->gist_height     = intVal(list_nth(__privs, __pindex++));
+		pp_inner->range_outer_key = list_nth(__exprs, __eindex++);
+		pp_inner->range_inner_key = list_nth(__exprs, __eindex++);
+		pp_inner->range_strategy  = intVal(list_nth(__privs, __pindex++));
+		pp_inner->range_grid_distance = floatVal(list_nth(__privs, __pindex++));
 	}
 	return pp_info;
 }
@@ -323,6 +361,8 @@ copy_pgstrom_plan_info(const pgstromPlanInfo *pp_orig)
 	pp_dest->scan_quals       = copyObject(pp_dest->scan_quals);
 	pp_dest->brin_index_conds = copyObject(pp_dest->brin_index_conds);
 	pp_dest->brin_index_quals = copyObject(pp_dest->brin_index_quals);
+	pp_dest->brin_subindex_oids = list_copy(pp_dest->brin_subindex_oids);
+	pp_dest->brin_subindex_conds = copyObject(pp_dest->brin_subindex_conds);
 	foreach (lc, pp_orig->kvars_deflist)
 	{
 		codegen_kvar_defitem *kvdef_orig = lfirst(lc);
@@ -343,6 +383,8 @@ copy_pgstrom_plan_info(const pgstromPlanInfo *pp_orig)
 		pp_inner->join_quals      = copyObject(pp_inner->join_quals);
 		pp_inner->other_quals     = copyObject(pp_inner->other_quals);
 		pp_inner->gist_clause     = copyObject(pp_inner->gist_clause);
+		pp_inner->range_outer_key = copyObject(pp_inner->range_outer_key);
+		pp_inner->range_inner_key = copyObject(pp_inner->range_inner_key);
 	}
 	return pp_dest;
 }
@@ -1803,6 +1845,24 @@ __shmemDrop(uint32_t shmem_handle)
 	elog(ERROR, "failed on __shmemDrop - no such segment (%u)", shmem_handle);
 }
 
+static void
+__mmapTrackerInit(void)
+{
+	if (!mmap_tracker_htab)
+	{
+		HASHCTL		hctl;
+
+		memset(&hctl, 0, sizeof(HASHCTL));
+		hctl.keysize = sizeof(void *);
+		hctl.entrysize = sizeof(mmapEntry);
+		mmap_tracker_htab = hash_create("mmap_tracker_htab",
+										256,
+										&hctl,
+										HASH_ELEM | HASH_BLOBS);
+		RegisterResourceReleaseCallback(cleanup_mmap_chunks, 0);
+	}
+}
+
 void *
 __mmapShmem(uint32_t shmem_handle,
 			size_t   shmem_length,
@@ -1823,19 +1883,7 @@ __mmapShmem(uint32_t shmem_handle,
 
 	if (ds_entry)
 		shmem_dir = DpuStorageEntryBaseDir(ds_entry);
-	if (!mmap_tracker_htab)
-	{
-		HASHCTL		hctl;
-
-		memset(&hctl, 0, sizeof(HASHCTL));
-		hctl.keysize = sizeof(void *);
-		hctl.entrysize = sizeof(mmapEntry);
-		mmap_tracker_htab = hash_create("mmap_tracker_htab",
-										256,
-										&hctl,
-										HASH_ELEM | HASH_BLOBS);
-		RegisterResourceReleaseCallback(cleanup_mmap_chunks, 0);
-	}
+	__mmapTrackerInit();
 
 	if (shmem_tracker_htab)
 	{
@@ -1914,6 +1962,66 @@ __mmapShmem(uint32_t shmem_handle,
 	return mmap_addr;
 }
 
+/*
+ * __mmapFileWithHeader
+ *
+ * It maps the file range [f_pos, f_pos + f_len) read-only, just behind
+ * the anonymous writable region of 'head_sz' bytes; so the caller can put
+ * a header structure (like KDS) adjacent to the file contents without
+ * copy. 'f_pos' must be aligned to PAGE_SIZE, and 'advice' is given to
+ * madvise(2) for the file contents. It returns the address to be released
+ * by __munmapShmem(), and *p_head points the header region.
+ */
+void *
+__mmapFileWithHeader(int fdesc, off_t f_pos, size_t f_len,
+					 size_t head_sz, int advice, void **p_head)
+{
+	size_t		head_pad = PAGE_ALIGN(head_sz);
+	size_t		mmap_size = head_pad + PAGE_ALIGN(f_len);
+	int			mmap_prot = PROT_READ | PROT_WRITE;
+	int			mmap_flags = MAP_PRIVATE | MAP_ANONYMOUS;
+	char	   *mmap_addr;
+	mmapEntry  *mmap_entry;
+	bool		found;
+
+	Assert(f_pos == PAGE_ALIGN_DOWN(f_pos));
+	__mmapTrackerInit();
+	mmap_addr = mmap(NULL, mmap_size, mmap_prot, mmap_flags, -1, 0);
+	if (mmap_addr == MAP_FAILED)
+		elog(ERROR, "failed on mmap(2): %m");
+	if (mmap(mmap_addr + head_pad, f_len,
+			 PROT_READ,
+			 MAP_PRIVATE | MAP_FIXED,
+			 fdesc, f_pos) == MAP_FAILED)
+	{
+		int		errno_saved = errno;
+
+		if (munmap(mmap_addr, mmap_size) != 0)
+			elog(WARNING, "failed on munmap(%p, %zu): %m",
+				 mmap_addr, mmap_size);
+		errno = errno_saved;
+		elog(ERROR, "failed on mmap(2) at offset=%lu, length=%zu: %m",
+			 f_pos, f_len);
+	}
+	if (madvise(mmap_addr + head_pad, f_len, advice) != 0)
+		elog(DEBUG2, "failed on madvise(2): %m");
+
+	mmap_entry = hash_search(mmap_tracker_htab,
+							 &mmap_addr,
+							 HASH_ENTER,
+							 &found);
+	if (found)
+		elog(ERROR, "Bug? duplicated mmap entry");
+	Assert(mmap_entry->mmap_addr == mmap_addr);
+	mmap_entry->mmap_size  = mmap_size;
+	mmap_entry->mmap_prot  = mmap_prot;
+	mmap_entry->mmap_flags = mmap_flags;
+	mmap_entry->owner      = CurrentResourceOwner;
+
+	*p_head = mmap_addr + head_pad - head_sz;
+	return mmap_addr;
+}
+
 bool
 __munmapShmem(void *mmap_addr)
 {
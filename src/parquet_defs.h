@@ -0,0 +1,237 @@
+/*
+ * parquet_defs.h
+ *
+ * Definitions of the Apache Parquet file format (subset for Arrow_Fdw)
+ * ----
+ * Copyright 2011-2023 (C) KaiGai Kohei <kaigai@kaigai.gr.jp>
+ * Copyright 2014-2023 (C) PG-Strom Developers Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the PostgreSQL License.
+ */
+#ifndef _PARQUET_DEFS_H_
+#define _PARQUET_DEFS_H_
+#include "arrow_defs.h"
+
+#define PARQUET_SIGNATURE		"PAR1"
+#define PARQUET_SIGNATURE_SZ	4
+
+/*
+ * parquet::Type - physical data types
+ */
+typedef enum
+{
+	ParquetType__BOOLEAN				= 0,
+	ParquetType__INT32					= 1,
+	ParquetType__INT64					= 2,
+	ParquetType__INT96					= 3,
+	ParquetType__FLOAT					= 4,
+	ParquetType__DOUBLE					= 5,
+	ParquetType__BYTE_ARRAY				= 6,
+	ParquetType__FIXED_LEN_BYTE_ARRAY	= 7,
+} ParquetType;
+
+/*
+ * parquet::ConvertedType - legacy logical annotation
+ */
+typedef enum
+{
+	ParquetConvertedType__UTF8				= 0,
+	ParquetConvertedType__MAP				= 1,
+	ParquetConvertedType__MAP_KEY_VALUE		= 2,
+	ParquetConvertedType__LIST				= 3,
+	ParquetConvertedType__ENUM				= 4,
+	ParquetConvertedType__DECIMAL			= 5,
+	ParquetConvertedType__DATE				= 6,
+	ParquetConvertedType__TIME_MILLIS		= 7,
+	ParquetConvertedType__TIME_MICROS		= 8,
+	ParquetConvertedType__TIMESTAMP_MILLIS	= 9,
+	ParquetConvertedType__TIMESTAMP_MICROS	= 10,
+	ParquetConvertedType__UINT_8			= 11,
+	ParquetConvertedType__UINT_16			= 12,
+	ParquetConvertedType__UINT_32			= 13,
+	ParquetConvertedType__UINT_64			= 14,
+	ParquetConvertedType__INT_8				= 15,
+	ParquetConvertedType__INT_16			= 16,
+	ParquetConvertedType__INT_32			= 17,
+	ParquetConvertedType__INT_64			= 18,
+	ParquetConvertedType__JSON				= 19,
+	ParquetConvertedType__BSON				= 20,
+	ParquetConvertedType__INTERVAL			= 21,
+} ParquetConvertedType;
+
+/*
+ * parquet::LogicalType - field-id of the union
+ */
+typedef enum
+{
+	ParquetLogicalType__NONE		= 0,
+	ParquetLogicalType__STRING		= 1,
+	ParquetLogicalType__MAP			= 2,
+	ParquetLogicalType__LIST		= 3,
+	ParquetLogicalType__ENUM		= 4,
+	ParquetLogicalType__DECIMAL		= 5,
+	ParquetLogicalType__DATE		= 6,
+	ParquetLogicalType__TIME		= 7,
+	ParquetLogicalType__TIMESTAMP	= 8,
+	ParquetLogicalType__INTEGER		= 10,
+	ParquetLogicalType__UNKNOWN		= 11,
+	ParquetLogicalType__JSON		= 12,
+	ParquetLogicalType__BSON		= 13,
+	ParquetLogicalType__UUID		= 14,
+} ParquetLogicalType;
+
+/*
+ * parquet::TimeUnit - field-id of the union
+ */
+typedef enum
+{
+	ParquetTimeUnit__MILLIS		= 1,
+	ParquetTimeUnit__MICROS		= 2,
+	ParquetTimeUnit__NANOS		= 3,
+} ParquetTimeUnit;
+
+/*
+ * parquet::FieldRepetitionType
+ */
+typedef enum
+{
+	ParquetRepetition__REQUIRED	= 0,
+	ParquetRepetition__OPTIONAL	= 1,
+	ParquetRepetition__REPEATED	= 2,
+} ParquetRepetition;
+
+/*
+ * parquet::Encoding
+ */
+typedef enum
+{
+	ParquetEncoding__PLAIN					= 0,
+	ParquetEncoding__PLAIN_DICTIONARY		= 2,
+	ParquetEncoding__RLE					= 3,
+	ParquetEncoding__BIT_PACKED				= 4,
+	ParquetEncoding__DELTA_BINARY_PACKED	= 5,
+	ParquetEncoding__DELTA_LENGTH_BYTE_ARRAY = 6,
+	ParquetEncoding__DELTA_BYTE_ARRAY		= 7,
+	ParquetEncoding__RLE_DICTIONARY			= 8,
+	ParquetEncoding__BYTE_STREAM_SPLIT		= 9,
+} ParquetEncoding;
+
+/*
+ * parquet::CompressionCodec
+ */
+typedef enum
+{
+	ParquetCodec__UNCOMPRESSED	= 0,
+	ParquetCodec__SNAPPY		= 1,
+	ParquetCodec__GZIP			= 2,
+	ParquetCodec__LZO			= 3,
+	ParquetCodec__BROTLI		= 4,
+	ParquetCodec__LZ4			= 5,
+	ParquetCodec__ZSTD			= 6,
+	ParquetCodec__LZ4_RAW		= 7,
+} ParquetCodec;
+
+/*
+ * parquet::PageType
+ */
+typedef enum
+{
+	ParquetPageType__DATA_PAGE			= 0,
+	ParquetPageType__INDEX_PAGE			= 1,
+	ParquetPageType__DICTIONARY_PAGE	= 2,
+	ParquetPageType__DATA_PAGE_V2		= 3,
+} ParquetPageType;
+
+/*
+ * ParquetSchemaElement - flatten parquet::SchemaElement
+ */
+typedef struct
+{
+	const char	   *name;
+	int				physical_type;	/* ParquetType, or -1 if group */
+	int				type_length;	/* FIXED_LEN_BYTE_ARRAY only */
+	int				repetition;		/* ParquetRepetition */
+	int				num_children;
+	int				converted_type;	/* ParquetConvertedType, or -1 */
+	int				scale;
+	int				precision;
+	int				logical_type;	/* ParquetLogicalType */
+	int				logical_unit;	/* ParquetTimeUnit (TIME/TIMESTAMP) */
+	bool			logical_utc;	/* isAdjustedToUTC (TIME/TIMESTAMP) */
+	int				logical_bitwidth; /* INTEGER */
+	bool			logical_signed;	/* INTEGER */
+} ParquetSchemaElement;
+
+/*
+ * ParquetColumnDesc - properties to decode a column chunk; it is kept in
+ * the RecordBatchFieldState of Arrow_Fdw and its metadata cache.
+ */
+typedef struct
+{
+	int16_t			physical_type;	/* ParquetType */
+	int16_t			codec;			/* ParquetCodec */
+	int16_t			max_def_level;	/* 0=REQUIRED, 1=OPTIONAL */
+	int32_t			type_length;	/* FIXED_LEN_BYTE_ARRAY only */
+} ParquetColumnDesc;
+
+/*
+ * ParquetColumnChunk - flatten parquet::ColumnChunk + ColumnMetaData
+ */
+#define PARQUET_STATS_MAXLEN	16
+typedef struct
+{
+	int				physical_type;
+	int				codec;
+	int64_t			num_values;
+	int64_t			data_page_offset;
+	int64_t			dictionary_page_offset;	/* 0, if none */
+	int64_t			total_compressed_size;
+	int64_t			null_count;		/* -1, if unknown */
+	bool			has_minmax;		/* only fixed-length min/max */
+	int				min_len;
+	int				max_len;
+	char			min_value[PARQUET_STATS_MAXLEN];
+	char			max_value[PARQUET_STATS_MAXLEN];
+} ParquetColumnChunk;
+
+/*
+ * ParquetRowGroup - flatten parquet::RowGroup
+ */
+typedef struct
+{
+	int64_t			num_rows;
+	int64_t			total_byte_size;
+	int				num_columns;
+	ParquetColumnChunk *columns;
+} ParquetRowGroup;
+
+/*
+ * ParquetFileInfo - state information of readParquetFileDesc()
+ */
+typedef struct
+{
+	const char	   *filename;
+	struct stat		stat_buf;
+	int32_t			version;
+	int64_t			num_rows;
+	int				num_elements;	/* elements[0] is the root group */
+	ParquetSchemaElement *elements;
+	int				num_row_groups;
+	ParquetRowGroup *row_groups;
+} ParquetFileInfo;
+
+/* parquet_read.c */
+extern bool		isParquetFileDesc(int fdesc);
+extern void		readParquetFileDesc(int fdesc, ParquetFileInfo *pq_info);
+extern void		parquetSetupArrowSchema(ParquetFileInfo *pq_info,
+										ArrowSchema *schema);
+extern int64_t	parquetDecodeColumnChunk(const char *filename,
+										 const ParquetColumnDesc *pq_desc,
+										 const ArrowTypeOptions *attopts,
+										 const char *chunk, size_t chunk_sz,
+										 int64_t nitems,
+										 StringInfo nullmap,
+										 StringInfo values,
+										 StringInfo extra);
+#endif	/* _PARQUET_DEFS_H_ */
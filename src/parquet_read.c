@@ -0,0 +1,1597 @@
+/*
+ * parquet_read.c
+ *
+ * Routines to read Apache Parquet files for Arrow_Fdw; it parses the file
+ * metadata (thrift compact protocol), and decodes column chunks into the
+ * Apache Arrow compatible buffers.
+ * ----
+ * Copyright 2011-2023 (C) KaiGai Kohei <kaigai@kaigai.gr.jp>
+ * Copyright 2014-2023 (C) PG-Strom Developers Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the PostgreSQL License.
+ */
+#ifdef WITH_LIBLZ4
+#include <lz4.h>
+#endif
+#ifdef WITH_LIBZSTD
+#include <zstd.h>
+#endif
+#ifdef WITH_LIBSNAPPY
+#include <snappy-c.h>
+#endif
+#include "pg_strom.h"
+#include "arrow_defs.h"
+#include "arrow_ipc.h"
+#include "parquet_defs.h"
+
+/*
+ * Parquet file layout
+ *
+ * +-----------------------+
+ * | "PAR1"                |
+ * +-----------------------+
+ * | Column chunks         |  : [dictionary page] + data pages
+ * |  of the row groups    |
+ * +-----------------------+
+ * | FileMetaData          |  : thrift compact protocol
+ * +-----------------------+
+ * | int32 metadata length |
+ * | "PAR1"                |
+ * +-----------------------+
+ */
+
+/*
+ * Thrift compact protocol
+ */
+#define THRIFT_STOP				0
+#define THRIFT_BOOLEAN_TRUE		1
+#define THRIFT_BOOLEAN_FALSE	2
+#define THRIFT_BYTE				3
+#define THRIFT_I16				4
+#define THRIFT_I32				5
+#define THRIFT_I64				6
+#define THRIFT_DOUBLE			7
+#define THRIFT_BINARY			8
+#define THRIFT_LIST				9
+#define THRIFT_SET				10
+#define THRIFT_MAP				11
+#define THRIFT_STRUCT			12
+#define THRIFT_MAX_DEPTH		64
+
+typedef struct
+{
+	const char *pos;
+	const char *end;
+} thriftReader;
+
+static inline uint8_t
+__thriftReadByte(thriftReader *r)
+{
+	if (r->pos >= r->end)
+		elog(ERROR, "parquet: thrift message is truncated");
+	return *((const uint8_t *)r->pos++);
+}
+
+static uint64_t
+__thriftReadVarint(thriftReader *r)
+{
+	uint64_t	val = 0;
+	int			shift = 0;
+
+	for (;;)
+	{
+		uint8_t		c = __thriftReadByte(r);
+
+		val |= ((uint64_t)(c & 0x7f)) << shift;
+		if ((c & 0x80) == 0)
+			break;
+		shift += 7;
+		if (shift >= 64)
+			elog(ERROR, "parquet: thrift varint is too long");
+	}
+	return val;
+}
+
+static inline int64_t
+__thriftReadZigzag(thriftReader *r)
+{
+	uint64_t	val = __thriftReadVarint(r);
+
+	return (int64_t)(val >> 1) ^ -((int64_t)(val & 1));
+}
+
+static int
+__thriftReadFieldHeader(thriftReader *r, int16_t *p_field_id)
+{
+	uint8_t		c = __thriftReadByte(r);
+	int			ftype = (c & 0x0f);
+
+	if (ftype != THRIFT_STOP)
+	{
+		if ((c >> 4) != 0)
+			*p_field_id += (c >> 4);
+		else
+			*p_field_id = (int16_t)__thriftReadZigzag(r);
+	}
+	return ftype;
+}
+
+static int
+__thriftReadListHeader(thriftReader *r, int *p_elem_type)
+{
+	uint8_t		c = __thriftReadByte(r);
+	uint64_t	nitems = (c >> 4);
+
+	if (nitems == 15)
+		nitems = __thriftReadVarint(r);
+	if (nitems > (uint64_t)(r->end - r->pos))
+		elog(ERROR, "parquet: thrift list has too many items (%lu)", nitems);
+	*p_elem_type = (c & 0x0f);
+	return (int)nitems;
+}
+
+static const char *
+__thriftReadBinary(thriftReader *r, int ftype, int *p_length)
+{
+	uint64_t	len;
+	const char *addr;
+
+	if (ftype != THRIFT_BINARY)
+		elog(ERROR, "parquet: thrift field type mismatch (%d for binary)", ftype);
+	len = __thriftReadVarint(r);
+	if (len > (uint64_t)(r->end - r->pos))
+		elog(ERROR, "parquet: thrift binary is truncated");
+	addr = r->pos;
+	r->pos += len;
+	*p_length = (int)len;
+	return addr;
+}
+
+static int64_t
+__thriftReadInteger(thriftReader *r, int ftype)
+{
+	switch (ftype)
+	{
+		case THRIFT_BYTE:
+			return (int8_t)__thriftReadByte(r);
+		case THRIFT_I16:
+		case THRIFT_I32:
+		case THRIFT_I64:
+			return __thriftReadZigzag(r);
+		default:
+			elog(ERROR, "parquet: thrift field type mismatch (%d for integer)", ftype);
+	}
+	return 0;	/* not reachable */
+}
+
+static bool
+__thriftReadBool(thriftReader *r, int ftype)
+{
+	if (ftype == THRIFT_BOOLEAN_TRUE)
+		return true;
+	if (ftype == THRIFT_BOOLEAN_FALSE)
+		return false;
+	elog(ERROR, "parquet: thrift field type mismatch (%d for bool)", ftype);
+}
+
+static void
+__thriftSkipValue(thriftReader *r, int ftype, bool in_list, int depth)
+{
+	int16_t		fid = 0;
+	int			etype;
+	int			ktype;
+	int			vtype;
+	int			nitems;
+	int			len;
+
+	if (depth > THRIFT_MAX_DEPTH)
+		elog(ERROR, "parquet: thrift message is nested too deep");
+	switch (ftype)
+	{
+		case THRIFT_BOOLEAN_TRUE:
+		case THRIFT_BOOLEAN_FALSE:
+			/* bool values in list/set/map are encoded as a byte */
+			if (in_list)
+				__thriftReadByte(r);
+			break;
+		case THRIFT_BYTE:
+			__thriftReadByte(r);
+			break;
+		case THRIFT_I16:
+		case THRIFT_I32:
+		case THRIFT_I64:
+			__thriftReadVarint(r);
+			break;
+		case THRIFT_DOUBLE:
+			if (r->end - r->pos < sizeof(double))
+				elog(ERROR, "parquet: thrift message is truncated");
+			r->pos += sizeof(double);
+			break;
+		case THRIFT_BINARY:
+			__thriftReadBinary(r, ftype, &len);
+			break;
+		case THRIFT_LIST:
+		case THRIFT_SET:
+			nitems = __thriftReadListHeader(r, &etype);
+			for (int i=0; i < nitems; i++)
+				__thriftSkipValue(r, etype, true, depth+1);
+			break;
+		case THRIFT_MAP:
+			nitems = __thriftReadVarint(r);
+			if (nitems > 0)
+			{
+				uint8_t		c = __thriftReadByte(r);
+
+				ktype = (c >> 4);
+				vtype = (c & 0x0f);
+				for (int i=0; i < nitems; i++)
+				{
+					__thriftSkipValue(r, ktype, true, depth+1);
+					__thriftSkipValue(r, vtype, true, depth+1);
+				}
+			}
+			break;
+		case THRIFT_STRUCT:
+			while ((etype = __thriftReadFieldHeader(r, &fid)) != THRIFT_STOP)
+				__thriftSkipValue(r, etype, false, depth+1);
+			break;
+		default:
+			elog(ERROR, "parquet: unknown thrift field type (%d)", ftype);
+	}
+}
+#define __thriftSkipField(r,ftype)		__thriftSkipValue((r),(ftype),false,0)
+
+static void
+__thriftCheckStruct(int ftype)
+{
+	if (ftype != THRIFT_STRUCT)
+		elog(ERROR, "parquet: thrift field type mismatch (%d for struct)", ftype);
+}
+
+/*
+ * parquet::LogicalType
+ */
+static void
+__parquetReadTimeUnit(thriftReader *r, ParquetSchemaElement *elem)
+{
+	int16_t		fid = 0;
+	int			ftype;
+
+	while ((ftype = __thriftReadFieldHeader(r, &fid)) != THRIFT_STOP)
+	{
+		if (ftype == THRIFT_STRUCT)
+			elem->logical_unit = fid;
+		__thriftSkipField(r, ftype);
+	}
+}
+
+static void
+__parquetReadLogicalType(thriftReader *r, ParquetSchemaElement *elem)
+{
+	int16_t		fid = 0;
+	int			ftype;
+
+	while ((ftype = __thriftReadFieldHeader(r, &fid)) != THRIFT_STOP)
+	{
+		int16_t		__fid = 0;
+		int			__ftype;
+
+		if (ftype != THRIFT_STRUCT)
+		{
+			__thriftSkipField(r, ftype);
+			continue;
+		}
+		elem->logical_type = fid;
+		while ((__ftype = __thriftReadFieldHeader(r, &__fid)) != THRIFT_STOP)
+		{
+			switch (fid)
+			{
+				case ParquetLogicalType__DECIMAL:
+					if (__fid == 1)
+						elem->scale = __thriftReadInteger(r, __ftype);
+					else if (__fid == 2)
+						elem->precision = __thriftReadInteger(r, __ftype);
+					else
+						__thriftSkipField(r, __ftype);
+					break;
+				case ParquetLogicalType__TIME:
+				case ParquetLogicalType__TIMESTAMP:
+					if (__fid == 1)
+						elem->logical_utc = __thriftReadBool(r, __ftype);
+					else if (__fid == 2)
+					{
+						__thriftCheckStruct(__ftype);
+						__parquetReadTimeUnit(r, elem);
+					}
+					else
+						__thriftSkipField(r, __ftype);
+					break;
+				case ParquetLogicalType__INTEGER:
+					if (__fid == 1)
+						elem->logical_bitwidth = __thriftReadInteger(r, __ftype);
+					else if (__fid == 2)
+						elem->logical_signed = __thriftReadBool(r, __ftype);
+					else
+						__thriftSkipField(r, __ftype);
+					break;
+				default:
+					__thriftSkipField(r, __ftype);
+					break;
+			}
+		}
+	}
+}
+
+/*
+ * parquet::SchemaElement
+ */
+static void
+__parquetReadSchemaElement(thriftReader *r, ParquetSchemaElement *elem)
+{
+	int16_t		fid = 0;
+	int			ftype;
+	const char *name;
+	int			len;
+
+	memset(elem, 0, sizeof(ParquetSchemaElement));
+	elem->physical_type = -1;
+	elem->converted_type = -1;
+	elem->repetition = ParquetRepetition__REQUIRED;
+	while ((ftype = __thriftReadFieldHeader(r, &fid)) != THRIFT_STOP)
+	{
+		switch (fid)
+		{
+			case 1:		/* type */
+				elem->physical_type = __thriftReadInteger(r, ftype);
+				break;
+			case 2:		/* type_length */
+				elem->type_length = __thriftReadInteger(r, ftype);
+				break;
+			case 3:		/* repetition_type */
+				elem->repetition = __thriftReadInteger(r, ftype);
+				break;
+			case 4:		/* name */
+				name = __thriftReadBinary(r, ftype, &len);
+				elem->name = pnstrdup(name, len);
+				break;
+			case 5:		/* num_children */
+				elem->num_children = __thriftReadInteger(r, ftype);
+				break;
+			case 6:		/* converted_type */
+				elem->converted_type = __thriftReadInteger(r, ftype);
+				break;
+			case 7:		/* scale */
+				elem->scale = __thriftReadInteger(r, ftype);
+				break;
+			case 8:		/* precision */
+				elem->precision = __thriftReadInteger(r, ftype);
+				break;
+			case 10:	/* logicalType */
+				__thriftCheckStruct(ftype);
+				__parquetReadLogicalType(r, elem);
+				break;
+			default:
+				__thriftSkipField(r, ftype);
+				break;
+		}
+	}
+	if (!elem->name)
+		elog(ERROR, "parquet: SchemaElement has no name");
+}
+
+/*
+ * parquet::Statistics
+ */
+static void
+__parquetReadStatistics(thriftReader *r, ParquetColumnChunk *chunk)
+{
+	int16_t		fid = 0;
+	int			ftype;
+	const char *min_value = NULL;
+	const char *max_value = NULL;
+	const char *min_legacy = NULL;
+	const char *max_legacy = NULL;
+	int			min_len = 0, min_legacy_len = 0;
+	int			max_len = 0, max_legacy_len = 0;
+
+	while ((ftype = __thriftReadFieldHeader(r, &fid)) != THRIFT_STOP)
+	{
+		switch (fid)
+		{
+			case 1:		/* max (deprecated) */
+				max_legacy = __thriftReadBinary(r, ftype, &max_legacy_len);
+				break;
+			case 2:		/* min (deprecated) */
+				min_legacy = __thriftReadBinary(r, ftype, &min_legacy_len);
+				break;
+			case 3:		/* null_count */
+				chunk->null_count = __thriftReadInteger(r, ftype);
+				break;
+			case 5:		/* max_value */
+				max_value = __thriftReadBinary(r, ftype, &max_len);
+				break;
+			case 6:		/* min_value */
+				min_value = __thriftReadBinary(r, ftype, &min_len);
+				break;
+			default:
+				__thriftSkipField(r, ftype);
+				break;
+		}
+	}
+	if (!min_value || !max_value)
+	{
+		min_value = min_legacy;
+		min_len   = min_legacy_len;
+		max_value = max_legacy;
+		max_len   = max_legacy_len;
+	}
+	if (min_value && max_value &&
+		min_len > 0 && min_len <= PARQUET_STATS_MAXLEN &&
+		max_len > 0 && max_len <= PARQUET_STATS_MAXLEN)
+	{
+		chunk->has_minmax = true;
+		chunk->min_len = min_len;
+		chunk->max_len = max_len;
+		memcpy(chunk->min_value, min_value, min_len);
+		memcpy(chunk->max_value, max_value, max_len);
+	}
+}
+
+/*
+ * parquet::ColumnMetaData
+ */
+static void
+__parquetReadColumnMetaData(thriftReader *r, ParquetColumnChunk *chunk)
+{
+	int16_t		fid = 0;
+	int			ftype;
+
+	while ((ftype = __thriftReadFieldHeader(r, &fid)) != THRIFT_STOP)
+	{
+		switch (fid)
+		{
+			case 1:		/* type */
+				chunk->physical_type = __thriftReadInteger(r, ftype);
+				break;
+			case 4:		/* codec */
+				chunk->codec = __thriftReadInteger(r, ftype);
+				break;
+			case 5:		/* num_values */
+				chunk->num_values = __thriftReadInteger(r, ftype);
+				break;
+			case 7:		/* total_compressed_size */
+				chunk->total_compressed_size = __thriftReadInteger(r, ftype);
+				break;
+			case 9:		/* data_page_offset */
+				chunk->data_page_offset = __thriftReadInteger(r, ftype);
+				break;
+			case 11:	/* dictionary_page_offset */
+				chunk->dictionary_page_offset = __thriftReadInteger(r, ftype);
+				break;
+			case 12:	/* statistics */
+				__thriftCheckStruct(ftype);
+				__parquetReadStatistics(r, chunk);
+				break;
+			default:
+				__thriftSkipField(r, ftype);
+				break;
+		}
+	}
+}
+
+/*
+ * parquet::ColumnChunk
+ */
+static void
+__parquetReadColumnChunk(thriftReader *r, ParquetColumnChunk *chunk)
+{
+	int16_t		fid = 0;
+	int			ftype;
+	bool		has_meta = false;
+	int			len;
+
+	memset(chunk, 0, sizeof(ParquetColumnChunk));
+	chunk->null_count = -1;
+	while ((ftype = __thriftReadFieldHeader(r, &fid)) != THRIFT_STOP)
+	{
+		switch (fid)
+		{
+			case 1:		/* file_path */
+				__thriftReadBinary(r, ftype, &len);
+				if (len > 0)
+					elog(ERROR, "parquet: column chunk in the external file is not supported");
+				break;
+			case 3:		/* meta_data */
+				__thriftCheckStruct(ftype);
+				__parquetReadColumnMetaData(r, chunk);
+				has_meta = true;
+				break;
+			default:
+				__thriftSkipField(r, ftype);
+				break;
+		}
+	}
+	if (!has_meta)
+		elog(ERROR, "parquet: ColumnChunk has no ColumnMetaData");
+}
+
+/*
+ * parquet::RowGroup
+ */
+static void
+__parquetReadRowGroup(thriftReader *r, ParquetRowGroup *rgroup)
+{
+	int16_t		fid = 0;
+	int			ftype;
+	int			etype;
+
+	memset(rgroup, 0, sizeof(ParquetRowGroup));
+	while ((ftype = __thriftReadFieldHeader(r, &fid)) != THRIFT_STOP)
+	{
+		switch (fid)
+		{
+			case 1:		/* columns */
+				if (ftype != THRIFT_LIST)
+					elog(ERROR, "parquet: RowGroup::columns is not a list");
+				rgroup->num_columns = __thriftReadListHeader(r, &etype);
+				__thriftCheckStruct(etype);
+				rgroup->columns = palloc0(sizeof(ParquetColumnChunk) *
+										  Max(rgroup->num_columns, 1));
+				for (int i=0; i < rgroup->num_columns; i++)
+					__parquetReadColumnChunk(r, &rgroup->columns[i]);
+				break;
+			case 2:		/* total_byte_size */
+				rgroup->total_byte_size = __thriftReadInteger(r, ftype);
+				break;
+			case 3:		/* num_rows */
+				rgroup->num_rows = __thriftReadInteger(r, ftype);
+				break;
+			default:
+				__thriftSkipField(r, ftype);
+				break;
+		}
+	}
+}
+
+/*
+ * parquet::FileMetaData
+ */
+static void
+__parquetReadFileMetaData(thriftReader *r, ParquetFileInfo *pq_info)
+{
+	int16_t		fid = 0;
+	int			ftype;
+	int			etype;
+
+	while ((ftype = __thriftReadFieldHeader(r, &fid)) != THRIFT_STOP)
+	{
+		switch (fid)
+		{
+			case 1:		/* version */
+				pq_info->version = __thriftReadInteger(r, ftype);
+				break;
+			case 2:		/* schema */
+				if (ftype != THRIFT_LIST)
+					elog(ERROR, "parquet: FileMetaData::schema is not a list");
+				pq_info->num_elements = __thriftReadListHeader(r, &etype);
+				__thriftCheckStruct(etype);
+				pq_info->elements = palloc0(sizeof(ParquetSchemaElement) *
+											Max(pq_info->num_elements, 1));
+				for (int i=0; i < pq_info->num_elements; i++)
+					__parquetReadSchemaElement(r, &pq_info->elements[i]);
+				break;
+			case 3:		/* num_rows */
+				pq_info->num_rows = __thriftReadInteger(r, ftype);
+				break;
+			case 4:		/* row_groups */
+				if (ftype != THRIFT_LIST)
+					elog(ERROR, "parquet: FileMetaData::row_groups is not a list");
+				pq_info->num_row_groups = __thriftReadListHeader(r, &etype);
+				__thriftCheckStruct(etype);
+				pq_info->row_groups = palloc0(sizeof(ParquetRowGroup) *
+											  Max(pq_info->num_row_groups, 1));
+				for (int i=0; i < pq_info->num_row_groups; i++)
+					__parquetReadRowGroup(r, &pq_info->row_groups[i]);
+				break;
+			default:
+				__thriftSkipField(r, ftype);
+				break;
+		}
+	}
+}
+
+static void
+__parquetPreadFully(int fdesc, char *buf, size_t len, off_t f_pos)
+{
+	while (len > 0)
+	{
+		ssize_t		sz;
+
+		CHECK_FOR_INTERRUPTS();
+
+		sz = pread(fdesc, buf, len, f_pos);
+		if (sz > 0)
+		{
+			buf   += sz;
+			f_pos += sz;
+			len   -= sz;
+		}
+		else if (sz == 0)
+			elog(ERROR, "parquet: unexpected EOF at %lu", f_pos);
+		else if (errno != EINTR)
+			elog(ERROR, "failed on pread(2): %m");
+	}
+}
+
+/*
+ * isParquetFileDesc
+ */
+bool
+isParquetFileDesc(int fdesc)
+{
+	char		signature[PARQUET_SIGNATURE_SZ];
+
+	if (pread(fdesc, signature, PARQUET_SIGNATURE_SZ, 0) != PARQUET_SIGNATURE_SZ)
+		return false;
+	return (memcmp(signature, PARQUET_SIGNATURE, PARQUET_SIGNATURE_SZ) == 0);
+}
+
+/*
+ * readParquetFileDesc
+ */
+void
+readParquetFileDesc(int fdesc, ParquetFileInfo *pq_info)
+{
+	char		tail[sizeof(int32_t) + PARQUET_SIGNATURE_SZ];
+	char	   *meta;
+	size_t		file_sz;
+	size_t		meta_sz;
+	thriftReader r;
+
+	memset(pq_info, 0, sizeof(ParquetFileInfo));
+	if (fstat(fdesc, &pq_info->stat_buf) != 0)
+		elog(ERROR, "failed on fstat: %m");
+	file_sz = pq_info->stat_buf.st_size;
+	if (file_sz < 2 * PARQUET_SIGNATURE_SZ + sizeof(int32_t))
+		elog(ERROR, "parquet: file is too small");
+	__parquetPreadFully(fdesc, tail, sizeof(tail), file_sz - sizeof(tail));
+	if (memcmp(tail + sizeof(int32_t),
+			   PARQUET_SIGNATURE, PARQUET_SIGNATURE_SZ) != 0)
+		elog(ERROR, "Signature mismatch on Apache Parquet file");
+	meta_sz = *((uint32_t *)tail);
+	if (meta_sz > file_sz - sizeof(tail) - PARQUET_SIGNATURE_SZ)
+		elog(ERROR, "parquet: FileMetaData length (%zu) is corrupted", meta_sz);
+	meta = palloc(meta_sz);
+	__parquetPreadFully(fdesc, meta, meta_sz, file_sz - sizeof(tail) - meta_sz);
+
+	r.pos = meta;
+	r.end = meta + meta_sz;
+	__parquetReadFileMetaData(&r, pq_info);
+	pfree(meta);
+}
+
+/*
+ * parquetSetupArrowSchema
+ *
+ * It builds a synthetic ArrowSchema according to the parquet schema, so
+ * Arrow_Fdw can handle the parquet columns as if Arrow fields.
+ */
+static void
+__parquetSetupArrowTimeUnit(ParquetSchemaElement *elem, ArrowTimeUnit *p_unit)
+{
+	switch (elem->logical_unit)
+	{
+		case ParquetTimeUnit__MILLIS:
+			*p_unit = ArrowTimeUnit__MilliSecond;
+			break;
+		case ParquetTimeUnit__MICROS:
+			*p_unit = ArrowTimeUnit__MicroSecond;
+			break;
+		case ParquetTimeUnit__NANOS:
+			*p_unit = ArrowTimeUnit__NanoSecond;
+			break;
+		default:
+			elog(ERROR, "parquet: column '%s' has unknown time unit (%d)",
+				 elem->name, elem->logical_unit);
+	}
+}
+
+static void
+__parquetSetupArrowDecimal(ParquetSchemaElement *elem, ArrowType *t)
+{
+	if (elem->precision <= 0 || elem->precision > 38)
+		elog(ERROR, "parquet: column '%s' has unsupported decimal precision (%d)",
+			 elem->name, elem->precision);
+	initArrowNode(t, Decimal);
+	t->Decimal.precision = elem->precision;
+	t->Decimal.scale     = elem->scale;
+	t->Decimal.bitWidth  = 128;
+}
+
+static void
+__parquetSetupArrowInt(ArrowType *t, int bitWidth, bool is_signed)
+{
+	initArrowNode(t, Int);
+	t->Int.bitWidth  = bitWidth;
+	t->Int.is_signed = is_signed;
+}
+
+static void
+__parquetSetupArrowType(ParquetSchemaElement *elem, ArrowType *t)
+{
+	int		lt = elem->logical_type;
+	int		ct = elem->converted_type;
+
+	switch (elem->physical_type)
+	{
+		case ParquetType__BOOLEAN:
+			initArrowNode(t, Bool);
+			break;
+
+		case ParquetType__INT32:
+			if (lt == ParquetLogicalType__DATE ||
+				ct == ParquetConvertedType__DATE)
+			{
+				initArrowNode(t, Date);
+				t->Date.unit = ArrowDateUnit__Day;
+			}
+			else if ((lt == ParquetLogicalType__TIME &&
+					  elem->logical_unit == ParquetTimeUnit__MILLIS) ||
+					 ct == ParquetConvertedType__TIME_MILLIS)
+			{
+				initArrowNode(t, Time);
+				t->Time.unit = ArrowTimeUnit__MilliSecond;
+				t->Time.bitWidth = 32;
+			}
+			else if (lt == ParquetLogicalType__DECIMAL ||
+					 ct == ParquetConvertedType__DECIMAL)
+				__parquetSetupArrowDecimal(elem, t);
+			else if (lt == ParquetLogicalType__INTEGER)
+				__parquetSetupArrowInt(t, elem->logical_bitwidth,
+									   elem->logical_signed);
+			else if (ct == ParquetConvertedType__INT_8)
+				__parquetSetupArrowInt(t, 8, true);
+			else if (ct == ParquetConvertedType__INT_16)
+				__parquetSetupArrowInt(t, 16, true);
+			else if (ct == ParquetConvertedType__UINT_8)
+				__parquetSetupArrowInt(t, 8, false);
+			else if (ct == ParquetConvertedType__UINT_16)
+				__parquetSetupArrowInt(t, 16, false);
+			else if (ct == ParquetConvertedType__UINT_32)
+				__parquetSetupArrowInt(t, 32, false);
+			else
+				__parquetSetupArrowInt(t, 32, true);
+			if (t->node.tag == ArrowNodeTag__Int &&
+				t->Int.bitWidth > 32)
+				elog(ERROR, "parquet: column '%s' has INT32 with bitWidth=%d",
+					 elem->name, t->Int.bitWidth);
+			break;
+
+		case ParquetType__INT64:
+			if (lt == ParquetLogicalType__TIMESTAMP)
+			{
+				initArrowNode(t, Timestamp);
+				__parquetSetupArrowTimeUnit(elem, &t->Timestamp.unit);
+				if (elem->logical_utc)
+				{
+					t->Timestamp.timezone = pstrdup("UTC");
+					t->Timestamp._timezone_len = 3;
+				}
+			}
+			else if (ct == ParquetConvertedType__TIMESTAMP_MILLIS ||
+					 ct == ParquetConvertedType__TIMESTAMP_MICROS)
+			{
+				/* legacy annotation implies isAdjustedToUTC=true */
+				initArrowNode(t, Timestamp);
+				t->Timestamp.unit = (ct == ParquetConvertedType__TIMESTAMP_MILLIS
+									 ? ArrowTimeUnit__MilliSecond
+									 : ArrowTimeUnit__MicroSecond);
+				t->Timestamp.timezone = pstrdup("UTC");
+				t->Timestamp._timezone_len = 3;
+			}
+			else if (lt == ParquetLogicalType__TIME ||
+					 ct == ParquetConvertedType__TIME_MICROS)
+			{
+				initArrowNode(t, Time);
+				if (lt == ParquetLogicalType__TIME)
+					__parquetSetupArrowTimeUnit(elem, &t->Time.unit);
+				else
+					t->Time.unit = ArrowTimeUnit__MicroSecond;
+				t->Time.bitWidth = 64;
+			}
+			else if (lt == ParquetLogicalType__DECIMAL ||
+					 ct == ParquetConvertedType__DECIMAL)
+				__parquetSetupArrowDecimal(elem, t);
+			else if (lt == ParquetLogicalType__INTEGER)
+				__parquetSetupArrowInt(t, 64, elem->logical_signed);
+			else if (ct == ParquetConvertedType__UINT_64)
+				__parquetSetupArrowInt(t, 64, false);
+			else
+				__parquetSetupArrowInt(t, 64, true);
+			break;
+
+		case ParquetType__FLOAT:
+			initArrowNode(t, FloatingPoint);
+			t->FloatingPoint.precision = ArrowPrecision__Single;
+			break;
+
+		case ParquetType__DOUBLE:
+			initArrowNode(t, FloatingPoint);
+			t->FloatingPoint.precision = ArrowPrecision__Double;
+			break;
+
+		case ParquetType__BYTE_ARRAY:
+			if (lt == ParquetLogicalType__DECIMAL ||
+				ct == ParquetConvertedType__DECIMAL)
+				elog(ERROR, "parquet: column '%s' has BYTE_ARRAY decimal; not supported",
+					 elem->name);
+			if (lt == ParquetLogicalType__STRING ||
+				lt == ParquetLogicalType__ENUM ||
+				lt == ParquetLogicalType__JSON ||
+				ct == ParquetConvertedType__UTF8 ||
+				ct == ParquetConvertedType__ENUM ||
+				ct == ParquetConvertedType__JSON)
+				initArrowNode(t, Utf8);
+			else
+				initArrowNode(t, Binary);
+			break;
+
+		case ParquetType__FIXED_LEN_BYTE_ARRAY:
+			if ((lt == ParquetLogicalType__DECIMAL ||
+				 ct == ParquetConvertedType__DECIMAL) &&
+				elem->type_length <= sizeof(int128_t))
+				__parquetSetupArrowDecimal(elem, t);
+			else
+			{
+				initArrowNode(t, FixedSizeBinary);
+				t->FixedSizeBinary.byteWidth = elem->type_length;
+			}
+			break;
+
+		case ParquetType__INT96:
+			elog(ERROR, "parquet: column '%s' has INT96; not supported",
+				 elem->name);
+		default:
+			elog(ERROR, "parquet: column '%s' has unknown physical type (%d)",
+				 elem->name, elem->physical_type);
+	}
+}
+
+void
+parquetSetupArrowSchema(ParquetFileInfo *pq_info, ArrowSchema *schema)
+{
+	ParquetSchemaElement *root;
+	int			nfields;
+
+	if (pq_info->num_elements < 1)
+		elog(ERROR, "parquet: file has no schema");
+	root = &pq_info->elements[0];
+	nfields = root->num_children;
+	if (nfields != pq_info->num_elements - 1)
+		elog(ERROR, "parquet: nested schema is not supported");
+
+	initArrowNode(schema, Schema);
+	schema->endianness = ArrowEndianness__Little;
+	schema->fields = palloc0(sizeof(ArrowField) * Max(nfields, 1));
+	schema->_num_fields = nfields;
+	for (int j=0; j < nfields; j++)
+	{
+		ParquetSchemaElement *elem = &pq_info->elements[j+1];
+		ArrowField *field = &schema->fields[j];
+
+		if (elem->physical_type < 0 || elem->num_children > 0)
+			elog(ERROR, "parquet: nested column '%s' is not supported",
+				 elem->name);
+		if (elem->repetition == ParquetRepetition__REPEATED)
+			elog(ERROR, "parquet: repeated column '%s' is not supported",
+				 elem->name);
+		initArrowNode(field, Field);
+		field->name = elem->name;
+		field->_name_len = strlen(elem->name);
+		field->nullable = (elem->repetition != ParquetRepetition__REQUIRED);
+		__parquetSetupArrowType(elem, &field->type);
+	}
+	/* row-groups must have consistent columns */
+	for (int i=0; i < pq_info->num_row_groups; i++)
+	{
+		ParquetRowGroup *rgroup = &pq_info->row_groups[i];
+
+		if (rgroup->num_columns != nfields)
+			elog(ERROR, "parquet: row-group %d has %d columns, but %d expected",
+				 i, rgroup->num_columns, nfields);
+		for (int j=0; j < nfields; j++)
+		{
+			if (rgroup->columns[j].physical_type !=
+				pq_info->elements[j+1].physical_type)
+				elog(ERROR, "parquet: row-group %d column '%s' has inconsistent type",
+					 i, pq_info->elements[j+1].name);
+		}
+	}
+}
+
+/*
+ * parquet::PageHeader
+ */
+typedef struct
+{
+	int			page_type;
+	int32_t		uncompressed_size;
+	int32_t		compressed_size;
+	int32_t		num_values;
+	int			encoding;
+	int			def_level_encoding;
+	/* DATA_PAGE_V2 only */
+	int32_t		def_levels_len;
+	int32_t		rep_levels_len;
+	bool		is_compressed;
+} parquetPageHeader;
+
+static void
+__parquetReadPageHeader(thriftReader *r, parquetPageHeader *hdr)
+{
+	int16_t		fid = 0;
+	int			ftype;
+
+	memset(hdr, 0, sizeof(parquetPageHeader));
+	hdr->page_type = -1;
+	hdr->def_level_encoding = ParquetEncoding__RLE;
+	hdr->is_compressed = true;
+	while ((ftype = __thriftReadFieldHeader(r, &fid)) != THRIFT_STOP)
+	{
+		int16_t		__fid = 0;
+		int			__ftype;
+
+		switch (fid)
+		{
+			case 1:		/* type */
+				hdr->page_type = __thriftReadInteger(r, ftype);
+				break;
+			case 2:		/* uncompressed_page_size */
+				hdr->uncompressed_size = __thriftReadInteger(r, ftype);
+				break;
+			case 3:		/* compressed_page_size */
+				hdr->compressed_size = __thriftReadInteger(r, ftype);
+				break;
+			case 5:		/* data_page_header */
+				__thriftCheckStruct(ftype);
+				while ((__ftype = __thriftReadFieldHeader(r, &__fid)) != THRIFT_STOP)
+				{
+					if (__fid == 1)
+						hdr->num_values = __thriftReadInteger(r, __ftype);
+					else if (__fid == 2)
+						hdr->encoding = __thriftReadInteger(r, __ftype);
+					else if (__fid == 3)
+						hdr->def_level_encoding = __thriftReadInteger(r, __ftype);
+					else
+						__thriftSkipField(r, __ftype);
+				}
+				break;
+			case 7:		/* dictionary_page_header */
+				__thriftCheckStruct(ftype);
+				while ((__ftype = __thriftReadFieldHeader(r, &__fid)) != THRIFT_STOP)
+				{
+					if (__fid == 1)
+						hdr->num_values = __thriftReadInteger(r, __ftype);
+					else if (__fid == 2)
+						hdr->encoding = __thriftReadInteger(r, __ftype);
+					else
+						__thriftSkipField(r, __ftype);
+				}
+				break;
+			case 8:		/* data_page_header_v2 */
+				__thriftCheckStruct(ftype);
+				while ((__ftype = __thriftReadFieldHeader(r, &__fid)) != THRIFT_STOP)
+				{
+					if (__fid == 1)
+						hdr->num_values = __thriftReadInteger(r, __ftype);
+					else if (__fid == 4)
+						hdr->encoding = __thriftReadInteger(r, __ftype);
+					else if (__fid == 5)
+						hdr->def_levels_len = __thriftReadInteger(r, __ftype);
+					else if (__fid == 6)
+						hdr->rep_levels_len = __thriftReadInteger(r, __ftype);
+					else if (__fid == 7)
+						hdr->is_compressed = __thriftReadBool(r, __ftype);
+					else
+						__thriftSkipField(r, __ftype);
+				}
+				break;
+			default:
+				__thriftSkipField(r, ftype);
+				break;
+		}
+	}
+	if (hdr->compressed_size < 0 ||
+		hdr->uncompressed_size < 0 ||
+		hdr->num_values < 0 ||
+		hdr->def_levels_len < 0 ||
+		hdr->rep_levels_len < 0 ||
+		hdr->def_levels_len + hdr->rep_levels_len > hdr->compressed_size)
+		elog(ERROR, "parquet: PageHeader is corrupted");
+}
+
+/*
+ * RLE / Bit-packed hybrid decoder (levels and dictionary indexes)
+ */
+typedef struct
+{
+	const uint8_t *pos;
+	const uint8_t *end;
+	int			bit_width;
+	uint32_t	rle_count;
+	uint32_t	rle_value;
+	uint32_t	bp_count;	/* remaining values in the bit-packed run */
+	uint32_t	bp_index;
+	const uint8_t *bp_base;
+} parquetRleDecoder;
+
+static void
+__parquetRleInit(parquetRleDecoder *dec,
+				 const char *pos, const char *end, int bit_width)
+{
+	if (bit_width < 0 || bit_width > 32)
+		elog(ERROR, "parquet: unexpected RLE bit-width (%d)", bit_width);
+	memset(dec, 0, sizeof(parquetRleDecoder));
+	dec->pos = (const uint8_t *)pos;
+	dec->end = (const uint8_t *)end;
+	dec->bit_width = bit_width;
+}
+
+static uint32_t
+__parquetRleNext(parquetRleDecoder *dec)
+{
+	if (dec->rle_count == 0 && dec->bp_count == 0)
+	{
+		uint64_t	header = 0;
+		int			shift = 0;
+
+		for (;;)
+		{
+			uint8_t		c;
+
+			if (dec->pos >= dec->end)
+				elog(ERROR, "parquet: RLE encoded data is truncated");
+			c = *dec->pos++;
+			header |= ((uint64_t)(c & 0x7f)) << shift;
+			if ((c & 0x80) == 0)
+				break;
+			shift += 7;
+			if (shift >= 64)
+				elog(ERROR, "parquet: RLE run header is corrupted");
+		}
+
+		if ((header & 1) != 0)
+		{
+			/* bit-packed run; (header >> 1) groups of 8 values */
+			uint64_t	ngroups = (header >> 1);
+
+			if (ngroups == 0 ||
+				ngroups * dec->bit_width > (uint64_t)(dec->end - dec->pos))
+				elog(ERROR, "parquet: bit-packed run is corrupted");
+			dec->bp_count = ngroups * 8;
+			dec->bp_index = 0;
+			dec->bp_base  = dec->pos;
+			dec->pos += ngroups * dec->bit_width;
+		}
+		else
+		{
+			/* RLE run */
+			int			nbytes = (dec->bit_width + 7) / 8;
+
+			if (nbytes > dec->end - dec->pos)
+				elog(ERROR, "parquet: RLE run is truncated");
+			dec->rle_count = (header >> 1);
+			dec->rle_value = 0;
+			for (int k=0; k < nbytes; k++)
+				dec->rle_value |= ((uint32_t)dec->pos[k]) << (8 * k);
+			dec->pos += nbytes;
+			if (dec->rle_count == 0)
+				return __parquetRleNext(dec);
+		}
+	}
+
+	if (dec->rle_count > 0)
+	{
+		dec->rle_count--;
+		return dec->rle_value;
+	}
+	else
+	{
+		uint64_t	bit_pos = (uint64_t)dec->bp_index * dec->bit_width;
+		const uint8_t *addr = dec->bp_base + (bit_pos >> 3);
+		uint64_t	bits = 0;
+		int			nbytes = Min(dec->end - addr, (long)sizeof(uint64_t));
+
+		memcpy(&bits, addr, nbytes);
+		dec->bp_index++;
+		dec->bp_count--;
+		return (uint32_t)((bits >> (bit_pos & 7)) &
+						  ((1UL << dec->bit_width) - 1));
+	}
+}
+
+/*
+ * Decompression of the pages
+ */
+static const char *
+__parquetDecompress(int codec,
+					const char *src, size_t src_sz, size_t dst_sz,
+					StringInfo buf)
+{
+	char	   *dst;
+
+	if (codec == ParquetCodec__UNCOMPRESSED)
+	{
+		if (src_sz < dst_sz)
+			elog(ERROR, "parquet: uncompressed page is truncated");
+		return src;
+	}
+	resetStringInfo(buf);
+	enlargeStringInfo(buf, dst_sz);
+	dst = buf->data;
+	switch (codec)
+	{
+#ifdef WITH_LIBSNAPPY
+		case ParquetCodec__SNAPPY:
+			{
+				size_t		len = dst_sz;
+
+				if (snappy_uncompress(src, src_sz, dst, &len) != SNAPPY_OK)
+					elog(ERROR, "failed on snappy_uncompress");
+				if (len != dst_sz)
+					elog(ERROR, "parquet: SNAPPY decompressed length mismatch (%zu of %zu)",
+						 len, dst_sz);
+			}
+			break;
+#endif
+#ifdef WITH_LIBZSTD
+		case ParquetCodec__ZSTD:
+			{
+				size_t		rc = ZSTD_decompress(dst, dst_sz, src, src_sz);
+
+				if (ZSTD_isError(rc))
+					elog(ERROR, "failed on ZSTD_decompress: %s",
+						 ZSTD_getErrorName(rc));
+				if (rc != dst_sz)
+					elog(ERROR, "parquet: ZSTD decompressed length mismatch (%zu of %zu)",
+						 rc, dst_sz);
+			}
+			break;
+#endif
+#ifdef WITH_LIBLZ4
+		case ParquetCodec__LZ4_RAW:
+			{
+				int		rc = LZ4_decompress_safe(src, dst, src_sz, dst_sz);
+
+				if (rc < 0 || rc != dst_sz)
+					elog(ERROR, "failed on LZ4_decompress_safe (rc=%d)", rc);
+			}
+			break;
+#endif
+		default:
+			elog(ERROR, "parquet: compression codec %s is not supported",
+				 codec == ParquetCodec__SNAPPY  ? "SNAPPY" :
+				 codec == ParquetCodec__GZIP    ? "GZIP" :
+				 codec == ParquetCodec__LZO     ? "LZO" :
+				 codec == ParquetCodec__BROTLI  ? "BROTLI" :
+				 codec == ParquetCodec__LZ4     ? "LZ4" :
+				 codec == ParquetCodec__ZSTD    ? "ZSTD" :
+				 codec == ParquetCodec__LZ4_RAW ? "LZ4_RAW" : "unknown");
+	}
+	buf->len = dst_sz;
+	return dst;
+}
+
+/*
+ * Column chunk decoder
+ */
+typedef struct
+{
+	const char *filename;
+	const ParquetColumnDesc *pq_desc;
+	const ArrowTypeOptions *attopts;
+	int64_t		nitems;
+	int64_t		row;
+	int64_t		null_count;
+	StringInfo	nullmap;
+	StringInfo	values;
+	StringInfo	extra;
+	/* dictionary */
+	int32_t		dict_nitems;
+	const char **dict_addr;
+	int32_t	   *dict_len;
+	StringInfoData dict_buf;
+	/* page buffer */
+	StringInfoData page_buf;
+} parquetDecodeState;
+
+static void
+__parquetEmitNull(parquetDecodeState *ds)
+{
+	if (ds->attopts->tag == ArrowType__Utf8 ||
+		ds->attopts->tag == ArrowType__Binary)
+	{
+		uint32_t   *offsets = (uint32_t *)ds->values->data;
+
+		offsets[ds->row + 1] = ds->extra->len;
+	}
+	ds->null_count++;
+	ds->row++;
+}
+
+static void
+__parquetEmitValue(parquetDecodeState *ds, const char *addr, int len)
+{
+	const ArrowTypeOptions *attopts = ds->attopts;
+	int64_t		row = ds->row;
+	char	   *dest;
+
+	ds->nullmap->data[row >> 3] |= (1 << (row & 7));
+	switch (attopts->tag)
+	{
+		case ArrowType__Bool:
+			if (*addr)
+				ds->values->data[row >> 3] |= (1 << (row & 7));
+			break;
+
+		case ArrowType__Utf8:
+		case ArrowType__Binary:
+			{
+				uint32_t   *offsets;
+
+				if ((uint64_t)ds->extra->len + len >= UINT_MAX)
+					elog(ERROR, "parquet: column chunk in '%s' is too large",
+						 ds->filename);
+				appendBinaryStringInfo(ds->extra, addr, len);
+				offsets = (uint32_t *)ds->values->data;
+				offsets[row + 1] = ds->extra->len;
+			}
+			break;
+
+		case ArrowType__Decimal:
+			{
+				int128_t	ival;
+
+				if (ds->pq_desc->physical_type == ParquetType__INT32)
+					ival = *((const int32_t *)addr);
+				else if (ds->pq_desc->physical_type == ParquetType__INT64)
+					ival = *((const int64_t *)addr);
+				else
+				{
+					/* big-endian two's complement */
+					const uint8_t *pos = (const uint8_t *)addr;
+
+					ival = ((len > 0 && (pos[0] & 0x80) != 0) ? -1 : 0);
+					for (int k=0; k < len; k++)
+						ival = (ival << 8) | pos[k];
+				}
+				dest = ds->values->data + sizeof(int128_t) * row;
+				memcpy(dest, &ival, sizeof(int128_t));
+			}
+			break;
+
+		default:
+			if (len < attopts->unitsz)
+				elog(ERROR, "parquet: value in '%s' is shorter than expected",
+					 ds->filename);
+			/* INT32 may be narrowed to int8/int16; little-endian */
+			dest = ds->values->data + (size_t)attopts->unitsz * row;
+			memcpy(dest, addr, attopts->unitsz);
+			break;
+	}
+	ds->row++;
+}
+
+/*
+ * __parquetPlainNext - fetch the next PLAIN encoded value
+ */
+static const char *
+__parquetPlainNext(parquetDecodeState *ds,
+				   const char **p_pos, const char *end,
+				   uint32_t *p_bitpos, int *p_len, char *bool_buf)
+{
+	const char *pos = *p_pos;
+	int			len;
+
+	switch (ds->pq_desc->physical_type)
+	{
+		case ParquetType__BOOLEAN:
+			if (pos + (*p_bitpos >> 3) >= end)
+				elog(ERROR, "parquet: PLAIN boolean values are truncated");
+			*bool_buf = ((pos[*p_bitpos >> 3] >> (*p_bitpos & 7)) & 1);
+			(*p_bitpos)++;
+			*p_len = 1;
+			return bool_buf;
+		case ParquetType__INT32:
+		case ParquetType__FLOAT:
+			len = sizeof(int32_t);
+			break;
+		case ParquetType__INT64:
+		case ParquetType__DOUBLE:
+			len = sizeof(int64_t);
+			break;
+		case ParquetType__FIXED_LEN_BYTE_ARRAY:
+			len = ds->pq_desc->type_length;
+			break;
+		case ParquetType__BYTE_ARRAY:
+			if (end - pos < sizeof(uint32_t))
+				elog(ERROR, "parquet: PLAIN byte-array is truncated");
+			len = *((const uint32_t *)pos);
+			pos += sizeof(uint32_t);
+			if (len < 0)
+				elog(ERROR, "parquet: PLAIN byte-array is corrupted");
+			break;
+		default:
+			elog(ERROR, "parquet: unsupported physical type (%d)",
+				 ds->pq_desc->physical_type);
+	}
+	if (end - pos < len)
+		elog(ERROR, "parquet: PLAIN values are truncated");
+	*p_pos = pos + len;
+	*p_len = len;
+	return pos;
+}
+
+static void
+__parquetDecodeDictionaryPage(parquetDecodeState *ds,
+							  parquetPageHeader *hdr,
+							  const char *page, const char *end)
+{
+	const char *pos;
+	uint32_t	bitpos = 0;
+	char		bool_buf;
+
+	if (hdr->encoding != ParquetEncoding__PLAIN &&
+		hdr->encoding != ParquetEncoding__PLAIN_DICTIONARY)
+		elog(ERROR, "parquet: dictionary page with encoding=%d is not supported",
+			 hdr->encoding);
+	if (ds->pq_desc->physical_type == ParquetType__BOOLEAN)
+		elog(ERROR, "parquet: dictionary of boolean is not supported");
+	if (ds->dict_addr)
+		elog(ERROR, "parquet: multiple dictionary pages in a column chunk");
+	/* dictionary must be kept during the column chunk */
+	initStringInfo(&ds->dict_buf);
+	pos = __parquetDecompress(ds->pq_desc->codec,
+							  page, end - page,
+							  hdr->uncompressed_size,
+							  &ds->dict_buf);
+	if (pos != ds->dict_buf.data)
+	{
+		/* uncompressed; page is on the chunk buffer that lives longer */
+		pfree(ds->dict_buf.data);
+		ds->dict_buf.data = NULL;
+	}
+	end = pos + hdr->uncompressed_size;
+
+	ds->dict_nitems = hdr->num_values;
+	ds->dict_addr = palloc(sizeof(const char *) * Max(hdr->num_values, 1));
+	ds->dict_len  = palloc(sizeof(int32_t) * Max(hdr->num_values, 1));
+	for (int i=0; i < hdr->num_values; i++)
+	{
+		ds->dict_addr[i] = __parquetPlainNext(ds, &pos, end, &bitpos,
+											  &ds->dict_len[i], &bool_buf);
+	}
+}
+
+static void
+__parquetDecodeDataPage(parquetDecodeState *ds,
+						parquetPageHeader *hdr,
+						const char *page, const char *end)
+{
+	const ParquetColumnDesc *pq_desc = ds->pq_desc;
+	parquetRleDecoder def_dec;
+	parquetRleDecoder val_dec;
+	const char *pos;
+	const char *tail;
+	uint32_t	bitpos = 0;
+	char		bool_buf;
+	int			encoding = hdr->encoding;
+
+	if (hdr->page_type == ParquetPageType__DATA_PAGE)
+	{
+		pos = __parquetDecompress(pq_desc->codec,
+								  page, end - page,
+								  hdr->uncompressed_size,
+								  &ds->page_buf);
+		tail = pos + hdr->uncompressed_size;
+		/* repetition levels are not stored for flat columns */
+		if (pq_desc->max_def_level > 0)
+		{
+			uint32_t	len;
+
+			if (hdr->def_level_encoding != ParquetEncoding__RLE)
+				elog(ERROR, "parquet: definition levels with encoding=%d is not supported",
+					 hdr->def_level_encoding);
+			if (tail - pos < sizeof(uint32_t))
+				elog(ERROR, "parquet: definition levels are truncated");
+			len = *((const uint32_t *)pos);
+			pos += sizeof(uint32_t);
+			if (len > tail - pos)
+				elog(ERROR, "parquet: definition levels are truncated");
+			__parquetRleInit(&def_dec, pos, pos + len, 1);
+			pos += len;
+		}
+	}
+	else
+	{
+		const char *levels = page + hdr->rep_levels_len;
+		size_t		offset = hdr->rep_levels_len + hdr->def_levels_len;
+
+		if (pq_desc->max_def_level > 0)
+			__parquetRleInit(&def_dec, levels,
+							 levels + hdr->def_levels_len, 1);
+		if (hdr->uncompressed_size < offset)
+			elog(ERROR, "parquet: DATA_PAGE_V2 header is corrupted");
+		if (hdr->is_compressed)
+			pos = __parquetDecompress(pq_desc->codec,
+									  page + offset, (end - page) - offset,
+									  hdr->uncompressed_size - offset,
+									  &ds->page_buf);
+		else
+			pos = page + offset;
+		tail = pos + (hdr->uncompressed_size - offset);
+	}
+
+	/* setup values decoder */
+	switch (encoding)
+	{
+		case ParquetEncoding__PLAIN:
+			break;
+		case ParquetEncoding__PLAIN_DICTIONARY:
+		case ParquetEncoding__RLE_DICTIONARY:
+			if (!ds->dict_addr)
+				elog(ERROR, "parquet: dictionary page is missing");
+			if (pos >= tail)
+				elog(ERROR, "parquet: dictionary indexes are truncated");
+			__parquetRleInit(&val_dec, pos + 1, tail, *((const uint8_t *)pos));
+			break;
+		case ParquetEncoding__RLE:
+			if (pq_desc->physical_type != ParquetType__BOOLEAN)
+				elog(ERROR, "parquet: RLE encoding is only supported for boolean");
+			if (tail - pos < sizeof(uint32_t))
+				elog(ERROR, "parquet: RLE boolean values are truncated");
+			__parquetRleInit(&val_dec, pos + sizeof(uint32_t), tail, 1);
+			break;
+		default:
+			elog(ERROR, "parquet: data page with encoding=%d is not supported",
+				 encoding);
+	}
+
+	for (int i=0; i < hdr->num_values; i++)
+	{
+		const char *addr;
+		int			len;
+		uint32_t	index;
+
+		if (ds->row >= ds->nitems)
+			elog(ERROR, "parquet: column chunk in '%s' has more values than expected",
+				 ds->filename);
+		if (pq_desc->max_def_level > 0 &&
+			__parquetRleNext(&def_dec) < pq_desc->max_def_level)
+		{
+			__parquetEmitNull(ds);
+			continue;
+		}
+		switch (encoding)
+		{
+			case ParquetEncoding__PLAIN:
+				addr = __parquetPlainNext(ds, &pos, tail, &bitpos,
+										  &len, &bool_buf);
+				break;
+			case ParquetEncoding__RLE:
+				bool_buf = (__parquetRleNext(&val_dec) != 0);
+				addr = &bool_buf;
+				len = 1;
+				break;
+			default:
+				index = __parquetRleNext(&val_dec);
+				if (index >= ds->dict_nitems)
+					elog(ERROR, "parquet: dictionary index (%u) out of range",
+						 index);
+				addr = ds->dict_addr[index];
+				len  = ds->dict_len[index];
+				break;
+		}
+		__parquetEmitValue(ds, addr, len);
+	}
+}
+
+/*
+ * parquetDecodeColumnChunk
+ *
+ * It decodes the supplied column chunk into the nullmap, values and extra
+ * buffers in the Apache Arrow layout, then returns the number of NULLs.
+ */
+int64_t
+parquetDecodeColumnChunk(const char *filename,
+						 const ParquetColumnDesc *pq_desc,
+						 const ArrowTypeOptions *attopts,
+						 const char *chunk, size_t chunk_sz,
+						 int64_t nitems,
+						 StringInfo nullmap,
+						 StringInfo values,
+						 StringInfo extra)
+{
+	parquetDecodeState ds;
+	const char *pos = chunk;
+	const char *end = chunk + chunk_sz;
+	size_t		sz;
+
+	memset(&ds, 0, sizeof(parquetDecodeState));
+	ds.filename = filename;
+	ds.pq_desc  = pq_desc;
+	ds.attopts  = attopts;
+	ds.nitems   = nitems;
+	ds.nullmap  = nullmap;
+	ds.values   = values;
+	ds.extra    = extra;
+	initStringInfo(&ds.page_buf);
+
+	/* setup output buffers */
+	sz = BITMAPLEN(nitems);
+	enlargeStringInfo(nullmap, sz);
+	memset(nullmap->data, 0, sz);
+	nullmap->len = sz;
+	switch (attopts->tag)
+	{
+		case ArrowType__Bool:
+			sz = BITMAPLEN(nitems);
+			break;
+		case ArrowType__Utf8:
+		case ArrowType__Binary:
+			sz = sizeof(uint32_t) * (nitems + 1);
+			break;
+		default:
+			if (attopts->unitsz <= 0)
+				elog(ERROR, "Bug? unexpected Arrow type for parquet column");
+			sz = (size_t)attopts->unitsz * nitems;
+			break;
+	}
+	enlargeStringInfo(values, sz);
+	memset(values->data, 0, sz);
+	values->len = sz;
+
+	while (ds.row < nitems)
+	{
+		parquetPageHeader hdr;
+		thriftReader r;
+		const char *page;
+
+		CHECK_FOR_INTERRUPTS();
+
+		if (pos >= end)
+			elog(ERROR, "parquet: column chunk in '%s' has less values than expected",
+				 filename);
+		r.pos = pos;
+		r.end = end;
+		__parquetReadPageHeader(&r, &hdr);
+		page = r.pos;
+		if (hdr.compressed_size > end - page)
+			elog(ERROR, "parquet: page in '%s' is truncated", filename);
+		pos = page + hdr.compressed_size;
+
+		switch (hdr.page_type)
+		{
+			case ParquetPageType__DICTIONARY_PAGE:
+				__parquetDecodeDictionaryPage(&ds, &hdr, page, pos);
+				break;
+			case ParquetPageType__DATA_PAGE:
+			case ParquetPageType__DATA_PAGE_V2:
+				__parquetDecodeDataPage(&ds, &hdr, page, pos);
+				break;
+			default:
+				/* INDEX_PAGE and others are not used */
+				break;
+		}
+	}
+	if (ds.dict_buf.data)
+		pfree(ds.dict_buf.data);
+	if (ds.dict_addr)
+		pfree(ds.dict_addr);
+	if (ds.dict_len)
+		pfree(ds.dict_len);
+	pfree(ds.page_buf.data);
+
+	return ds.null_count;
+}
@@ -41,6 +41,7 @@
 #if PG_VERSION_NUM >= 160000
 #define pg_type_aclcheck(a,b,c)		object_aclcheck(TypeRelationId,(a),(b),(c))
 #define pg_proc_aclcheck(a,b,c)		object_aclcheck(ProcedureRelationId,(a),(b),(c))
+#define pg_class_ownercheck(a,b)	object_ownercheck(RelationRelationId,(a),(b))
 #endif
 
 /*
@@ -40,9 +40,11 @@
 #include "catalog/pg_am.h"
 #include "catalog/pg_amop.h"
 #include "catalog/pg_cast.h"
+#include "catalog/pg_collation.h"
 #include "catalog/pg_database.h"
 #include "catalog/pg_depend.h"
 #include "catalog/pg_foreign_table.h"
+#include "catalog/pg_language.h"
 #include "catalog/pg_foreign_data_wrapper.h"
 #include "catalog/pg_foreign_server.h"
 #include "catalog/pg_user_mapping.h"
@@ -64,6 +66,8 @@
 #include "common/hashfn.h"
 #include "common/int.h"
 #include "common/md5.h"
+#include "executor/execPartition.h"
+#include "executor/functions.h"
 #include "executor/nodeIndexscan.h"
 #include "executor/nodeSubplan.h"
 #include "foreign/fdwapi.h"
@@ -71,6 +75,7 @@
 #include "funcapi.h"
 #include "libpq/pqformat.h"
 #include "libpq/pqsignal.h"
+#include "lib/binaryheap.h"
 #include "lib/stringinfo.h"
 #include "miscadmin.h"
 #include "nodes/extensible.h"
@@ -88,18 +93,24 @@
 #include "optimizer/planmain.h"
 #include "optimizer/restrictinfo.h"
 #include "optimizer/tlist.h"
+#include "parser/parse_agg.h"
 #include "parser/parse_func.h"
 #include "postmaster/bgworker.h"
 #include "postmaster/postmaster.h"
+#include "rewrite/rewriteHandler.h"
+#include "rewrite/rewriteManip.h"
 #include "storage/bufmgr.h"
 #include "storage/buf_internals.h"
 #include "storage/ipc.h"
 #include "storage/fd.h"
 #include "storage/latch.h"
+#include "storage/lmgr.h"
 #include "storage/pmsignal.h"
 #include "storage/procarray.h"
 #include "storage/shmem.h"
 #include "storage/smgr.h"
+#include "tcop/tcopprot.h"
+#include "utils/array.h"
 #include "utils/builtins.h"
 #include "utils/cash.h"
 #include "utils/catcache.h"
@@ -112,6 +123,7 @@
 #include "utils/inet.h"
 #include "utils/inval.h"
 #include "utils/jsonb.h"
+#include "utils/logtape.h"
 #include "utils/lsyscache.h"
 #include "utils/pg_locale.h"
 #include "utils/rangetypes.h"
@@ -120,9 +132,11 @@
 #include "utils/resowner.h"
 #include "utils/ruleutils.h"
 #include "utils/selfuncs.h"
+#include "utils/sortsupport.h"
 #include "utils/spccache.h"
 #include "utils/syscache.h"
 #include "utils/timestamp.h"
+#include "utils/tuplesort.h"
 #include "utils/tuplestore.h"
 #include "utils/typcache.h"
 #include "utils/uuid.h"
@@ -172,6 +186,8 @@ typedef struct GpuDevAttributes
 	size_t		DEV_TOTAL_MEMSZ;
 	size_t		DEV_BAR1_MEMSZ;
 	bool		DEV_SUPPORT_GPUDIRECTSQL;
+	int32		DEV_MIG_SIBLINGS;	/* # of MIG instances on the GPU, or 0 */
+	int32		DEV_MPS_THREAD_PERCENTAGE;	/* active threads of MPS, or 0 */
 #define DEV_ATTR(LABEL,DESC)	\
 	int32		LABEL;
 #include "gpu_devattrs.h"
@@ -232,6 +248,7 @@ typedef struct devfunc_info
 	uint64_t	func_flags;
 	int			func_cost;
 	bool		func_is_negative;
+	Expr	   *func_inline_expr;	/* body of the inlined SQL function */
 	int			func_nargs;
 	struct devtype_info *func_argtypes[1];
 } devfunc_info;
@@ -241,6 +258,7 @@ typedef struct GpuCacheDesc		GpuCacheDesc;
 typedef struct DpuStorageEntry	DpuStorageEntry;
 typedef struct ArrowFdwState	ArrowFdwState;
 typedef struct BrinIndexState	BrinIndexState;
+typedef struct ZoneMapState		ZoneMapState;
 
 /*
  * pgstromPlanInfo
@@ -263,6 +281,11 @@ typedef struct
 	Selectivity		gist_selectivity; /* GiST selectivity */
 	double			gist_npages;	/* number of disk pages */
 	int				gist_height;	/* index tree height, or -1 if unknown */
+	/* range-join properties (sorted nested-loop) */
+	Expr		   *range_outer_key; /* outer key of the range-join clause */
+	Expr		   *range_inner_key; /* inner key of the range-join clause */
+	int				range_strategy;	/* btree strategy of (inner OP outer) */
+	double			range_grid_distance; /* distance of st_dwithin, if grid-join */
 } pgstromPlanInnerInfo;
 
 typedef struct
@@ -285,10 +308,13 @@ typedef struct
 	Cost		inner_cost;			/* cost for inner setup */
 	Cost		run_cost;			/* run cost */
 	Cost		final_cost;			/* cost for sendback and host-side tasks */
+	double		gpu_memsz;			/* estimated device memory footprint */
 	/* BRIN-index support */
 	Oid			brin_index_oid;		/* OID of BRIN-index, if any */
 	List	   *brin_index_conds;	/* BRIN-index key conditions */
 	List	   *brin_index_quals;	/* Original BRIN-index qualifier */
+	List	   *brin_subindex_oids;	/* OIDs of secondary BRIN-indexes */
+	List	   *brin_subindex_conds;/* key conditions of secondary ones */
 	/* XPU code for JOIN */
 	bytea	   *kexp_load_vars_packed;	/* LoadVars[] */
 	bytea	   *kexp_move_vars_packed;	/* MoveVars[] */
@@ -296,6 +322,7 @@ typedef struct
 	bytea	   *kexp_join_quals_packed;
 	bytea	   *kexp_hash_keys_packed;
 	bytea	   *kexp_gist_evals_packed;
+	bytea	   *kexp_range_keys_packed;
 	bytea	   *kexp_projection;
 	bytea	   *kexp_groupby_keyhash;
 	bytea	   *kexp_groupby_keyload;
@@ -309,6 +336,18 @@ typedef struct
 	/* group-by parameters */
 	List	   *groupby_actions;		/* list of KAGG_ACTION__* on the kds_final */
 	int			groupby_prepfn_bufsz;	/* buffer-size for GpuPreAgg shared memory */
+	bool		groupby_final_mode;		/* kds_final has the final groups */
+	/* GPU Top-N selection / GPU Sort */
+	int			topk_nitems;			/* LIMIT + OFFSET, or 0 if not used */
+	int			limit_nitems;			/* LIMIT + OFFSET without ORDER BY */
+	int			sortkey_resno;			/* resno of the leading sort key */
+	int			sortkey_flags;			/* KERN_SORTKEY__* flags */
+	Oid			gpusort_sortop;			/* sort operator, if GPU Sort */
+	Oid			gpusort_collid;			/* collation of the sort key */
+	int			sortkey2_resno;			/* resno of the second sort key, or 0 */
+	int			sortkey2_flags;			/* KERN_SORTKEY__* flags */
+	Oid			gpusort_sortop2;		/* sort operator of the second key */
+	Oid			gpusort_collid2;		/* collation of the second key */
 	/* inner relations */
 	int			sibling_param_id;
 	int			num_rels;
@@ -334,6 +373,23 @@ typedef struct
 	List		   *inner_paths_list;
 } pgstromOuterPathLeafInfo;
 
+/*
+ * pgstromFallbackSlot - CPU fallback chunk offloaded to the other processes
+ */
+#define PGSTROM_FALLBACK_NSLOTS		16
+#define FALLBACK_SLOT__FREE			0
+#define FALLBACK_SLOT__RESERVED		1	/* owner is setting up */
+#define FALLBACK_SLOT__QUEUED		2	/* waiting for someone */
+#define FALLBACK_SLOT__TAKEN		3	/* someone is attaching */
+#define FALLBACK_SLOT__ATTACHED		4	/* owner can detach */
+
+typedef struct
+{
+	int32_t				status;			/* one of FALLBACK_SLOT__* */
+	pid_t				owner;			/* 0, if owner already detached */
+	dsm_handle			handle;			/* DSM segment of the KDS */
+} pgstromFallbackSlot;
+
 /*
  * pgstromSharedState
  */
@@ -342,9 +398,27 @@ typedef struct
 	pg_atomic_uint64	inner_nitems;
 	pg_atomic_uint64	inner_usage;
 	pg_atomic_uint64	stats_gist;			/* only GiST-index */
+	pg_atomic_uint32	gist_block_index;	/* next GiST-index block to copy */
 	pg_atomic_uint64	stats_join;			/* # of tuples by this join */
+	/* min/max of the inner hash-key, protected by preload_mutex */
+	bool				inner_key_valid;
+	int64_t				inner_key_min;
+	int64_t				inner_key_max;
+	/* max half-extent of the inner geometries, protected by preload_mutex */
+	double				inner_grid_extent;
 } pgstromSharedInnerState;
 
+/*
+ * Phases of the xPU task for the per-phase time statistics
+ */
+#define XPU_TASK_PHASE__QUEUE		0	/* enqueue -> dequeue by worker */
+#define XPU_TASK_PHASE__IO			1	/* dequeue -> kds_src loaded */
+#define XPU_TASK_PHASE__KERNEL		2	/* kds_src loaded -> kernel done */
+#define XPU_TASK_PHASE__POST		3	/* kernel done -> write-back */
+#define XPU_TASK_PHASE__TRANSFER	4	/* write-back -> picked up by backend */
+#define XPU_TASK_NUM_PHASES			5
+#define XPU_TASK_PHASE_NBUCKETS		24	/* log2 of microseconds */
+
 typedef struct
 {
 	dsm_handle			ss_handle;			/* DSM handle of the SharedState */
@@ -361,17 +435,25 @@ typedef struct
 	pg_atomic_uint64	source_ntuples_raw;	/* # of raw tuples in the base relation */
 	pg_atomic_uint64	source_ntuples_in;	/* # of tuples survived from WHERE-quals */
 	pg_atomic_uint64	result_ntuples;		/* # of tuples returned from xPU */
+	pg_atomic_uint32	exec_paths;			/* mask of XPU_EXEC_PATH__* */
+	/* per-phase time of the xPU tasks */
+	pg_atomic_uint64	phase_ntasks;
+	pg_atomic_uint64	phase_time_us[XPU_TASK_NUM_PHASES];
+	pg_atomic_uint32	phase_hist[XPU_TASK_NUM_PHASES][XPU_TASK_PHASE_NBUCKETS];
 	/* for parallel-scan */
 	uint32_t			parallel_scan_desc_offset;
 	/* for arrow_fdw */
 	pg_atomic_uint32	arrow_rbatch_index;
 	pg_atomic_uint32	arrow_rbatch_nload;	/* # of loaded record-batches */
 	pg_atomic_uint32	arrow_rbatch_nskip;	/* # of skipped record-batches */
+	pg_atomic_uint32	arrow_rbatch_nprune; /* # of pruned by late-materialization */
 	/* for gpu-cache */
 	pg_atomic_uint32	__gcache_fetch_count_data;
 	/* for brin-index */
 	pg_atomic_uint32	brin_index_fetched;
 	pg_atomic_uint32	brin_index_skipped;
+	/* for zone-map */
+	pg_atomic_uint64	zonemap_skipped_blocks;
 	/* for join-inner-preload */
 	ConditionVariable	preload_cond;		/* sync object */
 	slock_t				preload_mutex;		/* mutex for inner-preloading */
@@ -380,6 +462,11 @@ typedef struct
 	int					preload_nr_setup;	/* # of setup process */
 	uint32_t			preload_shmem_handle; /* host buffer handle */
 	uint64_t			preload_shmem_length; /* host buffer length */
+	/* for parallel CPU fallback */
+	slock_t				fallback_mutex;
+	ConditionVariable	fallback_cond;
+	pg_atomic_uint32	fallback_nqueued;	/* # of FALLBACK_SLOT__QUEUED */
+	pgstromFallbackSlot	fallback_slots[PGSTROM_FALLBACK_NSLOTS];
 	/* for join-inner relations */
 	uint32_t			num_rels;			/* if xPU-JOIN involved */
 	pgstromSharedInnerState inners[FLEXIBLE_ARRAY_MEMBER];
@@ -418,11 +505,24 @@ typedef struct
 	Relation		gist_irel;
 	ExprState	   *gist_clause;
 	AttrNumber		gist_ctid_resno;
+	/*
+	 * join properties (range-join)
+	 */
+	ExprState	   *range_inner_key;
+	int				range_strategy;
+	double			range_grid_distance;
+	/*
+	 * attribute numbers of geometry on the inner tuples, to build the edge
+	 * index of polygons
+	 */
+	List		   *geom_anums;
 	/*
 	 * CPU fallback (inner-loading)
 	 */
 	List		   *inner_load_src;		/* resno of inner tuple */
 	List		   *inner_load_dst;		/* resno of fallback slot */
+	uint32_t	   *fallback_hslots;	/* private hash-slot (rowid+1), if the */
+	uint32_t	   *fallback_hnext;		/* hash table is built by GPU */
 } pgstromTaskInnerState;
 
 struct pgstromTaskState
@@ -436,9 +536,19 @@ struct pgstromTaskState
 	pgstromPlanInfo	   *pp_info;
 	ArrowFdwState	   *arrow_state;
 	BrinIndexState	   *br_state;
+	ZoneMapState	   *zm_state;
 	GpuCacheDesc	   *gcache_desc;
 	pg_atomic_uint32   *gcache_fetch_count;
 	kern_multirels	   *h_kmrels;		/* host inner buffer (if JOIN) */
+	struct pgstromTaskState *sibling_leader; /* owner of the shared inner
+											  * buffer (partition-wise) */
+	/* grace hash-join, if inner hash table is partitioned */
+	int					inner_part_depth;	/* partitioned depth, or 0 */
+	uint32_t			inner_part_nparts;	/* # of partitions */
+	uint32_t			inner_part_id;		/* currently loaded partition */
+	uint32_t		   *inner_part_nitems;	/* # of tuples per partition */
+	uint64_t		   *inner_part_usage;	/* usage per partition */
+	MemoryContext		inner_part_memcxt;	/* keeps the preloaded tuples */
 	const char		   *kds_pathname;	/* pathname to be used for KDS setup */
 	/* current chunk (already processed by the device) */
 	XpuCommand		   *curr_resp;
@@ -448,6 +558,23 @@ struct pgstromTaskState
 	int64_t				curr_index;
 	bool				scan_done;
 	bool				final_done;
+	uint64_t			limit_nitems_received;	/* see limit_nitems */
+	size_t				chunk_size;		/* adaptive size of the source chunk */
+	/* asynchronous start of the next partition leaf under Append */
+	struct pgstromTaskState *async_next;
+	bool				async_kicked;	/* already kicked the next leafs */
+	bool				async_empty;	/* nothing to run in this leaf */
+	bool				async_prestarted; /* prestarted by the previous leaf */
+	/* cost calibration; elapsed time from the first call to the end */
+	uint64_t			calib_ts_begin;
+	bool				calib_recorded;
+	/* GPU Sort; merge of the sorted chunks */
+	struct pgstromGpuSortState *gpusort_state;
+	/* GpuPreAgg; attributes of STRING_AGG to be flattened */
+	Bitmapset		   *groupby_accum_attrs;
+	MemoryContext		groupby_accum_memcxt;
+	/* GpuPreAgg; result cache over the Arrow_Fdw files */
+	struct preaggResultCacheState *rcache_state;
 	/*
 	 * control variables to fire the end-of-task event
 	 * for RIGHT OUTER JOIN and PRE-AGG
@@ -467,14 +594,22 @@ struct pgstromTaskState
 	char			   *fallback_buffer;
 	TupleTableSlot	   *fallback_slot;	/* host-side kvars-slot */
 	List			   *fallback_proj;
+	dsm_segment		   *fallback_dsm_segs[PGSTROM_FALLBACK_NSLOTS]; /* offloaded */
 
 	List			   *fallback_load_src;	/* source resno of base-rel */
 	List			   *fallback_load_dst;	/* dest resno of fallback-slot */
+	int					fallback_load_natts; /* max resno in fallback_load_src */
 	/* request command buffer (+ status for table scan) */
 	TBMIterateResult   *curr_tbm;
 	Buffer				curr_vm_buffer;		/* for visibility-map */
 	BlockNumber			curr_block_num;		/* for KDS_FORMAT_BLOCK */
 	BlockNumber			curr_block_tail;	/* for KDS_FORMAT_BLOCK */
+	BlockNumber			prefetch_block_num;	/* for KDS_FORMAT_BLOCK */
+	BlockNumber			claim_block_num;	/* range reserved by the worker */
+	BlockNumber			claim_block_tail;	/* on the parallel scan */
+	BlockNumber			segment_optimal_id;	/* segment of the following */
+	int64_t				segment_optimal_gpus;
+	int64_t				chunk_optimal_gpus;	/* optimal GPUs for the chunk */
 	StringInfoData		xcmd_buf;
 	/* callbacks */
 	TupleTableSlot	 *(*cb_next_tuple)(struct pgstromTaskState *pts);
@@ -485,6 +620,8 @@ struct pgstromTaskState
 										struct iovec *xcmd_iov, int *xcmd_iovcnt);
 	bool			  (*cb_cpu_fallback)(struct pgstromTaskState *pts,
 										 HeapTuple htuple);
+	/* same as cb_cpu_fallback, but base_slot is already loaded */
+	bool			  (*cb_cpu_fallback_slot)(struct pgstromTaskState *pts);
 	/* inner relations state (if JOIN) */
 	int					num_rels;
 	pgstromTaskInnerState inners[FLEXIBLE_ARRAY_MEMBER];
@@ -501,7 +638,7 @@ extern long		PHYS_PAGES;
 extern long		PAGES_PER_BLOCK;	/* (BLCKSZ / PAGE_SIZE) */
 #define PAGE_ALIGN(x)			TYPEALIGN(PAGE_SIZE,(x))
 #define PAGE_ALIGN_DOWN(x)		TYPEALIGN_DOWN(PAGE_SIZE,(x))
-#define PGSTROM_CHUNK_SIZE		((size_t)(65534UL << 10))
+#define PGSTROM_CHUNK_SIZE		((size_t)(65534UL << 10))	/* upper limit */
 
 /*
  * extra.c
@@ -537,6 +674,12 @@ extern bool		gpuDirectFileReadAsyncIOV(const char *pathname,
 										  uint32_t *p_npages_vfs_read);
 extern char	   *gpuDirectGetProperty(void);
 extern void		gpuDirectSetProperty(const char *key, const char *value);
+extern void		gpuDirectSetupDMABufferPool(int cuda_dindex,
+											int numa_node_id,
+											size_t pool_sz);
+extern void		gpuDirectReleaseDMABufferPool(int cuda_dindex);
+extern void		gpuDirectAttachDMABuffer(int cuda_dindex);
+extern bool		gpuDirectDMABufferIsPooled(void);
 extern void		gpuDirectCleanUpOnThreadTerminate(void);
 extern bool		gpuDirectIsAvailable(void);
 
@@ -583,6 +726,8 @@ typedef struct
 	uint32_t	kvecs_usage;
 	Index		scan_relid;		/* depth==0 */
 	int			num_rels;
+	List	   *cse_kvdefs;		/* common sub-expressions already saved */
+	List	   *inline_funcs;	/* SQL functions under inlining */
 	struct {
 		PathTarget *inner_target;
 	} pd[1];
@@ -591,7 +736,12 @@ typedef struct
 extern Oid		get_int1_type_oid(bool missing_ok);
 extern Oid		get_float2_type_oid(bool missing_ok);
 extern Oid		get_cube_type_oid(bool missing_ok);
+extern Oid		get_geometry_type_oid(bool missing_ok);
 extern devtype_info *pgstrom_devtype_lookup(Oid type_oid);
+extern void		pgstrom_devtype_hash_batch(devtype_info *dtype, int nitems,
+										   const Datum *values,
+										   const bool *isnull,
+										   uint32_t *hashes);
 extern devfunc_info *pgstrom_devfunc_lookup(Oid func_oid,
 											List *func_args,
 											Oid func_collid);
@@ -611,6 +761,8 @@ extern bytea   *codegen_build_packed_hashkeys(codegen_context *context,
 											  List *stacked_hash_values);
 extern void		codegen_build_packed_gistevals(codegen_context *context,
 											   pgstromPlanInfo *pp_info);
+extern bytea   *codegen_build_packed_rangekeys(codegen_context *context,
+											   List *stacked_range_keys);
 extern bytea   *codegen_build_projection(codegen_context *context);
 extern void		codegen_build_groupby_actions(codegen_context *context,
 											  pgstromPlanInfo *pp_info);
@@ -639,6 +791,13 @@ extern void		pgstrom_explain_xpucode(const CustomScanState *css,
 extern char	   *pgstrom_xpucode_to_string(bytea *xpu_code);
 extern void		pgstrom_init_codegen(void);
 
+/*
+ * regex.c
+ */
+extern bytea   *pgstrom_regex_compile(const char *pattern, int patlen,
+									  bool icase, Oid collid,
+									  const char **p_errmsg);
+
 /*
  * brin.c
  */
@@ -646,7 +805,10 @@ extern IndexOptInfo *pgstromTryFindBrinIndex(PlannerInfo *root,
 											 RelOptInfo *baserel,
 											 List **p_indexConds,
 											 List **p_indexQuals,
-											 int64_t *p_indexNBlocks);
+											 int64_t *p_indexNBlocks,
+											 List **p_subIndexOids,
+											 List **p_subIndexConds,
+											 Cost *p_subIndexCost);
 extern Cost		cost_brin_bitmap_build(PlannerInfo *root,
 									   RelOptInfo *baserel,
 									   IndexOptInfo *indexOpt,
@@ -654,7 +816,9 @@ extern Cost		cost_brin_bitmap_build(PlannerInfo *root,
 extern void		pgstromBrinIndexExecBegin(pgstromTaskState *pts,
 										  Oid index_oid,
 										  List *index_conds,
-										  List *index_quals);
+										  List *index_quals,
+										  List *subindex_oids,
+										  List *subindex_conds);
 extern bool		pgstromBrinIndexNextChunk(pgstromTaskState *pts);
 extern TBMIterateResult *pgstromBrinIndexNextBlock(pgstromTaskState *pts);
 extern void		pgstromBrinIndexExecEnd(pgstromTaskState *pts);
@@ -668,6 +832,18 @@ extern void		pgstromBrinIndexExplain(pgstromTaskState *pts,
 										ExplainState *es);
 extern void		pgstrom_init_brin(void);
 
+/*
+ * zonemap.c
+ */
+extern void		pgstromZoneMapExecBegin(pgstromTaskState *pts, List *scan_quals);
+extern bool		pgstromZoneMapSkipBlock(pgstromTaskState *pts, BlockNumber block_num);
+extern void		pgstromZoneMapExecReset(pgstromTaskState *pts);
+extern void		pgstromZoneMapExecEnd(pgstromTaskState *pts);
+extern void		pgstromZoneMapExplain(pgstromTaskState *pts,
+									  List *dcontext,
+									  ExplainState *es);
+extern void		pgstrom_init_zonemap(void);
+
 /*
  * gist.c
  */
@@ -678,9 +854,19 @@ extern Path	   *pgstromTryFindGistIndex(PlannerInfo *root,
 										Index base_scan_relid,
 										List *inner_target_list,
 										pgstromPlanInnerInfo *pp_inner);
+/*
+ * cost_calib.c
+ */
+extern bool		pgstrom_cost_calibration;	/* GUC */
+extern double	pgstromCostCalibrationFactor(uint32_t devkind, uint32_t devtask);
+extern void		pgstromCostCalibrationRecordTask(pgstromTaskState *pts,
+												 uint64_t elapsed_us);
+extern void		pgstrom_init_cost_calib(void);
+
 /*
  * relscan.c
  */
+extern bool		pgstrom_relscan_block_format;
 extern Bitmapset *pickup_outer_referenced(PlannerInfo *root,
 										  RelOptInfo *base_rel,
 										  Bitmapset *referenced);
@@ -696,6 +882,9 @@ extern XpuCommand *pgstromRelScanChunkDirect(pgstromTaskState *pts,
 extern XpuCommand *pgstromRelScanChunkNormal(pgstromTaskState *pts,
 											 struct iovec *xcmd_iov,
 											 int *xcmd_iovcnt);
+extern XpuCommand *pgstromRelScanChunkPrefilter(pgstromTaskState *pts,
+												struct iovec *xcmd_iov,
+												int *xcmd_iovcnt);
 extern void		pgstromStoreFallbackTuple(pgstromTaskState *pts, HeapTuple tuple);
 extern TupleTableSlot *pgstromFetchFallbackTuple(pgstromTaskState *pts);
 extern void		pgstrom_init_relscan(void);
@@ -708,15 +897,27 @@ extern void		__xpuClientOpenSession(pgstromTaskState *pts,
 									   pgsocket sockfd,
 									   const char *devname,
 									   int dev_index);
+extern void		__xpuClientOpenSessionMulti(pgstromTaskState *pts,
+											const XpuCommand *session,
+											int num_socks,
+											const pgsocket *sockfds,
+											const int *dev_indexes,
+											const char *devname);
 extern int
 xpuConnectReceiveCommands(pgsocket sockfd,
 						  void *(*alloc_f)(void *priv, size_t sz),
 						  void  (*attach_f)(void *priv, XpuCommand *xcmd),
 						  void *priv,
 						  const char *error_label);
+extern bool		xpuClientReuseConnection(pgstromTaskState *pts,
+										 const XpuCommand *session,
+										 int dev_index);
 extern void		xpuClientCloseSession(XpuConnection *conn);
+extern void		xpuClientAttachLoadCounter(XpuConnection *conn,
+										   pg_atomic_uint32 *load_counter);
 extern void		xpuClientSendCommand(XpuConnection *conn, const XpuCommand *xcmd);
 extern void		xpuClientPutResponse(XpuCommand *xcmd);
+extern size_t		pgstromTaskStateChunkSize(pgstromTaskState *pts);
 extern const XpuCommand *pgstromBuildSessionInfo(pgstromTaskState *pts,
 												 uint32_t join_inner_handle,
 												 TupleDesc tdesc_final);
@@ -755,8 +956,13 @@ extern double	pgstrom_gpu_tuple_cost;		/* GUC */
 extern double	pgstrom_gpu_operator_cost;	/* GUC */
 extern double	pgstrom_gpu_direct_seq_page_cost; /* GUC */
 extern double	pgstrom_gpu_operator_ratio(void);
+extern size_t	pgstrom_gpu_memory_plan_limit(void);
 extern const Bitmapset *GetOptimalGpuForFile(const char *pathname);
 extern const Bitmapset *GetOptimalGpuForRelation(Relation relation);
+extern int64_t	GetOptimalGpuForSegment(pgstromTaskState *pts,
+										BlockNumber segment_id);
+extern int64_t	GetOptimalGpuForFileChunk(pgstromTaskState *pts,
+										  const char *pathname);
 extern const Bitmapset *GetOptimalGpuForBaseRel(PlannerInfo *root,
 												RelOptInfo *baserel);
 extern void		gpuClientOpenSession(pgstromTaskState *pts,
@@ -779,6 +985,17 @@ extern const char *cuStrError(CUresult rc);
 extern bool		gpuServiceGoingTerminate(void);
 extern void		gpuservBgWorkerMain(Datum arg);
 extern void		pgstrom_init_gpu_service(void);
+#ifdef WITH_NVTX
+extern void		pgstromNvtxRangeStart(uint64_t *p_range, const char *fmt, ...)
+				pg_attribute_printf(2, 3);
+extern void		pgstromNvtxRangeEnd(uint64_t *p_range);
+extern void		pgstromNvtxNameThread(const char *fmt, ...)
+				pg_attribute_printf(1, 2);
+#else
+#define pgstromNvtxRangeStart(p_range, fmt, ...)	((void)(p_range))
+#define pgstromNvtxRangeEnd(p_range)				((void)(p_range))
+#define pgstromNvtxNameThread(fmt, ...)				((void)0)
+#endif
 
 /*
  * gpu_cache.c
@@ -789,6 +1006,10 @@ extern int		baseRelHasGpuCache(PlannerInfo *root,
 extern bool		RelationHasGpuCache(Relation rel);
 extern const GpuCacheIdent *getGpuCacheDescIdent(const GpuCacheDesc *gc_desc);
 extern GpuCacheDesc *pgstromGpuCacheExecInit(pgstromTaskState *pts);
+extern const Bitmapset *pgstromGpuCacheOptimalGpus(GpuCacheDesc *gc_desc);
+extern bool		pgstromGpuCacheRedoSignature(GpuCacheDesc *gc_desc,
+											 Snapshot snapshot,
+											 StringInfo buf);
 extern XpuCommand *pgstromScanChunkGpuCache(pgstromTaskState *pts,
 											struct iovec *xcmd_iov,
 											int *xcmd_iovcnt);
@@ -811,6 +1032,10 @@ extern void	   *gpuCacheGetDeviceBuffer(const GpuCacheIdent *ident,
 										CUdeviceptr *p_gcache_main_devptr,
 										CUdeviceptr *p_gcache_extra_devptr,
 										char *errbuf, size_t errbuf_sz);
+extern int		gpuCacheBuildDeltaBuffer(void *gc_lmap,
+										 uint64_t merge_pos,
+										 CUdeviceptr *p_gcache_delta,
+										 char *errbuf, size_t errbuf_sz);
 extern void		gpuCachePutDeviceBuffer(void *gc_lmap);
 
 /*
@@ -818,9 +1043,17 @@ extern void		gpuCachePutDeviceBuffer(void *gc_lmap);
  */
 extern void		sort_device_qualifiers(List *dev_quals_list,
 									   List *dev_costs_list);
+extern Cost		cost_device_qualifiers(PlannerInfo *root,
+									   List *dev_quals_list,
+									   List *dev_costs_list,
+									   Index varRelid);
 extern pgstromPlanInfo *try_fetch_xpuscan_planinfo(const Path *path);
 extern List	   *assign_custom_cscan_tlist(List *tlist_dev,
 										  pgstromPlanInfo *pp_info);
+extern void		pgstrom_build_topk_planinfo(PlannerInfo *root,
+											RelOptInfo *rel,
+											pgstromPlanInfo *pp_info,
+											List *tlist_dev);
 extern List	   *buildOuterScanPlanInfo(PlannerInfo *root,
 									   RelOptInfo *baserel,
 									   uint32_t xpu_task_flags,
@@ -828,8 +1061,12 @@ extern List	   *buildOuterScanPlanInfo(PlannerInfo *root,
 									   bool consider_partition,
 									   bool allow_host_quals,
 									   bool allow_no_device_quals);
+extern Plan	   *pgstrom_build_dpu_prefilter_plan(PlannerInfo *root,
+												 CustomPath *cpath,
+												 pgstromPlanInfo *pp_gpu);
 extern bool		ExecFallbackCpuScan(pgstromTaskState *pts,
 									HeapTuple tuple);
+extern bool		ExecFallbackCpuScanSlot(pgstromTaskState *pts);
 extern void		gpuservHandleGpuScanExec(gpuClient *gclient, XpuCommand *xcmd);
 extern void		pgstrom_init_gpu_scan(void);
 extern void		pgstrom_init_dpu_scan(void);
@@ -851,8 +1088,11 @@ extern CustomScan *PlanXpuJoinPathCommon(PlannerInfo *root,
 										 pgstromPlanInfo *pp_info,
 										 const CustomScanMethods *methods);
 extern uint32_t	GpuJoinInnerPreload(pgstromTaskState *pts);
+extern bool		GpuJoinInnerPreloadSwitchPartition(pgstromTaskState *pts,
+												   uint32_t part_id);
 extern bool		ExecFallbackCpuJoin(pgstromTaskState *pts,
 									HeapTuple tuple);
+extern bool		ExecFallbackCpuJoinSlot(pgstromTaskState *pts);
 extern void		ExecFallbackCpuJoinRightOuter(pgstromTaskState *pts);
 extern void		ExecFallbackCpuJoinOuterJoinMap(pgstromTaskState *pts,
 												XpuCommand *resp);
@@ -891,11 +1131,17 @@ extern XpuCommand *pgstromScanChunkArrowFdw(pgstromTaskState *pts,
 											int *xcmd_iovcnt);
 extern void		pgstromArrowFdwExecEnd(ArrowFdwState *arrow_state);
 extern void		pgstromArrowFdwExecReset(ArrowFdwState *arrow_state);
+extern void		pgstromArrowFdwSetJoinKeyRange(ArrowFdwState *arrow_state,
+											   AttrNumber anum,
+											   int64_t key_min,
+											   int64_t key_max);
 extern void		pgstromArrowFdwInitDSM(ArrowFdwState *arrow_state,
 									   pgstromSharedState *ps_state);
 extern void		pgstromArrowFdwAttachDSM(ArrowFdwState *arrow_state,
 										 pgstromSharedState *ps_state);
 extern void		pgstromArrowFdwShutdown(ArrowFdwState *arrow_state);
+extern void		pgstromArrowFdwFileSignature(ArrowFdwState *arrow_state,
+											 StringInfo buf);
 extern void		pgstromArrowFdwExplain(ArrowFdwState *arrow_state,
 									   Relation frel,
 									   ExplainState *es,
@@ -906,6 +1152,28 @@ extern bool		kds_arrow_fetch_tuple(TupleTableSlot *slot,
 									  const Bitmapset *referenced);
 extern void pgstrom_init_arrow_fdw(void);
 
+/*
+ * arrow_remote.c
+ */
+typedef struct
+{
+	off_t		f_pos;
+	size_t		len;
+	char	   *dest;
+} arrowRemoteRange;
+
+extern bool		arrowRemoteIsURL(const char *filename);
+extern bool		arrowRemoteStat(const char *url,
+								struct stat *stat_buf,
+								bool missing_ok);
+extern void		arrowRemoteReadRanges(const char *url,
+									  arrowRemoteRange *ranges,
+									  int nranges);
+extern int		arrowRemoteOpenMetadata(const char *url,
+										struct stat *stat_buf,
+										bool missing_ok);
+extern void		pgstrom_init_arrow_remote(void);
+
 /*
  * dpu_device.c
  */
@@ -914,6 +1182,7 @@ extern double	pgstrom_dpu_operator_cost;
 extern double	pgstrom_dpu_seq_page_cost;
 extern double	pgstrom_dpu_tuple_cost;
 extern bool		pgstrom_dpu_handle_cached_pages;
+extern bool		pgstrom_dpu_compress_results;
 extern double	pgstrom_dpu_operator_ratio(void);
 
 extern const DpuStorageEntry *GetOptimalDpuForFile(const char *filename,
@@ -970,6 +1239,9 @@ extern void		__shmemDrop(uint32_t shmem_handle);
 extern void	   *__mmapShmem(uint32_t shmem_handle,
 							size_t shmem_length,
 							const DpuStorageEntry *ds_entry);
+extern void	   *__mmapFileWithHeader(int fdesc, off_t f_pos, size_t f_len,
+									 size_t head_sz, int advice,
+									 void **p_head);
 extern bool		__munmapShmem(void *mmap_addr);
 
 extern Path	   *pgstrom_copy_pathnode(const Path *pathnode);
@@ -983,6 +1255,15 @@ extern const char *pgstrom_githash_cstring;
  * main.c
  */
 extern bool		pgstrom_enabled(void);
+typedef enum
+{
+	PGSTROM_WAIT_EVENT__GPU_TASK = 0,
+	PGSTROM_WAIT_EVENT__DPU_TASK,
+	PGSTROM_WAIT_EVENT__INNER_PRELOAD,
+	PGSTROM_WAIT_EVENT__GPUCACHE_REDO,
+	PGSTROM_WAIT_EVENT__NITEMS,
+} PgStromWaitEvent;
+extern uint32	pgstrom_wait_event(PgStromWaitEvent kind);
 extern int		pgstrom_cpu_fallback_elevel;
 extern bool		pgstrom_regression_test_mode;
 extern void		pgstrom_remember_op_normal(PlannerInfo *root,
@@ -469,6 +469,18 @@ pthreadCondSignal(pthread_cond_t *cond)
 		__FATAL("failed on pthread_cond_signal: %m");
 }
 
+/*
+ * monotonic clock in microseconds; comparable between processes
+ */
+static inline uint64_t
+monotonic_clock_us(void)
+{
+	struct timespec tv;
+
+	clock_gettime(CLOCK_MONOTONIC, &tv);
+	return (uint64_t)tv.tv_sec * 1000000UL + tv.tv_nsec / 1000;
+}
+
 /*
  * Misc debug functions
  */
@@ -0,0 +1,1215 @@
+/*
+ * regex.c
+ *
+ * Routines to compile regular-expression pattern into DFA for xPU devices
+ * ----
+ * Copyright 2011-2023 (C) KaiGai Kohei <kaigai@kaigai.gr.jp>
+ * Copyright 2014-2023 (C) PG-Strom Developers Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the PostgreSQL License.
+ */
+#include "pg_strom.h"
+
+/*
+ * Supported syntax (subset of the PostgreSQL's ARE)
+ *
+ *  - literal characters, '.', '^', '$', '\A', '\Z'
+ *  - bracket expressions; [abc], [^a-z], [[:alpha:]], ...
+ *  - escapes; \d \D \s \S \w \W, \n \t \r \f \v \a \e, and \<punct>
+ *  - grouping; (...) and (?:...), alternation '|'
+ *  - quantifiers; *, +, ?, {m}, {m,}, {m,n}, and their non-greedy forms
+ *    (greediness does not matter to the boolean result)
+ *
+ * Back-references, look-ahead/behind constraints, word boundaries,
+ * embedded options and director prefixes are not supported, so these
+ * expressions are never pushed down to the device.
+ * The pattern is compiled to Thompson's NFA over the bytes of the text, then
+ * it is converted to DFA by the subset construction. '^' and '$' are zero-
+ * width assertions; '^' is satisfied only on the initial state, and '$' is
+ * evaluated on the last state by KERN_REGEX_ACCEPT__AT_END. Multi-byte characters are expanded to
+ * the byte sequences, so only UTF-8 and single-byte encodings are supported.
+ * Character classes and case-insensitive match depend on LC_CTYPE, so they
+ * are supported only on the "C" collation.
+ */
+#define REGEX_MAX_NFA_STATES	5000
+#define REGEX_MAX_DFA_STATES	1000
+#define REGEX_MAX_DFA_LENGTH	(256 * 1024)
+#define REGEX_MAX_REPEAT		255
+
+typedef struct
+{
+	uint32_t	bits[256 / 32];
+} regex_symset;
+
+#define symset_add(set,c)		((set)->bits[(c) >> 5] |= (1U << ((c) & 31)))
+#define symset_test(set,c)		(((set)->bits[(c) >> 5] & (1U << ((c) & 31))) != 0)
+
+typedef enum
+{
+	RNODE_EMPTY,
+	RNODE_SET,
+	RNODE_CAT,
+	RNODE_ALT,
+	RNODE_REPEAT,
+	RNODE_BOL,
+	RNODE_EOL,
+} regex_node_kind;
+
+typedef struct regex_node
+{
+	regex_node_kind kind;
+	regex_symset	set;		/* RNODE_SET */
+	struct regex_node *left;	/* RNODE_CAT, RNODE_ALT, RNODE_REPEAT */
+	struct regex_node *right;	/* RNODE_CAT, RNODE_ALT */
+	int				min;		/* RNODE_REPEAT */
+	int				max;		/* RNODE_REPEAT (-1 means infinity) */
+} regex_node;
+
+typedef struct
+{
+	const char	   *pos;
+	const char	   *end;
+	bool			icase;
+	bool			ctype_is_c;
+	bool			is_utf8;
+	const char	   *errmsg;
+} regex_parser;
+
+/*
+ * Thompson's NFA
+ */
+#define NFA_SYMSET		1
+#define NFA_SPLIT		2
+#define NFA_EPSILON		3
+#define NFA_MATCH		4
+#define NFA_ASSERT_BOL	5
+#define NFA_ASSERT_EOL	6
+
+typedef struct
+{
+	int				type;
+	int				out1;
+	int				out2;
+	int				symset_id;
+} regex_nfa_state;
+
+typedef struct
+{
+	regex_nfa_state *states;
+	int				nstates;
+	int				nrooms;
+	regex_symset   *symsets;
+	int				nsymsets;
+	int				nsymsets_rooms;
+	const char	   *errmsg;
+} regex_nfa;
+
+typedef struct
+{
+	int				start;
+	int				end;		/* NFA_EPSILON state to be connected */
+} regex_frag;
+
+static regex_node *__regex_parse_alternative(regex_parser *rp, int depth);
+
+/* ----------------------------------------------------------------
+ *
+ * Parser of the regular-expression
+ *
+ * ---------------------------------------------------------------- */
+static regex_node *
+__regex_make_node(regex_node_kind kind, regex_node *left, regex_node *right)
+{
+	regex_node *node = palloc0(sizeof(regex_node));
+
+	node->kind = kind;
+	node->left = left;
+	node->right = right;
+	return node;
+}
+
+static regex_node *
+__regex_make_cat(regex_node *left, regex_node *right)
+{
+	if (!left)
+		return right;
+	if (!right)
+		return left;
+	return __regex_make_node(RNODE_CAT, left, right);
+}
+
+static regex_node *
+__regex_make_alt(regex_node *left, regex_node *right)
+{
+	if (!left)
+		left = __regex_make_node(RNODE_EMPTY, NULL, NULL);
+	if (!right)
+		right = __regex_make_node(RNODE_EMPTY, NULL, NULL);
+	return __regex_make_node(RNODE_ALT, left, right);
+}
+
+static regex_node *
+__regex_make_byte(int c)
+{
+	regex_node *node = __regex_make_node(RNODE_SET, NULL, NULL);
+
+	symset_add(&node->set, c);
+	return node;
+}
+
+static regex_node *
+__regex_make_range(int lo, int hi)
+{
+	regex_node *node = __regex_make_node(RNODE_SET, NULL, NULL);
+
+	for (int c=lo; c <= hi; c++)
+		symset_add(&node->set, c);
+	return node;
+}
+
+/*
+ * __regex_make_multibyte_any - any multi-byte character of UTF-8
+ */
+static regex_node *
+__regex_make_multibyte_any(void)
+{
+	regex_node *node;
+
+	node = __regex_make_cat(__regex_make_range(0xc2, 0xdf),
+							__regex_make_range(0x80, 0xbf));
+	node = __regex_make_alt(node,
+							__regex_make_cat(__regex_make_range(0xe0, 0xef),
+							__regex_make_cat(__regex_make_range(0x80, 0xbf),
+											 __regex_make_range(0x80, 0xbf))));
+	node = __regex_make_alt(node,
+							__regex_make_cat(__regex_make_range(0xf0, 0xf4),
+							__regex_make_cat(__regex_make_range(0x80, 0xbf),
+							__regex_make_cat(__regex_make_range(0x80, 0xbf),
+											 __regex_make_range(0x80, 0xbf)))));
+	return node;
+}
+
+/*
+ * __regex_make_charset
+ *
+ * It makes a node that matches one character in the (ASCII) set. If
+ * @negative, it matches any character that is not in the set, including
+ * the multi-byte characters.
+ */
+static regex_node *
+__regex_make_charset(regex_parser *rp, regex_symset *set, bool negative)
+{
+	regex_node *node = __regex_make_node(RNODE_SET, NULL, NULL);
+	int			nbytes = (rp->is_utf8 ? 128 : 256);
+
+	for (int c=0; c < nbytes; c++)
+	{
+		if (symset_test(set, c) != negative)
+			symset_add(&node->set, c);
+	}
+	if (negative && rp->is_utf8)
+		node = __regex_make_alt(node, __regex_make_multibyte_any());
+	return node;
+}
+
+static void
+__regex_add_icase(regex_parser *rp, regex_symset *set, int c)
+{
+	symset_add(set, c);
+	if (rp->icase)
+	{
+		if (c >= 'a' && c <= 'z')
+			symset_add(set, c - 'a' + 'A');
+		else if (c >= 'A' && c <= 'Z')
+			symset_add(set, c - 'A' + 'a');
+	}
+}
+
+/*
+ * __regex_add_class - add members of the character class on the "C" locale
+ */
+static bool
+__regex_add_class(regex_parser *rp, regex_symset *set, const char *name)
+{
+	int		(*checker)(int c);
+
+	if (!rp->ctype_is_c)
+	{
+		rp->errmsg = "character class is supported only on the \"C\" collation";
+		return false;
+	}
+	if (strcmp(name, "alpha") == 0)
+		checker = isalpha;
+	else if (strcmp(name, "digit") == 0)
+		checker = isdigit;
+	else if (strcmp(name, "alnum") == 0)
+		checker = isalnum;
+	else if (strcmp(name, "upper") == 0)
+		checker = isupper;
+	else if (strcmp(name, "lower") == 0)
+		checker = islower;
+	else if (strcmp(name, "space") == 0)
+		checker = isspace;
+	else if (strcmp(name, "punct") == 0)
+		checker = ispunct;
+	else if (strcmp(name, "xdigit") == 0)
+		checker = isxdigit;
+	else if (strcmp(name, "cntrl") == 0)
+		checker = iscntrl;
+	else if (strcmp(name, "print") == 0)
+		checker = isprint;
+	else if (strcmp(name, "graph") == 0)
+		checker = isgraph;
+	else if (strcmp(name, "blank") == 0)
+	{
+		symset_add(set, ' ');
+		symset_add(set, '\t');
+		return true;
+	}
+	else if (strcmp(name, "word") == 0)
+	{
+		symset_add(set, '_');
+		checker = isalnum;
+	}
+	else
+	{
+		rp->errmsg = "unknown character class";
+		return false;
+	}
+	/* only ASCII characters on the "C" locale */
+	for (int c=0; c < 128; c++)
+	{
+		if (checker(c))
+			__regex_add_icase(rp, set, c);
+	}
+	return true;
+}
+
+/*
+ * __regex_class_escape - \d \s \w and negative forms
+ */
+static const char *
+__regex_class_escape(int c, bool *p_negative)
+{
+	*p_negative = (c == 'D' || c == 'S' || c == 'W');
+	switch (c)
+	{
+		case 'd': case 'D':
+			return "digit";
+		case 's': case 'S':
+			return "space";
+		case 'w': case 'W':
+			return "word";
+		default:
+			break;
+	}
+	return NULL;
+}
+
+/*
+ * __regex_char_escape - simple character escapes, or -1
+ */
+static int
+__regex_char_escape(int c)
+{
+	switch (c)
+	{
+		case 'n':	return '\n';
+		case 't':	return '\t';
+		case 'r':	return '\r';
+		case 'f':	return '\f';
+		case 'v':	return '\v';
+		case 'a':	return '\a';
+		case 'e':	return 033;
+		default:
+			break;
+	}
+	/* escaped punctuation is literal */
+	if ((c & 0x80) == 0 && !isalnum(c))
+		return c;
+	return -1;
+}
+
+static regex_node *
+__regex_parse_bracket(regex_parser *rp)
+{
+	regex_symset set;
+	bool		negative = false;
+	bool		is_first = true;
+
+	memset(&set, 0, sizeof(regex_symset));
+	if (rp->pos < rp->end && *rp->pos == '^')
+	{
+		negative = true;
+		rp->pos++;
+	}
+	for (;;)
+	{
+		int		lo, hi;
+
+		if (rp->pos >= rp->end)
+		{
+			rp->errmsg = "brackets [] not balanced";
+			return NULL;
+		}
+		if (*rp->pos == ']' && !is_first)
+		{
+			rp->pos++;
+			break;
+		}
+		is_first = false;
+
+		if (rp->pos + 1 < rp->end &&
+			rp->pos[0] == '[' && rp->pos[1] == ':')
+		{
+			const char *tail = rp->pos + 2;
+			char		name[20];
+
+			while (tail + 1 < rp->end && !(tail[0] == ':' && tail[1] == ']'))
+				tail++;
+			if (tail + 1 >= rp->end || tail - (rp->pos + 2) >= sizeof(name))
+			{
+				rp->errmsg = "invalid character class";
+				return NULL;
+			}
+			memcpy(name, rp->pos + 2, tail - (rp->pos + 2));
+			name[tail - (rp->pos + 2)] = '\0';
+			if (!__regex_add_class(rp, &set, name))
+				return NULL;
+			rp->pos = tail + 2;
+			continue;
+		}
+		if (rp->pos + 1 < rp->end &&
+			rp->pos[0] == '[' && (rp->pos[1] == '.' || rp->pos[1] == '='))
+		{
+			rp->errmsg = "collating elements and equivalence classes are not supported";
+			return NULL;
+		}
+		if (*rp->pos == '\\')
+		{
+			const char *cname;
+			bool		__negative;
+
+			if (rp->pos + 1 >= rp->end)
+			{
+				rp->errmsg = "invalid escape \\ sequence";
+				return NULL;
+			}
+			cname = __regex_class_escape(rp->pos[1], &__negative);
+			if (cname)
+			{
+				if (__negative)
+				{
+					rp->errmsg = "negative class escape in brackets is not supported";
+					return NULL;
+				}
+				if (!__regex_add_class(rp, &set, cname))
+					return NULL;
+				rp->pos += 2;
+				continue;
+			}
+			lo = __regex_char_escape((unsigned char)rp->pos[1]);
+			if (lo < 0)
+			{
+				rp->errmsg = "unsupported escape in brackets";
+				return NULL;
+			}
+			rp->pos += 2;
+		}
+		else
+		{
+			lo = (unsigned char)*rp->pos++;
+		}
+		hi = lo;
+		if (rp->pos + 1 < rp->end &&
+			rp->pos[0] == '-' && rp->pos[1] != ']')
+		{
+			hi = (unsigned char)rp->pos[1];
+			if (hi == '\\' || hi == '[')
+			{
+				rp->errmsg = "unsupported range end-point";
+				return NULL;
+			}
+			rp->pos += 2;
+			if (lo > hi)
+			{
+				rp->errmsg = "invalid character range";
+				return NULL;
+			}
+		}
+		if (rp->is_utf8 && (lo >= 0x80 || hi >= 0x80))
+		{
+			rp->errmsg = "non-ASCII characters in brackets are not supported";
+			return NULL;
+		}
+		for (int c=lo; c <= hi; c++)
+			__regex_add_icase(rp, &set, c);
+	}
+	return __regex_make_charset(rp, &set, negative);
+}
+
+static regex_node *
+__regex_parse_atom(regex_parser *rp, int depth)
+{
+	regex_node *node;
+	int			c = (unsigned char)*rp->pos;
+
+	switch (c)
+	{
+		case '(':
+			rp->pos++;
+			if (rp->pos < rp->end && *rp->pos == '?')
+			{
+				if (rp->pos + 1 < rp->end && rp->pos[1] == ':')
+					rp->pos += 2;
+				else
+				{
+					rp->errmsg = "constraints and embedded options are not supported";
+					return NULL;
+				}
+			}
+			node = __regex_parse_alternative(rp, depth+1);
+			if (rp->errmsg)
+				return NULL;
+			if (rp->pos >= rp->end || *rp->pos != ')')
+			{
+				rp->errmsg = "parentheses () not balanced";
+				return NULL;
+			}
+			rp->pos++;
+			if (!node)
+				node = __regex_make_node(RNODE_EMPTY, NULL, NULL);
+			return node;
+
+		case '[':
+			rp->pos++;
+			return __regex_parse_bracket(rp);
+
+		case '.':
+			rp->pos++;
+			if (rp->is_utf8)
+				return __regex_make_alt(__regex_make_range(0x00, 0x7f),
+										__regex_make_multibyte_any());
+			return __regex_make_range(0x00, 0xff);
+
+		case '^':
+			rp->pos++;
+			return __regex_make_node(RNODE_BOL, NULL, NULL);
+
+		case '$':
+			rp->pos++;
+			return __regex_make_node(RNODE_EOL, NULL, NULL);
+
+		case '\\':
+			if (rp->pos + 1 >= rp->end)
+			{
+				rp->errmsg = "invalid escape \\ sequence";
+				return NULL;
+			}
+			c = (unsigned char)rp->pos[1];
+			rp->pos += 2;
+			if (c == 'A')
+				return __regex_make_node(RNODE_BOL, NULL, NULL);
+			if (c == 'Z')
+				return __regex_make_node(RNODE_EOL, NULL, NULL);
+			else
+			{
+				regex_symset set;
+				const char *cname;
+				bool		negative;
+
+				memset(&set, 0, sizeof(regex_symset));
+				cname = __regex_class_escape(c, &negative);
+				if (cname)
+				{
+					if (!__regex_add_class(rp, &set, cname))
+						return NULL;
+					return __regex_make_charset(rp, &set, negative);
+				}
+				c = __regex_char_escape(c);
+				if (c < 0)
+				{
+					rp->errmsg = "unsupported escape sequence";
+					return NULL;
+				}
+				__regex_add_icase(rp, &set, c);
+				return __regex_make_charset(rp, &set, false);
+			}
+
+		case '*':
+		case '+':
+		case '?':
+		case '{':
+			rp->errmsg = "quantifier operand invalid";
+			return NULL;
+
+		default:
+			if (rp->is_utf8 && (c & 0x80) != 0)
+			{
+				int		len = pg_utf_mblen((const unsigned char *)rp->pos);
+
+				if (rp->icase)
+				{
+					rp->errmsg = "non-ASCII characters are not supported on case-insensitive match";
+					return NULL;
+				}
+				if (rp->pos + len > rp->end)
+				{
+					rp->errmsg = "invalid multibyte character";
+					return NULL;
+				}
+				node = NULL;
+				for (int i=0; i < len; i++)
+					node = __regex_make_cat(node, __regex_make_byte((unsigned char)rp->pos[i]));
+				rp->pos += len;
+				return node;
+			}
+			else
+			{
+				regex_symset set;
+
+				memset(&set, 0, sizeof(regex_symset));
+				__regex_add_icase(rp, &set, c);
+				rp->pos++;
+				node = __regex_make_node(RNODE_SET, NULL, NULL);
+				node->set = set;
+				return node;
+			}
+	}
+}
+
+/*
+ * __regex_parse_bound - {m}, {m,} or {m,n}
+ */
+static bool
+__regex_parse_bound(regex_parser *rp, int *p_min, int *p_max)
+{
+	const char *pos = rp->pos + 1;
+	int			min = 0, max;
+
+	if (pos >= rp->end || !isdigit(*pos))
+	{
+		rp->errmsg = "invalid repetition count(s)";
+		return false;
+	}
+	while (pos < rp->end && isdigit(*pos))
+	{
+		min = 10 * min + (*pos++ - '0');
+		if (min > REGEX_MAX_REPEAT)
+			goto too_large;
+	}
+	max = min;
+	if (pos < rp->end && *pos == ',')
+	{
+		pos++;
+		if (pos < rp->end && isdigit(*pos))
+		{
+			max = 0;
+			while (pos < rp->end && isdigit(*pos))
+			{
+				max = 10 * max + (*pos++ - '0');
+				if (max > REGEX_MAX_REPEAT)
+					goto too_large;
+			}
+			if (min > max)
+			{
+				rp->errmsg = "invalid repetition count(s)";
+				return false;
+			}
+		}
+		else
+			max = -1;
+	}
+	if (pos >= rp->end || *pos != '}')
+	{
+		rp->errmsg = "invalid repetition count(s)";
+		return false;
+	}
+	rp->pos = pos + 1;
+	*p_min = min;
+	*p_max = max;
+	return true;
+
+too_large:
+	rp->errmsg = "too large repetition count(s)";
+	return false;
+}
+
+static regex_node *
+__regex_parse_branch(regex_parser *rp, int depth)
+{
+	regex_node *branch = NULL;
+
+	while (rp->pos < rp->end && *rp->pos != '|' && *rp->pos != ')')
+	{
+		regex_node *atom;
+		bool		is_anchor = (*rp->pos == '^' || *rp->pos == '$');
+
+		atom = __regex_parse_atom(rp, depth);
+		if (!atom)
+			return NULL;
+		while (rp->pos < rp->end &&
+			   (*rp->pos == '*' || *rp->pos == '+' ||
+				*rp->pos == '?' || *rp->pos == '{'))
+		{
+			regex_node *node;
+			int		min, max;
+
+			if (is_anchor)
+			{
+				rp->errmsg = "quantifier operand invalid";
+				return NULL;
+			}
+			switch (*rp->pos)
+			{
+				case '*':
+					min = 0;
+					max = -1;
+					rp->pos++;
+					break;
+				case '+':
+					min = 1;
+					max = -1;
+					rp->pos++;
+					break;
+				case '?':
+					min = 0;
+					max = 1;
+					rp->pos++;
+					break;
+				default:
+					if (!__regex_parse_bound(rp, &min, &max))
+						return NULL;
+					break;
+			}
+			/* non-greedy form */
+			if (rp->pos < rp->end && *rp->pos == '?')
+				rp->pos++;
+			node = __regex_make_node(RNODE_REPEAT, atom, NULL);
+			node->min = min;
+			node->max = max;
+			atom = node;
+		}
+		branch = __regex_make_cat(branch, atom);
+	}
+	if (!branch)
+		branch = __regex_make_node(RNODE_EMPTY, NULL, NULL);
+	return branch;
+}
+
+static regex_node *
+__regex_parse_alternative(regex_parser *rp, int depth)
+{
+	regex_node *node;
+
+	if (depth > 100)
+	{
+		rp->errmsg = "too deep nested parentheses";
+		return NULL;
+	}
+	node = __regex_parse_branch(rp, depth);
+	while (node && rp->pos < rp->end && *rp->pos == '|')
+	{
+		regex_node *branch;
+
+		rp->pos++;
+		branch = __regex_parse_branch(rp, depth);
+		if (!branch)
+			return NULL;
+		node = __regex_make_alt(node, branch);
+	}
+	return node;
+}
+
+/* ----------------------------------------------------------------
+ *
+ * NFA construction
+ *
+ * ---------------------------------------------------------------- */
+static int
+__nfa_new_state(regex_nfa *nfa, int type)
+{
+	regex_nfa_state *state;
+
+	if (nfa->nstates >= REGEX_MAX_NFA_STATES)
+	{
+		nfa->errmsg = "regular expression is too complex";
+		return -1;
+	}
+	if (nfa->nstates >= nfa->nrooms)
+	{
+		nfa->nrooms = 2 * nfa->nrooms + 100;
+		nfa->states = repalloc_huge(nfa->states, sizeof(regex_nfa_state) * nfa->nrooms);
+	}
+	state = &nfa->states[nfa->nstates];
+	state->type = type;
+	state->out1 = -1;
+	state->out2 = -1;
+	state->symset_id = -1;
+	return nfa->nstates++;
+}
+
+static int
+__nfa_new_symset(regex_nfa *nfa, const regex_symset *set)
+{
+	if (nfa->nsymsets >= nfa->nsymsets_rooms)
+	{
+		nfa->nsymsets_rooms = 2 * nfa->nsymsets_rooms + 100;
+		nfa->symsets = repalloc_huge(nfa->symsets, sizeof(regex_symset) * nfa->nsymsets_rooms);
+	}
+	nfa->symsets[nfa->nsymsets] = *set;
+	return nfa->nsymsets++;
+}
+
+/*
+ * __nfa_build_fragment - returns false on error
+ */
+static bool
+__nfa_build_fragment(regex_nfa *nfa, regex_node *node, regex_frag *frag)
+{
+	regex_frag	a, b;
+	int			s, e;
+
+	switch (node->kind)
+	{
+		case RNODE_EMPTY:
+			if ((e = __nfa_new_state(nfa, NFA_EPSILON)) < 0)
+				return false;
+			frag->start = frag->end = e;
+			return true;
+
+		case RNODE_BOL:
+		case RNODE_EOL:
+			if ((s = __nfa_new_state(nfa, (node->kind == RNODE_BOL
+											? NFA_ASSERT_BOL
+											: NFA_ASSERT_EOL))) < 0 ||
+				(e = __nfa_new_state(nfa, NFA_EPSILON)) < 0)
+				return false;
+			nfa->states[s].out1 = e;
+			frag->start = s;
+			frag->end = e;
+			return true;
+
+		case RNODE_SET:
+			if ((s = __nfa_new_state(nfa, NFA_SYMSET)) < 0 ||
+				(e = __nfa_new_state(nfa, NFA_EPSILON)) < 0)
+				return false;
+			nfa->states[s].symset_id = __nfa_new_symset(nfa, &node->set);
+			nfa->states[s].out1 = e;
+			frag->start = s;
+			frag->end = e;
+			return true;
+
+		case RNODE_CAT:
+			if (!__nfa_build_fragment(nfa, node->left, &a) ||
+				!__nfa_build_fragment(nfa, node->right, &b))
+				return false;
+			nfa->states[a.end].out1 = b.start;
+			frag->start = a.start;
+			frag->end = b.end;
+			return true;
+
+		case RNODE_ALT:
+			if (!__nfa_build_fragment(nfa, node->left, &a) ||
+				!__nfa_build_fragment(nfa, node->right, &b) ||
+				(s = __nfa_new_state(nfa, NFA_SPLIT)) < 0 ||
+				(e = __nfa_new_state(nfa, NFA_EPSILON)) < 0)
+				return false;
+			nfa->states[s].out1 = a.start;
+			nfa->states[s].out2 = b.start;
+			nfa->states[a.end].out1 = e;
+			nfa->states[b.end].out1 = e;
+			frag->start = s;
+			frag->end = e;
+			return true;
+
+		case RNODE_REPEAT:
+			if ((e = __nfa_new_state(nfa, NFA_EPSILON)) < 0)
+				return false;
+			frag->start = frag->end = e;
+			/* mandatory part */
+			for (int i=0; i < node->min; i++)
+			{
+				if (!__nfa_build_fragment(nfa, node->left, &a))
+					return false;
+				nfa->states[frag->end].out1 = a.start;
+				frag->end = a.end;
+			}
+			if (node->max < 0)
+			{
+				/* x* */
+				if (!__nfa_build_fragment(nfa, node->left, &a) ||
+					(s = __nfa_new_state(nfa, NFA_SPLIT)) < 0 ||
+					(e = __nfa_new_state(nfa, NFA_EPSILON)) < 0)
+					return false;
+				nfa->states[s].out1 = a.start;
+				nfa->states[s].out2 = e;
+				nfa->states[a.end].out1 = s;
+				nfa->states[frag->end].out1 = s;
+				frag->end = e;
+			}
+			else
+			{
+				/* x? for the optional part */
+				for (int i=node->min; i < node->max; i++)
+				{
+					if (!__nfa_build_fragment(nfa, node->left, &a) ||
+						(s = __nfa_new_state(nfa, NFA_SPLIT)) < 0 ||
+						(e = __nfa_new_state(nfa, NFA_EPSILON)) < 0)
+						return false;
+					nfa->states[s].out1 = a.start;
+					nfa->states[s].out2 = e;
+					nfa->states[a.end].out1 = e;
+					nfa->states[frag->end].out1 = s;
+					frag->end = e;
+				}
+			}
+			return true;
+
+		default:
+			elog(ERROR, "unknown regex node kind: %d", (int)node->kind);
+	}
+	return false;
+}
+
+/* ----------------------------------------------------------------
+ *
+ * DFA construction (subset construction)
+ *
+ * ---------------------------------------------------------------- */
+typedef struct
+{
+	int			nitems;
+	int		   *items;		/* sorted NFA state-ids */
+	uint32_t	hash;
+	bool		accept;
+} regex_dfa_state;
+
+static int
+__dfa_closure_comp(const void *__a, const void *__b)
+{
+	int		a = *((const int *)__a);
+	int		b = *((const int *)__b);
+
+	return (a < b ? -1 : (a > b ? 1 : 0));
+}
+
+/*
+ * __dfa_closure - epsilon closure of the NFA state set
+ *
+ * The result contains NFA_SYMSET states, and NFA_ASSERT_EOL states that are
+ * not satisfied yet.
+ */
+static void
+__dfa_closure(regex_nfa *nfa, int *stack, int nstack, uint8_t *visited,
+			  bool at_start, bool at_end, regex_dfa_state *dstate)
+{
+	int		nitems = 0;
+	int		i, j;
+
+	memset(visited, 0, nfa->nstates);
+	for (i=0, j=0; i < nstack; i++)
+	{
+		if (!visited[stack[i]])
+		{
+			visited[stack[i]] = 1;
+			stack[j++] = stack[i];
+		}
+	}
+	nstack = j;
+	dstate->accept = false;
+	while (nstack > 0)
+	{
+		int		id = stack[--nstack];
+		regex_nfa_state *state = &nfa->states[id];
+
+		switch (state->type)
+		{
+			case NFA_ASSERT_BOL:
+				if (!at_start)
+					break;
+				goto next;
+			case NFA_ASSERT_EOL:
+				if (!at_end)
+				{
+					dstate->items[nitems++] = id;
+					break;
+				}
+				goto next;
+			case NFA_SPLIT:
+				if (state->out2 >= 0 && !visited[state->out2])
+				{
+					visited[state->out2] = 1;
+					stack[nstack++] = state->out2;
+				}
+				/* fallthrough */
+			case NFA_EPSILON:
+			next:
+				if (state->out1 >= 0 && !visited[state->out1])
+				{
+					visited[state->out1] = 1;
+					stack[nstack++] = state->out1;
+				}
+				break;
+			case NFA_SYMSET:
+				dstate->items[nitems++] = id;
+				break;
+			case NFA_MATCH:
+				dstate->accept = true;
+				break;
+			default:
+				elog(ERROR, "unknown NFA state type: %d", state->type);
+		}
+	}
+	qsort(dstate->items, nitems, sizeof(int), __dfa_closure_comp);
+	dstate->nitems = nitems;
+	dstate->hash = DatumGetUInt32(hash_any((unsigned char *)dstate->items,
+										   sizeof(int) * nitems));
+}
+
+/*
+ * __dfa_accept_at_end - checks whether the state matches at end of the text
+ */
+static bool
+__dfa_accept_at_end(regex_nfa *nfa, int *stack, uint8_t *visited,
+					bool at_start, regex_dfa_state *dstate,
+					regex_dfa_state *temp)
+{
+	int		nstack = 0;
+
+	if (dstate->accept)
+		return true;
+	for (int i=0; i < dstate->nitems; i++)
+	{
+		int		id = dstate->items[i];
+
+		if (nfa->states[id].type == NFA_ASSERT_EOL)
+			stack[nstack++] = id;
+	}
+	if (nstack == 0)
+		return false;
+	__dfa_closure(nfa, stack, nstack, visited, at_start, true, temp);
+	return temp->accept;
+}
+
+/*
+ * pgstrom_regex_compile
+ *
+ * It compiles the regular expression pattern into kern_regex_dfa, or returns
+ * NULL with error message if not supported.
+ */
+bytea *
+pgstrom_regex_compile(const char *pattern, int patlen,
+					  bool icase, Oid collid,
+					  const char **p_errmsg)
+{
+	regex_parser rp;
+	regex_nfa	nfa;
+	regex_node *node;
+	regex_frag	frag;
+	regex_symset all;
+	int			loop, split, match;
+	int			classmap[256];
+	int			remap[2 * 256];
+	int			nclasses = 1;
+	int			class_symbol[256];
+	regex_dfa_state *dstates;
+	int			ndstates = 0;
+	int			ndstates_rooms = 64;
+	uint16_t   *trans = NULL;
+	uint8_t	   *visited;
+	int		   *stack;
+	regex_dfa_state next;
+	int			encoding = GetDatabaseEncoding();
+	kern_regex_dfa *dfa;
+	bytea	   *result;
+	size_t		sz;
+
+	*p_errmsg = NULL;
+	if (encoding != PG_UTF8 && pg_encoding_max_length(encoding) != 1)
+	{
+		*p_errmsg = "regular expression supports only UTF-8 or single-byte encodings";
+		return NULL;
+	}
+	memset(&rp, 0, sizeof(regex_parser));
+	rp.pos = pattern;
+	rp.end = pattern + patlen;
+	rp.icase = icase;
+	rp.ctype_is_c = (OidIsValid(collid) && lc_ctype_is_c(collid));
+	rp.is_utf8 = (encoding == PG_UTF8);
+	if (icase && !rp.ctype_is_c)
+	{
+		*p_errmsg = "case-insensitive match is supported only on the \"C\" collation";
+		return NULL;
+	}
+	if (patlen >= 3 && memcmp(pattern, "***", 3) == 0)
+	{
+		*p_errmsg = "director prefix of regular expression is not supported";
+		return NULL;
+	}
+	node = __regex_parse_alternative(&rp, 0);
+	if (!node || rp.errmsg || rp.pos < rp.end)
+	{
+		*p_errmsg = (rp.errmsg ? rp.errmsg : "parentheses () not balanced");
+		return NULL;
+	}
+
+	/*
+	 * Build NFA; the pattern is preceded by the loop of any bytes, because
+	 * regular expression operators search for the sub-string that matches
+	 * the pattern.
+	 */
+	memset(&nfa, 0, sizeof(regex_nfa));
+	nfa.nrooms = 256;
+	nfa.states = palloc(sizeof(regex_nfa_state) * nfa.nrooms);
+	nfa.nsymsets_rooms = 64;
+	nfa.symsets = palloc(sizeof(regex_symset) * nfa.nsymsets_rooms);
+
+	memset(&all, 0, sizeof(regex_symset));
+	for (int c=0; c < 256; c++)
+		symset_add(&all, c);
+	split = __nfa_new_state(&nfa, NFA_SPLIT);
+	loop = __nfa_new_state(&nfa, NFA_SYMSET);
+	nfa.states[loop].symset_id = __nfa_new_symset(&nfa, &all);
+	nfa.states[loop].out1 = split;
+	nfa.states[split].out1 = loop;
+	if (!__nfa_build_fragment(&nfa, node, &frag) ||
+		(match = __nfa_new_state(&nfa, NFA_MATCH)) < 0)
+	{
+		*p_errmsg = nfa.errmsg;
+		return NULL;
+	}
+	nfa.states[split].out2 = frag.start;
+	nfa.states[frag.end].out1 = match;
+
+	/*
+	 * Equivalence classes of the symbols; symbols that are contained by
+	 * the same symbol-sets are not distinguished.
+	 */
+	memset(classmap, 0, sizeof(classmap));
+	for (int k=0; k < nfa.nsymsets; k++)
+	{
+		regex_symset *set = &nfa.symsets[k];
+		int			__nclasses = 0;
+
+		memset(remap, -1, sizeof(int) * 2 * nclasses);
+		for (int c=0; c < 256; c++)
+		{
+			int		index = 2 * classmap[c] + (symset_test(set, c) ? 1 : 0);
+
+			if (remap[index] < 0)
+				remap[index] = __nclasses++;
+			classmap[c] = remap[index];
+		}
+		nclasses = __nclasses;
+	}
+	if (nclasses > 255)
+	{
+		*p_errmsg = "regular expression is too complex for DFA";
+		return NULL;
+	}
+	for (int c=255; c >= 0; c--)
+		class_symbol[classmap[c]] = c;
+
+	/*
+	 * Subset construction; dstates[0] is the dead state
+	 */
+	visited = palloc(nfa.nstates);
+	stack = palloc(sizeof(int) * (2 * nfa.nstates + 1));
+	dstates = palloc0(sizeof(regex_dfa_state) * ndstates_rooms);
+	ndstates++;
+	memset(&next, 0, sizeof(regex_dfa_state));
+	next.items = palloc(sizeof(int) * nfa.nstates);
+
+	dstates[ndstates].items = palloc(sizeof(int) * nfa.nstates);
+	stack[0] = split;
+	__dfa_closure(&nfa, stack, 1, visited, true, false, &dstates[ndstates]);
+	ndstates++;
+
+	trans = palloc0(sizeof(uint16_t) * nclasses * ndstates_rooms);
+	for (int i=1; i < ndstates; i++)
+	{
+		regex_dfa_state *curr;
+
+		if (dstates[i].accept)
+			continue;	/* sticky accepting state; no transitions */
+		for (int cls=0; cls < nclasses; cls++)
+		{
+			int			sym = class_symbol[cls];
+			int			nstack = 0;
+			int			j;
+
+			curr = &dstates[i];
+			for (j=0; j < curr->nitems; j++)
+			{
+				regex_nfa_state *state = &nfa.states[curr->items[j]];
+
+				if (state->type == NFA_SYMSET &&
+					symset_test(&nfa.symsets[state->symset_id], sym))
+					stack[nstack++] = state->out1;
+			}
+			if (nstack == 0)
+				continue;	/* dead state */
+			__dfa_closure(&nfa, stack, nstack, visited, false, false, &next);
+			/* initial state is not shared, because '^' is satisfied here */
+			for (j=2; j < ndstates; j++)
+			{
+				if (dstates[j].hash == next.hash &&
+					dstates[j].nitems == next.nitems &&
+					dstates[j].accept == next.accept &&
+					memcmp(dstates[j].items, next.items,
+						   sizeof(int) * next.nitems) == 0)
+					break;
+			}
+			if (j == ndstates)
+			{
+				if (ndstates >= REGEX_MAX_DFA_STATES ||
+					KERN_REGEX_DFA_LENGTH(ndstates+1, nclasses) > REGEX_MAX_DFA_LENGTH)
+				{
+					*p_errmsg = "regular expression is too complex for DFA";
+					return NULL;
+				}
+				if (ndstates >= ndstates_rooms)
+				{
+					dstates = repalloc(dstates, sizeof(regex_dfa_state) * 2 * ndstates_rooms);
+					trans = repalloc(trans, sizeof(uint16_t) * nclasses * 2 * ndstates_rooms);
+					memset(trans + nclasses * ndstates_rooms, 0,
+						   sizeof(uint16_t) * nclasses * ndstates_rooms);
+					ndstates_rooms *= 2;
+				}
+				dstates[ndstates] = next;
+				dstates[ndstates].items = palloc(sizeof(int) * Max(next.nitems, 1));
+				memcpy(dstates[ndstates].items, next.items,
+					   sizeof(int) * next.nitems);
+				ndstates++;
+			}
+			trans[i * nclasses + cls] = j;
+		}
+	}
+
+	/* Setup kern_regex_dfa */
+	sz = KERN_REGEX_DFA_LENGTH(ndstates, nclasses);
+	result = palloc0(VARHDRSZ + sz);
+	SET_VARSIZE(result, VARHDRSZ + sz);
+	dfa = (kern_regex_dfa *)VARDATA(result);
+	dfa->magic = KERN_REGEX_DFA_MAGIC;
+	dfa->nstates = ndstates;
+	dfa->nclasses = nclasses;
+	dfa->start = 1;
+	for (int c=0; c < 256; c++)
+		dfa->classmap[c] = classmap[c];
+	memcpy(dfa->trans, trans, sizeof(uint16_t) * nclasses * ndstates);
+	for (int i=1; i < ndstates; i++)
+	{
+		uint8_t		flags = 0;
+
+		if (dstates[i].accept)
+			flags |= (KERN_REGEX_ACCEPT__MATCH | KERN_REGEX_ACCEPT__AT_END);
+		else if (__dfa_accept_at_end(&nfa, stack, visited, (i == 1),
+									 &dstates[i], &next))
+			flags |= KERN_REGEX_ACCEPT__AT_END;
+		KERN_REGEX_DFA_ACCEPT(dfa)[i] = flags;
+	}
+	return result;
+}
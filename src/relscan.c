@@ -11,6 +11,11 @@
  */
 #include "pg_strom.h"
 
+/* static variables */
+static int		pgstrom_relscan_prefetch_chunks;	/* GUC */
+static int		pgstrom_parallel_claim_chunks;		/* GUC */
+bool			pgstrom_relscan_block_format;		/* GUC */
+
 /* ----------------------------------------------------------------
  *
  * Routines to support optimization / path or plan construction
@@ -457,6 +462,7 @@ __relScanDirectFallbackBlock(pgstromTaskState *pts,
 	int			lines;
 	OffsetNumber lineoff;
 	ItemId		lpp;
+	bool		all_visible;
 
 	buffer = ReadBufferExtended(relation,
 								MAIN_FORKNUM,
@@ -469,6 +475,8 @@ __relScanDirectFallbackBlock(pgstromTaskState *pts,
 	LockBuffer(buffer, BUFFER_LOCK_SHARE);
 	page = BufferGetPage(buffer);
 	lines = PageGetMaxOffsetNumber(page);
+	/* just like heapgetpage(), skip MVCC checks on all-visible pages */
+	all_visible = (PageIsAllVisible(page) && !snapshot->takenDuringRecovery);
 	for (lineoff = FirstOffsetNumber, lpp = PageGetItemId(page, lineoff);
 		 lineoff <= lines;
 		 lineoff++, lpp++)
@@ -484,7 +492,10 @@ __relScanDirectFallbackBlock(pgstromTaskState *pts,
 		htup.t_len = ItemIdGetLength(lpp);
 		ItemPointerSet(&htup.t_self, block_num, lineoff);
 
-		valid = HeapTupleSatisfiesVisibility(&htup, snapshot, buffer);
+		if (all_visible)
+			valid = true;
+		else
+			valid = HeapTupleSatisfiesVisibility(&htup, snapshot, buffer);
 		HeapCheckForSerializableConflictOut(valid, relation, &htup,
 											buffer, snapshot);
 		if (valid)
@@ -588,6 +599,20 @@ __relScanDirectCachedBlock(pgstromTaskState *pts, BlockNumber block_num)
 	kds->block_nloaded++;
 }
 
+/*
+ * __relScanDirectIsAvailable
+ *
+ * pgstromRelScanChunkDirect() is also used for the relations where neither
+ * GPU-Direct SQL nor DPU is available (pg_strom.relscan_block_format).
+ * In this case, all the pages are copied from the shared-buffer.
+ */
+static inline bool
+__relScanDirectIsAvailable(pgstromTaskState *pts)
+{
+	return (pts->ds_entry != NULL || (gpuDirectIsAvailable() &&
+									  !bms_is_empty(pts->optimal_gpus)));
+}
+
 static bool
 __relScanDirectCheckBufferClean(SMgrRelation smgr, BlockNumber block_num)
 {
@@ -617,6 +642,72 @@ __relScanDirectCheckBufferClean(SMgrRelation smgr, BlockNumber block_num)
 	return (bufState & BM_DIRTY) == 0;
 }
 
+/*
+ * __relScanDirectPrefetch
+ *
+ * It issues read-ahead hints for the blocks to be loaded by the next
+ * chunks, so the storage can fetch them concurrently with the xPU
+ * processing the current chunk.
+ * Once GPU-Direct SQL (or DPU) is available, all-visible pages are read
+ * by P2P DMA (or on the DPU side) that bypasses the page cache, so only
+ * the pages to be read via the shared-buffer are hinted.
+ */
+static void
+__relScanDirectPrefetch(pgstromTaskState *pts,
+						HeapScanDesc h_scan,
+						uint32_t kds_nrooms)
+{
+#ifdef USE_PREFETCH
+	Relation		relation = pts->css.ss.ss_currentRelation;
+	BlockNumber		head;
+	BlockNumber		tail;
+	bool			only_cached_blocks;
+	bool			hinted = false;
+
+	if (pgstrom_relscan_prefetch_chunks <= 0 ||
+		pts->curr_block_num >= pts->curr_block_tail)
+		return;
+	if (pts->br_state)
+	{
+		/*
+		 * Range is claimed by the BRIN-index, so we cannot know which
+		 * blocks shall be read by us next.
+		 */
+		head = pts->curr_block_num;
+		tail = pts->curr_block_tail;
+	}
+	else
+	{
+		head = Max(pts->curr_block_num, pts->prefetch_block_num);
+		tail = pts->curr_block_tail
+			+ (uint64_t)pgstrom_relscan_prefetch_chunks * kds_nrooms;
+		if (tail > h_scan->rs_nblocks)
+			tail = h_scan->rs_nblocks;
+		/* the following blocks belong to the concurrent workers */
+		if (h_scan->rs_base.rs_parallel)
+			tail = Max(pts->curr_block_tail, Min(tail, pts->claim_block_tail));
+	}
+	only_cached_blocks = __relScanDirectIsAvailable(pts);
+	while (head < tail)
+	{
+		BlockNumber		block_num
+			= (head++ + h_scan->rs_startblock) % h_scan->rs_nblocks;
+
+		if (only_cached_blocks &&
+			VM_ALL_VISIBLE(relation, block_num, &pts->curr_vm_buffer))
+			continue;
+		if (pts->zm_state && pgstromZoneMapSkipBlock(pts, block_num))
+			continue;
+		PrefetchBuffer(relation, MAIN_FORKNUM, block_num);
+		hinted = true;
+	}
+	pts->prefetch_block_num = tail;
+	if (hinted)
+		pg_atomic_fetch_or_u32(&pts->ps_state->exec_paths,
+							   XPU_EXEC_PATH__READ_AHEAD);
+#endif	/* USE_PREFETCH */
+}
+
 XpuCommand *
 pgstromRelScanChunkDirect(pgstromTaskState *pts,
 						  struct iovec *xcmd_iov, int *xcmd_iovcnt)
@@ -636,9 +727,11 @@ pgstromRelScanChunkDirect(pgstromTaskState *pts,
 	uint32_t		kds_src_pathname = 0;
 	uint32_t		kds_src_iovec = 0;
 	uint32_t		kds_nrooms;
+	uint64_t		zm_nskips = 0;
+	bool			direct_available = __relScanDirectIsAvailable(pts);
 
 	kds = __XCMD_GET_KDS_SRC(&pts->xcmd_buf);
-	kds_nrooms = (PGSTROM_CHUNK_SIZE -
+	kds_nrooms = (pgstromTaskStateChunkSize(pts) -
 				  KDS_HEAD_LENGTH(kds)) / (sizeof(BlockNumber) + BLCKSZ);
 	kds->nitems  = 0;
 	kds->__usage64 = 0;
@@ -661,6 +754,16 @@ pgstromRelScanChunkDirect(pgstromTaskState *pts,
 		{
 			BlockNumber		block_num
 				= (pts->curr_block_num + h_scan->rs_startblock) % h_scan->rs_nblocks;
+			/*
+			 * Skip the block-range, if zone-map tells us no tuples
+			 * can satisfy the scan qualifiers.
+			 */
+			if (pts->zm_state && pgstromZoneMapSkipBlock(pts, block_num))
+			{
+				zm_nskips++;
+				pts->curr_block_num++;
+				continue;
+			}
 			/*
 			 * MEMO: Usually, CPU is (much) more powerful than DPUs.
 			 * In case when the source cache is already on the shared-
@@ -700,7 +803,8 @@ pgstromRelScanChunkDirect(pgstromTaskState *pts,
 			 * HEAP_XMIN_* or HEAP_XMAX_* flags correctly, we can have MVCC
 			 * logic in the device code.
 			 */
-			if (VM_ALL_VISIBLE(relation, block_num, &pts->curr_vm_buffer) &&
+			if (direct_available &&
+				VM_ALL_VISIBLE(relation, block_num, &pts->curr_vm_buffer) &&
 				__relScanDirectCheckBufferClean(smgr, block_num))
 			{
 				/*
@@ -760,6 +864,8 @@ pgstromRelScanChunkDirect(pgstromTaskState *pts,
 		{
 			if (!pgstromBrinIndexNextChunk(pts))
 				pts->scan_done = true;
+			else
+				__relScanDirectPrefetch(pts, h_scan, kds_nrooms);
 		}
 		else if (!h_scan->rs_base.rs_parallel)
 		{
@@ -770,6 +876,7 @@ pgstromRelScanChunkDirect(pgstromTaskState *pts,
 			{
 				h_scan->rs_cblock = 0;
 				h_scan->rs_inited = true;
+				pts->prefetch_block_num = 0;
 			}
 			pts->curr_block_num = h_scan->rs_cblock;
 			if (pts->curr_block_num >= h_scan->rs_nblocks)
@@ -778,6 +885,8 @@ pgstromRelScanChunkDirect(pgstromTaskState *pts,
 				num_blocks = h_scan->rs_nblocks - pts->curr_block_num;
 			h_scan->rs_cblock += num_blocks;
 			pts->curr_block_tail = pts->curr_block_num + num_blocks;
+			if (!pts->scan_done)
+				__relScanDirectPrefetch(pts, h_scan, kds_nrooms);
 		}
 		else
 		{
@@ -810,23 +919,71 @@ pgstromRelScanChunkDirect(pgstromTaskState *pts,
 				h_scan->rs_startblock = pb_scan->phs_startblock;
 				SpinLockRelease(&pb_scan->phs_mutex);
 				h_scan->rs_inited = true;
+				pts->claim_block_num = 0;
+				pts->claim_block_tail = 0;
+				pts->prefetch_block_num = 0;
+			}
+
+			/*
+			 * Each worker reserves a contiguous range of multiple chunks
+			 * at once, to keep the sequential reads on the storage and to
+			 * reduce the atomic operations on the shared scan cursor.
+			 * Once the remaining blocks get small, it is reduced to one
+			 * chunk, so that the workers finish the scan almost together.
+			 */
+			if (pts->claim_block_num >= pts->claim_block_tail)
+			{
+				uint64_t	nallocated;
+				uint64_t	nclaims = num_blocks;
+
+				nallocated = pg_atomic_read_u64(&pb_scan->phs_nallocated);
+				if (pgstrom_parallel_claim_chunks > 1 &&
+					nallocated < h_scan->rs_nblocks &&
+					(h_scan->rs_nblocks - nallocated) >
+					(uint64_t)kds_nrooms * pgstrom_parallel_claim_chunks * 4)
+				{
+					nclaims = (uint64_t)kds_nrooms * pgstrom_parallel_claim_chunks;
+					pg_atomic_fetch_or_u32(&ps_state->exec_paths,
+										   XPU_EXEC_PATH__MULTI_CHUNK_CLAIM);
+				}
+
+				nallocated = pg_atomic_fetch_add_u64(&pb_scan->phs_nallocated,
+													 nclaims);
+				if (nallocated >= h_scan->rs_nblocks)
+				{
+					pts->claim_block_num = h_scan->rs_nblocks;
+					pts->claim_block_tail = h_scan->rs_nblocks;
+				}
+				else
+				{
+					pts->claim_block_num = nallocated;
+					pts->claim_block_tail = Min(nallocated + nclaims,
+												h_scan->rs_nblocks);
+				}
 			}
-			pts->curr_block_num = pg_atomic_fetch_add_u64(&pb_scan->phs_nallocated,
-														  num_blocks);
+			pts->curr_block_num = pts->claim_block_num;
 			if (pts->curr_block_num >= h_scan->rs_nblocks)
 				pts->scan_done = true;
-			else if (pts->curr_block_num + num_blocks > h_scan->rs_nblocks)
-				num_blocks = h_scan->rs_nblocks - pts->curr_block_num;
+			else if (pts->curr_block_num + num_blocks > pts->claim_block_tail)
+				num_blocks = pts->claim_block_tail - pts->curr_block_num;
+			pts->claim_block_num += num_blocks;
 			pts->curr_block_tail = pts->curr_block_num + num_blocks;
+			if (!pts->scan_done)
+				__relScanDirectPrefetch(pts, h_scan, kds_nrooms);
 		}
 	}
 out:
 	Assert(kds->nitems == kds->block_nloaded + strom_nblocks);
 	pg_atomic_fetch_add_u64(&ps_state->npages_buffer_read,
 							kds->block_nloaded * PAGES_PER_BLOCK);
+	if (zm_nskips > 0)
+		pg_atomic_fetch_add_u64(&ps_state->zonemap_skipped_blocks, zm_nskips);
 	kds->length = kds->block_offset + BLCKSZ * kds->nitems;
 	if (kds->nitems == 0)
 		return NULL;
+	if (!direct_available)
+		pg_atomic_fetch_or_u32(&ps_state->exec_paths,
+							   XPU_EXEC_PATH__BLOCK_FORMAT);
 	if (strom_nblocks > 0)
 	{
 		memcpy(&KDS_BLOCK_BLCKNR(kds, kds->block_nloaded),
@@ -835,6 +992,7 @@ out:
 	}
 	Assert(kds->nitems == kds->block_nloaded + strom_nblocks);
 
+	pts->chunk_optimal_gpus = GetOptimalGpuForSegment(pts, segment_id);
 	if (strom_iovec->nr_chunks > 0)
 	{
 		size_t		sz;
@@ -906,14 +1064,15 @@ pgstromRelScanChunkNormal(pgstromTaskState *pts,
 	TupleTableSlot *slot = pts->base_slot;
 	kern_data_store *kds;
 	XpuCommand	   *xcmd;
+	size_t			chunk_sz = pgstromTaskStateChunkSize(pts);
 	size_t			sz1, sz2;
 
-	pts->xcmd_buf.len = __XCMD_KDS_SRC_OFFSET(&pts->xcmd_buf) + PGSTROM_CHUNK_SIZE;
+	pts->xcmd_buf.len = __XCMD_KDS_SRC_OFFSET(&pts->xcmd_buf) + chunk_sz;
 	enlargeStringInfo(&pts->xcmd_buf, 0);
 	kds = __XCMD_GET_KDS_SRC(&pts->xcmd_buf);
 	kds->nitems = 0;
 	kds->__usage64 = 0;
-	kds->length = PGSTROM_CHUNK_SIZE;
+	kds->length = chunk_sz;
 
 	if (pts->br_state)
 	{
@@ -981,8 +1140,97 @@ pgstromRelScanChunkNormal(pgstromTaskState *pts,
 	return xcmd;
 }
 
+/*
+ * pgstromRelScanChunkPrefilter
+ *
+ * It loads the tuples already filtered by the DPU pre-filtering sub-plan
+ * into a KDS_FORMAT_ROW chunk.
+ */
+XpuCommand *
+pgstromRelScanChunkPrefilter(pgstromTaskState *pts,
+							 struct iovec *xcmd_iov, int *xcmd_iovcnt)
+{
+	PlanState	   *subplan = outerPlanState(pts);
+	TupleTableSlot *slot = pts->base_slot;
+	kern_data_store *kds;
+	XpuCommand	   *xcmd;
+	size_t			sz1, sz2;
+
+	pts->xcmd_buf.len = __XCMD_KDS_SRC_OFFSET(&pts->xcmd_buf) + PGSTROM_CHUNK_SIZE;
+	enlargeStringInfo(&pts->xcmd_buf, 0);
+	kds = __XCMD_GET_KDS_SRC(&pts->xcmd_buf);
+	kds->nitems = 0;
+	kds->__usage64 = 0;
+	kds->length = PGSTROM_CHUNK_SIZE;
+
+	while (!pts->scan_done)
+	{
+		TupleTableSlot *sub_slot;
+
+		if (!TTS_EMPTY(slot) &&
+			!__kds_row_insert_tuple(kds, slot))
+			break;
+		sub_slot = ExecProcNode(subplan);
+		if (TupIsNull(sub_slot))
+		{
+			pts->scan_done = true;
+			break;
+		}
+		ExecCopySlot(slot, sub_slot);
+		if (!__kds_row_insert_tuple(kds, slot))
+			break;
+	}
+
+	if (kds->nitems == 0)
+		return NULL;
+
+	/* setup iovec that may skip the hole between row-index and tuples-buffer */
+	sz1 = ((KDS_BODY_ADDR(kds) - pts->xcmd_buf.data) +
+		   MAXALIGN(sizeof(uint64_t) * kds->nitems));
+	sz2 = kds->__usage64;
+	Assert(sz1 + sz2 <= pts->xcmd_buf.len);
+	kds->length = (KDS_HEAD_LENGTH(kds) +
+				   MAXALIGN(sizeof(uint64_t) * kds->nitems) + sz2);
+	xcmd = (XpuCommand *)pts->xcmd_buf.data;
+	xcmd->length = sz1 + sz2;
+	xcmd_iov[0].iov_base = xcmd;
+	xcmd_iov[0].iov_len  = sz1;
+	xcmd_iov[1].iov_base = (pts->xcmd_buf.data + pts->xcmd_buf.len - sz2);
+	xcmd_iov[1].iov_len  = sz2;
+	*xcmd_iovcnt = 2;
+
+	return xcmd;
+}
+
 void
 pgstrom_init_relscan(void)
 {
-	/* nothing to do */
+	DefineCustomIntVariable("pg_strom.relscan_prefetch_chunks",
+							"Number of chunks to be prefetched ahead of the direct relation scan",
+							NULL,
+							&pgstrom_relscan_prefetch_chunks,
+							2,
+							0,
+							64,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE,
+							NULL, NULL, NULL);
+	DefineCustomIntVariable("pg_strom.parallel_claim_chunks",
+							"Number of chunks to be reserved at once by the parallel workers of the direct relation scan",
+							NULL,
+							&pgstrom_parallel_claim_chunks,
+							4,
+							1,
+							256,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE,
+							NULL, NULL, NULL);
+	DefineCustomBoolVariable("pg_strom.relscan_block_format",
+							 "Loads heap pages into KDS_FORMAT_BLOCK chunks, even if direct read is not available",
+							 NULL,
+							 &pgstrom_relscan_block_format,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
 }
@@ -0,0 +1,810 @@
+---
+--- PG-Strom v5.1 -> v5.2
+---
+
+-- System view for GPU memory pool statistics
+CREATE TYPE pgstrom.__gpu_mempool_info AS (
+  gpu_id          int,
+  pool            text,
+  num_segments    int,
+  total_sz        bigint,
+  active_sz       bigint,
+  free_sz         bigint,
+  largest_free    bigint,
+  num_free_chunks int,
+  hard_limit      bigint,
+  keep_limit      bigint,
+  nr_alloc        bigint,
+  nr_free         bigint,
+  alloc_rate      float8,
+  free_rate       float8,
+  maint_time      float8
+);
+CREATE FUNCTION pgstrom.gpu_mempool_info()
+  RETURNS SETOF pgstrom.__gpu_mempool_info
+  AS 'MODULE_PATHNAME','pgstrom_gpu_mempool_info'
+  LANGUAGE C STRICT;
+CREATE VIEW pgstrom.gpu_mempool_info AS
+  SELECT * FROM pgstrom.gpu_mempool_info();
+
+-- Zone-map (min/max synopsis per block-range)
+CREATE FUNCTION pgstrom.zonemap_sync_trigger()
+  RETURNS trigger
+  AS 'MODULE_PATHNAME','pgstrom_zonemap_sync_trigger'
+  LANGUAGE C STRICT;
+
+CREATE FUNCTION pgstrom.zonemap_build(regclass)
+  RETURNS bigint
+  AS 'MODULE_PATHNAME','pgstrom_zonemap_build'
+  LANGUAGE C STRICT;
+
+CREATE FUNCTION pgstrom.zonemap_drop(regclass)
+  RETURNS bool
+  AS 'MODULE_PATHNAME','pgstrom_zonemap_drop'
+  LANGUAGE C STRICT;
+
+-- GpuCache snapshot for fast restart
+CREATE FUNCTION pgstrom.gpucache_checkpoint(regclass)
+  RETURNS void
+  AS 'MODULE_PATHNAME','pgstrom_gpucache_checkpoint'
+  LANGUAGE C STRICT;
+
+-- GpuCache latency and staleness statistics
+DROP VIEW IF EXISTS pgstrom.gpucache_info;
+DROP FUNCTION IF EXISTS pgstrom.__pgstrom_gpucache_info();
+DROP TYPE IF EXISTS pgstrom.__pgstrom_gpucache_info_t;
+CREATE TYPE pgstrom.__pgstrom_gpucache_info_t AS (
+    database_oid        oid,
+    database_name       text,
+    table_oid           oid,
+    table_name          text,
+    signature           int8,
+    phase               text,
+    rowid_num_used      int8,
+    rowid_num_free      int8,
+    gpu_main_sz         int8,
+    gpu_main_nitems     int8,
+    gpu_extra_sz        int8,
+    gpu_extra_usage     int8,
+    gpu_extra_dead      int8,
+    redo_write_ts       timestamptz,
+    redo_write_nitems   int8,
+    redo_write_pos      int8,
+    redo_read_nitems    int8,
+    redo_read_pos       int8,
+    redo_sync_pos       int8,
+    config_options      text,
+    stat_apply_redo_us  int8[],
+    stat_compaction_us  int8[],
+    stat_redo_queue_sz  int8[],
+    stat_visibility_us  int8[]
+);
+CREATE FUNCTION pgstrom.__pgstrom_gpucache_info()
+  RETURNS SETOF pgstrom.__pgstrom_gpucache_info_t
+  AS 'MODULE_PATHNAME','pgstrom_gpucache_info'
+  LANGUAGE C STRICT;
+CREATE VIEW pgstrom.gpucache_info AS
+  SELECT * FROM pgstrom.__pgstrom_gpucache_info();
+
+---
+--- HyperLogLog (hll_count / hll_sketch)
+---
+CREATE FUNCTION pgstrom.hll_hash(int1)
+  RETURNS bigint
+  AS 'MODULE_PATHNAME','pgstrom_hll_hash_int1'
+  LANGUAGE C STRICT PARALLEL SAFE;
+CREATE FUNCTION pgstrom.hll_sketch_update(bytea, int1)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_hll_sketch_update_int1'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+CREATE FUNCTION pgstrom.phll_sketch(int1)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_partial_hll_sketch_int1'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.hll_hash(int2)
+  RETURNS bigint
+  AS 'MODULE_PATHNAME','pgstrom_hll_hash_int2'
+  LANGUAGE C STRICT PARALLEL SAFE;
+CREATE FUNCTION pgstrom.hll_sketch_update(bytea, int2)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_hll_sketch_update_int2'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+CREATE FUNCTION pgstrom.phll_sketch(int2)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_partial_hll_sketch_int2'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.hll_hash(int4)
+  RETURNS bigint
+  AS 'MODULE_PATHNAME','pgstrom_hll_hash_int4'
+  LANGUAGE C STRICT PARALLEL SAFE;
+CREATE FUNCTION pgstrom.hll_sketch_update(bytea, int4)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_hll_sketch_update_int4'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+CREATE FUNCTION pgstrom.phll_sketch(int4)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_partial_hll_sketch_int4'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.hll_hash(int8)
+  RETURNS bigint
+  AS 'MODULE_PATHNAME','pgstrom_hll_hash_int8'
+  LANGUAGE C STRICT PARALLEL SAFE;
+CREATE FUNCTION pgstrom.hll_sketch_update(bytea, int8)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_hll_sketch_update_int8'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+CREATE FUNCTION pgstrom.phll_sketch(int8)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_partial_hll_sketch_int8'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.hll_hash(numeric)
+  RETURNS bigint
+  AS 'MODULE_PATHNAME','pgstrom_hll_hash_numeric'
+  LANGUAGE C STRICT PARALLEL SAFE;
+CREATE FUNCTION pgstrom.hll_sketch_update(bytea, numeric)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_hll_sketch_update_numeric'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+CREATE FUNCTION pgstrom.phll_sketch(numeric)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_partial_hll_sketch_numeric'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.hll_hash(date)
+  RETURNS bigint
+  AS 'MODULE_PATHNAME','pgstrom_hll_hash_date'
+  LANGUAGE C STRICT PARALLEL SAFE;
+CREATE FUNCTION pgstrom.hll_sketch_update(bytea, date)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_hll_sketch_update_date'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+CREATE FUNCTION pgstrom.phll_sketch(date)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_partial_hll_sketch_date'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.hll_hash(time)
+  RETURNS bigint
+  AS 'MODULE_PATHNAME','pgstrom_hll_hash_time'
+  LANGUAGE C STRICT PARALLEL SAFE;
+CREATE FUNCTION pgstrom.hll_sketch_update(bytea, time)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_hll_sketch_update_time'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+CREATE FUNCTION pgstrom.phll_sketch(time)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_partial_hll_sketch_time'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.hll_hash(timestamp)
+  RETURNS bigint
+  AS 'MODULE_PATHNAME','pgstrom_hll_hash_timestamp'
+  LANGUAGE C STRICT PARALLEL SAFE;
+CREATE FUNCTION pgstrom.hll_sketch_update(bytea, timestamp)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_hll_sketch_update_timestamp'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+CREATE FUNCTION pgstrom.phll_sketch(timestamp)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_partial_hll_sketch_timestamp'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.hll_hash(timestamptz)
+  RETURNS bigint
+  AS 'MODULE_PATHNAME','pgstrom_hll_hash_timestamptz'
+  LANGUAGE C STRICT PARALLEL SAFE;
+CREATE FUNCTION pgstrom.hll_sketch_update(bytea, timestamptz)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_hll_sketch_update_timestamptz'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+CREATE FUNCTION pgstrom.phll_sketch(timestamptz)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_partial_hll_sketch_timestamptz'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.hll_hash(bpchar)
+  RETURNS bigint
+  AS 'MODULE_PATHNAME','pgstrom_hll_hash_bpchar'
+  LANGUAGE C STRICT PARALLEL SAFE;
+CREATE FUNCTION pgstrom.hll_sketch_update(bytea, bpchar)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_hll_sketch_update_bpchar'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+CREATE FUNCTION pgstrom.phll_sketch(bpchar)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_partial_hll_sketch_bpchar'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.hll_hash(text)
+  RETURNS bigint
+  AS 'MODULE_PATHNAME','pgstrom_hll_hash_varlena'
+  LANGUAGE C STRICT PARALLEL SAFE;
+CREATE FUNCTION pgstrom.hll_sketch_update(bytea, text)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_hll_sketch_update_varlena'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+CREATE FUNCTION pgstrom.phll_sketch(text)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_partial_hll_sketch_varlena'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.hll_hash(bytea)
+  RETURNS bigint
+  AS 'MODULE_PATHNAME','pgstrom_hll_hash_varlena'
+  LANGUAGE C STRICT PARALLEL SAFE;
+CREATE FUNCTION pgstrom.hll_sketch_update(bytea, bytea)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_hll_sketch_update_varlena'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+CREATE FUNCTION pgstrom.phll_sketch(bytea)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_partial_hll_sketch_varlena'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.hll_hash(uuid)
+  RETURNS bigint
+  AS 'MODULE_PATHNAME','pgstrom_hll_hash_uuid'
+  LANGUAGE C STRICT PARALLEL SAFE;
+CREATE FUNCTION pgstrom.hll_sketch_update(bytea, uuid)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_hll_sketch_update_uuid'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+CREATE FUNCTION pgstrom.phll_sketch(uuid)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_partial_hll_sketch_uuid'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.hll_sketch_merge(bytea, bytea)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_hll_sketch_merge'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.hll_count_final(bytea)
+  RETURNS bigint
+  AS 'MODULE_PATHNAME','pgstrom_hll_count_final'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+
+CREATE FUNCTION pg_catalog.hll_sketch_histogram(bytea)
+  RETURNS int4[]
+  AS 'MODULE_PATHNAME','pgstrom_hll_sketch_histogram'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE pg_catalog.hll_merge(bytea)
+(
+  sfunc = pgstrom.hll_sketch_merge,
+  stype = bytea,
+  finalfunc = pgstrom.hll_count_final,
+  combinefunc = pgstrom.hll_sketch_merge,
+  parallel = safe
+);
+
+CREATE AGGREGATE pg_catalog.hll_combine(bytea)
+(
+  sfunc = pgstrom.hll_sketch_merge,
+  stype = bytea,
+  combinefunc = pgstrom.hll_sketch_merge,
+  parallel = safe
+);
+
+CREATE AGGREGATE pg_catalog.hll_count(int1)
+(
+  sfunc = pgstrom.hll_sketch_update,
+  stype = bytea,
+  finalfunc = pgstrom.hll_count_final,
+  combinefunc = pgstrom.hll_sketch_merge,
+  parallel = safe
+);
+
+CREATE AGGREGATE pg_catalog.hll_sketch(int1)
+(
+  sfunc = pgstrom.hll_sketch_update,
+  stype = bytea,
+  combinefunc = pgstrom.hll_sketch_merge,
+  parallel = safe
+);
+
+CREATE AGGREGATE pg_catalog.hll_count(int2)
+(
+  sfunc = pgstrom.hll_sketch_update,
+  stype = bytea,
+  finalfunc = pgstrom.hll_count_final,
+  combinefunc = pgstrom.hll_sketch_merge,
+  parallel = safe
+);
+
+CREATE AGGREGATE pg_catalog.hll_sketch(int2)
+(
+  sfunc = pgstrom.hll_sketch_update,
+  stype = bytea,
+  combinefunc = pgstrom.hll_sketch_merge,
+  parallel = safe
+);
+
+CREATE AGGREGATE pg_catalog.hll_count(int4)
+(
+  sfunc = pgstrom.hll_sketch_update,
+  stype = bytea,
+  finalfunc = pgstrom.hll_count_final,
+  combinefunc = pgstrom.hll_sketch_merge,
+  parallel = safe
+);
+
+CREATE AGGREGATE pg_catalog.hll_sketch(int4)
+(
+  sfunc = pgstrom.hll_sketch_update,
+  stype = bytea,
+  combinefunc = pgstrom.hll_sketch_merge,
+  parallel = safe
+);
+
+CREATE AGGREGATE pg_catalog.hll_count(int8)
+(
+  sfunc = pgstrom.hll_sketch_update,
+  stype = bytea,
+  finalfunc = pgstrom.hll_count_final,
+  combinefunc = pgstrom.hll_sketch_merge,
+  parallel = safe
+);
+
+CREATE AGGREGATE pg_catalog.hll_sketch(int8)
+(
+  sfunc = pgstrom.hll_sketch_update,
+  stype = bytea,
+  combinefunc = pgstrom.hll_sketch_merge,
+  parallel = safe
+);
+
+CREATE AGGREGATE pg_catalog.hll_count(numeric)
+(
+  sfunc = pgstrom.hll_sketch_update,
+  stype = bytea,
+  finalfunc = pgstrom.hll_count_final,
+  combinefunc = pgstrom.hll_sketch_merge,
+  parallel = safe
+);
+
+CREATE AGGREGATE pg_catalog.hll_sketch(numeric)
+(
+  sfunc = pgstrom.hll_sketch_update,
+  stype = bytea,
+  combinefunc = pgstrom.hll_sketch_merge,
+  parallel = safe
+);
+
+CREATE AGGREGATE pg_catalog.hll_count(date)
+(
+  sfunc = pgstrom.hll_sketch_update,
+  stype = bytea,
+  finalfunc = pgstrom.hll_count_final,
+  combinefunc = pgstrom.hll_sketch_merge,
+  parallel = safe
+);
+
+CREATE AGGREGATE pg_catalog.hll_sketch(date)
+(
+  sfunc = pgstrom.hll_sketch_update,
+  stype = bytea,
+  combinefunc = pgstrom.hll_sketch_merge,
+  parallel = safe
+);
+
+CREATE AGGREGATE pg_catalog.hll_count(time)
+(
+  sfunc = pgstrom.hll_sketch_update,
+  stype = bytea,
+  finalfunc = pgstrom.hll_count_final,
+  combinefunc = pgstrom.hll_sketch_merge,
+  parallel = safe
+);
+
+CREATE AGGREGATE pg_catalog.hll_sketch(time)
+(
+  sfunc = pgstrom.hll_sketch_update,
+  stype = bytea,
+  combinefunc = pgstrom.hll_sketch_merge,
+  parallel = safe
+);
+
+CREATE AGGREGATE pg_catalog.hll_count(timestamp)
+(
+  sfunc = pgstrom.hll_sketch_update,
+  stype = bytea,
+  finalfunc = pgstrom.hll_count_final,
+  combinefunc = pgstrom.hll_sketch_merge,
+  parallel = safe
+);
+
+CREATE AGGREGATE pg_catalog.hll_sketch(timestamp)
+(
+  sfunc = pgstrom.hll_sketch_update,
+  stype = bytea,
+  combinefunc = pgstrom.hll_sketch_merge,
+  parallel = safe
+);
+
+CREATE AGGREGATE pg_catalog.hll_count(timestamptz)
+(
+  sfunc = pgstrom.hll_sketch_update,
+  stype = bytea,
+  finalfunc = pgstrom.hll_count_final,
+  combinefunc = pgstrom.hll_sketch_merge,
+  parallel = safe
+);
+
+CREATE AGGREGATE pg_catalog.hll_sketch(timestamptz)
+(
+  sfunc = pgstrom.hll_sketch_update,
+  stype = bytea,
+  combinefunc = pgstrom.hll_sketch_merge,
+  parallel = safe
+);
+
+CREATE AGGREGATE pg_catalog.hll_count(bpchar)
+(
+  sfunc = pgstrom.hll_sketch_update,
+  stype = bytea,
+  finalfunc = pgstrom.hll_count_final,
+  combinefunc = pgstrom.hll_sketch_merge,
+  parallel = safe
+);
+
+CREATE AGGREGATE pg_catalog.hll_sketch(bpchar)
+(
+  sfunc = pgstrom.hll_sketch_update,
+  stype = bytea,
+  combinefunc = pgstrom.hll_sketch_merge,
+  parallel = safe
+);
+
+CREATE AGGREGATE pg_catalog.hll_count(text)
+(
+  sfunc = pgstrom.hll_sketch_update,
+  stype = bytea,
+  finalfunc = pgstrom.hll_count_final,
+  combinefunc = pgstrom.hll_sketch_merge,
+  parallel = safe
+);
+
+CREATE AGGREGATE pg_catalog.hll_sketch(text)
+(
+  sfunc = pgstrom.hll_sketch_update,
+  stype = bytea,
+  combinefunc = pgstrom.hll_sketch_merge,
+  parallel = safe
+);
+
+CREATE AGGREGATE pg_catalog.hll_count(bytea)
+(
+  sfunc = pgstrom.hll_sketch_update,
+  stype = bytea,
+  finalfunc = pgstrom.hll_count_final,
+  combinefunc = pgstrom.hll_sketch_merge,
+  parallel = safe
+);
+
+CREATE AGGREGATE pg_catalog.hll_sketch(bytea)
+(
+  sfunc = pgstrom.hll_sketch_update,
+  stype = bytea,
+  combinefunc = pgstrom.hll_sketch_merge,
+  parallel = safe
+);
+
+CREATE AGGREGATE pg_catalog.hll_count(uuid)
+(
+  sfunc = pgstrom.hll_sketch_update,
+  stype = bytea,
+  finalfunc = pgstrom.hll_count_final,
+  combinefunc = pgstrom.hll_sketch_merge,
+  parallel = safe
+);
+
+CREATE AGGREGATE pg_catalog.hll_sketch(uuid)
+(
+  sfunc = pgstrom.hll_sketch_update,
+  stype = bytea,
+  combinefunc = pgstrom.hll_sketch_merge,
+  parallel = safe
+);
+
+---
+--- Exact SUM(numeric) / AVG(numeric)
+---
+CREATE FUNCTION pgstrom.psum(numeric)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_partial_sum_numeric'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.pavg(numeric)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_partial_sum_numeric'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.fsum_trans_numeric(bytea, bytea)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_fsum_trans_numeric'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.fsum_final_numeric(bytea)
+  RETURNS numeric
+  AS 'MODULE_PATHNAME','pgstrom_fsum_final_numeric'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.favg_final_numeric(bytea)
+  RETURNS numeric
+  AS 'MODULE_PATHNAME','pgstrom_favg_final_numeric'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE pgstrom.sum_numeric(bytea)
+(
+  sfunc = pgstrom.fsum_trans_numeric,
+  stype = bytea,
+  finalfunc = pgstrom.fsum_final_numeric,
+  parallel = safe
+);
+
+CREATE AGGREGATE pgstrom.avg_numeric(bytea)
+(
+  sfunc = pgstrom.fsum_trans_numeric,
+  stype = bytea,
+  finalfunc = pgstrom.favg_final_numeric,
+  parallel = safe
+);
+
+---
+--- Approximate quantiles by log-bucket sketch
+---
+CREATE FUNCTION pgstrom.pquantile_sketch(float8)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_partial_quantile_sketch'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.quantile_sketch_update(bytea, float8)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_quantile_sketch_update'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.quantile_sketch_merge(bytea, bytea)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_quantile_sketch_merge'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+
+CREATE FUNCTION pg_catalog.quantile_estimate(bytea, float8)
+  RETURNS float8
+  AS 'MODULE_PATHNAME','pgstrom_quantile_estimate'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION pg_catalog.quantile_estimate(bytea, float8[])
+  RETURNS float8[]
+  AS 'MODULE_PATHNAME','pgstrom_quantile_estimate_multi'
+  LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE pg_catalog.quantile_sketch(float8)
+(
+  sfunc = pgstrom.quantile_sketch_update,
+  stype = bytea,
+  combinefunc = pgstrom.quantile_sketch_merge,
+  parallel = safe
+);
+
+CREATE AGGREGATE pg_catalog.quantile_combine(bytea)
+(
+  sfunc = pgstrom.quantile_sketch_merge,
+  stype = bytea,
+  combinefunc = pgstrom.quantile_sketch_merge,
+  parallel = safe
+);
+
+---
+--- STRING_AGG
+---
+CREATE FUNCTION pgstrom.pstring_agg(text, text)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_partial_string_agg'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.pstring_agg(bytea, bytea)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_partial_string_agg'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.string_agg_accum(internal, bytea)
+  RETURNS internal
+  AS 'MODULE_PATHNAME','pgstrom_string_agg_accum'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.string_agg_final(internal)
+  RETURNS text
+  AS 'MODULE_PATHNAME','pgstrom_string_agg_final'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+
+CREATE FUNCTION pgstrom.string_agg_final_bytea(internal)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME','pgstrom_string_agg_final'
+  LANGUAGE C CALLED ON NULL INPUT PARALLEL SAFE;
+
+CREATE AGGREGATE pgstrom.string_agg(bytea)
+(
+  sfunc = pgstrom.string_agg_accum,
+  stype = internal,
+  finalfunc = pgstrom.string_agg_final,
+  parallel = safe
+);
+
+CREATE AGGREGATE pgstrom.string_agg_bytea(bytea)
+(
+  sfunc = pgstrom.string_agg_accum,
+  stype = internal,
+  finalfunc = pgstrom.string_agg_final_bytea,
+  parallel = safe
+);
+
+-- System view for DPU service statistics
+CREATE TYPE pgstrom.__dpu_server_stats AS (
+  dpu_id           int,
+  host             text,
+  port             text,
+  dir              text,
+  active_sessions  int,
+  queued_commands  int,
+  bytes_read       bigint,
+  rows_scanned     bigint,
+  rows_filtered    bigint,
+  open_latency_us  bigint[],
+  exec_latency_us  bigint[],
+  final_latency_us bigint[]
+);
+CREATE FUNCTION pgstrom.dpu_server_stats()
+  RETURNS SETOF pgstrom.__dpu_server_stats
+  AS 'MODULE_PATHNAME','pgstrom_dpu_server_stats'
+  LANGUAGE C STRICT;
+CREATE VIEW pgstrom.dpu_server_stats AS
+  SELECT * FROM pgstrom.dpu_server_stats();
+
+-- System view for cumulative statistics of GPU service
+CREATE TYPE pgstrom.__gpu_service_stats AS (
+  gpu_id            int,
+  nr_tasks_scan     bigint,
+  nr_tasks_join     bigint,
+  nr_tasks_preagg   bigint,
+  nr_suspend_resume bigint,
+  nr_cpu_fallback   bigint,
+  nr_errors         bigint,
+  direct_read_sz    bigint,
+  vfs_read_sz       bigint,
+  queue_wait_time   float8,
+  kernel_time       float8
+);
+CREATE FUNCTION pgstrom.gpu_service_stats()
+  RETURNS SETOF pgstrom.__gpu_service_stats
+  AS 'MODULE_PATHNAME','pgstrom_gpu_service_stats'
+  LANGUAGE C STRICT;
+CREATE VIEW pgstrom.gpu_service_stats AS
+  SELECT * FROM pgstrom.gpu_service_stats();
+
+-- Calibration of the xPU cost constants
+CREATE TYPE pgstrom.__cost_calibration_info AS (
+  device          text,
+  workload        text,
+  nsamples        bigint,
+  usec_per_cost   float8,
+  factor          float8
+);
+CREATE FUNCTION pgstrom.cost_calibration_info()
+  RETURNS SETOF pgstrom.__cost_calibration_info
+  AS 'MODULE_PATHNAME','pgstrom_cost_calibration_info'
+  LANGUAGE C STRICT;
+CREATE VIEW pgstrom.cost_calibration_info AS
+  SELECT * FROM pgstrom.cost_calibration_info();
+CREATE FUNCTION pgstrom.cost_calibration_reset()
+  RETURNS void
+  AS 'MODULE_PATHNAME','pgstrom_cost_calibration_reset'
+  LANGUAGE C STRICT;
+
+-- Distance functions on the float2/float4/float8 vectors
+CREATE FUNCTION pgstrom.float2_l2_distance(float2[],float2[])
+  RETURNS float8
+  AS 'MODULE_PATHNAME','pgstrom_float2_l2_distance'
+  LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION pgstrom.float2_inner_product(float2[],float2[])
+  RETURNS float8
+  AS 'MODULE_PATHNAME','pgstrom_float2_inner_product'
+  LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION pgstrom.float2_negative_inner_product(float2[],float2[])
+  RETURNS float8
+  AS 'MODULE_PATHNAME','pgstrom_float2_negative_inner_product'
+  LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION pgstrom.float2_cosine_distance(float2[],float2[])
+  RETURNS float8
+  AS 'MODULE_PATHNAME','pgstrom_float2_cosine_distance'
+  LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION pgstrom.float4_l2_distance(float4[],float4[])
+  RETURNS float8
+  AS 'MODULE_PATHNAME','pgstrom_float4_l2_distance'
+  LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION pgstrom.float4_inner_product(float4[],float4[])
+  RETURNS float8
+  AS 'MODULE_PATHNAME','pgstrom_float4_inner_product'
+  LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION pgstrom.float4_negative_inner_product(float4[],float4[])
+  RETURNS float8
+  AS 'MODULE_PATHNAME','pgstrom_float4_negative_inner_product'
+  LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION pgstrom.float4_cosine_distance(float4[],float4[])
+  RETURNS float8
+  AS 'MODULE_PATHNAME','pgstrom_float4_cosine_distance'
+  LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION pgstrom.float8_l2_distance(float8[],float8[])
+  RETURNS float8
+  AS 'MODULE_PATHNAME','pgstrom_float8_l2_distance'
+  LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION pgstrom.float8_inner_product(float8[],float8[])
+  RETURNS float8
+  AS 'MODULE_PATHNAME','pgstrom_float8_inner_product'
+  LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION pgstrom.float8_negative_inner_product(float8[],float8[])
+  RETURNS float8
+  AS 'MODULE_PATHNAME','pgstrom_float8_negative_inner_product'
+  LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION pgstrom.float8_cosine_distance(float8[],float8[])
+  RETURNS float8
+  AS 'MODULE_PATHNAME','pgstrom_float8_cosine_distance'
+  LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+CREATE OPERATOR pg_catalog.<-> (
+  PROCEDURE = pgstrom.float2_l2_distance,
+  LEFTARG = pg_catalog.float2[],
+  RIGHTARG = pg_catalog.float2[],
+  COMMUTATOR = <->
+);
+CREATE OPERATOR pg_catalog.<#> (
+  PROCEDURE = pgstrom.float2_negative_inner_product,
+  LEFTARG = pg_catalog.float2[],
+  RIGHTARG = pg_catalog.float2[],
+  COMMUTATOR = <#>
+);
+CREATE OPERATOR pg_catalog.<=> (
+  PROCEDURE = pgstrom.float2_cosine_distance,
+  LEFTARG = pg_catalog.float2[],
+  RIGHTARG = pg_catalog.float2[],
+  COMMUTATOR = <=>
+);
+CREATE OPERATOR pg_catalog.<-> (
+  PROCEDURE = pgstrom.float4_l2_distance,
+  LEFTARG = pg_catalog.float4[],
+  RIGHTARG = pg_catalog.float4[],
+  COMMUTATOR = <->
+);
+CREATE OPERATOR pg_catalog.<#> (
+  PROCEDURE = pgstrom.float4_negative_inner_product,
+  LEFTARG = pg_catalog.float4[],
+  RIGHTARG = pg_catalog.float4[],
+  COMMUTATOR = <#>
+);
+CREATE OPERATOR pg_catalog.<=> (
+  PROCEDURE = pgstrom.float4_cosine_distance,
+  LEFTARG = pg_catalog.float4[],
+  RIGHTARG = pg_catalog.float4[],
+  COMMUTATOR = <=>
+);
+CREATE OPERATOR pg_catalog.<-> (
+  PROCEDURE = pgstrom.float8_l2_distance,
+  LEFTARG = pg_catalog.float8[],
+  RIGHTARG = pg_catalog.float8[],
+  COMMUTATOR = <->
+);
+CREATE OPERATOR pg_catalog.<#> (
+  PROCEDURE = pgstrom.float8_negative_inner_product,
+  LEFTARG = pg_catalog.float8[],
+  RIGHTARG = pg_catalog.float8[],
+  COMMUTATOR = <#>
+);
+CREATE OPERATOR pg_catalog.<=> (
+  PROCEDURE = pgstrom.float8_cosine_distance,
+  LEFTARG = pg_catalog.float8[],
+  RIGHTARG = pg_catalog.float8[],
+  COMMUTATOR = <=>
+);
@@ -0,0 +1,150 @@
+/*
+ * vector.c
+ *
+ * Distance functions on the float2/float4/float8 arrays (embedding vectors)
+ * ----
+ * Copyright 2011-2023 (C) KaiGai Kohei <kaigai@kaigai.gr.jp>
+ * Copyright 2014-2023 (C) PG-Strom Developers Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the PostgreSQL License.
+ */
+#include "pg_strom.h"
+#include "float2.h"
+
+/*
+ * These are the host implementation of the device functions in
+ * xpu_misclib.cu; used for CPU fallback and the queries not on the xPU.
+ * Vectors are fixed-length, one-dimensional arrays without NULLs, like:
+ *
+ *   SELECT * FROM items ORDER BY embedding <-> $1 LIMIT 10;
+ *
+ * The leading sort key is computed on the GPU projection, so GPU Top-N
+ * reduces each chunk to the nearest k items then Sort + Limit on the host
+ * merges them.
+ * float2 vectors are accumulated in fp32, float4/float8 vectors are in fp64,
+ * to get the same results as the device code.
+ */
+#define VECTOR_DISTANCE__L2					1
+#define VECTOR_DISTANCE__INNER_PRODUCT		2
+#define VECTOR_DISTANCE__NEG_INNER_PRODUCT	3
+#define VECTOR_DISTANCE__COSINE				4
+
+static const char *
+__vector_values(ArrayType *array, const char *fname, int *p_nitems)
+{
+	if (array_contains_nulls(array))
+		ereport(ERROR,
+				(errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+				 errmsg("%s: vector must not contain nulls", fname)));
+	*p_nitems = ArrayGetNItems(ARR_NDIM(array), ARR_DIMS(array));
+	return ARR_DATA_PTR(array);
+}
+
+static inline float4_t
+__fetch_fp16_as_fp32(const char *addr)
+{
+	uint16_t	ival;
+
+	memcpy(&ival, addr, sizeof(uint16_t));
+	return fp16_to_fp32(__short_as_half__(ival));
+}
+
+static inline float8_t
+__fetch_fp32_as_fp64(const char *addr)
+{
+	float4_t	fval;
+
+	memcpy(&fval, addr, sizeof(float4_t));
+	return (float8_t)fval;
+}
+
+static inline float8_t
+__fetch_fp64(const char *addr)
+{
+	float8_t	fval;
+
+	memcpy(&fval, addr, sizeof(float8_t));
+	return fval;
+}
+
+#define PG_VECTOR_DISTANCE_TEMPLATE(NAME,ELEMTYPE,ACCUMTYPE,__FETCH,METHOD) \
+	PG_FUNCTION_INFO_V1(pgstrom_##NAME);								\
+	PUBLIC_FUNCTION(Datum)												\
+	pgstrom_##NAME(PG_FUNCTION_ARGS)									\
+	{																	\
+		ArrayType  *x_array = PG_GETARG_ARRAYTYPE_P(0);					\
+		ArrayType  *y_array = PG_GETARG_ARRAYTYPE_P(1);					\
+		const char *x_values;											\
+		const char *y_values;											\
+		int			x_nitems;											\
+		int			y_nitems;											\
+		ACCUMTYPE	dot = 0.0;											\
+		ACCUMTYPE	x_norm = 0.0;										\
+		ACCUMTYPE	y_norm = 0.0;										\
+		double		fval;												\
+																		\
+		x_values = __vector_values(x_array, #NAME, &x_nitems);			\
+		y_values = __vector_values(y_array, #NAME, &y_nitems);			\
+		if (x_nitems != y_nitems)										\
+			ereport(ERROR,												\
+					(errcode(ERRCODE_DATA_EXCEPTION),					\
+					 errmsg("%s: different vector dimensions %d and %d", \
+							#NAME, x_nitems, y_nitems)));				\
+		for (int i=0; i < x_nitems; i++)								\
+		{																\
+			ACCUMTYPE	x = __FETCH(x_values + sizeof(ELEMTYPE) * i);	\
+			ACCUMTYPE	y = __FETCH(y_values + sizeof(ELEMTYPE) * i);	\
+																		\
+			switch (METHOD)												\
+			{															\
+				case VECTOR_DISTANCE__L2:								\
+					dot += (x - y) * (x - y);							\
+					break;												\
+				case VECTOR_DISTANCE__COSINE:							\
+					x_norm += x * x;									\
+					y_norm += y * y;									\
+					dot += x * y;										\
+					break;												\
+				default:												\
+					dot += x * y;										\
+					break;												\
+			}															\
+		}																\
+		switch (METHOD)													\
+		{																\
+			case VECTOR_DISTANCE__L2:									\
+				fval = sqrt((double)dot);								\
+				break;													\
+			case VECTOR_DISTANCE__NEG_INNER_PRODUCT:					\
+				fval = -(double)dot;									\
+				break;													\
+			case VECTOR_DISTANCE__COSINE:								\
+				if (x_norm == 0.0 || y_norm == 0.0)						\
+					fval = get_float8_nan();							\
+				else													\
+				{														\
+					fval = 1.0 - ((double)dot /							\
+								  sqrt((double)x_norm * (double)y_norm)); \
+					fval = Max(0.0, Min(fval, 2.0));					\
+				}														\
+				break;													\
+			default:													\
+				fval = (double)dot;										\
+				break;													\
+		}																\
+		PG_RETURN_FLOAT8(fval);											\
+	}
+
+PG_VECTOR_DISTANCE_TEMPLATE(float2_l2_distance, half_t,float4_t,__fetch_fp16_as_fp32,VECTOR_DISTANCE__L2)
+PG_VECTOR_DISTANCE_TEMPLATE(float4_l2_distance, float4_t,float8_t,__fetch_fp32_as_fp64,VECTOR_DISTANCE__L2)
+PG_VECTOR_DISTANCE_TEMPLATE(float8_l2_distance, float8_t,float8_t,__fetch_fp64,VECTOR_DISTANCE__L2)
+PG_VECTOR_DISTANCE_TEMPLATE(float2_inner_product, half_t,float4_t,__fetch_fp16_as_fp32,VECTOR_DISTANCE__INNER_PRODUCT)
+PG_VECTOR_DISTANCE_TEMPLATE(float4_inner_product, float4_t,float8_t,__fetch_fp32_as_fp64,VECTOR_DISTANCE__INNER_PRODUCT)
+PG_VECTOR_DISTANCE_TEMPLATE(float8_inner_product, float8_t,float8_t,__fetch_fp64,VECTOR_DISTANCE__INNER_PRODUCT)
+PG_VECTOR_DISTANCE_TEMPLATE(float2_negative_inner_product, half_t,float4_t,__fetch_fp16_as_fp32,VECTOR_DISTANCE__NEG_INNER_PRODUCT)
+PG_VECTOR_DISTANCE_TEMPLATE(float4_negative_inner_product, float4_t,float8_t,__fetch_fp32_as_fp64,VECTOR_DISTANCE__NEG_INNER_PRODUCT)
+PG_VECTOR_DISTANCE_TEMPLATE(float8_negative_inner_product, float8_t,float8_t,__fetch_fp64,VECTOR_DISTANCE__NEG_INNER_PRODUCT)
+PG_VECTOR_DISTANCE_TEMPLATE(float2_cosine_distance, half_t,float4_t,__fetch_fp16_as_fp32,VECTOR_DISTANCE__COSINE)
+PG_VECTOR_DISTANCE_TEMPLATE(float4_cosine_distance, float4_t,float8_t,__fetch_fp32_as_fp64,VECTOR_DISTANCE__COSINE)
+PG_VECTOR_DISTANCE_TEMPLATE(float8_cosine_distance, float8_t,float8_t,__fetch_fp64,VECTOR_DISTANCE__COSINE)
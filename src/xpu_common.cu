@@ -104,6 +104,192 @@ __extract_heap_tuple_sysattr(kern_context *kcxt,
 	return false;
 }
 
+/*
+ * Routines to decompress inline compressed varlena
+ *
+ * These are equivalent to pglz_decompress() and LZ4_decompress_safe()
+ * with the reference to the source and destination boundaries.
+ */
+#define TOAST_PGLZ_COMPRESSION_ID	0
+#define TOAST_LZ4_COMPRESSION_ID	1
+
+STATIC_FUNCTION(int32_t)
+__pglz_decompress(const uint8_t *sp, int32_t slen, char *dest, int32_t rawsize)
+{
+	const uint8_t  *srcend = sp + slen;
+	char		   *dp = dest;
+	char		   *destend = dest + rawsize;
+
+	while (sp < srcend && dp < destend)
+	{
+		uint8_t		ctrl = *sp++;
+
+		for (int ctrlc=0; ctrlc < 8 && sp < srcend && dp < destend; ctrlc++)
+		{
+			if (ctrl & 1)
+			{
+				int32_t		len = (sp[0] & 0x0f) + 3;
+				int32_t		off = ((sp[0] & 0xf0) << 4) | sp[1];
+
+				sp += 2;
+				if (len == 18)
+					len += *sp++;
+				if (sp > srcend || off == 0 || off > (dp - dest))
+					return -1;
+				len = Min(len, destend - dp);
+				/* copy with the overlap of the history */
+				while (off < len)
+				{
+					memcpy(dp, dp - off, off);
+					len -= off;
+					dp  += off;
+					off += off;
+				}
+				memcpy(dp, dp - off, len);
+				dp += len;
+			}
+			else
+			{
+				*dp++ = *sp++;
+			}
+			ctrl >>= 1;
+		}
+	}
+	return (dp - dest);
+}
+
+STATIC_FUNCTION(int32_t)
+__lz4_decompress(const uint8_t *sp, int32_t slen, char *dest, int32_t rawsize)
+{
+	const uint8_t  *srcend = sp + slen;
+	char		   *dp = dest;
+	char		   *destend = dest + rawsize;
+
+	while (sp < srcend)
+	{
+		uint8_t		token = *sp++;
+		uint32_t	len = (token >> 4);
+		uint32_t	off;
+		uint8_t		b;
+
+		/* literals */
+		if (len == 15)
+		{
+			do {
+				if (sp >= srcend)
+					return -1;
+				b = *sp++;
+				len += b;
+			} while (b == 255);
+		}
+		if (len > srcend - sp || len > destend - dp)
+			return -1;
+		memcpy(dp, sp, len);
+		sp += len;
+		dp += len;
+		if (sp >= srcend)
+			break;		/* last sequence has no match part */
+		/* match */
+		if (srcend - sp < 2)
+			return -1;
+		off = (uint32_t)sp[0] | ((uint32_t)sp[1] << 8);
+		sp += 2;
+		if (off == 0 || off > (dp - dest))
+			return -1;
+		len = (token & 0x0f);
+		if (len == 15)
+		{
+			do {
+				if (sp >= srcend)
+					return -1;
+				b = *sp++;
+				len += b;
+			} while (b == 255);
+		}
+		len += 4;
+		if (len > destend - dp)
+			return -1;
+		/* byte-by-byte copy, because the match may overlap */
+		for (uint32_t i=0; i < len; i++)
+			dp[i] = dp[i - off];
+		dp += len;
+	}
+	return (dp - dest);
+}
+
+PUBLIC_FUNCTION(bool)
+xpu_varlena_decompress(kern_context *kcxt,
+					   const char *addr,
+					   const char **p_value,
+					   int *p_length)
+{
+	const uint8_t  *src;
+	int32_t			slen;
+	int32_t			rawsize;
+	int32_t			nbytes;
+	char		   *pos;
+
+	if (!VARATT_IS_COMPRESSED(addr))
+	{
+		STROM_CPU_FALLBACK(kcxt, "varlena datum is external");
+		return false;
+	}
+	rawsize = TOAST_COMPRESS_EXTSIZE(addr);
+	pos = (char *)MAXALIGN(kcxt->vlpos);
+	if (pos + rawsize > kcxt->vlend)
+	{
+		STROM_CPU_FALLBACK(kcxt, "varlena datum is too large to decompress");
+		return false;
+	}
+	src  = (const uint8_t *)TOAST_COMPRESS_RAWDATA(addr);
+	slen = VARSIZE_4B(addr) - TOAST_COMPRESS_HDRSZ;
+	switch (TOAST_COMPRESS_METHOD(addr))
+	{
+		case TOAST_PGLZ_COMPRESSION_ID:
+			nbytes = __pglz_decompress(src, slen, pos, rawsize);
+			break;
+		case TOAST_LZ4_COMPRESSION_ID:
+			nbytes = __lz4_decompress(src, slen, pos, rawsize);
+			break;
+		default:
+			nbytes = -1;
+			break;
+	}
+	if (nbytes != rawsize)
+	{
+		STROM_CPU_FALLBACK(kcxt, "unable to decompress varlena datum");
+		return false;
+	}
+	kcxt->vlpos = pos + rawsize;
+	*p_value  = pos;
+	*p_length = rawsize;
+	return true;
+}
+
+/*
+ * __heap_tuple_has_nulls - true, if any of the first 'natts' attributes
+ * are NULL.
+ */
+INLINE_FUNCTION(bool)
+__heap_tuple_has_nulls(const uint8_t *t_bits, int natts)
+{
+	int		i;
+
+	for (i=0; i + 8 <= natts; i += 8)
+	{
+		if (t_bits[i >> 3] != 0xff)
+			return true;
+	}
+	if (i < natts)
+	{
+		uint8_t		mask = (1U << (natts - i)) - 1;
+
+		if ((t_bits[i >> 3] & mask) != mask)
+			return true;
+	}
+	return false;
+}
+
 STATIC_FUNCTION(bool)
 kern_extract_heap_tuple(kern_context *kcxt,
 						const kern_data_store *kds,
@@ -126,31 +312,36 @@ kern_extract_heap_tuple(kern_context *kcxt,
 		vl_desc++;
 		kvload_count++;
 	}
-	/* try attcacheoff shortcut, if available. */
-	if (!heap_hasnull)
+	/*
+	 * try attcacheoff shortcut, if available.
+	 * attcacheoff is valid as long as all the preceding attributes are
+	 * fixed-length and not NULL, so tuples with NULLs also take this
+	 * shortcut for the leading attributes.
+	 */
+	while (kvload_count < kvload_nitems &&
+		   vl_desc->vl_resno > 0 &&
+		   vl_desc->vl_resno <= ncols)
 	{
-		while (kvload_count < kvload_nitems &&
-			   vl_desc->vl_resno > 0 &&
-			   vl_desc->vl_resno <= ncols)
-		{
-			const kern_colmeta *cmeta = &kds->colmeta[vl_desc->vl_resno-1];
-			char	   *addr;
+		const kern_colmeta *cmeta = &kds->colmeta[vl_desc->vl_resno-1];
+		char	   *addr;
 
-			if (cmeta->attcacheoff < 0)
-				break;
-			offset = htup->t_hoff + cmeta->attcacheoff;
-			addr = (char *)htup + offset;
-			if (!__extract_heap_tuple_attr(kcxt, vl_desc->vl_slot_id, addr))
-				return false;
-			/* next resno */
-			resno = vl_desc->vl_resno + 1;
-			if (cmeta->attlen > 0)
-				offset += cmeta->attlen;
-			else
-				offset += VARSIZE_ANY(addr);
-			vl_desc++;
-			kvload_count++;
-		}
+		if (cmeta->attcacheoff < 0)
+			break;
+		if (heap_hasnull && __heap_tuple_has_nulls(htup->t_bits,
+												   vl_desc->vl_resno))
+			break;
+		offset = htup->t_hoff + cmeta->attcacheoff;
+		addr = (char *)htup + offset;
+		if (!__extract_heap_tuple_attr(kcxt, vl_desc->vl_slot_id, addr))
+			return false;
+		/* next resno */
+		resno = vl_desc->vl_resno + 1;
+		if (cmeta->attlen > 0)
+			offset += cmeta->attlen;
+		else
+			offset += VARSIZE_ANY(addr);
+		vl_desc++;
+		kvload_count++;
 	}
 
 	/* extract slow path */
@@ -830,6 +1021,80 @@ __ScalarArrayOpHeap(kern_context *kcxt,
 	return true;
 }
 
+/*
+ * __ScalarArrayOpHash - ANY operator with pre-built hash-table
+ */
+STATIC_FUNCTION(bool)
+__ScalarArrayOpHash(kern_context *kcxt,
+					xpu_bool_t *result,
+					const kern_expression *kexp,
+					const kern_expression *kcmp,
+					xpu_array_t *aval)
+{
+	const __ArrayTypeData *ar = (const __ArrayTypeData *)VARDATA_ANY(aval->u.heap.value);
+	const kern_saop_hashtable *htab = (const kern_saop_hashtable *)
+		((const char *)kexp + kexp->u.saop.hash_offset);
+	const kern_saop_hashitem *items = KERN_SAOP_HASHITEMS(htab);
+	const kern_expression *karg = KEXP_FIRST_ARG(kcmp);
+	const xpu_datum_operators *expr_ops = karg->expr_ops;
+	xpu_datum_t	   *datum;
+	char		   *base = __pg_array_dataptr(ar);
+	uint32_t		hash;
+	uint32_t		index;
+	bool			meet_nulls = htab->has_nulls;
+
+	if (htab->nitems == 0 && !htab->has_nulls)
+	{
+		/* empty array */
+		result->expr_ops = &xpu_bool_ops;
+		result->value = false;
+		return true;
+	}
+	/* scalar value (1st arg of the comparator) */
+	datum = (xpu_datum_t *)alloca(expr_ops->xpu_type_sizeof);
+	if (!EXEC_KERN_EXPRESSION(kcxt, karg, datum))
+		return false;
+	if (XPU_DATUM_ISNULL(datum))
+	{
+		result->expr_ops = NULL;
+		return true;
+	}
+	if (!expr_ops->xpu_datum_hash(kcxt, &hash, datum))
+		return false;
+	/* walk on the hash-chain */
+	for (index = htab->slots[hash & (htab->nslots - 1)];
+		 index != 0;
+		 index = items[index-1].next)
+	{
+		const kern_saop_hashitem *hitem = &items[index-1];
+		xpu_bool_t	status;
+
+		if (hitem->hash != hash)
+			continue;
+		if (!__extract_heap_tuple_attr(kcxt, kexp->u.saop.elem_slot_id,
+									   base + hitem->offset))
+			return false;
+		if (!EXEC_KERN_EXPRESSION(kcxt, kcmp, &status))
+			return false;
+		if (XPU_DATUM_ISNULL(&status))
+			meet_nulls = true;
+		else if (status.value)
+		{
+			result->expr_ops = &xpu_bool_ops;
+			result->value = true;
+			return true;
+		}
+	}
+	if (meet_nulls)
+		result->expr_ops = NULL;
+	else
+	{
+		result->expr_ops = &xpu_bool_ops;
+		result->value = false;
+	}
+	return true;
+}
+
 STATIC_FUNCTION(bool)
 __ScalarArrayOpArrow(kern_context *kcxt,
 					 xpu_bool_t *result,
@@ -920,9 +1185,18 @@ pgfn_ScalarArrayOp(XPU_PGFUNCTION_ARGS)
 	/* comparator expression */
 	karg = KEXP_NEXT_ARG(karg);
 	assert(KEXP_IS_VALID(karg, bool));
-	if (aval.length < 0)
+	if (XPU_DATUM_ISNULL(&aval))
 	{
-		if (!__ScalarArrayOpHeap(kcxt, result, kexp, karg, &aval))
+		result->expr_ops = NULL;
+	}
+	else if (aval.length < 0)
+	{
+		if (kexp->u.saop.hash_offset != 0)
+		{
+			if (!__ScalarArrayOpHash(kcxt, result, kexp, karg, &aval))
+				return false;
+		}
+		else if (!__ScalarArrayOpHeap(kcxt, result, kexp, karg, &aval))
 			return false;
 	}
 	else
@@ -1086,6 +1360,174 @@ pgfn_Projection(XPU_PGFUNCTION_ARGS)
 	return false;
 }
 
+/*
+ * pgfn_SimpleExpr
+ *
+ * It runs a postfix program of integer arithmetic / comparison operators
+ * on a small register stack. Var references are loaded from the kvars-slot
+ * or the kvecs-buffer directly, so neither recursive invocation nor
+ * xpu_datum_t copy happen for the intermediate results.
+ */
+INLINE_FUNCTION(bool)
+__simple_expr_check_range(kern_context *kcxt, int type_code, int128_t value)
+{
+	switch (type_code)
+	{
+		case TypeOpCode__int2:
+			if (value >= SHRT_MIN && value <= SHRT_MAX)
+				return true;
+			STROM_ELOG(kcxt, "smallint out of range");
+			return false;
+		case TypeOpCode__int4:
+			if (value >= INT_MIN && value <= INT_MAX)
+				return true;
+			STROM_ELOG(kcxt, "integer out of range");
+			return false;
+		case TypeOpCode__int8:
+			if (value >= LLONG_MIN && value <= LLONG_MAX)
+				return true;
+			STROM_ELOG(kcxt, "bigint out of range");
+			return false;
+		default:
+			return true;	/* bool */
+	}
+}
+
+STATIC_FUNCTION(bool)
+pgfn_SimpleExpr(XPU_PGFUNCTION_ARGS)
+{
+	int64_t		values[KERN_SIMPLE_EXPR_MAX_DEPTH];
+	bool		isnull[KERN_SIMPLE_EXPR_MAX_DEPTH];
+	int			depth = 0;
+	int			i;
+
+	for (i=0; i < kexp->u.simple.nsteps; i++)
+	{
+		const kern_simple_expr_step *step = &kexp->u.simple.steps[i];
+		int128_t	x, y, r;
+
+		if (step->se_op == SimpleExprOp__Var)
+		{
+			int64_t		ival = 0;
+			bool		inull;
+
+			assert(depth < KERN_SIMPLE_EXPR_MAX_DEPTH);
+			if (step->se_var_offset < 0)
+			{
+				const xpu_datum_t *xdatum = kcxt->kvars_slot[step->se_slot_id];
+
+				inull = XPU_DATUM_ISNULL(xdatum);
+				if (!inull)
+				{
+					switch (step->se_type_code)
+					{
+						case TypeOpCode__int2:
+							ival = ((const xpu_int2_t *)xdatum)->value;
+							break;
+						case TypeOpCode__int4:
+							ival = ((const xpu_int4_t *)xdatum)->value;
+							break;
+						default:
+							ival = ((const xpu_int8_t *)xdatum)->value;
+							break;
+					}
+				}
+			}
+			else
+			{
+				const char *kvecs = kcxt->kvecs_curr_buffer + step->se_var_offset;
+				uint32_t	kvecs_id = kcxt->kvecs_curr_id;
+
+				inull = ((const kvec_datum_t *)kvecs)->isnull[kvecs_id];
+				if (!inull)
+				{
+					switch (step->se_type_code)
+					{
+						case TypeOpCode__int2:
+							ival = ((const kvec_int2_t *)kvecs)->values[kvecs_id];
+							break;
+						case TypeOpCode__int4:
+							ival = ((const kvec_int4_t *)kvecs)->values[kvecs_id];
+							break;
+						default:
+							ival = ((const kvec_int8_t *)kvecs)->values[kvecs_id];
+							break;
+					}
+				}
+			}
+			values[depth] = ival;
+			isnull[depth] = inull;
+			depth++;
+			continue;
+		}
+		else if (step->se_op == SimpleExprOp__Const)
+		{
+			assert(depth < KERN_SIMPLE_EXPR_MAX_DEPTH);
+			values[depth] = step->se_value;
+			isnull[depth] = false;
+			depth++;
+			continue;
+		}
+		/* binary operators */
+		assert(depth >= 2);
+		depth--;
+		if (isnull[depth-1] || isnull[depth])
+		{
+			isnull[depth-1] = true;
+			continue;
+		}
+		x = values[depth-1];
+		y = values[depth];
+		switch (step->se_op)
+		{
+			case SimpleExprOp__Add:	r = x + y;			break;
+			case SimpleExprOp__Sub:	r = x - y;			break;
+			case SimpleExprOp__Mul:	r = x * y;			break;
+			case SimpleExprOp__Eq:	r = (x == y);		break;
+			case SimpleExprOp__Ne:	r = (x != y);		break;
+			case SimpleExprOp__Lt:	r = (x <  y);		break;
+			case SimpleExprOp__Le:	r = (x <= y);		break;
+			case SimpleExprOp__Gt:	r = (x >  y);		break;
+			case SimpleExprOp__Ge:	r = (x >= y);		break;
+			default:
+				STROM_ELOG(kcxt, "unknown SimpleExpr operator");
+				return false;
+		}
+		if (!__simple_expr_check_range(kcxt, step->se_type_code, r))
+			return false;
+		values[depth-1] = (int64_t)r;
+	}
+	assert(depth == 1);
+	if (isnull[0])
+	{
+		__result->expr_ops = NULL;
+		return true;
+	}
+	switch (kexp->exptype)
+	{
+		case TypeOpCode__bool:
+			((xpu_bool_t *)__result)->expr_ops = &xpu_bool_ops;
+			((xpu_bool_t *)__result)->value = (values[0] != 0);
+			break;
+		case TypeOpCode__int2:
+			((xpu_int2_t *)__result)->expr_ops = &xpu_int2_ops;
+			((xpu_int2_t *)__result)->value = (int16_t)values[0];
+			break;
+		case TypeOpCode__int4:
+			((xpu_int4_t *)__result)->expr_ops = &xpu_int4_ops;
+			((xpu_int4_t *)__result)->value = (int32_t)values[0];
+			break;
+		case TypeOpCode__int8:
+			((xpu_int8_t *)__result)->expr_ops = &xpu_int8_ops;
+			((xpu_int8_t *)__result)->value = values[0];
+			break;
+		default:
+			STROM_ELOG(kcxt, "unexpected result type of SimpleExpr");
+			return false;
+	}
+	return true;
+}
+
 STATIC_FUNCTION(bool)
 pgfn_HashValue(XPU_PGFUNCTION_ARGS)
 {
@@ -1289,15 +1731,31 @@ kern_extract_gpucache_tuple(kern_context *kcxt,
 	{
 		const kern_colmeta *cmeta = &kds->colmeta[vl_desc->vl_resno-1];
 		const char *addr;
+		int64_t		temp;
 		uint32_t	slot_id = vl_desc->vl_slot_id;
 
 		assert(slot_id < kcxt->kvars_nslots);
+		if (cmeta->values_offset == 0)
+		{
+			STROM_ELOG(kcxt, "gpucache: referenced column is not cached");
+			return false;
+		}
 		if (!KDS_COLUMN_ITEM_ISNULL(kds, cmeta, kds_index))
 		{
 			/* base pointer */
 			addr = ((const char *)kds + __kds_unpack(cmeta->values_offset));
 
-			if (cmeta->attlen > 0)
+			if (cmeta->for_unitsz > 0)
+			{
+				/*
+				 * frame-of-reference encoded integers; the decoded value
+				 * is always int64, but its lower bytes are also a valid
+				 * int2/int4 datum on the little-endian device.
+				 */
+				temp = KDS_COLUMN_FOR_DECODE(cmeta, addr, kds_index);
+				addr = (const char *)&temp;
+			}
+			else if (cmeta->attlen > 0)
 			{
 				addr += cmeta->attlen * kds_index;
 			}
@@ -1740,6 +2198,104 @@ restart:
 	return ULONG_MAX;	/* no more chance for this outer */
 }
 
+/*
+ * ExecGiSTRTreeGetNext
+ *
+ * It is equivalent to ExecGiSTIndexGetNext, but walks on the packed R-tree
+ * built by the host, instead of the GiST-index pages.
+ */
+PUBLIC_FUNCTION(uint64_t)
+ExecGiSTRTreeGetNext(kern_context *kcxt,
+					 const kern_data_store *kds_hash,
+					 const kern_gist_rtree *rtree,
+					 const kern_expression *kexp_gist,
+					 uint64_t l_state)
+{
+	const kern_expression *karg_gist;
+	const kern_varload_desc *vl_desc;
+	const kern_gist_rtree_node *node;
+	uint32_t		node_id;
+	uint32_t		index;
+
+	assert(kds_hash->format == KDS_FORMAT_HASH);
+	assert(kexp_gist->opcode == FuncOpCode__GiSTEval &&
+		   kexp_gist->exptype == TypeOpCode__bool);
+	vl_desc = &kexp_gist->u.gist.ivar_desc;
+	karg_gist = KEXP_FIRST_ARG(kexp_gist);
+	assert(karg_gist->exptype ==  TypeOpCode__bool);
+
+	if (rtree->nnodes == 0)
+		return ULONG_MAX;	/* empty */
+	if (l_state == 0)
+	{
+		node_id = rtree->nnodes - 1;	/* root */
+		index = 0;
+	}
+	else
+	{
+		/* l_state is the next entry-id of the last match */
+		node_id = (l_state - 1) / KERN_GIST_RTREE_FANOUT;
+		index   = (l_state - 1) % KERN_GIST_RTREE_FANOUT + 1;
+	}
+	for (;;)
+	{
+		assert(node_id < rtree->nnodes);
+		node = &rtree->nodes[node_id];
+		while (index < node->nitems)
+		{
+			xpu_bool_t	status;
+
+			kcxt_reset(kcxt);
+			if (!__extract_heap_tuple_attr(kcxt, vl_desc->vl_slot_id,
+										   (const char *)&node->keys[index]))
+			{
+				assert(kcxt->errcode != ERRCODE_STROM_SUCCESS);
+				return ULONG_MAX;
+			}
+			/* runs index-qualifier */
+			if (!EXEC_KERN_EXPRESSION(kcxt, karg_gist, &status))
+			{
+				assert(kcxt->errcode != ERRCODE_STROM_SUCCESS);
+				return ULONG_MAX;
+			}
+			if (XPU_DATUM_ISNULL(&status) || !status.value)
+			{
+				index++;
+				continue;
+			}
+			if (node_id < rtree->nleaf_nodes)
+			{
+				const kern_varslot_desc *vs_desc;
+				uint32_t	slot_id = kexp_gist->u.gist.htup_slot_id;
+				const char *addr;
+
+				addr = (const char *)kds_hash + __kds_unpack(node->values[index]);
+				assert(slot_id < kcxt->kvars_nslots);
+				vs_desc = &kcxt->kvars_desc[slot_id];
+				assert(vs_desc->vs_ops == &xpu_internal_ops);
+				if (!vs_desc->vs_ops->xpu_datum_heap_read(kcxt, addr,
+														  kcxt->kvars_slot[slot_id]))
+				{
+					assert(kcxt->errcode != ERRCODE_STROM_SUCCESS);
+					return ULONG_MAX;
+				}
+				return ((uint64_t)node_id * KERN_GIST_RTREE_FANOUT + index + 1);
+			}
+			/* walk down to the child node */
+			node_id = node->values[index];
+			index = 0;
+			assert(node_id < rtree->nnodes);
+			node = &rtree->nodes[node_id];
+		}
+		/* pop to the parent node if not found */
+		if (node->parent == UINT_MAX)
+			break;
+		node_id = node->parent / KERN_GIST_RTREE_FANOUT;
+		index   = node->parent % KERN_GIST_RTREE_FANOUT + 1;
+	}
+	return ULONG_MAX;	/* no more chance for this outer */
+}
+
 PUBLIC_FUNCTION(bool)
 ExecGiSTIndexPostQuals(kern_context *kcxt,
 					   int depth,
@@ -2457,6 +3013,8 @@ PUBLIC_DATA xpu_function_catalog_entry builtin_xpu_functions_catalog[] = {
 	{FuncOpCode__ScalarArrayOpAll,			pgfn_ScalarArrayOp},
 #include "xpu_opcodes.h"
 	{FuncOpCode__Projection,                pgfn_Projection},
+	{FuncOpCode__JsonbObjectFields,         pgfn_JsonbObjectFields},
+	{FuncOpCode__SimpleExpr,                pgfn_SimpleExpr},
 	{FuncOpCode__LoadVars,                  pgfn_LoadVars},
 	{FuncOpCode__MoveVars,					pgfn_MoveVars},
 	{FuncOpCode__HashValue,                 pgfn_HashValue},
@@ -2468,6 +3026,71 @@ PUBLIC_DATA xpu_function_catalog_entry builtin_xpu_functions_catalog[] = {
 	{FuncOpCode__Invalid, NULL},
 };
 
+#ifdef PGSTROM_JIT_SPECIALIZED
+/*
+ * pgstrom_jit_exec_expression
+ *
+ * Dispatcher of the device functions in the session specialized build.
+ * GPU-Service generates PGSTROM_JIT_OPCODE_USED() for the set of opcodes
+ * in the session, so the unused cases are eliminated at the compile time,
+ * and the used device functions are called directly (and inlined by the
+ * link-time optimization) instead of the function pointer.
+ */
+#define __JIT_OPCODE_CASE(OPCODE,FUNC)				\
+	case OPCODE:									\
+		if (PGSTROM_JIT_OPCODE_USED(OPCODE))		\
+			return FUNC(kcxt, kexp, __result);		\
+		break;
+#define FUNC_OPCODE(a,b,c,NAME,d,e)			\
+	__JIT_OPCODE_CASE(FuncOpCode__##NAME, pgfn_##NAME)
+#define DEVONLY_FUNC_OPCODE(a,NAME,b,c,d)	\
+	__JIT_OPCODE_CASE(FuncOpCode__##NAME, pgfn_##NAME)
+EXTERN_FUNCTION(bool)
+pgstrom_jit_exec_expression(XPU_PGFUNCTION_ARGS)
+{
+	switch (kexp->opcode)
+	{
+		__JIT_OPCODE_CASE(FuncOpCode__ConstExpr,			pgfn_ConstExpr)
+		__JIT_OPCODE_CASE(FuncOpCode__ParamExpr,			pgfn_ParamExpr)
+		__JIT_OPCODE_CASE(FuncOpCode__VarExpr,				pgfn_VarExpr)
+		__JIT_OPCODE_CASE(FuncOpCode__BoolExpr_And,			pgfn_BoolExprAnd)
+		__JIT_OPCODE_CASE(FuncOpCode__BoolExpr_Or,			pgfn_BoolExprOr)
+		__JIT_OPCODE_CASE(FuncOpCode__BoolExpr_Not,			pgfn_BoolExprNot)
+		__JIT_OPCODE_CASE(FuncOpCode__NullTestExpr_IsNull,	pgfn_NullTestExpr)
+		__JIT_OPCODE_CASE(FuncOpCode__NullTestExpr_IsNotNull, pgfn_NullTestExpr)
+		__JIT_OPCODE_CASE(FuncOpCode__BoolTestExpr_IsTrue,	pgfn_BoolTestExpr)
+		__JIT_OPCODE_CASE(FuncOpCode__BoolTestExpr_IsNotTrue, pgfn_BoolTestExpr)
+		__JIT_OPCODE_CASE(FuncOpCode__BoolTestExpr_IsFalse,	pgfn_BoolTestExpr)
+		__JIT_OPCODE_CASE(FuncOpCode__BoolTestExpr_IsNotFalse, pgfn_BoolTestExpr)
+		__JIT_OPCODE_CASE(FuncOpCode__BoolTestExpr_IsUnknown, pgfn_BoolTestExpr)
+		__JIT_OPCODE_CASE(FuncOpCode__BoolTestExpr_IsNotUnknown, pgfn_BoolTestExpr)
+		__JIT_OPCODE_CASE(FuncOpCode__DistinctFrom,			pgfn_DistinctFrom)
+		__JIT_OPCODE_CASE(FuncOpCode__CoalesceExpr,			pgfn_CoalesceExpr)
+		__JIT_OPCODE_CASE(FuncOpCode__LeastExpr,			pgfn_LeastExpr)
+		__JIT_OPCODE_CASE(FuncOpCode__GreatestExpr,			pgfn_GreatestExpr)
+		__JIT_OPCODE_CASE(FuncOpCode__CaseWhenExpr,			pgfn_CaseWhenExpr)
+		__JIT_OPCODE_CASE(FuncOpCode__ScalarArrayOpAny,		pgfn_ScalarArrayOp)
+		__JIT_OPCODE_CASE(FuncOpCode__ScalarArrayOpAll,		pgfn_ScalarArrayOp)
+#include "xpu_opcodes.h"
+		__JIT_OPCODE_CASE(FuncOpCode__Projection,			pgfn_Projection)
+		__JIT_OPCODE_CASE(FuncOpCode__JsonbObjectFields,	pgfn_JsonbObjectFields)
+		__JIT_OPCODE_CASE(FuncOpCode__SimpleExpr,			pgfn_SimpleExpr)
+		__JIT_OPCODE_CASE(FuncOpCode__LoadVars,				pgfn_LoadVars)
+		__JIT_OPCODE_CASE(FuncOpCode__MoveVars,				pgfn_MoveVars)
+		__JIT_OPCODE_CASE(FuncOpCode__HashValue,			pgfn_HashValue)
+		__JIT_OPCODE_CASE(FuncOpCode__GiSTEval,				pgfn_GiSTEval)
+		__JIT_OPCODE_CASE(FuncOpCode__SaveExpr,				pgfn_SaveExpr)
+		__JIT_OPCODE_CASE(FuncOpCode__AggFuncs,				pgfn_AggFuncs)
+		__JIT_OPCODE_CASE(FuncOpCode__JoinQuals,			pgfn_JoinQuals)
+		__JIT_OPCODE_CASE(FuncOpCode__Packed,				pgfn_Packed)
+		default:
+			break;
+	}
+	return kexp->fn_dptr(kcxt, kexp, __result);
+}
+#undef __JIT_OPCODE_CASE
+#endif	/* PGSTROM_JIT_SPECIALIZED */
+
 /*
  * Device version of hash_any() in PG host code
  */
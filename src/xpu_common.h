@@ -14,6 +14,7 @@
 #include <alloca.h>
 #include <assert.h>
 #include <limits.h>
+#include <math.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdarg.h>
@@ -381,6 +382,8 @@ typedef enum {
 	FuncOpCode__SaveExpr,
 	FuncOpCode__AggFuncs,
 	FuncOpCode__Projection,
+	FuncOpCode__JsonbObjectFields,
+	FuncOpCode__SimpleExpr,
 	FuncOpCode__Packed,		/* place-holder for the stacked expressions */
 	FuncOpCode__BuiltInMax,
 } FuncOpCode;
@@ -420,6 +423,7 @@ typedef struct
 	const char	   *error_funcname;
 	const char	   *error_message;
 	struct kern_session_info *session;
+	const struct kern_multirels *kmrels;	/* inner buffer, if GpuJoin */
 
 	/* the kernel variables slot */
 	struct xpu_datum_t **kvars_slot;
@@ -437,6 +441,26 @@ typedef struct
 	uint32_t		groupby_prepfn_bufsz;
 	uint32_t		groupby_prepfn_nbufs;
 	char		   *groupby_prepfn_buffer;
+	/*
+	 * Per-block local hash-slots to find the groups on the prepfn buffer
+	 * without walking on the global hash chain of kds_final.
+	 * Each slot packs (hash << 32 | rowid), or ULONG_MAX if empty.
+	 */
+	uint32_t		groupby_local_nslots;
+	uint64_t	   *groupby_local_hslots;
+	/*
+	 * Peer threads in the warp that update the same group; the handlers
+	 * reduce the values within the peers prior to the atomic operations.
+	 * Zero means no warp-level pre-reduction.
+	 */
+	uint32_t		groupby_warp_mask;
+	uint32_t		groupby_warp_peers;
+	/*
+	 * Extent on kds_final reserved for the items of STRING_AGG; @offset is
+	 * the offset of the @buffer from the tail of kds_final.
+	 */
+	char		   *groupby_accum_buffer;
+	uint64_t		groupby_accum_offset;
 
 	/*
 	 * mode control flags
@@ -623,12 +647,30 @@ struct kern_colmeta {
 	 * related data types, or precision in decimal data type.
 	 */
 	ArrowTypeOptions attopts;
+	/* zero @values_offset means the column is not cached (column format) */
 	uint32_t		nullmap_offset;
 	uint32_t		nullmap_length;
 	uint32_t		values_offset;
 	uint32_t		values_length;
 	uint32_t		extra_offset;
 	uint32_t		extra_length;
+	/*
+	 * (only column format)
+	 * If @for_unitsz > 0, integer values are stored using frame-of-reference
+	 * encoding; (value - @for_base) is saved as a signed integer with
+	 * @for_unitsz bytes width, instead of the @attlen bytes.
+	 */
+	int16_t			for_unitsz;
+	int64_t			for_base;
+	/*
+	 * (only arrow format)
+	 * If @dict_index_unitsz > 0, the column is dictionary encoded. @values
+	 * and @extra are the buffers of the dictionary, and the @dict_index
+	 * buffer keeps the signed integer index of the dictionary for each row.
+	 */
+	int16_t			dict_index_unitsz;
+	uint32_t		dict_index_offset;
+	uint32_t		dict_index_length;
 };
 typedef struct kern_colmeta		kern_colmeta;
 
@@ -1365,6 +1407,48 @@ KDS_ARROW_REF_SIMPLE_DATUM(const kern_data_store *kds,
 
 #define VARATT_MAX		0x4ffffff8U
 
+/*
+ * KDS_ARROW_DICT_INDEX - translate the row index to the dictionary index,
+ * if the column is dictionary encoded.
+ */
+INLINE_FUNCTION(bool)
+KDS_ARROW_DICT_INDEX(const kern_data_store *kds,
+					 const kern_colmeta *cmeta,
+					 uint32_t *p_index)
+{
+	uint32_t	unitsz = cmeta->dict_index_unitsz;
+	uint32_t	index = *p_index;
+	const char *base;
+	int64_t		code;
+
+	if (unitsz == 0)
+		return true;	/* not dictionary encoded */
+	if (unitsz * (index + 1) > __kds_unpack(cmeta->dict_index_length))
+		return false;
+	base = (const char *)kds + __kds_unpack(cmeta->dict_index_offset);
+	switch (unitsz)
+	{
+		case sizeof(int8_t):
+			code = ((const int8_t *)base)[index];
+			break;
+		case sizeof(int16_t):
+			code = ((const int16_t *)base)[index];
+			break;
+		case sizeof(int32_t):
+			code = ((const int32_t *)base)[index];
+			break;
+		case sizeof(int64_t):
+			code = ((const int64_t *)base)[index];
+			break;
+		default:
+			return false;
+	}
+	if (code < 0 || code >= 0xffffffffL)
+		return false;
+	*p_index = (uint32_t)code;
+	return true;
+}
+
 INLINE_FUNCTION(const void *)
 KDS_ARROW_REF_VARLENA32_DATUM(const kern_data_store *kds,
 							  const kern_colmeta *cmeta,
@@ -1373,6 +1457,8 @@ KDS_ARROW_REF_VARLENA32_DATUM(const kern_data_store *kds,
 {
 	Assert(cmeta->values_offset > 0 &&
 		   cmeta->extra_offset  > 0);
+	if (!KDS_ARROW_DICT_INDEX(kds, cmeta, &index))
+		return NULL;
 	/* NOTE: caller should already apply NULL-checks, so we don't check
 	 * it again. */
 	if (sizeof(uint32_t) * (index+1) <= __kds_unpack(cmeta->values_length))
@@ -1400,6 +1486,8 @@ KDS_ARROW_REF_VARLENA64_DATUM(const kern_data_store *kds,
 {
 	Assert(cmeta->values_offset > 0 &&
 		   cmeta->extra_offset  > 0);
+	if (!KDS_ARROW_DICT_INDEX(kds, cmeta, &index))
+		return NULL;
 	if (sizeof(uint32_t) * (index+1) <= __kds_unpack(cmeta->values_length))
 	{
 		const uint64_t *offset = (const uint64_t *)
@@ -1435,6 +1523,31 @@ KDS_COLUMN_ITEM_ISNULL(const kern_data_store *kds,
 	return (bitmap[idx] & mask) == 0;
 }
 
+INLINE_FUNCTION(int64_t)
+KDS_COLUMN_FOR_DECODE(const kern_colmeta *cmeta,
+					  const char *values,
+					  uint32_t rowid)
+{
+	int64_t		delta;
+
+	switch (cmeta->for_unitsz)
+	{
+		case sizeof(int8_t):
+			delta = ((const int8_t *)values)[rowid];
+			break;
+		case sizeof(int16_t):
+			delta = ((const int16_t *)values)[rowid];
+			break;
+		case sizeof(int32_t):
+			delta = ((const int32_t *)values)[rowid];
+			break;
+		default:
+			delta = ((const int64_t *)values)[rowid];
+			break;
+	}
+	return cmeta->for_base + delta;
+}
+
 /*
  * GpuCacheSysattr
  *
@@ -1787,6 +1900,17 @@ struct xpu_datum_operators {
 		.xpu_datum_comp       = xpu_##NAME##_datum_comp,			\
 	}
 
+/*
+ * xpu_varlena_decompress - decompress the inline compressed varlena
+ * (pglz or lz4) onto the kcxt buffer. External (toasted) varlena and
+ * values larger than the kcxt buffer raise CPU fallback.
+ */
+EXTERN_FUNCTION(bool)
+xpu_varlena_decompress(kern_context *kcxt,
+					   const char *addr,
+					   const char **p_value,
+					   int *p_length);
+
 #include "xpu_basetype.h"
 #include "xpu_numeric.h"
 #include "xpu_textlib.h"
@@ -2012,6 +2136,31 @@ typedef struct
  * Definition of device functions
  *
  * ---------------------------------------------------------------- */
+/*
+ * kern_saop_hashtable
+ *
+ * hash-table of the constant array elements for ScalarArrayOpAny; it is
+ * built by the host code and appended to the tail of kern_expression.
+ * @slots[] and @next of the items are 1-origin index, or 0 if none.
+ */
+typedef struct
+{
+	uint32_t	hash;
+	uint32_t	next;
+	uint32_t	offset;		/* offset from the array data pointer */
+} kern_saop_hashitem;
+
+typedef struct
+{
+	uint32_t	nslots;		/* power of 2 */
+	uint32_t	nitems;		/* number of non-null elements */
+	bool		has_nulls;	/* array contains NULL elements */
+	uint32_t	slots[1];
+} kern_saop_hashtable;
+
+#define KERN_SAOP_HASHITEMS(htab)				\
+	((kern_saop_hashitem *)((htab)->slots + (htab)->nslots))
+
 typedef struct kern_expression	kern_expression;
 #define XPU_PGFUNCTION_ARGS		kern_context *kcxt,				\
 								const kern_expression *kexp,	\
@@ -2119,10 +2268,16 @@ typedef bool  (*xpu_function_t)(XPU_PGFUNCTION_ARGS);
 #define KAGG_ACTION__PMAX_FP64		404		/* <int4>,<float8> - max value */
 #define KAGG_ACTION__PSUM_INT		501		/* <int8> - sum of values */
 #define KAGG_ACTION__PSUM_FP		503		/* <float8> - sum of values */
+#define KAGG_ACTION__PSUM_NUMERIC	504		/* <int4>x2,<int4>xN,<float8>,<int192>xN
+										 * - exact sum of numeric values */
 #define KAGG_ACTION__PAVG_INT		601		/* <int4>,<int8> - NROWS+PSUM */
 #define KAGG_ACTION__PAVG_FP		602		/* <int4>,<float8> - NROWS+PSUM */
+#define KAGG_ACTION__PAVG_NUMERIC	603		/* same as PSUM_NUMERIC */
 #define KAGG_ACTION__STDDEV			701		/* <int4>,<float8>,<float8> - stddev */
 #define KAGG_ACTION__COVAR			801		/* <int4>,<float8>x5 - covariance */
+#define KAGG_ACTION__HLL_SKETCH		901		/* <int4>,<uint8>x2^N - HLL registers */
+#define KAGG_ACTION__QUANTILE_SKETCH 1001	/* <int4>,<uint64>xN - log-bucket counters */
+#define KAGG_ACTION__STRING_AGG		1101	/* <int4>,<uint64>x2 - chain of the values */
 
 typedef struct
 {
@@ -2152,6 +2307,44 @@ typedef struct
 	float8_t	sum;
 } kagg_state__psum_fp_packed;
 
+/*
+ * Exact sum of numeric values
+ *
+ * Each group has KAGG_NUMERIC_NSLOTS fixed-point accumulators; a value is
+ * added to the slot with the same weight (number of fractional digits),
+ * or rescaled to a slot with larger weight. The first slot is usually
+ * pre-assigned at the scale of the numeric(p,s) typmod, so all the values
+ * go into the single slot in most cases.
+ * Values that cannot be accumulated exactly (no free slot, or too large
+ * to rescale) are added to 'fp_sum' with KAGG_NUMERIC_FLAG__INEXACT; the
+ * final function raises an error on such groups, instead of returning
+ * the rounded result.
+ */
+#define KAGG_NUMERIC_NSLOTS			4
+#define KAGG_NUMERIC_WEIGHT__UNUSED	INT_MIN
+#define KAGG_NUMERIC_FLAG__NAN		0x0001
+#define KAGG_NUMERIC_FLAG__POS_INF	0x0002
+#define KAGG_NUMERIC_FLAG__NEG_INF	0x0004
+#define KAGG_NUMERIC_FLAG__INEXACT	0x0008
+
+typedef struct
+{
+	uint64_t	lo;
+	uint64_t	mid;
+	int64_t		hi;
+} kagg_numeric_sum;				/* 192bit signed integer */
+
+typedef struct
+{
+	int32_t		vl_len_;
+	uint32_t	nitems;
+	uint32_t	flags;			/* KAGG_NUMERIC_FLAG__* */
+	int32_t		weights[KAGG_NUMERIC_NSLOTS];
+	uint32_t	__padding__;
+	float8_t	fp_sum;			/* sum of the values not in the slots */
+	kagg_numeric_sum sums[KAGG_NUMERIC_NSLOTS];
+} kagg_state__psum_numeric_packed;
+
 typedef struct
 {
 	int32_t		vl_len_;
@@ -2171,11 +2364,94 @@ typedef struct
 	float8_t	sum_xy;
 } kagg_state__covar_packed;
 
+/*
+ * HLL sketch; it is also the binary format of the hll_sketch() output,
+ * so sketches built by the device and the host can be merged each other.
+ */
+typedef struct
+{
+	int32_t		vl_len_;
+	uint32_t	nrooms;			/* number of the registers (= 2^N) */
+	uint8_t		regs[1];		/* HLL registers */
+} kagg_state__hll_sketch_packed;
+
+#define KAGG_STATE__HLL_SKETCH_SZ(nbits)						\
+	(offsetof(kagg_state__hll_sketch_packed, regs) + (1U << (nbits)))
+
+/*
+ * Quantile sketch; it is a histogram of logarithmic buckets with relative
+ * accuracy (same idea as DDSketch). A bucket 'k' covers the magnitude of
+ * (MIN * gamma^k, MIN * gamma^(k+1)], so the value estimated by the bucket
+ * has at most 2% relative error. Its update is an increment of a counter,
+ * and merge is an addition of the counters; both are atomic operations
+ * without any sorting or compaction, thus suitable for the device.
+ * Magnitudes less than MIN are counted as zero, and the ones beyond the
+ * last bucket are clamped.
+ * The counters are ordered by the value; negative buckets in descending
+ * order of the magnitude, zero, positive buckets, then NaN.
+ * It is also the binary format of the quantile_sketch() output.
+ */
+#define KAGG_QSKETCH_NBUCKETS		1024	/* number of buckets per sign */
+#define KAGG_QSKETCH_NCOUNTERS		(2 * KAGG_QSKETCH_NBUCKETS + 2)
+#define KAGG_QSKETCH_LOG_GAMMA		0.04000533461369913	/* log(1.02/0.98) */
+#define KAGG_QSKETCH_MIN_VALUE		1.0e-6
+
+typedef struct
+{
+	int32_t		vl_len_;
+	uint32_t	ncounters;		/* = KAGG_QSKETCH_NCOUNTERS */
+	uint64_t	counts[1];		/* number of the values in the bucket */
+} kagg_state__quantile_sketch_packed;
+
+#define KAGG_STATE__QUANTILE_SKETCH_SZ							\
+	(offsetof(kagg_state__quantile_sketch_packed, counts) +		\
+	 sizeof(uint64_t) * KAGG_QSKETCH_NCOUNTERS)
+
+/*
+ * Accumulation of varlena values (STRING_AGG)
+ *
+ * On the device, the per-group state has a fixed length, and each value is
+ * written to an item allocated from the tail of kds_final, then chained from
+ * the state. @head and @tail are offsets of the newest and the oldest items
+ * from the tail of kds_final, as row-index doing.
+ * The host flattens the chain when it fetches the tuple from kds_final; the
+ * flat state has zero @head and @tail, and the items follow the header.
+ * Each item contains the delimiter and the value, and the delimiter of the
+ * first item is ignored on the final aggregation.
+ */
+typedef struct
+{
+	uint64_t	next;			/* offset of the next (older) item, or 0 */
+	uint32_t	dlen;			/* length of the delimiter */
+	uint32_t	vlen;			/* length of the value */
+	char		data[1];		/* delimiter, then value */
+} kagg_string_agg_item;
+
+#define KAGG_STRING_AGG_ITEM_SZ(dlen,vlen)					\
+	MAXALIGN(offsetof(kagg_string_agg_item, data) + (dlen) + (vlen))
+
+typedef struct
+{
+	int32_t		vl_len_;
+	uint32_t	nitems;			/* number of the accumulated values */
+	uint64_t	head;			/* newest item on kds_final, or 0 */
+	uint64_t	tail;			/* oldest item on kds_final, or 0 */
+	char		data[1];		/* items, if flat */
+} kagg_state__string_agg_packed;
+
+#define KAGG_STATE__STRING_AGG_SZ							\
+	offsetof(kagg_state__string_agg_packed, data)
+
 typedef struct
 {
 	uint32_t	action;			/* any of KAGG_ACTION__* */
 	int32_t		arg0_slot_id;
 	int32_t		arg1_slot_id;
+	int32_t		hll_nbits;		/* width of the register selector,
+								 * if KAGG_ACTION__HLL_SKETCH */
+	int32_t		num_weight;		/* weight of the first slot, or
+								 * KAGG_NUMERIC_WEIGHT__UNUSED,
+								 * if KAGG_ACTION__P(SUM|AVG)_NUMERIC */
 } kern_aggregate_desc;
 
 typedef struct
@@ -2194,6 +2470,46 @@ typedef struct
 								 */
 } kern_varmove_desc;
 
+/*
+ * JsonbObjectFields fetches multiple fields of the same jsonb object at once,
+ * then saves them on the kvars-slot. The first one is also the result.
+ */
+#define KERN_JSONB_OBJECT_FIELDS_MAX	32
+typedef struct
+{
+	int16_t		jf_slot_id;		/* slot-id to save the field value */
+	bool		jf_as_text;		/* true, if jsonb->>KEY; elsewhere jsonb->KEY */
+} kern_jsonb_field_desc;
+
+/*
+ * SimpleExpr evaluates a small tree of integer arithmetic / comparison
+ * operators as a flat postfix program, without recursive invocation of
+ * the sub-expressions for each operator.
+ */
+#define KERN_SIMPLE_EXPR_MAX_STEPS		32
+#define KERN_SIMPLE_EXPR_MAX_DEPTH		8
+
+#define SimpleExprOp__Var		1
+#define SimpleExprOp__Const		2
+#define SimpleExprOp__Add		3
+#define SimpleExprOp__Sub		4
+#define SimpleExprOp__Mul		5
+#define SimpleExprOp__Eq		6
+#define SimpleExprOp__Ne		7
+#define SimpleExprOp__Lt		8
+#define SimpleExprOp__Le		9
+#define SimpleExprOp__Gt		10
+#define SimpleExprOp__Ge		11
+
+typedef struct
+{
+	uint8_t		se_op;			/* one of SimpleExprOp__* */
+	uint8_t		se_type_code;	/* TypeOpCode of the (result) value */
+	int16_t		se_slot_id;		/* Var: source slot-id */
+	int32_t		se_var_offset;	/* Var: kvecs-offset, or -1 for kvars-slot */
+	int64_t		se_value;		/* Const: value */
+} kern_simple_expr_step;
+
 struct kern_varslot_desc
 {
 	TypeOpCode	vs_type_code;
@@ -2209,6 +2525,9 @@ struct kern_varslot_desc
 #define KERN_EXPRESSION_MAGIC			(0x4b657870)	/* 'K' 'e' 'x' 'p' */
 
 #define KEXP_FLAG__IS_PUSHED_DOWN		0x0001U
+#define KEXP_FLAG__NUMERIC_INT64		0x0002U	/* numeric arguments are bounded
+												 * by typmod, so they are likely
+												 * fit to scaled int64 */
 
 #define SPECIAL_DEPTH__PREAGG_FINAL		(-2)
 
@@ -2251,6 +2570,7 @@ struct kern_expression
 		} casewhen;	/* Case-When */
 		struct {
 			uint16_t	elem_slot_id;	/* slot-id of temporary array element */
+			uint32_t	hash_offset;	/* offset to kern_saop_hashtable, if any */
 			char		data[1]			__MAXALIGNED__;
 		} saop;		/* ScalarArrayOp */
 		struct {
@@ -2283,6 +2603,14 @@ struct kern_expression
 			int			nattrs;
 			uint16_t	slot_id[1];
 		} proj;		/* Projection */
+		struct {
+			int			nfields;
+			kern_jsonb_field_desc desc[1];
+		} jfields;	/* JsonbObjectFields */
+		struct {
+			int			nsteps;
+			kern_simple_expr_step steps[1];
+		} simple;	/* SimpleExpr */
 		struct {
 			uint32_t	npacked;	/* number of packed sub-expressions; including
 									 * logical NULLs (npacked may be larger than
@@ -2292,8 +2620,16 @@ struct kern_expression
 	} u;
 };
 
+#ifdef PGSTROM_JIT_SPECIALIZED
+/* session specialized build; see pgstrom_jit_exec_expression() */
+EXTERN_FUNCTION(bool)
+pgstrom_jit_exec_expression(XPU_PGFUNCTION_ARGS);
+#define EXEC_KERN_EXPRESSION(__kcxt,__kexp,__retval)	\
+	pgstrom_jit_exec_expression((__kcxt),(__kexp),(xpu_datum_t *)__retval)
+#else
 #define EXEC_KERN_EXPRESSION(__kcxt,__kexp,__retval)	\
 	(__kexp)->fn_dptr((__kcxt),(__kexp),(xpu_datum_t *)__retval)
+#endif
 
 INLINE_FUNCTION(bool)
 __KEXP_IS_VALID(const kern_expression *kexp,
@@ -2363,8 +2699,11 @@ typedef struct
 #define XpuCommandTag__Success				0
 #define XpuCommandTag__Error				1
 #define XpuCommandTag__CPUFallback			2
+#define XpuCommandTag__SuccessPartial		3
 #define XpuCommandTag__SuccessFinal			50
 #define XpuCommandTag__OpenSession			100
+#define XpuCommandTag__ResetSession			101
+#define XpuCommandTag__ServerStats			102
 #define XpuCommandTag__XpuTaskExec			110
 #define XpuCommandTag__XpuTaskExecGpuCache	111
 #define XpuCommandTag__XpuTaskFinal			119
@@ -2385,6 +2724,9 @@ typedef struct kern_session_info
 	uint32_t	kcxt_extra_bufsz;	/* length of vlbuf[] */
 	uint32_t	cuda_stack_size;	/* estimated stack size */
 	uint32_t	xpu_task_flags;		/* mask of device flags */
+	uint32_t	xpu_task_priority;	/* weight of fair-share scheduling */
+	uint32_t	gpumem_limit_mb;	/* device memory budget (0 = unlimited) */
+	bool		compress_results;	/* results may be sent back LZ4 compressed */
 	/* xpucode for this session */
 	uint32_t	xpucode_load_vars_packed;
 	uint32_t	xpucode_move_vars_packed;
@@ -2392,6 +2734,7 @@ typedef struct kern_session_info
 	uint32_t	xpucode_join_quals_packed;
 	uint32_t	xpucode_hash_values_packed;
 	uint32_t	xpucode_gist_evals_packed;
+	uint32_t	xpucode_range_keys_packed;
 	uint32_t	xpucode_projection;
 	uint32_t	xpucode_groupby_keyhash;
 	uint32_t	xpucode_groupby_keyload;
@@ -2411,16 +2754,40 @@ typedef struct kern_session_info
 	uint32_t	pgsql_port_number;	/* = PostPortNumber */
 	uint32_t	pgsql_plan_node_id;	/* = Plan->plan_node_id */
 	uint32_t	join_inner_handle;	/* key of join inner buffer */
+	uint32_t	result_ring_handle;	/* key of result ring buffer, if any */
 
 	/* group-by final buffer */
 	uint32_t	groupby_kds_final;	/* header portion of kds_final */
 	uint32_t	groupby_prepfn_bufsz; /* buffer size for preagg functions */
 	float4_t	groupby_ngroups_estimation; /* planne's estimation of ngroups */
+	bool		groupby_final_mode;	/* no partial groups shall be written back */
+	/* GPU Top-N selection / GPU Sort */
+	uint32_t	topk_nitems;		/* LIMIT + OFFSET, or 0 if not used */
+	uint32_t	limit_nitems;		/* LIMIT + OFFSET without ORDER BY, or 0 */
+	int16_t		sortkey_resno;		/* attribute number of the sort key */
+	int16_t		sortkey_flags;		/* KERN_SORTKEY__* flags */
+	int16_t		sortkey2_resno;		/* attribute number of the 2nd key, or 0 */
+	int16_t		sortkey2_flags;		/* KERN_SORTKEY__* flags of the 2nd key */
+	bool		gpusort_chunks;		/* sort kds_dst by the sort key */
+	/* results are packed to KDS_FORMAT_COLUMN prior to write-back */
+	bool		columnar_results;
+	/* static portion; kept by GPU-service per connection */
+	uint64_t	session_cache_key;	/* hash of the static portion, or 0 */
+	uint32_t	session_cache_offset; /* offset of the static portion */
+	uint32_t	session_cache_length; /* length of the static portion */
+	bool		session_cache_omitted; /* static portion is not sent */
 	/* executor parameter buffer */
 	uint32_t	nparams;	/* number of parameters */
 	uint32_t	poffset[1];	/* offset of params */
 } kern_session_info;
 
+/*
+ * Number of the static portion of kern_session_info kept per connection.
+ * Both of the backend and GPU-service replace the entry with the same key,
+ * or the oldest one, so they always have the same set of the entries.
+ */
+#define KERN_SESSION_CACHE_NSLOTS	4
+
 typedef struct {
 	uint32_t	kds_src_pathname;	/* offset to const char *pathname */
 	uint32_t	kds_src_iovec;		/* offset to strom_io_vector */
@@ -2435,11 +2802,46 @@ typedef struct {
 	char		data[1]				__MAXALIGNED__;
 } kern_final_task;
 
+/*
+ * XPU_EXEC_PATH__* - optional execution paths taken by the xPU tasks.
+ * xPU service reports the paths taken by each task in kern_exec_results,
+ * and the backend also records the paths taken on its side, then EXPLAIN
+ * ANALYZE shows them.
+ */
+#define XPU_EXEC_PATH__MULTI_GPU		(1U<<0)	/* chunks split to multiple GPUs */
+#define XPU_EXEC_PATH__GRID_TUNING		(1U<<1)	/* grid size reduced by the tuner */
+#define XPU_EXEC_PATH__RESULT_RING		(1U<<2)	/* results in the shared memory ring */
+#define XPU_EXEC_PATH__JIT_MODULE		(1U<<3)	/* session specialized module */
+#define XPU_EXEC_PATH__DEVICE_MEMORY	(1U<<4)	/* source chunk copied to the device memory */
+#define XPU_EXEC_PATH__SHARED_INNER		(1U<<5)	/* inner buffer shared with other query */
+#define XPU_EXEC_PATH__POOLED_CONN		(1U<<6)	/* connection kept by the previous session */
+#define XPU_EXEC_PATH__INFLIGHT_WINDOW	(1U<<7)	/* commands in flight beyond max_async_tasks */
+#define XPU_EXEC_PATH__PARALLEL_FALLBACK	(1U<<8)	/* fallback chunk queued for the other processes */
+#define XPU_EXEC_PATH__READ_AHEAD		(1U<<9)	/* blocks of the next chunks prefetched */
+#define XPU_EXEC_PATH__MULTI_CHUNK_CLAIM	(1U<<10)	/* multiple chunks reserved at once */
+#define XPU_EXEC_PATH__VFS_FALLBACK		(1U<<11)	/* pages read through the VFS fallback */
+#define XPU_EXEC_PATH__DMA_POOL			(1U<<12)	/* VFS fallback on the preallocated DMA buffer */
+#define XPU_EXEC_PATH__HASH_BUCKETIZED	(1U<<13)	/* bucketized index of the inner hash table */
+#define XPU_EXEC_PATH__GPU_HASH_BUILD	(1U<<14)	/* inner hash table built by GPU */
+#define XPU_EXEC_PATH__BLOOM_FILTER		(1U<<15)	/* bloom-filter of the inner hash-keys */
+#define XPU_EXEC_PATH__HASH_SKEW		(1U<<16)	/* heavy-hitters of the inner hash-keys */
+#define XPU_EXEC_PATH__CACHED_INNER		(1U<<17)	/* idle inner buffer revived */
+#define XPU_EXEC_PATH__COLUMNAR_RESULTS	(1U<<18)	/* results sent back in columnar format */
+#define XPU_EXEC_PATH__HOST_MAPPED_INNER	(1U<<19)	/* inner buffer on the host-mapped memory */
+#define XPU_EXEC_PATH__KERNEL_YIELD		(1U<<20)	/* kernel yielded SMs by the time-slice */
+#define XPU_EXEC_PATH__BLOCK_FORMAT		(1U<<21)	/* heap pages copied from the shared-buffer */
+#define XPU_EXEC_PATH__SHARED_SCAN		(1U<<22)	/* source chunk loaded by other scans */
+#define XPU_EXEC_PATH__PEER_INNER		(1U<<23)	/* inner buffer on the peer GPU */
+
 typedef struct {
 	uint32_t	chunks_offset;		/* offset of kds_dst array */
 	uint32_t	chunks_nitems;		/* number of kds_dst items */
+	uint32_t	chunks_rawsize;		/* length of kds_dst array prior to LZ4
+									 * compression, or 0 if not compressed */
 	uint32_t	ojmap_offset;		/* offset of outer-join-map */
 	uint32_t	ojmap_length;		/* length of outer-join-map */
+	uint64_t	chunks_ring_offset;	/* offset of kds_dst array in the result
+									 * ring, instead of chunks_offset */
 	kern_final_task kfin;			/* copy from XpuTaskFinal if any */
 	bool		final_plan_node;
 	bool		final_this_device;
@@ -2449,6 +2851,13 @@ typedef struct {
 	uint32_t	nitems_raw;		/* # of visible rows kept in the relation */
 	uint32_t	nitems_in;		/* # of result rows in depth-0 after WHERE-clause */
 	uint32_t	nitems_out;		/* # of result rows in final depth before host quals */
+	uint32_t	exec_paths;		/* mask of XPU_EXEC_PATH__* taken by the task */
+	/* timestamps of the task processing (CLOCK_MONOTONIC in us), if non-zero */
+	uint64_t	ts_enqueue;		/* command is received */
+	uint64_t	ts_dequeue;		/* command is picked up by a worker */
+	uint64_t	ts_io_done;		/* kds_src is loaded */
+	uint64_t	ts_kernel_done;	/* kernel execution is completed */
+	uint64_t	ts_write_back;	/* results are sent back */
 	uint32_t	num_rels;
 	struct {
 		uint32_t	nitems_gist;/* # of results rows by GiST index (if any) */
@@ -2456,6 +2865,51 @@ typedef struct {
 	} stats[1];
 } kern_exec_results;
 
+/*
+ * kern_result_ring - shared memory ring buffer for the results
+ *
+ * If session->result_ring_handle is valid, GPU-service copies the results
+ * into the ring buffer (registered as pinned memory), then sends back only
+ * the response header with chunks_ring_offset. Backend marks the block as
+ * released once it consumed the results, and GPU-service reuses the space.
+ */
+#define KERN_RESULT_RING_ALIGN		16
+
+typedef struct {
+	uint64_t	length;		/* length of the ring buffer (incl. header) */
+	uint64_t	__padding;
+	char		data[1]		__attribute__((aligned(KERN_RESULT_RING_ALIGN)));
+} kern_result_ring;
+
+typedef struct {
+	volatile uint32_t released;	/* set by the backend */
+	uint32_t	__padding;
+	uint64_t	length;		/* length of this block (incl. header) */
+	char		data[1]		__attribute__((aligned(KERN_RESULT_RING_ALIGN)));
+} kern_result_ring_block;
+
+/*
+ * kern_server_stats - statistics of the xPU service (ServerStats response)
+ *
+ * latency_hist[] counts the commands by their processing time; the i-th
+ * bucket is less than 2^i microseconds, and the last one is unlimited.
+ */
+#define XPU_STATS_CMD__OPEN_SESSION		0
+#define XPU_STATS_CMD__TASK_EXEC		1
+#define XPU_STATS_CMD__TASK_FINAL		2
+#define XPU_STATS_NUM_COMMANDS			3
+#define XPU_STATS_LATENCY_NBUCKETS		24
+
+typedef struct
+{
+	uint32_t	nr_sessions;		/* # of active sessions */
+	uint32_t	nr_queued;			/* # of commands in the queues */
+	uint64_t	bytes_read;			/* bytes read from the storage */
+	uint64_t	nitems_raw;			/* # of rows scanned */
+	uint64_t	nitems_in;			/* # of rows after the scan_quals */
+	uint64_t	latency_hist[XPU_STATS_NUM_COMMANDS][XPU_STATS_LATENCY_NBUCKETS];
+} kern_server_stats;
+
 typedef struct
 {
 	kern_errorbuf		error;		/* original error in kernel space */
@@ -2491,6 +2945,7 @@ typedef struct
 		kern_final_task		fin;
 		kern_exec_results	results;
 		kern_cpu_fallback	fallback;
+		kern_server_stats	stats;
 	} u;
 } XpuCommand;
 
@@ -2622,6 +3077,20 @@ SESSION_KEXP_GIST_EVALS(const kern_session_info *session, int depth)
 	return karg;
 }
 
+INLINE_FUNCTION(kern_expression *)
+SESSION_KEXP_RANGE_KEY(const kern_session_info *session, int depth)
+{
+	kern_expression *kexp;
+
+	if (session->xpucode_range_keys_packed == 0)
+		return NULL;
+	kexp = (kern_expression *)
+		((char *)session + session->xpucode_range_keys_packed);
+	if (depth < 0)
+		return kexp;
+	return __PICKUP_PACKED_KEXP(kexp, depth);
+}
+
 INLINE_FUNCTION(kern_expression *)
 SESSION_KEXP_PROJECTION(const kern_session_info *session)
 {
@@ -2919,6 +3388,12 @@ ExecGiSTIndexGetNext(kern_context *kcxt,
 					 const kern_data_store *kds_gist,
 					 const kern_expression *kexp_gist,
 					 uint64_t l_state);
+EXTERN_FUNCTION(uint64_t)
+ExecGiSTRTreeGetNext(kern_context *kcxt,
+					 const kern_data_store *kds_hash,
+					 const struct kern_gist_rtree *rtree,
+					 const kern_expression *kexp_gist,
+					 uint64_t l_state);
 EXTERN_FUNCTION(bool)
 ExecGiSTIndexPostQuals(kern_context *kcxt,
 					   int depth,
@@ -2946,6 +3421,7 @@ ExecKernProjection(kern_context *kcxt,
 #define DEVONLY_FUNC_OPCODE(a,NAME,b,c,d)	\
 	EXTERN_DATA bool pgfn_##NAME(XPU_PGFUNCTION_ARGS);
 #include "xpu_opcodes.h"
+EXTERN_DATA bool pgfn_JsonbObjectFields(XPU_PGFUNCTION_ARGS);
 
 /* ----------------------------------------------------------------
  *
@@ -2963,6 +3439,162 @@ pg_hash_merge(uint32_t hash_prev, uint32_t hash_next)
 	return ((hash_prev >> 3) | (hash_prev << 29)) ^ hash_next;
 }
 
+/*
+ * Hash function of HyperLogLog based on SipHash-2-4
+ *
+ * See https://en.wikipedia.org/wiki/SipHash
+ *     and https://github.com/veorq/SipHash
+ *
+ * It is shared by the host and device code, because the HLL sketch built
+ * by GpuPreAgg is merged with the one by CPU (fallback or final merge).
+ */
+#define __HLL_ROTL(x, b)	(uint64_t)(((x) << (b)) | ((x) >> (64 - (b))))
+#define __HLL_SIPROUND							\
+	do {										\
+		v0 += v1;								\
+		v1 = __HLL_ROTL(v1, 13);				\
+		v1 ^= v0;								\
+		v0 = __HLL_ROTL(v0, 32);				\
+		v2 += v3;								\
+		v3 = __HLL_ROTL(v3, 16);				\
+		v3 ^= v2;								\
+		v0 += v3;								\
+		v3 = __HLL_ROTL(v3, 21);				\
+		v3 ^= v0;								\
+		v2 += v1;								\
+		v1 = __HLL_ROTL(v1, 17);				\
+		v1 ^= v2;								\
+		v2 = __HLL_ROTL(v2, 32);				\
+	} while(0)
+
+INLINE_FUNCTION(uint64_t)
+pg_hll_siphash_value(const void *ptr, uint32_t len)
+{
+	const char *pos = (const char *)ptr;
+	const char *end = pos + len - (len & 7);
+	uint64_t	v0 = 0x736f6d6570736575UL;
+	uint64_t	v1 = 0x646f72616e646f6dUL;
+	uint64_t	v2 = 0x6c7967656e657261UL;
+	uint64_t	v3 = 0x7465646279746573UL;
+	uint64_t	k0 = 0x9c38151cda15a76bUL;	/* random key-0 */
+	uint64_t	k1 = 0xfb4ff68fbd3e6658UL;	/* random key-1 */
+	uint64_t	b = ((uint64_t)len) << 56;
+	uint64_t	m;
+
+	v3 ^= k1;
+	v2 ^= k0;
+	v1 ^= k1;
+	v0 ^= k0;
+	for (; pos != end; pos += sizeof(uint64_t))
+	{
+		memcpy(&m, pos, sizeof(uint64_t));	/* may be unaligned */
+		v3 ^= m;
+		__HLL_SIPROUND;
+		__HLL_SIPROUND;
+		v0 ^= m;
+	}
+	if ((len & 7) != 0)
+	{
+		m = 0;
+		memcpy(&m, pos, (len & 7));
+		b |= m;
+	}
+	v3 ^= b;
+	__HLL_SIPROUND;
+	__HLL_SIPROUND;
+	v0 ^= b;
+	v2 ^= 0xff;
+	__HLL_SIPROUND;
+	__HLL_SIPROUND;
+	__HLL_SIPROUND;
+	__HLL_SIPROUND;
+
+	return (v0 ^ v1 ^ v2 ^ v3);
+}
+#undef __HLL_SIPROUND
+#undef __HLL_ROTL
+
+/*
+ * pg_hll_hash_numeric
+ *
+ * '1.0' and '1.00' must have an identical hash value, so trailing zeros
+ * below the decimal point are removed prior to the hash calculation.
+ */
+INLINE_FUNCTION(uint64_t)
+pg_hll_hash_numeric(const xpu_numeric_t *num)
+{
+	struct {
+		int128_t	value;
+		int16_t		weight;
+	} __attribute__((packed)) temp;
+
+	assert(num->kind != XPU_NUMERIC_KIND__VARLENA);
+	if (num->kind != XPU_NUMERIC_KIND__VALID)
+		return pg_hll_siphash_value(&num->kind, sizeof(uint8_t));
+	temp.value  = num->u.value;
+	temp.weight = num->weight;
+	if (temp.value == 0)
+		temp.weight = 0;
+	else
+	{
+		while (temp.weight > 0 && temp.value % 10 == 0)
+		{
+			temp.value /= 10;
+			temp.weight--;
+		}
+	}
+	return pg_hll_siphash_value(&temp, sizeof(temp));
+}
+
+/*
+ * pg_hll_register_position
+ *
+ * The low N bits of the hash choose the register, then the register keeps
+ * the maximum position of the lowest 1-bit of the remaining bits.
+ */
+INLINE_FUNCTION(void)
+pg_hll_register_position(uint64_t hash, uint32_t nbits,
+						 uint32_t *p_index, uint32_t *p_count)
+{
+	uint64_t	rest = (hash >> nbits);
+
+	*p_index = (hash & ((1UL << nbits) - 1));
+	if (rest == 0)
+		*p_count = 64 - nbits + 1;
+	else
+#ifdef __CUDACC__
+		*p_count = __ffsll(rest);
+#else
+		*p_count = __builtin_ffsll(rest);
+#endif
+}
+
+/*
+ * pg_quantile_sketch_index
+ *
+ * It returns the index of the quantile sketch counter for the value.
+ */
+INLINE_FUNCTION(uint32_t)
+pg_quantile_sketch_index(float8_t fval)
+{
+	float8_t	aval = fabs(fval);
+	float8_t	lval;
+	int32_t		k;
+
+	if (isnan(fval))
+		return KAGG_QSKETCH_NCOUNTERS - 1;	/* NaN is larger than any others */
+	if (aval <= KAGG_QSKETCH_MIN_VALUE)
+		return KAGG_QSKETCH_NBUCKETS;		/* zero */
+	lval = ceil(log(aval / KAGG_QSKETCH_MIN_VALUE) / KAGG_QSKETCH_LOG_GAMMA);
+	if (!(lval < (float8_t)KAGG_QSKETCH_NBUCKETS))
+		k = KAGG_QSKETCH_NBUCKETS - 1;		/* also infinity */
+	else
+		k = Max((int32_t)lval - 1, 0);
+	if (fval < 0.0)
+		return KAGG_QSKETCH_NBUCKETS - 1 - k;
+	return KAGG_QSKETCH_NBUCKETS + 1 + k;
+}
+
 /* ----------------------------------------------------------------
  *
  * Definitions for xPU JOIN
@@ -2973,18 +3605,313 @@ struct kern_multirels
 {
 	size_t		length;
 	uint32_t	num_rels;
+	uint64_t	geom_index_offset;	/* offset to kern_geom_index, if any */
+	uint64_t	geom_index_length;	/* length of the region for geometry index */
 	struct
 	{
 		uint64_t	kds_offset;		/* offset to KDS */
 		uint64_t	ojmap_offset;	/* offset to outer-join map, if any */
 		uint64_t	gist_offset;	/* offset to GiST-index pages, if any */
+		bool		gist_rtree;		/* true, if GiST-index pages are replaced
+									 * by the packed R-tree */
 		bool		is_nestloop;	/* true, if NestLoop */
 		bool		left_outer;		/* true, if JOIN_LEFT or JOIN_FULL */
 		bool		right_outer;	/* true, if JOIN_RIGHT or JOIN_FULL */
+		bool		semi_join;		/* true, if JOIN_SEMI */
+		bool		anti_join;		/* true, if JOIN_ANTI */
+		bool		hash_gpu_build;	/* true, if hash table is built by GPU */
+		uint32_t	hash_nparts;	/* # of partitions, if grace hash-join */
+		uint32_t	hash_partid;	/* partition currently loaded */
+		uint32_t	hash_nbuckets;	/* # of buckets, if bucketized hash */
+		uint64_t	hash_bucket_offset;	/* offset to the bucket array, if any */
+		uint32_t	bloom_nblocks;	/* # of blocks of the bloom-filter */
+		uint64_t	bloom_offset;	/* offset to the bloom-filter, if any */
+		uint32_t	hash_nskews;	/* # of heavy-hitter keys, if any */
+		uint64_t	hash_skew_offset; /* offset to the heavy-hitter array */
+		uint64_t	range_keys_offset; /* offset to the sorted keys, if range-join */
+		uint64_t	range_nulls_offset; /* offset to the null-map (host only) */
+		uint32_t	range_nnulls;	/* # of NULL keys at head of the row-index */
+		bool		range_desc;		/* true, if keys are sorted in descending */
+		bool		range_inclusive; /* true, if the key equal to outer matches */
+		double		range_grid_distance; /* cell size, if grid-join on st_dwithin */
+		double		range_grid_extent; /* max half-extent of the inner geometries */
 	} chunks[1];
 };
 typedef struct kern_multirels	kern_multirels;
 
+/*
+ * kern_gist_rtree - packed R-tree for GiST-Join
+ *
+ * The host rebuilds the leaf keys (box2df) of the GiST-index pages into
+ * a packed R-tree by sort-tile-recursive, after the inner tuples are loaded.
+ * Leaf entries point the inner tuples on the kds_hash directly, and the
+ * entries that have no inner tuples (invisible, or filtered out) are not
+ * included, so no relinking is needed on the device.
+ * Nodes are stored from the leaf level, so the root is the last node, and
+ * the entry-id (node_id * KERN_GIST_RTREE_FANOUT + index) identifies
+ * the position to resume the tree scan.
+ */
+#define KERN_GIST_RTREE_FANOUT		32
+typedef struct
+{
+	uint32_t	nitems;			/* number of valid entries */
+	uint32_t	parent;			/* entry-id on the parent node, or UINT_MAX
+								 * if root node */
+	geom_bbox_2d keys[KERN_GIST_RTREE_FANOUT];
+	uint32_t	values[KERN_GIST_RTREE_FANOUT];	/* node-id of the child, or
+												 * packed offset of the inner
+												 * tuple on the leaf node */
+} kern_gist_rtree_node;
+
+typedef struct kern_gist_rtree
+{
+	uint32_t	nnodes;			/* number of nodes; 0 if empty */
+	uint32_t	nleaf_nodes;	/* node_id < nleaf_nodes are leaf nodes */
+	uint64_t	__padding__;
+	kern_gist_rtree_node nodes[1];
+} kern_gist_rtree;
+
+/*
+ * KERN_HASH_PARTITION - partition-id of the hash value on grace hash-join.
+ * It picks up the upper bits, not to correlate with the hash-slot index.
+ */
+INLINE_FUNCTION(uint32_t)
+KERN_HASH_PARTITION(uint32_t hash, uint32_t nparts)
+{
+	return (uint32_t)(((uint64_t)hash * (uint64_t)nparts) >> 32);
+}
+
+/*
+ * kern_hashbucket - an optional index of the inner hash table for GpuHashJoin
+ *
+ * It is an open-addressing hash table with linear probing on the unit of
+ * 128-bytes bucket (= one cache line of GPU). Each bucket packs 16 hash
+ * values as tags, and 16 offsets of the kern_hashitem from the tail of KDS
+ * in MAXALIGN unit (0 means empty slot). A lookup fetches one bucket with
+ * a coalesced load, then compares the join-keys only on tag-match.
+ * Once a bucket has an empty slot, no items overflow to the next bucket,
+ * so it also terminates the probe.
+ * The hash-chain of KDS_FORMAT_HASH is still built for the CPU-fallback.
+ */
+#define KERN_HASHBUCKET_NSLOTS		16
+typedef struct
+{
+	uint32_t	tags[KERN_HASHBUCKET_NSLOTS];
+	uint32_t	items[KERN_HASHBUCKET_NSLOTS];
+} kern_hashbucket;
+
+/* average fill-factor per bucket on construction */
+#define KERN_HASHBUCKET_FILL		12
+
+INLINE_FUNCTION(kern_hashbucket *)
+KERN_MULTIRELS_HASH_BUCKETS(kern_multirels *kmrels, int dindex)
+{
+	uint64_t	offset;
+
+	assert(dindex >= 0 && dindex < kmrels->num_rels);
+	offset = kmrels->chunks[dindex].hash_bucket_offset;
+	return (kern_hashbucket *)(offset == 0 ? NULL : ((char *)kmrels + offset));
+}
+
+/*
+ * KERN_HASHBUCKET_LOOKUP
+ *
+ * It looks up the next item that has the 'hash' from the position '*p_pos'
+ * (bucket-index * KERN_HASHBUCKET_NSLOTS + slot), then updates '*p_pos' to
+ * the position of the item found.
+ */
+INLINE_FUNCTION(kern_hashitem *)
+KERN_HASHBUCKET_LOOKUP(const kern_data_store *kds,
+					   const kern_hashbucket *buckets,
+					   uint32_t nbuckets,
+					   uint32_t hash,
+					   uint64_t *p_pos)
+{
+	uint64_t	pos = *p_pos;
+	uint64_t	nloops = 0;
+
+	while (nloops++ < nbuckets)
+	{
+		uint32_t	bindex = (pos / KERN_HASHBUCKET_NSLOTS) % nbuckets;
+		const kern_hashbucket *bucket = &buckets[bindex];
+
+		for (int k = pos % KERN_HASHBUCKET_NSLOTS;
+			 k < KERN_HASHBUCKET_NSLOTS; k++)
+		{
+			uint32_t	item = __volatileRead(&bucket->items[k]);
+
+			if (item == 0)
+				return NULL;		/* end of the probe */
+			if (__volatileRead(&bucket->tags[k]) == hash)
+			{
+				*p_pos = (uint64_t)bindex * KERN_HASHBUCKET_NSLOTS + k;
+				return (kern_hashitem *)((char *)kds + kds->length -
+										 (uint64_t)item * MAXIMUM_ALIGNOF);
+			}
+		}
+		pos = (uint64_t)(bindex + 1) * KERN_HASHBUCKET_NSLOTS;
+	}
+	return NULL;
+}
+
+/*
+ * Blocked bloom-filter of the inner hash-keys
+ *
+ * Each 256bits block (8 x uint32) is chosen by the hash value, then 4 bits
+ * in the block are set by the remixed hash value. So, a probe touches only
+ * one 32-bytes sector of the memory.
+ */
+#define KERN_BLOOM_BLOCK_NWORDS		8
+#define KERN_BLOOM_BITS_PER_KEY		16
+
+INLINE_FUNCTION(uint32_t *)
+KERN_MULTIRELS_BLOOM_FILTER(kern_multirels *kmrels, int dindex)
+{
+	uint64_t	offset;
+
+	assert(dindex >= 0 && dindex < kmrels->num_rels);
+	offset = kmrels->chunks[dindex].bloom_offset;
+	return (uint32_t *)(offset == 0 ? NULL : ((char *)kmrels + offset));
+}
+
+INLINE_FUNCTION(uint32_t)
+__kern_bloom_remix(uint32_t hash)
+{
+	hash ^= (hash >> 16);
+	hash *= 0x85ebca6bU;
+	hash ^= (hash >> 13);
+	return hash;
+}
+
+INLINE_FUNCTION(bool)
+KERN_BLOOM_FILTER_CHECK(const uint32_t *bloom, uint32_t nblocks, uint32_t hash)
+{
+	const uint32_t *block = bloom + KERN_BLOOM_BLOCK_NWORDS * (hash % nblocks);
+	uint32_t	bits = __kern_bloom_remix(hash);
+
+	for (int k=0; k < 4; k++, bits >>= 8)
+	{
+		uint32_t	mask = (1U << (bits & 0x1f));
+
+		if ((block[(bits >> 5) & 7] & mask) == 0)
+			return false;
+	}
+	return true;
+}
+
+/*
+ * Heavy-hitters of the inner hash table
+ *
+ * The inner tuples whose hash value appears very frequently are gathered
+ * at the head of the row-index, so a heavy-hitter is a contiguous range
+ * of the row-index. The array is sorted by the hash value.
+ * When an outer tuple has the hash value of a heavy-hitter, GPU kernel
+ * does not walk on the hash-chain by itself; the inner tuples in the range
+ * are distributed to the idle threads of the thread-block, to avoid that
+ * a few threads stall the others for a long time.
+ * l_state of the heavy-hitter keeps the index of the array and the number
+ * of inner tuples already processed, with KERN_HASHSKEW_LSTATE_FLAG.
+ */
+#define KERN_HASHSKEW_MAX_KEYS		1024
+#define KERN_HASHSKEW_LSTATE_FLAG	(1UL<<63)
+#define KERN_HASHSKEW_LSTATE(sindex,done)						\
+	(KERN_HASHSKEW_LSTATE_FLAG | ((uint64_t)(sindex) << 32) | (uint64_t)(done))
+#define KERN_HASHSKEW_LSTATE_IS_VALID(l_state)					\
+	((l_state) != ULONG_MAX && ((l_state) & KERN_HASHSKEW_LSTATE_FLAG) != 0)
+#define KERN_HASHSKEW_LSTATE_SINDEX(l_state)					\
+	((uint32_t)(((l_state) & ~KERN_HASHSKEW_LSTATE_FLAG) >> 32))
+#define KERN_HASHSKEW_LSTATE_DONE(l_state)						\
+	((uint32_t)((l_state) & 0xffffffffUL))
+
+typedef struct
+{
+	uint32_t	hash;		/* hash value of the heavy-hitter */
+	uint32_t	head;		/* first position in the row-index */
+	uint32_t	nitems;		/* number of the inner tuples */
+} kern_hashskew;
+
+INLINE_FUNCTION(kern_hashskew *)
+KERN_MULTIRELS_HASH_SKEWS(kern_multirels *kmrels, int dindex)
+{
+	uint64_t	offset;
+
+	assert(dindex >= 0 && dindex < kmrels->num_rels);
+	if (kmrels->chunks[dindex].hash_nskews == 0)
+		return NULL;
+	offset = kmrels->chunks[dindex].hash_skew_offset;
+	return (kern_hashskew *)(offset == 0 ? NULL : ((char *)kmrels + offset));
+}
+
+/*
+ * KERN_HASHSKEW_LOOKUP - returns the index of the heavy-hitter, or -1
+ */
+INLINE_FUNCTION(int)
+KERN_HASHSKEW_LOOKUP(const kern_hashskew *skews, uint32_t nskews, uint32_t hash)
+{
+	uint32_t	head = 0;
+	uint32_t	tail = nskews;
+
+	while (head < tail)
+	{
+		uint32_t	curr = head + (tail - head) / 2;
+
+		if (skews[curr].hash == hash)
+			return curr;
+		if (skews[curr].hash < hash)
+			head = curr + 1;
+		else
+			tail = curr;
+	}
+	return -1;
+}
+
+/*
+ * Sorted keys of the range-join
+ *
+ * The row-index of the inner KDS (KDS_FORMAT_ROW) is sorted by the inner
+ * key of the range-join clause; NULL keys first, then ascending for the
+ * (inner > outer) or (inner >= outer) form, or descending for the others.
+ * So, the inner tuples that satisfy the clause are always the suffix of
+ * the row-index, and the GPU kernel skips the other portion by binary
+ * search on the int64 array of the sorted keys.
+ */
+INLINE_FUNCTION(int64_t *)
+KERN_MULTIRELS_RANGE_KEYS(kern_multirels *kmrels, int dindex)
+{
+	uint64_t	offset;
+
+	assert(dindex >= 0 && dindex < kmrels->num_rels);
+	offset = kmrels->chunks[dindex].range_keys_offset;
+	return (int64_t *)(offset == 0 ? NULL : ((char *)kmrels + offset));
+}
+
+INLINE_FUNCTION(uint32_t)
+KERN_RANGE_KEYS_LOWER_BOUND(const int64_t *range_keys,
+							uint32_t nnulls, uint32_t nitems,
+							bool range_desc, bool range_inclusive,
+							int64_t outer_key)
+{
+	uint32_t	head = nnulls;
+	uint32_t	tail = nitems;
+
+	while (head < tail)
+	{
+		uint32_t	curr = head + (tail - head) / 2;
+		int64_t		ival = range_keys[curr];
+		bool		match;
+
+		if (!range_desc)
+			match = (range_inclusive ? ival >= outer_key : ival > outer_key);
+		else
+			match = (range_inclusive ? ival <= outer_key : ival < outer_key);
+		if (match)
+			tail = curr;
+		else
+			head = curr + 1;
+	}
+	return head;
+}
+
 INLINE_FUNCTION(kern_data_store *)
 KERN_MULTIRELS_INNER_KDS(kern_multirels *kmrels, int dindex)
 {
@@ -3015,6 +3942,16 @@ KERN_MULTIRELS_GIST_INDEX(kern_multirels *kmrels, int dindex)
 	return (kern_data_store *)(offset == 0 ? NULL : ((char *)kmrels + offset));
 }
 
+INLINE_FUNCTION(kern_gist_rtree *)
+KERN_MULTIRELS_GIST_RTREE(kern_multirels *kmrels, int dindex)
+{
+	kern_data_store *kds_gist = KERN_MULTIRELS_GIST_INDEX(kmrels, dindex);
+
+	if (!kds_gist || !kmrels->chunks[dindex].gist_rtree)
+		return NULL;
+	return (kern_gist_rtree *)((char *)kds_gist + kds_gist->block_offset);
+}
+
 /* ----------------------------------------------------------------
  *
  * Atomic Operations
@@ -3115,6 +4052,26 @@ __atomic_or_uint32(uint32_t *ptr, uint32_t mask)
 #endif
 }
 
+INLINE_FUNCTION(uint64_t)
+__atomic_and_uint64(uint64_t *ptr, uint64_t mask)
+{
+#ifdef __CUDACC__
+	return atomicAnd((unsigned long long int *)ptr, (unsigned long long int)mask);
+#else
+	return __atomic_fetch_and(ptr, mask, __ATOMIC_SEQ_CST);
+#endif
+}
+
+INLINE_FUNCTION(uint64_t)
+__atomic_or_uint64(uint64_t *ptr, uint64_t mask)
+{
+#ifdef __CUDACC__
+	return atomicOr((unsigned long long int *)ptr, (unsigned long long int)mask);
+#else
+	return __atomic_fetch_or(ptr, mask, __ATOMIC_SEQ_CST);
+#endif
+}
+
 INLINE_FUNCTION(uint32_t)
 __atomic_max_uint32(uint32_t *ptr, uint32_t ival)
 {
@@ -3329,6 +4286,77 @@ __atomic_cas_uint64(uint64_t *ptr, uint64_t comp, uint64_t newval)
 #endif
 }
 
+/* ----------------------------------------------------------------
+ *
+ * xPU JOIN hash-table build
+ *
+ * ----------------------------------------------------------------
+ */
+
+/*
+ * KDS_HASH_INSERT_ITEM - links the hash-item to the hash-slot
+ *
+ * 'self' is offset of the item from the tail of KDS.
+ */
+INLINE_FUNCTION(void)
+KDS_HASH_INSERT_ITEM(kern_data_store *kds, kern_hashitem *hitem, uint64_t self)
+{
+	uint64_t   *hslot = KDS_GET_HASHSLOT(kds, hitem->hash);
+
+	hitem->next = __atomic_exchange_uint64(hslot, self);
+}
+
+/*
+ * KERN_BLOOM_FILTER_INSERT - sets the bits of the hash value
+ */
+INLINE_FUNCTION(void)
+KERN_BLOOM_FILTER_INSERT(uint32_t *bloom, uint32_t nblocks, uint32_t hash)
+{
+	uint32_t   *block = bloom + KERN_BLOOM_BLOCK_NWORDS * (hash % nblocks);
+	uint32_t	bits = __kern_bloom_remix(hash);
+
+	for (int k=0; k < 4; k++, bits >>= 8)
+	{
+		uint32_t	mask = (1U << (bits & 0x1f));
+		uint32_t   *word = &block[(bits >> 5) & 7];
+
+		if ((__volatileRead(word) & mask) == 0)
+			__atomic_or_uint32(word, mask);
+	}
+}
+
+/*
+ * KERN_HASHBUCKET_INSERT - adds an item on the bucketized index
+ *
+ * Slots of a bucket are consumed from the head, so a bucket with an empty
+ * slot is never overflowed. It returns false if no empty slots.
+ */
+INLINE_FUNCTION(bool)
+KERN_HASHBUCKET_INSERT(kern_hashbucket *buckets, uint32_t nbuckets,
+					   uint32_t hash, uint64_t self)
+{
+	uint32_t	item = self / MAXIMUM_ALIGNOF;
+	uint32_t	bindex = hash % nbuckets;
+
+	assert(self % MAXIMUM_ALIGNOF == 0 && item != 0);
+	for (uint32_t loop=0; loop < nbuckets; loop++)
+	{
+		kern_hashbucket *bucket = &buckets[bindex];
+
+		for (int k=0; k < KERN_HASHBUCKET_NSLOTS; k++)
+		{
+			if (__volatileRead(&bucket->items[k]) == 0 &&
+				__atomic_cas_uint32(&bucket->items[k], 0, item) == 0)
+			{
+				bucket->tags[k] = hash;
+				return true;
+			}
+		}
+		bindex = (bindex + 1) % nbuckets;
+	}
+	return false;
+}
+
 /* ----------------------------------------------------------------
  *
  * xPU PreAgg common utility functions
@@ -3384,6 +4412,356 @@ __preagg_fetch_xdatum_as_float64(float8_t *p_fval, const xpu_datum_t *xdatum)
 	return true;
 }
 
+INLINE_FUNCTION(bool)
+__preagg_fetch_xdatum_as_numeric(kern_context *kcxt,
+								 xpu_numeric_t *num,
+								 const xpu_datum_t *xdatum)
+{
+	if (xdatum->expr_ops == &xpu_numeric_ops)
+	{
+		*num = *((const xpu_numeric_t *)xdatum);
+		if (num->kind == XPU_NUMERIC_KIND__VARLENA)
+		{
+			const char *errmsg = __xpu_numeric_from_varlena(num, num->u.vl_addr);
+
+			if (errmsg)
+			{
+				STROM_ELOG(kcxt, errmsg);
+				return false;
+			}
+		}
+	}
+	else
+	{
+		assert(XPU_DATUM_ISNULL(xdatum));
+		return false;
+	}
+	return true;
+}
+
+/*
+ * Exact sum of numeric values (KAGG_ACTION__PSUM_NUMERIC/PAVG_NUMERIC)
+ *
+ * These routines are shared by GPU, DPU and the CPU fallback; so, state
+ * is always updated using atomic operations.
+ */
+INLINE_FUNCTION(void)
+__preagg_init_psum_numeric(kagg_state__psum_numeric_packed *r,
+						   int32_t num_weight)
+{
+	memset(r, 0, sizeof(kagg_state__psum_numeric_packed));
+	r->weights[0] = num_weight;
+	for (int k=1; k < KAGG_NUMERIC_NSLOTS; k++)
+		r->weights[k] = KAGG_NUMERIC_WEIGHT__UNUSED;
+	SET_VARSIZE(r, sizeof(kagg_state__psum_numeric_packed));
+}
+
+INLINE_FUNCTION(float8_t)
+__preagg_numeric_scale_fp64(float8_t fval, int32_t weight)
+{
+	if (fval != 0.0)
+	{
+		while (weight > 0)
+		{
+			fval /= 10.0;
+			weight--;
+		}
+		while (weight < 0)
+		{
+			fval *= 10.0;
+			weight++;
+		}
+	}
+	return fval;
+}
+
+INLINE_FUNCTION(float8_t)
+__preagg_numeric_sum_to_fp64(const kagg_numeric_sum *sum, int32_t weight)
+{
+	const float8_t	__2pow64 = 18446744073709551616.0;
+	float8_t		fval;
+
+	fval = ((float8_t)sum->hi * __2pow64 + (float8_t)sum->mid) * __2pow64
+		+ (float8_t)sum->lo;
+	return __preagg_numeric_scale_fp64(fval, weight);
+}
+
+/*
+ * __preagg_rescale_numeric - multiply 10^shift, if no overflow
+ */
+INLINE_FUNCTION(bool)
+__preagg_rescale_numeric(int128_t *p_value, int128_t value, int32_t shift)
+{
+	const int128_t	limit = (int128_t)(~((unsigned __int128)0) >> 1) / 10;
+
+	assert(shift >= 0);
+	while (shift-- > 0)
+	{
+		if (value > limit || value < -limit)
+			return false;
+		value *= 10;
+	}
+	*p_value = value;
+	return true;
+}
+
+/*
+ * __preagg_add_numeric_sum - 192bit atomic addition
+ *
+ * Each word is added by individual atomic operation, then carry is
+ * propagated to the upper word. The words may be inconsistent during
+ * the update, however, the final result is exact because all additions
+ * are commutative.
+ */
+INLINE_FUNCTION(void)
+__preagg_add_numeric_sum(kagg_numeric_sum *sum,
+						 uint64_t lo, uint64_t mid, int64_t hi)
+{
+	uint64_t	oldval;
+	int64_t		carry = 0;
+
+	if (lo != 0)
+	{
+		oldval = __atomic_add_uint64(&sum->lo, lo);
+		if (oldval + lo < oldval)
+		{
+			oldval = __atomic_add_uint64(&sum->mid, 1);
+			if (oldval == ULONG_MAX)
+				carry++;
+		}
+	}
+	if (mid != 0)
+	{
+		oldval = __atomic_add_uint64(&sum->mid, mid);
+		if (oldval + mid < oldval)
+			carry++;
+	}
+	if (hi + carry != 0)
+		__atomic_add_int64(&sum->hi, hi + carry);
+}
+
+/*
+ * __preagg_add_psum_numeric_slot
+ *
+ * It adds the value to the slot with the same or larger weight. If no
+ * such slot exists, a new slot shall be assigned. It returns false if
+ * no slot can accumulate the value exactly.
+ */
+INLINE_FUNCTION(bool)
+__preagg_add_psum_numeric_slot(kagg_state__psum_numeric_packed *r,
+							   int32_t weight, int128_t value)
+{
+	for (int k=0; k < KAGG_NUMERIC_NSLOTS; k++)
+	{
+		int32_t		curr = __volatileRead(&r->weights[k]);
+		int128_t	ival;
+
+		if (curr == KAGG_NUMERIC_WEIGHT__UNUSED)
+		{
+			curr = (int32_t)__atomic_cas_uint32((uint32_t *)&r->weights[k],
+												(uint32_t)KAGG_NUMERIC_WEIGHT__UNUSED,
+												(uint32_t)weight);
+			if (curr == KAGG_NUMERIC_WEIGHT__UNUSED)
+				curr = weight;		/* a new slot is assigned */
+		}
+		if (curr >= weight &&
+			__preagg_rescale_numeric(&ival, value, curr - weight))
+		{
+			__preagg_add_numeric_sum(&r->sums[k],
+									 (uint64_t)ival,
+									 (uint64_t)(ival >> 64),
+									 ival < 0 ? -1 : 0);
+			return true;
+		}
+	}
+	return false;
+}
+
+INLINE_FUNCTION(void)
+__preagg_update_psum_numeric(kagg_state__psum_numeric_packed *r,
+							 const xpu_numeric_t *num)
+{
+	__atomic_add_uint32(&r->nitems, 1);
+	switch (num->kind)
+	{
+		case XPU_NUMERIC_KIND__VALID:
+			if (num->u.value != 0 &&
+				!__preagg_add_psum_numeric_slot(r, num->weight, num->u.value))
+			{
+				int128_t	value = num->u.value;
+				kagg_numeric_sum temp;
+
+				/* this group falls back to the floating-point sum */
+				temp.lo  = (uint64_t)value;
+				temp.mid = (uint64_t)(value >> 64);
+				temp.hi  = (value < 0 ? -1 : 0);
+				__atomic_or_uint32(&r->flags, KAGG_NUMERIC_FLAG__INEXACT);
+				__atomic_add_fp64(&r->fp_sum,
+								  __preagg_numeric_sum_to_fp64(&temp, num->weight));
+			}
+			break;
+		case XPU_NUMERIC_KIND__NAN:
+			__atomic_or_uint32(&r->flags, KAGG_NUMERIC_FLAG__NAN);
+			break;
+		case XPU_NUMERIC_KIND__POS_INF:
+			__atomic_or_uint32(&r->flags, KAGG_NUMERIC_FLAG__POS_INF);
+			break;
+		case XPU_NUMERIC_KIND__NEG_INF:
+			__atomic_or_uint32(&r->flags, KAGG_NUMERIC_FLAG__NEG_INF);
+			break;
+		default:
+			assert(false);
+			break;
+	}
+}
+
+INLINE_FUNCTION(void)
+__preagg_merge_psum_numeric(kagg_state__psum_numeric_packed *r,
+							const kagg_state__psum_numeric_packed *s)
+{
+	__atomic_add_uint32(&r->nitems, s->nitems);
+	if (s->flags != 0)
+		__atomic_or_uint32(&r->flags, s->flags);
+	if (s->fp_sum != 0.0)
+		__atomic_add_fp64(&r->fp_sum, s->fp_sum);
+	for (int i=0; i < KAGG_NUMERIC_NSLOTS; i++)
+	{
+		const kagg_numeric_sum *sum = &s->sums[i];
+		int32_t		weight = s->weights[i];
+
+		if (weight == KAGG_NUMERIC_WEIGHT__UNUSED ||
+			(sum->lo == 0 && sum->mid == 0 && sum->hi == 0))
+			continue;
+		/* merge to the slot with identical weight */
+		for (int k=0; k < KAGG_NUMERIC_NSLOTS; k++)
+		{
+			int32_t		curr = __volatileRead(&r->weights[k]);
+
+			if (curr == KAGG_NUMERIC_WEIGHT__UNUSED)
+			{
+				curr = (int32_t)__atomic_cas_uint32((uint32_t *)&r->weights[k],
+													(uint32_t)KAGG_NUMERIC_WEIGHT__UNUSED,
+													(uint32_t)weight);
+				if (curr == KAGG_NUMERIC_WEIGHT__UNUSED)
+					curr = weight;
+			}
+			if (curr == weight)
+			{
+				__preagg_add_numeric_sum(&r->sums[k],
+										 sum->lo,
+										 sum->mid,
+										 sum->hi);
+				goto next;
+			}
+		}
+		/* or, rescale the sum if it fits to 128bit */
+		if (sum->hi == ((int64_t)sum->mid >> 63))
+		{
+			int128_t	value = (int128_t)(((unsigned __int128)sum->mid << 64) |
+										   (unsigned __int128)sum->lo);
+
+			if (__preagg_add_psum_numeric_slot(r, weight, value))
+				goto next;
+		}
+		__atomic_or_uint32(&r->flags, KAGG_NUMERIC_FLAG__INEXACT);
+		__atomic_add_fp64(&r->fp_sum,
+						  __preagg_numeric_sum_to_fp64(sum, weight));
+	next:
+		;
+	}
+}
+
+/*
+ * __preagg_fetch_xdatum_as_hll_hash
+ *
+ * It computes the HLL hash of the supplied datum; binary images to be
+ * hashed must be identical to __pgstrom_hll_hash_XXXX() in aggfuncs.c.
+ */
+INLINE_FUNCTION(bool)
+__preagg_fetch_xdatum_as_hll_hash(kern_context *kcxt,
+								  uint64_t *p_hash,
+								  const xpu_datum_t *xdatum)
+{
+	const xpu_datum_operators *ops = xdatum->expr_ops;
+
+	if (ops == &xpu_int1_ops)
+		*p_hash = pg_hll_siphash_value(&((const xpu_int1_t *)xdatum)->value,
+									   sizeof(int8_t));
+	else if (ops == &xpu_int2_ops)
+		*p_hash = pg_hll_siphash_value(&((const xpu_int2_t *)xdatum)->value,
+									   sizeof(int16_t));
+	else if (ops == &xpu_int4_ops)
+		*p_hash = pg_hll_siphash_value(&((const xpu_int4_t *)xdatum)->value,
+									   sizeof(int32_t));
+	else if (ops == &xpu_int8_ops)
+		*p_hash = pg_hll_siphash_value(&((const xpu_int8_t *)xdatum)->value,
+									   sizeof(int64_t));
+	else if (ops == &xpu_date_ops)
+		*p_hash = pg_hll_siphash_value(&((const xpu_date_t *)xdatum)->value,
+									   sizeof(DateADT));
+	else if (ops == &xpu_time_ops)
+		*p_hash = pg_hll_siphash_value(&((const xpu_time_t *)xdatum)->value,
+									   sizeof(TimeADT));
+	else if (ops == &xpu_timestamp_ops)
+		*p_hash = pg_hll_siphash_value(&((const xpu_timestamp_t *)xdatum)->value,
+									   sizeof(Timestamp));
+	else if (ops == &xpu_timestamptz_ops)
+		*p_hash = pg_hll_siphash_value(&((const xpu_timestamptz_t *)xdatum)->value,
+									   sizeof(TimestampTz));
+	else if (ops == &xpu_uuid_ops)
+		*p_hash = pg_hll_siphash_value(&((const xpu_uuid_t *)xdatum)->value,
+									   sizeof(pg_uuid_t));
+	else if (ops == &xpu_numeric_ops)
+	{
+		xpu_numeric_t	num = *((const xpu_numeric_t *)xdatum);
+
+		if (num.kind == XPU_NUMERIC_KIND__VARLENA)
+		{
+			const char *errmsg = __xpu_numeric_from_varlena(&num, num.u.vl_addr);
+
+			if (errmsg)
+			{
+				STROM_ELOG(kcxt, errmsg);
+				return false;
+			}
+		}
+		*p_hash = pg_hll_hash_numeric(&num);
+	}
+	else if (ops == &xpu_text_ops)
+	{
+		xpu_text_t	temp = *((const xpu_text_t *)xdatum);
+
+		if (!xpu_text_is_valid(kcxt, &temp))
+			return false;
+		*p_hash = pg_hll_siphash_value(temp.value, temp.length);
+	}
+	else if (ops == &xpu_bytea_ops)
+	{
+		xpu_bytea_t	temp = *((const xpu_bytea_t *)xdatum);
+
+		if (!xpu_bytea_is_valid(kcxt, &temp))
+			return false;
+		*p_hash = pg_hll_siphash_value(temp.value, temp.length);
+	}
+	else if (ops == &xpu_bpchar_ops)
+	{
+		xpu_bpchar_t temp = *((const xpu_bpchar_t *)xdatum);
+
+		if (!xpu_bpchar_is_valid(kcxt, &temp))
+			return false;
+		/* arrow_read does not strip the trailing spaces */
+		while (temp.length > 0 && temp.value[temp.length-1] == ' ')
+			temp.length--;
+		*p_hash = pg_hll_siphash_value(temp.value, temp.length);
+	}
+	else
+	{
+		assert(XPU_DATUM_ISNULL(xdatum));
+		return false;
+	}
+	return true;
+}
+
 /* ----------------------------------------------------------------
  *
  * Misc functions
@@ -65,13 +65,13 @@ typedef struct JsonbContainer
  * Basic Jsonb type handlers
  */
 INLINE_FUNCTION(bool)
-xpu_jsonb_is_valid(kern_context *kcxt, const xpu_jsonb_t *arg)
+xpu_jsonb_is_valid(kern_context *kcxt, xpu_jsonb_t *arg)
 {
+	/* see the comment at xpu_text_is_valid */
 	if (arg->length < 0)
-	{
-		STROM_CPU_FALLBACK(kcxt, "jsonb datum is compressed or external");
-		return false;
-	}
+		return xpu_varlena_decompress(kcxt, arg->value,
+									  &arg->value,
+									  &arg->length);
 	return true;
 }
 
@@ -316,7 +316,8 @@ xpu_jsonb_datum_hash(kern_context*kcxt,
 					 uint32_t *p_hash,
 					 xpu_datum_t *__arg)
 {
-	xpu_jsonb_t  *arg = (xpu_jsonb_t *)__arg;
+	xpu_jsonb_t  temp = *((xpu_jsonb_t *)__arg);	/* private copy */
+	xpu_jsonb_t *arg = &temp;
 
 	if (XPU_DATUM_ISNULL(arg))
 		*p_hash = 0;
@@ -928,6 +929,117 @@ pgfn_jsonb_object_field_text(XPU_PGFUNCTION_ARGS)
 	return true;
 }
 
+/*
+ * JsonbObjectFields
+ *
+ * It fetches multiple fields (jsonb->KEY or jsonb->>KEY) of the same jsonb
+ * object at once, for the case when a query references several keys.
+ * It walks on the object keys only once to find out the fields, instead of
+ * the binary search and offset calculation for each key, unless the object
+ * is much larger than the number of referenced fields.
+ */
+PUBLIC_FUNCTION(bool)
+pgfn_JsonbObjectFields(XPU_PGFUNCTION_ARGS)
+{
+	const kern_expression *karg = KEXP_FIRST_ARG(kexp);
+	int			nfields = kexp->u.jfields.nfields;
+	xpu_jsonb_t	json;
+	xpu_text_t	keys[KERN_JSONB_OBJECT_FIELDS_MAX];
+	int32_t		index[KERN_JSONB_OBJECT_FIELDS_MAX];
+	xpu_datum_t *fields[KERN_JSONB_OBJECT_FIELDS_MAX];
+
+	assert(kexp->nr_args == nfields + 1 &&
+		   nfields > 0 && nfields <= KERN_JSONB_OBJECT_FIELDS_MAX);
+	assert(KEXP_IS_VALID(karg, jsonb));
+	if (!EXEC_KERN_EXPRESSION(kcxt, karg, &json) ||
+		!xpu_jsonb_is_valid(kcxt, &json))
+		return false;
+	for (int k=0; k < nfields; k++)
+	{
+		uint16_t	slot_id = kexp->u.jfields.desc[k].jf_slot_id;
+
+		karg = KEXP_NEXT_ARG(karg);
+		assert(KEXP_IS_VALID(karg, text));
+		if (!EXEC_KERN_EXPRESSION(kcxt, karg, &keys[k]) ||
+			!xpu_text_is_valid(kcxt, &keys[k]))
+			return false;
+		assert(slot_id < kcxt->kvars_nslots);
+		fields[k] = (k == 0 && __result ? __result : kcxt->kvars_slot[slot_id]);
+		fields[k]->expr_ops = NULL;
+		index[k] = -1;
+	}
+
+	if (!XPU_DATUM_ISNULL(&json))
+	{
+		JsonbContainer *jc = (JsonbContainer *)json.value;
+		uint32_t		jheader = __Fetch(&jc->header);
+		uint32_t		count;
+		char		   *base;
+
+		if (!JsonContainerIsObject(jheader))
+			return true;
+		count = JsonContainerSize(jheader);
+		base = (char *)(jc->children + 2 * count);
+		if (count > 4 * nfields)
+		{
+			for (int k=0; k < nfields; k++)
+			{
+				if (!XPU_DATUM_ISNULL(&keys[k]))
+					index[k] = findJsonbIndexFromObject(jc, keys[k].value,
+														keys[k].length);
+			}
+		}
+		else
+		{
+			uint32_t	offset = 0;
+			int			nremains = nfields;
+
+			for (uint32_t i=0; i < count && nremains > 0; i++)
+			{
+				JEntry		entry = __Fetch(&jc->children[i]);
+				uint32_t	next;
+
+				if (JBE_HAS_OFF(entry))
+					next = JBE_OFFLENFLD(entry);
+				else
+					next = offset + JBE_OFFLENFLD(entry);
+				for (int k=0; k < nfields; k++)
+				{
+					if (index[k] < 0 &&
+						!XPU_DATUM_ISNULL(&keys[k]) &&
+						keys[k].length == next - offset &&
+						memcmp(base + offset, keys[k].value, keys[k].length) == 0)
+					{
+						index[k] = i;
+						nremains--;
+					}
+				}
+				offset = next;
+			}
+		}
+		/* extract the values */
+		for (int k=0; k < nfields; k++)
+		{
+			if (index[k] < 0 || index[k] >= count)
+				continue;
+			/* index now points one of values, not keys */
+			if (kexp->u.jfields.desc[k].jf_as_text)
+			{
+				if (!extractTextItemFromContainer(kcxt, (xpu_text_t *)fields[k],
+												  jc, index[k] + count, base))
+					return false;
+			}
+			else
+			{
+				if (!extractJsonbItemFromContainer(kcxt, (xpu_jsonb_t *)fields[k],
+												   jc, index[k] + count, base))
+					return false;
+			}
+		}
+	}
+	return true;
+}
+
 PUBLIC_FUNCTION(bool)
 pgfn_jsonb_array_element_text(XPU_PGFUNCTION_ARGS)
 {
@@ -1961,3 +1961,711 @@ pgfn_cube_ll_coord(XPU_PGFUNCTION_ARGS)
 	}
 	return true;
 }
+
+STATIC_FUNCTION(bool)
+pg_cube_overlap_v0(const __NDBOX *a, const __NDBOX *b)
+{
+	int		i;
+
+	/* swap the box pointers if needed */
+	if (DIM(a) < DIM(b))
+	{
+		const __NDBOX *tmp = b;
+
+		b = a;
+		a = tmp;
+	}
+	/* compare within the dimensions of (b) */
+	for (i = 0; i < DIM(b); i++)
+	{
+		if (Min(LL_COORD(a, i), UR_COORD(a, i)) >
+			Max(LL_COORD(b, i), UR_COORD(b, i)))
+			return false;
+		if (Max(LL_COORD(a, i), UR_COORD(a, i)) <
+			Min(LL_COORD(b, i), UR_COORD(b, i)))
+			return false;
+	}
+	/* compare to zero those dimensions in (a) absent in (b) */
+	for (i = DIM(b); i < DIM(a); i++)
+	{
+		if (Min(LL_COORD(a, i), UR_COORD(a, i)) > 0)
+			return false;
+		if (Max(LL_COORD(a, i), UR_COORD(a, i)) < 0)
+			return false;
+	}
+	return true;
+}
+
+PUBLIC_FUNCTION(bool)
+pgfn_cube_overlap(XPU_PGFUNCTION_ARGS)
+{
+	KEXP_PROCESS_ARGS2(bool, cube, arg1, cube, arg2);
+
+	if (XPU_DATUM_ISNULL(&arg1) || XPU_DATUM_ISNULL(&arg2))
+		result->expr_ops = NULL;
+	else if (!xpu_cube_is_valid(kcxt, &arg1) ||
+			 !xpu_cube_is_valid(kcxt, &arg2))
+		return false;
+	else
+	{
+		result->expr_ops = &xpu_bool_ops;
+		result->value = pg_cube_overlap_v0((const __NDBOX *)arg1.value,
+										   (const __NDBOX *)arg2.value);
+	}
+	return true;
+}
+
+INLINE_FUNCTION(double)
+cube_distance_1D(double a1, double a2, double b1, double b2)
+{
+	/* interval (a) is entirely on the left of (b) */
+	if ((a1 <= b1) && (a2 <= b1) && (a1 <= b2) && (a2 <= b2))
+		return (Min(b1, b2) - Max(a1, a2));
+	/* interval (a) is entirely on the right of (b) */
+	if ((a1 > b1) && (a2 > b1) && (a1 > b2) && (a2 > b2))
+		return (Min(a1, a2) - Max(b1, b2));
+	/* the rest are all sorts of intersections */
+	return 0.0;
+}
+
+#define CUBE_DISTANCE__EUCLID		1
+#define CUBE_DISTANCE__TAXICAB		2
+#define CUBE_DISTANCE__CHEBYSHEV	3
+
+STATIC_FUNCTION(double)
+pg_cube_distance_v0(const __NDBOX *a, const __NDBOX *b, int method)
+{
+	double		distance = 0.0;
+	double		d;
+	int			i;
+
+	/* swap the box pointers if needed */
+	if (DIM(a) < DIM(b))
+	{
+		const __NDBOX *tmp = b;
+
+		b = a;
+		a = tmp;
+	}
+	for (i = 0; i < DIM(a); i++)
+	{
+		if (i < DIM(b))
+			d = cube_distance_1D(LL_COORD(a, i), UR_COORD(a, i),
+								 LL_COORD(b, i), UR_COORD(b, i));
+		else
+			d = cube_distance_1D(LL_COORD(a, i), UR_COORD(a, i), 0.0, 0.0);
+		switch (method)
+		{
+			case CUBE_DISTANCE__TAXICAB:
+				distance += fabs(d);
+				break;
+			case CUBE_DISTANCE__CHEBYSHEV:
+				distance = Max(distance, fabs(d));
+				break;
+			default:
+				distance += d * d;
+				break;
+		}
+	}
+	return (method == CUBE_DISTANCE__EUCLID ? sqrt(distance) : distance);
+}
+
+#define PG_CUBE_DISTANCE_TEMPLATE(NAME,METHOD)							\
+	PUBLIC_FUNCTION(bool)												\
+	pgfn_##NAME(XPU_PGFUNCTION_ARGS)									\
+	{																	\
+		KEXP_PROCESS_ARGS2(float8, cube, arg1, cube, arg2);				\
+																		\
+		if (XPU_DATUM_ISNULL(&arg1) || XPU_DATUM_ISNULL(&arg2))			\
+			result->expr_ops = NULL;									\
+		else if (!xpu_cube_is_valid(kcxt, &arg1) ||						\
+				 !xpu_cube_is_valid(kcxt, &arg2))						\
+			return false;												\
+		else															\
+		{																\
+			result->expr_ops = &xpu_float8_ops;							\
+			result->value = pg_cube_distance_v0((const __NDBOX *)arg1.value, \
+												(const __NDBOX *)arg2.value, \
+												METHOD);				\
+		}																\
+		return true;													\
+	}
+PG_CUBE_DISTANCE_TEMPLATE(cube_distance,      CUBE_DISTANCE__EUCLID)
+PG_CUBE_DISTANCE_TEMPLATE(distance_taxicab,   CUBE_DISTANCE__TAXICAB)
+PG_CUBE_DISTANCE_TEMPLATE(distance_chebyshev, CUBE_DISTANCE__CHEBYSHEV)
+
+/* ----------------------------------------------------------------
+ *
+ * vector distance functions on float2/float4/float8 arrays
+ *
+ * ----------------------------------------------------------------
+ */
+#define VECTOR_DISTANCE__L2				1
+#define VECTOR_DISTANCE__INNER_PRODUCT	2
+#define VECTOR_DISTANCE__NEG_INNER_PRODUCT 3
+#define VECTOR_DISTANCE__COSINE			4
+
+STATIC_FUNCTION(const char *)
+__xpu_vector_values(kern_context *kcxt,
+					const xpu_array_t *aval,
+					int elemlen,
+					uint32_t *p_nitems)
+{
+	uint32_t	nitems = 0;
+
+	if (aval->length < 0)
+	{
+		const __ArrayTypeData *ar = (const __ArrayTypeData *)
+			VARDATA_ANY(aval->u.heap.value);
+		const uint8_t  *nullmap = __pg_array_nullmap(ar);
+		int				ndim = __pg_array_ndim(ar);
+
+		if (ndim > 0)
+		{
+			nitems = __pg_array_dim(ar, 0);
+			for (int k=1; k < ndim; k++)
+				nitems *= __pg_array_dim(ar, k);
+		}
+		if (nullmap)
+		{
+			for (uint32_t i=0; i < nitems; i++)
+			{
+				if (att_isnull(i, nullmap))
+				{
+					STROM_ELOG(kcxt, "vector must not contain nulls");
+					return NULL;
+				}
+			}
+		}
+		*p_nitems = nitems;
+		return __pg_array_dataptr(ar);
+	}
+	else
+	{
+		const kern_colmeta *cmeta = aval->u.arrow.cmeta;
+		const kern_data_store *kds = (const kern_data_store *)
+			((const char *)cmeta - cmeta->kds_offset);
+		const kern_colmeta *smeta = &kds->colmeta[cmeta->idx_subattrs];
+
+		if (smeta->attlen != elemlen || smeta->values_offset == 0)
+		{
+			STROM_ELOG(kcxt, "not a supported vector representation");
+			return NULL;
+		}
+		nitems = aval->length;
+		if (smeta->nullmap_offset != 0)
+		{
+			for (uint32_t i=0; i < nitems; i++)
+			{
+				if (KDS_ARROW_CHECK_ISNULL(kds, smeta, aval->u.arrow.start + i))
+				{
+					STROM_ELOG(kcxt, "vector must not contain nulls");
+					return NULL;
+				}
+			}
+		}
+		*p_nitems = nitems;
+		return ((const char *)kds + __kds_unpack(smeta->values_offset)
+				+ elemlen * aval->u.arrow.start);
+	}
+}
+
+/*
+ * NOTE: float2 vectors are accumulated in fp32; it keeps the memory traffic
+ * of half-precision, but we don't lose precision on the long vectors.
+ * float4/float8 vectors are accumulated in fp64, as the host code doing.
+ */
+#define PG_VECTOR_DISTANCE_TEMPLATE(NAME,ELEMTYPE,ACCUMTYPE,__CAST,METHOD) \
+	PUBLIC_FUNCTION(bool)												\
+	pgfn_##NAME(XPU_PGFUNCTION_ARGS)									\
+	{																	\
+		KEXP_PROCESS_ARGS2(float8, array, arg1, array, arg2);			\
+																		\
+		if (XPU_DATUM_ISNULL(&arg1) || XPU_DATUM_ISNULL(&arg2))			\
+			result->expr_ops = NULL;									\
+		else															\
+		{																\
+			const char *x_values;										\
+			const char *y_values;										\
+			uint32_t	x_nitems;										\
+			uint32_t	y_nitems;										\
+			ACCUMTYPE	dot = 0.0;										\
+			ACCUMTYPE	x_norm = 0.0;									\
+			ACCUMTYPE	y_norm = 0.0;									\
+			double		fval;											\
+																		\
+			x_values = __xpu_vector_values(kcxt, &arg1, sizeof(ELEMTYPE), &x_nitems); \
+			if (!x_values)												\
+				return false;											\
+			y_values = __xpu_vector_values(kcxt, &arg2, sizeof(ELEMTYPE), &y_nitems); \
+			if (!y_values)												\
+				return false;											\
+			if (x_nitems != y_nitems)									\
+			{															\
+				STROM_ELOG(kcxt, #NAME ": different vector dimensions"); \
+				return false;											\
+			}															\
+			for (uint32_t i=0; i < x_nitems; i++)						\
+			{															\
+				ACCUMTYPE	x = __CAST(__Fetch((const ELEMTYPE *)x_values + i)); \
+				ACCUMTYPE	y = __CAST(__Fetch((const ELEMTYPE *)y_values + i)); \
+																		\
+				switch (METHOD)											\
+				{														\
+					case VECTOR_DISTANCE__L2:							\
+						dot += (x - y) * (x - y);						\
+						break;											\
+					case VECTOR_DISTANCE__COSINE:						\
+						x_norm += x * x;								\
+						y_norm += y * y;								\
+						dot += x * y;									\
+						break;											\
+					default:											\
+						dot += x * y;									\
+						break;											\
+				}														\
+			}															\
+			switch (METHOD)												\
+			{															\
+				case VECTOR_DISTANCE__L2:								\
+					fval = sqrt((double)dot);							\
+					break;												\
+				case VECTOR_DISTANCE__NEG_INNER_PRODUCT:				\
+					fval = -(double)dot;								\
+					break;												\
+				case VECTOR_DISTANCE__COSINE:							\
+					if (x_norm == 0.0 || y_norm == 0.0)					\
+						fval = DBL_NAN;									\
+					else												\
+					{													\
+						fval = 1.0 - ((double)dot /						\
+									  sqrt((double)x_norm * (double)y_norm)); \
+						fval = Max(0.0, Min(fval, 2.0));				\
+					}													\
+					break;												\
+				default:												\
+					fval = (double)dot;									\
+					break;												\
+			}															\
+			result->expr_ops = &xpu_float8_ops;							\
+			result->value = fval;										\
+		}																\
+		return true;													\
+	}
+PG_VECTOR_DISTANCE_TEMPLATE(float2_l2_distance,     float2_t,float4_t,__to_fp32,VECTOR_DISTANCE__L2)
+PG_VECTOR_DISTANCE_TEMPLATE(float4_l2_distance,     float4_t,float8_t,__to_fp64,VECTOR_DISTANCE__L2)
+PG_VECTOR_DISTANCE_TEMPLATE(float8_l2_distance,     float8_t,float8_t,,VECTOR_DISTANCE__L2)
+PG_VECTOR_DISTANCE_TEMPLATE(float2_inner_product,   float2_t,float4_t,__to_fp32,VECTOR_DISTANCE__INNER_PRODUCT)
+PG_VECTOR_DISTANCE_TEMPLATE(float4_inner_product,   float4_t,float8_t,__to_fp64,VECTOR_DISTANCE__INNER_PRODUCT)
+PG_VECTOR_DISTANCE_TEMPLATE(float8_inner_product,   float8_t,float8_t,,VECTOR_DISTANCE__INNER_PRODUCT)
+PG_VECTOR_DISTANCE_TEMPLATE(float2_negative_inner_product, float2_t,float4_t,__to_fp32,VECTOR_DISTANCE__NEG_INNER_PRODUCT)
+PG_VECTOR_DISTANCE_TEMPLATE(float4_negative_inner_product, float4_t,float8_t,__to_fp64,VECTOR_DISTANCE__NEG_INNER_PRODUCT)
+PG_VECTOR_DISTANCE_TEMPLATE(float8_negative_inner_product, float8_t,float8_t,,VECTOR_DISTANCE__NEG_INNER_PRODUCT)
+PG_VECTOR_DISTANCE_TEMPLATE(float2_cosine_distance, float2_t,float4_t,__to_fp32,VECTOR_DISTANCE__COSINE)
+PG_VECTOR_DISTANCE_TEMPLATE(float4_cosine_distance, float4_t,float8_t,__to_fp64,VECTOR_DISTANCE__COSINE)
+PG_VECTOR_DISTANCE_TEMPLATE(float8_cosine_distance, float8_t,float8_t,,VECTOR_DISTANCE__COSINE)
+
+/* ----------------------------------------------------------------
+ *
+ * range types (int4range, int8range, daterange, tsrange, tstzrange)
+ *
+ * ----------------------------------------------------------------
+ */
+typedef struct
+{
+	int64_t		val;
+	bool		infinite;
+	bool		inclusive;
+	bool		lower;
+} pg_range_bound_t;
+
+INLINE_FUNCTION(pg_range_bound_t)
+pg_range_lower_bound(const pg_range_t *r)
+{
+	pg_range_bound_t	b;
+
+	b.val       = r->lower;
+	b.infinite  = ((r->flags & RANGE_LB_INF) != 0);
+	b.inclusive = ((r->flags & RANGE_LB_INC) != 0);
+	b.lower     = true;
+	return b;
+}
+
+INLINE_FUNCTION(pg_range_bound_t)
+pg_range_upper_bound(const pg_range_t *r)
+{
+	pg_range_bound_t	b;
+
+	b.val       = r->upper;
+	b.infinite  = ((r->flags & RANGE_UB_INF) != 0);
+	b.inclusive = ((r->flags & RANGE_UB_INC) != 0);
+	b.lower     = false;
+	return b;
+}
+
+/* see range_cmp_bounds() */
+STATIC_FUNCTION(int)
+pg_range_cmp_bounds(const pg_range_bound_t *b1, const pg_range_bound_t *b2)
+{
+	if (b1->infinite && b2->infinite)
+	{
+		if (b1->lower == b2->lower)
+			return 0;
+		return (b1->lower ? -1 : 1);
+	}
+	else if (b1->infinite)
+		return (b1->lower ? -1 : 1);
+	else if (b2->infinite)
+		return (b2->lower ? 1 : -1);
+
+	if (b1->val != b2->val)
+		return (b1->val < b2->val ? -1 : 1);
+	if (!b1->inclusive && !b2->inclusive)
+	{
+		if (b1->lower == b2->lower)
+			return 0;
+		return (b1->lower ? 1 : -1);
+	}
+	else if (!b1->inclusive)
+		return (b1->lower ? 1 : -1);
+	else if (!b2->inclusive)
+		return (b2->lower ? -1 : 1);
+	return 0;
+}
+
+/* see range_overlaps_internal() */
+STATIC_FUNCTION(bool)
+pg_range_overlaps(const pg_range_t *r1, const pg_range_t *r2)
+{
+	pg_range_bound_t	lower1, upper1;
+	pg_range_bound_t	lower2, upper2;
+
+	if ((r1->flags & RANGE_EMPTY) != 0 ||
+		(r2->flags & RANGE_EMPTY) != 0)
+		return false;
+	lower1 = pg_range_lower_bound(r1);
+	upper1 = pg_range_upper_bound(r1);
+	lower2 = pg_range_lower_bound(r2);
+	upper2 = pg_range_upper_bound(r2);
+	if (pg_range_cmp_bounds(&lower1, &lower2) >= 0 &&
+		pg_range_cmp_bounds(&lower1, &upper2) <= 0)
+		return true;
+	if (pg_range_cmp_bounds(&lower2, &lower1) >= 0 &&
+		pg_range_cmp_bounds(&lower2, &upper1) <= 0)
+		return true;
+	return false;
+}
+
+/* see range_contains_internal() */
+STATIC_FUNCTION(bool)
+pg_range_contains(const pg_range_t *r1, const pg_range_t *r2)
+{
+	pg_range_bound_t	lower1, upper1;
+	pg_range_bound_t	lower2, upper2;
+
+	/* If either range is empty, the answer is easy */
+	if ((r2->flags & RANGE_EMPTY) != 0)
+		return true;
+	if ((r1->flags & RANGE_EMPTY) != 0)
+		return false;
+	lower1 = pg_range_lower_bound(r1);
+	upper1 = pg_range_upper_bound(r1);
+	lower2 = pg_range_lower_bound(r2);
+	upper2 = pg_range_upper_bound(r2);
+	if (pg_range_cmp_bounds(&lower1, &lower2) > 0)
+		return false;
+	if (pg_range_cmp_bounds(&upper1, &upper2) < 0)
+		return false;
+	return true;
+}
+
+/* see range_contains_elem_internal() */
+STATIC_FUNCTION(bool)
+pg_range_contains_elem(const pg_range_t *r, int64_t val)
+{
+	if ((r->flags & RANGE_EMPTY) != 0)
+		return false;
+	if ((r->flags & RANGE_LB_INF) == 0)
+	{
+		if (r->lower > val)
+			return false;
+		if (r->lower == val && (r->flags & RANGE_LB_INC) == 0)
+			return false;
+	}
+	if ((r->flags & RANGE_UB_INF) == 0)
+	{
+		if (r->upper < val)
+			return false;
+		if (r->upper == val && (r->flags & RANGE_UB_INC) == 0)
+			return false;
+	}
+	return true;
+}
+
+/*
+ * __pg_range_datum_read - it deforms the RangeType (see range_serialize).
+ * Bounds are aligned to the absolute position from the 4B varlena header,
+ * so we have to adjust the offsets if short varlena.
+ */
+STATIC_FUNCTION(bool)
+__pg_range_datum_read(kern_context *kcxt,
+					  const void *addr,
+					  int elemsz,
+					  pg_range_t *range)
+{
+	const char *base;
+	const char *tail;
+	uint32_t	offset;
+
+	if (VARATT_IS_EXTERNAL(addr) || VARATT_IS_COMPRESSED(addr))
+	{
+		STROM_CPU_FALLBACK(kcxt, "range datum is compressed or external");
+		return false;
+	}
+	base = (const char *)addr + (VARATT_IS_SHORT(addr) ? 1 : VARHDRSZ) - VARHDRSZ;
+	tail = VARDATA_ANY(addr) + VARSIZE_ANY_EXHDR(addr);
+	if (tail <= VARDATA_ANY(addr) + sizeof(uint32_t))
+	{
+		STROM_ELOG(kcxt, "range datum is corrupted");
+		return false;
+	}
+	memset(range, 0, sizeof(pg_range_t));
+	memcpy(&range->rangetypid, VARDATA_ANY(addr), sizeof(uint32_t));
+	range->flags = tail[-1];
+	offset = VARHDRSZ + sizeof(uint32_t);
+	if ((range->flags & (RANGE_EMPTY | RANGE_LB_INF)) == 0)
+	{
+		offset = TYPEALIGN(elemsz, offset);
+		if (base + offset + elemsz >= tail)
+			goto corrupted;
+		if (elemsz == sizeof(int32_t))
+			range->lower = __Fetch((const int32_t *)(base + offset));
+		else
+			range->lower = __Fetch((const int64_t *)(base + offset));
+		offset += elemsz;
+	}
+	if ((range->flags & (RANGE_EMPTY | RANGE_UB_INF)) == 0)
+	{
+		offset = TYPEALIGN(elemsz, offset);
+		if (base + offset + elemsz >= tail)
+			goto corrupted;
+		if (elemsz == sizeof(int32_t))
+			range->upper = __Fetch((const int32_t *)(base + offset));
+		else
+			range->upper = __Fetch((const int64_t *)(base + offset));
+	}
+	return true;
+corrupted:
+	STROM_ELOG(kcxt, "range datum is corrupted");
+	return false;
+}
+
+STATIC_FUNCTION(int)
+__pg_range_datum_write(char *buffer, int elemsz, const pg_range_t *range)
+{
+	uint32_t	offset = VARHDRSZ;
+
+	if (buffer)
+		memcpy(buffer + offset, &range->rangetypid, sizeof(uint32_t));
+	offset += sizeof(uint32_t);
+	if ((range->flags & (RANGE_EMPTY | RANGE_LB_INF)) == 0)
+	{
+		offset = TYPEALIGN(elemsz, offset);
+		if (buffer)
+		{
+			if (elemsz == sizeof(int32_t))
+				*((int32_t *)(buffer + offset)) = range->lower;
+			else
+				*((int64_t *)(buffer + offset)) = range->lower;
+		}
+		offset += elemsz;
+	}
+	if ((range->flags & (RANGE_EMPTY | RANGE_UB_INF)) == 0)
+	{
+		offset = TYPEALIGN(elemsz, offset);
+		if (buffer)
+		{
+			if (elemsz == sizeof(int32_t))
+				*((int32_t *)(buffer + offset)) = range->upper;
+			else
+				*((int64_t *)(buffer + offset)) = range->upper;
+		}
+		offset += elemsz;
+	}
+	if (buffer)
+	{
+		buffer[offset] = range->flags;
+		SET_VARSIZE(buffer, offset + 1);
+	}
+	return offset + 1;
+}
+
+#define PG_RANGETYPE_TEMPLATE(NAME,ELEMTYPE,ELEMSZ)						\
+	STATIC_FUNCTION(bool)												\
+	xpu_##NAME##_datum_heap_read(kern_context *kcxt,					\
+								 const void *addr,						\
+								 xpu_datum_t *__result)					\
+	{																	\
+		xpu_##NAME##_t *result = (xpu_##NAME##_t *)__result;			\
+																		\
+		if (!__pg_range_datum_read(kcxt, addr, ELEMSZ, &result->value))	\
+			return false;												\
+		result->expr_ops = &xpu_##NAME##_ops;							\
+		return true;													\
+	}																	\
+	STATIC_FUNCTION(bool)												\
+	xpu_##NAME##_datum_arrow_read(kern_context *kcxt,					\
+								  const kern_data_store *kds,			\
+								  const kern_colmeta *cmeta,			\
+								  uint32_t kds_index,					\
+								  xpu_datum_t *__result)				\
+	{																	\
+		STROM_ELOG(kcxt, "xpu_" #NAME "_t does not support Arrow type mapping"); \
+		return false;													\
+	}																	\
+	STATIC_FUNCTION(bool)												\
+	xpu_##NAME##_datum_kvec_load(kern_context *kcxt,					\
+								 const kvec_datum_t *__kvecs,			\
+								 uint32_t kvecs_id,						\
+								 xpu_datum_t *__result)					\
+	{																	\
+		const kvec_##NAME##_t *kvecs = (const kvec_##NAME##_t *)__kvecs; \
+		xpu_##NAME##_t *result = (xpu_##NAME##_t *)__result;			\
+																		\
+		result->expr_ops = &xpu_##NAME##_ops;							\
+		result->value = kvecs->values[kvecs_id];						\
+		return true;													\
+	}																	\
+	STATIC_FUNCTION(bool)												\
+	xpu_##NAME##_datum_kvec_save(kern_context *kcxt,					\
+								 const xpu_datum_t *__xdatum,			\
+								 kvec_datum_t *__kvecs,					\
+								 uint32_t kvecs_id)						\
+	{																	\
+		const xpu_##NAME##_t *xdatum = (const xpu_##NAME##_t *)__xdatum; \
+		kvec_##NAME##_t *kvecs = (kvec_##NAME##_t *)__kvecs;			\
+																		\
+		kvecs->values[kvecs_id] = xdatum->value;						\
+		return true;													\
+	}																	\
+	STATIC_FUNCTION(bool)												\
+	xpu_##NAME##_datum_kvec_copy(kern_context *kcxt,					\
+								 const kvec_datum_t *__kvecs_src,		\
+								 uint32_t kvecs_src_id,					\
+								 kvec_datum_t *__kvecs_dst,				\
+								 uint32_t kvecs_dst_id)					\
+	{																	\
+		const kvec_##NAME##_t *kvecs_src = (const kvec_##NAME##_t *)__kvecs_src; \
+		kvec_##NAME##_t *kvecs_dst = (kvec_##NAME##_t *)__kvecs_dst;	\
+																		\
+		kvecs_dst->values[kvecs_dst_id] = kvecs_src->values[kvecs_src_id]; \
+		return true;													\
+	}																	\
+	STATIC_FUNCTION(int)												\
+	xpu_##NAME##_datum_write(kern_context *kcxt,						\
+							 char *buffer,								\
+							 const kern_colmeta *cmeta,					\
+							 const xpu_datum_t *__arg)					\
+	{																	\
+		const xpu_##NAME##_t *arg = (const xpu_##NAME##_t *)__arg;		\
+																		\
+		if (XPU_DATUM_ISNULL(arg))										\
+			return 0;													\
+		return __pg_range_datum_write(buffer, ELEMSZ, &arg->value);		\
+	}																	\
+	STATIC_FUNCTION(bool)												\
+	xpu_##NAME##_datum_hash(kern_context *kcxt,							\
+							uint32_t *p_hash,							\
+							xpu_datum_t *arg)							\
+	{																	\
+		STROM_ELOG(kcxt, #NAME " type has no hash function");			\
+		return false;													\
+	}																	\
+	STATIC_FUNCTION(bool)												\
+	xpu_##NAME##_datum_comp(kern_context *kcxt,							\
+							int *p_comp,								\
+							xpu_datum_t *__a,							\
+							xpu_datum_t *__b)							\
+	{																	\
+		STROM_ELOG(kcxt, #NAME " type has no compare function");		\
+		return false;													\
+	}																	\
+	PGSTROM_SQLTYPE_OPERATORS(NAME, false, ELEMSZ, -1);					\
+																		\
+	PUBLIC_FUNCTION(bool)												\
+	pgfn_##NAME##_overlaps(XPU_PGFUNCTION_ARGS)							\
+	{																	\
+		KEXP_PROCESS_ARGS2(bool, NAME, arg1, NAME, arg2);				\
+																		\
+		if (XPU_DATUM_ISNULL(&arg1) || XPU_DATUM_ISNULL(&arg2))			\
+			result->expr_ops = NULL;									\
+		else															\
+		{																\
+			result->expr_ops = &xpu_bool_ops;							\
+			result->value = pg_range_overlaps(&arg1.value, &arg2.value); \
+		}																\
+		return true;													\
+	}																	\
+	PUBLIC_FUNCTION(bool)												\
+	pgfn_##NAME##_contains(XPU_PGFUNCTION_ARGS)							\
+	{																	\
+		KEXP_PROCESS_ARGS2(bool, NAME, arg1, NAME, arg2);				\
+																		\
+		if (XPU_DATUM_ISNULL(&arg1) || XPU_DATUM_ISNULL(&arg2))			\
+			result->expr_ops = NULL;									\
+		else															\
+		{																\
+			result->expr_ops = &xpu_bool_ops;							\
+			result->value = pg_range_contains(&arg1.value, &arg2.value); \
+		}																\
+		return true;													\
+	}																	\
+	PUBLIC_FUNCTION(bool)												\
+	pgfn_##NAME##_contained_by(XPU_PGFUNCTION_ARGS)						\
+	{																	\
+		KEXP_PROCESS_ARGS2(bool, NAME, arg1, NAME, arg2);				\
+																		\
+		if (XPU_DATUM_ISNULL(&arg1) || XPU_DATUM_ISNULL(&arg2))			\
+			result->expr_ops = NULL;									\
+		else															\
+		{																\
+			result->expr_ops = &xpu_bool_ops;							\
+			result->value = pg_range_contains(&arg2.value, &arg1.value); \
+		}																\
+		return true;													\
+	}																	\
+	PUBLIC_FUNCTION(bool)												\
+	pgfn_##NAME##_contains_elem(XPU_PGFUNCTION_ARGS)					\
+	{																	\
+		KEXP_PROCESS_ARGS2(bool, NAME, arg1, ELEMTYPE, arg2);			\
+																		\
+		if (XPU_DATUM_ISNULL(&arg1) || XPU_DATUM_ISNULL(&arg2))			\
+			result->expr_ops = NULL;									\
+		else															\
+		{																\
+			result->expr_ops = &xpu_bool_ops;							\
+			result->value = pg_range_contains_elem(&arg1.value,			\
+												   arg2.value);			\
+		}																\
+		return true;													\
+	}																	\
+	PUBLIC_FUNCTION(bool)												\
+	pgfn_##NAME##_elem_contained_by(XPU_PGFUNCTION_ARGS)				\
+	{																	\
+		KEXP_PROCESS_ARGS2(bool, ELEMTYPE, arg1, NAME, arg2);			\
+																		\
+		if (XPU_DATUM_ISNULL(&arg1) || XPU_DATUM_ISNULL(&arg2))			\
+			result->expr_ops = NULL;									\
+		else															\
+		{																\
+			result->expr_ops = &xpu_bool_ops;							\
+			result->value = pg_range_contains_elem(&arg2.value,			\
+												   arg1.value);			\
+		}																\
+		return true;													\
+	}
+PG_RANGETYPE_TEMPLATE(int4range, int4,        4)
+PG_RANGETYPE_TEMPLATE(int8range, int8,        8)
+PG_RANGETYPE_TEMPLATE(daterange, date,        4)
+PG_RANGETYPE_TEMPLATE(tsrange,   timestamp,   8)
+PG_RANGETYPE_TEMPLATE(tstzrange, timestamptz, 8)
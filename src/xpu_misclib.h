@@ -110,4 +110,36 @@ typedef struct __NDBOX		__NDBOX;
 
 PGSTROM_SQLTYPE_VARLENA_DECLARATION(cube);
 
+/*
+ * range types (int4range, int8range, daterange, tsrange and tstzrange)
+ *
+ * Element types of these ranges are fixed-length integers, so the bounds
+ * are kept as int64; see utils/rangetypes.h for the on-disk format.
+ */
+#ifndef RANGETYPES_H
+#define RANGE_EMPTY			0x01	/* range is empty */
+#define RANGE_LB_INC		0x02	/* lower bound is inclusive */
+#define RANGE_UB_INC		0x04	/* upper bound is inclusive */
+#define RANGE_LB_INF		0x08	/* lower bound is -infinity */
+#define RANGE_UB_INF		0x10	/* upper bound is +infinity */
+#define RANGE_LB_NULL		0x20	/* lower bound is null (NOT USED) */
+#define RANGE_UB_NULL		0x40	/* upper bound is null (NOT USED) */
+#define RANGE_CONTAIN_EMPTY	0x80	/* marks a GiST internal-page entry whose
+									 * subtree contains some empty ranges */
+#endif	/* RANGETYPES_H */
+
+typedef struct
+{
+	int64_t		lower;
+	int64_t		upper;
+	uint32_t	rangetypid;
+	uint8_t		flags;		/* RANGE_* flags above */
+} pg_range_t;
+
+PGSTROM_SQLTYPE_SIMPLE_DECLARATION(int4range, pg_range_t);
+PGSTROM_SQLTYPE_SIMPLE_DECLARATION(int8range, pg_range_t);
+PGSTROM_SQLTYPE_SIMPLE_DECLARATION(daterange, pg_range_t);
+PGSTROM_SQLTYPE_SIMPLE_DECLARATION(tsrange,   pg_range_t);
+PGSTROM_SQLTYPE_SIMPLE_DECLARATION(tstzrange, pg_range_t);
+
 #endif	/* XPU_MISCLIB_H */
@@ -87,7 +87,7 @@ xpu_numeric_datum_arrow_read(kern_context *kcxt,
 														kds_index,
 														sizeof(int128_t));
 	if (addr)
-		set_normalized_numeric(result, *addr,
+		set_fixedpoint_numeric(result, *addr,
 							   cmeta->attopts.decimal.scale);
 	else
 		result->expr_ops = NULL;
@@ -218,13 +218,20 @@ xpu_numeric_datum_hash(kern_context *kcxt,
 	else if (arg->kind != XPU_NUMERIC_KIND__VALID)
 		*p_hash = pg_hash_any(&arg->kind, sizeof(uint8_t));
 	else
-		*p_hash = (pg_hash_any(&arg->weight, sizeof(int16_t)) ^
-				   pg_hash_any(&arg->u.value, sizeof(int128_t)));
+	{
+		xpu_numeric_t	temp;
+
+		/* Arrow::Decimal may not be normalized, see set_fixedpoint_numeric */
+		set_normalized_numeric(&temp, arg->u.value, arg->weight);
+		*p_hash = (pg_hash_any(&temp.weight, sizeof(int16_t)) ^
+				   pg_hash_any(&temp.u.value, sizeof(int128_t)));
+	}
 	return true;
 }
 
 STATIC_FUNCTION(int)
-__numeric_compare(const xpu_numeric_t *a, const xpu_numeric_t *b);
+__numeric_compare(const xpu_numeric_t *a, const xpu_numeric_t *b,
+				  bool bounded);
 
 STATIC_FUNCTION(bool)
 xpu_numeric_datum_comp(kern_context *kcxt,
@@ -240,7 +247,7 @@ xpu_numeric_datum_comp(kern_context *kcxt,
 		!xpu_numeric_validate(kcxt, b))
 		return false;
 
-	*p_comp = __numeric_compare(a, b);
+	*p_comp = __numeric_compare(a, b, false);
 	return true;
 }
 PGSTROM_SQLTYPE_OPERATORS(numeric, false, 4, -1);
@@ -543,8 +550,84 @@ PG_FLOAT_TO_NUMERIC_TEMPLATE(float2, float,__to_fp32)
 PG_FLOAT_TO_NUMERIC_TEMPLATE(float4, float,__to_fp32)
 PG_FLOAT_TO_NUMERIC_TEMPLATE(float8,double,__to_fp64)
 
+/*
+ * Fast path for the bounded numeric
+ *
+ * If codegen could prove the numeric arguments are bounded by precision
+ * (e.g, numeric(12,2)), it sets KEXP_FLAG__NUMERIC_INT64. Then, we try to
+ * evaluate them using scaled 64bit integer, instead of 128bit integer that
+ * is emulated on GPU. If it may overflow, we fall back to the generic path.
+ */
+STATIC_DATA const int64_t __numeric_int64_pow10[] = {
+	1L,
+	10L,
+	100L,
+	1000L,
+	10000L,
+	100000L,
+	1000000L,
+	10000000L,
+	100000000L,
+	1000000000L,
+	10000000000L,
+	100000000000L,
+	1000000000000L,
+	10000000000000L,
+	100000000000000L,
+	1000000000000000L,
+	10000000000000000L,
+	100000000000000000L,
+	1000000000000000000L,
+};
+#define NUMERIC_INT64_MAX_SHIFT		18
+
+STATIC_FUNCTION(bool)
+__numeric_int64_align(const xpu_numeric_t *a, const xpu_numeric_t *b,
+					  int64_t *p_aval, int64_t *p_bval, int16_t *p_weight)
+{
+	int64_t		aval, bval, m;
+	int			diff;
+
+	assert(a->kind == XPU_NUMERIC_KIND__VALID &&
+		   b->kind == XPU_NUMERIC_KIND__VALID);
+	if (a->u.value < -LONG_MAX || a->u.value > LONG_MAX ||
+		b->u.value < -LONG_MAX || b->u.value > LONG_MAX)
+		return false;
+	aval = (int64_t)a->u.value;
+	bval = (int64_t)b->u.value;
+	diff = (int)a->weight - (int)b->weight;
+	if (diff > 0)
+	{
+		if (diff > NUMERIC_INT64_MAX_SHIFT)
+			return false;
+		m = __numeric_int64_pow10[diff];
+		if (bval > LONG_MAX / m || bval < -LONG_MAX / m)
+			return false;
+		bval *= m;
+		*p_weight = a->weight;
+	}
+	else if (diff < 0)
+	{
+		if (-diff > NUMERIC_INT64_MAX_SHIFT)
+			return false;
+		m = __numeric_int64_pow10[-diff];
+		if (aval > LONG_MAX / m || aval < -LONG_MAX / m)
+			return false;
+		aval *= m;
+		*p_weight = b->weight;
+	}
+	else
+	{
+		*p_weight = a->weight;
+	}
+	*p_aval = aval;
+	*p_bval = bval;
+	return true;
+}
+
 STATIC_FUNCTION(int)
-__numeric_compare(const xpu_numeric_t *a, const xpu_numeric_t *b)
+__numeric_compare(const xpu_numeric_t *a, const xpu_numeric_t *b,
+				  bool bounded)
 {
 	int128_t	a_val = a->u.value;
 	int128_t	b_val = b->u.value;
@@ -589,6 +672,14 @@ __numeric_compare(const xpu_numeric_t *a, const xpu_numeric_t *b)
 	else if ((b_val > 0 && a_val <= 0) || (b_val == 0 && a_val < 0))
 		return -1;
 	/* Ok, both side are same sign with valid values */
+	if (bounded)
+	{
+		int64_t		a_ival, b_ival;
+		int16_t		weight;
+
+		if (__numeric_int64_align(a, b, &a_ival, &b_ival, &weight))
+			return (a_ival > b_ival ? 1 : (a_ival < b_ival ? -1 : 0));
+	}
 	while (a_weight > b_weight)
 	{
 		b_val *= 10;
@@ -623,9 +714,13 @@ __numeric_compare(const xpu_numeric_t *a, const xpu_numeric_t *b)
 		}																\
 		else															\
 		{																\
+			bool	bounded = ((kexp->expflags &						\
+								KEXP_FLAG__NUMERIC_INT64) != 0);		\
+																		\
 			result->expr_ops = &xpu_bool_ops;							\
 			result->value = (__numeric_compare(&datum_a,				\
-											   &datum_b) OPER 0);		\
+											   &datum_b,				\
+											   bounded) OPER 0);		\
 		}																\
 		return true;													\
 	}
@@ -679,6 +774,18 @@ pgfn_numeric_add(XPU_PGFUNCTION_ARGS)
 		}
 		else
 		{
+			int64_t		a_ival, b_ival;
+			int16_t		weight;
+
+			if ((kexp->expflags & KEXP_FLAG__NUMERIC_INT64) != 0 &&
+				__numeric_int64_align(&datum_a, &datum_b,
+									  &a_ival, &b_ival, &weight))
+			{
+				set_normalized_numeric(result,
+									   (int128_t)a_ival + (int128_t)b_ival,
+									   weight);
+				return true;
+			}
 			while (datum_a.weight > datum_b.weight)
 			{
 				datum_b.u.value *= 10;
@@ -740,6 +847,18 @@ pgfn_numeric_sub(XPU_PGFUNCTION_ARGS)
 		}
 		else
 		{
+			int64_t		a_ival, b_ival;
+			int16_t		weight;
+
+			if ((kexp->expflags & KEXP_FLAG__NUMERIC_INT64) != 0 &&
+				__numeric_int64_align(&datum_a, &datum_b,
+									  &a_ival, &b_ival, &weight))
+			{
+				set_normalized_numeric(result,
+									   (int128_t)a_ival - (int128_t)b_ival,
+									   weight);
+				return true;
+			}
 			while (datum_a.weight > datum_b.weight)
 			{
 				datum_b.u.value *= 10;
@@ -827,6 +946,16 @@ pgfn_numeric_mul(XPU_PGFUNCTION_ARGS)
 					result->kind = XPU_NUMERIC_KIND__NAN;
 			}
 		}
+		else if ((kexp->expflags & KEXP_FLAG__NUMERIC_INT64) != 0 &&
+				 datum_a.u.value >= -LONG_MAX && datum_a.u.value <= LONG_MAX &&
+				 datum_b.u.value >= -LONG_MAX && datum_b.u.value <= LONG_MAX)
+		{
+			/* 64bit x 64bit => 128bit never overflows */
+			set_normalized_numeric(result,
+								   (int128_t)((int64_t)datum_a.u.value) *
+								   (int128_t)((int64_t)datum_b.u.value),
+								   datum_a.weight + datum_b.weight);
+		}
 		else
 		{
 			set_normalized_numeric(result,
@@ -167,6 +167,18 @@ set_normalized_numeric(xpu_numeric_t *result, int128_t value, int16_t weight)
 {
 	if (value == 0)
 		weight = 0;
+	else if (value >= -LONG_MAX && value <= LONG_MAX)
+	{
+		/* 128bit modulo is much expensive than 64bit one */
+		int64_t		ival = (int64_t)value;
+
+		while (ival % 10 == 0)
+		{
+			ival /= 10;
+			weight--;
+		}
+		value = ival;
+	}
 	else
 	{
 		while (value % 10 == 0)
@@ -175,12 +187,36 @@ set_normalized_numeric(xpu_numeric_t *result, int128_t value, int16_t weight)
 			weight--;
 		}
 	}
+#ifndef POSTGRES_H
+	/* xpu_numeric_ops is not linked to the host module */
 	result->expr_ops = &xpu_numeric_ops;
+#endif
 	result->kind     = XPU_NUMERIC_KIND__VALID;
 	result->weight   = weight;
 	result->u.value  = value;
 }
 
+/*
+ * set_fixedpoint_numeric
+ *
+ * It sets up the value with fixed scale, like Arrow::Decimal, as is.
+ * Trailing zeros are not normalized, so the values from a particular
+ * column always have the identical weight; it allows to skip the
+ * per-row 128bit modulo, and comparison/sum of them need no alignment.
+ * Only the hash function has to normalize the value (see also the
+ * set_normalized_numeric above).
+ */
+INLINE_FUNCTION(void)
+set_fixedpoint_numeric(xpu_numeric_t *result, int128_t value, int16_t weight)
+{
+#ifndef POSTGRES_H
+	result->expr_ops = &xpu_numeric_ops;
+#endif
+	result->kind     = XPU_NUMERIC_KIND__VALID;
+	result->weight   = (value == 0 ? 0 : weight);
+	result->u.value  = value;
+}
+
 INLINE_FUNCTION(const char *)
 __xpu_numeric_from_varlena(xpu_numeric_t *result, const varlena *addr)
 {
@@ -213,8 +249,13 @@ __xpu_numeric_from_varlena(xpu_numeric_t *result, const varlena *addr)
 			int			weight  = NUMERIC_WEIGHT(nc, n_head) + 1;
 			int			i, ndigits = NUMERIC_NDIGITS(n_head, len);
 			int128_t	value = 0;
+			int64_t		ival = 0;
 
-			for (i=0; i < ndigits; i++)
+			/* the first 4 digits (< 10^16) never overflow 64bit */
+			for (i=0; i < ndigits && i < 4; i++)
+				ival = ival * PG_NBASE + __Fetch(&digits[i]);
+			value = ival;
+			for (; i < ndigits; i++)
 			{
 				NumericDigit dig = __Fetch(&digits[i]);
 
@@ -42,6 +42,11 @@ TYPE_OPCODE(jsonb, NULL, 0)
 TYPE_OPCODE(geometry, "postgis", 0)
 TYPE_OPCODE(box2df, "postgis", 0)
 TYPE_OPCODE(cube, "cube", 0)
+TYPE_OPCODE(int4range, NULL, 0)
+TYPE_OPCODE(int8range, NULL, 0)
+TYPE_OPCODE(daterange, NULL, 0)
+TYPE_OPCODE(tsrange,   NULL, 0)
+TYPE_OPCODE(tstzrange, NULL, 0)
 
 #ifndef TYPE_ALIAS
 #define TYPE_ALIAS(NAME,EXTENSION,BASE,BASE_EXTENSION)
@@ -696,6 +701,13 @@ __FUNC_OPCODE(bpchariclike, bpchar/text, 800, NULL)
 __FUNC_OPCODE(texticnlike, text/text, 800, NULL)
 __FUNC_OPCODE(bpcharicnlike, bpchar/text, 800, NULL)
 
+/* Regular expression operators (pattern must be a constant) */
+__FUNC_OPCODE(textregexeq, text/text, 1000, NULL)
+__FUNC_OPCODE(textregexne, text/text, 1000, NULL)
+__FUNC_OPCODE(texticregexeq, text/text, 1000, NULL)
+__FUNC_OPCODE(texticregexne, text/text, 1000, NULL)
+__FUNC_OPCODE(regexp_like, text/text, 1000, NULL)
+
 /* String operations */
 FUNC_OPCODE(substr,    text/int4/int4, DEVKIND__ANY, substr,    20, NULL)
 FUNC_OPCODE(substring, text/int4/int4, DEVKIND__ANY, substring, 20, NULL)
@@ -771,6 +783,7 @@ FUNC_OPCODE(st_makepoint, float8/float8/float8,        DEVKIND__ANY, st_makepoin
 FUNC_OPCODE(st_makepoint, float8/float8/float8/float8, DEVKIND__ANY, st_makepoint4, 5, "postgis")
 __FUNC_OPCODE(st_setsrid,        geometry/int4,             5, "postgis")
 __FUNC_OPCODE(st_distance,       geometry/geometry,        99, "postgis")
+FUNC_ALIAS(geometry_distance_centroid, geometry/geometry, DEVKIND__ANY, st_distance, 99, "postgis")
 __FUNC_OPCODE(st_dwithin,        geometry/geometry/float8, 99, "postgis")
 __FUNC_OPCODE(st_linecrossingdirection, geometry/geometry, 99, "postgis")
 __FUNC_OPCODE(st_relate,         geometry/geometry,        99, "postgis")
@@ -799,7 +812,52 @@ __FUNC_OPCODE(cube_gt,        cube/cube,  5, "cube")
 __FUNC_OPCODE(cube_ge,        cube/cube,  5, "cube")
 __FUNC_OPCODE(cube_contains,  cube/cube, 10, "cube")
 __FUNC_OPCODE(cube_contained, cube/cube, 10, "cube")
+__FUNC_OPCODE(cube_overlap,   cube/cube, 10, "cube")
 __FUNC_OPCODE(cube_ll_coord,  cube/int4, 10, "cube")
+__FUNC_OPCODE(cube_distance,      cube/cube, 10, "cube")
+__FUNC_OPCODE(distance_taxicab,   cube/cube, 10, "cube")
+__FUNC_OPCODE(distance_chebyshev, cube/cube, 10, "cube")
+
+/* vector distance functions */
+__FUNC_OPCODE(float2_l2_distance,            array/array, 40, "pg_strom")
+__FUNC_OPCODE(float4_l2_distance,            array/array, 40, "pg_strom")
+__FUNC_OPCODE(float8_l2_distance,            array/array, 40, "pg_strom")
+__FUNC_OPCODE(float2_inner_product,          array/array, 40, "pg_strom")
+__FUNC_OPCODE(float4_inner_product,          array/array, 40, "pg_strom")
+__FUNC_OPCODE(float8_inner_product,          array/array, 40, "pg_strom")
+__FUNC_OPCODE(float2_negative_inner_product, array/array, 40, "pg_strom")
+__FUNC_OPCODE(float4_negative_inner_product, array/array, 40, "pg_strom")
+__FUNC_OPCODE(float8_negative_inner_product, array/array, 40, "pg_strom")
+__FUNC_OPCODE(float2_cosine_distance,        array/array, 40, "pg_strom")
+__FUNC_OPCODE(float4_cosine_distance,        array/array, 40, "pg_strom")
+__FUNC_OPCODE(float8_cosine_distance,        array/array, 40, "pg_strom")
+
+/* range types */
+FUNC_OPCODE(range_overlaps,         int4range/int4range, DEVKIND__ANY, int4range_overlaps,          5, NULL)
+FUNC_OPCODE(range_contains,         int4range/int4range, DEVKIND__ANY, int4range_contains,          5, NULL)
+FUNC_OPCODE(range_contained_by,     int4range/int4range, DEVKIND__ANY, int4range_contained_by,      5, NULL)
+FUNC_OPCODE(range_contains_elem,    int4range/int4, DEVKIND__ANY, int4range_contains_elem,     5, NULL)
+FUNC_OPCODE(elem_contained_by_range, int4/int4range, DEVKIND__ANY, int4range_elem_contained_by, 5, NULL)
+FUNC_OPCODE(range_overlaps,         int8range/int8range, DEVKIND__ANY, int8range_overlaps,          5, NULL)
+FUNC_OPCODE(range_contains,         int8range/int8range, DEVKIND__ANY, int8range_contains,          5, NULL)
+FUNC_OPCODE(range_contained_by,     int8range/int8range, DEVKIND__ANY, int8range_contained_by,      5, NULL)
+FUNC_OPCODE(range_contains_elem,    int8range/int8, DEVKIND__ANY, int8range_contains_elem,     5, NULL)
+FUNC_OPCODE(elem_contained_by_range, int8/int8range, DEVKIND__ANY, int8range_elem_contained_by, 5, NULL)
+FUNC_OPCODE(range_overlaps,         daterange/daterange, DEVKIND__ANY, daterange_overlaps,          5, NULL)
+FUNC_OPCODE(range_contains,         daterange/daterange, DEVKIND__ANY, daterange_contains,          5, NULL)
+FUNC_OPCODE(range_contained_by,     daterange/daterange, DEVKIND__ANY, daterange_contained_by,      5, NULL)
+FUNC_OPCODE(range_contains_elem,    daterange/date, DEVKIND__ANY, daterange_contains_elem,     5, NULL)
+FUNC_OPCODE(elem_contained_by_range, date/daterange, DEVKIND__ANY, daterange_elem_contained_by, 5, NULL)
+FUNC_OPCODE(range_overlaps,         tsrange/tsrange, DEVKIND__ANY, tsrange_overlaps,          5, NULL)
+FUNC_OPCODE(range_contains,         tsrange/tsrange, DEVKIND__ANY, tsrange_contains,          5, NULL)
+FUNC_OPCODE(range_contained_by,     tsrange/tsrange, DEVKIND__ANY, tsrange_contained_by,      5, NULL)
+FUNC_OPCODE(range_contains_elem,    tsrange/timestamp, DEVKIND__ANY, tsrange_contains_elem,     5, NULL)
+FUNC_OPCODE(elem_contained_by_range, timestamp/tsrange, DEVKIND__ANY, tsrange_elem_contained_by, 5, NULL)
+FUNC_OPCODE(range_overlaps,         tstzrange/tstzrange, DEVKIND__ANY, tstzrange_overlaps,          5, NULL)
+FUNC_OPCODE(range_contains,         tstzrange/tstzrange, DEVKIND__ANY, tstzrange_contains,          5, NULL)
+FUNC_OPCODE(range_contained_by,     tstzrange/tstzrange, DEVKIND__ANY, tstzrange_contained_by,      5, NULL)
+FUNC_OPCODE(range_contains_elem,    tstzrange/timestamptz, DEVKIND__ANY, tstzrange_contains_elem,     5, NULL)
+FUNC_OPCODE(elem_contained_by_range, timestamptz/tstzrange, DEVKIND__ANY, tstzrange_elem_contained_by, 5, NULL)
 
 #undef TYPE_OPCODE
 #undef TYPE_ALIAS
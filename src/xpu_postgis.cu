@@ -429,8 +429,34 @@ xpu_geometry_datum_arrow_read(kern_context *kcxt,
 							  uint32_t kds_index,
 							  xpu_datum_t *__result)
 {
-	STROM_ELOG(kcxt, "xpu_geometry_t does not support Arrow type mapping");
-	return false;
+	xpu_geometry_t *geom = (xpu_geometry_t *)__result;
+	const void	   *addr;
+
+	/*
+	 * Only points in interleaved XY coordinates (FixedSizeBinary of 16bytes)
+	 * are mapped to geometry; rawdata of the point references the values
+	 * array of the Arrow column as is.
+	 */
+	if (cmeta->attopts.tag != ArrowType__FixedSizeBinary ||
+		cmeta->attopts.fixed_size_binary.byteWidth != 2 * sizeof(double))
+	{
+		STROM_ELOG(kcxt, "xpu_geometry_t must be mapped on Arrow::FixedSizeBinary");
+		return false;
+	}
+	addr = KDS_ARROW_REF_SIMPLE_DATUM(kds, cmeta, kds_index, 2 * sizeof(double));
+	if (!addr)
+		geom->expr_ops = NULL;
+	else
+	{
+		memset(geom, 0, sizeof(xpu_geometry_t));
+		geom->expr_ops = &xpu_geometry_ops;
+		geom->type     = GEOM_POINTTYPE;
+		geom->srid     = cmeta->attopts.fixed_size_binary.srid;
+		geom->nitems   = 1;
+		geom->rawsize  = 2 * sizeof(double);
+		geom->rawdata  = (const char *)addr;
+	}
+	return true;
 }
 
 STATIC_FUNCTION(bool)
@@ -885,6 +911,26 @@ __geom_segment_side(const POINT2D *p1, const POINT2D *p2, const POINT2D *q)
 	return (side < 0.0 ? -1 : (side > 0.0 ? 1 : 0));
 }
 
+/*
+ * __geom_segment_is_far - true, if the P1-P2 segment never touches the
+ * geometry according to its bounding-box. It allows to skip edge-by-edge
+ * comparison of the segment far from the (often very large) counterpart.
+ */
+INLINE_FUNCTION(bool)
+__geom_segment_is_far(const POINT2D *P1, const POINT2D *P2,
+					  const xpu_geometry_t *geom)
+{
+	geom_bbox_2d	bbox;
+
+	if (!geom->bbox || (geom->flags & GEOM_FLAG__GEODETIC) != 0)
+		return false;
+	memcpy(&bbox, &geom->bbox->d2, sizeof(geom_bbox_2d));
+	return (Max(P1->x, P2->x) < bbox.xmin ||
+			Min(P1->x, P2->x) > bbox.xmax ||
+			Max(P1->y, P2->y) < bbox.ymin ||
+			Min(P1->y, P2->y) > bbox.ymax);
+}
+
 INLINE_FUNCTION(bool)
 __geom_pt_in_arc(const POINT2D *P,
 				 const POINT2D *A1,
@@ -1093,6 +1139,30 @@ __geometry_get_bbox2d(kern_context *kcxt,
 	return true;
 }
 
+/*
+ * xpu_geometry_grid_bbox - bounding-box of the outer geometry for grid-join
+ *
+ * It returns 1 with the bounding-box, 0 if the geometry is NULL or empty
+ * that never satisfies st_dwithin, or -1 if the bounding-box is not
+ * available, thus all the cells must be checked.
+ */
+PUBLIC_FUNCTION(int)
+xpu_geometry_grid_bbox(kern_context *kcxt,
+					   xpu_geometry_t *geom,
+					   geom_bbox_2d *bbox)
+{
+	if (XPU_DATUM_ISNULL(geom))
+		return 0;
+	if (!xpu_geometry_is_valid(kcxt, geom))
+		return -1;
+	if (geom->nitems == 0)
+		return 0;
+	if (!__geometry_get_bbox2d(kcxt, geom, bbox) ||
+		!(bbox->xmin <= bbox->xmax && bbox->ymin <= bbox->ymax))
+		return -1;
+	return 1;
+}
+
 INLINE_FUNCTION(bool)
 __geom_overlaps_bbox2d(const geom_bbox_2d *bbox1,
 					   const geom_bbox_2d *bbox2)
@@ -3610,18 +3680,111 @@ isOnSegment(const POINT2D *seg1,
 	return true;
 }
 
+/*
+ * __geom_lookup_ring_index - returns the edge index of the ring on the inner
+ * buffer of GpuJoin, if any.
+ */
+STATIC_FUNCTION(const kern_geom_ring_index *)
+__geom_lookup_ring_index(kern_context *kcxt, const xpu_geometry_t *ring)
+{
+	const kern_multirels *kmrels = (kcxt ? kcxt->kmrels : NULL);
+	const kern_geom_index *gindex;
+	const kern_geom_ring_index *rindex;
+	uint64_t	offset;
+	uint32_t	head;
+	uint32_t	tail;
+
+	if (!kmrels || kmrels->geom_index_offset == 0 ||
+		ring->nitems < GEOM_RING_INDEX_MIN_POINTS ||
+		ring->rawdata <  (const char *)kmrels ||
+		ring->rawdata >= (const char *)kmrels + kmrels->length)
+		return NULL;
+	offset = (ring->rawdata - (const char *)kmrels);
+	gindex = (const kern_geom_index *)
+		((const char *)kmrels + kmrels->geom_index_offset);
+	head = 0;
+	tail = gindex->nrings;
+	while (head < tail)
+	{
+		uint32_t	curr = (head + tail) / 2;
+		const kern_geom_index_entry *entry = &gindex->entries[curr];
+
+		if (entry->points_offset == offset)
+		{
+			rindex = (const kern_geom_ring_index *)
+				((const char *)kmrels + entry->index_offset);
+			return (rindex->npoints == ring->nitems ? rindex : NULL);
+		}
+		if (entry->points_offset < offset)
+			head = curr + 1;
+		else
+			tail = curr;
+	}
+	return NULL;
+}
+
+/*
+ * __geom_point_in_ring_indexed - same as __geom_point_in_ring, but walks on
+ * the edges in the y-band of the point only.
+ */
+STATIC_FUNCTION(int32_t)
+__geom_point_in_ring_indexed(const xpu_geometry_t *geom,
+							 const kern_geom_ring_index *rindex,
+							 const POINT2D *pt)
+{
+	uint32_t	unitsz = sizeof(double) * GEOM_FLAGS_NDIMS(geom->flags);
+	const uint32_t *edges = rindex->buckets + rindex->nbuckets + 1;
+	uint32_t	bindex = __geom_ring_index_bucket(rindex, pt->y);
+	POINT2D		seg1;
+	POINT2D		seg2;
+	int			wn = 0;
+	double		side;
+
+	for (uint32_t k = rindex->buckets[bindex];
+		 k < rindex->buckets[bindex+1]; k++)
+	{
+		uint32_t	i = edges[k];
+
+		__loadPoint2dIndex(&seg1, geom->rawdata, unitsz, i-1);
+		__loadPoint2dIndex(&seg2, geom->rawdata, unitsz, i);
+
+		/* zero length segments are ignored. */
+		if (seg1.x == seg2.x && seg1.y == seg2.y)
+			continue;
+
+		side = determineSide(&seg1, &seg2, pt);
+		if (side == 0.0)
+		{
+			if (isOnSegment(&seg1, &seg2, pt))
+				return PT_BOUNDARY;		/* on boundary */
+		}
+		if (seg1.y <= pt->y && pt->y < seg2.y && side > 0.0)
+			wn++;
+		else if (seg2.y <= pt->y && pt->y < seg1.y && side < 0.0)
+			wn--;
+	}
+	if (wn == 0)
+		return PT_OUTSIDE;
+	return PT_INSIDE;
+}
+
 STATIC_FUNCTION(int32_t)
 __geom_point_in_ring(const xpu_geometry_t *geom, const POINT2D *pt,
 					 kern_context *kcxt)
 {
 	/* see, point_in_ring */
 	uint32_t		unitsz = sizeof(double) * GEOM_FLAGS_NDIMS(geom->flags);
+	const kern_geom_ring_index *rindex;
 	POINT2D		seg1;
 	POINT2D		seg2;
 	const char *pos;
 	int			wn = 0;
 	double		side;
 
+	rindex = __geom_lookup_ring_index(kcxt, geom);
+	if (rindex)
+		return __geom_point_in_ring_indexed(geom, rindex, pt);
+
 	pos = __loadPoint2d(&seg1, geom->rawdata, unitsz);
 	for (int i=1; i < geom->nitems; i++, seg1 = seg2)
 	{
@@ -4235,7 +4398,10 @@ __geom_relate_seg_line(kern_context *kcxt,
 	uint32_t	nloops;
 	uint32_t	index = start;
 
-	nloops = (geom->type == GEOM_LINETYPE ? 1 : geom->nitems);
+	if (__geom_segment_is_far(&P1, &P2, geom))
+		nloops = 0;		/* P1-P2 never touches the line */
+	else
+		nloops = (geom->type == GEOM_LINETYPE ? 1 : geom->nitems);
 	for (int k=0; k < nloops; k++)
 	{
 		xpu_geometry_t __temp;
@@ -4891,6 +5057,10 @@ __geom_relate_seg_polygon(kern_context *kcxt,
 	int32_t		nrings = 0;
 	uint32_t	__nrings_next;
 
+	/* P1-P2 is obviously outside of the polygons */
+	if (__geom_segment_is_far(&P1, &P2, geom))
+		return IM__INTER_EXTER_1D;
+
 	/* centroid of P1-P2 */
 	Pc.x = (P1.x + P2.x) / 2.0;
 	Pc.y = (P1.y + P2.y) / 2.0;
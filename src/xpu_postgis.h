@@ -198,4 +198,90 @@ typedef struct
 	double	x, y, z, m;
 } POINT4D;
 
+/*
+ * kern_geom_index - edge index of the inner polygons for GpuJoin
+ *
+ * Once all the inner tuples are loaded, the host builds an index for each
+ * ring of POLYGON / MULTIPOLYGON values on the inner buffer, if the ring
+ * has GEOM_RING_INDEX_MIN_POINTS points or more.
+ * The y-range of the ring is divided into @nbuckets bands, and each band
+ * has the edges (identified by the index of the end-point) that overlap
+ * with the band. Edges out of the y-coordinate of the point never affect
+ * the point-in-ring test, so it walks on the edges of one band only.
+ * The directory is sorted by the offset of the ring points from the head
+ * of kern_multirels, for binary search on the device.
+ */
+#define GEOM_RING_INDEX_MIN_POINTS		64
+#define GEOM_RING_INDEX_EDGES_PER_BUCKET	4
+
+typedef struct
+{
+	uint32_t	npoints;		/* number of points in the ring */
+	uint32_t	nbuckets;		/* number of y-bands */
+	double		ymin;			/* lower bound of the y-range */
+	double		ystep;			/* height of the y-band */
+	uint32_t	buckets[1];		/* (nbuckets + 1) indexes to the edges;
+								 * followed by the uint32_t edges[] */
+} kern_geom_ring_index;
+
+typedef struct
+{
+	uint64_t	points_offset;	/* offset of the ring points from kmrels */
+	uint64_t	index_offset;	/* offset of kern_geom_ring_index from kmrels */
+} kern_geom_index_entry;
+
+typedef struct
+{
+	uint32_t	nrings;			/* number of indexed rings */
+	uint32_t	__padding__;
+	kern_geom_index_entry entries[1];
+} kern_geom_index;
+
+INLINE_FUNCTION(uint32_t)
+__geom_ring_index_bucket(const kern_geom_ring_index *rindex, double y)
+{
+	double		v = (y - rindex->ymin) / rindex->ystep;
+
+	if (!(v > 0.0))
+		return 0;
+	if (v >= (double)rindex->nbuckets)
+		return rindex->nbuckets - 1;
+	return (uint32_t)v;
+}
+
+/*
+ * Uniform grid for GpuJoin on st_dwithin
+ *
+ * The inner tuples are sorted by the cell of the center of their bounding-
+ * box, where the cell size is the distance of st_dwithin. The key packs
+ * the cell (cx, cy) in the order of cy, then cx, so the cells of a row
+ * are continuous on the sorted keys.
+ */
+#define GEOM_GRID_CELL_MAX		0x40000000L
+
+INLINE_FUNCTION(int64_t)
+__geom_grid_cell(double v, double cell_sz)
+{
+	double		c = floor(v / cell_sz);
+
+	if (!(c > (double)(-GEOM_GRID_CELL_MAX)))
+		return -GEOM_GRID_CELL_MAX;
+	if (c > (double)GEOM_GRID_CELL_MAX)
+		return GEOM_GRID_CELL_MAX;
+	return (int64_t)c;
+}
+
+INLINE_FUNCTION(int64_t)
+__geom_grid_key(int64_t cx, int64_t cy)
+{
+	return cy * 0x100000000L + (cx + GEOM_GRID_CELL_MAX);
+}
+#define GEOM_GRID_KEY_CX(key)	(((key) & 0xffffffffL) - GEOM_GRID_CELL_MAX)
+#define GEOM_GRID_KEY_CY(key)	((key) >> 32)
+
+EXTERN_FUNCTION(int)
+xpu_geometry_grid_bbox(kern_context *kcxt,
+					   xpu_geometry_t *geom,
+					   geom_bbox_2d *bbox);
+
 #endif /* XPU_POSTGIS_H */
@@ -189,7 +189,8 @@ xpu_bpchar_datum_hash(kern_context*kcxt,
 					  uint32_t *p_hash,
 					  xpu_datum_t *__arg)
 {
-	xpu_bpchar_t *arg = (xpu_bpchar_t *)__arg;
+	xpu_bpchar_t  temp = *((xpu_bpchar_t *)__arg);	/* private copy */
+	xpu_bpchar_t *arg = &temp;
 
 	if (XPU_DATUM_ISNULL(arg))
 		*p_hash = 0;
@@ -206,8 +207,10 @@ xpu_bpchar_datum_comp(kern_context *kcxt,
 					  xpu_datum_t *__str1,
 					  xpu_datum_t *__str2)
 {
-	xpu_bpchar_t *str1 = (xpu_bpchar_t *)__str1;
-	xpu_bpchar_t *str2 = (xpu_bpchar_t *)__str2;
+	xpu_bpchar_t  temp1 = *((xpu_bpchar_t *)__str1);	/* private copy */
+	xpu_bpchar_t *str1 = &temp1;
+	xpu_bpchar_t  temp2 = *((xpu_bpchar_t *)__str2);	/* private copy */
+	xpu_bpchar_t *str2 = &temp2;
 	int			sz1, sz2;
 	int			comp;
 
@@ -349,7 +352,8 @@ xpu_text_datum_hash(kern_context *kcxt,
 					uint32_t *p_hash,
 					xpu_datum_t *__arg)
 {
-	xpu_text_t *arg = (xpu_text_t *)__arg;
+	xpu_text_t  temp = *((xpu_text_t *)__arg);	/* private copy */
+	xpu_text_t *arg = &temp;
 
 	if (XPU_DATUM_ISNULL(arg))
 		*p_hash = 0;
@@ -366,8 +370,10 @@ xpu_text_datum_comp(kern_context *kcxt,
 					xpu_datum_t *__str1,
 					xpu_datum_t *__str2)
 {
-	xpu_text_t *str1 = (xpu_text_t *)__str1;
-	xpu_text_t *str2 = (xpu_text_t *)__str2;
+	xpu_text_t  temp1 = *((xpu_text_t *)__str1);	/* private copy */
+	xpu_text_t *str1 = &temp1;
+	xpu_text_t  temp2 = *((xpu_text_t *)__str2);	/* private copy */
+	xpu_text_t *str2 = &temp2;
 	int			comp;
 
 	if (!xpu_text_is_valid(kcxt, str1) ||
@@ -508,7 +514,8 @@ xpu_bytea_datum_hash(kern_context *kcxt,
 					 uint32_t *p_hash,
 					 xpu_datum_t *__arg)
 {
-	xpu_bytea_t *arg = (xpu_bytea_t *)__arg;
+	xpu_bytea_t  temp = *((xpu_bytea_t *)__arg);	/* private copy */
+	xpu_bytea_t *arg = &temp;
 
 	if (XPU_DATUM_ISNULL(arg))
 		*p_hash = 0;
@@ -525,8 +532,10 @@ xpu_bytea_datum_comp(kern_context *kcxt,
 					 xpu_datum_t *__a,
 					 xpu_datum_t *__b)
 {
-	xpu_bytea_t *a = (xpu_bytea_t *)__a;
-	xpu_bytea_t *b = (xpu_bytea_t *)__b;
+	xpu_bytea_t  temp_a = *((xpu_bytea_t *)__a);	/* private copy */
+	xpu_bytea_t *a = &temp_a;
+	xpu_bytea_t  temp_b = *((xpu_bytea_t *)__b);	/* private copy */
+	xpu_bytea_t *b = &temp_b;
 	int			comp;
 
 	assert(!XPU_DATUM_ISNULL(a) && !XPU_DATUM_ISNULL(b));
@@ -1090,7 +1099,131 @@ PUBLIC_DATA	xpu_encode_info	xpu_encode_catalog[] = {
 GENERIC_MATCH_TEXT_TEMPLATE(GenericMatchText, GetChar)
 GENERIC_MATCH_TEXT_TEMPLATE(GenericCaseMatchText, GetCharUpper)
 
-#define PG_TEXTLIKE_TEMPLATE(FN_NAME,FN_MATCH,OPER)						\
+/*
+ * Fast path for the patterns that consist of literal segments and '%'
+ * (like 'abc%', '%abc', '%abc%def%' ...), without '_' and escapes.
+ * The prefix and suffix segments are compared at the both ends of the text,
+ * then the middle segments are searched from the left greedily, so it does
+ * not need any recursive calls. Byte-by-byte search is safe only if the
+ * encoding is single-byte or UTF-8 (self-synchronized), so we fall back to
+ * the generic recursive matcher elsewhere.
+ */
+#define LIKE_NOT_SIMPLE		(-2)
+
+#define SIMPLE_MATCH_TEXT_TEMPLATE(FUNCNAME, GETCHAR)					\
+	INLINE_FUNCTION(bool)												\
+	__##FUNCNAME##Equal(const char *t, const char *p, int len)			\
+	{																	\
+		for (int i=0; i < len; i++)										\
+		{																\
+			if (GETCHAR(t[i]) != GETCHAR(p[i]))							\
+				return false;											\
+		}																\
+		return true;													\
+	}																	\
+	STATIC_FUNCTION(int)												\
+	__##FUNCNAME##Search(const char *t, int tlen,						\
+						 const char *p, int plen)						\
+	{																	\
+		if (tlen >= 64 && plen >= 4)									\
+		{																\
+			/* Boyer-Moore-Horspool search */							\
+			uint8_t		skip[256];										\
+			int			shift = Min(plen, 255);							\
+																		\
+			memset(skip, shift, sizeof(skip));							\
+			for (int i = plen - shift; i < plen - 1; i++)				\
+				skip[(uint8_t)GETCHAR(p[i])] = plen - 1 - i;			\
+			for (int i=0; i <= tlen - plen; )							\
+			{															\
+				uint8_t	c = GETCHAR(t[i + plen - 1]);					\
+																		\
+				if (c == (uint8_t)GETCHAR(p[plen-1]) &&					\
+					__##FUNCNAME##Equal(t + i, p, plen - 1))			\
+					return i;											\
+				i += skip[c];											\
+			}															\
+		}																\
+		else															\
+		{																\
+			char		firstpat = GETCHAR(*p);							\
+																		\
+			for (int i=0; i <= tlen - plen; i++)						\
+			{															\
+				if (GETCHAR(t[i]) == firstpat &&						\
+					__##FUNCNAME##Equal(t + i + 1, p + 1, plen - 1))	\
+					return i;											\
+			}															\
+		}																\
+		return -1;														\
+	}																	\
+	STATIC_FUNCTION(int)												\
+	FUNCNAME(kern_context *kcxt,										\
+			 const char *t, int tlen,									\
+			 const char *p, int plen)									\
+	{																	\
+		xpu_encode_info	   *encode = SESSION_ENCODE(kcxt->session);		\
+		int			i, j;												\
+																		\
+		if (!encode || (encode->enc_maxlen != 1 &&						\
+						encode->enc_mblen != pg_utf8_mblen))			\
+			return LIKE_NOT_SIMPLE;										\
+		for (i=0; i < plen; i++)										\
+		{																\
+			if (p[i] == '_' || p[i] == '\\')								\
+				return LIKE_NOT_SIMPLE;									\
+		}																\
+		/* pattern without wildcards */									\
+		for (i=0; i < plen && p[i] != '%'; i++);						\
+		if (i == plen)													\
+			return ((tlen == plen && __##FUNCNAME##Equal(t, p, plen))	\
+					? LIKE_TRUE : LIKE_FALSE);							\
+		/* prefix segment */											\
+		if (i > 0)														\
+		{																\
+			if (tlen < i || !__##FUNCNAME##Equal(t, p, i))				\
+				return LIKE_FALSE;										\
+			t += i;														\
+			tlen -= i;													\
+			p += i;														\
+			plen -= i;													\
+		}																\
+		/* suffix segment */											\
+		for (j=plen; j > 0 && p[j-1] != '%'; j--);						\
+		if (j < plen)													\
+		{																\
+			int		len = plen - j;										\
+																		\
+			if (tlen < len ||											\
+				!__##FUNCNAME##Equal(t + tlen - len, p + j, len))		\
+				return LIKE_FALSE;										\
+			tlen -= len;												\
+			plen = j;													\
+		}																\
+		/* middle segments */											\
+		while (plen > 0)												\
+		{																\
+			int		pos;												\
+																		\
+			while (plen > 0 && *p == '%')								\
+				NextByte(p, plen);										\
+			for (i=0; i < plen && p[i] != '%'; i++);					\
+			if (i == 0)													\
+				break;													\
+			pos = __##FUNCNAME##Search(t, tlen, p, i);					\
+			if (pos < 0)												\
+				return LIKE_FALSE;										\
+			t += (pos + i);												\
+			tlen -= (pos + i);											\
+			p += i;														\
+			plen -= i;													\
+		}																\
+		return LIKE_TRUE;												\
+	}
+SIMPLE_MATCH_TEXT_TEMPLATE(SimpleMatchText, GetChar)
+SIMPLE_MATCH_TEXT_TEMPLATE(SimpleCaseMatchText, GetCharUpper)
+
+#define PG_TEXTLIKE_TEMPLATE(FN_NAME,FN_SIMPLE,FN_MATCH,OPER)			\
 	PUBLIC_FUNCTION(bool)												\
 	pgfn_##FN_NAME(XPU_PGFUNCTION_ARGS)									\
 	{																	\
@@ -1106,9 +1239,13 @@ GENERIC_MATCH_TEXT_TEMPLATE(GenericCaseMatchText, GetCharUpper)
 			if (!xpu_text_is_valid(kcxt, &datum_a) ||					\
 				!xpu_text_is_valid(kcxt, &datum_b))						\
 				return false;											\
-			status = FN_MATCH(kcxt,										\
-							  datum_a.value, datum_a.length,			\
-							  datum_b.value, datum_b.length, 0);		\
+			status = FN_SIMPLE(kcxt,									\
+							   datum_a.value, datum_a.length,			\
+							   datum_b.value, datum_b.length);			\
+			if (status == LIKE_NOT_SIMPLE)								\
+				status = FN_MATCH(kcxt,									\
+								  datum_a.value, datum_a.length,		\
+								  datum_b.value, datum_b.length, 0);	\
 			if (status == LIKE_EXCEPTION)								\
 				return false;											\
 			result->value = (status OPER LIKE_TRUE);					\
@@ -1117,14 +1254,14 @@ GENERIC_MATCH_TEXT_TEMPLATE(GenericCaseMatchText, GetCharUpper)
 		return true;													\
 	}																	\
 
-PG_TEXTLIKE_TEMPLATE(like, GenericMatchText, ==)
-PG_TEXTLIKE_TEMPLATE(textlike, GenericMatchText, ==)
-PG_TEXTLIKE_TEMPLATE(notlike, GenericMatchText, !=)
-PG_TEXTLIKE_TEMPLATE(textnlike, GenericMatchText, !=)
-PG_TEXTLIKE_TEMPLATE(texticlike, GenericCaseMatchText, ==)
-PG_TEXTLIKE_TEMPLATE(texticnlike, GenericCaseMatchText, !=)
+PG_TEXTLIKE_TEMPLATE(like, SimpleMatchText, GenericMatchText, ==)
+PG_TEXTLIKE_TEMPLATE(textlike, SimpleMatchText, GenericMatchText, ==)
+PG_TEXTLIKE_TEMPLATE(notlike, SimpleMatchText, GenericMatchText, !=)
+PG_TEXTLIKE_TEMPLATE(textnlike, SimpleMatchText, GenericMatchText, !=)
+PG_TEXTLIKE_TEMPLATE(texticlike, SimpleCaseMatchText, GenericCaseMatchText, ==)
+PG_TEXTLIKE_TEMPLATE(texticnlike, SimpleCaseMatchText, GenericCaseMatchText, !=)
 
-#define PG_BPCHARLIKE_TEMPLATE(FN_NAME,FN_MATCH,OPER)					\
+#define PG_BPCHARLIKE_TEMPLATE(FN_NAME,FN_SIMPLE,FN_MATCH,OPER)		\
 	PUBLIC_FUNCTION(bool)												\
 	pgfn_##FN_NAME(XPU_PGFUNCTION_ARGS)									\
 	{																	\
@@ -1140,9 +1277,13 @@ PG_TEXTLIKE_TEMPLATE(texticnlike, GenericCaseMatchText, !=)
 			if (!xpu_bpchar_is_valid(kcxt, &datum_a) ||					\
 				!xpu_text_is_valid(kcxt, &datum_b))						\
 				return false;											\
-			status = FN_MATCH(kcxt,										\
-							  datum_a.value, datum_a.length,			\
-							  datum_b.value, datum_b.length, 0);		\
+			status = FN_SIMPLE(kcxt,									\
+							   datum_a.value, datum_a.length,			\
+							   datum_b.value, datum_b.length);			\
+			if (status == LIKE_NOT_SIMPLE)								\
+				status = FN_MATCH(kcxt,									\
+								  datum_a.value, datum_a.length,		\
+								  datum_b.value, datum_b.length, 0);	\
 			if (status == LIKE_EXCEPTION)								\
 				return false;											\
 			result->value = (status OPER LIKE_TRUE);					\
@@ -1150,10 +1291,88 @@ PG_TEXTLIKE_TEMPLATE(texticnlike, GenericCaseMatchText, !=)
 		}																\
 		return true;													\
 	}
-PG_BPCHARLIKE_TEMPLATE(bpcharlike, GenericMatchText, ==)
-PG_BPCHARLIKE_TEMPLATE(bpcharnlike, GenericMatchText, !=)
-PG_BPCHARLIKE_TEMPLATE(bpchariclike, GenericCaseMatchText, ==)
-PG_BPCHARLIKE_TEMPLATE(bpcharicnlike, GenericCaseMatchText, !=)
+PG_BPCHARLIKE_TEMPLATE(bpcharlike, SimpleMatchText, GenericMatchText, ==)
+PG_BPCHARLIKE_TEMPLATE(bpcharnlike, SimpleMatchText, GenericMatchText, !=)
+PG_BPCHARLIKE_TEMPLATE(bpchariclike, SimpleCaseMatchText, GenericCaseMatchText, ==)
+PG_BPCHARLIKE_TEMPLATE(bpcharicnlike, SimpleCaseMatchText, GenericCaseMatchText, !=)
+
+/* ----------------------------------------------------------------
+ *
+ * Routines to support regular expression
+ *
+ * ---------------------------------------------------------------- */
+
+/*
+ * The 2nd argument is not a text pattern, but kern_regex_dfa (bytea) that
+ * is compiled by the host code. See regex.c
+ */
+STATIC_FUNCTION(bool)
+__RegexMatchDFA(kern_context *kcxt,
+				const xpu_bytea_t *pattern,
+				const char *t, int tlen,
+				bool *p_matched)
+{
+	const kern_regex_dfa *dfa = (const kern_regex_dfa *)pattern->value;
+	const uint8_t  *accept;
+	uint32_t		nclasses;
+	uint32_t		state;
+
+	if (pattern->length < offsetof(kern_regex_dfa, trans) ||
+		dfa->magic != KERN_REGEX_DFA_MAGIC ||
+		pattern->length < KERN_REGEX_DFA_LENGTH(dfa->nstates, dfa->nclasses))
+	{
+		STROM_ELOG(kcxt, "regular expression is not compiled");
+		return false;
+	}
+	accept = KERN_REGEX_DFA_ACCEPT(dfa);
+	nclasses = dfa->nclasses;
+	state = dfa->start;
+	if ((accept[state] & KERN_REGEX_ACCEPT__MATCH) == 0)
+	{
+		for (int i=0; i < tlen; i++)
+		{
+			uint8_t		cls = dfa->classmap[(uint8_t)t[i]];
+
+			state = dfa->trans[state * nclasses + cls];
+			if (state == 0 ||
+				(accept[state] & KERN_REGEX_ACCEPT__MATCH) != 0)
+				break;
+		}
+	}
+	*p_matched = ((accept[state] & KERN_REGEX_ACCEPT__AT_END) != 0);
+	return true;
+}
+
+#define PG_TEXTREGEX_TEMPLATE(FN_NAME,OPER)								\
+	PUBLIC_FUNCTION(bool)												\
+	pgfn_##FN_NAME(XPU_PGFUNCTION_ARGS)									\
+	{																	\
+		KEXP_PROCESS_ARGS2(bool,										\
+						   text,  datum_a,	/* string */				\
+						   bytea, datum_b);	/* compiled pattern */		\
+		if (XPU_DATUM_ISNULL(&datum_a) || XPU_DATUM_ISNULL(&datum_b))	\
+			result->expr_ops = NULL;									\
+		else															\
+		{																\
+			bool	matched;											\
+																		\
+			if (!xpu_text_is_valid(kcxt, &datum_a) ||					\
+				!xpu_bytea_is_valid(kcxt, &datum_b))					\
+				return false;											\
+			if (!__RegexMatchDFA(kcxt, &datum_b,						\
+								 datum_a.value,							\
+								 datum_a.length, &matched))				\
+				return false;											\
+			result->value = (matched OPER true);						\
+			result->expr_ops = &xpu_bool_ops;							\
+		}																\
+		return true;													\
+	}
+PG_TEXTREGEX_TEMPLATE(textregexeq, ==)
+PG_TEXTREGEX_TEMPLATE(textregexne, !=)
+PG_TEXTREGEX_TEMPLATE(texticregexeq, ==)
+PG_TEXTREGEX_TEMPLATE(texticregexne, !=)
+PG_TEXTREGEX_TEMPLATE(regexp_like, ==)
 
 /*
  * Sub-string
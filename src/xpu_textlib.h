@@ -34,39 +34,77 @@ typedef struct xpu_encode_info	xpu_encode_info;
 
 EXTERN_DATA xpu_encode_info		xpu_encode_catalog[];
 
+/*
+ * kern_regex_dfa
+ *
+ * DFA of the regular-expression operators, compiled from the constant pattern
+ * by the host code (regex.c). Input is the byte sequence of the text, and it
+ * matches as soon as DFA reaches a state with KERN_REGEX_ACCEPT__MATCH, or
+ * the last state has KERN_REGEX_ACCEPT__AT_END (pattern ends with '$').
+ * State-0 is the dead state.
+ */
+#define KERN_REGEX_DFA_MAGIC		0x52454746U		/* 'REGF' */
+#define KERN_REGEX_ACCEPT__MATCH	0x01
+#define KERN_REGEX_ACCEPT__AT_END	0x02
+
+typedef struct
+{
+	uint32_t	magic;
+	uint32_t	nstates;
+	uint32_t	nclasses;
+	uint32_t	start;
+	uint8_t		classmap[256];	/* byte -> class */
+	uint16_t	trans[1];		/* [nstates * nclasses] */
+	/* uint8_t	accept[nstates] follows */
+} kern_regex_dfa;
+
+#define KERN_REGEX_DFA_ACCEPT(dfa)							\
+	((uint8_t *)((dfa)->trans + (dfa)->nstates * (dfa)->nclasses))
+#define KERN_REGEX_DFA_LENGTH(nstates,nclasses)				\
+	(offsetof(kern_regex_dfa, trans) +						\
+	 sizeof(uint16_t) * (nstates) * (nclasses) +			\
+	 sizeof(uint8_t) * (nstates))
+
 /*
  * validation checkers
+ *
+ * The inline compressed datum is decompressed on the kcxt buffer, and
+ * the @arg is updated to the raw one. So, @arg must be a private copy
+ * of the caller, not a kvars-slot that may be saved on the kvecs-buffer.
  */
 INLINE_FUNCTION(bool)
-xpu_bpchar_is_valid(kern_context *kcxt, const xpu_bpchar_t *arg)
+xpu_bpchar_is_valid(kern_context *kcxt, xpu_bpchar_t *arg)
 {
 	if (arg->length < 0)
 	{
-		STROM_CPU_FALLBACK(kcxt, "bpchar datum is compressed or external");
-		return false;
+		if (!xpu_varlena_decompress(kcxt, arg->value,
+									&arg->value,
+									&arg->length))
+			return false;
+		/* see bpchar_truelen */
+		while (arg->length > 0 && arg->value[arg->length-1] == ' ')
+			arg->length--;
 	}
 	return true;
 }
 
 INLINE_FUNCTION(bool)
-xpu_text_is_valid(kern_context *kcxt, const xpu_text_t *arg)
+xpu_text_is_valid(kern_context *kcxt, xpu_text_t *arg)
 {
 	if (arg->length < 0)
-	{
-		STROM_CPU_FALLBACK(kcxt, "text datum is compressed or external");
-		return false;
-	}
+		return xpu_varlena_decompress(kcxt, arg->value,
+									  &arg->value,
+									  &arg->length);
 	return true;
 }
 
 INLINE_FUNCTION(bool)
-xpu_bytea_is_valid(kern_context *kcxt, const xpu_bytea_t *arg)
+xpu_bytea_is_valid(kern_context *kcxt, xpu_bytea_t *arg)
 {
 	if (arg->length < 0)
-	{
-		STROM_CPU_FALLBACK(kcxt, "bytea datum is compressed or external");
-		return false;
-	}
+		return xpu_varlena_decompress(kcxt, arg->value,
+									  &arg->value,
+									  &arg->length);
 	return true;
 }
 
@@ -1251,6 +1251,31 @@ time2t(const int hour, const int min, const int sec, const fsec_t fsec)
 	return (hour * 3600 + min  * 60 + sec) * USECS_PER_SEC + fsec;
 }
 
+/*
+ * __tz_compact_lookup
+ *
+ * It returns the index of the last transition at or before 't' on the
+ * compact transition table, or -1 if 't' is prior to the first transition.
+ */
+INLINE_FUNCTION(int)
+__tz_compact_lookup(const kern_tz_compact *tzc, pg_time_t t)
+{
+	int		lo = 0;
+	int		hi = tzc->ntrans;
+
+	/* find the first transition after 't' */
+	while (lo < hi)
+	{
+		int		mid = (lo + hi) >> 1;
+
+		if (t < tzc->ats[mid])
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+	return lo - 1;
+}
+
 STATIC_FUNCTION(int)
 pg_next_dst_boundary(const pg_time_t *timep,
 					 long int *before_gmtoff,
@@ -1261,9 +1286,27 @@ pg_next_dst_boundary(const pg_time_t *timep,
 					 const pg_tz *tz)
 {
 	const struct pg_tz_ttinfo *ttisp;
+	const kern_tz_compact *tzc = KERN_TZ_COMPACT(tz);
     const pg_time_t t = *timep;
 	int			i, j;
 
+	/* fast path using the compact transition table */
+	if (tzc->ntrans > 0 &&
+		t >= tzc->ats[0] &&
+		t <  tzc->ats[tzc->ntrans - 1])
+	{
+		const int32_t *offsets = KERN_TZ_COMPACT_OFFSETS(tzc);
+
+		i = __tz_compact_lookup(tzc, t) + 1;
+		assert(i > 0 && i < tzc->ntrans);
+		*before_gmtoff = (offsets[i-1] >> 1);
+		*before_isdst  = (offsets[i-1] & 1);
+		*boundary      = tzc->ats[i];
+		*after_gmtoff  = (offsets[i] >> 1);
+		*after_isdst   = (offsets[i] & 1);
+		return 1;
+	}
+
 	if (tz->state.timecnt == 0)
     {
         /* non-DST zone, use lowest-numbered standard type */
@@ -1652,10 +1695,57 @@ STATIC_FUNCTION(bool)
 pg_localtime(struct pg_tm *tx, pg_time_t t, const pg_tz *tz)
 {
 	const struct pg_tz_ttinfo *ttisp;
+	const kern_tz_compact *tzc;
 	bool		rv;
 	int         i;
 
 	assert(tz != NULL);
+	/*
+	 * Fast path using the compact transition table; it needs only a binary
+	 * search on the transition times, then the local time is computed by
+	 * the Julian-day routine, instead of the iterations in __timesub().
+	 */
+	tzc = KERN_TZ_COMPACT(tz);
+	if (tzc->ntrans >= 0 &&
+		t >= tzc->lower_bound &&
+		t <= tzc->upper_bound)
+	{
+		int32_t		offset;
+		pg_time_t	local;
+		pg_time_t	days;
+		int64_t		rem;
+		int			jd, y, m, d;
+
+		i = __tz_compact_lookup(tzc, t);
+		offset = (i < 0 ? tzc->default_offset : KERN_TZ_COMPACT_OFFSETS(tzc)[i]);
+		local = t + (offset >> 1);
+		days = local / SECS_PER_DAY;
+		rem = local % SECS_PER_DAY;
+		if (rem < 0)
+		{
+			rem += SECS_PER_DAY;
+			days--;
+		}
+		if (days >= -(pg_time_t)UNIX_EPOCH_JDATE &&
+			days <= (pg_time_t)INT_MAX - UNIX_EPOCH_JDATE)
+		{
+			jd = (int)(days + UNIX_EPOCH_JDATE);
+			j2date(jd, &y, &m, &d);
+			tx->tm_year   = y - TM_YEAR_BASE;
+			tx->tm_mon    = m - 1;
+			tx->tm_mday   = d;
+			tx->tm_hour   = (int)(rem / SECSPERHOUR);
+			tx->tm_min    = (int)((rem % SECSPERHOUR) / SECSPERMIN);
+			tx->tm_sec    = (int)(rem % SECSPERMIN);
+			tx->tm_wday   = j2day(jd);
+			tx->tm_yday   = jd - date2j(y, 1, 1);
+			tx->tm_isdst  = (offset & 1);
+			tx->tm_gmtoff = (offset >> 1);
+			tx->tm_zone   = NULL;
+			return true;
+		}
+	}
+
 	if ((tz->state.goback && t < tz->state.ats[0]) ||
         (tz->state.goahead && t > tz->state.ats[tz->state.timecnt - 1]))
     {
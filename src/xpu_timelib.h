@@ -195,6 +195,34 @@ struct pg_tz
 };
 typedef struct pg_tz	pg_tz;
 
+/*
+ * kern_tz_compact - compact transition table of the session timezone
+ *
+ * It is always put on the next of pg_tz in the session buffer; see
+ * __build_session_timezone(). The UT offset and DST flag are resolved
+ * for each transition, so device code can find out the local time offset
+ * by a binary search on the ats[] only. ntrans < 0 means it is not available
+ * (e.g, timezone with leap seconds), so device code uses the pg_tz as is.
+ * The timestamp out of the [lower_bound, upper_bound] also uses the pg_tz,
+ * because it needs extrapolation.
+ */
+typedef struct
+{
+	int32_t		ntrans;			/* number of the transitions */
+	int32_t		default_offset;	/* offset before the first transition */
+	int64_t		lower_bound;
+	int64_t		upper_bound;
+	int64_t		ats[1];			/* transition times, in ascending order */
+	/* int32_t	offsets[ntrans] follows; (tt_utoff << 1) | tt_isdst */
+} kern_tz_compact;
+
+#define KERN_TZ_COMPACT_OFFSETS(tzc)				\
+	((int32_t *)((tzc)->ats + Max((tzc)->ntrans, 0)))
+#define KERN_TZ_COMPACT_LENGTH(ntrans)				\
+	(offsetof(kern_tz_compact, ats[(ntrans)]) + sizeof(int32_t) * (ntrans))
+#define KERN_TZ_COMPACT(tz)											\
+	((const kern_tz_compact *)((const char *)(tz) + MAXALIGN(sizeof(pg_tz))))
+
 
 EXTERN_FUNCTION(int)
 xpu_interval_write_heap(kern_context *kcxt,
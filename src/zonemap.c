@@ -0,0 +1,1129 @@
+/*
+ * zonemap.c
+ *
+ * Routines to support zone-map; min/max synopsis per block-range of
+ * the heap tables that have no BRIN-index.
+ * ----
+ * Copyright 2011-2023 (C) KaiGai Kohei <kaigai@kaigai.gr.jp>
+ * Copyright 2014-2023 (C) PG-Strom Developers Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the PostgreSQL License.
+ */
+#include "pg_strom.h"
+
+/*
+ * Zone-map file layout
+ *
+ * $PGDATA/pg_strom_zonemap/<database oid>_<table oid>
+ *
+ * +-----------------------+
+ * | ZoneMapFileHead       |
+ * +-----------------------+ <-- ZONEMAP_DIRTY_OFFSET()
+ * | uint8  dirty[nranges] |   : range is modified after the build
+ * +-----------------------+ <-- ZONEMAP_ATTR_OFFSET(0)
+ * | bool   hasval[nranges]|   : range has any non-NULL values
+ * | Datum  min[nranges]   |
+ * | Datum  max[nranges]   |
+ * +-----------------------+ <-- ZONEMAP_ATTR_OFFSET(1)
+ * |        :              |
+ * +-----------------------+
+ *
+ * The zone-map is built by pgstrom.zonemap_build() under the ShareLock,
+ * then pgstrom.zonemap_sync_trigger() marks the ranges where new tuples
+ * are written on as 'dirty' (deletion never expands min/max, so it is
+ * harmless). The sync trigger must be enabled with ENABLE ALWAYS, because
+ * sessions under session_replication_role = replica skip the triggers
+ * that fire on origin only. Any trigger DDL on the table removes the
+ * zone-map file, because modifications may be made without the sync
+ * trigger.
+ * TRUNCATE, VACUUM FULL or relation rewrite by ALTER TABLE assigns a new
+ * relfilenode, so the existing zone-map file is also ignored.
+ */
+#define ZONEMAP_DIRNAME				"pg_strom_zonemap"
+#define ZONEMAP_FILE_MAGIC			0x5a4d4150U		/* 'ZMAP' */
+#define ZONEMAP_PAGES_PER_RANGE		((1U << 20) / BLCKSZ)	/* 1MB */
+
+typedef struct
+{
+	uint32_t	magic;
+	Oid			relid;
+	Oid			relfilenode;
+	Oid			trigger_oid;
+	BlockNumber	nblocks;			/* # of blocks at the build time */
+	uint32_t	pages_per_range;
+	uint32_t	nranges;
+	int32_t		nattrs;
+	struct {
+		int32_t	attnum;
+		Oid		atttypid;
+	} attrs[FLEXIBLE_ARRAY_MEMBER];
+} ZoneMapFileHead;
+
+#define ZONEMAP_HEAD_LENGTH(nattrs)						\
+	MAXALIGN(offsetof(ZoneMapFileHead, attrs[(nattrs)]))
+#define ZONEMAP_DIRTY_OFFSET(zm_head)					\
+	((off_t)ZONEMAP_HEAD_LENGTH((zm_head)->nattrs))
+#define ZONEMAP_ATTR_LENGTH(zm_head)					\
+	((off_t)MAXALIGN((zm_head)->nranges) +				\
+	 (off_t)(2 * sizeof(Datum)) * (zm_head)->nranges)
+#define ZONEMAP_ATTR_OFFSET(zm_head,index)				\
+	(ZONEMAP_DIRTY_OFFSET(zm_head) +					\
+	 (off_t)MAXALIGN((zm_head)->nranges) +				\
+	 ZONEMAP_ATTR_LENGTH(zm_head) * (index))
+
+/*
+ * ZoneMapState - executor state to skip block-ranges
+ */
+struct ZoneMapState
+{
+	uint32_t		pages_per_range;
+	uint32_t		nranges;
+	List		   *orig_quals;		/* for EXPLAIN */
+	List		   *eval_quals;
+	Bitmapset	   *stat_attrs;
+	Bitmapset	   *load_attrs;
+	ExprState	   *eval_state;
+	ExprContext	   *econtext;
+	uint8_t		   *dirty;
+	bool		  **hasval;			/* per attribute, NULL if not loaded */
+	Datum		  **min_values;
+	Datum		  **max_values;
+	bool			skipmap_ready;
+	uint32_t		skipmap_nranges;	/* # of ranges to be skipped */
+	bool		   *skipmap;
+};
+
+/*
+ * ZoneMapSyncCache - per-backend cache for the sync trigger
+ */
+typedef struct
+{
+	Oid			relid;			/* hash key */
+	File		filp;			/* -1, if no valid zone-map */
+	off_t		dirty_offset;
+	uint32_t	pages_per_range;
+	uint32_t	nranges;
+	uint8_t	   *dirty;			/* local copy of the dirty flags */
+} ZoneMapSyncCache;
+
+/* static variables */
+static bool		pgstrom_enable_zonemap;		/* GUC */
+static HTAB	   *zonemap_sync_htab = NULL;
+static Oid		__zonemap_sync_trigger_function_oid = InvalidOid;
+static object_access_hook_type object_access_next = NULL;
+
+/*
+ * zonemap_sync_trigger_function_oid
+ */
+static Oid
+zonemap_sync_trigger_function_oid(void)
+{
+	if (!OidIsValid(__zonemap_sync_trigger_function_oid))
+	{
+		Oid			namespace_oid;
+		oidvector	argtypes;
+
+		namespace_oid = get_namespace_oid("pgstrom", true);
+		if (!OidIsValid(namespace_oid))
+			return InvalidOid;
+
+		memset(&argtypes, 0, sizeof(oidvector));
+		SET_VARSIZE(&argtypes, offsetof(oidvector, values[0]));
+		argtypes.ndim = 1;
+		argtypes.dataoffset = 0;
+		argtypes.elemtype = OIDOID;
+		argtypes.dim1 = 0;
+		argtypes.lbound1 = 0;
+
+		__zonemap_sync_trigger_function_oid
+			= GetSysCacheOid3(PROCNAMEARGSNSP,
+							  Anum_pg_proc_oid,
+							  CStringGetDatum("zonemap_sync_trigger"),
+							  PointerGetDatum(&argtypes),
+							  ObjectIdGetDatum(namespace_oid));
+	}
+	return __zonemap_sync_trigger_function_oid;
+}
+
+/*
+ * __zoneMapLookupSyncTrigger
+ *
+ * It returns OID of the sync trigger that fires on any INSERT/UPDATE
+ * of the table unconditionally, regardless of session_replication_role.
+ */
+static Oid
+__zoneMapLookupSyncTrigger(Relation rel)
+{
+	TriggerDesc *trigdesc = rel->trigdesc;
+	Oid			trigger_func_oid = zonemap_sync_trigger_function_oid();
+
+	if (!trigdesc || !OidIsValid(trigger_func_oid))
+		return InvalidOid;
+	for (int i=0; i < trigdesc->numtriggers; i++)
+	{
+		Trigger	   *trig = &trigdesc->triggers[i];
+
+		if (TRIGGER_FOR_ROW(trig->tgtype) &&
+			TRIGGER_FOR_AFTER(trig->tgtype) &&
+			TRIGGER_FOR_INSERT(trig->tgtype) &&
+			TRIGGER_FOR_UPDATE(trig->tgtype) &&
+			trig->tgenabled == TRIGGER_FIRES_ALWAYS &&
+			trig->tgfoid == trigger_func_oid &&
+			trig->tgnattr == 0 &&
+			trig->tgqual == NULL)
+			return trig->tgoid;
+	}
+	return InvalidOid;
+}
+
+/*
+ * __zoneMapFilePath
+ */
+static char *
+__zoneMapFilePath(Oid relid)
+{
+	return psprintf("%s/%u_%u", ZONEMAP_DIRNAME, MyDatabaseId, relid);
+}
+
+static bool
+__zoneMapReadFile(File filp, void *buffer, size_t length, off_t f_pos)
+{
+	char	   *pos = buffer;
+
+	while (length > 0)
+	{
+		int		nbytes = Min(length, (1UL << 30));
+
+		nbytes = FileRead(filp, pos, nbytes, f_pos,
+						  WAIT_EVENT_DATA_FILE_READ);
+		if (nbytes <= 0)
+			return false;
+		pos += nbytes;
+		f_pos += nbytes;
+		length -= nbytes;
+	}
+	return true;
+}
+
+static void
+__zoneMapWriteFile(int fdesc, const void *buffer, size_t length,
+				   const char *pathname)
+{
+	const char *pos = buffer;
+
+	while (length > 0)
+	{
+		ssize_t	nbytes = write(fdesc, pos, length);
+
+		if (nbytes < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not write file \"%s\": %m", pathname)));
+		}
+		pos += nbytes;
+		length -= nbytes;
+	}
+}
+
+/*
+ * __zoneMapOpenFile
+ *
+ * It opens the zone-map file of the relation, then returns its header
+ * only if it is consistent to the current relation.
+ */
+static ZoneMapFileHead *
+__zoneMapOpenFile(Relation rel, int fflags, File *p_filp)
+{
+	TupleDesc	tupdesc = RelationGetDescr(rel);
+	ZoneMapFileHead	temp;
+	ZoneMapFileHead *zm_head;
+	char	   *fname = __zoneMapFilePath(RelationGetRelid(rel));
+	File		filp;
+	size_t		head_sz;
+
+	filp = PathNameOpenFile(fname, fflags | PG_BINARY);
+	if (filp < 0)
+	{
+		if (errno != ENOENT)
+			elog(WARNING, "failed to open zone-map file '%s': %m", fname);
+		pfree(fname);
+		return NULL;
+	}
+	pfree(fname);
+
+	if (!__zoneMapReadFile(filp, &temp, offsetof(ZoneMapFileHead, attrs), 0) ||
+		temp.magic != ZONEMAP_FILE_MAGIC ||
+		temp.relid != RelationGetRelid(rel) ||
+		temp.relfilenode != RelationGetForm(rel)->relfilenode ||
+		temp.pages_per_range == 0 ||
+		temp.nattrs <= 0 ||
+		temp.nattrs > tupdesc->natts)
+		goto bailout;
+	head_sz = ZONEMAP_HEAD_LENGTH(temp.nattrs);
+	zm_head = palloc(head_sz);
+	if (!__zoneMapReadFile(filp, zm_head, head_sz, 0))
+		goto bailout;
+	for (int i=0; i < zm_head->nattrs; i++)
+	{
+		int		anum = zm_head->attrs[i].attnum;
+		Form_pg_attribute attr;
+
+		if (anum <= 0 || anum > tupdesc->natts)
+			goto bailout;
+		attr = TupleDescAttr(tupdesc, anum-1);
+		if (attr->attisdropped ||
+			attr->atttypid != zm_head->attrs[i].atttypid)
+			goto bailout;
+	}
+	*p_filp = filp;
+	return zm_head;
+
+bailout:
+	FileClose(filp);
+	return NULL;
+}
+
+/* ------------------------------------------------------------
+ *
+ * Executor routines
+ *
+ * ------------------------------------------------------------
+ */
+static bool
+__buildZoneMapStatsOper(ZoneMapState *zm_state,
+						ScanState *ss,
+						OpExpr *op,
+						bool reverse)
+{
+	Scan	   *scan = (Scan *)ss->ps.plan;
+	Oid			opcode;
+	Var		   *var;
+	Node	   *arg;
+	Expr	   *expr;
+	Oid			opfamily = InvalidOid;
+	StrategyNumber strategy = InvalidStrategy;
+	CatCList   *catlist;
+
+	if (!reverse)
+	{
+		opcode = op->opno;
+		var = linitial(op->args);
+		arg = lsecond(op->args);
+	}
+	else
+	{
+		opcode = get_commutator(op->opno);
+		var = lsecond(op->args);
+		arg = linitial(op->args);
+	}
+	/* Is it VAR <OPER> ARG form? (see __buildArrowStatsOper) */
+	if (!IsA(var, Var) || !OidIsValid(opcode))
+		return false;
+	if (var->varnosyn != scan->scanrelid)
+		return false;
+	if (!bms_is_member(var->varattnosyn, zm_state->stat_attrs))
+		return false;
+	if (contain_var_clause(arg) ||
+		contain_volatile_functions(arg))
+		return false;
+
+	catlist = SearchSysCacheList1(AMOPOPID, ObjectIdGetDatum(opcode));
+	for (int i=0; i < catlist->n_members; i++)
+	{
+		HeapTuple	tuple = &catlist->members[i]->tuple;
+		Form_pg_amop amop = (Form_pg_amop) GETSTRUCT(tuple);
+
+		if (amop->amopmethod == BRIN_AM_OID)
+		{
+			opfamily = amop->amopfamily;
+			strategy = amop->amopstrategy;
+			break;
+		}
+	}
+	ReleaseSysCacheList(catlist);
+
+	if (strategy == BTLessStrategyNumber ||
+		strategy == BTLessEqualStrategyNumber)
+	{
+		/* if (VAR < ARG) --> (Min >= ARG), can be skipped */
+		/* if (VAR <= ARG) --> (Min > ARG), can be skipped */
+		opcode = get_negator(opcode);
+		if (!OidIsValid(opcode))
+			return false;
+		expr = make_opclause(opcode,
+							 op->opresulttype,
+							 op->opretset,
+							 (Expr *)makeVar(INNER_VAR,
+											 var->varattno,
+											 var->vartype,
+											 var->vartypmod,
+											 var->varcollid,
+											 0),
+							 (Expr *)copyObject(arg),
+							 op->opcollid,
+							 op->inputcollid);
+		set_opfuncid((OpExpr *)expr);
+		zm_state->eval_quals = lappend(zm_state->eval_quals, expr);
+	}
+	else if (strategy == BTGreaterEqualStrategyNumber ||
+			 strategy == BTGreaterStrategyNumber)
+	{
+		/* if (VAR > ARG) --> (Max <= ARG), can be skipped */
+		/* if (VAR >= ARG) --> (Max < ARG), can be skipped */
+		opcode = get_negator(opcode);
+		if (!OidIsValid(opcode))
+			return false;
+		expr = make_opclause(opcode,
+							 op->opresulttype,
+							 op->opretset,
+							 (Expr *)makeVar(OUTER_VAR,
+											 var->varattno,
+											 var->vartype,
+											 var->vartypmod,
+											 var->varcollid,
+											 0),
+							 (Expr *)copyObject(arg),
+							 op->opcollid,
+							 op->inputcollid);
+		set_opfuncid((OpExpr *)expr);
+		zm_state->eval_quals = lappend(zm_state->eval_quals, expr);
+	}
+	else if (strategy == BTEqualStrategyNumber)
+	{
+		/* (VAR = ARG) --> (Min > ARG) || (Max < ARG), can be skipped */
+		opcode = get_opfamily_member(opfamily, var->vartype,
+									 exprType((Node *)arg),
+									 BTGreaterStrategyNumber);
+		if (!OidIsValid(opcode))
+			return false;
+		expr = make_opclause(opcode,
+							 op->opresulttype,
+							 op->opretset,
+							 (Expr *)makeVar(INNER_VAR,
+											 var->varattno,
+											 var->vartype,
+											 var->vartypmod,
+											 var->varcollid,
+											 0),
+							 (Expr *)copyObject(arg),
+							 op->opcollid,
+							 op->inputcollid);
+		set_opfuncid((OpExpr *)expr);
+		zm_state->eval_quals = lappend(zm_state->eval_quals, expr);
+
+		opcode = get_opfamily_member(opfamily, var->vartype,
+									 exprType((Node *)arg),
+									 BTLessStrategyNumber);
+		if (!OidIsValid(opcode))
+			return false;
+		expr = make_opclause(opcode,
+							 op->opresulttype,
+							 op->opretset,
+							 (Expr *)makeVar(OUTER_VAR,
+											 var->varattno,
+											 var->vartype,
+											 var->vartypmod,
+											 var->varcollid,
+											 0),
+							 (Expr *)copyObject(arg),
+							 op->opcollid,
+							 op->inputcollid);
+		set_opfuncid((OpExpr *)expr);
+		zm_state->eval_quals = lappend(zm_state->eval_quals, expr);
+	}
+	else
+	{
+		return false;
+	}
+	zm_state->load_attrs = bms_add_member(zm_state->load_attrs, var->varattno);
+
+	return true;
+}
+
+/*
+ * pgstromZoneMapExecBegin
+ */
+void
+pgstromZoneMapExecBegin(pgstromTaskState *pts, List *scan_quals)
+{
+	ScanState	   *ss = &pts->css.ss;
+	Relation		relation = ss->ss_currentRelation;
+	TupleDesc		tupdesc = RelationGetDescr(relation);
+	ZoneMapFileHead *zm_head;
+	ZoneMapState   *zm_state;
+	ExprContext	   *econtext;
+	Expr		   *eval_expr;
+	Oid				trigger_oid;
+	File			filp;
+	ListCell	   *lc;
+
+	if (!pgstrom_enable_zonemap || scan_quals == NIL)
+		return;
+	trigger_oid = __zoneMapLookupSyncTrigger(relation);
+	if (!OidIsValid(trigger_oid))
+		return;
+	zm_head = __zoneMapOpenFile(relation, O_RDONLY, &filp);
+	if (!zm_head)
+		return;
+	if (zm_head->trigger_oid != trigger_oid)
+		goto bailout;
+
+	zm_state = palloc0(sizeof(ZoneMapState));
+	zm_state->pages_per_range = zm_head->pages_per_range;
+	zm_state->nranges = zm_head->nranges;
+	for (int i=0; i < zm_head->nattrs; i++)
+		zm_state->stat_attrs = bms_add_member(zm_state->stat_attrs,
+											  zm_head->attrs[i].attnum);
+	scan_quals = fixup_scanstate_expressions(ss, scan_quals);
+	foreach (lc, scan_quals)
+	{
+		OpExpr *op = lfirst(lc);
+
+		if (IsA(op, OpExpr) && list_length(op->args) == 2 &&
+			(__buildZoneMapStatsOper(zm_state, ss, op, false) ||
+			 __buildZoneMapStatsOper(zm_state, ss, op, true)))
+		{
+			zm_state->orig_quals = lappend(zm_state->orig_quals, op);
+		}
+	}
+	if (zm_state->eval_quals == NIL)
+		goto bailout;
+
+	/* load the dirty flags and min/max statistics */
+	zm_state->dirty = palloc(zm_head->nranges);
+	if (!__zoneMapReadFile(filp, zm_state->dirty, zm_head->nranges,
+						   ZONEMAP_DIRTY_OFFSET(zm_head)))
+		goto bailout;
+	zm_state->hasval = palloc0(sizeof(bool *) * tupdesc->natts);
+	zm_state->min_values = palloc0(sizeof(Datum *) * tupdesc->natts);
+	zm_state->max_values = palloc0(sizeof(Datum *) * tupdesc->natts);
+	for (int i=0; i < zm_head->nattrs; i++)
+	{
+		int		anum = zm_head->attrs[i].attnum;
+		off_t	f_pos = ZONEMAP_ATTR_OFFSET(zm_head, i);
+		size_t	nranges = zm_head->nranges;
+
+		if (!bms_is_member(anum, zm_state->load_attrs))
+			continue;
+		zm_state->hasval[anum-1] = palloc(sizeof(bool) * nranges);
+		zm_state->min_values[anum-1] = palloc(sizeof(Datum) * nranges);
+		zm_state->max_values[anum-1] = palloc(sizeof(Datum) * nranges);
+		if (!__zoneMapReadFile(filp, zm_state->hasval[anum-1],
+							   sizeof(bool) * nranges, f_pos))
+			goto bailout;
+		f_pos += MAXALIGN(nranges);
+		if (!__zoneMapReadFile(filp, zm_state->min_values[anum-1],
+							   sizeof(Datum) * nranges, f_pos))
+			goto bailout;
+		f_pos += sizeof(Datum) * nranges;
+		if (!__zoneMapReadFile(filp, zm_state->max_values[anum-1],
+							   sizeof(Datum) * nranges, f_pos))
+			goto bailout;
+	}
+	FileClose(filp);
+
+	if (list_length(zm_state->eval_quals) == 1)
+		eval_expr = linitial(zm_state->eval_quals);
+	else
+		eval_expr = make_orclause(zm_state->eval_quals);
+
+	econtext = CreateExprContext(ss->ps.state);
+	econtext->ecxt_innertuple = MakeSingleTupleTableSlot(tupdesc, &TTSOpsVirtual);
+	econtext->ecxt_outertuple = MakeSingleTupleTableSlot(tupdesc, &TTSOpsVirtual);
+
+	zm_state->eval_state = ExecInitExpr(eval_expr, &ss->ps);
+	zm_state->econtext = econtext;
+	zm_state->skipmap = palloc(sizeof(bool) * zm_head->nranges);
+
+	pts->zm_state = zm_state;
+	return;
+
+bailout:
+	FileClose(filp);
+}
+
+/*
+ * __zoneMapBuildSkipMap
+ *
+ * It is deferred to the first call of pgstromZoneMapSkipBlock(), because
+ * the ARG of the qualifiers may reference the executor parameters.
+ */
+static void
+__zoneMapBuildSkipMap(ZoneMapState *zm_state)
+{
+	ExprContext	   *econtext = zm_state->econtext;
+	TupleTableSlot *min_values = econtext->ecxt_innertuple;
+	TupleTableSlot *max_values = econtext->ecxt_outertuple;
+
+	zm_state->skipmap_nranges = 0;
+	for (uint32_t index=0; index < zm_state->nranges; index++)
+	{
+		Datum		datum;
+		bool		isnull;
+		int			anum;
+
+		zm_state->skipmap[index] = false;
+		if (zm_state->dirty[index])
+			continue;
+
+		ExecStoreAllNullTuple(min_values);
+		ExecStoreAllNullTuple(max_values);
+		for (anum = bms_next_member(zm_state->load_attrs, -1);
+			 anum >= 0;
+			 anum = bms_next_member(zm_state->load_attrs, anum))
+		{
+			if (zm_state->hasval[anum-1][index])
+			{
+				min_values->tts_isnull[anum-1] = false;
+				max_values->tts_isnull[anum-1] = false;
+				min_values->tts_values[anum-1] = zm_state->min_values[anum-1][index];
+				max_values->tts_values[anum-1] = zm_state->max_values[anum-1][index];
+			}
+		}
+		datum = ExecEvalExprSwitchContext(zm_state->eval_state, econtext, &isnull);
+		if (!isnull && DatumGetBool(datum))
+		{
+			zm_state->skipmap[index] = true;
+			zm_state->skipmap_nranges++;
+		}
+		ResetExprContext(econtext);
+	}
+	zm_state->skipmap_ready = true;
+}
+
+/*
+ * pgstromZoneMapSkipBlock
+ */
+bool
+pgstromZoneMapSkipBlock(pgstromTaskState *pts, BlockNumber block_num)
+{
+	ZoneMapState   *zm_state = pts->zm_state;
+	uint32_t		index = block_num / zm_state->pages_per_range;
+
+	if (!zm_state->skipmap_ready)
+		__zoneMapBuildSkipMap(zm_state);
+	return (index < zm_state->nranges && zm_state->skipmap[index]);
+}
+
+/*
+ * pgstromZoneMapExecReset
+ */
+void
+pgstromZoneMapExecReset(pgstromTaskState *pts)
+{
+	pts->zm_state->skipmap_ready = false;
+}
+
+/*
+ * pgstromZoneMapExecEnd
+ */
+void
+pgstromZoneMapExecEnd(pgstromTaskState *pts)
+{
+	ZoneMapState   *zm_state = pts->zm_state;
+	ExprContext	   *econtext = zm_state->econtext;
+
+	ExecDropSingleTupleTableSlot(econtext->ecxt_innertuple);
+	ExecDropSingleTupleTableSlot(econtext->ecxt_outertuple);
+	econtext->ecxt_innertuple = NULL;
+	econtext->ecxt_outertuple = NULL;
+
+	FreeExprContext(econtext, true);
+}
+
+/*
+ * pgstromZoneMapExplain
+ */
+void
+pgstromZoneMapExplain(pgstromTaskState *pts,
+					  List *dcontext,
+					  ExplainState *es)
+{
+	pgstromSharedState *ps_state = pts->ps_state;
+	ZoneMapState   *zm_state = pts->zm_state;
+	StringInfoData	buf;
+	ListCell	   *lc;
+
+	initStringInfo(&buf);
+	foreach (lc, zm_state->orig_quals)
+	{
+		Node   *qual = lfirst(lc);
+		char   *temp;
+
+		temp = deparse_expression(qual, dcontext, es->verbose, false);
+		if (buf.len > 0)
+			appendStringInfoString(&buf, ", ");
+		appendStringInfoString(&buf, temp);
+		pfree(temp);
+	}
+	if (es->analyze && ps_state)
+		appendStringInfo(&buf, "  [skipped: %lu blocks]",
+						 pg_atomic_read_u64(&ps_state->zonemap_skipped_blocks));
+	ExplainPropertyText("Zone Map", buf.data, es);
+	pfree(buf.data);
+}
+
+/* ------------------------------------------------------------
+ *
+ * SQL functions to build / drop the zone-map, and sync trigger
+ *
+ * ------------------------------------------------------------
+ */
+static void
+__zoneMapCheckTableOwner(Relation rel)
+{
+	if (RelationGetForm(rel)->relkind != RELKIND_RELATION)
+		ereport(ERROR,
+				(errcode(ERRCODE_WRONG_OBJECT_TYPE),
+				 errmsg("\"%s\" is not a regular table",
+						RelationGetRelationName(rel))));
+	if (RelationGetForm(rel)->relam != HEAP_TABLE_AM_OID)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("zone-map supports only heap tables")));
+	if (!pg_class_ownercheck(RelationGetRelid(rel), GetUserId()))
+		aclcheck_error(ACLCHECK_NOT_OWNER,
+					   get_relkind_objtype(RelationGetForm(rel)->relkind),
+					   RelationGetRelationName(rel));
+}
+
+/*
+ * pgstrom_zonemap_build
+ */
+PG_FUNCTION_INFO_V1(pgstrom_zonemap_build);
+PUBLIC_FUNCTION(Datum)
+pgstrom_zonemap_build(PG_FUNCTION_ARGS)
+{
+	Oid			table_oid = PG_GETARG_OID(0);
+	Relation	rel;
+	TupleDesc	tupdesc;
+	TableScanDesc scan;
+	TupleTableSlot *slot;
+	ZoneMapFileHead *zm_head;
+	FmgrInfo  **cmp_procs;
+	Oid		   *collations;
+	bool	  **hasval;
+	Datum	  **min_values;
+	Datum	  **max_values;
+	uint32_t	nranges;
+	int			nattrs = 0;
+	int			maxattnum = 0;
+	int			fdesc;
+	char	   *fname;
+	char	   *tname;
+
+	/* ShareLock blocks concurrent writers during the build */
+	rel = table_open(table_oid, ShareLock);
+	tupdesc = RelationGetDescr(rel);
+	__zoneMapCheckTableOwner(rel);
+
+	zm_head = palloc0(ZONEMAP_HEAD_LENGTH(tupdesc->natts));
+	zm_head->magic = ZONEMAP_FILE_MAGIC;
+	zm_head->relid = RelationGetRelid(rel);
+	zm_head->relfilenode = RelationGetForm(rel)->relfilenode;
+	zm_head->trigger_oid = __zoneMapLookupSyncTrigger(rel);
+	if (!OidIsValid(zm_head->trigger_oid))
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("zone-map sync trigger is not configured on \"%s\"",
+						RelationGetRelationName(rel)),
+				 errhint("CREATE TRIGGER ... AFTER INSERT OR UPDATE ON %s FOR EACH ROW EXECUTE FUNCTION pgstrom.zonemap_sync_trigger(), then ALTER TABLE %s ENABLE ALWAYS TRIGGER ...",
+						 RelationGetRelationName(rel),
+						 RelationGetRelationName(rel))));
+	zm_head->nblocks = RelationGetNumberOfBlocks(rel);
+	zm_head->pages_per_range = ZONEMAP_PAGES_PER_RANGE;
+	nranges = (zm_head->nblocks +
+			   ZONEMAP_PAGES_PER_RANGE - 1) / ZONEMAP_PAGES_PER_RANGE;
+	zm_head->nranges = nranges;
+
+	/* pick up fixed-length, inline attributes with btree comparator */
+	cmp_procs  = palloc0(sizeof(FmgrInfo *) * tupdesc->natts);
+	collations = palloc0(sizeof(Oid) * tupdesc->natts);
+	hasval     = palloc0(sizeof(bool *) * tupdesc->natts);
+	min_values = palloc0(sizeof(Datum *) * tupdesc->natts);
+	max_values = palloc0(sizeof(Datum *) * tupdesc->natts);
+	for (int j=0; j < tupdesc->natts; j++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, j);
+		TypeCacheEntry *tcache;
+
+		if (attr->attisdropped || !attr->attbyval || attr->attlen <= 0)
+			continue;
+		tcache = lookup_type_cache(attr->atttypid, TYPECACHE_CMP_PROC_FINFO);
+		if (!OidIsValid(tcache->cmp_proc_finfo.fn_oid))
+			continue;
+		cmp_procs[j]  = &tcache->cmp_proc_finfo;
+		collations[j] = attr->attcollation;
+		hasval[j]     = palloc0(sizeof(bool) * nranges);
+		min_values[j] = palloc0(sizeof(Datum) * nranges);
+		max_values[j] = palloc0(sizeof(Datum) * nranges);
+		zm_head->attrs[nattrs].attnum   = attr->attnum;
+		zm_head->attrs[nattrs].atttypid = attr->atttypid;
+		nattrs++;
+		maxattnum = attr->attnum;
+	}
+	if (nattrs == 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("\"%s\" has no columns available for zone-map",
+						RelationGetRelationName(rel))));
+	zm_head->nattrs = nattrs;
+
+	/*
+	 * MEMO: SnapshotAny also picks up the tuples which are invisible to
+	 * us, but may be visible to the older snapshots.
+	 */
+	slot = table_slot_create(rel, NULL);
+	scan = table_beginscan(rel, SnapshotAny, 0, NULL);
+	while (table_scan_getnextslot(scan, ForwardScanDirection, slot))
+	{
+		uint32_t	index = (ItemPointerGetBlockNumber(&slot->tts_tid) /
+							 ZONEMAP_PAGES_PER_RANGE);
+
+		CHECK_FOR_INTERRUPTS();
+		if (index >= nranges)
+			continue;
+		slot_getsomeattrs(slot, maxattnum);
+		for (int j=0; j < maxattnum; j++)
+		{
+			Datum	datum = slot->tts_values[j];
+
+			if (!cmp_procs[j] || slot->tts_isnull[j])
+				continue;
+			if (!hasval[j][index])
+			{
+				hasval[j][index] = true;
+				min_values[j][index] = datum;
+				max_values[j][index] = datum;
+			}
+			else if (DatumGetInt32(FunctionCall2Coll(cmp_procs[j],
+													 collations[j],
+													 datum,
+													 min_values[j][index])) < 0)
+				min_values[j][index] = datum;
+			else if (DatumGetInt32(FunctionCall2Coll(cmp_procs[j],
+													 collations[j],
+													 datum,
+													 max_values[j][index])) > 0)
+				max_values[j][index] = datum;
+		}
+	}
+	table_endscan(scan);
+	ExecDropSingleTupleTableSlot(slot);
+
+	/* write out the zone-map file, then replace atomically */
+	if (MakePGDirectory(ZONEMAP_DIRNAME) != 0 && errno != EEXIST)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not create directory \"%s\": %m",
+						ZONEMAP_DIRNAME)));
+	fname = __zoneMapFilePath(RelationGetRelid(rel));
+	tname = psprintf("%s.tmp", fname);
+	fdesc = OpenTransientFile(tname, O_RDWR | O_CREAT | O_TRUNC | PG_BINARY);
+	if (fdesc < 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not create file \"%s\": %m", tname)));
+	__zoneMapWriteFile(fdesc, zm_head, ZONEMAP_HEAD_LENGTH(nattrs), tname);
+	{
+		size_t	pad_sz = MAXALIGN(nranges);
+		char   *zero = palloc0(pad_sz);
+
+		/* dirty flags */
+		__zoneMapWriteFile(fdesc, zero, pad_sz, tname);
+		for (int j=0; j < tupdesc->natts; j++)
+		{
+			if (!cmp_procs[j])
+				continue;
+			memset(zero, 0, pad_sz);
+			memcpy(zero, hasval[j], sizeof(bool) * nranges);
+			__zoneMapWriteFile(fdesc, zero, pad_sz, tname);
+			__zoneMapWriteFile(fdesc, min_values[j],
+							   sizeof(Datum) * nranges, tname);
+			__zoneMapWriteFile(fdesc, max_values[j],
+							   sizeof(Datum) * nranges, tname);
+		}
+		pfree(zero);
+	}
+	if (pg_fsync(fdesc) != 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not fsync file \"%s\": %m", tname)));
+	CloseTransientFile(fdesc);
+	durable_rename(tname, fname, ERROR);
+
+	/* let the sync-trigger of other backends reopen the new file */
+	CacheInvalidateRelcache(rel);
+	table_close(rel, NoLock);
+
+	PG_RETURN_INT64(nranges);
+}
+
+/*
+ * pgstrom_zonemap_drop
+ */
+PG_FUNCTION_INFO_V1(pgstrom_zonemap_drop);
+PUBLIC_FUNCTION(Datum)
+pgstrom_zonemap_drop(PG_FUNCTION_ARGS)
+{
+	Oid			table_oid = PG_GETARG_OID(0);
+	Relation	rel;
+	char	   *fname;
+	bool		retval = true;
+
+	rel = table_open(table_oid, ShareLock);
+	__zoneMapCheckTableOwner(rel);
+	fname = __zoneMapFilePath(table_oid);
+	if (unlink(fname) != 0)
+	{
+		if (errno != ENOENT)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not remove file \"%s\": %m", fname)));
+		retval = false;
+	}
+	CacheInvalidateRelcache(rel);
+	table_close(rel, NoLock);
+
+	PG_RETURN_BOOL(retval);
+}
+
+/*
+ * __zoneMapMarkDirty
+ */
+static void
+__zoneMapMarkDirty(Relation rel, BlockNumber block_num)
+{
+	ZoneMapSyncCache *entry;
+	Oid			table_oid = RelationGetRelid(rel);
+	uint32_t	index;
+	bool		found;
+
+	if (!zonemap_sync_htab)
+	{
+		HASHCTL		hctl;
+
+		memset(&hctl, 0, sizeof(HASHCTL));
+		hctl.keysize = sizeof(Oid);
+		hctl.entrysize = sizeof(ZoneMapSyncCache);
+		hctl.hcxt = CacheMemoryContext;
+		zonemap_sync_htab = hash_create("ZoneMap Sync Cache", 256, &hctl,
+										HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+	}
+	entry = hash_search(zonemap_sync_htab, &table_oid, HASH_ENTER, &found);
+	if (!found)
+	{
+		ZoneMapFileHead *zm_head;
+
+		entry->filp = -1;
+		entry->dirty = NULL;
+		PG_TRY();
+		{
+			zm_head = __zoneMapOpenFile(rel, O_RDWR, &entry->filp);
+			if (zm_head)
+			{
+				entry->dirty_offset = ZONEMAP_DIRTY_OFFSET(zm_head);
+				entry->pages_per_range = zm_head->pages_per_range;
+				entry->nranges = zm_head->nranges;
+				entry->dirty = MemoryContextAlloc(CacheMemoryContext,
+												  zm_head->nranges);
+				if (!__zoneMapReadFile(entry->filp,
+									   entry->dirty,
+									   zm_head->nranges,
+									   entry->dirty_offset))
+					elog(ERROR, "failed on read zone-map of '%s'",
+						 RelationGetRelationName(rel));
+				pfree(zm_head);
+			}
+		}
+		PG_CATCH();
+		{
+			if (entry->filp >= 0)
+				FileClose(entry->filp);
+			if (entry->dirty)
+				pfree(entry->dirty);
+			hash_search(zonemap_sync_htab, &table_oid, HASH_REMOVE, NULL);
+			PG_RE_THROW();
+		}
+		PG_END_TRY();
+	}
+	if (entry->filp < 0)
+		return;
+	index = block_num / entry->pages_per_range;
+	if (index >= entry->nranges || entry->dirty[index])
+		return;
+	/*
+	 * MEMO: the dirty flag must be durable prior to the commit of the
+	 * modification; it happens only once per range, so the cost of sync
+	 * is not significant.
+	 */
+	entry->dirty[index] = 1;
+	if (FileWrite(entry->filp, (char *)&entry->dirty[index], 1,
+				  entry->dirty_offset + index,
+				  WAIT_EVENT_DATA_FILE_WRITE) != 1 ||
+		FileSync(entry->filp, WAIT_EVENT_DATA_FILE_SYNC) != 0)
+	{
+		entry->dirty[index] = 0;
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not update zone-map of \"%s\": %m",
+						RelationGetRelationName(rel))));
+	}
+}
+
+/*
+ * pgstrom_zonemap_sync_trigger
+ */
+PG_FUNCTION_INFO_V1(pgstrom_zonemap_sync_trigger);
+PUBLIC_FUNCTION(Datum)
+pgstrom_zonemap_sync_trigger(PG_FUNCTION_ARGS)
+{
+	TriggerData	   *trigdata = (TriggerData *) fcinfo->context;
+
+	if (!CALLED_AS_TRIGGER(fcinfo))
+		elog(ERROR, "%s: must be called as trigger",
+			 get_func_name(fcinfo->flinfo->fn_oid));
+	if (!TRIGGER_FIRED_FOR_ROW(trigdata->tg_event) ||
+		!TRIGGER_FIRED_AFTER(trigdata->tg_event))
+		elog(ERROR, "%s: must be declared as AFTER ROW trigger",
+			 trigdata->tg_trigger->tgname);
+
+	if (TRIGGER_FIRED_BY_INSERT(trigdata->tg_event))
+	{
+		__zoneMapMarkDirty(trigdata->tg_relation,
+						   ItemPointerGetBlockNumber(&trigdata->tg_trigslot->tts_tid));
+	}
+	else if (TRIGGER_FIRED_BY_UPDATE(trigdata->tg_event))
+	{
+		__zoneMapMarkDirty(trigdata->tg_relation,
+						   ItemPointerGetBlockNumber(&trigdata->tg_newslot->tts_tid));
+	}
+	else if (!TRIGGER_FIRED_BY_DELETE(trigdata->tg_event))
+	{
+		elog(ERROR, "zonemap: unexpected trigger event type (%u)",
+			 trigdata->tg_event);
+	}
+	/* DELETE never expands min/max of the range */
+	PG_RETURN_POINTER(trigdata->tg_trigtuple);
+}
+
+/* ------------------------------------------------------------
+ *
+ * Callbacks to invalidate the zone-map
+ *
+ * ------------------------------------------------------------
+ */
+static void
+__zoneMapRemoveFile(Oid table_oid)
+{
+	char	   *fname = __zoneMapFilePath(table_oid);
+
+	if (unlink(fname) != 0 && errno != ENOENT)
+		elog(WARNING, "could not remove zone-map file \"%s\": %m", fname);
+	pfree(fname);
+}
+
+static void
+__zoneMapCallbackOnAlterTrigger(Oid trigger_oid)
+{
+	Relation	srel;
+	ScanKeyData	skey;
+	SysScanDesc	sscan;
+	HeapTuple	tuple;
+
+	srel = table_open(TriggerRelationId, AccessShareLock);
+	ScanKeyInit(&skey,
+				Anum_pg_trigger_oid,
+				BTEqualStrategyNumber, F_OIDEQ,
+				ObjectIdGetDatum(trigger_oid));
+	sscan = systable_beginscan(srel, TriggerOidIndexId, true,
+							   SnapshotSelf, 1, &skey);
+	while ((tuple = systable_getnext(sscan)) != NULL)
+	{
+		Form_pg_trigger	pg_trig = (Form_pg_trigger)GETSTRUCT(tuple);
+
+		/*
+		 * Once trigger is altered, we cannot ensure the sync-trigger was
+		 * fired on all the modification of the table, even if it were
+		 * re-enabled later.
+		 */
+		__zoneMapRemoveFile(pg_trig->tgrelid);
+	}
+	systable_endscan(sscan);
+	table_close(srel, AccessShareLock);
+}
+
+static void
+zoneMapObjectAccess(ObjectAccessType access,
+					Oid classId,
+					Oid objectId,
+					int subId,
+					void *arg)
+{
+	if (object_access_next)
+		object_access_next(access, classId, objectId, subId, arg);
+
+	if (access == OAT_POST_CREATE ||
+		access == OAT_POST_ALTER ||
+		access == OAT_DROP)
+	{
+		if (classId == TriggerRelationId)
+			__zoneMapCallbackOnAlterTrigger(objectId);
+		else if (classId == RelationRelationId &&
+				 access == OAT_DROP && subId == 0)
+			__zoneMapRemoveFile(objectId);
+	}
+}
+
+static void
+zoneMapRelcacheCallback(Datum arg, Oid relid)
+{
+	HASH_SEQ_STATUS	hseq;
+	ZoneMapSyncCache *entry;
+
+	if (!zonemap_sync_htab)
+		return;
+	hash_seq_init(&hseq, zonemap_sync_htab);
+	while ((entry = hash_seq_search(&hseq)) != NULL)
+	{
+		if (OidIsValid(relid) && entry->relid != relid)
+			continue;
+		if (entry->filp >= 0)
+			FileClose(entry->filp);
+		if (entry->dirty)
+			pfree(entry->dirty);
+		hash_search(zonemap_sync_htab, &entry->relid, HASH_REMOVE, NULL);
+	}
+}
+
+static void
+zoneMapSyscacheCallback(Datum arg, int cacheid, uint32 hashvalue)
+{
+	__zonemap_sync_trigger_function_oid = InvalidOid;
+}
+
+/*
+ * pgstrom_init_zonemap
+ */
+void
+pgstrom_init_zonemap(void)
+{
+	/* pg_strom.enable_zonemap */
+	DefineCustomBoolVariable("pg_strom.enable_zonemap",
+							 "Enables to use zone-map to skip block-ranges",
+							 NULL,
+							 &pgstrom_enable_zonemap,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* invalidation callbacks */
+	object_access_next = object_access_hook;
+	object_access_hook = zoneMapObjectAccess;
+	CacheRegisterRelcacheCallback(zoneMapRelcacheCallback, 0);
+	CacheRegisterSyscacheCallback(PROCOID, zoneMapSyscacheCallback, 0);
+}
@@ -0,0 +1,79 @@
+---
+--- Dataset of the micro-benchmark suite
+---
+--- psql -v nrows=<N> -f bench-init.sql <dbname>
+---
+\if :{?nrows}
+\else
+\set nrows 10000000
+\endif
+SET client_min_messages = error;
+DROP SCHEMA IF EXISTS pgstrom_bench CASCADE;
+CREATE SCHEMA pgstrom_bench;
+RESET client_min_messages;
+
+SET search_path = pgstrom_bench,public;
+SELECT pgstrom.random_setseed(20240401);
+
+-- fact table for scalar device functions, scan, join and preagg
+CREATE TABLE bench_fact (
+  id    int,
+  aid   int,
+  bid   int,
+  ival  int8,
+  fval  float8,
+  nval  numeric,
+  tval  text,
+  dval  date,
+  tsval timestamp,
+  jval  jsonb
+);
+INSERT INTO bench_fact (
+  SELECT x, pgstrom.random_int(0, 1, 100000),
+            pgstrom.random_int(0, 1, 1000),
+            pgstrom.random_int(1, -2000000000, 2000000000),
+            pgstrom.random_float(1, -100000.0, 100000.0),
+            pgstrom.random_int(1, -2000000000,
+                                   2000000000)::numeric / 1000::numeric,
+            pgstrom.random_text_len(1, 64),
+            pgstrom.random_date(1),
+            pgstrom.random_timestamp(1),
+            ('{"a" : ' || pgstrom.random_int(0, 0, 10000)::text ||
+             ', "b" : "' || pgstrom.random_text_len(0, 16) || '"' ||
+             ', "c" : ' || pgstrom.random_float(0, 0.0, 1000.0)::text || '}')::jsonb
+    FROM generate_series(1, :nrows) x);
+
+-- dimension tables for join
+CREATE TABLE bench_dim_a (
+  aid   int primary key,
+  aname text,
+  aval  float8
+);
+INSERT INTO bench_dim_a (
+  SELECT x, pgstrom.random_text_len(0, 24),
+            pgstrom.random_float(0, 0.0, 100.0)
+    FROM generate_series(1, 100000) x);
+
+CREATE TABLE bench_dim_b (
+  bid   int primary key,
+  bcat  int,
+  bname text
+);
+INSERT INTO bench_dim_b (
+  SELECT x, pgstrom.random_int(0, 1, 20),
+            pgstrom.random_text_len(0, 24)
+    FROM generate_series(1, 1000) x);
+
+-- geometry table, only if PostGIS is installed
+DO $$
+BEGIN
+  IF EXISTS (SELECT 1 FROM pg_extension WHERE extname = 'postgis')
+  THEN
+    CREATE TABLE bench_geom AS
+      SELECT id, st_makepoint(pgstrom.random_float(0, 130.0, 145.0),
+                              pgstrom.random_float(0,  30.0,  45.0)) pt
+        FROM bench_fact;
+  END IF;
+END
+$$;
+VACUUM ANALYZE;
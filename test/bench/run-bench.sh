@@ -0,0 +1,146 @@
+#!/bin/sh
+#
+# run-bench.sh - micro-benchmark suite of the device functions and kernels
+#
+# It runs the test cases in bench-cases.list for each of GPU (pg_strom.enabled
+# = on) and CPU (pg_strom.enabled = off), then writes out a JSON report that
+# contains the best execution time and the throughput (rows/s) of each case.
+#
+CWD=`dirname $0`
+DBNAME="postgres"
+NROWS=10000000
+NLOOPS=3
+REPORT=""
+SKIP_INIT=0
+WITH_CPU=1
+FILTER=""
+
+usage()
+{
+  echo "usage: run-bench.sh [options]"
+  echo "  -d DBNAME   database name (default: ${DBNAME})"
+  echo "  -n NROWS    number of rows in bench_fact (default: ${NROWS})"
+  echo "  -l NLOOPS   number of runs per case; the best one is reported (default: ${NLOOPS})"
+  echo "  -o FILE     output JSON report (default: stdout)"
+  echo "  -k REGEX    run only the cases whose name matches"
+  echo "  -s          skip dataset initialization"
+  echo "  -g          GPU only; skip the CPU baseline"
+  exit 1
+}
+
+while getopts "d:n:l:o:k:sgh" opt
+do
+  case $opt in
+    d) DBNAME="$OPTARG" ;;
+    n) NROWS="$OPTARG" ;;
+    l) NLOOPS="$OPTARG" ;;
+    o) REPORT="$OPTARG" ;;
+    k) FILTER="$OPTARG" ;;
+    s) SKIP_INIT=1 ;;
+    g) WITH_CPU=0 ;;
+    *) usage ;;
+  esac
+done
+
+PSQL="psql -X -q -At -v ON_ERROR_STOP=1 ${DBNAME}"
+
+if [ ${SKIP_INIT} -eq 0 ]; then
+  echo "initializing the dataset (nrows=${NROWS})..." >&2
+  ${PSQL} -v nrows=${NROWS} -f ${CWD}/bench-init.sql > /dev/null || exit 1
+fi
+HAS_GEOM=`${PSQL} -c "SELECT count(*) FROM pg_class WHERE relname = 'bench_geom' AND relnamespace = 'pgstrom_bench'::regnamespace"`
+FACT_NROWS=`${PSQL} -c "SELECT count(*) FROM pgstrom_bench.bench_fact"` || exit 1
+
+#
+# run_case <query> <pg_strom.enabled>
+#
+# It prints "<best execution time in ms> <1 if GPU plan>", or nothing on error.
+#
+run_case()
+{
+  __best=""
+  __gpu=0
+  __i=0
+  while [ ${__i} -le ${NLOOPS} ]; do
+    __plan=`${PSQL} 2>/dev/null <<__EOF__
+SET search_path = pgstrom_bench,public;
+SET pg_strom.enabled = $2;
+SET max_parallel_workers_per_gather = 0;
+EXPLAIN (ANALYZE, FORMAT JSON) $1;
+__EOF__`
+    [ $? -eq 0 ] || return
+    __time=`echo "${__plan}" | sed -n 's/.*"Execution Time": \([0-9.]*\).*/\1/p'`
+    echo "${__plan}" | grep -q '"Custom Plan Provider": "Gpu' && __gpu=1
+    # the first run is a warm-up
+    if [ ${__i} -gt 0 ]; then
+      __best=`echo "${__time} ${__best}" | awk '{ print ($2 == "" || $1 < $2) ? $1 : $2 }'`
+    fi
+    __i=`expr ${__i} + 1`
+  done
+  echo "${__best} ${__gpu}"
+}
+
+#
+# json_entry <time in ms> <nrows>
+#
+json_entry()
+{
+  if [ -z "$1" ]; then
+    printf 'null'
+  else
+    echo "$1 $2" | awk '{ printf("{\"time_ms\": %s, \"rows_per_sec\": %.0f}", $1, $2 * 1000.0 / $1) }'
+  fi
+}
+
+PGSTROM_VERSION=`${PSQL} -c "SELECT extversion FROM pg_extension WHERE extname = 'pg_strom'"`
+GPU_NAMES=`${PSQL} -c "SELECT string_agg('\"' || att_value || '\"', ', ' ORDER BY gpu_id) FROM pgstrom.gpu_device_info WHERE att_name = 'DEV_NAME'"`
+TIMESTAMP=`date -Iseconds`
+
+OUT=`mktemp`
+trap 'rm -f ${OUT}' EXIT
+{
+  printf '{\n'
+  printf '  "timestamp": "%s",\n' "${TIMESTAMP}"
+  printf '  "pgstrom_version": "%s",\n' "${PGSTROM_VERSION}"
+  printf '  "gpus": [%s],\n' "${GPU_NAMES}"
+  printf '  "nrows": %s,\n' "${FACT_NROWS}"
+  printf '  "nloops": %s,\n' "${NLOOPS}"
+  printf '  "cases": ['
+  __sep=''
+  grep -v '^#' ${CWD}/bench-cases.list | grep -v '^$' | \
+  while IFS='|' read NAME CATEGORY QUERY
+  do
+    if [ -n "${FILTER}" ] && ! echo "${NAME}" | grep -Eq "${FILTER}"; then
+      continue
+    fi
+    if [ "${CATEGORY}" = "postgis" ] && [ "${HAS_GEOM}" = "0" ]; then
+      echo "${NAME}: skipped (no PostGIS)" >&2
+      continue
+    fi
+    echo "${NAME}: running..." >&2
+    set -- `run_case "${QUERY}" on`
+    GPU_TIME="$1"
+    GPU_PLAN="${2:-0}"
+    CPU_TIME=""
+    if [ ${WITH_CPU} -ne 0 ]; then
+      set -- `run_case "${QUERY}" off`
+      CPU_TIME="$1"
+    fi
+    if [ ${GPU_PLAN} -eq 1 ]; then GPU_PLAN=true; else GPU_PLAN=false; fi
+    printf '%s\n    {"name": "%s", "category": "%s", "gpu_plan": %s,\n' \
+           "${__sep}" "${NAME}" "${CATEGORY}" "${GPU_PLAN}"
+    printf '     "gpu": '
+    json_entry "${GPU_TIME}" ${FACT_NROWS}
+    printf ',\n     "cpu": '
+    json_entry "${CPU_TIME}" ${FACT_NROWS}
+    printf '}'
+    __sep=','
+  done
+  printf '\n  ]\n}\n'
+} > ${OUT}
+
+if [ -n "${REPORT}" ]; then
+  cp -f ${OUT} ${REPORT}
+else
+  cat ${OUT}
+fi
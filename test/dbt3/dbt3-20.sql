@@ -36,6 +36,6 @@ where
 			)
 	)
 	and s_nationkey = n_nationkey
-	and n_name = ':3'
+	and n_name = 'CANADA'
 order by
 	s_name;
@@ -0,0 +1,13 @@
+--
+-- DDL of the TPC-H (DBT-3) benchmark driver (dbt3-bench.sh)
+--
+SET client_min_messages = error;
+DROP SCHEMA IF EXISTS dbt3_heap CASCADE;
+DROP SCHEMA IF EXISTS dbt3_arrow CASCADE;
+RESET client_min_messages;
+
+CREATE SCHEMA dbt3_heap;
+CREATE SCHEMA dbt3_arrow;
+SET search_path = dbt3_heap;
+
+\ir dbt3-ddl.sql
@@ -0,0 +1,13 @@
+--
+-- Primary keys of the TPC-H (DBT-3) tables, built after the data loading
+--
+SET search_path = dbt3_heap;
+
+ALTER TABLE region   ADD PRIMARY KEY (r_regionkey);
+ALTER TABLE nation   ADD PRIMARY KEY (n_nationkey);
+ALTER TABLE part     ADD PRIMARY KEY (p_partkey);
+ALTER TABLE supplier ADD PRIMARY KEY (s_suppkey);
+ALTER TABLE partsupp ADD PRIMARY KEY (ps_partkey, ps_suppkey);
+ALTER TABLE customer ADD PRIMARY KEY (c_custkey);
+ALTER TABLE orders   ADD PRIMARY KEY (o_orderkey);
+ALTER TABLE lineitem ADD PRIMARY KEY (l_orderkey, l_linenumber);
@@ -0,0 +1,253 @@
+#!/bin/sh
+#
+# dbt3-bench.sh - TPC-H (DBT-3) benchmark driver
+#
+# It generates the DBT-3 dataset at the given scale factor, then runs the
+# 22 queries (dbt3-XX.sql) on the heap and Arrow_Fdw variants of the
+# lineitem and orders tables, with and without pg_strom.enabled, and in
+# warm and/or cold cache mode. The results are written out as a JSON
+# report that contains the best response time, the throughput (lineitem
+# rows/s), the speed-up ratio of GPU to CPU and the EXPLAIN ANALYZE output
+# in JSON format for each query.
+#
+CWD=`cd \`dirname $0\` && pwd`
+DBNAME="dbt3"
+SCALE=10
+VARIANTS="heap,arrow"
+MODES="warm"
+NLOOPS=3
+NWORKERS=""
+ARROW_DIR=""
+REPORT=""
+SKIP_INIT=0
+NO_EXPLAIN=0
+DBGEN="${CWD}/dbgen-dbt3"
+PG2ARROW="${CWD}/../../arrow-tools/pg2arrow"
+
+usage()
+{
+  echo "usage: dbt3-bench.sh [options]"
+  echo "  -d DBNAME   database name (default: ${DBNAME})"
+  echo "  -s SCALE    scale factor of the dataset (default: ${SCALE})"
+  echo "  -V LIST     comma separated variants of lineitem and orders; any of"
+  echo "              heap and arrow (default: ${VARIANTS})"
+  echo "  -m LIST     comma separated cache modes; any of warm and cold"
+  echo "              (default: ${MODES}). cold mode drops the OS page cache"
+  echo "              by 'sudo sysctl -w vm.drop_caches=1' prior to each run"
+  echo "  -l NLOOPS   number of runs per query; the best one is reported (default: ${NLOOPS})"
+  echo "  -w N        max_parallel_workers_per_gather (default: server setting)"
+  echo "  -A DIR      directory of the Arrow files (default: PGDATA of the server)"
+  echo "  -o FILE     output JSON report (default: stdout)"
+  echo "  -i          skip dataset generation, use the existing one"
+  echo "  -n          skip EXPLAIN ANALYZE of the queries"
+  exit 1
+}
+
+while getopts "d:s:V:m:l:w:A:o:inh" opt
+do
+  case $opt in
+    d) DBNAME="$OPTARG" ;;
+    s) SCALE="$OPTARG" ;;
+    V) VARIANTS="$OPTARG" ;;
+    m) MODES="$OPTARG" ;;
+    l) NLOOPS="$OPTARG" ;;
+    w) NWORKERS="$OPTARG" ;;
+    A) ARROW_DIR="$OPTARG" ;;
+    o) REPORT="$OPTARG" ;;
+    i) SKIP_INIT=1 ;;
+    n) NO_EXPLAIN=1 ;;
+    *) usage ;;
+  esac
+done
+VARIANTS=`echo ${VARIANTS} | tr ',' ' '`
+MODES=`echo ${MODES} | tr ',' ' '`
+
+PSQL="psql -X -q -At -v ON_ERROR_STOP=1 ${DBNAME}"
+
+if [ -z "${ARROW_DIR}" ]; then
+  ARROW_DIR=`${PSQL} -c 'SHOW data_directory'` || exit 1
+fi
+
+#
+# Dataset generation
+#
+load_table()
+{
+  echo "loading dbt3_heap.$1 (SF=${SCALE})..." >&2
+  ${DBGEN} -q -s${SCALE} -X -T$2 | \
+    ${PSQL} -c "\\copy dbt3_heap.$1 FROM STDIN DELIMITER '|'" || exit 1
+}
+
+if [ ${SKIP_INIT} -eq 0 ]; then
+  [ -x ${DBGEN} ] || make -C ${CWD} >&2 || exit 1
+  ${PSQL} -f ${CWD}/dbt3-bench-ddl.sql || exit 1
+  load_table region   r
+  load_table nation   n
+  load_table part     P
+  load_table supplier s
+  load_table partsupp S
+  load_table customer c
+  load_table orders   O
+  load_table lineitem L
+  ${PSQL} -f ${CWD}/dbt3-bench-index.sql || exit 1
+  ${PSQL} -c 'VACUUM ANALYZE' || exit 1
+
+  for v in ${VARIANTS}
+  do
+    case $v in
+      arrow)
+        [ -x ${PG2ARROW} ] || make -C ${CWD}/../../arrow-tools pg2arrow >&2 || exit 1
+        for t in orders lineitem
+        do
+          __file="${ARROW_DIR}/dbt3_${t}_sf${SCALE}.arrow"
+          echo "dumping ${t} to ${__file}..." >&2
+          ${PG2ARROW} -d ${DBNAME} -t dbt3_heap.${t} -o ${__file} || exit 1
+          ${PSQL} <<__EOF__ || exit 1
+IMPORT FOREIGN SCHEMA ${t}
+  FROM SERVER arrow_fdw
+  INTO dbt3_arrow
+OPTIONS (file '${__file}');
+__EOF__
+        done
+        ;;
+      heap)
+        ;;
+      *)
+        echo "unknown variant: $v" >&2
+        exit 1
+        ;;
+    esac
+  done
+fi
+NROWS=`${PSQL} -c "SELECT count(*) FROM dbt3_heap.lineitem"` || exit 1
+
+#
+# query_text <query file> [<prefix of the main query>]
+#
+# It prints the query file without comments; Q15 also contains the
+# CREATE/DROP VIEW around the main query, that begins at the first column.
+#
+query_text()
+{
+  sed -e '/^--/d' -e "s/^select/$2select/" $1
+}
+
+#
+# run_query <variant> <mode> <pg_strom.enabled> <query file>
+#
+# It prints the best response time in ms, or nothing on error.
+#
+run_query()
+{
+  __best=""
+  __i=0
+  while [ ${__i} -le ${NLOOPS} ]; do
+    # the first run is a warm-up, unless cold mode
+    if [ "$2" = "cold" ]; then
+      sudo sysctl -q -w vm.drop_caches=1 || return
+    fi
+    __time=`${PSQL} 2>/dev/null <<__EOF__ | awk '/^Time: / { sum += $2; n++ } END { if (n > 0) print sum }'
+SET search_path = dbt3_$1,dbt3_heap,public;
+SET pg_strom.enabled = $3;
+${NWORKERS:+SET max_parallel_workers_per_gather = ${NWORKERS};}
+\\o /dev/null
+\\timing on
+\`query_text $4\`
+__EOF__`
+    [ -n "${__time}" ] || return
+    if [ ${__i} -gt 0 ] || [ "$2" = "cold" ]; then
+      __best=`echo "${__time} ${__best}" | awk '{ print ($2 == "" || $1 < $2) ? $1 : $2 }'`
+    fi
+    __i=`expr ${__i} + 1`
+  done
+  echo "${__best}"
+}
+
+#
+# explain_query <variant> <pg_strom.enabled> <query file>
+#
+# It prints EXPLAIN ANALYZE of the main query in JSON, or null on error.
+#
+explain_query()
+{
+  __plan=""
+  if [ ${NO_EXPLAIN} -eq 0 ]; then
+    __plan=`${PSQL} 2>/dev/null <<__EOF__
+SET search_path = dbt3_$1,dbt3_heap,public;
+SET pg_strom.enabled = $2;
+${NWORKERS:+SET max_parallel_workers_per_gather = ${NWORKERS};}
+\`query_text $3 'EXPLAIN (ANALYZE, VERBOSE, BUFFERS, FORMAT JSON) '\`
+__EOF__`
+  fi
+  if [ -n "${__plan}" ]; then
+    echo "${__plan}"
+  else
+    echo 'null'
+  fi
+}
+
+#
+# json_entry <time in ms> <explain>
+#
+json_entry()
+{
+  if [ -z "$1" ]; then
+    printf 'null'
+  else
+    echo "$1 ${NROWS}" | awk '{ printf("{\"time_ms\": %s, \"rows_per_sec\": %.0f,\n      \"explain\": ", $1, $2 * 1000.0 / $1) }'
+    printf '%s}' "$2"
+  fi
+}
+
+OUT=`mktemp`
+trap 'rm -f ${OUT}' EXIT
+
+PGSTROM_VERSION=`${PSQL} -c "SELECT extversion FROM pg_extension WHERE extname = 'pg_strom'"`
+GPU_NAMES=`${PSQL} -c "SELECT string_agg('\"' || att_value || '\"', ', ' ORDER BY gpu_id) FROM pgstrom.gpu_device_info WHERE att_name = 'DEV_NAME'"`
+TIMESTAMP=`date -Iseconds`
+{
+  printf '{\n'
+  printf '  "timestamp": "%s",\n' "${TIMESTAMP}"
+  printf '  "pgstrom_version": "%s",\n' "${PGSTROM_VERSION}"
+  printf '  "gpus": [%s],\n' "${GPU_NAMES}"
+  printf '  "scale_factor": %s,\n' "${SCALE}"
+  printf '  "lineitem_nrows": %s,\n' "${NROWS}"
+  printf '  "nloops": %s,\n' "${NLOOPS}"
+  printf '  "results": ['
+  __sep=''
+  for v in ${VARIANTS}
+  do
+    for m in ${MODES}
+    do
+      for f in ${CWD}/dbt3-[0-9][0-9].sql
+      do
+        NAME=`basename $f .sql | sed 's/^dbt3-//'`
+        echo "Q${NAME} (${v}, ${m}): running..." >&2
+        CPU_TIME=`run_query $v $m off $f`
+        GPU_TIME=`run_query $v $m on $f`
+        if [ -n "${CPU_TIME}" ] && [ -n "${GPU_TIME}" ]; then
+          SPEEDUP=`echo "${CPU_TIME} ${GPU_TIME}" | awk '{ printf("%.2f", $1 / $2) }'`
+        else
+          SPEEDUP=null
+        fi
+        printf '%s\n    {"query": "Q%s", "variant": "%s", "mode": "%s",\n' \
+               "${__sep}" "${NAME}" "${v}" "${m}"
+        printf '     "cpu": '
+        [ -n "${CPU_TIME}" ] && CPU_PLAN=`explain_query $v off $f`
+        json_entry "${CPU_TIME}" "${CPU_PLAN}"
+        printf ',\n     "gpu": '
+        [ -n "${GPU_TIME}" ] && GPU_PLAN=`explain_query $v on $f`
+        json_entry "${GPU_TIME}" "${GPU_PLAN}"
+        printf ',\n     "speedup": %s}' "${SPEEDUP}"
+        __sep=','
+      done
+    done
+  done
+  printf '\n  ]\n}\n'
+} > ${OUT}
+
+if [ -n "${REPORT}" ]; then
+  cp -f ${OUT} ${REPORT}
+else
+  cat ${OUT}
+fi
@@ -177,3 +177,72 @@ WITH d AS (SELECT * FROM timezone_data  WHERE ts < tz),
 (SELECT * FROM d EXCEPT SELECT * FROM a)
 UNION ALL
 (SELECT * FROM a EXCEPT SELECT * FROM d);
+-- i/o chunks across the unreferenced columns are coalesced by io_coalesce_gap
+RESET arrow_fdw.enabled;
+SET pg_strom.enabled = off;
+SET arrow_fdw.mmap_enabled = off;
+SET max_parallel_workers_per_gather = 0;
+CREATE FUNCTION regtest_arrow_io_chunks(query text)
+RETURNS bigint AS $$
+DECLARE
+  plan jsonb;
+BEGIN
+  EXECUTE 'EXPLAIN (ANALYZE, VERBOSE, FORMAT JSON) ' || query INTO plan;
+  RETURN (jsonb_path_query_first(plan, 'strict $.**."file0-io-chunks"'))::bigint;
+END;
+$$ LANGUAGE plpgsql;
+SET arrow_fdw.io_coalesce_gap = 0;
+SELECT regtest_arrow_io_chunks('SELECT sum(i2), sum(i8) FROM regtest_arrow') ioc_nogap \gset
+SET arrow_fdw.io_coalesce_gap = 64;
+SELECT regtest_arrow_io_chunks('SELECT sum(i2), sum(i8) FROM regtest_arrow') ioc_gap \gset
+SELECT :ioc_nogap > :ioc_gap;
+RESET arrow_fdw.io_coalesce_gap;
+RESET max_parallel_workers_per_gather;
+RESET arrow_fdw.mmap_enabled;
+RESET pg_strom.enabled;
+
+-- CPU scan on the memory-mapped record-batches (arrow_fdw.mmap_enabled)
+SET pg_strom.enabled = off;
+SET arrow_fdw.mmap_enabled = on;
+SELECT id, i2, i4, f8, n1, t1, comp, ts
+  INTO mmap_a1
+  FROM regtest_arrow WHERE i4 > 0;
+SET arrow_fdw.mmap_enabled = off;
+SELECT id, i2, i4, f8, n1, t1, comp, ts
+  INTO mmap_a2
+  FROM regtest_arrow WHERE i4 > 0;
+SELECT id, i2, i4, f8, n1, t1, comp, ts
+  INTO mmap_d
+  FROM regtest_data WHERE i4 > 0;
+(SELECT * FROM mmap_a1 EXCEPT SELECT * FROM mmap_d)
+UNION ALL
+(SELECT * FROM mmap_d EXCEPT SELECT * FROM mmap_a1);
+(SELECT * FROM mmap_a2 EXCEPT SELECT * FROM mmap_d)
+UNION ALL
+(SELECT * FROM mmap_d EXCEPT SELECT * FROM mmap_a2);
+-- the mapping is released and set up again on rescan
+SET arrow_fdw.mmap_enabled = on;
+SET enable_hashjoin = off;
+SET enable_mergejoin = off;
+SET enable_material = off;
+SET max_parallel_workers_per_gather = 0;
+SELECT v.x, count(*), sum(a.i4), max(a.t1)
+  INTO mmap_a3
+  FROM (VALUES (0),(1),(2)) v(x), regtest_arrow a
+ WHERE a.id % 3 = v.x
+ GROUP BY v.x;
+SELECT v.x, count(*), sum(d.i4), max(d.t1)
+  INTO mmap_d3
+  FROM (VALUES (0),(1),(2)) v(x), regtest_data d
+ WHERE d.id % 3 = v.x
+ GROUP BY v.x;
+(SELECT * FROM mmap_a3 EXCEPT SELECT * FROM mmap_d3)
+UNION ALL
+(SELECT * FROM mmap_d3 EXCEPT SELECT * FROM mmap_a3);
+RESET enable_hashjoin;
+RESET enable_mergejoin;
+RESET enable_material;
+RESET max_parallel_workers_per_gather;
+RESET arrow_fdw.mmap_enabled;
+RESET pg_strom.enabled;
+DROP TABLE mmap_a1, mmap_a2, mmap_d, mmap_a3, mmap_d3;
@@ -193,4 +193,300 @@ SELECT count(*)
  WHERE timestamp_num between '2019-04-14 09:00:00' and '2023-05-23 17:00:00';
 RESET pg_strom.enabled;
 
+-- GpuPreAgg over multiple record-batches; the next chunk is loaded during
+-- the kernel execution of the current one (pg_strom.gpu_pipelined_load)
+SELECT int_num % 20 k, count(*) cnt, sum(int_num) s,
+       min(float_num) f_min, max(float_num) f_max
+  INTO test_pipeline_g
+  FROM regtest_arrow
+ WHERE int_num > 0
+ GROUP BY k;
+SET pg_strom.enabled = off;
+SELECT int_num % 20 k, count(*) cnt, sum(int_num) s,
+       min(float_num) f_min, max(float_num) f_max
+  INTO test_pipeline_p
+  FROM arrow_index_data
+ WHERE int_num > 0
+ GROUP BY k;
+RESET pg_strom.enabled;
+(SELECT * FROM test_pipeline_g EXCEPT SELECT * FROM test_pipeline_p) ORDER BY k;
+(SELECT * FROM test_pipeline_p EXCEPT SELECT * FROM test_pipeline_g) ORDER BY k;
+DROP TABLE test_pipeline_g, test_pipeline_p;
+
+-- persistent metadata index (arrow_fdw.metadata_index_enabled)
+SET arrow_fdw.metadata_index_enabled = on;
+SELECT count(*) > 0
+  FROM pg_ls_dir('pg_strom_arrow_index') fname
+ WHERE fname LIKE (SELECT oid::text FROM pg_database
+                    WHERE datname = current_database()) || '\_%';
+-- the entry of an updated file must not be used
+\! $PG2ARROW_CMD -s 16m --set=timezone:Asia/Tokyo -c 'SELECT * FROM regtest_arrow_index_temp.arrow_index_data WHERE id % 3 = 0 ORDER BY id' -o $ARROW_TEST_DATA_DIR/test_arrow_index.data
+SELECT count(*), sum(int_num) INTO test_index_g1 FROM regtest_arrow;
+SET arrow_fdw.metadata_index_enabled = off;
+SELECT count(*), sum(int_num) INTO test_index_g2 FROM regtest_arrow;
+RESET arrow_fdw.metadata_index_enabled;
+SET pg_strom.enabled = off;
+SELECT count(*), sum(int_num) INTO test_index_p
+  FROM arrow_index_data
+ WHERE id % 3 = 0;
+RESET pg_strom.enabled;
+SELECT * FROM test_index_g1 EXCEPT SELECT * FROM test_index_p;
+SELECT * FROM test_index_g2 EXCEPT SELECT * FROM test_index_p;
+DROP TABLE test_index_g1, test_index_g2, test_index_p;
+
+-- min/max statistics synthesized on the scan (arrow_fdw.stats_synthesis_enabled)
+CREATE FUNCTION regtest_arrow_explain(query text, key text, pattern text)
+RETURNS bigint AS $$
+DECLARE
+  plan jsonb;
+BEGIN
+  EXECUTE 'EXPLAIN (ANALYZE, VERBOSE, FORMAT JSON) ' || query INTO plan;
+  RETURN coalesce(substring(jsonb_path_query_first(plan, ('strict $.**."' || key || '"')::jsonpath) #>> '{}'
+                            FROM pattern)::bigint, 0);
+END;
+$$ LANGUAGE plpgsql;
+\! $PG2ARROW_CMD -s 16m --set=timezone:Asia/Tokyo -c 'SELECT * FROM regtest_arrow_index_temp.arrow_index_data ORDER BY int_num' -o $ARROW_TEST_DATA_DIR/test_arrow_index.data
+SET arrow_fdw.stats_synthesis_enabled = off;
+SELECT regtest_arrow_explain('SELECT * FROM regtest_arrow WHERE int_num BETWEEN -50000 AND 50000',
+                             'Stats-Hint', 'skipped: ([0-9]+)');
+SET arrow_fdw.stats_synthesis_enabled = on;
+-- the first scan computes min/max from the values
+SELECT regtest_arrow_explain('SELECT * FROM regtest_arrow WHERE int_num BETWEEN -50000 AND 50000',
+                             'Stats-Hint', 'skipped: ([0-9]+)') > 0;
+-- the later scans use the synthesized statistics written back
+SET arrow_fdw.stats_synthesis_enabled = off;
+SELECT regtest_arrow_explain('SELECT * FROM regtest_arrow WHERE int_num BETWEEN -50000 AND 50000',
+                             'Stats-Hint', 'skipped: ([0-9]+)') > 0;
+RESET arrow_fdw.stats_synthesis_enabled;
+SELECT id, int_num, float_num INTO test_synth_g
+  FROM regtest_arrow
+ WHERE int_num BETWEEN -50000 AND 50000;
+SET pg_strom.enabled = off;
+SELECT id, int_num, float_num INTO test_synth_p
+  FROM arrow_index_data
+ WHERE int_num BETWEEN -50000 AND 50000;
+RESET pg_strom.enabled;
+(SELECT * FROM test_synth_g EXCEPT SELECT * FROM test_synth_p) ORDER BY id;
+(SELECT * FROM test_synth_p EXCEPT SELECT * FROM test_synth_g) ORDER BY id;
+DROP TABLE test_synth_g, test_synth_p;
+
+-- late materialization of record-batches (arrow_fdw.late_materialization)
+SET arrow_fdw.stats_hint_enabled = off;
+SET arrow_fdw.late_materialization = on;
+SELECT regtest_arrow_explain('SELECT * FROM regtest_arrow WHERE int_num BETWEEN -50000 AND 50000',
+                             'Late-Materialization', 'pruned: ([0-9]+)') > 0;
+SELECT id, int_num, float_num, date_num, timestamp_num
+  INTO test_latemat_g
+  FROM regtest_arrow
+ WHERE int_num BETWEEN -50000 AND 50000;
+RESET arrow_fdw.late_materialization;
+SELECT regtest_arrow_explain('SELECT * FROM regtest_arrow WHERE int_num BETWEEN -50000 AND 50000',
+                             'Late-Materialization', 'pruned: ([0-9]+)');
+RESET arrow_fdw.stats_hint_enabled;
+SET pg_strom.enabled = off;
+SELECT id, int_num, float_num, date_num, timestamp_num
+  INTO test_latemat_p
+  FROM arrow_index_data
+ WHERE int_num BETWEEN -50000 AND 50000;
+RESET pg_strom.enabled;
+(SELECT * FROM test_latemat_g EXCEPT SELECT * FROM test_latemat_p) ORDER BY id;
+(SELECT * FROM test_latemat_p EXCEPT SELECT * FROM test_latemat_g) ORDER BY id;
+DROP TABLE test_latemat_g, test_latemat_p;
+
+-- small record-batches coalesced into one chunk (arrow_fdw.coalesce_batch_size)
+\! $PG2ARROW_CMD -s 1m --set=timezone:Asia/Tokyo -c 'SELECT * FROM regtest_arrow_index_temp.arrow_index_data ORDER BY id' -o $ARROW_TEST_DATA_DIR/test_arrow_index.data
+SET arrow_fdw.coalesce_batch_size = '4MB';
+SELECT int_num % 20 k, count(*) cnt, sum(int_num) s,
+       min(float_num) f_min, max(date_num) d_max
+  INTO test_coalesce_g1
+  FROM regtest_arrow
+ WHERE int_num > 0
+ GROUP BY k;
+SELECT id, int_num, date_num
+  INTO test_coalesce_s1
+  FROM regtest_arrow
+ WHERE int_num % 97 = 0;
+SET arrow_fdw.coalesce_batch_size = 0;
+SELECT int_num % 20 k, count(*) cnt, sum(int_num) s,
+       min(float_num) f_min, max(date_num) d_max
+  INTO test_coalesce_g2
+  FROM regtest_arrow
+ WHERE int_num > 0
+ GROUP BY k;
+RESET arrow_fdw.coalesce_batch_size;
+SET pg_strom.enabled = off;
+SELECT int_num % 20 k, count(*) cnt, sum(int_num) s,
+       min(float_num) f_min, max(date_num) d_max
+  INTO test_coalesce_p
+  FROM arrow_index_data
+ WHERE int_num > 0
+ GROUP BY k;
+SELECT id, int_num, date_num
+  INTO test_coalesce_q
+  FROM arrow_index_data
+ WHERE int_num % 97 = 0;
+RESET pg_strom.enabled;
+(SELECT * FROM test_coalesce_g1 EXCEPT SELECT * FROM test_coalesce_p) ORDER BY k;
+(SELECT * FROM test_coalesce_p EXCEPT SELECT * FROM test_coalesce_g1) ORDER BY k;
+(SELECT * FROM test_coalesce_g2 EXCEPT SELECT * FROM test_coalesce_p) ORDER BY k;
+(SELECT * FROM test_coalesce_s1 EXCEPT ALL SELECT * FROM test_coalesce_q) ORDER BY id;
+(SELECT * FROM test_coalesce_q EXCEPT ALL SELECT * FROM test_coalesce_s1) ORDER BY id;
+DROP TABLE test_coalesce_g1, test_coalesce_g2, test_coalesce_p, test_coalesce_s1, test_coalesce_q;
+
+-- record-batches out of the inner key range of GpuJoin are skipped
+\! $PG2ARROW_CMD -s 1m --set=timezone:Asia/Tokyo -c 'SELECT * FROM regtest_arrow_index_temp.arrow_index_data ORDER BY id' -o $ARROW_TEST_DATA_DIR/test_arrow_index.data --stat=id
+CREATE TABLE join_keys AS
+  SELECT id, int_num FROM arrow_index_data WHERE id BETWEEN 500000 AND 500999;
+ANALYZE join_keys;
+SELECT regtest_arrow_explain('SELECT a.id, k.int_num FROM regtest_arrow a JOIN join_keys k ON a.id = k.id',
+                             'Join-Key Range', 'skipped: ([0-9]+)') > 0;
+SELECT a.id, a.float_num, k.int_num
+  INTO test_keyrange_g
+  FROM regtest_arrow a JOIN join_keys k ON a.id = k.id;
+SET pg_strom.enabled = off;
+SELECT a.id, a.float_num, k.int_num
+  INTO test_keyrange_p
+  FROM arrow_index_data a JOIN join_keys k ON a.id = k.id;
+RESET pg_strom.enabled;
+(SELECT * FROM test_keyrange_g EXCEPT SELECT * FROM test_keyrange_p) ORDER BY id;
+(SELECT * FROM test_keyrange_p EXCEPT SELECT * FROM test_keyrange_g) ORDER BY id;
+DROP TABLE join_keys, test_keyrange_g, test_keyrange_p;
+
+-- GpuPreAgg results over the Arrow files are cached
+-- (pg_strom.gpupreagg_result_cache_size)
+CREATE FUNCTION regtest_result_cache(query text)
+RETURNS text AS $$
+DECLARE
+  plan jsonb;
+BEGIN
+  EXECUTE 'EXPLAIN (ANALYZE, VERBOSE, FORMAT JSON) ' || query INTO plan;
+  RETURN coalesce(jsonb_path_query_first(plan, 'strict $.**."Result Cache"') #>> '{}', 'none');
+END;
+$$ LANGUAGE plpgsql;
+SET max_parallel_workers_per_gather = 0;
+SELECT regtest_result_cache('SELECT id % 100 k, count(*) cnt, sum(int_num) s, max(float_num) f_max FROM regtest_arrow WHERE int_num > 0 GROUP BY k');
+SET pg_strom.gpupreagg_result_cache_size = 64;
+SELECT regtest_result_cache('SELECT id % 100 k, count(*) cnt, sum(int_num) s, max(float_num) f_max FROM regtest_arrow WHERE int_num > 0 GROUP BY k');
+SELECT regtest_result_cache('SELECT id % 100 k, count(*) cnt, sum(int_num) s, max(float_num) f_max FROM regtest_arrow WHERE int_num > 0 GROUP BY k');
+SELECT id % 100 k, count(*) cnt, sum(int_num) s, max(float_num) f_max
+  INTO test_rcache_g1
+  FROM regtest_arrow
+ WHERE int_num > 0
+ GROUP BY k;
+-- results of the mutable expressions are never cached
+SELECT regtest_result_cache('SELECT id % 100 k, count(*) cnt FROM regtest_arrow WHERE timestamp_num < now() GROUP BY k');
+-- the file signature is updated
+\! touch $ARROW_TEST_DATA_DIR/test_arrow_index.data
+SELECT regtest_result_cache('SELECT id % 100 k, count(*) cnt, sum(int_num) s, max(float_num) f_max FROM regtest_arrow WHERE int_num > 0 GROUP BY k');
+SELECT id % 100 k, count(*) cnt, sum(int_num) s, max(float_num) f_max
+  INTO test_rcache_g2
+  FROM regtest_arrow
+ WHERE int_num > 0
+ GROUP BY k;
+RESET pg_strom.gpupreagg_result_cache_size;
+RESET max_parallel_workers_per_gather;
+SET pg_strom.enabled = off;
+SELECT id % 100 k, count(*) cnt, sum(int_num) s, max(float_num) f_max
+  INTO test_rcache_p
+  FROM arrow_index_data
+ WHERE int_num > 0
+ GROUP BY k;
+RESET pg_strom.enabled;
+(SELECT * FROM test_rcache_g1 EXCEPT SELECT * FROM test_rcache_p) ORDER BY k;
+(SELECT * FROM test_rcache_p EXCEPT SELECT * FROM test_rcache_g1) ORDER BY k;
+(SELECT * FROM test_rcache_g2 EXCEPT SELECT * FROM test_rcache_p) ORDER BY k;
+(SELECT * FROM test_rcache_p EXCEPT SELECT * FROM test_rcache_g2) ORDER BY k;
+DROP TABLE test_rcache_g1, test_rcache_g2, test_rcache_p;
+DROP FUNCTION regtest_result_cache(text);
+
+-- Arrow_Fdw chunks loaded by the preceding scans are shared on GPU service
+-- (pg_strom.gpu_shared_scan_buffer_size)
+CREATE FUNCTION regtest_reload_gpuserv()
+RETURNS bool AS $$
+DECLARE
+  plan text;
+BEGIN
+  PERFORM pg_reload_conf();
+  PERFORM pg_sleep(1.0);
+  FOR i IN 1 .. 120
+  LOOP
+    EXECUTE 'EXPLAIN (COSTS OFF) SELECT * FROM regtest_arrow WHERE int_num > 0'
+       INTO plan;
+    IF plan LIKE '%GpuScan%' THEN
+      RETURN true;
+    END IF;
+    PERFORM pg_sleep(0.5);
+  END LOOP;
+  RETURN false;
+END;
+$$ LANGUAGE plpgsql;
+CREATE FUNCTION regtest_exec_path(query text, path text)
+RETURNS bool AS $$
+DECLARE
+  plan jsonb;
+BEGIN
+  EXECUTE 'EXPLAIN (ANALYZE, COSTS OFF, FORMAT JSON) ' || query INTO plan;
+  RETURN EXISTS (SELECT 1
+                   FROM jsonb_path_query(plan, 'strict $.**."Exec Paths"') p,
+                        unnest(string_to_array(p #>> '{}', ', ')) x
+                  WHERE x = path);
+END;
+$$ LANGUAGE plpgsql;
+\set test_shared_scan_path :arrow_test_data_dir_path '/test_shared_scan.data'
+\! $PG2ARROW_CMD -s 4m -c 'SELECT id, int_num, float_num FROM regtest_arrow_index_temp.arrow_index_data' -o $ARROW_TEST_DATA_DIR/test_shared_scan.data
+CREATE FOREIGN TABLE shared_scan (
+  id         int,
+  int_num    int,
+  float_num  float8
+) SERVER arrow_fdw
+  OPTIONS (file :'test_shared_scan_path');
+SET max_parallel_workers_per_gather = 0;
+ALTER SYSTEM SET pg_strom.gpu_shared_scan_buffer_size = 256;
+SELECT regtest_reload_gpuserv();
+-- the first scan loads the chunks, then the later scans share them
+SELECT regtest_exec_path('SELECT int_num % 100 k, count(*) cnt, sum(id) sid, max(float_num) f_max FROM shared_scan WHERE float_num > 0.0 GROUP BY k', 'shared-scan-buffer');
+SELECT int_num % 100 k, count(*) cnt, sum(id) sid, max(float_num) f_max
+  INTO test_sscan_g1
+  FROM shared_scan
+ WHERE float_num > 0.0
+ GROUP BY k;
+SELECT regtest_exec_path('SELECT int_num % 100 k, count(*) cnt, sum(id) sid, max(float_num) f_max FROM shared_scan WHERE float_num > 0.0 GROUP BY k', 'shared-scan-buffer');
+SELECT int_num % 100 k, count(*) cnt, sum(id) sid, max(float_num) f_max
+  INTO test_sscan_g2
+  FROM shared_scan
+ WHERE float_num > 0.0
+ GROUP BY k;
+SELECT id, int_num, float_num
+  INTO test_sscan_g3
+  FROM shared_scan
+ WHERE float_num < 0.0;
+ALTER SYSTEM RESET pg_strom.gpu_shared_scan_buffer_size;
+SELECT regtest_reload_gpuserv();
+SELECT regtest_exec_path('SELECT int_num % 100 k, count(*) cnt, sum(id) sid, max(float_num) f_max FROM shared_scan WHERE float_num > 0.0 GROUP BY k', 'shared-scan-buffer');
+RESET max_parallel_workers_per_gather;
+SET pg_strom.enabled = off;
+SELECT int_num % 100 k, count(*) cnt, sum(id) sid, max(float_num) f_max
+  INTO test_sscan_p1
+  FROM arrow_index_data
+ WHERE float_num > 0.0
+ GROUP BY k;
+SELECT id, int_num, float_num
+  INTO test_sscan_p2
+  FROM arrow_index_data
+ WHERE float_num < 0.0;
+RESET pg_strom.enabled;
+(SELECT * FROM test_sscan_g1 EXCEPT SELECT * FROM test_sscan_p1) ORDER BY k;
+(SELECT * FROM test_sscan_p1 EXCEPT SELECT * FROM test_sscan_g1) ORDER BY k;
+(SELECT * FROM test_sscan_g2 EXCEPT SELECT * FROM test_sscan_p1) ORDER BY k;
+(SELECT * FROM test_sscan_p1 EXCEPT SELECT * FROM test_sscan_g2) ORDER BY k;
+(SELECT * FROM test_sscan_g3 EXCEPT ALL SELECT * FROM test_sscan_p2) ORDER BY id;
+(SELECT * FROM test_sscan_p2 EXCEPT ALL SELECT * FROM test_sscan_g3) ORDER BY id;
+DROP TABLE test_sscan_g1, test_sscan_g2, test_sscan_g3, test_sscan_p1, test_sscan_p2;
+DROP FOREIGN TABLE shared_scan;
+DROP FUNCTION regtest_exec_path(text,text);
+DROP FUNCTION regtest_reload_gpuserv();
+\! rm -f $ARROW_TEST_DATA_DIR/test_shared_scan.data
+
+DROP FUNCTION regtest_arrow_explain(text,text,text);
+
 DROP SCHEMA regtest_arrow_index_temp CASCADE;
\ No newline at end of file
@@ -0,0 +1,167 @@
+---
+--- Test for arrow_fdw on Apache Parquet files
+---
+--- Parquet files are built from an arrow file by pyarrow, then compared
+--- to the arrow file on CPU and GPU.
+---
+\t on
+SET pg_strom.regression_test_mode = on;
+SET client_min_messages = error;
+DROP SCHEMA IF EXISTS regtest_arrow_parquet_temp CASCADE;
+CREATE SCHEMA regtest_arrow_parquet_temp;
+RESET client_min_messages;
+SET search_path = regtest_arrow_parquet_temp,public;
+CREATE TABLE regtest_data (
+  id     int,
+  i2     int2,
+  i4     int4,
+  i8     int8,
+  f4     float4,
+  f8     float8,
+  b      bool,
+  t1     text,
+  t2     text,
+  dt     date,
+  ts     timestamp
+);
+SELECT pgstrom.random_setseed(20240901);
+INSERT INTO regtest_data (
+  SELECT x, pgstrom.random_int(2, -32000, 32000),
+            pgstrom.random_int(2, -16777216, 16777216),
+            pgstrom.random_int(2, -16777216, 16777216),
+            pgstrom.random_float(2, -100000.0, 100000.0),
+            pgstrom.random_float(2, -100000.0, 100000.0),
+            pgstrom.random_int(2, 0, 1) = 1,
+            pgstrom.random_text_len(2, 64),
+            'key_' || pgstrom.random_int(2, 0, 20),
+            pgstrom.random_date(2),
+            pgstrom.random_timestamp(2)
+    FROM generate_series(1,10000) x);
+
+\! $PG2ARROW_CMD -c 'SELECT * FROM regtest_arrow_parquet_temp.regtest_data ORDER BY id' -o $ARROW_TEST_DATA_DIR/test_arrow_parquet.data
+\set arrow_path `echo -n $ARROW_TEST_DATA_DIR/test_arrow_parquet.data`
+\set parquet_1_path `echo -n $ARROW_TEST_DATA_DIR/test_arrow_parquet_1.parquet`
+\set parquet_2_path `echo -n $ARROW_TEST_DATA_DIR/test_arrow_parquet_2.parquet`
+\set parquet_3_path `echo -n $ARROW_TEST_DATA_DIR/test_arrow_parquet_3.parquet`
+
+CREATE FUNCTION regtest_write_parquet(src text, dst text,
+                                      use_dictionary bool,
+                                      data_page_version text,
+                                      compression text,
+                                      row_group_size int)
+RETURNS bool AS $$
+import pyarrow.ipc
+import pyarrow.parquet
+
+table = pyarrow.ipc.open_file(src).read_all()
+pyarrow.parquet.write_table(table, dst,
+                            use_dictionary = use_dictionary,
+                            data_page_version = data_page_version,
+                            compression = compression,
+                            row_group_size = row_group_size,
+                            write_statistics = True)
+return True
+$$ LANGUAGE plpython3u;
+-- PLAIN encoding, DATA_PAGE v1
+SELECT regtest_write_parquet(:'arrow_path', :'parquet_1_path',
+                             false, '1.0', 'NONE', 10000);
+-- dictionary encoding, DATA_PAGE v1
+SELECT regtest_write_parquet(:'arrow_path', :'parquet_2_path',
+                             true, '1.0', 'NONE', 10000);
+-- dictionary encoding, DATA_PAGE_V2 (RLE for boolean), ZSTD, 10 row-groups
+SELECT regtest_write_parquet(:'arrow_path', :'parquet_3_path',
+                             true, '2.0', 'ZSTD', 1000);
+
+IMPORT FOREIGN SCHEMA regtest_arrow
+  FROM SERVER arrow_fdw
+  INTO regtest_arrow_parquet_temp
+OPTIONS (file :'arrow_path');
+IMPORT FOREIGN SCHEMA regtest_parquet_1
+  FROM SERVER arrow_fdw
+  INTO regtest_arrow_parquet_temp
+OPTIONS (file :'parquet_1_path');
+IMPORT FOREIGN SCHEMA regtest_parquet_2
+  FROM SERVER arrow_fdw
+  INTO regtest_arrow_parquet_temp
+OPTIONS (file :'parquet_2_path');
+IMPORT FOREIGN SCHEMA regtest_parquet_3
+  FROM SERVER arrow_fdw
+  INTO regtest_arrow_parquet_temp
+OPTIONS (file :'parquet_3_path');
+
+-- NULLs are restored from the definition levels
+SET pg_strom.enabled = off;
+SELECT count(*) - count(i2), count(*) - count(i4), count(*) - count(f8),
+       count(*) - count(b), count(*) - count(t1), count(*) - count(ts)
+  FROM regtest_arrow
+EXCEPT
+SELECT count(*) - count(i2), count(*) - count(i4), count(*) - count(f8),
+       count(*) - count(b), count(*) - count(t1), count(*) - count(ts)
+  FROM regtest_parquet_3;
+-- by CPU
+WITH a AS (SELECT * FROM regtest_arrow),
+     p AS (SELECT * FROM regtest_parquet_1)
+(SELECT * FROM a EXCEPT ALL SELECT * FROM p)
+UNION ALL
+(SELECT * FROM p EXCEPT ALL SELECT * FROM a);
+WITH a AS (SELECT * FROM regtest_arrow),
+     p AS (SELECT * FROM regtest_parquet_2)
+(SELECT * FROM a EXCEPT ALL SELECT * FROM p)
+UNION ALL
+(SELECT * FROM p EXCEPT ALL SELECT * FROM a);
+WITH a AS (SELECT * FROM regtest_arrow),
+     p AS (SELECT * FROM regtest_parquet_3)
+(SELECT * FROM a EXCEPT ALL SELECT * FROM p)
+UNION ALL
+(SELECT * FROM p EXCEPT ALL SELECT * FROM a);
+SELECT t2, count(*) nitems, sum(i4) s4, sum(i8) s8,
+       count(*) FILTER (WHERE b) nbool
+  INTO test01a
+  FROM regtest_arrow
+ WHERE dt > '2020-01-01'
+ GROUP BY t2;
+-- by GPU
+RESET pg_strom.enabled;
+SELECT t2, count(*) nitems, sum(i4) s4, sum(i8) s8,
+       count(*) FILTER (WHERE b) nbool
+  INTO test01p
+  FROM regtest_parquet_1
+ WHERE dt > '2020-01-01'
+ GROUP BY t2;
+SELECT t2, count(*) nitems, sum(i4) s4, sum(i8) s8,
+       count(*) FILTER (WHERE b) nbool
+  INTO test02p
+  FROM regtest_parquet_2
+ WHERE dt > '2020-01-01'
+ GROUP BY t2;
+SELECT t2, count(*) nitems, sum(i4) s4, sum(i8) s8,
+       count(*) FILTER (WHERE b) nbool
+  INTO test03p
+  FROM regtest_parquet_3
+ WHERE dt > '2020-01-01'
+ GROUP BY t2;
+(SELECT * FROM test01a EXCEPT SELECT * FROM test01p)
+UNION ALL
+(SELECT * FROM test01p EXCEPT SELECT * FROM test01a);
+(SELECT * FROM test01a EXCEPT SELECT * FROM test02p)
+UNION ALL
+(SELECT * FROM test02p EXCEPT SELECT * FROM test01a);
+(SELECT * FROM test01a EXCEPT SELECT * FROM test03p)
+UNION ALL
+(SELECT * FROM test03p EXCEPT SELECT * FROM test01a);
+
+-- row-groups are skipped by the column chunk statistics
+CREATE FUNCTION regtest_stats_hint(query text)
+RETURNS text AS $$
+DECLARE
+  plan jsonb;
+BEGIN
+  EXECUTE 'EXPLAIN (ANALYZE, FORMAT JSON) ' || query INTO plan;
+  RETURN substring(jsonb_path_query_first(plan, 'strict $.**."Stats-Hint"') #>> '{}'
+                   from '\[.*\]');
+END;
+$$ LANGUAGE plpgsql;
+SET pg_strom.enabled = off;
+SELECT count(*) FROM regtest_parquet_3 WHERE id BETWEEN 2001 AND 2500;
+SELECT regtest_stats_hint('SELECT count(*) FROM regtest_parquet_3 WHERE id BETWEEN 2001 AND 2500');
+RESET pg_strom.enabled;
@@ -0,0 +1,172 @@
+---
+--- Test for writable arrow_fdw (INSERT / COPY FROM)
+---
+\t on
+SET pg_strom.regression_test_mode = on;
+SET client_min_messages = error;
+DROP SCHEMA IF EXISTS regtest_arrow_write_temp CASCADE;
+CREATE SCHEMA regtest_arrow_write_temp;
+RESET client_min_messages;
+SET search_path = regtest_arrow_write_temp,public;
+CREATE TYPE comp AS (
+  x    int,
+  y    text,
+  z    timestamp
+);
+CREATE TABLE tt (
+  id   int,
+  a    smallint,
+  b    real,
+  c    numeric(12,4),
+  d    comp,
+  e    date,
+  f    time
+);
+SELECT pgstrom.random_setseed(20200213);
+INSERT INTO tt (
+  SELECT x, pgstrom.random_int(1, -32000, 32000),
+            pgstrom.random_float(1, -100000.0, 100000.0),
+            pgstrom.random_float(1, -100000.0, 100000.0),
+            null,
+            pgstrom.random_date(1),
+            pgstrom.random_time(1)
+    FROM generate_series(1,1000) x);
+UPDATE tt SET d.x = pgstrom.random_int(1, -320000, 320000),
+              d.y = pgstrom.random_text_len(1, 50),
+              d.z = pgstrom.random_timestamp(1);
+
+\! rm -f $ARROW_TEST_DATA_DIR/test_arrow_write_*
+\set ft_path  `echo -n $ARROW_TEST_DATA_DIR/test_arrow_write_ft.arrow`
+\set ft2_path `echo -n $ARROW_TEST_DATA_DIR/test_arrow_write_ft2.arrow`
+\set csv_path `echo -n $ARROW_TEST_DATA_DIR/test_arrow_write_ft.csv`
+
+CREATE FOREIGN TABLE ft (
+  id   int,
+  a    smallint,
+  b    real,
+  c    numeric(12,4),
+  d    comp,
+  e    date,
+  f    time
+) SERVER arrow_fdw
+  OPTIONS (file :'ft_path', writable 'true');
+
+-- INSERT creates a new file
+INSERT INTO ft (SELECT * FROM tt WHERE id % 20 = 6 ORDER BY id);
+SELECT count(*) FROM ft;
+SELECT (pg_stat_file(:'ft_path')).size AS ft_size \gset
+
+-- ROLLBACK restores the original file image
+BEGIN;
+INSERT INTO ft (SELECT * FROM tt WHERE id % 10 = 7 ORDER BY id LIMIT 7);
+SELECT count(*) FROM ft;
+ROLLBACK;
+SELECT count(*) FROM ft;
+SELECT (pg_stat_file(:'ft_path')).size = :ft_size;
+
+-- ROLLBACK TO SAVEPOINT restores the file image at the savepoint
+BEGIN;
+INSERT INTO ft (SELECT * FROM tt WHERE id % 10 = 3 ORDER BY id LIMIT 10);
+SELECT count(*) FROM ft;
+SAVEPOINT s1;
+INSERT INTO ft (SELECT * FROM tt WHERE id % 10 = 5 ORDER BY id LIMIT 10);
+SELECT count(*) FROM ft;
+SAVEPOINT s2;
+INSERT INTO ft (SELECT * FROM tt WHERE id % 10 = 1 ORDER BY id LIMIT 8);
+SELECT count(*) FROM ft;
+ROLLBACK TO SAVEPOINT s1;
+SELECT count(*) FROM ft;
+INSERT INTO ft (SELECT * FROM tt WHERE id % 10 = 8 ORDER BY id LIMIT 5);
+SELECT count(*) FROM ft;
+COMMIT;
+SELECT count(*) FROM ft;
+
+-- COPY FROM
+COPY (SELECT * FROM tt WHERE id % 20 = 12 ORDER BY id) TO :'csv_path' (FORMAT csv);
+COPY ft FROM :'csv_path' (FORMAT csv);
+SELECT count(*) FROM ft;
+
+-- re-read the file by another foreign table
+CREATE FOREIGN TABLE ft_r (
+  id   int,
+  a    smallint,
+  b    real,
+  c    numeric(12,4),
+  d    comp,
+  e    date,
+  f    time
+) SERVER arrow_fdw
+  OPTIONS (file :'ft_path');
+INSERT INTO ft_r (SELECT * FROM tt WHERE id = 1);	-- error
+SELECT count(*) FROM ft_r;
+-- by CPU
+SET pg_strom.enabled = off;
+WITH d AS ((SELECT * FROM tt WHERE id % 20 IN (6, 12))
+           UNION ALL
+           (SELECT * FROM tt WHERE id % 10 = 3 ORDER BY id LIMIT 10)
+           UNION ALL
+           (SELECT * FROM tt WHERE id % 10 = 8 ORDER BY id LIMIT 5))
+(SELECT * FROM d EXCEPT ALL SELECT * FROM ft_r)
+UNION ALL
+(SELECT * FROM ft_r EXCEPT ALL SELECT * FROM d);
+-- by GPU
+RESET pg_strom.enabled;
+WITH d AS ((SELECT * FROM tt WHERE id % 20 IN (6, 12))
+           UNION ALL
+           (SELECT * FROM tt WHERE id % 10 = 3 ORDER BY id LIMIT 10)
+           UNION ALL
+           (SELECT * FROM tt WHERE id % 10 = 8 ORDER BY id LIMIT 5))
+(SELECT * FROM d EXCEPT ALL SELECT * FROM ft_r)
+UNION ALL
+(SELECT * FROM ft_r EXCEPT ALL SELECT * FROM d);
+
+-- ROLLBACK removes the file created by the transaction
+CREATE FOREIGN TABLE ft2 (
+  id   int,
+  a    smallint
+) SERVER arrow_fdw
+  OPTIONS (file :'ft2_path', writable 'true');
+BEGIN;
+INSERT INTO ft2 (SELECT id, a FROM tt WHERE id < 100);
+SELECT count(*) FROM ft2;
+ROLLBACK;
+SELECT pg_stat_file(:'ft2_path', true) IS NULL;
+
+-- remote files (http/https) are read-only, and checked on the scan
+CREATE FOREIGN TABLE ft3 (
+  id   int,
+  a    smallint
+) SERVER arrow_fdw
+  OPTIONS (file 'http://127.0.0.1/regtest_ft3.arrow', writable 'true');	-- error
+CREATE FOREIGN TABLE ft3 (
+  id   int,
+  a    smallint
+) SERVER arrow_fdw
+  OPTIONS (files 'https://127.0.0.1/regtest_ft3.arrow,regtest_ft3.arrow');	-- error
+
+-- min/max statistics of the existing record-batches are kept on the append
+\set ft4_path `echo -n $ARROW_TEST_DATA_DIR/test_arrow_write_ft4.arrow`
+\! $PG2ARROW_CMD -s 2k -c 'SELECT id, a FROM regtest_arrow_write_temp.tt ORDER BY id' -o $ARROW_TEST_DATA_DIR/test_arrow_write_ft4.arrow --stat=id
+CREATE FOREIGN TABLE ft4 (
+  id   int,
+  a    smallint
+) SERVER arrow_fdw
+  OPTIONS (file :'ft4_path', writable 'true');
+INSERT INTO ft4 (SELECT id + 1000, a FROM tt WHERE id <= 100);
+CREATE FUNCTION regtest_stats_skipped(query text)
+RETURNS bigint AS $$
+DECLARE
+  plan jsonb;
+BEGIN
+  EXECUTE 'EXPLAIN (ANALYZE, VERBOSE, FORMAT JSON) ' || query INTO plan;
+  RETURN coalesce(substring(jsonb_path_query_first(plan, 'strict $.**."Stats-Hint"') #>> '{}'
+                            FROM 'skipped: ([0-9]+)')::bigint, 0);
+END;
+$$ LANGUAGE plpgsql;
+SET arrow_fdw.stats_synthesis_enabled = off;
+SELECT regtest_stats_skipped('SELECT * FROM ft4 WHERE id BETWEEN 1 AND 50') > 0;
+SELECT count(*) FROM ft4 WHERE id BETWEEN 1 AND 50;
+-- the appended record-batch has no statistics, so it is never skipped
+SELECT count(*) FROM ft4 WHERE id > 1000;
+RESET arrow_fdw.stats_synthesis_enabled;
+DROP FUNCTION regtest_stats_skipped(text);
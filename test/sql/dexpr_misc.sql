@@ -259,6 +259,38 @@ SELECT id, CASE WHEN memo like '%aa%' THEN 'aaa'
 (SELECT * FROM test31g EXCEPT SELECT * FROM test31p) ORDER BY id;
 (SELECT * FROM test31p EXCEPT SELECT * FROM test31g) ORDER BY id;
 
+-- immutable SQL function on the device (pg_strom.enable_inline_sql_functions);
+-- the planner does not inline it, because the expensive argument is
+-- referenced multiple times
+CREATE FUNCTION regtest_sqlfunc(x int8)
+RETURNS int8 AS 'SELECT x * x + x'
+LANGUAGE sql IMMUTABLE;
+CREATE FUNCTION regtest_explain_has(query text, key text)
+RETURNS bool AS $$
+DECLARE
+  plan jsonb;
+BEGIN
+  EXECUTE 'EXPLAIN (VERBOSE, FORMAT JSON) ' || query INTO plan;
+  RETURN jsonb_path_exists(plan, ('strict $.**."' || key || '"')::jsonpath);
+END;
+$$ LANGUAGE plpgsql;
+SET pg_strom.enabled = on;
+SELECT regtest_explain_has('SELECT id FROM regtest_data WHERE regtest_sqlfunc((id % 3 + id % 5 + id % 7 + id % 11 + id % 13 + id % 17 + id % 19)::int8) % 10 = 3', 'GPU Scan Quals');
+SELECT id, regtest_sqlfunc((id % 3 + id % 5 + id % 7 + id % 11 + id % 13 + id % 17 + id % 19)::int8) v
+  INTO test32g
+  FROM regtest_data
+ WHERE regtest_sqlfunc((id % 3 + id % 5 + id % 7 + id % 11 + id % 13 + id % 17 + id % 19)::int8) % 10 = 3;
+SET pg_strom.enable_inline_sql_functions = off;
+SELECT regtest_explain_has('SELECT id FROM regtest_data WHERE regtest_sqlfunc((id % 3 + id % 5 + id % 7 + id % 11 + id % 13 + id % 17 + id % 19)::int8) % 10 = 3', 'GPU Scan Quals');
+RESET pg_strom.enable_inline_sql_functions;
+SET pg_strom.enabled = off;
+SELECT id, regtest_sqlfunc((id % 3 + id % 5 + id % 7 + id % 11 + id % 13 + id % 17 + id % 19)::int8) v
+  INTO test32p
+  FROM regtest_data
+ WHERE regtest_sqlfunc((id % 3 + id % 5 + id % 7 + id % 11 + id % 13 + id % 17 + id % 19)::int8) % 10 = 3;
+(SELECT * FROM test32g EXCEPT SELECT * FROM test32p) ORDER BY id;
+(SELECT * FROM test32p EXCEPT SELECT * FROM test32g) ORDER BY id;
+
 -- cleanup
 SET client_min_messages = error;
 DROP SCHEMA regtest_dexpr_misc_temp CASCADE;
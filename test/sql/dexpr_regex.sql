@@ -0,0 +1,140 @@
+---
+--- Test for regular expression match on the device
+---
+SET pg_strom.regression_test_mode = on;
+SET client_min_messages = error;
+DROP SCHEMA IF EXISTS regtest_dexpr_regex_temp CASCADE;
+CREATE SCHEMA regtest_dexpr_regex_temp;
+RESET client_min_messages;
+
+SET search_path = regtest_dexpr_regex_temp,public;
+CREATE TABLE regtest_data (
+  id    int,
+  memo  text COLLATE "C"
+);
+SELECT pgstrom.random_setseed(20240902);
+INSERT INTO regtest_data (
+  SELECT x, CASE WHEN x % 3 = 0 THEN w
+                 ELSE w || ' ' || pgstrom.random_text_len(2, 24)
+            END
+    FROM generate_series(1,6000) x,
+         LATERAL (SELECT (ARRAY['PostgreSQL', 'pg_strom', 'PG-Strom',
+                                'pg-strom v5.1', 'abc-123-xyz', 'ABC 456',
+                                'xyz789', E'tab\there', 'hello world', '',
+                                '東京都千代田区', '中央区', '大阪市北区',
+                                'ｶﾀｶﾅ', 'Ünïcödé', NULL])[x % 16 + 1] w) v
+);
+
+-- force to use GpuScan
+SET enable_seqscan = off;
+VACUUM ANALYZE regtest_data;
+
+-- qualifiers 1-14 run on the device, but 15-19 fall back to the CPU
+CREATE FUNCTION regtest_regex_on_device(qual text)
+RETURNS bool AS $$
+DECLARE
+  plan jsonb;
+BEGIN
+  EXECUTE 'EXPLAIN (COSTS OFF, FORMAT JSON) SELECT id FROM regtest_data WHERE '
+       || qual INTO plan;
+  RETURN jsonb_path_exists(plan, 'strict $.**."GPU Scan Quals"');
+END;
+$$ LANGUAGE plpgsql;
+SET pg_strom.enabled = on;
+SELECT no, regtest_regex_on_device(qual) device
+  FROM (VALUES ( 1, $$memo ~ '^PG'$$),
+               ( 2, $$memo ~ 'SQL$'$$),
+               ( 3, $$memo ~ '^[A-Z][a-z]+SQL$'$$),
+               ( 4, $$memo ~ '[[:digit:]]{3}'$$),
+               ( 5, $$memo ~ '\d+-\d+'$$),
+               ( 6, $$memo ~ '(abc|xyz)-?[0-9]+'$$),
+               ( 7, $$memo ~* 'pg[-_]strom'$$),
+               ( 8, $$memo ~* '^abc'$$),
+               ( 9, $$memo !~ '[[:space:]]'$$),
+               (10, $$memo !~* 'STROM'$$),
+               (11, $$memo ~ '東京'$$),
+               (12, $$memo ~ '^..区$'$$),
+               (13, $$memo ~ '^[^a-z]+$'$$),
+               (14, $$regexp_like(memo, 'v\d+\.\d+$')$$),
+               (15, $$memo ~ '([a-z])\1'$$),
+               (16, $$memo ~ 'pg(?=-)'$$),
+               (17, $$memo ~ '\mstrom'$$),
+               (18, $$memo ~ '[東大]'$$),
+               (19, $$memo ~* 'ünï'$$)) v(no, qual)
+ ORDER BY no;
+
+-- anchors, character classes, case-insensitive and multibyte text
+SET pg_strom.enabled = on;
+SELECT id, memo ~ '^PG' p01,
+           memo ~ 'SQL$' p02,
+           memo ~ '^[A-Z][a-z]+SQL$' p03,
+           memo ~ '[[:digit:]]{3}' p04,
+           memo ~ '\d+-\d+' p05,
+           memo ~ '(abc|xyz)-?[0-9]+' p06,
+           memo ~* 'pg[-_]strom' p07,
+           memo ~* '^abc' p08,
+           memo !~ '[[:space:]]' p09,
+           memo !~* 'STROM' p10,
+           memo ~ '東京' p11,
+           memo ~ '^..区$' p12,
+           memo ~ '^[^a-z]+$' p13,
+           regexp_like(memo, 'v\d+\.\d+$') p14
+  INTO test01g
+  FROM regtest_data
+ WHERE id > 0;
+SET pg_strom.enabled = off;
+SELECT id, memo ~ '^PG' p01,
+           memo ~ 'SQL$' p02,
+           memo ~ '^[A-Z][a-z]+SQL$' p03,
+           memo ~ '[[:digit:]]{3}' p04,
+           memo ~ '\d+-\d+' p05,
+           memo ~ '(abc|xyz)-?[0-9]+' p06,
+           memo ~* 'pg[-_]strom' p07,
+           memo ~* '^abc' p08,
+           memo !~ '[[:space:]]' p09,
+           memo !~* 'STROM' p10,
+           memo ~ '東京' p11,
+           memo ~ '^..区$' p12,
+           memo ~ '^[^a-z]+$' p13,
+           regexp_like(memo, 'v\d+\.\d+$') p14
+  INTO test01p
+  FROM regtest_data
+ WHERE id > 0;
+(SELECT * FROM test01g EXCEPT SELECT * FROM test01p) ORDER BY id;
+(SELECT * FROM test01p EXCEPT SELECT * FROM test01g) ORDER BY id;
+
+-- regular expressions in the scan qualifiers
+SET pg_strom.enabled = on;
+SELECT id, memo INTO test02g FROM regtest_data
+ WHERE memo ~ '^..区$' OR memo ~* '^pg.strom' OR memo ~ '[[:upper:]]{3} \d';
+SET pg_strom.enabled = off;
+SELECT id, memo INTO test02p FROM regtest_data
+ WHERE memo ~ '^..区$' OR memo ~* '^pg.strom' OR memo ~ '[[:upper:]]{3} \d';
+(SELECT * FROM test02g EXCEPT SELECT * FROM test02p) ORDER BY id;
+(SELECT * FROM test02p EXCEPT SELECT * FROM test02g) ORDER BY id;
+
+-- patterns not supported on the device
+SET pg_strom.enabled = on;
+SELECT id, memo ~ '([a-z])\1' p15,
+           memo ~ 'pg(?=-)' p16,
+           memo ~ '\mstrom' p17,
+           memo ~ '[東大]' p18,
+           memo ~* 'ünï' p19
+  INTO test03g
+  FROM regtest_data
+ WHERE id > 0;
+SET pg_strom.enabled = off;
+SELECT id, memo ~ '([a-z])\1' p15,
+           memo ~ 'pg(?=-)' p16,
+           memo ~ '\mstrom' p17,
+           memo ~ '[東大]' p18,
+           memo ~* 'ünï' p19
+  INTO test03p
+  FROM regtest_data
+ WHERE id > 0;
+(SELECT * FROM test03g EXCEPT SELECT * FROM test03p) ORDER BY id;
+(SELECT * FROM test03p EXCEPT SELECT * FROM test03g) ORDER BY id;
+
+-- cleanup
+SET client_min_messages = error;
+DROP SCHEMA regtest_dexpr_regex_temp CASCADE;
@@ -0,0 +1,164 @@
+--
+-- test for aggregate functions on GpuPreAgg
+--
+SET pg_strom.regression_test_mode = on;
+SET client_min_messages = error;
+DROP SCHEMA IF EXISTS regtest_dfunc_aggfuncs_temp CASCADE;
+CREATE SCHEMA regtest_dfunc_aggfuncs_temp;
+RESET client_min_messages;
+
+SET search_path = regtest_dfunc_aggfuncs_temp,public;
+CREATE TABLE rt_agg (
+  id   int,
+  g    int,
+  i4   int4,
+  i8   int8,
+  f8   float8,
+  t    text,
+  d    date
+);
+SELECT pgstrom.random_setseed(20240904);
+INSERT INTO rt_agg (
+  SELECT x, x % 10,
+            pgstrom.random_int(2, 0, 50000),
+            pgstrom.random_int(2, -2000000000, 2000000000),
+            pgstrom.random_float(2, 1.0, 100000.0),
+            pgstrom.random_text_len(2, 12),
+            pgstrom.random_date(2)
+    FROM generate_series(1,20000) x);
+VACUUM ANALYZE;
+
+-- force to use GpuPreAgg
+SET enable_seqscan = off;
+
+-- HyperLogLog; sketches by GPU must be identical to the ones by CPU
+SET pg_strom.hll_registers_bits = 12;
+SET pg_strom.enabled = on;
+SELECT g, hll_count(i4) c1, hll_count(i8) c2, hll_count(t) c3, hll_count(d) c4,
+          hll_sketch(i4) s1, hll_sketch(t) s2
+  INTO test01g
+  FROM rt_agg
+ GROUP BY g;
+SELECT hll_count(i4) c1, hll_count(t) c2
+  INTO test02g
+  FROM rt_agg;
+SET pg_strom.enabled = off;
+SELECT g, hll_count(i4) c1, hll_count(i8) c2, hll_count(t) c3, hll_count(d) c4,
+          hll_sketch(i4) s1, hll_sketch(t) s2
+  INTO test01p
+  FROM rt_agg
+ GROUP BY g;
+SELECT hll_count(i4) c1, hll_count(t) c2
+  INTO test02p
+  FROM rt_agg;
+(SELECT * FROM test01g EXCEPT SELECT * FROM test01p) ORDER BY g;
+(SELECT * FROM test01p EXCEPT SELECT * FROM test01g) ORDER BY g;
+(SELECT * FROM test02g EXCEPT SELECT * FROM test02p);
+-- estimation error should be small enough
+SELECT g.g, g.c1, g.c3, p.n1, p.n3
+  FROM test01g g JOIN (SELECT g, count(DISTINCT i4) n1, count(DISTINCT t) n3
+                         FROM rt_agg GROUP BY g) p ON g.g = p.g
+ WHERE @(g.c1 - p.n1) > 0.1 * p.n1
+    OR @(g.c3 - p.n3) > 0.1 * p.n3;
+RESET pg_strom.hll_registers_bits;
+
+-- quantile_sketch; estimation by GPU must match the one by CPU
+SET pg_strom.enabled = on;
+SELECT g, quantile_estimate(quantile_sketch(f8), ARRAY[0.1, 0.5, 0.9]) q
+  INTO test03g
+  FROM rt_agg
+ GROUP BY g;
+SELECT quantile_estimate(quantile_sketch(f8), 0.5) q
+  INTO test04g
+  FROM rt_agg;
+SET pg_strom.enabled = off;
+SELECT g, quantile_estimate(quantile_sketch(f8), ARRAY[0.1, 0.5, 0.9]) q
+  INTO test03p
+  FROM rt_agg
+ GROUP BY g;
+SELECT quantile_estimate(quantile_sketch(f8), 0.5) q
+  INTO test04p
+  FROM rt_agg;
+(SELECT * FROM test03g EXCEPT SELECT * FROM test03p) ORDER BY g;
+(SELECT * FROM test03p EXCEPT SELECT * FROM test03g) ORDER BY g;
+(SELECT * FROM test04g EXCEPT SELECT * FROM test04p);
+-- relative error should be within the bucket width (2%)
+SELECT q.g, q.q, p.q
+  FROM test03g q JOIN (SELECT g, percentile_disc(ARRAY[0.1, 0.5, 0.9])
+                                   WITHIN GROUP (ORDER BY f8) q
+                         FROM rt_agg GROUP BY g) p ON q.g = p.g
+ WHERE @(q.q[1] - p.q[1]) > 0.021 * p.q[1]
+    OR @(q.q[2] - p.q[2]) > 0.021 * p.q[2]
+    OR @(q.q[3] - p.q[3]) > 0.021 * p.q[3];
+
+-- string_agg; order of the values on GPU is not deterministic,
+-- so compare the sorted elements
+CREATE TABLE rt_str (
+  id   int,
+  g    int,
+  t    text,
+  b    bytea
+);
+INSERT INTO rt_str (
+  SELECT x, x % 20, v, convert_to(v, 'UTF8')
+    FROM (SELECT x, pgstrom.random_text_len(2, 24) v
+            FROM generate_series(1,6000) x) sub);
+SET pg_strom.enabled = on;
+SELECT g, string_agg(t, ',') s1, string_agg(b, '\x2c'::bytea) s2
+  INTO test05g
+  FROM rt_str
+ GROUP BY g;
+SET pg_strom.enabled = off;
+SELECT g, string_agg(t, ',') s1, string_agg(b, '\x2c'::bytea) s2
+  INTO test05p
+  FROM rt_str
+ GROUP BY g;
+CREATE VIEW test05gv AS
+  SELECT g, ARRAY(SELECT unnest(string_to_array(s1, ',')) x ORDER BY x) s1,
+            ARRAY(SELECT unnest(string_to_array(convert_from(s2, 'UTF8'), ',')) x
+                   ORDER BY x) s2
+    FROM test05g;
+CREATE VIEW test05pv AS
+  SELECT g, ARRAY(SELECT unnest(string_to_array(s1, ',')) x ORDER BY x) s1,
+            ARRAY(SELECT unnest(string_to_array(convert_from(s2, 'UTF8'), ',')) x
+                   ORDER BY x) s2
+    FROM test05p;
+(SELECT * FROM test05gv EXCEPT SELECT * FROM test05pv) ORDER BY g;
+(SELECT * FROM test05pv EXCEPT SELECT * FROM test05gv) ORDER BY g;
+SELECT count(*) FROM test05g WHERE length(s1) <> octet_length(s2);
+
+-- GpuPreAgg finalizes the groups without CPU aggregation on a single GPU
+-- (pg_strom.enable_gpupreagg_finalize)
+CREATE FUNCTION regtest_explain_has(query text, key text)
+RETURNS bool AS $$
+DECLARE
+  plan jsonb;
+BEGIN
+  EXECUTE 'EXPLAIN (VERBOSE, FORMAT JSON) ' || query INTO plan;
+  RETURN jsonb_path_exists(plan, ('strict $.**."' || key || '"')::jsonpath);
+END;
+$$ LANGUAGE plpgsql;
+SET pg_strom.enabled = on;
+SET pg_strom.enable_gpupreagg_finalize = on;
+SELECT regtest_explain_has('SELECT g, count(*) cnt, sum(i4) s, avg(i4) a, min(id) id_min, max(f8) f8_max FROM rt_agg WHERE f8 > 50000.0 GROUP BY g', 'Final Aggregation') =
+       ((SELECT count(DISTINCT gpu_id) FROM pgstrom.gpu_device_info) = 1);
+SELECT g, count(*) cnt, sum(i4) s, avg(i4) a, min(id) id_min, max(f8) f8_max
+  INTO test06g
+  FROM rt_agg
+ WHERE f8 > 50000.0
+ GROUP BY g;
+RESET pg_strom.enable_gpupreagg_finalize;
+SELECT regtest_explain_has('SELECT g, count(*) cnt, sum(i4) s, avg(i4) a, min(id) id_min, max(f8) f8_max FROM rt_agg WHERE f8 > 50000.0 GROUP BY g', 'Final Aggregation');
+SET pg_strom.enabled = off;
+SELECT g, count(*) cnt, sum(i4) s, avg(i4) a, min(id) id_min, max(f8) f8_max
+  INTO test06p
+  FROM rt_agg
+ WHERE f8 > 50000.0
+ GROUP BY g;
+(SELECT * FROM test06g EXCEPT SELECT * FROM test06p) ORDER BY g;
+(SELECT * FROM test06p EXCEPT SELECT * FROM test06g) ORDER BY g;
+DROP TABLE test06g, test06p;
+
+-- cleanup temporary resource
+SET client_min_messages = error;
+DROP SCHEMA regtest_dfunc_aggfuncs_temp CASCADE;
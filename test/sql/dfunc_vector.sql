@@ -0,0 +1,132 @@
+--
+-- test for vector distance functions
+--
+SET pg_strom.regression_test_mode = on;
+SET client_min_messages = error;
+DROP SCHEMA IF EXISTS regtest_dfunc_vector_temp CASCADE;
+CREATE SCHEMA regtest_dfunc_vector_temp;
+RESET client_min_messages;
+
+SET search_path = regtest_dfunc_vector_temp,public;
+CREATE TABLE rt_vec (
+  id   int,
+  v2   float2[],
+  w2   float2[],
+  v4   float4[],
+  w4   float4[],
+  v8   float8[],
+  w8   float8[]
+);
+SELECT pgstrom.random_setseed(20240903);
+INSERT INTO rt_vec (
+  SELECT x, a::float2[], b::float2[], a::float4[], b::float4[], a, b
+    FROM generate_series(1,2000) x,
+         LATERAL (SELECT array_agg(CASE WHEN x % 50 = 0 THEN 0.0	-- zero-norm
+                                        ELSE pgstrom.random_float(0, -1.0, 1.0)
+                                   END) a,
+                         array_agg(pgstrom.random_float(0, -1.0, 1.0)) b
+                    FROM generate_series(1,16) WHERE x > 0) v);
+UPDATE rt_vec SET v2 = NULL, v4 = NULL, v8 = NULL WHERE id % 97 = 0;
+VACUUM ANALYZE;
+
+-- force to use GpuScan
+SET enable_seqscan = off;
+
+CREATE FUNCTION regtest_float_eq(a float8, b float8, tol float8)
+RETURNS bool AS $$
+  SELECT coalesce(a IS NOT DISTINCT FROM b OR @(a - b) <= tol, false)
+$$ LANGUAGE sql;
+
+SET pg_strom.enabled = on;
+SELECT id, v2 <-> w2 l2_2, pgstrom.float2_inner_product(v2, w2) ip_2,
+           v2 <#> w2 nip_2, v2 <=> w2 cos_2,
+           v4 <-> w4 l2_4, pgstrom.float4_inner_product(v4, w4) ip_4,
+           v4 <#> w4 nip_4, v4 <=> w4 cos_4,
+           v8 <-> w8 l2_8, pgstrom.float8_inner_product(v8, w8) ip_8,
+           v8 <#> w8 nip_8, v8 <=> w8 cos_8
+  INTO test01g
+  FROM rt_vec
+ WHERE id > 0;
+SET pg_strom.enabled = off;
+SELECT id, v2 <-> w2 l2_2, pgstrom.float2_inner_product(v2, w2) ip_2,
+           v2 <#> w2 nip_2, v2 <=> w2 cos_2,
+           v4 <-> w4 l2_4, pgstrom.float4_inner_product(v4, w4) ip_4,
+           v4 <#> w4 nip_4, v4 <=> w4 cos_4,
+           v8 <-> w8 l2_8, pgstrom.float8_inner_product(v8, w8) ip_8,
+           v8 <#> w8 nip_8, v8 <=> w8 cos_8
+  INTO test01p
+  FROM rt_vec
+ WHERE id > 0;
+SELECT g.id
+  FROM test01g g FULL OUTER JOIN test01p p ON g.id = p.id
+ WHERE NOT (regtest_float_eq(g.l2_2,  p.l2_2,  0.0001) AND
+            regtest_float_eq(g.ip_2,  p.ip_2,  0.0001) AND
+            regtest_float_eq(g.nip_2, p.nip_2, 0.0001) AND
+            regtest_float_eq(g.cos_2, p.cos_2, 0.0001) AND
+            regtest_float_eq(g.l2_4,  p.l2_4,  0.000001) AND
+            regtest_float_eq(g.ip_4,  p.ip_4,  0.000001) AND
+            regtest_float_eq(g.nip_4, p.nip_4, 0.000001) AND
+            regtest_float_eq(g.cos_4, p.cos_4, 0.000001) AND
+            regtest_float_eq(g.l2_8,  p.l2_8,  0.000001) AND
+            regtest_float_eq(g.ip_8,  p.ip_8,  0.000001) AND
+            regtest_float_eq(g.nip_8, p.nip_8, 0.000001) AND
+            regtest_float_eq(g.cos_8, p.cos_8, 0.000001));
+-- zero-norm cosine distance is NaN, and NULL vector gives NULL
+SELECT count(*) FILTER (WHERE cos_2 = 'NaN' AND cos_4 = 'NaN' AND cos_8 = 'NaN') nans,
+       count(*) FILTER (WHERE l2_2 IS NULL AND ip_4 IS NULL AND cos_8 IS NULL) nulls
+  FROM test01g;
+
+-- nearest neighbor search by GPU Top-N
+SET pg_strom.enabled = on;
+SELECT id INTO test02g FROM rt_vec
+ ORDER BY v8 <-> (SELECT w8 FROM rt_vec WHERE id = 1) LIMIT 10;
+SELECT id INTO test03g FROM rt_vec
+ ORDER BY v4 <=> (SELECT w4 FROM rt_vec WHERE id = 1) LIMIT 10;
+SET pg_strom.enabled = off;
+SELECT id INTO test02p FROM rt_vec
+ ORDER BY v8 <-> (SELECT w8 FROM rt_vec WHERE id = 1) LIMIT 10;
+SELECT id INTO test03p FROM rt_vec
+ ORDER BY v4 <=> (SELECT w4 FROM rt_vec WHERE id = 1) LIMIT 10;
+(SELECT * FROM test02g EXCEPT SELECT * FROM test02p)
+UNION ALL
+(SELECT * FROM test02p EXCEPT SELECT * FROM test02g);
+(SELECT * FROM test03g EXCEPT SELECT * FROM test03p)
+UNION ALL
+(SELECT * FROM test03p EXCEPT SELECT * FROM test03g);
+
+-- vectors with NULL elements or different dimensions
+CREATE TABLE rt_vec_err (
+  id   int,
+  v2   float2[],
+  v4   float4[],
+  v8   float8[],
+  w4   float4[]
+);
+INSERT INTO rt_vec_err VALUES (1, '{1.0,NULL,3.0}', '{1.0,2.0,3.0}',
+                                  '{NULL,2.0,3.0}', '{1.0,2.0}');
+CREATE FUNCTION regtest_vector_error(query text)
+RETURNS text AS $$
+BEGIN
+  EXECUTE query;
+  RETURN 'no error';
+EXCEPTION WHEN OTHERS THEN
+  IF SQLERRM LIKE '%vector must not contain nulls%' THEN
+    RETURN 'nulls';
+  ELSIF SQLERRM LIKE '%different vector dimensions%' THEN
+    RETURN 'dimensions';
+  END IF;
+  RETURN SQLERRM;
+END;
+$$ LANGUAGE plpgsql;
+SET pg_strom.enabled = on;
+SELECT regtest_vector_error('SELECT id, v2 <-> v2 FROM rt_vec_err WHERE id > 0') v2,
+       regtest_vector_error('SELECT id, v8 <=> v8 FROM rt_vec_err WHERE id > 0') v8,
+       regtest_vector_error('SELECT id, v4 <#> w4 FROM rt_vec_err WHERE id > 0') v4;
+SET pg_strom.enabled = off;
+SELECT regtest_vector_error('SELECT id, v2 <-> v2 FROM rt_vec_err WHERE id > 0') v2,
+       regtest_vector_error('SELECT id, v8 <=> v8 FROM rt_vec_err WHERE id > 0') v8,
+       regtest_vector_error('SELECT id, v4 <#> w4 FROM rt_vec_err WHERE id > 0') v4;
+
+-- cleanup temporary resource
+SET client_min_messages = error;
+DROP SCHEMA regtest_dfunc_vector_temp CASCADE;
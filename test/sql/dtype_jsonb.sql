@@ -238,6 +238,50 @@ SELECT id, ((v)->>'num1')::numeric + ((v)->'comp'->>'ival')::numeric v1,
 (SELECT * FROM test06g EXCEPT SELECT * FROM test06p) ORDER BY id;
 (SELECT * FROM test06p EXCEPT SELECT * FROM test06g) ORDER BY id;
 
+-- qualifiers identical to the generation expression reference the stored
+-- generated column (pg_strom.enable_generated_column_rewrite)
+CREATE TABLE rt_jsonb_g (
+  id    int,
+  v     jsonb,
+  ival  int GENERATED ALWAYS AS ((v->>'ival')::int) STORED
+);
+INSERT INTO rt_jsonb_g (id, v) (SELECT id, v FROM rt_jsonb_o);
+VACUUM ANALYZE rt_jsonb_g;
+CREATE FUNCTION regtest_scan_quals(query text)
+RETURNS text AS $$
+DECLARE
+  plan jsonb;
+BEGIN
+  EXECUTE 'EXPLAIN (VERBOSE, FORMAT JSON) ' || query INTO plan;
+  RETURN jsonb_path_query_first(plan, 'strict $.**."GPU Scan Quals"') #>> '{}';
+END;
+$$ LANGUAGE plpgsql;
+SET pg_strom.enabled = on;
+SELECT regtest_scan_quals('SELECT id, v->>''sval_2'' s FROM rt_jsonb_g WHERE (v->>''ival'')::int > 1000') LIKE '%rt_jsonb_g.ival > 1000%';
+SELECT id, v->>'sval_2' s
+  INTO test07g
+  FROM rt_jsonb_g
+ WHERE (v->>'ival')::int > 1000;
+SET pg_strom.enable_generated_column_rewrite = off;
+SELECT regtest_scan_quals('SELECT id, v->>''sval_2'' s FROM rt_jsonb_g WHERE (v->>''ival'')::int > 1000') LIKE '%rt_jsonb_g.ival > 1000%';
+SELECT id, v->>'sval_2' s
+  INTO test08g
+  FROM rt_jsonb_g
+ WHERE (v->>'ival')::int > 1000;
+RESET pg_strom.enable_generated_column_rewrite;
+SET pg_strom.enabled = off;
+SELECT id, v->>'sval_2' s
+  INTO test07p
+  FROM rt_jsonb_g
+ WHERE (v->>'ival')::int > 1000;
+(SELECT * FROM test07g EXCEPT ALL SELECT * FROM test07p) ORDER BY id;
+(SELECT * FROM test07p EXCEPT ALL SELECT * FROM test07g) ORDER BY id;
+(SELECT * FROM test08g EXCEPT ALL SELECT * FROM test07p) ORDER BY id;
+(SELECT * FROM test07p EXCEPT ALL SELECT * FROM test08g) ORDER BY id;
+DROP TABLE test07g, test08g, test07p;
+DROP FUNCTION regtest_scan_quals(text);
+DROP TABLE rt_jsonb_g;
+
 -- cleanup temporary resource
 SET client_min_messages = error;
 DROP SCHEMA regtest_dtype_jsonb_temp CASCADE;
@@ -140,3 +140,82 @@ SELECT id, x = y eq, x <> y ne, x > y gt, x >= z ge, y < z lt, y <= x le
 
 (SELECT * FROM test04g EXCEPT SELECT * FROM test04p) ORDER BY id;
 (SELECT * FROM test04p EXCEPT SELECT * FROM test04g) ORDER BY id;
+
+-- numeric sum/avg on GpuPreAgg
+CREATE TABLE rt_numeric_agg (
+  id    int,
+  g     int,
+  x     numeric,
+  y     numeric(12,3),
+  v     numeric,
+  w     numeric
+);
+INSERT INTO rt_numeric_agg (
+  SELECT x, x % 20,
+            CASE x % 3 WHEN 0 THEN round(r, 0)		-- mixed scales
+                       WHEN 1 THEN round(r, 3)
+                       ELSE round(r, 10) END,
+            r::numeric(12,3),
+            '1e37'::numeric * pgstrom.random_int(0, -9, 9),	-- sum overflows int128
+            CASE WHEN x % 20 =  7 AND x % 7 = 0 THEN 'NaN'::numeric
+                 WHEN x % 20 = 11 AND x % 3 = 0 THEN 'Infinity'::numeric
+                 WHEN x % 20 = 13 AND x % 3 = 0 THEN 'Infinity'::numeric
+                 WHEN x % 20 = 13 AND x % 3 = 1 THEN '-Infinity'::numeric
+                 ELSE r END
+    FROM generate_series(1,6000) x,
+         LATERAL (SELECT pgstrom.random_float(2, -100000.0, 100000.0)::numeric r
+                   WHERE x > 0) v);
+VACUUM ANALYZE rt_numeric_agg;
+SET pg_strom.enabled = on;
+SELECT g, sum(x) sx, avg(x) ax, sum(y) sy, avg(y) ay,
+          sum(v) sv, avg(v) av, sum(w) sw, avg(w) aw
+  INTO test10g
+  FROM rt_numeric_agg
+ GROUP BY g;
+SELECT sum(x) sx, avg(x) ax, sum(y) sy, avg(y) ay,
+       sum(v) sv, avg(v) av, sum(w) sw, avg(w) aw
+  INTO test11g
+  FROM rt_numeric_agg
+ WHERE g <> 7;
+SET pg_strom.enabled = off;
+SELECT g, sum(x) sx, avg(x) ax, sum(y) sy, avg(y) ay,
+          sum(v) sv, avg(v) av, sum(w) sw, avg(w) aw
+  INTO test10p
+  FROM rt_numeric_agg
+ GROUP BY g;
+SELECT sum(x) sx, avg(x) ax, sum(y) sy, avg(y) ay,
+       sum(v) sv, avg(v) av, sum(w) sw, avg(w) aw
+  INTO test11p
+  FROM rt_numeric_agg
+ WHERE g <> 7;
+(SELECT * FROM test10g EXCEPT SELECT * FROM test10p) ORDER BY g;
+(SELECT * FROM test10p EXCEPT SELECT * FROM test10g) ORDER BY g;
+(SELECT * FROM test11g EXCEPT SELECT * FROM test11p);
+(SELECT * FROM test11p EXCEPT SELECT * FROM test11g);
+-- NaN and +/-Infinity
+SELECT g, sw, aw FROM test10g WHERE g IN (7, 11, 13) ORDER BY g;
+-- values that cannot be summarized exactly
+SELECT pgstrom.sum_numeric(pgstrom.psum(x))
+  FROM (VALUES (1.5), (123456789012345678901234567890123456789012345678901234567890)) t(x);
+
+-- pg_strom.enable_numeric_aggfuncs = off runs numeric sum/avg on CPU
+CREATE FUNCTION regtest_has_gpupreagg(query text)
+RETURNS bool AS $$
+DECLARE
+  line text;
+BEGIN
+  FOR line IN EXECUTE 'EXPLAIN (COSTS OFF) ' || query LOOP
+    IF line LIKE '%GpuPreAgg%' THEN
+      RETURN true;
+    END IF;
+  END LOOP;
+  RETURN false;
+END;
+$$ LANGUAGE plpgsql;
+SET pg_strom.enabled = on;
+SELECT regtest_has_gpupreagg('SELECT g, sum(x), avg(y) FROM rt_numeric_agg GROUP BY g');
+SET pg_strom.enable_numeric_aggfuncs = off;
+SELECT regtest_has_gpupreagg('SELECT g, sum(x), avg(y) FROM rt_numeric_agg GROUP BY g');
+RESET pg_strom.enable_numeric_aggfuncs;
+SET pg_strom.enabled = off;
+DROP FUNCTION regtest_has_gpupreagg(text);
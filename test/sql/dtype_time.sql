@@ -920,6 +920,53 @@ SELECT * FROM test45g AS a, test45p AS b WHERE a.id=b.id AND
   OR ABS(a.v12 - b.v12) > 0.1
 ) LIMIT 5;
 
+-- same GPU kernel on the pooled connection with the cached session info;
+-- timezone and parameters must be delivered for each query
+SET pg_strom.xpu_connection_pool_size = 2;
+SET pg_strom.gpu_session_cache = on;
+SET pg_strom.enabled = on;
+SET timezone = 'Japan';
+SELECT id, tsz1::date v1, tsz1::timestamp v2
+  INTO test50g
+  FROM rt_datetime
+ WHERE id > 0;
+SET timezone = 'America/New_York';
+SELECT id, tsz1::date v1, tsz1::timestamp v2
+  INTO test51g
+  FROM rt_datetime
+ WHERE id > 0;
+SET plan_cache_mode = force_generic_plan;
+PREPARE p_sess_cache(timestamptz) AS
+SELECT id, tsz2 FROM rt_datetime WHERE tsz2 > $1;
+CREATE TABLE test52g AS EXECUTE p_sess_cache('2010-01-01 00:00:00');
+CREATE TABLE test53g AS EXECUTE p_sess_cache('2030-01-01 00:00:00');
+SET pg_strom.enabled = off;
+SET timezone = 'Japan';
+SELECT id, tsz1::date v1, tsz1::timestamp v2
+  INTO test50p
+  FROM rt_datetime
+ WHERE id > 0;
+SET timezone = 'America/New_York';
+SELECT id, tsz1::date v1, tsz1::timestamp v2
+  INTO test51p
+  FROM rt_datetime
+ WHERE id > 0;
+CREATE TABLE test52p AS EXECUTE p_sess_cache('2010-01-01 00:00:00');
+CREATE TABLE test53p AS EXECUTE p_sess_cache('2030-01-01 00:00:00');
+DEALLOCATE p_sess_cache;
+RESET plan_cache_mode;
+RESET pg_strom.gpu_session_cache;
+RESET pg_strom.xpu_connection_pool_size;
+SET timezone = 'CET';
+(SELECT * FROM test50g EXCEPT SELECT * FROM test50p) ORDER BY id;
+(SELECT * FROM test50p EXCEPT SELECT * FROM test50g) ORDER BY id;
+(SELECT * FROM test51g EXCEPT SELECT * FROM test51p) ORDER BY id;
+(SELECT * FROM test51p EXCEPT SELECT * FROM test51g) ORDER BY id;
+(SELECT * FROM test52g EXCEPT SELECT * FROM test52p) ORDER BY id;
+(SELECT * FROM test52p EXCEPT SELECT * FROM test52g) ORDER BY id;
+(SELECT * FROM test53g EXCEPT SELECT * FROM test53p) ORDER BY id;
+(SELECT * FROM test53p EXCEPT SELECT * FROM test53g) ORDER BY id;
+
 -- cleanup temporary resource
 SET client_min_messages = error;
 DROP SCHEMA regtest_dtype_time_temp CASCADE;
@@ -218,3 +218,54 @@ SELECT * INTO test12p
 (SELECT * FROM test12g EXCEPT SELECT * FROM test12p) ORDER BY id LIMIT 10;
 (SELECT * FROM test12p EXCEPT SELECT * FROM test12g) ORDER BY id LIMIT 10;
 RESET pg_strom.cpu_fallback;
+
+-- execution paths taken by the xPU tasks, shown by EXPLAIN ANALYZE
+CREATE FUNCTION regtest_exec_path(query text, path text)
+RETURNS bool AS $$
+DECLARE
+  plan jsonb;
+BEGIN
+  EXECUTE 'EXPLAIN (ANALYZE, COSTS OFF, FORMAT JSON) ' || query INTO plan;
+  RETURN EXISTS (SELECT 1
+                   FROM jsonb_path_query(plan, 'strict $.**."Exec Paths"') p,
+                        unnest(string_to_array(p #>> '{}', ', ')) x
+                  WHERE x = path);
+END;
+$$ LANGUAGE plpgsql;
+
+-- CPU fallback chunks by parallel workers, redistributed to the other
+-- processes (pg_strom.parallel_cpu_fallback)
+SET pg_strom.enabled = on;
+SET pg_strom.cpu_fallback = on;
+SET max_parallel_workers_per_gather = 2;
+SET parallel_setup_cost = 0;
+SET parallel_tuple_cost = 0;
+SET client_min_messages = warning;
+SET pg_strom.parallel_cpu_fallback = on;
+SELECT regtest_exec_path('SELECT id, x + y v1, substring(memo, 1, 20) v2 FROM fallback_data WHERE memo LIKE ''%abc%''', 'parallel-fallback');
+SELECT id, x + y v1, substring(memo, 1, 20) v2
+  INTO test32g
+  FROM fallback_data
+ WHERE memo LIKE '%abc%';
+SET pg_strom.parallel_cpu_fallback = off;
+SELECT regtest_exec_path('SELECT id, x + y v1, substring(memo, 1, 20) v2 FROM fallback_data WHERE memo LIKE ''%abc%''', 'parallel-fallback');
+SELECT id, x + y v1, substring(memo, 1, 20) v2
+  INTO test32s
+  FROM fallback_data
+ WHERE memo LIKE '%abc%';
+RESET pg_strom.parallel_cpu_fallback;
+RESET client_min_messages;
+SET max_parallel_workers_per_gather = 0;
+RESET parallel_setup_cost;
+RESET parallel_tuple_cost;
+RESET pg_strom.cpu_fallback;
+SET pg_strom.enabled = off;
+SELECT id, x + y v1, substring(memo, 1, 20) v2
+  INTO test32p
+  FROM fallback_data
+ WHERE memo LIKE '%abc%';
+(SELECT * FROM test32g EXCEPT SELECT * FROM test32p) ORDER BY id;
+(SELECT * FROM test32p EXCEPT SELECT * FROM test32g) ORDER BY id;
+(SELECT * FROM test32s EXCEPT SELECT * FROM test32p) ORDER BY id;
+(SELECT * FROM test32p EXCEPT SELECT * FROM test32s) ORDER BY id;
+DROP TABLE test32g, test32s, test32p;
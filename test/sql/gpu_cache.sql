@@ -370,6 +370,193 @@ VACUUM ANALYZE cache_corruption_test;
 EXPLAIN (costs off, verbose)
 SELECT count(*) FROM cache_corruption_test;
 
+---
+--- REDO logs appended in batch (pg_strom.gpucache_log_batch_size)
+---
+CREATE TABLE cache_batch_test (
+  id   int,
+  a    int4,
+  b    float8
+);
+CREATE TRIGGER row_sync_batch AFTER INSERT OR UPDATE OR DELETE ON cache_batch_test FOR ROW
+    EXECUTE FUNCTION pgstrom.gpucache_sync_trigger('gpu_device_id=0,max_num_rows=50000,redo_buffer_size=150m,gpu_sync_threshold=10m,gpu_sync_interval=4');
+ALTER TABLE cache_batch_test ENABLE ALWAYS TRIGGER row_sync_batch;
+CREATE FUNCTION regtest_gpucache_used(query text)
+RETURNS bool AS $$
+DECLARE
+  plan jsonb;
+BEGIN
+  EXECUTE 'EXPLAIN (VERBOSE, FORMAT JSON) ' || query INTO plan;
+  RETURN jsonb_path_exists(plan, 'strict $.**."GPU Cache"');
+END;
+$$ LANGUAGE plpgsql;
+SET pg_strom.gpucache_log_batch_size = 4;
+INSERT INTO cache_batch_test (
+  SELECT x, pgstrom.random_int(1, -100000, 100000),
+            pgstrom.random_float(1, -1000.0, 1000.0)
+    FROM generate_series(1,20000) x);
+VACUUM ANALYZE cache_batch_test;
+SELECT regtest_gpucache_used('SELECT * FROM cache_batch_test WHERE id > 100');
+-- own changes of the transaction, still in the batch, must be visible
+BEGIN;
+DELETE FROM cache_batch_test WHERE id % 7 = 0;
+INSERT INTO cache_batch_test (
+  SELECT x, pgstrom.random_int(1, -100000, 100000),
+            pgstrom.random_float(1, -1000.0, 1000.0)
+    FROM generate_series(20001,24000) x);
+SET pg_strom.enabled = on;
+SELECT count(*) cnt, sum(a) s, max(b) b_max
+  INTO TEMPORARY batch_g1 FROM cache_batch_test WHERE id > 100;
+SET pg_strom.enabled = off;
+SELECT count(*) cnt, sum(a) s, max(b) b_max
+  INTO TEMPORARY batch_p1 FROM cache_batch_test WHERE id > 100;
+COMMIT;
+(SELECT * FROM batch_g1 EXCEPT SELECT * FROM batch_p1)
+UNION ALL
+(SELECT * FROM batch_p1 EXCEPT SELECT * FROM batch_g1);
+-- row-by-row appends
+SET pg_strom.gpucache_log_batch_size = 0;
+UPDATE cache_batch_test SET a = a + 1 WHERE id % 5 = 0;
+SELECT pgstrom.gpucache_apply_redo('cache_batch_test');
+SET pg_strom.enabled = on;
+SELECT id, a, b INTO TEMPORARY batch_g2 FROM cache_batch_test WHERE id % 3 = 0;
+SET pg_strom.enabled = off;
+SELECT id, a, b INTO TEMPORARY batch_p2 FROM cache_batch_test WHERE id % 3 = 0;
+RESET pg_strom.enabled;
+RESET pg_strom.gpucache_log_batch_size;
+(SELECT * FROM batch_g2 EXCEPT SELECT * FROM batch_p2)
+UNION ALL
+(SELECT * FROM batch_p2 EXCEPT SELECT * FROM batch_g2);
+
+---
+--- initial loading of GpuCache by parallel workers, and by a single backend
+---
+CREATE TABLE cache_load_test (
+  id   int,
+  a    int4,
+  b    float8,
+  c    text
+);
+INSERT INTO cache_load_test (
+  SELECT x, pgstrom.random_int(1, -100000, 100000),
+            pgstrom.random_float(1, -1000.0, 1000.0),
+            LEFT(MD5(x::TEXT), (x%32+1)::INTEGER)
+    FROM generate_series(1,200000) x);
+SELECT * INTO cache_load_serial FROM cache_load_test;
+DELETE FROM cache_load_test WHERE id % 11 = 0;
+DELETE FROM cache_load_serial WHERE id % 11 = 0;
+CREATE TRIGGER row_sync_load AFTER INSERT OR UPDATE OR DELETE ON cache_load_test FOR ROW
+    EXECUTE FUNCTION pgstrom.gpucache_sync_trigger('gpu_device_id=0,max_num_rows=300000,redo_buffer_size=150m,gpu_sync_threshold=10m,gpu_sync_interval=4');
+ALTER TABLE cache_load_test ENABLE ALWAYS TRIGGER row_sync_load;
+CREATE TRIGGER row_sync_serial AFTER INSERT OR UPDATE OR DELETE ON cache_load_serial FOR ROW
+    EXECUTE FUNCTION pgstrom.gpucache_sync_trigger('gpu_device_id=0,max_num_rows=300000,redo_buffer_size=150m,gpu_sync_threshold=10m,gpu_sync_interval=4');
+ALTER TABLE cache_load_serial ENABLE ALWAYS TRIGGER row_sync_serial;
+VACUUM ANALYZE cache_load_test;
+VACUUM ANALYZE cache_load_serial;
+SELECT regtest_gpucache_used('SELECT * FROM cache_load_test WHERE a > 0');
+SET min_parallel_table_scan_size = 0;
+SET pg_strom.gpucache_initial_load_workers = 4;
+SET pg_strom.enabled = on;
+-- the first scan without own transaction-id loads the GpuCache
+SELECT count(*) > 0 FROM cache_load_test WHERE a > 0;
+SET pg_strom.gpucache_initial_load_workers = 0;
+SELECT count(*) > 0 FROM cache_load_serial WHERE a > 0;
+SELECT id, a, b, c INTO TEMPORARY load_g1 FROM cache_load_test WHERE a > 0;
+SELECT id, a, b, c INTO TEMPORARY load_g2 FROM cache_load_serial WHERE a > 0;
+SET pg_strom.enabled = off;
+SELECT id, a, b, c INTO TEMPORARY load_p FROM cache_load_test WHERE a > 0;
+RESET pg_strom.enabled;
+RESET pg_strom.gpucache_initial_load_workers;
+RESET min_parallel_table_scan_size;
+(SELECT * FROM load_g1 EXCEPT SELECT * FROM load_p)
+UNION ALL
+(SELECT * FROM load_p EXCEPT SELECT * FROM load_g1);
+(SELECT * FROM load_g2 EXCEPT SELECT * FROM load_p)
+UNION ALL
+(SELECT * FROM load_p EXCEPT SELECT * FROM load_g2);
+
+---
+--- GpuCache scan with the pending REDO logs merged on read
+---
+SELECT pgstrom.gpucache_apply_redo('cache_batch_test');
+SET pg_strom.gpucache_merge_on_read = on;
+UPDATE cache_batch_test SET b = b * 2.0 WHERE id % 13 = 0;
+DELETE FROM cache_batch_test WHERE id % 17 = 0;
+INSERT INTO cache_batch_test (
+  SELECT x, pgstrom.random_int(1, -100000, 100000),
+            pgstrom.random_float(1, -1000.0, 1000.0)
+    FROM generate_series(24001,25000) x);
+SET pg_strom.enabled = on;
+SELECT id, a, b INTO TEMPORARY merge_g1 FROM cache_batch_test WHERE a > 0;
+UPDATE cache_batch_test SET a = -a WHERE id % 19 = 0;
+SELECT id, a, b INTO TEMPORARY merge_g2 FROM cache_batch_test WHERE a > 0;
+SET pg_strom.enabled = off;
+SELECT id, a, b INTO TEMPORARY merge_p2 FROM cache_batch_test WHERE a > 0;
+UPDATE cache_batch_test SET a = -a WHERE id % 19 = 0;
+SELECT id, a, b INTO TEMPORARY merge_p1 FROM cache_batch_test WHERE a > 0;
+RESET pg_strom.enabled;
+RESET pg_strom.gpucache_merge_on_read;
+(SELECT * FROM merge_g1 EXCEPT SELECT * FROM merge_p1)
+UNION ALL
+(SELECT * FROM merge_p1 EXCEPT SELECT * FROM merge_g1);
+(SELECT * FROM merge_g2 EXCEPT SELECT * FROM merge_p2)
+UNION ALL
+(SELECT * FROM merge_p2 EXCEPT SELECT * FROM merge_g2);
+
+---
+--- Cold GpuCaches are moved to the host memory beyond the device limit
+--- (pg_strom.gpucache_device_memory_limit)
+---
+CREATE FUNCTION regtest_reload_gpucache()
+RETURNS bool AS $$
+DECLARE
+  plan text;
+BEGIN
+  PERFORM pg_reload_conf();
+  PERFORM pg_sleep(1.0);
+  FOR i IN 1 .. 120
+  LOOP
+    EXECUTE 'EXPLAIN (COSTS OFF) SELECT * FROM cache_batch_test WHERE a > 0'
+       INTO plan;
+    IF plan LIKE '%GpuScan%' THEN
+      -- wait for the next round of the tiering on the idle timeout
+      PERFORM pg_sleep(6.0);
+      RETURN true;
+    END IF;
+    PERFORM pg_sleep(0.5);
+  END LOOP;
+  RETURN false;
+END;
+$$ LANGUAGE plpgsql;
+ALTER SYSTEM SET pg_strom.gpucache_device_memory_limit = 4;
+SELECT regtest_reload_gpucache();
+SET pg_strom.enabled = on;
+SELECT id, a, b, c INTO TEMPORARY tier_g1 FROM cache_load_test WHERE a > 0;
+SELECT id, a, b INTO TEMPORARY tier_g2 FROM cache_batch_test WHERE a > 0;
+-- scan again after the tiers are re-balanced by the access score
+SELECT pg_sleep(6.0);
+SELECT id, a, b, c INTO TEMPORARY tier_g3 FROM cache_load_test WHERE a > 0;
+SELECT id, a, b INTO TEMPORARY tier_g4 FROM cache_batch_test WHERE a > 0;
+ALTER SYSTEM RESET pg_strom.gpucache_device_memory_limit;
+SELECT regtest_reload_gpucache();
+SET pg_strom.enabled = off;
+SELECT id, a, b, c INTO TEMPORARY tier_p1 FROM cache_load_test WHERE a > 0;
+SELECT id, a, b INTO TEMPORARY tier_p2 FROM cache_batch_test WHERE a > 0;
+RESET pg_strom.enabled;
+(SELECT * FROM tier_g1 EXCEPT SELECT * FROM tier_p1)
+UNION ALL
+(SELECT * FROM tier_p1 EXCEPT SELECT * FROM tier_g1);
+(SELECT * FROM tier_g2 EXCEPT SELECT * FROM tier_p2)
+UNION ALL
+(SELECT * FROM tier_p2 EXCEPT SELECT * FROM tier_g2);
+(SELECT * FROM tier_g3 EXCEPT SELECT * FROM tier_p1)
+UNION ALL
+(SELECT * FROM tier_p1 EXCEPT SELECT * FROM tier_g3);
+(SELECT * FROM tier_g4 EXCEPT SELECT * FROM tier_p2)
+UNION ALL
+(SELECT * FROM tier_p2 EXCEPT SELECT * FROM tier_g4);
+DROP FUNCTION regtest_reload_gpucache();
+
 -- cleanup temporary resource
 SET client_min_messages = error;
 DROP SCHEMA gpu_cache_temp_test CASCADE;
@@ -0,0 +1,703 @@
+---
+--- Test for the execution paths of GpuJoin on PostgreSQL table
+---
+SET pg_strom.regression_test_mode = on;
+
+SET client_min_messages = error;
+DROP SCHEMA IF EXISTS regtest_gpu_join_temp CASCADE;
+CREATE SCHEMA regtest_gpu_join_temp;
+RESET client_min_messages;
+
+SET search_path = regtest_gpu_join_temp,public;
+
+-- disables SeqScan and parallel query
+SET enable_seqscan = off;
+SET max_parallel_workers_per_gather = 0;
+
+-- prepare tables
+CREATE TABLE join_data (
+  id    int,
+  aid   int,
+  cat   text,
+  x     float,
+  y     float,
+  memo  text
+);
+SELECT pgstrom.random_setseed(20190714);
+INSERT INTO join_data (
+  SELECT x, pgstrom.random_int(0.5, 1, 4000),
+            CASE floor(random()*26)
+            WHEN 0 THEN 'aaa'
+            WHEN  1 THEN 'bbb'
+            WHEN  2 THEN 'ccc'
+            WHEN  3 THEN 'ddd'
+            WHEN  4 THEN 'eee'
+            WHEN  5 THEN 'fff'
+            WHEN  6 THEN 'ggg'
+            WHEN  7 THEN 'hhh'
+            WHEN  8 THEN 'iii'
+            WHEN  9 THEN 'jjj'
+            WHEN 10 THEN 'kkk'
+            WHEN 11 THEN 'lll'
+            WHEN 12 THEN 'mmm'
+            WHEN 13 THEN 'nnn'
+            WHEN 14 THEN 'ooo'
+            WHEN 15 THEN 'ppp'
+            WHEN 16 THEN 'qqq'
+            WHEN 17 THEN 'rrr'
+            WHEN 18 THEN 'sss'
+            WHEN 19 THEN 'ttt'
+            WHEN 20 THEN 'uuu'
+            WHEN 21 THEN 'vvv'
+            WHEN 22 THEN 'www'
+            WHEN 23 THEN 'xxx'
+            WHEN 24 THEN 'yyy'
+            ELSE 'zzz'
+            END,
+            pgstrom.random_float(2,-1000.0,1000.0),
+            pgstrom.random_float(2,-1000.0,1000.0),
+            pgstrom.random_text_len(2, 200)
+    FROM generate_series(1,400001) x);
+UPDATE join_data
+   SET memo = md5(memo) || md5(memo)
+ WHERE id = 400001;
+UPDATE join_data
+   SET memo = memo || '-' || memo || '-' || memo || '-' || memo
+ WHERE id = 400001;
+UPDATE join_data
+   SET memo = memo || '-' || memo || '-' || memo || '-' || memo
+ WHERE id = 400001;
+UPDATE join_data
+   SET memo = memo || '-' || memo || '-' || memo || '-' || memo
+ WHERE id = 400001;
+
+CREATE TABLE join_small (
+  aid   int,
+  z     float,
+  md5   varchar(32)
+);
+INSERT INTO join_small (
+  SELECT x, pgstrom.random_float(2,-1000.0,1000.0),
+            md5(x::text)
+    FROM generate_series(1,4000) x);
+
+CREATE TABLE join_enlarge (
+  aid   int,
+  z     float,
+  md5   char(200)
+);
+INSERT INTO join_enlarge (
+  SELECT x / 5, pgstrom.random_float(2,-1000.0,1000.0),
+            md5(x::text)
+    FROM generate_series(1,20000) x);
+VACUUM ANALYZE;
+
+-- execution paths taken by the xPU tasks, shown by EXPLAIN ANALYZE
+CREATE FUNCTION regtest_exec_path(query text, path text)
+RETURNS bool AS $$
+DECLARE
+  plan jsonb;
+BEGIN
+  EXECUTE 'EXPLAIN (ANALYZE, COSTS OFF, FORMAT JSON) ' || query INTO plan;
+  RETURN EXISTS (SELECT 1
+                   FROM jsonb_path_query(plan, 'strict $.**."Exec Paths"') p,
+                        unnest(string_to_array(p #>> '{}', ', ')) x
+                  WHERE x = path);
+END;
+$$ LANGUAGE plpgsql;
+
+-- GPU service restarts on SIGHUP; wait for the GPU paths to be available
+CREATE FUNCTION regtest_reload_gpuserv()
+RETURNS bool AS $$
+DECLARE
+  plan text;
+BEGIN
+  PERFORM pg_reload_conf();
+  PERFORM pg_sleep(1.0);
+  FOR i IN 1 .. 120
+  LOOP
+    EXECUTE 'EXPLAIN (COSTS OFF) SELECT * FROM join_small WHERE z > 0.0'
+       INTO plan;
+    IF plan LIKE '%GpuScan%' THEN
+      RETURN true;
+    END IF;
+    PERFORM pg_sleep(0.5);
+  END LOOP;
+  RETURN false;
+END;
+$$ LANGUAGE plpgsql;
+
+
+-- GpuJoins with the identical inner buffer; the latter one shares the inner
+-- buffer loaded on GPU by the former one, still in use
+ALTER SYSTEM SET pg_strom.gpu_host_mapped_inner_size = 0;
+SELECT regtest_reload_gpuserv();
+SET pg_strom.enabled = on;
+SELECT regtest_exec_path('SELECT id, d.aid, x - z v, md5 FROM join_data d JOIN join_small s ON d.aid = s.aid WHERE x > 0.0 UNION ALL SELECT id, d.aid, x - z v, md5 FROM join_data d JOIN join_small s ON d.aid = s.aid WHERE x < 0.0',
+                         'shared-inner-buffer');
+SELECT id, d.aid, x - z v, md5
+  INTO test01g
+  FROM join_data d JOIN join_small s ON d.aid = s.aid
+ WHERE x > 0.0
+UNION ALL
+SELECT id, d.aid, x - z v, md5
+  FROM join_data d JOIN join_small s ON d.aid = s.aid
+ WHERE x < 0.0;
+ALTER SYSTEM SET pg_strom.gpu_shared_inner_buffer = off;
+SELECT regtest_reload_gpuserv();
+SELECT regtest_exec_path('SELECT id, d.aid, x - z v, md5 FROM join_data d JOIN join_small s ON d.aid = s.aid WHERE x > 0.0 UNION ALL SELECT id, d.aid, x - z v, md5 FROM join_data d JOIN join_small s ON d.aid = s.aid WHERE x < 0.0',
+                         'shared-inner-buffer');
+ALTER SYSTEM RESET pg_strom.gpu_shared_inner_buffer;
+ALTER SYSTEM RESET pg_strom.gpu_host_mapped_inner_size;
+SELECT regtest_reload_gpuserv();
+SET pg_strom.enabled = off;
+SELECT id, d.aid, x - z v, md5
+  INTO test01p
+  FROM join_data d JOIN join_small s ON d.aid = s.aid
+ WHERE x > 0.0
+UNION ALL
+SELECT id, d.aid, x - z v, md5
+  FROM join_data d JOIN join_small s ON d.aid = s.aid
+ WHERE x < 0.0;
+(SELECT * FROM test01g EXCEPT ALL SELECT * FROM test01p) ORDER BY id;
+(SELECT * FROM test01p EXCEPT ALL SELECT * FROM test01g) ORDER BY id;
+DROP TABLE test01g, test01p;
+
+-- GpuJoin with the inner hash table partitioned (pg_strom.gpujoin_inner_buffer_limit)
+CREATE FUNCTION regtest_gpujoin_npartitions(query text)
+RETURNS bigint AS $$
+DECLARE
+  plan jsonb;
+BEGIN
+  EXECUTE 'EXPLAIN (ANALYZE, VERBOSE, FORMAT JSON) ' || query INTO plan;
+  RETURN coalesce((jsonb_path_query_first(plan, 'strict $.**."GPU Hash Partitions [1]"'))::bigint, 1);
+END;
+$$ LANGUAGE plpgsql;
+SET pg_strom.enabled = on;
+SET pg_strom.gpujoin_inner_buffer_limit = '1MB';
+SELECT regtest_gpujoin_npartitions('SELECT d.id, l.z FROM join_data d NATURAL JOIN join_enlarge l') > 1;
+SELECT d.cat, count(*) cnt, sum(d.id) sid, max(l.z) z_max
+  INTO test02g
+  FROM join_data d NATURAL JOIN join_enlarge l
+ GROUP BY d.cat;
+SELECT d.cat, count(*) cnt, count(l.aid) l_cnt, sum(l.aid) l_sum
+  INTO test03g
+  FROM join_data d LEFT OUTER JOIN join_enlarge l
+       ON d.aid = l.aid AND l.z > 0.0
+ GROUP BY d.cat;
+SET pg_strom.gpujoin_inner_buffer_limit = -1;
+SELECT regtest_gpujoin_npartitions('SELECT d.id, l.z FROM join_data d NATURAL JOIN join_enlarge l');
+RESET pg_strom.gpujoin_inner_buffer_limit;
+SET pg_strom.enabled = off;
+SELECT d.cat, count(*) cnt, sum(d.id) sid, max(l.z) z_max
+  INTO test02p
+  FROM join_data d NATURAL JOIN join_enlarge l
+ GROUP BY d.cat;
+SELECT d.cat, count(*) cnt, count(l.aid) l_cnt, sum(l.aid) l_sum
+  INTO test03p
+  FROM join_data d LEFT OUTER JOIN join_enlarge l
+       ON d.aid = l.aid AND l.z > 0.0
+ GROUP BY d.cat;
+(SELECT * FROM test02g EXCEPT SELECT * FROM test02p) ORDER BY cat;
+(SELECT * FROM test02p EXCEPT SELECT * FROM test02g) ORDER BY cat;
+(SELECT * FROM test03g EXCEPT SELECT * FROM test03p) ORDER BY cat;
+(SELECT * FROM test03p EXCEPT SELECT * FROM test03g) ORDER BY cat;
+DROP TABLE test02g, test02p, test03g, test03p;
+
+-- GpuHashJoin with the bucketized index of the inner hash table (pg_strom.gpuhashjoin_bucketized)
+SET pg_strom.enabled = on;
+SET pg_strom.gpuhashjoin_bucketized = on;
+SELECT regtest_exec_path('SELECT d.id, d.aid, l.z FROM join_data d JOIN join_enlarge l ON d.aid = l.aid AND l.z > d.x WHERE d.id % 10 = 0', 'hash-bucketized');
+SELECT d.id, d.aid, l.z
+  INTO test04g
+  FROM join_data d JOIN join_enlarge l
+       ON d.aid = l.aid AND l.z > d.x
+ WHERE d.id % 10 = 0;
+SET pg_strom.gpuhashjoin_bucketized = off;
+SELECT regtest_exec_path('SELECT d.id, d.aid, l.z FROM join_data d JOIN join_enlarge l ON d.aid = l.aid AND l.z > d.x WHERE d.id % 10 = 0', 'hash-bucketized');
+SELECT d.id, d.aid, l.z
+  INTO test05g
+  FROM join_data d JOIN join_enlarge l
+       ON d.aid = l.aid AND l.z > d.x
+ WHERE d.id % 10 = 0;
+RESET pg_strom.gpuhashjoin_bucketized;
+SET pg_strom.enabled = off;
+SELECT d.id, d.aid, l.z
+  INTO test04p
+  FROM join_data d JOIN join_enlarge l
+       ON d.aid = l.aid AND l.z > d.x
+ WHERE d.id % 10 = 0;
+(SELECT * FROM test04g EXCEPT ALL SELECT * FROM test04p) ORDER BY id;
+(SELECT * FROM test04p EXCEPT ALL SELECT * FROM test04g) ORDER BY id;
+(SELECT * FROM test05g EXCEPT ALL SELECT * FROM test04p) ORDER BY id;
+(SELECT * FROM test04p EXCEPT ALL SELECT * FROM test05g) ORDER BY id;
+DROP TABLE test04g, test04p, test05g;
+
+-- GpuHashJoin with the inner hash table built by GPU (pg_strom.gpuhashjoin_build_on_gpu)
+SET pg_strom.enabled = on;
+SET client_min_messages = warning;
+SET pg_strom.gpuhashjoin_build_on_gpu = on;
+SELECT regtest_exec_path('SELECT d.id, l.z, substring(d.memo, 1, 10) memo FROM join_data d NATURAL JOIN join_enlarge l WHERE d.id % 10 = 0', 'gpu-hash-build');
+SELECT d.id, l.z, substring(d.memo, 1, 10) memo
+  INTO test06g
+  FROM join_data d NATURAL JOIN join_enlarge l
+ WHERE d.id % 10 = 0;
+-- CPU fallback needs its own index of the inner buffer
+SET pg_strom.cpu_fallback = on;
+SELECT d.id, l.z, substring(d.memo, 1, 10) memo
+  INTO test07g
+  FROM join_data d NATURAL JOIN join_enlarge l
+ WHERE d.id % 10 = 0 AND d.memo LIKE '%ab%';
+-- the inner hash table is built for each partition
+SET pg_strom.gpujoin_inner_buffer_limit = '1MB';
+SELECT d.id, l.z, substring(d.memo, 1, 10) memo
+  INTO test08g
+  FROM join_data d NATURAL JOIN join_enlarge l
+ WHERE d.id % 10 = 0 AND d.memo LIKE '%ab%';
+RESET pg_strom.gpujoin_inner_buffer_limit;
+RESET pg_strom.cpu_fallback;
+SET pg_strom.gpuhashjoin_build_on_gpu = off;
+SELECT regtest_exec_path('SELECT d.id, l.z, substring(d.memo, 1, 10) memo FROM join_data d NATURAL JOIN join_enlarge l WHERE d.id % 10 = 0', 'gpu-hash-build');
+SELECT d.id, l.z, substring(d.memo, 1, 10) memo
+  INTO test09g
+  FROM join_data d NATURAL JOIN join_enlarge l
+ WHERE d.id % 10 = 0;
+RESET pg_strom.gpuhashjoin_build_on_gpu;
+RESET client_min_messages;
+SET pg_strom.enabled = off;
+SELECT d.id, l.z, substring(d.memo, 1, 10) memo
+  INTO test06p
+  FROM join_data d NATURAL JOIN join_enlarge l
+ WHERE d.id % 10 = 0;
+SELECT d.id, l.z, substring(d.memo, 1, 10) memo
+  INTO test07p
+  FROM join_data d NATURAL JOIN join_enlarge l
+ WHERE d.id % 10 = 0 AND d.memo LIKE '%ab%';
+(SELECT * FROM test06g EXCEPT ALL SELECT * FROM test06p) ORDER BY id;
+(SELECT * FROM test06p EXCEPT ALL SELECT * FROM test06g) ORDER BY id;
+(SELECT * FROM test07g EXCEPT ALL SELECT * FROM test07p) ORDER BY id;
+(SELECT * FROM test07p EXCEPT ALL SELECT * FROM test07g) ORDER BY id;
+(SELECT * FROM test08g EXCEPT ALL SELECT * FROM test07p) ORDER BY id;
+(SELECT * FROM test07p EXCEPT ALL SELECT * FROM test08g) ORDER BY id;
+(SELECT * FROM test09g EXCEPT ALL SELECT * FROM test06p) ORDER BY id;
+(SELECT * FROM test06p EXCEPT ALL SELECT * FROM test09g) ORDER BY id;
+DROP TABLE test06g, test06p, test07g, test07p, test08g, test09g;
+
+-- GpuHashJoin with the bloom-filter of the inner hash-keys (pg_strom.gpujoin_bloom_filter)
+SET pg_strom.enabled = on;
+SET pg_strom.gpujoin_bloom_filter = on;
+SELECT regtest_exec_path('SELECT d.id, s.z FROM join_data d JOIN join_small s ON d.aid = s.aid WHERE s.aid % 50 = 0', 'bloom-filter');
+SELECT d.id, s.z
+  INTO test10g
+  FROM join_data d JOIN join_small s ON d.aid = s.aid
+ WHERE s.aid % 50 = 0;
+SELECT d.cat, count(*) cnt, count(s.aid) s_cnt, sum(s.aid) s_sum
+  INTO test11g
+  FROM join_data d LEFT OUTER JOIN join_small s
+       ON d.aid = s.aid AND s.aid % 50 = 0
+ GROUP BY d.cat;
+SET pg_strom.gpujoin_bloom_filter = off;
+SELECT regtest_exec_path('SELECT d.id, s.z FROM join_data d JOIN join_small s ON d.aid = s.aid WHERE s.aid % 50 = 0', 'bloom-filter');
+SELECT d.id, s.z
+  INTO test12g
+  FROM join_data d JOIN join_small s ON d.aid = s.aid
+ WHERE s.aid % 50 = 0;
+RESET pg_strom.gpujoin_bloom_filter;
+SET pg_strom.enabled = off;
+SELECT d.id, s.z
+  INTO test10p
+  FROM join_data d JOIN join_small s ON d.aid = s.aid
+ WHERE s.aid % 50 = 0;
+SELECT d.cat, count(*) cnt, count(s.aid) s_cnt, sum(s.aid) s_sum
+  INTO test11p
+  FROM join_data d LEFT OUTER JOIN join_small s
+       ON d.aid = s.aid AND s.aid % 50 = 0
+ GROUP BY d.cat;
+(SELECT * FROM test10g EXCEPT ALL SELECT * FROM test10p) ORDER BY id;
+(SELECT * FROM test10p EXCEPT ALL SELECT * FROM test10g) ORDER BY id;
+(SELECT * FROM test12g EXCEPT ALL SELECT * FROM test10p) ORDER BY id;
+(SELECT * FROM test10p EXCEPT ALL SELECT * FROM test12g) ORDER BY id;
+(SELECT * FROM test11g EXCEPT SELECT * FROM test11p) ORDER BY cat;
+(SELECT * FROM test11p EXCEPT SELECT * FROM test11g) ORDER BY cat;
+DROP TABLE test10g, test10p, test11g, test11p, test12g;
+
+-- GpuNestLoop on the inner relation sorted by the range key (pg_strom.enable_gpurangejoin)
+CREATE FUNCTION regtest_explain_has(query text, key text)
+RETURNS bool AS $$
+DECLARE
+  plan jsonb;
+BEGIN
+  EXECUTE 'EXPLAIN (VERBOSE, FORMAT JSON) ' || query INTO plan;
+  RETURN jsonb_path_exists(plan, ('strict $.**."' || key || '"')::jsonpath);
+END;
+$$ LANGUAGE plpgsql;
+CREATE TABLE rj_ranges (
+  rid   int,
+  lo    int,
+  hi    int
+);
+INSERT INTO rj_ranges (
+  SELECT x, CASE WHEN x % 97 = 0 THEN NULL ELSE x * 997 END, x * 997 + 50 + x % 300
+    FROM generate_series(1,400) x);
+ANALYZE rj_ranges;
+SET pg_strom.enabled = on;
+SELECT regtest_explain_has('SELECT d.id, r.rid FROM join_data d JOIN rj_ranges r ON d.id >= r.lo AND d.id < r.hi',
+                           'GPU Range Join [1]');
+SELECT d.id, r.rid
+  INTO test13g
+  FROM join_data d JOIN rj_ranges r
+       ON d.id >= r.lo AND d.id < r.hi;
+SELECT d.cat, count(*) cnt, count(r.rid) r_cnt, sum(r.rid) r_sum
+  INTO test14g
+  FROM join_data d LEFT OUTER JOIN rj_ranges r
+       ON d.id >= r.lo AND d.id < r.hi
+ GROUP BY d.cat;
+SET pg_strom.enable_gpurangejoin = off;
+SELECT regtest_explain_has('SELECT d.id, r.rid FROM join_data d JOIN rj_ranges r ON d.id >= r.lo AND d.id < r.hi',
+                           'GPU Range Join [1]');
+SELECT d.id, r.rid
+  INTO test15g
+  FROM join_data d JOIN rj_ranges r
+       ON d.id >= r.lo AND d.id < r.hi;
+RESET pg_strom.enable_gpurangejoin;
+SET pg_strom.enabled = off;
+SELECT d.id, r.rid
+  INTO test13p
+  FROM join_data d JOIN rj_ranges r
+       ON d.id >= r.lo AND d.id < r.hi;
+SELECT d.cat, count(*) cnt, count(r.rid) r_cnt, sum(r.rid) r_sum
+  INTO test14p
+  FROM join_data d LEFT OUTER JOIN rj_ranges r
+       ON d.id >= r.lo AND d.id < r.hi
+ GROUP BY d.cat;
+(SELECT * FROM test13g EXCEPT ALL SELECT * FROM test13p) ORDER BY id;
+(SELECT * FROM test13p EXCEPT ALL SELECT * FROM test13g) ORDER BY id;
+(SELECT * FROM test15g EXCEPT ALL SELECT * FROM test13p) ORDER BY id;
+(SELECT * FROM test13p EXCEPT ALL SELECT * FROM test15g) ORDER BY id;
+(SELECT * FROM test14g EXCEPT SELECT * FROM test14p) ORDER BY cat;
+(SELECT * FROM test14p EXCEPT SELECT * FROM test14g) ORDER BY cat;
+DROP TABLE rj_ranges, test13g, test13p, test14g, test14p, test15g;
+
+-- GpuHashJoin with heavy-hitters of the inner hash-keys (pg_strom.gpuhashjoin_skew_threshold)
+CREATE TABLE skew_inner (
+  sid   int,
+  aid   int,
+  v     float
+);
+INSERT INTO skew_inner (
+  SELECT x, CASE WHEN x <= 2000 THEN 1
+                 WHEN x <= 2600 THEN 2
+                 ELSE x % 4000 END,
+         pgstrom.random_float(0,-1000.0,1000.0)
+    FROM generate_series(1,10000) x);
+ANALYZE skew_inner;
+SET pg_strom.enabled = on;
+SET pg_strom.gpuhashjoin_skew_threshold = 256;
+SELECT regtest_exec_path('SELECT d.id, s.sid FROM join_data d JOIN skew_inner s ON d.aid = s.aid AND s.v > d.x WHERE d.id % 7 = 0', 'hash-skew');
+SELECT d.id, s.sid
+  INTO test16g
+  FROM join_data d JOIN skew_inner s
+       ON d.aid = s.aid AND s.v > d.x
+ WHERE d.id % 7 = 0;
+SELECT d.aid, count(*) cnt, sum(s.sid) s_sum
+  INTO test17g
+  FROM join_data d JOIN skew_inner s ON d.aid = s.aid
+ GROUP BY d.aid;
+SET pg_strom.gpuhashjoin_skew_threshold = 0;
+SELECT regtest_exec_path('SELECT d.id, s.sid FROM join_data d JOIN skew_inner s ON d.aid = s.aid AND s.v > d.x WHERE d.id % 7 = 0', 'hash-skew');
+SELECT d.id, s.sid
+  INTO test18g
+  FROM join_data d JOIN skew_inner s
+       ON d.aid = s.aid AND s.v > d.x
+ WHERE d.id % 7 = 0;
+RESET pg_strom.gpuhashjoin_skew_threshold;
+SET pg_strom.enabled = off;
+SELECT d.id, s.sid
+  INTO test16p
+  FROM join_data d JOIN skew_inner s
+       ON d.aid = s.aid AND s.v > d.x
+ WHERE d.id % 7 = 0;
+SELECT d.aid, count(*) cnt, sum(s.sid) s_sum
+  INTO test17p
+  FROM join_data d JOIN skew_inner s ON d.aid = s.aid
+ GROUP BY d.aid;
+(SELECT * FROM test16g EXCEPT ALL SELECT * FROM test16p) ORDER BY id;
+(SELECT * FROM test16p EXCEPT ALL SELECT * FROM test16g) ORDER BY id;
+(SELECT * FROM test18g EXCEPT ALL SELECT * FROM test16p) ORDER BY id;
+(SELECT * FROM test16p EXCEPT ALL SELECT * FROM test18g) ORDER BY id;
+(SELECT * FROM test17g EXCEPT SELECT * FROM test17p) ORDER BY aid;
+(SELECT * FROM test17p EXCEPT SELECT * FROM test17g) ORDER BY aid;
+DROP TABLE skew_inner, test16g, test16p, test17g, test17p, test18g;
+
+-- GpuJoin partitions the inner hash table far larger than the estimation
+-- (pg_strom.gpujoin_adaptive_partition); k1 and k2 are correlated.
+CREATE TABLE mis_inner (
+  aid   int,
+  k1    int,
+  k2    int,
+  v     float
+);
+INSERT INTO mis_inner (
+  SELECT x % 4000 + 1, x % 10, x % 10,
+         pgstrom.random_float(0,-1000.0,1000.0)
+    FROM generate_series(1,200000) x);
+ANALYZE mis_inner;
+SET pg_strom.enabled = on;
+SET pg_strom.gpujoin_inner_buffer_limit = '4MB';
+SET pg_strom.gpujoin_adaptive_partition = on;
+SELECT regtest_gpujoin_npartitions('SELECT d.id, m.v FROM join_data d JOIN mis_inner m ON d.aid = m.aid WHERE d.id < 5000 AND m.k1 = 3 AND m.k2 = 3') > 1;
+SELECT d.id, m.v
+  INTO test19g
+  FROM join_data d JOIN mis_inner m ON d.aid = m.aid
+ WHERE d.id < 5000 AND m.k1 = 3 AND m.k2 = 3;
+SET pg_strom.gpujoin_adaptive_partition = off;
+SELECT regtest_gpujoin_npartitions('SELECT d.id, m.v FROM join_data d JOIN mis_inner m ON d.aid = m.aid WHERE d.id < 5000 AND m.k1 = 3 AND m.k2 = 3');
+SELECT d.id, m.v
+  INTO test20g
+  FROM join_data d JOIN mis_inner m ON d.aid = m.aid
+ WHERE d.id < 5000 AND m.k1 = 3 AND m.k2 = 3;
+RESET pg_strom.gpujoin_adaptive_partition;
+RESET pg_strom.gpujoin_inner_buffer_limit;
+SET pg_strom.enabled = off;
+SELECT d.id, m.v
+  INTO test19p
+  FROM join_data d JOIN mis_inner m ON d.aid = m.aid
+ WHERE d.id < 5000 AND m.k1 = 3 AND m.k2 = 3;
+(SELECT * FROM test19g EXCEPT ALL SELECT * FROM test19p) ORDER BY id;
+(SELECT * FROM test19p EXCEPT ALL SELECT * FROM test19g) ORDER BY id;
+(SELECT * FROM test20g EXCEPT ALL SELECT * FROM test19p) ORDER BY id;
+(SELECT * FROM test19p EXCEPT ALL SELECT * FROM test20g) ORDER BY id;
+DROP TABLE mis_inner, test19g, test19p, test20g;
+
+-- GpuJoin revives the idle inner buffer kept on the device
+-- (pg_strom.gpu_inner_buffer_cache_size), unless the inner rows are updated
+CREATE TABLE cache_inner (
+  aid   int,
+  v     int
+);
+INSERT INTO cache_inner (SELECT x, x % 1000 FROM generate_series(1,4000,3) x);
+ANALYZE cache_inner;
+-- the host-mapped inner buffer is never kept
+ALTER SYSTEM SET pg_strom.gpu_host_mapped_inner_size = 0;
+SELECT regtest_reload_gpuserv();
+SET pg_strom.enabled = on;
+SELECT regtest_exec_path('SELECT d.id, c.v FROM join_data d JOIN cache_inner c ON d.aid = c.aid WHERE d.x > 0.0', 'cached-inner-buffer');
+SELECT d.id, c.v
+  INTO test21g1
+  FROM join_data d JOIN cache_inner c ON d.aid = c.aid
+ WHERE d.x > 0.0;
+SELECT regtest_exec_path('SELECT d.id, c.v FROM join_data d JOIN cache_inner c ON d.aid = c.aid WHERE d.x > 0.0', 'cached-inner-buffer');
+SELECT d.id, c.v
+  INTO test21g2
+  FROM join_data d JOIN cache_inner c ON d.aid = c.aid
+ WHERE d.x > 0.0;
+SET pg_strom.enabled = off;
+SELECT d.id, c.v
+  INTO test21p
+  FROM join_data d JOIN cache_inner c ON d.aid = c.aid
+ WHERE d.x > 0.0;
+UPDATE cache_inner SET v = v + 1 WHERE aid % 5 = 0;
+SET pg_strom.enabled = on;
+SELECT regtest_exec_path('SELECT d.id, c.v FROM join_data d JOIN cache_inner c ON d.aid = c.aid WHERE d.x > 0.0', 'cached-inner-buffer');
+SELECT regtest_exec_path('SELECT d.id, c.v FROM join_data d JOIN cache_inner c ON d.aid = c.aid WHERE d.x > 0.0', 'cached-inner-buffer');
+SELECT d.id, c.v
+  INTO test22g1
+  FROM join_data d JOIN cache_inner c ON d.aid = c.aid
+ WHERE d.x > 0.0;
+ALTER SYSTEM SET pg_strom.gpu_inner_buffer_cache_size = 0;
+SELECT regtest_reload_gpuserv();
+SELECT d.id, c.v
+  INTO test22g2
+  FROM join_data d JOIN cache_inner c ON d.aid = c.aid
+ WHERE d.x > 0.0;
+SELECT regtest_exec_path('SELECT d.id, c.v FROM join_data d JOIN cache_inner c ON d.aid = c.aid WHERE d.x > 0.0', 'cached-inner-buffer');
+SELECT d.id, c.v
+  INTO test22g3
+  FROM join_data d JOIN cache_inner c ON d.aid = c.aid
+ WHERE d.x > 0.0;
+ALTER SYSTEM RESET pg_strom.gpu_inner_buffer_cache_size;
+ALTER SYSTEM RESET pg_strom.gpu_host_mapped_inner_size;
+SELECT regtest_reload_gpuserv();
+SET pg_strom.enabled = off;
+SELECT d.id, c.v
+  INTO test22p
+  FROM join_data d JOIN cache_inner c ON d.aid = c.aid
+ WHERE d.x > 0.0;
+(SELECT * FROM test21g1 EXCEPT ALL SELECT * FROM test21p) ORDER BY id;
+(SELECT * FROM test21p EXCEPT ALL SELECT * FROM test21g1) ORDER BY id;
+(SELECT * FROM test21g2 EXCEPT ALL SELECT * FROM test21p) ORDER BY id;
+(SELECT * FROM test21p EXCEPT ALL SELECT * FROM test21g2) ORDER BY id;
+(SELECT * FROM test22g1 EXCEPT ALL SELECT * FROM test22p) ORDER BY id;
+(SELECT * FROM test22p EXCEPT ALL SELECT * FROM test22g1) ORDER BY id;
+(SELECT * FROM test22g2 EXCEPT ALL SELECT * FROM test22p) ORDER BY id;
+(SELECT * FROM test22p EXCEPT ALL SELECT * FROM test22g2) ORDER BY id;
+(SELECT * FROM test22g3 EXCEPT ALL SELECT * FROM test22p) ORDER BY id;
+(SELECT * FROM test22p EXCEPT ALL SELECT * FROM test22g3) ORDER BY id;
+DROP TABLE cache_inner, test21g1, test21g2, test21p, test22g1, test22g2, test22g3, test22p;
+
+-- GPU paths over the device memory budget are rejected
+-- (pg_strom.gpu_memory_plan_ratio)
+CREATE FUNCTION regtest_custom_scan_has(query text, provider text)
+RETURNS bool AS $$
+DECLARE
+  plan jsonb;
+BEGIN
+  EXECUTE 'EXPLAIN (VERBOSE, FORMAT JSON) ' || query INTO plan;
+  RETURN jsonb_path_exists(plan, 'strict $.**."Custom Plan Provider" ? (@ == $p)',
+                           jsonb_build_object('p', provider));
+END;
+$$ LANGUAGE plpgsql;
+SET pg_strom.enabled = on;
+SET pg_strom.gpujoin_inner_buffer_limit = -1;
+SELECT regtest_custom_scan_has('SELECT d.id, l.z FROM join_data d NATURAL JOIN join_enlarge l', 'GpuJoin');
+SELECT regtest_custom_scan_has('SELECT id, count(*) FROM join_data GROUP BY id', 'GpuPreAgg');
+SET pg_strom.gpu_memory_plan_ratio = 0.000001;
+SELECT regtest_custom_scan_has('SELECT d.id, l.z FROM join_data d NATURAL JOIN join_enlarge l', 'GpuJoin');
+SELECT regtest_custom_scan_has('SELECT id, count(*) FROM join_data GROUP BY id', 'GpuPreAgg');
+-- a small number of groups still fits
+SELECT regtest_custom_scan_has('SELECT cat, count(*) FROM join_data GROUP BY cat', 'GpuPreAgg');
+-- the inner buffer that grace hash-join can partition is not rejected
+SET pg_strom.gpujoin_inner_buffer_limit = '1MB';
+SELECT regtest_custom_scan_has('SELECT d.id, l.z FROM join_data d NATURAL JOIN join_enlarge l', 'GpuJoin');
+SELECT d.cat, count(*) cnt, sum(d.id) sid, max(l.z) z_max
+  INTO test23g
+  FROM join_data d NATURAL JOIN join_enlarge l
+ GROUP BY d.cat;
+RESET pg_strom.gpujoin_inner_buffer_limit;
+RESET pg_strom.gpu_memory_plan_ratio;
+SET pg_strom.enabled = off;
+SELECT d.cat, count(*) cnt, sum(d.id) sid, max(l.z) z_max
+  INTO test23p
+  FROM join_data d NATURAL JOIN join_enlarge l
+ GROUP BY d.cat;
+(SELECT * FROM test23g EXCEPT SELECT * FROM test23p) ORDER BY cat;
+(SELECT * FROM test23p EXCEPT SELECT * FROM test23g) ORDER BY cat;
+DROP TABLE test23g, test23p;
+DROP FUNCTION regtest_custom_scan_has(text,text);
+
+-- GpuJoin reads the small inner buffer from the host-mapped shared memory
+-- (pg_strom.gpu_host_mapped_inner_size), unless GPU kernel writes it
+SET pg_strom.enabled = on;
+SELECT regtest_exec_path('SELECT id, d.aid, x + z v FROM join_data d JOIN join_small s ON d.aid = s.aid WHERE d.x > 0.0', 'host-mapped-inner-buffer');
+SELECT id, d.aid, x + z v
+  INTO test24g1
+  FROM join_data d JOIN join_small s ON d.aid = s.aid
+ WHERE d.x > 0.0;
+SELECT d.cat, count(*) cnt, count(s.aid) s_cnt, sum(s.aid) s_sum
+  INTO test25g1
+  FROM join_data d LEFT OUTER JOIN join_small s
+       ON d.aid = s.aid AND s.z > 0.0
+ GROUP BY d.cat;
+ALTER SYSTEM SET pg_strom.gpu_host_mapped_inner_size = 0;
+SELECT regtest_reload_gpuserv();
+SELECT regtest_exec_path('SELECT id, d.aid, x + z v FROM join_data d JOIN join_small s ON d.aid = s.aid WHERE d.x > 0.0', 'host-mapped-inner-buffer');
+SELECT id, d.aid, x + z v
+  INTO test24g2
+  FROM join_data d JOIN join_small s ON d.aid = s.aid
+ WHERE d.x > 0.0;
+ALTER SYSTEM RESET pg_strom.gpu_host_mapped_inner_size;
+SELECT regtest_reload_gpuserv();
+SET pg_strom.enabled = off;
+SELECT id, d.aid, x + z v
+  INTO test24p
+  FROM join_data d JOIN join_small s ON d.aid = s.aid
+ WHERE d.x > 0.0;
+SELECT d.cat, count(*) cnt, count(s.aid) s_cnt, sum(s.aid) s_sum
+  INTO test25p
+  FROM join_data d LEFT OUTER JOIN join_small s
+       ON d.aid = s.aid AND s.z > 0.0
+ GROUP BY d.cat;
+(SELECT * FROM test24g1 EXCEPT ALL SELECT * FROM test24p) ORDER BY id;
+(SELECT * FROM test24p EXCEPT ALL SELECT * FROM test24g1) ORDER BY id;
+(SELECT * FROM test24g2 EXCEPT ALL SELECT * FROM test24p) ORDER BY id;
+(SELECT * FROM test24p EXCEPT ALL SELECT * FROM test24g2) ORDER BY id;
+(SELECT * FROM test25g1 EXCEPT SELECT * FROM test25p) ORDER BY cat;
+(SELECT * FROM test25p EXCEPT SELECT * FROM test25g1) ORDER BY cat;
+DROP TABLE test24g1, test24g2, test24p, test25g1, test25p;
+
+-- GPU kernel yields SMs by the time-slice, then resumes
+-- (pg_strom.gpu_kernel_time_slice)
+CREATE FUNCTION regtest_gpujoin_nitems(query text)
+RETURNS bigint AS $$
+DECLARE
+  plan jsonb;
+BEGIN
+  EXECUTE 'EXPLAIN (ANALYZE, VERBOSE, FORMAT JSON) ' || query INTO plan;
+  RETURN substring(jsonb_path_query_first(plan, 'strict $.**."GPU Join Quals [1]"') #>> '{}'
+                   FROM 'exec: [0-9]+ -> ([0-9]+)')::bigint;
+END;
+$$ LANGUAGE plpgsql;
+SET pg_strom.enabled = on;
+ALTER SYSTEM SET pg_strom.gpu_kernel_time_slice = 1;
+SELECT regtest_reload_gpuserv();
+SELECT regtest_exec_path('SELECT d.id, l.z FROM join_data d JOIN join_enlarge l ON d.aid = l.aid WHERE d.x > 0.0', 'time-slice-yield');
+-- statistics are not counted twice on resume
+SELECT regtest_gpujoin_nitems('SELECT d.id, l.z FROM join_data d JOIN join_enlarge l ON d.aid = l.aid WHERE d.x > 0.0') =
+       (SELECT count(*) FROM join_data d JOIN join_enlarge l
+                          ON d.aid = l.aid WHERE d.x > 0.0);
+SELECT d.cat, count(*) cnt, sum(d.id) sid, max(l.z) z_max
+  INTO test26g
+  FROM join_data d JOIN join_enlarge l ON d.aid = l.aid
+ WHERE d.x > 0.0
+ GROUP BY d.cat;
+SELECT d.id, l.z
+  INTO test27g
+  FROM join_data d LEFT OUTER JOIN join_enlarge l
+       ON d.aid = l.aid AND l.z > 0.0
+ WHERE d.y > 0.0;
+ALTER SYSTEM RESET pg_strom.gpu_kernel_time_slice;
+SELECT regtest_reload_gpuserv();
+SELECT regtest_exec_path('SELECT d.id, l.z FROM join_data d JOIN join_enlarge l ON d.aid = l.aid WHERE d.x > 0.0', 'time-slice-yield');
+SET pg_strom.enabled = off;
+SELECT d.cat, count(*) cnt, sum(d.id) sid, max(l.z) z_max
+  INTO test26p
+  FROM join_data d JOIN join_enlarge l ON d.aid = l.aid
+ WHERE d.x > 0.0
+ GROUP BY d.cat;
+SELECT d.id, l.z
+  INTO test27p
+  FROM join_data d LEFT OUTER JOIN join_enlarge l
+       ON d.aid = l.aid AND l.z > 0.0
+ WHERE d.y > 0.0;
+(SELECT * FROM test26g EXCEPT SELECT * FROM test26p) ORDER BY cat;
+(SELECT * FROM test26p EXCEPT SELECT * FROM test26g) ORDER BY cat;
+(SELECT * FROM test27g EXCEPT ALL SELECT * FROM test27p) ORDER BY id;
+(SELECT * FROM test27p EXCEPT ALL SELECT * FROM test27g) ORDER BY id;
+DROP TABLE test26g, test26p, test27g, test27p;
+DROP FUNCTION regtest_gpujoin_nitems(text);
+
+-- GpuJoin inner buffers shared with the peer GPUs connected by NVLink,
+-- when the chunks are distributed to multiple GPUs (pg_strom.gpu_peer_inner_buffer)
+SET pg_strom.enabled = on;
+SET pg_strom.multi_gpu_split = on;
+-- the peer GPUs connected by NVLink may be missing, but the inner buffer
+-- on the peer GPU is used only by the multi-GPU query
+SELECT regtest_exec_path('SELECT d.cat, count(*) cnt, sum(d.id) sid, max(l.z) z_max FROM join_data d JOIN join_enlarge l ON d.aid = l.aid WHERE d.y > 0.0 GROUP BY d.cat', 'peer-inner-buffer') <=
+       regtest_exec_path('SELECT d.cat, count(*) cnt, sum(d.id) sid, max(l.z) z_max FROM join_data d JOIN join_enlarge l ON d.aid = l.aid WHERE d.y > 0.0 GROUP BY d.cat', 'multi-gpu');
+SELECT d.cat, count(*) cnt, sum(d.id) sid, max(l.z) z_max
+  INTO test28g1
+  FROM join_data d JOIN join_enlarge l ON d.aid = l.aid
+ WHERE d.y > 0.0
+ GROUP BY d.cat;
+ALTER SYSTEM SET pg_strom.gpu_peer_inner_buffer = off;
+SELECT regtest_reload_gpuserv();
+SELECT regtest_exec_path('SELECT d.cat, count(*) cnt, sum(d.id) sid, max(l.z) z_max FROM join_data d JOIN join_enlarge l ON d.aid = l.aid WHERE d.y > 0.0 GROUP BY d.cat', 'peer-inner-buffer');
+SELECT d.cat, count(*) cnt, sum(d.id) sid, max(l.z) z_max
+  INTO test28g2
+  FROM join_data d JOIN join_enlarge l ON d.aid = l.aid
+ WHERE d.y > 0.0
+ GROUP BY d.cat;
+ALTER SYSTEM RESET pg_strom.gpu_peer_inner_buffer;
+SELECT regtest_reload_gpuserv();
+RESET pg_strom.multi_gpu_split;
+SET pg_strom.enabled = off;
+SELECT d.cat, count(*) cnt, sum(d.id) sid, max(l.z) z_max
+  INTO test28p
+  FROM join_data d JOIN join_enlarge l ON d.aid = l.aid
+ WHERE d.y > 0.0
+ GROUP BY d.cat;
+(SELECT * FROM test28g1 EXCEPT SELECT * FROM test28p) ORDER BY cat;
+(SELECT * FROM test28p EXCEPT SELECT * FROM test28g1) ORDER BY cat;
+(SELECT * FROM test28g2 EXCEPT SELECT * FROM test28p) ORDER BY cat;
+(SELECT * FROM test28p EXCEPT SELECT * FROM test28g2) ORDER BY cat;
+DROP TABLE test28g1, test28g2, test28p;
@@ -0,0 +1,908 @@
+---
+--- Test for the execution paths of GpuScan on PostgreSQL table
+---
+SET pg_strom.regression_test_mode = on;
+
+SET client_min_messages = error;
+DROP SCHEMA IF EXISTS regtest_gpu_scan_temp CASCADE;
+CREATE SCHEMA regtest_gpu_scan_temp;
+RESET client_min_messages;
+
+SET search_path = regtest_gpu_scan_temp,public;
+
+-- disables SeqScan and parallel query
+SET enable_seqscan = off;
+SET max_parallel_workers_per_gather = 0;
+
+-- prepare tables
+CREATE TABLE scan_data (
+  id    int,
+  aid   int,
+  cat   text,
+  x     float,
+  y     float,
+  memo  text
+);
+SELECT pgstrom.random_setseed(20190714);
+INSERT INTO scan_data (
+  SELECT x, pgstrom.random_int(0.5, 1, 4000),
+            CASE floor(random()*26)
+            WHEN 0 THEN 'aaa'
+            WHEN  1 THEN 'bbb'
+            WHEN  2 THEN 'ccc'
+            WHEN  3 THEN 'ddd'
+            WHEN  4 THEN 'eee'
+            WHEN  5 THEN 'fff'
+            WHEN  6 THEN 'ggg'
+            WHEN  7 THEN 'hhh'
+            WHEN  8 THEN 'iii'
+            WHEN  9 THEN 'jjj'
+            WHEN 10 THEN 'kkk'
+            WHEN 11 THEN 'lll'
+            WHEN 12 THEN 'mmm'
+            WHEN 13 THEN 'nnn'
+            WHEN 14 THEN 'ooo'
+            WHEN 15 THEN 'ppp'
+            WHEN 16 THEN 'qqq'
+            WHEN 17 THEN 'rrr'
+            WHEN 18 THEN 'sss'
+            WHEN 19 THEN 'ttt'
+            WHEN 20 THEN 'uuu'
+            WHEN 21 THEN 'vvv'
+            WHEN 22 THEN 'www'
+            WHEN 23 THEN 'xxx'
+            WHEN 24 THEN 'yyy'
+            ELSE 'zzz'
+            END,
+            pgstrom.random_float(2,-1000.0,1000.0),
+            pgstrom.random_float(2,-1000.0,1000.0),
+            pgstrom.random_text_len(2, 200)
+    FROM generate_series(1,400001) x);
+UPDATE scan_data
+   SET memo = md5(memo) || md5(memo)
+ WHERE id = 400001;
+UPDATE scan_data
+   SET memo = memo || '-' || memo || '-' || memo || '-' || memo
+ WHERE id = 400001;
+UPDATE scan_data
+   SET memo = memo || '-' || memo || '-' || memo || '-' || memo
+ WHERE id = 400001;
+UPDATE scan_data
+   SET memo = memo || '-' || memo || '-' || memo || '-' || memo
+ WHERE id = 400001;
+
+CREATE TABLE scan_small (
+  aid   int,
+  z     float,
+  md5   varchar(32)
+);
+INSERT INTO scan_small (
+  SELECT x, pgstrom.random_float(2,-1000.0,1000.0),
+            md5(x::text)
+    FROM generate_series(1,4000) x);
+
+CREATE TABLE scan_enlarge (
+  aid   int,
+  z     float,
+  md5   char(200)
+);
+INSERT INTO scan_enlarge (
+  SELECT x / 5, pgstrom.random_float(2,-1000.0,1000.0),
+            md5(x::text)
+    FROM generate_series(1,20000) x);
+VACUUM ANALYZE;
+
+-- execution paths taken by the xPU tasks, shown by EXPLAIN ANALYZE
+CREATE FUNCTION regtest_exec_path(query text, path text)
+RETURNS bool AS $$
+DECLARE
+  plan jsonb;
+BEGIN
+  EXECUTE 'EXPLAIN (ANALYZE, COSTS OFF, FORMAT JSON) ' || query INTO plan;
+  RETURN EXISTS (SELECT 1
+                   FROM jsonb_path_query(plan, 'strict $.**."Exec Paths"') p,
+                        unnest(string_to_array(p #>> '{}', ', ')) x
+                  WHERE x = path);
+END;
+$$ LANGUAGE plpgsql;
+
+-- RIGHT OUTER JOIN and GpuPreAgg with chunks distributed to multiple GPUs
+SET pg_strom.enabled = on;
+SET pg_strom.multi_gpu_split = on;
+-- the session connects to all the GPUs, if two or more
+SELECT regtest_exec_path('SELECT cat, count(*) FROM scan_data WHERE x < 500.0 GROUP BY cat', 'multi-gpu') =
+       ((SELECT count(DISTINCT gpu_id) FROM pgstrom.gpu_device_info) > 1);
+SELECT s.aid, count(d.id) cnt, sum(d.id) sid, max(d.x) x_max
+  INTO test01g
+  FROM scan_data d RIGHT OUTER JOIN scan_small s
+       ON d.aid = s.aid AND d.x > 900.0
+ GROUP BY s.aid;
+SELECT cat, count(*) cnt, sum(aid) s, min(y) y_min
+  INTO test02g
+  FROM scan_data
+ WHERE x < 500.0
+ GROUP BY cat;
+RESET pg_strom.multi_gpu_split;
+SELECT regtest_exec_path('SELECT cat, count(*) FROM scan_data WHERE x < 500.0 GROUP BY cat', 'multi-gpu');
+SET pg_strom.enabled = off;
+SELECT s.aid, count(d.id) cnt, sum(d.id) sid, max(d.x) x_max
+  INTO test01p
+  FROM scan_data d RIGHT OUTER JOIN scan_small s
+       ON d.aid = s.aid AND d.x > 900.0
+ GROUP BY s.aid;
+SELECT cat, count(*) cnt, sum(aid) s, min(y) y_min
+  INTO test02p
+  FROM scan_data
+ WHERE x < 500.0
+ GROUP BY cat;
+(SELECT * FROM test01g EXCEPT SELECT * FROM test01p) ORDER BY aid;
+(SELECT * FROM test01p EXCEPT SELECT * FROM test01g) ORDER BY aid;
+(SELECT * FROM test02g EXCEPT SELECT * FROM test02p) ORDER BY cat;
+(SELECT * FROM test02p EXCEPT SELECT * FROM test02g) ORDER BY cat;
+DROP TABLE test01g, test01p, test02g, test02p;
+
+-- GpuScan over many small chunks; the grid size of GPU kernels is tuned
+-- online by the kernel time per row (pg_strom.gpu_grid_size_tuning)
+SET pg_strom.enabled = on;
+SET pg_strom.chunk_size_min = 1;
+-- some chunks run with the grid size reduced by the tuner
+SELECT regtest_exec_path('SELECT id, aid, x * y v1, x - y v2 FROM scan_data WHERE y > -900.0', 'grid-tuning');
+SELECT id, aid, x * y v1, x - y v2
+  INTO test03g
+  FROM scan_data
+ WHERE y > -900.0;
+RESET pg_strom.chunk_size_min;
+SET pg_strom.enabled = off;
+SELECT id, aid, x * y v1, x - y v2
+  INTO test03p
+  FROM scan_data
+ WHERE y > -900.0;
+(SELECT * FROM test03g EXCEPT SELECT * FROM test03p) ORDER BY id;
+(SELECT * FROM test03p EXCEPT SELECT * FROM test03g) ORDER BY id;
+DROP TABLE test03g, test03p;
+
+-- GpuScan results sent back through the shared memory ring; a small ring
+-- runs out of space, then the rest of results come through the socket
+SET pg_strom.enabled = on;
+SET pg_strom.xpu_connection_pool_size = 0;
+SET pg_strom.gpu_result_ring_size = 1;
+SELECT regtest_exec_path('SELECT id, aid, cat, x + y v FROM scan_data WHERE x > -500.0', 'result-ring');
+SELECT id, aid, cat, x + y v
+  INTO test04g
+  FROM scan_data
+ WHERE x > -500.0;
+SET pg_strom.gpu_result_ring_size = 0;
+SELECT regtest_exec_path('SELECT id, aid, cat, x + y v FROM scan_data WHERE x > -500.0', 'result-ring');
+SELECT id, aid, cat, x + y v
+  INTO test04s
+  FROM scan_data
+ WHERE x > -500.0;
+RESET pg_strom.gpu_result_ring_size;
+RESET pg_strom.xpu_connection_pool_size;
+SET pg_strom.enabled = off;
+SELECT id, aid, cat, x + y v
+  INTO test04p
+  FROM scan_data
+ WHERE x > -500.0;
+(SELECT * FROM test04g EXCEPT SELECT * FROM test04p) ORDER BY id;
+(SELECT * FROM test04p EXCEPT SELECT * FROM test04g) ORDER BY id;
+(SELECT * FROM test04s EXCEPT SELECT * FROM test04p) ORDER BY id;
+(SELECT * FROM test04p EXCEPT SELECT * FROM test04s) ORDER BY id;
+DROP TABLE test04g, test04s, test04p;
+
+-- GPU service restarts on SIGHUP; wait for the GPU paths to be available
+CREATE FUNCTION regtest_reload_gpuserv()
+RETURNS bool AS $$
+DECLARE
+  plan text;
+BEGIN
+  PERFORM pg_reload_conf();
+  PERFORM pg_sleep(1.0);
+  FOR i IN 1 .. 120
+  LOOP
+    EXECUTE 'EXPLAIN (COSTS OFF) SELECT * FROM scan_small WHERE z > 0.0'
+       INTO plan;
+    IF plan LIKE '%GpuScan%' THEN
+      RETURN true;
+    END IF;
+    PERFORM pg_sleep(0.5);
+  END LOOP;
+  RETURN false;
+END;
+$$ LANGUAGE plpgsql;
+
+-- the specialized module is built in background; wait for the switch
+CREATE FUNCTION regtest_wait_exec_path(query text, path text)
+RETURNS bool AS $$
+BEGIN
+  FOR i IN 1 .. 120
+  LOOP
+    IF regtest_exec_path(query, path) THEN
+      RETURN true;
+    END IF;
+    PERFORM pg_sleep(0.5);
+  END LOOP;
+  RETURN false;
+END;
+$$ LANGUAGE plpgsql;
+-- GpuScan by the sessions with the same set of device functions; GPU service
+-- builds the specialized module in background, then switches to it
+SET pg_strom.enabled = on;
+ALTER SYSTEM SET pg_strom.gpu_jit_specialization = on;
+ALTER SYSTEM SET pg_strom.gpu_jit_threshold = 1;
+SELECT regtest_reload_gpuserv();
+SELECT regtest_wait_exec_path('SELECT id, sqrt(abs(x)) v1, y * 2.0 v2 FROM scan_data WHERE aid % 7 = 3', 'specialized-module');
+SELECT id, sqrt(abs(x)) v1, y * 2.0 v2
+  INTO test05g1
+  FROM scan_data
+ WHERE aid % 7 = 3;
+SELECT id, sqrt(abs(x)) v1, y * 2.0 v2
+  INTO test05g2
+  FROM scan_data
+ WHERE aid % 7 = 3;
+SELECT id, sqrt(abs(x)) v1, y * 2.0 v2
+  INTO test05g3
+  FROM scan_data
+ WHERE aid % 7 = 3;
+ALTER SYSTEM RESET pg_strom.gpu_jit_specialization;
+ALTER SYSTEM RESET pg_strom.gpu_jit_threshold;
+SELECT regtest_reload_gpuserv();
+SELECT regtest_exec_path('SELECT id, sqrt(abs(x)) v1, y * 2.0 v2 FROM scan_data WHERE aid % 7 = 3', 'specialized-module');
+SET pg_strom.enabled = off;
+SELECT id, sqrt(abs(x)) v1, y * 2.0 v2
+  INTO test05p
+  FROM scan_data
+ WHERE aid % 7 = 3;
+(SELECT * FROM test05g1 EXCEPT SELECT * FROM test05p) ORDER BY id;
+(SELECT * FROM test05p EXCEPT SELECT * FROM test05g1) ORDER BY id;
+(SELECT * FROM test05g2 EXCEPT SELECT * FROM test05p) ORDER BY id;
+(SELECT * FROM test05p EXCEPT SELECT * FROM test05g2) ORDER BY id;
+(SELECT * FROM test05g3 EXCEPT SELECT * FROM test05p) ORDER BY id;
+(SELECT * FROM test05p EXCEPT SELECT * FROM test05g3) ORDER BY id;
+DROP TABLE test05g1, test05g2, test05g3, test05p;
+
+-- GpuJoin and GpuPreAgg with the data chunks on the device memory,
+-- loaded by the explicit DMA instead of the fault-driven migration
+SET pg_strom.enabled = on;
+ALTER SYSTEM SET pg_strom.gpu_mempool_device_mode = on;
+SELECT regtest_reload_gpuserv();
+SELECT id, d.aid, x + z v
+  INTO test06g
+  FROM scan_data d JOIN scan_small s ON d.aid = s.aid
+ WHERE y < 0.0;
+SELECT aid % 50 k, count(*) cnt, sum(id) s, max(x) x_max
+  INTO test07g
+  FROM scan_data
+ GROUP BY k;
+SELECT regtest_exec_path('SELECT id, d.aid, x + z v FROM scan_data d JOIN scan_small s ON d.aid = s.aid WHERE y < 0.0', 'device-memory');
+SELECT regtest_exec_path('SELECT aid % 50 k, count(*) cnt, sum(id) s, max(x) x_max FROM scan_data GROUP BY k', 'device-memory');
+ALTER SYSTEM RESET pg_strom.gpu_mempool_device_mode;
+SELECT regtest_reload_gpuserv();
+SELECT regtest_exec_path('SELECT id, d.aid, x + z v FROM scan_data d JOIN scan_small s ON d.aid = s.aid WHERE y < 0.0', 'device-memory');
+SET pg_strom.enabled = off;
+SELECT id, d.aid, x + z v
+  INTO test06p
+  FROM scan_data d JOIN scan_small s ON d.aid = s.aid
+ WHERE y < 0.0;
+SELECT aid % 50 k, count(*) cnt, sum(id) s, max(x) x_max
+  INTO test07p
+  FROM scan_data
+ GROUP BY k;
+(SELECT * FROM test06g EXCEPT SELECT * FROM test06p) ORDER BY id;
+(SELECT * FROM test06p EXCEPT SELECT * FROM test06g) ORDER BY id;
+(SELECT * FROM test07g EXCEPT SELECT * FROM test07p) ORDER BY k;
+(SELECT * FROM test07p EXCEPT SELECT * FROM test07g) ORDER BY k;
+DROP TABLE test06g, test06p, test07g, test07p;
+
+-- GPU memory budget of the session
+CREATE FUNCTION regtest_gpumem_budget(query text)
+RETURNS text AS $$
+BEGIN
+  EXECUTE query;
+  RETURN 'ok';
+EXCEPTION WHEN OTHERS THEN
+  IF SQLERRM LIKE '%GPU memory budget of the session%' OR
+     SQLERRM LIKE '%OUT_OF_MEMORY%'
+  THEN
+    RETURN 'exceeded';
+  END IF;
+  RAISE;
+END;
+$$ LANGUAGE plpgsql;
+SET pg_strom.enabled = on;
+SET pg_strom.gpu_session_memory_limit = 1;
+SELECT regtest_gpumem_budget('SELECT count(*) FROM scan_data d
+                                 NATURAL JOIN scan_enlarge l');
+SET pg_strom.gpu_session_memory_limit = 4096;
+SELECT regtest_gpumem_budget('SELECT count(*) FROM scan_data d
+                                 NATURAL JOIN scan_enlarge l');
+SELECT l.aid, count(*) cnt, sum(id) s
+  INTO test08g
+  FROM scan_data d NATURAL JOIN scan_enlarge l
+ GROUP BY l.aid;
+RESET pg_strom.gpu_session_memory_limit;
+SET pg_strom.enabled = off;
+SELECT l.aid, count(*) cnt, sum(id) s
+  INTO test08p
+  FROM scan_data d NATURAL JOIN scan_enlarge l
+ GROUP BY l.aid;
+(SELECT * FROM test08g EXCEPT SELECT * FROM test08p) ORDER BY aid;
+(SELECT * FROM test08p EXCEPT SELECT * FROM test08g) ORDER BY aid;
+DROP TABLE test08g, test08p;
+
+-- GPU queries in turn on the connections kept in the pool
+SET pg_strom.enabled = on;
+SET pg_strom.xpu_connection_pool_size = 2;
+SELECT id, aid, x * 2.0 v
+  INTO test09g1
+  FROM scan_data
+ WHERE y > 800.0;
+SELECT aid % 30 k, count(*) cnt, min(x) x_min
+  INTO test10g
+  FROM scan_data
+ GROUP BY k;
+SELECT id, aid, x * 2.0 v
+  INTO test09g2
+  FROM scan_data
+ WHERE y > 800.0;
+-- the next query runs on the connection kept by the previous one
+SELECT regtest_exec_path('SELECT id, aid, x * 2.0 v FROM scan_data WHERE y > 800.0', 'pooled-connection');
+-- the connection already in the pool is used once more, but never kept again
+SET pg_strom.xpu_connection_pool_size = 0;
+SELECT regtest_exec_path('SELECT id, aid, x * 2.0 v FROM scan_data WHERE y > 800.0', 'pooled-connection');
+SELECT regtest_exec_path('SELECT id, aid, x * 2.0 v FROM scan_data WHERE y > 800.0', 'pooled-connection');
+RESET pg_strom.xpu_connection_pool_size;
+SET pg_strom.enabled = off;
+SELECT id, aid, x * 2.0 v
+  INTO test09p
+  FROM scan_data
+ WHERE y > 800.0;
+SELECT aid % 30 k, count(*) cnt, min(x) x_min
+  INTO test10p
+  FROM scan_data
+ GROUP BY k;
+(SELECT * FROM test09g1 EXCEPT SELECT * FROM test09p) ORDER BY id;
+(SELECT * FROM test09p EXCEPT SELECT * FROM test09g1) ORDER BY id;
+(SELECT * FROM test09g2 EXCEPT SELECT * FROM test09p) ORDER BY id;
+(SELECT * FROM test09p EXCEPT SELECT * FROM test09g2) ORDER BY id;
+(SELECT * FROM test10g EXCEPT SELECT * FROM test10p) ORDER BY k;
+(SELECT * FROM test10p EXCEPT SELECT * FROM test10g) ORDER BY k;
+DROP TABLE test09g1, test09g2, test09p, test10g, test10p;
+
+-- many in-flight xPU commands under the adaptive window, and the fixed
+-- window of pg_strom.max_async_tasks (xpu_max_inflight_tasks = 0)
+SET pg_strom.enabled = on;
+SET pg_strom.chunk_size_min = 1;
+-- the fixed window allows only one command in flight
+SET pg_strom.max_async_tasks = 1;
+SET pg_strom.xpu_max_inflight_tasks = 64;
+SELECT regtest_exec_path('SELECT id, cat, x + y v FROM scan_data WHERE aid < 2000', 'inflight-window');
+SELECT id, cat, x + y v
+  INTO test11g
+  FROM scan_data
+ WHERE aid < 2000;
+SET pg_strom.xpu_max_inflight_tasks = 0;
+SELECT regtest_exec_path('SELECT id, cat, x + y v FROM scan_data WHERE aid < 2000', 'inflight-window');
+SELECT id, cat, x + y v
+  INTO test11f
+  FROM scan_data
+ WHERE aid < 2000;
+RESET pg_strom.xpu_max_inflight_tasks;
+RESET pg_strom.max_async_tasks;
+RESET pg_strom.chunk_size_min;
+SET pg_strom.enabled = off;
+SELECT id, cat, x + y v
+  INTO test11p
+  FROM scan_data
+ WHERE aid < 2000;
+(SELECT * FROM test11g EXCEPT SELECT * FROM test11p) ORDER BY id;
+(SELECT * FROM test11p EXCEPT SELECT * FROM test11g) ORDER BY id;
+(SELECT * FROM test11f EXCEPT SELECT * FROM test11p) ORDER BY id;
+(SELECT * FROM test11p EXCEPT SELECT * FROM test11f) ORDER BY id;
+DROP TABLE test11g, test11f, test11p;
+
+-- direct relation scan with the read-ahead prefetch of the next chunks
+SET pg_strom.enabled = on;
+SET pg_strom.gpudirect_threshold = 0;
+SET pg_strom.chunk_size_min = 1;
+SET pg_strom.relscan_prefetch_chunks = 8;
+SELECT regtest_exec_path('SELECT id, aid, x - y v FROM scan_data WHERE cat IN (''aaa'', ''kkk'', ''zzz'')', 'read-ahead');
+SELECT id, aid, x - y v
+  INTO test12g
+  FROM scan_data
+ WHERE cat IN ('aaa', 'kkk', 'zzz');
+SET pg_strom.relscan_prefetch_chunks = 0;
+SELECT regtest_exec_path('SELECT id, aid, x - y v FROM scan_data WHERE cat IN (''aaa'', ''kkk'', ''zzz'')', 'read-ahead');
+SELECT id, aid, x - y v
+  INTO test12n
+  FROM scan_data
+ WHERE cat IN ('aaa', 'kkk', 'zzz');
+RESET pg_strom.relscan_prefetch_chunks;
+RESET pg_strom.chunk_size_min;
+RESET pg_strom.gpudirect_threshold;
+SET pg_strom.enabled = off;
+SELECT id, aid, x - y v
+  INTO test12p
+  FROM scan_data
+ WHERE cat IN ('aaa', 'kkk', 'zzz');
+(SELECT * FROM test12g EXCEPT SELECT * FROM test12p) ORDER BY id;
+(SELECT * FROM test12p EXCEPT SELECT * FROM test12g) ORDER BY id;
+(SELECT * FROM test12n EXCEPT SELECT * FROM test12p) ORDER BY id;
+(SELECT * FROM test12p EXCEPT SELECT * FROM test12n) ORDER BY id;
+DROP TABLE test12g, test12n, test12p;
+
+-- parallel direct relation scan; workers reserve multiple chunks at once,
+-- then claim one chunk at a time near the end of the relation
+SET pg_strom.enabled = on;
+SET pg_strom.gpudirect_threshold = 0;
+SET pg_strom.chunk_size_min = 1;
+SET max_parallel_workers_per_gather = 3;
+SET parallel_setup_cost = 0;
+SET parallel_tuple_cost = 0;
+SET pg_strom.parallel_claim_chunks = 16;
+SELECT regtest_exec_path('SELECT cat, count(*) cnt, sum(id) s, max(y) y_max FROM scan_data WHERE x > -950.0 GROUP BY cat', 'multi-chunk-claim');
+SELECT cat, count(*) cnt, sum(id) s, max(y) y_max
+  INTO test13g
+  FROM scan_data
+ WHERE x > -950.0
+ GROUP BY cat;
+SET pg_strom.parallel_claim_chunks = 1;
+SELECT regtest_exec_path('SELECT cat, count(*) cnt, sum(id) s, max(y) y_max FROM scan_data WHERE x > -950.0 GROUP BY cat', 'multi-chunk-claim');
+SELECT cat, count(*) cnt, sum(id) s, max(y) y_max
+  INTO test13n
+  FROM scan_data
+ WHERE x > -950.0
+ GROUP BY cat;
+RESET pg_strom.parallel_claim_chunks;
+SET max_parallel_workers_per_gather = 0;
+RESET parallel_setup_cost;
+RESET parallel_tuple_cost;
+RESET pg_strom.chunk_size_min;
+RESET pg_strom.gpudirect_threshold;
+SET pg_strom.enabled = off;
+SELECT cat, count(*) cnt, sum(id) s, max(y) y_max
+  INTO test13p
+  FROM scan_data
+ WHERE x > -950.0
+ GROUP BY cat;
+(SELECT * FROM test13g EXCEPT SELECT * FROM test13p) ORDER BY cat;
+(SELECT * FROM test13p EXCEPT SELECT * FROM test13g) ORDER BY cat;
+(SELECT * FROM test13n EXCEPT SELECT * FROM test13p) ORDER BY cat;
+(SELECT * FROM test13p EXCEPT SELECT * FROM test13n) ORDER BY cat;
+DROP TABLE test13g, test13n, test13p;
+
+-- GpuJoin over the direct relation scan; pages not loaded by GPU-Direct SQL
+-- are read through the VFS fallback and its DMA buffers
+-- (preallocated if pg_strom.gpudirect_dma_pool_size is configured)
+SET pg_strom.enabled = on;
+SET pg_strom.gpudirect_threshold = 0;
+SELECT id, d.aid, x + y + z v, md5
+  INTO test14g
+  FROM scan_data d JOIN scan_small s ON d.aid = s.aid
+ WHERE z > 0.0;
+-- DMA buffers of the VFS fallback come from the pool, only if configured
+SELECT regtest_exec_path('SELECT id, d.aid, x + y + z v, md5 FROM scan_data d JOIN scan_small s ON d.aid = s.aid WHERE z > 0.0', 'dma-pool') =
+       (regtest_exec_path('SELECT id, d.aid, x + y + z v, md5 FROM scan_data d JOIN scan_small s ON d.aid = s.aid WHERE z > 0.0', 'vfs-fallback') AND
+        current_setting('pg_strom.gpudirect_dma_pool_size') <> '0');
+RESET pg_strom.gpudirect_threshold;
+SET pg_strom.enabled = off;
+SELECT id, d.aid, x + y + z v, md5
+  INTO test14p
+  FROM scan_data d JOIN scan_small s ON d.aid = s.aid
+ WHERE z > 0.0;
+(SELECT * FROM test14g EXCEPT SELECT * FROM test14p) ORDER BY id;
+(SELECT * FROM test14p EXCEPT SELECT * FROM test14g) ORDER BY id;
+DROP TABLE test14g, test14p;
+
+-- zone-map to skip block-ranges of the tables without BRIN-index
+CREATE TABLE zm_data AS
+  SELECT id, aid, x, y FROM scan_data ORDER BY id;
+CREATE TRIGGER zm_data_sync AFTER INSERT OR UPDATE ON zm_data
+  FOR EACH ROW EXECUTE FUNCTION pgstrom.zonemap_sync_trigger();
+-- replica sessions skip the trigger unless it is enabled always
+SELECT pgstrom.zonemap_build('zm_data') > 0;
+ALTER TABLE zm_data ENABLE ALWAYS TRIGGER zm_data_sync;
+VACUUM ANALYZE zm_data;
+SELECT pgstrom.zonemap_build('zm_data') > 0;
+CREATE FUNCTION regtest_zonemap_skipped(query text)
+RETURNS bigint AS $$
+DECLARE
+  plan jsonb;
+BEGIN
+  EXECUTE 'EXPLAIN (ANALYZE, VERBOSE, FORMAT JSON) ' || query INTO plan;
+  RETURN substring(jsonb_path_query_first(plan, 'strict $.**."Zone Map"') #>> '{}'
+                   FROM 'skipped: ([0-9]+) blocks')::bigint;
+END;
+$$ LANGUAGE plpgsql;
+SET pg_strom.enabled = on;
+SELECT regtest_zonemap_skipped('SELECT * FROM zm_data WHERE id BETWEEN 100000 AND 120000') > 0;
+SELECT id, aid, x + y v
+  INTO test15g
+  FROM zm_data
+ WHERE id BETWEEN 100000 AND 120000;
+SET pg_strom.enable_zonemap = off;
+SELECT regtest_zonemap_skipped('SELECT * FROM zm_data WHERE id BETWEEN 100000 AND 120000');
+RESET pg_strom.enable_zonemap;
+-- tuples written after the build are never skipped
+UPDATE zm_data SET id = 110000 + id % 10 WHERE id > 399990;
+SELECT id, aid, x + y v
+  INTO test16g
+  FROM zm_data
+ WHERE id BETWEEN 100000 AND 120000;
+SET pg_strom.enabled = off;
+SELECT id, aid, x + y v
+  INTO test16p
+  FROM zm_data
+ WHERE id BETWEEN 100000 AND 120000;
+SELECT id, aid, x + y v
+  INTO test15p
+  FROM scan_data
+ WHERE id BETWEEN 100000 AND 120000;
+(SELECT * FROM test15g EXCEPT ALL SELECT * FROM test15p) ORDER BY id;
+(SELECT * FROM test15p EXCEPT ALL SELECT * FROM test15g) ORDER BY id;
+(SELECT * FROM test16g EXCEPT ALL SELECT * FROM test16p) ORDER BY id;
+(SELECT * FROM test16p EXCEPT ALL SELECT * FROM test16g) ORDER BY id;
+SELECT count(*) FROM test16g WHERE id BETWEEN 110000 AND 110009;
+DROP TABLE zm_data, test15g, test15p, test16g, test16p;
+
+-- GPU Top-N selection of ORDER BY ... LIMIT (pg_strom.enable_gputopk)
+CREATE FUNCTION regtest_explain_has(query text, key text)
+RETURNS bool AS $$
+DECLARE
+  plan jsonb;
+BEGIN
+  EXECUTE 'EXPLAIN (VERBOSE, FORMAT JSON) ' || query INTO plan;
+  RETURN jsonb_path_exists(plan, ('strict $.**."' || key || '"')::jsonpath);
+END;
+$$ LANGUAGE plpgsql;
+SET pg_strom.enabled = on;
+SELECT regtest_explain_has('SELECT id, aid, x FROM scan_data WHERE y > 0.0 ORDER BY x DESC, id LIMIT 500',
+                           'GPU Top-N');
+SELECT id, aid, x
+  INTO test17g
+  FROM scan_data
+ WHERE y > 0.0
+ ORDER BY x DESC, id
+ LIMIT 500;
+SELECT id, aid, x
+  INTO test18g
+  FROM scan_data
+ ORDER BY aid DESC NULLS FIRST
+ FETCH FIRST 300 ROWS WITH TIES;
+SELECT d.id, s.aid, s.z
+  INTO test19g
+  FROM scan_data d JOIN scan_small s ON d.aid = s.aid
+ ORDER BY s.z, d.id
+ LIMIT 1000;
+SET pg_strom.enable_gputopk = off;
+SELECT regtest_explain_has('SELECT id, aid, x FROM scan_data WHERE y > 0.0 ORDER BY x DESC, id LIMIT 500',
+                           'GPU Top-N');
+RESET pg_strom.enable_gputopk;
+SET pg_strom.enabled = off;
+SELECT id, aid, x
+  INTO test17p
+  FROM scan_data
+ WHERE y > 0.0
+ ORDER BY x DESC, id
+ LIMIT 500;
+SELECT id, aid, x
+  INTO test18p
+  FROM scan_data
+ ORDER BY aid DESC NULLS FIRST
+ FETCH FIRST 300 ROWS WITH TIES;
+SELECT d.id, s.aid, s.z
+  INTO test19p
+  FROM scan_data d JOIN scan_small s ON d.aid = s.aid
+ ORDER BY s.z, d.id
+ LIMIT 1000;
+(SELECT * FROM test17g EXCEPT ALL SELECT * FROM test17p) ORDER BY id;
+(SELECT * FROM test17p EXCEPT ALL SELECT * FROM test17g) ORDER BY id;
+(SELECT * FROM test18g EXCEPT ALL SELECT * FROM test18p) ORDER BY id;
+(SELECT * FROM test18p EXCEPT ALL SELECT * FROM test18g) ORDER BY id;
+(SELECT * FROM test19g EXCEPT ALL SELECT * FROM test19p) ORDER BY id;
+(SELECT * FROM test19p EXCEPT ALL SELECT * FROM test19g) ORDER BY id;
+DROP TABLE test17g, test17p, test18g, test18p, test19g, test19p;
+
+-- GPU Sort of the GpuScan results by the leading sort key (pg_strom.enable_gpusort)
+SET pg_strom.enabled = on;
+SELECT regtest_explain_has('SELECT id, x FROM scan_data WHERE aid % 3 = 0 ORDER BY x',
+                           'GPU Sort');
+SELECT count(*)
+  FROM (SELECT row_number() OVER () rn, x, lag(x) OVER () px
+          FROM (SELECT x FROM scan_data WHERE aid % 3 = 0 ORDER BY x) s) t
+ WHERE rn > 1 AND (px > x OR (px IS NULL AND x IS NOT NULL));
+SELECT count(*)
+  FROM (SELECT row_number() OVER () rn, aid, lag(aid) OVER () px
+          FROM (SELECT aid FROM scan_data WHERE y > 0.0 ORDER BY aid DESC NULLS FIRST) s) t
+ WHERE rn > 1 AND (px < aid OR (px IS NOT NULL AND aid IS NULL));
+SELECT id, aid, x
+  INTO test20g
+  FROM scan_data
+ WHERE aid % 3 = 0
+ ORDER BY x, id;
+-- tuples by CPU fallback are merged as another run
+SET client_min_messages = warning;
+SELECT count(*)
+  FROM (SELECT row_number() OVER () rn, x, lag(x) OVER () px
+          FROM (SELECT x FROM scan_data WHERE memo LIKE '%ab%' ORDER BY x) s) t
+ WHERE rn > 1 AND (px > x OR (px IS NULL AND x IS NOT NULL));
+RESET client_min_messages;
+SET pg_strom.enable_gpusort = off;
+SELECT regtest_explain_has('SELECT id, x FROM scan_data WHERE aid % 3 = 0 ORDER BY x',
+                           'GPU Sort');
+RESET pg_strom.enable_gpusort;
+SET pg_strom.enabled = off;
+SELECT id, aid, x
+  INTO test20p
+  FROM scan_data
+ WHERE aid % 3 = 0
+ ORDER BY x, id;
+(SELECT * FROM test20g EXCEPT ALL SELECT * FROM test20p) ORDER BY id;
+(SELECT * FROM test20p EXCEPT ALL SELECT * FROM test20g) ORDER BY id;
+DROP TABLE test20g, test20p;
+
+-- BRIN-index ranges are claimed by the workers, and the ranges of
+-- the secondary BRIN-indexes are combined (pg_strom.enable_brin_multi_index)
+CREATE TABLE brin_data (
+  id    int,
+  a     int,
+  b     int,
+  x     float8
+);
+INSERT INTO brin_data (
+  SELECT i, i, 1000000 - i, pgstrom.random_float(0.5, -100.0, 100.0)
+    FROM generate_series(1,1000000) i);
+CREATE INDEX brin_data_a ON brin_data USING brin (a) WITH (pages_per_range = 32);
+CREATE INDEX brin_data_b ON brin_data USING brin (b) WITH (pages_per_range = 64);
+VACUUM ANALYZE brin_data;
+CREATE FUNCTION regtest_brin_fetched(query text)
+RETURNS bigint AS $$
+DECLARE
+  plan jsonb;
+BEGIN
+  EXECUTE 'EXPLAIN (ANALYZE, VERBOSE, FORMAT JSON) ' || query INTO plan;
+  RETURN coalesce((jsonb_path_query_first(plan, 'strict $.**."Brin Stats Fetched"'))::bigint, 0);
+END;
+$$ LANGUAGE plpgsql;
+SET pg_strom.enabled = on;
+SET enable_bitmapscan = off;
+SET enable_indexscan = off;
+SET pg_strom.enable_brin_multi_index = off;
+SELECT regtest_brin_fetched('SELECT * FROM brin_data WHERE a BETWEEN 200000 AND 600000 AND b BETWEEN 300000 AND 500000') brin_single \gset
+SET pg_strom.enable_brin_multi_index = on;
+SELECT regtest_brin_fetched('SELECT * FROM brin_data WHERE a BETWEEN 200000 AND 600000 AND b BETWEEN 300000 AND 500000') brin_multi \gset
+SELECT :brin_multi > 0, :brin_multi < :brin_single;
+SELECT id, a, b, x
+  INTO test21g
+  FROM brin_data
+ WHERE a BETWEEN 200000 AND 600000 AND b BETWEEN 300000 AND 500000;
+-- parallel workers share the ranges to be checked, with no duplication
+SET parallel_setup_cost = 0;
+SET parallel_tuple_cost = 0;
+SET min_parallel_table_scan_size = 0;
+SET max_parallel_workers_per_gather = 2;
+SELECT regtest_brin_fetched('SELECT * FROM brin_data WHERE a BETWEEN 200000 AND 600000 AND b BETWEEN 300000 AND 500000') = :brin_multi;
+SELECT id, a, b, x
+  INTO test22g
+  FROM brin_data
+ WHERE a BETWEEN 200000 AND 600000 AND b BETWEEN 300000 AND 500000;
+SET max_parallel_workers_per_gather = 0;
+RESET min_parallel_table_scan_size;
+RESET parallel_tuple_cost;
+RESET parallel_setup_cost;
+RESET enable_indexscan;
+RESET enable_bitmapscan;
+SET pg_strom.enabled = off;
+SELECT id, a, b, x
+  INTO test21p
+  FROM brin_data
+ WHERE a BETWEEN 200000 AND 600000 AND b BETWEEN 300000 AND 500000;
+SELECT count(*) FROM test21p;
+(SELECT * FROM test21g EXCEPT ALL SELECT * FROM test21p) ORDER BY id;
+(SELECT * FROM test21p EXCEPT ALL SELECT * FROM test21g) ORDER BY id;
+(SELECT * FROM test22g EXCEPT ALL SELECT * FROM test21p) ORDER BY id;
+(SELECT * FROM test21p EXCEPT ALL SELECT * FROM test22g) ORDER BY id;
+DROP TABLE test21g, test22g, test21p;
+DROP FUNCTION regtest_brin_fetched(text);
+DROP TABLE brin_data;
+
+-- calibration of the xPU cost constants by the recorded execution time
+-- (pg_strom.cost_calibration)
+SET pg_strom.cost_calibration = on;
+SELECT pgstrom.cost_calibration_reset();
+SELECT device, workload, nsamples, factor
+  FROM pgstrom.cost_calibration_info ORDER BY device, workload NULLS FIRST;
+SET pg_strom.enabled = off;
+DO $$
+BEGIN
+  FOR i IN 1 .. 10
+  LOOP
+    EXECUTE 'SELECT count(*) FROM scan_data WHERE x > 0.0';
+  END LOOP;
+END;
+$$;
+SET pg_strom.enabled = on;
+SET pg_strom.enable_gpupreagg = off;
+DO $$
+BEGIN
+  FOR i IN 1 .. 10
+  LOOP
+    EXECUTE 'SELECT count(*) FROM scan_data WHERE x > 0.0';
+  END LOOP;
+END;
+$$;
+RESET pg_strom.enable_gpupreagg;
+SELECT device, workload, nsamples >= 10 sampled, factor <> 1.0 calibrated
+  FROM pgstrom.cost_calibration_info
+ WHERE device = 'CPU' OR (device = 'GPU' AND workload = 'scan')
+ ORDER BY device;
+SELECT pgstrom.cost_calibration_reset();
+SELECT device, workload, nsamples, factor
+  FROM pgstrom.cost_calibration_info ORDER BY device, workload NULLS FIRST;
+RESET pg_strom.cost_calibration;
+SET pg_strom.enabled = off;
+
+-- fixed-length GPU results are sent back in the columnar format
+-- (pg_strom.enable_columnar_results)
+SET pg_strom.enabled = on;
+SELECT regtest_exec_path('SELECT id, aid, x, y FROM scan_data WHERE id % 5 = 0', 'columnar-results');
+-- variable-length columns are sent back in the row format
+SELECT regtest_exec_path('SELECT id, memo FROM scan_data WHERE id % 5 = 0', 'columnar-results');
+SELECT id, aid, x, y
+  INTO test23g
+  FROM scan_data
+ WHERE id % 5 = 0;
+-- tuples by CPU fallback are mixed
+SET client_min_messages = warning;
+SELECT id, aid, x
+  INTO test24g
+  FROM scan_data
+ WHERE memo LIKE '%ab%';
+RESET client_min_messages;
+SET pg_strom.enable_columnar_results = off;
+SELECT regtest_exec_path('SELECT id, aid, x, y FROM scan_data WHERE id % 5 = 0', 'columnar-results');
+SELECT id, aid, x, y
+  INTO test25g
+  FROM scan_data
+ WHERE id % 5 = 0;
+RESET pg_strom.enable_columnar_results;
+SET pg_strom.enabled = off;
+SELECT id, aid, x, y
+  INTO test23p
+  FROM scan_data
+ WHERE id % 5 = 0;
+SELECT id, aid, x
+  INTO test24p
+  FROM scan_data
+ WHERE memo LIKE '%ab%';
+(SELECT * FROM test23g EXCEPT ALL SELECT * FROM test23p) ORDER BY id;
+(SELECT * FROM test23p EXCEPT ALL SELECT * FROM test23g) ORDER BY id;
+(SELECT * FROM test24g EXCEPT ALL SELECT * FROM test24p) ORDER BY id;
+(SELECT * FROM test24p EXCEPT ALL SELECT * FROM test24g) ORDER BY id;
+(SELECT * FROM test25g EXCEPT ALL SELECT * FROM test23p) ORDER BY id;
+(SELECT * FROM test23p EXCEPT ALL SELECT * FROM test25g) ORDER BY id;
+-- NULLs are kept by the null bitmap
+SELECT count(*) FILTER (WHERE aid IS NULL) = (SELECT count(*) FROM test23p WHERE aid IS NULL),
+       count(*) FILTER (WHERE x IS NULL) = (SELECT count(*) FROM test23p WHERE x IS NULL)
+  FROM test23g;
+DROP TABLE test23g, test24g, test25g, test23p, test24p;
+
+-- source chunks start with pg_strom.chunk_size_min, then adjusted at runtime
+CREATE FUNCTION regtest_task_samples(query text)
+RETURNS bigint AS $$
+DECLARE
+  plan jsonb;
+BEGIN
+  -- Task Samples is not shown in the regression test mode
+  PERFORM set_config('pg_strom.regression_test_mode', 'off', true);
+  EXECUTE 'EXPLAIN (ANALYZE, VERBOSE, FORMAT JSON) ' || query INTO plan;
+  RETURN coalesce((jsonb_path_query_first(plan, 'strict $.**."Task Samples"'))::bigint, 0);
+END;
+$$ LANGUAGE plpgsql;
+SET pg_strom.enabled = on;
+SET pg_strom.chunk_size_min = '1MB';
+SELECT regtest_task_samples('SELECT id, aid, x FROM scan_data WHERE x > 0.0') nchunks_small \gset
+SET pg_strom.chunk_size_min = '64MB';
+SELECT regtest_task_samples('SELECT id, aid, x FROM scan_data WHERE x > 0.0') nchunks_large \gset
+SELECT :nchunks_large > 0, :nchunks_small > :nchunks_large;
+SHOW pg_strom.regression_test_mode;
+SET pg_strom.chunk_size_min = '1MB';
+SELECT id, aid, x
+  INTO test26g
+  FROM scan_data
+ WHERE x > 0.0;
+RESET pg_strom.chunk_size_min;
+SET pg_strom.enabled = off;
+SELECT id, aid, x
+  INTO test26p
+  FROM scan_data
+ WHERE x > 0.0;
+(SELECT * FROM test26g EXCEPT ALL SELECT * FROM test26p) ORDER BY id;
+(SELECT * FROM test26p EXCEPT ALL SELECT * FROM test26g) ORDER BY id;
+DROP TABLE test26g, test26p;
+DROP FUNCTION regtest_task_samples(text);
+
+-- heap pages are loaded from the shared buffer as KDS_FORMAT_BLOCK chunks,
+-- or tuple-by-tuple as KDS_FORMAT_ROW chunks (pg_strom.relscan_block_format);
+-- visibility checks, parallel chunk claiming and CPU fallback of both ways
+CREATE TABLE vis_data AS
+  SELECT id, aid, x FROM scan_data WHERE id <= 200000;
+BEGIN;
+INSERT INTO vis_data (SELECT id + 1000000, aid, x FROM scan_data WHERE id <= 20000);
+ROLLBACK;
+DELETE FROM vis_data WHERE id BETWEEN 50001 AND 60000;
+BEGIN;
+UPDATE vis_data SET x = -x WHERE id % 7 = 0;
+DELETE FROM vis_data WHERE id % 11 = 0;
+INSERT INTO vis_data (SELECT id + 2000000, aid, x FROM scan_data WHERE id <= 5000);
+SET pg_strom.enabled = on;
+SET pg_strom.relscan_block_format = on;
+SELECT regtest_exec_path('SELECT id, aid, x FROM vis_data WHERE x > 0.0 OR aid % 3 = 0', 'block-format');
+SELECT id, aid, x
+  INTO test27g1
+  FROM vis_data
+ WHERE x > 0.0 OR aid % 3 = 0;
+SET pg_strom.relscan_block_format = off;
+SELECT regtest_exec_path('SELECT id, aid, x FROM vis_data WHERE x > 0.0 OR aid % 3 = 0', 'block-format');
+SELECT id, aid, x
+  INTO test27g2
+  FROM vis_data
+ WHERE x > 0.0 OR aid % 3 = 0;
+SET parallel_setup_cost = 0;
+SET parallel_tuple_cost = 0;
+SET min_parallel_table_scan_size = 0;
+SET max_parallel_workers_per_gather = 2;
+SET pg_strom.relscan_block_format = on;
+SELECT id, aid, x
+  INTO test27g3
+  FROM vis_data
+ WHERE x > 0.0 OR aid % 3 = 0;
+SET pg_strom.relscan_block_format = off;
+SELECT id, aid, x
+  INTO test27g4
+  FROM vis_data
+ WHERE x > 0.0 OR aid % 3 = 0;
+SET max_parallel_workers_per_gather = 0;
+RESET min_parallel_table_scan_size;
+RESET parallel_tuple_cost;
+RESET parallel_setup_cost;
+SET pg_strom.enabled = off;
+SELECT id, aid, x
+  INTO test27p
+  FROM vis_data
+ WHERE x > 0.0 OR aid % 3 = 0;
+COMMIT;
+SET client_min_messages = warning;
+SET pg_strom.enabled = on;
+SET pg_strom.relscan_block_format = on;
+SELECT id, aid, x
+  INTO test28g1
+  FROM scan_data
+ WHERE memo LIKE '%ab%';
+SET pg_strom.relscan_block_format = off;
+SELECT id, aid, x
+  INTO test28g2
+  FROM scan_data
+ WHERE memo LIKE '%ab%';
+RESET pg_strom.relscan_block_format;
+RESET client_min_messages;
+SET pg_strom.enabled = off;
+SELECT id, aid, x
+  INTO test28p
+  FROM scan_data
+ WHERE memo LIKE '%ab%';
+(SELECT * FROM test27g1 EXCEPT ALL SELECT * FROM test27p) ORDER BY id;
+(SELECT * FROM test27p EXCEPT ALL SELECT * FROM test27g1) ORDER BY id;
+(SELECT * FROM test27g2 EXCEPT ALL SELECT * FROM test27p) ORDER BY id;
+(SELECT * FROM test27p EXCEPT ALL SELECT * FROM test27g2) ORDER BY id;
+(SELECT * FROM test27g3 EXCEPT ALL SELECT * FROM test27p) ORDER BY id;
+(SELECT * FROM test27p EXCEPT ALL SELECT * FROM test27g3) ORDER BY id;
+(SELECT * FROM test27g4 EXCEPT ALL SELECT * FROM test27p) ORDER BY id;
+(SELECT * FROM test27p EXCEPT ALL SELECT * FROM test27g4) ORDER BY id;
+(SELECT * FROM test28g1 EXCEPT ALL SELECT * FROM test28p) ORDER BY id;
+(SELECT * FROM test28p EXCEPT ALL SELECT * FROM test28g1) ORDER BY id;
+(SELECT * FROM test28g2 EXCEPT ALL SELECT * FROM test28p) ORDER BY id;
+(SELECT * FROM test28p EXCEPT ALL SELECT * FROM test28g2) ORDER BY id;
+DROP TABLE test27g1, test27g2, test27g3, test27g4, test27p;
+DROP TABLE test28g1, test28g2, test28p;
+DROP TABLE vis_data;
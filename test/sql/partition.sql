@@ -1,59 +1,209 @@
 ---
---- Test cases for asymmetric partition-wise GpuJoin
+--- Test cases for partitioned tables
 ---
-SET search_path = pgstrom_regress,public;
 SET pg_strom.regression_test_mode = on;
 
--- INNER JOIN
-RESET pg_strom.enabled;
-EXPLAIN (costs off)
-SELECT count(*), label, sum(a.x), sum(b.y), sum(c.z)
-  FROM ptable p, atable a, btable b, ctable c
- WHERE p.aid = a.aid AND p.bid = b.bid AND p.cid = c.cid
- GROUP BY label
- ORDER BY label;
+SET client_min_messages = error;
+DROP SCHEMA IF EXISTS regtest_partition_temp CASCADE;
+CREATE SCHEMA regtest_partition_temp;
+RESET client_min_messages;
+
+SET search_path = regtest_partition_temp,public;
+
+-- disables SeqScan and parallel query
+SET enable_seqscan = off;
+SET max_parallel_workers_per_gather = 0;
+
+-- prepare tables
+CREATE TABLE ptable (
+  id    int,
+  label text,
+  aid   int,
+  bid   int,
+  cid   int,
+  x     float
+) PARTITION BY HASH (id);
+CREATE TABLE ptable__p0 PARTITION OF ptable
+       FOR VALUES WITH (MODULUS 4, REMAINDER 0);
+CREATE TABLE ptable__p1 PARTITION OF ptable
+       FOR VALUES WITH (MODULUS 4, REMAINDER 1);
+CREATE TABLE ptable__p2 PARTITION OF ptable
+       FOR VALUES WITH (MODULUS 4, REMAINDER 2);
+CREATE TABLE ptable__p3 PARTITION OF ptable
+       FOR VALUES WITH (MODULUS 4, REMAINDER 3);
+CREATE TABLE atable (
+  aid   int primary key,
+  x     int
+);
+CREATE TABLE btable (
+  bid   int primary key,
+  y     int
+);
+CREATE TABLE ctable (
+  cid   int primary key,
+  z     int
+);
+SELECT pgstrom.random_setseed(20240508);
+INSERT INTO ptable (
+  SELECT x, 'label' || pgstrom.random_int(2, 1, 20),
+            pgstrom.random_int(2,     1, 2000),
+            pgstrom.random_int(2,  -100, 2100),
+            pgstrom.random_int(2,  -200, 2200),
+            pgstrom.random_float(2, -1000.0, 1000.0)
+    FROM generate_series(1,400000) x);
+INSERT INTO atable (SELECT x, pgstrom.random_int(0, -200, 200)
+                      FROM generate_series(1,2000) x);
+INSERT INTO btable (SELECT x, pgstrom.random_int(0, -200, 200)
+                      FROM generate_series(1,2200) x);
+INSERT INTO ctable (SELECT x, pgstrom.random_int(0, -200, 200)
+                      FROM generate_series(1,2400) x);
+ANALYZE ptable, atable, btable, ctable;
 
-SELECT count(*), label, sum(a.x), sum(b.y), sum(c.z)
+CREATE FUNCTION regtest_count_custom_scan(query text, provider text)
+RETURNS int AS $$
+DECLARE
+  plan jsonb;
+BEGIN
+  EXECUTE 'EXPLAIN (VERBOSE, FORMAT JSON) ' || query INTO plan;
+  RETURN jsonb_array_length(jsonb_path_query_array(plan, 'strict $.**."Custom Plan Provider" ? (@ == $p)',
+                                                   jsonb_build_object('p', provider)));
+END;
+$$ LANGUAGE plpgsql;
+
+--
+-- Asymmetric partition-wise GpuJoin
+--
+-- INNER JOIN
+SET pg_strom.enabled = on;
+SELECT regtest_count_custom_scan('SELECT count(*), label, sum(a.x), sum(b.y), sum(c.z)
+                                    FROM ptable p, atable a, btable b, ctable c
+                                   WHERE p.aid = a.aid AND p.bid = b.bid AND p.cid = c.cid
+                                   GROUP BY label', 'GpuJoin') > 1 AS partitionwise;
+SELECT count(*), label, sum(a.x) sx, sum(b.y) sy, sum(c.z) sz
+  INTO test01g
   FROM ptable p, atable a, btable b, ctable c
  WHERE p.aid = a.aid AND p.bid = b.bid AND p.cid = c.cid
- GROUP BY label
- ORDER BY label;
-
+ GROUP BY label;
+SET pg_strom.enable_partitionwise_gpujoin = off;
+SELECT regtest_count_custom_scan('SELECT count(*), label, sum(a.x), sum(b.y), sum(c.z)
+                                    FROM ptable p, atable a, btable b, ctable c
+                                   WHERE p.aid = a.aid AND p.bid = b.bid AND p.cid = c.cid
+                                   GROUP BY label', 'GpuJoin') > 1 AS partitionwise;
+RESET pg_strom.enable_partitionwise_gpujoin;
 SET pg_strom.enabled = off;
-SELECT count(*), label, sum(a.x), sum(b.y), sum(c.z)
+SELECT count(*), label, sum(a.x) sx, sum(b.y) sy, sum(c.z) sz
+  INTO test01p
   FROM ptable p, atable a, btable b, ctable c
  WHERE p.aid = a.aid AND p.bid = b.bid AND p.cid = c.cid
- GROUP BY label
- ORDER BY label;
+ GROUP BY label;
+(SELECT * FROM test01g EXCEPT ALL SELECT * FROM test01p) ORDER BY label;
+(SELECT * FROM test01p EXCEPT ALL SELECT * FROM test01g) ORDER BY label;
 
 -- LEFT OUTER JOIN
-RESET pg_strom.enabled;
-EXPLAIN (costs off)
-SELECT count(*), label, sum(a.x), sum(b.y), sum(c.z)
+SET pg_strom.enabled = on;
+SELECT regtest_count_custom_scan('SELECT count(*), label, sum(a.x), sum(b.y), sum(c.z)
+                                    FROM ptable p
+                                    LEFT OUTER JOIN atable a ON p.aid = a.aid
+                                    LEFT OUTER JOIN btable b ON p.bid = b.bid
+                                    LEFT OUTER JOIN ctable c ON p.cid = c.cid
+                                   GROUP BY label', 'GpuJoin') > 1 AS partitionwise;
+SELECT count(*), label, sum(a.x) sx, sum(b.y) sy, sum(c.z) sz
+  INTO test02g
   FROM ptable p
   LEFT OUTER JOIN atable a ON p.aid = a.aid
   LEFT OUTER JOIN btable b ON p.bid = b.bid
   LEFT OUTER JOIN ctable c ON p.cid = c.cid
- GROUP BY label
- ORDER BY label;
-
-SELECT count(*), label, sum(a.x), sum(b.y), sum(c.z)
-  FROM ptable p
-  LEFT OUTER JOIN atable a ON p.aid = a.aid
-  LEFT OUTER JOIN btable b ON p.bid = b.bid
-  LEFT OUTER JOIN ctable c ON p.cid = c.cid
- GROUP BY label
- ORDER BY label;
-
+ GROUP BY label;
 SET pg_strom.enabled = off;
-SELECT count(*), label, sum(a.x), sum(b.y), sum(c.z)
+SELECT count(*), label, sum(a.x) sx, sum(b.y) sy, sum(c.z) sz
+  INTO test02p
   FROM ptable p
   LEFT OUTER JOIN atable a ON p.aid = a.aid
   LEFT OUTER JOIN btable b ON p.bid = b.bid
   LEFT OUTER JOIN ctable c ON p.cid = c.cid
- GROUP BY label
- ORDER BY label;
+ GROUP BY label;
+(SELECT * FROM test02g EXCEPT ALL SELECT * FROM test02p) ORDER BY label;
+(SELECT * FROM test02p EXCEPT ALL SELECT * FROM test02g) ORDER BY label;
+DROP TABLE test01g, test01p, test02g, test02p;
 
 --
 -- RIGHT/FULL OUTER JOIN is not supported right now
 --
+
+--
+-- The next partition leafs under Append are prestarted
+-- (pg_strom.async_append_depth); EXPLAIN ANALYZE marks the leafs
+-- prestarted by the previous one.
+--
+CREATE TABLE rtable (
+  id    int,
+  aid   int,
+  x     float
+) PARTITION BY RANGE (id);
+CREATE TABLE rtable__p0 PARTITION OF rtable FOR VALUES FROM (MINVALUE) TO (100000);
+CREATE TABLE rtable__p1 PARTITION OF rtable FOR VALUES FROM (100000) TO (200000);
+CREATE TABLE rtable__p2 PARTITION OF rtable FOR VALUES FROM (200000) TO (250000);
+CREATE TABLE rtable__p3 PARTITION OF rtable FOR VALUES FROM (250000) TO (350000);
+CREATE TABLE rtable__p4 PARTITION OF rtable FOR VALUES FROM (350000) TO (MAXVALUE);
+-- rtable__p2 is empty
+INSERT INTO rtable (
+  SELECT id, aid, x FROM ptable
+   WHERE id NOT BETWEEN 200000 AND 249999);
+ANALYZE rtable;
+
+CREATE FUNCTION regtest_count_prestarted(query text)
+RETURNS int AS $$
+DECLARE
+  plan jsonb;
+BEGIN
+  EXECUTE 'EXPLAIN (ANALYZE, COSTS OFF, FORMAT JSON) ' || query INTO plan;
+  RETURN jsonb_array_length(jsonb_path_query_array(plan, 'strict $.**."Prestarted"'));
+END;
+$$ LANGUAGE plpgsql;
+
+SET pg_strom.enabled = on;
+SET pg_strom.async_append_depth = 1;
+SELECT regtest_count_prestarted('SELECT * FROM rtable WHERE x > 0.0') AS prestarted;
+SELECT id, aid, x
+  INTO test03g
+  FROM rtable
+ WHERE x > 0.0;
+SELECT g, (SELECT count(*) FROM rtable WHERE x > 0.0 AND aid = g) cnt
+  INTO test04g
+  FROM generate_series(1,20) g;
+-- Append stops before the prestarted leafs are reached
+SELECT regtest_count_prestarted('SELECT * FROM rtable WHERE x > 0.0 LIMIT 100') AS prestarted;
+SELECT count(*) FROM (SELECT * FROM rtable WHERE x > 0.0 LIMIT 100) s;
+SET pg_strom.async_append_depth = 3;
+SELECT regtest_count_prestarted('SELECT * FROM rtable WHERE x > 0.0') AS prestarted;
+SELECT regtest_count_prestarted('SELECT * FROM rtable WHERE x > 0.0 LIMIT 100') AS prestarted;
+SELECT id, aid, x
+  INTO test05g
+  FROM rtable
+ WHERE x > 0.0;
+SET pg_strom.async_append_depth = 0;
+SELECT regtest_count_prestarted('SELECT * FROM rtable WHERE x > 0.0') AS prestarted;
+SELECT id, aid, x
+  INTO test06g
+  FROM rtable
+ WHERE x > 0.0;
+RESET pg_strom.async_append_depth;
+SET pg_strom.enabled = off;
+SELECT id, aid, x
+  INTO test03p
+  FROM rtable
+ WHERE x > 0.0;
+SELECT g, (SELECT count(*) FROM rtable WHERE x > 0.0 AND aid = g) cnt
+  INTO test04p
+  FROM generate_series(1,20) g;
+(SELECT * FROM test03g EXCEPT ALL SELECT * FROM test03p) ORDER BY id;
+(SELECT * FROM test03p EXCEPT ALL SELECT * FROM test03g) ORDER BY id;
+(SELECT * FROM test04g EXCEPT ALL SELECT * FROM test04p) ORDER BY g;
+(SELECT * FROM test04p EXCEPT ALL SELECT * FROM test04g) ORDER BY g;
+(SELECT * FROM test05g EXCEPT ALL SELECT * FROM test03p) ORDER BY id;
+(SELECT * FROM test03p EXCEPT ALL SELECT * FROM test05g) ORDER BY id;
+(SELECT * FROM test06g EXCEPT ALL SELECT * FROM test03p) ORDER BY id;
+(SELECT * FROM test03p EXCEPT ALL SELECT * FROM test06g) ORDER BY id;
+DROP TABLE test03g, test04g, test05g, test06g, test03p, test04p;
+DROP FUNCTION regtest_count_prestarted(text);
+DROP FUNCTION regtest_count_custom_scan(text, text);
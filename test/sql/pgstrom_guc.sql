@@ -26,4 +26,63 @@ SHOW pg_strom.gpu_mempool_segment_sz;
 SHOW pg_strom.gpu_mempool_max_ratio;
 SHOW pg_strom.gpu_mempool_min_ratio;
 SHOW pg_strom.gpu_mempool_release_delay;
-SHOW pg_strom.gpuserv_debug_output;
\ No newline at end of file
+SHOW pg_strom.gpuserv_debug_output;
+SHOW pg_strom.gpu_pipelined_load;
+SHOW pg_strom.multi_gpu_split;
+SHOW pg_strom.gpu_grid_size_tuning;
+SHOW pg_strom.gpu_result_ring_size;
+SHOW pg_strom.gpu_jit_specialization;
+SHOW pg_strom.gpu_jit_threshold;
+SHOW pg_strom.gpu_mempool_device_mode;
+SHOW pg_strom.gpu_session_memory_limit;
+SHOW pg_strom.gpu_admission_ratio;
+SHOW pg_strom.gpu_admission_timeout;
+SHOW pg_strom.gpu_shared_inner_buffer;
+SHOW pg_strom.gpu_inner_buffer_cache_size;
+SHOW pg_strom.xpu_connection_pool_size;
+SHOW pg_strom.gpu_session_cache;
+SHOW pg_strom.xpu_max_inflight_tasks;
+SHOW pg_strom.parallel_cpu_fallback;
+SHOW pg_strom.relscan_prefetch_chunks;
+SHOW arrow_fdw.io_coalesce_gap;
+SHOW pg_strom.parallel_claim_chunks;
+SHOW pg_strom.gpudirect_dma_pool_size;
+SHOW pg_strom.enable_zonemap;
+SHOW pg_strom.gpucache_log_batch_size;
+SHOW pg_strom.gpucache_initial_load_workers;
+SHOW pg_strom.gpucache_merge_on_read;
+SHOW arrow_fdw.metadata_index_enabled;
+SHOW arrow_fdw.stats_synthesis_enabled;
+SHOW arrow_fdw.late_materialization;
+SHOW arrow_fdw.record_batch_size;
+SHOW arrow_fdw.mmap_enabled;
+SHOW arrow_fdw.remote_concurrency;
+SHOW arrow_fdw.coalesce_batch_size;
+SHOW pg_strom.gpujoin_inner_buffer_limit;
+SHOW pg_strom.gpujoin_adaptive_partition;
+SHOW pg_strom.gpuhashjoin_bucketized;
+SHOW pg_strom.gpuhashjoin_build_on_gpu;
+SHOW pg_strom.gpujoin_bloom_filter;
+SHOW pg_strom.enable_gpurangejoin;
+SHOW pg_strom.gpuhashjoin_skew_threshold;
+SHOW pg_strom.enable_gpupreagg_finalize;
+SHOW pg_strom.enable_gputopk;
+SHOW pg_strom.enable_gpusort;
+SHOW pg_strom.enable_inline_sql_functions;
+SHOW pg_strom.gpujoin_gist_rtree;
+SHOW pg_strom.gpujoin_geometry_index;
+SHOW pg_strom.enable_gpugridjoin;
+SHOW pg_strom.enable_brin_multi_index;
+SHOW pg_strom.cost_calibration;
+SHOW pg_strom.async_append_depth;
+SHOW pg_strom.gpu_memory_plan_ratio;
+SHOW pg_strom.enable_columnar_results;
+SHOW pg_strom.chunk_size_min;
+SHOW pg_strom.gpupreagg_result_cache_size;
+SHOW pg_strom.gpu_host_mapped_inner_size;
+SHOW pg_strom.gpu_kernel_time_slice;
+SHOW pg_strom.enable_generated_column_rewrite;
+SHOW pg_strom.relscan_block_format;
+SHOW pg_strom.gpucache_device_memory_limit;
+SHOW pg_strom.gpu_shared_scan_buffer_size;
+SHOW pg_strom.gpu_peer_inner_buffer;
\ No newline at end of file
@@ -0,0 +1,11 @@
+--
+-- validation of the default GUC parameter setting of DPU
+--
+-- skip the test, if no DPU endpoints are configured
+SELECT current_setting('pg_strom.dpu_endpoint_list') = '' AS skip_test \gset
+\if :skip_test
+\quit
+\endif
+\t
+SHOW pg_strom.dpu_socket_buffer_size;
+SHOW pg_strom.dpu_compress_results;
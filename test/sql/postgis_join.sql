@@ -0,0 +1,144 @@
+
+---
+--- Test for GpuJoin on PostGIS geometry
+---
+SET pg_strom.regression_test_mode = on;
+-- skip the test, if PostGIS is not installed
+SELECT count(*) = 0 AS skip_test
+  FROM pg_available_extensions WHERE name = 'postgis' \gset
+\if :skip_test
+\quit
+\endif
+SET client_min_messages = error;
+CREATE EXTENSION IF NOT EXISTS postgis;
+DROP SCHEMA IF EXISTS regtest_postgis_join_temp CASCADE;
+CREATE SCHEMA regtest_postgis_join_temp;
+RESET client_min_messages;
+
+SET search_path = regtest_postgis_join_temp,public;
+SET max_parallel_workers_per_gather = 0;
+SELECT pgstrom.random_setseed(20241014);
+-- polygons with 129 points, and rectangles
+CREATE TABLE gis_zones (
+  zid   int,
+  geom  geometry
+);
+INSERT INTO gis_zones (
+  SELECT x, CASE WHEN x % 4 = 0
+                 THEN st_makeenvelope(px, py, px + 8.0, py + 5.0)
+                 ELSE st_buffer(st_makepoint(px, py), 2.0 + x % 8, 32)
+            END
+    FROM (SELECT x, pgstrom.random_float(0, 0.0, 1000.0) px,
+                    pgstrom.random_float(0, 0.0, 1000.0) py
+            FROM generate_series(1,2000) x) v);
+CREATE INDEX gis_zones_geom_idx ON gis_zones USING gist (geom);
+CREATE TABLE gis_points (
+  pid   int,
+  geom  geometry
+);
+INSERT INTO gis_points (
+  SELECT x, st_makepoint(pgstrom.random_float(0, 0.0, 1000.0),
+                         pgstrom.random_float(0, 0.0, 1000.0))
+    FROM generate_series(1,200000) x);
+VACUUM ANALYZE gis_zones, gis_points;
+CREATE FUNCTION regtest_explain_has(query text, key text)
+RETURNS bool AS $$
+DECLARE
+  plan jsonb;
+BEGIN
+  EXECUTE 'EXPLAIN (VERBOSE, FORMAT JSON) ' || query INTO plan;
+  RETURN jsonb_path_exists(plan, ('strict $.**."' || key || '"')::jsonpath);
+END;
+$$ LANGUAGE plpgsql;
+
+-- GpuJoin by the GiST-index replaced with the packed R-tree (pg_strom.gpujoin_gist_rtree)
+SET pg_strom.enabled = on;
+SELECT regtest_explain_has('SELECT p.pid, z.zid FROM gis_points p JOIN gis_zones z ON st_contains(z.geom, p.geom)',
+                           'GPU GiST Join [1]');
+SET pg_strom.gpujoin_gist_rtree = on;
+SELECT p.pid, z.zid
+  INTO test01g
+  FROM gis_points p JOIN gis_zones z ON st_contains(z.geom, p.geom);
+SET pg_strom.gpujoin_gist_rtree = off;
+SELECT p.pid, z.zid
+  INTO test02g
+  FROM gis_points p JOIN gis_zones z ON st_contains(z.geom, p.geom);
+RESET pg_strom.gpujoin_gist_rtree;
+SET pg_strom.enabled = off;
+SELECT p.pid, z.zid
+  INTO test01p
+  FROM gis_points p JOIN gis_zones z ON st_contains(z.geom, p.geom);
+(SELECT * FROM test01g EXCEPT ALL SELECT * FROM test01p) ORDER BY pid;
+(SELECT * FROM test01p EXCEPT ALL SELECT * FROM test01g) ORDER BY pid;
+(SELECT * FROM test02g EXCEPT ALL SELECT * FROM test01p) ORDER BY pid;
+(SELECT * FROM test01p EXCEPT ALL SELECT * FROM test02g) ORDER BY pid;
+SELECT count(*) > 0 FROM test01p;
+
+-- point-in-polygon by the edge index of the inner polygons (pg_strom.gpujoin_geometry_index)
+SET pg_strom.enabled = on;
+SET pg_strom.gpujoin_geometry_index = on;
+SELECT p.pid, z.zid
+  INTO test03g
+  FROM gis_points p JOIN gis_zones z ON st_contains(z.geom, p.geom);
+SELECT p.pid, z.zid
+  INTO test04g
+  FROM gis_points p JOIN gis_zones z ON st_intersects(z.geom, p.geom);
+SET pg_strom.gpujoin_geometry_index = off;
+SELECT p.pid, z.zid
+  INTO test05g
+  FROM gis_points p JOIN gis_zones z ON st_contains(z.geom, p.geom);
+RESET pg_strom.gpujoin_geometry_index;
+SET pg_strom.enabled = off;
+SELECT p.pid, z.zid
+  INTO test03p
+  FROM gis_points p JOIN gis_zones z ON st_contains(z.geom, p.geom);
+SELECT p.pid, z.zid
+  INTO test04p
+  FROM gis_points p JOIN gis_zones z ON st_intersects(z.geom, p.geom);
+(SELECT * FROM test03g EXCEPT ALL SELECT * FROM test03p) ORDER BY pid;
+(SELECT * FROM test03p EXCEPT ALL SELECT * FROM test03g) ORDER BY pid;
+(SELECT * FROM test04g EXCEPT ALL SELECT * FROM test04p) ORDER BY pid;
+(SELECT * FROM test04p EXCEPT ALL SELECT * FROM test04g) ORDER BY pid;
+(SELECT * FROM test05g EXCEPT ALL SELECT * FROM test03p) ORDER BY pid;
+(SELECT * FROM test03p EXCEPT ALL SELECT * FROM test05g) ORDER BY pid;
+
+-- grid-based GpuNestLoop for st_dwithin() without GiST-index (pg_strom.enable_gpugridjoin);
+-- line-strings have their centers in the far cells
+CREATE TABLE gis_sites (
+  sid   int,
+  geom  geometry
+);
+INSERT INTO gis_sites (
+  SELECT x, CASE WHEN x = 1 THEN 'POINT EMPTY'::geometry
+                 WHEN x % 10 = 0
+                 THEN st_makeline(st_makepoint(px, py), st_makepoint(px + 20.0, py + 3.0))
+                 ELSE st_makepoint(px, py)
+            END
+    FROM (SELECT x, pgstrom.random_float(0, 0.0, 1000.0) px,
+                    pgstrom.random_float(0, 0.0, 1000.0) py
+            FROM generate_series(1,5000) x) v);
+ANALYZE gis_sites;
+SET pg_strom.enabled = on;
+SELECT regtest_explain_has('SELECT p.pid, s.sid FROM gis_points p JOIN gis_sites s ON st_dwithin(p.geom, s.geom, 0.5)', 'GPU Grid Join [1]');
+SELECT p.pid, s.sid
+  INTO test06g
+  FROM gis_points p JOIN gis_sites s ON st_dwithin(p.geom, s.geom, 0.5);
+SET pg_strom.enable_gpugridjoin = off;
+SELECT regtest_explain_has('SELECT p.pid, s.sid FROM gis_points p JOIN gis_sites s ON st_dwithin(p.geom, s.geom, 0.5)', 'GPU Grid Join [1]');
+SELECT p.pid, s.sid
+  INTO test07g
+  FROM gis_points p JOIN gis_sites s ON st_dwithin(p.geom, s.geom, 0.5);
+RESET pg_strom.enable_gpugridjoin;
+SET pg_strom.enabled = off;
+SELECT p.pid, s.sid
+  INTO test06p
+  FROM gis_points p JOIN gis_sites s ON st_dwithin(p.geom, s.geom, 0.5);
+(SELECT * FROM test06g EXCEPT ALL SELECT * FROM test06p) ORDER BY pid;
+(SELECT * FROM test06p EXCEPT ALL SELECT * FROM test06g) ORDER BY pid;
+(SELECT * FROM test07g EXCEPT ALL SELECT * FROM test06p) ORDER BY pid;
+(SELECT * FROM test06p EXCEPT ALL SELECT * FROM test07g) ORDER BY pid;
+SELECT count(*) > 0 FROM test06p;
+
+-- cleanup temporary resource
+SET client_min_messages = error;
+DROP SCHEMA regtest_postgis_join_temp CASCADE;
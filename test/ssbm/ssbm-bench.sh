@@ -0,0 +1,231 @@
+#!/bin/sh
+#
+# ssbm-bench.sh - Star Schema Benchmark driver
+#
+# It generates the SSBM dataset at the given scale factor, then runs the
+# 13 queries in ssbm-all-pgsql.sql on the heap, Arrow_Fdw and GpuCache
+# variants of the lineorder table, with and without pg_strom.enabled, and
+# in warm and/or cold cache mode. The results are written out as a JSON
+# report that contains the best response time, the throughput (lineorder
+# rows/s) and the speed-up ratio of GPU to CPU for each query.
+#
+CWD=`cd \`dirname $0\` && pwd`
+DBNAME="ssbm"
+SCALE=10
+VARIANTS="heap,arrow"
+MODES="warm"
+NLOOPS=3
+NWORKERS=""
+ARROW_DIR=""
+REPORT=""
+SKIP_INIT=0
+DBGEN="${CWD}/dbgen-ssbm"
+PG2ARROW="${CWD}/../../arrow-tools/pg2arrow"
+
+usage()
+{
+  echo "usage: ssbm-bench.sh [options]"
+  echo "  -d DBNAME   database name (default: ${DBNAME})"
+  echo "  -s SCALE    scale factor of the dataset (default: ${SCALE})"
+  echo "  -V LIST     comma separated variants of lineorder; any of heap,"
+  echo "              arrow and gpucache (default: ${VARIANTS})"
+  echo "  -m LIST     comma separated cache modes; any of warm and cold"
+  echo "              (default: ${MODES}). cold mode drops the OS page cache"
+  echo "              by 'sudo sysctl -w vm.drop_caches=1' prior to each run"
+  echo "  -l NLOOPS   number of runs per query; the best one is reported (default: ${NLOOPS})"
+  echo "  -w N        max_parallel_workers_per_gather (default: server setting)"
+  echo "  -A DIR      directory of the Arrow file (default: PGDATA of the server)"
+  echo "  -o FILE     output JSON report (default: stdout)"
+  echo "  -i          skip dataset generation, use the existing one"
+  exit 1
+}
+
+while getopts "d:s:V:m:l:w:A:o:ih" opt
+do
+  case $opt in
+    d) DBNAME="$OPTARG" ;;
+    s) SCALE="$OPTARG" ;;
+    V) VARIANTS="$OPTARG" ;;
+    m) MODES="$OPTARG" ;;
+    l) NLOOPS="$OPTARG" ;;
+    w) NWORKERS="$OPTARG" ;;
+    A) ARROW_DIR="$OPTARG" ;;
+    o) REPORT="$OPTARG" ;;
+    i) SKIP_INIT=1 ;;
+    *) usage ;;
+  esac
+done
+VARIANTS=`echo ${VARIANTS} | tr ',' ' '`
+MODES=`echo ${MODES} | tr ',' ' '`
+
+PSQL="psql -X -q -At -v ON_ERROR_STOP=1 ${DBNAME}"
+
+if [ -z "${ARROW_DIR}" ]; then
+  ARROW_DIR=`${PSQL} -c 'SHOW data_directory'` || exit 1
+fi
+ARROW_FILE="${ARROW_DIR}/ssbm_lineorder_sf${SCALE}.arrow"
+
+#
+# Dataset generation
+#
+load_table()
+{
+  echo "loading ssbm_heap.$1 (SF=${SCALE})..." >&2
+  ${DBGEN} -q -s${SCALE} -X -T$2 | \
+    ${PSQL} -c "\\copy ssbm_heap.$1 FROM STDIN DELIMITER '|'" || exit 1
+}
+
+if [ ${SKIP_INIT} -eq 0 ]; then
+  [ -x ${DBGEN} ] || make -C ${CWD} >&2 || exit 1
+  ${PSQL} -f ${CWD}/ssbm-bench-ddl.sql || exit 1
+  load_table customer  c
+  load_table date1     d
+  load_table lineorder l
+  load_table part      p
+  load_table supplier  s
+  ${PSQL} -c 'VACUUM ANALYZE' || exit 1
+
+  for v in ${VARIANTS}
+  do
+    case $v in
+      arrow)
+        echo "dumping lineorder to ${ARROW_FILE}..." >&2
+        [ -x ${PG2ARROW} ] || make -C ${CWD}/../../arrow-tools pg2arrow >&2 || exit 1
+        ${PG2ARROW} -d ${DBNAME} -t ssbm_heap.lineorder -o ${ARROW_FILE} || exit 1
+        ${PSQL} <<__EOF__ || exit 1
+IMPORT FOREIGN SCHEMA lineorder
+  FROM SERVER arrow_fdw
+  INTO ssbm_arrow
+OPTIONS (file '${ARROW_FILE}');
+__EOF__
+        ;;
+      gpucache)
+        echo "loading lineorder to GpuCache..." >&2
+        ${PSQL} <<__EOF__ || exit 1
+CREATE TABLE ssbm_gpucache.lineorder (LIKE ssbm_heap.lineorder);
+SELECT 'max_num_rows=' || (reltuples * 1.2)::bigint opts
+  FROM pg_class WHERE oid = 'ssbm_heap.lineorder'::regclass
+\\gset
+CREATE TRIGGER row_sync AFTER INSERT OR UPDATE OR DELETE
+    ON ssbm_gpucache.lineorder FOR ROW
+    EXECUTE FUNCTION pgstrom.gpucache_sync_trigger(:'opts');
+ALTER TABLE ssbm_gpucache.lineorder ENABLE ALWAYS TRIGGER row_sync;
+INSERT INTO ssbm_gpucache.lineorder SELECT * FROM ssbm_heap.lineorder;
+VACUUM ANALYZE ssbm_gpucache.lineorder;
+SELECT pgstrom.gpucache_apply_redo('ssbm_gpucache.lineorder');
+__EOF__
+        ;;
+      heap)
+        ;;
+      *)
+        echo "unknown variant: $v" >&2
+        exit 1
+        ;;
+    esac
+  done
+fi
+NROWS=`${PSQL} -c "SELECT count(*) FROM ssbm_heap.lineorder"` || exit 1
+
+#
+# run_query <variant> <mode> <pg_strom.enabled> <query>
+#
+# It prints the best response time in ms, or nothing on error.
+#
+run_query()
+{
+  __best=""
+  __i=0
+  while [ ${__i} -le ${NLOOPS} ]; do
+    # the first run is a warm-up, unless cold mode
+    if [ "$2" = "cold" ]; then
+      sudo sysctl -q -w vm.drop_caches=1 || return
+    fi
+    __time=`${PSQL} 2>/dev/null <<__EOF__ | sed -n 's/^Time: \([0-9.]*\) ms.*/\1/p'
+SET search_path = ssbm_$1,ssbm_heap,public;
+SET pg_strom.enabled = $3;
+${NWORKERS:+SET max_parallel_workers_per_gather = ${NWORKERS};}
+\\o /dev/null
+\\timing on
+$4
+__EOF__`
+    [ -n "${__time}" ] || return
+    if [ ${__i} -gt 0 ] || [ "$2" = "cold" ]; then
+      __best=`echo "${__time} ${__best}" | awk '{ print ($2 == "" || $1 < $2) ? $1 : $2 }'`
+    fi
+    __i=`expr ${__i} + 1`
+  done
+  echo "${__best}"
+}
+
+#
+# json_entry <time in ms>
+#
+json_entry()
+{
+  if [ -z "$1" ]; then
+    printf 'null'
+  else
+    echo "$1 ${NROWS}" | awk '{ printf("{\"time_ms\": %s, \"rows_per_sec\": %.0f}", $1, $2 * 1000.0 / $1) }'
+  fi
+}
+
+QUERIES=`mktemp`
+OUT=`mktemp`
+trap 'rm -f ${QUERIES} ${OUT}' EXIT
+awk '
+/^--Q/ { name = substr($0, 4); buf = ""; next }
+/^\\|^SET|^$/ { next }
+{ buf = buf " " $0 }
+/;[ \t]*$/ {
+  sub(/^ +/, "", buf);
+  if (name != "" && tolower(buf) !~ /^explain/)
+    print name "|" buf;
+  buf = "";
+}' ${CWD}/ssbm-all-pgsql.sql > ${QUERIES}
+
+PGSTROM_VERSION=`${PSQL} -c "SELECT extversion FROM pg_extension WHERE extname = 'pg_strom'"`
+GPU_NAMES=`${PSQL} -c "SELECT string_agg('\"' || att_value || '\"', ', ' ORDER BY gpu_id) FROM pgstrom.gpu_device_info WHERE att_name = 'DEV_NAME'"`
+TIMESTAMP=`date -Iseconds`
+{
+  printf '{\n'
+  printf '  "timestamp": "%s",\n' "${TIMESTAMP}"
+  printf '  "pgstrom_version": "%s",\n' "${PGSTROM_VERSION}"
+  printf '  "gpus": [%s],\n' "${GPU_NAMES}"
+  printf '  "scale_factor": %s,\n' "${SCALE}"
+  printf '  "lineorder_nrows": %s,\n' "${NROWS}"
+  printf '  "nloops": %s,\n' "${NLOOPS}"
+  printf '  "results": ['
+  __sep=''
+  for v in ${VARIANTS}
+  do
+    for m in ${MODES}
+    do
+      while IFS='|' read NAME QUERY
+      do
+        echo "Q${NAME} (${v}, ${m}): running..." >&2
+        CPU_TIME=`run_query $v $m off "${QUERY}"`
+        GPU_TIME=`run_query $v $m on "${QUERY}"`
+        if [ -n "${CPU_TIME}" ] && [ -n "${GPU_TIME}" ]; then
+          SPEEDUP=`echo "${CPU_TIME} ${GPU_TIME}" | awk '{ printf("%.2f", $1 / $2) }'`
+        else
+          SPEEDUP=null
+        fi
+        printf '%s\n    {"query": "Q%s", "variant": "%s", "mode": "%s",\n' \
+               "${__sep}" "${NAME}" "${v}" "${m}"
+        printf '     "cpu": '
+        json_entry "${CPU_TIME}"
+        printf ',\n     "gpu": '
+        json_entry "${GPU_TIME}"
+        printf ',\n     "speedup": %s}' "${SPEEDUP}"
+        __sep=','
+      done < ${QUERIES}
+    done
+  done
+  printf '\n  ]\n}\n'
+} > ${OUT}
+
+if [ -n "${REPORT}" ]; then
+  cp -f ${OUT} ${REPORT}
+else
+  cat ${OUT}
+fi